@@ -35,6 +35,8 @@ namespace AppInstaller::CLI
             return Argument{ "count", 'n', Args::Type::Count, Resource::String::CountArgumentDescription, ArgumentType::Standard };
         case Args::Type::Exact:
             return Argument{ "exact", 'e', Args::Type::Exact, Resource::String::ExactArgumentDescription, ArgumentType::Flag };
+        case Args::Type::IdFile:
+            return Argument{ "id-file", NoAlias, Args::Type::IdFile, Resource::String::IdFileArgumentDescription, ArgumentType::Standard, Argument::Visibility::Help };
         case Args::Type::Version:
             return Argument{ "version", 'v', Args::Type::Version, Resource::String::VersionArgumentDescription, ArgumentType::Standard };
         case Args::Type::Channel:
@@ -55,6 +57,8 @@ namespace AppInstaller::CLI
             return Argument{ "file", 'f', Args::Type::HashFile, Resource::String::FileArgumentDescription, ArgumentType::Positional, true };
         case Args::Type::Msix:
             return Argument{ "msix", 'm', Args::Type::Msix, Resource::String::MsixArgumentDescription, ArgumentType::Flag };
+        case Args::Type::ChunkSize:
+            return Argument{ "chunk-size", NoAlias, Args::Type::ChunkSize, Resource::String::ChunkSizeArgumentDescription, ArgumentType::Standard };
         case Args::Type::ListVersions:
             return Argument{ "versions", NoAlias, Args::Type::ListVersions, Resource::String::VersionsArgumentDescription, ArgumentType::Flag };
         case Args::Type::Help:
@@ -65,8 +69,18 @@ namespace AppInstaller::CLI
             return Argument{ "arg", 'a', Args::Type::SourceArg, Resource::String::SourceArgArgumentDescription, ArgumentType::Positional, true };
         case Args::Type::SourceType:
             return Argument{ "type", 't', Args::Type::SourceType, Resource::String::SourceTypeArgumentDescription, ArgumentType::Positional };
+        case Args::Type::SourceMirror:
+            return Argument{ "mirror", NoAlias, Args::Type::SourceMirror, Resource::String::SourceMirrorArgumentDescription, ArgumentType::Standard };
+        case Args::Type::SourceScheduled:
+            return Argument{ "scheduled", NoAlias, Args::Type::SourceScheduled, Resource::String::SourceScheduledArgumentDescription, ArgumentType::Flag, Argument::Visibility::Hidden };
         case Args::Type::ValidateManifest:
             return Argument{ "manifest", NoAlias, Args::Type::ValidateManifest, Resource::String::ValidateManifestArgumentDescription, ArgumentType::Positional, true };
+        case Args::Type::ValidationCache:
+            return Argument{ "cache", NoAlias, Args::Type::ValidationCache, Resource::String::ValidationCacheArgumentDescription, ArgumentType::Standard };
+        case Args::Type::BatchFile:
+            return Argument{ "file", 'f', Args::Type::BatchFile, Resource::String::BatchFileArgumentDescription, ArgumentType::Positional, true };
+        case Args::Type::All:
+            return Argument{ "all", NoAlias, Args::Type::All, Resource::String::UpgradeAllArgumentDescription, ArgumentType::Flag };
         case Args::Type::NoVT:
             return Argument{ "no-vt", NoAlias, Args::Type::NoVT, Resource::String::NoVTArgumentDescription, ArgumentType::Flag, Argument::Visibility::Hidden };
         case Args::Type::RainbowStyle:
@@ -75,6 +89,10 @@ namespace AppInstaller::CLI
             return Argument{ "retro", NoAlias, Args::Type::RetroStyle, Resource::String::RetroArgumentDescription, ArgumentType::Flag, Argument::Visibility::Hidden };
         case Args::Type::VerboseLogs:
             return Argument{ "verbose-logs", NoAlias, Args::Type::VerboseLogs, Resource::String::VerboseLogsArgumentDescription, ArgumentType::Flag };
+        case Args::Type::Perf:
+            return Argument{ "perf", NoAlias, Args::Type::Perf, Resource::String::PerfArgumentDescription, ArgumentType::Flag, Argument::Visibility::Hidden };
+        case Args::Type::Output:
+            return Argument{ "output", NoAlias, Args::Type::Output, Resource::String::OutputArgumentDescription, ArgumentType::Standard, Argument::Visibility::Help };
         case Args::Type::ExperimentalArg:
             return Argument{ "arg", NoAlias, Args::Type::ExperimentalArg, Resource::String::ExperimentalArgumentDescription, ArgumentType::Flag, ExperimentalFeature::Feature::ExperimentalArg };
         default:
@@ -89,6 +107,7 @@ namespace AppInstaller::CLI
         args.push_back(ForType(Args::Type::RainbowStyle));
         args.push_back(ForType(Args::Type::RetroStyle));
         args.push_back(ForType(Args::Type::VerboseLogs));
+        args.push_back(ForType(Args::Type::Perf));
     }
 
     Argument::Visibility Argument::GetVisibility() const
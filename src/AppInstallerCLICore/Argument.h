@@ -109,6 +109,7 @@ namespace AppInstaller::CLI
         Settings::ExperimentalFeature::Feature Feature() const { return m_feature; }
 
         Argument& SetRequired(bool required) { m_required = required; return *this; }
+        Argument& SetCountLimit(size_t countLimit) { m_countLimit = countLimit; return *this; }
 
     private:
         std::string_view m_name;
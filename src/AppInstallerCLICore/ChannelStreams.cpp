@@ -9,14 +9,21 @@ namespace AppInstaller::CLI::Execution
     using namespace Settings;
     using namespace VirtualTerminal;
 
-    BaseStream::BaseStream(std::ostream& out, bool enabled, bool VTEnabled) :
-        m_out(out), m_enabled(enabled), m_VTEnabled(VTEnabled) {}
+    BaseStream::BaseStream(std::ostream& out, bool enabled, bool VTEnabled, bool flushLines) :
+        m_out(out), m_enabled(enabled), m_VTEnabled(VTEnabled), m_flushLines(flushLines) {}
 
     BaseStream& BaseStream::operator<<(std::ostream& (__cdecl* f)(std::ostream&))
     {
         if (m_enabled)
         {
-            f(m_out);
+            if (!m_flushLines && f == &std::endl<char, std::char_traits<char>>)
+            {
+                m_out.put('\n');
+            }
+            else
+            {
+                f(m_out);
+            }
         }
         return *this;
     }
@@ -39,8 +46,8 @@ namespace AppInstaller::CLI::Execution
         return *this;
     }
 
-    OutputStream::OutputStream(std::ostream& out, bool enabled, bool VTEnabled) :
-        m_out(out, enabled, VTEnabled) {}
+    OutputStream::OutputStream(std::ostream& out, bool enabled, bool VTEnabled, bool flushLines) :
+        m_out(out, enabled, VTEnabled, flushLines) {}
 
     void OutputStream::AddFormat(const Sequence& sequence)
     {
@@ -85,12 +92,85 @@ namespace AppInstaller::CLI::Execution
         return *this;
     }
 
-    NoVTStream::NoVTStream(std::ostream& out, bool enabled) :
-        m_out(out, enabled, false) {}
+    NoVTStream::NoVTStream(std::ostream& out, bool enabled, bool flushLines) :
+        m_out(out, enabled, false, flushLines) {}
 
     NoVTStream& NoVTStream::operator<<(std::ostream& (__cdecl* f)(std::ostream&))
     {
         m_out << f;
         return *this;
     }
+
+    RedirectedOutputBuffer::RedirectedOutputBuffer(HANDLE output) :
+        m_output(output), m_buffer(BufferSize, '\0')
+    {
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    }
+
+    RedirectedOutputBuffer::~RedirectedOutputBuffer()
+    {
+        WriteBuffer();
+    }
+
+    bool RedirectedOutputBuffer::IsRedirected(HANDLE output)
+    {
+        if (output == nullptr || output == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        DWORD type = GetFileType(output);
+        return type == FILE_TYPE_DISK || type == FILE_TYPE_PIPE;
+    }
+
+    RedirectedOutputBuffer::int_type RedirectedOutputBuffer::overflow(int_type c)
+    {
+        if (!WriteBuffer())
+        {
+            return traits_type::eof();
+        }
+
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+
+        return traits_type::not_eof(c);
+    }
+
+    int RedirectedOutputBuffer::sync()
+    {
+        return WriteBuffer() ? 0 : -1;
+    }
+
+    bool RedirectedOutputBuffer::WriteBuffer()
+    {
+        m_translated.clear();
+        for (const char* current = pbase(); current != pptr(); ++current)
+        {
+            if (*current == '\n')
+            {
+                m_translated += '\r';
+            }
+            m_translated += *current;
+        }
+
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+
+        // A pipe may take only part of the output at a time
+        size_t offset = 0;
+        while (offset < m_translated.size())
+        {
+            DWORD written = 0;
+            if (!WriteFile(m_output, m_translated.data() + offset, static_cast<DWORD>(m_translated.size() - offset), &written, nullptr) || written == 0)
+            {
+                // The reader may have closed the pipe, in which case the rest of the output has nowhere to go
+                return false;
+            }
+            offset += written;
+        }
+
+        return true;
+    }
 }
@@ -7,6 +7,7 @@
 #include <winget/LocIndependent.h>
 
 #include <ostream>
+#include <streambuf>
 #include <string>
 
 
@@ -43,9 +44,10 @@ namespace AppInstaller::CLI::Execution
     }
 
     // The base stream for all channels.
+    // Without flushLines, std::endl ends the line without flushing it, so that the buffer of the stream decides when it is written.
     struct BaseStream
     {
-        BaseStream(std::ostream& out, bool enabled, bool VTEnabled);
+        BaseStream(std::ostream& out, bool enabled, bool VTEnabled, bool flushLines = true);
 
         template <typename T>
         BaseStream& operator<<(const T& t)
@@ -65,12 +67,13 @@ namespace AppInstaller::CLI::Execution
         std::ostream& m_out;
         bool m_enabled;
         bool m_VTEnabled;
+        bool m_flushLines;
     };
 
     // Holds output formatting information.
     struct OutputStream
     {
-        OutputStream(std::ostream& out, bool enabled, bool VTEnabled);
+        OutputStream(std::ostream& out, bool enabled, bool VTEnabled, bool flushLines = true);
 
         // Adds a format to the current value.
         void AddFormat(const VirtualTerminal::Sequence& sequence);
@@ -113,7 +116,7 @@ namespace AppInstaller::CLI::Execution
     // Does not allow VT at all.
     struct NoVTStream
     {
-        NoVTStream(std::ostream& out, bool enabled);
+        NoVTStream(std::ostream& out, bool enabled, bool flushLines = true);
 
         template <typename T>
         NoVTStream& operator<<(const T& t)
@@ -129,4 +132,37 @@ namespace AppInstaller::CLI::Execution
     private:
         BaseStream m_out;
     };
+
+    // A buffer for output that is not to a console, such as when it is redirected to a file or a pipe.
+    // Output is written to the handle when the buffer is full or is flushed, rather than through the synchronized
+    // stdio of std::cout; it is not synchronized, so it must only be written from one thread.
+    // Line endings are written as CRLF, as they are by std::cout in text mode.
+    struct RedirectedOutputBuffer : public std::streambuf
+    {
+        static constexpr size_t BufferSize = 64 * 1024;
+
+        RedirectedOutputBuffer(HANDLE output);
+        ~RedirectedOutputBuffer();
+
+        RedirectedOutputBuffer(const RedirectedOutputBuffer&) = delete;
+        RedirectedOutputBuffer& operator=(const RedirectedOutputBuffer&) = delete;
+
+        RedirectedOutputBuffer(RedirectedOutputBuffer&&) = delete;
+        RedirectedOutputBuffer& operator=(RedirectedOutputBuffer&&) = delete;
+
+        // Gets whether the handle is to a file or a pipe rather than to a console.
+        static bool IsRedirected(HANDLE output);
+
+    protected:
+        int_type overflow(int_type c) override;
+        int sync() override;
+
+    private:
+        // Writes the buffered output to the handle; returns false if it could not all be written.
+        bool WriteBuffer();
+
+        HANDLE m_output;
+        std::string m_buffer;
+        std::string m_translated;
+    };
 }
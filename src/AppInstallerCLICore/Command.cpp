@@ -11,6 +11,12 @@ namespace AppInstaller::CLI
     using namespace Utility::literals;
     using namespace Settings;
 
+    namespace
+    {
+        // The only output format for other tools; JSON Lines, one object per line.
+        constexpr std::string_view s_Command_OutputFormat_JsonLines = "jsonl"sv;
+    }
+
     Command::Command(std::string_view name, std::string_view parent, Command::Visibility visibility, ExperimentalFeature::Feature feature) :
         m_name(name), m_visibility(visibility), m_feature(feature)
     {
@@ -279,12 +285,77 @@ namespace AppInstaller::CLI
         throw CommandException(Resource::String::UnrecognizedCommand, *itr);
     }
 
+    struct ArgumentTable
+    {
+        ArgumentTable(std::vector<CLI::Argument> arguments) : Arguments(std::move(arguments)), DefinedCount(Arguments.size())
+        {
+            Argument::GetCommon(Arguments);
+
+            for (const auto& arg : Arguments)
+            {
+                size_t index = static_cast<unsigned char>(arg.Alias());
+
+                // The first argument with an alias takes it, as when the arguments were searched in order
+                if (arg.Alias() != Argument::NoAlias && index < m_aliases.size() && !m_aliases[index])
+                {
+                    m_aliases[index] = &arg;
+                }
+            }
+        }
+
+        // The table points into its arguments, so it is neither copied nor moved.
+        ArgumentTable(const ArgumentTable&) = delete;
+        ArgumentTable& operator=(const ArgumentTable&) = delete;
+
+        // Finds the argument with the given single character alias; returns nullptr if there is not one.
+        const CLI::Argument* FindByAlias(char alias) const
+        {
+            size_t index = static_cast<unsigned char>(alias);
+
+            if (alias == Argument::NoAlias)
+            {
+                return nullptr;
+            }
+            else if (index < m_aliases.size())
+            {
+                return m_aliases[index];
+            }
+
+            auto itr = std::find_if(Arguments.begin(), Arguments.end(), [&](const Argument& arg) { return (alias == arg.Alias()); });
+            return (itr == Arguments.end() ? nullptr : &*itr);
+        }
+
+        // Finds the argument with the given name; returns nullptr if there is not one.
+        const CLI::Argument* FindByName(std::string_view name) const
+        {
+            for (const auto& arg : Arguments)
+            {
+                if (Utility::CaseInsensitiveEquals(name, arg.Name()))
+                {
+                    return &arg;
+                }
+            }
+
+            return nullptr;
+        }
+
+        // The arguments defined by the command, followed by the common arguments.
+        std::vector<CLI::Argument> Arguments;
+
+        // The number of arguments defined by the command.
+        size_t DefinedCount;
+
+    private:
+        // The argument for each ASCII alias.
+        std::array<const CLI::Argument*, 128> m_aliases{};
+    };
+
     // The argument parsing state machine.
     // It is broken out to enable completion to process arguments, ignore errors,
     // and determine the likely state of the word to be completed.
     struct ParseArgumentsStateMachine
     {
-        ParseArgumentsStateMachine(Invocation& inv, Execution::Args& execArgs, std::vector<CLI::Argument> arguments);
+        ParseArgumentsStateMachine(Invocation& inv, Execution::Args& execArgs, const ArgumentTable& arguments);
 
         ParseArgumentsStateMachine(const ParseArgumentsStateMachine&) = delete;
         ParseArgumentsStateMachine& operator=(const ParseArgumentsStateMachine&) = delete;
@@ -330,7 +401,7 @@ namespace AppInstaller::CLI
         // Gets the next positional argument, or nullptr if there is not one.
         const CLI::Argument* NextPositional();
 
-        const std::vector<CLI::Argument>& Arguments() const { return m_arguments; }
+        const std::vector<CLI::Argument>& Arguments() const { return m_arguments.Arguments; }
 
     private:
         State StepInternal();
@@ -339,21 +410,21 @@ namespace AppInstaller::CLI
 
         Invocation& m_invocation;
         Execution::Args& m_executionArgs;
-        std::vector<CLI::Argument> m_arguments;
+        const ArgumentTable& m_arguments;
 
         Invocation::iterator m_invocationItr;
-        std::vector<CLI::Argument>::iterator m_positionalSearchItr;
+        std::vector<CLI::Argument>::const_iterator m_positionalSearchItr;
         bool m_onlyPositionalArgumentsRemain = false;
 
         State m_state;
     };
 
-    ParseArgumentsStateMachine::ParseArgumentsStateMachine(Invocation& inv, Execution::Args& execArgs, std::vector<CLI::Argument> arguments) :
+    ParseArgumentsStateMachine::ParseArgumentsStateMachine(Invocation& inv, Execution::Args& execArgs, const ArgumentTable& arguments) :
         m_invocation(inv),
         m_executionArgs(execArgs),
-        m_arguments(std::move(arguments)),
+        m_arguments(arguments),
         m_invocationItr(m_invocation.begin()),
-        m_positionalSearchItr(m_arguments.begin())
+        m_positionalSearchItr(m_arguments.Arguments.begin())
     {
     }
 
@@ -384,17 +455,17 @@ namespace AppInstaller::CLI
     const CLI::Argument* ParseArgumentsStateMachine::NextPositional()
     {
         // Find the next appropriate positional arg if the current itr isn't one or has hit its limit.
-        if (m_positionalSearchItr != m_arguments.end() &&
+        if (m_positionalSearchItr != m_arguments.Arguments.end() &&
             (m_positionalSearchItr->Type() != ArgumentType::Positional || m_executionArgs.GetCount(m_positionalSearchItr->ExecArgType()) == m_positionalSearchItr->Limit()))
         {
             do
             {
                 ++m_positionalSearchItr;
             }
-            while (m_positionalSearchItr != m_arguments.end() && m_positionalSearchItr->Type() != ArgumentType::Positional);
+            while (m_positionalSearchItr != m_arguments.Arguments.end() && m_positionalSearchItr->Type() != ArgumentType::Positional);
         }
 
-        if (m_positionalSearchItr == m_arguments.end())
+        if (m_positionalSearchItr == m_arguments.Arguments.end())
         {
             return nullptr;
         }
@@ -449,32 +520,32 @@ namespace AppInstaller::CLI
             // Parse the single character alias argument
             char currChar = currArg[1];
 
-            auto itr = std::find_if(m_arguments.begin(), m_arguments.end(), [&](const Argument& arg) { return (currChar == arg.Alias()); });
-            if (itr == m_arguments.end())
+            const CLI::Argument* arg = m_arguments.FindByAlias(currChar);
+            if (!arg)
             {
                 return CommandException(Resource::String::InvalidAliasError, currArg);
             }
 
-            if (itr->Type() == ArgumentType::Flag)
+            if (arg->Type() == ArgumentType::Flag)
             {
-                m_executionArgs.AddArg(itr->ExecArgType());
+                m_executionArgs.AddArg(arg->ExecArgType());
 
                 for (size_t i = 2; i < currArg.length(); ++i)
                 {
                     currChar = currArg[i];
 
-                    auto itr2 = std::find_if(m_arguments.begin(), m_arguments.end(), [&](const Argument& arg) { return (currChar == arg.Alias()); });
-                    if (itr2 == m_arguments.end())
+                    const CLI::Argument* adjoinedArg = m_arguments.FindByAlias(currChar);
+                    if (!adjoinedArg)
                     {
                         return CommandException(Resource::String::AdjoinedNotFoundError, currArg);
                     }
-                    else if (itr2->Type() != ArgumentType::Flag)
+                    else if (adjoinedArg->Type() != ArgumentType::Flag)
                     {
                         return CommandException(Resource::String::AdjoinedNotFlagError, currArg);
                     }
                     else
                     {
-                        m_executionArgs.AddArg(itr2->ExecArgType());
+                        m_executionArgs.AddArg(adjoinedArg->ExecArgType());
                     }
                 }
             }
@@ -482,7 +553,7 @@ namespace AppInstaller::CLI
             {
                 if (currArg[2] == APPINSTALLER_CLI_ARGUMENT_SPLIT_CHAR)
                 {
-                    ProcessAdjoinedValue(itr->ExecArgType(), currArg.substr(3));
+                    ProcessAdjoinedValue(arg->ExecArgType(), currArg.substr(3));
                 }
                 else
                 {
@@ -491,7 +562,7 @@ namespace AppInstaller::CLI
             }
             else
             {
-                return { itr->ExecArgType(), currArg };
+                return { arg->ExecArgType(), currArg };
             }
         }
         // The currentArg is at least 2 chars, both of which are --
@@ -505,7 +576,6 @@ namespace AppInstaller::CLI
             // This is an arg name, find it and process its value if needed.
             // Skip the double arg identifier chars.
             std::string_view argName = currArg.substr(2);
-            bool argFound = false;
 
             bool hasValue = false;
             std::string_view argValue;
@@ -517,35 +587,28 @@ namespace AppInstaller::CLI
                 argName = argName.substr(0, splitChar);
             }
 
-            for (const auto& arg : m_arguments)
+            const CLI::Argument* arg = m_arguments.FindByName(argName);
+            if (!arg)
             {
-                if (Utility::CaseInsensitiveEquals(argName, arg.Name()))
-                {
-                    if (arg.Type() == ArgumentType::Flag)
-                    {
-                        if (hasValue)
-                        {
-                            return CommandException(Resource::String::FlagContainAdjoinedError, currArg);
-                        }
+                return CommandException(Resource::String::InvalidNameError, currArg);
+            }
 
-                        m_executionArgs.AddArg(arg.ExecArgType());
-                    }
-                    else if (hasValue)
-                    {
-                        ProcessAdjoinedValue(arg.ExecArgType(), argValue);
-                    }
-                    else
-                    {
-                        return { arg.ExecArgType(), currArg };
-                    }
-                    argFound = true;
-                    break;
+            if (arg->Type() == ArgumentType::Flag)
+            {
+                if (hasValue)
+                {
+                    return CommandException(Resource::String::FlagContainAdjoinedError, currArg);
                 }
-            }
 
-            if (!argFound)
+                m_executionArgs.AddArg(arg->ExecArgType());
+            }
+            else if (hasValue)
             {
-                return CommandException(Resource::String::InvalidNameError, currArg);
+                ProcessAdjoinedValue(arg->ExecArgType(), argValue);
+            }
+            else
+            {
+                return { arg->ExecArgType(), currArg };
             }
         }
 
@@ -566,10 +629,7 @@ namespace AppInstaller::CLI
 
     void Command::ParseArguments(Invocation& inv, Execution::Args& execArgs) const
     {
-        auto definedArgs = GetArguments();
-        Argument::GetCommon(definedArgs);
-
-        ParseArgumentsStateMachine stateMachine{ inv, execArgs, std::move(definedArgs) };
+        ParseArgumentsStateMachine stateMachine{ inv, execArgs, GetArgumentTable() };
 
         while (stateMachine.Step())
         {
@@ -585,6 +645,13 @@ namespace AppInstaller::CLI
             return;
         }
 
+        // The value is checked here as the argument means the same for each command that has it
+        if (execArgs.Contains(Execution::Args::Type::Output) &&
+            !Utility::CaseInsensitiveEquals(execArgs.GetArg(Execution::Args::Type::Output), s_Command_OutputFormat_JsonLines))
+        {
+            throw CommandException(Resource::String::OutputFormatNotSupported, execArgs.GetArg(Execution::Args::Type::Output));
+        }
+
         ValidateArgumentsInternal(execArgs);
     }
 
@@ -610,10 +677,7 @@ namespace AppInstaller::CLI
         }
 
         // Consume what remains, if any, of the preceding values to determine what type the word is.
-        auto definedArgs = GetArguments();
-        Argument::GetCommon(definedArgs);
-
-        ParseArgumentsStateMachine stateMachine{ data.BeforeWord(), context.Args, std::move(definedArgs) };
+        ParseArgumentsStateMachine stateMachine{ data.BeforeWord(), context.Args, GetArgumentTable() };
 
         // We don't care if there are errors along the way, just do the best that can be done and try to
         // complete whatever would be next if the bad strings were simply ignored. To do that we just spin
@@ -670,7 +734,7 @@ namespace AppInstaller::CLI
         // To enable more complete scenarios, also attempt to parse any arguments after the word to complete.
         // This will allow these later values to affect the result of the completion (for instance, if a specific source is listed).
         {
-            ParseArgumentsStateMachine afterWordStateMachine{ data.AfterWord(), context.Args, stateMachine.Arguments() };
+            ParseArgumentsStateMachine afterWordStateMachine{ data.AfterWord(), context.Args, GetArgumentTable() };
             while (afterWordStateMachine.Step());
         }
 
@@ -695,14 +759,25 @@ namespace AppInstaller::CLI
         }
         else
         {
+            // Only the data is written, so that it can be read by other tools
+            if (context.Args.Contains(Execution::Args::Type::Output))
+            {
+                context.Reporter.SetChannel(Execution::Reporter::Channel::Data);
+            }
+
             ExecuteInternal(context);
         }
     }
 
     void Command::ValidateArgumentsInternal(Execution::Args& execArgs) const
     {
-        for (const auto& arg : GetArguments())
+        // The common arguments have nothing to validate
+        const ArgumentTable& table = GetArgumentTable();
+
+        for (size_t i = 0; i < table.DefinedCount; ++i)
         {
+            const auto& arg = table.Arguments[i];
+
             if (!ExperimentalFeature::IsEnabled(arg.Feature()) && execArgs.Contains(arg.ExecArgType()))
             {
                 auto feature = ExperimentalFeature::GetFeature(arg.Feature());
@@ -728,6 +803,16 @@ namespace AppInstaller::CLI
         THROW_HR(E_NOTIMPL);
     }
 
+    const ArgumentTable& Command::GetArgumentTable() const
+    {
+        if (!m_argumentTable)
+        {
+            m_argumentTable = std::make_shared<const ArgumentTable>(GetArguments());
+        }
+
+        return *m_argumentTable;
+    }
+
     Command::Visibility Command::GetVisibility() const
     {
         if (!ExperimentalFeature::IsEnabled(m_feature))
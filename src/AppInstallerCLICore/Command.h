@@ -33,6 +33,9 @@ namespace AppInstaller::CLI
         Utility::LocIndString m_param;
     };
 
+    // The arguments of a command as used by parsing, indexed for the lookups that it makes.
+    struct ArgumentTable;
+
     struct Command
     {
         // Controls the visibility of the field.
@@ -93,10 +96,15 @@ namespace AppInstaller::CLI
         virtual void ExecuteInternal(Execution::Context& context) const;
 
     private:
+        // Gets the arguments of the command along with the common arguments; they are only built on the first call,
+        // as parsing, validation and completion all need them.
+        const ArgumentTable& GetArgumentTable() const;
+
         std::string_view m_name;
         std::string m_fullName;
         Command::Visibility m_visibility;
         Settings::ExperimentalFeature::Feature m_feature;
+        mutable std::shared_ptr<const ArgumentTable> m_argumentTable;
     };
 
     template <typename Container>
@@ -0,0 +1,146 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "BatchCommand.h"
+#include "SourceCommand.h"
+#include "Core.h"
+#include "Resources.h"
+#include "Workflows/WorkflowBase.h"
+#include <winget/MemoryBudget.h>
+
+namespace AppInstaller::CLI
+{
+    using namespace std::string_view_literals;
+    using namespace Utility::literals;
+
+    namespace
+    {
+        constexpr std::string_view s_ProgramName = "winget"sv;
+        constexpr char s_CommentChar = '#';
+        constexpr std::string_view s_Utf8ByteOrderMark = "\xEF\xBB\xBF"sv;
+
+        // Splits a line of the batch file into arguments as the command line of the process would be split.
+        // The line may start with the program name, so that lines can be copied from a script unchanged.
+        std::vector<std::string> SplitCommandLine(const std::string& line)
+        {
+            // The first argument of a command line is parsed as a program name, which does not follow the same rules
+            std::wstring commandLine = Utility::ConvertToUTF16(s_ProgramName) + L" " + Utility::ConvertToUTF16(line);
+
+            int argc = 0;
+            wil::unique_hlocal_ptr<LPWSTR> argv{ CommandLineToArgvW(commandLine.c_str(), &argc) };
+            THROW_LAST_ERROR_IF_NULL(argv);
+
+            std::vector<std::string> result;
+            for (int i = 1; i < argc; ++i)
+            {
+                result.emplace_back(Utility::ConvertToUTF8(argv.get()[i]));
+            }
+
+            if (!result.empty() && Utility::CaseInsensitiveEquals(result.front(), s_ProgramName))
+            {
+                result.erase(result.begin());
+            }
+
+            return result;
+        }
+
+        void ExecuteBatchFile(Execution::Context& context)
+        {
+            std::ifstream stream{ Utility::ConvertToUTF16(context.Args.GetArg(Execution::Args::Type::BatchFile)) };
+            THROW_LAST_ERROR_IF(stream.fail());
+
+            // Every command line opens its sources from this, so that each source is only opened once
+            auto sharedSources = std::make_shared<Execution::Context::SharedSources>();
+
+            // The searches of every command line are summarized in one event once the batch completes
+            Logging::AggregateTelemetryScope aggregateTelemetry;
+
+            // The shared sources keep their caches from line to line, so they are trimmed when memory runs low
+            Memory::LowMemoryMonitor lowMemoryMonitor;
+
+            std::string line;
+            for (size_t lineNumber = 1; std::getline(stream, line) && !context.IsTerminated(); ++lineNumber)
+            {
+                if (lineNumber == 1 && line.compare(0, s_Utf8ByteOrderMark.size(), s_Utf8ByteOrderMark) == 0)
+                {
+                    line.erase(0, s_Utf8ByteOrderMark.size());
+                }
+
+                Utility::Trim(line);
+                if (line.empty() || line[0] == s_CommentChar)
+                {
+                    continue;
+                }
+
+                std::vector<std::string> utf8Args = SplitCommandLine(line);
+                if (utf8Args.empty())
+                {
+                    continue;
+                }
+
+                if (Utility::CaseInsensitiveEquals(utf8Args.front(), BatchCommand::CommandName))
+                {
+                    context.Reporter.Error() << Resource::String::BatchNestedNotSupported << ' ' << lineNumber << std::endl;
+                    AICLI_TERMINATE_CONTEXT(APPINSTALLER_CLI_ERROR_INVALID_CL_ARGUMENTS);
+                }
+
+                // Changes to the sources need the sources to be closed, and the changed sources to be opened again
+                if (Utility::CaseInsensitiveEquals(utf8Args.front(), SourceCommand::CommandName))
+                {
+                    sharedSources->clear();
+                }
+
+                AICLI_LOG(CLI, Info, << "Executing line " << lineNumber << " of the batch");
+                context.Reporter.Info() << "> "_liv << Utility::LocIndView{ line } << std::endl;
+
+                // Each command line starts from the state that a new process would have
+                Logging::Log().SetLevel(Logging::Level::Verbose);
+                Logging::ResetPerformanceCounters();
+
+                Execution::Context lineContext = context.Clone();
+                lineContext.EnableCtrlHandler();
+                lineContext.ShareSources(sharedSources);
+
+                int result = ExecuteCommandLine(lineContext, std::move(utf8Args));
+
+                // What the line left in the caches is trimmed to the budget before the next one
+                Memory::MemoryBudget::Instance().TrimIfOverBudget();
+
+                if (result != 0)
+                {
+                    context.Reporter.Error() << Resource::String::BatchLineFailed << ' ' << lineNumber << std::endl;
+                    AICLI_TERMINATE_CONTEXT(result);
+                }
+            }
+        }
+    }
+
+    std::vector<Argument> BatchCommand::GetArguments() const
+    {
+        return {
+            Argument::ForType(Execution::Args::Type::BatchFile),
+        };
+    }
+
+    Resource::LocString BatchCommand::ShortDescription() const
+    {
+        return { Resource::String::BatchCommandShortDescription };
+    }
+
+    Resource::LocString BatchCommand::LongDescription() const
+    {
+        return { Resource::String::BatchCommandLongDescription };
+    }
+
+    std::string BatchCommand::HelpLink() const
+    {
+        return "https://aka.ms/winget-settings";
+    }
+
+    void BatchCommand::ExecuteInternal(Execution::Context& context) const
+    {
+        context <<
+            Workflow::VerifyFile(Execution::Args::Type::BatchFile) <<
+            ExecuteBatchFile;
+    }
+}
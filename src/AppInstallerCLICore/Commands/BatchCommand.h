@@ -0,0 +1,26 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Command.h"
+#include <winget/UserSettings.h>
+
+namespace AppInstaller::CLI
+{
+    // Command to run the command lines in a file within this process, so that they share the sources that they open.
+    struct BatchCommand final : public Command
+    {
+        static constexpr std::string_view CommandName = "batch";
+
+        BatchCommand(std::string_view parent) : Command(CommandName, parent, Settings::ExperimentalFeature::Feature::Batch) {}
+
+        std::vector<Argument> GetArguments() const override;
+
+        Resource::LocString ShortDescription() const override;
+        Resource::LocString LongDescription() const override;
+
+        std::string HelpLink() const override;
+
+    protected:
+        void ExecuteInternal(Execution::Context& context) const override;
+    };
+}
@@ -35,34 +35,39 @@ namespace AppInstaller::CLI
         return "https://aka.ms/winget-command-complete";
     }
 
-    void CompleteCommand::ExecuteInternal(Execution::Context& context) const
+    void CompleteCommand::CompleteCommandLine(const Execution::Args& args, Execution::Context& context)
     {
-        try
+        CompletionData data{
+            args.GetArg(Args::Type::Word),
+            args.GetArg(Args::Type::CommandLine),
+            args.GetArg(Args::Type::Position) };
+
+        std::unique_ptr<Command> command = std::make_unique<RootCommand>();
+
+        std::unique_ptr<Command> subCommand = command->FindSubCommand(data.BeforeWord());
+        while (subCommand)
         {
-            CompletionData data{
-                context.Args.GetArg(Args::Type::Word),
-                context.Args.GetArg(Args::Type::CommandLine),
-                context.Args.GetArg(Args::Type::Position) };
+            command = std::move(subCommand);
+            subCommand = command->FindSubCommand(data.BeforeWord());
+        }
+
+        context.Reporter.SetChannel(Execution::Reporter::Channel::Completion);
+        context.Add<Data::CompletionData>(std::move(data));
 
-            std::unique_ptr<Command> command = std::make_unique<RootCommand>();
+        // Disable all telemetry while doing a completion
+        Logging::DisableTelemetryScope disable;
 
-            std::unique_ptr<Command> subCommand = command->FindSubCommand(data.BeforeWord());
-            while (subCommand)
-            {
-                command = std::move(subCommand);
-                subCommand = command->FindSubCommand(data.BeforeWord());
-            }
+        AICLI_LOG(CLI, Info, << "Complete handing off to command " << command->FullName());
+        command->Complete(context);
+    }
 
+    void CompleteCommand::ExecuteInternal(Execution::Context& context) const
+    {
+        try
+        {
             // Create a new Context to execute the Complete from
             Context subContext = context.Clone();
-            subContext.Reporter.SetChannel(Execution::Reporter::Channel::Completion);
-            subContext.Add<Data::CompletionData>(std::move(data));
-
-            // Disable all telemetry while doing a completion
-            Logging::DisableTelemetryScope disable;
-
-            AICLI_LOG(CLI, Info, << "Complete handing off to command " << command->FullName());
-            command->Complete(subContext);
+            CompleteCommandLine(context.Args, subContext);
         }
         catch (const CommandException& ce)
         {
@@ -9,7 +9,12 @@ namespace AppInstaller::CLI
     // be context sensitive in their data output.
     struct CompleteCommand final : public Command
     {
-        CompleteCommand(std::string_view parent) : Command("complete", parent, Visibility::Hidden) {}
+        static constexpr std::string_view CommandName = "complete";
+
+        CompleteCommand(std::string_view parent) : Command(CommandName, parent, Visibility::Hidden) {}
+
+        // Completes the word of the command line given in the arguments of this command, writing the values to the given context.
+        static void CompleteCommandLine(const Execution::Args& args, Execution::Context& context);
 
         std::vector<Argument> GetArguments() const override;
 
@@ -4,17 +4,159 @@
 #include "HashCommand.h"
 #include "Workflows/WorkflowBase.h"
 #include "Resources.h"
+#include <winget/ManifestValidation.h>
 
 namespace AppInstaller::CLI
 {
     using namespace std::string_view_literals;
     using namespace Utility::literals;
 
+    namespace
+    {
+        // Gets the files to hash from the inputs, which can be files or directories.
+        // Directories are searched recursively; returns false if an input does not exist.
+        bool GetFilesToHash(Execution::Context& context, std::vector<std::filesystem::path>& files)
+        {
+            for (const auto& input : *context.Args.GetArgs(Execution::Args::Type::HashFile))
+            {
+                std::filesystem::path path = Utility::ConvertToUTF16(input);
+
+                if (std::filesystem::is_directory(path))
+                {
+                    for (const auto& entry : std::filesystem::recursive_directory_iterator(path))
+                    {
+                        if (entry.is_regular_file())
+                        {
+                            files.emplace_back(entry.path());
+                        }
+                    }
+                }
+                else if (std::filesystem::exists(path))
+                {
+                    files.emplace_back(std::move(path));
+                }
+                else
+                {
+                    context.Reporter.Error() << "File does not exist: " << path.u8string() << std::endl;
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        std::string GetSignatureHash(const std::filesystem::path& path)
+        {
+            Msix::MsixInfo msixInfo{ path.u8string() };
+            auto signature = msixInfo.GetSignature();
+            return Utility::SHA256::ConvertToString(Utility::SHA256::ComputeHash(signature.data(), static_cast<uint32_t>(signature.size())));
+        }
+
+        // Gets the size of the chunks of the chunked hash, or zero if it is not wanted.
+        uint64_t GetChunkSize(Execution::Context& context)
+        {
+            return context.Args.Contains(Execution::Args::Type::ChunkSize) ? std::stoull(std::string{ context.Args.GetArg(Execution::Args::Type::ChunkSize) }) : 0;
+        }
+
+        // Hashes the files on as many threads as there are processors, writing a line for each one as it completes:
+        //  <sha256>  <path>
+        //  <sha256>  <chunked sha256>  <path>    (with --chunk-size)
+        //  <sha256>  <signature sha256>  <path>  (with --msix; the chunked hash comes before the signature hash when both are given)
+        void HashFilesInParallel(Execution::Context& context, const std::vector<std::filesystem::path>& files)
+        {
+            bool msix = context.Args.Contains(Execution::Args::Type::Msix);
+            uint64_t chunkSize = GetChunkSize(context);
+            size_t threadCount = std::min<size_t>(std::max<size_t>(std::thread::hardware_concurrency(), 1), files.size());
+
+            AICLI_LOG(CLI, Info, << "Hashing " << files.size() << " files on " << threadCount << " threads");
+
+            std::atomic<size_t> nextFile = 0;
+            std::mutex outputLock;
+            HRESULT firstError = S_OK;
+
+            auto hashThread = [&]()
+            {
+                for (size_t index = nextFile++; index < files.size() && !context.IsTerminated(); index = nextFile++)
+                {
+                    const auto& path = files[index];
+                    std::string hash;
+                    std::string chunkedHash;
+                    std::string signatureHash;
+                    HRESULT error = S_OK;
+
+                    try
+                    {
+                        hash = Utility::SHA256::ConvertToString(Utility::SHA256::ComputeHashFromFile(path));
+
+                        if (chunkSize > 0)
+                        {
+                            chunkedHash = Utility::SHA256::ConvertToString(Utility::ChunkedSHA256::ComputeHashFromFile(path, chunkSize));
+                        }
+
+                        if (msix)
+                        {
+                            signatureHash = GetSignatureHash(path);
+                        }
+                    }
+                    catch (...)
+                    {
+                        error = LOG_CAUGHT_EXCEPTION();
+                    }
+
+                    std::lock_guard<std::mutex> lock{ outputLock };
+
+                    if (FAILED(error))
+                    {
+                        if (SUCCEEDED(firstError))
+                        {
+                            firstError = error;
+                        }
+
+                        context.Reporter.Warn() << (hash.empty() ? Resource::String::HashFileFailed : Resource::String::MsixSignatureHashFailed) << ' ' << path.u8string() << std::endl;
+                        continue;
+                    }
+
+                    auto info = context.Reporter.Info();
+                    info << Utility::LocIndString{ hash } << "  "_liv;
+                    if (chunkSize > 0)
+                    {
+                        info << Utility::LocIndString{ chunkedHash } << "  "_liv;
+                    }
+                    if (msix)
+                    {
+                        info << Utility::LocIndString{ signatureHash } << "  "_liv;
+                    }
+                    info << Utility::LocIndString{ path.u8string() } << std::endl;
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for (size_t i = 1; i < threadCount; ++i)
+            {
+                threads.emplace_back(hashThread);
+            }
+
+            // This thread does its share of the work too
+            hashThread();
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            if (FAILED(firstError))
+            {
+                AICLI_TERMINATE_CONTEXT(firstError);
+            }
+        }
+    }
+
     std::vector<Argument> HashCommand::GetArguments() const
     {
         return {
-            Argument::ForType(Execution::Args::Type::HashFile),
+            Argument::ForType(Execution::Args::Type::HashFile).SetCountLimit(std::numeric_limits<size_t>::max()),
             Argument::ForType(Execution::Args::Type::Msix),
+            Argument::ForType(Execution::Args::Type::ChunkSize),
         };
     }
 
@@ -33,16 +175,49 @@ namespace AppInstaller::CLI
         return "https://aka.ms/winget-command-hash";
     }
 
+    void HashCommand::ValidateArgumentsInternal(Execution::Args& execArgs) const
+    {
+        if (execArgs.Contains(Execution::Args::Type::ChunkSize) &&
+            !Manifest::FieldValidators::IsChunkSize(execArgs.GetArg(Execution::Args::Type::ChunkSize)))
+        {
+            throw CommandException(Resource::String::InvalidChunkSizeError, Argument::ForType(Execution::Args::Type::ChunkSize).Name());
+        }
+    }
+
     void HashCommand::ExecuteInternal(Execution::Context& context) const
     {
+        // Several files, or a directory, are hashed concurrently with a line of output for each file.
+        if (context.Args.GetCount(Execution::Args::Type::HashFile) > 1 ||
+            std::filesystem::is_directory(Utility::ConvertToUTF16(context.Args.GetArg(Execution::Args::Type::HashFile))))
+        {
+            std::vector<std::filesystem::path> files;
+            if (!GetFilesToHash(context, files))
+            {
+                AICLI_TERMINATE_CONTEXT(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+            }
+
+            HashFilesInParallel(context, files);
+            return;
+        }
+
         context <<
             Workflow::VerifyFile(Execution::Args::Type::HashFile) <<
             [](Execution::Context& context)
         {
             auto inputFile = context.Args.GetArg(Execution::Args::Type::HashFile);
-            std::ifstream inStream{ Utility::ConvertToUTF16(inputFile), std::ifstream::binary };
+            auto hash = Utility::SHA256::ComputeHashFromFile(Utility::ConvertToUTF16(inputFile));
+
+            context.Reporter.Info() << "Sha256: "_liv << Utility::LocIndString{ Utility::SHA256::ConvertToString(hash) } << std::endl;
 
-            context.Reporter.Info() << "Sha256: "_liv << Utility::LocIndString{ Utility::SHA256::ConvertToString(Utility::SHA256::ComputeHash(inStream)) } << std::endl;
+            // Written as the fields of the installer in the manifest
+            uint64_t chunkSize = GetChunkSize(context);
+            if (chunkSize > 0)
+            {
+                auto chunkedHash = Utility::ChunkedSHA256::ComputeHashFromFile(Utility::ConvertToUTF16(inputFile), chunkSize);
+
+                context.Reporter.Info() << "ChunkedSha256: "_liv << Utility::LocIndString{ Utility::SHA256::ConvertToString(chunkedHash) } << std::endl;
+                context.Reporter.Info() << "ChunkSize: "_liv << Utility::LocIndString{ std::to_string(chunkSize) } << std::endl;
+            }
 
             if (context.Args.Contains(Execution::Args::Type::Msix))
             {
@@ -20,7 +20,7 @@ namespace AppInstaller::CLI
     std::vector<Argument> InstallCommand::GetArguments() const
     {
         return {
-            Argument::ForType(Args::Type::Query),
+            Argument::ForType(Args::Type::Query).SetCountLimit(std::numeric_limits<size_t>::max()),
             Argument::ForType(Args::Type::Manifest),
             Argument::ForType(Args::Type::Id),
             Argument::ForType(Args::Type::Name),
@@ -84,11 +84,20 @@ namespace AppInstaller::CLI
 
     void InstallCommand::ExecuteInternal(Execution::Context& context) const
     {
+        if (context.Args.GetCount(Execution::Args::Type::Query) > 1)
+        {
+            context <<
+                Workflow::InstallMultiplePackages;
+            return;
+        }
+
         context <<
             Workflow::GetManifest <<
             Workflow::EnsureMinOSVersion <<
             Workflow::SelectInstaller <<
             Workflow::EnsureApplicableInstaller <<
+            // The installer downloads while the disclaimer is shown
+            Workflow::StartInstallerDownload <<
             Workflow::ShowInstallationDisclaimer <<
             Workflow::DownloadInstaller <<
             Workflow::ExecuteInstaller <<
@@ -101,5 +110,26 @@ namespace AppInstaller::CLI
         {
             throw CommandException(Resource::String::TooManyBehaviorsError, s_InstallCommand_ArgName_SilentAndInteractive);
         }
+
+        // These select or install a single package, so they have no meaning for several queries
+        if (execArgs.GetCount(Execution::Args::Type::Query) > 1)
+        {
+            for (auto type : {
+                Execution::Args::Type::Manifest,
+                Execution::Args::Type::Id,
+                Execution::Args::Type::Name,
+                Execution::Args::Type::Moniker,
+                Execution::Args::Type::Version,
+                Execution::Args::Type::Channel,
+                Execution::Args::Type::Log,
+                Execution::Args::Type::Override,
+                Execution::Args::Type::InstallLocation })
+            {
+                if (execArgs.Contains(type))
+                {
+                    throw CommandException(Resource::String::MultipleInstallArgumentNotSupported, Argument::ForType(type).Name());
+                }
+            }
+        }
     }
 }
@@ -13,6 +13,9 @@
 #include "FeaturesCommand.h"
 #include "ExperimentalCommand.h"
 #include "CompleteCommand.h"
+#include "ServerCommand.h"
+#include "BatchCommand.h"
+#include "UpgradeCommand.h"
 
 #include "Resources.h"
 #include "TableOutput.h"
@@ -34,6 +37,9 @@ namespace AppInstaller::CLI
             std::make_unique<FeaturesCommand>(FullName()),
             std::make_unique<ExperimentalCommand>(FullName()),
             std::make_unique<CompleteCommand>(FullName()),
+            std::make_unique<ServerCommand>(FullName()),
+            std::make_unique<BatchCommand>(FullName()),
+            std::make_unique<UpgradeCommand>(FullName()),
         });
     }
 
@@ -23,6 +23,8 @@ namespace AppInstaller::CLI
             Argument::ForType(Execution::Args::Type::Source),
             Argument::ForType(Execution::Args::Type::Count),
             Argument::ForType(Execution::Args::Type::Exact),
+            Argument::ForType(Execution::Args::Type::IdFile),
+            Argument::ForType(Execution::Args::Type::Output),
         };
     }
 
@@ -66,10 +68,43 @@ namespace AppInstaller::CLI
 
     void SearchCommand::ExecuteInternal(Context& context) const
     {
+        if (context.Args.Contains(Execution::Args::Type::IdFile))
+        {
+            context <<
+                Workflow::OpenSource <<
+                Workflow::SearchSourceForIds <<
+                Workflow::EnsureMatchesFromSearchResult <<
+                Workflow::ReportSearchResult;
+            return;
+        }
+
         context <<
             Workflow::OpenSource <<
             Workflow::SearchSourceForMany <<
             Workflow::EnsureMatchesFromSearchResult <<
             Workflow::ReportSearchResult;
     }
+
+    void SearchCommand::ValidateArgumentsInternal(Execution::Args& execArgs) const
+    {
+        // The ids are all found exactly, so there is nothing for the query or the filters to do
+        if (execArgs.Contains(Execution::Args::Type::IdFile))
+        {
+            for (auto type : {
+                Execution::Args::Type::Query,
+                Execution::Args::Type::Id,
+                Execution::Args::Type::Name,
+                Execution::Args::Type::Moniker,
+                Execution::Args::Type::Tag,
+                Execution::Args::Type::Command,
+                Execution::Args::Type::Count,
+                Execution::Args::Type::Exact })
+            {
+                if (execArgs.Contains(type))
+                {
+                    throw CommandException(Resource::String::IdFileArgumentNotSupported, Argument::ForType(type).Name());
+                }
+            }
+        }
+    }
 }
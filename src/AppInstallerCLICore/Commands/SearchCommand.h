@@ -20,5 +20,6 @@ namespace AppInstaller::CLI
 
     protected:
         void ExecuteInternal(Execution::Context& context) const override;
+        void ValidateArgumentsInternal(Execution::Args& execArgs) const override;
     };
 }
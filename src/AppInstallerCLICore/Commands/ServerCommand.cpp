@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "ServerCommand.h"
+#include "Core.h"
+#include "Resources.h"
+#include "Server.h"
+#include <winget/MemoryBudget.h>
+
+using namespace std::chrono_literals;
+
+namespace AppInstaller::CLI
+{
+    namespace
+    {
+        // The server stops once it has received no command line for this long, releasing what it holds.
+        constexpr std::chrono::milliseconds s_ServerIdleTimeout = 10min;
+    }
+
+    Resource::LocString ServerCommand::ShortDescription() const
+    {
+        return { Resource::String::ServerCommandShortDescription };
+    }
+
+    Resource::LocString ServerCommand::LongDescription() const
+    {
+        return { Resource::String::ServerCommandLongDescription };
+    }
+
+    std::string ServerCommand::HelpLink() const
+    {
+        return "https://aka.ms/winget-settings";
+    }
+
+    void ServerCommand::ExecuteInternal(Execution::Context& context) const
+    {
+        std::wstring pipeName = Server::GetPipeName();
+        context.Reporter.Info() << Resource::String::ServerListening << ' ' << Utility::ConvertToUTF8(pipeName) << std::endl;
+
+        // The searches of every command line are summarized in one event once the server stops
+        Logging::AggregateTelemetryScope aggregateTelemetry;
+
+        // A server that waits for its next command line gives its caches back when the system runs low on memory
+        Memory::LowMemoryMonitor lowMemoryMonitor;
+
+        Server::Run(context, s_ServerIdleTimeout, [](Execution::Context& requestContext, std::vector<std::string> utf8Args)
+            {
+                // Each command line starts from the state that a new process would have
+                Logging::Log().SetLevel(Logging::Level::Verbose);
+                Logging::ResetPerformanceCounters();
+
+                return ExecuteCommandLine(requestContext, std::move(utf8Args));
+            }, pipeName);
+    }
+}
@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Command.h"
+#include <winget/UserSettings.h>
+
+namespace AppInstaller::CLI
+{
+    // Command to run the server that executes the command lines of other winget processes of the same user.
+    struct ServerCommand final : public Command
+    {
+        // The command line of the server itself is never sent to a server.
+        static constexpr std::string_view CommandName = "server";
+
+        ServerCommand(std::string_view parent) : Command(CommandName, parent, Visibility::Hidden, Settings::ExperimentalFeature::Feature::ServerMode) {}
+
+        Resource::LocString ShortDescription() const override;
+        Resource::LocString LongDescription() const override;
+
+        std::string HelpLink() const override;
+
+    protected:
+        void ExecuteInternal(Execution::Context& context) const override;
+    };
+}
@@ -51,6 +51,7 @@ namespace AppInstaller::CLI
             Argument::ForType(Args::Type::SourceName).SetRequired(true),
             Argument::ForType(Args::Type::SourceArg),
             Argument::ForType(Args::Type::SourceType),
+            Argument::ForType(Args::Type::SourceMirror).SetCountLimit(std::numeric_limits<size_t>::max()),
         };
     }
 
@@ -120,6 +121,7 @@ namespace AppInstaller::CLI
     {
         return {
             Argument::ForType(Args::Type::SourceName),
+            Argument::ForType(Args::Type::SourceScheduled),
         };
     }
 
@@ -149,9 +151,19 @@ namespace AppInstaller::CLI
 
     void SourceUpdateCommand::ExecuteInternal(Context& context) const
     {
-        context <<
-            Workflow::GetSourceListWithFilter <<
-            Workflow::UpdateSources;
+        if (context.Args.Contains(Args::Type::SourceScheduled))
+        {
+            context <<
+                Workflow::GetSourceListWithFilter <<
+                Workflow::UpdateSourcesInBackground;
+        }
+        else
+        {
+            context <<
+                Workflow::GetSourceListWithFilter <<
+                Workflow::UpdateSources <<
+                Workflow::UpdateScheduledSourceUpdateTask;
+        }
     }
 
     std::vector<Argument> SourceRemoveCommand::GetArguments() const
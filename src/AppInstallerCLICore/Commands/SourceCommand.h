@@ -7,7 +7,9 @@ namespace AppInstaller::CLI
 {
     struct SourceCommand final : public Command
     {
-        SourceCommand(std::string_view parent) : Command("source", parent) {}
+        static constexpr std::string_view CommandName = "source";
+
+        SourceCommand(std::string_view parent) : Command(CommandName, parent) {}
 
         std::vector<std::unique_ptr<Command>> GetCommands() const override;
 
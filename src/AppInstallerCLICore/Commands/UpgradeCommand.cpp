@@ -0,0 +1,91 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "UpgradeCommand.h"
+#include "Workflows/CompletionFlow.h"
+#include "Workflows/UpgradeFlow.h"
+#include "Workflows/WorkflowBase.h"
+#include "Resources.h"
+
+namespace AppInstaller::CLI
+{
+    using namespace AppInstaller::CLI::Execution;
+    using namespace std::string_view_literals;
+
+    constexpr std::string_view s_UpgradeCommand_ArgName_SilentAndInteractive = "silent|interactive"sv;
+    constexpr std::string_view s_UpgradeCommand_ArgName_AllAndOutput = "all|output"sv;
+
+    std::vector<Argument> UpgradeCommand::GetArguments() const
+    {
+        return {
+            Argument::ForType(Args::Type::Source),
+            Argument::ForType(Args::Type::All),
+            Argument::ForType(Args::Type::Interactive),
+            Argument::ForType(Args::Type::Silent),
+            Argument::ForType(Args::Type::Output),
+        };
+    }
+
+    Resource::LocString UpgradeCommand::ShortDescription() const
+    {
+        return { Resource::String::UpgradeCommandShortDescription };
+    }
+
+    Resource::LocString UpgradeCommand::LongDescription() const
+    {
+        return { Resource::String::UpgradeCommandLongDescription };
+    }
+
+    void UpgradeCommand::Complete(Execution::Context& context, Execution::Args::Type valueType) const
+    {
+        if (valueType == Execution::Args::Type::Source)
+        {
+            context <<
+                Workflow::CompleteWithSingleSemanticsForValue(valueType);
+        }
+    }
+
+    std::string UpgradeCommand::HelpLink() const
+    {
+        return "https://aka.ms/winget-command-upgrade";
+    }
+
+    void UpgradeCommand::ExecuteInternal(Execution::Context& context) const
+    {
+        context <<
+            Workflow::OpenSource <<
+            Workflow::FindUpgrades <<
+            Workflow::ReportUpgrades;
+
+        if (context.IsTerminated() || context.Get<Execution::Data::Upgrades>().empty())
+        {
+            return;
+        }
+
+        if (!context.Args.Contains(Execution::Args::Type::All))
+        {
+            if (!context.Args.Contains(Execution::Args::Type::Output))
+            {
+                context.Reporter.Info() << Resource::String::UpgradeUseAllHint << std::endl;
+            }
+            return;
+        }
+
+        context <<
+            Workflow::InstallUpgrades;
+    }
+
+    void UpgradeCommand::ValidateArgumentsInternal(Execution::Args& execArgs) const
+    {
+        if (execArgs.Contains(Execution::Args::Type::Silent) && execArgs.Contains(Execution::Args::Type::Interactive))
+        {
+            throw CommandException(Resource::String::TooManyBehaviorsError, s_UpgradeCommand_ArgName_SilentAndInteractive);
+        }
+
+        // The output of the installs would not be in the format that was asked for
+        if (execArgs.Contains(Execution::Args::Type::All) && execArgs.Contains(Execution::Args::Type::Output))
+        {
+            throw CommandException(Resource::String::TooManyBehaviorsError, s_UpgradeCommand_ArgName_AllAndOutput);
+        }
+    }
+}
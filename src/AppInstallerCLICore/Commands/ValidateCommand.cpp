@@ -4,6 +4,7 @@
 #include "ValidateCommand.h"
 #include "Workflows/WorkflowBase.h"
 #include "Resources.h"
+#include <winget/ManifestDirectoryValidation.h>
 
 namespace AppInstaller::CLI
 {
@@ -13,6 +14,7 @@ namespace AppInstaller::CLI
     {
         return {
             Argument::ForType(Execution::Args::Type::ValidateManifest),
+            Argument::ForType(Execution::Args::Type::ValidationCache),
         };
     }
 
@@ -33,34 +35,61 @@ namespace AppInstaller::CLI
 
     void ValidateCommand::ExecuteInternal(Execution::Context& context) const
     {
+        std::shared_ptr<Manifest::ManifestValidationCache> cache;
+        if (context.Args.Contains(Execution::Args::Type::ValidationCache))
+        {
+            cache = std::make_shared<Manifest::ManifestValidationCache>(Utility::ConvertToUTF16(context.Args.GetArg(Execution::Args::Type::ValidationCache)));
+        }
+
+        // A directory of manifests is validated concurrently, with the results of all of them written as JSON.
+        std::filesystem::path inputPath = Utility::ConvertToUTF16(context.Args.GetArg(Execution::Args::Type::ValidateManifest));
+        if (std::filesystem::is_directory(inputPath))
+        {
+            auto results = Manifest::ValidateManifestsInDirectory(inputPath, cache.get());
+            if (cache)
+            {
+                cache->Save();
+            }
+
+            context.Reporter.Info() << Utility::LocIndString{ Manifest::ConvertToJson(results) } << std::endl;
+
+            HRESULT hr = Manifest::GetCombinedResult(results);
+            if (hr != S_OK)
+            {
+                AICLI_TERMINATE_CONTEXT(hr);
+            }
+            return;
+        }
+
         context <<
             Workflow::VerifyFile(Execution::Args::Type::ValidateManifest) <<
-            [](Execution::Context& context)
+            [cache](Execution::Context& context)
         {
             auto inputFile = Utility::ConvertToUTF16(context.Args.GetArg(Execution::Args::Type::ValidateManifest));
 
-            try
+            Manifest::ManifestValidationResult result = Manifest::ValidateManifestFile(inputFile, cache.get());
+            if (cache)
             {
-                (void)Manifest::YamlParser::CreateFromPath(inputFile, true, true);
-                context.Reporter.Info() << Resource::String::ManifestValidationSuccess << std::endl;
+                cache->Save();
             }
-            catch (const Manifest::ManifestException& e)
+
+            if (result.Result == S_OK)
             {
-                HRESULT hr = S_OK;
-                if (e.IsWarningOnly())
-                {
-                    context.Reporter.Warn() << Resource::String::ManifestValidationWarning << std::endl;
-                    hr = APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_WARNING;
-                }
-                else
-                {
-                    context.Reporter.Error() << Resource::String::ManifestValidationFail << std::endl;
-                    hr = APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_FAILURE;
-                }
+                context.Reporter.Info() << Resource::String::ManifestValidationSuccess << std::endl;
+                return;
+            }
 
-                context.Reporter.Info() << e.GetManifestErrorMessage() << std::endl;
-                AICLI_TERMINATE_CONTEXT(hr);
+            if (result.Result == APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_WARNING)
+            {
+                context.Reporter.Warn() << Resource::String::ManifestValidationWarning << std::endl;
             }
+            else
+            {
+                context.Reporter.Error() << Resource::String::ManifestValidationFail << std::endl;
+            }
+
+            context.Reporter.Info() << result.Message << std::endl;
+            AICLI_TERMINATE_CONTEXT(result.Result);
         };
     }
 }
@@ -37,8 +37,11 @@ namespace AppInstaller::CLI
 
         AICLI_LOG(CLI, Info, << "Cursor position moved to '" << cursor << '\'');
 
-        std::vector<std::string> argsBeforeWord;
-        std::vector<std::string> argsAfterWord;
+        m_commandLine.assign(commandLine.begin(), commandLine.end());
+        char* line = m_commandLine.data();
+
+        std::vector<std::string_view> argsBeforeWord;
+        std::vector<std::string_view> argsAfterWord;
 
         // If the word is empty, we must determine where the split is. We operate as PowerShell does; the cursor
         // being at the front of a token results in an empty word and an insertion rather than a replacement.
@@ -51,7 +54,7 @@ namespace AppInstaller::CLI
             if (cursor >= commandLine.length())
             {
                 // Move the position to the end in case it was extended past it.
-                ParseInto(commandLine, argsBeforeWord, true);
+                ParseInto(line, m_commandLine.size(), argsBeforeWord, true);
             }
             // The cursor is not past the end; ensure that the preceding character is whitespace or move the
             // position back until it is. This is far from foolproof, but until we have evidence otherwise,
@@ -65,16 +68,16 @@ namespace AppInstaller::CLI
                 // If we actually hit the front of the string, something bad probably happened.
                 THROW_HR_IF(APPINSTALLER_CLI_ERROR_COMPLETE_INPUT_BAD, cursor == 0);
 
-                ParseInto(commandLine.substr(0, cursor), argsBeforeWord, true);
-                ParseInto(commandLine.substr(cursor), argsAfterWord, false);
+                ParseInto(line, cursor, argsBeforeWord, true);
+                ParseInto(line + cursor, m_commandLine.size() - cursor, argsAfterWord, false);
             }
         }
         // If the word is not empty, the cursor is either in the middle of a token, or at the end of one.
         // The value will be replaced, and we will remove it from the args here.
         else
         {
-            std::vector<std::string> allArgs;
-            ParseInto(commandLine, allArgs, true);
+            std::vector<std::string_view> allArgs;
+            ParseInto(line, m_commandLine.size(), allArgs, true);
 
             // Find the word amongst the arguments
             std::vector<size_t> wordIndeces;
@@ -156,7 +159,7 @@ namespace AppInstaller::CLI
                 wordIndexForSplit = wordIndeces[indexToUse];
             }
 
-            std::vector<std::string>* moveTarget = &argsBeforeWord;
+            std::vector<std::string_view>* moveTarget = &argsBeforeWord;
             for (size_t i = 0; i < allArgs.size(); ++i)
             {
                 if (i == wordIndexForSplit)
@@ -166,12 +169,12 @@ namespace AppInstaller::CLI
                 }
                 else
                 {
-                    moveTarget->emplace_back(std::move(allArgs[i]));
+                    moveTarget->emplace_back(allArgs[i]);
                 }
             }
         }
 
-        // Move the arguments into an Invocation for future use.
+        // Move the arguments into an Invocation for future use; they remain views of the command line.
         m_argsBeforeWord = std::make_unique<CLI::Invocation>(std::move(argsBeforeWord));
         m_argsAfterWord = std::make_unique<CLI::Invocation>(std::move(argsAfterWord));
 
@@ -197,16 +200,97 @@ namespace AppInstaller::CLI
             }());
     }
 
-    void CompletionData::ParseInto(std::string_view line, std::vector<std::string>& args, bool skipFirst)
+    void CompletionData::ParseInto(char* line, size_t length, std::vector<std::string_view>& args, bool skipFirst)
     {
-        std::wstring commandLineW = Utility::ConvertToUTF16(line);
-        int argc = 0;
-        wil::unique_hlocal_ptr<LPWSTR> argv{ CommandLineToArgvW(commandLineW.c_str(), &argc) };
-        THROW_LAST_ERROR_IF_NULL(argv);
+        // All of the characters that have meaning are ASCII, so the UTF-8 can be split without decoding it.
+        // Removing quotes and escapes only ever shortens an argument, so it is written over the line as it is read.
+        const char* read = line;
+        const char* end = line + length;
+        auto isSpace = [](char c) { return c == ' ' || c == '\t'; };
+
+        // The program name is not escaped; it ends at the closing quote, or at whitespace if it is not quoted
+        if (skipFirst)
+        {
+            if (read != end && *read == '"')
+            {
+                for (++read; read != end && *read++ != '"';);
+            }
+            else
+            {
+                for (; read != end && !isSpace(*read); ++read);
+            }
+        }
+
+        for (; read != end && isSpace(*read); ++read);
+
+        char* argStart = line + (read - line);
+        char* write = argStart;
+        bool inArg = false;
+        size_t backslashCount = 0;
+        size_t quoteCount = 0;
+
+        while (read != end)
+        {
+            if (isSpace(*read) && quoteCount == 0)
+            {
+                args.emplace_back(argStart, static_cast<size_t>(write - argStart));
+                inArg = false;
+
+                for (; read != end && isSpace(*read); ++read);
+                argStart = line + (read - line);
+                write = argStart;
+                backslashCount = 0;
+                continue;
+            }
+
+            inArg = true;
+
+            if (*read == '\\')
+            {
+                *write++ = *read++;
+                ++backslashCount;
+            }
+            else if (*read == '"')
+            {
+                // Backslashes before a quote are halved; an odd one out escapes the quote
+                write -= backslashCount / 2;
+                if (backslashCount % 2 == 1)
+                {
+                    write[-1] = '"';
+                }
+                else
+                {
+                    ++quoteCount;
+                }
+
+                ++read;
+                backslashCount = 0;
+
+                // Every third quote in a run is a literal quote
+                for (; read != end && *read == '"'; ++read)
+                {
+                    if (++quoteCount == 3)
+                    {
+                        *write++ = '"';
+                        quoteCount = 0;
+                    }
+                }
+
+                if (quoteCount == 2)
+                {
+                    quoteCount = 0;
+                }
+            }
+            else
+            {
+                *write++ = *read++;
+                backslashCount = 0;
+            }
+        }
 
-        for (int i = (skipFirst ? 1 : 0); i < argc; ++i)
+        if (inArg)
         {
-            args.emplace_back(Utility::ConvertToUTF8(argv.get()[i]));
+            args.emplace_back(argStart, static_cast<size_t>(write - argStart));
         }
     }
 }
@@ -23,9 +23,13 @@ namespace AppInstaller::CLI
         Invocation& AfterWord() const { return *m_argsAfterWord; }
 
     private:
-        static void ParseInto(std::string_view line, std::vector<std::string>& args, bool skipFirst);
+        // Splits the line into arguments as CommandLineToArgvW does, removing the quotes and escapes in place;
+        // the arguments are views of the line.
+        static void ParseInto(char* line, size_t length, std::vector<std::string_view>& args, bool skipFirst);
 
         std::string m_word;
+        // The arguments are views of this copy of the command line, which does not move with the completion data.
+        std::vector<char> m_commandLine;
         std::unique_ptr<CLI::Invocation> m_argsBeforeWord;
         std::unique_ptr<CLI::Invocation> m_argsAfterWord;
     };
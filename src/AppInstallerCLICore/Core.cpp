@@ -2,9 +2,19 @@
 // Licensed under the MIT License.
 #include "pch.h"
 #include "Public/AppInstallerCLICore.h"
+#include "Core.h"
 #include "Commands/RootCommand.h"
+#include "Commands/ServerCommand.h"
 #include "ExecutionContext.h"
+#include "FastCompletion.h"
+#include "Server.h"
+#include "TableOutput.h"
 #include <winget/UserSettings.h>
+#include <SQLiteWrapper.h>
+#include <WorkloadTrace.h>
+
+#include <chrono>
+#include <iomanip>
 
 using namespace winrt;
 using namespace winrt::Windows::Foundation;
@@ -38,131 +48,302 @@ namespace AppInstaller::CLI
         private:
             UINT m_previousCP = 0;
         };
-    }
 
-    int CoreMain(int argc, wchar_t const** argv) try
-    {
-        init_apartment();
+        // RAII class to write the stream through a RedirectedOutputBuffer while the output is not a console.
+        struct RedirectedOutputRestore
+        {
+            RedirectedOutputRestore(std::ostream& stream) : m_stream(stream)
+            {
+                HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+                if (Execution::RedirectedOutputBuffer::IsRedirected(output))
+                {
+                    m_stream.flush();
+                    m_buffer.emplace(output);
+                    m_previousBuffer = m_stream.rdbuf(&m_buffer.value());
+                }
+            }
 
-        // Enable all logging for this phase; we will update once we have the arguments
-        Logging::Log().EnableChannel(Logging::Channel::All);
-        Logging::Log().SetLevel(Logging::Level::Verbose);
-        Logging::AddFileLogger();
-        Logging::EnableWilFailureTelemetry();
+            ~RedirectedOutputRestore()
+            {
+                if (m_buffer)
+                {
+                    m_stream.flush();
+                    m_stream.rdbuf(m_previousBuffer);
+                }
+            }
 
-        // Set output to UTF8
-        ConsoleOutputCPRestore utf8CP(CP_UTF8);
+            RedirectedOutputRestore(const RedirectedOutputRestore&) = delete;
+            RedirectedOutputRestore& operator=(const RedirectedOutputRestore&) = delete;
 
-        Logging::Telemetry().LogStartup();
+            RedirectedOutputRestore(RedirectedOutputRestore&&) = delete;
+            RedirectedOutputRestore& operator=(RedirectedOutputRestore&&) = delete;
 
-        // Initiate the background cleanup of the log file location.
-        Logging::BeginLogFileCleanup();
+            bool IsRedirected() const { return m_buffer.has_value(); }
 
-        Execution::Context context{ std::cout, std::cin };
-        context.EnableCtrlHandler();
+        private:
+            std::ostream& m_stream;
+            std::optional<Execution::RedirectedOutputBuffer> m_buffer;
+            std::streambuf* m_previousBuffer = nullptr;
+        };
 
-        // Convert incoming wide char args to UTF8
-        std::vector<std::string> utf8Args;
-        for (int i = 1; i < argc; ++i)
+        std::string FormatMilliseconds(std::chrono::microseconds duration)
         {
-            utf8Args.emplace_back(Utility::ConvertToUTF8(argv[i]));
+            std::ostringstream strstr;
+            strstr << std::fixed << std::setprecision(1) << (static_cast<double>(duration.count()) / 1000);
+            return strstr.str();
         }
 
-        AICLI_LOG(CLI, Info, << "WinGet invoked with arguments:" << [&]() {
-                std::stringstream strstr;
-                for (const auto& arg : utf8Args)
+        // Outputs the totals of the timed operations that ran during the command.
+        void OutputPerformanceSummary(Execution::Context& context)
+        {
+            Execution::TableOutput<4> table(context.Reporter, {
+                Resource::String::PerfSummaryOperation,
+                Resource::String::PerfSummaryCount,
+                Resource::String::PerfSummaryTotal,
+                Resource::String::PerfSummaryLongest });
+
+            for (size_t i = 0; i < ToIntegral(Logging::PerformanceOperation::Max); ++i)
+            {
+                Logging::PerformanceOperation operation = static_cast<Logging::PerformanceOperation>(i);
+                Logging::PerformanceCounter counter = Logging::GetPerformanceCounter(operation);
+                if (counter.Count == 0)
                 {
-                    strstr << " '" << arg << '\'';
+                    continue;
                 }
-                return strstr.str();
-            }());
 
-        Invocation invocation{ std::move(utf8Args) };
+                table.OutputLine({
+                    std::string{ Logging::ToString(operation) },
+                    std::to_string(counter.Count),
+                    FormatMilliseconds(counter.Total),
+                    FormatMilliseconds(counter.Longest) });
+            }
 
-        // The root command is our fallback in the event of very bad or very little input
-        std::unique_ptr<Command> command = std::make_unique<RootCommand>();
+            table.Complete();
+        }
 
-        try
+        int ExecuteCommandLineInternal(Execution::Context& context, std::vector<std::string> utf8Args)
         {
-            std::unique_ptr<Command> subCommand = command->FindSubCommand(invocation);
-            while (subCommand)
+            AICLI_LOG(CLI, Info, << "WinGet invoked with arguments:" << [&]() {
+                    std::stringstream strstr;
+                    for (const auto& arg : utf8Args)
+                    {
+                        strstr << " '" << arg << '\'';
+                    }
+                    return strstr.str();
+                }());
+
+            Invocation invocation{ std::move(utf8Args) };
+
+            // The root command is our fallback in the event of very bad or very little input
+            std::unique_ptr<Command> command = std::make_unique<RootCommand>();
+
+            try
             {
-                command = std::move(subCommand);
-                subCommand = command->FindSubCommand(invocation);
-            }
-            Logging::Telemetry().LogCommand(command->FullName());
+                std::unique_ptr<Command> subCommand = command->FindSubCommand(invocation);
+                while (subCommand)
+                {
+                    command = std::move(subCommand);
+                    subCommand = command->FindSubCommand(invocation);
+                }
+                Logging::Telemetry().LogCommand(command->FullName());
 
-            command->ParseArguments(invocation, context.Args);
+                command->ParseArguments(invocation, context.Args);
 
-            // Change logging level to Info if Verbose not requested
-            if (!context.Args.Contains(Execution::Args::Type::VerboseLogs))
+                // Change logging level to Info if Verbose not requested
+                if (!context.Args.Contains(Execution::Args::Type::VerboseLogs))
+                {
+                    Logging::Log().SetLevel(Logging::Level::Info);
+                }
+
+                context.UpdateForArgs();
+
+                command->ValidateArguments(context.Args);
+            }
+            // Exceptions specific to parsing the arguments of a command
+            catch (const CommandException& ce)
             {
-                Logging::Log().SetLevel(Logging::Level::Info);
+                command->OutputHelp(context.Reporter, &ce);
+                AICLI_LOG(CLI, Error, << "Error encountered parsing command line: " << ce.Message());
+                return APPINSTALLER_CLI_ERROR_INVALID_CL_ARGUMENTS;
             }
 
-            context.UpdateForArgs();
+            // With verbose logs, also record the cost of each SQL statement and log it once the command completes.
+            bool collectStatementStatistics = context.Args.Contains(Execution::Args::Type::VerboseLogs);
+            if (collectStatementStatistics)
+            {
+                Repository::SQLite::EnableStatementStatistics(true);
+            }
 
-            command->ValidateArguments(context.Args);
-        }
-        // Exceptions specific to parsing the arguments of a command
-        catch (const CommandException& ce)
-        {
-            command->OutputHelp(context.Reporter, &ce);
-            AICLI_LOG(CLI, Error, << "Error encountered parsing command line: " << ce.Message());
-            return APPINSTALLER_CLI_ERROR_INVALID_CL_ARGUMENTS;
-        }
+            auto logStatementStatistics = wil::scope_exit([&]()
+                {
+                    if (collectStatementStatistics)
+                    {
+                        try
+                        {
+                            Repository::SQLite::LogStatementStatistics();
+                        }
+                        CATCH_LOG();
+                    }
+                });
 
-        try
-        {
-            if (!Settings::User().GetWarnings().empty())
+            // The task durations and operation totals of every command are sent with its telemetry.
+            auto logCommandPerformance = wil::scope_exit([&]()
+                {
+                    Logging::Telemetry().LogCommandPerformance(command->FullName());
+                });
+
+            auto outputPerformanceSummary = wil::scope_exit([&]()
+                {
+                    if (context.Args.Contains(Execution::Args::Type::Perf))
+                    {
+                        try
+                        {
+                            OutputPerformanceSummary(context);
+                        }
+                        CATCH_LOG();
+                    }
+                });
+
+            try
+            {
+                if (!Settings::User().GetWarnings().empty())
+                {
+                    context.Reporter.Warn() << Resource::String::SettingsWarnings << std::endl;
+                }
+
+                command->Execute(context);
+            }
+            // Exceptions that may occur in the process of executing an arbitrary command
+            catch (const wil::ResultException& re)
+            {
+                // Even though they are logged at their source, log again here for completeness.
+                Logging::Telemetry().LogException(command->FullName(), "wil::ResultException", re.what());
+                context.Reporter.Error() <<
+                    Resource::String::UnexpectedErrorExecutingCommand << ' ' << std::endl <<
+                    GetUserPresentableMessage(re) << std::endl;
+                return re.GetErrorCode();
+            }
+            catch (const winrt::hresult_error& hre)
+            {
+                std::string message = GetUserPresentableMessage(hre);
+                Logging::Telemetry().LogException(command->FullName(), "winrt::hresult_error", message);
+                context.Reporter.Error() <<
+                    Resource::String::UnexpectedErrorExecutingCommand << ' ' << std::endl <<
+                    message << std::endl;
+                return hre.code();
+            }
+            catch (const std::exception& e)
+            {
+                Logging::Telemetry().LogException(command->FullName(), "std::exception", e.what());
+                context.Reporter.Error() <<
+                    Resource::String::UnexpectedErrorExecutingCommand << ' ' << std::endl <<
+                    GetUserPresentableMessage(e) << std::endl;
+                return APPINSTALLER_CLI_ERROR_COMMAND_FAILED;
+            }
+            catch (...)
+            {
+                LOG_CAUGHT_EXCEPTION();
+                Logging::Telemetry().LogException(command->FullName(), "unknown", {});
+                context.Reporter.Error() <<
+                    Resource::String::UnexpectedErrorExecutingCommand << " ???"_liv << std::endl;
+                return APPINSTALLER_CLI_ERROR_COMMAND_FAILED;
+            }
+
+            if (SUCCEEDED(context.GetTerminationHR()))
             {
-                context.Reporter.Warn() << Resource::String::SettingsWarnings << std::endl;
+                Logging::Telemetry().LogCommandSuccess(command->FullName());
             }
 
-            command->Execute(context);
+            return context.GetTerminationHR();
         }
-        // Exceptions that may occur in the process of executing an arbitrary command
-        catch (const wil::ResultException& re)
+    }
+
+    int ExecuteCommandLine(Execution::Context& context, std::vector<std::string> utf8Args)
+    {
+        // When the workload is being recorded, the command is recorded with its searches and timings
+        Repository::Workload::CommandRecorder recorder{ utf8Args };
+
+        int result = ExecuteCommandLineInternal(context, std::move(utf8Args));
+        recorder.End(result);
+        return result;
+    }
+
+    int CoreMain(int argc, wchar_t const** argv) try
+    {
+        // Set output to UTF8
+        ConsoleOutputCPRestore utf8CP(CP_UTF8);
+
+        // Output to a file or a pipe is written in large batches rather than a line at a time.
+        // This is declared before the context so that the output is all written after the context is done with it.
+        RedirectedOutputRestore redirectedOutput(std::cout);
+
+        // Convert incoming wide char args to UTF8
+        std::vector<std::string> utf8Args;
+        for (int i = 1; i < argc; ++i)
         {
-            // Even though they are logged at their source, log again here for completeness.
-            Logging::Telemetry().LogException(command->FullName(), "wil::ResultException", re.what());
-            context.Reporter.Error() <<
-                Resource::String::UnexpectedErrorExecutingCommand << ' ' << std::endl <<
-                GetUserPresentableMessage(re) << std::endl;
-            return re.GetErrorCode();
+            utf8Args.emplace_back(Utility::ConvertToUTF8(argv[i]));
         }
-        catch (const winrt::hresult_error& hre)
+
+        // A completion is done before the rest of the startup when it does not need it
+        std::optional<int> completionResult = FastCompletion::TryExecute(utf8Args, std::cout);
+        if (completionResult)
         {
-            std::string message = GetUserPresentableMessage(hre);
-            Logging::Telemetry().LogException(command->FullName(), "winrt::hresult_error", message);
-            context.Reporter.Error() <<
-                Resource::String::UnexpectedErrorExecutingCommand << ' ' << std::endl <<
-                message << std::endl;
-            return hre.code();
+            return completionResult.value();
         }
-        catch (const std::exception& e)
+
+        init_apartment();
+
+        // Enable all logging for this phase; we will update once we have the arguments
+        Logging::Log().EnableChannel(Logging::Channel::All);
+        Logging::Log().SetLevel(Logging::Level::Verbose);
+        Logging::AddFileLogger();
+        Logging::EnableWilFailureTelemetry();
+
+        // With server mode, the command line is executed by the server of this user if one is running
+        if (Settings::ExperimentalFeature::IsEnabled(Settings::ExperimentalFeature::Feature::ServerMode) &&
+            (utf8Args.empty() || utf8Args[0] != ServerCommand::CommandName))
         {
-            Logging::Telemetry().LogException(command->FullName(), "std::exception", e.what());
-            context.Reporter.Error() <<
-                Resource::String::UnexpectedErrorExecutingCommand << ' ' << std::endl <<
-                GetUserPresentableMessage(e) << std::endl;
-            return APPINSTALLER_CLI_ERROR_COMMAND_FAILED;
+            std::optional<int> serverResult = Server::TryExecute(utf8Args, std::cout);
+            if (serverResult)
+            {
+                return serverResult.value();
+            }
         }
-        catch (...)
+
+        Logging::Telemetry().LogStartup();
+
+        // Initiate the background cleanup of the log file location.
+        Logging::BeginLogFileCleanup();
+
+        if (Settings::User().Get<Settings::Setting::DiagnosticsRecordWorkload>())
         {
-            LOG_CAUGHT_EXCEPTION();
-            Logging::Telemetry().LogException(command->FullName(), "unknown", {});
-            context.Reporter.Error() <<
-                Resource::String::UnexpectedErrorExecutingCommand << " ???"_liv << std::endl;
-            return APPINSTALLER_CLI_ERROR_COMMAND_FAILED;
+            try
+            {
+                Repository::Workload::EnableRecording(Repository::Workload::GetDefaultTracePath());
+            }
+            CATCH_LOG();
         }
 
-        if (SUCCEEDED(context.GetTerminationHR()))
+        // Sources opened by the command may have started updating in the background; let them finish before exiting.
+        // This is declared before the context so that it runs after the context has released the sources.
+        auto completeBackgroundSourceUpdates = wil::scope_exit([]()
+            {
+                try
+                {
+                    Repository::CompleteBackgroundSourceUpdates();
+                }
+                CATCH_LOG();
+            });
+
+        Execution::Context context{ std::cout, std::cin };
+        context.EnableCtrlHandler();
+
+        if (redirectedOutput.IsRedirected())
         {
-            Logging::Telemetry().LogCommandSuccess(command->FullName());
+            context.Reporter.SetOutputRedirected();
         }
 
-        return context.GetTerminationHR();
+        return ExecuteCommandLine(context, std::move(utf8Args));
     }
     // End of the line exceptions that are not ever expected.
     // Telemetry cannot be reliable beyond this point, so don't let these happen.
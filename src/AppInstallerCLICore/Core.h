@@ -0,0 +1,14 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "ExecutionContext.h"
+
+#include <string>
+#include <vector>
+
+namespace AppInstaller::CLI
+{
+    // Finds the command for the command line, then parses its arguments and executes it in the context.
+    // Errors are reported to the context; returns the result of the command.
+    int ExecuteCommandLine(Execution::Context& context, std::vector<std::string> utf8Args);
+}
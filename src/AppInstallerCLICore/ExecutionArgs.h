@@ -1,9 +1,11 @@
 // Copyright (c) Microsoft Corporation.
 // Licensed under the MIT License.
 #pragma once
+#include <array>
+#include <bitset>
+#include <memory>
 #include <string>
 #include <string_view>
-#include <map>
 #include <vector>
 
 namespace AppInstaller::CLI::Execution
@@ -25,6 +27,7 @@ namespace AppInstaller::CLI::Execution
             Source, // Index source to be queried against
             Count, // Maximum query results
             Exact, // Exact match required
+            IdFile, // File of ids to find exactly, or standard input
 
             // Manifest selection behavior after an app is found
             Version,
@@ -42,19 +45,29 @@ namespace AppInstaller::CLI::Execution
             SourceName,
             SourceType,
             SourceArg,
+            SourceMirror,
+            SourceScheduled, // Run by the scheduled task that updates the sources
 
             //Hash Command
             HashFile,
             Msix, // Flag to indicate the input file is msix
+            ChunkSize, // The size of the chunks of the chunked hash
 
             //Validate Command
             ValidateManifest,
+            ValidationCache, // A file of results to skip manifests whose content has not changed
 
             // Complete Command
             Word,
             CommandLine,
             Position,
 
+            // Batch Command
+            BatchFile,
+
+            // Upgrade Command
+            All, // Upgrade every installed package that has a later version
+
             // Other
             Force,      // Generic flag to enable a command to skip some check
             ListVersions, // Used in Show command to list all available versions of an app
@@ -64,53 +77,105 @@ namespace AppInstaller::CLI::Execution
             Help, // Show command usage
             Info, // Show general info about WinGet
             VerboseLogs, // Increases winget logging level to verbose
+            Perf, // Prints the time spent in the hot paths when the command completes
+            Output, // Writes the results in a format for other tools instead of for the console
 
             // Used for demonstration purposes
             ExperimentalArg,
+
+            // Must be last and unused.
+            Max
         };
 
-        bool Contains(Type arg) const { return (m_parsedArgs.count(arg) != 0); }
+        bool Contains(Type arg) const { return Read().Present[Index(arg)]; }
 
         const std::vector<std::string>* GetArgs(Type arg) const
         {
-            auto itr = m_parsedArgs.find(arg);
-            return (itr == m_parsedArgs.end() ? nullptr : &(itr->second));
+            return (Contains(arg) ? &Read().Parsed[Index(arg)] : nullptr);
         }
 
         std::string_view GetArg(Type arg) const
         {
-            auto itr = m_parsedArgs.find(arg);
+            const auto& values = Read().Parsed[Index(arg)];
 
-            if (itr == m_parsedArgs.end())
+            if (values.empty())
             {
                 return {};
             }
 
-            return itr->second[0];
+            return values[0];
         }
 
         size_t GetCount(Type arg) const
         {
-            auto args = GetArgs(arg);
-            return (args ? args->size() : 0);
+            return Read().Parsed[Index(arg)].size();
         }
 
         bool AddArg(Type arg)
         {
-            return m_parsedArgs[arg].empty();
+            Values& values = Write();
+            values.Present[Index(arg)] = true;
+            return values.Parsed[Index(arg)].empty();
         }
 
         void AddArg(Type arg, std::string value)
         {
-            m_parsedArgs[arg].emplace_back(std::move(value));
+            Values& values = Write();
+            values.Present[Index(arg)] = true;
+            values.Parsed[Index(arg)].emplace_back(std::move(value));
         }
 
         void AddArg(Type arg, std::string_view value)
         {
-            m_parsedArgs[arg].emplace_back(value);
+            Values& values = Write();
+            values.Present[Index(arg)] = true;
+            values.Parsed[Index(arg)].emplace_back(value);
+        }
+
+        // Removes all of the values of the argument.
+        void RemoveArg(Type arg)
+        {
+            if (Contains(arg))
+            {
+                Values& values = Write();
+                values.Present[Index(arg)] = false;
+                values.Parsed[Index(arg)].clear();
+            }
         }
 
     private:
-        std::map<Type, std::vector<std::string>> m_parsedArgs;
+        static constexpr size_t Index(Type arg) { return static_cast<size_t>(arg); }
+
+        // The values of each argument, by its Type; an argument is present if it was added, even without values.
+        struct Values
+        {
+            std::array<std::vector<std::string>, static_cast<size_t>(Type::Max)> Parsed;
+            std::bitset<static_cast<size_t>(Type::Max)> Present;
+        };
+
+        const Values& Read() const
+        {
+            static const Values s_empty;
+            return (m_values ? *m_values : s_empty);
+        }
+
+        // Gets the values to modify, first copying them if they are shared with another Args.
+        Values& Write()
+        {
+            if (!m_values)
+            {
+                m_values = std::make_shared<Values>();
+            }
+            else if (m_values.use_count() > 1)
+            {
+                m_values = std::make_shared<Values>(*m_values);
+            }
+
+            return *m_values;
+        }
+
+        // Copies of the args share the values until one of them is modified, so that the many contexts
+        // created for the parts of a command do not each copy every argument.
+        std::shared_ptr<Values> m_values;
     };
 }
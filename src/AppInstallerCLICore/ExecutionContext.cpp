@@ -10,16 +10,26 @@ namespace AppInstaller::CLI::Execution
 
     namespace
     {
-        // The context that will receive CTRL signals
-        Context* s_contextForCtrlHandler = nullptr;
+        // The contexts that will receive CTRL signals; a command and the sub-contexts that it is running.
+        std::mutex s_contextsForCtrlHandlerLock;
+        std::vector<Context*> s_contextsForCtrlHandler;
+
+        void TerminateContextsForCtrlHandler(bool force)
+        {
+            for (Context* context : s_contextsForCtrlHandler)
+            {
+                context->Terminate(APPINSTALLER_CLI_ERROR_CTRL_SIGNAL_RECEIVED);
+                context->Reporter.CancelInProgressTask(force);
+            }
+        }
 
         BOOL WINAPI CtrlHandlerForContext(DWORD ctrlType)
         {
             AICLI_LOG(CLI, Info, << "Got CTRL type: " << ctrlType);
 
             // Won't save us from every crash, but a few more than direct access.
-            Context* context = s_contextForCtrlHandler;
-            if (!context)
+            std::lock_guard<std::mutex> lock{ s_contextsForCtrlHandlerLock };
+            if (s_contextsForCtrlHandler.empty())
             {
                 return FALSE;
             }
@@ -28,36 +38,43 @@ namespace AppInstaller::CLI::Execution
             {
             case CTRL_C_EVENT:
             case CTRL_BREAK_EVENT:
-                context->Terminate(APPINSTALLER_CLI_ERROR_CTRL_SIGNAL_RECEIVED);
-                context->Reporter.CancelInProgressTask(false);
+                TerminateContextsForCtrlHandler(false);
                 return TRUE;
                 // According to MSDN, we should never receive these due to having gdi32/user32 loaded in our process.
                 // But handle them as a force terminate anyway.
             case CTRL_CLOSE_EVENT:
             case CTRL_LOGOFF_EVENT:
             case CTRL_SHUTDOWN_EVENT:
-                context->Terminate(APPINSTALLER_CLI_ERROR_CTRL_SIGNAL_RECEIVED);
-                context->Reporter.CancelInProgressTask(true);
+                TerminateContextsForCtrlHandler(true);
                 return TRUE;
             default:
                 return FALSE;
             }
         }
 
-        void SetCtrlHandlerContext(Context* context)
+        void SetCtrlHandlerContext(Context* context, bool enabled)
         {
-            // Only one is allowed right now.
-            THROW_HR_IF(E_UNEXPECTED, s_contextForCtrlHandler != nullptr && context != nullptr);
+            std::lock_guard<std::mutex> lock{ s_contextsForCtrlHandlerLock };
+
+            auto itr = std::find(s_contextsForCtrlHandler.begin(), s_contextsForCtrlHandler.end(), context);
 
-            if (context == nullptr)
+            if (enabled && itr == s_contextsForCtrlHandler.end())
             {
-                LOG_IF_WIN32_BOOL_FALSE(SetConsoleCtrlHandler(CtrlHandlerForContext, FALSE));
-                s_contextForCtrlHandler = nullptr;
+                if (s_contextsForCtrlHandler.empty())
+                {
+                    LOG_IF_WIN32_BOOL_FALSE(SetConsoleCtrlHandler(CtrlHandlerForContext, TRUE));
+                }
+
+                s_contextsForCtrlHandler.push_back(context);
             }
-            else
+            else if (!enabled && itr != s_contextsForCtrlHandler.end())
             {
-                s_contextForCtrlHandler = context;
-                LOG_IF_WIN32_BOOL_FALSE(SetConsoleCtrlHandler(CtrlHandlerForContext, TRUE));
+                s_contextsForCtrlHandler.erase(itr);
+
+                if (s_contextsForCtrlHandler.empty())
+                {
+                    LOG_IF_WIN32_BOOL_FALSE(SetConsoleCtrlHandler(CtrlHandlerForContext, FALSE));
+                }
             }
         }
     }
@@ -75,9 +92,36 @@ namespace AppInstaller::CLI::Execution
         return { Reporter };
     }
 
+    std::unique_ptr<Context> Context::CreateSubContext()
+    {
+        std::unique_ptr<Context> result{ new Context(Reporter) };
+        InitializeSubContext(*result);
+        return result;
+    }
+
+    std::unique_ptr<Context> Context::CreateSubContext(std::ostream& out, std::istream& in)
+    {
+        auto result = std::make_unique<Context>(out, in);
+        InitializeSubContext(*result);
+        return result;
+    }
+
+    void Context::InitializeSubContext(Context& result)
+    {
+        result.Args = Args;
+        result.UpdateForArgs();
+        result.m_sharedSources = m_sharedSources;
+        result.m_sourcesAllowed = m_sourcesAllowed;
+
+        if (m_disableCtrlHandlerOnExit)
+        {
+            result.EnableCtrlHandler();
+        }
+    }
+
     void Context::EnableCtrlHandler(bool enabled)
     {
-        SetCtrlHandlerContext(enabled ? this : nullptr);
+        SetCtrlHandlerContext(this, enabled);
         m_disableCtrlHandlerOnExit = enabled;
     }
 
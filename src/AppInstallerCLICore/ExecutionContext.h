@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 #pragma once
 #include <AppInstallerLogging.h>
+#include <AppInstallerRepositoryInventory.h>
 #include <AppInstallerRepositorySearch.h>
 #include <AppInstallerRepositorySource.h>
 #include <winget/Manifest.h>
@@ -11,9 +12,10 @@
 
 #include <filesystem>
 #include <map>
+#include <optional>
 #include <string>
+#include <tuple>
 #include <utility>
-#include <variant>
 #include <vector>
 
 
@@ -33,12 +35,13 @@
 namespace AppInstaller::CLI::Workflow
 {
     struct WorkflowTask;
+    struct InstallerDownload;
 }
 
 namespace AppInstaller::CLI::Execution
 {
     // Names a piece of data stored in the context by a workflow step.
-    // Must start at 0 to enable direct access to variant in Context.
+    // Must start at 0 to enable direct access to the storage in Context.
     // Max must be last and unused.
     enum class Data : size_t
     {
@@ -52,6 +55,8 @@ namespace AppInstaller::CLI::Execution
         LogPath,
         InstallerArgs,
         CompletionData,
+        InstallerDownload,
+        Upgrades,
         Max
     };
 
@@ -123,15 +128,34 @@ namespace AppInstaller::CLI::Execution
             using value_t = CLI::CompletionData;
         };
 
-        // Used to deduce the DataVariant type; making a variant that includes std::monostate and all DataMapping types.
+        template <>
+        struct DataMapping<Data::InstallerDownload>
+        {
+            using value_t = std::shared_ptr<Workflow::InstallerDownload>;
+        };
+
+        template <>
+        struct DataMapping<Data::Upgrades>
+        {
+            using value_t = std::vector<Repository::AvailableUpgrade>;
+        };
+
+        // Used to deduce the DataStorage type; making a tuple with an optional of every DataMapping type, in the order of Data.
         template <size_t... I>
-        inline auto Deduce(std::index_sequence<I...>) { return std::variant<std::monostate, DataMapping<static_cast<Data>(I)>::value_t...>{}; }
+        inline auto Deduce(std::index_sequence<I...>) { return std::tuple<std::optional<typename DataMapping<static_cast<Data>(I)>::value_t>...>{}; }
+
+        // Holds a slot for every Data, each only constructed when the data is added.
+        using DataStorage = decltype(Deduce(std::make_index_sequence<static_cast<size_t>(Data::Max)>()));
 
-        // Holds data of any type listed in a DataMapping.
-        using DataVariant = decltype(Deduce(std::make_index_sequence<static_cast<size_t>(Data::Max)>()));
+        // Gets the index of the slot for the given Data.
+        constexpr inline size_t DataIndex(Data d) { return static_cast<size_t>(d); }
 
-        // Gets the index into the variant for the given Data.
-        constexpr inline size_t DataIndex(Data d) { return static_cast<size_t>(d) + 1; }
+        // Determines whether the slot for the given Data holds a value; for when the Data is only known at runtime.
+        template <size_t... I>
+        inline bool ContainsData(const DataStorage& storage, Data d, std::index_sequence<I...>)
+        {
+            return ((DataIndex(d) == I && std::get<I>(storage).has_value()) || ...);
+        }
     }
 
     // The context within which all commands execute.
@@ -152,8 +176,16 @@ namespace AppInstaller::CLI::Execution
         // Creates a copy of this context as it was at construction.
         Context Clone();
 
+        // Creates a context with the same output and a copy of the arguments, but its own data, to run a workflow for part of the command.
+        // It receives CTRL signals if this context does.
+        virtual std::unique_ptr<Context> CreateSubContext();
+
+        // Creates a sub context, as above, that uses the given streams for its input and output rather than those of this context,
+        // so that it can run on another thread alongside this one.
+        virtual std::unique_ptr<Context> CreateSubContext(std::ostream& out, std::istream& in);
+
         // Enables reception of CTRL signals.
-        // Only one context can be enabled to handle CTRL signals at a time.
+        // Every context that is enabled is terminated by a CTRL signal.
         void EnableCtrlHandler(bool enabled = true);
 
         // Applies changes based on the parsed args.
@@ -173,21 +205,56 @@ namespace AppInstaller::CLI::Execution
         template <Data D>
         void Add(typename details::DataMapping<D>::value_t&& v)
         {
-            m_data[D].emplace<details::DataIndex(D)>(std::forward<typename details::DataMapping<D>::value_t>(v));
+            std::get<details::DataIndex(D)>(m_data).emplace(std::forward<typename details::DataMapping<D>::value_t>(v));
         }
 
         // Return a value indicating whether the given data type is stored in the context.
-        bool Contains(Data d) { return (m_data.find(d) != m_data.end()); }
+        bool Contains(Data d) const { return details::ContainsData(m_data, d, std::make_index_sequence<static_cast<size_t>(Data::Max)>()); }
+
+        // Return a value indicating whether the given data type is stored in the context.
+        template <Data D>
+        bool Contains() const { return std::get<details::DataIndex(D)>(m_data).has_value(); }
 
         // Gets context data; which can be modified in place.
         template <Data D>
         typename details::DataMapping<D>::value_t& Get()
         {
-            auto itr = m_data.find(D);
-            THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), itr == m_data.end(), "Get(%d)", D);
-            return std::get<details::DataIndex(D)>(itr->second);
+            auto& slot = std::get<details::DataIndex(D)>(m_data);
+            THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), !slot.has_value(), "Get(%d)", D);
+            return slot.value();
+        }
+
+        // Moves context data out of the context, which no longer contains it; for handing it to another context without a copy.
+        template <Data D>
+        typename details::DataMapping<D>::value_t Extract()
+        {
+            auto& slot = std::get<details::DataIndex(D)>(m_data);
+            THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), !slot.has_value(), "Extract(%d)", D);
+            typename details::DataMapping<D>::value_t result = std::move(slot).value();
+            slot.reset();
+            return result;
         }
 
+        // The sources that have been opened, by the name of the source that was requested.
+        using SharedSources = std::map<std::string, std::shared_ptr<Repository::ISource>>;
+
+        // Shares the sources opened in this context and its sub contexts with all other contexts given the same sources,
+        // so that several commands run by one process open each source only once.
+        void ShareSources(std::shared_ptr<SharedSources> sources) { m_sharedSources = std::move(sources); }
+
+        // Gets the sources shared with this context; null if sources are not shared.
+        const std::shared_ptr<SharedSources>& GetSharedSources() const { return m_sharedSources; }
+
+        // The termination of a context that needed to open a source when sources are not allowed.
+        static constexpr HRESULT SourcesNotAllowedHR = E_PENDING;
+
+        // Sets whether sources can be opened by this context and its sub contexts. When they cannot, opening one
+        // terminates the context with SourcesNotAllowedHR, so that the command can be run again where they can.
+        void SetSourcesAllowed(bool allowed) { m_sourcesAllowed = allowed; }
+
+        // Determines whether sources can be opened by this context.
+        bool AreSourcesAllowed() const { return m_sourcesAllowed; }
+
 #ifndef AICLI_DISABLE_TEST_HOOKS
         // Enable tests to override behavior
         virtual bool ShouldExecuteWorkflowTask(const Workflow::WorkflowTask&) { return true; }
@@ -197,10 +264,15 @@ namespace AppInstaller::CLI::Execution
         // Clone the reporter for this constructor.
         Context(Execution::Reporter& reporter) : Reporter(reporter, Execution::Reporter::clone_t{}) {}
 
+        // Gives a new sub context the arguments and shared state of this context.
+        void InitializeSubContext(Context& result);
+
         DestructionToken m_disableCtrlHandlerOnExit = false;
         bool m_isTerminated = false;
         HRESULT m_terminationHR = S_OK;
-        std::map<Data, details::DataVariant> m_data;
+        details::DataStorage m_data;
+        std::shared_ptr<SharedSources> m_sharedSources;
+        bool m_sourcesAllowed = true;
         size_t m_CtrlSignalCount = 0;
     };
 }
@@ -7,10 +7,15 @@ namespace AppInstaller::CLI::Execution
 {
     using namespace Settings;
     using namespace VirtualTerminal;
+    using namespace std::chrono_literals;
     using namespace std::string_view_literals;
 
     namespace
     {
+        // How long the spinner waits before it is shown, and then between its steps.
+        constexpr std::chrono::milliseconds s_SpinnerDelay = 100ms;
+        constexpr std::chrono::milliseconds s_SpinnerStepInterval = 250ms;
+
         struct BytesFormatData
         {
             uint64_t PowerOfTwo;
@@ -158,57 +163,194 @@ namespace AppInstaller::CLI::Execution
                 LOG_HR(E_UNEXPECTED);
             }
         }
+
+        void ProgressVisualizerBase::FlushFrame()
+        {
+            std::string frame = m_out.str();
+            if (!frame.empty())
+            {
+                m_stream.write(frame.data(), frame.size());
+                m_stream.flush();
+                m_out.str({});
+            }
+        }
+    }
+
+    ProgressTicker::~ProgressTicker()
+    {
+        if (m_thread.joinable())
+        {
+            {
+                auto lock = m_lock.lock_exclusive();
+                m_stopping = true;
+            }
+
+            m_wake.SetEvent();
+            m_thread.join();
+        }
+    }
+
+    void ProgressTicker::Start(details::ProgressVisualizerBase* visualizer)
+    {
+        {
+            auto lock = m_lock.lock_exclusive();
+            m_visualizers.emplace_back(visualizer);
+
+            if (!m_thread.joinable())
+            {
+                m_thread = std::thread(&ProgressTicker::Run, this);
+            }
+        }
+
+        m_wake.SetEvent();
+    }
+
+    void ProgressTicker::Stop(details::ProgressVisualizerBase* visualizer)
+    {
+        auto lock = m_lock.lock_exclusive();
+        m_visualizers.erase(std::remove(m_visualizers.begin(), m_visualizers.end(), visualizer), m_visualizers.end());
+    }
+
+    void ProgressTicker::Run()
+    {
+        for (;;)
+        {
+            bool isTicking = false;
+            {
+                auto lock = m_lock.lock_shared();
+                if (m_stopping)
+                {
+                    return;
+                }
+
+                for (auto visualizer : m_visualizers)
+                {
+                    visualizer->Tick();
+                }
+
+                isTicking = !m_visualizers.empty();
+            }
+
+            // With nothing to tick, sleep until something is started
+            m_wake.wait(isTicking ? static_cast<DWORD>(Interval.count()) : INFINITE);
+        }
+    }
+
+    IndefiniteSpinner::~IndefiniteSpinner()
+    {
+        StopSpinner();
     }
 
     void IndefiniteSpinner::ShowSpinner()
     {
-        if (!m_spinnerJob.valid() && !m_spinnerRunning && !m_canceled)
+        auto lock = m_stateLock.lock_exclusive();
+        if (!m_spinnerRunning)
         {
+            m_startTime = std::chrono::steady_clock::now();
+            m_nextStepTime = m_startTime + s_SpinnerDelay;
+            m_step = 0;
+            m_isVisible = false;
+
             m_spinnerRunning = true;
-            m_spinnerJob = std::async(std::launch::async, (UseVT() ? &IndefiniteSpinner::ShowSpinnerInternalWithVT : &IndefiniteSpinner::ShowSpinnerInternalNoVT), this);
+            m_ticker.Start(this);
         }
     }
 
     void IndefiniteSpinner::StopSpinner()
     {
-        if (!m_canceled && m_spinnerJob.valid() && m_spinnerRunning)
+        auto lock = m_stateLock.lock_exclusive();
+        if (m_spinnerRunning)
         {
-            m_canceled = true;
-            m_spinnerJob.get();
+            m_ticker.Stop(this);
+            m_spinnerRunning = false;
+
+            if (m_isVisible)
+            {
+                m_out << "\b \r";
+                FlushFrame();
+                m_isVisible = false;
+            }
         }
     }
 
-    void IndefiniteSpinner::ShowSpinnerInternalNoVT()
+    void IndefiniteSpinner::Tick()
     {
         char spinnerChars[] = { '-', '\\', '|', '/' };
 
-        // First wait for a small amount of time to enable a fast task to skip
+        // The spinner is only shown after a small amount of time, to enable a fast task to skip
         // showing anything, or a progress task to skip straight to progress.
-        Sleep(100);
-
-        // Indent two spaces for the spinner, but three here so that we can overwrite it in the loop.
-        m_out << "   ";
+        auto now = std::chrono::steady_clock::now();
+        if (now < m_nextStepTime)
+        {
+            return;
+        }
 
-        for (size_t i = 0; !m_canceled; ++i)
+        if (!m_isVisible)
         {
-            constexpr size_t repetitionCount = 20;
-            ApplyStyle(i % repetitionCount, repetitionCount, true);
-            m_out << '\b' << spinnerChars[i % ARRAYSIZE(spinnerChars)] << std::flush;
-            Sleep(250);
+            // Indent two spaces for the spinner, but three here so that we can overwrite it in each step.
+            m_out << "   ";
+            m_isVisible = true;
         }
 
-        m_out << "\b \r";
-        m_canceled = false;
-        m_spinnerRunning = false;
+        constexpr size_t repetitionCount = 20;
+        ApplyStyle(m_step % repetitionCount, repetitionCount, true);
+        m_out << '\b' << spinnerChars[m_step % ARRAYSIZE(spinnerChars)];
+        FlushFrame();
+
+        ++m_step;
+        m_nextStepTime = now + s_SpinnerStepInterval;
     }
 
-    void IndefiniteSpinner::ShowSpinnerInternalWithVT()
+    ProgressBar::~ProgressBar()
     {
-        // Nothing special to do at the moment, can use NoVT version.
-        ShowSpinnerInternalNoVT();
+        StopTicking();
     }
 
     void ProgressBar::ShowProgress(uint64_t current, uint64_t maximum, ProgressType type)
+    {
+        {
+            auto lock = m_valueLock.lock_exclusive();
+            m_value = { current, maximum, type };
+            m_valueChanged = true;
+        }
+
+        if (!m_isTicking.exchange(true))
+        {
+            m_ticker.Start(this);
+        }
+    }
+
+    void ProgressBar::Tick()
+    {
+        Render();
+    }
+
+    void ProgressBar::StopTicking()
+    {
+        if (m_isTicking.exchange(false))
+        {
+            m_ticker.Stop(this);
+        }
+    }
+
+    void ProgressBar::Render()
+    {
+        ProgressValue value;
+        {
+            auto lock = m_valueLock.lock_exclusive();
+            if (!m_valueChanged)
+            {
+                return;
+            }
+
+            value = m_value;
+            m_valueChanged = false;
+        }
+
+        DrawProgress(value.Current, value.Maximum, value.Type);
+    }
+
+    void ProgressBar::DrawProgress(uint64_t current, uint64_t maximum, ProgressType type)
     {
         if (current < m_lastCurrent)
         {
@@ -224,12 +366,18 @@ namespace AppInstaller::CLI::Execution
             ShowProgressNoVT(current, maximum, type);
         }
 
+        FlushFrame();
+
         m_lastCurrent = current;
         m_isVisible = true;
     }
 
     void ProgressBar::EndProgress(bool hideProgressWhenDone)
     {
+        // Show where the progress ended before it is ended
+        StopTicking();
+        Render();
+
         if (m_isVisible)
         {
             if (hideProgressWhenDone)
@@ -240,6 +388,7 @@ namespace AppInstaller::CLI::Execution
             {
                 m_out << std::endl;
             }
+            FlushFrame();
             m_isVisible = false;
         }
     }
@@ -8,26 +8,38 @@
 #include <wil/resource.h>
 
 #include <atomic>
-#include <future>
+#include <chrono>
 #include <istream>
 #include <ostream>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace AppInstaller::CLI::Execution
 {
+    struct ProgressTicker;
+
     namespace details
     {
         // Shared functionality for progress visualizers.
         struct ProgressVisualizerBase
         {
-            ProgressVisualizerBase(std::ostream& stream, bool enableVT) :
-                m_out(stream), m_enableVT(enableVT) {}
+            ProgressVisualizerBase(ProgressTicker& ticker, std::ostream& stream, bool enableVT) :
+                m_ticker(ticker), m_stream(stream), m_enableVT(enableVT) {}
+
+            virtual ~ProgressVisualizerBase() = default;
 
             void SetStyle(AppInstaller::Settings::VisualStyle style) { m_style = style; }
 
+            // Called on the ticker thread while the visualizer is started on it.
+            virtual void Tick() = 0;
+
         protected:
-            std::ostream& m_out;
+            ProgressTicker& m_ticker;
+            // The frame being built; the many small writes of an update are collected here and then
+            // written to the stream all at once by FlushFrame, which matters most over remote consoles.
+            std::ostringstream m_out;
             Settings::VisualStyle m_style = AppInstaller::Settings::VisualStyle::Accent;
 
             bool UseVT() const { return m_enableVT && m_style != AppInstaller::Settings::VisualStyle::NoVT; }
@@ -35,37 +47,84 @@ namespace AppInstaller::CLI::Execution
             // Applies the selected visual style.
             void ApplyStyle(size_t i, size_t max, bool enabled);
 
+            // Writes the frame to the stream in a single write and starts a new one.
+            void FlushFrame();
+
         private:
+            std::ostream& m_stream;
             bool m_enableVT = false;
         };
     }
 
+    // The thread shared by the progress visualizers of a reporter, which ticks the visualizers that are started on it
+    // at a fixed rate. The thread is only created when a visualizer is first started, and starting and stopping a
+    // visualizer after that only changes the list of visualizers to tick.
+    struct ProgressTicker
+    {
+        ProgressTicker() = default;
+
+        ~ProgressTicker();
+
+        ProgressTicker(const ProgressTicker&) = delete;
+        ProgressTicker& operator=(const ProgressTicker&) = delete;
+
+        // The time between ticks.
+        static constexpr std::chrono::milliseconds Interval = std::chrono::milliseconds(50);
+
+        // Starts ticking the visualizer; it must not already be started.
+        void Start(details::ProgressVisualizerBase* visualizer);
+
+        // Stops ticking the visualizer; once this returns, it is not being ticked.
+        // Must not be called from a tick.
+        void Stop(details::ProgressVisualizerBase* visualizer);
+
+    private:
+        void Run();
+
+        // Held shared while ticking, so that holding it exclusively means that no tick is in progress.
+        wil::srwlock m_lock;
+        std::vector<details::ProgressVisualizerBase*> m_visualizers;
+        bool m_stopping = false;
+        wil::unique_event m_wake{ wil::EventOptions::None };
+        std::thread m_thread;
+    };
+
     // Displays an indefinite spinner.
     struct IndefiniteSpinner : public details::ProgressVisualizerBase
     {
-        IndefiniteSpinner(std::ostream& stream, bool enableVT) :
-            details::ProgressVisualizerBase(stream, enableVT) {}
+        IndefiniteSpinner(ProgressTicker& ticker, std::ostream& stream, bool enableVT) :
+            details::ProgressVisualizerBase(ticker, stream, enableVT) {}
+
+        ~IndefiniteSpinner();
 
         void ShowSpinner();
 
         void StopSpinner();
 
-    private:
-        std::atomic<bool> m_canceled = false;
-        std::atomic<bool> m_spinnerRunning = false;
-        std::future<void> m_spinnerJob;
-
-        void ShowSpinnerInternalNoVT();
+        void Tick() override;
 
-        void ShowSpinnerInternalWithVT();
+    private:
+        // Guards the starting and stopping of the spinner.
+        wil::srwlock m_stateLock;
+        bool m_spinnerRunning = false;
+
+        // The state of the spinner, only used by the ticks while it is running.
+        std::chrono::steady_clock::time_point m_startTime;
+        std::chrono::steady_clock::time_point m_nextStepTime;
+        size_t m_step = 0;
+        bool m_isVisible = false;
     };
 
-    // Displays progress 
+    // Displays progress.
+    // ShowProgress only records the latest progress, so that it can be called for every chunk of work without waiting
+    // on the output; the bar is drawn with the latest progress by the ticker.
     class ProgressBar : public details::ProgressVisualizerBase
     {
     public:
-        ProgressBar(std::ostream& stream, bool enableVT) :
-            details::ProgressVisualizerBase(stream, enableVT) {}
+        ProgressBar(ProgressTicker& ticker, std::ostream& stream, bool enableVT) :
+            details::ProgressVisualizerBase(ticker, stream, enableVT) {}
+
+        ~ProgressBar();
 
         void ShowProgress(uint64_t current, uint64_t maximum, ProgressType type);
 
@@ -73,10 +132,32 @@ namespace AppInstaller::CLI::Execution
 
         void SetStyle(AppInstaller::Settings::VisualStyle style) { m_style = style; }
 
+        void Tick() override;
+
     private:
+        struct ProgressValue
+        {
+            uint64_t Current = 0;
+            uint64_t Maximum = 0;
+            ProgressType Type = ProgressType::None;
+        };
+
+        // The latest progress; guarded by the lock.
+        wil::srwlock m_valueLock;
+        ProgressValue m_value;
+        bool m_valueChanged = false;
+
+        std::atomic<bool> m_isTicking = false;
         std::atomic<bool> m_isVisible = false;
         uint64_t m_lastCurrent = 0;
 
+        void StopTicking();
+
+        // Draws the latest progress if it has changed since it was last drawn.
+        void Render();
+
+        void DrawProgress(uint64_t current, uint64_t maximum, ProgressType type);
+
         void ClearLine();
 
         void ShowProgressNoVT(uint64_t current, uint64_t maximum, ProgressType type);
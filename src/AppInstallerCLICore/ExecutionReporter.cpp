@@ -18,8 +18,8 @@ namespace AppInstaller::CLI::Execution
     Reporter::Reporter(std::ostream& outStream, std::istream& inStream) :
         m_out(outStream),
         m_in(inStream),
-        m_progressBar(std::in_place, outStream, IsVTEnabled()),
-        m_spinner(std::in_place, outStream, IsVTEnabled())
+        m_spinner(std::in_place, m_progressTicker, outStream, IsVTEnabled()),
+        m_progressBar(std::in_place, m_progressTicker, outStream, IsVTEnabled())
     {}
 
     Reporter::~Reporter()
@@ -32,6 +32,10 @@ namespace AppInstaller::CLI::Execution
     Reporter::Reporter(const Reporter& other, clone_t) :
         Reporter(other.m_out, other.m_in)
     {
+        if (other.m_isOutputRedirected)
+        {
+            SetOutputRedirected();
+        }
     }
 
     OutputStream Reporter::GetOutputStream(Level level)
@@ -61,7 +65,7 @@ namespace AppInstaller::CLI::Execution
 
     OutputStream Reporter::GetBasicOutputStream()
     {
-        return { m_out, m_channel == Channel::Output, IsVTEnabled() };
+        return { m_out, m_channel == Channel::Output, IsVTEnabled(), !m_isOutputRedirected };
     }
 
     void Reporter::SetChannel(Channel channel)
@@ -76,6 +80,19 @@ namespace AppInstaller::CLI::Execution
         }
     }
 
+    void Reporter::DisableProgress()
+    {
+        m_spinner.reset();
+        m_progressBar.reset();
+    }
+
+    void Reporter::SetOutputRedirected()
+    {
+        m_isOutputRedirected = true;
+        m_isVTEnabled = false;
+        DisableProgress();
+    }
+
     void Reporter::SetStyle(VisualStyle style)
     {
         if (m_spinner)
@@ -31,6 +31,8 @@ namespace AppInstaller::CLI::Execution
         {
             Output,
             Completion,
+            // Data for other tools, such as JSON Lines, written without any formatting.
+            Data,
         };
 
         // The level for the Output channel.
@@ -67,8 +69,14 @@ namespace AppInstaller::CLI::Execution
         // Get a stream for error output.
         OutputStream Error() { return GetOutputStream(Level::Error); }
 
+        // Gets the stream for input.
+        std::istream& Input() { return m_in; }
+
         // Get a stream for outputting completion words.
-        NoVTStream Completion() { return NoVTStream(m_out, m_channel == Channel::Completion); }
+        NoVTStream Completion() { return NoVTStream(m_out, m_channel == Channel::Completion, !m_isOutputRedirected); }
+
+        // Get a stream for outputting data for other tools.
+        NoVTStream Data() { return NoVTStream(m_out, m_channel == Channel::Data, !m_isOutputRedirected); }
 
         // Gets a stream for output of the given level.
         OutputStream GetOutputStream(Level level);
@@ -82,6 +90,14 @@ namespace AppInstaller::CLI::Execution
         // Sets the visual style (mostly for progress currently)
         void SetStyle(AppInstaller::Settings::VisualStyle style);
 
+        // Disables progress, for output that is kept to be shown later rather than shown as it is written.
+        void DisableProgress();
+
+        // Sets that the output is not to a console, such as when it is redirected to a file or a pipe.
+        // There is no VT or progress, and lines are not flushed as they are written, so that the buffer
+        // of the output stream can write them in batches.
+        void SetOutputRedirected();
+
         // Used to show indefinite progress. Currently an indefinite spinner is the form of
         // showing indefinite progress.
         // running: shows indefinite progress if set to true, stops indefinite progress if set to false
@@ -94,6 +110,12 @@ namespace AppInstaller::CLI::Execution
         template <typename F>
         auto ExecuteWithProgress(F&& f, bool hideProgressWhenDone = false)
         {
+            // Without progress, the output so far must be written for something to be shown while this runs
+            if (m_isOutputRedirected)
+            {
+                m_out.flush();
+            }
+
             GetBasicOutputStream() << VirtualTerminal::Cursor::Visibility::DisableShow;
 
             ProgressCallback callback(this);
@@ -131,6 +153,9 @@ namespace AppInstaller::CLI::Execution
         std::ostream& m_out;
         std::istream& m_in;
         bool m_isVTEnabled = true;
+        bool m_isOutputRedirected = false;
+        // Declared before the visualizers, which stop ticking on it when they are destroyed.
+        ProgressTicker m_progressTicker;
         std::optional<IndefiniteSpinner> m_spinner;
         std::optional<ProgressBar> m_progressBar;
         wil::srwlock m_progressCallbackLock;
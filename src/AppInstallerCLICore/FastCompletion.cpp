@@ -0,0 +1,59 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "FastCompletion.h"
+#include "Commands/CompleteCommand.h"
+#include "Commands/RootCommand.h"
+#include "ExecutionContext.h"
+#include "Invocation.h"
+
+namespace AppInstaller::CLI::FastCompletion
+{
+    std::optional<int> TryExecute(const std::vector<std::string>& utf8Args, std::ostream& out)
+    {
+        if (utf8Args.empty() || utf8Args[0] != CompleteCommand::CommandName)
+        {
+            return {};
+        }
+
+        try
+        {
+            Invocation invocation{ std::vector<std::string_view>(utf8Args.begin() + 1, utf8Args.end()) };
+
+            CompleteCommand completeCommand{ RootCommand{}.FullName() };
+            Execution::Args args;
+            completeCommand.ParseArguments(invocation, args);
+            completeCommand.ValidateArguments(args);
+
+            if (args.Contains(Execution::Args::Type::Help))
+            {
+                return {};
+            }
+
+            // The output is held until the completion is known to be done here, so that a completion run again by the full
+            // startup does not write anything twice.
+            std::ostringstream completionOut;
+
+            {
+                std::istringstream in;
+                Execution::Context context{ completionOut, in };
+                context.SetSourcesAllowed(false);
+
+                CompleteCommand::CompleteCommandLine(args, context);
+
+                if (context.GetTerminationHR() == Execution::Context::SourcesNotAllowedHR)
+                {
+                    return {};
+                }
+            }
+
+            out << completionOut.str();
+            return 0;
+        }
+        // Any failure is left for the full startup to run again and report
+        catch (...)
+        {
+            return {};
+        }
+    }
+}
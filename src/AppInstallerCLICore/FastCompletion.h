@@ -0,0 +1,19 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace AppInstaller::CLI::FastCompletion
+{
+    // The shell runs a completion for every press of the tab key, so one should pay for as little of the startup of the
+    // other commands as it can. A completion run here only parses the arguments of the commands on its command line and
+    // reads the completion indexes of the sources; it does not initialize WinRT, the loggers or telemetry, and an ASCII word
+    // is matched without ICU. A completion that needs to open a source is left to the full startup instead.
+
+    // Executes the command line if it is a completion that can be done without the full startup, writing its output to the
+    // given stream. Returns an empty optional if the command line must be executed by the full startup, having written nothing.
+    std::optional<int> TryExecute(const std::vector<std::string>& utf8Args, std::ostream& out);
+}
@@ -2,18 +2,28 @@
 // Licensed under the MIT License.
 #pragma once
 #include <map>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace AppInstaller::CLI
 {
     // Contains the raw command line arguments and functionality to iterate and consume them.
+    // The arguments are views, either of strings owned by the invocation or of a buffer that must outlive it.
     struct Invocation
     {
-        Invocation(std::vector<std::string>&& args) : m_args(std::move(args)) {}
+        Invocation(std::vector<std::string>&& args) : m_ownedArgs(std::move(args)), m_args(m_ownedArgs.begin(), m_ownedArgs.end()) {}
+        Invocation(std::vector<std::string_view>&& args) : m_args(std::move(args)) {}
+
+        Invocation(const Invocation&) = delete;
+        Invocation& operator=(const Invocation&) = delete;
+
+        Invocation(Invocation&&) = default;
+        Invocation& operator=(Invocation&&) = default;
 
         struct iterator
         {
-            iterator(size_t arg, std::vector<std::string>& args) : m_arg(arg), m_args(args) {}
+            iterator(size_t arg, std::vector<std::string_view>& args) : m_arg(arg), m_args(args) {}
 
             iterator(const iterator&) = default;
             iterator& operator=(const iterator&) = default;
@@ -26,14 +36,14 @@ namespace AppInstaller::CLI
             bool operator==(const iterator& other) const { return m_arg == other.m_arg; }
             bool operator!=(const iterator& other) const { return m_arg != other.m_arg; }
 
-            const std::string& operator*() const { return m_args[m_arg]; }
-            const std::string* operator->() const { return &(m_args[m_arg]); }
+            const std::string_view& operator*() const { return m_args[m_arg]; }
+            const std::string_view* operator->() const { return &(m_args[m_arg]); }
 
             size_t index() const { return m_arg; }
 
         private:
             size_t m_arg;
-            std::vector<std::string>& m_args;
+            std::vector<std::string_view>& m_args;
         };
 
         size_t size() const { return m_args.size(); }
@@ -42,7 +52,8 @@ namespace AppInstaller::CLI
         void consume(const iterator& i) { m_currentFirstArg = i.index() + 1; }
 
     private:
-        std::vector<std::string> m_args;
+        std::vector<std::string> m_ownedArgs;
+        std::vector<std::string_view> m_args;
         size_t m_currentFirstArg = 0;
     };
 }
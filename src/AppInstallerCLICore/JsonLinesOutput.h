@@ -0,0 +1,34 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "ExecutionReporter.h"
+
+#include <json.h>
+
+#include <ostream>
+#include <string>
+
+
+namespace AppInstaller::CLI::Execution
+{
+    // Writes objects as JSON Lines, one compact object per line, for the output formats meant for other tools.
+    // Unlike a table, nothing is held back to lay out the columns; each line is written as soon as it is given.
+    struct JsonLinesOutput
+    {
+        JsonLinesOutput(Reporter& reporter) : m_reporter(reporter)
+        {
+            m_builder["indentation"] = "";
+            m_builder["commentStyle"] = "None";
+            m_builder["emitUTF8"] = true;
+        }
+
+        void OutputLine(const Json::Value& value)
+        {
+            m_reporter.Data() << Json::writeString(m_builder, value) << std::endl;
+        }
+
+    private:
+        Reporter& m_reporter;
+        Json::StreamWriterBuilder m_builder;
+    };
+}
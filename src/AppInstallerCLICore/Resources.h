@@ -33,7 +33,13 @@ namespace AppInstaller::CLI::Resource
         WINGET_DEFINE_RESOURCE_STRINGID(AvailableCommands);
         WINGET_DEFINE_RESOURCE_STRINGID(AvailableOptions);
         WINGET_DEFINE_RESOURCE_STRINGID(AvailableSubcommands);
+        WINGET_DEFINE_RESOURCE_STRINGID(BatchCommandLongDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(BatchCommandShortDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(BatchFileArgumentDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(BatchLineFailed);
+        WINGET_DEFINE_RESOURCE_STRINGID(BatchNestedNotSupported);
         WINGET_DEFINE_RESOURCE_STRINGID(ChannelArgumentDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(ChunkSizeArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(Command);
         WINGET_DEFINE_RESOURCE_STRINGID(CommandArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(CommandLineArgumentDescription);
@@ -61,16 +67,22 @@ namespace AppInstaller::CLI::Resource
         WINGET_DEFINE_RESOURCE_STRINGID(FlagContainAdjoinedError);
         WINGET_DEFINE_RESOURCE_STRINGID(HashCommandLongDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(HashCommandShortDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(HashFileFailed);
         WINGET_DEFINE_RESOURCE_STRINGID(HelpArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(HelpForDetails);
         WINGET_DEFINE_RESOURCE_STRINGID(HelpLinkPreamble);
         WINGET_DEFINE_RESOURCE_STRINGID(IdArgumentDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(IdFileArgumentDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(IdFileArgumentNotSupported);
+        WINGET_DEFINE_RESOURCE_STRINGID(IdFileIdNotFound);
         WINGET_DEFINE_RESOURCE_STRINGID(InstallationDisclaimer1);
         WINGET_DEFINE_RESOURCE_STRINGID(InstallationDisclaimer2);
         WINGET_DEFINE_RESOURCE_STRINGID(InstallationDisclaimerMSStore);
         WINGET_DEFINE_RESOURCE_STRINGID(InstallationRequiresHigherWindows);
         WINGET_DEFINE_RESOURCE_STRINGID(InstallCommandLongDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(InstallCommandShortDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(InstallerFoundInCache);
+        WINGET_DEFINE_RESOURCE_STRINGID(InstallerFoundInSource);
         WINGET_DEFINE_RESOURCE_STRINGID(InstallerHashMismatchAdminBlock);
         WINGET_DEFINE_RESOURCE_STRINGID(InstallerHashMismatchOverridden);
         WINGET_DEFINE_RESOURCE_STRINGID(InstallerHashMismatchOverrideRequired);
@@ -81,6 +93,7 @@ namespace AppInstaller::CLI::Resource
         WINGET_DEFINE_RESOURCE_STRINGID(InteractiveArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(InvalidAliasError);
         WINGET_DEFINE_RESOURCE_STRINGID(InvalidArgumentSpecifierError);
+        WINGET_DEFINE_RESOURCE_STRINGID(InvalidChunkSizeError);
         WINGET_DEFINE_RESOURCE_STRINGID(InvalidNameError);
         WINGET_DEFINE_RESOURCE_STRINGID(LanguageArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(LicenseAgreement);
@@ -105,6 +118,10 @@ namespace AppInstaller::CLI::Resource
         WINGET_DEFINE_RESOURCE_STRINGID(MSStoreInstallGetEntitlementSuccess);
         WINGET_DEFINE_RESOURCE_STRINGID(MSStoreInstallStoreClientBlocked);
         WINGET_DEFINE_RESOURCE_STRINGID(MSStoreInstallTryGetEntitlement);
+        WINGET_DEFINE_RESOURCE_STRINGID(MultipleInstallArgumentNotSupported);
+        WINGET_DEFINE_RESOURCE_STRINGID(MultipleInstallDuplicatePackage);
+        WINGET_DEFINE_RESOURCE_STRINGID(MultipleInstallFailed);
+        WINGET_DEFINE_RESOURCE_STRINGID(MultipleInstallProgress);
         WINGET_DEFINE_RESOURCE_STRINGID(MultiplePackagesFound);
         WINGET_DEFINE_RESOURCE_STRINGID(NameArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(NoApplicableInstallers);
@@ -112,9 +129,16 @@ namespace AppInstaller::CLI::Resource
         WINGET_DEFINE_RESOURCE_STRINGID(NoPackageFound);
         WINGET_DEFINE_RESOURCE_STRINGID(NoVTArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(Options);
+        WINGET_DEFINE_RESOURCE_STRINGID(OutputArgumentDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(OutputFormatNotSupported);
         WINGET_DEFINE_RESOURCE_STRINGID(OverrideArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(Package);
         WINGET_DEFINE_RESOURCE_STRINGID(PendingWorkError);
+        WINGET_DEFINE_RESOURCE_STRINGID(PerfArgumentDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(PerfSummaryCount);
+        WINGET_DEFINE_RESOURCE_STRINGID(PerfSummaryLongest);
+        WINGET_DEFINE_RESOURCE_STRINGID(PerfSummaryOperation);
+        WINGET_DEFINE_RESOURCE_STRINGID(PerfSummaryTotal);
         WINGET_DEFINE_RESOURCE_STRINGID(PositionArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(PreviewVersion);
         WINGET_DEFINE_RESOURCE_STRINGID(PrivacyStatement);
@@ -128,8 +152,12 @@ namespace AppInstaller::CLI::Resource
         WINGET_DEFINE_RESOURCE_STRINGID(SearchMatch);
         WINGET_DEFINE_RESOURCE_STRINGID(SearchName);
         WINGET_DEFINE_RESOURCE_STRINGID(SearchSource);
+        WINGET_DEFINE_RESOURCE_STRINGID(SearchSourceTimedOut);
         WINGET_DEFINE_RESOURCE_STRINGID(SearchTruncated);
         WINGET_DEFINE_RESOURCE_STRINGID(SearchVersion);
+        WINGET_DEFINE_RESOURCE_STRINGID(ServerCommandLongDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(ServerCommandShortDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(ServerListening);
         WINGET_DEFINE_RESOURCE_STRINGID(SettingLoadFailure);
         WINGET_DEFINE_RESOURCE_STRINGID(SettingsCommandLongDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(SettingsCommandShortDescription);
@@ -155,6 +183,7 @@ namespace AppInstaller::CLI::Resource
         WINGET_DEFINE_RESOURCE_STRINGID(SourceListCommandShortDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceListData);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceListField);
+        WINGET_DEFINE_RESOURCE_STRINGID(SourceListMirrors);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceListName);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceListNoneFound);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceListNoSources);
@@ -162,6 +191,7 @@ namespace AppInstaller::CLI::Resource
         WINGET_DEFINE_RESOURCE_STRINGID(SourceListUpdated);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceListUpdatedNever);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceListValue);
+        WINGET_DEFINE_RESOURCE_STRINGID(SourceMirrorArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceNameArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceRemoveAll);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceRemoveCommandLongDescription);
@@ -173,11 +203,13 @@ namespace AppInstaller::CLI::Resource
         WINGET_DEFINE_RESOURCE_STRINGID(SourceResetForceArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceResetListAndOverridePreamble);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceResetOne);
+        WINGET_DEFINE_RESOURCE_STRINGID(SourceScheduledArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceTypeArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceUpdateAll);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceUpdateCommandLongDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceUpdateCommandShortDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(SourceUpdateOne);
+        WINGET_DEFINE_RESOURCE_STRINGID(SourceUpdateScheduleFailed);
         WINGET_DEFINE_RESOURCE_STRINGID(TagArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(ThankYou);
         WINGET_DEFINE_RESOURCE_STRINGID(ThirdPartSoftwareNotices);
@@ -188,10 +220,19 @@ namespace AppInstaller::CLI::Resource
         WINGET_DEFINE_RESOURCE_STRINGID(TooManyBehaviorsError);
         WINGET_DEFINE_RESOURCE_STRINGID(UnexpectedErrorExecutingCommand);
         WINGET_DEFINE_RESOURCE_STRINGID(UnrecognizedCommand);
+        WINGET_DEFINE_RESOURCE_STRINGID(UpgradeAllArgumentDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(UpgradeAvailableCount);
+        WINGET_DEFINE_RESOURCE_STRINGID(UpgradeAvailableVersion);
+        WINGET_DEFINE_RESOURCE_STRINGID(UpgradeCommandLongDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(UpgradeCommandShortDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(UpgradeFailed);
+        WINGET_DEFINE_RESOURCE_STRINGID(UpgradeNoneAvailable);
+        WINGET_DEFINE_RESOURCE_STRINGID(UpgradeUseAllHint);
         WINGET_DEFINE_RESOURCE_STRINGID(Usage);
         WINGET_DEFINE_RESOURCE_STRINGID(ValidateCommandLongDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(ValidateCommandShortDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(ValidateManifestArgumentDescription);
+        WINGET_DEFINE_RESOURCE_STRINGID(ValidationCacheArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(VerboseLogsArgumentDescription);
         WINGET_DEFINE_RESOURCE_STRINGID(VerifyFileSignedMsix);
         WINGET_DEFINE_RESOURCE_STRINGID(VersionArgumentDescription);
@@ -0,0 +1,558 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Server.h"
+#include "VTSupport.h"
+#include <winget/MemoryBudget.h>
+
+#include <sddl.h>
+
+using namespace std::chrono_literals;
+
+namespace AppInstaller::CLI::Server
+{
+    namespace
+    {
+        constexpr std::wstring_view s_PipeNamePrefix = L"\\\\.\\pipe\\WinGetServer_";
+        constexpr std::wstring_view s_ElevatedPipeNameSuffix = L"_Elevated";
+
+        // Must be changed whenever the messages change; a server does not accept a request of another version.
+        constexpr uint32_t s_ProtocolVersion = 1;
+
+        // Flags of a request.
+        constexpr uint32_t s_RequestFlag_VTEnabled = 0x1;
+
+        // Messages larger than this are not valid; output is sent in messages of at most the output buffer size.
+        constexpr uint32_t s_MaximumMessageSize = 16 * 1024 * 1024;
+        constexpr size_t s_OutputBufferSize = 4096;
+
+        // How long a client waits for a busy server before executing the command line itself.
+        constexpr DWORD s_ClientWaitTimeoutMilliseconds = 2000;
+
+        // How often a waiting server checks whether it has been terminated.
+        constexpr std::chrono::milliseconds s_ServerWaitInterval = 1s;
+
+        // A request is answered with Accepted before its command line is executed, so that a client that does not
+        // receive it knows that the command line was not executed and can execute it itself.
+        enum class MessageType : uint32_t
+        {
+            Request = 1,
+            Accepted,
+            Output,
+            Result,
+        };
+
+        struct MessageHeader
+        {
+            uint32_t Type;
+            uint32_t Size;
+        };
+        static_assert(sizeof(MessageHeader) == 8);
+
+        // The payload of a message is malformed.
+        constexpr HRESULT s_InvalidMessageError = HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+        struct PayloadWriter
+        {
+            void WriteUInt32(uint32_t value)
+            {
+                Data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+            }
+
+            void WriteString(std::string_view value)
+            {
+                WriteUInt32(wil::safe_cast<uint32_t>(value.size()));
+                Data.append(value);
+            }
+
+            std::string Data;
+        };
+
+        struct PayloadReader
+        {
+            PayloadReader(std::string_view data) : m_data(data) {}
+
+            uint32_t ReadUInt32()
+            {
+                uint32_t value = 0;
+                std::string_view bytes = ReadRaw(sizeof(value));
+                std::memcpy(&value, bytes.data(), sizeof(value));
+                return value;
+            }
+
+            std::string ReadString()
+            {
+                return std::string{ ReadRaw(ReadUInt32()) };
+            }
+
+        private:
+            std::string_view ReadRaw(size_t size)
+            {
+                THROW_HR_IF(s_InvalidMessageError, size > m_data.size());
+                std::string_view result = m_data.substr(0, size);
+                m_data.remove_prefix(size);
+                return result;
+            }
+
+            std::string_view m_data;
+        };
+
+        // Reads and writes messages on a connected pipe.
+        struct PipeConnection
+        {
+            // The event is required when the pipe was opened for overlapped operations.
+            PipeConnection(HANDLE pipe, HANDLE event = nullptr) : m_pipe(pipe), m_event(event) {}
+
+            // Returns false if the other end has closed the pipe.
+            bool WriteMessage(MessageType type, std::string_view payload)
+            {
+                MessageHeader header{ static_cast<uint32_t>(type), wil::safe_cast<uint32_t>(payload.size()) };
+
+                std::string message{ reinterpret_cast<const char*>(&header), sizeof(header) };
+                message.append(payload);
+
+                return Transfer(message.data(), message.size(), true);
+            }
+
+            // Returns false if the other end has closed the pipe.
+            bool ReadMessage(MessageType& type, std::string& payload)
+            {
+                MessageHeader header{};
+                if (!Transfer(&header, sizeof(header), false))
+                {
+                    return false;
+                }
+
+                THROW_HR_IF(s_InvalidMessageError, header.Size > s_MaximumMessageSize);
+
+                type = static_cast<MessageType>(header.Type);
+                payload.resize(header.Size);
+                return Transfer(payload.data(), payload.size(), false);
+            }
+
+        private:
+            bool Transfer(void* data, size_t size, bool write)
+            {
+                uint8_t* bytes = static_cast<uint8_t*>(data);
+
+                while (size > 0)
+                {
+                    OVERLAPPED overlapped{};
+                    overlapped.hEvent = m_event;
+                    LPOVERLAPPED overlappedPtr = (m_event ? &overlapped : nullptr);
+
+                    DWORD requested = static_cast<DWORD>(std::min<size_t>(size, s_MaximumMessageSize));
+                    DWORD transferred = 0;
+                    BOOL succeeded = (write ?
+                        WriteFile(m_pipe, bytes, requested, &transferred, overlappedPtr) :
+                        ReadFile(m_pipe, bytes, requested, &transferred, overlappedPtr));
+
+                    if (!succeeded && GetLastError() == ERROR_IO_PENDING)
+                    {
+                        succeeded = GetOverlappedResult(m_pipe, &overlapped, &transferred, TRUE);
+                    }
+
+                    if (!succeeded)
+                    {
+                        DWORD error = GetLastError();
+                        if (error == ERROR_BROKEN_PIPE || error == ERROR_NO_DATA || error == ERROR_PIPE_NOT_CONNECTED)
+                        {
+                            return false;
+                        }
+
+                        THROW_WIN32(error);
+                    }
+
+                    bytes += transferred;
+                    size -= transferred;
+                }
+
+                return true;
+            }
+
+            HANDLE m_pipe;
+            HANDLE m_event;
+        };
+
+        // Sends the output of a command to the client as it is written.
+        // If the client disconnects, the context of the command is terminated and the output that follows is discarded.
+        struct OutputBuffer : public std::streambuf
+        {
+            OutputBuffer(PipeConnection& connection) : m_connection(connection)
+            {
+                setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+            }
+
+            // Sets the context to terminate if the client disconnects.
+            void SetContext(Execution::Context* context) { m_context = context; }
+
+            bool IsDisconnected() const { return m_disconnected; }
+
+        protected:
+            int_type overflow(int_type ch) override
+            {
+                if (!Send())
+                {
+                    return traits_type::eof();
+                }
+
+                if (!traits_type::eq_int_type(ch, traits_type::eof()))
+                {
+                    *pptr() = traits_type::to_char_type(ch);
+                    pbump(1);
+                }
+
+                return traits_type::not_eof(ch);
+            }
+
+            int sync() override
+            {
+                return (Send() ? 0 : -1);
+            }
+
+        private:
+            bool Send()
+            {
+                std::string_view pending{ pbase(), static_cast<size_t>(pptr() - pbase()) };
+                setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+
+                if (m_disconnected)
+                {
+                    return false;
+                }
+
+                if (pending.empty())
+                {
+                    return true;
+                }
+
+                bool sent = false;
+                try
+                {
+                    sent = m_connection.WriteMessage(MessageType::Output, pending);
+                }
+                CATCH_LOG();
+
+                if (!sent)
+                {
+                    AICLI_LOG(CLI, Info, << "Client disconnected, terminating its command");
+                    m_disconnected = true;
+
+                    if (m_context)
+                    {
+                        m_context->Terminate(E_ABORT);
+                    }
+                }
+
+                return sent;
+            }
+
+            PipeConnection& m_connection;
+            std::array<char, s_OutputBufferSize> m_buffer;
+            Execution::Context* m_context = nullptr;
+            bool m_disconnected = false;
+        };
+
+        bool IsElevated(HANDLE token)
+        {
+            TOKEN_ELEVATION elevation{};
+            DWORD size = 0;
+            THROW_IF_WIN32_BOOL_FALSE(GetTokenInformation(token, TokenElevation, &elevation, sizeof(elevation), &size));
+            return elevation.TokenIsElevated != 0;
+        }
+
+        std::wstring GetCurrentUserSid()
+        {
+            auto userToken = wil::get_token_information<TOKEN_USER>();
+
+            wil::unique_hlocal_string sidString;
+            THROW_IF_WIN32_BOOL_FALSE(ConvertSidToStringSidW(userToken->User.Sid, &sidString));
+            return sidString.get();
+        }
+
+        // Another user could create the pipe before the server does, so the client only trusts a server of its own user and elevation.
+        bool IsServerTrusted(HANDLE pipe)
+        {
+            ULONG serverProcessId = 0;
+            THROW_IF_WIN32_BOOL_FALSE(GetNamedPipeServerProcessId(pipe, &serverProcessId));
+
+            wil::unique_handle serverProcess{ OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, serverProcessId) };
+            THROW_LAST_ERROR_IF(!serverProcess);
+
+            wil::unique_handle serverToken;
+            THROW_IF_WIN32_BOOL_FALSE(OpenProcessToken(serverProcess.get(), TOKEN_QUERY, &serverToken));
+
+            auto serverUser = wil::get_token_information<TOKEN_USER>(serverToken.get());
+            auto currentUser = wil::get_token_information<TOKEN_USER>();
+
+            return EqualSid(serverUser->User.Sid, currentUser->User.Sid) && IsElevated(serverToken.get()) == IsElevated(GetCurrentProcessToken());
+        }
+
+        // Only the current user may connect; an elevated server also requires its clients to be elevated.
+        wil::unique_hlocal_security_descriptor CreatePipeSecurityDescriptor()
+        {
+            std::wstring sddl = L"D:P(A;;GA;;;" + GetCurrentUserSid() + L")";
+            if (IsElevated(GetCurrentProcessToken()))
+            {
+                sddl += L"S:(ML;;NWNRNX;;;HI)";
+            }
+
+            wil::unique_hlocal_security_descriptor result;
+            THROW_IF_WIN32_BOOL_FALSE(ConvertStringSecurityDescriptorToSecurityDescriptorW(sddl.c_str(), SDDL_REVISION_1, &result, nullptr));
+            return result;
+        }
+
+        // Waits for a client to connect; returns false if the server is terminated or idle for the timeout first.
+        bool WaitForClient(HANDLE pipe, HANDLE event, Execution::Context& context, std::chrono::steady_clock::time_point idleDeadline)
+        {
+            OVERLAPPED overlapped{};
+            overlapped.hEvent = event;
+
+            if (ConnectNamedPipe(pipe, &overlapped))
+            {
+                return true;
+            }
+
+            DWORD error = GetLastError();
+            if (error == ERROR_PIPE_CONNECTED)
+            {
+                return true;
+            }
+
+            THROW_WIN32_IF(error, error != ERROR_IO_PENDING);
+
+            for (;;)
+            {
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(idleDeadline - std::chrono::steady_clock::now());
+                if (context.IsTerminated() || remaining <= 0ms)
+                {
+                    CancelIoEx(pipe, &overlapped);
+
+                    DWORD ignored = 0;
+                    return GetOverlappedResult(pipe, &overlapped, &ignored, TRUE) != FALSE;
+                }
+
+                if (WaitForSingleObject(event, static_cast<DWORD>(std::min(remaining, s_ServerWaitInterval).count())) == WAIT_OBJECT_0)
+                {
+                    DWORD ignored = 0;
+                    THROW_IF_WIN32_BOOL_FALSE(GetOverlappedResult(pipe, &overlapped, &ignored, FALSE));
+                    return true;
+                }
+            }
+        }
+
+        void ServeClient(HANDLE pipe, HANDLE event, const ExecuteFunction& execute)
+        {
+            PipeConnection connection{ pipe, event };
+
+            MessageType type{};
+            std::string payload;
+            if (!connection.ReadMessage(type, payload) || type != MessageType::Request)
+            {
+                return;
+            }
+
+            PayloadReader reader{ payload };
+            uint32_t version = reader.ReadUInt32();
+            if (version != s_ProtocolVersion)
+            {
+                AICLI_LOG(CLI, Warning, << "Rejecting request of protocol version " << version);
+                return;
+            }
+
+            uint32_t flags = reader.ReadUInt32();
+            std::filesystem::path workingDirectory = std::filesystem::u8path(reader.ReadString());
+
+            std::vector<std::string> utf8Args(reader.ReadUInt32());
+            for (auto& arg : utf8Args)
+            {
+                arg = reader.ReadString();
+            }
+
+            // Paths in the arguments are relative to the working directory of the client
+            std::filesystem::current_path(workingDirectory);
+
+            if (!connection.WriteMessage(MessageType::Accepted, {}))
+            {
+                return;
+            }
+
+            OutputBuffer buffer{ connection };
+            std::ostream out{ &buffer };
+            std::istringstream in;
+
+            int result = 0;
+            {
+                Execution::Context requestContext{ out, in };
+                requestContext.EnableCtrlHandler();
+
+                if ((flags & s_RequestFlag_VTEnabled) == 0)
+                {
+                    requestContext.Reporter.SetStyle(Settings::VisualStyle::NoVT);
+                }
+
+                buffer.SetContext(&requestContext);
+                try
+                {
+                    result = execute(requestContext, std::move(utf8Args));
+                }
+                catch (...)
+                {
+                    LOG_CAUGHT_EXCEPTION();
+                    result = APPINSTALLER_CLI_ERROR_INTERNAL_ERROR;
+                }
+                buffer.SetContext(nullptr);
+            }
+
+            out.flush();
+            if (buffer.IsDisconnected())
+            {
+                return;
+            }
+
+            PayloadWriter resultPayload;
+            resultPayload.WriteUInt32(static_cast<uint32_t>(result));
+            if (connection.WriteMessage(MessageType::Result, resultPayload.Data))
+            {
+                // Disconnecting discards what the client has not read yet
+                LOG_IF_WIN32_BOOL_FALSE(FlushFileBuffers(pipe));
+            }
+        }
+    }
+
+    std::wstring GetPipeName()
+    {
+        std::wstring result{ s_PipeNamePrefix };
+        result += GetCurrentUserSid();
+
+        if (IsElevated(GetCurrentProcessToken()))
+        {
+            result += s_ElevatedPipeNameSuffix;
+        }
+
+        return result;
+    }
+
+    std::optional<int> TryExecute(const std::vector<std::string>& utf8Args, std::ostream& out, const std::wstring& pipeName)
+    {
+        wil::unique_hfile pipe;
+
+        for (;;)
+        {
+            // The client is only identified to the server, which executes the command line as itself
+            pipe.reset(CreateFileW(pipeName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, SECURITY_SQOS_PRESENT | SECURITY_IDENTIFICATION, nullptr));
+            if (pipe)
+            {
+                break;
+            }
+
+            // The server executes one command line at a time; a client that waits too long executes the command line itself
+            DWORD error = GetLastError();
+            if (error != ERROR_PIPE_BUSY || !WaitNamedPipeW(pipeName.c_str(), s_ClientWaitTimeoutMilliseconds))
+            {
+                AICLI_LOG(CLI, Verbose, << "No server available, error: " << error);
+                return {};
+            }
+        }
+
+        if (!IsServerTrusted(pipe.get()))
+        {
+            AICLI_LOG(CLI, Warning, << "The process listening on the server pipe is not of the current user and elevation");
+            return {};
+        }
+
+        PayloadWriter request;
+        request.WriteUInt32(s_ProtocolVersion);
+        request.WriteUInt32(VirtualTerminal::ConsoleModeRestore::Instance().IsVTEnabled() ? s_RequestFlag_VTEnabled : 0);
+        request.WriteString(std::filesystem::current_path().u8string());
+        request.WriteUInt32(wil::safe_cast<uint32_t>(utf8Args.size()));
+        for (const auto& arg : utf8Args)
+        {
+            request.WriteString(arg);
+        }
+
+        PipeConnection connection{ pipe.get() };
+        MessageType type{};
+        std::string payload;
+
+        if (!connection.WriteMessage(MessageType::Request, request.Data) ||
+            !connection.ReadMessage(type, payload) ||
+            type != MessageType::Accepted)
+        {
+            AICLI_LOG(CLI, Warning, << "The server did not accept the request");
+            return {};
+        }
+
+        AICLI_LOG(CLI, Info, << "Command line is being executed by the server");
+
+        for (;;)
+        {
+            if (!connection.ReadMessage(type, payload))
+            {
+                AICLI_LOG(CLI, Error, << "The server disconnected before the command completed");
+                return HRESULT_FROM_WIN32(ERROR_BROKEN_PIPE);
+            }
+
+            switch (type)
+            {
+            case MessageType::Output:
+                out.write(payload.data(), payload.size());
+                out.flush();
+                break;
+            case MessageType::Result:
+                return static_cast<int>(PayloadReader{ payload }.ReadUInt32());
+            default:
+                THROW_HR(s_InvalidMessageError);
+            }
+        }
+    }
+
+    void Run(Execution::Context& context, std::chrono::milliseconds idleTimeout, const ExecuteFunction& execute, const std::wstring& pipeName)
+    {
+        wil::unique_hlocal_security_descriptor securityDescriptor = CreatePipeSecurityDescriptor();
+        SECURITY_ATTRIBUTES securityAttributes{ sizeof(SECURITY_ATTRIBUTES), securityDescriptor.get(), FALSE };
+
+        // The single instance of the pipe is reused for every client, so that no other process can create one in between
+        wil::unique_hfile pipe{ CreateNamedPipeW(
+            pipeName.c_str(),
+            PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+            PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+            1,
+            static_cast<DWORD>(s_OutputBufferSize),
+            static_cast<DWORD>(s_OutputBufferSize),
+            0,
+            &securityAttributes) };
+        THROW_LAST_ERROR_IF_MSG(!pipe, "failed creating the server pipe; is another server running?");
+
+        wil::unique_event event{ wil::EventOptions::ManualReset };
+
+        AICLI_LOG(CLI, Info, << "Server listening on pipe: " << Utility::ConvertToUTF8(pipeName));
+
+        while (WaitForClient(pipe.get(), event.get(), context, std::chrono::steady_clock::now() + idleTimeout))
+        {
+            try
+            {
+                ServeClient(pipe.get(), event.get(), execute);
+            }
+            CATCH_LOG();
+
+            LOG_IF_WIN32_BOOL_FALSE(DisconnectNamedPipe(pipe.get()));
+
+            // Background source updates started by the command would have completed as its process exited
+            try
+            {
+                Repository::CompleteBackgroundSourceUpdates();
+            }
+            CATCH_LOG();
+
+            // What the command kept in memory is trimmed to the budget before the server waits for the next one
+            try
+            {
+                Memory::MemoryBudget::Instance().TrimIfOverBudget();
+            }
+            CATCH_LOG();
+        }
+
+        AICLI_LOG(CLI, Info, << "Server stopping");
+    }
+}
@@ -0,0 +1,32 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "ExecutionContext.h"
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace AppInstaller::CLI::Server
+{
+    // A server keeps a single process running to execute the command lines of scripts that invoke winget many times,
+    // so that each of them does not pay for starting the process, reading the settings and loading the sources again.
+    // The server only accepts clients of the same user and elevation as itself, and executes one command line at a time.
+
+    // Gets the name of the pipe that the server for the current user and elevation listens on.
+    std::wstring GetPipeName();
+
+    // Executes the command line on the server listening on the pipe, writing the output of the command to the given stream.
+    // Returns an empty optional if no server is listening, in which case the command line must be executed by this process.
+    std::optional<int> TryExecute(const std::vector<std::string>& utf8Args, std::ostream& out, const std::wstring& pipeName = GetPipeName());
+
+    // The function that executes a command line received by the server in the given context, returning its result.
+    using ExecuteFunction = std::function<int(Execution::Context&, std::vector<std::string>)>;
+
+    // Executes the command lines received on the pipe, one at a time, until none has been received for the idle timeout
+    // or the given context is terminated.
+    void Run(Execution::Context& context, std::chrono::milliseconds idleTimeout, const ExecuteFunction& execute, const std::wstring& pipeName = GetPipeName());
+}
@@ -30,6 +30,8 @@ namespace AppInstaller::CLI::Execution
     }
 
     // Enables output data in a table format.
+    // The columns are sized from the first sizingBuffer lines, which are held until then; later lines are output as they are given,
+    // so the time until the first line is shown does not depend on the number of lines.
     template <size_t FieldCount>
     struct TableOutput
     {
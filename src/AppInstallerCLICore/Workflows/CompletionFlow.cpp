@@ -23,6 +23,56 @@ namespace AppInstaller::CLI::Workflow
                 stream << value << std::endl;
             }
         }
+
+        // Outputs the values of the field from the completion indexes of the sources, without opening them.
+        // Filters and a maximum count can only be applied by a search, so a completion that has either is never answered this way.
+        // Returns false if the sources must be searched instead.
+        bool TryCompleteFromCompletionIndexes(Execution::Context& context, Repository::ApplicationMatchField field)
+        {
+            for (auto arg : { Execution::Args::Type::Id, Execution::Args::Type::Name, Execution::Args::Type::Moniker, Execution::Args::Type::Tag, Execution::Args::Type::Command, Execution::Args::Type::Count })
+            {
+                if (context.Args.Contains(arg))
+                {
+                    return false;
+                }
+            }
+
+            try
+            {
+                std::string_view sourceName;
+                if (context.Args.Contains(Execution::Args::Type::Source))
+                {
+                    sourceName = context.Args.GetArg(Execution::Args::Type::Source);
+                }
+
+                auto completions = Repository::GetCompletionsFromIndexes(sourceName, field, context.Get<Data::CompletionData>().Word());
+                if (completions)
+                {
+                    auto stream = context.Reporter.Completion();
+                    for (const auto& completion : completions.value())
+                    {
+                        OutputCompletionString(stream, completion);
+                    }
+
+                    return true;
+                }
+            }
+            CATCH_LOG();
+
+            return false;
+        }
+
+        // Outputs the values of the field that start with the completion word, searching the source if it has no completion index.
+        void CompleteWithField(Execution::Context& context, Repository::ApplicationMatchField field)
+        {
+            if (!TryCompleteFromCompletionIndexes(context, field))
+            {
+                context <<
+                    Workflow::OpenSource <<
+                    Workflow::SearchSourceForCompletionField(field) <<
+                    Workflow::CompleteWithMatchedField;
+            }
+        }
     }
 
     void CompleteSourceName(Execution::Context& context)
@@ -71,13 +121,13 @@ namespace AppInstaller::CLI::Workflow
         const std::string& word = context.Get<Data::CompletionData>().Word();
         auto stream = context.Reporter.Completion();
 
-        for (const auto& vc : context.Get<Execution::Data::SearchResult>().Matches[0].Application->GetVersions())
+        // Only the versions that begin with the word are read
+        Repository::VersionQuery query;
+        query.Prefix = word;
+
+        for (const auto& vc : context.Get<Execution::Data::SearchResult>().Matches[0].Application->GetVersions(query))
         {
-            std::string version = vc.GetVersion().ToString();
-            if (word.empty() || Utility::CaseInsensitiveStartsWith(version, word))
-            {
-                OutputCompletionString(stream, version);
-            }
+            OutputCompletionString(stream, vc.GetVersion().ToString());
         }
     }
 
@@ -119,34 +169,19 @@ namespace AppInstaller::CLI::Workflow
             // Intentionally output none to enable pass through to filesystem.
             break;
         case Execution::Args::Type::Id:
-            context <<
-                Workflow::OpenSource <<
-                Workflow::SearchSourceForCompletionField(Repository::ApplicationMatchField::Id) <<
-                Workflow::CompleteWithMatchedField;
+            CompleteWithField(context, Repository::ApplicationMatchField::Id);
             break;
         case Execution::Args::Type::Name:
-            context <<
-                Workflow::OpenSource <<
-                Workflow::SearchSourceForCompletionField(Repository::ApplicationMatchField::Name) <<
-                Workflow::CompleteWithMatchedField;
+            CompleteWithField(context, Repository::ApplicationMatchField::Name);
             break;
         case Execution::Args::Type::Moniker:
-            context <<
-                Workflow::OpenSource <<
-                Workflow::SearchSourceForCompletionField(Repository::ApplicationMatchField::Moniker) <<
-                Workflow::CompleteWithMatchedField;
+            CompleteWithField(context, Repository::ApplicationMatchField::Moniker);
             break;
         case Execution::Args::Type::Tag:
-            context <<
-                Workflow::OpenSource <<
-                Workflow::SearchSourceForCompletionField(Repository::ApplicationMatchField::Tag) <<
-                Workflow::CompleteWithMatchedField;
+            CompleteWithField(context, Repository::ApplicationMatchField::Tag);
             break;
         case Execution::Args::Type::Command:
-            context <<
-                Workflow::OpenSource <<
-                Workflow::SearchSourceForCompletionField(Repository::ApplicationMatchField::Command) <<
-                Workflow::CompleteWithMatchedField;
+            CompleteWithField(context, Repository::ApplicationMatchField::Command);
             break;
         case Execution::Args::Type::Version:
             // Here we require that the standard search finds a single entry, and we list those versions.
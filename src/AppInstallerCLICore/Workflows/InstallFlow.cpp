@@ -5,6 +5,7 @@
 #include "Resources.h"
 #include "ShellExecuteInstallerHandler.h"
 #include "WorkflowBase.h"
+#include <winget/InstallerCache.h>
 
 namespace AppInstaller::CLI::Workflow
 {
@@ -15,6 +16,177 @@ namespace AppInstaller::CLI::Workflow
     using namespace AppInstaller::Utility;
     using namespace AppInstaller::Manifest;
 
+    namespace
+    {
+        // How often a wait for a background download checks whether it was cancelled.
+        constexpr std::chrono::milliseconds s_InstallerDownloadWaitInterval = std::chrono::milliseconds(100);
+
+        // The most packages that InstallPackages installs at once.
+        constexpr size_t s_MaxConcurrentInstalls = 4;
+
+        std::filesystem::path GetInstallerDownloadPath(const Manifest::Manifest& manifest)
+        {
+            std::filesystem::path result = Runtime::GetPathTo(Runtime::PathName::Temp);
+            result /= Utility::ConvertToUTF16(manifest.Id + '.' + manifest.Version);
+            return result;
+        }
+
+        // Determines whether DownloadInstaller downloads the installer file, rather than letting the installer read it from its url.
+        bool IsInstallerFileDownloaded(const ManifestInstaller& installer)
+        {
+            switch (installer.InstallerType)
+            {
+            case ManifestInstaller::InstallerTypeEnum::Exe:
+            case ManifestInstaller::InstallerTypeEnum::Burn:
+            case ManifestInstaller::InstallerTypeEnum::Inno:
+            case ManifestInstaller::InstallerTypeEnum::Msi:
+            case ManifestInstaller::InstallerTypeEnum::Nullsoft:
+            case ManifestInstaller::InstallerTypeEnum::Wix:
+                return true;
+            case ManifestInstaller::InstallerTypeEnum::Msix:
+                return installer.SignatureSha256.empty();
+            default:
+                return false;
+            }
+        }
+
+        // Gets the url of the installer, followed by its mirrors.
+        std::vector<std::string> GetInstallerUrls(const ManifestInstaller& installer)
+        {
+            std::vector<std::string> result{ installer.Url };
+            result.insert(result.end(), installer.MirrorUrls.begin(), installer.MirrorUrls.end());
+            return result;
+        }
+
+        // Asks the source that the package was found in for the installer, so that one it holds, such as in a bundle, is not downloaded.
+        // Any failure only means that the installer is downloaded instead.
+        bool TryGetInstallerFromSource(Execution::Context& context, const ManifestInstaller& installer, const std::filesystem::path& path)
+        {
+            if (!context.Contains(Execution::Data::Source))
+            {
+                return false;
+            }
+
+            try
+            {
+                const auto& source = context.Get<Execution::Data::Source>();
+                return source && source->TryGetInstaller(installer.Sha256, path);
+            }
+            CATCH_LOG();
+
+            return false;
+        }
+    }
+
+    // An installer that is downloaded on another thread, while the context it belongs to waits for its turn to install.
+    // Its progress is kept until DownloadInstallerFile waits for it, and then reported to the waiting progress callback.
+    struct InstallerDownload : public IProgressSink
+    {
+        InstallerDownload(std::filesystem::path path) : m_path(std::move(path)) {}
+
+        InstallerDownload(const InstallerDownload&) = delete;
+        InstallerDownload& operator=(const InstallerDownload&) = delete;
+
+        // An abandoned download is cancelled rather than completed, and what it wrote is deleted.
+        ~InstallerDownload()
+        {
+            m_callback.Cancel();
+
+            if (m_result.valid())
+            {
+                m_result.wait();
+            }
+
+            if (!m_claimed)
+            {
+                std::error_code error;
+                std::filesystem::remove(m_path, error);
+            }
+        }
+
+        const std::filesystem::path& GetPath() const { return m_path; }
+
+        // Marks the installer as taken by DownloadInstallerFile, which then owns the file.
+        void Claim() { m_claimed = true; }
+
+        // Whether the installer was placed from the installer cache, so that nothing is downloaded.
+        bool IsFromCache() const { return m_fromCache; }
+
+        void SetFromCache() { m_fromCache = true; }
+
+        // Whether the installer was placed from the source that the package was found in, so that nothing is downloaded.
+        bool IsFromSource() const { return m_fromSource; }
+
+        void SetFromSource() { m_fromSource = true; }
+
+        void Start(std::vector<std::string> urls, uint64_t hashChunkSize)
+        {
+            m_result = std::async(std::launch::async, [this, urls = std::move(urls), hashChunkSize]()
+                {
+                    return Utility::Download(urls, m_path, Utility::DownloadType::Installer, m_callback, true, hashChunkSize);
+                });
+        }
+
+        // Waits for the download to complete; cancelling the given callback cancels the download.
+        // Returns the hash of the installer, or an empty optional if the download was cancelled. Rethrows the error of a failed download.
+        std::optional<std::vector<uint8_t>> Wait(IProgressCallback& progress)
+        {
+            SetForegroundSink(&progress);
+            auto removeForegroundSink = wil::scope_exit([this]() { SetForegroundSink(nullptr); });
+
+            while (m_result.wait_for(s_InstallerDownloadWaitInterval) != std::future_status::ready)
+            {
+                if (progress.IsCancelled())
+                {
+                    m_callback.Cancel();
+                }
+            }
+
+            return m_result.get();
+        }
+
+        void OnProgress(uint64_t current, uint64_t maximum, ProgressType type) override
+        {
+            std::lock_guard<std::mutex> lock{ m_progressLock };
+
+            m_current = current;
+            m_maximum = maximum;
+            m_type = type;
+
+            if (m_foregroundSink)
+            {
+                m_foregroundSink->OnProgress(current, maximum, type);
+            }
+        }
+
+    private:
+        void SetForegroundSink(IProgressSink* sink)
+        {
+            std::lock_guard<std::mutex> lock{ m_progressLock };
+
+            m_foregroundSink = sink;
+
+            if (m_foregroundSink && m_type != ProgressType::None)
+            {
+                m_foregroundSink->OnProgress(m_current, m_maximum, m_type);
+            }
+        }
+
+        std::filesystem::path m_path;
+        bool m_fromCache = false;
+        bool m_fromSource = false;
+        bool m_claimed = false;
+
+        std::mutex m_progressLock;
+        IProgressSink* m_foregroundSink = nullptr;
+        uint64_t m_current = 0;
+        uint64_t m_maximum = 0;
+        ProgressType m_type = ProgressType::None;
+
+        ProgressCallback m_callback{ this };
+        std::future<std::optional<std::vector<uint8_t>>> m_result;
+    };
+
     void EnsureMinOSVersion(Execution::Context& context)
     {
         const auto& manifest = context.Get<Execution::Data::Manifest>();
@@ -92,18 +264,51 @@ namespace AppInstaller::CLI::Workflow
         const auto& manifest = context.Get<Execution::Data::Manifest>();
         const auto& installer = context.Get<Execution::Data::Installer>().value();
 
-        std::filesystem::path tempInstallerPath = Runtime::GetPathTo(Runtime::PathName::Temp);
-        tempInstallerPath /= Utility::ConvertToUTF16(manifest.Id + '.' + manifest.Version);
+        // The download may have been started by StartInstallerDownload; then only its result is waited for here
+        std::shared_ptr<InstallerDownload> backgroundDownload;
+        if (context.Contains(Execution::Data::InstallerDownload))
+        {
+            backgroundDownload = context.Get<Execution::Data::InstallerDownload>();
+            backgroundDownload->Claim();
+        }
+
+        std::filesystem::path tempInstallerPath = backgroundDownload ? backgroundDownload->GetPath() : GetInstallerDownloadPath(manifest);
 
         AICLI_LOG(CLI, Info, << "Generated temp download path: " << tempInstallerPath);
 
+        // The cache is keyed by the hash from the manifest, so a hit already matches it
+        auto installerCache = InstallerCache::GetDefault();
+        if (backgroundDownload ? backgroundDownload->IsFromCache() : (installerCache && installerCache->TryGet(installer.Sha256, tempInstallerPath)))
+        {
+            context.Reporter.Info() << Resource::String::InstallerFoundInCache << ' ' << Execution::UrlEmphasis << installer.Url << std::endl;
+            context.Add<Execution::Data::HashPair>(std::make_pair(installer.Sha256, installer.Sha256));
+            context.Add<Execution::Data::InstallerPath>(std::move(tempInstallerPath));
+            return;
+        }
+
+        // The source only gives an installer whose contents it checked against the hash, so this too already matches it
+        if (backgroundDownload ? backgroundDownload->IsFromSource() : TryGetInstallerFromSource(context, installer, tempInstallerPath))
+        {
+            context.Reporter.Info() << Resource::String::InstallerFoundInSource << ' ' << Execution::UrlEmphasis << installer.Url << std::endl;
+            context.Add<Execution::Data::HashPair>(std::make_pair(installer.Sha256, installer.Sha256));
+            context.Add<Execution::Data::InstallerPath>(std::move(tempInstallerPath));
+            return;
+        }
+
         context.Reporter.Info() << "Downloading " << Execution::UrlEmphasis << installer.Url << std::endl;
 
-        auto hash = context.Reporter.ExecuteWithProgress(std::bind(Utility::Download,
-            installer.Url,
-            tempInstallerPath,
-            std::placeholders::_1,
-            true));
+        std::optional<std::vector<uint8_t>> hash;
+        if (backgroundDownload)
+        {
+            hash = context.Reporter.ExecuteWithProgress([&](IProgressCallback& progress) { return backgroundDownload->Wait(progress); });
+        }
+        else
+        {
+            hash = context.Reporter.ExecuteWithProgress([&](IProgressCallback& progress)
+                {
+                    return Utility::Download(GetInstallerUrls(installer), tempInstallerPath, Utility::DownloadType::Installer, progress, true, installer.ChunkSize);
+                });
+        }
 
         if (!hash)
         {
@@ -111,7 +316,16 @@ namespace AppInstaller::CLI::Workflow
             AICLI_TERMINATE_CONTEXT(E_ABORT);
         }
 
-        context.Add<Execution::Data::HashPair>(std::make_pair(installer.Sha256, hash.value()));
+        // With a chunk size, the download is checked against the chunked hash of the manifest, whose chunks were hashed as they arrived
+        const std::vector<uint8_t>& expectedHash = (installer.ChunkSize > 0 ? installer.ChunkedSha256 : installer.Sha256);
+
+        // Only an installer that matches the manifest is published, as it is published under that hash
+        if (installerCache && hash.value() == expectedHash)
+        {
+            installerCache->Add(installer.Sha256, tempInstallerPath);
+        }
+
+        context.Add<Execution::Data::HashPair>(std::make_pair(expectedHash, hash.value()));
         context.Add<Execution::Data::InstallerPath>(std::move(tempInstallerPath));
     }
 
@@ -124,8 +338,8 @@ namespace AppInstaller::CLI::Workflow
         {
             const auto& installer = context.Get<Execution::Data::Installer>().value();
 
-            Msix::MsixInfo msixInfo(installer.Url);
-            auto signature = msixInfo.GetSignature();
+            // Only the signature is read here; the deployment streams the package from the url itself
+            auto signature = Msix::GetPackageSignature(installer.Url);
 
             auto signatureHash = SHA256::ComputeHash(signature.data(), static_cast<uint32_t>(signature.size()));
 
@@ -190,6 +404,8 @@ namespace AppInstaller::CLI::Workflow
 
     void ExecuteInstaller(Execution::Context& context)
     {
+        Logging::ScopedPerformanceTimer timer{ Logging::PerformanceOperation::InstallerExecution };
+
         const auto& installer = context.Get<Execution::Data::Installer>().value();
 
         switch (installer.InstallerType)
@@ -395,4 +611,260 @@ namespace AppInstaller::CLI::Workflow
             AICLI_TERMINATE_CONTEXT(errorCode);
         }
     }
+
+    void StartInstallerDownload(Execution::Context& context)
+    {
+        const auto& installer = context.Get<Execution::Data::Installer>().value();
+
+        if (!IsInstallerFileDownloaded(installer))
+        {
+            return;
+        }
+
+        auto download = std::make_shared<InstallerDownload>(GetInstallerDownloadPath(context.Get<Execution::Data::Manifest>()));
+
+        auto installerCache = InstallerCache::GetDefault();
+        if (installerCache && installerCache->TryGet(installer.Sha256, download->GetPath()))
+        {
+            download->SetFromCache();
+        }
+        else if (TryGetInstallerFromSource(context, installer, download->GetPath()))
+        {
+            download->SetFromSource();
+        }
+        else
+        {
+            AICLI_LOG(CLI, Info, << "Starting background download of: " << installer.Url);
+            download->Start(GetInstallerUrls(installer), installer.ChunkSize);
+        }
+
+        context.Add<Execution::Data::InstallerDownload>(std::move(download));
+    }
+
+    void InstallMultiplePackages(Execution::Context& context)
+    {
+        const auto& queries = *context.Args.GetArgs(Execution::Args::Type::Query);
+
+        // The source is opened once, and every package is found in it before anything is installed
+        context << OpenSource;
+        if (context.IsTerminated())
+        {
+            return;
+        }
+
+        std::vector<std::unique_ptr<Execution::Context>> packages;
+
+        for (const auto& query : queries)
+        {
+            auto package = context.CreateSubContext();
+            package->Args.RemoveArg(Execution::Args::Type::Query);
+            package->Args.AddArg(Execution::Args::Type::Query, query);
+            package->Add<Execution::Data::Source>(std::shared_ptr<Repository::ISource>(context.Get<Execution::Data::Source>()));
+
+            *package <<
+                SearchSourceForSingle <<
+                EnsureOneMatchFromSearchResult <<
+                ReportSearchResultIdentity <<
+                GetManifestFromSearchResult <<
+                EnsureMinOSVersion <<
+                SelectInstaller <<
+                EnsureApplicableInstaller;
+
+            if (context.IsTerminated())
+            {
+                return;
+            }
+
+            // Two packages with the same installer path would overwrite the installer of the other while it runs
+            if (!package->IsTerminated())
+            {
+                const auto& manifest = package->Get<Execution::Data::Manifest>();
+                bool isDuplicate = std::any_of(packages.begin(), packages.end(), [&](const std::unique_ptr<Execution::Context>& other)
+                    {
+                        return !other->IsTerminated() && other->Get<Execution::Data::Manifest>().Id == manifest.Id;
+                    });
+
+                if (isDuplicate)
+                {
+                    context.Reporter.Warn() << Resource::String::MultipleInstallDuplicatePackage << ' ' << query << std::endl;
+                    continue;
+                }
+            }
+
+            packages.emplace_back(std::move(package));
+        }
+
+        // The query of each package, in the order given, to report it by
+        std::vector<std::string> packageQueries;
+        for (const auto& package : packages)
+        {
+            packageQueries.emplace_back(package->Args.GetArg(Execution::Args::Type::Query));
+        }
+
+        InstallPackages(context, std::move(packages), packageQueries, Resource::String::MultipleInstallFailed);
+    }
+
+    void InstallPackages(
+        Execution::Context& context,
+        std::vector<std::unique_ptr<Execution::Context>> packages,
+        const std::vector<std::string>& packageLabels,
+        Resource::StringId failedMessage)
+    {
+        THROW_HR_IF(E_INVALIDARG, packages.size() != packageLabels.size());
+
+        // MSIX packages are deployed concurrently, as the deployment stack handles that itself; the other installers run
+        // one at a time, as most of them take the Windows Installer mutex or otherwise expect to be the only installer running.
+        auto isConcurrent = [](Execution::Context& package)
+        {
+            return !package.IsTerminated() &&
+                package.Get<Execution::Data::Installer>()->InstallerType == ManifestInstaller::InstallerTypeEnum::Msix;
+        };
+
+        // Starts the download of the next package that installs one at a time, after the given one.
+        // A concurrent package downloads on its own thread when it starts.
+        size_t nextDownload = 0;
+        auto startNextDownload = [&](size_t after)
+        {
+            for (nextDownload = std::max(nextDownload, after); nextDownload < packages.size(); ++nextDownload)
+            {
+                if (!packages[nextDownload]->IsTerminated() && !isConcurrent(*packages[nextDownload]))
+                {
+                    *packages[nextDownload++] << StartInstallerDownload;
+                    break;
+                }
+            }
+        };
+
+        // A package installing on another thread, with its output kept until it is done so that it does not interleave.
+        struct ConcurrentInstall
+        {
+            size_t Index = 0;
+            std::ostringstream Output;
+            std::istringstream Input;
+            std::unique_ptr<Execution::Context> Package;
+            std::future<void> Result;
+        };
+
+        std::vector<bool> failed(packages.size());
+        std::vector<std::unique_ptr<ConcurrentInstall>> concurrentInstalls;
+
+        // Reports the concurrent installs that are done, in the order that they were started; if wait is set, first waits for the oldest.
+        auto completeConcurrentInstalls = [&](bool wait)
+        {
+            while (!concurrentInstalls.empty() &&
+                (wait || concurrentInstalls.front()->Result.wait_for(std::chrono::seconds(0)) == std::future_status::ready))
+            {
+                auto install = std::move(concurrentInstalls.front());
+                concurrentInstalls.erase(concurrentInstalls.begin());
+
+                install->Result.get();
+                context.Reporter.Info() << Utility::LocIndView{ install->Output.str() };
+                failed[install->Index] = install->Package->IsTerminated();
+
+                // Waiting for only one makes room for the next
+                wait = false;
+            }
+        };
+
+        startNextDownload(0);
+
+        for (size_t i = 0; i < packages.size() && !context.IsTerminated(); ++i)
+        {
+            auto& package = *packages[i];
+            const auto& label = packageLabels[i];
+
+            if (isConcurrent(package))
+            {
+                if (concurrentInstalls.size() >= s_MaxConcurrentInstalls)
+                {
+                    completeConcurrentInstalls(true);
+                }
+
+                auto install = std::make_unique<ConcurrentInstall>();
+                install->Index = i;
+                install->Package = package.CreateSubContext(install->Output, install->Input);
+                install->Package->Reporter.DisableProgress();
+                // The package context is not used again, so its data is moved to the one that does the install
+                install->Package->Add<Execution::Data::Manifest>(package.Extract<Execution::Data::Manifest>());
+                install->Package->Add<Execution::Data::Installer>(package.Extract<Execution::Data::Installer>());
+
+                install->Package->Reporter.Info() << Resource::String::MultipleInstallProgress << ' ' << (i + 1) << '/' << packages.size() << ": " << label << std::endl;
+
+                install->Result = std::async(std::launch::async, [&worker = *install->Package]()
+                    {
+                        try
+                        {
+                            worker <<
+                                ShowInstallationDisclaimer <<
+                                DownloadInstaller <<
+                                ExecuteInstaller <<
+                                RemoveInstaller;
+                        }
+                        catch (...)
+                        {
+                            HRESULT hr = wil::ResultFromCaughtException();
+                            worker.Reporter.Error() << Resource::String::UnexpectedErrorExecutingCommand << ' ' << WINGET_OSTREAM_FORMAT_HRESULT(hr) << std::endl;
+                            worker.Terminate(hr);
+                        }
+                    });
+
+                concurrentInstalls.emplace_back(std::move(install));
+            }
+            else
+            {
+                if (!package.IsTerminated())
+                {
+                    context.Reporter.Info() << Resource::String::MultipleInstallProgress << ' ' << (i + 1) << '/' << packages.size() << ": " << label << std::endl;
+
+                    package <<
+                        ShowInstallationDisclaimer <<
+                        DownloadInstaller;
+
+                    // The installers run one at a time, but the next one downloads while this one runs
+                    startNextDownload(i + 1);
+
+                    package <<
+                        ExecuteInstaller <<
+                        RemoveInstaller;
+                }
+
+                failed[i] = package.IsTerminated();
+
+                // The installer is no longer needed, and a cancelled download is stopped
+                packages[i].reset();
+            }
+
+            completeConcurrentInstalls(false);
+        }
+
+        while (!concurrentInstalls.empty())
+        {
+            completeConcurrentInstalls(true);
+        }
+
+        if (context.IsTerminated())
+        {
+            return;
+        }
+
+        std::vector<std::string> failedLabels;
+        for (size_t i = 0; i < packages.size(); ++i)
+        {
+            if (failed[i])
+            {
+                failedLabels.emplace_back(packageLabels[i]);
+            }
+        }
+
+        if (!failedLabels.empty())
+        {
+            context.Reporter.Error() << failedMessage << std::endl;
+            for (const auto& label : failedLabels)
+            {
+                context.Reporter.Error() << "  " << label << std::endl;
+            }
+
+            AICLI_TERMINATE_CONTEXT(APPINSTALLER_CLI_ERROR_MULTIPLE_INSTALL_FAILED);
+        }
+    }
 }
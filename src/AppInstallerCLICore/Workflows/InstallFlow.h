@@ -82,4 +82,29 @@ namespace AppInstaller::CLI::Workflow
     // Inputs: InstallerPath
     // Outputs: None
     void RemoveInstaller(Execution::Context& context);
+
+    // Starts downloading the installer file on another thread, if DownloadInstaller would download it.
+    // DownloadInstallerFile then waits for this download rather than starting its own; if the context ends before
+    // that, the download is cancelled and its file deleted.
+    // Required Args: None
+    // Inputs: Manifest, Installer
+    // Outputs: InstallerDownload?
+    void StartInstallerDownload(Execution::Context& context);
+
+    // Installs the package found by each query in its own sub-context.
+    // Every package is found before the first is installed. MSIX packages are installed concurrently, on their own threads;
+    // the other packages are installed in order, one at a time, and the installer of the next downloads while the current one installs.
+    // Required Args: Query
+    // Inputs: None
+    // Outputs: None
+    void InstallMultiplePackages(Execution::Context& context);
+
+    // Installs the packages of the sub-contexts as InstallMultiplePackages does, each of which already has its Manifest and Installer;
+    // a package whose sub-context is terminated is skipped. Each package is reported by its label, and the labels of those that fail
+    // are listed after the message.
+    void InstallPackages(
+        Execution::Context& context,
+        std::vector<std::unique_ptr<Execution::Context>> packages,
+        const std::vector<std::string>& packageLabels,
+        Resource::StringId failedMessage);
 }
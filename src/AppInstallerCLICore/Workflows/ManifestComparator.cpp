@@ -22,7 +22,7 @@ namespace AppInstaller::CLI::Workflow
     bool LocalizationComparator::operator() (const ManifestLocalization& loc1, const ManifestLocalization& loc2)
     {
         // Todo: Compare simple language for now. Need more work and spec.
-        std::string userPreferredLocale = std::locale("").name();
+        const std::string& userPreferredLocale = Runtime::GetSystemCapabilities().Locale;
 
         auto foundLoc1 = userPreferredLocale.find(loc1.Language);
         auto foundLoc2 = userPreferredLocale.find(loc2.Language);
@@ -35,25 +35,26 @@ namespace AppInstaller::CLI::Workflow
         return false;
     }
 
-    std::optional<Manifest::ManifestInstaller> ManifestComparator::GetPreferredInstaller(const Manifest::Manifest& manifest)
+    std::optional<size_t> ManifestComparator::GetPreferredInstaller(const Manifest::Manifest& manifest)
     {
         AICLI_LOG(CLI, Info, << "Starting installer selection.");
 
-        // Sorting the list of available installers according to rules defined in InstallerComparator.
-        auto installers = manifest.Installers;
-        std::sort(installers.begin(), installers.end(), InstallerComparator());
+        // Finding the best of the available installers according to rules defined in InstallerComparator.
+        // The installers are compared in place, rather than sorting a copy of them.
+        const auto& installers = manifest.Installers;
+        auto best = std::min_element(installers.begin(), installers.end(), InstallerComparator());
 
-        // If the first one is inapplicable, then no installer is applicable.
-        if (Utility::IsApplicableArchitecture(installers[0].Arch) == -1)
+        // If the best one is inapplicable, then no installer is applicable.
+        if (best == installers.end() || Utility::IsApplicableArchitecture(best->Arch) == -1)
         {
             return {};
         }
 
-        ManifestInstaller& selectedInstaller = installers[0];
+        const ManifestInstaller& selectedInstaller = *best;
 
         Logging::Telemetry().LogSelectedInstaller((int)selectedInstaller.Arch, selectedInstaller.Url, Manifest::ManifestInstaller::InstallerTypeToString(selectedInstaller.InstallerType), selectedInstaller.Scope, selectedInstaller.Language);
 
-        return std::move(selectedInstaller);
+        return static_cast<size_t>(std::distance(installers.begin(), best));
     }
 
     Manifest::ManifestLocalization ManifestComparator::GetPreferredLocalization(const Manifest::Manifest& manifest)
@@ -62,15 +63,13 @@ namespace AppInstaller::CLI::Workflow
 
         ManifestLocalization selectedLocalization;
 
-        // Sorting the list of available localizations according to rules defined in LocalizationComparator.
+        // Finding the best of the available localizations according to rules defined in LocalizationComparator.
         if (!manifest.Localization.empty())
         {
-            auto localization = manifest.Localization;
-            std::sort(localization.begin(), localization.end(), LocalizationComparator());
-
             // TODO: needs to check language applicability here
 
-            selectedLocalization = localization[0];
+            selectedLocalization = *std::min_element(manifest.Localization.begin(), manifest.Localization.end(), LocalizationComparator());
+            selectedLocalization.Decode();
         }
         else
         {
@@ -4,6 +4,7 @@
 #include "ExecutionArgs.h"
 #include <winget/Manifest.h>
 
+#include <cstddef>
 #include <optional>
 
 
@@ -31,7 +32,11 @@ namespace AppInstaller::CLI::Workflow
     public:
         ManifestComparator(const Execution::Args&) {}
 
-        std::optional<Manifest::ManifestInstaller> GetPreferredInstaller(const Manifest::Manifest& manifest);
+        // Gets the index of the best installer in the manifest; returns an empty value if none of them is applicable.
+        // The first of equally good installers is chosen, so that the selection follows the order of the manifest.
+        std::optional<size_t> GetPreferredInstaller(const Manifest::Manifest& manifest);
+
+        // Gets the best localization of the manifest, or one from the manifest fields if it has none.
         Manifest::ManifestLocalization GetPreferredLocalization(const Manifest::Manifest& manifest);
 
     private:
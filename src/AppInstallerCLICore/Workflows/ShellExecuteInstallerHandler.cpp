@@ -32,17 +32,18 @@ namespace AppInstaller::CLI::Workflow
 
             wil::unique_process_handle process{ execInfo.hProcess };
 
-            // Wait for installation to finish
-            while (!progress.IsCancelled())
+            // Wait for installation to finish or be cancelled, whichever happens first.
+            // The event is checked after the cancellation function is set, in case the cancel came before it.
+            wil::unique_event cancelled{ wil::EventOptions::ManualReset };
+            auto removeCancel = progress.SetCancellationFunction([&]() { cancelled.SetEvent(); });
+
+            if (!progress.IsCancelled())
             {
-                DWORD waitResult = WaitForSingleObject(process.get(), 250);
-                if (waitResult == WAIT_OBJECT_0)
-                {
-                    break;
-                }
-                if (waitResult != WAIT_TIMEOUT)
+                HANDLE waitHandles[] = { process.get(), cancelled.get() };
+                DWORD waitResult = WaitForMultipleObjects(ARRAYSIZE(waitHandles), waitHandles, FALSE, INFINITE);
+                if (waitResult != WAIT_OBJECT_0 && waitResult != WAIT_OBJECT_0 + 1)
                 {
-                    THROW_LAST_ERROR_MSG("Unexpected WaitForSingleObjectResult: %d", waitResult);
+                    THROW_LAST_ERROR_MSG("Unexpected WaitForMultipleObjects result: %d", waitResult);
                 }
             }
 
@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "ShowFlow.h"
+#include "JsonLinesOutput.h"
 #include "ManifestComparator.h"
 #include "TableOutput.h"
 
@@ -18,6 +19,36 @@ namespace AppInstaller::CLI::Workflow
         ManifestComparator manifestComparator(context.Args);
         auto selectedLocalization = manifestComparator.GetPreferredLocalization(manifest);
 
+        if (context.Args.Contains(Execution::Args::Type::Output))
+        {
+            Json::Value line{ Json::objectValue };
+            line["Id"] = manifest.Id;
+            line["Name"] = manifest.Name;
+            line["Version"] = manifest.Version;
+            line["Channel"] = manifest.Channel;
+            line["Publisher"] = manifest.Publisher;
+            line["Author"] = manifest.Author;
+            line["Moniker"] = manifest.AppMoniker;
+            line["Description"] = selectedLocalization.Description;
+            line["Homepage"] = selectedLocalization.Homepage;
+            line["License"] = manifest.License;
+            line["LicenseUrl"] = selectedLocalization.LicenseUrl;
+
+            if (installer)
+            {
+                Json::Value installerValue{ Json::objectValue };
+                installerValue["Type"] = Manifest::ManifestInstaller::InstallerTypeToString(installer->InstallerType);
+                installerValue["Language"] = installer->Language;
+                installerValue["Url"] = installer->Url;
+                installerValue["Sha256"] = Utility::SHA256::ConvertToString(installer->Sha256);
+                installerValue["ProductId"] = installer->ProductId;
+                line["Installer"] = std::move(installerValue);
+            }
+
+            Execution::JsonLinesOutput(context.Reporter).OutputLine(line);
+            return;
+        }
+
         // TODO: Come up with a prettier format
         context.Reporter.Info() << "Version: " << manifest.Version << std::endl;
         context.Reporter.Info() << "Publisher: " << manifest.Publisher << std::endl;
@@ -77,6 +108,16 @@ namespace AppInstaller::CLI::Workflow
     {
         const auto& manifest = context.Get<Execution::Data::Manifest>();
 
+        if (context.Args.Contains(Execution::Args::Type::Output))
+        {
+            Json::Value line{ Json::objectValue };
+            line["Id"] = manifest.Id;
+            line["Version"] = manifest.Version;
+            line["Channel"] = manifest.Channel;
+            Execution::JsonLinesOutput(context.Reporter).OutputLine(line);
+            return;
+        }
+
         Execution::TableOutput<2> table(context.Reporter, { Resource::String::ShowVersion, Resource::String::ShowChannel });
         table.OutputLine({ manifest.Version, manifest.Channel });
         table.Complete();
@@ -84,7 +125,26 @@ namespace AppInstaller::CLI::Workflow
 
     void ShowAppVersions(Execution::Context& context)
     {
-        auto app = context.Get<Execution::Data::SearchResult>().Matches.at(0).Application.get();
+        const auto& match = context.Get<Execution::Data::SearchResult>().Matches.at(0);
+        auto app = match.Application.get();
+
+        if (context.Args.Contains(Execution::Args::Type::Output))
+        {
+            Execution::JsonLinesOutput output(context.Reporter);
+            std::string id = app->GetId();
+
+            for (auto& version : app->GetVersions())
+            {
+                Json::Value line{ Json::objectValue };
+                line["Id"] = id;
+                line["Version"] = version.GetVersion().ToString();
+                line["Channel"] = version.GetChannel().ToString();
+                line["Source"] = match.SourceName;
+                output.OutputLine(line);
+            }
+
+            return;
+        }
 
         Execution::TableOutput<2> table(context.Reporter, { Resource::String::ShowVersion, Resource::String::ShowChannel });
         for (auto& version : app->GetVersions())
@@ -6,11 +6,14 @@
 #include "SourceFlow.h"
 #include "TableOutput.h"
 #include "WorkflowBase.h"
+#include <winget/Maintenance.h>
+#include <winget/UserSettings.h>
 
 namespace AppInstaller::CLI::Workflow
 {
     using namespace AppInstaller::CLI::Execution;
     using namespace AppInstaller::Utility::literals;
+    using namespace std::chrono_literals;
 
     void GetSourceList(Execution::Context& context)
     {
@@ -65,7 +68,7 @@ namespace AppInstaller::CLI::Workflow
         }
 
         // Now check if the URL is already in use under a different name
-        auto sourceList = context.Get<Execution::Data::SourceList>();
+        const auto& sourceList = context.Get<Execution::Data::SourceList>();
         std::string_view type = context.Args.GetArg(Args::Type::SourceType);
 
         for (const auto& details : sourceList)
@@ -88,12 +91,20 @@ namespace AppInstaller::CLI::Workflow
         {
             type = context.Args.GetArg(Args::Type::SourceType);
         }
+        std::vector<std::string> mirrors;
+        if (context.Args.Contains(Args::Type::SourceMirror))
+        {
+            mirrors = *context.Args.GetArgs(Args::Type::SourceMirror);
+        }
 
         context.Reporter.Info() <<
             Resource::String::SourceAddBegin << std::endl <<
             "  "_liv << name << " -> "_liv << arg << std::endl;
 
-        context.Reporter.ExecuteWithProgress(std::bind(Repository::AddSource, std::move(name), std::move(type), std::move(arg), std::placeholders::_1));
+        context.Reporter.ExecuteWithProgress([&](IProgressCallback& progress)
+            {
+                Repository::AddSource(name, type, arg, progress, mirrors);
+            });
 
         context.Reporter.Info() << Resource::String::Done;
     }
@@ -114,6 +125,11 @@ namespace AppInstaller::CLI::Workflow
             table.OutputLine({ Resource::Loader::Instance().ResolveString(Resource::String::SourceListArg), source.Arg });
             table.OutputLine({ Resource::Loader::Instance().ResolveString(Resource::String::SourceListData), source.Data });
 
+            for (const auto& mirror : source.Mirrors)
+            {
+                table.OutputLine({ Resource::Loader::Instance().ResolveString(Resource::String::SourceListMirrors), mirror });
+            }
+
             if (source.LastUpdateTime == Utility::ConvertUnixEpochToSystemClock(0))
             {
                 table.OutputLine({
@@ -156,11 +172,79 @@ namespace AppInstaller::CLI::Workflow
         }
 
         const std::vector<Repository::SourceDetails>& sources = context.Get<Data::SourceList>();
+        std::vector<std::string> names;
         for (const auto& sd : sources)
         {
             context.Reporter.Info() << Resource::String::SourceUpdateOne << ' ' << sd.Name << "..."_liv << std::endl;
-            context.Reporter.ExecuteWithProgress(std::bind(Repository::UpdateSource, sd.Name, std::placeholders::_1));
-            context.Reporter.Info() << Resource::String::Done << std::endl;
+            names.emplace_back(sd.Name);
+        }
+
+        // The sources are updated concurrently, with their progress shown as one.
+        context.Reporter.ExecuteWithProgress([&](IProgressCallback& progress) { return Repository::UpdateSources(names, progress); });
+        context.Reporter.Info() << Resource::String::Done << std::endl;
+    }
+
+    void UpdateSourcesInBackground(Execution::Context& context)
+    {
+        Maintenance::EnterBackgroundMode();
+
+        // The task is left in place until the next `source update`, so a run after the setting is turned off removes it
+        auto interval = Settings::User().Get<Settings::Setting::AutoUpdateTimeInMinutes>();
+        if (!Settings::User().Get<Settings::Setting::SourceScheduledUpdate>() || interval == 0min)
+        {
+            AICLI_LOG(CLI, Info, << "Scheduled source updates are not enabled");
+            Maintenance::UnregisterSourceUpdateTask();
+            return;
+        }
+
+        if (Maintenance::ShouldDeferNetworkUse())
+        {
+            AICLI_LOG(CLI, Info, << "Skipping the scheduled source update until there is an unmetered connection");
+            return;
+        }
+
+        // A source that was updated recently is left for a later run, which still comes before it is due
+        std::vector<std::string> names;
+        auto now = std::chrono::system_clock::now();
+        for (const auto& sd : context.Get<Data::SourceList>())
+        {
+            if (now - sd.LastUpdateTime >= interval / 2)
+            {
+                names.emplace_back(sd.Name);
+            }
+        }
+
+        if (names.empty())
+        {
+            AICLI_LOG(CLI, Info, << "No source is due for a scheduled update");
+            return;
+        }
+
+        // Each update swaps in the new index under the source's lock, so commands that are running keep reading the old one
+        ProgressCallback progress;
+        Repository::UpdateSources(names, progress);
+    }
+
+    void UpdateScheduledSourceUpdateTask(Execution::Context& context)
+    {
+        auto interval = Settings::User().Get<Settings::Setting::AutoUpdateTimeInMinutes>();
+
+        try
+        {
+            if (Settings::User().Get<Settings::Setting::SourceScheduledUpdate>() && interval != 0min)
+            {
+                Maintenance::RegisterSourceUpdateTask(interval);
+            }
+            else
+            {
+                Maintenance::UnregisterSourceUpdateTask();
+            }
+        }
+        catch (...)
+        {
+            // The sources were updated, which is what was asked for, so a failure here is only a warning
+            LOG_CAUGHT_EXCEPTION();
+            context.Reporter.Warn() << Resource::String::SourceUpdateScheduleFailed << std::endl;
         }
     }
 
@@ -42,6 +42,19 @@ namespace AppInstaller::CLI::Workflow
     // Outputs: None
     void UpdateSources(Execution::Context& context);
 
+    // Updates the sources in SourceList as the scheduled task does: at a low priority, not over a metered connection,
+    // and only those that are at least halfway to their next auto update.
+    // Required Args: None
+    // Inputs: SourceList
+    // Outputs: None
+    void UpdateSourcesInBackground(Execution::Context& context);
+
+    // Registers or removes the scheduled task that updates the sources, as the user settings ask for.
+    // Required Args: None
+    // Inputs: None
+    // Outputs: None
+    void UpdateScheduledSourceUpdateTask(Execution::Context& context);
+
     // Removes the sources in SourceList.
     // Required Args: None
     // Inputs: SourceList
@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "UpgradeFlow.h"
+#include "InstallFlow.h"
+#include "JsonLinesOutput.h"
+#include "TableOutput.h"
+#include "WorkflowBase.h"
+
+using namespace AppInstaller::Repository;
+
+namespace AppInstaller::CLI::Workflow
+{
+    void FindUpgrades(Execution::Context& context)
+    {
+        auto& source = context.Get<Execution::Data::Source>();
+
+        auto upgrades = context.Reporter.ExecuteWithProgress([&](IProgressCallback&)
+            {
+                return EvaluateUpgrades(*source, GetInstalledInventory());
+            }, true);
+
+        context.Add<Execution::Data::Upgrades>(std::move(upgrades));
+    }
+
+    void ReportUpgrades(Execution::Context& context)
+    {
+        const auto& upgrades = context.Get<Execution::Data::Upgrades>();
+
+        if (context.Args.Contains(Execution::Args::Type::Output))
+        {
+            Execution::JsonLinesOutput output(context.Reporter);
+
+            for (const auto& upgrade : upgrades)
+            {
+                Json::Value line{ Json::objectValue };
+                line["Id"] = upgrade.Entry.Application->GetId().get();
+                line["Name"] = upgrade.Entry.Application->GetName().get();
+                line["Version"] = upgrade.Entry.Installed.Version;
+                line["Available"] = upgrade.Latest.GetVersion().ToString();
+                line["Source"] = upgrade.Entry.SourceName;
+                output.OutputLine(line);
+            }
+
+            return;
+        }
+
+        if (upgrades.empty())
+        {
+            context.Reporter.Info() << Resource::String::UpgradeNoneAvailable << std::endl;
+            return;
+        }
+
+        Execution::TableOutput<5> table(context.Reporter, { Resource::String::SearchName, Resource::String::SearchId, Resource::String::SearchVersion, Resource::String::UpgradeAvailableVersion, Resource::String::SearchSource });
+
+        for (const auto& upgrade : upgrades)
+        {
+            table.OutputLine({ upgrade.Entry.Application->GetName(), upgrade.Entry.Application->GetId(), upgrade.Entry.Installed.Version, upgrade.Latest.GetVersion().ToString(), upgrade.Entry.SourceName });
+        }
+
+        table.Complete();
+
+        context.Reporter.Info() << upgrades.size() << ' ' << Resource::String::UpgradeAvailableCount << std::endl;
+    }
+
+    void InstallUpgrades(Execution::Context& context)
+    {
+        auto& upgrades = context.Get<Execution::Data::Upgrades>();
+
+        std::vector<std::unique_ptr<Execution::Context>> packages;
+        std::vector<std::string> packageIds;
+
+        // Every installer is selected before the first is installed, so that the next can download while the current one runs
+        for (const auto& upgrade : upgrades)
+        {
+            auto package = context.CreateSubContext();
+            const auto& latest = upgrade.Latest;
+
+            std::optional<Manifest::Manifest> manifest = upgrade.Entry.Application->GetManifest(latest.GetVersion().ToString(), latest.GetChannel().ToString());
+            if (!manifest)
+            {
+                package->Reporter.Error() << "No version found matching: " << latest.ToString() << std::endl;
+                package->Terminate(APPINSTALLER_CLI_ERROR_NO_MANIFEST_FOUND);
+            }
+            else
+            {
+                Logging::Telemetry().LogManifestFields(manifest->Id, manifest->Name, manifest->Version, false);
+                package->Add<Execution::Data::Manifest>(std::move(manifest).value());
+
+                *package <<
+                    ReportManifestIdentity <<
+                    EnsureMinOSVersion <<
+                    SelectInstaller <<
+                    EnsureApplicableInstaller;
+            }
+
+            if (context.IsTerminated())
+            {
+                return;
+            }
+
+            packageIds.emplace_back(upgrade.Entry.Application->GetId().get());
+            packages.emplace_back(std::move(package));
+        }
+
+        InstallPackages(context, std::move(packages), packageIds, Resource::String::UpgradeFailed);
+    }
+}
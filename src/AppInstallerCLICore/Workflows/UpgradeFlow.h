@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "ExecutionContext.h"
+
+namespace AppInstaller::CLI::Workflow
+{
+    // Finds the installed packages that the source has a later version of, looking up all of them at once.
+    // Required Args: None
+    // Inputs: Source
+    // Outputs: Upgrades
+    void FindUpgrades(Execution::Context& context);
+
+    // Shows the upgrades that were found.
+    // Required Args: None
+    // Inputs: Upgrades
+    // Outputs: None
+    void ReportUpgrades(Execution::Context& context);
+
+    // Installs every upgrade that was found, each in its own sub-context, as InstallMultiplePackages does.
+    // Required Args: None
+    // Inputs: Upgrades
+    // Outputs: None
+    void InstallUpgrades(Execution::Context& context);
+}
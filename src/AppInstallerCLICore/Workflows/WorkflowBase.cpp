@@ -3,17 +3,25 @@
 #include "pch.h"
 #include "WorkflowBase.h"
 #include "ExecutionContext.h"
+#include "JsonLinesOutput.h"
 #include "ManifestComparator.h"
 #include "TableOutput.h"
 #include <winget/ManifestYamlParser.h>
+#include <WorkloadTrace.h>
+
+#include <unordered_set>
 
 
 namespace AppInstaller::CLI::Workflow
 {
     using namespace AppInstaller::Repository;
+    using namespace std::string_view_literals;
 
     namespace
     {
+        // The id file name that reads the ids from standard input instead.
+        constexpr std::string_view s_StandardInputName = "-"sv;
+
         std::string GetMatchCriteriaDescriptor(const ResultMatch& match)
         {
             if (match.MatchCriteria.Field != ApplicationMatchField::Id && match.MatchCriteria.Field != ApplicationMatchField::Name)
@@ -34,6 +42,58 @@ namespace AppInstaller::CLI::Workflow
             context.Reporter.Info() << "Found " << Execution::NameEmphasis << name << " [" << Execution::IdEmphasis << id << ']' << std::endl;
         }
 
+        // Searches the source, recording the search when the workload is being recorded.
+        SearchResult SearchSource(Execution::Context& context, const SearchRequest& searchRequest)
+        {
+            auto start = std::chrono::steady_clock::now();
+            SearchResult result = context.Get<Execution::Data::Source>()->Search(searchRequest);
+
+            Workload::RecordSearch(searchRequest, result.Matches.size(),
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+
+            return result;
+        }
+
+        // Searches the source with progress shown, so that a slow search can be cancelled.
+        // Completion does not use this, as it must not write anything but the results.
+        SearchResult SearchSourceWithProgress(Execution::Context& context, SearchRequest& searchRequest)
+        {
+            SearchResult result = context.Reporter.ExecuteWithProgress([&](IProgressCallback& progress)
+                {
+                    searchRequest.Progress = &progress;
+                    auto clearProgress = wil::scope_exit([&]() { searchRequest.Progress = nullptr; });
+                    return SearchSource(context, searchRequest);
+                }, true);
+
+            for (const auto& source : result.MissingSources)
+            {
+                context.Reporter.Warn() << Resource::String::SearchSourceTimedOut << ' ' << source << std::endl;
+            }
+
+            return result;
+        }
+
+        // Records the sources behind the opened source, when the workload is being recorded.
+        void RecordSources(const ISource& source)
+        {
+            if (!Workload::IsRecording())
+            {
+                return;
+            }
+
+            const SourceDetails& details = source.GetDetails();
+            if (!details.IsAggregated)
+            {
+                Workload::RecordSource(details);
+                return;
+            }
+
+            for (const auto& aggregatedDetails : GetSources())
+            {
+                Workload::RecordSource(aggregatedDetails);
+            }
+        }
+
         void SearchSourceApplyFilters(Execution::Context& context, SearchRequest& searchRequest, MatchType matchType)
         {
             const auto& args = context.Args;
@@ -74,7 +134,7 @@ namespace AppInstaller::CLI::Workflow
     {
         if (m_isFunc && other.m_isFunc)
         {
-            return m_func == other.m_func;
+            return m_func == other.m_func && m_asyncFunc == other.m_asyncFunc;
         }
         else if (!m_isFunc && !other.m_isFunc)
         {
@@ -89,11 +149,26 @@ namespace AppInstaller::CLI::Workflow
     void WorkflowTask::operator()(Execution::Context& context) const
     {
         THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), !m_isFunc);
-        m_func(context);
+
+        if (m_asyncFunc)
+        {
+            // Any exception from the coroutine is rethrown here, as it would be from a synchronous task.
+            m_asyncFunc(context).get();
+        }
+        else
+        {
+            m_func(context);
+        }
     }
 
     void OpenSource(Execution::Context& context)
     {
+        if (!context.AreSourcesAllowed())
+        {
+            AICLI_LOG(CLI, Verbose, << "Sources are not allowed in this context");
+            AICLI_TERMINATE_CONTEXT(Execution::Context::SourcesNotAllowedHR);
+        }
+
         std::string_view sourceName;
         if (context.Args.Contains(Execution::Args::Type::Source))
         {
@@ -101,14 +176,34 @@ namespace AppInstaller::CLI::Workflow
         }
 
         std::shared_ptr<Repository::ISource> source;
-        try
+        const auto& sharedSources = context.GetSharedSources();
+        if (sharedSources)
         {
-            source = context.Reporter.ExecuteWithProgress(std::bind(Repository::OpenSource, sourceName, std::placeholders::_1), true);
+            auto itr = sharedSources->find(std::string{ sourceName });
+            if (itr != sharedSources->end())
+            {
+                AICLI_LOG(CLI, Verbose, << "Using the shared source that was already opened for: '" << sourceName << '\'');
+                source = itr->second;
+            }
         }
-        catch (...)
+
+        if (!source)
         {
-            context.Reporter.Error() << "Failed to open the source; try removing and re-adding it" << std::endl;
-            throw;
+            try
+            {
+                Logging::ScopedPerformanceTimer timer{ Logging::PerformanceOperation::SourceOpen };
+                source = context.Reporter.ExecuteWithProgress(std::bind(Repository::OpenSource, sourceName, std::placeholders::_1), true);
+            }
+            catch (...)
+            {
+                context.Reporter.Error() << "Failed to open the source; try removing and re-adding it" << std::endl;
+                throw;
+            }
+
+            if (source && sharedSources)
+            {
+                sharedSources->emplace(sourceName, source);
+            }
         }
 
         if (!source)
@@ -135,6 +230,7 @@ namespace AppInstaller::CLI::Workflow
             }
         }
 
+        RecordSources(*source);
         context.Add<Execution::Data::Source>(std::move(source));
     }
 
@@ -156,18 +252,76 @@ namespace AppInstaller::CLI::Workflow
 
         SearchSourceApplyFilters(context, searchRequest, matchType);
 
-        Logging::Telemetry().LogSearchRequest(
-            "many",
-            args.GetArg(Execution::Args::Type::Query),
-            args.GetArg(Execution::Args::Type::Id),
-            args.GetArg(Execution::Args::Type::Name),
-            args.GetArg(Execution::Args::Type::Moniker),
-            args.GetArg(Execution::Args::Type::Tag),
-            args.GetArg(Execution::Args::Type::Command),
-            searchRequest.MaximumResults,
-            searchRequest.ToString());
-
-        context.Add<Execution::Data::SearchResult>(context.Get<Execution::Data::Source>()->Search(searchRequest));
+        // The request is only formatted when the event is written
+        if (Logging::Telemetry().IsEnabled())
+        {
+            Logging::Telemetry().LogSearchRequest(
+                "many",
+                args.GetArg(Execution::Args::Type::Query),
+                args.GetArg(Execution::Args::Type::Id),
+                args.GetArg(Execution::Args::Type::Name),
+                args.GetArg(Execution::Args::Type::Moniker),
+                args.GetArg(Execution::Args::Type::Tag),
+                args.GetArg(Execution::Args::Type::Command),
+                searchRequest.MaximumResults,
+                searchRequest.ToString());
+        }
+
+        context.Add<Execution::Data::SearchResult>(SearchSourceWithProgress(context, searchRequest));
+    }
+
+    void SearchSourceForIds(Execution::Context& context)
+    {
+        std::string_view idFile = context.Args.GetArg(Execution::Args::Type::IdFile);
+
+        std::ifstream fileStream;
+        std::istream* stream = &context.Reporter.Input();
+
+        if (idFile != s_StandardInputName)
+        {
+            context << VerifyFile(Execution::Args::Type::IdFile);
+            if (context.IsTerminated())
+            {
+                return;
+            }
+
+            fileStream.open(Utility::ConvertToUTF16(idFile));
+            THROW_LAST_ERROR_IF(fileStream.fail());
+            stream = &fileStream;
+        }
+
+        std::vector<std::string> ids;
+        std::string line;
+        while (std::getline(*stream, line))
+        {
+            Utility::Trim(line);
+            if (!line.empty())
+            {
+                ids.emplace_back(std::move(line));
+            }
+        }
+
+        AICLI_LOG(CLI, Info, << "Searching for " << ids.size() << " ids");
+        auto start = std::chrono::steady_clock::now();
+        SearchResult result = context.Get<Execution::Data::Source>()->SearchForIds(ids);
+        Workload::RecordSearchForIds(ids, result.Matches.size(),
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+
+        std::unordered_set<std::string> found;
+        for (const auto& match : result.Matches)
+        {
+            found.insert(match.MatchCriteria.Value);
+        }
+
+        for (const auto& id : ids)
+        {
+            if (found.count(id) == 0)
+            {
+                context.Reporter.Warn() << Resource::String::IdFileIdNotFound << ' ' << id << std::endl;
+            }
+        }
+
+        context.Add<Execution::Data::SearchResult>(std::move(result));
     }
 
     void SearchSourceForSingle(Execution::Context& context)
@@ -191,18 +345,22 @@ namespace AppInstaller::CLI::Workflow
 
         SearchSourceApplyFilters(context, searchRequest, matchType);
 
-        Logging::Telemetry().LogSearchRequest(
-            "single",
-            args.GetArg(Execution::Args::Type::Query),
-            args.GetArg(Execution::Args::Type::Id),
-            args.GetArg(Execution::Args::Type::Name),
-            args.GetArg(Execution::Args::Type::Moniker),
-            args.GetArg(Execution::Args::Type::Tag),
-            args.GetArg(Execution::Args::Type::Command),
-            searchRequest.MaximumResults,
-            searchRequest.ToString());
-
-        context.Add<Execution::Data::SearchResult>(context.Get<Execution::Data::Source>()->Search(searchRequest));
+        // The request is only formatted when the event is written
+        if (Logging::Telemetry().IsEnabled())
+        {
+            Logging::Telemetry().LogSearchRequest(
+                "single",
+                args.GetArg(Execution::Args::Type::Query),
+                args.GetArg(Execution::Args::Type::Id),
+                args.GetArg(Execution::Args::Type::Name),
+                args.GetArg(Execution::Args::Type::Moniker),
+                args.GetArg(Execution::Args::Type::Tag),
+                args.GetArg(Execution::Args::Type::Command),
+                searchRequest.MaximumResults,
+                searchRequest.ToString());
+        }
+
+        context.Add<Execution::Data::SearchResult>(SearchSourceWithProgress(context, searchRequest));
     }
 
     void SearchSourceForManyCompletion(Execution::Context& context)
@@ -215,7 +373,7 @@ namespace AppInstaller::CLI::Workflow
 
         SearchSourceApplyFilters(context, searchRequest, matchType);
 
-        context.Add<Execution::Data::SearchResult>(context.Get<Execution::Data::Source>()->Search(searchRequest));
+        context.Add<Execution::Data::SearchResult>(SearchSource(context, searchRequest));
     }
 
     void SearchSourceForSingleCompletion(Execution::Context& context)
@@ -230,7 +388,7 @@ namespace AppInstaller::CLI::Workflow
 
         SearchSourceApplyFilters(context, searchRequest, matchType);
 
-        context.Add<Execution::Data::SearchResult>(context.Get<Execution::Data::Source>()->Search(searchRequest));
+        context.Add<Execution::Data::SearchResult>(SearchSource(context, searchRequest));
     }
 
     void SearchSourceForCompletionField::operator()(Execution::Context& context) const
@@ -243,7 +401,7 @@ namespace AppInstaller::CLI::Workflow
         // If filters are provided, be generous with the search no matter the intended result.
         SearchSourceApplyFilters(context, searchRequest, MatchType::Substring);
 
-        context.Add<Execution::Data::SearchResult>(context.Get<Execution::Data::Source>()->Search(searchRequest));
+        context.Add<Execution::Data::SearchResult>(SearchSource(context, searchRequest));
     }
 
     void ReportSearchResult(Execution::Context& context)
@@ -251,14 +409,36 @@ namespace AppInstaller::CLI::Workflow
         auto& searchResult = context.Get<Execution::Data::SearchResult>();
         Logging::Telemetry().LogSearchResultCount(searchResult.Matches.size());
 
+        if (context.Args.Contains(Execution::Args::Type::Output))
+        {
+            Execution::JsonLinesOutput output(context.Reporter);
+
+            for (const auto& match : searchResult.Matches)
+            {
+                auto app = match.Application.get();
+
+                Json::Value line{ Json::objectValue };
+                line["Id"] = app->GetId().get();
+                line["Name"] = app->GetName().get();
+                line["Version"] = app->GetVersions(Repository::VersionQuery::First()).at(0).GetVersion().ToString();
+                line["Source"] = match.SourceName;
+                line["MatchField"] = std::string{ ApplicationMatchFieldToString(match.MatchCriteria.Field) };
+                line["MatchType"] = std::string{ MatchTypeToString(match.MatchCriteria.Type) };
+                line["MatchValue"] = match.MatchCriteria.Value;
+                output.OutputLine(line);
+            }
+
+            return;
+        }
+
         Execution::TableOutput<5> table(context.Reporter, { Resource::String::SearchName, Resource::String::SearchId, Resource::String::SearchVersion, Resource::String::SearchMatch, Resource::String::SearchSource });
 
         for (size_t i = 0; i < searchResult.Matches.size(); ++i)
         {
             auto app = searchResult.Matches[i].Application.get();
-            auto allVersions = app->GetVersions();
+            auto latestVersion = app->GetVersions(Repository::VersionQuery::First());
 
-            table.OutputLine({ app->GetName(), app->GetId(), allVersions.at(0).GetVersion().ToString(), GetMatchCriteriaDescriptor(searchResult.Matches[i]), searchResult.Matches[i].SourceName });
+            table.OutputLine({ app->GetName(), app->GetId(), latestVersion.at(0).GetVersion().ToString(), GetMatchCriteriaDescriptor(searchResult.Matches[i]), searchResult.Matches[i].SourceName });
         }
 
         table.Complete();
@@ -394,7 +574,17 @@ namespace AppInstaller::CLI::Workflow
     void SelectInstaller(Execution::Context& context)
     {
         ManifestComparator manifestComparator(context.Args);
-        context.Add<Execution::Data::Installer>(manifestComparator.GetPreferredInstaller(context.Get<Execution::Data::Manifest>()));
+        const auto& manifest = context.Get<Execution::Data::Manifest>();
+
+        // Only the selected installer is copied out of the manifest.
+        std::optional<Manifest::ManifestInstaller> installer;
+        std::optional<size_t> installerIndex = manifestComparator.GetPreferredInstaller(manifest);
+        if (installerIndex)
+        {
+            installer = manifest.Installers[installerIndex.value()];
+        }
+
+        context.Add<Execution::Data::Installer>(std::move(installer));
     }
 
     void EnsureRunningAsAdmin(Execution::Context& context)
@@ -418,11 +608,23 @@ namespace AppInstaller::CLI::Workflow
     }
 }
 
+namespace
+{
+    // The time spent in the tasks run by the task that is running on this thread.
+    // It is taken out of the duration of the running task, so that each task records only its own time.
+    thread_local std::chrono::steady_clock::duration s_nestedTaskTime{};
+}
+
 AppInstaller::CLI::Execution::Context& operator<<(AppInstaller::CLI::Execution::Context& context, AppInstaller::CLI::Workflow::WorkflowTask::Func f)
 {
     return (context << AppInstaller::CLI::Workflow::WorkflowTask(f));
 }
 
+AppInstaller::CLI::Execution::Context& operator<<(AppInstaller::CLI::Execution::Context& context, AppInstaller::CLI::Workflow::WorkflowTask::AsyncFunc f)
+{
+    return (context << AppInstaller::CLI::Workflow::WorkflowTask(f));
+}
+
 AppInstaller::CLI::Execution::Context& operator<<(AppInstaller::CLI::Execution::Context& context, const AppInstaller::CLI::Workflow::WorkflowTask& task)
 {
     if (!context.IsTerminated())
@@ -431,6 +633,16 @@ AppInstaller::CLI::Execution::Context& operator<<(AppInstaller::CLI::Execution::
         if (context.ShouldExecuteWorkflowTask(task))
 #endif
         {
+            auto start = std::chrono::steady_clock::now();
+            auto outerNestedTaskTime = std::exchange(s_nestedTaskTime, {});
+
+            auto recordDuration = wil::scope_exit([&]()
+                {
+                    auto duration = std::chrono::steady_clock::now() - start;
+                    AppInstaller::Logging::RecordWorkflowTaskDuration(std::chrono::duration_cast<std::chrono::microseconds>(duration - s_nestedTaskTime));
+                    s_nestedTaskTime = outerNestedTaskTime + duration;
+                });
+
             task(context);
         }
     }
@@ -5,6 +5,7 @@
 #include <winget/ExperimentalFeature.h>
 #include <AppInstallerRepositorySearch.h>
 
+#include <future>
 #include <string>
 #include <string_view>
 
@@ -21,7 +22,12 @@ namespace AppInstaller::CLI::Workflow
     {
         using Func = void (*)(Execution::Context&);
 
+        // A task that is a coroutine, so that it can await its I/O rather than block a thread on it.
+        // The task still completes before the next one starts; the context is only ever used by one task at a time.
+        using AsyncFunc = std::future<void> (*)(Execution::Context&);
+
         WorkflowTask(Func f) : m_isFunc(true), m_func(f) {}
+        WorkflowTask(AsyncFunc f) : m_isFunc(true), m_asyncFunc(f) {}
         WorkflowTask(std::string_view name) : m_name(name) {}
 
         virtual ~WorkflowTask() = default;
@@ -41,6 +47,7 @@ namespace AppInstaller::CLI::Workflow
     private:
         bool m_isFunc = false;
         Func m_func = nullptr;
+        AsyncFunc m_asyncFunc = nullptr;
         std::string m_name;
     };
 
@@ -56,6 +63,12 @@ namespace AppInstaller::CLI::Workflow
     // Outputs: SearchResult
     void SearchSourceForMany(Execution::Context& context);
 
+    // Finds each of the ids read from the id file exactly, with one search of the source for all of them.
+    // Required Args: IdFile
+    // Inputs: Source
+    // Outputs: SearchResult
+    void SearchSourceForIds(Execution::Context& context);
+
     // Performs a search on the source with the semantics of targeting a single package.
     // Required Args: None
     // Inputs: Source
@@ -182,5 +195,8 @@ namespace AppInstaller::CLI::Workflow
 // Passes the context to the function if it has not been terminated; returns the context.
 AppInstaller::CLI::Execution::Context& operator<<(AppInstaller::CLI::Execution::Context& context, AppInstaller::CLI::Workflow::WorkflowTask::Func f);
 
+// Passes the context to the coroutine if it has not been terminated, and waits for it to complete; returns the context.
+AppInstaller::CLI::Execution::Context& operator<<(AppInstaller::CLI::Execution::Context& context, AppInstaller::CLI::Workflow::WorkflowTask::AsyncFunc f);
+
 // Passes the context to the task if it has not been terminated; returns the context.
 AppInstaller::CLI::Execution::Context& operator<<(AppInstaller::CLI::Execution::Context& context, const AppInstaller::CLI::Workflow::WorkflowTask& task);
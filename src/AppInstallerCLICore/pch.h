@@ -8,16 +8,19 @@
 #include <WinInet.h>
 
 #include <array>
+#include <atomic>
 #include <iostream>
 #include <fstream>
 #include <future>
 #include <functional>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <optional>
 #include <sstream>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 #include <winrt/Windows.Foundation.h>
@@ -0,0 +1,386 @@
+﻿// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+namespace AppInstallerCLIE2ETests
+{
+    using NUnit.Framework;
+    using System;
+    using System.Collections.Generic;
+    using System.Diagnostics;
+    using System.IO;
+    using System.Linq;
+    using System.Runtime.InteropServices;
+    using System.Security.Cryptography;
+    using System.Text;
+    using System.Text.Json;
+
+    // Measures the latency and resource use of the commands against a local directory source holding a large synthetic index.
+    // Each command is run once cold (its first run against the source) and then several times warm; the measurements are
+    // written to a results file, and compared against a baseline file of an earlier run when one is given.
+    public class PerformanceCommand
+    {
+        private const string PerfTestSourceName = @"PerfTestSource";
+        private const string PerfTestPackagePrefix = @"PerfTest.Package";
+        private const string PerfRegressionThresholdDefault = "25";
+        private const string PerfSyntheticPackageCountDefault = "10000";
+        private const string PerfResultsFile = @"PerformanceResults.json";
+        private const int WarmRunCount = 5;
+        private const int IndexTimeOut = 600000;
+
+        private const string InstallTestExeInstaller = @"AppInstallerTestExeInstaller.exe";
+        private const string InstallTestMsiInstaller = @"AppInstallerTestMsiInstaller.msi";
+        private const string InstallTestMsixInstaller = @"AppInstallerTestMsixInstaller.msix";
+        private const string InstallTestMsiProductId = @"{A5D36CF1-1993-4F63-BFB4-3ACD910D36A1}";
+        private const string InstallTestMsixName = @"6c6338fe-41b7-46ca-8ba6-b5ad5312bb0e";
+
+        private string manifestDirectory;
+        private int packageCount;
+        private double regressionThreshold;
+        private Dictionary<string, CommandMeasurement> baseline;
+        private Dictionary<string, CommandMeasurement> results = new Dictionary<string, CommandMeasurement>();
+        private List<string> installPackages = new List<string>();
+
+        public class CommandMeasurement
+        {
+            public double WallTimeMs { get; set; }
+            public double CpuTimeMs { get; set; }
+            public long PeakWorkingSetBytes { get; set; }
+            public long IoBytes { get; set; }
+        }
+
+        [OneTimeSetUp]
+        public void OneTimeSetup()
+        {
+            if (TestCommon.InvokeCommandInDesktopPackage)
+            {
+                // The process under test is not started by us, so it cannot be measured
+                Assert.Ignore("Performance measurements require the executable to be run directly.");
+            }
+
+            packageCount = int.Parse(GetParameter(Constants.PerfSyntheticPackageCountParameter, PerfSyntheticPackageCountDefault));
+            regressionThreshold = double.Parse(GetParameter(Constants.PerfRegressionThresholdParameter, PerfRegressionThresholdDefault)) / 100;
+
+            string baselinePath = GetParameter(Constants.PerfBaselinePathParameter, null);
+            if (!string.IsNullOrEmpty(baselinePath))
+            {
+                baseline = JsonSerializer.Deserialize<Dictionary<string, CommandMeasurement>>(File.ReadAllText(baselinePath));
+            }
+
+            manifestDirectory = TestCommon.GetRandomTestDir();
+            WriteSyntheticManifests();
+            WriteInstallerManifests(GetParameter(Constants.PerfInstallerDirectoryParameter, TestCommon.GetTestFile("TestData")));
+
+            Assert.AreEqual(Constants.ErrorCode.S_OK, TestCommon.RunAICLICommand("source add", $"{PerfTestSourceName} \"{manifestDirectory}\" -t Microsoft.Directory", null, IndexTimeOut).ExitCode);
+        }
+
+        [OneTimeTearDown]
+        public void OneTimeTearDown()
+        {
+            TestCommon.RunAICLICommand("source remove", PerfTestSourceName);
+            TestCommon.WaitForDeploymentFinish();
+
+            if (results.Count > 0)
+            {
+                // The results of a run can be given as the baseline of a later one
+                string resultsPath = TestCommon.GetTestFile(PerfResultsFile);
+                File.WriteAllText(resultsPath, JsonSerializer.Serialize(results, new JsonSerializerOptions { WriteIndented = true }));
+                TestContext.Out.WriteLine("Performance results written to: " + resultsPath);
+            }
+        }
+
+        [Test]
+        public void SearchPerformance()
+        {
+            AssertNoRegressions(
+                Measure("search.query", "search", "PerfTest"),
+                Measure("search.id", "search", $"--id {GetPackageId(packageCount / 2)} --exact"),
+                Measure("search.tag", "search", $"--tag Tag{packageCount % 100}"));
+        }
+
+        [Test]
+        public void ShowPerformance()
+        {
+            AssertNoRegressions(Measure("show", "show", $"--id {GetPackageId(packageCount / 2)} --exact"));
+        }
+
+        [Test]
+        public void CompletePerformance()
+        {
+            AssertNoRegressions(Measure("complete", "complete", "--word PerfTest --commandline \"winget install PerfTest\" --position 23"));
+        }
+
+        [Test]
+        public void SourceUpdatePerformance()
+        {
+            AssertNoRegressions(Measure("source update", "source update", $"-n {PerfTestSourceName}", timeOut: IndexTimeOut));
+        }
+
+        [Test]
+        public void InstallPerformance()
+        {
+            if (installPackages.Count == 0)
+            {
+                Assert.Ignore("None of the test installers were found.");
+            }
+
+            var measured = new List<string>();
+            foreach (var package in installPackages)
+            {
+                measured.AddRange(Measure(
+                    "install." + package,
+                    "install",
+                    $"--id {package} --exact --silent",
+                    () => $" -l {TestCommon.GetRandomTestDir()}",
+                    () => CleanupInstall(package)));
+            }
+
+            AssertNoRegressions(measured);
+        }
+
+        // Runs the command cold and then warm, and records both; returns the names of the measurements.
+        // The optional functions give arguments that change with each run, and undo what a run did.
+        private IEnumerable<string> Measure(string name, string command, string parameters, Func<string> runParameters = null, Action cleanup = null, int timeOut = 60000)
+        {
+            CommandMeasurement RunOnce()
+            {
+                var measurement = RunMeasuredCommand(command, parameters + (runParameters?.Invoke() ?? string.Empty), timeOut);
+                cleanup?.Invoke();
+                return measurement;
+            }
+
+            results[name + ".Cold"] = RunOnce();
+
+            var warm = Enumerable.Range(0, WarmRunCount).Select(i => RunOnce()).ToList();
+            results[name + ".Warm"] = new CommandMeasurement
+            {
+                WallTimeMs = Median(warm.Select(m => m.WallTimeMs)),
+                CpuTimeMs = Median(warm.Select(m => m.CpuTimeMs)),
+                PeakWorkingSetBytes = (long)Median(warm.Select(m => (double)m.PeakWorkingSetBytes)),
+                IoBytes = (long)Median(warm.Select(m => (double)m.IoBytes)),
+            };
+
+            return new[] { name + ".Cold", name + ".Warm" };
+        }
+
+        private void AssertNoRegressions(params IEnumerable<string>[] names)
+        {
+            var regressions = new List<string>();
+
+            foreach (var name in names.SelectMany(n => n))
+            {
+                var current = results[name];
+                TestContext.Out.WriteLine($"{name}: wall {current.WallTimeMs:F0} ms, cpu {current.CpuTimeMs:F0} ms, peak working set {current.PeakWorkingSetBytes} bytes, I/O {current.IoBytes} bytes");
+
+                if (baseline == null || !baseline.TryGetValue(name, out var previous))
+                {
+                    continue;
+                }
+
+                CheckRegression(regressions, name, "wall time", current.WallTimeMs, previous.WallTimeMs);
+                CheckRegression(regressions, name, "CPU time", current.CpuTimeMs, previous.CpuTimeMs);
+                CheckRegression(regressions, name, "peak working set", current.PeakWorkingSetBytes, previous.PeakWorkingSetBytes);
+                CheckRegression(regressions, name, "I/O bytes", current.IoBytes, previous.IoBytes);
+            }
+
+            Assert.IsEmpty(regressions, string.Join(Environment.NewLine, regressions));
+        }
+
+        private void CheckRegression(List<string> regressions, string name, string metric, double current, double previous)
+        {
+            if (previous > 0 && current > previous * (1 + regressionThreshold))
+            {
+                regressions.Add($"{name} {metric} regressed from {previous:F0} to {current:F0}");
+            }
+        }
+
+        private CommandMeasurement RunMeasuredCommand(string command, string parameters, int timeOut)
+        {
+            TestContext.Out.WriteLine($"Starting measured command run. AICLI path: {TestCommon.AICLIPath} Command: {command} Parameters: {parameters}");
+
+            using (Process p = new Process())
+            {
+                p.StartInfo = new ProcessStartInfo(TestCommon.AICLIPath, command + ' ' + parameters);
+                p.StartInfo.UseShellExecute = false;
+                p.StartInfo.RedirectStandardOutput = true;
+                p.StartInfo.RedirectStandardError = true;
+
+                // The output is read as it is written, so that a large result cannot block the process on a full pipe
+                StringBuilder stdOut = new StringBuilder();
+                p.OutputDataReceived += (sender, e) => { if (e.Data != null) { stdOut.AppendLine(e.Data); } };
+                p.ErrorDataReceived += (sender, e) => { };
+
+                Stopwatch stopwatch = Stopwatch.StartNew();
+                p.Start();
+                p.BeginOutputReadLine();
+                p.BeginErrorReadLine();
+
+                if (!p.WaitForExit(timeOut))
+                {
+                    throw new TimeoutException("Command run timed out.");
+                }
+
+                stopwatch.Stop();
+                p.WaitForExit();
+
+                if (TestCommon.VerboseLogging)
+                {
+                    TestContext.Out.WriteLine("Command run output. Output: " + stdOut);
+                }
+
+                Assert.AreEqual(Constants.ErrorCode.S_OK, p.ExitCode, $"{command} {parameters}");
+
+                // The handle stays valid after the exit, and the counters of the process can still be read through it
+                PROCESS_MEMORY_COUNTERS memoryCounters = new PROCESS_MEMORY_COUNTERS { cb = (uint)Marshal.SizeOf<PROCESS_MEMORY_COUNTERS>() };
+                Assert.True(GetProcessMemoryInfo(p.Handle, ref memoryCounters, memoryCounters.cb), "GetProcessMemoryInfo");
+                Assert.True(GetProcessIoCounters(p.Handle, out IO_COUNTERS ioCounters), "GetProcessIoCounters");
+
+                return new CommandMeasurement
+                {
+                    WallTimeMs = stopwatch.Elapsed.TotalMilliseconds,
+                    CpuTimeMs = p.TotalProcessorTime.TotalMilliseconds,
+                    PeakWorkingSetBytes = (long)memoryCounters.PeakWorkingSetSize.ToUInt64(),
+                    IoBytes = (long)(ioCounters.ReadTransferCount + ioCounters.WriteTransferCount + ioCounters.OtherTransferCount),
+                };
+            }
+        }
+
+        private void WriteSyntheticManifests()
+        {
+            for (int i = 0; i < packageCount; ++i)
+            {
+                // The installer is never downloaded, so neither the url nor the hash has to be real
+                File.WriteAllText(Path.Combine(manifestDirectory, GetPackageId(i) + ".yaml"),
+$@"Id: {GetPackageId(i)}
+Name: Perf Test Package {i}
+Version: 1.0.{i}.0
+Publisher: AppInstallerTest
+License: Test
+Tags: ""Tag{i % 100},PerfTest""
+Commands: ""perftest{i}""
+Installers:
+  - Arch: x86
+    Url: https://localhost/PerfTest/Package{i}.exe
+    Sha256: {new string('0', 64)}
+    InstallerType: exe
+    Switches:
+      Silent: /exesilent
+      SilentWithProgress: /exeswp
+ManifestVersion: 0.1.0
+");
+            }
+        }
+
+        // Local installer paths are copied rather than downloaded, so the installs measure the rest of the workflow.
+        private void WriteInstallerManifests(string installerDirectory)
+        {
+            WriteInstallerManifest(installerDirectory, InstallTestExeInstaller, "PerfTest.TestExeInstaller", "exe",
+@"    Switches:
+      Custom: /execustom
+      SilentWithProgress: /exeswp
+      Silent: /exesilent
+      Interactive: /exeinteractive
+      Language: /exeenus
+      Log: /exelog <LOGPATH>
+      InstallLocation: /InstallDir <INSTALLPATH>
+");
+            WriteInstallerManifest(installerDirectory, InstallTestMsiInstaller, "PerfTest.TestMsiInstaller", "msi");
+            WriteInstallerManifest(installerDirectory, InstallTestMsixInstaller, "PerfTest.TestMsixInstaller", "msix");
+        }
+
+        private void WriteInstallerManifest(string installerDirectory, string installerFile, string id, string installerType, string switches = "")
+        {
+            string installerPath = Path.Combine(installerDirectory, installerFile);
+            if (!File.Exists(installerPath))
+            {
+                TestContext.Out.WriteLine("Test installer not found, its install will not be measured: " + installerPath);
+                return;
+            }
+
+            string hash;
+            using (var sha256 = SHA256.Create())
+            using (var stream = File.OpenRead(installerPath))
+            {
+                hash = BitConverter.ToString(sha256.ComputeHash(stream)).Replace("-", string.Empty);
+            }
+
+            File.WriteAllText(Path.Combine(manifestDirectory, id + ".yaml"),
+$@"Id: {id}
+Name: {id}
+Version: 1.0.0.0
+Publisher: AppInstallerTest
+License: Test
+Installers:
+  - Arch: x86
+    Url: '{installerPath.Replace("'", "''")}'
+    Sha256: {hash}
+    InstallerType: {installerType}
+{switches}ManifestVersion: 0.1.0
+");
+
+            installPackages.Add(id);
+        }
+
+        private void CleanupInstall(string package)
+        {
+            if (package == "PerfTest.TestMsiInstaller")
+            {
+                TestCommon.RunCommand("msiexec.exe", $"/qn /x {InstallTestMsiProductId}");
+            }
+            else if (package == "PerfTest.TestMsixInstaller")
+            {
+                TestCommon.RemoveMsix(InstallTestMsixName);
+            }
+        }
+
+        private static string GetPackageId(int i)
+        {
+            return PerfTestPackagePrefix + i.ToString("D6");
+        }
+
+        private static string GetParameter(string name, string defaultValue)
+        {
+            return TestContext.Parameters.Exists(name) ? TestContext.Parameters.Get(name) : defaultValue;
+        }
+
+        private static double Median(IEnumerable<double> values)
+        {
+            var sorted = values.OrderBy(v => v).ToList();
+            int middle = sorted.Count / 2;
+            return (sorted.Count % 2 == 0) ? (sorted[middle - 1] + sorted[middle]) / 2 : sorted[middle];
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct IO_COUNTERS
+        {
+            public ulong ReadOperationCount;
+            public ulong WriteOperationCount;
+            public ulong OtherOperationCount;
+            public ulong ReadTransferCount;
+            public ulong WriteTransferCount;
+            public ulong OtherTransferCount;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct PROCESS_MEMORY_COUNTERS
+        {
+            public uint cb;
+            public uint PageFaultCount;
+            public UIntPtr PeakWorkingSetSize;
+            public UIntPtr WorkingSetSize;
+            public UIntPtr QuotaPeakPagedPoolUsage;
+            public UIntPtr QuotaPagedPoolUsage;
+            public UIntPtr QuotaPeakNonPagedPoolUsage;
+            public UIntPtr QuotaNonPagedPoolUsage;
+            public UIntPtr PagefileUsage;
+            public UIntPtr PeakPagefileUsage;
+        }
+
+        [DllImport("kernel32.dll", SetLastError = true)]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        private static extern bool GetProcessIoCounters(IntPtr hProcess, out IO_COUNTERS ioCounters);
+
+        [DllImport("kernel32.dll", EntryPoint = "K32GetProcessMemoryInfo", SetLastError = true)]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        private static extern bool GetProcessMemoryInfo(IntPtr hProcess, ref PROCESS_MEMORY_COUNTERS counters, uint size);
+    }
+}
@@ -0,0 +1,408 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include "TestHooks.h"
+#include <AggregatedSource.h>
+#include <SourceLatencies.h>
+
+#include <atomic>
+#include <set>
+
+using namespace AppInstaller::Repository;
+using namespace std::chrono_literals;
+
+namespace
+{
+    // A source that gives the matches it was created with, in that order.
+    struct TestSource : public ISource
+    {
+        TestSource(std::string name, std::vector<ApplicationMatchFilter> matches, bool truncated = false) :
+            m_matches(std::move(matches)), m_truncated(truncated)
+        {
+            m_details.Name = std::move(name);
+        }
+
+        const SourceDetails& GetDetails() const override { return m_details; }
+
+        SearchResult Search(const SearchRequest&) override
+        {
+            SearchResult result;
+            for (const auto& match : m_matches)
+            {
+                result.Matches.emplace_back(std::unique_ptr<IApplication>(), match);
+            }
+            result.Truncated = m_truncated;
+            return result;
+        }
+
+        bool MayContainId(std::string_view id) const override
+        {
+            return m_ids.empty() || m_ids.count(std::string{ id }) != 0;
+        }
+
+        // Limits the ids that the source may contain; by default it may contain any.
+        void SetIds(std::set<std::string> ids) { m_ids = std::move(ids); }
+
+    private:
+        SourceDetails m_details;
+        std::vector<ApplicationMatchFilter> m_matches;
+        bool m_truncated;
+        std::set<std::string> m_ids;
+    };
+
+    // A source whose first search does not answer until it is cancelled; any other search answers at once.
+    struct StalledSource : public ISource
+    {
+        StalledSource(std::string name, bool supportsConcurrentSearches) : m_supportsConcurrentSearches(supportsConcurrentSearches)
+        {
+            m_details.Name = std::move(name);
+        }
+
+        const SourceDetails& GetDetails() const override { return m_details; }
+
+        SearchResult Search(const SearchRequest& request) override
+        {
+            if (m_searches++ == 0)
+            {
+                for (auto start = std::chrono::steady_clock::now(); std::chrono::steady_clock::now() - start < 10s;)
+                {
+                    if (request.Progress && request.Progress->IsCancelled())
+                    {
+                        m_cancelled = true;
+                        THROW_HR(E_ABORT);
+                    }
+                    std::this_thread::sleep_for(10ms);
+                }
+            }
+
+            SearchResult result;
+            result.Matches.emplace_back(std::unique_ptr<IApplication>(), ApplicationMatchFilter{ ApplicationMatchField::Id, MatchType::Exact, "stalled" });
+            return result;
+        }
+
+        bool SupportsConcurrentSearches() const override { return m_supportsConcurrentSearches; }
+
+        size_t GetSearchCount() const { return m_searches; }
+        bool WasCancelled() const { return m_cancelled; }
+
+    private:
+        SourceDetails m_details;
+        bool m_supportsConcurrentSearches;
+        std::atomic<size_t> m_searches = 0;
+        std::atomic_bool m_cancelled = false;
+    };
+
+    // An application whose manifests are named for the source that has it.
+    struct TestApplication : public IApplication
+    {
+        TestApplication(std::string id, std::string source, std::vector<std::string> versions) :
+            m_id(std::move(id)), m_source(std::move(source)), m_versions(std::move(versions)) {}
+
+        AppInstaller::Utility::LocIndString GetId() override { return AppInstaller::Utility::LocIndString{ m_id }; }
+        AppInstaller::Utility::LocIndString GetName() override { return AppInstaller::Utility::LocIndString{ m_source }; }
+
+        std::optional<AppInstaller::Manifest::Manifest> GetManifest(const AppInstaller::Utility::NormalizedString& version, const AppInstaller::Utility::NormalizedString&) override
+        {
+            // The latest version is the first one
+            if (m_versions.empty() || (!version.empty() && std::find(m_versions.begin(), m_versions.end(), version) == m_versions.end()))
+            {
+                return {};
+            }
+
+            AppInstaller::Manifest::Manifest manifest;
+            manifest.Id = m_id;
+            manifest.Name = m_source;
+            manifest.Version = version.empty() ? m_versions.front() : version;
+            return manifest;
+        }
+
+        std::vector<AppInstaller::Utility::VersionAndChannel> GetVersions() override
+        {
+            std::vector<AppInstaller::Utility::VersionAndChannel> result;
+            for (const auto& version : m_versions)
+            {
+                result.emplace_back(AppInstaller::Utility::Version{ version }, AppInstaller::Utility::Channel{ "" });
+            }
+            return result;
+        }
+
+    private:
+        std::string m_id;
+        std::string m_source;
+        std::vector<std::string> m_versions;
+    };
+
+    // A source that gives an application for each of its matches, matched on the id.
+    struct PackageSource : public ISource
+    {
+        PackageSource(std::string name, std::vector<std::pair<std::string, std::vector<std::string>>> packages) :
+            m_packages(std::move(packages))
+        {
+            m_details.Name = std::move(name);
+        }
+
+        const SourceDetails& GetDetails() const override { return m_details; }
+
+        SearchResult Search(const SearchRequest&) override
+        {
+            SearchResult result;
+            for (const auto& [id, versions] : m_packages)
+            {
+                result.Matches.emplace_back(std::make_unique<TestApplication>(id, m_details.Name, versions), ApplicationMatchFilter{ ApplicationMatchField::Id, MatchType::Exact, id });
+            }
+            return result;
+        }
+
+    private:
+        SourceDetails m_details;
+        std::vector<std::pair<std::string, std::vector<std::string>>> m_packages;
+    };
+
+    std::shared_ptr<AggregatedSource> CreateAggregatedSource(bool secondTruncated = false)
+    {
+        auto aggregated = std::make_shared<AggregatedSource>();
+        aggregated->AddSource(std::make_shared<TestSource>("first", std::vector<ApplicationMatchFilter>{
+            { ApplicationMatchField::Name, MatchType::Exact, "a" },
+            { ApplicationMatchField::Id, MatchType::Exact, "b" },
+            { ApplicationMatchField::Id, MatchType::Substring, "c" },
+        }));
+        aggregated->AddSource(std::make_shared<TestSource>("second", std::vector<ApplicationMatchFilter>{
+            { ApplicationMatchField::Id, MatchType::Exact, "d" },
+            { ApplicationMatchField::Tag, MatchType::CaseInsensitive, "e" },
+        }, secondTruncated));
+        return aggregated;
+    }
+
+    std::vector<std::string> GetValues(const std::vector<ResultMatch>& matches)
+    {
+        std::vector<std::string> result;
+        for (const auto& match : matches)
+        {
+            result.emplace_back(match.MatchCriteria.Value);
+        }
+        return result;
+    }
+}
+
+TEST_CASE("AggregatedSource_CursorMergesInOrder", "[aggregatedsource]")
+{
+    auto aggregated = CreateAggregatedSource();
+
+    // Equal matches keep the order of the sources
+    std::vector<std::string> expected{ "b", "d", "a", "e", "c" };
+
+    SearchResult result = aggregated->Search({});
+    REQUIRE(GetValues(result.Matches) == expected);
+    REQUIRE(!result.Truncated);
+    REQUIRE(result.Matches[0].SourceName == "first");
+    REQUIRE(result.Matches[1].SourceName == "second");
+
+    auto cursor = aggregated->OpenSearchCursor({});
+    std::vector<std::string> values;
+    for (;;)
+    {
+        auto matches = cursor->Next(2);
+        auto batchValues = GetValues(matches);
+        values.insert(values.end(), batchValues.begin(), batchValues.end());
+
+        if (matches.size() < 2)
+        {
+            break;
+        }
+    }
+
+    REQUIRE(values == expected);
+    REQUIRE(!cursor->IsTruncated());
+    REQUIRE(cursor->Next(2).empty());
+}
+
+TEST_CASE("AggregatedSource_SkipsSourcesWithoutExactId", "[aggregatedsource]")
+{
+    auto aggregated = std::make_shared<AggregatedSource>();
+
+    auto first = std::make_shared<TestSource>("first", std::vector<ApplicationMatchFilter>{ { ApplicationMatchField::Id, MatchType::Exact, "a" } });
+    first->SetIds({ "a" });
+    aggregated->AddSource(first);
+
+    auto second = std::make_shared<TestSource>("second", std::vector<ApplicationMatchFilter>{ { ApplicationMatchField::Id, MatchType::Exact, "b" } });
+    second->SetIds({ "b" });
+    aggregated->AddSource(second);
+
+    REQUIRE(aggregated->MayContainId("a"));
+    REQUIRE(aggregated->MayContainId("b"));
+    REQUIRE(!aggregated->MayContainId("c"));
+
+    SearchRequest request;
+    request.Filters.emplace_back(ApplicationMatchField::Id, MatchType::Exact, "b");
+
+    SearchResult result = aggregated->Search(request);
+    REQUIRE(GetValues(result.Matches) == std::vector<std::string>{ "b" });
+    REQUIRE(result.Matches[0].SourceName == "second");
+
+    // Only exact id filters rule out a source
+    request.Filters[0].Type = MatchType::CaseInsensitive;
+    REQUIRE(aggregated->Search(request).Matches.size() == 2);
+
+    request.Filters.clear();
+    request.Inclusions.emplace_back(ApplicationMatchField::Id, MatchType::Exact, "b");
+    REQUIRE(aggregated->Search(request).Matches.size() == 2);
+}
+
+TEST_CASE("AggregatedSource_CursorTruncated", "[aggregatedsource]")
+{
+    SECTION("By the maximum")
+    {
+        auto aggregated = CreateAggregatedSource();
+
+        SearchRequest request;
+        request.MaximumResults = 3;
+
+        auto cursor = aggregated->OpenSearchCursor(request);
+        REQUIRE(GetValues(cursor->Next(10)) == std::vector<std::string>{ "b", "d", "a" });
+        REQUIRE(cursor->IsTruncated());
+
+        SearchResult result = aggregated->Search(request);
+        REQUIRE(result.Matches.size() == 3);
+        REQUIRE(result.Truncated);
+    }
+    SECTION("By a source")
+    {
+        auto aggregated = CreateAggregatedSource(true);
+
+        auto cursor = aggregated->OpenSearchCursor({});
+        REQUIRE(cursor->Next(10).size() == 5);
+        REQUIRE(cursor->IsTruncated());
+    }
+}
+
+TEST_CASE("AggregatedSource_SourceTimeout", "[aggregatedsource]")
+{
+    AppInstaller::Repository::TestHook_SetSearchPolicy(200ms, false);
+    auto clearPolicy = wil::scope_exit([]() { AppInstaller::Repository::TestHook_ClearSearchPolicy(); });
+
+    auto stalled = std::make_shared<StalledSource>("stalled", false);
+
+    {
+        auto aggregated = CreateAggregatedSource();
+        aggregated->AddSource(stalled);
+
+        auto start = std::chrono::steady_clock::now();
+        SearchResult result = aggregated->Search({});
+        REQUIRE(std::chrono::steady_clock::now() - start < 5s);
+
+        // The sources that answered give their results, and the one that did not is named
+        REQUIRE(GetValues(result.Matches) == std::vector<std::string>{ "b", "d", "a", "e", "c" });
+        REQUIRE(result.MissingSources == std::vector<std::string>{ "stalled" });
+    }
+
+    // The search that was left behind was cancelled, and is waited for when the aggregate is destroyed
+    REQUIRE(stalled->WasCancelled());
+    REQUIRE(stalled->GetSearchCount() == 1);
+}
+
+TEST_CASE("AggregatedSource_HedgesSlowSearch", "[aggregatedsource]")
+{
+    AppInstaller::Repository::TestHook_SetSearchPolicy(0ms, true);
+    auto clearPolicy = wil::scope_exit([]() { AppInstaller::Repository::TestHook_ClearSearchPolicy(); });
+
+    SECTION("Concurrent searches")
+    {
+        // The recent searches of the source all took 50ms
+        for (int i = 0; i < 20; ++i)
+        {
+            SourceLatencies::Instance().Record("hedged", 50ms);
+        }
+
+        auto stalled = std::make_shared<StalledSource>("hedged", true);
+
+        {
+            auto aggregated = std::make_shared<AggregatedSource>();
+            aggregated->AddSource(stalled);
+
+            auto start = std::chrono::steady_clock::now();
+            SearchResult result = aggregated->Search({});
+            REQUIRE(std::chrono::steady_clock::now() - start < 5s);
+
+            // The duplicate answered for the search that stalled
+            REQUIRE(GetValues(result.Matches) == std::vector<std::string>{ "stalled" });
+            REQUIRE(result.MissingSources.empty());
+            REQUIRE(stalled->GetSearchCount() == 2);
+        }
+
+        REQUIRE(stalled->WasCancelled());
+    }
+    SECTION("One search at a time")
+    {
+        for (int i = 0; i < 20; ++i)
+        {
+            SourceLatencies::Instance().Record("unhedged", 50ms);
+        }
+
+        auto stalled = std::make_shared<StalledSource>("unhedged", false);
+        AppInstaller::Repository::TestHook_SetSearchPolicy(500ms, true);
+
+        {
+            auto aggregated = std::make_shared<AggregatedSource>();
+            aggregated->AddSource(stalled);
+
+            // A duplicate would only wait behind the first search, so none is sent
+            SearchResult result = aggregated->Search({});
+            REQUIRE(result.Matches.empty());
+            REQUIRE(result.MissingSources == std::vector<std::string>{ "unhedged" });
+            REQUIRE(stalled->GetSearchCount() == 1);
+        }
+    }
+}
+
+TEST_CASE("AggregatedSource_MergesPackagesAcrossSources", "[aggregatedsource]")
+{
+    auto aggregated = std::make_shared<AggregatedSource>();
+    aggregated->AddSource(std::make_shared<PackageSource>("first", std::vector<std::pair<std::string, std::vector<std::string>>>{
+        { "Contoso.App", { "2.0", "1.0" } },
+    }));
+    aggregated->AddSource(std::make_shared<PackageSource>("second", std::vector<std::pair<std::string, std::vector<std::string>>>{
+        { "contoso.app", { "3.0", "2.0" } },
+        { "Fabrikam.App", { "1.0" } },
+    }));
+
+    SearchRequest request;
+    request.MaximumResults = 2;
+
+    // The copy in the second source does not count toward the maximum
+    SearchResult result = aggregated->Search(request);
+    REQUIRE(result.Matches.size() == 2);
+    REQUIRE(!result.Truncated);
+
+    auto& merged = result.Matches[0];
+    REQUIRE(merged.SourceName == "first");
+    REQUIRE(merged.Application->GetId().get() == "Contoso.App");
+    REQUIRE(merged.Application->GetName().get() == "first");
+
+    std::vector<std::string> versions;
+    for (const auto& version : merged.Application->GetVersions())
+    {
+        versions.emplace_back(version.GetVersion().ToString());
+    }
+    REQUIRE(versions == std::vector<std::string>{ "3.0", "2.0", "1.0" });
+
+    // Each version comes from the first source that has it
+    REQUIRE(merged.Application->GetManifest("3.0", "")->Name == "second");
+    REQUIRE(merged.Application->GetManifest("2.0", "")->Name == "first");
+    REQUIRE(merged.Application->GetManifest("1.0", "")->Name == "first");
+    REQUIRE(!merged.Application->GetManifest("4.0", ""));
+
+    auto latest = merged.Application->GetManifest("", "");
+    REQUIRE(latest->Version == "3.0");
+    REQUIRE(latest->Name == "second");
+
+    auto manifests = merged.Application->GetManifests(merged.Application->GetVersions());
+    REQUIRE(manifests.size() == 3);
+    REQUIRE(manifests[0]->Name == "second");
+    REQUIRE(manifests[1]->Name == "first");
+    REQUIRE(manifests[2]->Name == "first");
+
+    REQUIRE(result.Matches[1].SourceName == "second");
+    REQUIRE(result.Matches[1].Application->GetId().get() == "Fabrikam.App");
+    REQUIRE(result.Matches[1].Application->GetVersions().size() == 1);
+}
@@ -0,0 +1,79 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include "Commands/BatchCommand.h"
+#include <AppInstallerErrors.h>
+
+using namespace std::string_literals;
+using namespace TestCommon;
+using namespace AppInstaller::CLI;
+
+namespace
+{
+    constexpr std::string_view s_TestMsixHash = "Sha256: 6a2d3683fa19bf00e58e07d1313d20a5f5735ebbd6a999d33381d28740ee07ea";
+
+    size_t CountOccurrences(const std::string& value, std::string_view find)
+    {
+        size_t result = 0;
+        for (size_t pos = value.find(find); pos != std::string::npos; pos = value.find(find, pos + find.size()))
+        {
+            ++result;
+        }
+        return result;
+    }
+
+    void ExecuteBatch(Execution::Context& context, const std::filesystem::path& batchFile, const std::string& contents)
+    {
+        std::ofstream{ batchFile } << contents;
+
+        context.Args.AddArg(Execution::Args::Type::BatchFile, batchFile.u8string());
+        BatchCommand batchCommand({});
+        batchCommand.Execute(context);
+    }
+}
+
+TEST_CASE("BatchCommand_ExecutesEachLine", "[batch]")
+{
+    TempFile batchFile{ "batch"s, ".txt"s };
+    std::string msixPath = TestDataFile("TestSignedApp.msix").GetPath().u8string();
+
+    std::ostringstream output;
+    Execution::Context context{ output, std::cin };
+    ExecuteBatch(context, batchFile,
+        "# Comments and empty lines are skipped\n"
+        "hash \"" + msixPath + "\"\n"
+        "\n"
+        "  winget hash --msix \"" + msixPath + "\"  \r\n");
+
+    REQUIRE(SUCCEEDED(context.GetTerminationHR()));
+    REQUIRE(CountOccurrences(output.str(), s_TestMsixHash) == 2);
+    REQUIRE(CountOccurrences(output.str(), "SignatureSha256: ") == 1);
+}
+
+TEST_CASE("BatchCommand_StopsAtFailedLine", "[batch]")
+{
+    TempFile batchFile{ "batch"s, ".txt"s };
+    TempFile missingFile{ "missing"s, ".msix"s };
+    std::string msixPath = TestDataFile("TestSignedApp.msix").GetPath().u8string();
+
+    std::ostringstream output;
+    Execution::Context context{ output, std::cin };
+    ExecuteBatch(context, batchFile,
+        "hash \"" + missingFile.GetPath().u8string() + "\"\n"
+        "hash \"" + msixPath + "\"\n");
+
+    REQUIRE(context.GetTerminationHR() == HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+    REQUIRE(CountOccurrences(output.str(), s_TestMsixHash) == 0);
+}
+
+TEST_CASE("BatchCommand_NestedBatch", "[batch]")
+{
+    TempFile batchFile{ "batch"s, ".txt"s };
+
+    std::ostringstream output;
+    Execution::Context context{ output, std::cin };
+    ExecuteBatch(context, batchFile, "batch \"" + batchFile.GetPath().u8string() + "\"\n");
+
+    REQUIRE(context.GetTerminationHR() == APPINSTALLER_CLI_ERROR_INVALID_CL_ARGUMENTS);
+}
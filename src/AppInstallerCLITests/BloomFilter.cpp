@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <Microsoft/BloomFilter.h>
+
+using namespace AppInstaller::Repository::Microsoft;
+
+
+TEST_CASE("BloomFilter_NoFalseNegatives", "[bloomfilter]")
+{
+    constexpr size_t count = 1000;
+
+    BloomFilter filter{ count };
+    for (size_t i = 0; i < count; ++i)
+    {
+        filter.Add("contained." + std::to_string(i));
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        REQUIRE(filter.MayContain("contained." + std::to_string(i)));
+    }
+
+    // About one percent are expected; allow for the distribution of the hashes
+    size_t falsePositives = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (filter.MayContain("missing." + std::to_string(i)))
+        {
+            ++falsePositives;
+        }
+    }
+    REQUIRE(falsePositives < count / 20);
+}
+
+TEST_CASE("BloomFilter_Serialize", "[bloomfilter]")
+{
+    BloomFilter filter{ 3 };
+    filter.Add("microsoft.msixsdk");
+    filter.Add("contoso.app");
+
+    std::string serialized = filter.Serialize();
+    BloomFilter read = BloomFilter::Deserialize(serialized);
+
+    REQUIRE(read.MayContain("microsoft.msixsdk"));
+    REQUIRE(read.MayContain("contoso.app"));
+    REQUIRE(read.Serialize() == serialized);
+
+    // An empty filter contains nothing
+    REQUIRE(!BloomFilter{ 0 }.MayContain("microsoft.msixsdk"));
+}
+
+TEST_CASE("BloomFilter_DeserializeInvalid", "[bloomfilter]")
+{
+    REQUIRE_THROWS_HR(BloomFilter::Deserialize(""), E_INVALIDARG);
+    REQUIRE_THROWS_HR(BloomFilter::Deserialize("2;7;00"), E_INVALIDARG);
+    REQUIRE_THROWS_HR(BloomFilter::Deserialize("1;0;00"), E_INVALIDARG);
+    REQUIRE_THROWS_HR(BloomFilter::Deserialize("1;x;00"), E_INVALIDARG);
+    REQUIRE_THROWS_HR(BloomFilter::Deserialize("1;7;"), E_INVALIDARG);
+    REQUIRE_THROWS_HR(BloomFilter::Deserialize("1;7;0"), E_INVALIDARG);
+    REQUIRE_THROWS_HR(BloomFilter::Deserialize("1;7;0g"), E_INVALIDARG);
+}
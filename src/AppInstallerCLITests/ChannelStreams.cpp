@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <ChannelStreams.h>
+#include <ExecutionReporter.h>
+
+using namespace AppInstaller::CLI::Execution;
+using namespace std::string_literals;
+
+namespace
+{
+    std::string ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream stream{ path, std::ios::binary };
+        std::ostringstream content;
+        content << stream.rdbuf();
+        return content.str();
+    }
+
+    wil::unique_hfile OpenForWrite(const std::filesystem::path& path)
+    {
+        wil::unique_hfile result{ CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        REQUIRE(result);
+        return result;
+    }
+}
+
+TEST_CASE("RedirectedOutputBuffer_WritesInBatches", "[ChannelStreams]")
+{
+    TestCommon::TempFile tempFile("redirected_output"s, ".txt"s);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    wil::unique_hfile file = OpenForWrite(tempFile.GetPath());
+    REQUIRE(RedirectedOutputBuffer::IsRedirected(file.get()));
+
+    RedirectedOutputBuffer buffer{ file.get() };
+    std::ostream stream{ &buffer };
+
+    stream << "first\nsecond";
+    REQUIRE(ReadFile(tempFile.GetPath()).empty());
+
+    stream.flush();
+    REQUIRE(ReadFile(tempFile.GetPath()) == "first\r\nsecond");
+
+    // More than the buffer holds is written as it fills
+    std::string line(RedirectedOutputBuffer::BufferSize / 4, 'a');
+    line += '\n';
+    for (size_t i = 0; i < 5; ++i)
+    {
+        stream << line;
+    }
+
+    std::string written = ReadFile(tempFile.GetPath());
+    REQUIRE(written.size() > "first\r\nsecond"s.size());
+    REQUIRE(written.size() < "first\r\nsecond"s.size() + 5 * (line.size() + 1));
+
+    stream.flush();
+    REQUIRE(ReadFile(tempFile.GetPath()).size() == "first\r\nsecond"s.size() + 5 * (line.size() + 1));
+}
+
+TEST_CASE("Reporter_OutputRedirected_LinesNotFlushed", "[ChannelStreams]")
+{
+    TestCommon::TempFile tempFile("redirected_output"s, ".txt"s);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    wil::unique_hfile file = OpenForWrite(tempFile.GetPath());
+    RedirectedOutputBuffer buffer{ file.get() };
+    std::ostream out{ &buffer };
+    std::istringstream in;
+
+    {
+        Reporter reporter{ out, in };
+        reporter.SetOutputRedirected();
+
+        reporter.Info() << "line" << std::endl;
+        reporter.Warn() << "warning" << std::endl;
+
+        // Nothing is written until the stream is flushed, and there is no VT in what is
+        REQUIRE(ReadFile(tempFile.GetPath()).empty());
+    }
+
+    out.flush();
+    REQUIRE(ReadFile(tempFile.GetPath()) == "line\r\nwarning\r\n");
+}
@@ -225,6 +225,29 @@ TEST_CASE("ParseArguments_TooManyPositional", "[command]")
     REQUIRE_COMMAND_EXCEPTION(command.ParseArguments(inv, args), values[2]);
 }
 
+TEST_CASE("ParseArguments_PositionalWithCountLimit", "[command]")
+{
+    Args args;
+    TestCommand command({
+            Argument{ "pos1", 'p', Args::Type::Channel, DefaultDesc, ArgumentType::Positional }.SetCountLimit(3),
+            Argument{ "std1", 's', Args::Type::Command, DefaultDesc, ArgumentType::Standard },
+        });
+
+    std::vector<std::string> values{ "val1", "val2", "val3" };
+    Invocation inv{ std::vector<std::string>(values) };
+
+    command.ParseArguments(inv, args);
+
+    REQUIRE(args.GetCount(Args::Type::Channel) == 3);
+    REQUIRE(*args.GetArgs(Args::Type::Channel) == values);
+
+    Args tooManyArgs;
+    std::vector<std::string> tooManyValues{ "val1", "val2", "val3", "val4" };
+    Invocation tooManyInv{ std::vector<std::string>(tooManyValues) };
+
+    REQUIRE_COMMAND_EXCEPTION(command.ParseArguments(tooManyInv, tooManyArgs), tooManyValues[3]);
+}
+
 TEST_CASE("ParseArguments_InvalidChar", "[command]")
 {
     Args args;
@@ -472,3 +495,75 @@ TEST_CASE("ParseArguments_UnknownName", "[command]")
 
     REQUIRE_COMMAND_EXCEPTION(command.ParseArguments(inv, args), values[1]);
 }
+
+TEST_CASE("ParseArguments_SameCommandTwice", "[command]")
+{
+    TestCommand command({
+            Argument{ "pos1", 'p', Args::Type::Channel, DefaultDesc, ArgumentType::Positional },
+            Argument{ "std1", 's', Args::Type::Command, DefaultDesc, ArgumentType::Standard },
+            Argument{ "flag1", 'f', Args::Type::Exact, DefaultDesc, ArgumentType::Flag },
+        });
+
+    // The arguments of the command are only built once, and each parse must start from the first positional
+    for (const std::string& value : { "val1"s, "val2"s })
+    {
+        Args args;
+        std::vector<std::string> values{ value, "-f", "--std1", "named" };
+        Invocation inv{ std::vector<std::string>(values) };
+
+        command.ParseArguments(inv, args);
+        command.ValidateArguments(args);
+
+        RequireValueParsedToArg(values[0], command.m_args[0], args);
+        RequireValueParsedToArg(values[3], command.m_args[1], args);
+        REQUIRE(args.Contains(Args::Type::Exact));
+    }
+}
+
+TEST_CASE("Args_AddAndRemove", "[command]")
+{
+    Args args;
+    REQUIRE(!args.Contains(Args::Type::Exact));
+    REQUIRE(args.GetArgs(Args::Type::Exact) == nullptr);
+    REQUIRE(args.GetCount(Args::Type::Query) == 0);
+
+    // A flag is present without any values
+    REQUIRE(args.AddArg(Args::Type::Exact));
+    REQUIRE(args.Contains(Args::Type::Exact));
+    REQUIRE(args.GetArgs(Args::Type::Exact) != nullptr);
+    REQUIRE(args.GetCount(Args::Type::Exact) == 0);
+    REQUIRE(args.GetArg(Args::Type::Exact).empty());
+
+    args.AddArg(Args::Type::Query, "first"sv);
+    args.AddArg(Args::Type::Query, "second"s);
+    REQUIRE(args.GetCount(Args::Type::Query) == 2);
+    REQUIRE(args.GetArg(Args::Type::Query) == "first");
+    REQUIRE(!args.AddArg(Args::Type::Query));
+
+    args.RemoveArg(Args::Type::Query);
+    REQUIRE(!args.Contains(Args::Type::Query));
+    REQUIRE(args.GetCount(Args::Type::Query) == 0);
+    REQUIRE(args.Contains(Args::Type::Exact));
+}
+
+TEST_CASE("Args_CopiesAreIndependent", "[command]")
+{
+    Args original;
+    original.AddArg(Args::Type::Query, "query"sv);
+
+    Args copy = original;
+    REQUIRE(copy.GetArg(Args::Type::Query) == "query");
+
+    // Modifying a copy does not change the args it was copied from
+    copy.RemoveArg(Args::Type::Query);
+    copy.AddArg(Args::Type::Query, "other"sv);
+    copy.AddArg(Args::Type::Exact);
+
+    REQUIRE(original.GetArg(Args::Type::Query) == "query");
+    REQUIRE(original.GetCount(Args::Type::Query) == 1);
+    REQUIRE(!original.Contains(Args::Type::Exact));
+    REQUIRE(copy.GetArg(Args::Type::Query) == "other");
+
+    original.AddArg(Args::Type::Query, "second"sv);
+    REQUIRE(copy.GetCount(Args::Type::Query) == 1);
+}
@@ -8,6 +8,10 @@
 #include <Commands/RootCommand.h>
 #include <Commands/SourceCommand.h>
 #include <CompletionData.h>
+#include <FastCompletion.h>
+#include <AppInstallerFileLogger.h>
+
+#include <chrono>
 
 using namespace std::string_literals;
 using namespace std::string_view_literals;
@@ -104,6 +108,21 @@ TEST_CASE("CompletionData_UTF8_UTF8Word", "[complete]")
     REQUIRE(cd.AfterWord().size() == 1);
 }
 
+TEST_CASE("CompletionData_QuotedArguments", "[complete]")
+{
+    CompletionData cd{ "", R"(winget install "Power Toys" --id a\"b """x""" )", "46" };
+    REQUIRE(cd.Word() == "");
+    REQUIRE(cd.AfterWord().size() == 0);
+
+    std::vector<std::string> args;
+    for (const auto& arg : cd.BeforeWord())
+    {
+        args.emplace_back(arg);
+    }
+
+    REQUIRE(args == std::vector<std::string>{ "install", "Power Toys", "--id", "a\"b", "\"x\"" });
+}
+
 void OutputAllSubCommands(Command& command, std::ostream& out, std::string_view filter = {})
 {
     for (const auto& c : command.GetCommands())
@@ -547,3 +566,78 @@ TEST_CASE("CommandComplete_Complex", "[complete]")
     REQUIRE(ctc.context.Args.Contains(command.Arguments[0].ExecArgType()));
     REQUIRE(ctc.context.Args.GetArg(command.Arguments[0].ExecArgType()) == "value1");
 }
+
+TEST_CASE("FastCompletion_CompletesCommandNames", "[complete]")
+{
+    std::ostringstream out;
+    std::optional<int> result = FastCompletion::TryExecute({ "complete", "--word", "inst", "--commandline", "winget inst", "--position", "11" }, out);
+
+    REQUIRE(result);
+    REQUIRE(result.value() == 0);
+    REQUIRE(out.str().find("install") != std::string::npos);
+}
+
+TEST_CASE("FastCompletion_LeavesOtherCommandsToFullStartup", "[complete]")
+{
+    std::ostringstream out;
+    REQUIRE(!FastCompletion::TryExecute({ "install", "--id", "Some.Id" }, out));
+    REQUIRE(!FastCompletion::TryExecute({ "complete", "--word", "inst" }, out));
+    REQUIRE(out.str().empty());
+}
+
+TEST_CASE("FastCompletion_LeavesSourceSearchToFullStartup", "[complete]")
+{
+    // Completing the query of install searches the sources, which is not done before the full startup
+    std::ostringstream out;
+    REQUIRE(!FastCompletion::TryExecute({ "complete", "--word", "pow", "--commandline", "winget install pow", "--position", "18" }, out));
+    REQUIRE(out.str().empty());
+}
+
+// Not run by default; use "[benchmark]" to run it, and "-benchout <file>" to write the results as JSON lines.
+// Measures what a tab completion costs when it is done before the rest of the startup.
+TEST_CASE("FastCompletion_StartupBenchmark", "[.][benchmark]")
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t iterations = 100;
+    auto start = Clock::now();
+
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        std::ostringstream out;
+        REQUIRE(FastCompletion::TryExecute({ "complete", "--word", "inst", "--commandline", "winget inst", "--position", "11" }, out));
+        REQUIRE(out.str().find("install") != std::string::npos);
+    }
+
+    double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    BenchmarkResults::Record("FastCompletion_Startup", "latency", milliseconds / iterations, "ms");
+}
+
+// Not run by default; use "[benchmark]" to run it, and "-benchout <file>" to write the results as JSON lines.
+// Measures what a tab completion costs from the start of the process, with the default file logger that startup adds.
+TEST_CASE("CompleteCommand_StartupBenchmark", "[.][benchmark]")
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t iterations = 100;
+    auto start = Clock::now();
+
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        Logging::FileLogger logger;
+
+        std::stringstream out, in;
+        Context context{ out, in };
+
+        CompleteCommand command{ "test" };
+        context.Args.AddArg(Args::Type::Word, "inst"sv);
+        context.Args.AddArg(Args::Type::CommandLine, "winget inst"sv);
+        context.Args.AddArg(Args::Type::Position, "11"sv);
+        command.Execute(context);
+
+        REQUIRE(out.str().find("install") != std::string::npos);
+    }
+
+    double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    BenchmarkResults::Record("CompleteCommand_Startup", "latency", milliseconds / iterations, "ms");
+}
@@ -0,0 +1,92 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <Microsoft/CompletionIndex.h>
+#include <winget/ManifestYamlParser.h>
+
+using namespace std::string_literals;
+using namespace TestCommon;
+using namespace AppInstaller::Manifest;
+using namespace AppInstaller::Repository;
+using namespace AppInstaller::Repository::Microsoft;
+
+namespace
+{
+    void CreateTestIndex(const std::filesystem::path& indexFile, const std::filesystem::path& completionIndexFile)
+    {
+        SQLiteIndex index = SQLiteIndex::CreateNew(indexFile.u8string(), Schema::Version::Latest());
+
+        Manifest manifest = YamlParser::CreateFromPath(TestDataFile("Manifest-Good.yaml"));
+        manifest.AppMoniker = "";
+
+        manifest.Id = "Contoso.Editor";
+        manifest.Name = "Contoso Editor";
+        manifest.Tags = { "editor", "Text" };
+        manifest.Commands = { "edit" };
+        index.AddManifest(manifest, "editor.yaml");
+
+        // Another version of the same package must not repeat its values
+        manifest.Version = "2.0.0.0";
+        index.AddManifest(manifest, "editor2.yaml");
+
+        manifest.Id = "Contoso.Compiler";
+        manifest.Name = "contoso compiler";
+        manifest.Version = "1.0.0.0";
+        manifest.Tags = { "text", "compiler" };
+        manifest.Commands = { "cc" };
+        index.AddManifest(manifest, "compiler.yaml");
+
+        manifest.Id = "Fabrikam.Player";
+        manifest.Name = "Player";
+        manifest.Tags = {};
+        manifest.Commands = {};
+        index.AddManifest(manifest, "player.yaml");
+
+        CompletionIndex::Create(completionIndexFile, index);
+    }
+}
+
+TEST_CASE("CompletionIndex_GetCompletions", "[completionindex]")
+{
+    TempFile indexFile{ "completionindex"s, ".db"s };
+    TempFile completionIndexFile{ "completionindex"s, ".bin"s };
+    CreateTestIndex(indexFile, completionIndexFile);
+
+    CompletionIndex completionIndex = CompletionIndex::Open(completionIndexFile);
+
+    REQUIRE(completionIndex.GetCompletions(ApplicationMatchField::Id, "contoso.") == std::vector<std::string>{ "Contoso.Compiler", "Contoso.Editor" });
+    REQUIRE(completionIndex.GetCompletions(ApplicationMatchField::Id, "Contoso.E") == std::vector<std::string>{ "Contoso.Editor" });
+    REQUIRE(completionIndex.GetCompletions(ApplicationMatchField::Id, "Fab").size() == 1);
+    REQUIRE(completionIndex.GetCompletions(ApplicationMatchField::Id, "").size() == 3);
+    REQUIRE(completionIndex.GetCompletions(ApplicationMatchField::Id, "Zzz").empty());
+
+    // Values that differ only by case are all kept, as each came from a different package
+    REQUIRE(completionIndex.GetCompletions(ApplicationMatchField::Name, "CONTOSO") == std::vector<std::string>{ "contoso compiler", "Contoso Editor" });
+    REQUIRE(completionIndex.GetCompletions(ApplicationMatchField::Tag, "te") == std::vector<std::string>{ "Text", "text" });
+
+    // Each field only completes its own values
+    REQUIRE(completionIndex.GetCompletions(ApplicationMatchField::Command, "e") == std::vector<std::string>{ "edit" });
+    REQUIRE(completionIndex.GetCompletions(ApplicationMatchField::Tag, "edit") == std::vector<std::string>{ "editor" });
+    REQUIRE(completionIndex.GetCompletions(ApplicationMatchField::Moniker, "").empty());
+}
+
+TEST_CASE("CompletionIndex_Corrupt", "[completionindex]")
+{
+    TempFile indexFile{ "completionindex"s, ".db"s };
+    TempFile completionIndexFile{ "completionindex"s, ".bin"s };
+    CreateTestIndex(indexFile, completionIndexFile);
+
+    SECTION("Not a completion index")
+    {
+        std::ofstream{ completionIndexFile.GetPath(), std::ios::binary | std::ios::trunc } << "not a completion index";
+        REQUIRE_THROWS_HR(CompletionIndex::Open(completionIndexFile), HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT));
+    }
+    SECTION("Truncated")
+    {
+        std::filesystem::resize_file(completionIndexFile.GetPath(), std::filesystem::file_size(completionIndexFile.GetPath()) - 1);
+
+        CompletionIndex completionIndex = CompletionIndex::Open(completionIndexFile);
+        REQUIRE_THROWS_HR(completionIndex.GetCompletions(ApplicationMatchField::Tag, "text"), HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT));
+    }
+}
@@ -0,0 +1,110 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <Microsoft/DirectoryIndexer.h>
+#include <Microsoft/SQLiteIndex.h>
+
+#include <fstream>
+
+using namespace std::string_literals;
+using namespace TestCommon;
+using namespace AppInstaller::Repository::Microsoft;
+
+namespace
+{
+    std::vector<std::string> GetIndexedIds(SQLiteIndex& index)
+    {
+        std::vector<std::string> result;
+        for (const auto& [manifest, relativePath] : index.GetAllManifests())
+        {
+            result.emplace_back(manifest.Id);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    void RequireResult(const DirectoryIndexer::Result& result, size_t added, size_t updated, size_t removed, size_t failed)
+    {
+        REQUIRE(result.Added == added);
+        REQUIRE(result.Updated == updated);
+        REQUIRE(result.Removed == removed);
+        REQUIRE(result.Failed == failed);
+    }
+}
+
+TEST_CASE("DirectoryIndexer_Synchronize", "[directoryindexer]")
+{
+    TempDirectory directory{ "directoryindexer_root" };
+    TempFile indexFile{ "directoryindexer_index", ".db" };
+    TempFile stateFile{ "directoryindexer_state", ".db" };
+    TestProgress progress;
+
+    std::filesystem::create_directories(directory.GetPath() / "sub");
+    std::filesystem::copy_file(TestDataFile("Manifest-Good.yaml"), directory.GetPath() / "msixsdk.yaml");
+    std::filesystem::copy_file(TestDataFile("InstallFlowTest_Exe.yaml"), directory.GetPath() / "sub" / "testinstaller.yaml");
+
+    SQLiteIndex index = SQLiteIndex::CreateNew(indexFile, AppInstaller::Repository::Microsoft::Schema::Version::Latest());
+
+    // The first scan adds every manifest
+    RequireResult(DirectoryIndexer::Open(stateFile).Synchronize(index, directory, progress), 2, 0, 0, 0);
+    REQUIRE(GetIndexedIds(index) == std::vector<std::string>{ "AppInstallerCliTest.TestInstaller", "microsoft.msixsdk" });
+
+    // Nothing changed, so nothing is parsed
+    auto unchanged = DirectoryIndexer::Open(stateFile).Synchronize(index, directory, progress);
+    RequireResult(unchanged, 0, 0, 0, 0);
+    REQUIRE(!unchanged.IndexModified());
+
+    // A changed file with the same manifest is updated
+    {
+        std::ofstream file{ directory.GetPath() / "msixsdk.yaml", std::ios::app };
+        file << "\n# Changed\n";
+    }
+    RequireResult(DirectoryIndexer::Open(stateFile).Synchronize(index, directory, progress), 0, 1, 0, 0);
+
+    // A removed file has its manifest removed
+    std::filesystem::remove(directory.GetPath() / "sub" / "testinstaller.yaml");
+    RequireResult(DirectoryIndexer::Open(stateFile).Synchronize(index, directory, progress), 0, 0, 1, 0);
+    REQUIRE(GetIndexedIds(index) == std::vector<std::string>{ "microsoft.msixsdk" });
+
+    // A new file is added, and one that cannot be parsed fails without stopping the others
+    std::filesystem::copy_file(TestDataFile("InstallFlowTest_Exe.yaml"), directory.GetPath() / "added.yaml");
+    {
+        std::ofstream file{ directory.GetPath() / "bad.yaml" };
+        file << "Id: [ not a manifest\n";
+    }
+    RequireResult(DirectoryIndexer::Open(stateFile).Synchronize(index, directory, progress), 1, 0, 0, 1);
+    REQUIRE(GetIndexedIds(index) == std::vector<std::string>{ "AppInstallerCliTest.TestInstaller", "microsoft.msixsdk" });
+
+    // The file that failed is tried again
+    RequireResult(DirectoryIndexer::Open(stateFile).Synchronize(index, directory, progress), 0, 0, 0, 1);
+}
+
+TEST_CASE("DirectoryIndexer_ManifestReplaced", "[directoryindexer]")
+{
+    TempDirectory directory{ "directoryindexer_root" };
+    TempFile indexFile{ "directoryindexer_index", ".db" };
+    TempFile stateFile{ "directoryindexer_state", ".db" };
+    TestProgress progress;
+
+    std::filesystem::copy_file(TestDataFile("Manifest-Good.yaml"), directory.GetPath() / "manifest.yaml");
+
+    SQLiteIndex index = SQLiteIndex::CreateNew(indexFile, AppInstaller::Repository::Microsoft::Schema::Version::Latest());
+    RequireResult(DirectoryIndexer::Open(stateFile).Synchronize(index, directory, progress), 1, 0, 0, 0);
+
+    // The file now holds a different manifest, so the old one is removed and the new one added
+    std::filesystem::copy_file(TestDataFile("InstallFlowTest_Exe.yaml"), directory.GetPath() / "manifest.yaml", std::filesystem::copy_options::overwrite_existing);
+    RequireResult(DirectoryIndexer::Open(stateFile).Synchronize(index, directory, progress), 1, 0, 1, 0);
+    REQUIRE(GetIndexedIds(index) == std::vector<std::string>{ "AppInstallerCliTest.TestInstaller" });
+}
+
+TEST_CASE("DirectoryIndexer_MissingDirectory", "[directoryindexer]")
+{
+    TempDirectory directory{ "directoryindexer_missing", false };
+    TempFile indexFile{ "directoryindexer_index", ".db" };
+    TempFile stateFile{ "directoryindexer_state", ".db" };
+    TestProgress progress;
+
+    SQLiteIndex index = SQLiteIndex::CreateNew(indexFile, AppInstaller::Repository::Microsoft::Schema::Version::Latest());
+    REQUIRE_THROWS_HR(DirectoryIndexer::Open(stateFile).Synchronize(index, directory, progress), HRESULT_FROM_WIN32(ERROR_PATH_NOT_FOUND));
+}
@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include "DownloadScheduler.h"
+
+using namespace AppInstaller;
+using namespace AppInstaller::Utility;
+using namespace std::chrono_literals;
+
+TEST_CASE("DownloadScheduler_Unlimited", "[DownloadScheduler]")
+{
+    DownloadScheduler scheduler{ 0, 0 };
+    auto now = DownloadScheduler::clock::now();
+
+    REQUIRE(scheduler.Reserve(1024 * 1024 * 1024, DownloadPriority::Foreground, now) == 0us);
+    REQUIRE(scheduler.Reserve(1024 * 1024 * 1024, DownloadPriority::Background, now) == 0us);
+}
+
+TEST_CASE("DownloadScheduler_TokenBucket", "[DownloadScheduler]")
+{
+    DownloadScheduler scheduler{ 1000, 0 };
+    auto now = DownloadScheduler::clock::now();
+
+    // The bucket starts with one second of data
+    REQUIRE(scheduler.Reserve(1000, DownloadPriority::Foreground, now) == 0us);
+
+    // Beyond it, the download waits for the bucket to refill
+    REQUIRE(scheduler.Reserve(500, DownloadPriority::Foreground, now) == 500ms);
+    REQUIRE(scheduler.Reserve(500, DownloadPriority::Foreground, now + 500ms) == 500ms);
+
+    // The bucket holds at most one second of data, however long it is idle
+    now += 1h;
+    REQUIRE(scheduler.Reserve(1000, DownloadPriority::Foreground, now) == 0us);
+    REQUIRE(scheduler.Reserve(100, DownloadPriority::Foreground, now) == 100ms);
+}
+
+TEST_CASE("DownloadScheduler_BackgroundYieldsToForeground", "[DownloadScheduler]")
+{
+    DownloadScheduler scheduler{ 0, 100 };
+    auto now = DownloadScheduler::clock::now();
+
+    // Without a foreground download, a background one is not limited
+    REQUIRE(scheduler.Reserve(1000, DownloadPriority::Background, now) == 0us);
+
+    {
+        auto foreground = scheduler.Begin(DownloadPriority::Foreground);
+
+        REQUIRE(scheduler.Reserve(100, DownloadPriority::Background, now) == 0us);
+        REQUIRE(scheduler.Reserve(100, DownloadPriority::Background, now) == 1s);
+        REQUIRE(scheduler.Reserve(1000, DownloadPriority::Foreground, now) == 0us);
+    }
+
+    REQUIRE(scheduler.Reserve(1000, DownloadPriority::Background, now) == 0us);
+}
+
+TEST_CASE("DownloadScheduler_ConsumeStopsWhenCancelled", "[DownloadScheduler]")
+{
+    DownloadScheduler scheduler{ 1, 0 };
+    auto download = scheduler.Begin(DownloadPriority::Foreground);
+
+    ProgressCallback progress;
+    progress.Cancel();
+
+    // Without the cancellation, this would wait for over an hour
+    auto start = DownloadScheduler::clock::now();
+    download.Consume(4000, progress);
+    REQUIRE(DownloadScheduler::clock::now() - start < 1min);
+}
@@ -2,6 +2,8 @@
 // Licensed under the MIT License.
 #include "pch.h"
 #include "TestCommon.h"
+#include "TestHooks.h"
+#include "TestHttpServer.h"
 #include "AppInstallerDownloader.h"
 #include "AppInstallerSHA256.h"
 
@@ -16,7 +18,7 @@ TEST_CASE("DownloadValidFileAndVerifyHash", "[Downloader]")
 
     // Todo: point to files from our repo when the repo goes public
     ProgressCallback callback;
-    auto result = Download("https://raw.githubusercontent.com/microsoft/msix-packaging/master/LICENSE", tempFile.GetPath(), callback, true);
+    auto result = Download("https://raw.githubusercontent.com/microsoft/msix-packaging/master/LICENSE", tempFile.GetPath(), DownloadType::Installer, callback, true);
 
     REQUIRE(result.has_value());
     auto resultHash = result.value();
@@ -49,7 +51,7 @@ TEST_CASE("DownloadValidFileAndCancel", "[Downloader]")
     std::optional<std::vector<BYTE>> waitResult;
     std::thread waitThread([&]
         {
-            waitResult = Download("https://aka.ms/win32-x64-user-stable", tempFile.GetPath(), callback, true);
+            waitResult = Download("https://aka.ms/win32-x64-user-stable", tempFile.GetPath(), DownloadType::Installer, callback, true);
         });
 
     callback.Cancel();
@@ -59,6 +61,251 @@ TEST_CASE("DownloadValidFileAndCancel", "[Downloader]")
     REQUIRE(!waitResult.has_value());
 }
 
+// Downloads a large file twice, so it is not run by default; use "[DownloaderLarge]" to run it.
+TEST_CASE("DownloadInSegmentsMatchesSingleStream", "[.][DownloaderLarge]")
+{
+    TestCommon::TempFile tempFile("downloader_test"s, ".test"s);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    // Large enough to be downloaded in segments, from a server that supports range requests
+    std::string url = "https://aka.ms/win32-x64-user-stable";
+
+    ProgressCallback callback;
+    auto segmentedHash = Download(url, tempFile.GetPath(), DownloadType::Installer, callback, true);
+    REQUIRE(segmentedHash.has_value());
+
+    std::ostringstream singleStream;
+    auto singleStreamHash = DownloadToStream(url, singleStream, DownloadType::Installer, callback, true);
+    REQUIRE(singleStreamHash.has_value());
+
+    REQUIRE(segmentedHash.value() == singleStreamHash.value());
+    REQUIRE(std::filesystem::file_size(tempFile.GetPath()) == singleStream.str().size());
+}
+
+namespace
+{
+    // Cancels the download once it has made some progress.
+    struct CancelAfterProgressSink : public IProgressSink
+    {
+        CancelAfterProgressSink(uint64_t cancelAfter) : m_cancelAfter(cancelAfter) {}
+
+        void OnProgress(uint64_t current, uint64_t, ProgressType) override
+        {
+            if (current >= m_cancelAfter)
+            {
+                Callback.Cancel();
+            }
+        }
+
+        ProgressCallback Callback{ this };
+
+    private:
+        uint64_t m_cancelAfter;
+    };
+}
+
+// Downloads a large file twice, so it is not run by default; use "[DownloaderLarge]" to run it.
+TEST_CASE("DownloadResumesAfterCancel", "[.][DownloaderLarge]")
+{
+    TestCommon::TempFile tempFile("downloader_test"s, ".test"s);
+    std::filesystem::path statePath = tempFile.GetPath();
+    statePath += ".partial";
+    TestCommon::TempFile stateFile(statePath);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    std::string url = "https://aka.ms/win32-x64-user-stable";
+
+    CancelAfterProgressSink cancelSink(16 * 1024 * 1024);
+    REQUIRE(!Download(url, tempFile.GetPath(), DownloadType::Installer, cancelSink.Callback, true).has_value());
+
+    // The state of the cancelled download is kept beside the file
+    REQUIRE(std::filesystem::exists(stateFile.GetPath()));
+
+    ProgressCallback callback;
+    auto resumedHash = Download(url, tempFile.GetPath(), DownloadType::Installer, callback, true);
+    REQUIRE(resumedHash.has_value());
+    REQUIRE(!std::filesystem::exists(stateFile.GetPath()));
+
+    std::ostringstream singleStream;
+    auto singleStreamHash = DownloadToStream(url, singleStream, DownloadType::Installer, callback, true);
+    REQUIRE(singleStreamHash.has_value());
+
+    REQUIRE(resumedHash.value() == singleStreamHash.value());
+}
+
+TEST_CASE("DownloadLocalFileCopiesAndHashes", "[Downloader]")
+{
+    TestCommon::TempFile sourceFile("downloader_source"s, ".test"s);
+    TestCommon::TempFile tempFile("downloader_test"s, ".test"s);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    std::string content = "local installer content";
+    {
+        std::ofstream sourceStream{ sourceFile.GetPath(), std::ios::binary };
+        sourceStream << content;
+    }
+
+    ProgressCallback callback;
+    auto result = Download(sourceFile.GetPath().u8string(), tempFile.GetPath(), DownloadType::Installer, callback, true);
+
+    REQUIRE(result.has_value());
+    REQUIRE(result.value() == SHA256::ComputeHash(reinterpret_cast<const uint8_t*>(content.data()), static_cast<uint32_t>(content.size())));
+    REQUIRE(std::filesystem::file_size(tempFile.GetPath()) == content.size());
+}
+
+TEST_CASE("DownloadFromTestServerResumesAfterDroppedConnection", "[Downloader]")
+{
+    TestCommon::TempFile tempFile("downloader_test"s, ".test"s);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    std::string content(4 * 1024 * 1024, '\0');
+    for (size_t i = 0; i < content.size(); ++i)
+    {
+        content[i] = static_cast<char>(i * 31 + i / 4096);
+    }
+
+    // Segment the download, and drop one of the segments half way through; the probe is the first request
+    TestHook_SetSegmentedDownloadMinimumSize(1024 * 1024);
+    auto resetHook = wil::scope_exit([]() { TestHook_SetSegmentedDownloadMinimumSize(0); });
+
+    TestCommon::TestHttpServer server{ content };
+    server.InjectFailure({ 2, 0, content.size() / 8 });
+
+    ProgressCallback callback;
+    REQUIRE_THROWS(Download(server.GetUrl(), tempFile.GetPath(), DownloadType::Installer, callback, true));
+    size_t requestsBeforeResume = server.GetRequestCount();
+
+    auto result = Download(server.GetUrl(), tempFile.GetPath(), DownloadType::Installer, callback, true);
+
+    REQUIRE(result.has_value());
+    REQUIRE(result.value() == SHA256::ComputeHash(reinterpret_cast<const uint8_t*>(content.data()), static_cast<uint32_t>(content.size())));
+    REQUIRE(std::filesystem::file_size(tempFile.GetPath()) == content.size());
+
+    // Only the dropped segment is requested again, after the probe
+    REQUIRE(server.GetRequestCount() - requestsBeforeResume == 2);
+    REQUIRE(server.GetContentBytesSent() < content.size() + content.size() / 4);
+}
+
+TEST_CASE("DownloadFromTestServerKeepsHashedChunksAfterDroppedConnection", "[Downloader]")
+{
+    TestCommon::TempFile tempFile("downloader_test"s, ".test"s);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    std::string content(4 * 1024 * 1024 + 1000, '\0');
+    for (size_t i = 0; i < content.size(); ++i)
+    {
+        content[i] = static_cast<char>(i * 31 + i / 4096);
+    }
+
+    constexpr uint64_t chunkSize = 256 * 1024;
+
+    ChunkedSHA256 expected{ chunkSize };
+    expected.Add(reinterpret_cast<const uint8_t*>(content.data()), content.size());
+    auto expectedHash = expected.Get();
+
+    // Segment the download, and drop one of the segments part way into a chunk; the probe is the first request
+    TestHook_SetSegmentedDownloadMinimumSize(1024 * 1024);
+    auto resetHook = wil::scope_exit([]() { TestHook_SetSegmentedDownloadMinimumSize(0); });
+
+    TestCommon::TestHttpServer server{ content };
+    server.InjectFailure({ 2, 0, chunkSize + chunkSize / 2 });
+
+    ProgressCallback callback;
+    REQUIRE_THROWS(Download(server.GetUrl(), tempFile.GetPath(), DownloadType::Installer, callback, true, chunkSize));
+
+    auto result = Download(server.GetUrl(), tempFile.GetPath(), DownloadType::Installer, callback, true, chunkSize);
+
+    REQUIRE(result.has_value());
+    REQUIRE(result.value() == expectedHash);
+    REQUIRE(std::filesystem::file_size(tempFile.GetPath()) == content.size());
+
+    // The chunk that was partly written is downloaded again, but the one before it is kept
+    REQUIRE(server.GetContentBytesSent() < content.size() + 2 * chunkSize);
+
+    // A copy is hashed in chunks from the file
+    TestCommon::TempFile copyFile("downloader_test"s, ".test"s);
+    REQUIRE(Download(tempFile.GetPath().u8string(), copyFile.GetPath(), DownloadType::Installer, callback, true, chunkSize).value() == expectedHash);
+}
+
+TEST_CASE("DownloadFromMirrorsUsesTheFirstToRespond", "[Downloader]")
+{
+    TestCommon::TempFile tempFile("downloader_test"s, ".test"s);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    std::string content(256 * 1024, 'm');
+
+    TestHook_SetMirrorTimeouts(std::chrono::milliseconds{ 50 }, std::chrono::milliseconds{ 0 });
+    auto resetHook = wil::scope_exit([]() { TestHook_SetMirrorTimeouts(std::chrono::milliseconds{ 0 }, std::chrono::milliseconds{ 0 }); });
+
+    TestCommon::TestHttpServer::Options slowOptions;
+    slowOptions.Latency = std::chrono::milliseconds{ 2000 };
+    TestCommon::TestHttpServer slow{ content, slowOptions };
+    TestCommon::TestHttpServer fast{ content };
+
+    ProgressCallback callback;
+    auto start = std::chrono::steady_clock::now();
+    auto result = Download(std::vector<std::string>{ slow.GetUrl(), fast.GetUrl() }, tempFile.GetPath(), DownloadType::Installer, callback, true);
+
+    REQUIRE(result.has_value());
+    REQUIRE(result.value() == SHA256::ComputeHash(reinterpret_cast<const uint8_t*>(content.data()), static_cast<uint32_t>(content.size())));
+
+    // The slow server was still waiting to respond when the whole content came from the fast one
+    REQUIRE(fast.GetContentBytesSent() >= content.size());
+    REQUIRE(std::chrono::steady_clock::now() - start < slowOptions.Latency);
+}
+
+TEST_CASE("DownloadFromMirrorsFailsOverMidStream", "[Downloader]")
+{
+    TestCommon::TempFile tempFile("downloader_test"s, ".test"s);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    std::string content(512 * 1024, '\0');
+    for (size_t i = 0; i < content.size(); ++i)
+    {
+        content[i] = static_cast<char>(i * 31 + i / 4096);
+    }
+
+    TestHook_SetMirrorTimeouts(std::chrono::milliseconds{ 50 }, std::chrono::milliseconds{ 0 });
+    auto resetHook = wil::scope_exit([]() { TestHook_SetMirrorTimeouts(std::chrono::milliseconds{ 0 }, std::chrono::milliseconds{ 0 }); });
+
+    // The first server answers the probe, which is its first request, then drops the download part way
+    TestCommon::TestHttpServer first{ content };
+    first.InjectFailure({ 1, 0, content.size() / 4 });
+
+    TestCommon::TestHttpServer::Options secondOptions;
+    secondOptions.Latency = std::chrono::milliseconds{ 200 };
+    TestCommon::TestHttpServer second{ content, secondOptions };
+
+    ProgressCallback callback;
+    auto result = Download(std::vector<std::string>{ first.GetUrl(), second.GetUrl() }, tempFile.GetPath(), DownloadType::Installer, callback, true);
+
+    REQUIRE(result.has_value());
+    REQUIRE(result.value() == SHA256::ComputeHash(reinterpret_cast<const uint8_t*>(content.data()), static_cast<uint32_t>(content.size())));
+    REQUIRE(std::filesystem::file_size(tempFile.GetPath()) == content.size());
+
+    // Only the content after the drop was requested from the second server
+    REQUIRE(second.GetRangeRequestCount() >= 1);
+    REQUIRE(second.GetContentBytesSent() <= content.size() - content.size() / 4 + 1);
+}
+
+TEST_CASE("DownloadFromMirrorsReportsThePrimaryError", "[Downloader]")
+{
+    TestCommon::TempFile tempFile("downloader_test"s, ".test"s);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    // Both the range probe and the single stream that follows it fail on each server
+    TestCommon::TestHttpServer first{ "content"s };
+    first.InjectFailure({ 0, 404 });
+    first.InjectFailure({ 1, 404 });
+    TestCommon::TestHttpServer second{ "content"s };
+    second.InjectFailure({ 0, 500 });
+    second.InjectFailure({ 1, 500 });
+
+    ProgressCallback callback;
+    REQUIRE_THROWS_HR(Download(std::vector<std::string>{ first.GetUrl(), second.GetUrl() }, tempFile.GetPath(), DownloadType::Installer, callback, true),
+        MAKE_HRESULT(SEVERITY_ERROR, FACILITY_HTTP, 404));
+}
+
 TEST_CASE("DownloadInvalidUrl", "[Downloader]")
 {
     TestCommon::TempFile tempFile("downloader_test"s, ".test"s);
@@ -66,5 +313,5 @@ TEST_CASE("DownloadInvalidUrl", "[Downloader]")
 
     ProgressCallback callback;
 
-    REQUIRE_THROWS_HR(Download("blargle-flargle-fluff", tempFile.GetPath(), callback, true), WININET_E_UNRECOGNIZED_SCHEME);
+    REQUIRE_THROWS_HR(Download("blargle-flargle-fluff", tempFile.GetPath(), DownloadType::Installer, callback, true), WININET_E_UNRECOGNIZED_SCHEME);
 }
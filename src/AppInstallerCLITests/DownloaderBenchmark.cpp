@@ -0,0 +1,184 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include "TestHooks.h"
+#include "TestHttpServer.h"
+#include <AppInstallerDownloader.h>
+#include <AppInstallerMsixInfo.h>
+#include <AppInstallerSHA256.h>
+
+#include <chrono>
+#include <random>
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+using namespace TestCommon;
+using namespace AppInstaller;
+using namespace AppInstaller::Utility;
+
+// These benchmarks are not run by default; use "[benchmark]" to run them, and "-benchout <file>" to write the results as JSON lines.
+// They download from a TestHttpServer on the loopback interface, which emulates the latency and bandwidth of a remote server,
+// so that the results only change with the code. Round trips and bytes sent are deterministic, and are held to the baseline.
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t s_DownloadSize = 16 * 1024 * 1024;
+
+    // Downloads are segmented from this size, so that the content does not have to be as large as a real installer to be segmented.
+    constexpr int64_t s_SegmentedDownloadMinimumSize = 4 * 1024 * 1024;
+
+    // A connection to a server that is far away, and not very fast.
+    constexpr std::chrono::milliseconds s_Latency{ 50 };
+    constexpr size_t s_BytesPerSecond = 8 * 1024 * 1024;
+
+    // The number of small downloads, each paying the latency of its round trips.
+    constexpr size_t s_SmallDownloadCount = 20;
+    constexpr size_t s_SmallDownloadSize = 64 * 1024;
+
+    // Throughput on the loopback interface is still noisy, while requests and bytes sent only change with the code.
+    constexpr double s_ThroughputTolerance = 0.2;
+    constexpr double s_DeterministicTolerance = 0;
+
+    // Content that does not compress, the same for every run.
+    std::string GenerateContent(size_t size)
+    {
+        std::mt19937 engine{ 42 };
+        std::string result(size, '\0');
+        for (char& c : result)
+        {
+            c = static_cast<char>(engine());
+        }
+        return result;
+    }
+
+    std::vector<uint8_t> HashContent(const std::string& content)
+    {
+        return SHA256::ComputeHash(reinterpret_cast<const uint8_t*>(content.data()), static_cast<std::uint32_t>(content.size()));
+    }
+
+    // Overrides the size downloads are segmented from, for the lifetime of the object.
+    struct SegmentedDownloadMinimumSizeOverride
+    {
+        SegmentedDownloadMinimumSizeOverride(int64_t size) { TestHook_SetSegmentedDownloadMinimumSize(size); }
+        ~SegmentedDownloadMinimumSizeOverride() { TestHook_SetSegmentedDownloadMinimumSize(0); }
+    };
+
+    void RecordServerMetrics(std::string_view benchmark, const TestHttpServer& server, size_t contentBytes)
+    {
+        BenchmarkResults::RecordWithThreshold(benchmark, "round_trips", static_cast<double>(server.GetRequestCount()), "requests", BenchmarkResults::Better::Lower, s_DeterministicTolerance);
+        BenchmarkResults::Record(benchmark, "connections", static_cast<double>(server.GetConnectionCount()), "connections");
+        BenchmarkResults::RecordWithThreshold(benchmark, "bytes_sent", static_cast<double>(server.GetContentBytesSent()) / contentBytes, "x content", BenchmarkResults::Better::Lower, s_DeterministicTolerance);
+    }
+
+    void RecordThroughput(std::string_view benchmark, size_t bytes, Clock::duration elapsed)
+    {
+        double megabytes = static_cast<double>(bytes) / (1024 * 1024);
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        BenchmarkResults::RecordWithThreshold(benchmark, "throughput", megabytes / seconds, "MB/s", BenchmarkResults::Better::Higher, s_ThroughputTolerance);
+    }
+
+    // Downloads the content of the server to a file, checking that the file is the content.
+    void DownloadAndRecord(std::string_view benchmark, TestHttpServer& server)
+    {
+        TempFile tempFile{ "downloader_benchmark"s, ".bin"s };
+        ProgressCallback callback;
+
+        auto start = Clock::now();
+        auto hash = Download(server.GetUrl(), tempFile, DownloadType::Installer, callback, true);
+        auto elapsed = Clock::now() - start;
+
+        REQUIRE(hash.has_value());
+        REQUIRE(hash.value() == HashContent(server.GetContent()));
+        REQUIRE(std::filesystem::file_size(tempFile.GetPath()) == server.GetContent().size());
+
+        RecordThroughput(benchmark, server.GetContent().size(), elapsed);
+        RecordServerMetrics(benchmark, server, server.GetContent().size());
+    }
+}
+
+TEST_CASE("Downloader_Benchmark_Segmented", "[.][benchmark]")
+{
+    SegmentedDownloadMinimumSizeOverride segmentOverride{ s_SegmentedDownloadMinimumSize };
+    TestHttpServer server{ GenerateContent(s_DownloadSize), { s_Latency, s_BytesPerSecond } };
+
+    DownloadAndRecord("downloader.segmented", server);
+}
+
+TEST_CASE("Downloader_Benchmark_SingleStream", "[.][benchmark]")
+{
+    TestHttpServer::Options options{ s_Latency, s_BytesPerSecond };
+    options.SupportsRanges = false;
+    TestHttpServer server{ GenerateContent(s_DownloadSize), options };
+
+    DownloadAndRecord("downloader.single_stream", server);
+}
+
+TEST_CASE("Downloader_Benchmark_Resume", "[.][benchmark]")
+{
+    SegmentedDownloadMinimumSizeOverride segmentOverride{ s_SegmentedDownloadMinimumSize };
+    TestHttpServer server{ GenerateContent(s_DownloadSize), { s_Latency, s_BytesPerSecond } };
+
+    // The probe is the first request, so this drops one of the segments half way through
+    constexpr size_t s_SegmentSize = s_DownloadSize / 4;
+    server.InjectFailure({ 2, 0, s_SegmentSize / 2 });
+
+    TempFile tempFile{ "downloader_benchmark"s, ".bin"s };
+    ProgressCallback callback;
+
+    auto start = Clock::now();
+    REQUIRE_THROWS(Download(server.GetUrl(), tempFile, DownloadType::Installer, callback, true));
+
+    // The second attempt only downloads what the first did not
+    auto hash = Download(server.GetUrl(), tempFile, DownloadType::Installer, callback, true);
+    auto elapsed = Clock::now() - start;
+
+    REQUIRE(hash.has_value());
+    REQUIRE(hash.value() == HashContent(server.GetContent()));
+
+    RecordThroughput("downloader.resume", server.GetContent().size(), elapsed);
+    RecordServerMetrics("downloader.resume", server, server.GetContent().size());
+}
+
+TEST_CASE("Downloader_Benchmark_SmallDownloadsToStream", "[.][benchmark]")
+{
+    TestHttpServer server{ GenerateContent(s_SmallDownloadSize), { s_Latency, s_BytesPerSecond } };
+    ProgressCallback callback;
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < s_SmallDownloadCount; ++i)
+    {
+        std::ostringstream stream;
+        auto hash = DownloadToStream(server.GetUrl("manifest.yaml"), stream, DownloadType::Manifest, callback, true);
+        REQUIRE(hash.has_value());
+        REQUIRE(stream.str() == server.GetContent());
+    }
+    auto elapsed = Clock::now() - start;
+
+    // Many small downloads are bound by their round trips rather than the bandwidth
+    double milliseconds = std::chrono::duration<double, std::milli>(elapsed).count() / s_SmallDownloadCount;
+    BenchmarkResults::RecordWithThreshold("downloader.small_to_stream", "latency", milliseconds, "ms/download", BenchmarkResults::Better::Lower, s_ThroughputTolerance);
+    RecordServerMetrics("downloader.small_to_stream", server, server.GetContent().size() * s_SmallDownloadCount);
+}
+
+TEST_CASE("MsixInfo_Benchmark_RemoteOpen", "[.][benchmark]")
+{
+    std::ifstream file{ TestDataFile{ "index.1.0.0.0.msix" }.GetPath(), std::ios::binary };
+    std::ostringstream content;
+    content << file.rdbuf();
+
+    TestHttpServer::Options options{ s_Latency, s_BytesPerSecond };
+    options.ContentType = "application/msix";
+    TestHttpServer server{ content.str(), options };
+
+    auto start = Clock::now();
+    Msix::MsixInfo msix(server.GetUrl("index.msix"));
+    std::string fullName = msix.GetPackageFullName();
+    auto elapsed = Clock::now() - start;
+
+    REQUIRE(fullName == "AppInstallerCLITestsFakeIndex_1.0.0.0_neutral__125rzkzqaqjwj");
+
+    BenchmarkResults::RecordWithThreshold("msixinfo.remote_open", "latency", std::chrono::duration<double, std::milli>(elapsed).count(), "ms", BenchmarkResults::Better::Lower, s_ThroughputTolerance);
+    RecordServerMetrics("msixinfo.remote_open", server, server.GetContent().size());
+}
@@ -15,4 +15,15 @@ TEST_CASE("ExperimentalFeature None", "[experimentalFeature]")
 
     // Make sure to throw requesting Feature::None
     REQUIRE_THROWS_HR(ExperimentalFeature::GetFeature(ExperimentalFeature::Feature::None), E_UNEXPECTED);
-}
\ No newline at end of file
+}
+TEST_CASE("ExperimentalFeature Invalid", "[experimentalFeature]")
+{
+    REQUIRE_THROWS_HR(ExperimentalFeature::IsEnabled(ExperimentalFeature::Feature::Max), E_UNEXPECTED);
+    REQUIRE_THROWS_HR(ExperimentalFeature::IsEnabled(ExperimentalFeature::Feature::ExperimentalCmd | ExperimentalFeature::Feature::ExperimentalArg), E_UNEXPECTED);
+
+    // Every feature can be looked up
+    for (const auto& feature : ExperimentalFeature::GetAllFeatures())
+    {
+        REQUIRE_NOTHROW(ExperimentalFeature::IsEnabled(feature.GetFeature()));
+    }
+}
@@ -0,0 +1,139 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <AppInstallerFileLogger.h>
+
+using namespace std::string_literals;
+using namespace TestCommon;
+using namespace AppInstaller::Logging;
+
+namespace
+{
+    std::vector<std::string> ReadLines(const std::filesystem::path& path)
+    {
+        std::ifstream stream{ path };
+        std::vector<std::string> result;
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            result.emplace_back(std::move(line));
+        }
+        return result;
+    }
+}
+
+TEST_CASE("FileLogger_FileCreatedByFirstLine", "[filelogger]")
+{
+    TempFile tempFile{ "filelogger"s, ".log"s };
+
+    {
+        FileLogger logger{ tempFile.GetPath() };
+    }
+
+    REQUIRE(!std::filesystem::exists(tempFile.GetPath()));
+
+    {
+        FileLogger logger{ tempFile.GetPath() };
+        logger.Write(Channel::Test, Level::Info, "line");
+    }
+
+    REQUIRE(ReadLines(tempFile.GetPath()).size() == 1);
+}
+
+TEST_CASE("FileLogger_WritesOnFlush", "[filelogger]")
+{
+    TempFile tempFile{ "filelogger"s, ".log"s };
+    FileLogger logger{ tempFile.GetPath() };
+
+    logger.Write(Channel::Test, Level::Info, "first line");
+    logger.Flush();
+
+    auto lines = ReadLines(tempFile.GetPath());
+    REQUIRE(lines.size() == 1);
+    REQUIRE(lines[0].find("[TEST] first line") != std::string::npos);
+
+    // A critical line is written before Write returns
+    logger.Write(Channel::Core, Level::Crit, "critical line");
+
+    lines = ReadLines(tempFile.GetPath());
+    REQUIRE(lines.size() == 2);
+    REQUIRE(lines[1].find("[CORE] critical line") != std::string::npos);
+}
+
+TEST_CASE("FileLogger_ConcurrentWritersFillingTheRing", "[filelogger]")
+{
+    TempFile tempFile{ "filelogger"s, ".log"s };
+
+    constexpr size_t threadCount = 4;
+    constexpr size_t linesPerThread = FileLogger::RingSize * 2;
+
+    {
+        FileLogger logger{ tempFile.GetPath() };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            threads.emplace_back([&logger, i]()
+                {
+                    for (size_t j = 0; j < linesPerThread; ++j)
+                    {
+                        logger.Write(Channel::Test, Level::Verbose, "thread " + std::to_string(i) + " line " + std::to_string(j));
+                    }
+                });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    // Every line is written once the logger is destroyed, and the lines of each thread are in order
+    auto lines = ReadLines(tempFile.GetPath());
+    REQUIRE(lines.size() == threadCount * linesPerThread);
+
+    std::vector<size_t> nextLine(threadCount, 0);
+    for (const auto& line : lines)
+    {
+        size_t threadStart = line.find("thread ");
+        REQUIRE(threadStart != std::string::npos);
+
+        size_t thread = 0;
+        size_t lineNumber = 0;
+        REQUIRE(sscanf_s(line.c_str() + threadStart, "thread %zu line %zu", &thread, &lineNumber) == 2);
+        REQUIRE(thread < threadCount);
+        REQUIRE(lineNumber == nextLine[thread]);
+        ++nextLine[thread];
+    }
+}
+
+TEST_CASE("FileLogger_CleanupRemovesOldLogs", "[filelogger]")
+{
+    TempDirectory tempDirectory{ "filelogger_cleanup"s };
+    const auto& directory = tempDirectory.GetPath();
+
+    auto createFile = [&](const std::string& name, std::chrono::hours age)
+    {
+        std::filesystem::path path = directory / name;
+        std::ofstream{ path } << "log";
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() - age);
+        return path;
+    };
+
+    auto oldLog = createFile("WinGet-old.log", std::chrono::hours{ 10 * 24 });
+    auto newLog = createFile("WinGet-new.log", std::chrono::hours{ 1 });
+    auto otherFile = createFile("Other-old.log", std::chrono::hours{ 10 * 24 });
+
+    REQUIRE(FileLogger::Cleanup(directory));
+
+    REQUIRE(!std::filesystem::exists(oldLog));
+    REQUIRE(std::filesystem::exists(newLog));
+    REQUIRE(std::filesystem::exists(otherFile));
+
+    // A pass completed within the last day, so the next one is skipped
+    auto laterLog = createFile("WinGet-later.log", std::chrono::hours{ 10 * 24 });
+
+    REQUIRE(!FileLogger::Cleanup(directory));
+    REQUIRE(std::filesystem::exists(laterLog));
+}
@@ -3,6 +3,7 @@
 #include "pch.h"
 #include "TestCommon.h"
 #include "Commands/HashCommand.h"
+#include <AppInstallerSHA256.h>
 
 using namespace std::string_literals;
 using namespace TestCommon;
@@ -20,4 +21,21 @@ TEST_CASE("HashCommandWithTestMsix", "[Sha256Hash]")
 
     REQUIRE(hashOutput.str().find("Sha256: 6a2d3683fa19bf00e58e07d1313d20a5f5735ebbd6a999d33381d28740ee07ea") != std::string::npos);
     REQUIRE(hashOutput.str().find("SignatureSha256: 138781c3e6f635240353f3d14d1d57bdcb89413e49be63b375e6a5d7b93b0d07") != std::string::npos);
-}
\ No newline at end of file
+}
+TEST_CASE("HashCommandWithChunkSize", "[Sha256Hash]")
+{
+    TestDataFile testFile("TestSignedApp.msix");
+    auto expected = AppInstaller::Utility::ChunkedSHA256::ComputeHashFromFile(testFile.GetPath(), 65536);
+
+    std::ostringstream hashOutput;
+    Execution::Context context{ hashOutput, std::cin };
+    context.Args.AddArg(Execution::Args::Type::HashFile, testFile.GetPath().u8string());
+    context.Args.AddArg(Execution::Args::Type::ChunkSize, "65536"s);
+    HashCommand hashCommand({});
+
+    hashCommand.Execute(context);
+
+    REQUIRE(hashOutput.str().find("Sha256: 6a2d3683fa19bf00e58e07d1313d20a5f5735ebbd6a999d33381d28740ee07ea") != std::string::npos);
+    REQUIRE(hashOutput.str().find("ChunkedSha256: " + AppInstaller::Utility::SHA256::ConvertToString(expected)) != std::string::npos);
+    REQUIRE(hashOutput.str().find("ChunkSize: 65536") != std::string::npos);
+}
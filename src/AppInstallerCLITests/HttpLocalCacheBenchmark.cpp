@@ -0,0 +1,364 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include "TestHttpServer.h"
+#include <AppInstallerMsixInfo.h>
+#include <winget/HttpAccessTrace.h>
+
+#include <list>
+#include <map>
+#include <unordered_map>
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+using namespace TestCommon;
+using namespace AppInstaller;
+using namespace AppInstaller::Utility::HttpStream;
+
+// The benchmarks are not run by default; use "[benchmark]" to run them, and "-benchout <file>" to write the results as JSON lines.
+// They record the reads that the operations of MsixInfo make on a package served by a TestHttpServer, then replay the reads
+// against other policies for the HttpLocalCache, so that a change to the page size, capacity, read-ahead or eviction of the
+// cache can be measured against real packages before it is made.
+namespace
+{
+    // A connection to a server that is far away, and not very fast; the same as in the downloader benchmarks.
+    constexpr std::chrono::milliseconds s_Latency{ 50 };
+    constexpr size_t s_BytesPerSecond = 8 * 1024 * 1024;
+
+    // The simulation only changes with the trace and the policy.
+    constexpr double s_DeterministicTolerance = 0;
+
+    constexpr std::string_view s_SignedPackage = "TestSignedApp.msix"sv;
+
+    // The order in which a simulated cache evicts its pages.
+    enum class EvictionOrder
+    {
+        LeastRecentlyUsed,
+        FirstInFirstOut,
+    };
+
+    // The policy of a simulated cache over a range stream.
+    struct CachePolicy
+    {
+        std::string_view Name;
+        uint32_t PageSize = 0;
+        uint32_t MaxPages = 0;
+        // The read-ahead doubles up to this many pages while the reads of a stream are sequential; 0 disables it.
+        uint32_t MaxReadAheadPages = 0;
+        EvictionOrder Eviction = EvictionOrder::LeastRecentlyUsed;
+        // The size of the end of the data that is downloaded when the stream is created.
+        uint32_t TailSize = 0;
+    };
+
+    // The policy of HttpLocalCache and HttpClientWrapper as they are.
+    constexpr CachePolicy s_CurrentPolicy{ "current"sv, 2 << 16, 200, 16, EvictionOrder::LeastRecentlyUsed, 2 << 16 };
+
+    constexpr CachePolicy s_Policies[] =
+    {
+        s_CurrentPolicy,
+        { "small_pages"sv, 2 << 13, 1600, 128, EvictionOrder::LeastRecentlyUsed, 2 << 16 },
+        { "small_tail"sv, 2 << 16, 200, 16, EvictionOrder::LeastRecentlyUsed, 2 << 13 },
+        { "no_read_ahead"sv, 2 << 16, 200, 0, EvictionOrder::LeastRecentlyUsed, 2 << 16 },
+        { "few_pages_lru"sv, 2 << 13, 4, 16, EvictionOrder::LeastRecentlyUsed, 2 << 13 },
+        { "few_pages_fifo"sv, 2 << 13, 4, 16, EvictionOrder::FirstInFirstOut, 2 << 13 },
+    };
+
+    struct SimulationResult
+    {
+        size_t Reads = 0;
+        size_t Hits = 0;
+        size_t RoundTrips = 0;
+        uint64_t BytesFetched = 0;
+
+        // Each round trip pays the latency and the time to send its bytes. Read-ahead is counted as if it was waited on,
+        // though it overlaps with the reads that follow it; the latency is then the most that the reads could take.
+        double GetLatencyInMilliseconds() const
+        {
+            return static_cast<double>(RoundTrips * s_Latency.count()) + static_cast<double>(BytesFetched) * 1000 / s_BytesPerSecond;
+        }
+    };
+
+    // Replays the reads of a trace against a cache with the given policy, following the logic of HttpLocalCache.
+    struct CacheSimulator
+    {
+        CacheSimulator(const CachePolicy& policy, uint64_t fileSize) : m_policy(policy), m_fileSize(fileSize)
+        {
+            // Creating the stream downloads the tail of the data, which also gives its size; the cache only keeps whole pages of it
+            uint64_t tailPosition = fileSize - std::min<uint64_t>(fileSize, policy.TailSize);
+            m_result.RoundTrips = 1;
+            m_result.BytesFetched = fileSize - tailPosition;
+
+            for (uint64_t page = PageCeiling(tailPosition); page < fileSize; page += m_policy.PageSize)
+            {
+                AddPage(page);
+            }
+
+            EvictStalePages();
+        }
+
+        void Read(const AccessTraceEntry& entry)
+        {
+            ReadSequence& sequence = m_sequences[entry.Stream];
+            if (entry.Offset == sequence.NextPosition)
+            {
+                sequence.ReadAheadPages = std::min(std::max(sequence.ReadAheadPages * 2, 1U), m_policy.MaxReadAheadPages);
+            }
+            else
+            {
+                sequence.ReadAheadPages = 0;
+            }
+
+            uint64_t endPosition = entry.Offset + entry.Size;
+            sequence.NextPosition = endPosition;
+
+            // There is always at least one page for the range
+            std::vector<uint64_t> pages;
+            uint64_t page = PageFloor(entry.Offset);
+            do
+            {
+                pages.push_back(page);
+                page += m_policy.PageSize;
+            } while (page < endPosition);
+
+            std::vector<uint64_t> missingPages;
+            std::copy_if(pages.begin(), pages.end(), std::back_inserter(missingPages), [&](uint64_t p) { return m_pages.find(p) == m_pages.end(); });
+
+            m_result.Reads++;
+            if (missingPages.empty())
+            {
+                m_result.Hits++;
+            }
+
+            Download(missingPages);
+
+            for (uint64_t p : pages)
+            {
+                UsePage(p);
+            }
+
+            EvictStalePages();
+
+            std::vector<uint64_t> readAheadPages;
+            page = PageCeiling(endPosition);
+            for (uint32_t i = 0; i < sequence.ReadAheadPages && page < m_fileSize; i++, page += m_policy.PageSize)
+            {
+                if (m_pages.find(page) == m_pages.end())
+                {
+                    readAheadPages.push_back(page);
+                }
+            }
+
+            Download(readAheadPages);
+        }
+
+        const SimulationResult& GetResult() const { return m_result; }
+
+    private:
+        struct ReadSequence
+        {
+            uint64_t NextPosition = 0;
+            uint32_t ReadAheadPages = 0;
+        };
+
+        uint64_t PageFloor(uint64_t position) const { return (position / m_policy.PageSize) * m_policy.PageSize; }
+        uint64_t PageCeiling(uint64_t position) const { return ((position + m_policy.PageSize - 1) / m_policy.PageSize) * m_policy.PageSize; }
+
+        // Downloads the sorted pages with a request for each run of adjacent pages, as HttpLocalCache does.
+        void Download(const std::vector<uint64_t>& pages)
+        {
+            for (size_t runStart = 0; runStart < pages.size();)
+            {
+                size_t runEnd = runStart + 1;
+                while (runEnd < pages.size() && pages[runEnd] == pages[runEnd - 1] + m_policy.PageSize)
+                {
+                    runEnd++;
+                }
+
+                uint64_t startPosition = pages[runStart];
+                uint64_t endPosition = std::min<uint64_t>(pages[runEnd - 1] + m_policy.PageSize, m_fileSize);
+
+                if (endPosition > startPosition)
+                {
+                    m_result.RoundTrips++;
+                    m_result.BytesFetched += endPosition - startPosition;
+
+                    for (size_t i = runStart; i < runEnd; i++)
+                    {
+                        AddPage(pages[i]);
+                    }
+                }
+
+                runStart = runEnd;
+            }
+        }
+
+        void AddPage(uint64_t page)
+        {
+            auto itr = m_pages.find(page);
+            if (itr == m_pages.end())
+            {
+                m_pages.emplace(page, m_order.insert(m_order.begin(), page));
+            }
+            else
+            {
+                m_order.splice(m_order.begin(), m_order, itr->second);
+            }
+        }
+
+        void UsePage(uint64_t page)
+        {
+            auto itr = m_pages.find(page);
+            if (itr != m_pages.end() && m_policy.Eviction == EvictionOrder::LeastRecentlyUsed)
+            {
+                m_order.splice(m_order.begin(), m_order, itr->second);
+            }
+        }
+
+        void EvictStalePages()
+        {
+            while (m_pages.size() > m_policy.MaxPages)
+            {
+                m_pages.erase(m_order.back());
+                m_order.pop_back();
+            }
+        }
+
+        const CachePolicy& m_policy;
+        uint64_t m_fileSize = 0;
+        SimulationResult m_result;
+
+        std::unordered_map<uint64_t, std::list<uint64_t>::iterator> m_pages;
+        // The pages ordered from the first to be kept to the first to be evicted.
+        std::list<uint64_t> m_order;
+        std::map<uint32_t, ReadSequence> m_sequences;
+    };
+
+    SimulationResult Simulate(const std::vector<AccessTraceEntry>& trace, const CachePolicy& policy, uint64_t fileSize)
+    {
+        CacheSimulator simulator{ policy, fileSize };
+
+        for (const auto& entry : trace)
+        {
+            simulator.Read(entry);
+        }
+
+        return simulator.GetResult();
+    }
+
+    std::string ReadTestDataFile(std::string_view name)
+    {
+        std::ifstream file{ TestDataFile{ name }.GetPath(), std::ios::binary };
+        std::ostringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    // Serves the signed package, recording the reads of the given operation on it.
+    template <typename Operation>
+    std::vector<AccessTraceEntry> RecordTrace(TestHttpServer& server, Operation&& operation)
+    {
+        AccessTrace trace;
+
+        Msix::MsixInfo msix(server.GetUrl("package.msix"));
+        operation(msix);
+
+        return trace.GetEntries();
+    }
+}
+
+TEST_CASE("HttpLocalCache_AccessTrace", "[httpcache]")
+{
+    TestHttpServer::Options options;
+    options.ContentType = "application/msix";
+    TestHttpServer server{ ReadTestDataFile(s_SignedPackage), options };
+
+    auto trace = RecordTrace(server, [](Msix::MsixInfo& msix) { REQUIRE(!msix.GetSignature().empty()); });
+    REQUIRE(!trace.empty());
+
+    // The package is smaller than the tail, so every read is served from the pages seeded with it
+    REQUIRE(std::all_of(trace.begin(), trace.end(), [](const AccessTraceEntry& entry) { return entry.Hit; }));
+
+    // Replaying the trace with the policy of the cache makes the same requests that it made
+    SimulationResult result = Simulate(trace, s_CurrentPolicy, server.GetContent().size());
+    REQUIRE(result.Reads == trace.size());
+    REQUIRE(result.Hits == trace.size());
+    REQUIRE(result.RoundTrips == server.GetRequestCount());
+}
+
+TEST_CASE("HttpLocalCache_SimulateReadAhead", "[httpcache]")
+{
+    constexpr uint32_t s_PageSize = 1024;
+    constexpr uint64_t s_FileSize = 64 * s_PageSize;
+
+    // A single stream reading the data from the start, half a page at a time
+    std::vector<AccessTraceEntry> trace;
+    for (uint64_t offset = 0; offset < s_FileSize; offset += s_PageSize / 2)
+    {
+        trace.push_back({ 0, offset, s_PageSize / 2, false });
+    }
+
+    CachePolicy readAhead{ "read_ahead"sv, s_PageSize, 128, 16, EvictionOrder::LeastRecentlyUsed, 0 };
+    CachePolicy noReadAhead{ "no_read_ahead"sv, s_PageSize, 128, 0, EvictionOrder::LeastRecentlyUsed, 0 };
+
+    SimulationResult withReadAhead = Simulate(trace, readAhead, s_FileSize);
+    SimulationResult withoutReadAhead = Simulate(trace, noReadAhead, s_FileSize);
+
+    // Every page is downloaded once either way, in fewer requests with the read-ahead
+    REQUIRE(withReadAhead.BytesFetched == s_FileSize);
+    REQUIRE(withoutReadAhead.BytesFetched == s_FileSize);
+    REQUIRE(withoutReadAhead.RoundTrips == 1 + 64);
+    REQUIRE(withReadAhead.RoundTrips < withoutReadAhead.RoundTrips);
+
+    // A cache that holds fewer pages than a stream reads again has to download them again
+    std::vector<AccessTraceEntry> repeated = trace;
+    repeated.insert(repeated.end(), trace.begin(), trace.end());
+
+    CachePolicy smallCache{ "small_cache"sv, s_PageSize, 8, 0, EvictionOrder::LeastRecentlyUsed, 0 };
+    REQUIRE(Simulate(repeated, smallCache, s_FileSize).BytesFetched == 2 * s_FileSize);
+    REQUIRE(Simulate(repeated, noReadAhead, s_FileSize).BytesFetched == s_FileSize);
+}
+
+TEST_CASE("HttpLocalCache_Benchmark_Policies", "[.][benchmark]")
+{
+    TestHttpServer::Options options{ s_Latency, s_BytesPerSecond };
+    options.ContentType = "application/msix";
+    TestHttpServer server{ ReadTestDataFile(s_SignedPackage), options };
+    uint64_t fileSize = server.GetContent().size();
+
+    TempFile manifest{ "httpcache_benchmark_manifest"s, ".xml"s };
+    TempFile file{ "httpcache_benchmark_file"s, ".bin"s };
+    ProgressCallback callback;
+
+    {
+        Msix::MsixInfo local(TestDataFile{ s_SignedPackage }.GetPath().u8string());
+        local.WriteManifestToFile(manifest, callback);
+    }
+
+    // The operations that read packages from a server, each recorded as it is done on a newly opened package
+    std::vector<std::pair<std::string_view, std::vector<AccessTraceEntry>>> traces;
+    traces.emplace_back("get_signature"sv, RecordTrace(server, [](Msix::MsixInfo& msix) { REQUIRE(!msix.GetSignature().empty()); }));
+    traces.emplace_back("is_newer_than"sv, RecordTrace(server, [&](Msix::MsixInfo& msix) { REQUIRE(!msix.IsNewerThan(manifest.GetPath())); }));
+    traces.emplace_back("write_to_file"sv, RecordTrace(server, [&](Msix::MsixInfo& msix) { msix.WriteToFile("TestAppxPackage.exe", file, callback); }));
+
+    REQUIRE(std::filesystem::file_size(file.GetPath()) == 231936);
+
+    for (const auto& [operation, trace] : traces)
+    {
+        for (const CachePolicy& policy : s_Policies)
+        {
+            SimulationResult result = Simulate(trace, policy, fileSize);
+
+            std::string benchmark = "httpcache."s + std::string{ operation } + "." + std::string{ policy.Name };
+            BenchmarkResults::Record(benchmark, "reads", static_cast<double>(result.Reads), "reads");
+            BenchmarkResults::Record(benchmark, "hit_rate", result.Reads ? static_cast<double>(result.Hits) / result.Reads : 0, "hits/read");
+            BenchmarkResults::RecordWithThreshold(benchmark, "round_trips", static_cast<double>(result.RoundTrips), "requests", BenchmarkResults::Better::Lower, s_DeterministicTolerance);
+            BenchmarkResults::RecordWithThreshold(benchmark, "bytes_fetched", static_cast<double>(result.BytesFetched) / fileSize, "x content", BenchmarkResults::Better::Lower, s_DeterministicTolerance);
+            BenchmarkResults::RecordWithThreshold(benchmark, "simulated_latency", result.GetLatencyInMilliseconds(), "ms", BenchmarkResults::Better::Lower, s_DeterministicTolerance);
+        }
+    }
+
+    // The requests that the cache actually made for all of the operations, to check the simulation of the current policy against
+    BenchmarkResults::Record("httpcache.recorded", "round_trips", static_cast<double>(server.GetRequestCount()), "requests");
+    BenchmarkResults::Record("httpcache.recorded", "bytes_sent", static_cast<double>(server.GetContentBytesSent()) / fileSize, "x content");
+}
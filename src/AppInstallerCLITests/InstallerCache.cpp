@@ -0,0 +1,116 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include "AppInstallerSHA256.h"
+#include <winget/InstallerCache.h>
+
+using namespace AppInstaller::Utility;
+using namespace TestCommon;
+using namespace std::string_literals;
+using namespace std::chrono_literals;
+
+namespace
+{
+    std::vector<uint8_t> WriteFile(const std::filesystem::path& path, const std::string& content)
+    {
+        std::ofstream stream{ path, std::ios::binary | std::ios::trunc };
+        stream << content;
+        return SHA256::ComputeHash(reinterpret_cast<const uint8_t*>(content.data()), static_cast<uint32_t>(content.size()));
+    }
+
+    std::string ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream stream{ path, std::ios::binary };
+        std::stringstream content;
+        content << stream.rdbuf();
+        return content.str();
+    }
+
+    std::filesystem::path GetEntryPath(const InstallerCache& cache, const std::vector<uint8_t>& sha256)
+    {
+        return cache.GetDirectory() / SHA256::ConvertToString(sha256);
+    }
+}
+
+TEST_CASE("InstallerCache_AddAndGet", "[InstallerCache]")
+{
+    TempDirectory cacheDirectory("installercache");
+    TempFile sourceFile("installercache_source"s, ".exe"s);
+    TempFile destinationFile("installercache_destination"s, ".exe"s);
+
+    InstallerCache cache{ cacheDirectory.GetPath(), 1024 * 1024, 24h };
+
+    std::string content = "installer content";
+    auto hash = WriteFile(sourceFile, content);
+
+    REQUIRE(!cache.TryGet(hash, destinationFile));
+
+    cache.Add(hash, sourceFile);
+    REQUIRE(std::filesystem::exists(GetEntryPath(cache, hash)));
+
+    REQUIRE(cache.TryGet(hash, destinationFile));
+    REQUIRE(ReadFile(destinationFile) == content);
+
+    // Adding the same installer again keeps the published copy
+    cache.Add(hash, sourceFile);
+    REQUIRE(std::distance(std::filesystem::directory_iterator(cacheDirectory.GetPath()), std::filesystem::directory_iterator()) == 1);
+}
+
+TEST_CASE("InstallerCache_MismatchedEntryIsRemoved", "[InstallerCache]")
+{
+    TempDirectory cacheDirectory("installercache");
+    TempFile sourceFile("installercache_source"s, ".exe"s);
+    TempFile destinationFile("installercache_destination"s, ".exe"s);
+
+    InstallerCache cache{ cacheDirectory.GetPath(), 1024 * 1024, 24h };
+
+    auto hash = WriteFile(sourceFile, "installer content");
+    WriteFile(GetEntryPath(cache, hash), "tampered content");
+
+    REQUIRE(!cache.TryGet(hash, destinationFile));
+    REQUIRE(!std::filesystem::exists(GetEntryPath(cache, hash)));
+    REQUIRE(!std::filesystem::exists(destinationFile.GetPath()));
+}
+
+TEST_CASE("InstallerCache_PruneBySizeAndAge", "[InstallerCache]")
+{
+    TempDirectory cacheDirectory("installercache");
+    TempFile sourceFile("installercache_source"s, ".exe"s);
+
+    std::string content(100, 'a');
+    auto now = std::filesystem::file_time_type::clock::now();
+
+    SECTION("Least recently used installers are removed past the size")
+    {
+        InstallerCache cache{ cacheDirectory.GetPath(), 250, 24h };
+
+        // Each installer is used more recently than the one before it
+        std::vector<std::vector<uint8_t>> hashes;
+        for (int i = 0; i < 3; ++i)
+        {
+            content[0] = static_cast<char>('a' + i);
+            hashes.emplace_back(WriteFile(sourceFile, content));
+            cache.Add(hashes.back(), sourceFile);
+            std::filesystem::last_write_time(GetEntryPath(cache, hashes.back()), now - std::chrono::minutes(10 - i));
+        }
+
+        cache.Prune();
+
+        REQUIRE(!std::filesystem::exists(GetEntryPath(cache, hashes[0])));
+        REQUIRE(std::filesystem::exists(GetEntryPath(cache, hashes[1])));
+        REQUIRE(std::filesystem::exists(GetEntryPath(cache, hashes[2])));
+    }
+    SECTION("Installers past the age are removed")
+    {
+        InstallerCache cache{ cacheDirectory.GetPath(), 1024 * 1024, 24h };
+
+        auto hash = WriteFile(sourceFile, content);
+        cache.Add(hash, sourceFile);
+        std::filesystem::last_write_time(GetEntryPath(cache, hash), now - 25h);
+
+        cache.Prune();
+
+        REQUIRE(!std::filesystem::exists(GetEntryPath(cache, hash)));
+    }
+}
@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <Microsoft/IntegrityVerificationCache.h>
+
+#include <fstream>
+
+using namespace std::string_literals;
+using namespace std::chrono_literals;
+using namespace TestCommon;
+using namespace AppInstaller::Repository::Microsoft;
+
+namespace
+{
+    void WriteFile(const std::filesystem::path& path, std::string_view contents)
+    {
+        std::ofstream file{ path, std::ios::binary };
+        file << contents;
+    }
+}
+
+TEST_CASE("IntegrityVerificationCache_FileIdentity", "[integrityverificationcache]")
+{
+    TempFile first{ "integrityverification_first", ".db" };
+    TempFile second{ "integrityverification_second", ".db" };
+    WriteFile(first, "first");
+    WriteFile(second, "second");
+
+    auto identity = IntegrityVerificationCache::GetFileIdentity(first);
+    REQUIRE(identity == IntegrityVerificationCache::GetFileIdentity(first));
+    REQUIRE(identity != IntegrityVerificationCache::GetFileIdentity(second));
+
+    // A write changes the identity of the file
+    std::filesystem::last_write_time(first, std::filesystem::last_write_time(first) + 1h);
+    REQUIRE(identity != IntegrityVerificationCache::GetFileIdentity(first));
+
+    REQUIRE_THROWS(IntegrityVerificationCache::GetFileIdentity(first.GetPath().u8string() + ".missing"));
+}
+
+TEST_CASE("IntegrityVerificationCache_IsVerified", "[integrityverificationcache]")
+{
+    TempFile cacheFile{ "integrityverification_cache", ".db" };
+    TempFile indexFile{ "integrityverification_index", ".db" };
+    WriteFile(indexFile, "index");
+
+    auto identity = IntegrityVerificationCache::GetFileIdentity(indexFile);
+
+    {
+        auto cache = IntegrityVerificationCache::Open(cacheFile);
+        REQUIRE(!cache.IsVerified("Family_1", "Family_1.0_x64__1", identity));
+
+        cache.SetVerified("Family_1", "Family_1.0_x64__1", identity);
+        REQUIRE(cache.IsVerified("Family_1", "Family_1.0_x64__1", identity));
+    }
+
+    auto cache = IntegrityVerificationCache::Open(cacheFile);
+    REQUIRE(cache.IsVerified("Family_1", "Family_1.0_x64__1", identity));
+
+    // Another version of the package, another family or a changed file must be verified
+    REQUIRE(!cache.IsVerified("Family_1", "Family_2.0_x64__1", identity));
+    REQUIRE(!cache.IsVerified("Family_2", "Family_1.0_x64__1", identity));
+
+    std::filesystem::last_write_time(indexFile, std::filesystem::last_write_time(indexFile) + 1h);
+    REQUIRE(!cache.IsVerified("Family_1", "Family_1.0_x64__1", IntegrityVerificationCache::GetFileIdentity(indexFile)));
+
+    // An old verification must be done again
+    REQUIRE(!cache.IsVerified("Family_1", "Family_1.0_x64__1", identity, 0s));
+
+    // A new version replaces the old one
+    cache.SetVerified("Family_1", "Family_2.0_x64__1", identity);
+    REQUIRE(cache.IsVerified("Family_1", "Family_2.0_x64__1", identity));
+    REQUIRE(!cache.IsVerified("Family_1", "Family_1.0_x64__1", identity));
+
+    cache.Remove("Family_1");
+    REQUIRE(!cache.IsVerified("Family_1", "Family_2.0_x64__1", identity));
+}
@@ -0,0 +1,316 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <AppInstallerRepositoryInventory.h>
+#include <InventoryCache.h>
+
+#include <map>
+#include <set>
+
+using namespace std::string_literals;
+using namespace TestCommon;
+using namespace AppInstaller::Inventory;
+using namespace AppInstaller::Repository;
+
+namespace
+{
+    // What is installed, as the test sets it; the reader counts the entries that are read.
+    struct TestInventory
+    {
+        struct ArpKey
+        {
+            int64_t LastWriteTime = 0;
+            std::optional<InstalledEntry> Entry;
+        };
+
+        std::map<std::string, ArpKey> Arp;
+        int64_t MsixStamp = 0;
+        std::vector<InstalledEntry> Msix;
+
+        size_t ArpReads = 0;
+        size_t MsixReads = 0;
+
+        void SetArp(std::string key, int64_t lastWriteTime, std::string name, std::string version = "1.0", std::string publisher = "Publisher")
+        {
+            InstalledEntry entry;
+            entry.Location = EntryLocation::ArpUser;
+            entry.Key = key;
+            entry.Name = std::move(name);
+            entry.Version = std::move(version);
+            entry.Publisher = std::move(publisher);
+            Arp[std::move(key)] = { lastWriteTime, std::move(entry) };
+        }
+    };
+
+    struct TestInventoryReader : public IInventoryReader
+    {
+        TestInventoryReader(TestInventory& inventory) : m_inventory(inventory) {}
+
+        std::vector<EntryLocation> GetArpLocations() override { return { EntryLocation::ArpUser }; }
+
+        std::vector<ArpKeyStamp> GetArpKeyStamps(EntryLocation) override
+        {
+            std::vector<ArpKeyStamp> result;
+            for (const auto& key : m_inventory.Arp)
+            {
+                result.push_back({ key.first, key.second.LastWriteTime });
+            }
+            return result;
+        }
+
+        std::optional<InstalledEntry> ReadArpEntry(EntryLocation, std::string_view key) override
+        {
+            ++m_inventory.ArpReads;
+            auto itr = m_inventory.Arp.find(std::string{ key });
+            return (itr == m_inventory.Arp.end() ? std::nullopt : itr->second.Entry);
+        }
+
+        int64_t GetMsixStamp() override { return m_inventory.MsixStamp; }
+
+        std::vector<InstalledEntry> ReadMsixEntries() override
+        {
+            ++m_inventory.MsixReads;
+            return m_inventory.Msix;
+        }
+
+    private:
+        TestInventory& m_inventory;
+    };
+
+    InstalledEntry CreateMsixEntry(std::string name)
+    {
+        InstalledEntry entry;
+        entry.Location = EntryLocation::Msix;
+        entry.Key = name + "_1.0.0.0_x64__8wekyb3d8bbwe";
+        entry.Name = name;
+        entry.Version = "1.0.0.0";
+        entry.FamilyName = name + "_8wekyb3d8bbwe";
+        return entry;
+    }
+
+    struct TestApplication : public IApplication
+    {
+        TestApplication(std::string id, std::vector<AppInstaller::Utility::VersionAndChannel> versions = {}) :
+            m_id(std::move(id)), m_versions(std::move(versions)) {}
+
+        AppInstaller::Utility::LocIndString GetId() override { return AppInstaller::Utility::LocIndString{ m_id }; }
+        AppInstaller::Utility::LocIndString GetName() override { return AppInstaller::Utility::LocIndString{ m_id }; }
+        std::optional<AppInstaller::Manifest::Manifest> GetManifest(const AppInstaller::Utility::NormalizedString&, const AppInstaller::Utility::NormalizedString&) override { return {}; }
+        std::vector<AppInstaller::Utility::VersionAndChannel> GetVersions() override { return m_versions; }
+
+    private:
+        std::string m_id;
+        std::vector<AppInstaller::Utility::VersionAndChannel> m_versions;
+    };
+
+    // A source with the given ids, that counts the lookups made of it.
+    struct TestSource : public ISource
+    {
+        TestSource(std::set<std::string> ids) : m_ids(std::move(ids)) { m_details.Name = "test"; }
+
+        const SourceDetails& GetDetails() const override { return m_details; }
+
+        SearchResult Search(const SearchRequest&) override { return {}; }
+
+        SearchResult SearchForIds(const std::vector<std::string>& ids) override
+        {
+            ++Lookups;
+
+            SearchResult result;
+            for (const auto& id : ids)
+            {
+                if (m_ids.count(id))
+                {
+                    auto versions = Versions.find(id);
+                    result.Matches.emplace_back(
+                        std::make_unique<TestApplication>(id, versions == Versions.end() ? std::vector<AppInstaller::Utility::VersionAndChannel>{} : versions->second),
+                        ApplicationMatchFilter{ ApplicationMatchField::Id, MatchType::Exact, id });
+                }
+            }
+            return result;
+        }
+
+        size_t Lookups = 0;
+
+        // The versions of each package, in descending order.
+        std::map<std::string, std::vector<AppInstaller::Utility::VersionAndChannel>> Versions;
+
+    private:
+        SourceDetails m_details;
+        std::set<std::string> m_ids;
+    };
+}
+
+TEST_CASE("InventoryCache_RefreshIsIncremental", "[inventory]")
+{
+    TempFile cacheFile{ "inventorycache"s, ".db"s };
+    TestInventory inventory;
+
+    inventory.SetArp("{11111111-1111-1111-1111-111111111111}", 1, "First");
+    inventory.SetArp("Second_is1", 1, "Second");
+    inventory.Arp["Hidden"] = { 1, std::nullopt };
+    inventory.MsixStamp = 1;
+    inventory.Msix.emplace_back(CreateMsixEntry("Contoso.App"));
+
+    InventoryCache cache = InventoryCache::Open(cacheFile, std::make_unique<TestInventoryReader>(inventory));
+
+    auto result = cache.Refresh();
+    REQUIRE(result.Read == 4);
+    REQUIRE(result.Removed == 0);
+    REQUIRE(inventory.ArpReads == 3);
+    REQUIRE(inventory.MsixReads == 1);
+
+    // The hidden entry is kept so that it is not read again, but it is not given
+    auto entries = cache.GetEntries();
+    REQUIRE(entries.size() == 3);
+
+    SECTION("Nothing changed")
+    {
+        result = cache.Refresh();
+        REQUIRE(result.Read == 0);
+        REQUIRE(result.Removed == 0);
+        REQUIRE(inventory.ArpReads == 3);
+        REQUIRE(inventory.MsixReads == 1);
+    }
+    SECTION("Entry changed")
+    {
+        inventory.SetArp("Second_is1", 2, "Second", "2.0");
+
+        result = cache.Refresh();
+        REQUIRE(result.Read == 1);
+        REQUIRE(inventory.ArpReads == 4);
+
+        auto second = cache.FindByName("second");
+        REQUIRE(second.size() == 1);
+        REQUIRE(second[0].Version == "2.0");
+    }
+    SECTION("Entry removed")
+    {
+        inventory.Arp.erase("{11111111-1111-1111-1111-111111111111}");
+
+        result = cache.Refresh();
+        REQUIRE(result.Read == 0);
+        REQUIRE(result.Removed == 1);
+        REQUIRE(cache.FindByName("First").empty());
+        REQUIRE(cache.GetEntries().size() == 2);
+    }
+    SECTION("Package added")
+    {
+        inventory.MsixStamp = 2;
+        inventory.Msix.emplace_back(CreateMsixEntry("Contoso.Other"));
+
+        result = cache.Refresh();
+        REQUIRE(inventory.MsixReads == 2);
+        REQUIRE(inventory.ArpReads == 3);
+        REQUIRE(cache.GetEntries().size() == 4);
+    }
+    SECTION("Reopened")
+    {
+        // The snapshot is kept between runs
+        InventoryCache reopened = InventoryCache::Open(cacheFile, std::make_unique<TestInventoryReader>(inventory));
+        result = reopened.Refresh();
+        REQUIRE(result.Read == 0);
+        REQUIRE(reopened.GetEntries().size() == 3);
+    }
+}
+
+TEST_CASE("Inventory_CandidateIds", "[inventory]")
+{
+    InstalledEntry entry;
+    entry.Location = EntryLocation::ArpMachineNative;
+
+    SECTION("Product code")
+    {
+        entry.Key = "{11111111-1111-1111-1111-111111111111}";
+        entry.Name = "Microsoft Visual Studio Code";
+        entry.Publisher = "Microsoft Corporation";
+        REQUIRE(GetCandidateIds(entry) == std::vector<std::string>{ "Microsoft.VisualStudioCode" });
+    }
+    SECTION("Inno key")
+    {
+        entry.Key = "Git_is1";
+        entry.Name = "Git 2.30.0 (64-bit)";
+        entry.Publisher = "The Git Development Community";
+        REQUIRE(GetCandidateIds(entry) == std::vector<std::string>{ "Git", "The.Git" });
+    }
+    SECTION("Msix")
+    {
+        entry = CreateMsixEntry("Microsoft.WindowsTerminal");
+        REQUIRE(GetCandidateIds(entry) == std::vector<std::string>{ "Microsoft.WindowsTerminal" });
+    }
+}
+
+TEST_CASE("Inventory_CorrelateWithSingleLookup", "[inventory]")
+{
+    std::vector<InstalledEntry> entries;
+
+    InstalledEntry vscode;
+    vscode.Location = EntryLocation::ArpUser;
+    vscode.Key = "{11111111-1111-1111-1111-111111111111}";
+    vscode.Name = "Microsoft Visual Studio Code";
+    vscode.Publisher = "Microsoft Corporation";
+    entries.emplace_back(vscode);
+
+    // The 32-bit entry of the same package shares it
+    vscode.Location = EntryLocation::ArpMachineX86;
+    entries.emplace_back(vscode);
+
+    InstalledEntry unknown;
+    unknown.Key = "Unknown";
+    unknown.Name = "Unknown";
+    entries.emplace_back(unknown);
+
+    entries.emplace_back(CreateMsixEntry("Microsoft.WindowsTerminal"));
+
+    TestSource source{ { "Microsoft.VisualStudioCode", "Microsoft.WindowsTerminal" } };
+    auto correlated = CorrelateInventory(source, entries);
+
+    REQUIRE(source.Lookups == 1);
+    REQUIRE(correlated.size() == 3);
+    REQUIRE(correlated[0].Application->GetId() == "Microsoft.VisualStudioCode");
+    REQUIRE(correlated[0].Application == correlated[1].Application);
+    REQUIRE(correlated[1].Installed.Location == EntryLocation::ArpMachineX86);
+    REQUIRE(correlated[2].Application->GetId() == "Microsoft.WindowsTerminal");
+    REQUIRE(correlated[2].SourceName == "test");
+}
+
+TEST_CASE("Inventory_EvaluateUpgrades", "[inventory]")
+{
+    using AppInstaller::Utility::Channel;
+    using AppInstaller::Utility::Version;
+
+    auto create = [](std::string id, std::string version)
+    {
+        InstalledEntry entry;
+        entry.Location = EntryLocation::ArpUser;
+        entry.Key = std::move(id);
+        entry.Name = entry.Key;
+        entry.Version = std::move(version);
+        return entry;
+    };
+
+    std::vector<InstalledEntry> entries;
+    entries.emplace_back(create("Contoso.Numeric", "1.2"));
+    entries.emplace_back(create("Contoso.Current", "2.0"));
+    entries.emplace_back(create("Contoso.Channel", "3.0"));
+    entries.emplace_back(create("Contoso.NoVersion", ""));
+
+    // The 32-bit entry of an upgraded package does not give it again
+    entries.emplace_back(create("Contoso.Numeric", "1.2"));
+    entries.back().Location = EntryLocation::ArpMachineX86;
+
+    TestSource source{ { "Contoso.Numeric", "Contoso.Current", "Contoso.Channel", "Contoso.NoVersion" } };
+    source.Versions["Contoso.Numeric"] = { { Version("1.10"), Channel("") }, { Version("1.2"), Channel("") } };
+    source.Versions["Contoso.Current"] = { { Version("2.0"), Channel("") } };
+    source.Versions["Contoso.Channel"] = { { Version("4.0"), Channel("beta") }, { Version("3.0"), Channel("") } };
+    source.Versions["Contoso.NoVersion"] = { { Version("5.0"), Channel("") } };
+
+    auto upgrades = EvaluateUpgrades(source, entries);
+
+    REQUIRE(source.Lookups == 1);
+    REQUIRE(upgrades.size() == 1);
+    REQUIRE(upgrades[0].Entry.Application->GetId() == "Contoso.Numeric");
+    REQUIRE(upgrades[0].Entry.Installed.Location == EntryLocation::ArpUser);
+    REQUIRE(upgrades[0].Latest.GetVersion().ToString() == "1.10");
+}
@@ -0,0 +1,95 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <AppInstallerLogging.h>
+
+using namespace std::string_literals;
+using namespace AppInstaller::Logging;
+
+namespace
+{
+    // Keeps the messages that are logged while it is in the active set.
+    struct CaptureLogger : public ILogger
+    {
+        static constexpr std::string_view Name = "test :: capture";
+
+        CaptureLogger(std::vector<std::string>& messages) : m_messages(messages) {}
+
+        std::string GetName() const override { return std::string{ Name }; }
+
+        void Write(Channel, Level, std::string_view message) noexcept override try
+        {
+            m_messages.emplace_back(message);
+        }
+        catch (...) {}
+
+    private:
+        std::vector<std::string>& m_messages;
+    };
+
+    // Adds a CaptureLogger for the lifetime of the object.
+    struct ScopedCaptureLogger
+    {
+        ScopedCaptureLogger()
+        {
+            Log().AddLogger(std::make_unique<CaptureLogger>(Messages));
+        }
+
+        ~ScopedCaptureLogger()
+        {
+            (void)Log().RemoveLogger(std::string{ CaptureLogger::Name });
+        }
+
+        std::vector<std::string> Messages;
+    };
+
+    std::string LogNested(int value)
+    {
+        AICLI_LOG(Test, Info, << "inner " << value);
+        return "outer";
+    }
+}
+
+TEST_CASE("Logging_FormattingDoesNotCarryOver", "[logging]")
+{
+    ScopedCaptureLogger capture;
+
+    AICLI_LOG(Test, Info, << std::hex << std::setfill('0') << std::setw(4) << 255);
+    AICLI_LOG(Test, Info, << std::setw(4) << 255);
+    AICLI_LOG(Test, Info, << 1.0 / 3);
+
+    REQUIRE(capture.Messages.size() == 3);
+    REQUIRE(capture.Messages[0] == "00ff");
+    REQUIRE(capture.Messages[1] == " 255");
+    REQUIRE(capture.Messages[2] == "0.333333");
+}
+
+TEST_CASE("Logging_NestedMessages", "[logging]")
+{
+    ScopedCaptureLogger capture;
+
+    // The inner message is logged while the outer one is being formatted
+    AICLI_LOG(Test, Info, << "before " << LogNested(1) << " after");
+
+    REQUIRE(capture.Messages.size() == 2);
+    REQUIRE(capture.Messages[0] == "inner 1");
+    REQUIRE(capture.Messages[1] == "before outer after");
+}
+
+TEST_CASE("Logging_DisabledMessagesAreNotFormatted", "[logging]")
+{
+    ScopedCaptureLogger capture;
+
+    bool formatted = false;
+    auto format = [&]() { formatted = true; return "value"; };
+
+    Log().DisableChannel(Channel::Test);
+    AICLI_LOG(Test, Info, << format());
+    Log().EnableChannel(Channel::Test);
+
+    REQUIRE(!formatted);
+    REQUIRE(capture.Messages.empty());
+
+    static_assert(IsLevelCompiled(Level::Crit));
+}
@@ -0,0 +1,39 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <winget/Maintenance.h>
+
+using namespace AppInstaller::Maintenance;
+using namespace std::chrono_literals;
+
+namespace
+{
+    bool Contains(const std::wstring& value, std::wstring_view part)
+    {
+        return value.find(part) != std::wstring::npos;
+    }
+}
+
+TEST_CASE("Maintenance_SourceUpdateTaskDefinition", "[maintenance]")
+{
+    std::wstring definition = GetSourceUpdateTaskDefinition(L"C:\\Tools & More\\winget.exe", 90min);
+
+    REQUIRE(Contains(definition, L"<Interval>PT90M</Interval>"));
+    REQUIRE(Contains(definition, L"<Command>C:\\Tools &amp; More\\winget.exe</Command>"));
+    REQUIRE(Contains(definition, std::wstring{ L"<Arguments>" } + std::wstring{ ScheduledSourceUpdateArguments } + L"</Arguments>"));
+
+    // Runs only when it disturbs no one
+    REQUIRE(Contains(definition, L"<RunOnlyIfIdle>true</RunOnlyIfIdle>"));
+    REQUIRE(Contains(definition, L"<DisallowStartIfOnBatteries>true</DisallowStartIfOnBatteries>"));
+    REQUIRE(Contains(definition, L"<RunOnlyIfNetworkAvailable>true</RunOnlyIfNetworkAvailable>"));
+    REQUIRE(Contains(definition, L"<Priority>7</Priority>"));
+    REQUIRE(Contains(definition, L"<MultipleInstancesPolicy>IgnoreNew</MultipleInstancesPolicy>"));
+}
+
+TEST_CASE("Maintenance_SourceUpdateTaskIntervalBounds", "[maintenance]")
+{
+    // The task scheduler only repeats a task every minute to every 31 days
+    REQUIRE(Contains(GetSourceUpdateTaskDefinition(L"winget.exe", 0min), L"<Interval>PT1M</Interval>"));
+    REQUIRE(Contains(GetSourceUpdateTaskDefinition(L"winget.exe", std::chrono::hours(24 * 365)), L"<Interval>PT44640M</Interval>"));
+}
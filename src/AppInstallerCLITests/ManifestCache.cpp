@@ -0,0 +1,145 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <Microsoft/ManifestCache.h>
+#include <winget/ManifestYamlParser.h>
+
+using namespace std::string_literals;
+using namespace TestCommon;
+using namespace AppInstaller::Manifest;
+using namespace AppInstaller::Repository::Microsoft;
+
+namespace
+{
+    void RequireEqual(const ManifestInstaller& a, const ManifestInstaller& b)
+    {
+        REQUIRE(a.Arch == b.Arch);
+        REQUIRE(a.Url == b.Url);
+        REQUIRE(a.MirrorUrls == b.MirrorUrls);
+        REQUIRE(a.Sha256 == b.Sha256);
+        REQUIRE(a.SignatureSha256 == b.SignatureSha256);
+        REQUIRE(a.ChunkedSha256 == b.ChunkedSha256);
+        REQUIRE(a.ChunkSize == b.ChunkSize);
+        REQUIRE(a.Language == b.Language);
+        REQUIRE(a.Scope == b.Scope);
+        REQUIRE(a.ProductId == b.ProductId);
+        REQUIRE(a.InstallerType == b.InstallerType);
+        REQUIRE(a.Switches == b.Switches);
+    }
+
+    void RequireEqual(const Manifest& a, const Manifest& b)
+    {
+        REQUIRE(a.Id == b.Id);
+        REQUIRE(a.Name == b.Name);
+        REQUIRE(a.Version == b.Version);
+        REQUIRE(a.Publisher == b.Publisher);
+        REQUIRE(a.AppMoniker == b.AppMoniker);
+        REQUIRE(a.Channel == b.Channel);
+        REQUIRE(a.Author == b.Author);
+        REQUIRE(a.License == b.License);
+        REQUIRE(a.MinOSVersion == b.MinOSVersion);
+        REQUIRE(a.Tags == b.Tags);
+        REQUIRE(a.Commands == b.Commands);
+        REQUIRE(a.Protocols == b.Protocols);
+        REQUIRE(a.FileExtensions == b.FileExtensions);
+        REQUIRE(a.InstallerType == b.InstallerType);
+        REQUIRE(a.Description == b.Description);
+        REQUIRE(a.Homepage == b.Homepage);
+        REQUIRE(a.LicenseUrl == b.LicenseUrl);
+        REQUIRE(a.ManifestVersion.ToString() == b.ManifestVersion.ToString());
+        REQUIRE(a.Switches == b.Switches);
+
+        REQUIRE(a.Installers.size() == b.Installers.size());
+        for (size_t i = 0; i < a.Installers.size(); ++i)
+        {
+            RequireEqual(a.Installers[i], b.Installers[i]);
+        }
+
+        REQUIRE(a.Localization.size() == b.Localization.size());
+        for (size_t i = 0; i < a.Localization.size(); ++i)
+        {
+            ManifestLocalization localizationA = a.Localization[i];
+            ManifestLocalization localizationB = b.Localization[i];
+            localizationA.Decode();
+            localizationB.Decode();
+
+            REQUIRE(localizationA.Language == localizationB.Language);
+            REQUIRE(localizationA.Description == localizationB.Description);
+            REQUIRE(localizationA.Homepage == localizationB.Homepage);
+            REQUIRE(localizationA.LicenseUrl == localizationB.LicenseUrl);
+        }
+    }
+}
+
+TEST_CASE("ManifestCache_RoundTrip", "[manifestcache]")
+{
+    TempFile cacheFile{ "manifestcache"s, ".bin"s };
+
+    Manifest good = YamlParser::CreateFromPath(TestDataFile("Manifest-Good.yaml"));
+    Manifest switches = YamlParser::CreateFromPath(TestDataFile("Manifest-Good-Switches.yaml"));
+
+    ManifestCache::Create(cacheFile, {
+        { good, std::filesystem::path{ "manifests" } / "good.yaml" },
+        { switches, std::filesystem::path{ "manifests" } / "switches.yaml" },
+    });
+
+    ManifestCache cache = ManifestCache::Open(cacheFile);
+    REQUIRE(cache.GetCount() == 2);
+
+    // The keys are in the form that the index returns the relative paths
+    auto cachedGood = cache.GetManifest("manifests/good.yaml");
+    REQUIRE(cachedGood);
+    RequireEqual(cachedGood.value(), good);
+
+    auto cachedSwitches = cache.GetManifest("manifests/switches.yaml");
+    REQUIRE(cachedSwitches);
+    RequireEqual(cachedSwitches.value(), switches);
+
+    REQUIRE(!cache.GetManifest("manifests/missing.yaml"));
+    REQUIRE(!cache.GetManifest("manifests\\good.yaml"));
+}
+
+TEST_CASE("ManifestCache_CreateFromDirectory", "[manifestcache]")
+{
+    TempDirectory directory{ "manifestcache_directory" };
+    TempFile cacheFile{ "manifestcache"s, ".bin"s };
+
+    std::filesystem::create_directories(directory.GetPath() / "m");
+    std::filesystem::copy_file(TestDataFile("Manifest-Good.yaml"), directory.GetPath() / "m" / "good.yaml");
+    std::filesystem::copy_file(TestDataFile("Manifest-Good-Minimum.yaml"), directory.GetPath() / "minimum.yaml");
+
+    ManifestCache::CreateFromDirectory(cacheFile, directory.GetPath());
+
+    ManifestCache cache = ManifestCache::Open(cacheFile);
+    REQUIRE(cache.GetCount() == 2);
+
+    auto cachedGood = cache.GetManifest("m/good.yaml");
+    REQUIRE(cachedGood);
+    RequireEqual(cachedGood.value(), YamlParser::CreateFromPath(TestDataFile("Manifest-Good.yaml")));
+
+    auto cachedMinimum = cache.GetManifest("minimum.yaml");
+    REQUIRE(cachedMinimum);
+    RequireEqual(cachedMinimum.value(), YamlParser::CreateFromPath(TestDataFile("Manifest-Good-Minimum.yaml")));
+}
+
+TEST_CASE("ManifestCache_Corrupt", "[manifestcache]")
+{
+    TempFile cacheFile{ "manifestcache"s, ".bin"s };
+
+    Manifest good = YamlParser::CreateFromPath(TestDataFile("Manifest-Good.yaml"));
+    ManifestCache::Create(cacheFile, { { good, "good.yaml" } });
+
+    SECTION("Not a cache")
+    {
+        std::ofstream{ cacheFile.GetPath(), std::ios::binary | std::ios::trunc } << "not a manifest cache";
+        REQUIRE_THROWS_HR(ManifestCache::Open(cacheFile), HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT));
+    }
+    SECTION("Truncated")
+    {
+        std::filesystem::resize_file(cacheFile.GetPath(), std::filesystem::file_size(cacheFile.GetPath()) - 1);
+
+        ManifestCache cache = ManifestCache::Open(cacheFile);
+        REQUIRE_THROWS_HR(cache.GetManifest("good.yaml"), HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT));
+    }
+}
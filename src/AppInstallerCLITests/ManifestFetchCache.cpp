@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <Microsoft/ManifestFetchCache.h>
+
+using namespace std::string_literals;
+using namespace TestCommon;
+using namespace AppInstaller::Repository::Microsoft;
+
+TEST_CASE("ManifestFetchCache_PutAndGet", "[manifestfetchcache]")
+{
+    TempFile tempFile{ "repolibtest_manifestfetchcache"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    {
+        ManifestFetchCache cache = ManifestFetchCache::Open(tempFile.GetPath());
+        REQUIRE(!cache.Get("source", "1", "manifests/a/A.yaml"));
+
+        cache.Put("source", "1", "manifests/a/A.yaml", "Id: A");
+    }
+
+    // Reopen to read from another connection, as another process would.
+    ManifestFetchCache cache = ManifestFetchCache::Open(tempFile.GetPath());
+
+    auto cached = cache.Get("source", "1", "manifests/a/A.yaml");
+    REQUIRE(cached);
+    REQUIRE(cached.value() == "Id: A");
+
+    // A different index, source or path is not a hit.
+    REQUIRE(!cache.Get("source", "2", "manifests/a/A.yaml"));
+    REQUIRE(!cache.Get("other", "1", "manifests/a/A.yaml"));
+    REQUIRE(!cache.Get("source", "1", "manifests/b/B.yaml"));
+
+    // The manifest from a new index replaces the one from the old index.
+    cache.Put("source", "2", "manifests/a/A.yaml", "Id: A2");
+    REQUIRE(cache.GetEntryCount() == 1);
+    REQUIRE(!cache.Get("source", "1", "manifests/a/A.yaml"));
+    REQUIRE(cache.Get("source", "2", "manifests/a/A.yaml").value() == "Id: A2");
+
+    cache.Remove("source");
+    REQUIRE(cache.GetEntryCount() == 0);
+}
+
+TEST_CASE("ManifestFetchCache_LeastRecentlyUsed", "[manifestfetchcache]")
+{
+    TempFile tempFile{ "repolibtest_manifestfetchcache"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    ManifestFetchCache cache = ManifestFetchCache::Open(tempFile.GetPath(), 2);
+
+    cache.Put("source", "1", "A.yaml", "Id: A");
+    cache.Put("source", "1", "B.yaml", "Id: B");
+
+    // Using A makes B the least recently used.
+    REQUIRE(cache.Get("source", "1", "A.yaml"));
+
+    cache.Put("source", "1", "C.yaml", "Id: C");
+
+    REQUIRE(cache.GetEntryCount() == 2);
+    REQUIRE(cache.Get("source", "1", "A.yaml"));
+    REQUIRE(!cache.Get("source", "1", "B.yaml"));
+    REQUIRE(cache.Get("source", "1", "C.yaml"));
+}
+
+TEST_CASE("ManifestFetchCache_RemoveSource", "[manifestfetchcache]")
+{
+    TempFile tempFile{ "repolibtest_manifestfetchcache"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    // The cache does not exist yet, so there is nothing to remove and it is not created.
+    ManifestFetchCache::RemoveSource(tempFile.GetPath(), "source");
+    REQUIRE(!std::filesystem::exists(tempFile.GetPath()));
+
+    {
+        ManifestFetchCache cache = ManifestFetchCache::Open(tempFile.GetPath());
+        cache.Put("source", "1", "A.yaml", "Id: A");
+        cache.Put("other", "1", "A.yaml", "Id: A");
+    }
+
+    ManifestFetchCache::RemoveSource(tempFile.GetPath(), "source");
+
+    ManifestFetchCache cache = ManifestFetchCache::Open(tempFile.GetPath());
+    REQUIRE(!cache.Get("source", "1", "A.yaml"));
+    REQUIRE(cache.Get("other", "1", "A.yaml"));
+}
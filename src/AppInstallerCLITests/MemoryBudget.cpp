@@ -0,0 +1,78 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <SQLiteWrapper.h>
+#include <winget/MemoryBudget.h>
+
+using namespace AppInstaller;
+using namespace AppInstaller::Memory;
+using namespace AppInstaller::Repository;
+using namespace std::string_literals;
+
+TEST_CASE("MemoryBudget_TrimsInOrder", "[MemoryBudget]")
+{
+    MemoryBudget budget{ 1000 };
+    std::vector<std::string> trimmed;
+
+    auto late = budget.Register("late", TrimOrder::Late, [&](size_t) { trimmed.emplace_back("late"); });
+    late.SetUsage(600);
+
+    size_t earlyUsage = 600;
+    auto early = budget.Register("early", TrimOrder::Early, [&]() { return earlyUsage; }, [&](size_t bytesToFree)
+        {
+            trimmed.emplace_back("early");
+            earlyUsage -= std::min(earlyUsage, bytesToFree);
+        });
+
+    auto reportOnly = budget.Register("reportOnly", TrimOrder::Normal, {});
+    reportOnly.SetUsage(100);
+
+    REQUIRE(budget.GetUsage() == 1300);
+
+    // Only the early cache needs to be trimmed to get under the limit
+    budget.TrimIfOverBudget();
+    REQUIRE(trimmed == std::vector<std::string>{ "early" });
+    REQUIRE(earlyUsage == 300);
+    REQUIRE(budget.GetUsage() == 1000);
+
+    budget.TrimIfOverBudget();
+    REQUIRE(trimmed.size() == 1);
+
+    // Trimming everything reaches the late cache, which here does not free anything
+    REQUIRE(budget.Trim(0) == 300);
+    REQUIRE(trimmed == std::vector<std::string>{ "early", "early", "late" });
+
+    // A removed registration is neither counted nor trimmed
+    late.reset();
+    REQUIRE(budget.GetUsage() == 100);
+    budget.Trim(0);
+    REQUIRE(trimmed.size() == 3);
+}
+
+TEST_CASE("MemoryBudget_ReleasesSQLiteMemory", "[MemoryBudget]")
+{
+    TestCommon::TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+
+    SQLite::Connection connection = SQLite::Connection::Create(tempFile, SQLite::Connection::OpenDisposition::Create);
+    SQLite::Statement::Create(connection, "create table [values] ([value] TEXT)").Execute();
+
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "fill");
+        SQLite::Statement insert = SQLite::Statement::Create(connection, "insert into [values] ([value]) values (?)");
+        for (int i = 0; i < 10000; ++i)
+        {
+            insert.Reset();
+            insert.Bind(1, std::string(100, static_cast<char>('a' + i % 26)));
+            insert.Execute();
+        }
+        savepoint.Commit();
+    }
+
+    size_t before = connection.GetCacheMemoryUsed();
+    REQUIRE(before > 0);
+
+    // The connection is registered with the budget of the process
+    MemoryBudget::Instance().Trim(0);
+    REQUIRE(connection.GetCacheMemoryUsed() < before);
+}
@@ -64,3 +64,37 @@ TEST_CASE("MsixInfo_WriteFile", "[msixinfo]")
 
     REQUIRE(1 == std::filesystem::file_size(file));
 }
+
+TEST_CASE("MsixInfo_GetPackageSignature", "[msixinfo]")
+{
+    TestDataFile package("TestSignedApp.msix");
+    std::string path = package.GetPath().u8string();
+
+    Msix::MsixInfo msix(path);
+    std::vector<byte> expected = msix.GetSignature();
+    REQUIRE(!expected.empty());
+
+    REQUIRE(Msix::GetPackageSignature(path) == expected);
+}
+
+TEST_CASE("MsixInfo_OpenConcurrently", "[msixinfo]")
+{
+    TestDataFile index(s_MsixFile_1);
+    std::string path = index.GetPath().u8string();
+
+    // The threads share the factories that read the package
+    std::vector<std::future<std::string>> results;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        results.emplace_back(std::async(std::launch::async, [&]()
+            {
+                Msix::MsixInfo msix(path);
+                return msix.GetPackageFullName();
+            }));
+    }
+
+    for (auto& result : results)
+    {
+        REQUIRE(result.get() == "AppInstallerCLITestsFakeIndex_1.0.0.0_neutral__125rzkzqaqjwj");
+    }
+}
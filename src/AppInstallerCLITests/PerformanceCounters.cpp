@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <AppInstallerTelemetry.h>
+#include <thread>
+
+using namespace AppInstaller::Logging;
+using namespace std::chrono_literals;
+
+TEST_CASE("ScopedPerformanceTimer_AddsToCounter", "[perf]")
+{
+    ResetPerformanceCounters();
+
+    {
+        ScopedPerformanceTimer timer{ PerformanceOperation::IndexSearch };
+        std::this_thread::sleep_for(20ms);
+    }
+    {
+        ScopedPerformanceTimer timer{ PerformanceOperation::IndexSearch };
+    }
+
+    PerformanceCounter counter = GetPerformanceCounter(PerformanceOperation::IndexSearch);
+    REQUIRE(counter.Count == 2);
+    REQUIRE(counter.Longest >= 20ms);
+    REQUIRE(counter.Total >= counter.Longest);
+
+    // Other operations are counted apart
+    REQUIRE(GetPerformanceCounter(PerformanceOperation::Download).Count == 0);
+
+    ResetPerformanceCounters();
+    counter = GetPerformanceCounter(PerformanceOperation::IndexSearch);
+    REQUIRE(counter.Count == 0);
+    REQUIRE(counter.Total == 0us);
+    REQUIRE(counter.Longest == 0us);
+}
+
+TEST_CASE("ScopedPerformanceTimer_ConcurrentTimers", "[perf]")
+{
+    ResetPerformanceCounters();
+
+    constexpr size_t threadCount = 8;
+    constexpr size_t timersPerThread = 1000;
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back([]()
+            {
+                for (size_t j = 0; j < timersPerThread; ++j)
+                {
+                    ScopedPerformanceTimer timer{ PerformanceOperation::ManifestFetch };
+                }
+            });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(GetPerformanceCounter(PerformanceOperation::ManifestFetch).Count == threadCount * timersPerThread);
+    ResetPerformanceCounters();
+}
+
+TEST_CASE("PerformanceOperation_Names", "[perf]")
+{
+    for (size_t i = 0; i < static_cast<size_t>(PerformanceOperation::Max); ++i)
+    {
+        REQUIRE(ToString(static_cast<PerformanceOperation>(i)) != "Unknown");
+    }
+}
+
+TEST_CASE("WorkflowTaskHistogram_Buckets", "[perf]")
+{
+    ResetPerformanceCounters();
+
+    RecordWorkflowTaskDuration(0us);
+    RecordWorkflowTaskDuration(999us);
+    RecordWorkflowTaskDuration(1ms);
+    RecordWorkflowTaskDuration(150ms);
+    RecordWorkflowTaskDuration(10s);
+    RecordWorkflowTaskDuration(1min);
+
+    WorkflowTaskHistogram histogram = GetWorkflowTaskHistogram();
+    REQUIRE(histogram.Counts == std::array<uint64_t, WorkflowTaskHistogram::BucketCount>{ 2, 1, 0, 1, 0, 2 });
+    REQUIRE(histogram.Total == 999us + 1ms + 150ms + 10s + 1min);
+
+    ResetPerformanceCounters();
+    histogram = GetWorkflowTaskHistogram();
+    REQUIRE(histogram.Counts == std::array<uint64_t, WorkflowTaskHistogram::BucketCount>{});
+    REQUIRE(histogram.Total == 0us);
+}
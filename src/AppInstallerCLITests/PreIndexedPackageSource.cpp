@@ -27,6 +27,7 @@ constexpr std::string_view s_Msix_FamilyName = "AppInstallerCLITestsFakeIndex_12
 constexpr std::string_view s_AppxManifestFileName = "AppxManifest.xml"sv;
 constexpr std::string_view s_IndexMsixName = "source.msix"sv;
 constexpr std::string_view s_IndexFileName = "index.db"sv;
+constexpr std::string_view s_CurrentVersionFileName = "current"sv;
 
 void CopyIndexFileToDirectory(const fs::path& from, const fs::path& to)
 {
@@ -54,6 +55,16 @@ std::string GetContents(const fs::path& file)
     return ReadEntireStream(stream);
 }
 
+// Gets the directory of the version of the data that the state names as current.
+fs::path GetPathToCurrentVersionDir()
+{
+    fs::path state = GetPathToFileDir();
+    std::string version = GetContents(state / s_CurrentVersionFileName);
+    Trim(version);
+    REQUIRE(!version.empty());
+    return state / fs::u8path(version);
+}
+
 void CleanSources()
 {
     RemoveSetting(Streams::UserSources);
@@ -79,12 +90,12 @@ TEST_CASE("PIPS_Add", "[pips]")
     fs::path state = GetPathToFileDir();
     REQUIRE(fs::exists(state));
 
-    fs::path manifest = state;
+    fs::path manifest = GetPathToCurrentVersionDir();
     manifest /= s_AppxManifestFileName;
     REQUIRE(fs::exists(manifest));
     REQUIRE(fs::file_size(manifest) > 0);
 
-    fs::path indexFile = state;
+    fs::path indexFile = GetPathToCurrentVersionDir();
     indexFile /= s_IndexFileName;
     REQUIRE(fs::exists(indexFile));
     REQUIRE(fs::file_size(indexFile) > 0);
@@ -133,13 +144,9 @@ TEST_CASE("PIPS_UpdateNewVersion", "[pips]")
     fs::path state = GetPathToFileDir();
     REQUIRE(fs::exists(state));
 
-    fs::path manifestPath = state;
-    manifestPath /= s_AppxManifestFileName;
-    std::string manifestContents1 = GetContents(manifestPath);
-
-    fs::path indexPath = state;
-    indexPath /= s_IndexFileName;
-    std::string indexContents1 = GetContents(indexPath);
+    fs::path versionDir1 = GetPathToCurrentVersionDir();
+    std::string manifestContents1 = GetContents(versionDir1 / s_AppxManifestFileName);
+    std::string indexContents1 = GetContents(versionDir1 / s_IndexFileName);
 
     TestDataFile indexMsix2(s_MsixFile_2);
     CopyIndexFileToDirectory(indexMsix2, dir);
@@ -150,13 +157,58 @@ TEST_CASE("PIPS_UpdateNewVersion", "[pips]")
     UpdateSource(name, callback);
     REQUIRE(progressCalled);
 
-    std::string manifestContents2 = GetContents(manifestPath);
+    fs::path versionDir2 = GetPathToCurrentVersionDir();
+    REQUIRE(versionDir1 != versionDir2);
+
+    // The previous version is not open, so the update removes it
+    REQUIRE(!fs::exists(versionDir1));
+
+    std::string manifestContents2 = GetContents(versionDir2 / s_AppxManifestFileName);
     REQUIRE(manifestContents1 != manifestContents2);
 
-    std::string indexContents2 = GetContents(indexPath);
+    std::string indexContents2 = GetContents(versionDir2 / s_IndexFileName);
     REQUIRE(indexContents1 != indexContents2);
 }
 
+TEST_CASE("PIPS_UpdateWhileOpen", "[pips]")
+{
+    CleanSources();
+
+    TempDirectory dir("pipssource");
+    TestDataFile indexMsix1(s_MsixFile_1);
+    CopyIndexFileToDirectory(indexMsix1, dir);
+
+    std::string name = "TestName";
+    std::string type(AppInstaller::Repository::Microsoft::PreIndexedPackageSourceFactory::Type());
+    std::string arg = dir;
+    TestProgress callback;
+
+    AddSource(name, type, arg, callback);
+
+    fs::path versionDir1 = GetPathToCurrentVersionDir();
+
+    {
+        // The open source keeps its version of the index while the update swaps in the new one
+        auto source = OpenSource(name, callback);
+        REQUIRE(source);
+
+        TestDataFile indexMsix2(s_MsixFile_2);
+        CopyIndexFileToDirectory(indexMsix2, dir);
+
+        UpdateSource(name, callback);
+
+        REQUIRE(GetPathToCurrentVersionDir() != versionDir1);
+        REQUIRE(fs::exists(versionDir1 / s_IndexFileName));
+
+        SearchRequest request;
+        REQUIRE_NOTHROW(source->Search(request));
+    }
+
+    // Once it is closed, the old version is removed with the source
+    RemoveSource(name, callback);
+    REQUIRE(!fs::exists(GetPathToFileDir()));
+}
+
 TEST_CASE("PIPS_Remove", "[pips]")
 {
     CleanSources();
@@ -175,11 +227,11 @@ TEST_CASE("PIPS_Remove", "[pips]")
     fs::path state = GetPathToFileDir();
     REQUIRE(fs::exists(state));
 
-    fs::path manifest = state;
+    fs::path manifest = GetPathToCurrentVersionDir();
     manifest /= s_AppxManifestFileName;
     REQUIRE(fs::exists(manifest));
 
-    fs::path indexFile = state;
+    fs::path indexFile = GetPathToCurrentVersionDir();
     indexFile /= s_IndexFileName;
     REQUIRE(fs::exists(indexFile));
 
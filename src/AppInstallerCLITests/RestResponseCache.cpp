@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <Microsoft/RestResponseCache.h>
+
+using namespace std::string_literals;
+using namespace TestCommon;
+using namespace AppInstaller::Repository::Microsoft;
+
+TEST_CASE("RestResponseCache_PutAndGet", "[restresponsecache]")
+{
+    TempFile tempFile{ "repolibtest_restresponsecache"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    {
+        RestResponseCache cache = RestResponseCache::Open(tempFile.GetPath());
+        REQUIRE(!cache.Get("source", "https://server/information"));
+
+        cache.Put("source", "https://server/information", "\"1\"", "{}");
+    }
+
+    // Reopen to read from another connection, as another process would.
+    RestResponseCache cache = RestResponseCache::Open(tempFile.GetPath());
+
+    auto cached = cache.Get("source", "https://server/information");
+    REQUIRE(cached);
+    REQUIRE(cached->ETag == "\"1\"");
+    REQUIRE(cached->Contents == "{}");
+
+    // A different source or request is not a hit.
+    REQUIRE(!cache.Get("other", "https://server/information"));
+    REQUIRE(!cache.Get("source", "https://server/manifestSearch"));
+
+    // A new response replaces the old one.
+    cache.Put("source", "https://server/information", "\"2\"", "{ \"Data\": {} }");
+    REQUIRE(cache.GetEntryCount() == 1);
+    REQUIRE(cache.Get("source", "https://server/information")->ETag == "\"2\"");
+
+    cache.Remove("source");
+    REQUIRE(cache.GetEntryCount() == 0);
+}
+
+TEST_CASE("RestResponseCache_LeastRecentlyUsed", "[restresponsecache]")
+{
+    TempFile tempFile{ "repolibtest_restresponsecache"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    RestResponseCache cache = RestResponseCache::Open(tempFile.GetPath(), 2);
+
+    cache.Put("source", "A", "1", "A");
+    cache.Put("source", "B", "1", "B");
+
+    // Only confirming that A is current makes B the least recently used; reading it does not.
+    REQUIRE(cache.Get("source", "B"));
+    cache.Touch("source", "A");
+
+    cache.Put("source", "C", "1", "C");
+
+    REQUIRE(cache.GetEntryCount() == 2);
+    REQUIRE(cache.Get("source", "A"));
+    REQUIRE(!cache.Get("source", "B"));
+    REQUIRE(cache.Get("source", "C"));
+}
+
+TEST_CASE("RestResponseCache_RemoveSource", "[restresponsecache]")
+{
+    TempFile tempFile{ "repolibtest_restresponsecache"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    // The cache does not exist yet, so there is nothing to remove and it is not created.
+    RestResponseCache::RemoveSource(tempFile.GetPath(), "source");
+    REQUIRE(!std::filesystem::exists(tempFile.GetPath()));
+
+    {
+        RestResponseCache cache = RestResponseCache::Open(tempFile.GetPath());
+        cache.Put("source", "A", "1", "A");
+        cache.Put("other", "A", "1", "A");
+    }
+
+    RestResponseCache::RemoveSource(tempFile.GetPath(), "source");
+
+    RestResponseCache cache = RestResponseCache::Open(tempFile.GetPath());
+    REQUIRE(!cache.Get("source", "A"));
+    REQUIRE(cache.Get("other", "A"));
+}
@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <Microsoft/RestSource.h>
+#include <Microsoft/RestSourceFactory.h>
+#include <AppInstallerErrors.h>
+
+using namespace std::string_literals;
+using namespace TestCommon;
+using namespace AppInstaller::Repository;
+using namespace AppInstaller::Repository::Microsoft;
+
+TEST_CASE("RestSource_CreateSearchRequestBody", "[restsource]")
+{
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Substring, "terminal");
+    request.Inclusions.emplace_back(ApplicationMatchField::Moniker, MatchType::Exact, "wt");
+    request.Filters.emplace_back(ApplicationMatchField::Tag, MatchType::CaseInsensitive, "console");
+    request.MaximumResults = 1000;
+
+    // The page size is sent, not the maximum of the whole search.
+    std::string body = RestProtocol::CreateSearchRequestBody(request, 100);
+    REQUIRE(body ==
+        R"({"Filters":[{"PackageMatchField":"Tag","RequestMatch":{"KeyWord":"console","MatchType":"CaseInsensitive"}}],)"
+        R"("Inclusions":[{"PackageMatchField":"Moniker","RequestMatch":{"KeyWord":"wt","MatchType":"Exact"}}],)"
+        R"("MaximumResults":100,"Query":{"KeyWord":"terminal","MatchType":"Substring"}})");
+
+    // The parts of the request that are not used are left out.
+    REQUIRE(RestProtocol::CreateSearchRequestBody({}, 10) == R"({"MaximumResults":10})");
+}
+
+TEST_CASE("RestSource_ParseSearchResponse", "[restsource]")
+{
+    auto page = RestProtocol::ParseSearchResponse(R"({
+        "Data": [
+            {
+                "PackageIdentifier": "Contoso.Terminal",
+                "PackageName": "Contoso Terminal",
+                "Versions": [ { "PackageVersion": "1.0" }, { "PackageVersion": "2.0" }, { "PackageVersion": "3.0", "Channel": "beta" } ],
+                "Match": { "PackageMatchField": "PackageName", "RequestMatch": { "KeyWord": "Contoso Terminal", "MatchType": "Substring" } }
+            },
+            {
+                "PackageIdentifier": "Fabrikam.Console",
+                "Versions": [ { "PackageVersion": "1.0" } ]
+            }
+        ],
+        "ContinuationToken": "page2"
+    })");
+
+    REQUIRE(page.ContinuationToken == "page2");
+    REQUIRE(page.Packages.size() == 2);
+
+    const auto& first = page.Packages[0];
+    REQUIRE(first.Id == "Contoso.Terminal");
+    REQUIRE(first.Name == "Contoso Terminal");
+    REQUIRE(first.Versions.size() == 3);
+    REQUIRE(first.Versions[0].GetVersion().ToString() == "2.0");
+    REQUIRE(first.Versions[1].GetVersion().ToString() == "1.0");
+    REQUIRE(first.Versions[2].GetChannel().ToString() == "beta");
+    REQUIRE(first.Match);
+    REQUIRE(first.Match->Field == ApplicationMatchField::Name);
+    REQUIRE(first.Match->Type == MatchType::Substring);
+    REQUIRE(first.Match->Value == "Contoso Terminal");
+
+    // A package without a name is named by its id, and may not say what it was matched on.
+    const auto& second = page.Packages[1];
+    REQUIRE(second.Name == "Fabrikam.Console");
+    REQUIRE(!second.Match);
+
+    // The last page has no token, and a search that found nothing may have no content.
+    REQUIRE(RestProtocol::ParseSearchResponse(R"({ "Data": [] })").ContinuationToken.empty());
+    REQUIRE(RestProtocol::ParseSearchResponse("").Packages.empty());
+}
+
+TEST_CASE("RestSource_ParseInvalidResponses", "[restsource]")
+{
+    REQUIRE_THROWS_HR(RestProtocol::ParseSearchResponse("not json"), APPINSTALLER_CLI_ERROR_RESTSOURCE_INVALID_RESPONSE);
+    REQUIRE_THROWS_HR(RestProtocol::ParseSearchResponse(R"({ "Data": {} })"), APPINSTALLER_CLI_ERROR_RESTSOURCE_INVALID_RESPONSE);
+    REQUIRE_THROWS_HR(RestProtocol::ParseSearchResponse(R"({ "Data": [ { "Versions": [ { "PackageVersion": "1.0" } ] } ] })"), APPINSTALLER_CLI_ERROR_RESTSOURCE_INVALID_RESPONSE);
+    REQUIRE_THROWS_HR(RestProtocol::ParseSearchResponse(R"({ "Data": [ { "PackageIdentifier": "Id", "Versions": [] } ] })"), APPINSTALLER_CLI_ERROR_RESTSOURCE_INVALID_RESPONSE);
+
+    REQUIRE(RestProtocol::ParseInformationResponse(R"({ "Data": { "SourceIdentifier": "Contoso.Packages" } })") == "Contoso.Packages");
+    REQUIRE_THROWS_HR(RestProtocol::ParseInformationResponse(R"({ "Data": {} })"), APPINSTALLER_CLI_ERROR_RESTSOURCE_INVALID_RESPONSE);
+}
+
+TEST_CASE("RestSource_AddRequiresSecureLocation", "[restsource]")
+{
+    SourceDetails details;
+    details.Name = "testName";
+    details.Type = RestSourceFactory::Type();
+    details.Arg = "http://localhost/api/";
+
+    ProgressCallback progress;
+    auto factory = RestSourceFactory::Create();
+    REQUIRE_THROWS_HR(factory->Add(details, progress), APPINSTALLER_CLI_ERROR_SOURCE_NOT_SECURE);
+    REQUIRE(details.Data.empty());
+}
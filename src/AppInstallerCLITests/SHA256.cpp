@@ -0,0 +1,212 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include "AppInstallerSHA256.h"
+
+#include <chrono>
+
+using namespace AppInstaller::Utility;
+using namespace std::string_literals;
+
+namespace
+{
+    std::vector<SHA256::Implementation> GetAvailableImplementations()
+    {
+        std::vector<SHA256::Implementation> result{ SHA256::Implementation::Platform };
+
+        if (SHA256::IsHardwareImplementationSupported())
+        {
+            result.emplace_back(SHA256::Implementation::Hardware);
+        }
+
+        return result;
+    }
+
+    std::vector<uint8_t> CreateData(size_t size)
+    {
+        std::vector<uint8_t> result(size);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            result[i] = static_cast<uint8_t>((i * 31) ^ (i >> 8));
+        }
+
+        return result;
+    }
+
+    std::string HashInChunks(SHA256::Implementation implementation, const std::vector<uint8_t>& data, size_t chunkSize)
+    {
+        SHA256 hasher{ implementation };
+
+        for (size_t offset = 0; offset < data.size(); offset += chunkSize)
+        {
+            hasher.Add(data.data() + offset, std::min(chunkSize, data.size() - offset));
+        }
+
+        return SHA256::ConvertToString(hasher.Get());
+    }
+}
+
+TEST_CASE("SHA256_KnownValues", "[SHA256]")
+{
+    std::string abc = "abc";
+    std::string twoBlocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+    for (auto implementation : GetAvailableImplementations())
+    {
+        INFO("Implementation: " << static_cast<int>(implementation));
+
+        SHA256 emptyHasher{ implementation };
+        REQUIRE(SHA256::ConvertToString(emptyHasher.Get()) == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+
+        SHA256 abcHasher{ implementation };
+        abcHasher.Add(reinterpret_cast<const uint8_t*>(abc.data()), abc.size());
+        REQUIRE(SHA256::ConvertToString(abcHasher.Get()) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+        SHA256 twoBlocksHasher{ implementation };
+        twoBlocksHasher.Add(reinterpret_cast<const uint8_t*>(twoBlocks.data()), twoBlocks.size());
+        REQUIRE(SHA256::ConvertToString(twoBlocksHasher.Get()) == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    }
+}
+
+TEST_CASE("SHA256_ImplementationsMatch", "[SHA256]")
+{
+    if (!SHA256::IsHardwareImplementationSupported())
+    {
+        WARN("The processor does not support the SHA256 instructions");
+        return;
+    }
+
+    // Sizes around the block and padding boundaries, added in chunks that do not align with the blocks
+    for (size_t size : { 55, 56, 63, 64, 65, 119, 120, 1000, 100'000 })
+    {
+        auto data = CreateData(size);
+
+        for (size_t chunkSize : { 1, 7, 64, 4096 })
+        {
+            INFO("Size: " << size << ", chunk size: " << chunkSize);
+            REQUIRE(HashInChunks(SHA256::Implementation::Hardware, data, chunkSize) == HashInChunks(SHA256::Implementation::Platform, data, chunkSize));
+        }
+    }
+}
+
+TEST_CASE("SHA256_HashAfterGetThrows", "[SHA256]")
+{
+    for (auto implementation : GetAvailableImplementations())
+    {
+        SHA256 hasher{ implementation };
+        hasher.Get();
+
+        REQUIRE_THROWS_HR(hasher.Get(), E_UNEXPECTED);
+    }
+}
+
+// Not run by default; use "[benchmark]" to run it, and "-benchout <file>" to write the results as JSON lines.
+TEST_CASE("SHA256_Benchmark", "[.][benchmark]")
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t bufferSize = 1024 * 1024;
+    constexpr size_t bufferCount = 256;
+    auto data = CreateData(bufferSize);
+
+    for (auto implementation : GetAvailableImplementations())
+    {
+        SHA256 hasher{ implementation };
+
+        auto start = Clock::now();
+
+        for (size_t i = 0; i < bufferCount; ++i)
+        {
+            hasher.Add(data);
+        }
+
+        hasher.Get();
+
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::string benchmark = implementation == SHA256::Implementation::Hardware ? "SHA256_Hardware"s : "SHA256_Platform"s;
+        TestCommon::BenchmarkResults::Record(benchmark, "throughput", (bufferSize * bufferCount) / (1024.0 * 1024.0) / seconds, "MB/s");
+    }
+}
+
+TEST_CASE("SHA256_ComputeHashFromFile", "[SHA256]")
+{
+    TestCommon::TempFile tempFile("sha256_test"s, ".bin"s);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    for (size_t size : { 0, 1, 100'000 })
+    {
+        auto data = CreateData(size);
+
+        {
+            std::ofstream stream{ tempFile.GetPath(), std::ios::binary | std::ios::trunc };
+            stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+        }
+
+        INFO("Size: " << size);
+        REQUIRE(SHA256::ComputeHashFromFile(tempFile.GetPath()) == SHA256::ComputeHash(data.data(), static_cast<uint32_t>(data.size())));
+    }
+}
+
+TEST_CASE("ChunkedSHA256_MatchesHashOfChunkHashes", "[SHA256]")
+{
+    TestCommon::TempFile tempFile("sha256_test"s, ".bin"s);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    constexpr size_t chunkSize = 64 * 1024;
+
+    for (size_t size : { size_t{ 0 }, size_t{ 1 }, chunkSize, 5 * chunkSize + 123 })
+    {
+        auto data = CreateData(size);
+
+        {
+            std::ofstream stream{ tempFile.GetPath(), std::ios::binary | std::ios::trunc };
+            stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+        }
+
+        SHA256 expected;
+        for (size_t offset = 0; offset < data.size(); offset += chunkSize)
+        {
+            expected.Add(SHA256::ComputeHash(data.data() + offset, static_cast<uint32_t>(std::min(chunkSize, data.size() - offset))));
+        }
+        auto expectedHash = expected.Get();
+
+        // Added in pieces that do not line up with the chunks
+        ChunkedSHA256 hasher{ chunkSize };
+        for (size_t offset = 0; offset < data.size(); offset += 1000)
+        {
+            hasher.Add(data.data() + offset, std::min<size_t>(1000, data.size() - offset));
+        }
+
+        INFO("Size: " << size);
+        REQUIRE(hasher.Get() == expectedHash);
+        REQUIRE(ChunkedSHA256::ComputeHashFromFile(tempFile.GetPath(), chunkSize) == expectedHash);
+    }
+}
+
+TEST_CASE("ChunkedSHA256_KeepsGivenChunkHashes", "[SHA256]")
+{
+    TestCommon::TempFile tempFile("sha256_test"s, ".bin"s);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    constexpr size_t chunkSize = 64 * 1024;
+    auto data = CreateData(3 * chunkSize);
+
+    {
+        std::ofstream stream{ tempFile.GetPath(), std::ios::binary | std::ios::trunc };
+        stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    // A chunk that is already hashed is not read again, so a made up hash for it is kept
+    SHA256::HashBuffer madeUp(32, 0xab);
+    std::vector<SHA256::HashBuffer> chunkHashes{ {}, madeUp };
+    ChunkedSHA256::ComputeMissingChunkHashesFromFile(tempFile.GetPath(), chunkSize, chunkHashes);
+
+    REQUIRE(chunkHashes.size() == 3);
+    REQUIRE(chunkHashes[0] == SHA256::ComputeHash(data.data(), static_cast<uint32_t>(chunkSize)));
+    REQUIRE(chunkHashes[1] == madeUp);
+    REQUIRE(chunkHashes[2] == SHA256::ComputeHash(data.data() + 2 * chunkSize, static_cast<uint32_t>(chunkSize)));
+
+    REQUIRE_THROWS_HR(ChunkedSHA256::CombineChunkHashes({ SHA256::HashBuffer(31) }), E_INVALIDARG);
+}
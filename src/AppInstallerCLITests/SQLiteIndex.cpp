@@ -4,8 +4,12 @@
 #include "TestCommon.h"
 #include <SQLiteWrapper.h>
 #include <Microsoft/SQLiteIndex.h>
+#include <Microsoft/SQLiteIndexProfile.h>
+#include <Microsoft/ParallelManifestParser.h>
 #include <winget/Manifest.h>
 
+#include <set>
+
 #include <Microsoft/Schema/1_0/IdTable.h>
 #include <Microsoft/Schema/1_0/NameTable.h>
 #include <Microsoft/Schema/1_0/MonikerTable.h>
@@ -16,6 +20,14 @@
 #include <Microsoft/Schema/1_0/TagsTable.h>
 #include <Microsoft/Schema/1_0/CommandsTable.h>
 #include <Microsoft/Schema/1_0/SearchResultsTable.h>
+#include <Microsoft/Schema/1_0/SearchSnapshot.h>
+
+#include <Microsoft/Schema/1_1/TrigramTable.h>
+#include <Microsoft/Schema/1_1/FullTextTable.h>
+
+#include <Microsoft/Schema/1_2/FuzzyValueTable.h>
+#include <Microsoft/Schema/1_2/ManifestKeyTable.h>
+#include <Microsoft/Schema/WildcardPattern.h>
 
 using namespace std::string_literals;
 using namespace TestCommon;
@@ -166,6 +178,359 @@ TEST_CASE("SQLiteIndexCreateAndAddManifestDuplicate", "[sqliteindex]")
     REQUIRE_THROWS_HR(index.AddManifest(manifest, relativePath), HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS));
 }
 
+TEST_CASE("SQLiteIndexCreateAndAddManifests", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    std::vector<std::pair<Manifest, std::filesystem::path>> manifests;
+
+    auto addManifest = [&](std::string_view id, std::string_view version, std::vector<NormalizedString> tags, std::string_view path)
+    {
+        Manifest manifest;
+        manifest.Id = id;
+        manifest.Name = "Shared Name";
+        manifest.AppMoniker = "shared";
+        manifest.Version = version;
+        manifest.Tags = std::move(tags);
+        manifest.Commands = { "command" };
+        manifests.emplace_back(std::move(manifest), path);
+    };
+
+    addManifest("Id1", "1.0", { "tag1", "shared" }, "Path1");
+    addManifest("Id1", "2.0", { "tag1", "shared" }, "Path2");
+    addManifest("Id2", "1.0", { "shared" }, "Path3");
+
+    {
+        SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version::Latest());
+        index.AddManifests(manifests);
+    }
+
+    SQLiteIndex index = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::ReadWrite);
+
+    SearchRequest request;
+    request.Inclusions.emplace_back(ApplicationMatchField::Tag, MatchType::Exact, "shared");
+    REQUIRE(index.Search(request).Matches.size() == 2);
+
+    auto versions = index.GetVersionsById(index.Search(request).Matches[0].first);
+    REQUIRE(!versions.empty());
+
+    // The indices are created again, allowing modification as usual.
+    index.RemoveManifest(manifests[2].first, manifests[2].second);
+    REQUIRE(index.Search(request).Matches.size() == 1);
+}
+
+TEST_CASE("SQLiteIndexCreateAndAddManifests_KeyOrder", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    TempFile sequentialFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << sequentialFile.GetPath());
+
+    std::vector<std::pair<Manifest, std::filesystem::path>> manifests;
+
+    auto addManifest = [&](std::string_view id, std::string_view name, std::string_view version, std::vector<NormalizedString> tags, std::string_view path)
+    {
+        Manifest manifest;
+        manifest.Id = id;
+        manifest.Name = name;
+        manifest.AppMoniker = "moniker";
+        manifest.Version = version;
+        manifest.Tags = std::move(tags);
+        manifest.Commands = { "command" };
+        manifests.emplace_back(std::move(manifest), path);
+    };
+
+    // Given out of the order of their keys
+    addManifest("Id2", "Name C", "1.0", { "zeta", "alpha" }, "Path1");
+    addManifest("Id1", "Name A", "2.0", { "alpha" }, "Path2");
+    addManifest("Id1", "Name B", "1.0", { "middle" }, "Path3");
+
+    {
+        SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version::Latest());
+        index.AddManifests(manifests);
+    }
+
+    {
+        SQLiteIndex index = SQLiteIndex::CreateNew(sequentialFile, Schema::Version::Latest());
+        for (const auto& manifest : manifests)
+        {
+            index.AddManifest(manifest.first, manifest.second);
+        }
+    }
+
+    {
+        // The rowids of the values follow their order
+        Connection connection = Connection::Create(tempFile, Connection::OpenDisposition::ReadWrite);
+
+        auto id1 = Schema::V1_0::IdTable::SelectIdByValue(connection, "Id1");
+        auto id2 = Schema::V1_0::IdTable::SelectIdByValue(connection, "Id2");
+        REQUIRE(id1);
+        REQUIRE(id2);
+        REQUIRE(id1.value() < id2.value());
+
+        auto nameA = Schema::V1_0::NameTable::SelectIdByValue(connection, "Name A");
+        auto nameB = Schema::V1_0::NameTable::SelectIdByValue(connection, "Name B");
+        auto nameC = Schema::V1_0::NameTable::SelectIdByValue(connection, "Name C");
+        REQUIRE(nameA);
+        REQUIRE(nameB);
+        REQUIRE(nameC);
+        REQUIRE(nameA.value() < nameB.value());
+        REQUIRE(nameB.value() < nameC.value());
+    }
+
+    // The index holds the same manifests as one built a manifest at a time
+    auto getSortedManifests = [](const std::string& filePath)
+    {
+        SQLiteIndex index = SQLiteIndex::Open(filePath, SQLiteIndex::OpenDisposition::ReadWrite);
+        auto result = index.GetAllManifests();
+        std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+        return result;
+    };
+
+    auto bulk = getSortedManifests(tempFile);
+    auto sequential = getSortedManifests(sequentialFile);
+    REQUIRE(bulk.size() == sequential.size());
+
+    for (size_t i = 0; i < bulk.size(); ++i)
+    {
+        REQUIRE(bulk[i].second == sequential[i].second);
+        REQUIRE(bulk[i].first.Name == sequential[i].first.Name);
+        REQUIRE(bulk[i].first.Version == sequential[i].first.Version);
+        REQUIRE(bulk[i].first.Tags == sequential[i].first.Tags);
+        REQUIRE(bulk[i].first.Commands == sequential[i].first.Commands);
+    }
+
+    SQLiteIndex index = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::ReadWrite);
+
+    SearchRequest request;
+    request.Inclusions.emplace_back(ApplicationMatchField::Tag, MatchType::Exact, "alpha");
+    REQUIRE(index.Search(request).Matches.size() == 2);
+}
+
+TEST_CASE("SQLiteIndexCreateAndAddManifestsDuplicate", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    Manifest manifest;
+    manifest.Id = "Id";
+    manifest.Name = "Name";
+    manifest.AppMoniker = "Moniker";
+    manifest.Version = "1.0";
+
+    std::vector<std::pair<Manifest, std::filesystem::path>> manifests;
+    manifests.emplace_back(manifest, "Path1");
+    manifests.emplace_back(manifest, "Path2");
+
+    SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version::Latest());
+    REQUIRE_THROWS_HR(index.AddManifests(manifests), HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS));
+
+    // None of the manifests were added.
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Exact, "Id");
+    REQUIRE(index.Search(request).Matches.empty());
+
+    index.AddManifest(manifest, "Path1");
+    REQUIRE(index.Search(request).Matches.size() == 1);
+}
+
+TEST_CASE("SQLiteIndexAddManifestAfterRemove", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    auto makeManifest = [](std::string_view id, std::string_view name)
+    {
+        Manifest manifest;
+        manifest.Id = id;
+        manifest.Name = name;
+        manifest.AppMoniker = name;
+        manifest.Version = "1.0";
+        manifest.Tags = { NormalizedString{ name } };
+        return manifest;
+    };
+
+    SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version::Latest());
+
+    // Values are cached by the index as they are added; the removal must not leave stale values behind,
+    // as the rowids of the removed values are reused by the next values added.
+    Manifest first = makeManifest("Id1", "Name1");
+    index.AddManifest(first, "Dir/Path1");
+    index.RemoveManifest(first, "Dir/Path1");
+
+    index.AddManifest(makeManifest("Id2", "Name2"), "Dir/Path2");
+    index.AddManifest(makeManifest("Id3", "Name1"), "Dir/Path1");
+
+    for (std::string_view name : { "Name1", "Name2" })
+    {
+        SearchRequest request;
+        request.Filters.emplace_back(ApplicationMatchField::Name, MatchType::Exact, name);
+        request.Filters.emplace_back(ApplicationMatchField::Tag, MatchType::Exact, name);
+
+        auto results = index.Search(request);
+        REQUIRE(results.Matches.size() == 1);
+        REQUIRE(index.GetNameStringById(results.Matches[0].first) == std::string{ name });
+    }
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Exact, "Id3");
+    auto results = index.Search(request);
+    REQUIRE(results.Matches.size() == 1);
+    REQUIRE(index.GetPathStringByKey(results.Matches[0].first, "1.0", "") == "Dir/Path1");
+}
+
+TEST_CASE("ParallelManifestParser_PreservesOrder", "[sqliteindex]")
+{
+    TestDataFile manifestFile{ "Manifest-Good.yaml" };
+
+    std::vector<std::pair<std::filesystem::path, std::filesystem::path>> manifestPaths;
+    for (size_t i = 0; i < 50; ++i)
+    {
+        manifestPaths.emplace_back(manifestFile, "Path" + std::to_string(i));
+    }
+
+    // Use fewer slots than threads so that the threads must wait for space.
+    ParallelManifestParser parser{ manifestPaths, 4, 2 };
+
+    for (const auto& paths : manifestPaths)
+    {
+        auto manifest = parser.Next();
+        REQUIRE(manifest);
+        REQUIRE(manifest->second == paths.second);
+        REQUIRE(manifest->first.Id == "microsoft.msixsdk");
+    }
+
+    REQUIRE(!parser.Next());
+}
+
+TEST_CASE("ParallelManifestParser_Error", "[sqliteindex]")
+{
+    TestDataFile goodFile{ "Manifest-Good.yaml" };
+    TestDataFile badFile{ "Manifest-Bad-IdMissing.yaml" };
+
+    ParallelManifestParser parser{ { { goodFile, "Good1" }, { badFile, "Bad" }, { goodFile, "Good2" } } };
+
+    REQUIRE(parser.Next()->second == "Good1");
+    REQUIRE_THROWS(parser.Next());
+    REQUIRE(parser.Next()->second == "Good2");
+    REQUIRE(!parser.Next());
+}
+
+TEST_CASE("ParallelManifestParser_Content", "[sqliteindex]")
+{
+    TestDataFile goodFile{ "Manifest-Good.yaml" };
+
+    std::ifstream goodStream{ goodFile.GetPath() };
+    std::string goodContent{ std::istreambuf_iterator<char>{ goodStream }, std::istreambuf_iterator<char>{} };
+
+    ParallelManifestParser parser{ std::vector<ParallelManifestParser::Input>{
+        { {}, goodContent, "Content" },
+        { {}, "Id: [ not a manifest"s, "Bad" },
+        { goodFile.GetPath(), std::nullopt, "File" },
+        } };
+
+    auto result = parser.NextResult();
+    REQUIRE(result);
+    REQUIRE(result->Index == 0);
+    REQUIRE(result->Parsed->Id == "microsoft.msixsdk");
+
+    result = parser.NextResult();
+    REQUIRE(result);
+    REQUIRE(result->Index == 1);
+    REQUIRE(!result->Parsed);
+    REQUIRE(result->Error);
+
+    result = parser.NextResult();
+    REQUIRE(result);
+    REQUIRE(result->Index == 2);
+    REQUIRE(result->Parsed->Id == "microsoft.msixsdk");
+
+    REQUIRE(!parser.NextResult());
+}
+
+TEST_CASE("SQLiteIndexCreateAndAddManifestsFiles", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    TestDataFile goodFile{ "Manifest-Good.yaml" };
+    TestDataFile badFile{ "Manifest-Bad-IdMissing.yaml" };
+
+    using ManifestPaths = std::vector<std::pair<std::filesystem::path, std::filesystem::path>>;
+
+    SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version::Latest());
+
+    // A single failure prevents any of the manifests from being added.
+    REQUIRE_THROWS(index.AddManifests(ManifestPaths{ { goodFile, "Path1" }, { badFile, "Path2" } }));
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Exact, "microsoft.msixsdk");
+    REQUIRE(index.Search(request).Matches.empty());
+
+    index.AddManifests(ManifestPaths{ { goodFile, "Path1" } });
+    REQUIRE(index.Search(request).Matches.size() == 1);
+}
+
+TEST_CASE("SQLiteIndex_ApplyManifestChanges", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    TestDataFile goodFile{ "Manifest-Good.yaml" };
+    TestDataFile badFile{ "Manifest-Bad-IdMissing.yaml" };
+
+    std::ifstream goodStream{ goodFile.GetPath() };
+    std::string goodContent{ std::istreambuf_iterator<char>{ goodStream }, std::istreambuf_iterator<char>{} };
+
+    using Change = SQLiteIndex::ManifestChange;
+    using Operation = Change::Operation;
+
+    SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version::Latest());
+
+    std::vector<std::tuple<size_t, HRESULT, bool>> results;
+    auto callback = [&](size_t i, HRESULT hr, bool modified) { results.emplace_back(i, hr, modified); };
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Exact, "microsoft.msixsdk");
+
+    // A change that fails does not prevent the others from being applied.
+    REQUIRE(index.ApplyManifestChanges({
+        { Operation::Add, badFile.GetPath(), std::nullopt, "Bad" },
+        { Operation::Add, goodFile.GetPath(), std::nullopt, "Path1" },
+        }, callback));
+
+    REQUIRE(results.size() == 2);
+    REQUIRE(std::get<0>(results[0]) == 0);
+    REQUIRE(FAILED(std::get<1>(results[0])));
+    REQUIRE(!std::get<2>(results[0]));
+    REQUIRE(std::get<0>(results[1]) == 1);
+    REQUIRE(std::get<1>(results[1]) == S_OK);
+    REQUIRE(std::get<2>(results[1]));
+    REQUIRE(index.Search(request).Matches.size() == 1);
+
+    // The manifests can be given as content rather than files.
+    results.clear();
+    REQUIRE(index.ApplyManifestChanges({
+        { Operation::Update, {}, goodContent, "Path1" },
+        { Operation::Remove, {}, goodContent, "Path1" },
+        }, callback));
+
+    REQUIRE(results.size() == 2);
+    REQUIRE(std::get<1>(results[0]) == S_OK);
+    REQUIRE(!std::get<2>(results[0]));
+    REQUIRE(std::get<1>(results[1]) == S_OK);
+    REQUIRE(std::get<2>(results[1]));
+    REQUIRE(index.Search(request).Matches.empty());
+
+    // Nothing is modified when every change fails.
+    results.clear();
+    REQUIRE(!index.ApplyManifestChanges({ { Operation::Remove, {}, goodContent, "Path1" } }, callback));
+    REQUIRE(results.size() == 1);
+    REQUIRE(FAILED(std::get<1>(results[0])));
+}
+
 TEST_CASE("SQLiteIndex_RemoveManifestFile_NotPresent", "[sqliteindex]")
 {
     SQLiteIndex index = SQLiteIndex::CreateNew(SQLITE_MEMORY_DB_CONNECTION_TARGET, Schema::Version::Latest());
@@ -248,6 +613,87 @@ TEST_CASE("SQLiteIndex_RemoveManifest", "[sqliteindex][V1_0]")
     REQUIRE(Schema::V1_0::CommandsTable::IsEmpty(connection));
 }
 
+TEST_CASE("SQLiteIndex_DeferUnusedValueRemoval", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    std::string manifest1Path = "test/id/test.id-1.0.0.yaml";
+    Manifest manifest1;
+    manifest1.Id = "test.id";
+    manifest1.Name = "Test Name";
+    manifest1.AppMoniker = "testmoniker";
+    manifest1.Version = "1.0.0";
+    manifest1.Channel = "test";
+    manifest1.Tags = { "t1", "t2" };
+    manifest1.Commands = { "test1", "test2" };
+
+    std::string manifest2Path = "test/woah/test.id-1.0.0.yaml";
+    Manifest manifest2;
+    manifest2.Id = "test.woah";
+    manifest2.Name = "Test Name WOAH";
+    manifest2.AppMoniker = "testmoniker";
+    manifest2.Version = "1.0.0";
+    manifest2.Channel = "test";
+    manifest2.Tags = {};
+    manifest2.Commands = { "test1", "test2", "test3" };
+
+    auto countPathParts = [](Connection& connection)
+    {
+        Statement count = Statement::Create(connection, "select count(*) from [pathparts]");
+        REQUIRE(count.Step());
+        return count.GetColumn<int>(0);
+    };
+
+    {
+        SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version::Latest());
+
+        index.AddManifest(manifest1, manifest1Path);
+        index.AddManifest(manifest2, manifest2Path);
+
+        index.SetDeferUnusedValueRemoval(true);
+
+        index.RemoveManifest(manifest1, manifest1Path);
+
+        manifest2.Name = "Test Name Updated";
+        manifest2.Commands = { "test1" };
+        REQUIRE(index.UpdateManifest(manifest2, "test/woah/new/test.woah-1.0.0.yaml"));
+
+        // The removed manifest is not found even though its values remain
+        SearchRequest request;
+        request.Query = RequestMatch(MatchType::Exact, "Test Name");
+        REQUIRE(index.Search(request).Matches.empty());
+    }
+
+    {
+        // Open it directly to directly test table state
+        Connection connection = Connection::Create(tempFile, Connection::OpenDisposition::ReadWrite);
+
+        REQUIRE(Schema::V1_0::IdTable::GetCount(connection) == 2);
+        REQUIRE(Schema::V1_0::NameTable::GetCount(connection) == 3);
+        REQUIRE(!Schema::V1_0::TagsTable::IsEmpty(connection));
+        REQUIRE(countPathParts(connection) == 7);
+    }
+
+    {
+        // The values left by an earlier use of the index are removed as well
+        SQLiteIndex index = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::ReadWrite);
+        index.RemoveUnusedValues();
+    }
+
+    Connection connection = Connection::Create(tempFile, Connection::OpenDisposition::ReadWrite);
+
+    REQUIRE(Schema::V1_0::IdTable::GetCount(connection) == 1);
+    REQUIRE(Schema::V1_0::NameTable::GetCount(connection) == 1);
+    REQUIRE(Schema::V1_0::MonikerTable::GetCount(connection) == 1);
+    REQUIRE(Schema::V1_0::TagsTable::IsEmpty(connection));
+    REQUIRE(countPathParts(connection) == 4);
+
+    Statement commands = Statement::Create(connection, "select count(*) from [commands]");
+    REQUIRE(commands.Step());
+    REQUIRE(commands.GetColumn<int>(0) == 1);
+}
+
 TEST_CASE("SQLiteIndex_RemoveManifestFile", "[sqliteindex][V1_0]")
 {
     TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
@@ -694,74 +1140,463 @@ TEST_CASE("SQLiteIndex_PrepareForPackaging", "[sqliteindex]")
 
     index.AddManifest(manifestFile, manifestPath);
 
+    REQUIRE(!index.GetIdFilter());
+
     index.PrepareForPackaging();
+
+    // The filter of ids holds the case folded id
+    auto idFilter = index.GetIdFilter();
+    REQUIRE(idFilter);
+    REQUIRE(idFilter->MayContain("microsoft.msixsdk"));
+
+    // Statistics for the query planner are gathered while packaging
+    Connection connection = Connection::Create(tempFile, Connection::OpenDisposition::ReadOnly);
+    Statement statistics = Statement::Create(connection, "select count(*) from [sqlite_stat1]");
+    REQUIRE(statistics.Step());
+    REQUIRE(statistics.GetColumn<int>(0) > 0);
+
+    // The file is rebuilt with the smaller page size used for packaged indexes
+    Statement pageSize = Statement::Create(connection, "pragma page_size");
+    REQUIRE(pageSize.Step());
+    REQUIRE(pageSize.GetColumn<int>(0) == 2048);
 }
 
-TEST_CASE("SQLiteIndex_Search_IdExactMatch", "[sqliteindex]")
+TEST_CASE("SQLiteIndex_PrewarmPageRanges", "[sqliteindex]")
 {
     TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
     INFO("Using temporary file named: " << tempFile.GetPath());
 
-    Manifest manifest;
-    std::string relativePath;
-    SQLiteIndex index = SimpleTestSetup(tempFile, manifest, relativePath);
-
-    SearchRequest request;
-    request.Query = RequestMatch(MatchType::Exact, manifest.Id);
+    {
+        SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version::Latest());
 
-    auto results = index.Search(request);
-    REQUIRE(results.Matches.size() == 1);
-    REQUIRE(results.Matches[0].second.Field == ApplicationMatchField::Id);
-    REQUIRE(results.Matches[0].second.Type == MatchType::Exact);
-    REQUIRE(results.Matches[0].second.Value == manifest.Id);
-}
+        TestDataFile manifestFile{ "Manifest-Good.yaml" };
+        index.AddManifest(manifestFile, std::filesystem::path{ "microsoft/msixsdk/microsoft.msixsdk-1.7.32.yaml" });
 
-TEST_CASE("SQLiteIndex_Search_MultipleMatch", "[sqliteindex]")
-{
-    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
-    INFO("Using temporary file named: " << tempFile.GetPath());
+        REQUIRE(!index.GetPrewarmPageRanges());
 
-    Manifest manifest;
-    std::string relativePath;
-    SQLiteIndex index = SimpleTestSetup(tempFile, manifest, relativePath);
+        // The whole file is prewarmed when no pages are recorded
+        SQLiteIndex::Prewarm(tempFile);
 
-    manifest.Version = "2.0.0";
-    index.AddManifest(manifest, relativePath + "2");
+        index.PrepareForPackaging();
 
-    SearchRequest request;
-    request.Query = RequestMatch(MatchType::Exact, manifest.Id);
+        SQLiteIndex::StorageStatistics storage = index.GetStorageStatistics();
+        auto ranges = index.GetPrewarmPageRanges();
 
-    auto results = index.Search(request);
-    REQUIRE(results.Matches.size() == 1);
+        // The pages can only be found with the dbstat virtual table
+        REQUIRE(ranges.has_value() == storage.HasObjectPages);
+        if (ranges)
+        {
+            REQUIRE(!ranges->empty());
+
+            int64_t previousEnd = 0;
+            int64_t pageCount = 0;
+            for (const auto& range : ranges.value())
+            {
+                // Ascending, within the file, and with adjacent pages merged
+                REQUIRE(range.First > previousEnd);
+                REQUIRE(range.Count > 0);
+                REQUIRE(range.First + range.Count - 1 <= storage.PageCount);
+                previousEnd = range.First + range.Count;
+                pageCount += range.Count;
+            }
+
+            // The paths of manifests are not read by searches
+            auto pathParts = std::find_if(storage.Objects.begin(), storage.Objects.end(), [](const auto& object) { return object.Name == "pathparts"; });
+            REQUIRE(pathParts != storage.Objects.end());
+            REQUIRE(pageCount <= storage.PageCount - pathParts->PageCount);
+        }
+    }
 
-    auto result = index.GetVersionsById(results.Matches[0].first);
-    REQUIRE(result.size() == 2);
+    // The recorded pages are prewarmed once the index is deployed
+    SQLiteIndex::Prewarm(tempFile);
 }
 
-TEST_CASE("SQLiteIndex_Search_NoMatch", "[sqliteindex]")
+TEST_CASE("SQLiteIndex_Facets", "[sqliteindex]")
 {
     TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
     INFO("Using temporary file named: " << tempFile.GetPath());
 
-    Manifest manifest;
-    std::string relativePath;
-    SQLiteIndex index = SimpleTestSetup(tempFile, manifest, relativePath);
+    SQLiteIndex index = SearchTestSetup(tempFile, {
+        { "Contoso.Editor", "Editor", "edit", "1.0", "", { "text", "tools" }, {}, "path1" },
+        { "Contoso.Editor", "Editor", "edit", "2.0", "", { "text" }, {}, "path2" },
+        { "contoso.Paint", "Paint", "paint", "1.0", "", { "image", "tools" }, {}, "path3" },
+        { "Fabrikam.Viewer", "Viewer", "view", "1.0", "", { "image" }, {}, "path4" },
+        { "Standalone", "Standalone", "alone", "1.0", "", {}, {}, "path5" },
+        });
 
-    SearchRequest request;
-    request.Query = RequestMatch(MatchType::Exact, "THIS DOES NOT MATCH ANYTHING!");
+    auto getIdStrings = [&](Schema::Facet facet, std::string_view value)
+    {
+        std::set<std::string> result;
+        for (auto id : index.GetIdsByFacet(facet, value))
+        {
+            result.emplace(index.GetIdStringById(id).value());
+        }
+        return result;
+    };
 
-    auto results = index.Search(request);
-    REQUIRE(results.Matches.size() == 0);
-}
+    auto requireFacets = [&]()
+    {
+        using Counts = std::vector<std::pair<std::string, size_t>>;
 
-TEST_CASE("SQLiteIndex_IdString", "[sqliteindex]")
-{
-    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
-    INFO("Using temporary file named: " << tempFile.GetPath());
+        // Each id is only counted once, no matter how many of its manifests have the tag
+        REQUIRE(index.GetFacetCounts(Schema::Facet::Tag) == Counts{ { "image", 2 }, { "text", 1 }, { "tools", 2 } });
+        REQUIRE(index.GetFacetCounts(Schema::Facet::Publisher) == Counts{ { "contoso", 2 }, { "fabrikam", 1 }, { "standalone", 1 } });
 
-    Manifest manifest;
-    std::string relativePath;
-    SQLiteIndex index = SimpleTestSetup(tempFile, manifest, relativePath);
+        REQUIRE(getIdStrings(Schema::Facet::Tag, "tools") == std::set<std::string>{ "Contoso.Editor", "contoso.Paint" });
+        REQUIRE(getIdStrings(Schema::Facet::Publisher, "contoso") == std::set<std::string>{ "Contoso.Editor", "contoso.Paint" });
+        REQUIRE(getIdStrings(Schema::Facet::Publisher, "standalone") == std::set<std::string>{ "Standalone" });
+        REQUIRE(index.GetIdsByFacet(Schema::Facet::Tag, "missing").empty());
+    };
+
+    // Gathered from the manifests before packaging, then read from the precomputed facets
+    requireFacets();
+    index.PrepareForPackaging();
+    requireFacets();
+}
+
+TEST_CASE("SQLiteIndex_WithoutRowIDTables", "[sqliteindex]")
+{
+    auto isWithoutRowID = [](Connection& connection, std::string_view table)
+    {
+        Statement select = Statement::Create(connection, "select [sql] from [sqlite_master] where [type] = 'table' and [name] = ?");
+        select.Bind(1, table);
+        REQUIRE(select.Step());
+        return select.GetColumn<std::string>(0).find("WITHOUT ROWID") != std::string::npos;
+    };
+
+    TestDataFile manifestFile{ "Manifest-Good.yaml" };
+    std::filesystem::path manifestPath{ "microsoft/msixsdk/microsoft.msixsdk-1.7.32.yaml" };
+
+    {
+        TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+        INFO("Using temporary file named: " << tempFile.GetPath());
+
+        {
+            SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version{ 1, 2 });
+            index.AddManifest(manifestFile, manifestPath);
+            index.PrepareForPackaging();
+
+            auto results = index.Search({});
+            REQUIRE(results.Matches.size() == 1);
+            REQUIRE(index.GetIdStringById(results.Matches[0].first) == "microsoft.msixsdk");
+        }
+
+        Connection connection = Connection::Create(tempFile, Connection::OpenDisposition::ReadOnly);
+        REQUIRE(isWithoutRowID(connection, "tags_map"));
+        REQUIRE(isWithoutRowID(connection, "commands_map"));
+        REQUIRE(isWithoutRowID(connection, "ids_folded"));
+        REQUIRE(isWithoutRowID(connection, "ids_deletes"));
+        // The value tables are referred to by rowid
+        REQUIRE(!isWithoutRowID(connection, "ids"));
+        REQUIRE(!isWithoutRowID(connection, "tags"));
+    }
+
+    {
+        // Released versions keep their layout
+        TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+        INFO("Using temporary file named: " << tempFile.GetPath());
+
+        {
+            SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version{ 1, 1 });
+            index.AddManifest(manifestFile, manifestPath);
+        }
+
+        Connection connection = Connection::Create(tempFile, Connection::OpenDisposition::ReadOnly);
+        REQUIRE(!isWithoutRowID(connection, "tags_map"));
+    }
+}
+
+TEST_CASE("SQLiteIndex_ManifestKeys", "[sqliteindex]")
+{
+    REQUIRE(Schema::V1_2::ManifestKeyTable::GetKey("Id", "1.0", "") == Schema::V1_2::ManifestKeyTable::GetKey("id", "1.0", ""));
+    REQUIRE(Schema::V1_2::ManifestKeyTable::GetKey("Id", "1.0", "") != Schema::V1_2::ManifestKeyTable::GetKey("Id1", ".0", ""));
+    REQUIRE(Schema::V1_2::ManifestKeyTable::GetKey("Id", "1.0", "") != Schema::V1_2::ManifestKeyTable::GetKey("Id", "1.0", "beta"));
+
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version{ 1, 2 });
+
+    Manifest manifest;
+    manifest.Id = "Test.Id";
+    manifest.Name = "Test Name";
+    manifest.AppMoniker = "testmoniker";
+    manifest.Version = "1.0.0";
+    manifest.Channel = "Beta";
+
+    index.AddManifest(manifest, "test/id/1.0.0.yaml");
+
+    Manifest otherVersion = manifest;
+    otherVersion.Version = "2.0.0";
+    index.AddManifest(otherVersion, "test/id/2.0.0.yaml");
+
+    // The existing manifest is found ignoring case
+    Manifest differentCase = manifest;
+    differentCase.Id = "TEST.ID";
+    differentCase.Channel = "beta";
+    REQUIRE_THROWS_HR(index.AddManifest(differentCase, "test/id/other.yaml"), HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS));
+
+    REQUIRE(index.UpdateManifest(differentCase, "test/id/1.0.0.yaml"));
+    REQUIRE(index.GetIdStringById(index.Search({}).Matches[0].first) == "TEST.ID");
+
+    index.RemoveManifest(differentCase, "test/id/1.0.0.yaml");
+    REQUIRE_THROWS_HR(index.UpdateManifest(manifest, "test/id/1.0.0.yaml"), E_NOT_SET);
+
+    // The remaining manifest is still found, and can be added again once removed
+    index.RemoveManifest(otherVersion, "test/id/2.0.0.yaml");
+    index.AddManifest(otherVersion, "test/id/2.0.0.yaml");
+
+    Connection connection = Connection::Create(tempFile, Connection::OpenDisposition::ReadOnly);
+    Statement count = Statement::Create(connection, "select count(*) from [manifest_keys]");
+    REQUIRE(count.Step());
+    REQUIRE(count.GetColumn<int>(0) == 1);
+}
+
+TEST_CASE("SQLiteIndex_MigrateTo", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    Schema::Version fromVersion = GENERATE(Schema::Version{ 1, 0 }, Schema::Version{ 1, 1 });
+
+    {
+        SQLiteIndex index = SearchTestSetup(tempFile, {
+            { "Id", "Name", "Moniker", "1.0.0", "", { "foot" }, { "com34" }, "Path1" },
+            { "Id", "Name", "Moniker", "2.0.0", "beta", { "floor" }, { "com3" }, "Path2" },
+            { "Other", "Other Name", "OtherMoniker", "1.0.0", "", { "foo" }, { "Command" }, "Path3" },
+            }, fromVersion);
+
+        index.MigrateTo(Schema::Version::Latest());
+        REQUIRE(index.GetVersion() == Schema::Version{ 1, 2 });
+    }
+
+    SQLiteIndex index = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::ReadWrite);
+    REQUIRE(index.GetVersion() == Schema::Version{ 1, 2 });
+
+    SearchRequest request;
+    request.Inclusions.emplace_back(ApplicationMatchField::Tag, MatchType::Exact, "floor");
+    auto results = index.Search(request);
+    REQUIRE(results.Matches.size() == 1);
+    REQUIRE(index.GetIdStringById(results.Matches[0].first) == "Id");
+    REQUIRE(index.GetPathStringByKey(results.Matches[0].first, "2.0.0", "beta") == "Path2");
+
+    // The existing manifests are found through their keys
+    Manifest manifest;
+    manifest.Id = "Other";
+    manifest.Name = "Other Name";
+    manifest.AppMoniker = "OtherMoniker";
+    manifest.Version = "1.0.0";
+    manifest.Tags = { "foo" };
+    manifest.Commands = { "Command" };
+    REQUIRE(!index.UpdateManifest(manifest, "Path3"));
+
+    index.RemoveManifest(manifest, "Path3");
+    request.Inclusions.clear();
+    request.Inclusions.emplace_back(ApplicationMatchField::Command, MatchType::Exact, "Command");
+    REQUIRE(index.Search(request).Matches.empty());
+
+    index.PrepareForPackaging();
+    REQUIRE(index.Search({}).Matches.size() == 1);
+
+    // Migrating to the current version does nothing; an earlier or another major version is not possible
+    index.MigrateTo(Schema::Version{ 1, 2 });
+    REQUIRE_THROWS_HR(index.MigrateTo(Schema::Version{ 1, 0 }), HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED));
+}
+
+TEST_CASE("SQLiteIndex_Profile", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version::Latest());
+
+    TestDataFile manifestFile{ "Manifest-Good.yaml" };
+    std::filesystem::path manifestPath{ "microsoft/msixsdk/microsoft.msixsdk-1.7.32.yaml" };
+    index.AddManifest(manifestFile, manifestPath);
+
+    TempFile corpusFile{ "repolibtest_corpus"s, ".txt"s };
+    {
+        std::ofstream corpus{ corpusFile.GetPath() };
+        corpus << "microsoft.msixsdk\r\n\nmsix\nnot found\n";
+    }
+
+    std::vector<std::string> searchCorpus = ReadSearchCorpus(corpusFile);
+    REQUIRE(searchCorpus == std::vector<std::string>{ "microsoft.msixsdk", "msix", "not found" });
+
+    IndexProfile profile = ProfileIndex(index, searchCorpus, 2);
+
+    REQUIRE(profile.Version == index.GetVersion());
+    REQUIRE(profile.Storage.PageSize > 0);
+    REQUIRE(profile.Storage.PageCount > 0);
+
+    // Every table is reported, whether or not the page counts are available
+    auto manifestTable = std::find_if(profile.Storage.Objects.begin(), profile.Storage.Objects.end(), [](const auto& object) { return object.Name == "manifest"; });
+    REQUIRE(manifestTable != profile.Storage.Objects.end());
+    REQUIRE(!manifestTable->IsIndex);
+    if (profile.Storage.HasObjectPages)
+    {
+        REQUIRE(manifestTable->PageCount > 0);
+    }
+
+    REQUIRE(profile.Searches.size() == GetProfiledMatchTypes().size());
+    for (const auto& search : profile.Searches)
+    {
+        INFO(MatchTypeToString(search.Type));
+        REQUIRE(search.SearchCount == 6);
+        REQUIRE(search.P50 <= search.P90);
+        REQUIRE(search.P90 <= search.P99);
+        REQUIRE(search.P99 <= search.Max);
+    }
+
+    REQUIRE(profile.Searches[0].Type == MatchType::Exact);
+    REQUIRE(profile.Searches[0].MatchCount >= 2);
+
+    std::string json = ConvertToJson(profile);
+    REQUIRE(json.find("\"Searches\"") != std::string::npos);
+    REQUIRE(json.find("\"manifest\"") != std::string::npos);
+}
+
+// Not run by default; use "[benchmark]" to run it.
+TEST_CASE("SQLiteIndex_Benchmark_PackagingStatistics", "[.][benchmark]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    TempFile withoutStatisticsFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary files named: " << tempFile.GetPath() << " and " << withoutStatisticsFile.GetPath());
+
+    constexpr size_t idCount = 5000;
+
+    {
+        SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version::Latest());
+
+        Manifest manifest;
+        for (size_t i = 0; i < idCount; ++i)
+        {
+            manifest.Id = "Publisher" + std::to_string(i % 500) + ".Application" + std::to_string(i);
+            manifest.Name = "Application Name " + std::to_string(i);
+            manifest.AppMoniker = "app" + std::to_string(i);
+            manifest.Channel = "";
+            manifest.Commands = { "command" + std::to_string(i % 1000) };
+
+            for (size_t v = 0; v <= i % 5; ++v)
+            {
+                manifest.Version = "1." + std::to_string(v);
+                manifest.Tags = { "tag" + std::to_string((i + v) % 2000), "tag" + std::to_string((i * 7 + v) % 2000), "tag" + std::to_string((i * 13 + v) % 2000) };
+
+                index.AddManifest(manifest, "path/" + std::to_string(i) + "/" + manifest.Version + ".yaml");
+            }
+        }
+
+        index.PrepareForPackaging();
+    }
+
+    std::filesystem::copy_file(tempFile.GetPath(), withoutStatisticsFile.GetPath(), std::filesystem::copy_options::overwrite_existing);
+
+    {
+        Connection connection = Connection::Create(withoutStatisticsFile, Connection::OpenDisposition::ReadWrite);
+        Statement removeStatistics = Statement::Create(connection, "delete from [sqlite_stat1]");
+        removeStatistics.Execute();
+    }
+
+    SQLiteIndex withStatistics = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::Immutable);
+    SQLiteIndex withoutStatistics = SQLiteIndex::Open(withoutStatisticsFile, SQLiteIndex::OpenDisposition::Immutable);
+
+    std::vector<SearchRequest> requests;
+    for (std::string_view value : { "app", "name 12", "tag1", "command9", "publisher4" })
+    {
+        SearchRequest& query = requests.emplace_back();
+        query.Query = RequestMatch(MatchType::Substring, value);
+
+        SearchRequest& tags = requests.emplace_back();
+        tags.Inclusions.emplace_back(ApplicationMatchField::Tag, MatchType::CaseInsensitive, value);
+    }
+
+    auto timeSearches = [&](SQLiteIndex& index)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (const SearchRequest& request : requests)
+        {
+            index.Search(request);
+        }
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    };
+
+    for (const SearchRequest& request : requests)
+    {
+        INFO(request.ToString());
+        REQUIRE(withStatistics.Search(request).Matches.size() == withoutStatistics.Search(request).Matches.size());
+    }
+
+    auto withTime = timeSearches(withStatistics);
+    auto withoutTime = timeSearches(withoutStatistics);
+
+    WARN("Searches with statistics: " << withTime.count() << "ms; without statistics: " << withoutTime.count() << "ms");
+}
+
+TEST_CASE("SQLiteIndex_Search_IdExactMatch", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    Manifest manifest;
+    std::string relativePath;
+    SQLiteIndex index = SimpleTestSetup(tempFile, manifest, relativePath);
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Exact, manifest.Id);
+
+    auto results = index.Search(request);
+    REQUIRE(results.Matches.size() == 1);
+    REQUIRE(results.Matches[0].second.Field == ApplicationMatchField::Id);
+    REQUIRE(results.Matches[0].second.Type == MatchType::Exact);
+    REQUIRE(results.Matches[0].second.Value == manifest.Id);
+}
+
+TEST_CASE("SQLiteIndex_Search_MultipleMatch", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    Manifest manifest;
+    std::string relativePath;
+    SQLiteIndex index = SimpleTestSetup(tempFile, manifest, relativePath);
+
+    manifest.Version = "2.0.0";
+    index.AddManifest(manifest, relativePath + "2");
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Exact, manifest.Id);
+
+    auto results = index.Search(request);
+    REQUIRE(results.Matches.size() == 1);
+
+    auto result = index.GetVersionsById(results.Matches[0].first);
+    REQUIRE(result.size() == 2);
+}
+
+TEST_CASE("SQLiteIndex_Search_NoMatch", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    Manifest manifest;
+    std::string relativePath;
+    SQLiteIndex index = SimpleTestSetup(tempFile, manifest, relativePath);
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Exact, "THIS DOES NOT MATCH ANYTHING!");
+
+    auto results = index.Search(request);
+    REQUIRE(results.Matches.size() == 0);
+}
+
+TEST_CASE("SQLiteIndex_IdString", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    Manifest manifest;
+    std::string relativePath;
+    SQLiteIndex index = SimpleTestSetup(tempFile, manifest, relativePath);
 
     SearchRequest request;
     request.Query = RequestMatch(MatchType::Exact, manifest.Id);
@@ -887,6 +1722,47 @@ TEST_CASE("SQLiteIndex_Search_VersionSorting", "[sqliteindex]")
     }
 }
 
+TEST_CASE("SQLiteIndex_GetApplicationSummaries", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SQLiteIndex index = SearchTestSetup(tempFile, {
+        { "Id1", "Old Name", "Moniker", "1.0.0", "", {}, {}, "Path1" },
+        { "Id1", "New Name", "Moniker", "2.0.0", "", {}, {}, "Path2" },
+        { "Id1", "Beta Name", "Moniker", "3.0.0", "beta", {}, {}, "Path3" },
+        { "Id2", "Other Name", "Moniker", "1.0.0", "", {}, {}, "Path4" },
+        });
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Exact, "Id1");
+    auto id1 = index.Search(request).Matches.at(0).first;
+    request.Query = RequestMatch(MatchType::Exact, "Id2");
+    auto id2 = index.Search(request).Matches.at(0).first;
+
+    // Unknown ids are skipped, and repeated ids only produce one summary.
+    auto summaries = index.GetApplicationSummaries({ id2, id1, 0xFFFF, id2 });
+    REQUIRE(summaries.size() == 2);
+
+    REQUIRE(summaries[0].Id == id2);
+    REQUIRE(summaries[0].IdString == "Id2");
+    REQUIRE(summaries[0].Name == "Other Name");
+    REQUIRE(summaries[0].Versions.size() == 1);
+
+    REQUIRE(summaries[1].Id == id1);
+    REQUIRE(summaries[1].IdString == index.GetIdStringById(id1));
+    REQUIRE(summaries[1].Name == index.GetNameStringById(id1));
+    REQUIRE(summaries[1].Name == "New Name");
+
+    auto versions = index.GetVersionsById(id1);
+    REQUIRE(summaries[1].Versions.size() == versions.size());
+    for (size_t i = 0; i < versions.size(); ++i)
+    {
+        INFO(i);
+        REQUIRE(summaries[1].Versions[i].ToString() == versions[i].ToString());
+    }
+}
+
 TEST_CASE("SQLiteIndex_PathString_VersionSorting", "[sqliteindex]")
 {
     TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
@@ -969,6 +1845,56 @@ TEST_CASE("SQLiteIndex_PathString_CaseInsensitive", "[sqliteindex]")
     REQUIRE(!result.has_value());
 }
 
+TEST_CASE("SQLiteIndex_PathStrings_MatchSingleLookup", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SQLiteIndex index = SearchTestSetup(tempFile, {
+        { "Id", "Name", "Moniker", "14.0.0", "", { "foot" }, { "com34" }, "Path1" },
+        { "Id", "Name", "Moniker", "16.0.0", "alpha", { "floor" }, { "com3" }, "Path2" },
+        { "Id", "Name", "Moniker", "13.2.0-BUGFIX", "", {}, { "Command" }, "Path3" },
+        { "Id", "Name", "Moniker", "13.2.0-bugfix", "beta", { "foo" }, { "com3" }, "Path4" },
+        { "Other", "Name", "Moniker", "14.0.0", "", { "foot" }, { "com34" }, "Path5" },
+        });
+
+    bool prepareForPackaging = GENERATE(false, true);
+    if (prepareForPackaging)
+    {
+        index.PrepareForPackaging();
+    }
+
+    SearchRequest request;
+    request.Filters.emplace_back(ApplicationMatchField::Id, MatchType::Exact, "Id");
+
+    auto results = index.Search(request);
+    REQUIRE(results.Matches.size() == 1);
+    SQLiteIndex::IdType id = results.Matches[0].first;
+
+    std::vector<VersionAndChannel> versions = {
+        { Version("16.0.0"), Channel("alpha") },
+        { Version("14.0.0"), Channel("") },
+        { Version(""), Channel("") },
+        { Version(""), Channel("alpha") },
+        { Version("13.2.0-BugFix"), Channel("") },
+        { Version("13.2.0-BugFix"), Channel("BETA") },
+        { Version("15.0.0"), Channel("") },
+        };
+
+    auto paths = index.GetPathStringsByKeys(id, versions);
+    REQUIRE(paths.size() == versions.size());
+
+    for (size_t i = 0; i < versions.size(); ++i)
+    {
+        INFO(versions[i].GetVersion().ToString() << '[' << versions[i].GetChannel().ToString() << ']');
+        REQUIRE(paths[i] == index.GetPathStringByKey(id, versions[i].GetVersion().ToString(), versions[i].GetChannel().ToString()));
+    }
+
+    REQUIRE(paths[0] == "Path2");
+    REQUIRE(paths[1] == "Path1");
+    REQUIRE(!paths[6].has_value());
+}
+
 TEST_CASE("SQLiteIndex_SearchResultsTableSearches", "[sqliteindex][V1_0]")
 {
     TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
@@ -993,6 +1919,9 @@ TEST_CASE("SQLiteIndex_SearchResultsTableSearches", "[sqliteindex][V1_0]")
             search.SearchOnField(field, match, value);
         }
     }
+
+    // The searches are compiled into a single statement that only runs when the results are read
+    (void)search.GetSearchResults();
 }
 
 TEST_CASE("SQLiteIndex_Search_EmptySearch", "[sqliteindex]")
@@ -1067,37 +1996,128 @@ TEST_CASE("SQLiteIndex_Search_ExactBeforeSubstring", "[sqliteindex]")
     REQUIRE(index.GetIdStringById(results.Matches[1].first) == "Id2");
 }
 
-TEST_CASE("SQLiteIndex_Search_SingleFilter", "[sqliteindex]")
+TEST_CASE("SQLiteIndex_Search_MatchScore", "[sqliteindex]")
 {
-    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
-    INFO("Using temporary file named: " << tempFile.GetPath());
-
-    SQLiteIndex index = SearchTestSetup(tempFile, {
-        { "Id", "Name", "Moniker", "Version", "Channel", { "Tag" }, { "Command" }, "Path1" },
-        { "Id2", "Na", "Moniker", "Version", "Channel", { "Tag" }, { "Command" }, "Path2" },
-        { "Id3", "No", "Moniker", "Version", "Channel", { "Tag" }, { "Command" }, "Path3" },
-        });
+    auto score = [](ApplicationMatchField field, MatchType type, std::string_view value, std::string_view requestValue)
+    {
+        return GetMatchScore(ApplicationMatchFilter{ field, type, value }, requestValue);
+    };
 
-    SearchRequest request;
-    request.Filters.emplace_back(ApplicationMatchField::Name, MatchType::Substring, "a");
+    // The match type, and then the field, come before everything else
+    REQUIRE(score(ApplicationMatchField::Tag, MatchType::Exact, "terminal.preview.tag", "terminal") > score(ApplicationMatchField::Id, MatchType::CaseInsensitive, "Terminal", "terminal"));
+    REQUIRE(score(ApplicationMatchField::Id, MatchType::Substring, "Contoso.Terminal.Preview", "terminal") > score(ApplicationMatchField::Name, MatchType::Substring, "Terminal", "terminal"));
 
-    auto results = index.Search(request);
-    REQUIRE(results.Matches.size() == 2);
+    // Then an earlier position, and then a smaller edit distance
+    REQUIRE(score(ApplicationMatchField::Id, MatchType::Substring, "Terminal.Preview", "terminal") > score(ApplicationMatchField::Id, MatchType::Substring, "Contoso.Terminal", "terminal"));
+    REQUIRE(score(ApplicationMatchField::Id, MatchType::Substring, "Contoso.Terminal", "terminal") > score(ApplicationMatchField::Id, MatchType::Substring, "Contoso.Terminal.Preview", "terminal"));
+    REQUIRE(score(ApplicationMatchField::Id, MatchType::Fuzzy, "Terminal", "termnal") > score(ApplicationMatchField::Id, MatchType::Fuzzy, "Trmnal", "terminal"));
 
-    request.Filters[0].Value = "e";
+    // Only the request values that search on the field of the match are scored
+    SearchRequest request;
+    request.Inclusions.emplace_back(ApplicationMatchField::Name, MatchType::Substring, "terminal");
+    ApplicationMatchFilter idMatch{ ApplicationMatchField::Id, MatchType::Substring, "Contoso.Terminal" };
+    REQUIRE(GetMatchScore(idMatch, request) == GetMatchScore(idMatch));
 
-    results = index.Search(request);
-    REQUIRE(results.Matches.size() == 1);
+    request.Query = RequestMatch(MatchType::Substring, "terminal");
+    REQUIRE(GetMatchScore(idMatch, request) == GetMatchScore(idMatch, "terminal"));
 }
 
-TEST_CASE("SQLiteIndex_Search_Multimatch", "[sqliteindex]")
+TEST_CASE("SQLiteIndex_Search_BestScoresKept", "[sqliteindex]")
 {
     TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
     INFO("Using temporary file named: " << tempFile.GetPath());
 
     SQLiteIndex index = SearchTestSetup(tempFile, {
-        { "Id1", "Name", "Moniker", "Version", "Channel", { "Tag" }, { "Command" }, "Path1" },
-        { "Id1", "Name1", "Moniker", "Version1", "Channel", { "Tag" }, { "Command" }, "Path2" },
+        { "Fabrikam.Terminal", "Name1", "Moniker1", "Version", "Channel", { "Tag" }, { "Command" }, "Path1" },
+        { "Contoso.Terminal.Preview", "Name2", "Moniker2", "Version", "Channel", { "Tag" }, { "Command" }, "Path2" },
+        { "Terminal", "Name3", "Moniker3", "Version", "Channel", { "Tag" }, { "Command" }, "Path3" },
+        });
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Substring, "terminal");
+
+    auto results = index.Search(request);
+    REQUIRE(results.Matches.size() == 3);
+    REQUIRE(!results.Truncated);
+    REQUIRE(index.GetIdStringById(results.Matches[0].first) == "Terminal");
+    REQUIRE(index.GetIdStringById(results.Matches[1].first) == "Contoso.Terminal.Preview");
+    REQUIRE(index.GetIdStringById(results.Matches[2].first) == "Fabrikam.Terminal");
+
+    // The results kept are the best scores, rather than the first found
+    request.MaximumResults = 2;
+    results = index.Search(request);
+    REQUIRE(results.Matches.size() == 2);
+    REQUIRE(results.Truncated);
+    REQUIRE(index.GetIdStringById(results.Matches[0].first) == "Terminal");
+    REQUIRE(index.GetIdStringById(results.Matches[1].first) == "Contoso.Terminal.Preview");
+}
+
+TEST_CASE("SQLiteIndex_SearchForIds", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SQLiteIndex index = SearchTestSetup(tempFile, {
+        { "Id1", "Name1", "Moniker1", "Version", "Channel", { "Tag" }, { "Command" }, "Path1" },
+        { "Id2", "Name2", "Moniker2", "Version", "Channel", { "Tag" }, { "Command" }, "Path2" },
+        { "Id3", "Name3", "Moniker3", "Version", "Channel", { "Tag" }, { "Command" }, "Path3" },
+        });
+
+    // The results are in the order requested, without the missing or repeated ids
+    auto results = index.SearchForIds({ "Id3", "Missing", "Id1", "Id3" });
+    REQUIRE(results.Matches.size() == 2);
+    REQUIRE(index.GetIdStringById(results.Matches[0].first) == "Id3");
+    REQUIRE(results.Matches[0].second.Field == ApplicationMatchField::Id);
+    REQUIRE(results.Matches[0].second.Type == MatchType::Exact);
+    REQUIRE(results.Matches[0].second.Value == "Id3");
+    REQUIRE(index.GetIdStringById(results.Matches[1].first) == "Id1");
+
+    // More ids than are found in a single statement
+    std::vector<std::string> ids;
+    for (size_t i = 0; i < 1200; ++i)
+    {
+        ids.emplace_back("Missing" + std::to_string(i));
+    }
+    ids.emplace_back("Id2");
+
+    results = index.SearchForIds(ids);
+    REQUIRE(results.Matches.size() == 1);
+    REQUIRE(index.GetIdStringById(results.Matches[0].first) == "Id2");
+
+    REQUIRE(index.SearchForIds({}).Matches.empty());
+}
+
+TEST_CASE("SQLiteIndex_Search_SingleFilter", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SQLiteIndex index = SearchTestSetup(tempFile, {
+        { "Id", "Name", "Moniker", "Version", "Channel", { "Tag" }, { "Command" }, "Path1" },
+        { "Id2", "Na", "Moniker", "Version", "Channel", { "Tag" }, { "Command" }, "Path2" },
+        { "Id3", "No", "Moniker", "Version", "Channel", { "Tag" }, { "Command" }, "Path3" },
+        });
+
+    SearchRequest request;
+    request.Filters.emplace_back(ApplicationMatchField::Name, MatchType::Substring, "a");
+
+    auto results = index.Search(request);
+    REQUIRE(results.Matches.size() == 2);
+
+    request.Filters[0].Value = "e";
+
+    results = index.Search(request);
+    REQUIRE(results.Matches.size() == 1);
+}
+
+TEST_CASE("SQLiteIndex_Search_Multimatch", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SQLiteIndex index = SearchTestSetup(tempFile, {
+        { "Id1", "Name", "Moniker", "Version", "Channel", { "Tag" }, { "Command" }, "Path1" },
+        { "Id1", "Name1", "Moniker", "Version1", "Channel", { "Tag" }, { "Command" }, "Path2" },
         { "Id2", "Name", "Moniker", "Version", "", { "Tag" }, { "Command" }, "Path3" },
         { "Id2", "Name", "Moniker", "Version", "Channel", { "Tag" }, { "Command" }, "Path4" },
         { "Id3", "Name", "Moniker", "Version1", "", { "Tag" }, { "Command" }, "Path5" },
@@ -1245,6 +2265,113 @@ TEST_CASE("SQLiteIndex_Search_MaximumResults_Greater", "[sqliteindex]")
     REQUIRE(!results.Truncated);
 }
 
+TEST_CASE("SQLiteIndex_Search_MaximumResults_SkipsLaterSearches", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    {
+        SQLiteIndex index = SearchTestSetup(tempFile, {
+            { "Id1", "Tool", "Moniker1", "1.0", "Channel", { "Tag" }, { "Command" }, "Path1" },
+            { "Id2", "tool", "Moniker2", "1.0", "Channel", { "Tag" }, { "Command" }, "Path2" },
+            { "Id3", "Tool Box", "Moniker3", "1.0", "Channel", { "Tag" }, { "Command" }, "Path3" },
+            { "Id4", "Power Tool", "Moniker4", "1.0", "Channel", { "Tag" }, { "Command" }, "Path4" },
+            });
+    }
+
+    auto check = [](SQLiteIndex& index)
+    {
+        SearchRequest request;
+        request.Query = RequestMatch(MatchType::Substring, "Tool");
+        auto allResults = index.Search(request);
+        REQUIRE(allResults.Matches.size() == 4);
+
+        // The limited results are the start of the full results, regardless of which searches were skipped.
+        for (size_t limit = 1; limit <= 4; ++limit)
+        {
+            request.MaximumResults = limit;
+            auto results = index.Search(request);
+
+            REQUIRE(results.Matches.size() == limit);
+            REQUIRE(results.Truncated == (limit < 4));
+
+            for (size_t i = 0; i < limit; ++i)
+            {
+                REQUIRE(results.Matches[i].first == allResults.Matches[i].first);
+                REQUIRE(results.Matches[i].second.Type == allResults.Matches[i].second.Type);
+                REQUIRE(results.Matches[i].second.Field == allResults.Matches[i].second.Field);
+            }
+        }
+
+        // A filter can remove early results, so the searches must all be run.
+        request.MaximumResults = 1;
+        request.Filters.emplace_back(ApplicationMatchField::Moniker, MatchType::Exact, "Moniker4");
+        auto filteredResults = index.Search(request);
+        REQUIRE(filteredResults.Matches.size() == 1);
+        REQUIRE(!filteredResults.Truncated);
+        REQUIRE(index.GetIdStringById(filteredResults.Matches[0].first) == "Id4");
+    };
+
+    SQLiteIndex index = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::Read);
+    check(index);
+
+    SQLiteIndex snapshotIndex = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::Immutable);
+    snapshotIndex.LoadSearchSnapshot();
+    check(snapshotIndex);
+}
+
+TEST_CASE("SQLiteIndex_Search_CompiledIntoSingleStatement", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    {
+        SQLiteIndex index = SearchTestSetup(tempFile, {
+            { "Id1", "Tool", "Moniker1", "1.0", "Channel", { "Tag" }, { "Command" }, "Path1" },
+            { "Id2", "tool", "Moniker2", "1.0", "Channel", { "Other" }, { "Command" }, "Path2" },
+            { "Id3", "Tool Box", "Moniker3", "1.0", "Channel", { "Tag" }, { "Command" }, "Path3" },
+            });
+    }
+
+    SQLiteIndex index = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::Read);
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Substring, "Tool");
+    request.Inclusions.emplace_back(ApplicationMatchField::Moniker, MatchType::Exact, "Moniker2");
+    request.Filters.emplace_back(ApplicationMatchField::Tag, MatchType::CaseInsensitive, "tag");
+    request.Filters.emplace_back(ApplicationMatchField::Command, MatchType::Exact, "Command");
+
+    // Discard anything collected before the search
+    LogStatementStatistics();
+
+    EnableStatementStatistics(true);
+    auto disable = wil::scope_exit([]() { EnableStatementStatistics(false); LogStatementStatistics(); });
+
+    auto results = index.Search(request);
+    auto statistics = GetStatementStatistics();
+
+    EnableStatementStatistics(false);
+
+    REQUIRE(results.Matches.size() == 2);
+
+    // The searches and filters are a single statement, and nothing is written
+    size_t searchStatementCount = 0;
+    for (const StatementStatistics& statement : statistics)
+    {
+        INFO(statement.SQL);
+        std::string sql = ToLower(statement.SQL);
+        bool isSearch = (sql.rfind("with", 0) == 0);
+        REQUIRE((isSearch || sql.rfind("select", 0) == 0));
+
+        if (isSearch)
+        {
+            searchStatementCount += statement.PrepareCount;
+        }
+    }
+
+    REQUIRE(searchStatementCount == 1);
+}
+
 TEST_CASE("SQLiteIndex_Search_QueryAndInclusion", "[sqliteindex]")
 {
     TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
@@ -1360,3 +2487,1057 @@ TEST_CASE("SQLiteIndex_Search_StartsWith", "[sqliteindex]")
     auto results = index.Search(request);
     REQUIRE(results.Matches.size() == 2);
 }
+
+TEST_CASE("SQLiteIndex_SearchSnapshot_RequiresImmutable", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    {
+        SQLiteIndex index = SearchTestSetup(tempFile, {
+            { "Id", "Name", "Moniker", "Version", "Channel", { "Tag" }, { "Command" }, "Path1" },
+            });
+
+        REQUIRE_THROWS_HR(index.LoadSearchSnapshot(), HRESULT_FROM_WIN32(ERROR_INVALID_STATE));
+    }
+
+    SQLiteIndex index = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::Read);
+    REQUIRE_THROWS_HR(index.LoadSearchSnapshot(), HRESULT_FROM_WIN32(ERROR_INVALID_STATE));
+}
+
+TEST_CASE("SQLiteIndex_SearchSnapshot_MatchesDatabase", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    {
+        SQLiteIndex index = SearchTestSetup(tempFile, {
+            { "Id1", "Name", "Moniker", "Version1", "Channel", { "Tag", "id3" }, { "Command" }, "Path1" },
+            { "Id1", "Name", "Moniker", "Version2", "Channel", { "Tag" }, { "Command" }, "Path2" },
+            { "Id2", "Nope", "id", "Version", "Channel", { "Tag2" }, { "Command1", "Command2" }, "Path3" },
+            { "Id3", "No", "Moniker3", "Version", "Channel", { }, { "Id" }, "Path4" },
+            { "NopeId", "id3", "Moniker", "Version", "Channel", { "ID3" }, { "Command" }, "Path5" },
+            { u8"\x41\x308wesomeApp", "HasUmlaut", "Moniker", "Version", "Channel", { "foot" }, { "com34" }, "Path6" },
+            });
+
+        index.PrepareForPackaging();
+    }
+
+    SQLiteIndex database = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::Read);
+    SQLiteIndex snapshot = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::Immutable);
+    snapshot.LoadSearchSnapshot();
+
+    std::vector<SearchRequest> requests;
+
+    for (MatchType match : { MatchType::Exact, MatchType::CaseInsensitive, MatchType::StartsWith, MatchType::Substring, MatchType::Wildcard })
+    {
+        for (std::string_view value : { "id", "Id1", "ID3", "Moniker", "nope", "command", u8"\xE4", "", "i*", "*D?", "*a*d*" })
+        {
+            SearchRequest& query = requests.emplace_back();
+            query.Query = RequestMatch(match, value);
+
+            SearchRequest& inclusion = requests.emplace_back();
+            inclusion.Inclusions.emplace_back(ApplicationMatchField::Id, match, value);
+            inclusion.Inclusions.emplace_back(ApplicationMatchField::Tag, match, value);
+
+            SearchRequest& filter = requests.emplace_back();
+            filter.Filters.emplace_back(ApplicationMatchField::Command, match, value);
+
+            SearchRequest& combined = requests.emplace_back();
+            combined.Query = RequestMatch(match, value);
+            combined.Filters.emplace_back(ApplicationMatchField::Moniker, MatchType::CaseInsensitive, "moniker");
+            combined.MaximumResults = 1;
+        }
+    }
+
+    // Ordering between results of the same search is unspecified, so compare them as sets.
+    auto toComparable = [](const Schema::ISQLiteIndex::SearchResult& result)
+    {
+        std::vector<std::tuple<SQLiteIndex::IdType, ApplicationMatchField, MatchType>> values;
+        for (const auto& match : result.Matches)
+        {
+            values.emplace_back(match.first, match.second.Field, match.second.Type);
+        }
+        std::sort(values.begin(), values.end());
+        return values;
+    };
+
+    for (const SearchRequest& request : requests)
+    {
+        INFO(request.ToString());
+
+        auto databaseResults = database.Search(request);
+        auto snapshotResults = snapshot.Search(request);
+
+        REQUIRE(databaseResults.Truncated == snapshotResults.Truncated);
+        REQUIRE(databaseResults.Matches.size() == snapshotResults.Matches.size());
+
+        if (request.MaximumResults == 0)
+        {
+            REQUIRE(toComparable(databaseResults) == toComparable(snapshotResults));
+        }
+    }
+}
+
+TEST_CASE("SQLiteIndex_SearchSnapshot_Shared", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    {
+        SQLiteIndex index = SearchTestSetup(tempFile, {
+            { "Id1", "Name", "Moniker", "Version1", "Channel", { "Tag" }, { "Command" }, "Path1" },
+            { "Id2", "Nope", "id", "Version", "Channel", { "Tag2" }, { "Command1", "Command2" }, "Path2" },
+            { "Id3", "No", "Moniker3", "Version", "Channel", { }, { "Id" }, "Path3" },
+            });
+
+        index.PrepareForPackaging();
+    }
+
+    // The temporary file name is unique, so no other process has a snapshot with the same name
+    std::string sharedName = "SQLiteIndex_SearchSnapshot_Shared_" + tempFile.GetPath().filename().u8string();
+
+    Connection connection = Connection::Create(tempFile, Connection::OpenDisposition::ReadOnly);
+    Schema::V1_0::SearchSnapshot local{ connection };
+    Schema::V1_0::SearchSnapshot first{ connection, sharedName };
+    Schema::V1_0::SearchSnapshot second{ connection, sharedName };
+
+    REQUIRE(!local.IsShared());
+    REQUIRE(first.IsShared());
+    REQUIRE(second.IsShared());
+    REQUIRE(local.GetManifestCount() == 3);
+    REQUIRE(second.GetManifestCount() == local.GetManifestCount());
+
+    auto search = [](const Schema::V1_0::SearchSnapshot& snapshot, ApplicationMatchField field, MatchType match, std::string_view value)
+    {
+        Schema::V1_0::SearchSnapshot::Results results{ snapshot };
+        results.SearchOnField(field, match, value);
+
+        std::vector<std::pair<SQLiteIndex::IdType, std::string>> values;
+        for (const auto& result : results.GetSearchResults().Matches)
+        {
+            values.emplace_back(result.first, result.second.Value);
+        }
+        std::sort(values.begin(), values.end());
+        return values;
+    };
+
+    for (auto field : { ApplicationMatchField::Id, ApplicationMatchField::Moniker, ApplicationMatchField::Command })
+    {
+        auto expected = search(local, field, MatchType::Substring, "id");
+        REQUIRE(search(second, field, MatchType::Substring, "id") == expected);
+    }
+
+    REQUIRE(search(second, ApplicationMatchField::Tag, MatchType::Exact, "Tag2").size() == 1);
+}
+
+TEST_CASE("SQLiteIndex_SearchResultsInMemory_MatchesCompiledStatement", "[sqliteindex]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    {
+        SQLiteIndex index = SearchTestSetup(tempFile, {
+            { "Id1", "Name", "Moniker", "Version1", "Channel", { "Tag", "id3" }, { "Command" }, "Path1" },
+            { "Id1", "Name", "Moniker", "Version2", "Channel", { "Tag" }, { "Command" }, "Path2" },
+            { "Id2", "Nope", "id", "Version", "Channel", { "Tag2" }, { "Command1", "Command2" }, "Path3" },
+            { "Id3", "No", "Moniker3", "Version", "Channel", { }, { "Id" }, "Path4" },
+            { "NopeId", "id3", "Moniker", "Version", "Channel", { "ID3" }, { "Command" }, "Path5" },
+            { "Contoso.Terminal", "Contoso Terminal", "term", "1.0", "", { "console", "shell" }, { "ct" }, "Path6" },
+            });
+
+        index.PrepareForPackaging();
+    }
+
+    // Read compiles each request into a single statement, while Immutable accumulates the results in memory.
+    SQLiteIndex compiled = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::Read);
+    SQLiteIndex inMemory = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::Immutable);
+
+    std::vector<SearchRequest> requests;
+
+    for (MatchType match : { MatchType::Exact, MatchType::CaseInsensitive, MatchType::StartsWith, MatchType::Substring, MatchType::FuzzySubstring, MatchType::Wildcard })
+    {
+        for (std::string_view value : { "id", "Id1", "ID3", "Moniker", "nope", "command", "term", "", "i*", "*D?", "*a*d*" })
+        {
+            SearchRequest& query = requests.emplace_back();
+            query.Query = RequestMatch(match, value);
+
+            SearchRequest& inclusion = requests.emplace_back();
+            inclusion.Inclusions.emplace_back(ApplicationMatchField::Id, match, value);
+            inclusion.Inclusions.emplace_back(ApplicationMatchField::Tag, match, value);
+
+            SearchRequest& filter = requests.emplace_back();
+            filter.Filters.emplace_back(ApplicationMatchField::Command, match, value);
+
+            SearchRequest& filters = requests.emplace_back();
+            filters.Query = RequestMatch(match, value);
+            filters.Filters.emplace_back(ApplicationMatchField::Moniker, MatchType::StartsWith, "mon");
+            filters.Filters.emplace_back(ApplicationMatchField::Tag, MatchType::CaseInsensitive, "tag");
+
+            SearchRequest& limited = requests.emplace_back();
+            limited.Query = RequestMatch(match, value);
+            limited.MaximumResults = 1;
+        }
+    }
+
+    // Ordering between results of the same search is unspecified, so compare them as sets.
+    auto toComparable = [](const Schema::ISQLiteIndex::SearchResult& result)
+    {
+        std::vector<std::tuple<SQLiteIndex::IdType, ApplicationMatchField, MatchType>> values;
+        for (const auto& match : result.Matches)
+        {
+            values.emplace_back(match.first, match.second.Field, match.second.Type);
+        }
+        std::sort(values.begin(), values.end());
+        return values;
+    };
+
+    for (const SearchRequest& request : requests)
+    {
+        INFO(request.ToString());
+
+        auto compiledResults = compiled.Search(request);
+        auto inMemoryResults = inMemory.Search(request);
+
+        REQUIRE(compiledResults.Truncated == inMemoryResults.Truncated);
+        REQUIRE(compiledResults.Matches.size() == inMemoryResults.Matches.size());
+
+        if (request.MaximumResults == 0)
+        {
+            REQUIRE(toComparable(compiledResults) == toComparable(inMemoryResults));
+        }
+    }
+}
+
+TEST_CASE("SQLiteIndex_V1_1_GetTrigrams", "[sqliteindex][V1_1]")
+{
+    REQUIRE(Schema::V1_1::GetTrigrams("").empty());
+    REQUIRE(Schema::V1_1::GetTrigrams("ab").empty());
+    REQUIRE(Schema::V1_1::GetTrigrams("abc").size() == 1);
+    REQUIRE(Schema::V1_1::GetTrigrams("abcd").size() == 2);
+
+    // Case folded and distinct
+    REQUIRE(Schema::V1_1::GetTrigrams("ABC") == Schema::V1_1::GetTrigrams("abc"));
+    REQUIRE(Schema::V1_1::GetTrigrams("aaaaaa").size() == 1);
+}
+
+TEST_CASE("SQLiteIndex_V1_1_SubstringMatchesV1_0", "[sqliteindex][V1_1]")
+{
+    std::initializer_list<IndexFields> data = {
+        { "Microsoft.WindowsTerminal", "Windows Terminal", "terminal", "1.0", "", { "console", "shell" }, { "wt" }, "Path1" },
+        { "Microsoft.PowerShell", "PowerShell", "pwsh", "7.0", "", { "Shell", "Console" }, { "pwsh" }, "Path2" },
+        { "Contoso.Terminator", "The Terminator", "", "2.0", "", { "Terminal" }, { "term" }, "Path3" },
+        { u8"\x41\x308wesomeApp", "HasUmlaut", "Moniker", "Version", "Channel", { "foot" }, { "com34" }, "Path4" },
+        };
+
+    TempFile tempFile1_0{ "repolibtest_tempdb"s, ".db"s };
+    TempFile tempFile1_1{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary files named: " << tempFile1_0.GetPath() << " and " << tempFile1_1.GetPath());
+
+    {
+        SQLiteIndex index1_0 = SearchTestSetup(tempFile1_0, data, { 1, 0 });
+        index1_0.PrepareForPackaging();
+
+        SQLiteIndex index1_1 = SearchTestSetup(tempFile1_1, data, { 1, 1 });
+        REQUIRE(index1_1.GetVersion() == Schema::Version{ 1, 1 });
+        index1_1.PrepareForPackaging();
+    }
+
+    SQLiteIndex index1_0 = SQLiteIndex::Open(tempFile1_0, SQLiteIndex::OpenDisposition::Immutable);
+    SQLiteIndex index1_1 = SQLiteIndex::Open(tempFile1_1, SQLiteIndex::OpenDisposition::Immutable);
+
+    for (std::string_view value : { "term", "TERMINAL", "shell", "soft.", "nothing", "wt", u8"\xE4wes", "" })
+    {
+        INFO(value);
+
+        SearchRequest request;
+        request.Query = RequestMatch(MatchType::Substring, value);
+
+        auto getIds = [&](SQLiteIndex& index)
+        {
+            std::vector<std::string> ids;
+            for (const auto& match : index.Search(request).Matches)
+            {
+                ids.emplace_back(index.GetIdStringById(match.first).value());
+            }
+            std::sort(ids.begin(), ids.end());
+            return ids;
+        };
+
+        REQUIRE(getIds(index1_0) == getIds(index1_1));
+    }
+}
+
+TEST_CASE("SQLiteIndex_V1_1_ModifyAfterPackaging", "[sqliteindex][V1_1]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SQLiteIndex index = SearchTestSetup(tempFile, {
+        { "Id1", "Name", "Moniker", "Version", "Channel", { "Tag" }, { "Command" }, "Path1" },
+        }, { 1, 1 });
+
+    index.PrepareForPackaging();
+
+    Manifest manifest;
+    manifest.Id = "Id2";
+    manifest.Name = "Another";
+    manifest.AppMoniker = "Moniker2";
+    manifest.Version = "Version";
+    manifest.Channel = "Channel";
+    index.AddManifest(manifest, "Path2");
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Substring, "other");
+
+    // The trigrams no longer reflect the index, so the search must not rely on them.
+    auto results = index.Search(request);
+    REQUIRE(results.Matches.size() == 1);
+    REQUIRE(index.GetIdStringById(results.Matches[0].first) == "Id2");
+}
+
+TEST_CASE("SQLiteIndex_V1_1_BuildFullTextQuery", "[sqliteindex][V1_1]")
+{
+    REQUIRE(Schema::V1_1::BuildFullTextQuery(ApplicationMatchField::Name, "").empty());
+    REQUIRE(Schema::V1_1::BuildFullTextQuery(ApplicationMatchField::Name, "  \t ").empty());
+    REQUIRE(Schema::V1_1::BuildFullTextQuery(ApplicationMatchField::Name, "term") == R"(name : "term"*)");
+    REQUIRE(Schema::V1_1::BuildFullTextQuery(ApplicationMatchField::Tag, " windows  term ") == R"(tag : "windows"* AND tag : "term"*)");
+    REQUIRE(Schema::V1_1::BuildFullTextQuery(ApplicationMatchField::Id, R"(a"b OR)") == R"(id : "a""b"* AND id : "OR"*)");
+}
+
+TEST_CASE("SQLiteIndex_V1_1_FuzzySubstring", "[sqliteindex][V1_1]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    {
+        SQLiteIndex index = SearchTestSetup(tempFile, {
+            { "Microsoft.WindowsTerminal", "Windows Terminal", "terminal", "1.0", "", { "console", "shell" }, { "wt" }, "Path1" },
+            { "Microsoft.PowerShell", "PowerShell", "pwsh", "7.0", "", { "Shell", "Console" }, { "pwsh" }, "Path2" },
+            }, { 1, 1 });
+
+        index.PrepareForPackaging();
+    }
+
+    SQLiteIndex index = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::Immutable);
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::FuzzySubstring, "TERMINAL wind");
+
+    // Substring is searched first, and finds nothing; the rest can only come from the full text table, if FTS5 is available.
+    auto results = index.Search(request);
+    REQUIRE(results.Matches.size() <= 1);
+
+    if (!results.Matches.empty())
+    {
+        REQUIRE(index.GetIdStringById(results.Matches[0].first) == "Microsoft.WindowsTerminal");
+        REQUIRE(results.Matches[0].second.Field == ApplicationMatchField::Name);
+        REQUIRE(results.Matches[0].second.Type == MatchType::FuzzySubstring);
+        REQUIRE(results.Matches[0].second.Value == "TERMINAL wind");
+    }
+
+    // A substring match still takes precedence.
+    request.Query = RequestMatch(MatchType::FuzzySubstring, "shell");
+    results = index.Search(request);
+    REQUIRE(results.Matches.size() == 2);
+    for (const auto& match : results.Matches)
+    {
+        REQUIRE(match.second.Type == MatchType::Substring);
+    }
+}
+
+TEST_CASE("SQLiteIndex_V1_2_LatestMatchesV1_1", "[sqliteindex][V1_2]")
+{
+    std::initializer_list<IndexFields> data = {
+        { "Id", "Name 14", "Moniker", "14.0.0", "", {}, {}, "Path1" },
+        { "Id", "Name 16 alpha", "Moniker", "16.0.0", "alpha", {}, {}, "Path2" },
+        { "Id", "Name 15", "Moniker", "15.0.0", "", {}, {}, "Path3" },
+        { "Id", "Name 13.2", "Moniker", "13.2.0", "", {}, {}, "Path4" },
+        { "Id", "Name 15.1 beta", "Moniker", "15.1.0", "beta", {}, {}, "Path5" },
+        { "Id", "Name 15.8 alpha", "Moniker", "15.8.0", "alpha", {}, {}, "Path6" },
+        { "Id", "Name 13.2 bugfix", "Moniker", "13.2.0-bugfix", "", {}, {}, "Path7" },
+        { "Other", "Other 1.10", "Moniker", "1.10", "beta", {}, {}, "Path8" },
+        { "Other", "Other 1.9", "Moniker", "1.9", "beta", {}, {}, "Path9" },
+        };
+
+    TempFile tempFile1_1{ "repolibtest_tempdb"s, ".db"s };
+    TempFile tempFile1_2{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary files named: " << tempFile1_1.GetPath() << " and " << tempFile1_2.GetPath());
+
+    {
+        SQLiteIndex index1_1 = SearchTestSetup(tempFile1_1, data, { 1, 1 });
+        index1_1.PrepareForPackaging();
+
+        SQLiteIndex index1_2 = SearchTestSetup(tempFile1_2, data, { 1, 2 });
+        REQUIRE(index1_2.GetVersion() == Schema::Version{ 1, 2 });
+        index1_2.PrepareForPackaging();
+    }
+
+    SQLiteIndex index1_1 = SQLiteIndex::Open(tempFile1_1, SQLiteIndex::OpenDisposition::Immutable);
+    SQLiteIndex index1_2 = SQLiteIndex::Open(tempFile1_2, SQLiteIndex::OpenDisposition::Immutable);
+
+    for (std::string_view id : { "Id", "Other" })
+    {
+        INFO(id);
+
+        SearchRequest request;
+        request.Query = RequestMatch(MatchType::Exact, id);
+
+        auto id1_1 = index1_1.Search(request).Matches.at(0).first;
+        auto id1_2 = index1_2.Search(request).Matches.at(0).first;
+
+        REQUIRE(index1_1.GetNameStringById(id1_1) == index1_2.GetNameStringById(id1_2));
+
+        for (std::string_view channel : { "", "alpha", "beta", "gamma" })
+        {
+            INFO(channel);
+            REQUIRE(index1_1.GetPathStringByKey(id1_1, "", channel) == index1_2.GetPathStringByKey(id1_2, "", channel));
+        }
+
+        auto versions1_1 = index1_1.GetVersionsById(id1_1);
+        auto versions1_2 = index1_2.GetVersionsById(id1_2);
+        REQUIRE(versions1_1.size() == versions1_2.size());
+
+        for (size_t i = 0; i < versions1_1.size(); ++i)
+        {
+            INFO(i);
+            REQUIRE(versions1_1[i].ToString() == versions1_2[i].ToString());
+        }
+    }
+}
+
+TEST_CASE("SQLiteIndex_V1_2_VersionQueryMatchesV1_1", "[sqliteindex][V1_2]")
+{
+    std::initializer_list<IndexFields> data = {
+        { "Id", "Name 14", "Moniker", "14.0.0", "", {}, {}, "Path1" },
+        { "Id", "Name 16 alpha", "Moniker", "16.0.0", "alpha", {}, {}, "Path2" },
+        { "Id", "Name 15", "Moniker", "15.0.0", "", {}, {}, "Path3" },
+        { "Id", "Name 13.2", "Moniker", "13.2.0", "", {}, {}, "Path4" },
+        { "Id", "Name 15.1 beta", "Moniker", "15.1.0", "beta", {}, {}, "Path5" },
+        { "Id", "Name 15.8 alpha", "Moniker", "15.8.0", "alpha", {}, {}, "Path6" },
+        { "Id", "Name 13.2 bugfix", "Moniker", "13.2.0-bugfix", "", {}, {}, "Path7" },
+        { "Other", "Other 1.10", "Moniker", "1.10", "beta", {}, {}, "Path8" },
+        { "Other", "Other 1.9", "Moniker", "1.9", "beta", {}, {}, "Path9" },
+        };
+
+    TempFile tempFile1_1{ "repolibtest_tempdb"s, ".db"s };
+    TempFile tempFile1_2{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary files named: " << tempFile1_1.GetPath() << " and " << tempFile1_2.GetPath());
+
+    {
+        SQLiteIndex index1_1 = SearchTestSetup(tempFile1_1, data, { 1, 1 });
+        index1_1.PrepareForPackaging();
+
+        SQLiteIndex index1_2 = SearchTestSetup(tempFile1_2, data, { 1, 2 });
+        index1_2.PrepareForPackaging();
+    }
+
+    SQLiteIndex index1_1 = SQLiteIndex::Open(tempFile1_1, SQLiteIndex::OpenDisposition::Immutable);
+    SQLiteIndex index1_2 = SQLiteIndex::Open(tempFile1_2, SQLiteIndex::OpenDisposition::Immutable);
+
+    std::vector<SQLiteIndex::IdType> ids1_1;
+    std::vector<SQLiteIndex::IdType> ids1_2;
+    for (std::string_view id : { "Other", "Id" })
+    {
+        SearchRequest request;
+        request.Query = RequestMatch(MatchType::Exact, id);
+        ids1_1.emplace_back(index1_1.Search(request).Matches.at(0).first);
+        ids1_2.emplace_back(index1_2.Search(request).Matches.at(0).first);
+    }
+
+    auto toStrings = [](const std::vector<std::vector<VersionAndChannel>>& versionsByIds)
+    {
+        std::vector<std::vector<std::string>> result;
+        for (const auto& versions : versionsByIds)
+        {
+            auto& strings = result.emplace_back();
+            for (const auto& version : versions)
+            {
+                strings.emplace_back(version.ToString());
+            }
+        }
+        return result;
+    };
+
+    auto check = [&](const VersionQuery& query, const std::vector<std::vector<std::string>>& expected)
+    {
+        INFO(query.Prefix << " " << query.Offset << " " << query.Limit);
+        REQUIRE(toStrings(index1_1.GetVersionsByIds(ids1_1, query)) == expected);
+        REQUIRE(toStrings(index1_2.GetVersionsByIds(ids1_2, query)) == expected);
+    };
+
+    // With no limit, every version is given in the order of GetVersionsById
+    std::vector<std::vector<VersionAndChannel>> all{ index1_2.GetVersionsById(ids1_2[0]), index1_2.GetVersionsById(ids1_2[1]) };
+    check({}, toStrings(all));
+
+    // The limit and offset apply to each id separately
+    VersionQuery query;
+    query.Limit = 1;
+    check(query, { { toStrings(all)[0][0] }, { toStrings(all)[1][0] } });
+
+    query.Offset = 1;
+    query.Limit = 2;
+    check(query, { { toStrings(all)[0][1] }, { toStrings(all)[1][1], toStrings(all)[1][2] } });
+
+    query = {};
+    query.Offset = 10;
+    check(query, { {}, {} });
+
+    // The prefix is matched on the version string, ignoring case, with no wildcards
+    query = {};
+    query.Prefix = "1.1";
+    check(query, { { "1.10[beta]" }, {} });
+
+    query.Prefix = "13.2.0-BUG";
+    check(query, { {}, { "13.2.0-bugfix" } });
+
+    query.Prefix = "13_2";
+    check(query, { {}, {} });
+
+    query.Prefix = "15";
+    check(query, toStrings({ {}, VersionQuery{ "15" }.Apply(all[1]) }));
+    REQUIRE(VersionQuery{ "15" }.Apply(all[1]).size() == 3);
+}
+
+TEST_CASE("SQLiteIndex_V1_2_ModifyAfterPackaging", "[sqliteindex][V1_2]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SQLiteIndex index = SearchTestSetup(tempFile, {
+        { "Id1", "Name", "Moniker", "1.0", "", { "Tag" }, { "Command" }, "Path1" },
+        }, { 1, 2 });
+
+    index.PrepareForPackaging();
+
+    Manifest manifest;
+    manifest.Id = "Id1";
+    manifest.Name = "Newer";
+    manifest.AppMoniker = "Moniker";
+    manifest.Version = "2.0";
+    index.AddManifest(manifest, "Path2");
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Exact, "Id1");
+
+    // The latest manifests no longer reflect the index, so the lookups must not rely on them.
+    auto results = index.Search(request);
+    REQUIRE(results.Matches.size() == 1);
+    REQUIRE(index.GetNameStringById(results.Matches[0].first) == "Newer");
+
+    auto versions = index.GetVersionsById(results.Matches[0].first);
+    REQUIRE(versions.size() == 2);
+    REQUIRE(versions[0].GetVersion().ToString() == "2.0");
+
+    REQUIRE(index.GetPathStringByKey(results.Matches[0].first, "2.0", "") == "Path2");
+    REQUIRE(index.GetPathStringByKey(results.Matches[0].first, "", "") == "Path2");
+}
+
+TEST_CASE("SQLiteIndex_V1_2_PathsMatchV1_1", "[sqliteindex][V1_2]")
+{
+    std::initializer_list<IndexFields> data = {
+        { "Id1", "Name", "Moniker", "1.0", "", {}, {}, "manifests/i/Id1/1.0.yaml" },
+        { "Id1", "Name", "Moniker", "2.0", "", {}, {}, "manifests/i/Id1/2.0.yaml" },
+        { "Id1", "Name", "Moniker", "2.0", "beta", {}, {}, "manifests/i/Id1/beta/2.0.yaml" },
+        { "Id2", "Name", "Moniker", "1.0", "", {}, {}, "Root.yaml" },
+        };
+
+    TempFile tempFile1_1{ "repolibtest_tempdb"s, ".db"s };
+    TempFile tempFile1_2{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary files named: " << tempFile1_1.GetPath() << " and " << tempFile1_2.GetPath());
+
+    {
+        SQLiteIndex index1_1 = SearchTestSetup(tempFile1_1, data, { 1, 1 });
+        index1_1.PrepareForPackaging();
+
+        SQLiteIndex index1_2 = SearchTestSetup(tempFile1_2, data, { 1, 2 });
+        index1_2.PrepareForPackaging();
+    }
+
+    SQLiteIndex index1_1 = SQLiteIndex::Open(tempFile1_1, SQLiteIndex::OpenDisposition::Immutable);
+    SQLiteIndex index1_2 = SQLiteIndex::Open(tempFile1_2, SQLiteIndex::OpenDisposition::Immutable);
+
+    for (std::string_view id : { "Id1", "Id2" })
+    {
+        INFO(id);
+
+        SearchRequest request;
+        request.Query = RequestMatch(MatchType::Exact, id);
+
+        auto id1_1 = index1_1.Search(request).Matches.at(0).first;
+        auto id1_2 = index1_2.Search(request).Matches.at(0).first;
+
+        for (std::string_view version : { "", "1.0", "2.0", "3.0" })
+        {
+            for (std::string_view channel : { "", "beta" })
+            {
+                INFO(version << " " << channel);
+                REQUIRE(index1_1.GetPathStringByKey(id1_1, version, channel) == index1_2.GetPathStringByKey(id1_2, version, channel));
+            }
+        }
+    }
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Exact, "Id1");
+    REQUIRE(index1_2.GetPathStringByKey(index1_2.Search(request).Matches.at(0).first, "2.0", "beta") == "manifests/i/Id1/beta/2.0.yaml");
+}
+
+TEST_CASE("SQLiteIndex_V1_2_CatalogSummary", "[sqliteindex][V1_2]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    {
+        SQLiteIndex index = SearchTestSetup(tempFile, {
+            { "beta.id", "Beta", "Moniker", "1.0", "", {}, {}, "Path1" },
+            { "Alpha.Id", "Alpha Old", "Moniker", "1.0", "", {}, {}, "Path2" },
+            { "Alpha.Id", "Alpha New", "Moniker", "2.0", "", {}, {}, "Path3" },
+            { "Gamma.Id", "Gamma", "Moniker", "1.0", "", {}, {}, "Path4" },
+            }, { 1, 2 });
+
+        index.PrepareForPackaging();
+    }
+
+    SQLiteIndex index = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::Immutable);
+
+    // The catalog is listed in id order, regardless of case, with the summaries of every id
+    SearchRequest request;
+    auto results = index.Search(request);
+    REQUIRE(results.Matches.size() == 3);
+    REQUIRE(!results.Truncated);
+    REQUIRE(results.Summaries.size() == 3);
+
+    std::vector<SQLiteIndex::IdType> ids;
+    for (const auto& match : results.Matches)
+    {
+        ids.push_back(match.first);
+    }
+
+    auto summaries = index.GetApplicationSummaries(ids);
+    REQUIRE(summaries.size() == 3);
+
+    for (size_t i = 0; i < summaries.size(); ++i)
+    {
+        INFO(i);
+        REQUIRE(results.Summaries[i].Id == summaries[i].Id);
+        REQUIRE(results.Summaries[i].IdString == summaries[i].IdString);
+        REQUIRE(results.Summaries[i].Name == summaries[i].Name);
+        REQUIRE(results.Summaries[i].Versions.size() == summaries[i].Versions.size());
+        for (size_t j = 0; j < summaries[i].Versions.size(); ++j)
+        {
+            REQUIRE(results.Summaries[i].Versions[j].ToString() == summaries[i].Versions[j].ToString());
+        }
+    }
+
+    REQUIRE(results.Summaries[0].IdString == "Alpha.Id");
+    REQUIRE(results.Summaries[0].Name == "Alpha New");
+    REQUIRE(results.Summaries[1].IdString == "beta.id");
+    REQUIRE(results.Summaries[2].IdString == "Gamma.Id");
+
+    // Limited results are truncated
+    request.MaximumResults = 2;
+    results = index.Search(request);
+    REQUIRE(results.Matches.size() == 2);
+    REQUIRE(results.Truncated);
+    REQUIRE(results.Summaries.size() == 2);
+
+    request.MaximumResults = 3;
+    REQUIRE(!index.Search(request).Truncated);
+}
+
+TEST_CASE("SQLiteIndex_V1_2_CatalogSummary_ModifyAfterPackaging", "[sqliteindex][V1_2]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SQLiteIndex index = SearchTestSetup(tempFile, {
+        { "Id1", "Name", "Moniker", "1.0", "", {}, {}, "Path1" },
+        }, { 1, 2 });
+
+    index.PrepareForPackaging();
+
+    Manifest manifest;
+    manifest.Id = "Id2";
+    manifest.Name = "Other";
+    manifest.AppMoniker = "Moniker";
+    manifest.Version = "1.0";
+    index.AddManifest(manifest, "Path2");
+
+    // The summaries no longer reflect the index, so the listing must not rely on them.
+    SearchRequest request;
+    auto results = index.Search(request);
+    REQUIRE(results.Matches.size() == 2);
+    REQUIRE(results.Summaries.empty());
+}
+
+TEST_CASE("SQLiteIndex_V1_2_FoldedMatchesV1_1", "[sqliteindex][V1_2]")
+{
+    std::initializer_list<IndexFields> data = {
+        { "Microsoft.WindowsTerminal", "Windows Terminal", "terminal", "1.0", "", { "console", "shell" }, { "wt" }, "Path1" },
+        { "Microsoft.PowerShell", "PowerShell", "pwsh", "7.0", "", { "Shell", "Console" }, { "pwsh" }, "Path2" },
+        { "Contoso.Terminator", "The Terminator", "", "2.0", "", { "Terminal" }, { "term" }, "Path3" },
+        { u8"\x41\x308wesomeApp", "\xC3\x84RGER", "Moniker", "Version", "Channel", { "foot" }, { "com34" }, "Path4" },
+        };
+
+    TempFile tempFile1_1{ "repolibtest_tempdb"s, ".db"s };
+    TempFile tempFile1_2{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary files named: " << tempFile1_1.GetPath() << " and " << tempFile1_2.GetPath());
+
+    {
+        SQLiteIndex index1_1 = SearchTestSetup(tempFile1_1, data, { 1, 1 });
+        index1_1.PrepareForPackaging();
+
+        SQLiteIndex index1_2 = SearchTestSetup(tempFile1_2, data, { 1, 2 });
+        index1_2.PrepareForPackaging();
+    }
+
+    SQLiteIndex index1_1 = SQLiteIndex::Open(tempFile1_1, SQLiteIndex::OpenDisposition::Immutable);
+    SQLiteIndex index1_2 = SQLiteIndex::Open(tempFile1_2, SQLiteIndex::OpenDisposition::Immutable);
+
+    auto getIds = [&](SQLiteIndex& index, const SearchRequest& request)
+    {
+        std::vector<std::string> ids;
+        for (const auto& match : index.Search(request).Matches)
+        {
+            ids.emplace_back(index.GetIdStringById(match.first).value());
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+
+    for (MatchType match : { MatchType::CaseInsensitive, MatchType::StartsWith })
+    {
+        for (std::string_view value : { "term", "TERMINAL", "shell", "microsoft.", "MICROSOFT.POWERSHELL", "nothing", "wt", "\xC3\xA4rg", "" })
+        {
+            INFO(MatchTypeToString(match) << " " << value);
+
+            SearchRequest request;
+            request.Query = RequestMatch(match, value);
+            REQUIRE(getIds(index1_1, request) == getIds(index1_2, request));
+
+            SearchRequest filterRequest;
+            filterRequest.Filters.emplace_back(ApplicationMatchField::Tag, match, value);
+            REQUIRE(getIds(index1_1, filterRequest) == getIds(index1_2, filterRequest));
+        }
+    }
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::StartsWith, "MICROSOFT.");
+    REQUIRE(getIds(index1_2, request).size() == 2);
+}
+
+TEST_CASE("SQLiteIndex_V1_2_ValueSetFilterMatchesV1_1", "[sqliteindex][V1_2]")
+{
+    std::initializer_list<IndexFields> data = {
+        { "Microsoft.WindowsTerminal", "Windows Terminal", "terminal", "1.0", "", { "console", "shell" }, { "wt" }, "Path1" },
+        { "Microsoft.PowerShell", "PowerShell", "pwsh", "7.0", "", { "Shell", "Console" }, { "pwsh", "powershell" }, "Path2" },
+        { "Contoso.Terminator", "The Terminator", "", "2.0", "", { "Terminal" }, { "term" }, "Path3" },
+        { "Contoso.NoTags", "No Tags", "", "1.0", "", {}, {}, "Path4" },
+        };
+
+    TempFile tempFile1_1{ "repolibtest_tempdb"s, ".db"s };
+    TempFile tempFile1_2{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary files named: " << tempFile1_1.GetPath() << " and " << tempFile1_2.GetPath());
+
+    {
+        SQLiteIndex index1_1 = SearchTestSetup(tempFile1_1, data, { 1, 1 });
+        index1_1.PrepareForPackaging();
+
+        SQLiteIndex index1_2 = SearchTestSetup(tempFile1_2, data, { 1, 2 });
+        index1_2.PrepareForPackaging();
+    }
+
+    SQLiteIndex index1_1 = SQLiteIndex::Open(tempFile1_1, SQLiteIndex::OpenDisposition::Immutable);
+    SQLiteIndex index1_2 = SQLiteIndex::Open(tempFile1_2, SQLiteIndex::OpenDisposition::Immutable);
+
+    auto getIds = [&](SQLiteIndex& index, const SearchRequest& request)
+    {
+        std::vector<std::string> ids;
+        for (const auto& match : index.Search(request).Matches)
+        {
+            ids.emplace_back(index.GetIdStringById(match.first).value());
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+
+    // The query finds every manifest, so that the filters are evaluated against the results rather than as the first search
+    for (ApplicationMatchField field : { ApplicationMatchField::Tag, ApplicationMatchField::Command })
+    {
+        for (MatchType match : { MatchType::Exact, MatchType::CaseInsensitive, MatchType::StartsWith })
+        {
+            for (std::string_view value : { "shell", "Shell", "CONSOLE", "term", "pwsh", "wt", "nothing", "" })
+            {
+                INFO(ApplicationMatchFieldToString(field) << " " << MatchTypeToString(match) << " " << value);
+
+                SearchRequest request;
+                request.Query = RequestMatch(MatchType::Substring, "o");
+                request.Filters.emplace_back(field, match, value);
+                REQUIRE(getIds(index1_1, request) == getIds(index1_2, request));
+            }
+        }
+    }
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Substring, "o");
+    request.Filters.emplace_back(ApplicationMatchField::Tag, MatchType::Exact, "shell");
+    REQUIRE(getIds(index1_2, request) == std::vector<std::string>{ "Microsoft.WindowsTerminal" });
+
+    request.Filters[0].Type = MatchType::CaseInsensitive;
+    REQUIRE(getIds(index1_2, request) == std::vector<std::string>{ "Microsoft.PowerShell", "Microsoft.WindowsTerminal" });
+
+    request.Filters.emplace_back(ApplicationMatchField::Command, MatchType::StartsWith, "POW");
+    REQUIRE(getIds(index1_2, request) == std::vector<std::string>{ "Microsoft.PowerShell" });
+}
+
+TEST_CASE("WildcardPattern", "[sqliteindex]")
+{
+    using Schema::WildcardPattern;
+
+    REQUIRE(WildcardPattern{ "Microsoft.*" }.GetLiteralPrefix() == "microsoft.");
+    REQUIRE(WildcardPattern{ "*Code*" }.GetLiteralPrefix().empty());
+    REQUIRE(WildcardPattern{ "ab?d*" }.GetLiteralPrefix() == "ab");
+
+    REQUIRE(WildcardPattern{ "Microsoft.*" }.Matches("microsoft.powershell"));
+    REQUIRE(WildcardPattern{ "Microsoft.*" }.Matches("microsoft."));
+    REQUIRE(!WildcardPattern{ "Microsoft.*" }.Matches("contoso.microsoft.app"));
+    REQUIRE(WildcardPattern{ "*Code*" }.Matches("microsoft.visualstudiocode"));
+    REQUIRE(WildcardPattern{ "*Code*" }.Matches("code"));
+    REQUIRE(!WildcardPattern{ "*Code*" }.Matches("cod"));
+    REQUIRE(WildcardPattern{ "?" }.Matches("\xC3\xA4"));
+    REQUIRE(!WildcardPattern{ "?" }.Matches("ab"));
+    REQUIRE(WildcardPattern{ "a*b*c" }.Matches("abbbc"));
+    REQUIRE(!WildcardPattern{ "a*b*c" }.Matches("abcb"));
+    REQUIRE(WildcardPattern{ "" }.Matches(""));
+    REQUIRE(!WildcardPattern{ "" }.Matches("a"));
+
+    REQUIRE(WildcardPattern{ "[a]*" }.ToGlob() == "[[]a]*");
+    REQUIRE(WildcardPattern{ "a_b%*?" }.ToLike() == "a'_b'%%_");
+}
+
+TEST_CASE("SQLiteIndex_V1_2_WildcardMatch", "[sqliteindex][V1_2]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SQLiteIndex index = SearchTestSetup(tempFile, {
+        { "Microsoft.WindowsTerminal", "Windows Terminal", "terminal", "1.0", "", { "console", "shell" }, { "wt" }, "Path1" },
+        { "Microsoft.VisualStudioCode", "Visual Studio Code", "vscode", "1.0", "", { "editor" }, { "code" }, "Path2" },
+        { "Contoso.Microsoft.Code", "Code", "", "2.0", "", { "editor" }, { "coder" }, "Path3" },
+        }, { 1, 2 });
+
+    auto getIds = [&](std::string_view value)
+    {
+        SearchRequest request;
+        request.Inclusions.emplace_back(ApplicationMatchField::Id, MatchType::Wildcard, value);
+
+        std::vector<std::string> ids;
+        for (const auto& match : index.Search(request).Matches)
+        {
+            ids.emplace_back(index.GetIdStringById(match.first).value());
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+
+    // The results are the same through LIKE before packaging, and through the folded values after it
+    for (bool packaged : { false, true })
+    {
+        INFO(packaged);
+
+        if (packaged)
+        {
+            index.PrepareForPackaging();
+        }
+
+        REQUIRE(getIds("microsoft.*") == std::vector<std::string>{ "Microsoft.VisualStudioCode", "Microsoft.WindowsTerminal" });
+        REQUIRE(getIds("*Code*") == std::vector<std::string>{ "Contoso.Microsoft.Code", "Microsoft.VisualStudioCode" });
+        REQUIRE(getIds("*.?ode") == std::vector<std::string>{ "Contoso.Microsoft.Code" });
+        REQUIRE(getIds("Microsoft.WindowsTerminal") == std::vector<std::string>{ "Microsoft.WindowsTerminal" });
+        REQUIRE(getIds("Microsoft").empty());
+        REQUIRE(getIds("%").empty());
+    }
+}
+
+TEST_CASE("SQLiteIndex_V1_2_FuzzyMatch", "[sqliteindex][V1_2]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SQLiteIndex index = SearchTestSetup(tempFile, {
+        { "Microsoft.WindowsTerminal", "Windows Terminal", "terminal", "1.0", "", { "console", "shell" }, { "wt" }, "Path1" },
+        { "Microsoft.PowerShell", "PowerShell", "pwsh", "7.0", "", { "Shell", "Console" }, { "pwsh" }, "Path2" },
+        { "Contoso.Terminator", "The Terminator", "", "2.0", "", { "Terminal" }, { "term" }, "Path3" },
+        }, { 1, 2 });
+
+    auto getIds = [&](std::string_view value)
+    {
+        SearchRequest request;
+        request.Query = RequestMatch(MatchType::Fuzzy, value);
+
+        std::vector<std::string> ids;
+        for (const auto& match : index.Search(request).Matches)
+        {
+            ids.emplace_back(index.GetIdStringById(match.first).value());
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+
+    // The deletions are only present after packaging
+    REQUIRE(getIds("PowerShel").empty());
+
+    index.PrepareForPackaging();
+
+    REQUIRE(getIds("PowerShell") == std::vector<std::string>{ "Microsoft.PowerShell" });
+    REQUIRE(getIds("powreshell") == std::vector<std::string>{ "Microsoft.PowerShell" });
+    REQUIRE(getIds("Windows Termnal") == std::vector<std::string>{ "Microsoft.WindowsTerminal" });
+    REQUIRE(getIds("microsoft.windowsterminl") == std::vector<std::string>{ "Microsoft.WindowsTerminal" });
+    REQUIRE(getIds("termnal") == std::vector<std::string>{ "Contoso.Terminator", "Microsoft.WindowsTerminal" });
+    REQUIRE(getIds("pw").empty());
+    REQUIRE(getIds("nothing").empty());
+
+    // Filters use the same matching
+    SearchRequest filterRequest;
+    filterRequest.Filters.emplace_back(ApplicationMatchField::Tag, MatchType::Fuzzy, "consle");
+    REQUIRE(index.Search(filterRequest).Matches.size() == 2);
+}
+
+TEST_CASE("SQLiteIndex_Delta_CreateAndApply", "[sqliteindex]")
+{
+    TempFile baseFile{ "repolibtest_tempdb"s, ".db"s };
+    TempFile targetFile{ "repolibtest_tempdb"s, ".db"s };
+    TempFile clientFile{ "repolibtest_tempdb"s, ".db"s };
+    TempFile deltaFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary files named: " << baseFile.GetPath() << ", " << targetFile.GetPath() << ", " << clientFile.GetPath() << ", " << deltaFile.GetPath());
+
+    {
+        SQLiteIndex index = SearchTestSetup(baseFile, {
+            { "Id1", "Name1", "Moniker1", "1.0", "", { "Tag1" }, { "Command1" }, "Path1" },
+            { "Id2", "Name2", "Moniker2", "1.0", "", { "Tag2" }, { "Command2" }, "Path2" },
+            { "Id3", "Name3", "Moniker3", "1.0", "", { "Tag3" }, { "Command3" }, "Path3" },
+            });
+    }
+
+    std::filesystem::copy_file(baseFile.GetPath(), targetFile.GetPath(), std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::copy_file(baseFile.GetPath(), clientFile.GetPath(), std::filesystem::copy_options::overwrite_existing);
+
+    SQLiteIndex baseIndex = SQLiteIndex::Open(baseFile, SQLiteIndex::OpenDisposition::Read);
+    SQLiteIndex targetIndex = SQLiteIndex::Open(targetFile, SQLiteIndex::OpenDisposition::ReadWrite);
+
+    Manifest manifest;
+    manifest.Id = "Id2";
+    manifest.Name = "Updated Name";
+    manifest.AppMoniker = "Moniker2";
+    manifest.Version = "1.0";
+    manifest.Tags = { "Tag2", "NewTag" };
+    manifest.Commands = { "Command2" };
+    REQUIRE(targetIndex.UpdateManifest(manifest, "Path2"));
+
+    manifest.Id = "Id3";
+    manifest.Version = "1.0";
+    targetIndex.RemoveManifest(manifest, "Path3");
+
+    manifest.Id = "Id4";
+    manifest.Name = "Name4";
+    manifest.AppMoniker = "Moniker4";
+    manifest.Version = "2.0";
+    manifest.Tags = {};
+    manifest.Commands = {};
+    targetIndex.AddManifest(manifest, "Path3");
+
+    SQLiteIndex delta = SQLiteIndex::CreateDelta(deltaFile, baseIndex, targetIndex);
+    REQUIRE(delta.IsDelta());
+    REQUIRE(!targetIndex.IsDelta());
+
+    // The delta only holds the changed manifests.
+    SearchRequest request;
+    REQUIRE(delta.Search(request).Matches.size() == 2);
+
+    SQLiteIndex clientIndex = SQLiteIndex::Open(clientFile, SQLiteIndex::OpenDisposition::ReadWrite);
+    clientIndex.ApplyDelta(delta);
+
+    REQUIRE(clientIndex.GetLastWriteTime() == targetIndex.GetLastWriteTime());
+
+    auto getValues = [](SQLiteIndex& index)
+    {
+        std::set<std::tuple<std::string, std::string, std::string>> result;
+        for (const auto& match : index.Search({}).Matches)
+        {
+            result.emplace(index.GetIdStringById(match.first).value(), index.GetNameStringById(match.first).value(), index.GetPathStringByKey(match.first, "", "").value());
+        }
+        return result;
+    };
+
+    REQUIRE(getValues(clientIndex) == getValues(targetIndex));
+    REQUIRE(getValues(clientIndex).size() == 3);
+
+    request.Query = RequestMatch(MatchType::Exact, "NewTag");
+    REQUIRE(clientIndex.Search(request).Matches.size() == 1);
+}
+
+TEST_CASE("SQLiteIndex_Hot_Create", "[sqliteindex]")
+{
+    TempFile fullFile{ "repolibtest_tempdb"s, ".db"s };
+    TempFile hotFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary files named: " << fullFile.GetPath() << ", " << hotFile.GetPath());
+
+    SQLiteIndex fullIndex = SearchTestSetup(fullFile, {
+        { "Id1", "Name1", "Moniker1", "1.0", "", { "Tag1" }, { "Command1" }, "Path1" },
+        { "Id1", "Name1", "Moniker1", "2.0", "", { "Tag1" }, { "Command1" }, "Path2" },
+        { "Id2", "Name2", "Moniker2", "1.0", "", { "Tag2" }, { "Command2" }, "Path3" },
+        { "Id3", "Name3", "Moniker3", "1.0", "", { "Tag3" }, { "Command3" }, "Path4" },
+        });
+
+    REQUIRE(!fullIndex.GetColdIdFilter());
+
+    // The ids are matched without regard to case, and an id that is not in the full index is ignored
+    SQLiteIndex hotIndex = SQLiteIndex::CreateHot(hotFile, fullIndex, { "id1", "Id4" });
+
+    auto results = hotIndex.Search({});
+    REQUIRE(results.Matches.size() == 1);
+    REQUIRE(hotIndex.GetIdStringById(results.Matches[0].first) == "Id1");
+    REQUIRE(hotIndex.GetVersionsById(results.Matches[0].first).size() == 2);
+
+    hotIndex.PrepareForPackaging();
+
+    // The cold filter has every id in the full index, while the filter of the hot index only has its own
+    auto coldIdFilter = hotIndex.GetColdIdFilter();
+    REQUIRE(coldIdFilter);
+    REQUIRE(coldIdFilter->MayContain("id1"));
+    REQUIRE(coldIdFilter->MayContain("id2"));
+    REQUIRE(coldIdFilter->MayContain("id3"));
+
+    auto idFilter = hotIndex.GetIdFilter();
+    REQUIRE(idFilter);
+    REQUIRE(idFilter->MayContain("id1"));
+}
+
+TEST_CASE("SQLiteIndex_Delta_Mismatch", "[sqliteindex]")
+{
+    TempFile baseFile{ "repolibtest_tempdb"s, ".db"s };
+    TempFile targetFile{ "repolibtest_tempdb"s, ".db"s };
+    TempFile clientFile{ "repolibtest_tempdb"s, ".db"s };
+    TempFile deltaFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary files named: " << baseFile.GetPath() << ", " << targetFile.GetPath() << ", " << clientFile.GetPath() << ", " << deltaFile.GetPath());
+
+    SQLiteIndex baseIndex = SearchTestSetup(baseFile, {
+        { "Id1", "Name1", "Moniker1", "1.0", "", {}, {}, "Path1" },
+        });
+
+    SQLiteIndex targetIndex = SearchTestSetup(targetFile, {
+        { "Id2", "Name2", "Moniker2", "1.0", "", {}, {}, "Path2" },
+        });
+
+    SQLiteIndex olderIndex = SearchTestSetup(clientFile, {
+        { "Id1", "Name1", "Moniker1", "1.0", "", {}, {}, "Path1" },
+        }, { 1, 0 });
+
+    REQUIRE_THROWS_HR(SQLiteIndex::CreateDelta(deltaFile, baseIndex, olderIndex), E_INVALIDARG);
+
+    SQLiteIndex delta = SQLiteIndex::CreateDelta(deltaFile, baseIndex, targetIndex);
+
+    // The delta can only be applied to the index that it was created from.
+    REQUIRE_THROWS_HR(olderIndex.ApplyDelta(delta), APPINSTALLER_CLI_ERROR_INDEX_DELTA_MISMATCH);
+    REQUIRE_THROWS_HR(baseIndex.ApplyDelta(targetIndex), E_INVALIDARG);
+}
@@ -0,0 +1,175 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <Microsoft/SQLiteIndex.h>
+#include <winget/Manifest.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+
+using namespace std::string_literals;
+using namespace TestCommon;
+using namespace AppInstaller::Manifest;
+using namespace AppInstaller::Repository;
+using namespace AppInstaller::Repository::Microsoft;
+
+// These benchmarks are not run by default; use "[benchmark]" to run them, and "-benchout <file>" to write the results as JSON lines.
+// The index contents are deterministic, so that results can be compared between runs.
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Each id has this many versions, so the manifest count is a multiple of it.
+    constexpr size_t s_VersionsPerId = 3;
+
+    // The number of searches timed for each field and match type.
+    constexpr size_t s_SearchesPerCombination = 100;
+
+    std::string GetIdValue(size_t id) { return "Publisher" + std::to_string(id % 1000) + ".Application" + std::to_string(id); }
+    std::string GetNameValue(size_t id) { return "Application Name " + std::to_string(id); }
+    std::string GetMonikerValue(size_t id) { return "app" + std::to_string(id); }
+    std::string GetTagValue(size_t id, size_t index) { return "tag" + std::to_string((id * 7 + index * 13) % 5000); }
+    std::string GetCommandValue(size_t id) { return "command" + std::to_string(id % 2000); }
+
+    Manifest CreateManifest(size_t id, size_t version)
+    {
+        Manifest manifest;
+        manifest.Id = GetIdValue(id);
+        manifest.Name = GetNameValue(id);
+        manifest.AppMoniker = GetMonikerValue(id);
+        manifest.Version = std::to_string(id % 10) + "." + std::to_string(version) + ".0";
+        manifest.Tags = { GetTagValue(id, 0), GetTagValue(id, 1), GetTagValue(id, 2) };
+        manifest.Commands = { GetCommandValue(id) };
+        return manifest;
+    }
+
+    std::filesystem::path CreatePath(const Manifest& manifest)
+    {
+        return "manifests/"s + manifest.Id.substr(0, 1) + "/" + manifest.Id + "/" + manifest.Version + ".yaml";
+    }
+
+    // Gets a value for the field that exists in the index, transformed to exercise the match type.
+    std::string GetSearchValue(ApplicationMatchField field, MatchType match, size_t id)
+    {
+        std::string value;
+
+        switch (field)
+        {
+        case ApplicationMatchField::Id: value = GetIdValue(id); break;
+        case ApplicationMatchField::Name: value = GetNameValue(id); break;
+        case ApplicationMatchField::Moniker: value = GetMonikerValue(id); break;
+        case ApplicationMatchField::Tag: value = GetTagValue(id, 0); break;
+        case ApplicationMatchField::Command: value = GetCommandValue(id); break;
+        default: THROW_HR(E_UNEXPECTED);
+        }
+
+        switch (match)
+        {
+        case MatchType::CaseInsensitive:
+            std::transform(value.begin(), value.end(), value.begin(), [](char c) { return static_cast<char>(std::toupper(static_cast<unsigned char>(c))); });
+            break;
+        case MatchType::StartsWith:
+        case MatchType::FuzzySubstring:
+            value = value.substr(0, (value.length() + 1) / 2);
+            break;
+        case MatchType::Substring:
+            value = value.substr(value.length() / 4, value.length() / 2);
+            break;
+        default:
+            // The full value for the others.
+            break;
+        }
+
+        return value;
+    }
+
+    double GetPercentile(const std::vector<double>& sortedValues, size_t percentile)
+    {
+        size_t index = std::min(sortedValues.size() - 1, (sortedValues.size() * percentile) / 100);
+        return sortedValues[index];
+    }
+
+    double GetMicroseconds(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    void RunIndexBenchmark(size_t manifestCount)
+    {
+        TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+        INFO("Using temporary file named: " << tempFile.GetPath());
+
+        std::string benchmark = "SQLiteIndex_" + std::to_string(manifestCount);
+        size_t idCount = manifestCount / s_VersionsPerId;
+
+        {
+            SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version::Latest());
+
+            auto start = Clock::now();
+
+            for (size_t id = 0; id < idCount; ++id)
+            {
+                for (size_t version = 0; version < s_VersionsPerId; ++version)
+                {
+                    Manifest manifest = CreateManifest(id, version);
+                    index.AddManifest(manifest, CreatePath(manifest));
+                }
+            }
+
+            auto ingestTime = Clock::now() - start;
+            BenchmarkResults::Record(benchmark, "ingest.throughput", (idCount * s_VersionsPerId) / std::chrono::duration<double>(ingestTime).count(), "manifests/s");
+
+            start = Clock::now();
+            index.PrepareForPackaging();
+            BenchmarkResults::Record(benchmark, "package.time", std::chrono::duration<double, std::milli>(Clock::now() - start).count(), "ms");
+        }
+
+        BenchmarkResults::Record(benchmark, "package.size", static_cast<double>(std::filesystem::file_size(tempFile.GetPath())), "bytes");
+
+        SQLiteIndex index = SQLiteIndex::Open(tempFile, SQLiteIndex::OpenDisposition::Immutable);
+
+        for (ApplicationMatchField field : { ApplicationMatchField::Id, ApplicationMatchField::Name, ApplicationMatchField::Moniker, ApplicationMatchField::Tag, ApplicationMatchField::Command })
+        {
+            for (MatchType match : { MatchType::Exact, MatchType::CaseInsensitive, MatchType::StartsWith, MatchType::Substring, MatchType::Wildcard, MatchType::Fuzzy, MatchType::FuzzySubstring })
+            {
+                std::vector<double> durations;
+                durations.reserve(s_SearchesPerCombination);
+
+                for (size_t i = 0; i < s_SearchesPerCombination; ++i)
+                {
+                    // Spread the searches across the index with a stride that is coprime to most counts.
+                    SearchRequest request;
+                    request.Inclusions.emplace_back(field, match, GetSearchValue(field, match, (i * 7919) % idCount));
+
+                    auto start = Clock::now();
+                    index.Search(request);
+                    durations.push_back(GetMicroseconds(Clock::now() - start));
+                }
+
+                std::sort(durations.begin(), durations.end());
+
+                std::string metric = "search."s + std::string{ ApplicationMatchFieldToString(field) } + "." + std::string{ MatchTypeToString(match) };
+                BenchmarkResults::Record(benchmark, metric + ".p50", GetPercentile(durations, 50), "us");
+                BenchmarkResults::Record(benchmark, metric + ".p99", GetPercentile(durations, 99), "us");
+            }
+        }
+    }
+}
+
+TEST_CASE("SQLiteIndex_Benchmark_10k", "[.][benchmark]")
+{
+    RunIndexBenchmark(10'000);
+}
+
+TEST_CASE("SQLiteIndex_Benchmark_100k", "[.][benchmark]")
+{
+    RunIndexBenchmark(100'000);
+}
+
+// Takes a long time; it is only run when explicitly named.
+TEST_CASE("SQLiteIndex_Benchmark_1M", "[.][benchmark_large]")
+{
+    RunIndexBenchmark(1'000'000);
+}
@@ -3,8 +3,12 @@
 #include "pch.h"
 #include "TestCommon.h"
 #include <Microsoft/SQLiteIndexSource.h>
+#include <Microsoft/CompactSearchResult.h>
+#include <Microsoft/HotColdSource.h>
 #include <winget/ManifestYamlParser.h>
 
+#include <future>
+
 using namespace std::string_literals;
 using namespace TestCommon;
 using namespace AppInstaller::Manifest;
@@ -170,3 +174,275 @@ TEST_CASE("SQLiteIndexSource_GetManifest", "[sqliteindexsource]")
     auto noResult = app->GetManifest("blargle", "flargle");
     REQUIRE(!noResult.has_value());
 }
+
+TEST_CASE("SQLiteIndexSource_GetManifests", "[sqliteindexsource]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SourceDetails details;
+    Manifest manifest;
+    std::string relativePath;
+    std::shared_ptr<SQLiteIndexSource> source = SimpleTestSetup(tempFile, details, manifest, relativePath);
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Exact, manifest.Id);
+
+    auto results = source->Search(request);
+    REQUIRE(results.Matches.size() == 1);
+    IApplication* app = results.Matches[0].Application.get();
+
+    // The results are in the order requested, with the versions that are not found left empty
+    auto manifests = app->GetManifests({
+        { AppInstaller::Utility::Version{ "blargle" }, AppInstaller::Utility::Channel{ "flargle" } },
+        { AppInstaller::Utility::Version{ manifest.Version }, AppInstaller::Utility::Channel{ manifest.Channel } },
+        { AppInstaller::Utility::Version{ "" }, AppInstaller::Utility::Channel{ manifest.Channel } },
+        });
+
+    REQUIRE(manifests.size() == 3);
+    REQUIRE(!manifests[0].has_value());
+    REQUIRE(manifests[1].has_value());
+    REQUIRE(manifests[1]->Id == manifest.Id);
+    REQUIRE(manifests[1]->Version == manifest.Version);
+    REQUIRE(manifests[2].has_value());
+    REQUIRE(manifests[2]->Version == manifest.Version);
+}
+
+TEST_CASE("SQLiteIndexSource_Search_ManyResults", "[sqliteindexsource]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SQLiteIndex index = SQLiteIndex::CreateNew(tempFile, Schema::Version::Latest());
+
+    TestDataFile testManifest("Manifest-Good.yaml");
+    Manifest manifest = YamlParser::CreateFromPath(testManifest);
+
+    // More results than the summaries are retrieved for at once
+    constexpr size_t count = 150;
+    for (size_t i = 0; i < count; ++i)
+    {
+        manifest.Id = "ManyResults.Package" + std::to_string(i);
+        manifest.Name = "Many Results " + std::to_string(i);
+        index.AddManifest(manifest, "manifest" + std::to_string(i) + ".yaml");
+    }
+
+    SourceDetails details;
+    details.Name = "TestName";
+    details.Type = "TestType";
+    details.Arg = testManifest.GetPath().parent_path().u8string();
+    auto source = std::make_shared<SQLiteIndexSource>(details, std::move(index));
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Substring, "ManyResults.");
+
+    auto results = source->Search(request);
+    REQUIRE(results.Matches.size() == count);
+
+    // Read from the last batch first, so that every batch is retrieved out of order
+    std::unordered_set<std::string> ids;
+    for (size_t i = count; i > 0; --i)
+    {
+        IApplication* app = results.Matches[i - 1].Application.get();
+        std::string id = app->GetId().get();
+        std::string name = app->GetName().get();
+        REQUIRE(name == "Many Results " + id.substr(std::string_view{ "ManyResults.Package" }.size()));
+        REQUIRE(app->GetVersions().size() == 1);
+        ids.emplace(std::move(id));
+    }
+
+    REQUIRE(ids.size() == count);
+}
+
+TEST_CASE("SQLiteIndexSource_SearchCursor", "[sqliteindexsource]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SourceDetails details;
+    Manifest manifest;
+    std::string relativePath;
+    std::shared_ptr<SQLiteIndexSource> source = SimpleTestSetup(tempFile, details, manifest, relativePath);
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Exact, manifest.Id);
+
+    auto cursor = source->OpenSearchCursor(request);
+    auto matches = cursor->Next(10);
+    REQUIRE(matches.size() == 1);
+    REQUIRE(matches[0].Application->GetId().get() == manifest.Id);
+    REQUIRE(matches[0].MatchCriteria.Field == ApplicationMatchField::Id);
+    REQUIRE(!cursor->IsTruncated());
+
+    REQUIRE(cursor->Next(10).empty());
+}
+
+TEST_CASE("SQLiteIndexSource_SearchFromManyThreads", "[sqliteindexsource]")
+{
+    TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SourceDetails details;
+    Manifest manifest;
+    std::string relativePath;
+    std::shared_ptr<SQLiteIndexSource> source = SimpleTestSetup(tempFile, details, manifest, relativePath);
+
+    REQUIRE(source->GetIndex().CanOpenReader());
+
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Exact, manifest.Id);
+
+    // Each thread reads through its own connection to the index; the checks are made on this thread
+    struct ThreadResult
+    {
+        const SQLiteIndex* Index = nullptr;
+        size_t MatchCount = 0;
+        std::string Name;
+    };
+
+    std::vector<std::future<ThreadResult>> searches;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        searches.emplace_back(std::async(std::launch::async, [&]()
+            {
+                ThreadResult result;
+                result.Index = &source->GetIndex();
+                auto results = source->Search(request);
+                result.MatchCount = results.Matches.size();
+                if (!results.Matches.empty())
+                {
+                    result.Name = results.Matches[0].Application->GetName().get();
+                }
+                return result;
+            }));
+    }
+
+    for (auto& search : searches)
+    {
+        ThreadResult result = search.get();
+        REQUIRE(result.Index != &source->GetIndex());
+        REQUIRE(result.MatchCount == 1);
+        REQUIRE(result.Name == manifest.Name);
+    }
+
+    REQUIRE(source->Search(request).Matches.size() == 1);
+}
+
+TEST_CASE("HotColdSource_FallsThroughToCold", "[sqliteindexsource]")
+{
+    TempFile fullFile{ "repolibtest_tempdb"s, ".db"s };
+    TempFile hotFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary files named: " << fullFile.GetPath() << ", " << hotFile.GetPath());
+
+    SQLiteIndex fullIndex = SQLiteIndex::CreateNew(fullFile, Schema::Version::Latest());
+
+    Manifest manifest;
+    manifest.Id = "Hot.Package";
+    manifest.Name = "Hot Package";
+    manifest.Version = "1.0";
+    fullIndex.AddManifest(manifest, "hot.yaml");
+
+    manifest.Id = "Cold.Package";
+    manifest.Name = "Cold Package";
+    fullIndex.AddManifest(manifest, "cold.yaml");
+
+    SQLiteIndex hotIndex = SQLiteIndex::CreateHot(hotFile, fullIndex, { "Hot.Package" });
+    auto coldIdFilter = hotIndex.GetColdIdFilter();
+
+    SourceDetails details;
+    details.Name = "TestName";
+    details.Type = "TestType";
+
+    std::promise<std::shared_ptr<ISource>> cold;
+    HotColdSource source{ std::make_shared<SQLiteIndexSource>(details, std::move(hotIndex)), std::move(coldIdFilter), cold.get_future().share() };
+
+    auto searchForId = [&](const std::string& id)
+    {
+        SearchRequest request;
+        request.Filters.emplace_back(ApplicationMatchField::Id, MatchType::Exact, id);
+        return source.Search(request);
+    };
+
+    // The hot index answers for its own packages, and for ids that the full index does not have, without waiting
+    auto result = searchForId("Hot.Package");
+    REQUIRE(result.Matches.size() == 1);
+    REQUIRE(!result.Truncated);
+    REQUIRE(searchForId("Missing.Package").Matches.empty());
+    REQUIRE(source.MayContainId("Cold.Package"));
+    REQUIRE(!source.IsColdAvailable());
+
+    // Other searches may have more results in the full index
+    SearchRequest queryRequest;
+    queryRequest.Query = RequestMatch(MatchType::Substring, "Package");
+    result = source.Search(queryRequest);
+    REQUIRE(result.Matches.size() == 1);
+    REQUIRE(result.Truncated);
+
+    cold.set_value(std::make_shared<SQLiteIndexSource>(details, std::move(fullIndex)));
+
+    REQUIRE(source.IsColdAvailable());
+    REQUIRE(searchForId("Cold.Package").Matches.size() == 1);
+    REQUIRE(source.Search(queryRequest).Matches.size() == 2);
+}
+
+TEST_CASE("HotColdSource_ColdFailure", "[sqliteindexsource]")
+{
+    TempFile fullFile{ "repolibtest_tempdb"s, ".db"s };
+    TempFile hotFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary files named: " << fullFile.GetPath() << ", " << hotFile.GetPath());
+
+    SQLiteIndex fullIndex = SQLiteIndex::CreateNew(fullFile, Schema::Version::Latest());
+
+    Manifest manifest;
+    manifest.Id = "Cold.Package";
+    manifest.Name = "Cold Package";
+    manifest.Version = "1.0";
+    fullIndex.AddManifest(manifest, "cold.yaml");
+
+    SQLiteIndex hotIndex = SQLiteIndex::CreateHot(hotFile, fullIndex, {});
+    auto coldIdFilter = hotIndex.GetColdIdFilter();
+
+    SourceDetails details;
+    details.Name = "TestName";
+
+    std::promise<std::shared_ptr<ISource>> cold;
+    cold.set_exception(std::make_exception_ptr(std::runtime_error("The full index is not available")));
+
+    HotColdSource source{ std::make_shared<SQLiteIndexSource>(details, std::move(hotIndex)), std::move(coldIdFilter), cold.get_future().share() };
+
+    // The hot index is still searched, and has nothing
+    REQUIRE(!source.IsColdAvailable());
+    REQUIRE(source.SearchForIds({ "Cold.Package" }).Matches.empty());
+    REQUIRE(source.Search({}).Matches.empty());
+}
+
+TEST_CASE("CompactSearchResult_InternsCriteria", "[sqliteindexsource]")
+{
+    std::vector<std::pair<SQLite::rowid_t, ApplicationMatchFilter>> matches;
+    matches.emplace_back(1, ApplicationMatchFilter(ApplicationMatchField::Name, MatchType::Substring, "value"));
+    matches.emplace_back(2, ApplicationMatchFilter(ApplicationMatchField::Id, MatchType::Exact, "value"));
+    matches.emplace_back(3, ApplicationMatchFilter(ApplicationMatchField::Name, MatchType::Substring, "value"));
+    matches.emplace_back(4, ApplicationMatchFilter(ApplicationMatchField::Name, MatchType::Substring, "other value"));
+    matches.emplace_back(5, ApplicationMatchFilter(ApplicationMatchField::Id, MatchType::Exact, "value"));
+
+    CompactSearchResult result{ std::move(matches), true };
+    REQUIRE(result.Size() == 5);
+    REQUIRE(result.GetCriteriaCount() == 3);
+    REQUIRE(result.IsTruncated());
+
+    REQUIRE(result.GetId(3) == 4);
+    REQUIRE(result.GetCriteria(3).Field == ApplicationMatchField::Name);
+    REQUIRE(result.GetCriteria(3).Type == MatchType::Substring);
+    REQUIRE(result.GetCriteria(3).Value == "other value");
+    REQUIRE(&result.GetCriteria(0) == &result.GetCriteria(2));
+
+    // Better matches come first, and equal matches keep their order
+    SearchRequest request;
+    request.Query = RequestMatch(MatchType::Substring, "value");
+    result.ScoreAndSort(request);
+
+    REQUIRE(result.GetIds() == std::vector<SQLite::rowid_t>{ 2, 5, 1, 3, 4 });
+    REQUIRE(result.GetScore(0) == result.GetScore(1));
+    REQUIRE(result.GetScore(1) > result.GetScore(2));
+    REQUIRE(result.GetScore(2) >= result.GetScore(4));
+}
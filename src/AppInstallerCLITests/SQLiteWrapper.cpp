@@ -7,6 +7,7 @@
 
 using namespace AppInstaller::Repository::SQLite;
 using namespace std::string_literals;
+using namespace std::chrono_literals;
 
 static const char* s_firstColumn = "first";
 static const char* s_secondColumn = "second";
@@ -136,6 +137,87 @@ TEST_CASE("SQLiteWrapperFileCreateAndReopen", "[sqlitewrapper]")
     }
 }
 
+TEST_CASE("SQLiteWrapperOptimizeForRead", "[sqlitewrapper]")
+{
+    TestCommon::TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    int firstVal = 1;
+    std::string secondVal = "test";
+
+    {
+        Connection connection = Connection::Create(tempFile, Connection::OpenDisposition::Create);
+
+        CreateSimpleTestTable(connection);
+
+        InsertIntoSimpleTestTable(connection, firstVal, secondVal);
+    }
+
+    Connection connection = Connection::Create(tempFile, Connection::OpenDisposition::ReadOnly, Connection::OpenFlags::OptimizeForRead);
+
+    SelectFromSimpleTestTableOnlyOneRow(connection, firstVal, secondVal);
+
+    Statement tempStore = Statement::Create(connection, "pragma temp_store");
+    REQUIRE(tempStore.Step());
+    // 2 is MEMORY
+    REQUIRE(tempStore.GetColumn<int>(0) == 2);
+
+    Statement cacheSize = Statement::Create(connection, "pragma cache_size");
+    REQUIRE(cacheSize.Step());
+    REQUIRE(cacheSize.GetColumn<int>(0) == -16384);
+
+    // Temporary tables must still be usable on the read only connection
+    Statement createTemp = Statement::Create(connection, "create temp table [readtemp]([value] INT)");
+    createTemp.Execute();
+
+    Statement insertTemp = Statement::Create(connection, "insert into [temp].[readtemp] ([value]) values (1)");
+    insertTemp.Execute();
+}
+
+TEST_CASE("SQLiteWrapperWriteAheadLog", "[sqlitewrapper]")
+{
+    TestCommon::TempFile tempFile{ "repolibtest_tempdb"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    int firstVal = 1;
+    std::string secondVal = "test";
+
+    Connection writer = Connection::Create(tempFile, Connection::OpenDisposition::Create, Connection::OpenFlags::WriteAheadLog);
+
+    Statement journalMode = Statement::Create(writer, "pragma journal_mode");
+    REQUIRE(journalMode.Step());
+    REQUIRE(journalMode.GetColumn<std::string>(0) == "wal");
+    journalMode.Reset();
+
+    CreateSimpleTestTable(writer);
+    InsertIntoSimpleTestTable(writer, firstVal, secondVal);
+    writer.Checkpoint();
+
+    {
+        Savepoint savepoint = Savepoint::Create(writer, "test_savepoint");
+        UpdateSimpleTestTable(writer, 2, "changed");
+
+        // The reader is not blocked by the write, and sees the database as it was before it
+        Connection reader = Connection::Create(tempFile, Connection::OpenDisposition::ReadOnly);
+        reader.SetBusyTimeout(0ms);
+        SelectFromSimpleTestTableOnlyOneRow(reader, firstVal, secondVal);
+
+        savepoint.Commit();
+        writer.Checkpoint();
+
+        SelectFromSimpleTestTableOnlyOneRow(reader, 2, "changed");
+    }
+
+    REQUIRE(writer.SetWriteAheadLog(false));
+    REQUIRE(journalMode.Step());
+    REQUIRE(journalMode.GetColumn<std::string>(0) == "delete");
+
+    // A database in memory cannot use a log, which is not an error
+    Connection memory = Connection::Create(SQLITE_MEMORY_DB_CONNECTION_TARGET, Connection::OpenDisposition::Create, Connection::OpenFlags::WriteAheadLog);
+    REQUIRE_FALSE(memory.SetWriteAheadLog(true));
+    memory.Checkpoint();
+}
+
 TEST_CASE("SQLiteWrapperSavepointRollback", "[sqlitewrapper]")
 {
     Connection connection = Connection::Create(SQLITE_MEMORY_DB_CONNECTION_TARGET, Connection::OpenDisposition::Create);
@@ -149,7 +231,13 @@ TEST_CASE("SQLiteWrapperSavepointRollback", "[sqlitewrapper]")
 
     InsertIntoSimpleTestTable(connection, firstVal, secondVal);
 
+    REQUIRE(connection.GetRollbackCount() == 0);
+    savepoint.Rollback();
+    REQUIRE(connection.GetRollbackCount() == 1);
+
+    // Rolling back again does nothing
     savepoint.Rollback();
+    REQUIRE(connection.GetRollbackCount() == 1);
 
     Statement select = Statement::Create(connection, s_selectFromSimpleTestTableSQL);
     REQUIRE(!select.Step());
@@ -171,6 +259,8 @@ TEST_CASE("SQLiteWrapperSavepointRollbackOnDestruct", "[sqlitewrapper]")
         InsertIntoSimpleTestTable(connection, firstVal, secondVal);
     }
 
+    REQUIRE(connection.GetRollbackCount() == 1);
+
     Statement select = Statement::Create(connection, s_selectFromSimpleTestTableSQL);
     REQUIRE(!select.Step());
     REQUIRE(select.GetState() == Statement::State::Completed);
@@ -193,6 +283,7 @@ TEST_CASE("SQLiteWrapperSavepointCommit", "[sqlitewrapper]")
         savepoint.Commit();
     }
 
+    REQUIRE(connection.GetRollbackCount() == 0);
     SelectFromSimpleTestTableOnlyOneRow(connection, firstVal, secondVal);
 }
 
@@ -286,6 +377,213 @@ TEST_CASE("SQLiteWrapper_EscapeStringForLike", "[sqlitewrapper]")
     REQUIRE(expected == output);
 }
 
+TEST_CASE("SQLiteWrapper_StatementCache", "[sqlitewrapper]")
+{
+    Connection connection = Connection::Create(SQLITE_MEMORY_DB_CONNECTION_TARGET, Connection::OpenDisposition::Create);
+
+    CreateSimpleTestTable(connection);
+
+    int firstVal = 1;
+    std::string secondVal = "test";
+
+    InsertIntoSimpleTestTable(connection, firstVal, secondVal);
+
+    StatementCache& cache = connection.GetStatementCache();
+
+    {
+        CachedStatement select = cache.Get(connection, s_selectFromSimpleTestTableSQL);
+        REQUIRE(select->Step());
+
+        // The statement is leased, so a second request must get a different statement
+        CachedStatement second = cache.Get(connection, s_selectFromSimpleTestTableSQL);
+        REQUIRE(second->GetState() == Statement::State::Prepared);
+        REQUIRE(second->Step());
+
+        REQUIRE(firstVal == select->GetColumn<int>(0));
+        REQUIRE(firstVal == second->GetColumn<int>(0));
+    }
+
+    REQUIRE(cache.GetSize() == 1);
+    REQUIRE(cache.GetHitCount() == 0);
+    REQUIRE(cache.GetMissCount() == 2);
+
+    {
+        CachedStatement select = cache.Get(connection, s_selectFromSimpleTestTableSQL);
+        REQUIRE(select->GetState() == Statement::State::Prepared);
+        REQUIRE(select->Step());
+        REQUIRE(secondVal == select->GetColumn<std::string>(1));
+        REQUIRE(!select->Step());
+    }
+
+    REQUIRE(cache.GetSize() == 1);
+    REQUIRE(cache.GetHitCount() == 1);
+    REQUIRE(cache.GetMissCount() == 2);
+
+    cache.Clear();
+    REQUIRE(cache.GetSize() == 0);
+}
+
+TEST_CASE("SQLiteWrapper_StatementStatistics", "[sqlitewrapper]")
+{
+    // Discard anything collected before this test
+    LogStatementStatistics();
+
+    EnableStatementStatistics(true);
+    auto disable = wil::scope_exit([]() { EnableStatementStatistics(false); LogStatementStatistics(); });
+
+    Connection connection = Connection::Create(SQLITE_MEMORY_DB_CONNECTION_TARGET, Connection::OpenDisposition::Create);
+
+    CreateSimpleTestTable(connection);
+
+    int firstVal = 1;
+    std::string secondVal = "test";
+
+    InsertIntoSimpleTestTable(connection, firstVal, secondVal);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        Statement select = Statement::Create(connection, s_selectFromSimpleTestTableSQL);
+        REQUIRE(select.Step());
+        REQUIRE_FALSE(select.Step());
+    }
+
+    auto statistics = GetStatementStatistics();
+    auto itr = std::find_if(statistics.begin(), statistics.end(), [](const StatementStatistics& s) { return s.SQL == s_selectFromSimpleTestTableSQL; });
+    REQUIRE(itr != statistics.end());
+
+    REQUIRE(itr->PrepareCount == 2);
+    REQUIRE(itr->StepCount == 4);
+    REQUIRE(itr->RowCount == 2);
+    REQUIRE(itr->QueryPlan.find("simpletest") != std::string::npos);
+
+    // Logging discards the statistics, and nothing more is collected once disabled
+    LogStatementStatistics();
+    EnableStatementStatistics(false);
+
+    {
+        Statement select = Statement::Create(connection, s_selectFromSimpleTestTableSQL);
+        REQUIRE(select.Step());
+    }
+
+    REQUIRE(GetStatementStatistics().empty());
+}
+
+// Would take minutes to complete, rather than the test failing by hanging if it is never interrupted.
+static const char* s_longRunningSQL = R"(
+with recursive counter(x) as (select 1 union all select x + 1 from counter where x < 1000000000) select count(*) from counter
+)";
+
+TEST_CASE("SQLiteWrapper_CancellationScope", "[sqlitewrapper]")
+{
+    Connection connection = Connection::Create(SQLITE_MEMORY_DB_CONNECTION_TARGET, Connection::OpenDisposition::Create);
+    CreateSimpleTestTable(connection);
+
+    HRESULT interrupted = MAKE_HRESULT(SEVERITY_ERROR, FACILITY_SQLITE, SQLITE_INTERRUPT);
+
+    SECTION("Cancelled before")
+    {
+        AppInstaller::ProgressCallback progress;
+        progress.Cancel();
+
+        CancellationScope cancellation{ connection, progress };
+        Statement statement = Statement::Create(connection, s_longRunningSQL);
+        REQUIRE_THROWS_HR(statement.Step(), interrupted);
+    }
+    SECTION("Cancelled during")
+    {
+        AppInstaller::ProgressCallback progress;
+        CancellationScope cancellation{ connection, progress };
+
+        std::thread cancelThread([&]()
+            {
+                std::this_thread::sleep_for(100ms);
+                progress.Cancel();
+            });
+
+        Statement statement = Statement::Create(connection, s_longRunningSQL);
+        REQUIRE_THROWS_HR(statement.Step(), interrupted);
+        cancelThread.join();
+    }
+
+    // The connection is usable once the scope is gone
+    InsertIntoSimpleTestTable(connection, 1, "test");
+    SelectFromSimpleTestTableOnlyOneRow(connection, 1, "test");
+}
+
+TEST_CASE("SQLiteWrapper_BindBlob", "[sqlitewrapper]")
+{
+    Connection connection = Connection::Create(SQLITE_MEMORY_DB_CONNECTION_TARGET, Connection::OpenDisposition::Create);
+
+    Statement create = Statement::Create(connection, "create table [blobs] ([value] BLOB)");
+    create.Execute();
+
+    std::vector<uint8_t> value{ 0, 1, 0x7F, 0x80, 0xFF, 0 };
+
+    Statement insert = Statement::Create(connection, "insert into [blobs] values (?)");
+    insert.Bind(1, value);
+    insert.Execute();
+    insert.Reset();
+    insert.Bind(1, std::vector<uint8_t>{});
+    insert.Execute();
+
+    Statement select = Statement::Create(connection, "select [value] from [blobs] order by [rowid]");
+    REQUIRE(select.Step());
+    REQUIRE(select.GetColumn<std::vector<uint8_t>>(0) == value);
+    REQUIRE(select.Step());
+    REQUIRE(select.GetColumn<std::vector<uint8_t>>(0).empty());
+    REQUIRE(!select.Step());
+}
+
+TEST_CASE("SQLiteWrapper_ICUOnFirstUse", "[sqlitewrapper]")
+{
+    Connection connection = Connection::Create(SQLITE_MEMORY_DB_CONNECTION_TARGET, Connection::OpenDisposition::Create);
+    connection.EnableICUOnFirstUse();
+
+    Statement exact = Statement::Create(connection, "select 'a' = 'a'");
+    REQUIRE(exact.Step());
+    REQUIRE(!connection.IsICURegistered());
+
+    // The built in LIKE only ignores the case of ASCII, so this only matches with ICU
+    Statement like = Statement::Create(connection, "select '\xC3\x84' like '\xC3\xA4'");
+    REQUIRE(connection.IsICURegistered());
+    REQUIRE(like.Step());
+    REQUIRE(like.GetColumn<bool>(0));
+}
+
+TEST_CASE("SQLiteWrapper_TryStepReturnsStatus", "[sqlitewrapper]")
+{
+    Connection connection = Connection::Create(SQLITE_MEMORY_DB_CONNECTION_TARGET, Connection::OpenDisposition::Create);
+
+    Statement create = Statement::Create(connection, "create table [unique_values] ([value] TEXT PRIMARY KEY NOT NULL)");
+    REQUIRE(create.TryExecute() == SQLITE_DONE);
+
+    Statement insert = Statement::Create(connection, "insert into [unique_values] ([value]) values (?)");
+    insert.Bind(1, "value");
+    REQUIRE(insert.TryExecute() == SQLITE_DONE);
+
+    // The conflict is returned rather than thrown
+    insert.Reset();
+    insert.Bind(1, "value");
+    REQUIRE(insert.TryExecute() == SQLITE_CONSTRAINT_PRIMARYKEY);
+
+    Statement select = Statement::Create(connection, "select [value] from [unique_values]");
+    REQUIRE(select.TryStep() == SQLITE_ROW);
+    REQUIRE(select.GetColumn<std::string>(0) == "value");
+    REQUIRE(select.TryStep() == SQLITE_DONE);
+
+    if (IsReturningSupported())
+    {
+        Statement insertIfMissing = Statement::Create(connection, "insert into [unique_values] ([value]) values (?) on conflict do nothing returning [rowid]");
+        insertIfMissing.Bind(1, "value");
+        REQUIRE(insertIfMissing.TryStep() == SQLITE_DONE);
+
+        insertIfMissing.Reset();
+        insertIfMissing.Bind(1, "other");
+        REQUIRE(insertIfMissing.TryStep() == SQLITE_ROW);
+        REQUIRE(insertIfMissing.GetColumn<rowid_t>(0) == 2);
+    }
+}
+
 TEST_CASE("SQLBuilder_SimpleSelectBind", "[sqlbuilder]")
 {
     Connection connection = Connection::Create(SQLITE_MEMORY_DB_CONNECTION_TARGET, Connection::OpenDisposition::Create);
@@ -585,3 +883,105 @@ TEST_CASE("SQLBuilder_InsertValueBinding", "[sqlbuilder]")
         REQUIRE(!select.Step());
     }
 }
+
+TEST_CASE("SQLBuilder_PrepareCached", "[sqlbuilder]")
+{
+    Connection connection = Connection::Create(SQLITE_MEMORY_DB_CONNECTION_TARGET, Connection::OpenDisposition::Create);
+
+    CreateSimpleTestTable(connection);
+
+    InsertIntoSimpleTestTable(connection, 1, "1");
+    InsertIntoSimpleTestTable(connection, 2, "2");
+    InsertIntoSimpleTestTable(connection, 3, "3");
+
+    for (int i = 1; i <= 3; ++i)
+    {
+        Builder::StatementBuilder builder;
+        builder.Select({ s_firstColumn, s_secondColumn }).From(s_tableName).Where(s_firstColumn).Equals(i);
+
+        CachedStatement statement = builder.PrepareCached(connection);
+
+        REQUIRE(statement->Step());
+        REQUIRE(statement->GetColumn<int>(0) == i);
+        REQUIRE(statement->GetColumn<std::string>(1) == std::to_string(i));
+
+        REQUIRE(!statement->Step());
+    }
+
+    REQUIRE(connection.GetStatementCache().GetSize() == 1);
+    REQUIRE(connection.GetStatementCache().GetHitCount() == 2);
+    REQUIRE(connection.GetStatementCache().GetMissCount() == 1);
+}
+
+TEST_CASE("SQLBuilder_StaticSql", "[sqlbuilder]")
+{
+    using namespace std::string_view_literals;
+
+    static constexpr std::string_view tableName = "simpletest"sv;
+    static constexpr auto select = AICLI_SQLITE_STATIC_SQL("SELECT [first], [second] FROM [", tableName, "] WHERE [first] = ?");
+    static_assert(select.View() == "SELECT [first], [second] FROM [simpletest] WHERE [first] = ?"sv);
+
+    Connection connection = Connection::Create(SQLITE_MEMORY_DB_CONNECTION_TARGET, Connection::OpenDisposition::Create);
+
+    CreateSimpleTestTable(connection);
+
+    InsertIntoSimpleTestTable(connection, 1, "1");
+    InsertIntoSimpleTestTable(connection, 2, "2");
+
+    for (int i = 1; i <= 2; ++i)
+    {
+        CachedStatement statement = select.PrepareCached(connection);
+        statement->Bind(1, i);
+
+        REQUIRE(statement->Step());
+        REQUIRE(statement->GetColumn<std::string>(1) == std::to_string(i));
+        REQUIRE(!statement->Step());
+    }
+
+    REQUIRE(connection.GetStatementCache().GetSize() == 1);
+    REQUIRE(connection.GetStatementCache().GetHitCount() == 1);
+    REQUIRE(connection.GetStatementCache().GetMissCount() == 1);
+}
+
+TEST_CASE("SQLBuilder_BulkInsert", "[sqlbuilder]")
+{
+    Connection connection = Connection::Create(SQLITE_MEMORY_DB_CONNECTION_TARGET, Connection::OpenDisposition::Create);
+
+    CreateSimpleTestTable(connection);
+
+    {
+        Builder::BulkInsert<int, std::string> insert{ connection, { s_tableName }, { s_firstColumn, s_secondColumn }, 2 };
+        REQUIRE(insert.GetRowsPerStatement() == 2);
+
+        for (int i = 1; i <= 5; ++i)
+        {
+            insert.AddRow(i, std::to_string(i));
+        }
+
+        // The first four rows are inserted by full statements, and the last by Execute
+        Builder::StatementBuilder countBuilder;
+        countBuilder.Select(Builder::RowCount).From(s_tableName);
+        Statement beforeExecute = countBuilder.Prepare(connection);
+        REQUIRE(beforeExecute.Step());
+        REQUIRE(beforeExecute.GetColumn<int>(0) == 4);
+
+        insert.Execute();
+    }
+
+    Builder::StatementBuilder builder;
+    builder.Select({ s_firstColumn, s_secondColumn }).From(s_tableName).OrderBy(s_firstColumn);
+    Statement select = builder.Prepare(connection);
+
+    for (int i = 1; i <= 5; ++i)
+    {
+        REQUIRE(select.Step());
+        REQUIRE(select.GetColumn<int>(0) == i);
+        REQUIRE(select.GetColumn<std::string>(1) == std::to_string(i));
+    }
+
+    REQUIRE(!select.Step());
+
+    // The number of rows per statement is limited by the number of values that can be bound
+    Builder::BulkInsert<int, std::string> limited{ connection, { s_tableName }, { s_firstColumn, s_secondColumn }, 10000 };
+    REQUIRE(limited.GetRowsPerStatement() == Builder::BulkInsert<int, std::string>::MaximumValuesPerStatement / 2);
+}
@@ -0,0 +1,114 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <Microsoft/SearchResultCache.h>
+
+using namespace std::string_literals;
+using namespace TestCommon;
+using namespace AppInstaller::Repository;
+using namespace AppInstaller::Repository::Microsoft;
+
+namespace
+{
+    SearchRequest CreateQueryRequest(std::string_view query)
+    {
+        SearchRequest request;
+        request.Query = RequestMatch(MatchType::Substring, query);
+        return request;
+    }
+
+    Schema::ISQLiteIndex::SearchResult CreateResult(std::initializer_list<SQLite::rowid_t> ids)
+    {
+        Schema::ISQLiteIndex::SearchResult result;
+        for (SQLite::rowid_t id : ids)
+        {
+            result.Matches.emplace_back(id, ApplicationMatchFilter(ApplicationMatchField::Name, MatchType::Substring, "Name" + std::to_string(id)));
+        }
+        return result;
+    }
+}
+
+TEST_CASE("SearchResultCache_PutAndGet", "[searchresultcache]")
+{
+    TempFile tempFile{ "repolibtest_searchcache"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    {
+        SearchResultCache cache = SearchResultCache::Open(tempFile.GetPath());
+
+        SearchRequest request = CreateQueryRequest("Name");
+        REQUIRE(!cache.Get("source", "1", request));
+
+        Schema::ISQLiteIndex::SearchResult result = CreateResult({ 3, 1, 2 });
+        result.Truncated = true;
+        cache.Put("source", "1", request, result);
+    }
+
+    // Reopen to read from another connection, as another process would.
+    SearchResultCache cache = SearchResultCache::Open(tempFile.GetPath());
+    SearchRequest request = CreateQueryRequest("Name");
+
+    auto cached = cache.Get("source", "1", request);
+    REQUIRE(cached);
+    REQUIRE(cached->Truncated);
+    REQUIRE(cached->Matches.size() == 3);
+    REQUIRE(cached->Matches[0].first == 3);
+    REQUIRE(cached->Matches[1].first == 1);
+    REQUIRE(cached->Matches[2].first == 2);
+    REQUIRE(cached->Matches[0].second.Field == ApplicationMatchField::Name);
+    REQUIRE(cached->Matches[0].second.Type == MatchType::Substring);
+    REQUIRE(cached->Matches[0].second.Value == "Name3");
+
+    // A different index, source or request is not a hit.
+    REQUIRE(!cache.Get("source", "2", request));
+    REQUIRE(!cache.Get("other", "1", request));
+    REQUIRE(!cache.Get("source", "1", CreateQueryRequest("Other")));
+
+    cache.Remove("source");
+    REQUIRE(!cache.Get("source", "1", request));
+    REQUIRE(cache.GetEntryCount() == 0);
+}
+
+TEST_CASE("SearchResultCache_LeastRecentlyUsed", "[searchresultcache]")
+{
+    TempFile tempFile{ "repolibtest_searchcache"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    SearchResultCache cache = SearchResultCache::Open(tempFile.GetPath(), 2);
+
+    cache.Put("source", "1", CreateQueryRequest("A"), CreateResult({ 1 }));
+    cache.Put("source", "1", CreateQueryRequest("B"), CreateResult({ 2 }));
+
+    // Using A makes B the least recently used.
+    REQUIRE(cache.Get("source", "1", CreateQueryRequest("A")));
+
+    cache.Put("source", "1", CreateQueryRequest("C"), CreateResult({ 3 }));
+
+    REQUIRE(cache.GetEntryCount() == 2);
+    REQUIRE(cache.Get("source", "1", CreateQueryRequest("A")));
+    REQUIRE(!cache.Get("source", "1", CreateQueryRequest("B")));
+    REQUIRE(cache.Get("source", "1", CreateQueryRequest("C")));
+}
+
+TEST_CASE("SearchResultCache_RemoveSource", "[searchresultcache]")
+{
+    TempFile tempFile{ "repolibtest_searchcache"s, ".db"s };
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    // The cache does not exist yet, so there is nothing to remove and it is not created.
+    SearchResultCache::RemoveSource(tempFile.GetPath(), "source");
+    REQUIRE(!std::filesystem::exists(tempFile.GetPath()));
+
+    {
+        SearchResultCache cache = SearchResultCache::Open(tempFile.GetPath());
+        cache.Put("source", "1", CreateQueryRequest("A"), CreateResult({ 1 }));
+        cache.Put("other", "1", CreateQueryRequest("A"), CreateResult({ 1 }));
+    }
+
+    SearchResultCache::RemoveSource(tempFile.GetPath(), "source");
+
+    SearchResultCache cache = SearchResultCache::Open(tempFile.GetPath());
+    REQUIRE(!cache.Get("source", "1", CreateQueryRequest("A")));
+    REQUIRE(cache.Get("other", "1", CreateQueryRequest("A")));
+}
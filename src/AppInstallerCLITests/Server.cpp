@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <Server.h>
+
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+using namespace std::string_literals;
+using namespace TestCommon;
+using namespace AppInstaller::CLI;
+using namespace AppInstaller::CLI::Execution;
+
+namespace
+{
+    std::wstring GetTestPipeName()
+    {
+        return Server::GetPipeName() + L"_Test_" + std::to_wstring(GetCurrentProcessId());
+    }
+
+    // The server creates its pipe on its own thread, so retry until it is listening.
+    std::optional<int> ExecuteOnServer(const std::vector<std::string>& args, std::ostream& out, const std::wstring& pipeName)
+    {
+        auto deadline = std::chrono::steady_clock::now() + 5s;
+        for (;;)
+        {
+            std::optional<int> result = Server::TryExecute(args, out, pipeName);
+            if (result || std::chrono::steady_clock::now() > deadline)
+            {
+                return result;
+            }
+
+            std::this_thread::sleep_for(10ms);
+        }
+    }
+}
+
+TEST_CASE("Server_ExecutesCommandLines", "[server]")
+{
+    std::wstring pipeName = GetTestPipeName();
+
+    std::ostringstream serverOutput;
+    std::istringstream serverInput;
+    Context serverContext{ serverOutput, serverInput };
+
+    std::vector<std::vector<std::string>> received;
+    std::thread server([&]()
+        {
+            Server::Run(serverContext, 30s, [&](Context& context, std::vector<std::string> args)
+                {
+                    context.Reporter.Info() << "Executed " << args.size() << " arguments" << std::endl;
+                    received.emplace_back(std::move(args));
+                    return static_cast<int>(received.size());
+                }, pipeName);
+        });
+    auto stopServer = wil::scope_exit([&]()
+        {
+            serverContext.Terminate(E_ABORT);
+            server.join();
+        });
+
+    std::ostringstream firstOutput;
+    REQUIRE(ExecuteOnServer({ "show", "--id", "Contoso.Editor" }, firstOutput, pipeName) == 1);
+    REQUIRE(firstOutput.str().find("Executed 3 arguments") != std::string::npos);
+
+    // The server keeps running for the next command line
+    std::ostringstream secondOutput;
+    REQUIRE(ExecuteOnServer({ "list" }, secondOutput, pipeName) == 2);
+    REQUIRE(secondOutput.str().find("Executed 1 arguments") != std::string::npos);
+
+    stopServer.reset();
+
+    REQUIRE(received.size() == 2);
+    REQUIRE(received[0] == std::vector<std::string>{ "show", "--id", "Contoso.Editor" });
+    REQUIRE(received[1] == std::vector<std::string>{ "list" });
+}
+
+TEST_CASE("Server_NotListening", "[server]")
+{
+    std::ostringstream output;
+    REQUIRE_FALSE(Server::TryExecute({ "list" }, output, GetTestPipeName()).has_value());
+    REQUIRE(output.str().empty());
+}
@@ -82,6 +82,29 @@ TEST_CASE("SetAndReadUserFileSetting", "[settings]")
     REQUIRE(value == settingValue);
 }
 
+TEST_CASE("GetSettingValue", "[settings]")
+{
+    StreamDefinition missing{ Type::UserFile, "userfilesetting_nonexistent" };
+    REQUIRE(!GetSetting(missing));
+
+    // The value is read back exactly as it was written
+    StreamDefinition name{ Type::UserFile, "userfilesetting_value" };
+    std::string value = "First line\r\nSecond line\n";
+    value += std::string(100000, 'x');
+
+    SetSetting(name, value);
+
+    auto result = GetSetting(name);
+    REQUIRE(result);
+    REQUIRE(result.value() == value);
+
+    SetSetting(name, "");
+
+    result = GetSetting(name);
+    REQUIRE(result);
+    REQUIRE(result.value().empty());
+}
+
 TEST_CASE("ReadEmptySecureSetting", "[settings]")
 {
     StreamDefinition name{ Type::Secure, "secure_nonexistentsetting" };
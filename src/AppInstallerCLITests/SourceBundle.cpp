@@ -0,0 +1,128 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <Microsoft/ManifestCache.h>
+#include <Microsoft/SourceBundle.h>
+#include <AppInstallerSHA256.h>
+#include <winget/ManifestYamlParser.h>
+
+using namespace std::string_literals;
+using namespace TestCommon;
+using namespace AppInstaller::Manifest;
+using namespace AppInstaller::Repository::Microsoft;
+using namespace AppInstaller::Utility;
+
+namespace
+{
+    void WriteFile(const std::filesystem::path& path, std::string_view content)
+    {
+        std::ofstream stream{ path, std::ios::binary | std::ios::trunc };
+        stream.write(content.data(), content.size());
+    }
+
+    std::string ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream stream{ path, std::ios::binary };
+        std::ostringstream content;
+        content << stream.rdbuf();
+        return content.str();
+    }
+
+    SHA256::HashBuffer HashOf(std::string_view content)
+    {
+        return SHA256::ComputeHash(reinterpret_cast<const uint8_t*>(content.data()), static_cast<std::uint32_t>(content.size()));
+    }
+
+    // The bundle does not read the index, so any content stands in for it.
+    constexpr std::string_view s_IndexContent = "not really an index";
+    constexpr std::string_view s_InstallerContent = "the installer";
+    constexpr std::string_view s_OtherInstallerContent = "another installer, of a different size";
+}
+
+TEST_CASE("SourceBundle_RoundTrip", "[sourcebundle]")
+{
+    TempDirectory directory{ "sourcebundle" };
+    TempFile bundleFile{ "sourcebundle"s, ".bin"s };
+    TempFile extracted{ "sourcebundle_installer"s, ".exe"s };
+
+    WriteFile(directory.GetPath() / "index.db", s_IndexContent);
+    WriteFile(directory.GetPath() / "installer.exe", s_InstallerContent);
+    WriteFile(directory.GetPath() / "copy.exe", s_InstallerContent);
+    WriteFile(directory.GetPath() / "other.exe", s_OtherInstallerContent);
+
+    Manifest good = YamlParser::CreateFromPath(TestDataFile("Manifest-Good.yaml"));
+    ManifestCache::Create(directory.GetPath() / "manifestcache.bin", { { good, std::filesystem::path{ "manifests" } / "good.yaml" } });
+
+    SourceBundle::Create(bundleFile, directory.GetPath() / "index.db", directory.GetPath() / "manifestcache.bin",
+        { directory.GetPath() / "installer.exe", directory.GetPath() / "copy.exe", directory.GetPath() / "other.exe" });
+
+    SourceBundle bundle = SourceBundle::Open(bundleFile);
+
+    // An installer named twice is only held once
+    REQUIRE(bundle.GetCount() == 4);
+
+    auto index = bundle.GetEntry(SourceBundle::IndexEntryName);
+    REQUIRE(index);
+    REQUIRE(bundle.GetData(index.value()) == s_IndexContent);
+
+    bundle.ExtractEntry(SourceBundle::IndexEntryName, extracted);
+    REQUIRE(ReadFile(extracted) == s_IndexContent);
+
+    // The manifests are read in place from the bundle
+    auto manifestCacheEntry = bundle.GetEntry(SourceBundle::ManifestCacheEntryName);
+    REQUIRE(manifestCacheEntry);
+    ManifestCache manifestCache = ManifestCache::Open(bundleFile, manifestCacheEntry->Offset, manifestCacheEntry->Size);
+    REQUIRE(manifestCache.GetCount() == 1);
+    auto cachedGood = manifestCache.GetManifest("manifests/good.yaml");
+    REQUIRE(cachedGood);
+    REQUIRE(cachedGood->Id == good.Id);
+
+    REQUIRE(bundle.TryExtractInstaller(HashOf(s_InstallerContent), extracted));
+    REQUIRE(ReadFile(extracted) == s_InstallerContent);
+
+    REQUIRE(bundle.TryExtractInstaller(HashOf(s_OtherInstallerContent), extracted));
+    REQUIRE(ReadFile(extracted) == s_OtherInstallerContent);
+
+    REQUIRE(!bundle.TryExtractInstaller(HashOf("not in the bundle"), extracted));
+    REQUIRE(!bundle.GetEntry("missing"));
+    REQUIRE_THROWS_HR(bundle.ExtractEntry("missing", extracted), HRESULT_FROM_WIN32(ERROR_NOT_FOUND));
+}
+
+TEST_CASE("SourceBundle_Corrupt", "[sourcebundle]")
+{
+    TempDirectory directory{ "sourcebundle" };
+    TempFile bundleFile{ "sourcebundle"s, ".bin"s };
+    TempFile extracted{ "sourcebundle_installer"s, ".exe"s };
+
+    WriteFile(directory.GetPath() / "index.db", s_IndexContent);
+    WriteFile(directory.GetPath() / "installer.exe", s_InstallerContent);
+
+    SourceBundle::Create(bundleFile, directory.GetPath() / "index.db", {}, { directory.GetPath() / "installer.exe" });
+
+    SECTION("Not a bundle")
+    {
+        WriteFile(bundleFile, "not a source bundle");
+        REQUIRE_THROWS_HR(SourceBundle::Open(bundleFile), HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT));
+    }
+    SECTION("Installer altered")
+    {
+        // The installer is the last entry, so altering the end of the file alters it
+        {
+            std::fstream stream{ bundleFile.GetPath(), std::ios::binary | std::ios::in | std::ios::out };
+            stream.seekp(-1, std::ios::end);
+            stream.put('!');
+        }
+
+        SourceBundle bundle = SourceBundle::Open(bundleFile);
+        REQUIRE(!bundle.TryExtractInstaller(HashOf(s_InstallerContent), extracted));
+        REQUIRE(!std::filesystem::exists(extracted.GetPath()));
+    }
+    SECTION("Truncated")
+    {
+        std::filesystem::resize_file(bundleFile.GetPath(), std::filesystem::file_size(bundleFile.GetPath()) - 1);
+
+        SourceBundle bundle = SourceBundle::Open(bundleFile);
+        REQUIRE_THROWS_HR(bundle.TryExtractInstaller(HashOf(s_InstallerContent), extracted), HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT));
+    }
+}
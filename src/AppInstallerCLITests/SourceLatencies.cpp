@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <SourceLatencies.h>
+
+using namespace AppInstaller::Repository;
+using namespace std::string_literals;
+using namespace std::chrono_literals;
+
+TEST_CASE("SourceLatencies_Percentile", "[SourceLatencies]")
+{
+    TestCommon::TempFile latenciesFile{ "sourcelatencies"s, ".yaml"s };
+    SourceLatencies latencies{ latenciesFile.GetPath() };
+
+    // Too few searches to say what is usual
+    for (int i = 1; i <= 4; ++i)
+    {
+        latencies.Record("source", std::chrono::milliseconds{ i * 10 });
+    }
+    REQUIRE(!latencies.GetPercentile("source", 0.95));
+
+    for (int i = 5; i <= 20; ++i)
+    {
+        latencies.Record("source", std::chrono::milliseconds{ i * 10 });
+    }
+    REQUIRE(latencies.GetPercentile("source", 0.95).value() == 190ms);
+    REQUIRE(latencies.GetPercentile("source", 0.5).value() == 100ms);
+    REQUIRE(latencies.GetPercentile("source", 1).value() == 200ms);
+    REQUIRE(!latencies.GetPercentile("other", 0.95));
+
+    // Only the latest searches are kept, so a source that became slow is soon seen as such
+    for (int i = 0; i < 20; ++i)
+    {
+        latencies.Record("source", 1s);
+    }
+    REQUIRE(latencies.GetPercentile("source", 0.5).value() == 1s);
+}
+
+TEST_CASE("SourceLatencies_Persist", "[SourceLatencies]")
+{
+    TestCommon::TempFile latenciesFile{ "sourcelatencies"s, ".yaml"s };
+
+    {
+        SourceLatencies latencies{ latenciesFile.GetPath() };
+        for (int i = 1; i <= 10; ++i)
+        {
+            latencies.Record("source", std::chrono::milliseconds{ i });
+        }
+    }
+
+    SourceLatencies latencies{ latenciesFile.GetPath() };
+    REQUIRE(latencies.GetPercentile("source", 0.95).value() == 10ms);
+    REQUIRE(latencies.GetPercentile("source", 0.1).value() == 1ms);
+}
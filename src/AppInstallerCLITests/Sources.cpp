@@ -11,6 +11,10 @@
 #include <AppInstallerErrors.h>
 #include <winget/Settings.h>
 
+#include <condition_variable>
+#include <mutex>
+#include <set>
+
 using namespace AppInstaller;
 using namespace AppInstaller::Runtime;
 using namespace AppInstaller::Repository;
@@ -84,6 +88,16 @@ Sources:
     LastUpdate: 2
 )"sv;
 
+constexpr std::string_view s_ThreeSourcesMetadata_ThirdUpdated = R"(
+Sources:
+  - Name: testName
+    LastUpdate: 0
+  - Name: testName2
+    LastUpdate: 1
+  - Name: testName3
+    LastUpdate: 100
+)"sv;
+
 constexpr std::string_view s_SingleSource_MissingArg = R"(
 Sources:
   - Name: testName
@@ -148,11 +162,11 @@ namespace
     {
         using CreateFunctor = std::function<std::shared_ptr<ISource>(const SourceDetails&)>;
         using AddFunctor = std::function<void(SourceDetails&)>;
-        using UpdateFunctor = std::function<void(const SourceDetails&)>;
+        using UpdateFunctor = std::function<void(SourceDetails&)>;
         using RemoveFunctor = std::function<void(const SourceDetails&)>;
 
         TestSourceFactory() :
-            m_Create(TestSource::Create), m_Add([](SourceDetails&) {}), m_Update([](const SourceDetails&) {}), m_Remove([](const SourceDetails&) {}) {}
+            m_Create(TestSource::Create), m_Add([](SourceDetails&) {}), m_Update([](SourceDetails&) {}), m_Remove([](const SourceDetails&) {}) {}
 
         // ISourceFactory
         std::shared_ptr<ISource> Create(const SourceDetails& details, IProgressCallback&) override
@@ -165,7 +179,7 @@ namespace
             m_Add(details);
         }
 
-        void Update(const SourceDetails& details, IProgressCallback&) override
+        void Update(SourceDetails& details, IProgressCallback&) override
         {
             m_Update(details);
         }
@@ -232,6 +246,24 @@ TEST_CASE("RepoSources_SingleSource", "[sources]")
     REQUIRE(sources[1].Origin == SourceOrigin::Default);
 }
 
+TEST_CASE("RepoSources_SettingsChangedBetweenReads", "[sources]")
+{
+    SetSetting(Streams::UserSources, s_SingleSource);
+    REQUIRE(GetSources().size() == 2);
+
+    // Each read must see the settings as they are now, even though the last read is kept
+    SetSetting(Streams::UserSources, s_ThreeSources);
+    REQUIRE(GetSources().size() == 3);
+
+    SetSetting(Streams::UserSources, s_SingleSource);
+    std::vector<SourceDetails> sources = GetSources();
+    REQUIRE(sources.size() == 2);
+    REQUIRE(sources[0].Name == "testName");
+
+    SetSetting(Streams::UserSources, "Name: Value : BAD");
+    REQUIRE_THROWS_HR(GetSources(), APPINSTALLER_CLI_ERROR_SOURCES_INVALID);
+}
+
 TEST_CASE("RepoSources_ThreeSources", "[sources]")
 {
     SetSetting(Streams::UserSources, s_ThreeSources);
@@ -301,6 +333,34 @@ TEST_CASE("RepoSources_AddSource", "[sources]")
     REQUIRE(sources[1].Origin == SourceOrigin::Default);
 }
 
+TEST_CASE("RepoSources_AddSourceWithMirrors", "[sources]")
+{
+    SetSetting(Streams::UserSources, s_EmptySources);
+    TestHook_ClearSourceFactoryOverrides();
+
+    std::string type = "thisIsTheType";
+
+    std::vector<std::string> mirrorsSeenByFactory;
+    TestSourceFactory factory;
+    factory.m_Add = [&](SourceDetails& sd) { mirrorsSeenByFactory = sd.Mirrors; };
+    TestHook_SetSourceFactoryOverride(type, factory);
+
+    std::vector<std::string> mirrors{ "https://one.example.com/cache", "https://two.example.com/cache" };
+
+    ProgressCallback progress;
+    AddSource("mirrored", type, "https://example.com/cache", progress, mirrors);
+
+    REQUIRE(mirrorsSeenByFactory == mirrors);
+
+    // The mirrors are kept with the source
+    std::vector<SourceDetails> sources = GetSources();
+    REQUIRE(sources[0].Name == "mirrored");
+    REQUIRE(sources[0].Mirrors == mirrors);
+
+    // A remote mirror must be as secure as a remote argument
+    REQUIRE_THROWS_HR(AddSource("insecure", type, "https://example.com/cache", progress, { "http://one.example.com/cache" }), APPINSTALLER_CLI_ERROR_SOURCE_NOT_SECURE);
+}
+
 TEST_CASE("RepoSources_AddMultipleSources", "[sources]")
 {
     SetSetting(Streams::UserSources, s_EmptySources);
@@ -407,6 +467,30 @@ TEST_CASE("RepoSources_UpdateSource", "[sources]")
     REQUIRE((now - sources[0].LastUpdateTime) < 1s);
 }
 
+TEST_CASE("RepoSources_UpdateSourceKeepsConcurrentMetadata", "[sources]")
+{
+    using namespace std::chrono_literals;
+
+    SetSetting(Streams::UserSources, s_ThreeSources);
+    SetSetting(Streams::SourcesMetadata, s_ThreeSourcesMetadata);
+    TestHook_ClearSourceFactoryOverrides();
+
+    // Another process records an update of a different source while this one is updating
+    TestSourceFactory factory;
+    factory.m_Update = [&](const SourceDetails&) { SetSetting(Streams::SourcesMetadata, s_ThreeSourcesMetadata_ThirdUpdated); };
+    TestHook_SetSourceFactoryOverride("testType", factory);
+
+    auto now = std::chrono::system_clock::now();
+    ProgressCallback progress;
+    REQUIRE(UpdateSource("testName", progress));
+
+    std::vector<SourceDetails> sources = GetSources();
+    REQUIRE(sources.size() == 3);
+    REQUIRE((now - sources[0].LastUpdateTime) < 1s);
+    REQUIRE(sources[1].LastUpdateTime == ConvertUnixEpochToSystemClock(1));
+    REQUIRE(sources[2].LastUpdateTime == ConvertUnixEpochToSystemClock(100));
+}
+
 TEST_CASE("RepoSources_UpdateSourceRetries", "[sources]")
 {
     using namespace std::chrono_literals;
@@ -444,6 +528,132 @@ TEST_CASE("RepoSources_UpdateSourceRetries", "[sources]")
     REQUIRE(updateCalledOnFactoryAgain);
 }
 
+TEST_CASE("RepoSources_UpdateSourceRecordsDataValidators", "[sources]")
+{
+    SetSetting(Streams::UserSources, s_EmptySources);
+    TestHook_ClearSourceFactoryOverrides();
+
+    std::string name = "thisIsTheName";
+    std::string type = "thisIsTheType";
+
+    TestSourceFactory factory;
+    TestHook_SetSourceFactoryOverride(type, factory);
+
+    ProgressCallback progress;
+    AddSource(name, type, "thisIsTheArg", progress);
+
+    std::vector<SourceDetails> sources = GetSources();
+    REQUIRE(sources[0].DataETag.empty());
+    REQUIRE(sources[0].DataLastModified.empty());
+
+    // The factory records the validators of the data that it fetched
+    factory.m_Update = [&](SourceDetails& sd)
+    {
+        sd.DataETag = "\"etag\"";
+        sd.DataLastModified = "Wed, 21 Oct 2015 07:28:00 GMT";
+    };
+
+    UpdateSource(name, progress);
+
+    sources = GetSources();
+    REQUIRE(sources[0].DataETag == "\"etag\"");
+    REQUIRE(sources[0].DataLastModified == "Wed, 21 Oct 2015 07:28:00 GMT");
+
+    // And is given them on the next update
+    std::string etagOnUpdate;
+    factory.m_Update = [&](SourceDetails& sd) { etagOnUpdate = sd.DataETag; };
+
+    UpdateSource(name, progress);
+
+    REQUIRE(etagOnUpdate == "\"etag\"");
+}
+
+TEST_CASE("RepoSources_UpdateSources", "[sources]")
+{
+    using namespace std::chrono_literals;
+
+    SetSetting(Streams::UserSources, s_EmptySources);
+    TestHook_ClearSourceFactoryOverrides();
+
+    std::string type = "thisIsTheType";
+    std::vector<std::string> names = { "thisIsTheName", "thisIsTheName2", "thisIsTheName3" };
+
+    TestSourceFactory factory;
+    TestHook_SetSourceFactoryOverride(type, factory);
+
+    ProgressCallback progress;
+    for (const auto& name : names)
+    {
+        AddSource(name, type, "thisIsTheArg", progress);
+    }
+
+    // Each update waits for all of them to have started, which only completes if they run concurrently.
+    std::mutex updatedLock;
+    std::condition_variable updatedCondition;
+    std::set<std::string> updated;
+    std::atomic_bool allStartedTogether = true;
+    factory.m_Update = [&](const SourceDetails& sd)
+    {
+        std::unique_lock<std::mutex> lock{ updatedLock };
+        updated.emplace(sd.Name);
+        updatedCondition.notify_all();
+        if (!updatedCondition.wait_for(lock, 10s, [&]() { return updated.size() == names.size(); }))
+        {
+            allStartedTogether = false;
+        }
+    };
+
+    auto now = std::chrono::system_clock::now();
+    std::vector<bool> result = UpdateSources({ names[0], names[1], names[2], "notASource" }, progress);
+
+    REQUIRE(result == std::vector<bool>{ true, true, true, false });
+    REQUIRE(updated.size() == names.size());
+    REQUIRE(allStartedTogether);
+
+    std::vector<SourceDetails> sources = GetSources();
+    REQUIRE(sources.size() == 4);
+
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        REQUIRE(sources[i].Name == names[i]);
+        REQUIRE((now - sources[i].LastUpdateTime) < 15s);
+    }
+}
+
+TEST_CASE("RepoSources_UpdateSourcesRecordsSuccessesOnFailure", "[sources]")
+{
+    SetSetting(Streams::UserSources, s_EmptySources);
+    TestHook_ClearSourceFactoryOverrides();
+
+    std::string type = "thisIsTheType";
+    std::string goodName = "thisIsTheName";
+    std::string badName = "thisIsTheName2";
+
+    TestSourceFactory factory;
+    TestHook_SetSourceFactoryOverride(type, factory);
+
+    ProgressCallback progress;
+    AddSource(goodName, type, "thisIsTheArg", progress);
+    AddSource(badName, type, "thisIsTheArg", progress);
+
+    auto before = std::chrono::system_clock::now();
+
+    // Fails every time for one of the sources, including the retry
+    factory.m_Update = [&](const SourceDetails& sd)
+    {
+        THROW_HR_IF(E_ACCESSDENIED, sd.Name == badName);
+    };
+
+    REQUIRE_THROWS_HR(UpdateSources({ goodName, badName }, progress), E_ACCESSDENIED);
+
+    std::vector<SourceDetails> sources = GetSources();
+    REQUIRE(sources.size() == 3);
+    REQUIRE(sources[0].Name == goodName);
+    REQUIRE(sources[0].LastUpdateTime >= before);
+    REQUIRE(sources[1].Name == badName);
+    REQUIRE(sources[1].LastUpdateTime < before);
+}
+
 TEST_CASE("RepoSources_RemoveSource", "[sources]")
 {
     SetSetting(Streams::UserSources, s_EmptySources);
@@ -597,6 +807,12 @@ TEST_CASE("RepoSources_SearchAcrossMultipleSources", "[sources]")
     REQUIRE((result.Matches[3].MatchCriteria.Type == MatchType::Exact && result.Matches[3].MatchCriteria.Field == ApplicationMatchField::Name));
     REQUIRE((result.Matches[4].MatchCriteria.Type == MatchType::CaseInsensitive && result.Matches[4].MatchCriteria.Field == ApplicationMatchField::Id));
     REQUIRE((result.Matches[5].MatchCriteria.Type == MatchType::CaseInsensitive && result.Matches[5].MatchCriteria.Field == ApplicationMatchField::Id));
+    // equal matches are in source order
+    for (size_t i = 0; i < result.Matches.size(); i += 2)
+    {
+        REQUIRE(result.Matches[i].SourceName == "winget");
+        REQUIRE(result.Matches[i + 1].SourceName == "msstore");
+    }
 
     // when truncate required
     request.MaximumResults = 3;
@@ -607,4 +823,33 @@ TEST_CASE("RepoSources_SearchAcrossMultipleSources", "[sources]")
     REQUIRE((result.Matches[0].MatchCriteria.Type == MatchType::Exact && result.Matches[0].MatchCriteria.Field == ApplicationMatchField::Id));
     REQUIRE((result.Matches[1].MatchCriteria.Type == MatchType::Exact && result.Matches[1].MatchCriteria.Field == ApplicationMatchField::Id));
     REQUIRE((result.Matches[2].MatchCriteria.Type == MatchType::Exact && result.Matches[2].MatchCriteria.Field == ApplicationMatchField::Name));
+}
+
+TEST_CASE("RepoSources_AggregatedSourceOpensOnFirstSearch", "[sources]")
+{
+    TestHook_ClearSourceFactoryOverrides();
+    TestSourceFactory factory;
+    std::atomic<int> createCount = 0;
+    factory.m_Create = [&](const SourceDetails& details) { ++createCount; return TestSource::Create(details); };
+    TestHook_SetSourceFactoryOverride("testType", factory);
+
+    SetSetting(Streams::UserSources, s_TwoSource_AggregateSourceTest);
+
+    // Recently updated, so that they are not updated before opening
+    std::string now = std::to_string(GetCurrentUnixEpoch());
+    SetSetting(Streams::SourcesMetadata, "Sources:\n  - Name: winget\n    LastUpdate: " + now + "\n  - Name: msstore\n    LastUpdate: " + now + "\n");
+
+    ProgressCallback progress;
+    auto source = OpenSource("", progress);
+
+    REQUIRE(source->GetDetails().IsAggregated);
+    REQUIRE(createCount == 0);
+
+    auto result = source->Search({});
+    REQUIRE(result.Matches.size() == 6);
+    REQUIRE(createCount == 2);
+
+    // Each is only opened once
+    source->Search({});
+    REQUIRE(createCount == 2);
 }
\ No newline at end of file
@@ -4,6 +4,9 @@
 #include "TestCommon.h"
 #include <AppInstallerStrings.h>
 
+#include <chrono>
+
+using namespace std::string_literals;
 using namespace AppInstaller::Utility;
 
 
@@ -16,6 +19,8 @@ TEST_CASE("UTF8Length", "[strings]")
     REQUIRE(UTF8Length("bye\xE2\x80\xA6") == 4); // "bye…"
     REQUIRE(UTF8Length("\xf0\x9f\xa6\x86") == 1); // [duck emoji]
     REQUIRE(UTF8Length("\xf0\x9d\x85\xa0\xf0\x9d\x85\xa0") == 2); // [8th note][8th note]
+    REQUIRE(UTF8Length("a\r\nb") == 3);
+    REQUIRE(UTF8Length("a\rb\n") == 4);
 }
 
 TEST_CASE("UTF8Substring", "[strings]")
@@ -28,6 +33,9 @@ TEST_CASE("UTF8Substring", "[strings]")
     REQUIRE(UTF8Substring("abcd", 1, 1) == "b");
     REQUIRE(UTF8Substring("abcd", 1, 3) == "bcd");
     REQUIRE(UTF8Substring("abcd", 4, 0) == "");
+    REQUIRE_THROWS_AS(UTF8Substring("abcd", 5, 0), std::out_of_range);
+    REQUIRE(UTF8Substring("a\r\nb", 1, 1) == "\r\n");
+    REQUIRE(UTF8Substring("a\r\nb", 2, 1) == "b");
 
     const char* s = "\xf0\x9f\xa6\x86s like \xf0\x9f\x8c\x8a"; // [duck emoji]s like [wave emoji]
     REQUIRE(UTF8Substring(s, 0, 9) == "\xf0\x9f\xa6\x86s like \xf0\x9f\x8c\x8a");
@@ -35,6 +43,27 @@ TEST_CASE("UTF8Substring", "[strings]")
     REQUIRE(UTF8Substring(s, 0, 2) == "\xf0\x9f\xa6\x86s");
     REQUIRE(UTF8Substring(s, 1, 7) == "s like ");
     REQUIRE(UTF8Substring(s, 1, 8) == "s like \xf0\x9f\x8c\x8a");
+    REQUIRE_THROWS_AS(UTF8Substring(s, 10, 0), std::out_of_range);
+}
+
+TEST_CASE("IsASCII", "[strings]")
+{
+    REQUIRE(IsASCII(""));
+    REQUIRE(IsASCII("test"));
+    REQUIRE(IsASCII("\x7F"));
+    REQUIRE(!IsASCII("K\xC3\xA4se"));
+
+    // The non-ASCII byte is found whether it is in a full block or in the remainder
+    std::string value(37, 'a');
+    REQUIRE(IsASCII(value));
+
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        std::string modified = value;
+        modified[i] = '\x80';
+        INFO(i);
+        REQUIRE(!IsASCII(modified));
+    }
 }
 
 TEST_CASE("Normalize", "[strings]")
@@ -65,6 +94,68 @@ TEST_CASE("NormalizedString", "[strings]")
     // Ligature fi => f + i
     std::string_view input2 = u8"\xFB01";
     REQUIRE(NormalizedString(input2) == u8"fi");
+
+    // Moved values are normalized the same way
+    REQUIRE(NormalizedString("test"s) == "test");
+    REQUIRE(NormalizedString(std::string(u8"\x41\x308")) == u8"\xC4");
+}
+
+TEST_CASE("StringsAllocationBudget", "[strings]")
+{
+    // Long enough that a copy could not be held in the string itself
+    std::string value = "Microsoft.VisualStudioCode.Insiders";
+    std::string upper = "MICROSOFT.VISUALSTUDIOCODE.INSIDERS";
+
+    size_t allocations = 0;
+    bool equal = false;
+    bool startsWith = false;
+    {
+        TestCommon::AllocationCounter counter;
+
+        // ASCII is compared in place, and moved into a normalized string rather than copied
+        equal = CaseInsensitiveEquals(value, upper);
+        startsWith = CaseInsensitiveStartsWith(upper, "microsoft.");
+        NormalizedString normalized{ std::move(value) };
+        equal = equal && normalized.length() == upper.length();
+
+        allocations = counter.GetCount();
+    }
+
+    REQUIRE(equal);
+    REQUIRE(startsWith);
+    if (TestCommon::AllocationCounter::BudgetsApply)
+    {
+        REQUIRE(allocations == 0);
+    }
+}
+
+// Not run by default; use "[benchmark]" to run it, and "-benchout <file>" to write the results as JSON lines.
+TEST_CASE("Normalize_Benchmark", "[.][benchmark]")
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t iterations = 100'000;
+
+    // An ASCII value as found in manifests, and the same value with one non-ASCII character
+    std::pair<std::string, std::string> inputs[] = {
+        { "Normalize_ASCII"s, "Publisher.Application with a typical package description"s },
+        { "Normalize_NonASCII"s, "Publisher.Application with a typical package descripti\xC3\xB3n"s },
+    };
+
+    for (const auto& [benchmark, input] : inputs)
+    {
+        size_t totalSize = 0;
+        auto start = Clock::now();
+
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            totalSize += NormalizedString(input).size();
+        }
+
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        REQUIRE(totalSize > 0);
+        TestCommon::BenchmarkResults::Record(benchmark, "throughput", (input.size() * iterations) / (1024.0 * 1024.0) / seconds, "MB/s");
+    }
 }
 
 TEST_CASE("Trim", "[strings]")
@@ -81,6 +172,36 @@ TEST_CASE("Trim", "[strings]")
     REQUIRE(Trim(str.assign("Much after is taken \f\n\r\t\v\v\t\r\n\f ")) == "Much after is taken");
 }
 
+TEST_CASE("CaseInsensitiveEquals", "[strings]")
+{
+    REQUIRE(CaseInsensitiveEquals("", ""));
+    REQUIRE(CaseInsensitiveEquals("equals", "EQUALS"));
+    REQUIRE(CaseInsensitiveEquals("Microsoft.WindowsTerminal.Preview", "microsoft.windowsterminal.preview"));
+    REQUIRE(CaseInsensitiveEquals("@[`{", "@[`{"));
+    REQUIRE(CaseInsensitiveEquals("Some.Long.Identifier.\xC3\x84wesome", "some.long.identifier.\xC3\xA4WESOME"));
+    REQUIRE(CaseInsensitiveEquals("\xE2\x84\xAA", "k"));
+
+    REQUIRE(!CaseInsensitiveEquals("equals", "equal"));
+    REQUIRE(!CaseInsensitiveEquals("", "a"));
+    REQUIRE(!CaseInsensitiveEquals("@", "`"));
+    REQUIRE(!CaseInsensitiveEquals("[", "{"));
+    REQUIRE(!CaseInsensitiveEquals("Microsoft.WindowsTerminal.Preview", "Microsoft.WindowsTerminal.Previex"));
+    REQUIRE(!CaseInsensitiveEquals("Microsoft.WindowsTerminal.Preview", "Microsoft.WindowsTerninal.Preview"));
+    REQUIRE(!CaseInsensitiveEquals("Some.Long.Identifier.\xC3\x84wesome", "Some.Long.Identifier.\xC3\x96wesome"));
+
+    // Every position of a block, and the bytes after it
+    std::string value = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    for (size_t i = 0; i < value.length(); ++i)
+    {
+        INFO(i);
+        std::string other = ToLower(value);
+        REQUIRE(CaseInsensitiveEquals(value, other));
+
+        other[i] = '!';
+        REQUIRE(!CaseInsensitiveEquals(value, other));
+    }
+}
+
 TEST_CASE("CaseInsensitiveStartsWith", "[strings]")
 {
     REQUIRE(CaseInsensitiveStartsWith("startswith", "starts"));
@@ -92,4 +213,40 @@ TEST_CASE("CaseInsensitiveStartsWith", "[strings]")
     REQUIRE(!CaseInsensitiveStartsWith("", "nuffing"));
     REQUIRE(!CaseInsensitiveStartsWith("withstarts", "starts"));
     REQUIRE(!CaseInsensitiveStartsWith(" starts", "starts"));
+
+    REQUIRE(CaseInsensitiveStartsWith("\xC3\x84wesome", "\xC3\xA4W"));
+    REQUIRE(CaseInsensitiveStartsWith("Publisher.\xC3\x84wesome", "publisher.\xC3\xA4"));
+    REQUIRE(!CaseInsensitiveStartsWith("\xC3\x84wesome", "\xC3\x96"));
+}
+
+TEST_CASE("FoldCase", "[strings]")
+{
+    REQUIRE(FoldCase("") == "");
+    REQUIRE(FoldCase("Some.Id") == "some.id");
+    REQUIRE(FoldCase("some.id") == "some.id");
+    REQUIRE(FoldCase("AZaz@[`{09-_") == "azaz@[`{09-_");
+    REQUIRE(FoldCase(u8"\xC4wesome") == FoldCase(u8"\xE4WESOME"));
+
+    REQUIRE(FoldCase("id2") != FoldCase("ID3"));
+}
+
+TEST_CASE("GetEditDistance", "[strings]")
+{
+    REQUIRE(GetEditDistance(L"", L"") == 0);
+    REQUIRE(GetEditDistance(L"", L"abc") == 3);
+    REQUIRE(GetEditDistance(L"abc", L"") == 3);
+    REQUIRE(GetEditDistance(L"powershell", L"powershell") == 0);
+    REQUIRE(GetEditDistance(L"powershell", L"powershel") == 1);
+    REQUIRE(GetEditDistance(L"powershell", L"powreshell") == 2);
+    REQUIRE(GetEditDistance(L"kitten", L"sitting") == 3);
+    REQUIRE(GetEditDistance(L"\xE4rger", L"arger") == 1);
+
+    // Values longer than a single word, either way around
+    std::wstring longValue(100, L'a');
+    std::wstring changed = longValue;
+    changed[50] = L'b';
+    changed.erase(10, 1);
+    REQUIRE(GetEditDistance(longValue, changed) == 2);
+    REQUIRE(GetEditDistance(changed, longValue) == 2);
+    REQUIRE(GetEditDistance(longValue.substr(0, 64), longValue.substr(0, 60) + L"bbbb") == 4);
 }
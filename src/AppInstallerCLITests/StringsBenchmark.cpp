@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <AppInstallerStrings.h>
+
+#include <chrono>
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+using namespace TestCommon;
+using namespace AppInstaller::Utility;
+
+// These benchmarks are not run by default; use "[benchmark]" to run them, and "-benchout <file>" to write the results as JSON lines.
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // The number of calls timed for each case; enough that the timer resolution does not matter.
+    constexpr size_t s_CallsPerCase = 1'000'000;
+
+    // Records the average time of a call to the function, in nanoseconds.
+    template <typename Function>
+    void RecordAverageCallTime(std::string_view benchmark, std::string_view metric, Function&& function)
+    {
+        // Keeps the calls from being optimized out
+        volatile bool sink = false;
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < s_CallsPerCase; ++i)
+        {
+            sink = function();
+        }
+        auto duration = Clock::now() - start;
+
+        BenchmarkResults::Record(benchmark, metric, std::chrono::duration<double, std::nano>(duration).count() / s_CallsPerCase, "ns");
+    }
+}
+
+TEST_CASE("Strings_Benchmark_CaseInsensitive", "[.][benchmark]")
+{
+    constexpr std::string_view benchmark = "Strings_CaseInsensitive"sv;
+
+    // Typical values: a source name, an argument name, a package identifier, and one that is not ASCII
+    std::string sourceName = "winget";
+    std::string sourceNameUpper = "WinGet";
+    std::string argumentName = "accept-package-agreements";
+    std::string packageId = "Microsoft.VisualStudioCode.Insiders";
+    std::string packageIdLower = ToLower(packageId);
+    std::string packageIdOther = "Microsoft.VisualStudioCode.Insider_";
+    std::string nonASCII = "Publisher.\xC3\x84wesome.Application";
+    std::string nonASCIIOther = "publisher.\xC3\xA4WESOME.application";
+
+    RecordAverageCallTime(benchmark, "equals.short"sv, [&]() { return CaseInsensitiveEquals(sourceName, sourceNameUpper); });
+    RecordAverageCallTime(benchmark, "equals.short.mismatch"sv, [&]() { return CaseInsensitiveEquals(sourceName, argumentName); });
+    RecordAverageCallTime(benchmark, "equals.long"sv, [&]() { return CaseInsensitiveEquals(packageId, packageIdLower); });
+    RecordAverageCallTime(benchmark, "equals.long.mismatch_end"sv, [&]() { return CaseInsensitiveEquals(packageId, packageIdOther); });
+    RecordAverageCallTime(benchmark, "equals.non_ascii"sv, [&]() { return CaseInsensitiveEquals(nonASCII, nonASCIIOther); });
+    RecordAverageCallTime(benchmark, "startswith.url"sv, [&]() { return CaseInsensitiveStartsWith("https://cdn.winget.microsoft.com/cache"sv, "HTTPS://"sv); });
+    RecordAverageCallTime(benchmark, "startswith.long"sv, [&]() { return CaseInsensitiveStartsWith(packageId, "microsoft.visualstudio"sv); });
+}
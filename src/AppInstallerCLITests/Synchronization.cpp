@@ -98,3 +98,60 @@ TEST_CASE("CPRWL_WriterBlocksWriter", "[CrossProcessReaderWriteLock]")
     // Upon release of the writer, the other thread should signal
     REQUIRE(signal.wait(1000));
 }
+
+TEST_CASE("CPRWL_TryLockTimesOut", "[CrossProcessReaderWriteLock]")
+{
+    std::string name = "AppInstCPRWLTests_TryLock";
+
+    {
+        CrossProcessReaderWriteLock readLock = CrossProcessReaderWriteLock::LockForRead(name);
+        REQUIRE_FALSE(CrossProcessReaderWriteLock::TryLockForWrite(name, std::chrono::milliseconds{ 100 }).has_value());
+    }
+
+    {
+        CrossProcessReaderWriteLock writeLock = CrossProcessReaderWriteLock::LockForWrite(name);
+        REQUIRE_FALSE(CrossProcessReaderWriteLock::TryLockForRead(name, std::chrono::milliseconds{ 100 }).has_value());
+        REQUIRE_FALSE(CrossProcessReaderWriteLock::TryLockForWrite(name, std::chrono::milliseconds{ 100 }).has_value());
+    }
+
+    // A timed out attempt must not leave anything held
+    REQUIRE(CrossProcessReaderWriteLock::TryLockForWrite(name, std::chrono::milliseconds{ 100 }).has_value());
+}
+
+TEST_CASE("CPRWL_PendingWriterYieldsToReaders", "[CrossProcessReaderWriteLock]")
+{
+    std::string name = "AppInstCPRWLTests_PendingWriter";
+
+    wil::unique_event writerSignal;
+    writerSignal.create();
+
+    wil::unique_event readerSignal;
+    readerSignal.create();
+
+    {
+        CrossProcessReaderWriteLock mainThreadLock = CrossProcessReaderWriteLock::LockForRead(name);
+
+        std::thread writerThread([&name, &writerSignal]() {
+            CrossProcessReaderWriteLock otherThreadLock = CrossProcessReaderWriteLock::LockForWrite(name);
+            writerSignal.SetEvent();
+            });
+        // In the event of bugs, we don't want to block the test waiting forever
+        writerThread.detach();
+
+        // Let the writer become pending behind the held reader
+        REQUIRE(!writerSignal.wait(100));
+
+        // A new reader waits for the pending writer only for a short time
+        std::thread readerThread([&name, &readerSignal]() {
+            CrossProcessReaderWriteLock otherThreadLock = CrossProcessReaderWriteLock::LockForRead(name);
+            readerSignal.SetEvent();
+            });
+        readerThread.detach();
+
+        REQUIRE(readerSignal.wait(1000));
+        REQUIRE(!writerSignal.wait(100));
+    }
+
+    // Upon release of the readers, the writer should signal
+    REQUIRE(writerSignal.wait(1000));
+}
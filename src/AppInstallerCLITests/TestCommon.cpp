@@ -2,6 +2,9 @@
 // Licensed under the MIT License.
 #include "pch.h"
 #include "TestCommon.h"
+#include <json.h>
+#include <map>
+#include <new>
 
 namespace TestCommon
 {
@@ -32,8 +35,19 @@ namespace TestCommon
         static std::vector<std::filesystem::path> s_TempFilesOnFile;
 
         static std::filesystem::path s_TestDataFileBasePath{};
+
+        static std::filesystem::path s_BenchmarkResultsPath{};
+
+        // The baseline value of each metric, keyed by "<benchmark>.<metric>".
+        static std::map<std::string, double> s_BenchmarkBaseline;
     }
 
+    // The allocations of the current thread, only counted while an AllocationCounter is alive on it.
+    // These are plain values, so that reaching them from operator new does not itself allocate.
+    thread_local size_t t_AllocationCounterDepth = 0;
+    thread_local size_t t_AllocationCount = 0;
+    thread_local size_t t_AllocatedBytes = 0;
+
     TempFile::TempFile(const std::string& baseName, const std::string& baseExt, bool deleteFileOnConstruction)
     {
         _filepath = GetTempFilePath(baseName, baseExt);
@@ -125,6 +139,69 @@ namespace TestCommon
         s_TestDataFileBasePath = path;
     }
 
+    void BenchmarkResults::Record(std::string_view benchmark, std::string_view metric, double value, std::string_view unit)
+    {
+        WARN(benchmark << " " << metric << ": " << value << " " << unit);
+
+        if (!s_BenchmarkResultsPath.empty())
+        {
+            // The names are always simple identifiers, so they do not need to be escaped.
+            std::ofstream out{ s_BenchmarkResultsPath, std::ios::app };
+            out << R"({"benchmark":")" << benchmark << R"(","metric":")" << metric << R"(","value":)" << value << R"(,"unit":")" << unit << "\"}" << std::endl;
+        }
+    }
+
+    void BenchmarkResults::RecordWithThreshold(std::string_view benchmark, std::string_view metric, double value, std::string_view unit, Better better, double tolerance)
+    {
+        Record(benchmark, metric, value, unit);
+
+        auto itr = s_BenchmarkBaseline.find(std::string{ benchmark } + "." + std::string{ metric });
+        if (itr == s_BenchmarkBaseline.end())
+        {
+            return;
+        }
+
+        double baseline = itr->second;
+        INFO(benchmark << " " << metric << ": " << value << " " << unit << " against a baseline of " << baseline << " " << unit);
+
+        if (better == Better::Lower)
+        {
+            CHECK(value <= baseline * (1 + tolerance));
+        }
+        else
+        {
+            CHECK(value >= baseline * (1 - tolerance));
+        }
+    }
+
+    void BenchmarkResults::SetOutputPath(const std::filesystem::path& path)
+    {
+        s_BenchmarkResultsPath = path;
+    }
+
+    void BenchmarkResults::SetBaselinePath(const std::filesystem::path& path)
+    {
+        std::ifstream in{ path };
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND), !in);
+
+        Json::CharReaderBuilder builder;
+        std::unique_ptr<Json::CharReader> reader{ builder.newCharReader() };
+
+        std::string line;
+        while (std::getline(in, line))
+        {
+            Json::Value result;
+            std::string errors;
+            if (line.empty() || !reader->parse(line.data(), line.data() + line.size(), &result, &errors))
+            {
+                continue;
+            }
+
+            // A later result for the same metric replaces an earlier one, as the output file is appended to.
+            s_BenchmarkBaseline[result["benchmark"].asString() + "." + result["metric"].asString()] = result["value"].asDouble();
+        }
+    }
+
     void TestProgress::OnProgress(uint64_t current, uint64_t maximum, AppInstaller::ProgressType type)
     {
         if (m_OnProgress)
@@ -142,4 +219,54 @@ namespace TestCommon
     {
         return {};
     }
+
+    AllocationCounter::AllocationCounter() :
+        m_startCount(t_AllocationCount), m_startBytes(t_AllocatedBytes)
+    {
+        ++t_AllocationCounterDepth;
+    }
+
+    AllocationCounter::~AllocationCounter()
+    {
+        --t_AllocationCounterDepth;
+    }
+
+    size_t AllocationCounter::GetCount() const
+    {
+        return t_AllocationCount - m_startCount;
+    }
+
+    size_t AllocationCounter::GetBytes() const
+    {
+        return t_AllocatedBytes - m_startBytes;
+    }
+}
+
+// Replaces the allocation function of the test binary, which the libraries under test are linked into, so that
+// AllocationCounter sees their allocations. The array and nothrow forms call this one, and the default operator
+// delete frees what it returns.
+void* __cdecl operator new(size_t size)
+{
+    if (TestCommon::t_AllocationCounterDepth > 0)
+    {
+        ++TestCommon::t_AllocationCount;
+        TestCommon::t_AllocatedBytes += size;
+    }
+
+    for (;;)
+    {
+        void* result = malloc(size == 0 ? 1 : size);
+        if (result)
+        {
+            return result;
+        }
+
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+        {
+            throw std::bad_alloc{};
+        }
+
+        handler();
+    }
 }
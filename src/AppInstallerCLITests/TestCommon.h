@@ -7,6 +7,7 @@
 #include <filesystem>
 #include <functional>
 #include <string>
+#include <string_view>
 
 #define SQLITE_MEMORY_DB_CONNECTION_TARGET ":memory:"
 
@@ -68,6 +69,58 @@ namespace TestCommon
         std::filesystem::path m_path;
     };
 
+    // Use this to hold code to an allocation budget. Counts the allocations made through operator new, and their bytes,
+    // on the current thread for the lifetime of the object; allocations made on other threads are not counted.
+    // Counters can be nested, each counting everything allocated while it is alive.
+    struct AllocationCounter
+    {
+        // Standard containers make an allocation of their own for iterator debugging, which debug builds turn on,
+        // so budgets only describe the code when it is off.
+        static constexpr bool BudgetsApply = (_ITERATOR_DEBUG_LEVEL == 0);
+
+        AllocationCounter();
+        ~AllocationCounter();
+
+        AllocationCounter(const AllocationCounter&) = delete;
+        AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+        AllocationCounter(AllocationCounter&&) = delete;
+        AllocationCounter& operator=(AllocationCounter&&) = delete;
+
+        // The allocations made since the counter was created.
+        size_t GetCount() const;
+
+        // The bytes requested by those allocations.
+        size_t GetBytes() const;
+
+    private:
+        size_t m_startCount;
+        size_t m_startBytes;
+    };
+
+    // Use this to record the measurements of benchmark tests.
+    // Each measurement is reported as a test warning, and written as a JSON line to the output file if one is set.
+    struct BenchmarkResults
+    {
+        static void Record(std::string_view benchmark, std::string_view metric, double value, std::string_view unit);
+
+        // Whether the larger or the smaller value of a metric is the better one.
+        enum class Better
+        {
+            Lower,
+            Higher,
+        };
+
+        // Records the measurement, and if the baseline has the same metric, checks that the value is not worse than the
+        // baseline value by more than the tolerance, which is a fraction of the baseline value.
+        static void RecordWithThreshold(std::string_view benchmark, std::string_view metric, double value, std::string_view unit, Better better, double tolerance);
+
+        static void SetOutputPath(const std::filesystem::path& path);
+
+        // Reads the results of a previous run written with -benchout, for the thresholds to be checked against.
+        static void SetBaselinePath(const std::filesystem::path& path);
+    };
+
     // Matcher that lets us verify wil::ResultExceptions have a specific HR.
     struct ResultExceptionHRMatcher : public Catch::MatcherBase<wil::ResultException>
     {
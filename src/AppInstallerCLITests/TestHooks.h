@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 #pragma once
 #include <SourceFactory.h>
+#include <chrono>
 #include <filesystem>
 #include <functional>
 #include <memory>
@@ -21,9 +22,23 @@ namespace AppInstaller
         void TestHook_ClearPathOverrides();
     }
 
+    namespace Utility
+    {
+        // Downloads at least this large are split into segments; 0 restores the default.
+        void TestHook_SetSegmentedDownloadMinimumSize(int64_t size);
+
+        // How long the race of the mirrors of a download waits before starting the next one, and how long a download
+        // waits for data before it fails over to the next mirror; 0 restores the default.
+        void TestHook_SetMirrorTimeouts(std::chrono::milliseconds raceStagger, std::chrono::milliseconds stallTimeout);
+    }
+
     namespace Repository
     {
         void TestHook_SetSourceFactoryOverride(const std::string& type, std::function<std::unique_ptr<ISourceFactory>()>&& factory);
         void TestHook_ClearSourceFactoryOverrides();
+
+        // Searches of aggregated sources use this timeout and hedging rather than those of the user settings.
+        void TestHook_SetSearchPolicy(std::chrono::milliseconds sourceTimeout, bool hedgeRequests);
+        void TestHook_ClearSearchPolicy();
     }
 }
@@ -0,0 +1,411 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestHttpServer.h"
+#include <AppInstallerStrings.h>
+
+#include <algorithm>
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+using namespace AppInstaller::Utility;
+
+namespace TestCommon
+{
+    namespace
+    {
+        constexpr size_t s_ReceiveBufferSize = 8 * 1024;
+
+        // The content is sent in pieces of this size, so that the emulated bandwidth is paced smoothly.
+        constexpr size_t s_SendChunkSize = 16 * 1024;
+
+        // A connection sending more than this without ending its headers is closed.
+        constexpr size_t s_MaxRequestHeadersSize = 64 * 1024;
+
+        constexpr std::string_view s_LastModified = "Wed, 21 Oct 2015 07:28:00 GMT"sv;
+
+        struct WinsockInitialization
+        {
+            WinsockInitialization()
+            {
+                WSADATA data{};
+                THROW_IF_WIN32_ERROR(WSAStartup(MAKEWORD(2, 2), &data));
+            }
+
+            ~WinsockInitialization()
+            {
+                WSACleanup();
+            }
+        };
+
+        // Gets the value of a header of the request, matching its name without regard to case.
+        std::optional<std::string> GetHeader(std::string_view request, std::string_view name)
+        {
+            size_t lineStart = request.find("\r\n"sv);
+            while (lineStart != std::string_view::npos)
+            {
+                lineStart += 2;
+                size_t lineEnd = request.find("\r\n"sv, lineStart);
+                std::string_view line = request.substr(lineStart, lineEnd == std::string_view::npos ? std::string_view::npos : lineEnd - lineStart);
+
+                size_t colon = line.find(':');
+                if (colon != std::string_view::npos && CaseInsensitiveEquals(line.substr(0, colon), name))
+                {
+                    std::string value{ line.substr(colon + 1) };
+                    return Trim(value);
+                }
+
+                lineStart = lineEnd;
+            }
+
+            return {};
+        }
+
+        // Parses a single range in any of the forms bytes=a-b, bytes=a- and bytes=-n.
+        // Returns false if it is malformed or cannot be satisfied by content of the given size.
+        bool ParseRange(const std::string& value, size_t size, size_t& first, size_t& last)
+        {
+            constexpr std::string_view s_Unit = "bytes="sv;
+            if (!CaseInsensitiveStartsWith(value, s_Unit) || value.find(',') != std::string::npos)
+            {
+                return false;
+            }
+
+            std::string_view range = std::string_view{ value }.substr(s_Unit.size());
+            size_t dash = range.find('-');
+            if (dash == std::string_view::npos || size == 0)
+            {
+                return false;
+            }
+
+            std::string start{ range.substr(0, dash) };
+            std::string end{ range.substr(dash + 1) };
+
+            try
+            {
+                if (start.empty())
+                {
+                    size_t suffix = std::stoull(end);
+                    if (suffix == 0)
+                    {
+                        return false;
+                    }
+
+                    first = (suffix < size ? size - suffix : 0);
+                    last = size - 1;
+                }
+                else
+                {
+                    first = std::stoull(start);
+                    last = (end.empty() ? size - 1 : std::min<size_t>(std::stoull(end), size - 1));
+                }
+            }
+            catch (...)
+            {
+                return false;
+            }
+
+            return first < size && first <= last;
+        }
+
+        std::string_view GetReasonPhrase(int status)
+        {
+            switch (status)
+            {
+            case 200: return "OK"sv;
+            case 206: return "Partial Content"sv;
+            case 404: return "Not Found"sv;
+            case 416: return "Range Not Satisfiable"sv;
+            case 500: return "Internal Server Error"sv;
+            case 503: return "Service Unavailable"sv;
+            default: return "Status"sv;
+            }
+        }
+    }
+
+    TestHttpServer::TestHttpServer(std::string content, Options options) :
+        m_content(std::move(content)), m_options(std::move(options))
+    {
+        static WinsockInitialization s_winsock;
+
+        wil::unique_socket listener{ socket(AF_INET, SOCK_STREAM, IPPROTO_TCP) };
+        THROW_WIN32_IF(WSAGetLastError(), !listener);
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+
+        THROW_WIN32_IF(WSAGetLastError(), bind(listener.get(), reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR);
+        THROW_WIN32_IF(WSAGetLastError(), listen(listener.get(), SOMAXCONN) == SOCKET_ERROR);
+
+        // The port was chosen by the system
+        int addressLength = sizeof(address);
+        THROW_WIN32_IF(WSAGetLastError(), getsockname(listener.get(), reinterpret_cast<sockaddr*>(&address), &addressLength) == SOCKET_ERROR);
+        m_port = ntohs(address.sin_port);
+
+        m_listener = listener.release();
+        m_acceptThread = std::thread(&TestHttpServer::AcceptConnections, this);
+    }
+
+    TestHttpServer::~TestHttpServer()
+    {
+        m_stopping = true;
+
+        // Closing the listener ends the wait for a connection
+        closesocket(m_listener);
+        m_acceptThread.join();
+
+        {
+            // Each connection closes its own socket; shutting it down ends any wait for a request
+            std::lock_guard<std::mutex> lock{ m_lock };
+            for (SOCKET connection : m_connections)
+            {
+                shutdown(connection, SD_BOTH);
+            }
+        }
+
+        for (auto& thread : m_connectionThreads)
+        {
+            thread.join();
+        }
+    }
+
+    std::string TestHttpServer::GetUrl(std::string_view name) const
+    {
+        return "http://127.0.0.1:"s + std::to_string(m_port) + "/" + std::string{ name };
+    }
+
+    void TestHttpServer::InjectFailure(const Failure& failure)
+    {
+        std::lock_guard<std::mutex> lock{ m_lock };
+        m_failures.emplace_back(failure);
+    }
+
+    void TestHttpServer::AcceptConnections()
+    {
+        while (!m_stopping)
+        {
+            SOCKET connection = accept(m_listener, nullptr, nullptr);
+            if (connection == INVALID_SOCKET)
+            {
+                // The listener only fails once it is closed
+                break;
+            }
+
+            ++m_connectionCount;
+
+            std::lock_guard<std::mutex> lock{ m_lock };
+            m_connections.emplace_back(connection);
+            m_connectionThreads.emplace_back(&TestHttpServer::ServeConnection, this, connection);
+        }
+    }
+
+    void TestHttpServer::ServeConnection(SOCKET connection)
+    {
+        std::string received;
+        char buffer[s_ReceiveBufferSize];
+
+        // Requests carry no content, so each one ends with its headers
+        bool keepOpen = true;
+        while (keepOpen && !m_stopping)
+        {
+            size_t headersEnd = received.find("\r\n\r\n"sv);
+            if (headersEnd == std::string::npos)
+            {
+                if (received.size() > s_MaxRequestHeadersSize)
+                {
+                    break;
+                }
+
+                int count = recv(connection, buffer, static_cast<int>(sizeof(buffer)), 0);
+                if (count <= 0)
+                {
+                    break;
+                }
+
+                received.append(buffer, static_cast<size_t>(count));
+                continue;
+            }
+
+            std::string request = received.substr(0, headersEnd + 4);
+            received.erase(0, headersEnd + 4);
+
+            keepOpen = ServeRequest(connection, request);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{ m_lock };
+            m_connections.erase(std::remove(m_connections.begin(), m_connections.end(), connection), m_connections.end());
+        }
+
+        closesocket(connection);
+    }
+
+    bool TestHttpServer::ServeRequest(SOCKET connection, const std::string& request)
+    {
+        size_t requestIndex = m_requestCount++;
+        std::optional<Failure> failure = TakeFailure(requestIndex);
+
+        bool isHead = CaseInsensitiveStartsWith(request, "HEAD "sv);
+
+        bool keepAlive = m_options.KeepAlive;
+        std::optional<std::string> connectionHeader = GetHeader(request, "Connection"sv);
+        if (connectionHeader && CaseInsensitiveEquals(connectionHeader.value(), "close"sv))
+        {
+            keepAlive = false;
+        }
+
+        std::optional<std::string> range = GetHeader(request, "Range"sv);
+        if (range)
+        {
+            ++m_rangeRequestCount;
+        }
+
+        int status = 200;
+        size_t first = 0;
+        size_t last = 0;
+        size_t length = m_content.size();
+
+        if (failure && failure->Status != 0)
+        {
+            status = failure->Status;
+            length = 0;
+        }
+        else if (range && m_options.SupportsRanges)
+        {
+            if (ParseRange(range.value(), m_content.size(), first, last))
+            {
+                status = 206;
+                length = last - first + 1;
+            }
+            else
+            {
+                status = 416;
+                length = 0;
+            }
+        }
+
+        std::ostringstream headers;
+        headers << "HTTP/1.1 " << status << ' ' << GetReasonPhrase(status) << "\r\n";
+        headers << "Content-Length: " << length << "\r\n";
+
+        if (status == 200 || status == 206)
+        {
+            headers << "Content-Type: " << m_options.ContentType << "\r\n";
+            headers << "ETag: " << m_options.ETag << "\r\n";
+            headers << "Last-Modified: " << s_LastModified << "\r\n";
+        }
+
+        if (m_options.SupportsRanges)
+        {
+            headers << "Accept-Ranges: bytes\r\n";
+        }
+
+        if (status == 206)
+        {
+            headers << "Content-Range: bytes " << first << '-' << last << '/' << m_content.size() << "\r\n";
+        }
+        else if (status == 416)
+        {
+            headers << "Content-Range: bytes */" << m_content.size() << "\r\n";
+        }
+
+        headers << "Connection: " << (keepAlive ? "keep-alive" : "close") << "\r\n\r\n";
+
+        // The round trip is paid before the response starts
+        if (m_options.Latency.count() > 0)
+        {
+            std::this_thread::sleep_for(m_options.Latency);
+        }
+
+        std::string headersString = headers.str();
+        if (!SendAll(connection, headersString.c_str(), headersString.size()))
+        {
+            return false;
+        }
+
+        if (!isHead && length > 0)
+        {
+            std::optional<size_t> dropAfterBytes;
+            if (failure)
+            {
+                dropAfterBytes = failure->DropAfterBytes;
+            }
+
+            if (!SendContent(connection, first, length, dropAfterBytes))
+            {
+                return false;
+            }
+        }
+
+        return keepAlive;
+    }
+
+    bool TestHttpServer::SendAll(SOCKET connection, const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            int sent = send(connection, data, static_cast<int>(std::min<size_t>(size, INT_MAX)), 0);
+            if (sent == SOCKET_ERROR)
+            {
+                return false;
+            }
+
+            data += sent;
+            size -= static_cast<size_t>(sent);
+        }
+
+        return true;
+    }
+
+    bool TestHttpServer::SendContent(SOCKET connection, size_t offset, size_t length, std::optional<size_t> dropAfterBytes)
+    {
+        auto start = std::chrono::steady_clock::now();
+        size_t sent = 0;
+
+        while (sent < length)
+        {
+            size_t chunk = std::min(s_SendChunkSize, length - sent);
+            if (dropAfterBytes)
+            {
+                if (sent >= dropAfterBytes.value())
+                {
+                    return false;
+                }
+
+                chunk = std::min(chunk, dropAfterBytes.value() - sent);
+            }
+
+            if (m_stopping || !SendAll(connection, m_content.data() + offset + sent, chunk))
+            {
+                return false;
+            }
+
+            sent += chunk;
+            m_contentBytesSent += chunk;
+
+            if (m_options.BytesPerSecond > 0)
+            {
+                std::this_thread::sleep_until(start + std::chrono::microseconds(static_cast<uint64_t>(sent) * 1000000 / m_options.BytesPerSecond));
+            }
+        }
+
+        return true;
+    }
+
+    std::optional<TestHttpServer::Failure> TestHttpServer::TakeFailure(size_t request)
+    {
+        std::lock_guard<std::mutex> lock{ m_lock };
+
+        auto itr = std::find_if(m_failures.begin(), m_failures.end(), [&](const Failure& failure) { return failure.Request == request; });
+        if (itr == m_failures.end())
+        {
+            return {};
+        }
+
+        Failure result = *itr;
+        m_failures.erase(itr);
+        return result;
+    }
+}
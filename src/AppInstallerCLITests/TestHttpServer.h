@@ -0,0 +1,110 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <WinSock2.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace TestCommon
+{
+    // An HTTP/1.1 server on the loopback interface, so that downloads can be tested and measured without the network.
+    // It serves one resource, emulating the latency and bandwidth of a remote server, and can be made to ignore
+    // ranges or to fail chosen requests. Requests are served concurrently, one thread per connection.
+    struct TestHttpServer
+    {
+        struct Options
+        {
+            // The delay before each response, emulating the round trip to a remote server.
+            std::chrono::milliseconds Latency{ 0 };
+
+            // The bytes per second sent on each connection; 0 is not limited.
+            size_t BytesPerSecond = 0;
+
+            // If false, the Range header is ignored and the whole resource is always returned.
+            bool SupportsRanges = true;
+
+            // If false, the connection is closed after each response.
+            bool KeepAlive = true;
+
+            std::string ETag = "\"TestHttpServer\"";
+            std::string ContentType = "application/octet-stream";
+        };
+
+        // A failure of one request, identified by its zero based position among all of the requests served.
+        struct Failure
+        {
+            size_t Request = 0;
+
+            // If not 0, the request is answered with this status and no content.
+            int Status = 0;
+
+            // Otherwise the connection is dropped once this many bytes of the content have been sent.
+            size_t DropAfterBytes = 0;
+        };
+
+        TestHttpServer(std::string content, Options options = {});
+
+        TestHttpServer(const TestHttpServer&) = delete;
+        TestHttpServer& operator=(const TestHttpServer&) = delete;
+
+        TestHttpServer(TestHttpServer&&) = delete;
+        TestHttpServer& operator=(TestHttpServer&&) = delete;
+
+        // Closes all of the connections, and waits for their threads.
+        ~TestHttpServer();
+
+        // Gets the URL of the resource; any path on the server serves it, so the name is only for the logs.
+        std::string GetUrl(std::string_view name = "resource") const;
+
+        const std::string& GetContent() const { return m_content; }
+
+        void InjectFailure(const Failure& failure);
+
+        // The number of requests, which is the number of round trips the client made.
+        size_t GetRequestCount() const { return m_requestCount; }
+
+        // The number of connections accepted; fewer than the requests when connections are kept alive.
+        size_t GetConnectionCount() const { return m_connectionCount; }
+
+        // The bytes of content sent, not counting the headers.
+        size_t GetContentBytesSent() const { return m_contentBytesSent; }
+
+        // The requests that had a Range header.
+        size_t GetRangeRequestCount() const { return m_rangeRequestCount; }
+
+    private:
+        void AcceptConnections();
+        void ServeConnection(SOCKET connection);
+        // Returns false if the connection must be closed.
+        bool ServeRequest(SOCKET connection, const std::string& request);
+        bool SendAll(SOCKET connection, const char* data, size_t size);
+        // Sends the range of the content at the emulated bandwidth, dropping the connection part way if told to.
+        bool SendContent(SOCKET connection, size_t offset, size_t length, std::optional<size_t> dropAfterBytes);
+        std::optional<Failure> TakeFailure(size_t request);
+
+        std::string m_content;
+        Options m_options;
+        SOCKET m_listener = INVALID_SOCKET;
+        unsigned short m_port = 0;
+
+        std::atomic<bool> m_stopping = false;
+        std::thread m_acceptThread;
+
+        std::mutex m_lock;
+        std::vector<SOCKET> m_connections;
+        std::vector<std::thread> m_connectionThreads;
+        std::vector<Failure> m_failures;
+
+        std::atomic<size_t> m_requestCount = 0;
+        std::atomic<size_t> m_connectionCount = 0;
+        std::atomic<size_t> m_contentBytesSent = 0;
+        std::atomic<size_t> m_rangeRequestCount = 0;
+    };
+}
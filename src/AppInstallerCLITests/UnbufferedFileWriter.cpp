@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include "UnbufferedFileWriter.h"
+
+using namespace AppInstaller;
+using namespace AppInstaller::Utility;
+using namespace std::string_literals;
+
+namespace
+{
+    std::string ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream stream{ path, std::ios::binary };
+        std::ostringstream content;
+        content << stream.rdbuf();
+        return content.str();
+    }
+
+    // Content that is not a whole number of sectors, or of buffers, with a position dependent pattern.
+    std::string CreateContent(size_t size)
+    {
+        std::string result(size, '\0');
+        for (size_t i = 0; i < size; ++i)
+        {
+            result[i] = static_cast<char>((i * 31) ^ (i >> 8));
+        }
+        return result;
+    }
+}
+
+TEST_CASE("UnbufferedFileWriter_WritesContent", "[UnbufferedFileWriter]")
+{
+    TestCommon::TempFile tempFile("unbuffered_test"s, ".test"s);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    size_t size = GENERATE(size_t{ 0 }, size_t{ 1 }, size_t{ 4096 }, size_t{ 1024 * 1024 }, size_t{ 3 * 1024 * 1024 + 12345 });
+    std::string content = CreateContent(size);
+
+    // The writer only opens files that exist
+    std::ofstream{ tempFile.GetPath() }.close();
+
+    {
+        UnbufferedFileWriter writer{ tempFile.GetPath() };
+        writer.Preallocate(size);
+
+        // Written in uneven pieces, so that they straddle the buffers
+        size_t offset = 0;
+        size_t piece = 1000;
+        while (offset < content.size())
+        {
+            size_t count = std::min(piece, content.size() - offset);
+            writer.Write(content.data() + offset, count);
+            offset += count;
+            piece = piece * 3 % 700000 + 1;
+        }
+
+        writer.Complete();
+        REQUIRE(writer.GetSize() == size);
+
+        REQUIRE_THROWS_HR(writer.Write("x", 1), E_ILLEGAL_METHOD_CALL);
+    }
+
+    REQUIRE(std::filesystem::file_size(tempFile.GetPath()) == size);
+    REQUIRE(ReadFile(tempFile.GetPath()) == content);
+}
+
+TEST_CASE("UnbufferedFileWriter_KeepsAlternateStreams", "[UnbufferedFileWriter]")
+{
+    TestCommon::TempFile tempFile("unbuffered_test"s, ".test"s);
+    INFO("Using temporary file named: " << tempFile.GetPath());
+
+    {
+        std::ofstream stream{ tempFile.GetPath(), std::ios::binary };
+        stream << "content that is replaced by the writer";
+    }
+
+    std::filesystem::path zoneFile = tempFile.GetPath();
+    zoneFile += ":Zone.Identifier:$data";
+    {
+        std::ofstream stream{ zoneFile };
+        stream << "[ZoneTransfer]\nZoneId=3\n";
+    }
+
+    {
+        UnbufferedFileWriter writer{ tempFile.GetPath() };
+        writer.Write("new", 3);
+        writer.Complete();
+    }
+
+    REQUIRE(ReadFile(tempFile.GetPath()) == "new");
+    REQUIRE(ReadFile(zoneFile).find("ZoneId=3") != std::string::npos);
+}
+
+TEST_CASE("UnbufferedFileWriter_RequiresExistingFile", "[UnbufferedFileWriter]")
+{
+    TestCommon::TempFile tempFile("unbuffered_test"s, ".test"s);
+
+    REQUIRE_THROWS_HR(UnbufferedFileWriter{ tempFile.GetPath() }, HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+}
@@ -161,6 +161,56 @@ TEST_CASE("UserSettingsCreateFiles", "[settings]")
     }
 }
 
+TEST_CASE("UserSettingsSnapshot", "[settings]")
+{
+    DeleteUserSettingsFiles();
+
+    auto settingsPath = UserSettings::SettingsFilePath();
+
+    // The snapshot is only written for files that are not new
+    auto lastWriteTime = std::filesystem::file_time_type::clock::now() - 1h;
+    SetSetting(Streams::PrimaryUserSettings, R"({ "visual": { "progressBar": "rainbow" } })"sv);
+    std::filesystem::last_write_time(settingsPath, lastWriteTime);
+
+    {
+        UserSettingsTest userSettingTest;
+        REQUIRE(userSettingTest.GetType() == UserSettingsType::Standard);
+        REQUIRE(userSettingTest.Get<Setting::ProgressBarVisualStyle>() == VisualStyle::Rainbow);
+    }
+
+    // A change that keeps the size and last write time is not seen, as the snapshot is used
+    SetSetting(Streams::PrimaryUserSettings, R"({ "visual": { "progressBar": "retro"   } })"sv);
+    std::filesystem::last_write_time(settingsPath, lastWriteTime);
+
+    {
+        UserSettingsTest userSettingTest;
+        REQUIRE(userSettingTest.GetType() == UserSettingsType::Standard);
+        REQUIRE(userSettingTest.Get<Setting::ProgressBarVisualStyle>() == VisualStyle::Rainbow);
+    }
+
+    // Any other change of the last write time is
+    std::filesystem::last_write_time(settingsPath, lastWriteTime + 1min);
+
+    {
+        UserSettingsTest userSettingTest;
+        REQUIRE(userSettingTest.GetType() == UserSettingsType::Standard);
+        REQUIRE(userSettingTest.Get<Setting::ProgressBarVisualStyle>() == VisualStyle::Retro);
+        REQUIRE(userSettingTest.GetWarnings().size() == 0);
+    }
+
+    // As are warnings and settings, through the snapshot
+    SetSetting(Streams::PrimaryUserSettings, R"({ "visual": { "progressBar": "fake" }, "network": { "downloader": "wininet" } })"sv);
+    std::filesystem::last_write_time(settingsPath, lastWriteTime);
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        UserSettingsTest userSettingTest;
+        REQUIRE(userSettingTest.Get<Setting::ProgressBarVisualStyle>() == VisualStyle::Accent);
+        REQUIRE(userSettingTest.Get<Setting::NetworkDownloader>() == InstallerDownloader::WinInet);
+        REQUIRE(userSettingTest.GetWarnings().size() == 1);
+    }
+}
+
 TEST_CASE("SettingProgressBar", "[settings]")
 {
     DeleteUserSettingsFiles();
@@ -272,6 +322,46 @@ TEST_CASE("SettingAutoUpdateIntervalInMinutes", "[settings]")
     }
 }
 
+TEST_CASE("SettingNetworkDownloader", "[settings]")
+{
+    DeleteUserSettingsFiles();
+
+    SECTION("Default value")
+    {
+        UserSettingsTest userSettingTest;
+
+        REQUIRE(userSettingTest.Get<Setting::NetworkDownloader>() == InstallerDownloader::Default);
+        REQUIRE(userSettingTest.GetWarnings().size() == 0);
+    }
+    SECTION("WinInet")
+    {
+        std::string_view json = R"({ "network": { "downloader": "wininet" } })";
+        SetSetting(Streams::PrimaryUserSettings, json);
+        UserSettingsTest userSettingTest;
+
+        REQUIRE(userSettingTest.Get<Setting::NetworkDownloader>() == InstallerDownloader::WinInet);
+        REQUIRE(userSettingTest.GetWarnings().size() == 0);
+    }
+    SECTION("Delivery Optimization")
+    {
+        std::string_view json = R"({ "network": { "downloader": "do" } })";
+        SetSetting(Streams::PrimaryUserSettings, json);
+        UserSettingsTest userSettingTest;
+
+        REQUIRE(userSettingTest.Get<Setting::NetworkDownloader>() == InstallerDownloader::DeliveryOptimization);
+        REQUIRE(userSettingTest.GetWarnings().size() == 0);
+    }
+    SECTION("Bad value")
+    {
+        std::string_view json = R"({ "network": { "downloader": "carrier pigeon" } })";
+        SetSetting(Streams::PrimaryUserSettings, json);
+        UserSettingsTest userSettingTest;
+
+        REQUIRE(userSettingTest.Get<Setting::NetworkDownloader>() == InstallerDownloader::Default);
+        REQUIRE(userSettingTest.GetWarnings().size() == 1);
+    }
+}
+
 // Test one experimental feature in usersettingstest context because there's no good way to test ExperimentalFeature
 TEST_CASE("SettingsExperimentalCmd", "[settings]")
 {
@@ -70,6 +70,83 @@ TEST_CASE("VersionParseCorner", "[versions]")
     REQUIRE(parts.size() == 1);
     REQUIRE(parts[0].Integer == 0);
     REQUIRE(parts[0].Other == "version");
+
+    Version version6("1.99999999999999999999999");
+    parts = version6.GetParts();
+    REQUIRE(parts.size() == 2);
+    REQUIRE(parts[1].Integer == 0);
+    REQUIRE(parts[1].Other == "99999999999999999999999");
+}
+
+TEST_CASE("VersionParseStringView", "[versions]")
+{
+    std::string_view source = "1.2.3-beta and more"sv;
+    Version version(source.substr(0, 10));
+    REQUIRE(version.ToString() == "1.2.3-beta");
+
+    const auto& parts = version.GetParts();
+    REQUIRE(parts.size() == 3);
+    REQUIRE(parts[2].Integer == 3);
+    REQUIRE(parts[2].Other == "-beta");
+}
+
+TEST_CASE("VersionParseManyParts", "[versions]")
+{
+    Version small("1.2.3.4");
+    REQUIRE(small.GetParts().IsInline());
+
+    Version large("1.2.3.4.5.6-gamma");
+    REQUIRE_FALSE(large.GetParts().IsInline());
+    REQUIRE(large.GetParts().size() == 6);
+    for (size_t i = 0; i < large.GetParts().size(); ++i)
+    {
+        INFO(i);
+        REQUIRE(large.GetParts()[i].Integer == static_cast<uint64_t>(i + 1));
+    }
+    REQUIRE(large.GetParts().back().Other == "-gamma");
+
+    Version copy = large;
+    REQUIRE(copy == large);
+
+    Version moved = std::move(copy);
+    REQUIRE(moved == large);
+
+    copy = small;
+    REQUIRE(copy == small);
+    REQUIRE(copy.GetParts().IsInline());
+}
+
+TEST_CASE("VersionAllocationBudget", "[versions]")
+{
+    // Versions with no more parts than are stored inline, and no text in them, are parsed and compared without allocating
+    size_t smallAllocations = 0;
+    bool smallLess = false;
+    {
+        TestCommon::AllocationCounter counter;
+        Version a{ "1.2.3.4" };
+        Version b{ "1.2.10" };
+        smallLess = (a < b && a != b);
+        smallAllocations = counter.GetCount();
+    }
+
+    REQUIRE(smallLess);
+    if (TestCommon::AllocationCounter::BudgetsApply)
+    {
+        REQUIRE(smallAllocations == 0);
+    }
+
+    // The parts that do not fit inline are held in one allocation
+    size_t largeAllocations = 0;
+    {
+        TestCommon::AllocationCounter counter;
+        Version large{ "1.2.3.4.5.6" };
+        largeAllocations = counter.GetCount();
+    }
+
+    if (TestCommon::AllocationCounter::BudgetsApply)
+    {
+        REQUIRE(largeAllocations == 1);
+    }
 }
 
 void RequireLessThan(std::string_view a, std::string_view b)
@@ -111,10 +188,84 @@ TEST_CASE("VersionCompare", "[versions]")
     RequireLessThan("0.0.1-beta", "0.0.2-alpha");
     RequireLessThan("0.0.1-beta", "0.0.2-alpha");
     RequireLessThan("13.9.8", "14.1");
+    RequireLessThan("1.2.3.4", "1.2.3.4.5.6");
+    RequireLessThan("1.2.3.4.5.6", "1.2.3.4.5.7");
 
     RequireEqual("1.0", "1.0.0");
 }
 
+void RequireSortKeyRoundTrip(const Version& version)
+{
+    Version decoded = Version::FromSortKey(version.GetSortKey());
+
+    REQUIRE(decoded == version);
+    REQUIRE(decoded.GetSortKey() == version.GetSortKey());
+
+    const auto& parts = version.GetParts();
+    const auto& decodedParts = decoded.GetParts();
+    REQUIRE(parts.size() == decodedParts.size());
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        REQUIRE(parts[i].Integer == decodedParts[i].Integer);
+        REQUIRE(parts[i].Other == decodedParts[i].Other);
+    }
+}
+
+TEST_CASE("VersionSortKey", "[versions]")
+{
+    std::vector<std::string> sortedList =
+    {
+        "",
+        "0.1",
+        "0.1-alpha",
+        "0.1-alpha.1",
+        "0.1-beta",
+        "99999999999999999999999",
+        "alpha",
+        "1",
+        "1.0.1",
+        "1.1",
+        "1.255",
+        "1.256",
+        "1.65536",
+        "2",
+        "13.9.8",
+        "14.1",
+        "18446744073709551615",
+    };
+
+    for (size_t i = 0; i < sortedList.size(); ++i)
+    {
+        Version vA{ sortedList[i] };
+        INFO(sortedList[i]);
+        RequireSortKeyRoundTrip(vA);
+
+        for (size_t j = i + 1; j < sortedList.size(); ++j)
+        {
+            Version vB{ sortedList[j] };
+            INFO(sortedList[j]);
+            REQUIRE(vA < vB);
+            REQUIRE(vA.GetSortKey() < vB.GetSortKey());
+        }
+    }
+
+    REQUIRE(Version("1.0").GetSortKey() == Version("1.0.0").GetSortKey());
+    REQUIRE(Version("1.2.3.4").GetSortKey().length() == 8);
+    REQUIRE(Version::FromSortKey(Version("1.2.0.4-beta").GetSortKey()).ToString() == "1.2.0.4-beta");
+
+    RequireSortKeyRoundTrip(Version("1.2.3.4-alpha", ".-"));
+
+    Version embeddedNull = Version::FromSortKey("\x03\x01" "a\x00\xFF" "b\x00\x00"sv);
+    REQUIRE(embeddedNull.GetParts().size() == 1);
+    REQUIRE(embeddedNull.GetParts()[0].Integer == 1);
+    REQUIRE(embeddedNull.GetParts()[0].Other == std::string("a\0b", 3));
+    RequireSortKeyRoundTrip(embeddedNull);
+
+    REQUIRE_THROWS_HR(Version::FromSortKey("\x03"), E_INVALIDARG);
+    REQUIRE_THROWS_HR(Version::FromSortKey("\x01" "a"), E_INVALIDARG);
+    REQUIRE_THROWS_HR(Version::FromSortKey("\x00"sv), E_INVALIDARG);
+}
+
 TEST_CASE("VersionAndChannelSort", "[versions]")
 {
     std::vector<VersionAndChannel> sortedList =
@@ -159,3 +310,20 @@ TEST_CASE("MinOsVersion_Check", "[versions]")
     REQUIRE(Runtime::IsCurrentOSVersionGreaterThanOrEqual(Version("6.1")));
     REQUIRE(!Runtime::IsCurrentOSVersionGreaterThanOrEqual(Version("10.0.65535")));
 }
+
+TEST_CASE("SystemCapabilities_ArchitecturePriorities", "[versions]")
+{
+    const auto& capabilities = Runtime::GetSystemCapabilities();
+    const auto& applicable = capabilities.ApplicableArchitectures;
+    REQUIRE(!applicable.empty());
+
+    // Earlier architectures in the list are preferred
+    for (size_t i = 1; i < applicable.size(); ++i)
+    {
+        REQUIRE(capabilities.GetArchitecturePriority(applicable[i - 1]) > capabilities.GetArchitecturePriority(applicable[i]));
+    }
+
+    REQUIRE(capabilities.GetArchitecturePriority(Utility::Architecture::Neutral) > 0);
+    REQUIRE(capabilities.GetArchitecturePriority(Utility::Architecture::Unknown) == -1);
+    REQUIRE(Utility::IsApplicableArchitecture(applicable.front()) == static_cast<int>(applicable.size()));
+}
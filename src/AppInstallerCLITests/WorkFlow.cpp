@@ -6,16 +6,19 @@
 #include <AppInstallerDownloader.h>
 #include <AppInstallerStrings.h>
 #include <Workflows/InstallFlow.h>
+#include <Workflows/ManifestComparator.h>
 #include <Workflows/ShowFlow.h>
 #include <Workflows/ShellExecuteInstallerHandler.h>
 #include <Workflows/WorkflowBase.h>
 #include <Public/AppInstallerRepositorySource.h>
 #include <Public/AppInstallerRepositorySearch.h>
 #include <Commands/InstallCommand.h>
+#include <Commands/SearchCommand.h>
 #include <Commands/ShowCommand.h>
 #include <winget/LocIndependent.h>
 #include <winget/ManifestYamlParser.h>
 #include <Resources.h>
+#include <json.h>
 
 using namespace winrt::Windows::Foundation;
 using namespace winrt::Windows::Management::Deployment;
@@ -79,6 +82,10 @@ namespace
             {
                 input = request.Inclusions[0].Value;
             }
+            else if (!request.Filters.empty())
+            {
+                input = request.Filters[0].Value;
+            }
 
             if (input == "TestQueryReturnOne")
             {
@@ -102,6 +109,14 @@ namespace
                         std::make_unique<TestApplication>(manifest2),
                         ApplicationMatchFilter(ApplicationMatchField::Id, MatchType::Exact, "TestQueryReturnTwo")));
             }
+            else if (input == "TestQueryReturnMsix")
+            {
+                auto manifest = YamlParser::CreateFromPath(TestDataFile("InstallFlowTest_Msix_StreamingFlow.yaml"));
+                result.Matches.emplace_back(
+                    ResultMatch(
+                        std::make_unique<TestApplication>(manifest),
+                        ApplicationMatchFilter(ApplicationMatchField::Id, MatchType::Exact, "TestQueryReturnMsix")));
+            }
 
             return result;
         }
@@ -116,6 +131,9 @@ namespace
         WorkflowTaskOverride(WorkflowTask::Func f, const std::function<void(TestContext&)>& o) :
             Target(f), Override(o) {}
 
+        WorkflowTaskOverride(WorkflowTask::AsyncFunc f, const std::function<void(TestContext&)>& o) :
+            Target(f), Override(o) {}
+
         WorkflowTaskOverride(std::string_view n, const std::function<void(TestContext&)>& o) :
             Target(n), Override(o) {}
 
@@ -130,7 +148,8 @@ namespace
     // Enables overriding the behavior of specific workflow tasks.
     struct TestContext : public Context
     {
-        TestContext(std::ostream& out, std::istream& in) : Context(out, in)
+        TestContext(std::ostream& out, std::istream& in) :
+            Context(out, in), m_out(out), m_in(in), m_overrides(std::make_shared<std::vector<WorkflowTaskOverride>>())
         {
             WorkflowTaskOverride wto
             { RemoveInstaller, [](TestContext&)
@@ -144,9 +163,18 @@ namespace
             Override(wto);
         }
 
+        // Sub-contexts share the overrides of the context that created them.
+        TestContext(std::ostream& out, std::istream& in, std::shared_ptr<std::vector<WorkflowTaskOverride>> overrides) :
+            Context(out, in), m_out(out), m_in(in), m_overrides(std::move(overrides)), m_isSubContext(true) {}
+
         ~TestContext()
         {
-            for (const auto& wto : m_overrides)
+            if (m_isSubContext)
+            {
+                return;
+            }
+
+            for (const auto& wto : *m_overrides)
             {
                 if (!wto.Used)
                 {
@@ -157,9 +185,9 @@ namespace
 
         bool ShouldExecuteWorkflowTask(const Workflow::WorkflowTask& task) override
         {
-            auto itr = std::find_if(m_overrides.begin(), m_overrides.end(), [&](const WorkflowTaskOverride& wto) { return wto.Target == task; });
+            auto itr = std::find_if(m_overrides->begin(), m_overrides->end(), [&](const WorkflowTaskOverride& wto) { return wto.Target == task; });
 
-            if (itr == m_overrides.end())
+            if (itr == m_overrides->end())
             {
                 return true;
             }
@@ -173,11 +201,28 @@ namespace
 
         void Override(const WorkflowTaskOverride& wto)
         {
-            m_overrides.emplace_back(wto);
+            m_overrides->emplace_back(wto);
+        }
+
+        std::unique_ptr<Context> CreateSubContext() override
+        {
+            auto result = std::make_unique<TestContext>(m_out, m_in, m_overrides);
+            result->Args = Args;
+            return result;
+        }
+
+        std::unique_ptr<Context> CreateSubContext(std::ostream& out, std::istream& in) override
+        {
+            auto result = std::make_unique<TestContext>(out, in, m_overrides);
+            result->Args = Args;
+            return result;
         }
 
     private:
-        std::vector<WorkflowTaskOverride> m_overrides;
+        std::ostream& m_out;
+        std::istream& m_in;
+        std::shared_ptr<std::vector<WorkflowTaskOverride>> m_overrides;
+        bool m_isSubContext = false;
     };
 }
 
@@ -200,6 +245,10 @@ void OverrideForShellExecute(TestContext& context)
     context.Override({ RenameDownloadedInstaller, [](TestContext&)
     {
     } });
+
+    context.Override({ StartInstallerDownload, [](TestContext&)
+    {
+    } });
 }
 
 void OverrideForMSIX(TestContext& context)
@@ -223,6 +272,30 @@ void OverrideForMSIX(TestContext& context)
     } });
 }
 
+std::future<void> AsyncTaskAddsInstallerArgs(Execution::Context& context)
+{
+    // Resume on the thread pool, as a task awaiting I/O would.
+    co_await winrt::resume_background();
+    context.Add<Execution::Data::InstallerArgs>("/async");
+}
+
+std::future<void> AsyncTaskTerminates(Execution::Context& context)
+{
+    co_await winrt::resume_background();
+    context.Terminate(E_ABORT);
+}
+
+std::future<void> AsyncTaskThrows(Execution::Context&)
+{
+    co_await winrt::resume_background();
+    THROW_HR(E_ACCESSDENIED);
+}
+
+void AppendInstallerArgs(Execution::Context& context)
+{
+    context.Get<Execution::Data::InstallerArgs>() += " /sync";
+}
+
 void OverrideForMSStore(TestContext& context)
 {
     context.Override({ MSStoreInstall, [](TestContext& context)
@@ -280,6 +353,32 @@ TEST_CASE("InstallFlowWithNonApplicableArchitecture", "[InstallFlow]")
     REQUIRE(!std::filesystem::exists(installResultPath.GetPath()));
 }
 
+TEST_CASE("ManifestComparator_SelectsFirstBestInstaller", "[InstallFlow]")
+{
+    Manifest manifest;
+    Args args;
+    ManifestComparator comparator{ args };
+
+    // No installers and only inapplicable installers select nothing
+    REQUIRE(!comparator.GetPreferredInstaller(manifest));
+
+    manifest.Installers.resize(1);
+    manifest.Installers[0].Arch = Architecture::Unknown;
+    REQUIRE(!comparator.GetPreferredInstaller(manifest));
+
+    // The first of the installers for the system architecture is chosen over a neutral one
+    manifest.Installers.resize(4);
+    manifest.Installers[1].Arch = Architecture::Neutral;
+    manifest.Installers[2].Arch = GetSystemArchitecture();
+    manifest.Installers[2].Url = "first";
+    manifest.Installers[3].Arch = GetSystemArchitecture();
+    manifest.Installers[3].Url = "second";
+
+    auto index = comparator.GetPreferredInstaller(manifest);
+    REQUIRE(index);
+    REQUIRE(index.value() == 2);
+}
+
 TEST_CASE("MSStoreInstallFlowWithTestManifest", "[InstallFlow]")
 {
     TestCommon::TempFile installResultPath("TestMSStoreInstalled.txt");
@@ -514,6 +613,69 @@ TEST_CASE("InstallFlow_SearchFoundMultipleApp", "[InstallFlow]")
     REQUIRE(installOutput.str().find(Resource::LocString(Resource::String::MultiplePackagesFound).get()) != std::string::npos);
 }
 
+TEST_CASE("InstallFlow_MultiplePackages", "[InstallFlow]")
+{
+    TestCommon::TempFile installResultPath("TestExeInstalled.txt");
+
+    std::ostringstream installOutput;
+    TestContext context{ installOutput, std::cin };
+    OverrideForOpenSource(context);
+    OverrideForShellExecute(context);
+
+    SECTION("One query fails")
+    {
+        context.Args.AddArg(Execution::Args::Type::Query, "TestQueryReturnOne"sv);
+        context.Args.AddArg(Execution::Args::Type::Query, "TestQueryReturnTwo"sv);
+
+        InstallCommand install({});
+        install.Execute(context);
+        INFO(installOutput.str());
+
+        // The package that was found is still installed
+        REQUIRE(std::filesystem::exists(installResultPath.GetPath()));
+        REQUIRE(installOutput.str().find(Resource::LocString(Resource::String::MultiplePackagesFound).get()) != std::string::npos);
+        REQUIRE(installOutput.str().find(Resource::LocString(Resource::String::MultipleInstallFailed).get()) != std::string::npos);
+        REQUIRE_TERMINATED_WITH(context, APPINSTALLER_CLI_ERROR_MULTIPLE_INSTALL_FAILED);
+    }
+    SECTION("Duplicate package")
+    {
+        context.Args.AddArg(Execution::Args::Type::Query, "TestQueryReturnOne"sv);
+        context.Args.AddArg(Execution::Args::Type::Query, "TestQueryReturnOne"sv);
+
+        InstallCommand install({});
+        install.Execute(context);
+        INFO(installOutput.str());
+
+        REQUIRE(std::filesystem::exists(installResultPath.GetPath()));
+        REQUIRE(installOutput.str().find(Resource::LocString(Resource::String::MultipleInstallDuplicatePackage).get()) != std::string::npos);
+        REQUIRE(!context.IsTerminated());
+    }
+    SECTION("MSIX installs alongside")
+    {
+        TestCommon::TempFile msixInstallResultPath("TestMsixInstalled.txt");
+        OverrideForMSIX(context);
+        context.Override({ GetMsixSignatureHash, [](TestContext& context)
+        {
+            const auto& installer = context.Get<Execution::Data::Installer>().value();
+            context.Add<Data::HashPair>({ installer.SignatureSha256, installer.SignatureSha256 });
+        } });
+
+        context.Args.AddArg(Execution::Args::Type::Query, "TestQueryReturnMsix"sv);
+        context.Args.AddArg(Execution::Args::Type::Query, "TestQueryReturnOne"sv);
+
+        InstallCommand install({});
+        install.Execute(context);
+        INFO(installOutput.str());
+
+        // Both are installed, and the output of the MSIX install is reported once it is done
+        REQUIRE(std::filesystem::exists(installResultPath.GetPath()));
+        REQUIRE(std::filesystem::exists(msixInstallResultPath.GetPath()));
+        REQUIRE(installOutput.str().find("1/2: TestQueryReturnMsix") != std::string::npos);
+        REQUIRE(installOutput.str().find("2/2: TestQueryReturnOne") != std::string::npos);
+        REQUIRE(!context.IsTerminated());
+    }
+}
+
 TEST_CASE("InstallFlow_SearchAndShowAppInfo", "[ShowFlow]")
 {
     std::ostringstream showOutput;
@@ -548,4 +710,153 @@ TEST_CASE("InstallFlow_SearchAndShowAppVersion", "[ShowFlow]")
     REQUIRE(showOutput.str().find("1.0.0.0") != std::string::npos);
     // No manifest info is printed
     REQUIRE(showOutput.str().find("  Download Url: https://ThisIsNotUsed") == std::string::npos);
-}
\ No newline at end of file
+}
+
+TEST_CASE("SearchFlow_IdFileFromStandardInput", "[SearchFlow]")
+{
+    std::ostringstream searchOutput;
+    std::istringstream searchInput{ "TestQueryReturnOne\n\n  Not.Found  \n" };
+    TestContext context{ searchOutput, searchInput };
+    OverrideForOpenSource(context);
+    context.Args.AddArg(Execution::Args::Type::IdFile, "-"sv);
+
+    SearchCommand search({});
+    search.Execute(context);
+    INFO(searchOutput.str());
+
+    // The found id is reported, and the missing one is warned about
+    REQUIRE(searchOutput.str().find("AppInstallerCliTest.TestInstaller") != std::string::npos);
+    REQUIRE(searchOutput.str().find(Resource::LocString(Resource::String::IdFileIdNotFound).get() + " Not.Found") != std::string::npos);
+}
+
+TEST_CASE("SearchFlow_JsonLinesOutput", "[SearchFlow]")
+{
+    std::ostringstream searchOutput;
+    TestContext context{ searchOutput, std::cin };
+    OverrideForOpenSource(context);
+    context.Args.AddArg(Execution::Args::Type::Query, "TestQueryReturnTwo"sv);
+    context.Args.AddArg(Execution::Args::Type::Output, "jsonl"sv);
+
+    SearchCommand search({});
+    search.Execute(context);
+    INFO(searchOutput.str());
+
+    // Each match is one JSON object on its own line, with nothing else written
+    std::istringstream lines{ searchOutput.str() };
+    std::vector<Json::Value> values;
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        Json::Value value;
+        std::string errors;
+        std::unique_ptr<Json::CharReader> reader{ Json::CharReaderBuilder{}.newCharReader() };
+        REQUIRE(reader->parse(line.data(), line.data() + line.size(), &value, &errors));
+        values.emplace_back(std::move(value));
+    }
+
+    REQUIRE(values.size() == 2);
+    REQUIRE(values[0]["Id"].asString() == "AppInstallerCliTest.TestInstaller");
+    REQUIRE(values[0]["Version"].asString() == "1.0.0.0");
+    REQUIRE(values[0]["MatchField"].asString() == "Id");
+    REQUIRE(values[0]["MatchValue"].asString() == "TestQueryReturnTwo");
+    REQUIRE(searchOutput.str().find(Resource::LocString(Resource::String::SearchName).get()) == std::string::npos);
+}
+
+TEST_CASE("SearchFlow_OutputFormatNotSupported", "[SearchFlow]")
+{
+    Execution::Args args;
+    args.AddArg(Execution::Args::Type::Query, "TestQueryReturnOne"sv);
+    args.AddArg(Execution::Args::Type::Output, "xml"sv);
+
+    SearchCommand search({});
+    REQUIRE_THROWS_AS(search.ValidateArguments(args), CommandException);
+
+    args = {};
+    args.AddArg(Execution::Args::Type::Query, "TestQueryReturnOne"sv);
+    args.AddArg(Execution::Args::Type::Output, "JSONL"sv);
+    search.ValidateArguments(args);
+}
+
+TEST_CASE("ExecutionContext_DataSlots", "[ExecutionContext]")
+{
+    std::ostringstream output;
+    Execution::Context context{ output, std::cin };
+
+    REQUIRE(!context.Contains(Execution::Data::InstallerArgs));
+    REQUIRE_THROWS_HR(context.Get<Execution::Data::InstallerArgs>(), HRESULT_FROM_WIN32(ERROR_INVALID_STATE));
+
+    context.Add<Execution::Data::InstallerArgs>("/silent");
+    REQUIRE(context.Contains(Execution::Data::InstallerArgs));
+    REQUIRE(context.Contains<Execution::Data::InstallerArgs>());
+    REQUIRE(!context.Contains(Execution::Data::InstallerPath));
+    REQUIRE(context.Get<Execution::Data::InstallerArgs>() == "/silent");
+
+    // Get modifies in place, and Add overwrites
+    context.Get<Execution::Data::InstallerArgs>() += " /norestart";
+    REQUIRE(context.Get<Execution::Data::InstallerArgs>() == "/silent /norestart");
+    context.Add<Execution::Data::InstallerArgs>("/quiet");
+    REQUIRE(context.Get<Execution::Data::InstallerArgs>() == "/quiet");
+
+    // Extract leaves the context without the data
+    std::string extracted = context.Extract<Execution::Data::InstallerArgs>();
+    REQUIRE(extracted == "/quiet");
+    REQUIRE(!context.Contains(Execution::Data::InstallerArgs));
+    REQUIRE_THROWS_HR(context.Extract<Execution::Data::InstallerArgs>(), HRESULT_FROM_WIN32(ERROR_INVALID_STATE));
+}
+
+TEST_CASE("WorkflowTask_AsyncTask", "[ExecutionContext]")
+{
+    std::ostringstream output;
+    Execution::Context context{ output, std::cin };
+
+    // The next task only runs once the coroutine has completed
+    context <<
+        AsyncTaskAddsInstallerArgs <<
+        AppendInstallerArgs;
+
+    REQUIRE(!context.IsTerminated());
+    REQUIRE(context.Get<Execution::Data::InstallerArgs>() == "/async /sync");
+
+    REQUIRE(WorkflowTask{ AsyncTaskAddsInstallerArgs } == WorkflowTask{ AsyncTaskAddsInstallerArgs });
+    REQUIRE(!(WorkflowTask{ AsyncTaskAddsInstallerArgs } == WorkflowTask{ AsyncTaskTerminates }));
+    REQUIRE(!(WorkflowTask{ AsyncTaskAddsInstallerArgs } == WorkflowTask{ AppendInstallerArgs }));
+}
+
+TEST_CASE("WorkflowTask_AsyncTaskTerminates", "[ExecutionContext]")
+{
+    std::ostringstream output;
+    Execution::Context context{ output, std::cin };
+    context.Add<Execution::Data::InstallerArgs>("");
+
+    context <<
+        AsyncTaskTerminates <<
+        AppendInstallerArgs;
+
+    REQUIRE(context.IsTerminated());
+    REQUIRE(context.GetTerminationHR() == E_ABORT);
+    REQUIRE(context.Get<Execution::Data::InstallerArgs>().empty());
+}
+
+TEST_CASE("WorkflowTask_AsyncTaskThrows", "[ExecutionContext]")
+{
+    std::ostringstream output;
+    Execution::Context context{ output, std::cin };
+
+    REQUIRE_THROWS_HR(context << AsyncTaskThrows, E_ACCESSDENIED);
+}
+
+TEST_CASE("WorkflowTask_AsyncTaskOverride", "[ExecutionContext]")
+{
+    std::ostringstream output;
+    TestContext context{ output, std::cin };
+    context.Override({ AsyncTaskAddsInstallerArgs, [](TestContext& context)
+    {
+        context.Add<Execution::Data::InstallerArgs>("/override");
+    } });
+
+    context <<
+        AsyncTaskAddsInstallerArgs <<
+        AppendInstallerArgs;
+
+    REQUIRE(context.Get<Execution::Data::InstallerArgs>() == "/override /sync");
+}
@@ -0,0 +1,166 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <Microsoft/SQLiteIndexSource.h>
+#include <WorkloadTrace.h>
+#include <winget/ManifestYamlParser.h>
+
+using namespace std::string_literals;
+using namespace std::chrono_literals;
+using namespace TestCommon;
+using namespace AppInstaller::Logging;
+using namespace AppInstaller::Manifest;
+using namespace AppInstaller::Repository;
+using namespace AppInstaller::Repository::Microsoft;
+using namespace AppInstaller::Repository::Workload;
+
+TEST_CASE("WorkloadTrace_RecordAndRead", "[workload]")
+{
+    TempFile traceFile{ "workload"s, ".jsonl"s };
+
+    // Nothing is recorded until recording is enabled
+    {
+        CommandRecorder recorder{ { "search", "before" } };
+        recorder.End(S_OK);
+    }
+
+    EnableRecording(traceFile);
+    auto disableRecording = wil::scope_exit([]() { DisableRecording(); });
+    REQUIRE(IsRecording());
+
+    SourceDetails details;
+    details.Name = "TestSource";
+    details.Type = "Microsoft.PreIndexed.Package";
+    details.Arg = "https://example.com/cache";
+    details.LastUpdateTime = AppInstaller::Utility::ConvertUnixEpochToSystemClock(1600000000);
+    details.DataETag = "\"etag\"";
+
+    SearchRequest request;
+    request.Query = RequestMatch{ MatchType::Substring, "query" };
+    request.Inclusions.emplace_back(ApplicationMatchField::Moniker, MatchType::StartsWith, "moniker");
+    request.Filters.emplace_back(ApplicationMatchField::Tag, MatchType::Exact, "tag");
+    request.MaximumResults = 10;
+
+    {
+        CommandRecorder recorder{ { "search", "query" } };
+        RecordSource(details);
+        RecordSearch(request, 3, 1500us);
+
+        {
+            ScopedPerformanceTimer timer{ PerformanceOperation::IndexSearch };
+        }
+
+        recorder.End(E_ABORT);
+    }
+
+    {
+        CommandRecorder recorder{ { "install", "--id-file", "ids.txt" } };
+        RecordSearchForIds({ "Id.One", "Id.Two" }, 1, 200us);
+    }
+
+    // Records outside of a command are not kept
+    RecordSearch(request, 1, 1us);
+
+    DisableRecording();
+    REQUIRE(!IsRecording());
+
+    std::vector<RecordedCommand> commands = ReadTrace(traceFile);
+    REQUIRE(commands.size() == 2);
+
+    const RecordedCommand& search = commands[0];
+    REQUIRE(search.Process == GetCurrentProcessId());
+    REQUIRE(search.Args == std::vector<std::string>{ "search", "query" });
+    REQUIRE(search.Result == E_ABORT);
+
+    REQUIRE(search.Sources.size() == 1);
+    REQUIRE(search.Sources[0].Name == details.Name);
+    REQUIRE(search.Sources[0].Type == details.Type);
+    REQUIRE(search.Sources[0].Arg == details.Arg);
+    REQUIRE(search.Sources[0].LastUpdateTime == details.LastUpdateTime);
+    REQUIRE(search.Sources[0].DataETag == details.DataETag);
+
+    REQUIRE(search.Searches.size() == 1);
+    const RecordedSearch& recordedSearch = search.Searches[0];
+    REQUIRE(!recordedSearch.IsForIds);
+    REQUIRE(recordedSearch.Summary == request.ToString());
+    REQUIRE(recordedSearch.Request.ToString() == request.ToString());
+    REQUIRE(recordedSearch.Request.Inclusions[0].Field == ApplicationMatchField::Moniker);
+    REQUIRE(recordedSearch.Request.Filters[0].Type == MatchType::Exact);
+    REQUIRE(recordedSearch.Request.MaximumResults == 10);
+    REQUIRE(recordedSearch.ResultCount == 3);
+    REQUIRE(recordedSearch.Duration == 1500us);
+
+    REQUIRE(std::any_of(search.Operations.begin(), search.Operations.end(),
+        [](const RecordedOperation& operation) { return operation.Name == ToString(PerformanceOperation::IndexSearch) && operation.Count == 1; }));
+
+    // A command that did not end is still read
+    const RecordedCommand& install = commands[1];
+    REQUIRE(install.Command > search.Command);
+    REQUIRE(!install.Result);
+    REQUIRE(install.Searches.size() == 1);
+    REQUIRE(install.Searches[0].IsForIds);
+    REQUIRE(install.Searches[0].Ids == std::vector<std::string>{ "Id.One", "Id.Two" });
+}
+
+TEST_CASE("WorkloadTrace_SkipsIncompleteLines", "[workload]")
+{
+    TempFile traceFile{ "workload"s, ".jsonl"s };
+
+    {
+        std::ofstream stream{ traceFile.GetPath(), std::ios::binary };
+        stream << R"({"Type":"Command","Process":1,"Command":1,"Args":["list"]})" << '\n';
+        stream << R"({"Type":"SearchForIds","Process":2,"Command":1,"Ids":["Orphan"],"Results":0,"Microseconds":1})" << '\n';
+        stream << R"({"Type":"Search","Process":1,"Command":1,"Request":{"Query":{"Type":"NotAType","Value":"x"}}})" << '\n';
+        stream << R"({"Type":"End","Process":1,"Command":1,"Result":0,"Micro)";
+    }
+
+    std::vector<RecordedCommand> commands = ReadTrace(traceFile);
+    REQUIRE(commands.size() == 1);
+    REQUIRE(commands[0].Args == std::vector<std::string>{ "list" });
+    REQUIRE(commands[0].Searches.empty());
+    REQUIRE(!commands[0].Result);
+}
+
+TEST_CASE("WorkloadTrace_ReplayAgainstIndex", "[workload]")
+{
+    TempFile indexFile{ "repolibtest_tempdb"s, ".db"s };
+    TempFile traceFile{ "workload"s, ".jsonl"s };
+
+    TestDataFile testManifest("Manifest-Good.yaml");
+    Manifest manifest = YamlParser::CreateFromPath(testManifest);
+
+    {
+        SQLiteIndex index = SQLiteIndex::CreateNew(indexFile, Schema::Version::Latest());
+        index.AddManifest(manifest, testManifest.GetPath().filename().u8string());
+    }
+
+    SearchRequest request;
+    request.Query = RequestMatch{ MatchType::Exact, manifest.Id };
+
+    EnableRecording(traceFile);
+    {
+        auto disableRecording = wil::scope_exit([]() { DisableRecording(); });
+
+        CommandRecorder recorder{ { "show", manifest.Id } };
+        RecordSearch(request, 1, 10us);
+        RecordSearchForIds({ manifest.Id, "Not.An.Id" }, 1, 10us);
+        recorder.End(S_OK);
+    }
+
+    std::vector<RecordedCommand> commands = ReadTrace(traceFile);
+
+    SourceDetails details;
+    details.Name = "Replay";
+    auto source = std::make_shared<SQLiteIndexSource>(details, SQLiteIndex::Open(indexFile, SQLiteIndex::OpenDisposition::Read));
+
+    std::vector<ReplayedSearch> replayed = Replay(commands, *source);
+    REQUIRE(replayed.size() == 2);
+    REQUIRE(replayed[0].Command == &commands[0]);
+    REQUIRE(!replayed[0].Search->IsForIds);
+    REQUIRE(replayed[0].ResultCount == 1);
+    REQUIRE(replayed[1].Search->IsForIds);
+    REQUIRE(replayed[1].ResultCount == 1);
+
+    REQUIRE(ConvertToJson(replayed).find("\"RecordedMicroseconds\" : 10") != std::string::npos);
+}
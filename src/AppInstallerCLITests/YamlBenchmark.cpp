@@ -0,0 +1,340 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "TestCommon.h"
+#include <winget/ManifestYamlParser.h>
+#include <winget/Yaml.h>
+
+#include <chrono>
+#include <psapi.h>
+
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+using namespace TestCommon;
+using namespace AppInstaller;
+using namespace AppInstaller::Manifest;
+
+// These benchmarks are not run by default; use "[benchmark]" to run them, and "-benchout <file>" to write the results as JSON lines.
+// Use "-benchbaseline <file>" with the results of a previous run to check the thresholded metrics for regressions.
+// The inputs are deterministic, so that results can be compared between runs.
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Each case processes its input repeatedly until at least this many bytes have been processed.
+    constexpr size_t s_BytesPerCase = 16 * 1024 * 1024;
+
+    // The number of copies of a document that are held at once to measure the memory of each.
+    constexpr size_t s_DocumentsHeld = 100;
+
+    // How much worse than the baseline a metric can be; throughput is noisy, while allocations are deterministic.
+    constexpr double s_ThroughputTolerance = 0.2;
+    constexpr double s_AllocationTolerance = 0.05;
+    constexpr double s_MemoryTolerance = 0.1;
+
+    // The languages of the installers and localizations of the generated manifests.
+    constexpr std::string_view s_Languages[] =
+    {
+        "ar-SA"sv, "cs-CZ"sv, "da-DK"sv, "de-DE"sv, "el-GR"sv, "en-GB"sv, "en-US"sv, "es-ES"sv, "es-MX"sv, "fi-FI"sv,
+        "fr-CA"sv, "fr-FR"sv, "he-IL"sv, "hu-HU"sv, "it-IT"sv, "ja-JP"sv, "ko-KR"sv, "nb-NO"sv, "nl-NL"sv, "pl-PL"sv,
+        "pt-BR"sv, "pt-PT"sv, "ro-RO"sv, "ru-RU"sv, "sk-SK"sv, "sv-SE"sv, "th-TH"sv, "tr-TR"sv, "uk-UA"sv, "zh-CN"sv,
+    };
+
+    constexpr std::string_view s_Architectures[] = { "x86"sv, "x64"sv, "arm"sv, "arm64"sv };
+
+    struct BenchmarkInput
+    {
+        std::string Name;
+        std::string Content;
+        // If true, the content is a manifest that YamlParser can create a manifest from.
+        bool IsManifest = false;
+    };
+
+    std::string ReadTestData(const std::filesystem::path& path)
+    {
+        std::ifstream stream{ TestDataFile{ path }.GetPath(), std::ios::binary };
+        std::ostringstream content;
+        content << stream.rdbuf();
+        return content.str();
+    }
+
+    // The start of a manifest, before its installers and localizations.
+    std::string GetManifestHeader()
+    {
+        return R"(Id: Publisher.Benchmark.Application
+Name: Benchmark Application
+AppMoniker: benchmark
+Version: 1.2.3.4
+Publisher: Benchmark Publisher
+Author: Benchmark Author
+License: MIT License
+LicenseUrl: https://example.com/benchmark/LICENSE
+MinOSVersion: 10.0.0.0
+Description: A generated manifest, used to measure the throughput of reading manifests with many installers and localizations.
+Homepage: https://example.com/benchmark
+Tags: "benchmark,generated,yaml,manifest"
+Commands: "benchmark,bench"
+InstallerType: Exe
+Switches:
+  Silent: /S
+  SilentWithProgress: /S /progress
+)";
+    }
+
+    // A manifest with an installer for every language and architecture.
+    std::string GetLargeManifest()
+    {
+        std::string result = GetManifestHeader();
+        result += "Installers:\n";
+
+        for (std::string_view language : s_Languages)
+        {
+            for (std::string_view arch : s_Architectures)
+            {
+                result += "  - Arch: "s + std::string{ arch } + "\n";
+                result += "    Url: https://example.com/benchmark/" + std::string{ language } + "/setup-" + std::string{ arch } + ".exe\n";
+                result += "    Sha256: 69D84CA8899800A5575CE31798293CD4FEBAB1D734A07C2E51E56A28E0DF8C82\n";
+                result += "    Language: "s + std::string{ language } + "\n";
+                result += "    Scope: user\n";
+                result += "    Switches:\n";
+                result += "      Custom: /lang=" + std::string{ language } + "\n";
+            }
+        }
+
+        result += "ManifestVersion: 0.1.0\n";
+        return result;
+    }
+
+    // A manifest with a localization for every language.
+    std::string GetMultiLocalizationManifest()
+    {
+        std::string result = GetManifestHeader();
+        result += R"(Installers:
+  - Arch: x64
+    Url: https://example.com/benchmark/setup-x64.exe
+    Sha256: 69D84CA8899800A5575CE31798293CD4FEBAB1D734A07C2E51E56A28E0DF8C82
+    Language: en-US
+Localization:
+)";
+
+        for (std::string_view language : s_Languages)
+        {
+            result += "  - Language: "s + std::string{ language } + "\n";
+            result += "    Description: The description of the generated benchmark application, translated into " + std::string{ language } + "\n";
+            result += "    Homepage: https://example.com/benchmark/" + std::string{ language } + "\n";
+            result += "    LicenseUrl: https://example.com/benchmark/" + std::string{ language } + "/LICENSE\n";
+        }
+
+        result += "ManifestVersion: 0.1.0\n";
+        return result;
+    }
+
+    // The sources metadata setting, as written by the source code, for the given number of sources.
+    std::string GetSourcesMetadata(size_t sourceCount)
+    {
+        std::string result = "Sources:\n";
+
+        for (size_t i = 0; i < sourceCount; ++i)
+        {
+            result += "  - Name: source" + std::to_string(i) + "\n";
+            result += "    LastUpdate: " + std::to_string(1600000000 + i * 3600) + "\n";
+            result += "    DataETag: \"0x8D8" + std::to_string(1000000 + i) + "\"\n";
+            result += "    DataLastModified: Tue, 15 Sep 2020 18:00:" + std::to_string(10 + i % 50) + " GMT\n";
+        }
+
+        return result;
+    }
+
+    std::vector<BenchmarkInput> GetInputs()
+    {
+        std::vector<BenchmarkInput> result;
+        result.push_back({ "manifest_small", ReadTestData("Manifest-Good.yaml"), true });
+        result.push_back({ "manifest_large", GetLargeManifest(), true });
+        result.push_back({ "manifest_localizations", GetMultiLocalizationManifest(), true });
+        result.push_back({ "sources_metadata_small", GetSourcesMetadata(2), false });
+        result.push_back({ "sources_metadata_large", GetSourcesMetadata(100), false });
+        return result;
+    }
+
+    // Emits the node, in the same way as the code that writes settings and manifests.
+    void EmitNode(YAML::Emitter& out, const YAML::Node& node)
+    {
+        if (node.IsMap())
+        {
+            out << YAML::BeginMap;
+            for (const auto& [key, value] : node.Mapping())
+            {
+                out << YAML::Key << key.as<std::string>() << YAML::Value;
+                EmitNode(out, value);
+            }
+            out << YAML::EndMap;
+        }
+        else if (node.IsSequence())
+        {
+            out << YAML::BeginSeq;
+            for (const auto& child : node.Sequence())
+            {
+                EmitNode(out, child);
+            }
+            out << YAML::EndSeq;
+        }
+        else
+        {
+            out << (node.IsNull() ? std::string{} : node.as<std::string>());
+        }
+    }
+
+    // Records the throughput of the function in MB/s of the input processed.
+    template <typename Function>
+    void RecordThroughput(std::string_view benchmark, const std::string& metric, size_t inputSize, Function&& function)
+    {
+        size_t iterations = std::max<size_t>(1, s_BytesPerCase / inputSize);
+
+        // Once first, so that one time initialization is not measured.
+        function();
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            function();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        double megabytes = static_cast<double>(inputSize * iterations) / (1024 * 1024);
+        BenchmarkResults::RecordWithThreshold(benchmark, metric + ".throughput", megabytes / seconds, "MB/s", BenchmarkResults::Better::Higher, s_ThroughputTolerance);
+    }
+
+#ifdef _DEBUG
+    std::atomic<size_t> s_AllocationCount{ 0 };
+
+    int __cdecl CountAllocation(int allocType, void*, size_t, int, long, const unsigned char*, int)
+    {
+        if (allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC)
+        {
+            ++s_AllocationCount;
+        }
+
+        return TRUE;
+    }
+#endif
+
+    // Records the number of heap allocations made by one call to the function.
+    // The debug heap is what counts them, so they are only recorded for debug builds.
+    template <typename Function>
+    void RecordAllocations(std::string_view benchmark, const std::string& metric, Function&& function)
+    {
+#ifdef _DEBUG
+        // Once first, so that one time initialization is not counted.
+        function();
+
+        _CRT_ALLOC_HOOK previous = _CrtSetAllocHook(CountAllocation);
+        size_t start = s_AllocationCount;
+
+        function();
+
+        size_t count = s_AllocationCount - start;
+        _CrtSetAllocHook(previous);
+
+        BenchmarkResults::RecordWithThreshold(benchmark, metric + ".allocations", static_cast<double>(count), "allocations/document", BenchmarkResults::Better::Lower, s_AllocationTolerance);
+#else
+        UNREFERENCED_PARAMETER(benchmark);
+        UNREFERENCED_PARAMETER(metric);
+        UNREFERENCED_PARAMETER(function);
+#endif
+    }
+
+    size_t GetPrivateBytes()
+    {
+        PROCESS_MEMORY_COUNTERS_EX counters{};
+        THROW_IF_WIN32_BOOL_FALSE(GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters)));
+        return counters.PrivateUsage;
+    }
+
+    // Records the memory held by each result of the function, from the private bytes of the process while many are held.
+    template <typename Function>
+    void RecordMemory(std::string_view benchmark, const std::string& metric, Function&& function)
+    {
+        using result_t = decltype(function());
+        std::vector<result_t> held;
+        held.reserve(s_DocumentsHeld);
+
+        size_t before = GetPrivateBytes();
+        for (size_t i = 0; i < s_DocumentsHeld; ++i)
+        {
+            held.emplace_back(function());
+        }
+        size_t after = GetPrivateBytes();
+
+        double perDocument = (after > before ? static_cast<double>(after - before) / s_DocumentsHeld : 0.0);
+        BenchmarkResults::RecordWithThreshold(benchmark, metric + ".memory", perDocument, "bytes/document", BenchmarkResults::Better::Lower, s_MemoryTolerance);
+    }
+
+    void RecordPeakWorkingSet(std::string_view benchmark)
+    {
+        PROCESS_MEMORY_COUNTERS counters{};
+        THROW_IF_WIN32_BOOL_FALSE(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)));
+        BenchmarkResults::Record(benchmark, "peak_working_set", static_cast<double>(counters.PeakWorkingSetSize) / (1024 * 1024), "MB");
+    }
+}
+
+TEST_CASE("Yaml_Benchmark_Load", "[.][benchmark]")
+{
+    constexpr std::string_view benchmark = "Yaml_Load"sv;
+
+    for (const auto& input : GetInputs())
+    {
+        RecordThroughput(benchmark, input.Name, input.Content.size(), [&]() { return YAML::Load(input.Content); });
+        RecordAllocations(benchmark, input.Name, [&]() { return YAML::Load(input.Content); });
+        RecordMemory(benchmark, input.Name, [&]() { return YAML::Load(input.Content); });
+    }
+
+    RecordPeakWorkingSet(benchmark);
+}
+
+TEST_CASE("Yaml_Benchmark_Emit", "[.][benchmark]")
+{
+    constexpr std::string_view benchmark = "Yaml_Emit"sv;
+
+    for (const auto& input : GetInputs())
+    {
+        YAML::Node document = YAML::Load(input.Content);
+
+        auto emit = [&]()
+        {
+            YAML::Emitter out;
+            EmitNode(out, document);
+            return out.str();
+        };
+
+        // The throughput is of the size of the output, which is what the emitter produces.
+        size_t outputSize = emit().size();
+        RecordThroughput(benchmark, input.Name, outputSize, emit);
+        RecordAllocations(benchmark, input.Name, emit);
+    }
+
+    RecordPeakWorkingSet(benchmark);
+}
+
+TEST_CASE("Yaml_Benchmark_ManifestParse", "[.][benchmark]")
+{
+    constexpr std::string_view benchmark = "Yaml_ManifestParse"sv;
+
+    for (const auto& input : GetInputs())
+    {
+        if (!input.IsManifest)
+        {
+            continue;
+        }
+
+        RecordThroughput(benchmark, input.Name, input.Content.size(), [&]() { return YamlParser::Create(input.Content); });
+        RecordThroughput(benchmark, input.Name + ".full_validation", input.Content.size(), [&]() { return YamlParser::Create(input.Content, true); });
+        RecordAllocations(benchmark, input.Name, [&]() { return YamlParser::Create(input.Content); });
+        RecordMemory(benchmark, input.Name, [&]() { return YamlParser::Create(input.Content); });
+    }
+
+    RecordPeakWorkingSet(benchmark);
+}
@@ -2,8 +2,11 @@
 // Licensed under the MIT License.
 #include "pch.h"
 #include "TestCommon.h"
+#include <AppInstallerErrors.h>
 #include <AppInstallerSHA256.h>
+#include <winget/ManifestDirectoryValidation.h>
 #include <winget/ManifestYamlParser.h>
+#include <winget/Yaml.h>
 
 using namespace TestCommon;
 using namespace AppInstaller::Manifest;
@@ -101,11 +104,34 @@ TEST_CASE("ReadGoodManifestAndVerifyContents", "[ManifestValidation]")
     REQUIRE(manifest.Localization.size() == 1);
     ManifestLocalization localization1 = manifest.Localization.at(0);
     REQUIRE(localization1.Language == "es-MX");
+
+    // Only the language is decoded with the manifest; the rest waits until the localization is needed
+    REQUIRE(!localization1.IsDecoded());
+    localization1.Decode();
+    REQUIRE(localization1.IsDecoded());
     REQUIRE(localization1.Description == "El proyecto MSIX SDK es habilita desarrolladores de diferentes");
     REQUIRE(localization1.Homepage == "https://github.com/microsoft/msix-packaging/es-MX");
     REQUIRE(localization1.LicenseUrl == "https://github.com/microsoft/msix-packaging/blob/master/LICENSE-es-MX");
 }
 
+TEST_CASE("ReadGoodManifest_LocalizationDecodedForFullValidation", "[ManifestValidation]")
+{
+    Manifest manifest = YamlParser::CreateFromPath(TestDataFile("Manifest-Good.yaml"), true);
+
+    REQUIRE(manifest.Localization.size() == 1);
+    const ManifestLocalization& localization = manifest.Localization[0];
+    REQUIRE(localization.IsDecoded());
+    REQUIRE(localization.Language == "es-MX");
+    REQUIRE(localization.Homepage == "https://github.com/microsoft/msix-packaging/es-MX");
+
+    // A copy that is decoded later has the same values as one decoded with the manifest
+    ManifestLocalization deferred = YamlParser::CreateFromPath(TestDataFile("Manifest-Good.yaml")).Localization[0];
+    deferred.Decode();
+    REQUIRE(deferred.Description == localization.Description);
+    REQUIRE(deferred.Homepage == localization.Homepage);
+    REQUIRE(deferred.LicenseUrl == localization.LicenseUrl);
+}
+
 TEST_CASE("ReadGoodManifestWithSpaces", "[ManifestValidation]")
 {
     Manifest manifest = YamlParser::CreateFromPath(TestDataFile("Manifest-Good-Spaces.yaml"));
@@ -255,3 +281,275 @@ TEST_CASE("ManifestEncoding", "[ManifestValidation]")
         REQUIRE(manifest.Name == u8"MSIX SDK\xA9");
     }
 }
+
+TEST_CASE("ManifestFieldValidators", "[ManifestValidation]")
+{
+    REQUIRE(FieldValidators::IsManifestVersion("0.1.0"));
+    REQUIRE(FieldValidators::IsManifestVersion("65535.65535.65535"));
+    REQUIRE_FALSE(FieldValidators::IsManifestVersion("1.0"));
+    REQUIRE_FALSE(FieldValidators::IsManifestVersion("1.0.0.0"));
+    REQUIRE_FALSE(FieldValidators::IsManifestVersion("1.01.0"));
+    REQUIRE_FALSE(FieldValidators::IsManifestVersion("1.65536.0"));
+    REQUIRE_FALSE(FieldValidators::IsManifestVersion("1..0"));
+    REQUIRE_FALSE(FieldValidators::IsManifestVersion("1.0.0."));
+
+    REQUIRE(FieldValidators::IsMinOSVersion("10"));
+    REQUIRE(FieldValidators::IsMinOSVersion("10.0.17763.0"));
+    REQUIRE_FALSE(FieldValidators::IsMinOSVersion(""));
+    REQUIRE_FALSE(FieldValidators::IsMinOSVersion("10.0.17763.0.1"));
+    REQUIRE_FALSE(FieldValidators::IsMinOSVersion("10.0a"));
+
+    REQUIRE(FieldValidators::IsPackageId("Publisher.Package"));
+    REQUIRE(FieldValidators::IsPackageId("a..b"));
+    REQUIRE_FALSE(FieldValidators::IsPackageId("Package"));
+    REQUIRE_FALSE(FieldValidators::IsPackageId(".Package"));
+    REQUIRE_FALSE(FieldValidators::IsPackageId("Package."));
+    REQUIRE_FALSE(FieldValidators::IsPackageId("Publisher.My Package"));
+
+    REQUIRE(FieldValidators::IsPackageVersion("1.0.0-beta+1"));
+    REQUIRE_FALSE(FieldValidators::IsPackageVersion(""));
+    REQUIRE_FALSE(FieldValidators::IsPackageVersion("1.0/2"));
+    REQUIRE_FALSE(FieldValidators::IsPackageVersion("1.0\t"));
+
+    REQUIRE(FieldValidators::IsSha256(std::string(64, 'a')));
+    REQUIRE(FieldValidators::IsSha256(std::string(32, 'F') + std::string(32, '9')));
+    REQUIRE_FALSE(FieldValidators::IsSha256(std::string(63, 'a')));
+    REQUIRE_FALSE(FieldValidators::IsSha256(std::string(64, 'g')));
+
+    REQUIRE(FieldValidators::IsChunkSize("65536"));
+    REQUIRE(FieldValidators::IsChunkSize("4294967296"));
+    REQUIRE_FALSE(FieldValidators::IsChunkSize(""));
+    REQUIRE_FALSE(FieldValidators::IsChunkSize("0"));
+    REQUIRE_FALSE(FieldValidators::IsChunkSize("065536"));
+    REQUIRE_FALSE(FieldValidators::IsChunkSize("65537"));
+    REQUIRE_FALSE(FieldValidators::IsChunkSize("4295032832"));
+    REQUIRE_FALSE(FieldValidators::IsChunkSize("-65536"));
+}
+
+TEST_CASE("ReadManifestWithChunkedSha256", "[ManifestValidation]")
+{
+    std::string installer = R"(
+ManifestVersion: 0.1.0
+Id: Microsoft.Chunked
+Name: Chunked
+Version: 1.0.0
+Publisher: Microsoft
+License: Test
+Installers:
+  - Arch: x64
+    Url: https://example.com/installer.exe
+    Sha256: 0000000000000000000000000000000000000000000000000000000000000000
+    InstallerType: zip
+)";
+
+    Manifest manifest = YamlParser::Create(installer + "    ChunkedSha256: " + std::string(64, 'a') + "\n    ChunkSize: 1048576\n", true);
+    REQUIRE(manifest.Installers[0].ChunkedSha256 == AppInstaller::Utility::SHA256::ConvertToBytes(std::string(64, 'a')));
+    REQUIRE(manifest.Installers[0].ChunkSize == 1048576);
+
+    // Either one without the other cannot be used
+    REQUIRE_THROWS_AS(YamlParser::Create(installer + "    ChunkSize: 1048576\n", true), ManifestException);
+    REQUIRE_THROWS_AS(YamlParser::Create(installer + "    ChunkedSha256: " + std::string(64, 'a') + "\n", true), ManifestException);
+    REQUIRE_THROWS_AS(YamlParser::Create(installer + "    ChunkedSha256: " + std::string(64, 'a') + "\n    ChunkSize: 1000\n", true), ManifestException);
+}
+
+TEST_CASE("ReadManifestWithMirrorUrls", "[ManifestValidation]")
+{
+    std::string installer = R"(
+ManifestVersion: 0.1.0
+Id: Microsoft.Mirrored
+Name: Mirrored
+Version: 1.0.0
+Publisher: Microsoft
+License: Test
+Installers:
+  - Arch: x64
+    Url: https://example.com/installer.exe
+    Sha256: 0000000000000000000000000000000000000000000000000000000000000000
+    InstallerType: zip
+)";
+
+    Manifest manifest = YamlParser::Create(installer + "    MirrorUrls:\n      - https://one.example.com/installer.exe\n      - https://two.example.com/installer.exe\n", true);
+    REQUIRE(manifest.Installers[0].MirrorUrls == std::vector<std::string>{ "https://one.example.com/installer.exe", "https://two.example.com/installer.exe" });
+
+    // A mirror must be a secure remote location
+    REQUIRE_THROWS_AS(YamlParser::Create(installer + "    MirrorUrls:\n      - http://one.example.com/installer.exe\n", true), ManifestException);
+    REQUIRE_THROWS_AS(YamlParser::Create(installer + "    MirrorUrls:\n      - C:\\installer.exe\n", true), ManifestException);
+}
+
+TEST_CASE("ReadGoodManifest_AllocationBudget", "[ManifestValidation]")
+{
+    // A ceiling well above the current count, that only a large regression reaches; lower it along with improvements.
+    constexpr size_t s_ManifestGoodParseAllocationBudget = 4000;
+
+    std::ifstream stream{ TestDataFile("Manifest-Good.yaml").GetPath(), std::ios::binary };
+    std::ostringstream content;
+    content << stream.rdbuf();
+    std::string input = content.str();
+
+    // Once first, so that one time initialization is not counted
+    YamlParser::Create(input);
+
+    auto countParse = [&]()
+    {
+        TestCommon::AllocationCounter counter;
+        Manifest manifest = YamlParser::Create(input);
+        return counter.GetCount();
+    };
+
+    size_t first = countParse();
+    size_t second = countParse();
+    INFO("Allocations to parse the manifest: " << first);
+
+    // Nothing is held between parses, so each one allocates the same
+    REQUIRE(first == second);
+    if (AllocationCounter::BudgetsApply)
+    {
+        REQUIRE(first <= s_ManifestGoodParseAllocationBudget);
+    }
+}
+
+TEST_CASE("YamlNodeMapping", "[ManifestValidation]")
+{
+    auto document = AppInstaller::YAML::Load(std::string_view{ "b: 2\na: 1\nc:\n  - x\n  - y\nb: 3\n" });
+
+    REQUIRE(document["a"].as<std::string>() == "1");
+    REQUIRE(!document["d"].IsDefined());
+    REQUIRE_THROWS_HR(document["b"], APPINSTALLER_CLI_ERROR_YAML_DUPLICATE_MAPPING_KEY);
+
+    // The mapping is iterated in document order
+    std::vector<std::string> entries;
+    for (const auto& entry : document.Mapping())
+    {
+        entries.emplace_back(entry.first.as<std::string>() + (entry.second.IsScalar() ? entry.second.as<std::string>() : ""));
+    }
+    REQUIRE(entries == std::vector<std::string>{ "b2", "a1", "c", "b3" });
+
+    // Copies of a node share its children
+    AppInstaller::YAML::Node sequence = document["c"];
+    REQUIRE(sequence.size() == 2);
+    REQUIRE(&sequence[1] == &document["c"][1]);
+    REQUIRE(sequence[1].as<std::string>() == "y");
+}
+
+TEST_CASE("YamlNodeAliases", "[ManifestValidation]")
+{
+    auto document = AppInstaller::YAML::Load(std::string_view{ "a: &anchor\n  b: 1\nc: *anchor\nd: &scalar x\ne: *scalar\n" });
+
+    REQUIRE(document["c"]["b"].as<std::string>() == "1");
+    REQUIRE(document["e"].as<std::string>() == "x");
+
+    REQUIRE_THROWS_AS(AppInstaller::YAML::Load(std::string_view{ "a: *missing\n" }), AppInstaller::YAML::Exception);
+}
+
+TEST_CASE("YamlEmitter", "[ManifestValidation]")
+{
+    using namespace AppInstaller;
+
+    YAML::Emitter out;
+    out << YAML::BeginMap;
+    out << YAML::Key << "Name" << YAML::Value << "value: with a colon";
+    out << YAML::Key << "Count" << YAML::Value << static_cast<int64_t>(42);
+    out << YAML::Key << "Enabled" << YAML::Value << true;
+    out << YAML::Key << "Items" << YAML::BeginSeq << "a" << YAML::BeginMap << YAML::Key << "b" << YAML::Value << "c" << YAML::EndMap << YAML::EndSeq;
+    out << YAML::Key << "Empty" << YAML::Value << "";
+
+    // The result can only be retrieved once the containers are closed
+    REQUIRE_THROWS_HR(out.str(), APPINSTALLER_CLI_ERROR_YAML_INVALID_EMITTER_STATE);
+    out << YAML::EndMap;
+
+    REQUIRE_THROWS_HR(out << YAML::BeginMap, APPINSTALLER_CLI_ERROR_YAML_INVALID_EMITTER_STATE);
+
+    std::string result = out.str();
+    auto document = YAML::Load(result);
+
+    REQUIRE(document["Name"].as<std::string>() == "value: with a colon");
+    REQUIRE(document["Count"].as<int64_t>() == 42);
+    REQUIRE(document["Enabled"].as<bool>());
+    REQUIRE(document["Items"].size() == 2);
+    REQUIRE(document["Items"][0].as<std::string>() == "a");
+    REQUIRE(document["Items"][1]["b"].as<std::string>() == "c");
+    REQUIRE(document["Empty"].as<std::string>().empty());
+
+    REQUIRE_THROWS_HR(out.str(), APPINSTALLER_CLI_ERROR_YAML_INVALID_EMITTER_STATE);
+
+    YAML::Emitter empty;
+    REQUIRE(empty.str().empty());
+
+    YAML::Emitter invalid;
+    REQUIRE_THROWS_HR(invalid << "scalar", APPINSTALLER_CLI_ERROR_YAML_INVALID_EMITTER_STATE);
+    invalid << YAML::BeginMap;
+    REQUIRE_THROWS_HR(invalid << YAML::Value, APPINSTALLER_CLI_ERROR_YAML_INVALID_EMITTER_STATE);
+}
+
+TEST_CASE("ValidateManifestsInDirectory", "[ManifestValidation]")
+{
+    TempDirectory directory("validatedirectory");
+    std::filesystem::create_directories(directory.GetPath() / "a");
+    std::filesystem::create_directories(directory.GetPath() / "b");
+
+    std::filesystem::copy_file(TestDataFile("Manifest-Good-Minimum.yaml"), directory.GetPath() / "a" / "good.yaml");
+    std::filesystem::copy_file(TestDataFile("Manifest-Bad-UnknownProperty.yaml"), directory.GetPath() / "b" / "warning.yaml");
+    std::filesystem::copy_file(TestDataFile("Manifest-Bad-IdMissing.yaml"), directory.GetPath() / "bad.yaml");
+    std::ofstream{ directory.GetPath() / "notamanifest.txt" } << "Id: Not.AManifest";
+
+    auto results = ValidateManifestsInDirectory(directory.GetPath());
+
+    REQUIRE(results.size() == 3);
+    REQUIRE(results[0].RelativePath == std::filesystem::path{ "a" } / "good.yaml");
+    REQUIRE(results[0].Result == S_OK);
+    REQUIRE(results[0].Errors.empty());
+    REQUIRE(results[1].RelativePath == std::filesystem::path{ "b" } / "warning.yaml");
+    REQUIRE(results[1].Result == APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_WARNING);
+    REQUIRE(results[2].RelativePath == "bad.yaml");
+    REQUIRE(results[2].Result == APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_FAILURE);
+    REQUIRE(results[2].Message.find("Required field missing. Field: Id") != std::string::npos);
+
+    REQUIRE(GetCombinedResult(results) == APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_FAILURE);
+    REQUIRE(GetCombinedResult({ results[0], results[1] }) == APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_WARNING);
+
+    std::string json = ConvertToJson(results);
+    REQUIRE(json.find("\"Result\" : \"Warning\"") != std::string::npos);
+    REQUIRE(json.find("\"Field\" : \"Id\"") != std::string::npos);
+}
+
+TEST_CASE("ManifestValidationCache_SkipsUnchangedManifests", "[ManifestValidation]")
+{
+    TempDirectory directory("validatecache");
+    TempFile cacheFile(std::string{ "validatecache" }, std::string{ ".json" });
+
+    std::filesystem::copy_file(TestDataFile("Manifest-Good-Minimum.yaml"), directory.GetPath() / "good.yaml");
+    std::filesystem::copy_file(TestDataFile("Manifest-Bad-IdMissing.yaml"), directory.GetPath() / "bad.yaml");
+
+    std::vector<ManifestValidationResult> validated;
+    {
+        ManifestValidationCache cache{ cacheFile.GetPath() };
+        validated = ValidateManifestsInDirectory(directory.GetPath(), &cache);
+        cache.Save();
+    }
+
+    REQUIRE(std::filesystem::exists(cacheFile.GetPath()));
+
+    // The results are loaded again from the file, with their errors
+    ManifestValidationCache cache{ cacheFile.GetPath() };
+    auto goodHash = SHA256::ComputeHashFromFile(directory.GetPath() / "good.yaml");
+    auto cachedGood = cache.Get(goodHash);
+    REQUIRE(cachedGood);
+    REQUIRE(cachedGood->Result == S_OK);
+
+    auto cachedBad = cache.Get(SHA256::ComputeHashFromFile(directory.GetPath() / "bad.yaml"));
+    REQUIRE(cachedBad);
+    REQUIRE(cachedBad->Result == APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_FAILURE);
+    REQUIRE(cachedBad->Message == validated[0].Message);
+    REQUIRE(cachedBad->Errors.size() == validated[0].Errors.size());
+    REQUIRE(cachedBad->Errors[0].Field == validated[0].Errors[0].Field);
+
+    // A changed manifest is validated again
+    std::ofstream{ directory.GetPath() / "good.yaml", std::ios::app } << "\n# changed\n";
+    auto results = ValidateManifestsInDirectory(directory.GetPath(), &cache);
+    REQUIRE(results.size() == 2);
+    REQUIRE(results[0].RelativePath == "bad.yaml");
+    REQUIRE(results[0].Result == APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_FAILURE);
+    REQUIRE(results[1].RelativePath == "good.yaml");
+    REQUIRE(results[1].Result == S_OK);
+    REQUIRE(cache.Get(SHA256::ComputeHashFromFile(directory.GetPath() / "good.yaml")));
+}
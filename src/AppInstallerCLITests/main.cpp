@@ -82,6 +82,22 @@ int main(int argc, char** argv)
                 hasSetTestDataBasePath = true;
             }
         }
+        else if ("-benchout"s == argv[i])
+        {
+            ++i;
+            if (i < argc)
+            {
+                TestCommon::BenchmarkResults::SetOutputPath(argv[i]);
+            }
+        }
+        else if ("-benchbaseline"s == argv[i])
+        {
+            ++i;
+            if (i < argc)
+            {
+                TestCommon::BenchmarkResults::SetBaselinePath(argv[i]);
+            }
+        }
         else if ("-wait"s == argv[i])
         {
             waitBeforeReturn = true;
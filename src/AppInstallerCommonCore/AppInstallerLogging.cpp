@@ -29,6 +29,39 @@ namespace AppInstaller::Logging
                 return (1ull << AsNum(channel));
             }
         }
+
+        // The streams for formatting log messages on this thread; those before InUse are held by a MessageStream.
+        struct MessageStreamPool
+        {
+            std::vector<std::unique_ptr<std::ostringstream>> Streams;
+            size_t InUse = 0;
+        };
+
+        thread_local MessageStreamPool s_messageStreams;
+    }
+
+    MessageStream::MessageStream()
+    {
+        MessageStreamPool& pool = s_messageStreams;
+        if (pool.InUse == pool.Streams.size())
+        {
+            pool.Streams.emplace_back(std::make_unique<std::ostringstream>());
+        }
+
+        m_stream = pool.Streams[pool.InUse++].get();
+    }
+
+    MessageStream::~MessageStream()
+    {
+        // Reset the contents and any formatting that the message changed, so that the next message starts from a new stream's state
+        m_stream->str({});
+        m_stream->clear();
+        m_stream->flags(std::ios_base::skipws | std::ios_base::dec);
+        m_stream->fill(' ');
+        m_stream->precision(6);
+        m_stream->width(0);
+
+        --s_messageStreams.InUse;
     }
 
     char const* GetChannelName(Channel channel)
@@ -136,7 +169,8 @@ namespace AppInstaller::Logging
 
     void BeginLogFileCleanup()
     {
-        FileLogger::BeginCleanup(Runtime::GetPathTo(Runtime::PathName::DefaultLogLocation));
+        // The location is found by the cleanup task, so that startup does not wait on it
+        FileLogger::BeginCleanup();
     }
 }
 
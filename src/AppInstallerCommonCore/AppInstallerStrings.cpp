@@ -5,6 +5,14 @@
 #include "Public/AppInstallerStrings.h"
 #include "icu.h"
 
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define AICLI_STRINGS_SIMD_X86
+#elif defined(_M_ARM64)
+#include <arm64_neon.h>
+#define AICLI_STRINGS_SIMD_ARM64
+#endif
+
 namespace AppInstaller::Utility
 {
     // Same as std::isspace(char)
@@ -17,26 +25,39 @@ namespace AppInstaller::Utility
     namespace
     {
         // Contains the ICU objects necessary to do break iteration.
+        // Opening the break iterator loads its rules, so it is opened once and then reset for each input.
         struct ICUBreakIterator
         {
-            ICUBreakIterator(std::string_view input, UBreakIteratorType type)
+            ICUBreakIterator(UBreakIteratorType type)
             {
                 UErrorCode err = U_ZERO_ERROR;
 
-                m_text.reset(utext_openUTF8(nullptr, input.data(), wil::safe_cast<int64_t>(input.length()), &err));
+                m_brk.reset(ubrk_open(type, nullptr, nullptr, 0, &err));
                 if (U_FAILURE(err))
                 {
-                    AICLI_LOG(Core, Error, << "utext_openUTF8 returned " << err);
+                    AICLI_LOG(Core, Error, << "ubrk_open returned " << err);
                     THROW_HR(E_UNEXPECTED);
                 }
+            }
 
-                m_brk.reset(ubrk_open(type, nullptr, nullptr, 0, &err));
+            // Starts the iteration over the input, which must outlive the iteration.
+            void SetText(std::string_view input)
+            {
+                UErrorCode err = U_ZERO_ERROR;
+
+                // The existing UText is reused rather than allocated again
+                UText* text = utext_openUTF8(m_text.get(), input.data(), wil::safe_cast<int64_t>(input.length()), &err);
                 if (U_FAILURE(err))
                 {
-                    AICLI_LOG(Core, Error, << "ubrk_open returned " << err);
+                    AICLI_LOG(Core, Error, << "utext_openUTF8 returned " << err);
                     THROW_HR(E_UNEXPECTED);
                 }
 
+                if (text != m_text.get())
+                {
+                    m_text.reset(text);
+                }
+
                 ubrk_setUText(m_brk.get(), m_text.get(), &err);
                 if (U_FAILURE(err))
                 {
@@ -50,6 +71,8 @@ namespace AppInstaller::Utility
                     AICLI_LOG(Core, Error, << "ubrk_first returned " << i);
                     THROW_HR(E_UNEXPECTED);
                 }
+
+                m_currentBrk = 0;
             }
 
             // Gets the current break value; the byte offset or UBRK_DONE.
@@ -84,17 +107,168 @@ namespace AppInstaller::Utility
             wil::unique_any<UBreakIterator*, decltype(ubrk_close), &ubrk_close> m_brk;
             int32_t m_currentBrk = 0;
         };
+
+        // Gets the character break iterator of this thread, set to iterate over the input.
+        ICUBreakIterator& GetCharacterBreakIterator(std::string_view input)
+        {
+            thread_local ICUBreakIterator s_iterator{ UBRK_CHARACTER };
+            s_iterator.SetText(input);
+            return s_iterator;
+        }
+
+        // Determines whether every character of the input is a single byte, so that byte offsets are character offsets.
+        // That is the case for ASCII, except for CR LF, which is a single character.
+        bool IsSingleByteCharacters(std::string_view input)
+        {
+            return IsASCII(input) && input.find('\r') == std::string_view::npos;
+        }
+
+        // Folds the case of an ASCII letter; every other byte is unchanged.
+        unsigned char FoldASCIICase(unsigned char c)
+        {
+            return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c | 0x20) : c;
+        }
+
+        // Compares up to length bytes of the two strings as ASCII, folding the case of the letters.
+        // Returns the number of bytes before the first that differ, or that are not ASCII in either string;
+        // as every byte before it is ASCII, that is always the start of a character in both.
+        size_t CaseInsensitiveASCIIPrefixLength(const char* a, const char* b, size_t length)
+        {
+            size_t i = 0;
+
+            // Each block is folded and compared as a whole, so that there is only one branch per block.
+#if defined(AICLI_STRINGS_SIMD_X86)
+            const __m128i beforeUpper = _mm_set1_epi8('A' - 1);
+            const __m128i afterUpper = _mm_set1_epi8('Z' + 1);
+            const __m128i caseBit = _mm_set1_epi8(0x20);
+
+            auto fold = [&](__m128i x)
+            {
+                // The bytes that are not ASCII are negative, so they are never in the range of the upper case letters
+                __m128i isUpper = _mm_and_si128(_mm_cmpgt_epi8(x, beforeUpper), _mm_cmplt_epi8(x, afterUpper));
+                return _mm_or_si128(x, _mm_and_si128(isUpper, caseBit));
+            };
+
+            for (; length - i >= 16; i += 16)
+            {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+
+                if (_mm_movemask_epi8(_mm_or_si128(x, y)) != 0 ||
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(fold(x), fold(y))) != 0xFFFF)
+                {
+                    break;
+                }
+            }
+#elif defined(AICLI_STRINGS_SIMD_ARM64)
+            const uint8x16_t upperA = vdupq_n_u8('A');
+            const uint8x16_t upperRange = vdupq_n_u8('Z' - 'A');
+            const uint8x16_t caseBit = vdupq_n_u8(0x20);
+
+            auto fold = [&](uint8x16_t x)
+            {
+                uint8x16_t isUpper = vcleq_u8(vsubq_u8(x, upperA), upperRange);
+                return vorrq_u8(x, vandq_u8(isUpper, caseBit));
+            };
+
+            for (; length - i >= 16; i += 16)
+            {
+                uint8x16_t x = vld1q_u8(reinterpret_cast<const uint8_t*>(a + i));
+                uint8x16_t y = vld1q_u8(reinterpret_cast<const uint8_t*>(b + i));
+
+                if (vmaxvq_u8(vorrq_u8(x, y)) >= 0x80 ||
+                    vminvq_u8(vceqq_u8(fold(x), fold(y))) != 0xFF)
+                {
+                    break;
+                }
+            }
+#endif
+
+            for (; i < length; ++i)
+            {
+                unsigned char x = static_cast<unsigned char>(a[i]);
+                unsigned char y = static_cast<unsigned char>(b[i]);
+
+                if (((x | y) & 0x80) != 0 || FoldASCIICase(x) != FoldASCIICase(y))
+                {
+                    break;
+                }
+            }
+
+            return i;
+        }
+
+        // Determines whether the byte at the offset is ASCII in both strings.
+        bool IsASCIIInBoth(std::string_view a, std::string_view b, size_t offset)
+        {
+            return ((static_cast<unsigned char>(a[offset]) | static_cast<unsigned char>(b[offset])) & 0x80) == 0;
+        }
+
+        // The edit distance from the full matrix, one row at a time; used for patterns too long for a single word.
+        size_t GetEditDistanceByRows(std::wstring_view pattern, std::wstring_view text)
+        {
+            std::vector<size_t> row(pattern.length() + 1);
+            for (size_t i = 0; i < row.size(); ++i)
+            {
+                row[i] = i;
+            }
+
+            for (size_t j = 1; j <= text.length(); ++j)
+            {
+                size_t diagonal = row[0];
+                row[0] = j;
+
+                for (size_t i = 1; i <= pattern.length(); ++i)
+                {
+                    size_t above = row[i];
+                    row[i] = std::min({ row[i] + 1, row[i - 1] + 1, diagonal + (pattern[i - 1] == text[j - 1] ? 0 : 1) });
+                    diagonal = above;
+                }
+            }
+
+            return row.back();
+        }
     }
 
     bool CaseInsensitiveEquals(std::string_view a, std::string_view b)
     {
-        // TODO: When we bring in ICU, do this correctly.
-        return ToLower(a) == ToLower(b);
+        size_t length = std::min(a.length(), b.length());
+        size_t offset = CaseInsensitiveASCIIPrefixLength(a.data(), b.data(), length);
+
+        if (offset == length)
+        {
+            // Folding maps each character to one character, so the longer string has characters left that the other does not
+            return a.length() == b.length();
+        }
+
+        // ASCII characters only fold to ASCII characters, so they are only equal if they are the same letter
+        if (IsASCIIInBoth(a, b, offset))
+        {
+            return false;
+        }
+
+        return FoldCase(a.substr(offset)) == FoldCase(b.substr(offset));
     }
 
     bool CaseInsensitiveStartsWith(std::string_view a, std::string_view b)
     {
-        return a.length() >= b.length() && CaseInsensitiveEquals(a.substr(0, b.length()), b);
+        size_t length = std::min(a.length(), b.length());
+        size_t offset = CaseInsensitiveASCIIPrefixLength(a.data(), b.data(), length);
+
+        if (offset == b.length())
+        {
+            return true;
+        }
+
+        if (offset == a.length() || IsASCIIInBoth(a, b, offset))
+        {
+            return false;
+        }
+
+        // As UTF8 is self synchronizing, the folded prefix matches as bytes exactly when it matches as characters
+        std::string foldedA = FoldCase(a.substr(offset));
+        std::string foldedB = FoldCase(b.substr(offset));
+        return foldedA.compare(0, foldedB.length(), foldedB) == 0;
     }
 
     std::string ConvertToUTF8(std::wstring_view input)
@@ -139,7 +313,12 @@ namespace AppInstaller::Utility
 
     size_t UTF8Length(std::string_view input)
     {
-        ICUBreakIterator itr{ input, UBRK_CHARACTER };
+        if (IsSingleByteCharacters(input))
+        {
+            return input.length();
+        }
+
+        ICUBreakIterator& itr = GetCharacterBreakIterator(input);
 
         size_t numGraphemeClusters = 0;
 
@@ -153,7 +332,13 @@ namespace AppInstaller::Utility
 
     std::string_view UTF8Substring(std::string_view input, size_t offset, size_t count)
     {
-        ICUBreakIterator itr{ input, UBRK_CHARACTER };
+        if (IsSingleByteCharacters(input))
+        {
+            // This throws std::out_of_range for an offset past the end, and takes the rest of the input for a count past it, as below
+            return input.substr(offset, count);
+        }
+
+        ICUBreakIterator& itr = GetCharacterBreakIterator(input);
 
         // Offset was past end, throw just like std::string::substr
         if (itr.Advance(offset) == UBRK_DONE)
@@ -177,6 +362,40 @@ namespace AppInstaller::Utility
         return input.substr(utf8Offset, utf8Count);
     }
 
+    bool IsASCII(std::string_view input)
+    {
+        const char* current = input.data();
+        const char* end = current + input.size();
+
+        // Every byte of a non-ASCII UTF8 character has the high bit set; the bytes are combined
+        // a block at a time, so that there is only one branch per block.
+#if defined(AICLI_STRINGS_SIMD_X86)
+        for (; end - current >= 16; current += 16)
+        {
+            if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(current))) != 0)
+            {
+                return false;
+            }
+        }
+#elif defined(AICLI_STRINGS_SIMD_ARM64)
+        for (; end - current >= 16; current += 16)
+        {
+            if (vmaxvq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(current))) >= 0x80)
+            {
+                return false;
+            }
+        }
+#endif
+
+        unsigned char combined = 0;
+        for (; current < end; ++current)
+        {
+            combined |= static_cast<unsigned char>(*current);
+        }
+
+        return (combined & 0x80) == 0;
+    }
+
     std::string Normalize(std::string_view input, NORM_FORM form)
     {
         if (input.empty())
@@ -184,6 +403,12 @@ namespace AppInstaller::Utility
             return {};
         }
 
+        // ASCII is already in every normalization form, so the conversions and the normalization can be skipped.
+        if (IsASCII(input))
+        {
+            return std::string{ input };
+        }
+
         return ConvertToUTF8(Normalize(ConvertToUTF16(input), form));
     }
 
@@ -236,6 +461,137 @@ namespace AppInstaller::Utility
         return result;
     }
 
+    std::string FoldCase(std::string_view input)
+    {
+        if (input.empty())
+        {
+            return {};
+        }
+
+        // Folding only changes the upper case letters of ASCII, so such a value does not need ICU
+        if (IsASCII(input))
+        {
+            std::string asciiResult(input);
+            std::transform(asciiResult.begin(), asciiResult.end(), asciiResult.begin(),
+                [](char c) { return static_cast<char>(FoldASCIICase(static_cast<unsigned char>(c))); });
+            return asciiResult;
+        }
+
+        std::wstring utf16 = ConvertToUTF16(input);
+
+        std::wstring result;
+        result.reserve(utf16.size());
+
+        int32_t length = wil::safe_cast<int32_t>(utf16.size());
+        for (int32_t i = 0; i < length;)
+        {
+            UChar32 c;
+            U16_NEXT(utf16.data(), i, length, c);
+            c = u_foldCase(c, U_FOLD_CASE_DEFAULT);
+
+            if (U_IS_BMP(c))
+            {
+                result += static_cast<wchar_t>(c);
+            }
+            else
+            {
+                result += static_cast<wchar_t>(U16_LEAD(c));
+                result += static_cast<wchar_t>(U16_TRAIL(c));
+            }
+        }
+
+        return ConvertToUTF8(result);
+    }
+
+    size_t GetEditDistance(std::wstring_view a, std::wstring_view b)
+    {
+        // The shorter value is the pattern, so that more pairs fit the single word form
+        std::wstring_view pattern = (a.length() <= b.length() ? a : b);
+        std::wstring_view text = (a.length() <= b.length() ? b : a);
+
+        if (pattern.empty())
+        {
+            return text.length();
+        }
+
+        if (pattern.length() > 64)
+        {
+            return GetEditDistanceByRows(pattern, text);
+        }
+
+        // The bit-parallel form of Myers, as given by Hyyrö for the edit distance of the whole values: each bit of the
+        // vertical deltas holds whether the matrix goes up (pv) or down (mv) by one from the row above, for a column of the text.
+        std::array<uint64_t, 128> asciiMasks{};
+        std::vector<std::pair<wchar_t, uint64_t>> otherMasks;
+
+        for (size_t i = 0; i < pattern.length(); ++i)
+        {
+            wchar_t c = pattern[i];
+            uint64_t bit = 1ull << i;
+
+            if (c < asciiMasks.size())
+            {
+                asciiMasks[c] |= bit;
+            }
+            else
+            {
+                auto itr = std::find_if(otherMasks.begin(), otherMasks.end(), [&](const auto& mask) { return mask.first == c; });
+                if (itr == otherMasks.end())
+                {
+                    otherMasks.emplace_back(c, bit);
+                }
+                else
+                {
+                    itr->second |= bit;
+                }
+            }
+        }
+
+        uint64_t pv = ~0ull;
+        uint64_t mv = 0;
+        uint64_t last = 1ull << (pattern.length() - 1);
+        size_t score = pattern.length();
+
+        for (wchar_t c : text)
+        {
+            uint64_t eq = 0;
+            if (c < asciiMasks.size())
+            {
+                eq = asciiMasks[c];
+            }
+            else
+            {
+                auto itr = std::find_if(otherMasks.begin(), otherMasks.end(), [&](const auto& mask) { return mask.first == c; });
+                if (itr != otherMasks.end())
+                {
+                    eq = itr->second;
+                }
+            }
+
+            uint64_t xv = eq | mv;
+            uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+            uint64_t ph = mv | ~(xh | pv);
+            uint64_t mh = pv & xh;
+
+            if (ph & last)
+            {
+                ++score;
+            }
+            else if (mh & last)
+            {
+                --score;
+            }
+
+            // The row above the pattern goes up by one for each character of the text
+            ph = (ph << 1) | 1;
+            mh <<= 1;
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+        }
+
+        return score;
+    }
+
     bool IsEmptyOrWhitespace(std::wstring_view str)
     {
         if (str.empty())
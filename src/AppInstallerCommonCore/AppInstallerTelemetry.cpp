@@ -29,6 +29,7 @@ std::ostream& operator<<(std::ostream& out, const GUID& guid)
 namespace AppInstaller::Logging
 {
     using namespace Utility;
+    using namespace std::string_view_literals;
 
     namespace
     {
@@ -40,6 +41,20 @@ namespace AppInstaller::Logging
             return g_IsTelemetryProviderEnabled && s_isTelemetryEnabled;
         }
 
+        // Set while an AggregateTelemetryScope is coalescing the per search events.
+        std::atomic_bool s_isAggregatingSearchEvents{ false };
+
+        // The totals of the per search events that were coalesced.
+        struct SearchEventTotals
+        {
+            std::atomic<uint64_t> Searches{ 0 };
+            std::atomic<uint64_t> Results{ 0 };
+            std::atomic<uint64_t> NoMatches{ 0 };
+            std::atomic<uint64_t> MultipleMatches{ 0 };
+        };
+
+        SearchEventTotals s_searchEventTotals;
+
         void __stdcall wilResultLoggingCallback(const wil::FailureInfo& info) noexcept
         {
             Telemetry().LogFailure(info);
@@ -57,6 +72,26 @@ namespace AppInstaller::Logging
             static GUID activityId = CreateGuid();
             return &activityId;
         }
+
+        // The totals for an operation, in microseconds.
+        struct PerformanceTotals
+        {
+            std::atomic<uint64_t> Count{ 0 };
+            std::atomic<uint64_t> Total{ 0 };
+            std::atomic<uint64_t> Longest{ 0 };
+        };
+
+        PerformanceTotals s_performanceTotals[static_cast<size_t>(PerformanceOperation::Max)];
+
+        std::atomic<uint64_t> s_workflowTaskCounts[WorkflowTaskHistogram::BucketCount]{};
+        std::atomic<uint64_t> s_workflowTaskTotal{ 0 };
+
+        bool IsPerformanceTracingEnabled()
+        {
+            // The provider is registered by the telemetry logger
+            Telemetry();
+            return TraceLoggingProviderEnabled(g_hTelemetryProvider, WINEVENT_LEVEL_VERBOSE, 0);
+        }
     }
 
     TelemetryTraceLogger::TelemetryTraceLogger()
@@ -75,6 +110,11 @@ namespace AppInstaller::Logging
         return instance;
     }
 
+    bool TelemetryTraceLogger::IsEnabled() const noexcept
+    {
+        return IsTelemetryEnabled();
+    }
+
     void TelemetryTraceLogger::LogFailure(const wil::FailureInfo& failure) noexcept
     {
         if (IsTelemetryEnabled())
@@ -221,7 +261,11 @@ namespace AppInstaller::Logging
 
     void TelemetryTraceLogger::LogNoAppMatch() noexcept
     {
-        if (IsTelemetryEnabled())
+        if (s_isAggregatingSearchEvents)
+        {
+            ++s_searchEventTotals.NoMatches;
+        }
+        else if (IsTelemetryEnabled())
         {
             TraceLoggingWriteActivity(g_hTelemetryProvider,
                 "NoAppMatch",
@@ -236,7 +280,11 @@ namespace AppInstaller::Logging
 
     void TelemetryTraceLogger::LogMultiAppMatch() noexcept
     {
-        if (IsTelemetryEnabled())
+        if (s_isAggregatingSearchEvents)
+        {
+            ++s_searchEventTotals.MultipleMatches;
+        }
+        else if (IsTelemetryEnabled())
         {
             TraceLoggingWriteActivity(g_hTelemetryProvider,
                 "MultiAppMatch",
@@ -324,7 +372,12 @@ namespace AppInstaller::Logging
 
     void TelemetryTraceLogger::LogSearchResultCount(uint64_t resultCount) noexcept
     {
-        if (IsTelemetryEnabled())
+        if (s_isAggregatingSearchEvents)
+        {
+            ++s_searchEventTotals.Searches;
+            s_searchEventTotals.Results += resultCount;
+        }
+        else if (IsTelemetryEnabled())
         {
             TraceLoggingWriteActivity(g_hTelemetryProvider,
                 "SearchResultCount",
@@ -388,6 +441,47 @@ namespace AppInstaller::Logging
         AICLI_LOG(CLI, Error, << type << " installer failed: " << errorCode);
     }
 
+    void TelemetryTraceLogger::LogCommandPerformance(std::string_view commandName) noexcept try
+    {
+        WorkflowTaskHistogram histogram = GetWorkflowTaskHistogram();
+
+        constexpr size_t operationCount = static_cast<size_t>(PerformanceOperation::Max);
+        uint64_t operationCounts[operationCount];
+        uint64_t operationTotals[operationCount];
+        for (size_t i = 0; i < operationCount; ++i)
+        {
+            PerformanceCounter counter = GetPerformanceCounter(static_cast<PerformanceOperation>(i));
+            operationCounts[i] = counter.Count;
+            operationTotals[i] = static_cast<uint64_t>(counter.Total.count());
+        }
+
+        if (IsTelemetryEnabled())
+        {
+            TraceLoggingWriteActivity(g_hTelemetryProvider,
+                "CommandPerformance",
+                GetActivityId(),
+                nullptr,
+                AICLI_TraceLoggingStringView(commandName, "Command"),
+                TraceLoggingUInt64FixedArray(histogram.Counts.data(), static_cast<UINT16>(histogram.Counts.size()), "TaskDurationHistogram"),
+                TraceLoggingUInt64(static_cast<uint64_t>(histogram.Total.count()), "TaskTotalMicroseconds"),
+                TraceLoggingUInt64FixedArray(operationCounts, static_cast<UINT16>(operationCount), "OperationCounts"),
+                TraceLoggingUInt64FixedArray(operationTotals, static_cast<UINT16>(operationCount), "OperationTotalMicroseconds"),
+                TelemetryPrivacyDataTag(PDT_ProductAndServicePerformance),
+                TraceLoggingKeyword(MICROSOFT_KEYWORD_CRITICAL_DATA));
+        }
+
+        AICLI_LOG(CLI, Verbose, << "Workflow task durations [<1ms, <10ms, <100ms, <1s, <10s, >=10s]: " << [&]() {
+                std::ostringstream strstr;
+                for (size_t i = 0; i < histogram.Counts.size(); ++i)
+                {
+                    strstr << (i == 0 ? "" : ", ") << histogram.Counts[i];
+                }
+                strstr << "; total " << histogram.Total.count() << "us";
+                return strstr.str();
+            }());
+    }
+    CATCH_LOG();
+
     void EnableWilFailureTelemetry()
     {
         wil::SetResultLoggingCallback(wilResultLoggingCallback);
@@ -405,4 +499,154 @@ namespace AppInstaller::Logging
             s_isTelemetryEnabled = true;
         }
     }
+
+    AggregateTelemetryScope::AggregateTelemetryScope()
+    {
+        // Only the outermost scope writes the totals
+        m_token = !s_isAggregatingSearchEvents.exchange(true);
+    }
+
+    AggregateTelemetryScope::~AggregateTelemetryScope()
+    {
+        if (!m_token)
+        {
+            return;
+        }
+
+        s_isAggregatingSearchEvents = false;
+
+        uint64_t searches = s_searchEventTotals.Searches.exchange(0);
+        uint64_t results = s_searchEventTotals.Results.exchange(0);
+        uint64_t noMatches = s_searchEventTotals.NoMatches.exchange(0);
+        uint64_t multipleMatches = s_searchEventTotals.MultipleMatches.exchange(0);
+
+        if (IsTelemetryEnabled() && (searches != 0 || noMatches != 0 || multipleMatches != 0))
+        {
+            TraceLoggingWriteActivity(g_hTelemetryProvider,
+                "SearchSummary",
+                GetActivityId(),
+                nullptr,
+                TraceLoggingUInt64(searches, "SearchCount"),
+                TraceLoggingUInt64(results, "ResultCount"),
+                TraceLoggingUInt64(noMatches, "NoAppMatchCount"),
+                TraceLoggingUInt64(multipleMatches, "MultiAppMatchCount"),
+                TelemetryPrivacyDataTag(PDT_ProductAndServicePerformance | PDT_ProductAndServiceUsage),
+                TraceLoggingKeyword(MICROSOFT_KEYWORD_CRITICAL_DATA));
+        }
+
+        AICLI_LOG(CLI, Info, << "Search summary: " << searches << " searches, " << results << " results, " <<
+            noMatches << " without a match, " << multipleMatches << " with multiple matches");
+    }
+
+    std::string_view ToString(PerformanceOperation operation)
+    {
+        switch (operation)
+        {
+        case PerformanceOperation::SourceOpen: return "SourceOpen"sv;
+        case PerformanceOperation::IndexSearch: return "IndexSearch"sv;
+        case PerformanceOperation::ManifestFetch: return "ManifestFetch"sv;
+        case PerformanceOperation::Download: return "Download"sv;
+        case PerformanceOperation::HashVerify: return "HashVerify"sv;
+        case PerformanceOperation::InstallerExecution: return "InstallerExecution"sv;
+        case PerformanceOperation::InventoryRefresh: return "InventoryRefresh"sv;
+        }
+
+        return "Unknown"sv;
+    }
+
+    PerformanceCounter GetPerformanceCounter(PerformanceOperation operation)
+    {
+        THROW_HR_IF(E_INVALIDARG, operation >= PerformanceOperation::Max);
+
+        const PerformanceTotals& totals = s_performanceTotals[ToIntegral(operation)];
+
+        PerformanceCounter result;
+        result.Count = totals.Count;
+        result.Total = std::chrono::microseconds{ totals.Total };
+        result.Longest = std::chrono::microseconds{ totals.Longest };
+        return result;
+    }
+
+    void RecordWorkflowTaskDuration(std::chrono::microseconds duration) noexcept
+    {
+        size_t bucket = 0;
+        while (bucket < WorkflowTaskHistogram::BucketBounds.size() && duration >= WorkflowTaskHistogram::BucketBounds[bucket])
+        {
+            ++bucket;
+        }
+
+        ++s_workflowTaskCounts[bucket];
+        s_workflowTaskTotal += static_cast<uint64_t>(duration.count());
+    }
+
+    WorkflowTaskHistogram GetWorkflowTaskHistogram()
+    {
+        WorkflowTaskHistogram result;
+        for (size_t i = 0; i < WorkflowTaskHistogram::BucketCount; ++i)
+        {
+            result.Counts[i] = s_workflowTaskCounts[i];
+        }
+        result.Total = std::chrono::microseconds{ s_workflowTaskTotal };
+        return result;
+    }
+
+    void ResetPerformanceCounters()
+    {
+        for (PerformanceTotals& totals : s_performanceTotals)
+        {
+            totals.Count = 0;
+            totals.Total = 0;
+            totals.Longest = 0;
+        }
+
+        for (auto& count : s_workflowTaskCounts)
+        {
+            count = 0;
+        }
+        s_workflowTaskTotal = 0;
+    }
+
+    ScopedPerformanceTimer::ScopedPerformanceTimer(PerformanceOperation operation) :
+        m_operation(operation), m_start(std::chrono::steady_clock::now())
+    {
+        if (IsPerformanceTracingEnabled())
+        {
+            m_activityId = CreateGuid();
+            m_traced = true;
+
+            std::string_view name = ToString(m_operation);
+            TraceLoggingWriteActivity(g_hTelemetryProvider,
+                "PerformanceOperation",
+                &m_activityId,
+                GetActivityId(),
+                TraceLoggingOpcode(WINEVENT_OPCODE_START),
+                TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                AICLI_TraceLoggingStringView(name, "Operation"));
+        }
+    }
+
+    ScopedPerformanceTimer::~ScopedPerformanceTimer()
+    {
+        uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count());
+
+        PerformanceTotals& totals = s_performanceTotals[ToIntegral(m_operation)];
+        ++totals.Count;
+        totals.Total += elapsed;
+
+        uint64_t longest = totals.Longest;
+        while (elapsed > longest && !totals.Longest.compare_exchange_weak(longest, elapsed)) {}
+
+        if (m_traced)
+        {
+            std::string_view name = ToString(m_operation);
+            TraceLoggingWriteActivity(g_hTelemetryProvider,
+                "PerformanceOperation",
+                &m_activityId,
+                GetActivityId(),
+                TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+                TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                AICLI_TraceLoggingStringView(name, "Operation"),
+                TraceLoggingUInt64(elapsed, "DurationInMicroseconds"));
+        }
+    }
 }
\ No newline at end of file
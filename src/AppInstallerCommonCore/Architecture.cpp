@@ -65,12 +65,7 @@ namespace AppInstaller::Utility
 
     std::vector<Architecture> GetApplicableArchitectures()
     {
-        static std::vector<Architecture> applicableArchs;
-
-        if (!applicableArchs.empty())
-        {
-            return applicableArchs;
-        }
+        std::vector<Architecture> applicableArchs;
 
         switch (GetSystemArchitecture())
         {
@@ -102,16 +97,6 @@ namespace AppInstaller::Utility
 
     int IsApplicableArchitecture(Architecture arch)
     {
-        std::vector<Architecture> applicableArchs = GetApplicableArchitectures();
-        auto it = std::find(applicableArchs.begin(), applicableArchs.end(), arch);
-
-        if (it != applicableArchs.end())
-        {
-            return static_cast<int>(std::distance(it, applicableArchs.end()));
-        }
-        else
-        {
-            return -1;
-        }
+        return Runtime::GetSystemCapabilities().GetArchitecturePriority(arch);
     }
 }
\ No newline at end of file
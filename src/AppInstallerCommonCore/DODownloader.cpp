@@ -0,0 +1,130 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "DODownloader.h"
+#include "Public/AppInstallerLogging.h"
+#include "Public/AppInstallerStrings.h"
+
+#include <wil/com.h>
+#include <deliveryoptimization.h>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace AppInstaller::Utility
+{
+    namespace
+    {
+        // How often the status of the download is read, to report progress and check for cancellation.
+        constexpr std::chrono::milliseconds s_StatusPollInterval = 100ms;
+
+        // DO fails a download that makes no progress for this long, rather than waiting for peers or the network indefinitely.
+        constexpr ULONG s_NoProgressTimeoutSeconds = 60;
+
+        // The total size reported by DO before it is known.
+        constexpr UINT64 s_UnknownTotalSize = std::numeric_limits<UINT64>::max();
+
+        // The DO service writes the file on behalf of the caller, so it must be allowed to impersonate it.
+        void AllowImpersonation(IUnknown* proxy)
+        {
+            THROW_IF_FAILED(CoSetProxyBlanket(
+                proxy,
+                RPC_C_AUTHN_DEFAULT,
+                RPC_C_AUTHZ_NONE,
+                COLE_DEFAULT_PRINCIPAL,
+                RPC_C_AUTHN_LEVEL_DEFAULT,
+                RPC_C_IMP_LEVEL_IMPERSONATE,
+                nullptr,
+                EOAC_DEFAULT));
+        }
+
+        void SetStringProperty(IDODownload* download, DODownloadProperty property, const std::wstring& value)
+        {
+            wil::unique_variant variant;
+            variant.vt = VT_BSTR;
+            variant.bstrVal = SysAllocString(value.c_str());
+            THROW_IF_NULL_ALLOC(variant.bstrVal);
+            THROW_IF_FAILED(download->SetProperty(property, &variant));
+        }
+
+        void SetBoolProperty(IDODownload* download, DODownloadProperty property, bool value)
+        {
+            wil::unique_variant variant;
+            variant.vt = VT_BOOL;
+            variant.boolVal = value ? VARIANT_TRUE : VARIANT_FALSE;
+            THROW_IF_FAILED(download->SetProperty(property, &variant));
+        }
+
+        void SetUInt32Property(IDODownload* download, DODownloadProperty property, ULONG value)
+        {
+            wil::unique_variant variant;
+            variant.vt = VT_UI4;
+            variant.ulVal = value;
+            THROW_IF_FAILED(download->SetProperty(property, &variant));
+        }
+
+        void ReportProgress(const DO_DOWNLOAD_STATUS& status, IProgressCallback& progress)
+        {
+            UINT64 total = status.BytesTotal == s_UnknownTotalSize ? 0 : status.BytesTotal;
+            progress.OnProgress(status.BytesTransferred, total, ProgressType::Bytes);
+        }
+    }
+
+    bool DODownloadToFile(const std::string& url, const std::filesystem::path& dest, IProgressCallback& progress)
+    {
+        AICLI_LOG(Core, Info, << "Downloading with Delivery Optimization from url: " << url);
+
+        auto manager = wil::CoCreateInstance<DeliveryOptimization, IDOManager>(CLSCTX_LOCAL_SERVER);
+        AllowImpersonation(manager.get());
+
+        wil::com_ptr<IDODownload> download;
+        THROW_IF_FAILED(manager->CreateDownload(&download));
+        AllowImpersonation(download.get());
+
+        SetStringProperty(download.get(), DODownloadProperty_Uri, ConvertToUTF16(url));
+        SetStringProperty(download.get(), DODownloadProperty_LocalPath, dest.wstring());
+        SetStringProperty(download.get(), DODownloadProperty_DisplayName, L"winget");
+        SetBoolProperty(download.get(), DODownloadProperty_ForegroundPriority, true);
+        SetUInt32Property(download.get(), DODownloadProperty_NoProgressTimeoutSeconds, s_NoProgressTimeoutSeconds);
+
+        // A download that is not finalized is aborted, so that the DO service does not keep it
+        auto abortDownload = wil::scope_exit([&]() { LOG_IF_FAILED(download->Abort()); });
+
+        THROW_IF_FAILED(download->Start(nullptr));
+
+        for (;;)
+        {
+            DO_DOWNLOAD_STATUS status{};
+            THROW_IF_FAILED(download->GetStatus(&status));
+
+            if (progress.IsCancelled())
+            {
+                AICLI_LOG(Core, Info, << "Download cancelled.");
+                return false;
+            }
+
+            ReportProgress(status, progress);
+
+            if (status.State == DODownloadState_Transferred)
+            {
+                break;
+            }
+
+            // A failed download is paused by DO, with the error that stopped it
+            if (status.State == DODownloadState_Paused || status.State == DODownloadState_Aborted)
+            {
+                AICLI_LOG(Core, Error, << "Delivery Optimization download stopped; error: 0x" << std::hex << std::setw(8) << std::setfill('0') << status.Error <<
+                    ", extended error: 0x" << std::setw(8) << status.ExtendedError);
+                THROW_HR(FAILED(status.Error) ? status.Error : E_UNEXPECTED);
+            }
+
+            std::this_thread::sleep_for(s_StatusPollInterval);
+        }
+
+        THROW_IF_FAILED(download->Finalize());
+        abortDownload.release();
+
+        AICLI_LOG(Core, Info, << "Delivery Optimization download completed.");
+        return true;
+    }
+}
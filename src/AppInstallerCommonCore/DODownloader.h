@@ -0,0 +1,15 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Public/AppInstallerProgress.h"
+
+#include <filesystem>
+#include <string>
+
+namespace AppInstaller::Utility
+{
+    // Downloads a file from the given URL to the given location with Delivery Optimization, which can get the content
+    // from peers on the local network and from its cache rather than from the server. The download runs in the DO
+    // service; progress is polled from it. Returns false if the download was cancelled, and throws if it failed.
+    bool DODownloadToFile(const std::string& url, const std::filesystem::path& dest, IProgressCallback& progress);
+}
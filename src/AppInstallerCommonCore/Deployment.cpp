@@ -56,6 +56,13 @@ namespace AppInstaller::Deployment
         }
     }
 
+    PackageManager GetPackageManager()
+    {
+        // Never released, as COM may already be uninitialized when static objects are destroyed
+        static PackageManager* s_packageManager = new PackageManager{};
+        return *s_packageManager;
+    }
+
     void RequestAddPackage(
         const winrt::Windows::Foundation::Uri& uri,
         winrt::Windows::Management::Deployment::DeploymentOptions options,
@@ -64,7 +71,7 @@ namespace AppInstaller::Deployment
         size_t id = GetDeploymentOperationId();
         AICLI_LOG(Core, Info, << "Starting RequestAddPackage operation #" << id << ": " << Utility::ConvertToUTF8(uri.AbsoluteUri().c_str()));
 
-        PackageManager packageManager;
+        PackageManager packageManager = GetPackageManager();
 
         // RequestAddPackageAsync will invoke smart screen.
         auto deployOperation = packageManager.RequestAddPackageAsync(
@@ -85,7 +92,7 @@ namespace AppInstaller::Deployment
         size_t id = GetDeploymentOperationId();
         AICLI_LOG(Core, Info, << "Starting RemovePackage operation #" << id << ": " << packageFullName);
 
-        PackageManager packageManager;
+        PackageManager packageManager = GetPackageManager();
         winrt::hstring fullName = Utility::ConvertToUTF16(packageFullName).c_str();
         auto deployOperation = packageManager.RemovePackageAsync(fullName, RemovalOptions::None);
 
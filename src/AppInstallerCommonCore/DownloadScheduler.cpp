@@ -0,0 +1,116 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "DownloadScheduler.h"
+#include "Public/winget/UserSettings.h"
+
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace AppInstaller::Utility
+{
+    namespace
+    {
+        // The longest a download sleeps at once, so that a cancellation is seen promptly.
+        constexpr std::chrono::milliseconds s_MaxSleep = 100ms;
+
+        uint64_t KilobytesToBytes(uint32_t kilobytes)
+        {
+            return static_cast<uint64_t>(kilobytes) * 1024;
+        }
+    }
+
+    DownloadScheduler::ScheduledDownload::ScheduledDownload(DownloadScheduler* scheduler, DownloadPriority priority) :
+        m_scheduler(scheduler), m_priority(priority)
+    {
+        if (m_scheduler && m_priority == DownloadPriority::Foreground)
+        {
+            std::lock_guard<std::mutex> lock{ m_scheduler->m_lock };
+            ++m_scheduler->m_foregroundDownloads;
+        }
+    }
+
+    DownloadScheduler::ScheduledDownload::~ScheduledDownload()
+    {
+        if (m_scheduler && m_priority == DownloadPriority::Foreground)
+        {
+            std::lock_guard<std::mutex> lock{ m_scheduler->m_lock };
+            --m_scheduler->m_foregroundDownloads;
+        }
+    }
+
+    void DownloadScheduler::ScheduledDownload::Consume(size_t bytes, IProgressCallback& progress) const
+    {
+        if (!m_scheduler)
+        {
+            return;
+        }
+
+        clock::time_point end = clock::now() + m_scheduler->Reserve(bytes, m_priority, clock::now());
+
+        while (!progress.IsCancelled())
+        {
+            clock::time_point now = clock::now();
+            if (now >= end)
+            {
+                break;
+            }
+
+            std::this_thread::sleep_for(std::min<clock::duration>(end - now, s_MaxSleep));
+        }
+    }
+
+    DownloadScheduler::DownloadScheduler(uint64_t bytesPerSecond, uint64_t backgroundBytesPerSecond) :
+        m_bucket(bytesPerSecond), m_backgroundBucket(backgroundBytesPerSecond) {}
+
+    DownloadScheduler& DownloadScheduler::Instance()
+    {
+        static DownloadScheduler s_instance{
+            KilobytesToBytes(Settings::User().Get<Settings::Setting::NetworkDownloadRateLimitInKBps>()),
+            KilobytesToBytes(Settings::User().Get<Settings::Setting::NetworkBackgroundDownloadRateLimitInKBps>()) };
+        return s_instance;
+    }
+
+    std::chrono::microseconds DownloadScheduler::Reserve(uint64_t bytes, DownloadPriority priority, clock::time_point now)
+    {
+        std::lock_guard<std::mutex> lock{ m_lock };
+
+        std::chrono::microseconds wait = m_bucket.Take(bytes, now);
+
+        if (priority == DownloadPriority::Background && m_foregroundDownloads > 0)
+        {
+            wait = std::max(wait, m_backgroundBucket.Take(bytes, now));
+        }
+
+        return wait;
+    }
+
+    std::chrono::microseconds DownloadScheduler::TokenBucket::Take(uint64_t bytes, clock::time_point now)
+    {
+        if (Rate == 0)
+        {
+            return 0us;
+        }
+
+        // The bucket starts full, and refills at the rate up to one second of data
+        double capacity = static_cast<double>(Rate);
+        if (LastRefill == clock::time_point{})
+        {
+            Tokens = capacity;
+        }
+        else if (now > LastRefill)
+        {
+            Tokens = std::min(capacity, Tokens + capacity * std::chrono::duration<double>(now - LastRefill).count());
+        }
+        LastRefill = std::max(LastRefill, now);
+
+        Tokens -= static_cast<double>(bytes);
+        if (Tokens >= 0)
+        {
+            return 0us;
+        }
+
+        return std::chrono::microseconds(static_cast<std::chrono::microseconds::rep>(-Tokens * 1000000 / capacity));
+    }
+}
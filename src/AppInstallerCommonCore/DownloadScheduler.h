@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Public/AppInstallerProgress.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace AppInstaller::Utility
+{
+    // The priority of a download. Background downloads, such as source updates, yield to foreground ones.
+    enum class DownloadPriority
+    {
+        Foreground,
+        Background,
+    };
+
+    // Limits the rate at which the downloads of the process receive data, with a token bucket that holds up to one
+    // second of data. While any foreground download is active, background downloads are also limited to their own,
+    // lower rate, so that they leave the bandwidth to it.
+    struct DownloadScheduler
+    {
+        using clock = std::chrono::steady_clock;
+
+        // A download that receives data at the rate allowed by its scheduler, for as long as it exists.
+        // One without a scheduler is not limited.
+        struct ScheduledDownload
+        {
+            ScheduledDownload() = default;
+            ScheduledDownload(DownloadScheduler* scheduler, DownloadPriority priority);
+
+            ScheduledDownload(const ScheduledDownload&) = delete;
+            ScheduledDownload& operator=(const ScheduledDownload&) = delete;
+
+            ~ScheduledDownload();
+
+            // Waits until the received bytes fit in the rate; the wait ends early if the download is cancelled.
+            // Can be called from any number of threads at once.
+            void Consume(size_t bytes, IProgressCallback& progress) const;
+
+        private:
+            DownloadScheduler* m_scheduler = nullptr;
+            DownloadPriority m_priority = DownloadPriority::Foreground;
+        };
+
+        // The rates are in bytes per second; 0 is unlimited.
+        DownloadScheduler(uint64_t bytesPerSecond, uint64_t backgroundBytesPerSecond);
+
+        // Gets the scheduler of the process, whose rates come from the user settings.
+        static DownloadScheduler& Instance();
+
+        // Starts a download with the given priority.
+        ScheduledDownload Begin(DownloadPriority priority) { return { this, priority }; }
+
+        // Takes the bytes from the rates of the priority, and returns how long the download must wait for them.
+        std::chrono::microseconds Reserve(uint64_t bytes, DownloadPriority priority, clock::time_point now);
+
+    private:
+        struct TokenBucket
+        {
+            TokenBucket(uint64_t rate) : Rate(rate) {}
+
+            // The bucket may go into debt; the wait is the time to pay it back.
+            std::chrono::microseconds Take(uint64_t bytes, clock::time_point now);
+
+            uint64_t Rate;
+            double Tokens = 0;
+            clock::time_point LastRefill{};
+        };
+
+        std::mutex m_lock;
+        TokenBucket m_bucket;
+        TokenBucket m_backgroundBucket;
+        size_t m_foregroundDownloads = 0;
+    };
+}
@@ -6,117 +6,1296 @@
 #include "Public/AppInstallerSHA256.h"
 #include "Public/AppInstallerStrings.h"
 #include "Public/AppInstallerLogging.h"
+#include "Public/AppInstallerTelemetry.h"
+#include "Public/winget/HttpSession.h"
+#include "Public/winget/UserSettings.h"
+#include "Public/winget/Yaml.h"
+#include "DODownloader.h"
+#include "DownloadScheduler.h"
+#include "MirrorScores.h"
+#include "UnbufferedFileWriter.h"
+
+#include <thread>
 
 using namespace AppInstaller::Runtime;
 
 namespace AppInstaller::Utility
 {
-    std::optional<std::vector<BYTE>> DownloadToStream(
-        const std::string& url,
-        std::ostream& dest,
-        IProgressCallback& progress,
-        bool computeHash)
+    namespace
     {
-        THROW_HR_IF(E_INVALIDARG, url.empty());
+        // Gets the value of a header from the response, or an empty string if it is not present.
+        std::string QueryHeader(HINTERNET request, DWORD infoLevel)
+        {
+            DWORD size = 0;
+            if (HttpQueryInfoA(request, infoLevel, nullptr, &size, nullptr) || GetLastError() != ERROR_INSUFFICIENT_BUFFER)
+            {
+                return {};
+            }
 
-        AICLI_LOG(Core, Info, << "Downloading from url: " << url);
+            std::string result(size, '\0');
+            THROW_LAST_ERROR_IF_MSG(!HttpQueryInfoA(request, infoLevel, result.data(), &size, nullptr), "Query header failed.");
+            result.resize(size);
+            return result;
+        }
 
-        wil::unique_hinternet session(InternetOpenA(
-            "winget-cli",
-            INTERNET_OPEN_TYPE_PRECONFIG,
-            NULL,
-            NULL,
-            0));
-        THROW_LAST_ERROR_IF_NULL_MSG(session, "InternetOpen() failed.");
+        using namespace std::string_view_literals;
 
-        wil::unique_hinternet urlFile(InternetOpenUrlA(
-            session.get(),
-            url.c_str(),
-            NULL,
-            0,
-            INTERNET_FLAG_IGNORE_REDIRECT_TO_HTTPS, // This allows http->https redirection
-            0));
-        THROW_LAST_ERROR_IF_NULL_MSG(urlFile, "InternetOpenUrl() failed.");
+        // The number of buffers moving through the stages of a download; one can be received, one hashed and one written at once.
+        constexpr size_t s_DownloadPipelineBufferCount = 3;
 
-        // Check http return status
-        DWORD requestStatus = 0;
-        DWORD cbRequestStatus = sizeof(requestStatus);
+        // A buffer of downloaded data, and how much of it is filled.
+        struct DownloadBuffer
+        {
+            std::unique_ptr<BYTE[]> Data;
+            DWORD Size = 0;
+        };
 
-        THROW_LAST_ERROR_IF_MSG(!HttpQueryInfoA(urlFile.get(),
-            HTTP_QUERY_STATUS_CODE | HTTP_QUERY_FLAG_NUMBER,
-            &requestStatus,
-            &cbRequestStatus,
-            nullptr), "Query download request status failed.");
+        // A blocking queue between two stages of a download pipeline.
+        struct DownloadPipelineQueue
+        {
+            void Push(DownloadBuffer&& buffer)
+            {
+                {
+                    std::lock_guard<std::mutex> lock{ m_lock };
+                    m_buffers.emplace(std::move(buffer));
+                }
+                m_condition.notify_one();
+            }
 
-        if (requestStatus != HTTP_STATUS_OK)
+            // Waits for the next buffer; returns an empty optional once the queue is closed and drained.
+            std::optional<DownloadBuffer> Pop()
+            {
+                std::unique_lock<std::mutex> lock{ m_lock };
+                m_condition.wait(lock, [this]() { return !m_buffers.empty() || m_closed; });
+
+                if (m_buffers.empty())
+                {
+                    return {};
+                }
+
+                DownloadBuffer result = std::move(m_buffers.front());
+                m_buffers.pop();
+                return result;
+            }
+
+            // Indicates that no more buffers will be pushed.
+            void Close()
+            {
+                {
+                    std::lock_guard<std::mutex> lock{ m_lock };
+                    m_closed = true;
+                }
+                m_condition.notify_all();
+            }
+
+        private:
+            std::mutex m_lock;
+            std::condition_variable m_condition;
+            std::queue<DownloadBuffer> m_buffers;
+            bool m_closed = false;
+        };
+
+        // Downloads at least this large are split into segments, when the server supports range requests.
+        constexpr LONGLONG s_SegmentedDownloadMinimumSize = 32 * 1024 * 1024;
+
+#ifndef AICLI_DISABLE_TEST_HOOKS
+        // Lets tests segment downloads that are smaller than a real installer; 0 when not overridden.
+        static std::atomic<LONGLONG> s_SegmentedDownloadMinimumSize_TestHook_Override = 0;
+#endif
+
+        LONGLONG GetSegmentedDownloadMinimumSize()
+        {
+#ifndef AICLI_DISABLE_TEST_HOOKS
+            LONGLONG result = s_SegmentedDownloadMinimumSize_TestHook_Override;
+            if (result > 0)
+            {
+                return result;
+            }
+#endif
+            return s_SegmentedDownloadMinimumSize;
+        }
+
+        // The number of concurrent range requests in a segmented download.
+        constexpr LONGLONG s_SegmentedDownloadSegmentCount = 4;
+
+        // How long the race of the mirrors of a download gives each one to respond before also starting the next; this is
+        // the delay that happy eyeballs gives each address of a host.
+        constexpr std::chrono::milliseconds s_MirrorRaceStagger{ 250 };
+
+        // How long a download that has mirrors waits for data before failing over to the next one.
+        constexpr std::chrono::milliseconds s_MirrorStallTimeout{ 15000 };
+
+#ifndef AICLI_DISABLE_TEST_HOOKS
+        static std::atomic<int64_t> s_MirrorRaceStagger_TestHook_Override = 0;
+        static std::atomic<int64_t> s_MirrorStallTimeout_TestHook_Override = 0;
+#endif
+
+        std::chrono::milliseconds GetMirrorRaceStagger()
+        {
+#ifndef AICLI_DISABLE_TEST_HOOKS
+            int64_t result = s_MirrorRaceStagger_TestHook_Override;
+            if (result > 0)
+            {
+                return std::chrono::milliseconds{ result };
+            }
+#endif
+            return s_MirrorRaceStagger;
+        }
+
+        std::chrono::milliseconds GetMirrorStallTimeout()
         {
-            AICLI_LOG(Core, Error, << "Download request failed. Returned status: " << requestStatus);
-            THROW_HR_MSG(MAKE_HRESULT(SEVERITY_ERROR, FACILITY_HTTP, requestStatus), "Download request status is not success.");
+#ifndef AICLI_DISABLE_TEST_HOOKS
+            int64_t result = s_MirrorStallTimeout_TestHook_Override;
+            if (result > 0)
+            {
+                return std::chrono::milliseconds{ result };
+            }
+#endif
+            return s_MirrorStallTimeout;
         }
 
-        AICLI_LOG(Core, Verbose, << "Download request status success.");
+        // The state of a range download is saved each time at least this many more bytes have been written.
+        constexpr LONGLONG s_RangeDownloadStateSaveInterval = 4 * 1024 * 1024;
+
+        constexpr std::string_view s_RangeDownloadState_FileSuffix = ".partial"sv;
+        constexpr std::string_view s_RangeDownloadState_Url = "Url"sv;
+        constexpr std::string_view s_RangeDownloadState_ETag = "ETag"sv;
+        constexpr std::string_view s_RangeDownloadState_LastModified = "LastModified"sv;
+        constexpr std::string_view s_RangeDownloadState_Size = "Size"sv;
+        constexpr std::string_view s_RangeDownloadState_Segments = "Segments"sv;
+        constexpr std::string_view s_RangeDownloadState_Segment_Start = "Start"sv;
+        constexpr std::string_view s_RangeDownloadState_Segment_End = "End"sv;
+        constexpr std::string_view s_RangeDownloadState_Segment_Completed = "Completed"sv;
+        constexpr std::string_view s_RangeDownloadState_ChunkSize = "ChunkSize"sv;
+        constexpr std::string_view s_RangeDownloadState_Chunks = "Chunks"sv;
+
+        // Opens the url with the given request headers, failing if the response status is not the expected one.
+        wil::unique_hinternet OpenUrlWithStatus(HINTERNET session, const std::string& url, const std::string& headers, DWORD expectedStatus)
+        {
+            wil::unique_hinternet urlFile(InternetOpenUrlA(
+                session,
+                url.c_str(),
+                headers.c_str(),
+                static_cast<DWORD>(headers.length()),
+                INTERNET_FLAG_IGNORE_REDIRECT_TO_HTTPS | INTERNET_FLAG_RELOAD | INTERNET_FLAG_NO_CACHE_WRITE,
+                0));
+            THROW_LAST_ERROR_IF_NULL_MSG(urlFile, "InternetOpenUrl() failed.");
 
-        // Get content length. Don't fail the download if failed.
-        LONGLONG contentLength = 0;
-        DWORD cbContentLength = sizeof(contentLength);
+            DWORD requestStatus = 0;
+            DWORD cbRequestStatus = sizeof(requestStatus);
+
+            THROW_LAST_ERROR_IF_MSG(!HttpQueryInfoA(urlFile.get(),
+                HTTP_QUERY_STATUS_CODE | HTTP_QUERY_FLAG_NUMBER,
+                &requestStatus,
+                &cbRequestStatus,
+                nullptr), "Query range request status failed.");
+
+            if (requestStatus != expectedStatus)
+            {
+                AICLI_LOG(Core, Info, << "Range request returned status: " << requestStatus);
+                THROW_HR(HRESULT_FROM_WIN32(ERROR_NO_RANGES_PROCESSED));
+            }
+
+            return urlFile;
+        }
 
-        HttpQueryInfoA(
-            urlFile.get(),
-            HTTP_QUERY_CONTENT_LENGTH | HTTP_QUERY_FLAG_NUMBER64,
-            &contentLength,
-            &cbContentLength,
-            nullptr);
-        AICLI_LOG(Core, Verbose, << "Download size: " << contentLength);
+        // Gets the size of the whole content from the Content-Range header of a partial response, or 0 if it is not given.
+        LONGLONG GetContentRangeSize(HINTERNET request)
+        {
+            // Format: bytes a-b/x, where x is either the size or *
+            std::string contentRange = QueryHeader(request, HTTP_QUERY_CONTENT_RANGE);
+            size_t separator = contentRange.find('/');
+            if (separator == std::string::npos || contentRange.compare(separator + 1, std::string::npos, "*") == 0)
+            {
+                return 0;
+            }
 
-        // Setup hash engine
-        SHA256 hashEngine;
-        std::string contentHash;
+            return std::stoll(contentRange.substr(separator + 1));
+        }
 
-        const int bufferSize = 1024 * 1024; // 1MB
-        auto buffer = std::make_unique<BYTE[]>(bufferSize);
+        // Limits how long a read of the request waits for data, so that a mirror that stops sending is failed over from
+        // rather than waited on.
+        void SetStallTimeout(HINTERNET request)
+        {
+            DWORD timeout = static_cast<DWORD>(GetMirrorStallTimeout().count());
+            LOG_LAST_ERROR_IF(!InternetSetOptionA(request, INTERNET_OPTION_RECEIVE_TIMEOUT, &timeout, sizeof(timeout)));
+        }
 
-        BOOL readSuccess = true;
-        DWORD bytesRead = 0;
-        LONGLONG bytesDownloaded = 0;
+        // The request to the url that won a race, and the position of the url.
+        struct RacedRequest
+        {
+            size_t Index = 0;
+            wil::unique_hinternet Request;
+        };
 
-        do
+        // Opens a request to the first of the urls to respond. As happy eyeballs does for the addresses of a host, each url
+        // is given a moment to respond before the next one is also tried, and one that fails starts the next at once.
+        // Requests that respond after the first are closed. If every url fails, the error of the first is thrown.
+        RacedRequest RaceRequests(const std::vector<std::string>& urls, const std::function<wil::unique_hinternet(const std::string&)>& open)
         {
-            if (progress.IsCancelled())
+            THROW_HR_IF(E_INVALIDARG, urls.empty());
+
+            if (urls.size() == 1)
+            {
+                return { 0, open(urls[0]) };
+            }
+
+            // Shared with the attempts, which are left to finish on their own once the race is decided.
+            struct RaceState
             {
-                AICLI_LOG(Core, Info, << "Download cancelled.");
+                std::mutex Lock;
+                std::condition_variable Changed;
+                std::optional<RacedRequest> Winner;
+                std::vector<std::exception_ptr> Failures;
+                size_t FailureCount = 0;
+            };
+
+            auto state = std::make_shared<RaceState>();
+            state->Failures.resize(urls.size());
+
+            auto startAttempt = [&](size_t index)
+            {
+                std::thread([open, state, index, url = urls[index]]()
+                    {
+                        try
+                        {
+                            wil::unique_hinternet request = open(url);
+
+                            std::lock_guard<std::mutex> lock{ state->Lock };
+                            if (!state->Winner)
+                            {
+                                state->Winner = RacedRequest{ index, std::move(request) };
+                            }
+                        }
+                        catch (...)
+                        {
+                            std::lock_guard<std::mutex> lock{ state->Lock };
+                            state->Failures[index] = std::current_exception();
+                            ++state->FailureCount;
+                        }
+
+                        state->Changed.notify_all();
+                    }).detach();
+            };
+
+            std::unique_lock<std::mutex> lock{ state->Lock };
+            size_t started = 0;
+
+            while (!state->Winner)
+            {
+                if (started < urls.size())
+                {
+                    startAttempt(started++);
+                    state->Changed.wait_for(lock, GetMirrorRaceStagger(), [&]() { return state->Winner.has_value() || state->FailureCount == started; });
+                }
+                else if (state->FailureCount == urls.size())
+                {
+                    std::rethrow_exception(state->Failures[0]);
+                }
+                else
+                {
+                    state->Changed.wait(lock, [&]() { return state->Winner.has_value() || state->FailureCount == urls.size(); });
+                }
+            }
+
+            // The winner stays set, though moved from, so that the attempts still running close their requests
+            RacedRequest result = std::move(state->Winner.value());
+            AICLI_LOG(Core, Info, << "Mirror " << result.Index << " of " << urls.size() << " responded first: " << urls[result.Index]);
+            return result;
+        }
+
+        // Gets the urls that a download races, in the order of the scores of their hosts. Mirrors are only used for remote content.
+        std::vector<std::string> GetUrlsToRace(const std::vector<std::string>& urls)
+        {
+            THROW_HR_IF(E_INVALIDARG, urls.empty());
+
+            if (urls.size() == 1 || !IsUrlRemote(urls[0]))
+            {
+                return { urls[0] };
+            }
+
+            std::vector<std::string> remote;
+            for (const auto& url : urls)
+            {
+                if (IsUrlRemote(url))
+                {
+                    remote.emplace_back(url);
+                }
+                else
+                {
+                    AICLI_LOG(Core, Info, << "Ignoring mirror that is not remote: " << url);
+                }
+            }
+
+            return MirrorScores::Instance().Order(remote);
+        }
+
+        // Records the throughput of the part of a download received from a mirror, when there were mirrors to choose from.
+        void RecordMirrorThroughput(const std::vector<std::string>& urls, size_t index, LONGLONG bytes, std::chrono::steady_clock::time_point start)
+        {
+            if (urls.size() > 1 && bytes > 0)
+            {
+                MirrorScores::Instance().Record(urls[index], static_cast<uint64_t>(bytes),
+                    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+            }
+        }
+
+        // A range of the content, and how much of it has been written to the file.
+        struct DownloadSegment
+        {
+            LONGLONG Start = 0;
+            // Inclusive, as in the Range header.
+            LONGLONG End = 0;
+            LONGLONG Completed = 0;
+        };
+
+        // The state of a download through range requests. It is kept beside the file while the download is incomplete,
+        // so that a later attempt for the same content resumes each segment rather than starting again.
+        struct RangeDownloadState
+        {
+            std::string Url;
+            ResourceValidators Validators;
+            LONGLONG Size = 0;
+            std::vector<DownloadSegment> Segments;
+            // The hashes of the chunks that were downloaded whole, when the download is hashed in chunks;
+            // the others are empty. A chunk that was hashed does not need to be read again when the download resumes.
+            uint64_t ChunkSize = 0;
+            std::vector<SHA256::HashBuffer> ChunkHashes;
+
+            static std::filesystem::path GetPath(const std::filesystem::path& dest)
+            {
+                std::filesystem::path result = dest;
+                result += s_RangeDownloadState_FileSuffix;
+                return result;
+            }
+
+            // Loads the state for the file, returning an empty optional if there is none or it cannot be read.
+            static std::optional<RangeDownloadState> Load(const std::filesystem::path& dest)
+            {
+                std::filesystem::path path = GetPath(dest);
+                if (!std::filesystem::exists(path))
+                {
+                    return {};
+                }
+
+                try
+                {
+                    YAML::Node document = YAML::Load(path);
+
+                    RangeDownloadState result;
+                    result.Url = document[s_RangeDownloadState_Url].as<std::string>();
+                    result.Size = document[s_RangeDownloadState_Size].as<int64_t>();
+
+                    const YAML::Node& etag = document[s_RangeDownloadState_ETag];
+                    if (etag.IsScalar())
+                    {
+                        result.Validators.ETag = etag.as<std::string>();
+                    }
+
+                    const YAML::Node& lastModified = document[s_RangeDownloadState_LastModified];
+                    if (lastModified.IsScalar())
+                    {
+                        result.Validators.LastModified = lastModified.as<std::string>();
+                    }
+
+                    for (const auto& segment : document[s_RangeDownloadState_Segments].Sequence())
+                    {
+                        DownloadSegment& added = result.Segments.emplace_back();
+                        added.Start = segment[s_RangeDownloadState_Segment_Start].as<int64_t>();
+                        added.End = segment[s_RangeDownloadState_Segment_End].as<int64_t>();
+                        added.Completed = segment[s_RangeDownloadState_Segment_Completed].as<int64_t>();
+                    }
+
+                    const YAML::Node& chunkSize = document[s_RangeDownloadState_ChunkSize];
+                    if (chunkSize.IsScalar())
+                    {
+                        result.ChunkSize = static_cast<uint64_t>(chunkSize.as<int64_t>());
+
+                        const YAML::Node& chunks = document[s_RangeDownloadState_Chunks];
+                        if (chunks.IsSequence())
+                        {
+                            for (const auto& chunk : chunks.Sequence())
+                            {
+                                std::string value = (chunk.IsScalar() ? chunk.as<std::string>() : std::string{});
+                                result.ChunkHashes.emplace_back(value.size() == 64 ? SHA256::ConvertToBytes(value) : SHA256::HashBuffer{});
+                            }
+                        }
+                    }
+
+                    return result;
+                }
+                catch (...)
+                {
+                    AICLI_LOG(Core, Info, << "Download state could not be read, it will be ignored: " << path);
+                    return {};
+                }
+            }
+
+            void Save(const std::filesystem::path& dest) const
+            {
+                YAML::Emitter out;
+                out << YAML::BeginMap;
+                out << YAML::Key << s_RangeDownloadState_Url << YAML::Value << Url;
+                if (!Validators.ETag.empty())
+                {
+                    out << YAML::Key << s_RangeDownloadState_ETag << YAML::Value << Validators.ETag;
+                }
+                if (!Validators.LastModified.empty())
+                {
+                    out << YAML::Key << s_RangeDownloadState_LastModified << YAML::Value << Validators.LastModified;
+                }
+                out << YAML::Key << s_RangeDownloadState_Size << YAML::Value << static_cast<int64_t>(Size);
+                out << YAML::Key << s_RangeDownloadState_Segments;
+                out << YAML::BeginSeq;
+                for (const auto& segment : Segments)
+                {
+                    out << YAML::BeginMap;
+                    out << YAML::Key << s_RangeDownloadState_Segment_Start << YAML::Value << static_cast<int64_t>(segment.Start);
+                    out << YAML::Key << s_RangeDownloadState_Segment_End << YAML::Value << static_cast<int64_t>(segment.End);
+                    out << YAML::Key << s_RangeDownloadState_Segment_Completed << YAML::Value << static_cast<int64_t>(segment.Completed);
+                    out << YAML::EndMap;
+                }
+                out << YAML::EndSeq;
+                if (ChunkSize > 0)
+                {
+                    out << YAML::Key << s_RangeDownloadState_ChunkSize << YAML::Value << static_cast<int64_t>(ChunkSize);
+                    out << YAML::Key << s_RangeDownloadState_Chunks;
+                    out << YAML::BeginSeq;
+                    for (const auto& chunkHash : ChunkHashes)
+                    {
+                        out << (chunkHash.empty() ? std::string{} : SHA256::ConvertToString(chunkHash));
+                    }
+                    out << YAML::EndSeq;
+                }
+                out << YAML::EndMap;
+
+                std::ofstream stream(GetPath(dest), std::ofstream::binary | std::ofstream::trunc);
+                stream << out.str();
+            }
+
+            // Determines whether this state is for the same content, so that what was written can be kept.
+            // Content without validators is never resumed, as there would be no way to know that it did not change.
+            bool IsResumableAs(const std::string& url, const ResourceValidators& validators, LONGLONG size) const
+            {
+                return Url == url && Size == size && !Validators.IsEmpty() &&
+                    Validators.ETag == validators.ETag && Validators.LastModified == validators.LastModified;
+            }
+
+            static void Remove(const std::filesystem::path& dest)
+            {
+                std::error_code error;
+                std::filesystem::remove(GetPath(dest), error);
+            }
+        };
+
+        // Downloads the url to the file with range requests. Large content is split into segments that are downloaded
+        // concurrently, each writing straight to its offset in the file. The progress is saved beside the file, and an
+        // earlier attempt for the same content is resumed.
+        // Returns false, without writing to the file, if the server does not support range requests.
+        // Returns true if the download completed or was cancelled; the saved state is only removed once it completes.
+        // When hashChunkSize is not zero, the chunks are hashed as they arrive; the hashes of those that could be are
+        // returned in chunkHashes once the download completes, and the others are empty.
+        // The urls are the url and its mirrors, in the order that they are raced; the url identifies the content in the saved
+        // state, whichever mirror it comes from. The probe is raced, and the mirror that answers first is used; each segment
+        // fails over to the next mirror on its own when its download stops, continuing from where it stopped.
+        bool TryDownloadWithRanges(
+            const std::string& url,
+            const std::vector<std::string>& urls,
+            const std::filesystem::path& dest,
+            const DownloadScheduler::ScheduledDownload& scheduled,
+            IProgressCallback& progress,
+            uint64_t hashChunkSize,
+            std::vector<SHA256::HashBuffer>& chunkHashes)
+        {
+            // Range offsets address the content as it is stored, so these requests never ask for it encoded.
+            HINTERNET session = GetSharedInternetSession();
+
+            // Probe with a one byte range; a partial content response confirms support, and gives the full size.
+            LONGLONG contentLength = 0;
+            ResourceValidators validators;
+
+            // The mirror that answered the probe first is used, and the others are failed over to in order.
+            std::vector<std::string> mirrors;
+
+            try
+            {
+                RacedRequest probe = RaceRequests(urls, [session](const std::string& url)
+                    {
+                        return OpenUrlWithStatus(session, url, "Range: bytes=0-0\r\n", HTTP_STATUS_PARTIAL_CONTENT);
+                    });
+
+                contentLength = GetContentRangeSize(probe.Request.get());
+
+                validators.ETag = QueryHeader(probe.Request.get(), HTTP_QUERY_ETAG);
+                validators.LastModified = QueryHeader(probe.Request.get(), HTTP_QUERY_LAST_MODIFIED);
+
+                mirrors.emplace_back(urls[probe.Index]);
+                for (size_t i = 0; i < urls.size(); ++i)
+                {
+                    if (i != probe.Index)
+                    {
+                        mirrors.emplace_back(urls[i]);
+                    }
+                }
+            }
+            catch (...)
+            {
+                AICLI_LOG(Core, Info, << "Range requests not supported, downloading as a single stream.");
+                return false;
+            }
+
+            if (contentLength <= 0)
+            {
+                AICLI_LOG(Core, Info, << "Range request did not give the size, downloading as a single stream.");
+                return false;
+            }
+
+            RangeDownloadState state;
+            std::optional<RangeDownloadState> previous = RangeDownloadState::Load(dest);
+
+            if (previous && previous->IsResumableAs(url, validators, contentLength) && std::filesystem::file_size(dest) == static_cast<uintmax_t>(contentLength))
+            {
+                state = std::move(previous).value();
+                AICLI_LOG(Core, Info, << "Resuming download of " << contentLength << " bytes in " << state.Segments.size() << " segments.");
+            }
+            else
+            {
+                state.Url = url;
+                state.Validators = validators;
+                state.Size = contentLength;
+
+                LONGLONG segmentCount = (contentLength < GetSegmentedDownloadMinimumSize() ? 1 : s_SegmentedDownloadSegmentCount);
+                LONGLONG segmentSize = (contentLength + segmentCount - 1) / segmentCount;
+
+                // Segments of whole chunks, so that every chunk is hashed by the segment that downloads it
+                if (hashChunkSize > 0)
+                {
+                    LONGLONG chunkSize = static_cast<LONGLONG>(hashChunkSize);
+                    segmentSize = (segmentSize + chunkSize - 1) / chunkSize * chunkSize;
+                }
+                for (LONGLONG start = 0; start < contentLength; start += segmentSize)
+                {
+                    DownloadSegment& segment = state.Segments.emplace_back();
+                    segment.Start = start;
+                    segment.End = std::min(start + segmentSize, contentLength) - 1;
+                }
+
+                AICLI_LOG(Core, Info, << "Downloading " << contentLength << " bytes in " << state.Segments.size() << " segments.");
+            }
+
+            LONGLONG chunkSize = static_cast<LONGLONG>(hashChunkSize);
+            if (state.ChunkSize != hashChunkSize)
+            {
+                // What was written is kept, but hashes of chunks of another size are of no use
+                state.ChunkSize = hashChunkSize;
+                state.ChunkHashes.clear();
+            }
+
+            if (chunkSize > 0)
+            {
+                state.ChunkHashes.resize(static_cast<size_t>((contentLength + chunkSize - 1) / chunkSize));
+
+                // A chunk that was partly written is downloaded again from its start, so that it can be hashed whole
+                for (auto& segment : state.Segments)
+                {
+                    LONGLONG offset = segment.Start + segment.Completed;
+                    LONGLONG chunkStart = offset - offset % chunkSize;
+                    if (offset <= segment.End && chunkStart >= segment.Start)
+                    {
+                        segment.Completed = chunkStart - segment.Start;
+                    }
+                }
+            }
+
+            wil::unique_hfile file{ CreateFileW(dest.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+            THROW_LAST_ERROR_IF(!file);
+
+            LARGE_INTEGER size{};
+            size.QuadPart = contentLength;
+            THROW_LAST_ERROR_IF(!SetFilePointerEx(file.get(), size, nullptr, FILE_BEGIN));
+            THROW_LAST_ERROR_IF(!SetEndOfFile(file.get()));
+
+            // Save before any data so that even the first bytes can be resumed.
+            state.Save(dest);
+
+            LONGLONG bytesDownloaded = 0;
+            for (const auto& segment : state.Segments)
+            {
+                bytesDownloaded += segment.Completed;
+            }
+            LONGLONG bytesSaved = bytesDownloaded;
+
+            // Guards the state, the counts, and the progress callback across the segments.
+            std::mutex stateLock;
+
+            // Downloads the rest of the segment, writing at the matching offsets through the shared handle.
+            auto downloadSegment = [&](DownloadSegment& segment)
+            {
+                LONGLONG offset = segment.Start + segment.Completed;
+                if (offset > segment.End)
+                {
+                    return;
+                }
+
+                // Opens the rest of the segment from the mirror.
+                auto openRange = [&](size_t mirror)
+                {
+                    std::string headers = "Range: bytes=" + std::to_string(offset) + "-" + std::to_string(segment.End) + "\r\n";
+
+                    // If the content changed since the probe, the server returns all of it; the status check rejects that.
+                    // The validators are those of the mirror that was probed, so another mirror is only checked by the size.
+                    const std::string& ifRange = (validators.ETag.empty() ? validators.LastModified : validators.ETag);
+                    if (mirror == 0 && !ifRange.empty())
+                    {
+                        headers += "If-Range: " + ifRange + "\r\n";
+                    }
+
+                    wil::unique_hinternet result = OpenUrlWithStatus(session, mirrors[mirror], headers, HTTP_STATUS_PARTIAL_CONTENT);
+
+                    if (mirror > 0)
+                    {
+                        THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_NO_RANGES_PROCESSED), GetContentRangeSize(result.get()) != contentLength,
+                            "Mirror content is not the same size.");
+                    }
+
+                    if (mirrors.size() > 1)
+                    {
+                        SetStallTimeout(result.get());
+                    }
+
+                    return result;
+                };
+
+                const DWORD bufferSize = 1024 * 1024; // 1MB
+                auto buffer = std::make_unique<BYTE[]>(bufferSize);
+
+                // Only the chunks that lie wholly in the segment are hashed here; the others are hashed from the file at the end.
+                std::unique_ptr<SHA256> chunkHasher;
+                auto hashChunks = [&](LONGLONG position, const BYTE* data, DWORD size)
+                {
+                    while (size > 0)
+                    {
+                        LONGLONG chunkStart = position - position % chunkSize;
+                        LONGLONG chunkEnd = std::min(chunkStart + chunkSize, contentLength);
+                        DWORD part = static_cast<DWORD>(std::min<LONGLONG>(size, chunkEnd - position));
+
+                        if (position == chunkStart && chunkStart >= segment.Start && chunkEnd - 1 <= segment.End)
+                        {
+                            chunkHasher = std::make_unique<SHA256>();
+                        }
+
+                        if (chunkHasher)
+                        {
+                            chunkHasher->Add(data, part);
+
+                            if (position + part == chunkEnd)
+                            {
+                                SHA256::HashBuffer chunkHash = chunkHasher->Get();
+                                chunkHasher.reset();
+
+                                std::lock_guard<std::mutex> lock{ stateLock };
+                                state.ChunkHashes[static_cast<size_t>(chunkStart / chunkSize)] = std::move(chunkHash);
+                            }
+                        }
+
+                        position += part;
+                        data += part;
+                        size -= part;
+                    }
+                };
+
+                size_t mirror = 0;
+                wil::unique_hinternet urlFile;
+                auto mirrorStart = std::chrono::steady_clock::now();
+                LONGLONG mirrorStartOffset = offset;
+
+                while (!progress.IsCancelled())
+                {
+                    DWORD bytesRead = 0;
+
+                    try
+                    {
+                        if (!urlFile)
+                        {
+                            urlFile = openRange(mirror);
+                        }
+
+                        THROW_LAST_ERROR_IF_MSG(!InternetReadFile(urlFile.get(), buffer.get(), bufferSize, &bytesRead), "InternetReadFile() failed.");
+
+                        // A connection that ends early is failed over from, the same as one that fails
+                        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INCORRECT_SIZE), bytesRead == 0 && offset != segment.End + 1);
+                    }
+                    catch (...)
+                    {
+                        if (mirror + 1 >= mirrors.size() || progress.IsCancelled())
+                        {
+                            throw;
+                        }
+
+                        LOG_CAUGHT_EXCEPTION_MSG("Segment download stopped, failing over to the next mirror.");
+                        RecordMirrorThroughput(mirrors, mirror, offset - mirrorStartOffset, mirrorStart);
+
+                        ++mirror;
+                        urlFile.reset();
+                        mirrorStart = std::chrono::steady_clock::now();
+                        mirrorStartOffset = offset;
+                        continue;
+                    }
+
+                    if (bytesRead == 0)
+                    {
+                        break;
+                    }
+
+                    // The segments share the rate of the download
+                    scheduled.Consume(bytesRead, progress);
+
+                    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INCORRECT_SIZE), offset + bytesRead > segment.End + 1);
+
+                    OVERLAPPED overlapped{};
+                    overlapped.Offset = static_cast<DWORD>(offset);
+                    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+                    DWORD bytesWritten = 0;
+                    THROW_LAST_ERROR_IF(!WriteFile(file.get(), buffer.get(), bytesRead, &bytesWritten, &overlapped));
+                    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_WRITE_FAULT), bytesWritten != bytesRead);
+
+                    if (chunkSize > 0)
+                    {
+                        hashChunks(offset, buffer.get(), bytesRead);
+                    }
+
+                    offset += bytesRead;
+
+                    std::lock_guard<std::mutex> lock{ stateLock };
+
+                    segment.Completed = offset - segment.Start;
+                    bytesDownloaded += bytesRead;
+
+                    if (bytesDownloaded - bytesSaved >= s_RangeDownloadStateSaveInterval)
+                    {
+                        state.Save(dest);
+                        bytesSaved = bytesDownloaded;
+                    }
+
+                    progress.OnProgress(bytesDownloaded, contentLength, ProgressType::Bytes);
+                }
+
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INCORRECT_SIZE), !progress.IsCancelled() && offset != segment.End + 1);
+
+                RecordMirrorThroughput(mirrors, mirror, offset - mirrorStartOffset, mirrorStart);
+            };
+
+            std::vector<std::future<void>> segments;
+            for (auto& segment : state.Segments)
+            {
+                segments.emplace_back(std::async(std::launch::async, downloadSegment, std::ref(segment)));
+            }
+
+            // Wait for every segment, as they all use the handle and the state, before surfacing a failure.
+            std::exception_ptr failure;
+            for (auto& segment : segments)
+            {
+                try
+                {
+                    segment.get();
+                }
+                catch (...)
+                {
+                    if (!failure)
+                    {
+                        failure = std::current_exception();
+                    }
+                }
+            }
+
+            if (failure || progress.IsCancelled())
+            {
+                // Keep what was written for the next attempt.
+                try
+                {
+                    state.Save(dest);
+                }
+                CATCH_LOG();
+
+                if (failure)
+                {
+                    std::rethrow_exception(failure);
+                }
+
+                return true;
+            }
+
+            RangeDownloadState::Remove(dest);
+
+            chunkHashes = std::move(state.ChunkHashes);
+
+            return true;
+        }
+
+        // Hashes a downloaded file, if requested; the file is hashed once it is complete, as that is what will be used.
+        // With a chunk size, the chunked hash is computed instead, hashing only those chunks that are not already given.
+        std::vector<BYTE> GetDownloadedFileHash(const std::filesystem::path& dest, bool computeHash, uint64_t hashChunkSize, std::vector<SHA256::HashBuffer> chunkHashes = {})
+        {
+            std::vector<BYTE> result;
+            if (computeHash && hashChunkSize > 0)
+            {
+                size_t hashedChunks = static_cast<size_t>(std::count_if(chunkHashes.begin(), chunkHashes.end(), [](const auto& chunkHash) { return !chunkHash.empty(); }));
+                ChunkedSHA256::ComputeMissingChunkHashesFromFile(dest, hashChunkSize, chunkHashes);
+                AICLI_LOG(Core, Info, << "Hashed " << chunkHashes.size() - std::min(hashedChunks, chunkHashes.size()) << " of " << chunkHashes.size() << " chunks from the downloaded file");
+
+                result = ChunkedSHA256::CombineChunkHashes(chunkHashes);
+                AICLI_LOG(Core, Info, << "Download chunked hash: " << SHA256::ConvertToString(result));
+            }
+            else if (computeHash)
+            {
+                result = SHA256::ComputeHashFromFile(dest);
+                AICLI_LOG(Core, Info, << "Download hash: " << SHA256::ConvertToString(result));
+            }
+
+            AICLI_LOG(Core, Info, << "Download completed.");
+
+            return result;
+        }
+
+        // Where a single stream download puts its data. The functions are called on the thread that writes the data.
+        struct DownloadWriter
+        {
+            // Called with the size of the content, if the server gave it, before any data is written.
+            std::function<void(LONGLONG contentLength)> Begin;
+            std::function<void(const BYTE* data, DWORD size)> Write;
+            // Called once all of the data is written, unless the download failed or was cancelled.
+            std::function<void()> Complete;
+        };
+
+        // Starts the download in the scheduler of the process. Source indexes are updated in the background, and yield
+        // to the downloads that the user is waiting for; WinGetUtil is used outside of winget, so it is not limited by its settings.
+        DownloadScheduler::ScheduledDownload ScheduleDownload(DownloadType type)
+        {
+            switch (type)
+            {
+            case DownloadType::Index:
+                return DownloadScheduler::Instance().Begin(DownloadPriority::Background);
+            case DownloadType::WinGetUtil:
                 return {};
+            default:
+                return DownloadScheduler::Instance().Begin(DownloadPriority::Foreground);
+            }
+        }
+    }
+
+    namespace
+    {
+        // Opens the url for a download as a single stream, failing if the response is not a success.
+        wil::unique_hinternet OpenUrlForStream(HINTERNET session, const std::string& url)
+        {
+            AICLI_LOG(Core, Info, << "Downloading from url: " << url);
+
+            wil::unique_hinternet urlFile(InternetOpenUrlA(
+                session,
+                url.c_str(),
+                NULL,
+                0,
+                INTERNET_FLAG_IGNORE_REDIRECT_TO_HTTPS, // This allows http->https redirection
+                0));
+            THROW_LAST_ERROR_IF_NULL_MSG(urlFile, "InternetOpenUrl() failed.");
+
+            // Check http return status
+            DWORD requestStatus = 0;
+            DWORD cbRequestStatus = sizeof(requestStatus);
+
+            THROW_LAST_ERROR_IF_MSG(!HttpQueryInfoA(urlFile.get(),
+                HTTP_QUERY_STATUS_CODE | HTTP_QUERY_FLAG_NUMBER,
+                &requestStatus,
+                &cbRequestStatus,
+                nullptr), "Query download request status failed.");
+
+            if (requestStatus != HTTP_STATUS_OK)
+            {
+                AICLI_LOG(Core, Error, << "Download request failed. Returned status: " << requestStatus);
+                THROW_HR_MSG(MAKE_HRESULT(SEVERITY_ERROR, FACILITY_HTTP, requestStatus), "Download request status is not success.");
+            }
+
+            AICLI_LOG(Core, Verbose, << "Download request status success.");
+
+            return urlFile;
+        }
+
+        // Downloads the first of the urls to respond as a single stream, receiving, hashing, and writing the data on their own threads.
+        // The urls are the url and its mirrors, in the order that they are raced. When the download from a mirror stops, it
+        // continues from the next with a range request, if the content is not decoded and its size is known.
+        std::optional<std::vector<BYTE>> DownloadThroughPipeline(
+            const std::vector<std::string>& urls,
+            const DownloadWriter& writer,
+            DownloadType type,
+            IProgressCallback& progress,
+            bool computeHash,
+            uint64_t hashChunkSize)
+        {
+            THROW_HR_IF(E_INVALIDARG, urls.empty() || urls[0].empty());
+
+            // Manifests and indexes compress well, and are fully read and hashed after decoding; installers are
+            // usually compressed already, and their size is needed up front to preallocate the file.
+            bool decodeContent = (type == DownloadType::Manifest || type == DownloadType::Index);
+            HINTERNET session = decodeContent ? GetSharedDecodingInternetSession() : GetSharedInternetSession();
+
+            RacedRequest raced = RaceRequests(urls, [session](const std::string& url) { return OpenUrlForStream(session, url); });
+            wil::unique_hinternet urlFile = std::move(raced.Request);
+
+            // The mirror that responded first is used, and the others are failed over to in order.
+            std::vector<std::string> mirrors{ urls[raced.Index] };
+            for (size_t i = 0; i < urls.size(); ++i)
+            {
+                if (i != raced.Index)
+                {
+                    mirrors.emplace_back(urls[i]);
+                }
             }
 
-            readSuccess = InternetReadFile(urlFile.get(), buffer.get(), bufferSize, &bytesRead);
+            if (mirrors.size() > 1)
+            {
+                SetStallTimeout(urlFile.get());
+            }
+
+            // Get content length. Don't fail the download if failed.
+            LONGLONG contentLength = 0;
+            DWORD cbContentLength = sizeof(contentLength);
+
+            HttpQueryInfoA(
+                urlFile.get(),
+                HTTP_QUERY_CONTENT_LENGTH | HTTP_QUERY_FLAG_NUMBER64,
+                &contentLength,
+                &cbContentLength,
+                nullptr);
+            AICLI_LOG(Core, Verbose, << "Download size: " << contentLength);
+
+            if (decodeContent)
+            {
+                // The length is that of the encoded content, which is not what will be read; treat it as unknown.
+                char contentEncoding[64]{};
+                DWORD cbContentEncoding = sizeof(contentEncoding);
+                if (HttpQueryInfoA(urlFile.get(), HTTP_QUERY_CONTENT_ENCODING, contentEncoding, &cbContentEncoding, nullptr) &&
+                    cbContentEncoding > 0)
+                {
+                    AICLI_LOG(Core, Verbose, << "Download content encoding: " << contentEncoding);
+                    contentLength = 0;
+                }
+            }
+
+            writer.Begin(contentLength);
+
+            DownloadScheduler::ScheduledDownload scheduled = ScheduleDownload(type);
+
+            // The data is received on this thread, and hashed and written on their own threads, so that the three overlap.
+            // The buffers are passed along in order, and return to the free queue once written.
+            SHA256 hashEngine;
+            std::optional<ChunkedSHA256> chunkedHashEngine;
+            if (hashChunkSize > 0)
+            {
+                chunkedHashEngine.emplace(hashChunkSize);
+            }
+
+            const DWORD bufferSize = 1024 * 1024; // 1MB
+
+            DownloadPipelineQueue freeBuffers;
+            DownloadPipelineQueue toHash;
+            DownloadPipelineQueue toWrite;
+
+            for (size_t i = 0; i < s_DownloadPipelineBufferCount; ++i)
+            {
+                DownloadBuffer buffer;
+                buffer.Data = std::make_unique<BYTE[]>(bufferSize);
+                freeBuffers.Push(std::move(buffer));
+            }
+
+            // Set when any stage fails or the download is cancelled, to stop the others.
+            std::atomic_bool aborted = false;
+            auto abortPipeline = [&]()
+            {
+                aborted = true;
+                freeBuffers.Close();
+                toHash.Close();
+                toWrite.Close();
+            };
+
+            std::future<void> hashStage = std::async(std::launch::async, [&]()
+                {
+                    auto closeOnExit = wil::scope_exit([&]() { toWrite.Close(); });
+
+                    try
+                    {
+                        while (std::optional<DownloadBuffer> buffer = toHash.Pop())
+                        {
+                            if (aborted)
+                            {
+                                break;
+                            }
+
+                            if (computeHash && chunkedHashEngine)
+                            {
+                                chunkedHashEngine->Add(buffer->Data.get(), buffer->Size);
+                            }
+                            else if (computeHash)
+                            {
+                                hashEngine.Add(buffer->Data.get(), buffer->Size);
+                            }
+
+                            toWrite.Push(std::move(buffer).value());
+                        }
+                    }
+                    catch (...)
+                    {
+                        abortPipeline();
+                        throw;
+                    }
+                });
+
+            std::future<void> writeStage = std::async(std::launch::async, [&]()
+                {
+                    try
+                    {
+                        while (std::optional<DownloadBuffer> buffer = toWrite.Pop())
+                        {
+                            if (aborted)
+                            {
+                                break;
+                            }
+
+                            writer.Write(buffer->Data.get(), buffer->Size);
+
+                            freeBuffers.Push(std::move(buffer).value());
+                        }
+                    }
+                    catch (...)
+                    {
+                        abortPipeline();
+                        throw;
+                    }
+                });
+
+            // Decoded content cannot be continued with a range request, as the offsets would address the encoded content;
+            // it is only raced, which is enough for the size of a manifest.
+            size_t mirror = 0;
+            auto mirrorStart = std::chrono::steady_clock::now();
+            LONGLONG mirrorStartOffset = 0;
+
+            auto tryFailOver = [&](LONGLONG offset)
+            {
+                while (!decodeContent && contentLength > 0 && mirror + 1 < mirrors.size() && !progress.IsCancelled())
+                {
+                    RecordMirrorThroughput(mirrors, mirror, offset - mirrorStartOffset, mirrorStart);
+
+                    ++mirror;
+                    mirrorStart = std::chrono::steady_clock::now();
+                    mirrorStartOffset = offset;
+                    AICLI_LOG(Core, Info, << "Download stopped at " << offset << " bytes, failing over to mirror: " << mirrors[mirror]);
+
+                    try
+                    {
+                        wil::unique_hinternet next = OpenUrlWithStatus(session, mirrors[mirror], "Range: bytes=" + std::to_string(offset) + "-\r\n", HTTP_STATUS_PARTIAL_CONTENT);
+                        THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_NO_RANGES_PROCESSED), GetContentRangeSize(next.get()) != contentLength,
+                            "Mirror content is not the same size.");
+                        SetStallTimeout(next.get());
+
+                        urlFile = std::move(next);
+                        return true;
+                    }
+                    CATCH_LOG();
+                }
+
+                return false;
+            };
+
+            bool cancelled = false;
+            std::exception_ptr failure;
+            LONGLONG bytesDownloaded = 0;
+
+            try
+            {
+
+                while (std::optional<DownloadBuffer> buffer = freeBuffers.Pop())
+                {
+                    if (aborted)
+                    {
+                        break;
+                    }
+
+                    if (progress.IsCancelled())
+                    {
+                        AICLI_LOG(Core, Info, << "Download cancelled.");
+                        cancelled = true;
+                        abortPipeline();
+                        break;
+                    }
+
+                    while (true)
+                    {
+                        BOOL read = InternetReadFile(urlFile.get(), buffer->Data.get(), bufferSize, &buffer->Size);
+                        DWORD error = (read ? ERROR_SUCCESS : GetLastError());
+
+                        // A connection that ends early is failed over from, the same as one that fails
+                        bool endedEarly = (read && buffer->Size == 0 && contentLength > 0 && bytesDownloaded < contentLength);
+
+                        if ((read && !endedEarly) || !tryFailOver(bytesDownloaded))
+                        {
+                            THROW_WIN32_IF_MSG(error, !read, "InternetReadFile() failed.");
+                            break;
+                        }
+                    }
+
+                    if (buffer->Size == 0)
+                    {
+                        break;
+                    }
+
+                    scheduled.Consume(buffer->Size, progress);
+
+                    bytesDownloaded += buffer->Size;
+                    toHash.Push(std::move(buffer).value());
+
+                    progress.OnProgress(bytesDownloaded, contentLength, ProgressType::Bytes);
+                }
+            }
+            catch (...)
+            {
+                failure = std::current_exception();
+                abortPipeline();
+            }
+
+            toHash.Close();
+
+            // Wait for both stages before surfacing a failure, as they use the writer and the hash engine.
+            for (std::future<void>* stage : { &hashStage, &writeStage })
+            {
+                try
+                {
+                    stage->get();
+                }
+                catch (...)
+                {
+                    if (!failure)
+                    {
+                        failure = std::current_exception();
+                    }
+                }
+            }
 
-            THROW_LAST_ERROR_IF_MSG(!readSuccess, "InternetReadFile() failed.");
+            if (failure)
+            {
+                std::rethrow_exception(failure);
+            }
 
-            if (computeHash)
+            if (cancelled)
             {
-                hashEngine.Add(buffer.get(), bytesRead);
+                return {};
             }
 
-            dest.write((char*)buffer.get(), bytesRead);
+            writer.Complete();
 
-            bytesDownloaded += bytesRead;
+            RecordMirrorThroughput(mirrors, mirror, bytesDownloaded - mirrorStartOffset, mirrorStart);
 
-            if (bytesRead != 0)
+            std::vector<BYTE> result;
+            if (computeHash && chunkedHashEngine)
+            {
+                result = chunkedHashEngine->Get();
+                AICLI_LOG(Core, Info, << "Download chunked hash: " << SHA256::ConvertToString(result));
+            }
+            else if (computeHash)
             {
-                progress.OnProgress(bytesDownloaded, contentLength, ProgressType::Bytes);
+                result = hashEngine.Get();
+                AICLI_LOG(Core, Info, << "Download hash: " << SHA256::ConvertToString(result));
             }
 
-        } while (bytesRead != 0);
+            AICLI_LOG(Core, Info, << "Download completed.");
 
-        dest.flush();
+            return result;
+        }
+    }
+
+    std::optional<std::vector<BYTE>> DownloadToStream(
+        const std::string& url,
+        std::ostream& dest,
+        DownloadType type,
+        IProgressCallback& progress,
+        bool computeHash)
+    {
+        return DownloadToStream(std::vector<std::string>{ url }, dest, type, progress, computeHash);
+    }
 
-        std::vector<BYTE> result;
-        if (computeHash)
+    std::optional<std::vector<BYTE>> DownloadToStream(
+        const std::vector<std::string>& urls,
+        std::ostream& dest,
+        DownloadType type,
+        IProgressCallback& progress,
+        bool computeHash)
+    {
+        DownloadWriter writer;
+        writer.Begin = [](LONGLONG) {};
+        writer.Write = [&](const BYTE* data, DWORD size)
         {
-            result = hashEngine.Get();
-            AICLI_LOG(Core, Info, << "Download hash: " << SHA256::ConvertToString(result));
+            dest.write(reinterpret_cast<const char*>(data), size);
+            THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_WRITE_FAULT), !dest, "Writing the download failed.");
+        };
+        writer.Complete = [&]() { dest.flush(); };
+
+        return DownloadThroughPipeline(GetUrlsToRace(urls), writer, type, progress, computeHash, 0);
+    }
+
+    std::optional<ResourceValidators> GetResourceValidatorsIfModified(const std::string& url, const ResourceValidators& previous)
+    {
+        THROW_HR_IF(E_INVALIDARG, url.empty());
+
+        AICLI_LOG(Core, Info, << "Checking for modification of url: " << url);
+
+        std::string headers;
+        if (!previous.ETag.empty())
+        {
+            headers += "If-None-Match: " + previous.ETag + "\r\n";
+        }
+        if (!previous.LastModified.empty())
+        {
+            headers += "If-Modified-Since: " + previous.LastModified + "\r\n";
         }
 
-        AICLI_LOG(Core, Info, << "Download completed.");
+        HINTERNET session = GetSharedInternetSession();
+
+        // The local cache is bypassed so that the server makes the decision; closing the handle without reading
+        // the content abandons the body of a 200 response.
+        wil::unique_hinternet urlFile(InternetOpenUrlA(
+            session,
+            url.c_str(),
+            headers.empty() ? NULL : headers.c_str(),
+            static_cast<DWORD>(headers.length()),
+            INTERNET_FLAG_IGNORE_REDIRECT_TO_HTTPS | INTERNET_FLAG_RELOAD | INTERNET_FLAG_NO_CACHE_WRITE,
+            0));
+        THROW_LAST_ERROR_IF_NULL_MSG(urlFile, "InternetOpenUrl() failed.");
+
+        DWORD requestStatus = 0;
+        DWORD cbRequestStatus = sizeof(requestStatus);
+
+        THROW_LAST_ERROR_IF_MSG(!HttpQueryInfoA(urlFile.get(),
+            HTTP_QUERY_STATUS_CODE | HTTP_QUERY_FLAG_NUMBER,
+            &requestStatus,
+            &cbRequestStatus,
+            nullptr), "Query request status failed.");
+
+        if (requestStatus == HTTP_STATUS_NOT_MODIFIED)
+        {
+            AICLI_LOG(Core, Info, << "Resource not modified.");
+            return {};
+        }
+
+        if (requestStatus != HTTP_STATUS_OK)
+        {
+            AICLI_LOG(Core, Error, << "Conditional request failed. Returned status: " << requestStatus);
+            THROW_HR_MSG(MAKE_HRESULT(SEVERITY_ERROR, FACILITY_HTTP, requestStatus), "Conditional request status is not success.");
+        }
+
+        ResourceValidators result;
+        result.ETag = QueryHeader(urlFile.get(), HTTP_QUERY_ETAG);
+        result.LastModified = QueryHeader(urlFile.get(), HTTP_QUERY_LAST_MODIFIED);
+
+        AICLI_LOG(Core, Info, << "Resource modified; ETag [" << result.ETag << "], Last-Modified [" << result.LastModified << "]");
 
         return result;
     }
@@ -124,24 +1303,134 @@ namespace AppInstaller::Utility
     std::optional<std::vector<BYTE>> Download(
         const std::string& url,
         const std::filesystem::path& dest,
+        DownloadType type,
         IProgressCallback& progress,
-        bool computeHash)
+        bool computeHash,
+        uint64_t hashChunkSize)
     {
-        THROW_HR_IF(E_INVALIDARG, url.empty());
+        return Download(std::vector<std::string>{ url }, dest, type, progress, computeHash, hashChunkSize);
+    }
+
+    std::optional<std::vector<BYTE>> Download(
+        const std::vector<std::string>& urls,
+        const std::filesystem::path& dest,
+        DownloadType type,
+        IProgressCallback& progress,
+        bool computeHash,
+        uint64_t hashChunkSize)
+    {
+        THROW_HR_IF(E_INVALIDARG, urls.empty() || urls[0].empty());
         THROW_HR_IF(E_INVALIDARG, dest.empty());
 
+        const std::string& url = urls[0];
+        std::vector<std::string> urlsToRace = GetUrlsToRace(urls);
+
         AICLI_LOG(Core, Info, << "Downloading to path: " << dest);
 
+        Logging::ScopedPerformanceTimer timer{ Logging::PerformanceOperation::Download };
+
         std::filesystem::create_directories(dest.parent_path());
 
-        std::ofstream emptyDestFile(dest);
-        emptyDestFile.close();
-        ApplyMotwIfApplicable(dest);
+        // An interrupted download leaves its state beside the file; keep the file so that it can be resumed.
+        if (std::filesystem::exists(dest) && std::filesystem::exists(RangeDownloadState::GetPath(dest)))
+        {
+            AICLI_LOG(Core, Info, << "Found the state of an earlier download to this path.");
+        }
+        else
+        {
+            RangeDownloadState::Remove(dest);
+
+            std::ofstream emptyDestFile(dest);
+            emptyDestFile.close();
+            ApplyMotwIfApplicable(dest);
+        }
+
+        if (IsUrlRemote(url))
+        {
+            if (type == DownloadType::Installer &&
+                Settings::User().Get<Settings::Setting::NetworkDownloader>() == Settings::InstallerDownloader::DeliveryOptimization)
+            {
+                try
+                {
+                    // DO writes the file itself, and cannot resume a download made with ranges
+                    RangeDownloadState::Remove(dest);
+                    std::filesystem::remove(dest);
+
+                    if (!DODownloadToFile(url, dest, progress))
+                    {
+                        return {};
+                    }
+
+                    ApplyMotwIfApplicable(dest);
+                    return GetDownloadedFileHash(dest, computeHash, hashChunkSize);
+                }
+                catch (...)
+                {
+                    // DO can be disabled by policy or unable to reach the content; WinINet is always tried after it
+                    LOG_CAUGHT_EXCEPTION_MSG("Delivery Optimization download failed, falling back to WinINet.");
+                }
+
+                if (progress.IsCancelled())
+                {
+                    return {};
+                }
+
+                std::ofstream emptyDestFile(dest);
+                emptyDestFile.close();
+                ApplyMotwIfApplicable(dest);
+            }
+
+            // A failure here leaves the state for the next attempt to resume.
+            std::vector<SHA256::HashBuffer> chunkHashes;
+            if (TryDownloadWithRanges(url, urlsToRace, dest, ScheduleDownload(type), progress, (computeHash ? hashChunkSize : 0), chunkHashes))
+            {
+                if (progress.IsCancelled())
+                {
+                    AICLI_LOG(Core, Info, << "Download cancelled.");
+                    return {};
+                }
 
-        // Use std::ofstream::app to append to previous empty file so that it will not
-        // create a new file and clear motw.
-        std::ofstream outfile(dest, std::ofstream::binary | std::ofstream::app);
-        return DownloadToStream(url, outfile, progress, computeHash);
+                return GetDownloadedFileHash(dest, computeHash, hashChunkSize, std::move(chunkHashes));
+            }
+        }
+        else
+        {
+            // A local or UNC path is copied rather than streamed; the copy is what gets hashed, as that is the file that will be used.
+            std::filesystem::path source = ConvertToUTF16(url);
+            if (std::filesystem::is_regular_file(source))
+            {
+                AICLI_LOG(Core, Info, << "Copying local file: " << source);
+
+                RangeDownloadState::Remove(dest);
+                std::filesystem::copy_file(source, dest, std::filesystem::copy_options::overwrite_existing);
+
+                // Copying replaces the alternate streams of the destination
+                ApplyMotwIfApplicable(dest);
+
+                uint64_t size = static_cast<uint64_t>(std::filesystem::file_size(dest));
+                progress.OnProgress(size, size, ProgressType::Bytes);
+
+                return GetDownloadedFileHash(dest, computeHash, hashChunkSize);
+            }
+        }
+
+        // Nothing that was written can be resumed without range requests. The writer empties the file rather than
+        // creating it again, so that it keeps the mark of the web.
+        RangeDownloadState::Remove(dest);
+        UnbufferedFileWriter fileWriter{ dest };
+
+        DownloadWriter writer;
+        writer.Begin = [&](LONGLONG contentLength)
+        {
+            if (contentLength > 0)
+            {
+                fileWriter.Preallocate(static_cast<uint64_t>(contentLength));
+            }
+        };
+        writer.Write = [&](const BYTE* data, DWORD size) { fileWriter.Write(data, size); };
+        writer.Complete = [&]() { fileWriter.Complete(); };
+
+        return DownloadThroughPipeline(urlsToRace, writer, type, progress, computeHash, hashChunkSize);
     }
 
     using namespace std::string_view_literals;
@@ -218,4 +1507,17 @@ namespace AppInstaller::Utility
 
         AICLI_LOG(Core, Info, << "Finished applying motw");
     }
+
+#ifndef AICLI_DISABLE_TEST_HOOKS
+    void TestHook_SetSegmentedDownloadMinimumSize(int64_t size)
+    {
+        s_SegmentedDownloadMinimumSize_TestHook_Override = size;
+    }
+
+    void TestHook_SetMirrorTimeouts(std::chrono::milliseconds raceStagger, std::chrono::milliseconds stallTimeout)
+    {
+        s_MirrorRaceStagger_TestHook_Override = raceStagger.count();
+        s_MirrorStallTimeout_TestHook_Override = stallTimeout.count();
+    }
+#endif
 }
@@ -62,6 +62,12 @@ namespace AppInstaller
                 return "Command requires administrator privileges to run";
             case APPINSTALLER_CLI_ERROR_SOURCE_NOT_SECURE:
                 return "The source location is not secure";
+            case APPINSTALLER_CLI_ERROR_INDEX_DELTA_MISMATCH:
+                return "The index delta was not created from this index";
+            case APPINSTALLER_CLI_ERROR_MULTIPLE_INSTALL_FAILED:
+                return "One or more of the packages failed to install";
+            case APPINSTALLER_CLI_ERROR_RESTSOURCE_INVALID_RESPONSE:
+                return "The source server returned an invalid response";
             default:
                 return "Uknown Error Code";
             }
@@ -7,23 +7,78 @@
 
 namespace AppInstaller::Settings
 {
+    namespace
+    {
+        bool IsEnabledInSettings(const UserSettings& settings, ExperimentalFeature::Feature feature)
+        {
+            using Feature = ExperimentalFeature::Feature;
+
+            switch (feature)
+            {
+            case Feature::ExperimentalCmd:
+                // ExperimentalArg depends on ExperimentalCmd, so instead of failing we could
+                // assume that if ExperimentalArg is enabled then ExperimentalCmd is as well.
+                return settings.Get<Setting::EFExperimentalCmd>() || settings.Get<Setting::EFExperimentalArg>();
+            case Feature::ExperimentalArg:
+                return settings.Get<Setting::EFExperimentalArg>();
+            case Feature::ExperimentalMSStore:
+                return settings.Get<Setting::EFExperimentalMSStore>();
+            case Feature::InMemorySearch:
+                return settings.Get<Setting::EFInMemorySearch>();
+            case Feature::SearchResultCache:
+                return settings.Get<Setting::EFSearchResultCache>();
+            case Feature::BackgroundSourceUpdate:
+                return settings.Get<Setting::EFBackgroundSourceUpdate>();
+            case Feature::PersistentRangeCache:
+                return settings.Get<Setting::EFPersistentRangeCache>();
+            case Feature::InstallerCache:
+                return settings.Get<Setting::EFInstallerCache>();
+            case Feature::ManifestFetchCache:
+                return settings.Get<Setting::EFManifestFetchCache>();
+            case Feature::CompletionIndex:
+                return settings.Get<Setting::EFCompletionIndex>();
+            case Feature::ServerMode:
+                return settings.Get<Setting::EFServerMode>();
+            case Feature::Batch:
+                return settings.Get<Setting::EFBatch>();
+            case Feature::Upgrade:
+                return settings.Get<Setting::EFUpgrade>();
+            case Feature::HotIndex:
+                return settings.Get<Setting::EFHotIndex>();
+            default:
+                THROW_HR(E_UNEXPECTED);
+            }
+        }
+
+        ExperimentalFeature::Feature_t GetEnabledFeatures(const UserSettings& settings)
+        {
+            ExperimentalFeature::Feature_t result = 0;
+
+            for (ExperimentalFeature::Feature_t i = 0x1; i < static_cast<ExperimentalFeature::Feature_t>(ExperimentalFeature::Feature::Max); i = i << 1)
+            {
+                if (IsEnabledInSettings(settings, static_cast<ExperimentalFeature::Feature>(i)))
+                {
+                    result |= i;
+                }
+            }
+
+            return result;
+        }
+    }
+
     bool ExperimentalFeature::IsEnabled(Feature feature)
     {
-        switch (feature)
+        if (feature == Feature::None)
         {
-        case Feature::None:
             return true;
-        case Feature::ExperimentalCmd:
-            // ExperimentalArg depends on ExperimentalCmd, so instead of failing we could
-            // assume that if ExperimentalArg is enabled then ExperimentalCmd is as well.
-            return User().Get<Setting::EFExperimentalCmd>() || User().Get<Setting::EFExperimentalArg>();
-        case Feature::ExperimentalArg:
-            return User().Get<Setting::EFExperimentalArg>();
-        case Feature::ExperimentalMSStore:
-            return User().Get<Setting::EFExperimentalMSStore>();
-        default:
-            THROW_HR(E_UNEXPECTED);
         }
+
+        auto value = static_cast<Feature_t>(feature);
+        THROW_HR_IF(E_UNEXPECTED, value >= static_cast<Feature_t>(Feature::Max) || (value & (value - 1)) != 0);
+
+        // The user settings do not change while the process runs, so the features are only looked up once
+        static const Feature_t s_enabledFeatures = GetEnabledFeatures(User());
+        return (s_enabledFeatures & value) != 0;
     }
 
     ExperimentalFeature ExperimentalFeature::GetFeature(ExperimentalFeature::Feature feature)
@@ -36,6 +91,28 @@ namespace AppInstaller::Settings
             return ExperimentalFeature{ "Argument Sample", "experimentalArg", "https://aka.ms/winget-settings", Feature::ExperimentalArg };
         case Feature::ExperimentalMSStore:
             return ExperimentalFeature{ "Microsoft Store Support", "experimentalMSStore", "https://aka.ms/winget-settings", Feature::ExperimentalMSStore };
+        case Feature::InMemorySearch:
+            return ExperimentalFeature{ "In Memory Search", "inMemorySearch", "https://aka.ms/winget-settings", Feature::InMemorySearch };
+        case Feature::SearchResultCache:
+            return ExperimentalFeature{ "Search Result Cache", "searchResultCache", "https://aka.ms/winget-settings", Feature::SearchResultCache };
+        case Feature::BackgroundSourceUpdate:
+            return ExperimentalFeature{ "Background Source Update", "backgroundSourceUpdate", "https://aka.ms/winget-settings", Feature::BackgroundSourceUpdate };
+        case Feature::PersistentRangeCache:
+            return ExperimentalFeature{ "Persistent Range Cache", "persistentRangeCache", "https://aka.ms/winget-settings", Feature::PersistentRangeCache };
+        case Feature::InstallerCache:
+            return ExperimentalFeature{ "Installer Cache", "installerCache", "https://aka.ms/winget-settings", Feature::InstallerCache };
+        case Feature::ManifestFetchCache:
+            return ExperimentalFeature{ "Manifest Fetch Cache", "manifestFetchCache", "https://aka.ms/winget-settings", Feature::ManifestFetchCache };
+        case Feature::CompletionIndex:
+            return ExperimentalFeature{ "Completion Index", "completionIndex", "https://aka.ms/winget-settings", Feature::CompletionIndex };
+        case Feature::ServerMode:
+            return ExperimentalFeature{ "Server Mode", "serverMode", "https://aka.ms/winget-settings", Feature::ServerMode };
+        case Feature::Batch:
+            return ExperimentalFeature{ "Batch", "batch", "https://aka.ms/winget-settings", Feature::Batch };
+        case Feature::Upgrade:
+            return ExperimentalFeature{ "Upgrade", "upgrade", "https://aka.ms/winget-settings", Feature::Upgrade };
+        case Feature::HotIndex:
+            return ExperimentalFeature{ "Hot Index", "hotIndex", "https://aka.ms/winget-settings", Feature::HotIndex };
         default:
             THROW_HR(E_UNEXPECTED);
         }
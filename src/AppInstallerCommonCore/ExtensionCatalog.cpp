@@ -3,47 +3,288 @@
 #pragma once
 #include "pch.h"
 #include "winget/ExtensionCatalog.h"
+#include "winget/Settings.h"
+#include "winget/Yaml.h"
+#include "AppInstallerDeployment.h"
 #include "AppInstallerErrors.h"
 #include "AppInstallerLogging.h"
+#include "AppInstallerMsixInfo.h"
 #include "AppInstallerStrings.h"
 
+#include <winrt/Windows.Management.Deployment.h>
+
 namespace AppInstaller::Deployment
 {
     namespace AppExt = winrt::Windows::ApplicationModel::AppExtensions;
 
+    namespace
+    {
+        using namespace std::string_view_literals;
+
+        constexpr std::string_view s_ExtensionCacheYaml_Extensions = "Extensions"sv;
+        constexpr std::string_view s_ExtensionCacheYaml_Extension_Name = "Name"sv;
+        constexpr std::string_view s_ExtensionCacheYaml_Extension_FamilyName = "FamilyName"sv;
+        constexpr std::string_view s_ExtensionCacheYaml_Extension_Id = "Id"sv;
+        constexpr std::string_view s_ExtensionCacheYaml_Extension_FullName = "FullName"sv;
+        constexpr std::string_view s_ExtensionCacheYaml_Extension_Path = "Path"sv;
+        constexpr std::string_view s_ExtensionCacheYaml_Extension_InstallTime = "InstallTime"sv;
+
+        // An extension found in the catalog, along with the package it was found in.
+        struct CachedExtension
+        {
+            std::string Name;
+            std::string FamilyName;
+            std::string Id;
+            std::string FullName;
+            std::string Path;
+            int64_t InstallTime = 0;
+
+            bool IsFor(std::string_view name, std::string_view familyName, std::string_view id) const
+            {
+                return Name == name && Utility::CaseInsensitiveEquals(FamilyName, familyName) && Id == id;
+            }
+        };
+
+        // Gets the time that the package at the given location was installed, from the write time of its manifest;
+        // a package of the same full name that is installed again has a new one. Returns nullopt if it cannot be read.
+        std::optional<int64_t> GetPackageInstallTime(const std::filesystem::path& packagePath)
+        {
+            std::error_code error;
+            auto writeTime = std::filesystem::last_write_time(packagePath / L"AppxManifest.xml", error);
+            if (error)
+            {
+                return {};
+            }
+
+            return static_cast<int64_t>(writeTime.time_since_epoch().count());
+        }
+
+        // Reads the cached extensions; a cache that cannot be read is treated as empty.
+        std::vector<CachedExtension> ReadExtensionCache()
+        {
+            std::vector<CachedExtension> result;
+
+            try
+            {
+                std::optional<std::string> value = Settings::GetSetting(Settings::Streams::ExtensionCatalogCache);
+                if (!value)
+                {
+                    return result;
+                }
+
+                YAML::Node document = YAML::Load(value.value());
+                const YAML::Node& extensions = document[s_ExtensionCacheYaml_Extensions];
+                if (!extensions.IsSequence())
+                {
+                    return result;
+                }
+
+                for (const auto& extension : extensions.Sequence())
+                {
+                    CachedExtension cached;
+                    cached.Name = extension[s_ExtensionCacheYaml_Extension_Name].as<std::string>();
+                    cached.FamilyName = extension[s_ExtensionCacheYaml_Extension_FamilyName].as<std::string>();
+                    cached.Id = extension[s_ExtensionCacheYaml_Extension_Id].as<std::string>();
+                    cached.FullName = extension[s_ExtensionCacheYaml_Extension_FullName].as<std::string>();
+                    cached.Path = extension[s_ExtensionCacheYaml_Extension_Path].as<std::string>();
+                    cached.InstallTime = extension[s_ExtensionCacheYaml_Extension_InstallTime].as<int64_t>();
+                    result.emplace_back(std::move(cached));
+                }
+            }
+            catch (...)
+            {
+                LOG_CAUGHT_EXCEPTION_MSG("Extension catalog cache could not be read");
+                result.clear();
+            }
+
+            return result;
+        }
+
+        void WriteExtensionCache(const std::vector<CachedExtension>& extensions)
+        {
+            try
+            {
+                YAML::Emitter out;
+                out << YAML::BeginMap;
+                out << YAML::Key << s_ExtensionCacheYaml_Extensions;
+                out << YAML::BeginSeq;
+
+                for (const auto& extension : extensions)
+                {
+                    out << YAML::BeginMap;
+                    out << YAML::Key << s_ExtensionCacheYaml_Extension_Name << YAML::Value << extension.Name;
+                    out << YAML::Key << s_ExtensionCacheYaml_Extension_FamilyName << YAML::Value << extension.FamilyName;
+                    out << YAML::Key << s_ExtensionCacheYaml_Extension_Id << YAML::Value << extension.Id;
+                    out << YAML::Key << s_ExtensionCacheYaml_Extension_FullName << YAML::Value << extension.FullName;
+                    out << YAML::Key << s_ExtensionCacheYaml_Extension_Path << YAML::Value << extension.Path;
+                    out << YAML::Key << s_ExtensionCacheYaml_Extension_InstallTime << YAML::Value << extension.InstallTime;
+                    out << YAML::EndMap;
+                }
+
+                out << YAML::EndSeq;
+                out << YAML::EndMap;
+
+                Settings::SetSetting(Settings::Streams::ExtensionCatalogCache, out.str());
+            }
+            CATCH_LOG_MSG("Extension catalog cache could not be written");
+        }
+
+        // Replaces the cached entry for the extension, or removes it if there is no longer one.
+        void UpdateExtensionCache(std::string_view name, std::string_view familyName, std::string_view id, std::optional<CachedExtension> extension)
+        {
+            std::vector<CachedExtension> extensions = ReadExtensionCache();
+            size_t previousSize = extensions.size();
+
+            extensions.erase(
+                std::remove_if(extensions.begin(), extensions.end(), [&](const CachedExtension& cached) { return cached.IsFor(name, familyName, id); }),
+                extensions.end());
+
+            if (extension)
+            {
+                extensions.emplace_back(std::move(extension.value()));
+            }
+            else if (extensions.size() == previousSize)
+            {
+                // Nothing to remove
+                return;
+            }
+
+            WriteExtensionCache(extensions);
+        }
+    }
+
     Extension::Extension(AppExt::AppExtension extension) : m_extension(extension) {}
 
+    Extension::Extension(std::string packageFullName, std::filesystem::path packagePath) :
+        m_packageFullName(std::move(packageFullName)), m_packagePath(std::move(packagePath)) {}
+
     std::filesystem::path Extension::GetPackagePath() const
     {
+        if (!m_extension)
+        {
+            return m_packagePath;
+        }
+
         return m_extension.Package().InstalledLocation().Path().c_str();
     }
 
     std::filesystem::path Extension::GetPublicFolderPath() const
     {
+        THROW_HR_IF(APPINSTALLER_CLI_ERROR_EXTENSION_PUBLIC_FAILED, !m_extension);
+
         auto folder = m_extension.GetPublicFolderAsync().get();
         THROW_HR_IF(APPINSTALLER_CLI_ERROR_EXTENSION_PUBLIC_FAILED, !folder);
         return folder.Path().c_str();
     }
 
+    std::string Extension::GetPackageFullName() const
+    {
+        if (!m_extension)
+        {
+            return m_packageFullName;
+        }
+
+        return Utility::ConvertToUTF8(m_extension.Package().Id().FullName());
+    }
+
     winrt::Windows::ApplicationModel::PackageVersion Extension::GetPackageVersion() const
     {
-        return m_extension.Package().Id().Version();
+        return GetPackage().Id().Version();
     }
 
     bool Extension::VerifyContentIntegrity(IProgressCallback& progress)
     {
-        auto operation = m_extension.Package().VerifyContentIntegrityAsync();
+        auto operation = GetPackage().VerifyContentIntegrityAsync();
         auto removeCancel = progress.SetCancellationFunction([&]() { operation.Cancel(); });
         return operation.get();
     }
 
-    ExtensionCatalog::ExtensionCatalog(std::wstring_view extensionName)
+    winrt::Windows::ApplicationModel::Package Extension::GetPackage() const
+    {
+        if (m_extension)
+        {
+            return m_extension.Package();
+        }
+
+        // An empty user SID is the current user
+        auto package = Deployment::GetPackageManager().FindPackageForUser({}, Utility::ConvertToUTF16(m_packageFullName));
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_NOT_FOUND), !package);
+        return package;
+    }
+
+    ExtensionCatalog::ExtensionCatalog(std::wstring_view extensionName) : m_extensionName(extensionName)
     {
-        m_catalog = AppExt::AppExtensionCatalog::Open(winrt::hstring(extensionName));
     }
 
     std::optional<Extension> ExtensionCatalog::FindByPackageFamilyAndId(std::string_view packageFamilyName, std::wstring_view id) const
     {
+        std::string name = Utility::ConvertToUTF8(m_extensionName);
+        std::string idUtf8 = Utility::ConvertToUTF8(id);
+
+        // The package of the family that is installed now; finding it does not enumerate the catalog
+        std::optional<std::string> fullName;
+        try
+        {
+            fullName = Msix::GetPackageFullNameFromFamilyName(packageFamilyName);
+        }
+        CATCH_LOG();
+
+        if (fullName)
+        {
+            for (const auto& cached : ReadExtensionCache())
+            {
+                if (cached.IsFor(name, packageFamilyName, idUtf8) && cached.FullName == fullName.value())
+                {
+                    std::filesystem::path packagePath = Utility::ConvertToUTF16(cached.Path);
+                    std::optional<int64_t> installTime = GetPackageInstallTime(packagePath);
+
+                    if (installTime && installTime.value() == cached.InstallTime)
+                    {
+                        AICLI_LOG(Core, Verbose, << "Using the cached extension: PFN = " << packageFamilyName << ", ID = " << idUtf8 << ", Package = " << cached.FullName);
+                        return Extension{ cached.FullName, std::move(packagePath) };
+                    }
+                }
+            }
+        }
+
+        std::optional<Extension> result = FindInCatalog(packageFamilyName, id);
+        std::optional<CachedExtension> toCache;
+
+        if (result)
+        {
+            try
+            {
+                CachedExtension cached;
+                cached.Name = name;
+                cached.FamilyName = packageFamilyName;
+                cached.Id = idUtf8;
+                cached.FullName = result->GetPackageFullName();
+
+                std::filesystem::path packagePath = result->GetPackagePath();
+                cached.Path = Utility::ConvertToUTF8(packagePath.wstring());
+
+                std::optional<int64_t> installTime = GetPackageInstallTime(packagePath);
+                if (installTime)
+                {
+                    cached.InstallTime = installTime.value();
+                    toCache = std::move(cached);
+                }
+            }
+            CATCH_LOG();
+        }
+
+        UpdateExtensionCache(name, packageFamilyName, idUtf8, std::move(toCache));
+
+        return result;
+    }
+
+    std::optional<Extension> ExtensionCatalog::FindInCatalog(std::string_view packageFamilyName, std::wstring_view id) const
+    {
+        if (!m_catalog)
+        {
+            m_catalog = AppExt::AppExtensionCatalog::Open(winrt::hstring(m_extensionName));
+        }
+
         std::wstring wpfn = Utility::ConvertToUTF16(packageFamilyName);
         std::optional<Extension> result;
 
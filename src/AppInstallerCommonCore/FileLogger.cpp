@@ -16,13 +16,49 @@ namespace AppInstaller::Logging
     static constexpr std::string_view s_fileLoggerDefaultFilePrefix = "WinGet-"sv;
     static constexpr std::string_view s_fileLoggerDefaultFileExt = ".log"sv;
 
+    static_assert((FileLogger::RingSize & (FileLogger::RingSize - 1)) == 0, "The ring size must be a power of 2");
+    static constexpr size_t s_fileLoggerRingMask = FileLogger::RingSize - 1;
+
+    // The writer is woken whenever this many lines have been added, so that the ring rarely fills between the periodic writes.
+    static constexpr size_t s_fileLoggerWakeEveryRecords = FileLogger::RingSize / 4;
+
+    // A slot that held a long line gives up its buffer once the line is written, rather than keeping it for the life of the logger.
+    static constexpr size_t s_fileLoggerMaxRetainedMessageCapacity = 4096;
+
+    // Flush gives up rather than hang the caller if a line before it is never completed.
+    static constexpr std::chrono::milliseconds s_fileLoggerFlushTimeout = 2s;
+
+    // The units of a FILETIME, which the cleanup reads the times of the log files in.
+    using FileTimeDuration = std::chrono::duration<int64_t, std::ratio<1, 10'000'000>>;
+
+    // Log files older than this are removed by the cleanup.
+    static constexpr FileTimeDuration s_fileLoggerCleanupMaxAge = 7 * 24h;
+
+    // A cleanup pass is skipped if one completed less than this long ago.
+    static constexpr FileTimeDuration s_fileLoggerCleanupInterval = 24h;
+
+    // The most files that a cleanup pass removes, so that a directory with thousands of old logs is cleaned over several launches.
+    static constexpr size_t s_fileLoggerCleanupMaxRemovedFiles = 256;
+
+    // The file whose last write time is when a cleanup pass last completed in the directory.
+    static constexpr std::wstring_view s_fileLoggerCleanupMarkerFileName = L"LastLogCleanup"sv;
+
+    namespace
+    {
+        FileTimeDuration GetAge(const FILETIME& now, const FILETIME& time)
+        {
+            auto toTicks = [](const FILETIME& fileTime) { return static_cast<int64_t>((static_cast<uint64_t>(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime); };
+            return FileTimeDuration{ toTicks(now) - toTicks(time) };
+        }
+    }
+
     FileLogger::FileLogger(const std::filesystem::path& filePath)
     {
         if (filePath.empty())
         {
+            // The default location is only found when the file is created, as finding it can be expensive
             m_name = "file";
-            m_filePath = Runtime::GetPathTo(Runtime::PathName::DefaultLogLocation);
-            m_filePath /= s_fileLoggerDefaultFilePrefix.data() + Utility::GetCurrentTimeForFilename() + s_fileLoggerDefaultFileExt.data();
+            m_defaultFileName = s_fileLoggerDefaultFilePrefix.data() + Utility::GetCurrentTimeForFilename() + s_fileLoggerDefaultFileExt.data();
         }
         else
         {
@@ -30,12 +66,33 @@ namespace AppInstaller::Logging
             m_filePath = filePath;
         }
 
-        m_stream.open(m_filePath);
+        // Each slot starts out free for its first use, at the position equal to its index
+        m_ring.reset(new Record[RingSize]);
+        for (size_t i = 0; i < RingSize; ++i)
+        {
+            m_ring[i].Sequence.store(i, std::memory_order_relaxed);
+        }
+
+        m_wake.create(wil::EventOptions::None);
     }
 
     FileLogger::~FileLogger()
     {
-        m_stream.flush();
+        m_stopping = true;
+        m_wake.SetEvent();
+        m_writtenChanged.notify_all();
+
+        if (m_writer.joinable())
+        {
+            m_writer.join();
+        }
+
+        // Lines logged while the writer was stopping are written here
+        try
+        {
+            WriteRecords();
+        }
+        catch (...) {}
     }
 
     std::string FileLogger::GetNameForPath(const std::filesystem::path& filePath)
@@ -49,39 +106,222 @@ namespace AppInstaller::Logging
         return m_name;
     }
 
-    void FileLogger::Write(Channel channel, Level, std::string_view message) noexcept try
+    void FileLogger::Write(Channel channel, Level level, std::string_view message) noexcept try
     {
-        // Send to a string first to create a single block to write to a file.
-        std::stringstream strstr;
-        strstr << std::chrono::system_clock::now() << " [" << std::setw(GetMaxChannelNameLength()) << std::left << std::setfill(' ') << GetChannelName(channel) << "] " << message;
-        m_stream << strstr.str() << std::endl;
+        auto now = std::chrono::system_clock::now();
+
+        std::call_once(m_writerStarted, [this]() { m_writer = std::thread([this]() { WriteInBackground(); }); });
+
+        // Claim the slot at the next position; it is free once the writer has written the line from one lap before.
+        size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+        Record* record = nullptr;
+
+        for (;;)
+        {
+            record = &m_ring[position & s_fileLoggerRingMask];
+            size_t sequence = record->Sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+            if (difference == 0)
+            {
+                if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The ring is full; wait for the writer to catch up, unless it has stopped
+                if (m_stopping)
+                {
+                    return;
+                }
+
+                m_wake.SetEvent();
+                std::this_thread::yield();
+                position = m_enqueuePosition.load(std::memory_order_relaxed);
+            }
+            else
+            {
+                // Another caller claimed the position first
+                position = m_enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        record->Time = now;
+        record->LogChannel = channel;
+
+        // The slot must be completed even if the copy fails, as the writer waits on it
+        try
+        {
+            record->Message.assign(message);
+        }
+        catch (...)
+        {
+            record->Message.clear();
+        }
+
+        record->Sequence.store(position + 1, std::memory_order_release);
+
+        // A critical line may be the last one before the process ends, so it is written before returning
+        if (level == Level::Crit)
+        {
+            Flush();
+        }
+        else if (level == Level::Error || (position + 1) % s_fileLoggerWakeEveryRecords == 0)
+        {
+            m_wake.SetEvent();
+        }
     }
     catch (...)
     {
         // Just eat any exceptions here; better than losing logs
     }
 
+    void FileLogger::Flush() noexcept try
+    {
+        size_t target = m_enqueuePosition.load(std::memory_order_acquire);
+        m_wake.SetEvent();
+
+        std::unique_lock<std::mutex> lock{ m_writtenLock };
+        m_writtenChanged.wait_for(lock, s_fileLoggerFlushTimeout, [&]() { return m_writtenPosition >= target || m_stopping; });
+    }
+    catch (...) {}
+
+    void FileLogger::WriteInBackground()
+    {
+        while (!m_stopping)
+        {
+            m_wake.wait(static_cast<DWORD>(WriteInterval.count()));
+
+            try
+            {
+                WriteRecords();
+            }
+            catch (...) {}
+        }
+    }
+
+    void FileLogger::WriteRecords()
+    {
+        size_t firstPosition = m_dequeuePosition;
+
+        // Send to a string first to create a single block to write to a file.
+        std::ostringstream batch;
+
+        for (;;)
+        {
+            Record& record = m_ring[m_dequeuePosition & s_fileLoggerRingMask];
+            if (record.Sequence.load(std::memory_order_acquire) != m_dequeuePosition + 1)
+            {
+                break;
+            }
+
+            batch << record.Time << " [" << std::setw(GetMaxChannelNameLength()) << std::left << std::setfill(' ') << GetChannelName(record.LogChannel) << "] " << record.Message << '\n';
+
+            if (record.Message.capacity() > s_fileLoggerMaxRetainedMessageCapacity)
+            {
+                std::string{}.swap(record.Message);
+            }
+
+            // Free the slot for its use one lap later
+            record.Sequence.store(m_dequeuePosition + RingSize, std::memory_order_release);
+            ++m_dequeuePosition;
+        }
+
+        if (m_dequeuePosition != firstPosition)
+        {
+            if (!m_stream.is_open())
+            {
+                if (m_filePath.empty())
+                {
+                    m_filePath = Runtime::GetPathTo(Runtime::PathName::DefaultLogLocation);
+                    m_filePath /= m_defaultFileName;
+                }
+
+                m_stream.open(m_filePath);
+            }
+
+            m_stream << batch.str();
+            m_stream.flush();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{ m_writtenLock };
+            m_writtenPosition = m_dequeuePosition;
+        }
+        m_writtenChanged.notify_all();
+    }
+
     void FileLogger::BeginCleanup(const std::filesystem::path& filePath)
     {
         std::thread([filePath]()
             {
+                // The cleanup must not take disk time from the command that is running, so its I/O is background priority
+                SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+
                 try
                 {
-                    auto now = std::filesystem::file_time_type::clock::now();
-
-                    // Remove all files that are older than 7 days from the standard log location.
-                    for (auto& file : std::filesystem::directory_iterator{ filePath })
-                    {
-                        if (file.is_regular_file() &&
-                            now - file.last_write_time() > (7 * 24h) &&
-                            Utility::CaseInsensitiveStartsWith(file.path().filename().string(), s_fileLoggerDefaultFilePrefix))
-                        {
-                            std::filesystem::remove(file.path());
-                        }
-                    }
+                    std::filesystem::path directory = filePath.empty() ? Runtime::GetPathTo(Runtime::PathName::DefaultLogLocation) : filePath;
+                    Cleanup(directory);
                 }
                 // Just throw out everything
                 catch (...) {}
             }).detach();
     }
+
+    bool FileLogger::Cleanup(const std::filesystem::path& directory)
+    {
+        FILETIME now{};
+        GetSystemTimeAsFileTime(&now);
+
+        std::filesystem::path markerPath = directory / s_fileLoggerCleanupMarkerFileName;
+
+        WIN32_FILE_ATTRIBUTE_DATA markerData{};
+        if (GetFileAttributesExW(markerPath.c_str(), GetFileExInfoStandard, &markerData) &&
+            GetAge(now, markerData.ftLastWriteTime) < s_fileLoggerCleanupInterval)
+        {
+            return false;
+        }
+
+        // The enumeration returns the write time of each file with its name, and fetches them in large batches,
+        // so the only other I/O is the removals themselves.
+        std::wstring pattern = (directory / Utility::ConvertToUTF16(s_fileLoggerDefaultFilePrefix)).wstring() + L'*';
+        WIN32_FIND_DATAW findData{};
+        wil::unique_hfind find{ FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &findData, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH) };
+
+        if (find)
+        {
+            size_t removed = 0;
+
+            do
+            {
+                if (WI_IsFlagClear(findData.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY) &&
+                    GetAge(now, findData.ftLastWriteTime) > s_fileLoggerCleanupMaxAge)
+                {
+                    if (removed == s_fileLoggerCleanupMaxRemovedFiles)
+                    {
+                        // The next launch continues where this pass stopped
+                        return false;
+                    }
+
+                    // A file that is still in use by another process is left for a later pass
+                    if (DeleteFileW((directory / findData.cFileName).c_str()))
+                    {
+                        ++removed;
+                    }
+                }
+            } while (FindNextFileW(find.get(), &findData));
+        }
+        else
+        {
+            THROW_LAST_ERROR_IF(GetLastError() != ERROR_FILE_NOT_FOUND);
+        }
+
+        wil::unique_hfile marker{ CreateFileW(markerPath.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        THROW_LAST_ERROR_IF(!marker);
+        THROW_IF_WIN32_BOOL_FALSE(SetFileTime(marker.get(), nullptr, nullptr, &now));
+
+        return true;
+    }
 }
@@ -0,0 +1,82 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Public/winget/HttpSession.h"
+#include "Public/AppInstallerLogging.h"
+
+using namespace winrt::Windows::Web::Http;
+using namespace winrt::Windows::Web::Http::Filters;
+
+namespace AppInstaller::Utility
+{
+    namespace
+    {
+        HINTERNET CreateInternetSession(bool decodeContent)
+        {
+            HINTERNET session = InternetOpenA(
+                "winget-cli",
+                INTERNET_OPEN_TYPE_PRECONFIG,
+                NULL,
+                NULL,
+                0);
+            THROW_LAST_ERROR_IF_NULL_MSG(session, "InternetOpen() failed.");
+
+            // Older versions of WinINet do not know the option; they keep using HTTP/1.1
+            DWORD protocols = HTTP_PROTOCOL_FLAG_HTTP2;
+            if (!InternetSetOptionA(session, INTERNET_OPTION_ENABLE_HTTP_PROTOCOL, &protocols, sizeof(protocols)))
+            {
+                AICLI_LOG(Core, Info, << "HTTP/2 could not be enabled for the shared session: " << GetLastError());
+            }
+
+            if (decodeContent)
+            {
+                BOOL decoding = TRUE;
+                if (!InternetSetOptionA(session, INTERNET_OPTION_HTTP_DECODING, &decoding, sizeof(decoding)))
+                {
+                    AICLI_LOG(Core, Info, << "HTTP decoding could not be enabled for the shared session: " << GetLastError());
+                }
+            }
+
+            return session;
+        }
+
+        HttpClient CreateHttpClient()
+        {
+            // Use an HTTP filter to disable the default caching behavior and use the Most Recent caching behavior instead
+            // so we don't use a stale cached resource.
+            HttpBaseProtocolFilter filter;
+            filter.CacheControl().ReadBehavior(HttpCacheReadBehavior::MostRecent);
+
+            try
+            {
+                filter.MaxVersion(HttpVersion::Http20);
+            }
+            catch (...)
+            {
+                // Older versions of the OS do not have the property; they keep using HTTP/1.1
+                LOG_CAUGHT_EXCEPTION();
+            }
+
+            return HttpClient(filter);
+        }
+    }
+
+    HINTERNET GetSharedInternetSession()
+    {
+        // Never closed; the session lives as long as the process, as other threads may still be downloading while it exits.
+        static HINTERNET s_session = CreateInternetSession(false);
+        return s_session;
+    }
+
+    HINTERNET GetSharedDecodingInternetSession()
+    {
+        static HINTERNET s_session = CreateInternetSession(true);
+        return s_session;
+    }
+
+    HttpClient GetSharedHttpClient()
+    {
+        static HttpClient s_client = CreateHttpClient();
+        return s_client;
+    }
+}
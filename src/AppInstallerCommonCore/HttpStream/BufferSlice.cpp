@@ -0,0 +1,112 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include "BufferSlice.h"
+
+using namespace winrt::Windows::Storage::Streams;
+
+// Note: this class is used by the HttpRandomAccessStream which is passed to the AppxPackaging COM API
+// All exceptions thrown across dll boundaries should be WinRT exception not custom exceptions.
+// The HRESULTs will be mapped to UI error code by the appropriate component
+namespace AppInstaller::Utility::HttpStream
+{
+    namespace
+    {
+        byte* GetBufferData(const IBuffer& buffer)
+        {
+            Microsoft::WRL::ComPtr<::Windows::Storage::Streams::IBufferByteAccess> bufferByteAccess;
+            ::IInspectable* bufferAbi = (::IInspectable*)winrt::get_abi(buffer);
+            winrt::check_hresult(bufferAbi->QueryInterface(IID_PPV_ARGS(&bufferByteAccess)));
+            byte* byteBuffer = nullptr;
+            winrt::check_hresult(bufferByteAccess->Buffer(&byteBuffer));
+            return byteBuffer;
+        }
+
+        // A buffer over part of the data of another one, which it keeps alive.
+        struct BufferSliceView : winrt::implements<BufferSliceView, IBuffer, ::Windows::Storage::Streams::IBufferByteAccess>
+        {
+            BufferSliceView(IBuffer buffer, byte* data, UINT32 size) :
+                m_buffer(std::move(buffer)), m_data(data), m_capacity(size), m_length(size) {}
+
+            uint32_t Capacity() const
+            {
+                return m_capacity;
+            }
+
+            uint32_t Length() const
+            {
+                return m_length;
+            }
+
+            void Length(uint32_t value)
+            {
+                THROW_HR_IF(E_INVALIDARG, value > m_capacity);
+                m_length = value;
+            }
+
+            HRESULT __stdcall Buffer(byte** value) noexcept final
+            {
+                *value = m_data;
+                return S_OK;
+            }
+
+        private:
+            IBuffer m_buffer;
+            byte* m_data;
+            uint32_t m_capacity;
+            uint32_t m_length;
+        };
+    }
+
+    BufferSlice::BufferSlice(IBuffer buffer)
+    {
+        m_size = buffer.Length();
+        m_data = m_size > 0 ? GetBufferData(buffer) : nullptr;
+        m_buffer = std::move(buffer);
+    }
+
+    BufferSlice::BufferSlice(IBuffer buffer, byte* data, UINT32 size) :
+        m_buffer(std::move(buffer)), m_data(data), m_size(size) {}
+
+    BufferSlice BufferSlice::Allocate(UINT32 size)
+    {
+        winrt::Windows::Storage::Streams::Buffer buffer{ size };
+        buffer.Length(size);
+        return BufferSlice{ buffer };
+    }
+
+    BufferSlice BufferSlice::Slice(UINT32 offset, UINT32 size) const
+    {
+        UINT32 end;
+        winrt::check_hresult(UInt32Add(offset, size, &end));
+        THROW_HR_IF(E_BOUNDS, end > m_size);
+
+        return { m_buffer, m_data + offset, size };
+    }
+
+    bool BufferSlice::IsFollowedBy(const BufferSlice& other) const
+    {
+        return m_buffer && m_buffer == other.m_buffer && m_data + m_size == other.m_data;
+    }
+
+    BufferSlice BufferSlice::Join(const BufferSlice& next) const
+    {
+        THROW_HR_IF(E_INVALIDARG, !IsFollowedBy(next));
+
+        UINT32 size;
+        winrt::check_hresult(UInt32Add(m_size, next.m_size, &size));
+
+        return { m_buffer, m_data, size };
+    }
+
+    IBuffer BufferSlice::AsBuffer() const
+    {
+        if (!m_buffer)
+        {
+            return winrt::Windows::Storage::Streams::Buffer{ 0 };
+        }
+
+        return winrt::make<BufferSliceView>(m_buffer, m_data, m_size);
+    }
+}
@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+#include "pch.h"
+
+namespace AppInstaller::Utility::HttpStream
+{
+    // A view of part of a buffer, which holds a reference to the buffer rather than a copy of its data.
+    // A downloaded range lives in a single allocation however many pages and reads are cut from it;
+    // the allocation is freed with the last view of it. Views that are shared must not be written to.
+    class BufferSlice
+    {
+    public:
+        BufferSlice() = default;
+
+        // A view of the data of the whole buffer, up to its length.
+        explicit BufferSlice(winrt::Windows::Storage::Streams::IBuffer buffer);
+
+        // Allocates a buffer of the given size, to be filled through Data() before it is shared.
+        static BufferSlice Allocate(UINT32 size);
+
+        // Gets a view of part of this one; throws if it does not fit in this one.
+        BufferSlice Slice(UINT32 offset, UINT32 size) const;
+
+        // Whether the other slice starts where this one ends, in the same buffer, so that the two can be joined without a copy.
+        bool IsFollowedBy(const BufferSlice& other) const;
+
+        // Joins a slice that follows this one, as determined by IsFollowedBy.
+        BufferSlice Join(const BufferSlice& next) const;
+
+        // Gets a buffer over the data of the slice, without copying it.
+        winrt::Windows::Storage::Streams::IBuffer AsBuffer() const;
+
+        byte* Data() const { return m_data; }
+
+        UINT32 Size() const { return m_size; }
+
+    private:
+        BufferSlice(winrt::Windows::Storage::Streams::IBuffer buffer, byte* data, UINT32 size);
+
+        winrt::Windows::Storage::Streams::IBuffer m_buffer = nullptr;
+        byte* m_data = nullptr;
+        UINT32 m_size = 0;
+    };
+}
@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Public/winget/HttpAccessTrace.h"
+
+namespace AppInstaller::Utility::HttpStream
+{
+    namespace
+    {
+        // Guards the trace being recorded, which is only set while it exists.
+        std::mutex s_ActiveTraceLock;
+        AccessTrace* s_ActiveTrace = nullptr;
+    }
+
+    AccessTrace::AccessTrace()
+    {
+        std::lock_guard<std::mutex> lock{ s_ActiveTraceLock };
+        THROW_HR_IF(E_NOT_VALID_STATE, s_ActiveTrace != nullptr);
+        s_ActiveTrace = this;
+    }
+
+    AccessTrace::~AccessTrace()
+    {
+        std::lock_guard<std::mutex> lock{ s_ActiveTraceLock };
+        s_ActiveTrace = nullptr;
+    }
+
+    std::vector<AccessTraceEntry> AccessTrace::GetEntries() const
+    {
+        std::lock_guard<std::mutex> lock{ m_lock };
+        return m_entries;
+    }
+
+    void AccessTrace::Record(const void* stream, uint64_t offset, uint32_t size, bool hit)
+    {
+        std::lock_guard<std::mutex> activeLock{ s_ActiveTraceLock };
+        if (!s_ActiveTrace)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock{ s_ActiveTrace->m_lock };
+
+        // A stream that is destroyed while tracing may have its address reused by a later one, which is then taken as the same stream
+        auto itr = s_ActiveTrace->m_streams.try_emplace(stream, static_cast<uint32_t>(s_ActiveTrace->m_streams.size())).first;
+
+        AccessTraceEntry entry;
+        entry.Stream = itr->second;
+        entry.Offset = offset;
+        entry.Size = size;
+        entry.Hit = hit;
+        s_ActiveTrace->m_entries.emplace_back(entry);
+    }
+}
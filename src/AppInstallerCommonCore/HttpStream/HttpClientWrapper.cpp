@@ -3,10 +3,10 @@
 
 #include "pch.h"
 #include "Public/AppInstallerStrings.h"
+#include "Public/winget/HttpSession.h"
 #include "HttpClientWrapper.h"
 
 using namespace winrt::Windows::Foundation;
-using namespace winrt::Windows::Security::Cryptography;
 using namespace winrt::Windows::Storage;
 using namespace winrt::Windows::Storage::Streams;
 using namespace winrt::Windows::Web::Http;
@@ -22,22 +22,67 @@ namespace AppInstaller::Utility::HttpStream
     {
         std::shared_ptr<HttpClientWrapper> instance = std::make_shared<HttpClientWrapper>();
 
-        // Use an HTTP filter to disable the default caching behavior and use the Most Recent caching behavior instead
-        // so we don't use a stale cached resource. Note: this wrapper object is used in the custom HTTP stream implementation
-        // so this affects the parsing of HTTP-based packages/bundles.
-        HttpBaseProtocolFilter filter;
-        filter.CacheControl().ReadBehavior(HttpCacheReadBehavior::MostRecent);
-        instance->m_httpClient = HttpClient(filter);
+        // The process-wide client reuses its connections across streams, and does not use a stale cached resource.
+        // Note: this wrapper object is used in the custom HTTP stream implementation so this affects the parsing of
+        // HTTP-based packages/bundles.
+        instance->m_httpClient = GetSharedHttpClient();
         instance->m_requestUri = uri;
 
-        instance->m_httpClient.DefaultRequestHeaders().Connection().Clear();
-        instance->m_httpClient.DefaultRequestHeaders().Append(L"Connection", L"Keep-Alive");
-
-        co_await instance->PopulateInfoAsync();
+        // The tail request saves a round trip over a HEAD request, as the zip reader reads the end of the data first
+        bool populatedFromTail = co_await instance->PopulateInfoFromTailAsync();
+        if (!populatedFromTail)
+        {
+            co_await instance->PopulateInfoAsync();
+        }
 
         co_return instance;
     }
 
+    std::future<bool> HttpClientWrapper::PopulateInfoFromTailAsync()
+    {
+        HttpRequestMessage request(HttpMethod::Get(), m_requestUri);
+        request.Headers().Append(L"Range", L"bytes=-" + std::to_wstring(TAIL_REQUEST_SIZE));
+
+        HttpResponseMessage response = co_await m_httpClient.SendRequestAsync(request, HttpCompletionOption::ResponseHeadersRead);
+        HttpContentHeaderCollection contentHeaders = response.Content().Headers();
+
+        // A server that ignores the range returns all of the data, which is not read here; the HEAD request handles it as before
+        if (response.StatusCode() != HttpStatusCode::PartialContent || !contentHeaders.HasKey(L"Content-Range"))
+        {
+            response.Close();
+            co_return false;
+        }
+
+        // format: bytes a-b/x where x is either a number or *
+        std::wstring contentRange(contentHeaders.Lookup(L"Content-Range"));
+        size_t startPosition = contentRange.find(L' ');
+        size_t endPosition = contentRange.find(L'-');
+        size_t lengthPosition = contentRange.find(L'/');
+
+        if (startPosition == std::wstring::npos || endPosition == std::wstring::npos || lengthPosition == std::wstring::npos ||
+            startPosition > endPosition || endPosition > lengthPosition || contentRange.substr(lengthPosition + 1) == L"*")
+        {
+            response.Close();
+            co_return false;
+        }
+
+        m_sizeInBytes = std::stoull(contentRange.substr(lengthPosition + 1));
+        m_tailPosition = std::stoull(contentRange.substr(startPosition + 1, endPosition - startPosition - 1));
+        ULONG64 tailEndPosition = std::stoull(contentRange.substr(endPosition + 1, lengthPosition - endPosition - 1));
+
+        PopulateInfoFromResponse(response);
+
+        IBuffer tail = co_await response.Content().ReadAsBufferAsync();
+
+        // Only a tail that runs to the end of the data can be cached whole
+        if (tailEndPosition + 1 == m_sizeInBytes && tail.Length() == m_sizeInBytes - m_tailPosition)
+        {
+            m_tailBuffer = std::move(tail);
+        }
+
+        co_return true;
+    }
+
     // this function will issue a HEAD request to determine the size of the file and the redirect URI
     std::future<void> HttpClientWrapper::PopulateInfoAsync()
     {
@@ -58,6 +103,17 @@ namespace AppInstaller::Utility::HttpStream
             m_sizeInBytes = 0;
         }
 
+        PopulateInfoFromResponse(response);
+
+        // If the size wasn't resolved try with a GET 0-0 request
+        if (m_sizeInBytes == 0)
+        {
+            co_await SendHttpRequestAsync(0, 1);
+        }
+    }
+
+    void HttpClientWrapper::PopulateInfoFromResponse(const HttpResponseMessage& response)
+    {
         // Get the extension from the redirect URI
         m_redirectUri = response.RequestMessage().RequestUri();
 
@@ -65,10 +121,15 @@ namespace AppInstaller::Utility::HttpStream
             response.Content().Headers().Lookup(L"Content-Type")
             : L"";
 
-        // If the size wasn't resolved try with a GET 0-0 request
-        if (m_sizeInBytes == 0)
+        // Capture the validators now, so that every range is requested from the same version of the data
+        if (response.Headers().HasKey(L"ETag"))
         {
-            co_await SendHttpRequestAsync(0, 1);
+            m_etagHeader = response.Headers().Lookup(L"ETag");
+        }
+
+        if (response.Content().Headers().HasKey(L"Last-Modified"))
+        {
+            m_lastModifiedHeader = response.Content().Headers().Lookup(L"Last-Modified");
         }
     }
 
@@ -89,14 +150,18 @@ namespace AppInstaller::Utility::HttpStream
         HttpRequestMessage request(HttpMethod::Get(), m_requestUri);
         request.Headers().Append(L"Range", rangeHeaderValue);
 
-        if (!Utility::IsEmptyOrWhitespace(m_etagHeader))
         {
-            request.Headers().Append(L"If-Match", m_etagHeader);
-        }
+            std::lock_guard<std::mutex> lock{ m_validatorsLock };
 
-        if (!Utility::IsEmptyOrWhitespace(m_lastModifiedHeader))
-        {
-            request.Headers().Append(L"If-Unmodified-Since", m_lastModifiedHeader);
+            if (!Utility::IsEmptyOrWhitespace(m_etagHeader))
+            {
+                request.Headers().Append(L"If-Match", m_etagHeader);
+            }
+
+            if (!Utility::IsEmptyOrWhitespace(m_lastModifiedHeader))
+            {
+                request.Headers().Append(L"If-Unmodified-Since", m_lastModifiedHeader);
+            }
         }
 
         HttpResponseMessage response = co_await m_httpClient.SendRequestAsync(request, HttpCompletionOption::ResponseHeadersRead);
@@ -115,14 +180,18 @@ namespace AppInstaller::Utility::HttpStream
             THROW_HR(HRESULT_FROM_WIN32(ERROR_NO_RANGES_PROCESSED));
         }
 
-        if (Utility::IsEmptyOrWhitespace(m_etagHeader) && response.Headers().HasKey(L"ETag"))
         {
-            m_etagHeader = response.Headers().Lookup(L"ETag");
-        }
+            std::lock_guard<std::mutex> lock{ m_validatorsLock };
 
-        if (Utility::IsEmptyOrWhitespace(m_lastModifiedHeader) && contentHeaders.HasKey(L"Last-Modified"))
-        {
-            m_lastModifiedHeader = contentHeaders.Lookup(L"Last-Modified");
+            if (Utility::IsEmptyOrWhitespace(m_etagHeader) && response.Headers().HasKey(L"ETag"))
+            {
+                m_etagHeader = response.Headers().Lookup(L"ETag");
+            }
+
+            if (Utility::IsEmptyOrWhitespace(m_lastModifiedHeader) && contentHeaders.HasKey(L"Last-Modified"))
+            {
+                m_lastModifiedHeader = contentHeaders.Lookup(L"Last-Modified");
+            }
         }
 
         // If we don't know the size, parse it from the Content-Range field.
@@ -142,9 +211,7 @@ namespace AppInstaller::Utility::HttpStream
         const UINT32 requestedSizeInBytes,
         const InputStreamOptions& options)
     {
-        std::vector<byte> byteArray(requestedSizeInBytes);
-        IBuffer buffer = CryptographicBuffer::CreateFromByteArray(byteArray);
-
+        // The content is returned in the buffer it was read into; the cache shares it rather than copying it.
         co_return co_await SendHttpRequestAsync(startPosition, requestedSizeInBytes);
     }
 }
\ No newline at end of file
@@ -6,11 +6,17 @@
 
 namespace AppInstaller::Utility::HttpStream
 {
-    // Wrapper around HTTP client. When created, an object of this class will send a HTTP 
-    // head request to determine the size of the data source.
+    // Wrapper around HTTP client. When created, an object of this class will request the end of the data source,
+    // which is where a zip is read from first, to determine its size; it falls back to a HTTP head request if the
+    // server does not return the range.
+    // Ranges can be downloaded concurrently, by the clones of a stream.
     class HttpClientWrapper
     {
     public:
+        // The size of the end of the data requested on creation; enough for the zip end of central directory record
+        // with the largest comment it can have.
+        static constexpr UINT32 TAIL_REQUEST_SIZE = 2 << 16;
+
         static std::future<std::shared_ptr<HttpClientWrapper>> CreateAsync(const winrt::Windows::Foundation::Uri& uri);
 
         std::future<winrt::Windows::Storage::Streams::IBuffer> DownloadRangeAsync(
@@ -33,17 +39,47 @@ namespace AppInstaller::Utility::HttpStream
             return m_contentType;
         }
 
+        // The ETag of the data, if the server provided one; range requests only succeed while it still matches.
+        std::wstring GetETag()
+        {
+            std::lock_guard<std::mutex> lock{ m_validatorsLock };
+            return m_etagHeader;
+        }
+
+        // Takes the end of the data that was downloaded on creation; null if the server did not return it.
+        winrt::Windows::Storage::Streams::IBuffer TakeTailBuffer()
+        {
+            return std::exchange(m_tailBuffer, nullptr);
+        }
+
+        // The position in the data of the start of the tail buffer.
+        ULONG64 GetTailPosition()
+        {
+            return m_tailPosition;
+        }
+
     private:
-        winrt::Windows::Web::Http::HttpClient m_httpClient;
+        winrt::Windows::Web::Http::HttpClient m_httpClient = nullptr;
         winrt::Windows::Foundation::Uri m_requestUri = nullptr;
         winrt::Windows::Foundation::Uri m_redirectUri = nullptr;
         std::wstring m_contentType;
         unsigned long long m_sizeInBytes;
+        // Guards the validators, which are filled in by the first response that has them.
+        std::mutex m_validatorsLock;
         std::wstring m_etagHeader;
         std::wstring m_lastModifiedHeader;
+        winrt::Windows::Storage::Streams::IBuffer m_tailBuffer = nullptr;
+        ULONG64 m_tailPosition = 0;
+
+        // Requests the end of the data, learning its size from the Content-Range of the response.
+        // Returns false if the server did not return the range, in which case nothing is populated.
+        std::future<bool> PopulateInfoFromTailAsync();
 
         std::future<void> PopulateInfoAsync();
 
+        // Reads the redirect URI, content type and validators of the data from a response for it.
+        void PopulateInfoFromResponse(const winrt::Windows::Web::Http::HttpResponseMessage& response);
+
         std::future<winrt::Windows::Storage::Streams::IBuffer> SendHttpRequestAsync(
             _In_ ULONG64 startPosition,
             _In_ UINT32 requestedSizeInBytes);
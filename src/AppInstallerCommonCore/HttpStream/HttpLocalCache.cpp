@@ -3,58 +3,253 @@
 
 #include "pch.h"
 #include "HttpLocalCache.h"
+#include "Public/AppInstallerRuntime.h"
+#include "Public/AppInstallerSHA256.h"
+#include "Public/AppInstallerStrings.h"
+#include "Public/winget/ExperimentalFeature.h"
+#include "Public/winget/HttpAccessTrace.h"
 
-using namespace Windows::Storage::Streams;
 using namespace winrt::Windows::Storage::Streams;
-using namespace winrt::Windows::Security::Cryptography;
 
 // Note: this class is used by the HttpRandomAccessStream which is passed to the AppxPackaging COM API
 // All exceptions thrown across dll boundaries should be WinRT exception not custom exceptions.
 // The HRESULTs will be mapped to UI error code by the appropriate component
 namespace AppInstaller::Utility::HttpStream
 {
+    namespace
+    {
+        constexpr std::wstring_view s_DiskCacheDirectoryName = L"HttpRangeCache";
+        constexpr std::wstring_view s_DiskCachePageExtension = L".page";
+
+        std::string HashToDirectoryName(const std::wstring& value)
+        {
+            std::string valueUtf8 = Utility::ConvertToUTF8(value);
+            return Utility::SHA256::ConvertToString(Utility::SHA256::ComputeHash(reinterpret_cast<const uint8_t*>(valueUtf8.data()), static_cast<uint32_t>(valueUtf8.size())));
+        }
+    }
+
+    HttpLocalCache::HttpLocalCache(std::filesystem::path diskCacheDirectory) : m_diskCacheDirectory(std::move(diskCacheDirectory))
+    {
+        // Pages that are also on disk are only read again, rather than downloaded
+        m_memoryRegistration = Memory::MemoryBudget::Instance().Register("HTTP range cache",
+            (m_diskCacheDirectory.empty() ? Memory::TrimOrder::Normal : Memory::TrimOrder::Early),
+            [this]()
+            {
+                std::lock_guard<std::mutex> lock{ m_lock };
+                return m_localCache.size() * static_cast<size_t>(PAGE_SIZE);
+            },
+            [this](size_t bytesToFree) { TrimCache(bytesToFree); });
+    }
+
+    HttpLocalCache::~HttpLocalCache()
+    {
+        for (auto& readAhead : m_readAheads)
+        {
+            if (readAhead.valid())
+            {
+                readAhead.wait();
+            }
+        }
+    }
+
     std::future<IBuffer> HttpLocalCache::ReadFromCacheAndDownloadIfNecessaryAsync(
         const ULONG64 requestedPosition,
         const UINT32 requestedSize,
         HttpClientWrapper* httpClientWrapper,
-        InputStreamOptions httpInputStreamOptions)
+        InputStreamOptions httpInputStreamOptions,
+        ReadSequence& sequence)
     {
-        // Increment cache access counter user for implementing LRU replacement
-        m_accessCounter++;
+        co_await CompleteReadAheadAsync();
 
-        // Find all the pages for the given request, and the pages that are missing
-        std::vector<ULONG64> allPages;
-        std::vector<ULONG64> unsatisfiablePages;
-        FindCachePages(requestedPosition, requestedSize, allPages, unsatisfiablePages);
+        // Grow the read-ahead while the reads of the stream are sequential, and stop it when they are not
+        if (requestedPosition == sequence.NextPosition)
+        {
+            sequence.ReadAheadPages = std::min(std::max(sequence.ReadAheadPages * 2, 1U), MAX_READ_AHEAD_PAGES);
+        }
+        else
+        {
+            sequence.ReadAheadPages = 0U;
+        }
+
+        ULONG64 requestedEndPosition;
+        winrt::check_hresult(ULong64Add(requestedPosition, requestedSize, &requestedEndPosition));
+        sequence.NextPosition = requestedEndPosition;
+
+        UINT32 readAheadPageCount = sequence.ReadAheadPages;
+        UINT64 fileSize = httpClientWrapper->GetFullFileSize();
+
+        std::vector<BufferSlice> parts;
+        std::vector<ULONG64> readAheadPages;
+        bool downloaded = false;
 
-        // download the missing pages
-        co_await DownloadAndSaveToCacheAysnc(
-            unsatisfiablePages,
-            httpClientWrapper,
-            httpInputStreamOptions);
+        // The lock is only held while the cache is used, never across a download. A page downloaded here can be evicted by
+        // other streams over this cache before it is read, so the pages still missing are downloaded again, once.
+        for (UINT32 attempt = 0; ; attempt++)
+        {
+            std::vector<ULONG64> unsatisfiablePages;
+
+            {
+                std::lock_guard<std::mutex> lock{ m_lock };
+
+                // Find all the pages for the given request, and the pages that are missing
+                std::vector<ULONG64> allPages;
+                FindCachePages(requestedPosition, requestedSize, allPages, unsatisfiablePages);
+
+                // Pages kept on disk by an earlier open of the same data do not need to be downloaded
+                if (!m_diskCacheDirectory.empty())
+                {
+                    unsatisfiablePages.erase(
+                        std::remove_if(unsatisfiablePages.begin(), unsatisfiablePages.end(), [&](ULONG64 pageOffset) { return LoadPageFromDisk(pageOffset, fileSize); }),
+                        unsatisfiablePages.end());
+                }
+
+                if (unsatisfiablePages.empty() || attempt > 1)
+                {
+                    // Everything should be in the cache; the parts are taken while holding the lock, and share the data of the pages.
+                    for (UINT32 i = 0; i < allPages.size(); i++)
+                    {
+                        BufferSlice part = GetPageFromCache(allPages[i], requestedPosition, requestedEndPosition);
+                        if (part.Size() != 0)
+                        {
+                            parts.emplace_back(std::move(part));
+                        }
+                    }
+
+                    VacateStaleEntriesFromCache();
+
+                    if (readAheadPageCount > 0U)
+                    {
+                        readAheadPages = GetReadAheadPages(requestedEndPosition, readAheadPageCount, fileSize);
+                    }
+
+                    break;
+                }
+            }
 
-        // At this point, everything should be in the cache
-        IBuffer constructedBuffer = {};
+            // download the missing pages
+            downloaded = true;
+            co_await DownloadAndSaveToCacheAysnc(
+                unsatisfiablePages,
+                httpClientWrapper,
+                httpInputStreamOptions);
+        }
 
-        for (UINT32 i = 0; i < allPages.size(); i++)
+        // The download runs while the caller consumes this read; the next read over the cache waits for it.
+        if (!readAheadPages.empty())
         {
-            UINT64 pageOffset = allPages[i];
-            IBuffer cachedPageBuffer = ReadPageFromCache(pageOffset);
-            constructedBuffer = ConcatenateBuffers(constructedBuffer, cachedPageBuffer);
+            std::future<void> readAhead = DownloadAndSaveToCacheAysnc(std::move(readAheadPages), httpClientWrapper, httpInputStreamOptions);
+
+            std::lock_guard<std::mutex> lock{ m_lock };
+            m_readAheads.emplace_back(std::move(readAhead));
         }
 
-        // trim buffer to match requested range
-        IBuffer requestedBuffer = TrimBufferToSatisfyRequest(
-            constructedBuffer,
-            requestedPosition,
-            requestedSize,
-            allPages);
+        AccessTrace::Record(&sequence, requestedPosition, requestedSize, !downloaded);
 
-        VacateStaleEntriesFromCache();
+        // The parts of the range usually lie next to each other in the data of one download, so that they can be returned
+        // as a view of it; otherwise they are copied together.
+        bool contiguous = true;
+        UINT32 resultSize = 0;
+
+        for (size_t i = 0; i < parts.size(); i++)
+        {
+            contiguous = contiguous && (i == 0 || parts[i - 1].IsFollowedBy(parts[i]));
+            resultSize += parts[i].Size();
+        }
+
+        IBuffer requestedBuffer = nullptr;
+        if (contiguous)
+        {
+            BufferSlice result = parts.empty() ? BufferSlice{} : parts.front();
+            for (size_t i = 1; i < parts.size(); i++)
+            {
+                result = result.Join(parts[i]);
+            }
+
+            requestedBuffer = result.AsBuffer();
+        }
+        else
+        {
+            BufferSlice result = BufferSlice::Allocate(resultSize);
+            byte* resultData = result.Data();
+
+            for (const auto& part : parts)
+            {
+                memcpy(resultData, part.Data(), part.Size());
+                resultData += part.Size();
+            }
+
+            requestedBuffer = result.AsBuffer();
+        }
 
         co_return requestedBuffer;
     }
 
+    void HttpLocalCache::SeedCache(const IBuffer& buffer, const ULONG64 position)
+    {
+        BufferSlice data{ buffer };
+
+        ULONG64 firstPageOffset;
+        winrt::check_hresult(ULong64Mult(((position + PAGE_SIZE - 1) / PAGE_SIZE), PAGE_SIZE, &firstPageOffset));
+
+        if (firstPageOffset - position >= data.Size())
+        {
+            return;
+        }
+
+        // Conversion is safe as it is less than the size of the buffer.
+        UINT32 skippedSize = static_cast<UINT32>(firstPageOffset - position);
+
+        std::lock_guard<std::mutex> lock{ m_lock };
+        SaveBufferToCache(data.Slice(skippedSize, data.Size() - skippedSize).AsBuffer(), firstPageOffset);
+        VacateStaleEntriesFromCache();
+    }
+
+    std::future<void> HttpLocalCache::CompleteReadAheadAsync()
+    {
+        std::vector<std::future<void>> readAheads;
+
+        {
+            std::lock_guard<std::mutex> lock{ m_lock };
+            readAheads = std::move(m_readAheads);
+            m_readAheads.clear();
+        }
+
+        for (auto& readAhead : readAheads)
+        {
+            try
+            {
+                co_await std::move(readAhead);
+            }
+            catch (...)
+            {
+                LOG_CAUGHT_EXCEPTION_MSG("Read-ahead failed");
+            }
+        }
+    }
+
+    std::vector<ULONG64> HttpLocalCache::GetReadAheadPages(
+        const ULONG64 requestedEndPosition,
+        const UINT32 readAheadPageCount,
+        const UINT64 fileSize)
+    {
+        // Start at the first page that the request did not touch
+        ULONG64 currentPageOffset;
+        winrt::check_hresult(ULong64Mult(((requestedEndPosition + PAGE_SIZE - 1) / PAGE_SIZE), PAGE_SIZE, &currentPageOffset));
+
+        std::vector<ULONG64> readAheadPages;
+        for (UINT32 i = 0; i < readAheadPageCount && currentPageOffset < fileSize; i++)
+        {
+            if (m_localCache.find(currentPageOffset) == m_localCache.end() && !LoadPageFromDisk(currentPageOffset, fileSize))
+            {
+                readAheadPages.push_back(currentPageOffset);
+            }
+
+            winrt::check_hresult(ULong64Add(currentPageOffset, PAGE_SIZE, &currentPageOffset));
+        }
+
+        return readAheadPages;
+    }
+
     void HttpLocalCache::FindCachePages(
         ULONG64 requestedPosition,
         UINT32 requestedSize,
@@ -81,163 +276,240 @@ namespace AppInstaller::Utility::HttpStream
         } while (currentPageOffset < requestedEndPosition);
     }
 
-    // Breaks the provided buffer into smaller buffers and saves them to the cache at the corresponding 
-    // page offset position, starting at firstPageOffset. The smaller buffers are all PAGE_SIZE bytes,
-    // except for the one corresponding to the last page in the file
+    // Splits the provided buffer into pages of the cache, starting at firstPageOffset. The pages are all
+    // PAGE_SIZE bytes, except for the one corresponding to the last page in the file
     void HttpLocalCache::SaveBufferToCache(const IBuffer& buffer, const ULONG64 firstPageOffset)
     {
-        UINT32 remainingBufferSize = buffer.Length();
-        UINT32 currentBufferIndex = 0;
+        BufferSlice bufferData{ buffer };
+        UINT32 currentBufferOffset = 0;
         ULONG64 currentPageOffset = firstPageOffset;
 
-        while (remainingBufferSize > 0)
+        while (currentBufferOffset < bufferData.Size())
         {
-            // Extract the sub-buffer
-            UINT32 currentPageSize = std::min(remainingBufferSize, PAGE_SIZE);
-            IBuffer currentPageBuffer = CreateTrimmedBuffer(buffer, currentBufferIndex, currentPageSize);
+            UINT32 currentPageSize = std::min(bufferData.Size() - currentBufferOffset, PAGE_SIZE);
 
-            // Add it to the cache
-            CachedPage currentPage;
-            currentPage.lastAccessCounter = m_accessCounter;
-            currentPage.buffer = currentPageBuffer;
-            m_localCache[currentPageOffset] = currentPage;
+            CachedPage& currentPage = AddPageToCache(currentPageOffset, bufferData.Slice(currentBufferOffset, currentPageSize));
+            SavePageToDisk(currentPageOffset, currentPage);
 
             // update loop vars
-            winrt::check_hresult(UInt32Sub(remainingBufferSize, currentPageSize, &remainingBufferSize));
-            winrt::check_hresult(UInt32Add(currentBufferIndex, currentPageSize, &currentBufferIndex));
+            currentBufferOffset += currentPageSize;
             winrt::check_hresult(ULong64Add(currentPageOffset, PAGE_SIZE, &currentPageOffset));
         }
     }
 
-    IBuffer HttpLocalCache::ReadPageFromCache(const ULONG64 pageOffset)
+    CachedPage& HttpLocalCache::AddPageToCache(const ULONG64 pageOffset, BufferSlice data)
     {
-        if (!(m_localCache.find(pageOffset) != m_localCache.end()))
+        auto [pageIter, inserted] = m_localCache.try_emplace(pageOffset);
+        CachedPage& page = pageIter->second;
+
+        if (inserted)
         {
-            THROW_HR(E_INVALIDARG);
+            page.lruPosition = m_lruList.insert(m_lruList.begin(), pageOffset);
+        }
+        else
+        {
+            m_lruList.splice(m_lruList.begin(), m_lruList, page.lruPosition);
         }
 
-        CachedPage& page = m_localCache[pageOffset];
-        page.lastAccessCounter = m_accessCounter;
-
-        return page.buffer;
+        page.data = std::move(data);
+        return page;
     }
 
-    // Trims a buffer that was constructed (by fetching pages from cache and downloading missing pages)
-    // in order to satisfy a request and return the exact buffer the consumer asked for.
-    IBuffer HttpLocalCache::TrimBufferToSatisfyRequest(
-        const IBuffer& constructedBuffer,
-        const ULONG64 requestedPosition,
-        const UINT32 requestedSize,
-        const std::vector<ULONG64> allPages)
+    std::filesystem::path HttpLocalCache::GetDiskCacheDirectory(const std::wstring& uri, const std::wstring& etag)
     {
-        ULONG64 fullBufferStartOffset = allPages[0];
+        // A weak ETag does not promise the same bytes, so it cannot identify the cached pages
+        if (!Settings::ExperimentalFeature::IsEnabled(Settings::ExperimentalFeature::Feature::PersistentRangeCache) ||
+            Utility::IsEmptyOrWhitespace(etag) || etag.rfind(L"W/", 0) == 0)
+        {
+            return {};
+        }
+
+        try
+        {
+            // Each version of the data has its own directory, so that processes holding different versions never mix their pages
+            std::filesystem::path uriDirectory = Runtime::GetPathTo(Runtime::PathName::LocalState);
+            uriDirectory /= s_DiskCacheDirectoryName;
+            uriDirectory /= HashToDirectoryName(uri);
+
+            std::filesystem::path result = uriDirectory / HashToDirectoryName(etag);
+            std::filesystem::create_directories(result);
 
-        ULONG64 trimmedBufferStartRelativeIndex;
-        winrt::check_hresult(ULong64Sub(requestedPosition, fullBufferStartOffset, &trimmedBufferStartRelativeIndex));
+            // Remove the other versions; one that another process is still reading from is removed by a later open
+            for (const auto& entry : std::filesystem::directory_iterator(uriDirectory))
+            {
+                if (entry.path() != result)
+                {
+                    std::error_code error;
+                    std::filesystem::remove_all(entry.path(), error);
+                }
+            }
 
-        IBuffer requestedBuffer = CreateTrimmedBuffer(
-            constructedBuffer,
-            (UINT32)trimmedBufferStartRelativeIndex, // Conversion is safe as buffer size is a UINT32.
-            requestedSize);
+            return result;
+        }
+        CATCH_LOG();
 
-        return requestedBuffer;
+        return {};
     }
 
-    // Downloads a chunk of the file, saves it to the cache, and returns the corresponding buffer
-    // If the requested size is 0, this method returns an empty buffer without making HTTP calls
-    std::future<void> HttpLocalCache::DownloadAndSaveToCacheAysnc(
-        const std::vector<ULONG64> unsatisfiablePages,
-        HttpClientWrapper* httpClientWrapper,
-        InputStreamOptions httpInputStreamOptions)
+    bool HttpLocalCache::LoadPageFromDisk(const ULONG64 pageOffset, const UINT64 fileSize)
     {
-        // Determine the download job
-        // To make things easy, we will download the contiguous range that includes all the unsatisfiable ranges.
-        // Note that in theory, this may include cached pages. However, this situation is rarely expected to happen,
-        // if at all. The package reader usually reads things in chunks of 64 KB or less, so, we should expect to 
-        // always have up to two satisfiable and unsatisfiable pages in total.
-        UINT64 fileSize = httpClientWrapper->GetFullFileSize();
-        ULONG64 downloadJobStartPosition = 0U;
-        ULONG64 downloadJobEndPosition = 0U;
-        ULONG64 downloadJobSize = 0U;
-        if (unsatisfiablePages.size() > 0U)
+        if (m_diskCacheDirectory.empty() || pageOffset >= fileSize)
         {
-            downloadJobStartPosition = unsatisfiablePages[0];
-            ULONG64 lastUnsatisfiableJob = unsatisfiablePages[unsatisfiablePages.size() - 1];
-            winrt::check_hresult(ULong64Add(lastUnsatisfiableJob, PAGE_SIZE, &downloadJobEndPosition));
+            return false;
+        }
 
-            // make sure to not overflow file size
-            downloadJobEndPosition = std::min(downloadJobEndPosition, fileSize);
-            winrt::check_hresult(ULong64Sub(downloadJobEndPosition, downloadJobStartPosition, &downloadJobSize));
+        try
+        {
+            // A page of any other size was not written completely
+            UINT32 expectedSize = static_cast<UINT32>(std::min<UINT64>(PAGE_SIZE, fileSize - pageOffset));
+            std::filesystem::path pagePath = GetDiskPagePath(pageOffset);
+
+            std::error_code error;
+            if (std::filesystem::file_size(pagePath, error) != expectedSize || error)
+            {
+                return false;
+            }
+
+            BufferSlice data = BufferSlice::Allocate(expectedSize);
+            std::ifstream pageStream{ pagePath, std::ios::binary };
+            pageStream.read(reinterpret_cast<char*>(data.Data()), expectedSize);
+            if (static_cast<UINT32>(pageStream.gcount()) != expectedSize)
+            {
+                return false;
+            }
+
+            AddPageToCache(pageOffset, std::move(data));
+            return true;
         }
+        CATCH_LOG();
+
+        return false;
+    }
 
-        if (downloadJobSize != 0U)
+    void HttpLocalCache::SavePageToDisk(const ULONG64 pageOffset, const CachedPage& page)
+    {
+        if (m_diskCacheDirectory.empty())
         {
-            // start download job
-            IBuffer downloadedBuffer = co_await httpClientWrapper->DownloadRangeAsync(
-                downloadJobStartPosition,
-                (UINT32)downloadJobSize,
-                httpInputStreamOptions);
+            return;
+        }
+
+        try
+        {
+            // Write to a file of this process and rename it, so that other processes only ever see complete pages
+            std::filesystem::path pagePath = GetDiskPagePath(pageOffset);
+            std::filesystem::path tempPath = pagePath;
+            tempPath += L"." + std::to_wstring(GetCurrentProcessId()) + L".tmp";
+
+            {
+                std::ofstream pageStream{ tempPath, std::ios::binary | std::ios::trunc };
+                pageStream.write(reinterpret_cast<const char*>(page.data.Data()), page.data.Size());
+                pageStream.close();
+                THROW_HR_IF(E_FAIL, pageStream.fail());
+            }
 
-            SaveBufferToCache(downloadedBuffer, downloadJobStartPosition);
+            std::filesystem::rename(tempPath, pagePath);
         }
+        CATCH_LOG();
     }
 
-    void HttpLocalCache::VacateStaleEntriesFromCache()
+    std::filesystem::path HttpLocalCache::GetDiskPagePath(const ULONG64 pageOffset) const
+    {
+        std::filesystem::path result = m_diskCacheDirectory;
+        result /= std::to_wstring(pageOffset);
+        result += s_DiskCachePageExtension;
+        return result;
+    }
+
+    BufferSlice HttpLocalCache::GetPageFromCache(const ULONG64 pageOffset, const ULONG64 requestedPosition, const ULONG64 requestedEndPosition)
     {
-        // Copy page offsets into vector and sort by the access counter
-        std::vector<std::pair<UINT64, int>> orderedPageOffsets;
-        for (auto pageIter = m_localCache.begin(); pageIter != m_localCache.end(); pageIter++)
+        auto pageIter = m_localCache.find(pageOffset);
+        if (pageIter == m_localCache.end())
         {
-            orderedPageOffsets.push_back(std::pair<UINT64, int>(pageIter->first, pageIter->second.lastAccessCounter));
+            THROW_HR(E_INVALIDARG);
         }
 
-        // Compare function to sort by access counter
-        auto cmp = [](std::pair<UINT64, int> const & a, std::pair<UINT64, int> const & b)
+        CachedPage& page = pageIter->second;
+        m_lruList.splice(m_lruList.begin(), m_lruList, page.lruPosition);
+
+        // The part of the page inside the requested range; it is empty if the request goes past the end of the file
+        ULONG64 partStart = std::max(pageOffset, requestedPosition);
+        ULONG64 partEnd = std::min(pageOffset + page.data.Size(), requestedEndPosition);
+        if (partEnd <= partStart)
         {
-            return a.second != b.second ? a.second < b.second : a.first < b.first;
-        };
+            return {};
+        }
+
+        // Conversions are safe as both are at most a page.
+        return page.data.Slice(static_cast<UINT32>(partStart - pageOffset), static_cast<UINT32>(partEnd - partStart));
+    }
 
-        std::sort(orderedPageOffsets.begin(), orderedPageOffsets.end(), cmp);
+    // Downloads a chunk of the file, saves it to the cache, and returns the corresponding buffer
+    // If the requested size is 0, this method returns an empty buffer without making HTTP calls
+    std::future<void> HttpLocalCache::DownloadAndSaveToCacheAysnc(
+        const std::vector<ULONG64> unsatisfiablePages,
+        HttpClientWrapper* httpClientWrapper,
+        InputStreamOptions httpInputStreamOptions)
+    {
+        // Determine the download jobs
+        // Adjacent pages are coalesced into one range request, and cached pages between the runs are not downloaded again.
+        UINT64 fileSize = httpClientWrapper->GetFullFileSize();
 
-        for (auto pageIter = orderedPageOffsets.begin(); pageIter != orderedPageOffsets.end(); pageIter++)
+        for (size_t runStart = 0; runStart < unsatisfiablePages.size();)
         {
-            if (m_localCache.size() > MAX_PAGES)
+            size_t runEnd = runStart + 1;
+            while (runEnd < unsatisfiablePages.size() && unsatisfiablePages[runEnd] == unsatisfiablePages[runEnd - 1] + PAGE_SIZE)
+            {
+                runEnd++;
+            }
+
+            ULONG64 downloadJobStartPosition = unsatisfiablePages[runStart];
+            ULONG64 downloadJobEndPosition = 0U;
+            ULONG64 downloadJobSize = 0U;
+            winrt::check_hresult(ULong64Add(unsatisfiablePages[runEnd - 1], PAGE_SIZE, &downloadJobEndPosition));
+
+            // make sure to not overflow file size
+            downloadJobEndPosition = std::min(downloadJobEndPosition, fileSize);
+            if (downloadJobEndPosition > downloadJobStartPosition)
             {
-                m_localCache.erase(pageIter->first);
+                winrt::check_hresult(ULong64Sub(downloadJobEndPosition, downloadJobStartPosition, &downloadJobSize));
             }
-            else
+
+            if (downloadJobSize != 0U)
             {
-                break;
+                // start download job
+                IBuffer downloadedBuffer = co_await httpClientWrapper->DownloadRangeAsync(
+                    downloadJobStartPosition,
+                    (UINT32)downloadJobSize,
+                    httpInputStreamOptions);
+
+                std::lock_guard<std::mutex> lock{ m_lock };
+                SaveBufferToCache(downloadedBuffer, downloadJobStartPosition);
             }
+
+            runStart = runEnd;
         }
     }
 
-    IBuffer HttpLocalCache::CreateTrimmedBuffer(
-        const IBuffer& originalBuffer,
-        UINT32 trimStartIndex,
-        UINT32 size)
+    void HttpLocalCache::VacateStaleEntriesFromCache()
     {
-        originalBuffer.as<::IInspectable>();
-
-        // Get the byte array from the IBuffer object
-        Microsoft::WRL::ComPtr<IBufferByteAccess> bufferByteAccess;
-        ::IInspectable* bufferAbi = (::IInspectable*)winrt::get_abi(originalBuffer);
-        bufferAbi->QueryInterface(IID_PPV_ARGS(&bufferByteAccess));
-        byte* byteBuffer = nullptr;
-        bufferByteAccess->Buffer(&byteBuffer);
-
-        // Create the array of bytes holding the trimmed bytes
-        IBuffer trimmedBuffer = CryptographicBuffer::CreateFromByteArray(
-            { byteBuffer + trimStartIndex, byteBuffer + trimStartIndex + size });
-
-        return trimmedBuffer;
+        // Evict the least recently used pages; the data of a download is freed with the last of its pages
+        while (m_localCache.size() > MAX_PAGES)
+        {
+            m_localCache.erase(m_lruList.back());
+            m_lruList.pop_back();
+        }
     }
 
-    IBuffer HttpLocalCache::ConcatenateBuffers(const IBuffer& buffer1, const IBuffer& buffer2)
+    void HttpLocalCache::TrimCache(size_t bytesToFree)
     {
-        DataWriter writer;
-        writer.WriteBuffer(buffer1);
-        writer.WriteBuffer(buffer2);
-        return writer.DetachBuffer();
+        std::lock_guard<std::mutex> lock{ m_lock };
+
+        size_t freed = 0;
+        while (!m_lruList.empty() && freed < bytesToFree)
+        {
+            m_localCache.erase(m_lruList.back());
+            m_lruList.pop_back();
+            freed += PAGE_SIZE;
+        }
     }
-}
\ No newline at end of file
+}
@@ -3,35 +3,83 @@
 
 #pragma once
 #include "pch.h"
+#include "BufferSlice.h"
 #include "HttpClientWrapper.h"
+#include "Public/winget/MemoryBudget.h"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 namespace AppInstaller::Utility::HttpStream
 {
     // Represents an entry in the cache.
     struct CachedPage
     {
-        int lastAccessCounter;
-        winrt::Windows::Storage::Streams::IBuffer buffer;
+        // The data of the page, a view of the range it was downloaded in; only the last page of the file is smaller than a full page.
+        BufferSlice data;
+        // The position of the page in the LRU list, so that it can be moved or removed in constant time.
+        std::list<ULONG64>::iterator lruPosition;
+    };
+
+    // The reads of one stream over the cache, used to detect sequential access for the read-ahead.
+    struct ReadSequence
+    {
+        ULONG64 NextPosition = 0U;
+        UINT32 ReadAheadPages = 0U;
     };
 
     // A cache used internally by the custom HttpRandomAccessStream to reduce round-trips
+    // It is thread-safe, so that clones of a stream can share it and read from it concurrently.
     class HttpLocalCache
     {
     public:
         const UINT32 PAGE_SIZE = 2 << 16;   // each entry in the cache is 64 KB
-        const UINT32 MAX_PAGES = 200;       // cache size capped at 12.5 MB (200 * 64KB)
+        const UINT32 MAX_PAGES = 200;       // cache size capped at 12.5 MB (200 * 64KB), not counting the rest of the ranges that cached pages were downloaded in
+        const UINT32 MAX_READ_AHEAD_PAGES = 16; // read-ahead grows up to 1 MB (16 * 64KB) while reads are sequential
+
+        // The pages are also kept in the disk cache directory, if one is given, and loaded from it before they are downloaded.
+        // The cache is registered with the memory budget of the process, which evicts the least recently used pages when it trims.
+        HttpLocalCache(std::filesystem::path diskCacheDirectory = {});
+
+        // Waits for any read-ahead, as it saves to this cache when it completes.
+        ~HttpLocalCache();
+
+        // Gets the disk cache directory for the data with the given URI and ETag, emptying it if it holds another version of the data.
+        // Returns an empty path if the disk cache is not enabled, or the ETag cannot identify the data.
+        static std::filesystem::path GetDiskCacheDirectory(const std::wstring& uri, const std::wstring& etag);
+
+        // Adds the pages of data that was already downloaded to the cache. The data must run to the end of the file,
+        // so that only whole pages and the last page of the file are added; the part before the first whole page is dropped.
+        void SeedCache(const winrt::Windows::Storage::Streams::IBuffer& buffer, const ULONG64 position);
 
         // Returns a buffer matching the requested range by reading the parts of the range that are cached
-        // and downloading the rest using the provided httpClientWrapper object
+        // and downloading the rest using the provided httpClientWrapper object.
+        // A range that lies in the data of one download is returned as a view of it, without a copy.
+        // The sequence is that of the stream reading, and must outlive the read. The read is added to the AccessTrace being recorded, if any.
         std::future<winrt::Windows::Storage::Streams::IBuffer> ReadFromCacheAndDownloadIfNecessaryAsync(
             const ULONG64 requestedPosition,
             const UINT32 requestedSize,
             HttpClientWrapper* httpClientWrapper,
-            winrt::Windows::Storage::Streams::InputStreamOptions httpInputStreamOptions);
+            winrt::Windows::Storage::Streams::InputStreamOptions httpInputStreamOptions,
+            ReadSequence& sequence);
 
     private:
-        std::map<ULONG64, CachedPage> m_localCache;
-        UINT32 m_accessCounter = 0U;
+        std::unordered_map<ULONG64, CachedPage> m_localCache;
+
+        // The page offsets ordered from the most to the least recently used.
+        std::list<ULONG64> m_lruList;
+
+        // Guards all of the state of the cache; it is never held across a download.
+        std::mutex m_lock;
+
+        // The read-aheads in progress. They are awaited by the next read, so that it does not download their pages again.
+        std::vector<std::future<void>> m_readAheads;
+
+        std::filesystem::path m_diskCacheDirectory;
+
+        // Declared last so that it is removed before the rest of the cache is destroyed.
+        Memory::MemoryBudget::Registration m_memoryRegistration;
 
         // Returns a vector of all pages corresponding to a range, and another (subset)
         // vector of the pages missing from the cache.
@@ -41,30 +89,42 @@ namespace AppInstaller::Utility::HttpStream
             std::vector<ULONG64>& allPages,
             std::vector<ULONG64>& unsatisfiablePages);
 
+        // Splits the buffer into pages of the cache, starting at firstPageOffset; the pages share the data of the buffer.
         void SaveBufferToCache(const winrt::Windows::Storage::Streams::IBuffer& buffer, const ULONG64 firstPageOffset);
 
-        winrt::Windows::Storage::Streams::IBuffer ReadPageFromCache(const ULONG64 pageOffset);
+        // Adds a page to the cache as the most recently used one, replacing its data if it is already cached.
+        CachedPage& AddPageToCache(const ULONG64 pageOffset, BufferSlice data);
+
+        // Loads a page from the disk cache; returns false if it is not there. The file size determines the expected size of the page.
+        bool LoadPageFromDisk(const ULONG64 pageOffset, const UINT64 fileSize);
+
+        void SavePageToDisk(const ULONG64 pageOffset, const CachedPage& page);
+
+        std::filesystem::path GetDiskPagePath(const ULONG64 pageOffset) const;
+
+        // Gets the part of the requested range held by the page, and marks the page as recently used.
+        // The part is empty if the request goes past the end of the file.
+        BufferSlice GetPageFromCache(const ULONG64 pageOffset, const ULONG64 requestedPosition, const ULONG64 requestedEndPosition);
 
         void VacateStaleEntriesFromCache();
 
+        // Evicts the least recently used pages until at least the given number of bytes are evicted, or the cache is empty.
+        void TrimCache(size_t bytesToFree);
+
+        // Waits for the read-aheads in progress; a failure is only logged, as the pages will be downloaded again when read.
+        std::future<void> CompleteReadAheadAsync();
+
+        // Gets the pages that follow the given range and are not cached, for the read-ahead to download.
+        std::vector<ULONG64> GetReadAheadPages(
+            const ULONG64 requestedEndPosition,
+            const UINT32 readAheadPageCount,
+            const UINT64 fileSize);
+
+        // Downloads the given pages, which must be sorted, with a single range request for each run of adjacent pages.
+        // Must be called without holding the lock.
         std::future<void> DownloadAndSaveToCacheAysnc(
             const std::vector<ULONG64> unsatisfiablePages,
             HttpClientWrapper* httpClientWrapper,
             const winrt::Windows::Storage::Streams::InputStreamOptions httpInputStreamOptions);
-
-        winrt::Windows::Storage::Streams::IBuffer TrimBufferToSatisfyRequest(
-            const winrt::Windows::Storage::Streams::IBuffer& constructedBuffer,
-            const ULONG64 requestedPosition,
-            const UINT32 requestedSize,
-            const std::vector<ULONG64> allPages);
-
-        winrt::Windows::Storage::Streams::IBuffer CreateTrimmedBuffer(
-            const winrt::Windows::Storage::Streams::IBuffer& originalBuffer,
-            UINT32 trimStartIndex,
-            UINT32 size);
-
-        winrt::Windows::Storage::Streams::IBuffer ConcatenateBuffers(
-            const winrt::Windows::Storage::Streams::IBuffer& buffer1,
-            const winrt::Windows::Storage::Streams::IBuffer& buffer2);
     };
-}
\ No newline at end of file
+}
@@ -18,7 +18,14 @@ namespace AppInstaller::Utility::HttpStream
 
         stream->m_httpHelper = co_await HttpClientWrapper::CreateAsync(uri);
         stream->m_size = stream->m_httpHelper->GetFullFileSize();
-        stream->m_httpLocalCache = std::make_unique<HttpLocalCache>();
+        stream->m_httpLocalCache = std::make_shared<HttpLocalCache>(HttpLocalCache::GetDiskCacheDirectory(std::wstring{ uri.AbsoluteUri() }, stream->m_httpHelper->GetETag()));
+
+        // The end of the data was downloaded with the size, and is the first part the package reader needs
+        IBuffer tail = stream->m_httpHelper->TakeTailBuffer();
+        if (tail)
+        {
+            stream->m_httpLocalCache->SeedCache(tail, stream->m_httpHelper->GetTailPosition());
+        }
 
         co_return stream.as<IRandomAccessStream>();
 
@@ -64,7 +71,14 @@ namespace AppInstaller::Utility::HttpStream
 
     IRandomAccessStream HttpRandomAccessStream::CloneStream() const
     {
-        THROW_HR(E_NOTIMPL);
+        // The clone starts at the beginning of the data, with its own sequential access detection
+        winrt::com_ptr<HttpRandomAccessStream> stream = winrt::make_self<HttpRandomAccessStream>();
+
+        stream->m_httpHelper = m_httpHelper;
+        stream->m_httpLocalCache = m_httpLocalCache;
+        stream->m_size = m_size;
+
+        return stream.as<IRandomAccessStream>();
     }
 
     void HttpRandomAccessStream::Seek(uint64_t position)
@@ -77,11 +91,15 @@ namespace AppInstaller::Utility::HttpStream
         uint32_t count,
         InputStreamOptions options)
     {
+        // Keeps the stream alive for the read, as a clone may be released while it is reading
+        auto strongThis = get_strong();
+
         IBuffer result = co_await m_httpLocalCache->ReadFromCacheAndDownloadIfNecessaryAsync(
             m_requestedPosition,
             count,
             m_httpHelper.get(),
-            options);
+            options,
+            m_readSequence);
         winrt::check_hresult(ULong64Add(m_requestedPosition, result.Length(), &m_requestedPosition));
 
         co_return result;
@@ -12,6 +12,8 @@ namespace AppInstaller::Utility::HttpStream
     // range-based fetching. This is intended to be used by AppxPackageReader.
     //
     // Note: If the server doesn't support HTTP ranges, this implementation will throw an exception.
+    //
+    // Clones are separate positions over the same data; they share the HTTP client and the cache, and can read concurrently.
     class HttpRandomAccessStream : public winrt::implements<
         HttpRandomAccessStream,
         winrt::Windows::Storage::Streams::IRandomAccessStream,
@@ -36,8 +38,9 @@ namespace AppInstaller::Utility::HttpStream
 
     private:
         std::shared_ptr<HttpClientWrapper> m_httpHelper;
-        std::unique_ptr<HttpLocalCache> m_httpLocalCache;
-        unsigned long long m_size;
-        unsigned long long m_requestedPosition;
+        std::shared_ptr<HttpLocalCache> m_httpLocalCache;
+        ReadSequence m_readSequence;
+        unsigned long long m_size = 0;
+        unsigned long long m_requestedPosition = 0;
     };
 }
\ No newline at end of file
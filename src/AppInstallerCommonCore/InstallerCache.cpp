@@ -0,0 +1,210 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Public/winget/InstallerCache.h"
+#include "Public/winget/ExperimentalFeature.h"
+#include "Public/winget/UserSettings.h"
+#include "Public/AppInstallerDownloader.h"
+#include "Public/AppInstallerLogging.h"
+#include "Public/AppInstallerRuntime.h"
+#include "Public/AppInstallerSHA256.h"
+#include "Public/AppInstallerStrings.h"
+
+namespace AppInstaller::Utility
+{
+    namespace
+    {
+        constexpr std::wstring_view s_InstallerCacheDirectoryName = L"InstallerCache";
+
+        struct CacheEntry
+        {
+            std::filesystem::path path;
+            uint64_t size;
+            std::filesystem::file_time_type lastUsed;
+        };
+
+        // Marks the entry as used now, so that the age and size policies
+        // keep the installers that are used the most.
+        void MarkEntryUsed(const std::filesystem::path& entryPath)
+        {
+            std::error_code error;
+            std::filesystem::last_write_time(entryPath, std::filesystem::file_time_type::clock::now(), error);
+        }
+    }
+
+    InstallerCache::InstallerCache(std::filesystem::path directory, uint64_t maxSizeInBytes, std::chrono::hours maxAge) :
+        m_directory(std::move(directory)), m_maxSizeInBytes(maxSizeInBytes), m_maxAge(maxAge) {}
+
+    std::optional<InstallerCache> InstallerCache::GetDefault()
+    {
+        if (!Settings::ExperimentalFeature::IsEnabled(Settings::ExperimentalFeature::Feature::InstallerCache))
+        {
+            return {};
+        }
+
+        std::filesystem::path directory = Runtime::GetPathTo(Runtime::PathName::LocalState);
+        directory /= s_InstallerCacheDirectoryName;
+
+        uint64_t maxSizeInBytes = static_cast<uint64_t>(Settings::User().Get<Settings::Setting::InstallerCacheMaxSizeInMB>()) * 1024 * 1024;
+        return InstallerCache{ std::move(directory), maxSizeInBytes, Settings::User().Get<Settings::Setting::InstallerCacheMaxAgeInDays>() };
+    }
+
+    bool InstallerCache::TryGet(const std::vector<uint8_t>& sha256, const std::filesystem::path& destination) const
+    {
+        if (sha256.empty())
+        {
+            return false;
+        }
+
+        std::filesystem::path entryPath = GetEntryPath(sha256);
+
+        try
+        {
+            if (!std::filesystem::is_regular_file(entryPath))
+            {
+                return false;
+            }
+
+            std::filesystem::remove(destination);
+
+            // A hard link avoids copying the installer; it is only possible when the destination is on the same volume
+            std::error_code linkError;
+            std::filesystem::create_hard_link(entryPath, destination, linkError);
+            if (linkError)
+            {
+                std::filesystem::copy_file(entryPath, destination, std::filesystem::copy_options::overwrite_existing);
+            }
+
+            // The installer is verified where it will be run from, so that it cannot change between the check and its use
+            if (SHA256::ComputeHashFromFile(destination) != sha256)
+            {
+                AICLI_LOG(Core, Warning, << "Cached installer does not match its hash, removing it: " << entryPath);
+                std::filesystem::remove(destination);
+
+                std::error_code error;
+                std::filesystem::remove(entryPath, error);
+                return false;
+            }
+
+            ApplyMotwIfApplicable(destination);
+            MarkEntryUsed(entryPath);
+
+            AICLI_LOG(Core, Info, << "Installer found in the cache: " << entryPath);
+            return true;
+        }
+        CATCH_LOG();
+
+        std::error_code error;
+        std::filesystem::remove(destination, error);
+        return false;
+    }
+
+    void InstallerCache::Add(const std::vector<uint8_t>& sha256, const std::filesystem::path& file) const
+    {
+        if (sha256.empty())
+        {
+            return;
+        }
+
+        std::filesystem::path entryPath = GetEntryPath(sha256);
+
+        try
+        {
+            if (std::filesystem::exists(entryPath))
+            {
+                MarkEntryUsed(entryPath);
+                return;
+            }
+
+            std::filesystem::create_directories(m_directory);
+
+            // The copy is only renamed to its final name once it is complete, so that no process ever sees a partial installer
+            std::filesystem::path tempPath = entryPath;
+            tempPath += L"." + std::to_wstring(GetCurrentProcessId()) + L".tmp";
+            std::filesystem::copy_file(file, tempPath, std::filesystem::copy_options::overwrite_existing);
+
+            if (MoveFileExW(tempPath.c_str(), entryPath.c_str(), MOVEFILE_WRITE_THROUGH))
+            {
+                MarkEntryUsed(entryPath);
+                AICLI_LOG(Core, Info, << "Installer added to the cache: " << entryPath);
+            }
+            else
+            {
+                DWORD moveError = GetLastError();
+
+                std::error_code error;
+                std::filesystem::remove(tempPath, error);
+
+                // Another process published the same installer first
+                if (moveError != ERROR_ALREADY_EXISTS)
+                {
+                    THROW_WIN32(moveError);
+                }
+            }
+
+            Prune();
+        }
+        CATCH_LOG();
+    }
+
+    void InstallerCache::Prune() const
+    {
+        std::error_code error;
+        if (!std::filesystem::is_directory(m_directory, error))
+        {
+            return;
+        }
+
+        auto now = std::filesystem::file_time_type::clock::now();
+        std::vector<CacheEntry> entries;
+        uint64_t totalSize = 0;
+
+        for (const auto& item : std::filesystem::directory_iterator(m_directory, error))
+        {
+            if (!item.is_regular_file(error))
+            {
+                continue;
+            }
+
+            CacheEntry entry{ item.path(), item.file_size(error), item.last_write_time(error) };
+            if (error)
+            {
+                continue;
+            }
+
+            // An installer that is in use cannot be removed; it is removed by a later prune
+            if (now - entry.lastUsed > m_maxAge)
+            {
+                if (std::filesystem::remove(entry.path, error))
+                {
+                    AICLI_LOG(Core, Verbose, << "Removed installer past the maximum age from the cache: " << entry.path);
+                    continue;
+                }
+            }
+
+            totalSize += entry.size;
+            entries.emplace_back(std::move(entry));
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const CacheEntry& a, const CacheEntry& b) { return a.lastUsed < b.lastUsed; });
+
+        for (const auto& entry : entries)
+        {
+            if (totalSize <= m_maxSizeInBytes)
+            {
+                break;
+            }
+
+            if (std::filesystem::remove(entry.path, error))
+            {
+                AICLI_LOG(Core, Verbose, << "Removed least recently used installer from the cache: " << entry.path);
+                totalSize -= entry.size;
+            }
+        }
+    }
+
+    std::filesystem::path InstallerCache::GetEntryPath(const std::vector<uint8_t>& sha256) const
+    {
+        return m_directory / ConvertToUTF16(SHA256::ConvertToString(sha256));
+    }
+}
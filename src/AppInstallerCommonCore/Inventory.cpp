@@ -0,0 +1,230 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Public/AppInstallerInventory.h"
+#include "Public/AppInstallerDeployment.h"
+#include "Public/AppInstallerLogging.h"
+#include "Public/AppInstallerStrings.h"
+
+namespace AppInstaller::Inventory
+{
+    using namespace std::string_view_literals;
+    using namespace winrt::Windows::Management::Deployment;
+
+    namespace
+    {
+        constexpr std::wstring_view s_ArpKeyPath = L"SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Uninstall"sv;
+
+        // The package repository of the user has a subkey for each package registered for them.
+        constexpr std::wstring_view s_MsixRepositoryKeyPath = L"Software\\Classes\\Local Settings\\Software\\Microsoft\\Windows\\CurrentVersion\\AppModel\\Repository\\Packages"sv;
+
+        // Subkey names are at most 255 characters.
+        constexpr DWORD s_MaxKeyNameLength = 256;
+
+        int64_t ToInt64(const FILETIME& time)
+        {
+            ULARGE_INTEGER value{};
+            value.LowPart = time.dwLowDateTime;
+            value.HighPart = time.dwHighDateTime;
+            return static_cast<int64_t>(value.QuadPart);
+        }
+
+        // Opens the key for reading; returns null if it does not exist.
+        wil::unique_hkey OpenKey(HKEY root, std::wstring_view path, REGSAM view = 0)
+        {
+            wil::unique_hkey result;
+            LSTATUS status = RegOpenKeyExW(root, std::wstring{ path }.c_str(), 0, KEY_READ | view, &result);
+            if (status == ERROR_FILE_NOT_FOUND || status == ERROR_PATH_NOT_FOUND)
+            {
+                return {};
+            }
+
+            THROW_IF_WIN32_ERROR(status);
+            return result;
+        }
+
+        wil::unique_hkey OpenArpKey(EntryLocation location)
+        {
+            switch (location)
+            {
+            case EntryLocation::ArpMachineNative:
+                return OpenKey(HKEY_LOCAL_MACHINE, s_ArpKeyPath, KEY_WOW64_64KEY);
+            case EntryLocation::ArpMachineX86:
+                return OpenKey(HKEY_LOCAL_MACHINE, s_ArpKeyPath, KEY_WOW64_32KEY);
+            case EntryLocation::ArpUser:
+                return OpenKey(HKEY_CURRENT_USER, s_ArpKeyPath);
+            default:
+                THROW_HR(E_INVALIDARG);
+            }
+        }
+
+        // Reads a string value; returns an empty value if it does not exist or is not a string.
+        std::optional<std::string> GetStringValue(HKEY key, const wchar_t* name)
+        {
+            DWORD size = 0;
+            LSTATUS status = RegGetValueW(key, nullptr, name, RRF_RT_REG_SZ | RRF_RT_REG_EXPAND_SZ | RRF_NOEXPAND, nullptr, nullptr, &size);
+            if (status != ERROR_SUCCESS)
+            {
+                return {};
+            }
+
+            // The value may be written between the two reads, so this tries again until the buffer is large enough for it
+            std::wstring value;
+            do
+            {
+                value.resize(size / sizeof(wchar_t) + 1);
+                size = static_cast<DWORD>(value.size() * sizeof(wchar_t));
+                status = RegGetValueW(key, nullptr, name, RRF_RT_REG_SZ | RRF_RT_REG_EXPAND_SZ | RRF_NOEXPAND, nullptr, value.data(), &size);
+            } while (status == ERROR_MORE_DATA);
+
+            if (status != ERROR_SUCCESS)
+            {
+                return {};
+            }
+
+            value.resize(wcsnlen(value.c_str(), value.size()));
+            return Utility::ConvertToUTF8(value);
+        }
+
+        std::optional<DWORD> GetDWordValue(HKEY key, const wchar_t* name)
+        {
+            DWORD value = 0;
+            DWORD size = sizeof(value);
+            if (RegGetValueW(key, nullptr, name, RRF_RT_REG_DWORD, nullptr, &value, &size) != ERROR_SUCCESS)
+            {
+                return {};
+            }
+
+            return value;
+        }
+
+        bool IsSystem32Bit()
+        {
+            SYSTEM_INFO info{};
+            GetNativeSystemInfo(&info);
+            return info.wProcessorArchitecture == PROCESSOR_ARCHITECTURE_INTEL;
+        }
+    }
+
+    std::string_view ToString(EntryLocation location)
+    {
+        switch (location)
+        {
+        case EntryLocation::ArpMachineNative: return "ArpMachineNative"sv;
+        case EntryLocation::ArpMachineX86: return "ArpMachineX86"sv;
+        case EntryLocation::ArpUser: return "ArpUser"sv;
+        case EntryLocation::Msix: return "Msix"sv;
+        }
+
+        return "Unknown"sv;
+    }
+
+    std::vector<EntryLocation> GetArpLocations()
+    {
+        // On a 32-bit system both views are the same key, which would give every entry twice
+        if (IsSystem32Bit())
+        {
+            return { EntryLocation::ArpMachineNative, EntryLocation::ArpUser };
+        }
+
+        return { EntryLocation::ArpMachineNative, EntryLocation::ArpMachineX86, EntryLocation::ArpUser };
+    }
+
+    std::vector<ArpKeyStamp> GetArpKeyStamps(EntryLocation location)
+    {
+        std::vector<ArpKeyStamp> result;
+
+        wil::unique_hkey key = OpenArpKey(location);
+        if (!key)
+        {
+            return result;
+        }
+
+        for (DWORD index = 0;; ++index)
+        {
+            wchar_t name[s_MaxKeyNameLength];
+            DWORD nameLength = ARRAYSIZE(name);
+            FILETIME lastWriteTime{};
+
+            LSTATUS status = RegEnumKeyExW(key.get(), index, name, &nameLength, nullptr, nullptr, nullptr, &lastWriteTime);
+            if (status == ERROR_NO_MORE_ITEMS)
+            {
+                break;
+            }
+
+            THROW_IF_WIN32_ERROR(status);
+            result.push_back({ Utility::ConvertToUTF8(std::wstring_view{ name, nameLength }), ToInt64(lastWriteTime) });
+        }
+
+        return result;
+    }
+
+    std::optional<InstalledEntry> ReadArpEntry(EntryLocation location, std::string_view key)
+    {
+        wil::unique_hkey arpKey = OpenArpKey(location);
+        if (!arpKey)
+        {
+            return {};
+        }
+
+        wil::unique_hkey entryKey = OpenKey(arpKey.get(), Utility::ConvertToUTF16(key));
+        if (!entryKey)
+        {
+            return {};
+        }
+
+        // Add/Remove Programs hides entries without a name, system components, and updates that are shown under their parent
+        std::optional<std::string> name = GetStringValue(entryKey.get(), L"DisplayName");
+        if (!name || name->empty() ||
+            GetDWordValue(entryKey.get(), L"SystemComponent").value_or(0) != 0 ||
+            GetStringValue(entryKey.get(), L"ParentKeyName"))
+        {
+            return {};
+        }
+
+        InstalledEntry result;
+        result.Location = location;
+        result.Key = key;
+        result.Name = std::move(name).value();
+        result.Version = GetStringValue(entryKey.get(), L"DisplayVersion").value_or(std::string{});
+        result.Publisher = GetStringValue(entryKey.get(), L"Publisher").value_or(std::string{});
+        return result;
+    }
+
+    int64_t GetMsixStamp()
+    {
+        wil::unique_hkey key = OpenKey(HKEY_CURRENT_USER, s_MsixRepositoryKeyPath);
+        if (!key)
+        {
+            return 0;
+        }
+
+        FILETIME lastWriteTime{};
+        THROW_IF_WIN32_ERROR(RegQueryInfoKeyW(key.get(), nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &lastWriteTime));
+        return ToInt64(lastWriteTime);
+    }
+
+    std::vector<InstalledEntry> ReadMsixEntries()
+    {
+        std::vector<InstalledEntry> result;
+
+        for (const auto& package : Deployment::GetPackageManager().FindPackagesForUserWithPackageTypes({}, PackageTypes::Main))
+        {
+            // Only the identity is read, as the display properties are read from the manifest of each package
+            auto id = package.Id();
+            auto version = id.Version();
+
+            InstalledEntry entry;
+            entry.Location = EntryLocation::Msix;
+            entry.Key = Utility::ConvertToUTF8(id.FullName());
+            entry.Name = Utility::ConvertToUTF8(id.Name());
+            entry.Version = std::to_string(version.Major) + '.' + std::to_string(version.Minor) + '.' + std::to_string(version.Build) + '.' + std::to_string(version.Revision);
+            entry.Publisher = Utility::ConvertToUTF8(id.Publisher());
+            entry.FamilyName = Utility::ConvertToUTF8(id.FamilyName());
+            result.emplace_back(std::move(entry));
+        }
+
+        AICLI_LOG(Core, Info, << "Read " << result.size() << " MSIX packages");
+        return result;
+    }
+}
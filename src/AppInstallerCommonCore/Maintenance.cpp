@@ -0,0 +1,188 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Public/winget/Maintenance.h"
+#include "Public/AppInstallerLogging.h"
+#include "Public/AppInstallerRuntime.h"
+#include "Public/AppInstallerStrings.h"
+
+#include <wil/com.h>
+#include <taskschd.h>
+#include <winrt/Windows.Networking.Connectivity.h>
+
+namespace AppInstaller::Maintenance
+{
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        // The task is named for the user, as the tasks of every user share the root folder.
+        constexpr std::wstring_view s_SourceUpdateTaskName = L"WinGet Source Update-";
+
+        // A packaged winget is run through its app execution alias, which the task scheduler expands when it starts the task.
+        constexpr std::wstring_view s_PackagedExecutable = L"%LOCALAPPDATA%\\Microsoft\\WindowsApps\\winget.exe";
+
+        // The task scheduler only repeats a task at intervals within these bounds.
+        constexpr std::chrono::minutes s_MinimumInterval = 1min;
+        constexpr std::chrono::minutes s_MaximumInterval = std::chrono::hours(24 * 31);
+
+        std::wstring EscapeXml(std::wstring_view value)
+        {
+            std::wstring result;
+            for (wchar_t c : value)
+            {
+                switch (c)
+                {
+                case L'&': result += L"&amp;"; break;
+                case L'<': result += L"&lt;"; break;
+                case L'>': result += L"&gt;"; break;
+                case L'"': result += L"&quot;"; break;
+                default: result += c; break;
+                }
+            }
+            return result;
+        }
+
+        std::wstring GetSourceUpdateTaskName()
+        {
+            auto user = wil::get_token_information<TOKEN_USER>();
+
+            wil::unique_hlocal_string sid;
+            THROW_IF_WIN32_BOOL_FALSE(ConvertSidToStringSidW(user->User.Sid, &sid));
+
+            return std::wstring{ s_SourceUpdateTaskName } + sid.get();
+        }
+
+        std::filesystem::path GetSourceUpdateTaskExecutable()
+        {
+            if (Runtime::IsRunningInPackagedContext())
+            {
+                return std::filesystem::path{ s_PackagedExecutable };
+            }
+
+            std::wstring path(MAX_PATH, L'\0');
+            for (;;)
+            {
+                DWORD length = GetModuleFileNameW(nullptr, path.data(), static_cast<DWORD>(path.size()));
+                THROW_LAST_ERROR_IF(length == 0);
+
+                if (length < path.size())
+                {
+                    path.resize(length);
+                    return path;
+                }
+
+                path.resize(path.size() * 2);
+            }
+        }
+
+        wil::com_ptr<ITaskFolder> GetRootTaskFolder()
+        {
+            auto service = wil::CoCreateInstance<TaskScheduler, ITaskService>(CLSCTX_INPROC_SERVER);
+
+            // Empty values connect to the local machine as the current user
+            VARIANT empty{};
+            THROW_IF_FAILED(service->Connect(empty, empty, empty, empty));
+
+            wil::com_ptr<ITaskFolder> folder;
+            THROW_IF_FAILED(service->GetFolder(wil::make_bstr(L"\\").get(), &folder));
+            return folder;
+        }
+    }
+
+    std::wstring GetSourceUpdateTaskDefinition(const std::filesystem::path& executable, std::chrono::minutes interval)
+    {
+        interval = std::clamp(interval, s_MinimumInterval, s_MaximumInterval);
+
+        std::wostringstream definition;
+        definition <<
+            LR"(<?xml version="1.0" encoding="UTF-16"?>)"
+            LR"(<Task version="1.2" xmlns="http://schemas.microsoft.com/windows/2004/02/mit/task">)"
+            LR"(<RegistrationInfo><Description>Updates the WinGet sources while the system is idle.</Description></RegistrationInfo>)"
+            LR"(<Triggers><TimeTrigger>)"
+            LR"(<StartBoundary>2020-01-01T00:00:00</StartBoundary>)"
+            LR"(<Repetition><Interval>PT)" << interval.count() << LR"(M</Interval></Repetition>)"
+            LR"(</TimeTrigger></Triggers>)"
+            LR"(<Principals><Principal id="Author"><LogonType>InteractiveToken</LogonType><RunLevel>LeastPrivilege</RunLevel></Principal></Principals>)"
+            LR"(<Settings>)"
+            LR"(<MultipleInstancesPolicy>IgnoreNew</MultipleInstancesPolicy>)"
+            LR"(<DisallowStartIfOnBatteries>true</DisallowStartIfOnBatteries>)"
+            LR"(<StopIfGoingOnBatteries>true</StopIfGoingOnBatteries>)"
+            LR"(<StartWhenAvailable>true</StartWhenAvailable>)"
+            LR"(<RunOnlyIfNetworkAvailable>true</RunOnlyIfNetworkAvailable>)"
+            LR"(<IdleSettings><Duration>PT5M</Duration><WaitTimeout>PT1H</WaitTimeout><StopOnIdleEnd>false</StopOnIdleEnd><RestartOnIdle>false</RestartOnIdle></IdleSettings>)"
+            LR"(<RunOnlyIfIdle>true</RunOnlyIfIdle>)"
+            LR"(<Hidden>true</Hidden>)"
+            LR"(<ExecutionTimeLimit>PT1H</ExecutionTimeLimit>)"
+            LR"(<Priority>7</Priority>)"
+            LR"(</Settings>)"
+            LR"(<Actions Context="Author"><Exec>)"
+            LR"(<Command>)" << EscapeXml(executable.wstring()) << LR"(</Command>)"
+            LR"(<Arguments>)" << EscapeXml(ScheduledSourceUpdateArguments) << LR"(</Arguments>)"
+            LR"(</Exec></Actions>)"
+            LR"(</Task>)";
+
+        return definition.str();
+    }
+
+    void RegisterSourceUpdateTask(std::chrono::minutes interval)
+    {
+        std::wstring name = GetSourceUpdateTaskName();
+        std::wstring definition = GetSourceUpdateTaskDefinition(GetSourceUpdateTaskExecutable(), interval);
+
+        AICLI_LOG(Core, Info, << "Registering the scheduled source update task to run every " << interval.count() << " minutes");
+
+        VARIANT empty{};
+        wil::com_ptr<IRegisteredTask> task;
+        THROW_IF_FAILED(GetRootTaskFolder()->RegisterTask(wil::make_bstr(name.c_str()).get(), wil::make_bstr(definition.c_str()).get(),
+            TASK_CREATE_OR_UPDATE, empty, empty, TASK_LOGON_INTERACTIVE_TOKEN, empty, &task));
+    }
+
+    bool UnregisterSourceUpdateTask()
+    {
+        HRESULT hr = GetRootTaskFolder()->DeleteTask(wil::make_bstr(GetSourceUpdateTaskName().c_str()).get(), 0);
+        if (hr == HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND))
+        {
+            return false;
+        }
+
+        THROW_IF_FAILED(hr);
+        AICLI_LOG(Core, Info, << "Removed the scheduled source update task");
+        return true;
+    }
+
+    void EnterBackgroundMode()
+    {
+        // Background mode lowers the I/O and memory priority along with the CPU priority
+        if (!SetPriorityClass(GetCurrentProcess(), PROCESS_MODE_BACKGROUND_BEGIN))
+        {
+            LOG_LAST_ERROR_IF(GetLastError() != ERROR_PROCESS_MODE_ALREADY_BACKGROUND);
+        }
+    }
+
+    bool ShouldDeferNetworkUse()
+    {
+        using namespace winrt::Windows::Networking::Connectivity;
+
+        try
+        {
+            ConnectionProfile profile = NetworkInformation::GetInternetConnectionProfile();
+            if (!profile)
+            {
+                AICLI_LOG(Core, Info, << "There is no internet connection");
+                return true;
+            }
+
+            ConnectionCost cost = profile.GetConnectionCost();
+            NetworkCostType type = cost.NetworkCostType();
+            if (type == NetworkCostType::Fixed || type == NetworkCostType::Variable || cost.Roaming() || cost.OverDataLimit() || cost.ApproachingDataLimit())
+            {
+                AICLI_LOG(Core, Info, << "The internet connection is metered");
+                return true;
+            }
+        }
+        CATCH_LOG();
+
+        return false;
+    }
+}
@@ -0,0 +1,322 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "winget/ManifestDirectoryValidation.h"
+#include "winget/ManifestYamlParser.h"
+#include "AppInstallerLogging.h"
+#include "AppInstallerRuntime.h"
+#include "AppInstallerStrings.h"
+
+#include <json.h>
+#include <thread>
+
+namespace AppInstaller::Manifest
+{
+    namespace
+    {
+        // Must be changed whenever the format of the cache file changes.
+        constexpr std::string_view s_ValidationCacheFormatVersion = "1";
+
+        ManifestValidationResult ValidateManifestFile(const std::filesystem::path& path, std::filesystem::path relativePath, ManifestValidationCache* cache)
+        {
+            ManifestValidationResult result;
+            result.RelativePath = std::move(relativePath);
+
+            std::optional<Utility::SHA256::HashBuffer> contentHash;
+
+            try
+            {
+                if (cache)
+                {
+                    contentHash = Utility::SHA256::ComputeHashFromFile(path);
+
+                    auto cached = cache->Get(contentHash.value());
+                    if (cached)
+                    {
+                        cached->RelativePath = std::move(result.RelativePath);
+                        return std::move(cached).value();
+                    }
+                }
+
+                (void)YamlParser::CreateFromPath(path, true, true);
+            }
+            catch (const ManifestException& e)
+            {
+                result.Result = e.IsWarningOnly() ? APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_WARNING : APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_FAILURE;
+                result.Errors = e.Errors();
+                result.Message = e.GetManifestErrorMessage();
+            }
+            catch (const std::exception& e)
+            {
+                // The failure may not be from the content, such as when the file could not be read, so it is not cached
+                result.Result = APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_FAILURE;
+                result.Message = e.what();
+                return result;
+            }
+
+            if (cache && contentHash)
+            {
+                cache->Set(contentHash.value(), result);
+            }
+
+            return result;
+        }
+
+        Json::Value ConvertToJson(const std::vector<ValidationError>& errors)
+        {
+            Json::Value result{ Json::arrayValue };
+            for (const auto& error : errors)
+            {
+                Json::Value errorValue{ Json::objectValue };
+                errorValue["Level"] = (error.ErrorLevel == ValidationError::Level::Warning ? "Warning" : "Error");
+                errorValue["Message"] = error.Message;
+                errorValue["Field"] = error.Field;
+                errorValue["Value"] = error.Value;
+                errorValue["Line"] = static_cast<Json::UInt64>(error.Line);
+                errorValue["Column"] = static_cast<Json::UInt64>(error.Column);
+                result.append(std::move(errorValue));
+            }
+            return result;
+        }
+
+        std::vector<ValidationError> ConvertToErrors(const Json::Value& errors)
+        {
+            std::vector<ValidationError> result;
+            for (const auto& errorValue : errors)
+            {
+                result.emplace_back(
+                    errorValue["Message"].asString(),
+                    errorValue["Field"].asString(),
+                    errorValue["Value"].asString(),
+                    static_cast<size_t>(errorValue["Line"].asUInt64()),
+                    static_cast<size_t>(errorValue["Column"].asUInt64()),
+                    errorValue["Level"].asString() == "Warning" ? ValidationError::Level::Warning : ValidationError::Level::Error);
+            }
+            return result;
+        }
+
+        std::string_view GetResultName(HRESULT result)
+        {
+            switch (result)
+            {
+            case S_OK:
+                return "Valid";
+            case APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_WARNING:
+                return "Warning";
+            default:
+                return "Error";
+            }
+        }
+    }
+
+    ManifestValidationCache::ManifestValidationCache(std::filesystem::path filePath) :
+        m_filePath(std::move(filePath))
+    {
+        std::ifstream stream{ m_filePath, std::ios::binary };
+        if (!stream)
+        {
+            AICLI_LOG(Core, Info, << "Validation cache does not exist at [" << m_filePath << "]");
+            return;
+        }
+
+        Json::Value root;
+        Json::CharReaderBuilder builder;
+        std::string errors;
+        if (!Json::parseFromStream(builder, stream, &root, &errors) || !root.isObject())
+        {
+            AICLI_LOG(Core, Warning, << "Validation cache could not be read, and will be replaced: " << errors);
+            return;
+        }
+
+        if (root["ValidatorVersion"].asString() != GetValidatorVersion())
+        {
+            AICLI_LOG(Core, Info, << "Validation cache is from validator version " << root["ValidatorVersion"].asString() << ", and will be replaced");
+            return;
+        }
+
+        const Json::Value& results = root["Results"];
+        for (auto itr = results.begin(); itr != results.end(); ++itr)
+        {
+            ManifestValidationResult result;
+            result.Result = static_cast<HRESULT>((*itr)["Result"].asInt());
+            result.Message = (*itr)["Message"].asString();
+            result.Errors = ConvertToErrors((*itr)["Errors"]);
+            m_results.emplace(itr.name(), std::move(result));
+        }
+
+        AICLI_LOG(Core, Info, << "Loaded " << m_results.size() << " results from validation cache at [" << m_filePath << "]");
+    }
+
+    std::string ManifestValidationCache::GetValidatorVersion()
+    {
+        // The rules are those of the build, so a result only holds for the same build
+        return std::string{ s_ValidationCacheFormatVersion } + ';' + Runtime::GetClientVersion().get();
+    }
+
+    std::optional<ManifestValidationResult> ManifestValidationCache::Get(const Utility::SHA256::HashBuffer& contentHash) const
+    {
+        auto lock = m_lock.lock_shared();
+
+        auto itr = m_results.find(Utility::SHA256::ConvertToString(contentHash));
+        if (itr == m_results.end())
+        {
+            return {};
+        }
+
+        return itr->second;
+    }
+
+    void ManifestValidationCache::Set(const Utility::SHA256::HashBuffer& contentHash, const ManifestValidationResult& result)
+    {
+        ManifestValidationResult cached;
+        cached.Result = result.Result;
+        cached.Errors = result.Errors;
+        cached.Message = result.Message;
+
+        auto lock = m_lock.lock_exclusive();
+        m_results.insert_or_assign(Utility::SHA256::ConvertToString(contentHash), std::move(cached));
+        m_changed = true;
+    }
+
+    void ManifestValidationCache::Save()
+    {
+        auto lock = m_lock.lock_exclusive();
+
+        if (!m_changed)
+        {
+            return;
+        }
+
+        Json::Value results{ Json::objectValue };
+        for (const auto& [hash, result] : m_results)
+        {
+            Json::Value resultValue{ Json::objectValue };
+            resultValue["Result"] = static_cast<Json::Int>(result.Result);
+            resultValue["Message"] = result.Message;
+            resultValue["Errors"] = ConvertToJson(result.Errors);
+            results[hash] = std::move(resultValue);
+        }
+
+        Json::Value root{ Json::objectValue };
+        root["ValidatorVersion"] = GetValidatorVersion();
+        root["Results"] = std::move(results);
+
+        // Written beside the cache and moved over it, so that a cache that is being read is never partly written
+        std::filesystem::path tempPath = m_filePath;
+        tempPath += ".tmp";
+
+        {
+            std::ofstream stream{ tempPath, std::ios::binary | std::ios::trunc };
+            THROW_LAST_ERROR_IF(stream.fail());
+
+            Json::StreamWriterBuilder builder;
+            builder["indentation"] = "";
+            stream << Json::writeString(builder, root);
+
+            stream.flush();
+            THROW_HR_IF(E_FAIL, stream.fail());
+        }
+
+        std::filesystem::rename(tempPath, m_filePath);
+        m_changed = false;
+
+        AICLI_LOG(Core, Info, << "Saved " << m_results.size() << " results to validation cache at [" << m_filePath << "]");
+    }
+
+    ManifestValidationResult ValidateManifestFile(const std::filesystem::path& path, ManifestValidationCache* cache)
+    {
+        return ValidateManifestFile(path, path.filename(), cache);
+    }
+
+    std::vector<ManifestValidationResult> ValidateManifestsInDirectory(const std::filesystem::path& directory, ManifestValidationCache* cache)
+    {
+        AICLI_LOG(Core, Info, << "Validating manifests in directory [" << directory << "]");
+
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_PATH_NOT_FOUND), !std::filesystem::is_directory(directory));
+
+        std::vector<std::pair<std::filesystem::path, std::filesystem::path>> manifestPaths;
+
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+        {
+            if (entry.is_regular_file() && Utility::CaseInsensitiveEquals(entry.path().extension().u8string(), ".yaml"))
+            {
+                manifestPaths.emplace_back(entry.path(), entry.path().lexically_relative(directory));
+            }
+        }
+
+        // Enumeration order is not defined; sorting makes the results the same every time.
+        std::sort(manifestPaths.begin(), manifestPaths.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+
+        std::vector<ManifestValidationResult> results(manifestPaths.size());
+        size_t threadCount = std::min<size_t>(std::max<size_t>(std::thread::hardware_concurrency(), 1), manifestPaths.size());
+
+        AICLI_LOG(Core, Info, << "Validating " << manifestPaths.size() << " manifests on " << threadCount << " threads");
+
+        // Each result is written by the thread that validated its manifest, so no lock is needed
+        std::atomic<size_t> nextManifest = 0;
+
+        auto validateThread = [&]()
+        {
+            for (size_t index = nextManifest++; index < manifestPaths.size(); index = nextManifest++)
+            {
+                results[index] = ValidateManifestFile(manifestPaths[index].first, manifestPaths[index].second, cache);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < threadCount; ++i)
+        {
+            threads.emplace_back(validateThread);
+        }
+
+        // This thread does its share of the work too
+        validateThread();
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        return results;
+    }
+
+    HRESULT GetCombinedResult(const std::vector<ManifestValidationResult>& results)
+    {
+        HRESULT combined = S_OK;
+
+        for (const auto& result : results)
+        {
+            if (result.Result == APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_FAILURE)
+            {
+                return result.Result;
+            }
+            else if (result.Result == APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_WARNING)
+            {
+                combined = result.Result;
+            }
+        }
+
+        return combined;
+    }
+
+    std::string ConvertToJson(const std::vector<ManifestValidationResult>& results)
+    {
+        Json::Value root{ Json::arrayValue };
+
+        for (const auto& result : results)
+        {
+            Json::Value manifest{ Json::objectValue };
+            manifest["Path"] = result.RelativePath.u8string();
+            manifest["Result"] = std::string{ GetResultName(result.Result) };
+            manifest["Message"] = result.Message;
+
+            manifest["Errors"] = ConvertToJson(result.Errors);
+
+            root.append(std::move(manifest));
+        }
+
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "  ";
+        return Json::writeString(builder, root);
+    }
+}
@@ -2,9 +2,74 @@
 // Licensed under the MIT License.
 #include "pch.h"
 #include "winget/ManifestValidation.h"
+#include "AppInstallerDownloader.h"
 
 namespace AppInstaller::Manifest
 {
+    namespace
+    {
+        // The characters that \s matches in the classic locale, as in the regular expressions these replace.
+        bool IsWhitespace(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+        }
+
+        bool IsDigit(char c)
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        bool IsHexDigit(char c)
+        {
+            return IsDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+        }
+
+        // A number from 0 to 65535, without leading zeros.
+        bool IsVersionPart(std::string_view part)
+        {
+            if (part.empty() || part.size() > 5 || (part.size() > 1 && part[0] == '0'))
+            {
+                return false;
+            }
+
+            uint32_t value = 0;
+            for (char c : part)
+            {
+                if (!IsDigit(c))
+                {
+                    return false;
+                }
+
+                value = value * 10 + (c - '0');
+            }
+
+            return value <= std::numeric_limits<uint16_t>::max();
+        }
+
+        bool IsVersionWithParts(std::string_view value, size_t minParts, size_t maxParts)
+        {
+            size_t parts = 0;
+
+            for (;;)
+            {
+                size_t separator = value.find('.');
+                if (!IsVersionPart(value.substr(0, separator)) || ++parts > maxParts)
+                {
+                    return false;
+                }
+
+                if (separator == std::string_view::npos)
+                {
+                    break;
+                }
+
+                value = value.substr(separator + 1);
+            }
+
+            return parts >= minParts;
+        }
+    }
+
     std::vector<ValidationError> ValidateManifest(const Manifest& manifest)
     {
         std::vector<ValidationError> resultErrors;
@@ -110,6 +175,12 @@ namespace AppInstaller::Manifest
                 }
             }
 
+            // The chunked hash cannot be computed or checked without the size of its chunks
+            if (installer.ChunkedSha256.empty() != (installer.ChunkSize == 0))
+            {
+                resultErrors.emplace_back(ManifestError::RequiredFieldMissing, installer.ChunkedSha256.empty() ? "ChunkedSha256" : "ChunkSize");
+            }
+
             if (installer.InstallerType == ManifestInstaller::InstallerTypeEnum::Exe &&
                 (installer.Switches.find(ManifestInstaller::InstallerSwitchType::SilentWithProgress) == installer.Switches.end() ||
                  installer.Switches.find(ManifestInstaller::InstallerSwitchType::Silent) == installer.Switches.end()))
@@ -122,8 +193,74 @@ namespace AppInstaller::Manifest
             {
                 resultErrors.emplace_back(ManifestError::InvalidFieldValue, "Url", installer.Url);
             }
+
+            for (const auto& mirror : installer.MirrorUrls)
+            {
+                if (!Utility::IsUrlSecure(mirror) || IsValidURL(NULL, Utility::ConvertToUTF16(mirror).c_str(), 0) == S_FALSE)
+                {
+                    resultErrors.emplace_back(ManifestError::InvalidFieldValue, "MirrorUrls", mirror);
+                }
+            }
         }
 
         return resultErrors;
     }
-}
\ No newline at end of file
+}
+namespace AppInstaller::Manifest::FieldValidators
+{
+    bool IsManifestVersion(std::string_view value)
+    {
+        return IsVersionWithParts(value, 3, 3);
+    }
+
+    bool IsMinOSVersion(std::string_view value)
+    {
+        return IsVersionWithParts(value, 1, 4);
+    }
+
+    bool IsPackageId(std::string_view value)
+    {
+        if (std::any_of(value.begin(), value.end(), IsWhitespace))
+        {
+            return false;
+        }
+
+        // Any '.' other than the first or the last character separates two non-empty parts
+        return value.size() >= 3 && value.find('.', 1) < value.size() - 1;
+    }
+
+    bool IsPackageVersion(std::string_view value)
+    {
+        constexpr std::string_view s_InvalidCharacters = "\\/:*?\"<>|";
+
+        return !value.empty() && std::none_of(value.begin(), value.end(),
+            [&](char c)
+            {
+                return (c >= '\x01' && c <= '\x1f') || s_InvalidCharacters.find(c) != std::string_view::npos;
+            });
+    }
+
+    bool IsSha256(std::string_view value)
+    {
+        return value.size() == 64 && std::all_of(value.begin(), value.end(), IsHexDigit);
+    }
+
+    bool IsChunkSize(std::string_view value)
+    {
+        constexpr uint64_t s_ChunkSizeMultiple = 64 * 1024;
+        constexpr uint64_t s_ChunkSizeMaximum = 4ull * 1024 * 1024 * 1024;
+
+        if (value.empty() || value.size() > 10 || value[0] == '0' || !std::all_of(value.begin(), value.end(), [](char c) { return c >= '0' && c <= '9'; }))
+        {
+            return false;
+        }
+
+        uint64_t size = 0;
+        for (char c : value)
+        {
+            size = size * 10 + static_cast<uint64_t>(c - '0');
+        }
+
+        return size % s_ChunkSizeMultiple == 0 && size <= s_ChunkSizeMaximum;
+    }
+}
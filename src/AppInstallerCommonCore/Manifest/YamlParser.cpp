@@ -37,95 +37,213 @@ namespace AppInstaller::Manifest
 
             return result;
         }
-    }
-
-    void YamlParser::PrepareManifestFieldInfos(const ManifestVer& manifestVer)
-    {
-        RootFieldInfos =
-        {
-            { "ManifestVersion", PreviewManifestVersion, [](const YAML::Node&) { /* ManifestVersion already processed */ }, false,
-            // Regex here is to prevent leading 0s in the version, this also keeps consistent with other versions in the manifest
-            "^(0|[1-9][0-9]{0,3}|[1-5][0-9]{4}|6[0-4][0-9]{3}|65[0-4][0-9]{2}|655[0-2][0-9]|6553[0-5])(\\.(0|[1-9][0-9]{0,3}|[1-5][0-9]{4}|6[0-4][0-9]{3}|65[0-4][0-9]{2}|655[0-2][0-9]|6553[0-5])){2}$" },
-            { "Id", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->Id = value.as<std::string>(); Utility::Trim(m_p_manifest->Id); }, true, "^[\\S]+\\.[\\S]+$" },
-            { "Name", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->Name = value.as<std::string>(); Utility::Trim(m_p_manifest->Name); }, true },
-            { "Version", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->Version = value.as<std::string>(); Utility::Trim(m_p_manifest->Version); }, true,
-            /* File name chars not allowed */ "^[^\\\\/:\\*\\?\"<>\\|\\x01-\\x1f]+$" },
-            { "Publisher", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->Publisher = value.as<std::string>(); }, true },
-            { "AppMoniker", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->AppMoniker = value.as<std::string>(); Utility::Trim(m_p_manifest->AppMoniker); } },
-            { "Channel", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->Channel = value.as<std::string>(); Utility::Trim(m_p_manifest->Channel); } },
-            { "Author", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->Author = value.as<std::string>(); } },
-            { "License", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->License = value.as<std::string>(); } },
-            { "MinOSVersion", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->MinOSVersion = value.as<std::string>(); Utility::Trim(m_p_manifest->MinOSVersion); }, false,
-              "^(0|[1-9][0-9]{0,3}|[1-5][0-9]{4}|6[0-4][0-9]{3}|65[0-4][0-9]{2}|655[0-2][0-9]|6553[0-5])(\\.(0|[1-9][0-9]{0,3}|[1-5][0-9]{4}|6[0-4][0-9]{3}|65[0-4][0-9]{2}|655[0-2][0-9]|6553[0-5])){0,3}$" },
-            { "Tags", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->Tags = SplitMultiValueField(value.as<std::string>()); } },
-            { "Commands", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->Commands = SplitMultiValueField(value.as<std::string>()); } },
-            { "Protocols", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->Protocols = SplitMultiValueField(value.as<std::string>()); } },
-            { "FileExtensions", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->FileExtensions = SplitMultiValueField(value.as<std::string>()); } },
-            { "InstallerType", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->InstallerType = ManifestInstaller::ConvertToInstallerTypeEnum(value.as<std::string>()); } },
-            { "Description", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->Description = value.as<std::string>(); } },
-            { "Homepage", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->Homepage = value.as<std::string>(); } },
-            { "LicenseUrl", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_manifest->LicenseUrl = value.as<std::string>(); } },
-            { "Switches", PreviewManifestVersion, [this](const YAML::Node& value) { *m_p_switchesNode = value; } },
-            { "Installers", PreviewManifestVersion, [this](const YAML::Node& value) { *m_p_installersNode = value; }, true },
-            { "Localization", PreviewManifestVersion, [this](const YAML::Node& value) { *m_p_localizationsNode = value; } },
-        };
-
-        InstallerFieldInfos =
-        {
-            { "Arch", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_installer->Arch = Utility::ConvertToArchitectureEnum(value.as<std::string>()); }, true },
-            { "Url", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_installer->Url = value.as<std::string>(); } },
-            { "Sha256", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_installer->Sha256 = Utility::SHA256::ConvertToBytes(value.as<std::string>()); }, false, "^[A-Fa-f0-9]{64}$" },
-            { "SignatureSha256", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_installer->SignatureSha256 = Utility::SHA256::ConvertToBytes(value.as<std::string>()); }, false, "^[A-Fa-f0-9]{64}$" },
-            { "Language", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_installer->Language = value.as<std::string>(); } },
-            { "Scope", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_installer->Scope = value.as<std::string>(); } },
-            { "InstallerType", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_installer->InstallerType = ManifestInstaller::ConvertToInstallerTypeEnum(value.as<std::string>()); } },
-            { "ProductId", PreviewManifestVersionMSStore, [this](const YAML::Node& value) { m_p_installer->ProductId = value.as<std::string>(); } },
-            { "Switches", PreviewManifestVersion, [this](const YAML::Node& value) { *m_p_switchesNode = value; } },
-        };
 
-        SwitchesFieldInfos =
+        // The root values that every localization of a manifest starts from.
+        struct LocalizationDefaults
         {
-            { "Custom", PreviewManifestVersion, [this](const YAML::Node& value) { (*m_p_switches)[ManifestInstaller::InstallerSwitchType::Custom] = value.as<std::string>(); } },
-            { "Silent", PreviewManifestVersion, [this](const YAML::Node& value) { (*m_p_switches)[ManifestInstaller::InstallerSwitchType::Silent] = value.as<std::string>(); } },
-            { "SilentWithProgress", PreviewManifestVersion, [this](const YAML::Node& value) { (*m_p_switches)[ManifestInstaller::InstallerSwitchType::SilentWithProgress] = value.as<std::string>(); } },
-            { "Interactive", PreviewManifestVersion, [this](const YAML::Node& value) { (*m_p_switches)[ManifestInstaller::InstallerSwitchType::Interactive] = value.as<std::string>(); } },
-            { "Language", PreviewManifestVersion, [this](const YAML::Node& value) { (*m_p_switches)[ManifestInstaller::InstallerSwitchType::Language] = value.as<std::string>(); } },
-            { "Log", PreviewManifestVersion, [this](const YAML::Node& value) { (*m_p_switches)[ManifestInstaller::InstallerSwitchType::Log] = value.as<std::string>(); } },
-            { "InstallLocation", PreviewManifestVersion, [this](const YAML::Node& value) { (*m_p_switches)[ManifestInstaller::InstallerSwitchType::InstallLocation] = value.as<std::string>(); } },
+            Manifest::string_t Description;
+            Manifest::string_t Homepage;
+            Manifest::string_t LicenseUrl;
         };
 
-        LocalizationFieldInfos =
+        // Orders the strings by their lowercase bytes, so that the names equal under CaseInsensitiveEquals are next to each other.
+        int CompareCaseInsensitive(std::string_view a, std::string_view b)
         {
-            { "Language", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_localization->Language = value.as<std::string>(); }, true },
-            { "Description", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_localization->Description = value.as<std::string>(); } },
-            { "Homepage", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_localization->Homepage = value.as<std::string>(); } },
-            { "LicenseUrl", PreviewManifestVersion, [this](const YAML::Node& value) { m_p_localization->LicenseUrl = value.as<std::string>(); } },
-        };
+            size_t length = std::min(a.size(), b.size());
+            for (size_t i = 0; i < length; ++i)
+            {
+                int lowerA = std::tolower(static_cast<unsigned char>(a[i]));
+                int lowerB = std::tolower(static_cast<unsigned char>(b[i]));
+                if (lowerA != lowerB)
+                {
+                    return lowerA < lowerB ? -1 : 1;
+                }
+            }
+
+            return a.size() == b.size() ? 0 : (a.size() < b.size() ? -1 : 1);
+        }
 
-        FilterManifestFieldInfos(RootFieldInfos, manifestVer);
-        FilterManifestFieldInfos(InstallerFieldInfos, manifestVer);
-        FilterManifestFieldInfos(SwitchesFieldInfos, manifestVer);
-        FilterManifestFieldInfos(LocalizationFieldInfos, manifestVer);
+        // The tables are shared for this many versions; the fields of any other version are prepared for each parse.
+        constexpr size_t s_MaxSharedManifestFieldInfoVersions = 16;
     }
 
-    void YamlParser::FilterManifestFieldInfos(
-        std::vector<ManifestFieldInfo>& source,
-        const ManifestVer& manifestVer)
+    YamlParser::ManifestFieldInfos::ManifestFieldInfos(const std::vector<ManifestFieldInfo>& fields, const ManifestVer& manifestVer)
     {
-        auto it = std::remove_if(source.begin(), source.end(),
-            [&](ManifestFieldInfo field)
+        std::copy_if(fields.begin(), fields.end(), std::back_inserter(m_fields),
+            [&](const ManifestFieldInfo& field)
             {
                 if (field.VerIntroduced.HasTag())
                 {
                     // Tagged version should have exact match
-                    return field.VerIntroduced != manifestVer;
+                    return field.VerIntroduced == manifestVer;
                 }
                 else
                 {
-                    return manifestVer < field.VerIntroduced;
+                    return !(manifestVer < field.VerIntroduced);
                 }
             });
-        source.erase(it, source.end());
+
+        m_byName.resize(m_fields.size());
+        std::iota(m_byName.begin(), m_byName.end(), size_t{ 0 });
+        std::sort(m_byName.begin(), m_byName.end(),
+            [&](size_t a, size_t b) { return CompareCaseInsensitive(m_fields[a].Name, m_fields[b].Name) < 0; });
+    }
+
+    const YamlParser::ManifestFieldInfo* YamlParser::ManifestFieldInfos::Find(std::string_view key) const
+    {
+        auto it = std::lower_bound(m_byName.begin(), m_byName.end(), key,
+            [&](size_t index, std::string_view value) { return CompareCaseInsensitive(m_fields[index].Name, value) < 0; });
+
+        if (it != m_byName.end() && CompareCaseInsensitive(m_fields[*it].Name, key) == 0)
+        {
+            return &m_fields[*it];
+        }
+
+        return nullptr;
+    }
+
+    struct YamlParser::DeferredLocalization : public details::DeferredLocalization
+    {
+        DeferredLocalization(YAML::Node node, std::shared_ptr<const ManifestFieldInfoTables> fieldInfos, std::shared_ptr<const LocalizationDefaults> defaults) :
+            m_node(std::move(node)), m_fieldInfos(std::move(fieldInfos)), m_defaults(std::move(defaults)) {}
+
+        void Decode(ManifestLocalization& localization) const override
+        {
+            // Populates default values from root first
+            localization.Description = m_defaults->Description;
+            localization.Homepage = m_defaults->Homepage;
+            localization.LicenseUrl = m_defaults->LicenseUrl;
+
+            YamlParser parser;
+            parser.m_fieldInfos = m_fieldInfos;
+            parser.m_p_localization = &localization;
+
+            // The fields were checked when the manifest was parsed, so there is nothing more to report
+            (void)parser.ValidateAndProcessFields(m_node, m_fieldInfos->Localization, false);
+        }
+
+    private:
+        // Shares the children of the localization node, which keeps only them from the parsed document.
+        YAML::Node m_node;
+        std::shared_ptr<const ManifestFieldInfoTables> m_fieldInfos;
+        std::shared_ptr<const LocalizationDefaults> m_defaults;
+    };
+
+    std::shared_ptr<const YamlParser::ManifestFieldInfoTables> YamlParser::GetManifestFieldInfos(const ManifestVer& manifestVer)
+    {
+        static wil::srwlock s_lock;
+        static std::map<std::string, std::shared_ptr<const ManifestFieldInfoTables>> s_tables;
+
+        {
+            auto lock = s_lock.lock_shared();
+            auto itr = s_tables.find(manifestVer.ToString());
+            if (itr != s_tables.end())
+            {
+                return itr->second;
+            }
+        }
+
+        auto result = std::make_shared<const ManifestFieldInfoTables>(CreateManifestFieldInfos(manifestVer));
+
+        // Manifests can name any version, so only so many are kept
+        auto lock = s_lock.lock_exclusive();
+        if (s_tables.size() < s_MaxSharedManifestFieldInfoVersions)
+        {
+            s_tables.emplace(manifestVer.ToString(), result);
+        }
+
+        return result;
+    }
+
+    YamlParser::ManifestFieldInfoTables YamlParser::CreateManifestFieldInfos(const ManifestVer& manifestVer)
+    {
+        // The fields of every manifest version; those of the given version are taken from these
+        static const std::vector<ManifestFieldInfo> s_rootFieldInfos =
+        {
+            { "ManifestVersion", PreviewManifestVersion, [](YamlParser&, const YAML::Node&) { /* ManifestVersion already processed */ }, false,
+            // The validator here is to prevent leading 0s in the version, this also keeps consistent with other versions in the manifest
+            FieldValidators::IsManifestVersion },
+            { "Id", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->Id = value.as<std::string>(); Utility::Trim(p.m_p_manifest->Id); }, true, FieldValidators::IsPackageId },
+            { "Name", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->Name = value.as<std::string>(); Utility::Trim(p.m_p_manifest->Name); }, true },
+            { "Version", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->Version = value.as<std::string>(); Utility::Trim(p.m_p_manifest->Version); }, true,
+            /* File name chars not allowed */ FieldValidators::IsPackageVersion },
+            { "Publisher", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->Publisher = value.as<std::string>(); }, true },
+            { "AppMoniker", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->AppMoniker = value.as<std::string>(); Utility::Trim(p.m_p_manifest->AppMoniker); } },
+            { "Channel", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->Channel = value.as<std::string>(); Utility::Trim(p.m_p_manifest->Channel); } },
+            { "Author", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->Author = value.as<std::string>(); } },
+            { "License", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->License = value.as<std::string>(); } },
+            { "MinOSVersion", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->MinOSVersion = value.as<std::string>(); Utility::Trim(p.m_p_manifest->MinOSVersion); }, false,
+              FieldValidators::IsMinOSVersion },
+            { "Tags", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->Tags = SplitMultiValueField(value.as<std::string>()); } },
+            { "Commands", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->Commands = SplitMultiValueField(value.as<std::string>()); } },
+            { "Protocols", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->Protocols = SplitMultiValueField(value.as<std::string>()); } },
+            { "FileExtensions", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->FileExtensions = SplitMultiValueField(value.as<std::string>()); } },
+            { "InstallerType", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->InstallerType = ManifestInstaller::ConvertToInstallerTypeEnum(value.as<std::string>()); } },
+            { "Description", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->Description = value.as<std::string>(); } },
+            { "Homepage", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->Homepage = value.as<std::string>(); } },
+            { "LicenseUrl", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_manifest->LicenseUrl = value.as<std::string>(); } },
+            { "Switches", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { *p.m_p_switchesNode = value; } },
+            { "Installers", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { *p.m_p_installersNode = value; }, true },
+            { "Localization", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { *p.m_p_localizationsNode = value; } },
+        };
+
+        static const std::vector<ManifestFieldInfo> s_installerFieldInfos =
+        {
+            { "Arch", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_installer->Arch = Utility::ConvertToArchitectureEnum(value.as<std::string>()); }, true },
+            { "Url", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_installer->Url = value.as<std::string>(); } },
+            { "MirrorUrls", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { THROW_HR_IF(E_INVALIDARG, !value.IsSequence()); for (const auto& mirror : value.Sequence()) { p.m_p_installer->MirrorUrls.emplace_back(mirror.as<std::string>()); } } },
+            { "Sha256", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_installer->Sha256 = Utility::SHA256::ConvertToBytes(value.as<std::string>()); }, false, FieldValidators::IsSha256 },
+            { "SignatureSha256", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_installer->SignatureSha256 = Utility::SHA256::ConvertToBytes(value.as<std::string>()); }, false, FieldValidators::IsSha256 },
+            { "ChunkedSha256", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_installer->ChunkedSha256 = Utility::SHA256::ConvertToBytes(value.as<std::string>()); }, false, FieldValidators::IsSha256 },
+            { "ChunkSize", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { std::string chunkSize = value.as<std::string>(); THROW_HR_IF(E_INVALIDARG, !FieldValidators::IsChunkSize(chunkSize)); p.m_p_installer->ChunkSize = std::stoull(chunkSize); }, false, FieldValidators::IsChunkSize },
+            { "Language", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_installer->Language = value.as<std::string>(); } },
+            { "Scope", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_installer->Scope = value.as<std::string>(); } },
+            { "InstallerType", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_installer->InstallerType = ManifestInstaller::ConvertToInstallerTypeEnum(value.as<std::string>()); } },
+            { "ProductId", PreviewManifestVersionMSStore, [](YamlParser& p, const YAML::Node& value) { p.m_p_installer->ProductId = value.as<std::string>(); } },
+            { "Switches", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { *p.m_p_switchesNode = value; } },
+        };
+
+        static const std::vector<ManifestFieldInfo> s_switchesFieldInfos =
+        {
+            { "Custom", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { (*p.m_p_switches)[ManifestInstaller::InstallerSwitchType::Custom] = value.as<std::string>(); } },
+            { "Silent", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { (*p.m_p_switches)[ManifestInstaller::InstallerSwitchType::Silent] = value.as<std::string>(); } },
+            { "SilentWithProgress", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { (*p.m_p_switches)[ManifestInstaller::InstallerSwitchType::SilentWithProgress] = value.as<std::string>(); } },
+            { "Interactive", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { (*p.m_p_switches)[ManifestInstaller::InstallerSwitchType::Interactive] = value.as<std::string>(); } },
+            { "Language", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { (*p.m_p_switches)[ManifestInstaller::InstallerSwitchType::Language] = value.as<std::string>(); } },
+            { "Log", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { (*p.m_p_switches)[ManifestInstaller::InstallerSwitchType::Log] = value.as<std::string>(); } },
+            { "InstallLocation", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { (*p.m_p_switches)[ManifestInstaller::InstallerSwitchType::InstallLocation] = value.as<std::string>(); } },
+        };
+
+        static const std::vector<ManifestFieldInfo> s_localizationFieldInfos =
+        {
+            { "Language", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_localization->Language = value.as<std::string>(); }, true },
+            { "Description", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_localization->Description = value.as<std::string>(); } },
+            { "Homepage", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_localization->Homepage = value.as<std::string>(); } },
+            { "LicenseUrl", PreviewManifestVersion, [](YamlParser& p, const YAML::Node& value) { p.m_p_localization->LicenseUrl = value.as<std::string>(); } },
+        };
+
+        // The same fields, checked in the same way, but only the language is stored
+        static const std::vector<ManifestFieldInfo> s_localizationLanguageFieldInfos = []()
+        {
+            std::vector<ManifestFieldInfo> result = s_localizationFieldInfos;
+            for (auto& field : result)
+            {
+                if (field.Name != "Language"sv)
+                {
+                    field.ProcessFunc = [](YamlParser&, const YAML::Node&) {};
+                }
+            }
+            return result;
+        }();
+
+        return
+        {
+            { s_rootFieldInfos, manifestVer },
+            { s_installerFieldInfos, manifestVer },
+            { s_switchesFieldInfos, manifestVer },
+            { s_localizationFieldInfos, manifestVer },
+            { s_localizationLanguageFieldInfos, manifestVer },
+        };
     }
 
     Manifest YamlParser::CreateFromPath(const std::filesystem::path& inputFile, bool fullValidation, bool throwOnWarning)
@@ -224,7 +342,7 @@ namespace AppInstaller::Manifest
             THROW_EXCEPTION_MSG(ManifestException(APPINSTALLER_CLI_ERROR_UNSUPPORTED_MANIFESTVERSION), "Unsupported ManifestVersion: %S", manifest.ManifestVersion.ToString().c_str());
         }
 
-        PrepareManifestFieldInfos(manifest.ManifestVersion);
+        m_fieldInfos = GetManifestFieldInfos(manifest.ManifestVersion);
 
         // Populate root fields
         YAML::Node switchesNode;
@@ -234,13 +352,13 @@ namespace AppInstaller::Manifest
         m_p_installersNode = &installersNode;
         m_p_localizationsNode = &localizationsNode;
         m_p_manifest = &manifest;
-        auto resultErrors = ValidateAndProcessFields(rootNode, RootFieldInfos, fullValidation);
+        auto resultErrors = ValidateAndProcessFields(rootNode, m_fieldInfos->Root, fullValidation);
 
         // Populate root switches
         if (!switchesNode.IsNull())
         {
             m_p_switches = &manifest.Switches;
-            auto errors = ValidateAndProcessFields(switchesNode, SwitchesFieldInfos, fullValidation);
+            auto errors = ValidateAndProcessFields(switchesNode, m_fieldInfos->Switches, fullValidation);
             std::move(errors.begin(), errors.end(), std::inserter(resultErrors, resultErrors.end()));
         }
 
@@ -257,7 +375,7 @@ namespace AppInstaller::Manifest
 
             m_p_installer = &installer;
             m_p_switchesNode = &installerSwitchesNode;
-            auto errors = ValidateAndProcessFields(installerNode, InstallerFieldInfos, fullValidation);
+            auto errors = ValidateAndProcessFields(installerNode, m_fieldInfos->Installer, fullValidation);
             std::move(errors.begin(), errors.end(), std::inserter(resultErrors, resultErrors.end()));
 
             // Populate default known switches
@@ -273,7 +391,7 @@ namespace AppInstaller::Manifest
             if (!installerSwitchesNode.IsNull())
             {
                 m_p_switches = &installer.Switches;
-                auto switchesErrors = ValidateAndProcessFields(installerSwitchesNode, SwitchesFieldInfos, fullValidation);
+                auto switchesErrors = ValidateAndProcessFields(installerSwitchesNode, m_fieldInfos->Switches, fullValidation);
                 std::move(switchesErrors.begin(), switchesErrors.end(), std::inserter(resultErrors, resultErrors.end()));
             }
 
@@ -283,18 +401,36 @@ namespace AppInstaller::Manifest
         // Populate localization fields
         if (!localizationsNode.IsNull())
         {
+            // Only one localization is ever shown, so the client decodes the rest of their fields when they are first needed.
+            // They are still checked now, so that a manifest that is not valid fails to parse all the same.
+            std::shared_ptr<const LocalizationDefaults> defaults;
+            if (!fullValidation)
+            {
+                defaults = std::make_shared<const LocalizationDefaults>(LocalizationDefaults{ manifest.Description, manifest.Homepage, manifest.LicenseUrl });
+            }
+
             for (std::size_t i = 0; i < localizationsNode.size(); i++)
             {
                 YAML::Node localizationNode = localizationsNode[i];
                 ManifestLocalization localization;
+                m_p_localization = &localization;
+                std::vector<ValidationError> errors;
 
-                // Populates default values from root first
-                localization.Description = manifest.Description;
-                localization.Homepage = manifest.Homepage;
-                localization.LicenseUrl = manifest.LicenseUrl;
+                if (fullValidation)
+                {
+                    // Populates default values from root first
+                    localization.Description = manifest.Description;
+                    localization.Homepage = manifest.Homepage;
+                    localization.LicenseUrl = manifest.LicenseUrl;
+
+                    errors = ValidateAndProcessFields(localizationNode, m_fieldInfos->Localization, fullValidation);
+                }
+                else
+                {
+                    errors = ValidateAndProcessFields(localizationNode, m_fieldInfos->LocalizationLanguage, fullValidation);
+                    localization.SetDeferred(std::make_shared<const DeferredLocalization>(localizationNode, m_fieldInfos, defaults));
+                }
 
-                m_p_localization = &localization;
-                auto errors = ValidateAndProcessFields(localizationNode, LocalizationFieldInfos, fullValidation);
                 std::move(errors.begin(), errors.end(), std::inserter(resultErrors, resultErrors.end()));
                 manifest.Localization.emplace_back(std::move(localization));
             }
@@ -312,7 +448,7 @@ namespace AppInstaller::Manifest
 
     std::vector<ValidationError> YamlParser::ValidateAndProcessFields(
         const YAML::Node& rootNode,
-        const std::vector<ManifestFieldInfo>& fieldInfos,
+        const ManifestFieldInfos& fieldInfos,
         bool fullValidation)
     {
         std::vector<ValidationError> errors;
@@ -323,8 +459,9 @@ namespace AppInstaller::Manifest
             return errors;
         }
 
-        // Keeps track of already processed fields. Used to check duplicate fields or missing required fields.
-        std::set<std::string> processedFields;
+        // Keeps track of already processed fields, by their index. Used to check duplicate fields or missing required fields.
+        const std::vector<ManifestFieldInfo>& fields = fieldInfos.Fields();
+        std::vector<bool> processedFields(fields.size());
 
         for (auto const& keyValuePair : rootNode.Mapping())
         {
@@ -332,15 +469,12 @@ namespace AppInstaller::Manifest
             const YAML::Node& valueNode = keyValuePair.second;
 
             // We'll do case insensitive search first and validate correct case later.
-            auto fieldIter = std::find_if(fieldInfos.begin(), fieldInfos.end(),
-                [&](auto const& s)
-                {
-                    return Utility::CaseInsensitiveEquals(s.Name, key);
-                });
+            const ManifestFieldInfo* field = fieldInfos.Find(key);
 
-            if (fieldIter != fieldInfos.end())
+            if (field)
             {
-                const ManifestFieldInfo& fieldInfo = *fieldIter;
+                const ManifestFieldInfo& fieldInfo = *field;
+                size_t fieldIndex = static_cast<size_t>(field - fields.data());
 
                 // Make sure the found key is in Pascal Case
                 if (key != fieldInfo.Name)
@@ -349,10 +483,11 @@ namespace AppInstaller::Manifest
                 }
 
                 // Make sure it's not a duplicate key
-                if (!processedFields.insert(fieldInfo.Name).second)
+                if (processedFields[fieldIndex])
                 {
-                    errors.emplace_back(ManifestError::FieldDuplicate, fieldInfo.Name, "", keyValuePair.first.Mark().line, keyValuePair.first.Mark().column);
+                    errors.emplace_back(ManifestError::FieldDuplicate, std::string{ fieldInfo.Name }, "", keyValuePair.first.Mark().line, keyValuePair.first.Mark().column);
                 }
+                processedFields[fieldIndex] = true;
 
                 // Validate non empty value is provided for required fields
                 if (fieldInfo.Required)
@@ -361,25 +496,24 @@ namespace AppInstaller::Manifest
                         (valueNode.IsScalar() && valueNode.as<std::string>().empty()) ||  // Scalar type should have content
                         ((valueNode.IsMap() || valueNode.IsSequence()) && valueNode.size() == 0))  // Map or sequence type should have size greater than 0
                     {
-                        errors.emplace_back(ManifestError::RequiredFieldEmpty, fieldInfo.Name, "", valueNode.Mark().line, valueNode.Mark().column);
+                        errors.emplace_back(ManifestError::RequiredFieldEmpty, std::string{ fieldInfo.Name }, "", valueNode.Mark().line, valueNode.Mark().column);
                     }
                 }
 
-                // Validate value against regex if applicable
-                if (fullValidation && !fieldInfo.RegEx.empty())
+                // Validate value against its format if applicable
+                if (fullValidation && fieldInfo.ValidateValue)
                 {
                     std::string value = valueNode.as<std::string>();
-                    std::regex pattern{ fieldInfo.RegEx };
-                    if (!std::regex_match(value, pattern))
+                    if (!fieldInfo.ValidateValue(value))
                     {
-                        errors.emplace_back(ManifestError::InvalidFieldValue, fieldInfo.Name, value, valueNode.Mark().line, valueNode.Mark().column);
+                        errors.emplace_back(ManifestError::InvalidFieldValue, std::string{ fieldInfo.Name }, value, valueNode.Mark().line, valueNode.Mark().column);
                         continue;
                     }
                 }
 
                 if (!valueNode.IsNull())
                 {
-                    fieldInfo.ProcessFunc(valueNode);
+                    fieldInfo.ProcessFunc(*this, valueNode);
                 }
             }
             else
@@ -393,11 +527,11 @@ namespace AppInstaller::Manifest
         }
 
         // Make sure required fields are provided
-        for (auto const& fieldInfo : fieldInfos)
+        for (size_t i = 0; i < fields.size(); ++i)
         {
-            if (fieldInfo.Required && processedFields.find(fieldInfo.Name) == processedFields.end())
+            if (fields[i].Required && !processedFields[i])
             {
-                errors.emplace_back(ManifestError::RequiredFieldMissing, fieldInfo.Name);
+                errors.emplace_back(ManifestError::RequiredFieldMissing, std::string{ fields[i].Name });
             }
         }
 
@@ -0,0 +1,246 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Public/winget/MemoryBudget.h"
+#include "Public/winget/UserSettings.h"
+#include "Public/AppInstallerLogging.h"
+
+namespace AppInstaller::Memory
+{
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        // While the system stays low on memory, the caches are trimmed again at most this often.
+        constexpr std::chrono::milliseconds s_LowMemoryTrimInterval = 10s;
+    }
+
+    struct MemoryBudget::Registration::Entry
+    {
+        std::string Name;
+        TrimOrder Order = TrimOrder::Normal;
+        UsageFunction Usage;
+        TrimFunction Trim;
+        std::atomic<size_t> ReportedUsage{ 0 };
+
+        // Held while the functions of the cache are called, and to remove the registration.
+        std::mutex Lock;
+        bool Active = true;
+
+        // *Must be called with the lock held*
+        size_t GetUsage() const
+        {
+            return (Usage ? Usage() : ReportedUsage.load());
+        }
+    };
+
+    MemoryBudget::Registration::Registration(MemoryBudget* budget, std::shared_ptr<Entry> entry) :
+        m_budget(budget), m_entry(std::move(entry)) {}
+
+    MemoryBudget::Registration& MemoryBudget::Registration::operator=(Registration&& other)
+    {
+        if (this != &other)
+        {
+            reset();
+            m_budget = std::exchange(other.m_budget, nullptr);
+            m_entry = std::move(other.m_entry);
+        }
+
+        return *this;
+    }
+
+    MemoryBudget::Registration::~Registration()
+    {
+        reset();
+    }
+
+    void MemoryBudget::Registration::SetUsage(size_t bytes)
+    {
+        if (m_entry)
+        {
+            m_entry->ReportedUsage = bytes;
+        }
+    }
+
+    void MemoryBudget::Registration::reset()
+    {
+        if (m_entry)
+        {
+            m_budget->Unregister(m_entry);
+            m_entry.reset();
+            m_budget = nullptr;
+        }
+    }
+
+    MemoryBudget::MemoryBudget(size_t limit) : m_limit(limit) {}
+
+    MemoryBudget& MemoryBudget::Instance()
+    {
+        static MemoryBudget s_instance{ static_cast<size_t>(Settings::User().Get<Settings::Setting::MemoryBudgetInMB>()) * 1024 * 1024 };
+        return s_instance;
+    }
+
+    MemoryBudget::Registration MemoryBudget::Register(std::string_view name, TrimOrder order, TrimFunction trim)
+    {
+        return Register(name, order, {}, std::move(trim));
+    }
+
+    MemoryBudget::Registration MemoryBudget::Register(std::string_view name, TrimOrder order, UsageFunction usage, TrimFunction trim)
+    {
+        auto entry = std::make_shared<Registration::Entry>();
+        entry->Name = name;
+        entry->Order = order;
+        entry->Usage = std::move(usage);
+        entry->Trim = std::move(trim);
+
+        {
+            std::lock_guard<std::mutex> lock{ m_lock };
+            m_entries.emplace_back(entry);
+        }
+
+        return { this, std::move(entry) };
+    }
+
+    size_t MemoryBudget::GetUsage() const
+    {
+        std::vector<std::shared_ptr<Registration::Entry>> entries;
+        {
+            std::lock_guard<std::mutex> lock{ m_lock };
+            entries = m_entries;
+        }
+
+        size_t result = 0;
+        for (const auto& entry : entries)
+        {
+            std::lock_guard<std::mutex> entryLock{ entry->Lock };
+            if (entry->Active)
+            {
+                result += entry->GetUsage();
+            }
+        }
+
+        return result;
+    }
+
+    size_t MemoryBudget::Trim(size_t target)
+    {
+        std::vector<std::shared_ptr<Registration::Entry>> entries;
+        {
+            std::lock_guard<std::mutex> lock{ m_lock };
+            entries = m_entries;
+        }
+
+        std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a->Order < b->Order; });
+
+        size_t usage = GetUsage();
+        size_t freed = 0;
+
+        for (const auto& entry : entries)
+        {
+            if (usage <= target)
+            {
+                break;
+            }
+
+            std::lock_guard<std::mutex> entryLock{ entry->Lock };
+            if (!entry->Active || !entry->Trim)
+            {
+                continue;
+            }
+
+            size_t before = entry->GetUsage();
+            if (before == 0)
+            {
+                continue;
+            }
+
+            // A cache that fails to trim keeps its memory; the others are still trimmed
+            try
+            {
+                entry->Trim(usage - target);
+            }
+            CATCH_LOG();
+
+            size_t after = entry->GetUsage();
+            if (after < before)
+            {
+                AICLI_LOG(Core, Verbose, << "Trimmed " << (before - after) << " bytes from " << entry->Name);
+                freed += before - after;
+                usage -= std::min(usage, before - after);
+            }
+        }
+
+        AICLI_LOG(Core, Info, << "Trimmed caches to " << usage << " bytes, freeing " << freed << " bytes");
+        return freed;
+    }
+
+    void MemoryBudget::TrimIfOverBudget()
+    {
+        size_t limit = m_limit;
+        if (limit > 0 && GetUsage() > limit)
+        {
+            Trim(limit);
+        }
+    }
+
+    void MemoryBudget::Unregister(const std::shared_ptr<Registration::Entry>& entry)
+    {
+        {
+            std::lock_guard<std::mutex> entryLock{ entry->Lock };
+            entry->Active = false;
+        }
+
+        std::lock_guard<std::mutex> lock{ m_lock };
+        m_entries.erase(std::remove(m_entries.begin(), m_entries.end(), entry), m_entries.end());
+    }
+
+    LowMemoryMonitor::LowMemoryMonitor(MemoryBudget& budget) :
+        m_budget(budget), m_stop(wil::EventOptions::ManualReset)
+    {
+        m_notification.reset(CreateMemoryResourceNotification(LowMemoryResourceNotification));
+        if (!m_notification)
+        {
+            LOG_LAST_ERROR_MSG("Low memory notifications are not available; caches are only trimmed to their budget");
+            return;
+        }
+
+        m_thread = std::thread(&LowMemoryMonitor::Monitor, this);
+    }
+
+    LowMemoryMonitor::~LowMemoryMonitor()
+    {
+        m_stop.SetEvent();
+
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+    void LowMemoryMonitor::Monitor()
+    {
+        HANDLE handles[] = { m_stop.get(), m_notification.get() };
+
+        for (;;)
+        {
+            DWORD result = WaitForMultipleObjects(ARRAYSIZE(handles), handles, FALSE, INFINITE);
+            if (result != WAIT_OBJECT_0 + 1)
+            {
+                return;
+            }
+
+            AICLI_LOG(Core, Info, << "The system is low on memory, trimming all caches");
+            try
+            {
+                m_budget.Trim(0);
+            }
+            CATCH_LOG();
+
+            // The notification stays signaled while memory is low, so it is not waited on again right away
+            if (m_stop.wait(static_cast<DWORD>(s_LowMemoryTrimInterval.count())))
+            {
+                return;
+            }
+        }
+    }
+}
@@ -0,0 +1,186 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "MirrorScores.h"
+#include "Public/AppInstallerDateTime.h"
+#include "Public/AppInstallerLogging.h"
+#include "Public/AppInstallerRuntime.h"
+#include "Public/AppInstallerStrings.h"
+#include "Public/winget/Yaml.h"
+
+namespace AppInstaller::Utility
+{
+    namespace
+    {
+        using namespace std::string_view_literals;
+
+        constexpr std::string_view s_MirrorScores_FileName = "MirrorScores.yaml"sv;
+        constexpr std::string_view s_MirrorScores_Hosts = "Hosts"sv;
+        constexpr std::string_view s_MirrorScores_Host = "Host"sv;
+        constexpr std::string_view s_MirrorScores_BytesPerSecond = "BytesPerSecond"sv;
+        constexpr std::string_view s_MirrorScores_LastRecorded = "LastRecorded"sv;
+
+        // The weight of the newest download in the score of its host.
+        constexpr double s_MirrorScores_NewestWeight = 0.3;
+
+        // Downloads shorter than this say more about the round trip than the throughput, and are not recorded.
+        constexpr std::chrono::milliseconds s_MirrorScores_MinimumDuration{ 100 };
+
+        // The number of hosts kept; the one recorded least recently is removed to make room for another.
+        constexpr size_t s_MirrorScores_MaximumHosts = 64;
+    }
+
+    MirrorScores::MirrorScores(std::filesystem::path path) : m_path(std::move(path))
+    {
+        Load();
+    }
+
+    MirrorScores& MirrorScores::Instance()
+    {
+        static MirrorScores s_instance{ Runtime::GetPathTo(Runtime::PathName::LocalState) / s_MirrorScores_FileName };
+        return s_instance;
+    }
+
+    std::string MirrorScores::GetHost(std::string_view url)
+    {
+        size_t start = url.find("://"sv);
+        if (start == std::string_view::npos)
+        {
+            return {};
+        }
+        start += 3;
+
+        size_t end = url.find_first_of("/?#"sv, start);
+        std::string_view authority = url.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+
+        // Any credentials are not part of the host
+        size_t credentials = authority.rfind('@');
+        if (credentials != std::string_view::npos)
+        {
+            authority = authority.substr(credentials + 1);
+        }
+
+        return ToLower(authority);
+    }
+
+    std::optional<double> MirrorScores::GetScore(std::string_view url) const
+    {
+        std::string host = GetHost(url);
+
+        std::lock_guard<std::mutex> lock{ m_lock };
+        auto itr = m_scores.find(host);
+        if (itr == m_scores.end())
+        {
+            return {};
+        }
+
+        return itr->second.BytesPerSecond;
+    }
+
+    std::vector<std::string> MirrorScores::Order(const std::vector<std::string>& urls) const
+    {
+        std::vector<std::pair<std::string, std::optional<double>>> scored;
+        for (const auto& url : urls)
+        {
+            scored.emplace_back(url, GetScore(url));
+        }
+
+        std::stable_sort(scored.begin(), scored.end(), [](const auto& a, const auto& b)
+            {
+                return a.second.has_value() && (!b.second.has_value() || a.second.value() > b.second.value());
+            });
+
+        std::vector<std::string> result;
+        for (auto& entry : scored)
+        {
+            result.emplace_back(std::move(entry.first));
+        }
+
+        return result;
+    }
+
+    void MirrorScores::Record(std::string_view url, uint64_t bytes, std::chrono::microseconds duration)
+    {
+        std::string host = GetHost(url);
+        if (host.empty() || bytes == 0 || duration < s_MirrorScores_MinimumDuration)
+        {
+            return;
+        }
+
+        double bytesPerSecond = static_cast<double>(bytes) * 1000000 / static_cast<double>(duration.count());
+
+        std::lock_guard<std::mutex> lock{ m_lock };
+
+        auto [itr, added] = m_scores.emplace(host, Score{ bytesPerSecond });
+        if (!added)
+        {
+            itr->second.BytesPerSecond = itr->second.BytesPerSecond * (1 - s_MirrorScores_NewestWeight) + bytesPerSecond * s_MirrorScores_NewestWeight;
+        }
+        itr->second.LastRecorded = GetCurrentUnixEpoch();
+
+        AICLI_LOG(Core, Verbose, << "Mirror score of " << host << " is now " << static_cast<uint64_t>(itr->second.BytesPerSecond) << " bytes per second");
+
+        while (m_scores.size() > s_MirrorScores_MaximumHosts)
+        {
+            auto oldest = std::min_element(m_scores.begin(), m_scores.end(), [](const auto& a, const auto& b)
+                {
+                    return a.second.LastRecorded < b.second.LastRecorded;
+                });
+            m_scores.erase(oldest);
+        }
+
+        // The scores only order the mirrors, so failing to keep them does not fail the download
+        try
+        {
+            Save();
+        }
+        CATCH_LOG();
+    }
+
+    void MirrorScores::Load()
+    {
+        if (!std::filesystem::exists(m_path))
+        {
+            return;
+        }
+
+        try
+        {
+            YAML::Node document = YAML::Load(m_path);
+
+            for (const auto& entry : document[s_MirrorScores_Hosts].Sequence())
+            {
+                Score& score = m_scores[entry[s_MirrorScores_Host].as<std::string>()];
+                score.BytesPerSecond = static_cast<double>(entry[s_MirrorScores_BytesPerSecond].as<int64_t>());
+                score.LastRecorded = entry[s_MirrorScores_LastRecorded].as<int64_t>();
+            }
+        }
+        catch (...)
+        {
+            AICLI_LOG(Core, Info, << "Mirror scores could not be read, they will be ignored: " << m_path);
+            m_scores.clear();
+        }
+    }
+
+    void MirrorScores::Save() const
+    {
+        YAML::Emitter out;
+        out << YAML::BeginMap;
+        out << YAML::Key << s_MirrorScores_Hosts;
+        out << YAML::BeginSeq;
+        for (const auto& score : m_scores)
+        {
+            out << YAML::BeginMap;
+            out << YAML::Key << s_MirrorScores_Host << YAML::Value << score.first;
+            out << YAML::Key << s_MirrorScores_BytesPerSecond << YAML::Value << static_cast<int64_t>(score.second.BytesPerSecond);
+            out << YAML::Key << s_MirrorScores_LastRecorded << YAML::Value << score.second.LastRecorded;
+            out << YAML::EndMap;
+        }
+        out << YAML::EndSeq;
+        out << YAML::EndMap;
+
+        std::filesystem::create_directories(m_path.parent_path());
+        std::ofstream stream(m_path, std::ofstream::binary | std::ofstream::trunc);
+        stream << out.str();
+    }
+}
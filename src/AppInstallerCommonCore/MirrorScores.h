@@ -0,0 +1,53 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AppInstaller::Utility
+{
+    // The throughput that downloads have seen from each host, kept between runs so that the mirror that was fastest
+    // before is given the head start when the mirrors of a download are raced.
+    // The scores are a moving average, so that a host that became slow, or fast, is ranked by its recent downloads.
+    // Only the hosts downloaded from most recently are kept, so that the file does not grow without bound.
+    struct MirrorScores
+    {
+        // The scores are read from, and written to, the given file.
+        MirrorScores(std::filesystem::path path);
+
+        // Gets the scores of the process, which are kept in the local state.
+        static MirrorScores& Instance();
+
+        // Gets the host of the url, with its port, as the scores are kept; empty if the url has none.
+        static std::string GetHost(std::string_view url);
+
+        // Gets the bytes per second seen from the host of the url, if there have been downloads from it.
+        std::optional<double> GetScore(std::string_view url) const;
+
+        // Orders the urls from the highest score to the lowest; those of hosts without a score follow in the order given.
+        std::vector<std::string> Order(const std::vector<std::string>& urls) const;
+
+        // Records a download from the url, and saves the scores.
+        void Record(std::string_view url, uint64_t bytes, std::chrono::microseconds duration);
+
+    private:
+        struct Score
+        {
+            double BytesPerSecond = 0;
+            int64_t LastRecorded = 0;
+        };
+
+        void Load();
+        void Save() const;
+
+        std::filesystem::path m_path;
+        mutable std::mutex m_lock;
+        std::map<std::string, Score> m_scores;
+    };
+}
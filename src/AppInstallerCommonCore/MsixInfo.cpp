@@ -11,11 +11,44 @@
 using namespace winrt::Windows::Storage::Streams;
 using namespace Microsoft::WRL;
 using namespace AppInstaller::Utility::HttpStream;
+using namespace std::string_view_literals;
 
 namespace AppInstaller::Msix
 {
     namespace
     {
+        bool IsInMultithreadedApartment()
+        {
+            APTTYPE type = APTTYPE_CURRENT;
+            APTTYPEQUALIFIER qualifier = APTTYPEQUALIFIER_NONE;
+            return SUCCEEDED(CoGetApartmentType(&type, &qualifier)) && type == APTTYPE_MTA;
+        }
+
+        template <typename Factory>
+        ComPtr<Factory> CreateFactory(REFCLSID clsid)
+        {
+            ComPtr<Factory> result;
+            THROW_IF_FAILED(CoCreateInstance(clsid, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&result)));
+            return result;
+        }
+
+        // Gets a factory of the class. A caller in the multithreaded apartment, as every thread of winget is, shares a single
+        // factory with the rest of the process, created by the first of them; it is never released, as COM may already be
+        // uninitialized when static objects are destroyed. A caller in a single-threaded apartment cannot call an object of
+        // another apartment directly, so it gets a factory of its own.
+        template <typename Factory>
+        ComPtr<Factory> GetFactory(REFCLSID clsid)
+        {
+            if (!IsInMultithreadedApartment())
+            {
+                return CreateFactory<Factory>(clsid);
+            }
+
+            // A failure leaves the static uninitialized, so the next caller tries again
+            static Factory* s_factory = CreateFactory<Factory>(clsid).Detach();
+            return s_factory;
+        }
+
         // Gets the version from the manifest reader.
         UINT64 GetVersionFromManifestReader(IAppxManifestReader* reader)
         {
@@ -40,30 +73,55 @@ namespace AppInstaller::Msix
         }
 
         // Writes the stream (from current location) to the given file.
+        // Each block is written while the next one is read, so that the copy takes about as long as the slower of the two.
         void WriteStreamToFile(IStream* stream, UINT64 expectedSize, const std::filesystem::path& target, IProgressCallback& progress)
         {
             std::filesystem::path tempFile = target;
             tempFile += ".dnld";
 
             {
-                std::ofstream file(tempFile, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
-
                 constexpr ULONG bufferSize = 1 << 20;
-                std::unique_ptr<char[]> buffer = std::make_unique<char[]>(bufferSize);
+                std::unique_ptr<char[]> buffers[2] = { std::make_unique<char[]>(bufferSize), std::make_unique<char[]>(bufferSize) };
+                size_t currentBuffer = 0;
+
+                // The blocks are already large, so the file writes them through without buffering them again
+                std::ofstream file;
+                file.rdbuf()->pubsetbuf(nullptr, 0);
+                file.open(tempFile, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_OPEN_FAILED), file.fail());
+
+                // Declared after the file, so that a write still in progress is waited for before the file is closed
+                std::future<void> pendingWrite;
+                auto waitForPendingWrite = [&]()
+                {
+                    if (pendingWrite.valid())
+                    {
+                        pendingWrite.get();
+                    }
+                };
 
                 UINT64 totalBytesRead = 0;
 
                 while (!progress.IsCancelled())
                 {
+                    char* buffer = buffers[currentBuffer].get();
                     ULONG bytesRead = 0;
-                    HRESULT hr = stream->Read(buffer.get(), bufferSize, &bytesRead);
+                    HRESULT hr = stream->Read(buffer, bufferSize, &bytesRead);
 
                     if (bytesRead)
                     {
                         // If we got bytes, just accept them and keep going.
                         LOG_IF_FAILED(hr);
 
-                        file.write(buffer.get(), bytesRead);
+                        // Only the previous block can still be being written, and it is in the other buffer
+                        waitForPendingWrite();
+                        pendingWrite = std::async(std::launch::async, [&file, buffer, bytesRead]()
+                            {
+                                file.write(buffer, bytesRead);
+                                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_WRITE_FAULT), file.fail());
+                            });
+                        currentBuffer = 1 - currentBuffer;
+
                         totalBytesRead += bytesRead;
                         progress.OnProgress(totalBytesRead, expectedSize, ProgressType::Bytes);
                     }
@@ -90,6 +148,8 @@ namespace AppInstaller::Msix
                         }
                     }
                 }
+
+                waitForPendingWrite();
             }
 
             std::filesystem::path backupFile = target;
@@ -117,21 +177,214 @@ namespace AppInstaller::Msix
 
             WriteStreamToFile(stream.Get(), size, target, progress);
         }
+
+        // Creates a stream over the package at the given uri; a remote package is read with range requests.
+        ComPtr<IStream> CreateStreamFromUri(std::string_view uriStr)
+        {
+            ComPtr<IStream> result;
+
+            if (Utility::IsUrlRemote(uriStr))
+            {
+                winrt::Windows::Foundation::Uri uri(Utility::ConvertToUTF16(uriStr));
+                IRandomAccessStream randomAccessStream = HttpRandomAccessStream::CreateAsync(uri).get();
+
+                ::IUnknown* rasAsIUnknown = (::IUnknown*)winrt::get_abi(randomAccessStream);
+                THROW_IF_FAILED(CreateStreamOverRandomAccessStream(
+                    rasAsIUnknown,
+                    IID_PPV_ARGS(result.ReleaseAndGetAddressOf())));
+            }
+            else
+            {
+                std::filesystem::path path(Utility::ConvertToUTF16(uriStr));
+                THROW_IF_FAILED(SHCreateStreamOnFileEx(path.c_str(),
+                    STGM_READ | STGM_SHARE_DENY_WRITE | STGM_FAILIFTHERE, 0, FALSE, nullptr, &result));
+            }
+
+            return result;
+        }
+
+        // The records of the zip format that packages and bundles are written in, as far as they are needed to find a file.
+        constexpr UINT32 s_ZipEndOfCentralDirectorySignature = 0x06054b50;
+        constexpr ULONG s_ZipEndOfCentralDirectorySize = 22;
+        constexpr ULONG s_ZipMaxCommentSize = 0xFFFF;
+        constexpr UINT32 s_Zip64EndOfCentralDirectoryLocatorSignature = 0x07064b50;
+        constexpr ULONG s_Zip64EndOfCentralDirectoryLocatorSize = 20;
+        constexpr UINT32 s_Zip64EndOfCentralDirectorySignature = 0x06064b50;
+        constexpr ULONG s_Zip64EndOfCentralDirectorySize = 56;
+        constexpr UINT32 s_ZipCentralDirectoryHeaderSignature = 0x02014b50;
+        constexpr ULONG s_ZipCentralDirectoryHeaderSize = 46;
+        constexpr UINT32 s_ZipLocalFileHeaderSignature = 0x04034b50;
+        constexpr ULONG s_ZipLocalFileHeaderSize = 30;
+        constexpr UINT16 s_Zip64ExtraFieldId = 0x0001;
+        constexpr UINT16 s_ZipStoredMethod = 0;
+
+        // Larger central directories (or signatures) are left to the package readers rather than read at once.
+        constexpr UINT64 s_ZipMaxCentralDirectorySize = 16 << 20;
+        constexpr UINT64 s_ZipMaxSignatureSize = 1 << 20;
+
+        constexpr std::string_view s_SignatureFileName = "AppxSignature.p7x"sv;
+
+        // Reads the given range of the stream, failing if it is not all there.
+        std::vector<byte> ReadStreamRange(IStream* stream, UINT64 offset, ULONG size)
+        {
+            LARGE_INTEGER position{};
+            position.QuadPart = static_cast<LONGLONG>(offset);
+            THROW_IF_FAILED(stream->Seek(position, STREAM_SEEK_SET, nullptr));
+
+            std::vector<byte> result(size);
+            ULONG totalBytesRead = 0;
+
+            while (totalBytesRead < size)
+            {
+                ULONG bytesRead = 0;
+                THROW_IF_FAILED(stream->Read(result.data() + totalBytesRead, size - totalBytesRead, &bytesRead));
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_HANDLE_EOF), bytesRead == 0);
+                totalBytesRead += bytesRead;
+            }
+
+            return result;
+        }
+
+        // Reads a little endian value from the buffer.
+        template <typename T>
+        T ReadZipValue(const std::vector<byte>& buffer, size_t offset)
+        {
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), offset > buffer.size() || buffer.size() - offset < sizeof(T));
+
+            T result = 0;
+            for (size_t i = 0; i < sizeof(T); ++i)
+            {
+                result |= static_cast<T>(buffer[offset + i]) << (8 * i);
+            }
+
+            return result;
+        }
+
+        // Reads the content of the file at the root of the zip archive in the stream, using only the central directory and
+        // the file itself. Returns an empty optional if the file is not stored uncompressed, or is not found.
+        std::optional<std::vector<byte>> TryReadStoredZipFile(IStream* stream, std::string_view fileName)
+        {
+            STATSTG stat = { 0 };
+            THROW_IF_FAILED(stream->Stat(&stat, STATFLAG_NONAME));
+            UINT64 streamSize = stat.cbSize.QuadPart;
+
+            if (streamSize < s_ZipEndOfCentralDirectorySize)
+            {
+                return {};
+            }
+
+            // The end of central directory record is followed only by the archive comment
+            ULONG tailSize = static_cast<ULONG>(std::min<UINT64>(streamSize,
+                s_ZipEndOfCentralDirectorySize + s_ZipMaxCommentSize + s_Zip64EndOfCentralDirectoryLocatorSize));
+            UINT64 tailOffset = streamSize - tailSize;
+            std::vector<byte> tail = ReadStreamRange(stream, tailOffset, tailSize);
+
+            size_t endRecord = tailSize - s_ZipEndOfCentralDirectorySize;
+            while (ReadZipValue<UINT32>(tail, endRecord) != s_ZipEndOfCentralDirectorySignature)
+            {
+                if (endRecord == 0)
+                {
+                    return {};
+                }
+
+                --endRecord;
+            }
+
+            UINT64 entryCount = ReadZipValue<UINT16>(tail, endRecord + 10);
+            UINT64 directorySize = ReadZipValue<UINT32>(tail, endRecord + 12);
+            UINT64 directoryOffset = ReadZipValue<UINT32>(tail, endRecord + 16);
+
+            if (endRecord >= s_Zip64EndOfCentralDirectoryLocatorSize &&
+                ReadZipValue<UINT32>(tail, endRecord - s_Zip64EndOfCentralDirectoryLocatorSize) == s_Zip64EndOfCentralDirectoryLocatorSignature)
+            {
+                UINT64 zip64RecordOffset = ReadZipValue<UINT64>(tail, endRecord - s_Zip64EndOfCentralDirectoryLocatorSize + 8);
+                std::vector<byte> zip64Record = ReadStreamRange(stream, zip64RecordOffset, s_Zip64EndOfCentralDirectorySize);
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), ReadZipValue<UINT32>(zip64Record, 0) != s_Zip64EndOfCentralDirectorySignature);
+
+                entryCount = ReadZipValue<UINT64>(zip64Record, 32);
+                directorySize = ReadZipValue<UINT64>(zip64Record, 40);
+                directoryOffset = ReadZipValue<UINT64>(zip64Record, 48);
+            }
+
+            if (directorySize > s_ZipMaxCentralDirectorySize || directoryOffset > streamSize || streamSize - directoryOffset < directorySize)
+            {
+                return {};
+            }
+
+            std::vector<byte> directory = ReadStreamRange(stream, directoryOffset, static_cast<ULONG>(directorySize));
+
+            size_t header = 0;
+            for (UINT64 i = 0; i < entryCount; ++i)
+            {
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), ReadZipValue<UINT32>(directory, header) != s_ZipCentralDirectoryHeaderSignature);
+
+                UINT16 method = ReadZipValue<UINT16>(directory, header + 10);
+                UINT64 compressedSize = ReadZipValue<UINT32>(directory, header + 20);
+                UINT64 uncompressedSize = ReadZipValue<UINT32>(directory, header + 24);
+                UINT16 nameLength = ReadZipValue<UINT16>(directory, header + 28);
+                UINT16 extraLength = ReadZipValue<UINT16>(directory, header + 30);
+                UINT16 commentLength = ReadZipValue<UINT16>(directory, header + 32);
+                UINT64 localHeaderOffset = ReadZipValue<UINT32>(directory, header + 42);
+
+                size_t name = header + s_ZipCentralDirectoryHeaderSize;
+                size_t extra = name + nameLength;
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), directory.size() < extra + extraLength);
+
+                if (std::string_view{ reinterpret_cast<const char*>(&directory[name]), nameLength } == fileName)
+                {
+                    if (method != s_ZipStoredMethod)
+                    {
+                        return {};
+                    }
+
+                    // The values that do not fit in the header are in the zip64 extra field, in this order
+                    for (size_t field = extra; field + 4 <= extra + extraLength;)
+                    {
+                        UINT16 fieldId = ReadZipValue<UINT16>(directory, field);
+                        UINT16 fieldSize = ReadZipValue<UINT16>(directory, field + 2);
+
+                        if (fieldId == s_Zip64ExtraFieldId)
+                        {
+                            size_t value = field + 4;
+                            for (UINT64* target : { &uncompressedSize, &compressedSize, &localHeaderOffset })
+                            {
+                                if (*target == 0xFFFFFFFF)
+                                {
+                                    *target = ReadZipValue<UINT64>(directory, value);
+                                    value += sizeof(UINT64);
+                                }
+                            }
+                        }
+
+                        field += 4 + fieldSize;
+                    }
+
+                    if (compressedSize != uncompressedSize || compressedSize > s_ZipMaxSignatureSize)
+                    {
+                        return {};
+                    }
+
+                    std::vector<byte> localHeader = ReadStreamRange(stream, localHeaderOffset, s_ZipLocalFileHeaderSize);
+                    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), ReadZipValue<UINT32>(localHeader, 0) != s_ZipLocalFileHeaderSignature);
+
+                    UINT64 dataOffset = localHeaderOffset + s_ZipLocalFileHeaderSize +
+                        ReadZipValue<UINT16>(localHeader, 26) + ReadZipValue<UINT16>(localHeader, 28);
+
+                    return ReadStreamRange(stream, dataOffset, static_cast<ULONG>(compressedSize));
+                }
+
+                header = extra + extraLength + commentLength;
+            }
+
+            return {};
+        }
     }
 
     bool GetBundleReader(
         IStream* inputStream,
         IAppxBundleReader** reader)
     {
-        ComPtr<IAppxBundleFactory> bundleFactory;
-
-        // Create a new Appxbundle factory
-        THROW_IF_FAILED(CoCreateInstance(
-            __uuidof(AppxBundleFactory),
-            nullptr,
-            CLSCTX_INPROC_SERVER,
-            __uuidof(IAppxBundleFactory),
-            (LPVOID*)(&bundleFactory)));
+        ComPtr<IAppxBundleFactory> bundleFactory = GetFactory<IAppxBundleFactory>(__uuidof(AppxBundleFactory));
 
         HRESULT hr = bundleFactory->CreateBundleReader(inputStream, reader);
 
@@ -155,15 +408,7 @@ namespace AppInstaller::Msix
         IStream* inputStream,
         IAppxPackageReader** reader)
     {
-        ComPtr<IAppxFactory> appxFactory;
-
-        // Create a new Appx factory
-        THROW_IF_FAILED(CoCreateInstance(
-            __uuidof(AppxFactory),
-            nullptr,
-            CLSCTX_INPROC_SERVER,
-            __uuidof(IAppxFactory),
-            (LPVOID*)(&appxFactory)));
+        ComPtr<IAppxFactory> appxFactory = GetFactory<IAppxFactory>(__uuidof(AppxFactory));
 
         // Create a new package reader using the factory.
         HRESULT hr = appxFactory->CreatePackageReader(inputStream, reader);
@@ -188,14 +433,7 @@ namespace AppInstaller::Msix
         IStream* inputStream,
         IAppxManifestReader** reader)
     {
-        ComPtr<IAppxFactory> appxFactory;
-
-        THROW_IF_FAILED(CoCreateInstance(
-            __uuidof(AppxFactory),
-            nullptr,
-            CLSCTX_INPROC_SERVER,
-            __uuidof(IAppxFactory),
-            (LPVOID*)(&appxFactory)));
+        ComPtr<IAppxFactory> appxFactory = GetFactory<IAppxFactory>(__uuidof(AppxFactory));
 
         THROW_IF_FAILED(appxFactory->CreateManifestReader(inputStream, reader));
     }
@@ -278,26 +516,25 @@ namespace AppInstaller::Msix
         return { result };
     }
 
-    MsixInfo::MsixInfo(std::string_view uriStr)
+    std::vector<byte> GetPackageSignature(std::string_view uriStr)
     {
-        if (Utility::IsUrlRemote(uriStr))
-        {
-            // Get an IStream from the input uri and try to create package or bundler reader.
-            winrt::Windows::Foundation::Uri uri(Utility::ConvertToUTF16(uriStr));
-            IRandomAccessStream randomAccessStream = HttpRandomAccessStream::CreateAsync(uri).get();
+        ComPtr<IStream> stream = CreateStreamFromUri(uriStr);
 
-            ::IUnknown* rasAsIUnknown = (::IUnknown*)winrt::get_abi(randomAccessStream);
-            THROW_IF_FAILED(CreateStreamOverRandomAccessStream(
-                rasAsIUnknown,
-                IID_PPV_ARGS(m_stream.ReleaseAndGetAddressOf())));
-        }
-        else
+        std::optional<std::vector<byte>> signature = TryReadStoredZipFile(stream.Get(), s_SignatureFileName);
+        if (signature)
         {
-            std::filesystem::path path(Utility::ConvertToUTF16(uriStr));
-            THROW_IF_FAILED(SHCreateStreamOnFileEx(path.c_str(),
-                STGM_READ | STGM_SHARE_DENY_WRITE | STGM_FAILIFTHERE, 0, FALSE, nullptr, &m_stream));
+            return std::move(signature).value();
         }
 
+        AICLI_LOG(Core, Info, << "Signature is not stored uncompressed, opening the package to read it");
+        return MsixInfo{ uriStr }.GetSignature();
+    }
+
+    MsixInfo::MsixInfo(std::string_view uriStr)
+    {
+        // Get an IStream from the input uri and try to create package or bundler reader.
+        m_stream = CreateStreamFromUri(uriStr);
+
         if (GetBundleReader(m_stream.Get(), &m_bundleReader))
         {
             m_isBundle = true;
@@ -394,6 +631,21 @@ namespace AppInstaller::Msix
         return (GetVersionFromManifestReader(manifestReader.Get()) > GetVersionFromVersion(otherVersion));
     }
 
+    bool MsixInfo::ContainsFile(std::string_view packageFile)
+    {
+        std::wstring fileUTF16 = Utility::ConvertToUTF16(packageFile);
+
+        ComPtr<IAppxFile> appxFile;
+        if (m_isBundle)
+        {
+            return SUCCEEDED(m_bundleReader->GetPayloadPackage(fileUTF16.c_str(), &appxFile));
+        }
+        else
+        {
+            return SUCCEEDED(m_packageReader->GetPayloadFile(fileUTF16.c_str(), &appxFile));
+        }
+    }
+
     void MsixInfo::WriteToFile(std::string_view packageFile, const std::filesystem::path& target, IProgressCallback& progress)
     {
         std::wstring fileUTF16 = Utility::ConvertToUTF16(packageFile);
@@ -7,6 +7,10 @@
 
 namespace AppInstaller::Deployment
 {
+    // Gets the PackageManager shared by the process. It is agile, so it can be used from any thread and apartment,
+    // and any number of its operations can be in progress at once; each waits for its own result.
+    winrt::Windows::Management::Deployment::PackageManager GetPackageManager();
+
     // Calls winrt::Windows::Management::Deployment::PackageManager::RequestAddPackageAsync
     void RequestAddPackage(
         const winrt::Windows::Foundation::Uri& uri, 
@@ -12,25 +12,82 @@
 
 namespace AppInstaller::Utility
 {
+    // The kinds of files that are downloaded; the backend that downloads a file, and its priority, depend on its kind.
+    enum class DownloadType
+    {
+        // An installer, which is downloaded with the backend chosen by the network.downloader setting.
+        Installer,
+        // A source index, which changes in place at the same url, so it is always downloaded from the server.
+        Index,
+        // A file downloaded by a caller of WinGetUtil, which has no user settings.
+        WinGetUtil,
+        // A manifest, which is needed before the package can be shown or installed.
+        Manifest,
+    };
+
     // Downloads a file from the given URL and places it in the given location.
     //   url: The url to be downloaded from. http->https redirection is allowed.
     //   dest: The stream to be downloaded to.
+    //   type: The kind of file; source indexes yield the bandwidth to the other downloads of the process.
     //   computeHash: Optional. Indicates if SHA256 hash should be calculated when downloading.
     std::optional<std::vector<BYTE>> DownloadToStream(
         const std::string& url,
         std::ostream& dest,
+        DownloadType type,
+        IProgressCallback& progress,
+        bool computeHash = false);
+
+    // Downloads a file from the first of the given URLs to respond, and places it in the given location.
+    //   urls: The url to be downloaded from, followed by mirrors that serve the same content. The mirrors are raced, each
+    //         starting a moment after the one before, and the first to respond is used; it fails over to the next when the
+    //         download stops. The hosts that were fastest before are raced first.
+    std::optional<std::vector<BYTE>> DownloadToStream(
+        const std::vector<std::string>& urls,
+        std::ostream& dest,
+        DownloadType type,
         IProgressCallback& progress,
         bool computeHash = false);
 
     // Downloads a file from the given URL and places it in the given location.
-    //   url: The url to be downloaded from. http->https redirection is allowed.
+    //   url: The url to be downloaded from. http->https redirection is allowed. A local or UNC file path is copied instead.
     //   dest: The path to local file to be downloaded to.
+    //   type: The kind of file; installers can be downloaded with Delivery Optimization, which falls back to WinINet when it fails.
     //   computeHash: Optional. Indicates if SHA256 hash should be calculated when downloading.
+    //   hashChunkSize: Optional. When not zero, the hash is the chunked hash of the content in chunks of this size (see ChunkedSHA256);
+    //                  the chunks of a download with range requests are hashed as they arrive, and those of a resumed download are kept.
     std::optional<std::vector<BYTE>> Download(
         const std::string& url,
         const std::filesystem::path& dest,
+        DownloadType type,
         IProgressCallback& progress,
-        bool computeHash = false);
+        bool computeHash = false,
+        uint64_t hashChunkSize = 0);
+
+    // Downloads a file from the first of the given URLs to respond, and places it in the given location.
+    //   urls: The url to be downloaded from, followed by mirrors that serve the same content; see DownloadToStream.
+    //         With range requests, each segment fails over to the next mirror on its own, resuming where it stopped.
+    //         The content of a mirror is only checked to have the same size, so it must be verified by its hash or signature.
+    std::optional<std::vector<BYTE>> Download(
+        const std::vector<std::string>& urls,
+        const std::filesystem::path& dest,
+        DownloadType type,
+        IProgressCallback& progress,
+        bool computeHash = false,
+        uint64_t hashChunkSize = 0);
+
+    // The values of the ETag and Last-Modified headers, which identify the content of a remote resource.
+    struct ResourceValidators
+    {
+        std::string ETag;
+        std::string LastModified;
+
+        bool IsEmpty() const { return ETag.empty() && LastModified.empty(); }
+    };
+
+    // Sends a single request for the given URL, conditional on the resource having changed from the given validators.
+    // Only the response headers are read. Returns the current validators of the resource, or an empty optional if
+    // the server reports that it has not been modified. Empty validators make the request unconditional.
+    std::optional<ResourceValidators> GetResourceValidatorsIfModified(const std::string& url, const ResourceValidators& previous);
 
     // Determines if the given url is a remote location.
     bool IsUrlRemote(std::string_view url);
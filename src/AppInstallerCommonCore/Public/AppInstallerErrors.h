@@ -55,6 +55,9 @@
 #define APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_WARNING      ((HRESULT)0x8A150028)
 #define APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_FAILURE      ((HRESULT)0x8A150029)
 #define APPINSTALLER_CLI_ERROR_INVALID_MANIFEST                 ((HRESULT)0x8A15002A)
+#define APPINSTALLER_CLI_ERROR_INDEX_DELTA_MISMATCH             ((HRESULT)0x8A15002B)
+#define APPINSTALLER_CLI_ERROR_MULTIPLE_INSTALL_FAILED          ((HRESULT)0x8A15002C)
+#define APPINSTALLER_CLI_ERROR_RESTSOURCE_INVALID_RESPONSE      ((HRESULT)0x8A15002D)
 
 namespace AppInstaller
 {
@@ -2,16 +2,33 @@
 // Licensed under the MIT License.
 #pragma once
 #include <AppInstallerLogging.h>
+#include <wil/resource.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 namespace AppInstaller::Logging
 {
     // Logs to a file.
+    // Log lines are placed in a bounded ring by the callers and written to the file in batches by a background thread,
+    // so that logging never waits on the disk. The lines are written when the logger is destroyed, when a critical
+    // line is logged, and periodically otherwise; the logger must be destroyed before the module is unloaded.
+    // The thread is started and the file is created by the first line, so a logger that is never written to costs nothing.
     struct FileLogger : public ILogger
     {
+        // The number of log lines that can be waiting to be written; callers wait for space when the ring is full.
+        static constexpr size_t RingSize = 1024;
+
+        // The longest that a log line waits before it is written.
+        static constexpr std::chrono::milliseconds WriteInterval = std::chrono::milliseconds(200);
+
         FileLogger(const std::filesystem::path& filePath = {});
 
         ~FileLogger();
@@ -19,8 +36,9 @@ namespace AppInstaller::Logging
         FileLogger(const FileLogger&) = delete;
         FileLogger& operator=(const FileLogger&) = delete;
 
-        FileLogger(FileLogger&&) = default;
-        FileLogger& operator=(FileLogger&&) = default;
+        // The background thread refers to the logger, so it cannot be moved.
+        FileLogger(FileLogger&&) = delete;
+        FileLogger& operator=(FileLogger&&) = delete;
 
         static std::string GetNameForPath(const std::filesystem::path& filePath);
 
@@ -29,12 +47,53 @@ namespace AppInstaller::Logging
 
         virtual void Write(Channel channel, Level level, std::string_view message) noexcept override;
 
+        // Waits until every line logged before the call has been written to the file.
+        void Flush() noexcept;
+
         // Starts a background task to clean up old log files.
-        static void BeginCleanup(const std::filesystem::path& filePath);
+        // An empty path cleans up the default log location, which is found by the task rather than the caller.
+        static void BeginCleanup(const std::filesystem::path& filePath = {});
+
+        // Removes the log files in the directory that are older than 7 days, unless a pass completed there within the last day.
+        // A pass removes a limited number of files, leaving the rest to the next one; returns true if the pass completed.
+        static bool Cleanup(const std::filesystem::path& directory);
 
     private:
+        // A log line in the ring. The sequence tells whether the slot is free or holds a line that has not been written,
+        // for the position in the ring that the slot is currently used for.
+        struct Record
+        {
+            std::atomic<size_t> Sequence{ 0 };
+            std::chrono::system_clock::time_point Time;
+            Channel LogChannel = Channel::All;
+            std::string Message;
+        };
+
+        // Writes the lines in the ring to the file on the background thread until the logger is destroyed.
+        void WriteInBackground();
+
+        // Writes the lines in the ring to the file, in order, up to the first one that is not complete.
+        // Opens the file if there are lines to write. Must only be called by one thread at a time.
+        void WriteRecords();
+
         std::string m_name;
         std::filesystem::path m_filePath;
+        std::string m_defaultFileName;
         std::ofstream m_stream;
+
+        std::unique_ptr<Record[]> m_ring;
+        std::atomic<size_t> m_enqueuePosition{ 0 };
+        size_t m_dequeuePosition = 0;
+
+        std::atomic<bool> m_stopping{ false };
+        wil::unique_event m_wake;
+
+        // The position up to which the lines have been written, for the callers waiting in Flush.
+        std::mutex m_writtenLock;
+        std::condition_variable m_writtenChanged;
+        size_t m_writtenPosition = 0;
+
+        std::once_flag m_writerStarted;
+        std::thread m_writer;
     };
 }
@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AppInstaller::Inventory
+{
+    // The places that installed entries are read from.
+    enum class EntryLocation : int32_t
+    {
+        // The Add/Remove Programs entries of the machine, in the native registry view.
+        ArpMachineNative = 0,
+        // The Add/Remove Programs entries of the machine, in the 32-bit registry view of a 64-bit system.
+        ArpMachineX86 = 1,
+        // The Add/Remove Programs entries of the current user.
+        ArpUser = 2,
+        // The MSIX packages registered for the current user.
+        Msix = 3,
+    };
+
+    std::string_view ToString(EntryLocation location);
+
+    // An entry for something installed on the machine.
+    struct InstalledEntry
+    {
+        EntryLocation Location = EntryLocation::ArpMachineNative;
+
+        // Identifies the entry within its location: the name of the ARP subkey, which is the product code of an MSI,
+        // or the package full name of an MSIX package.
+        std::string Key;
+
+        // The name and version that are shown for the entry; for an MSIX package, the name from its identity.
+        std::string Name;
+        std::string Version;
+        std::string Publisher;
+
+        // The package family name of an MSIX package; empty for an ARP entry.
+        std::string FamilyName;
+    };
+
+    // A subkey of an ARP location, with the time that it was last written.
+    struct ArpKeyStamp
+    {
+        std::string Key;
+        int64_t LastWriteTime = 0;
+    };
+
+    // Gets the ARP locations of this system; on a 32-bit system there is no separate 32-bit view.
+    std::vector<EntryLocation> GetArpLocations();
+
+    // Gets the subkeys of the ARP location with the times that they were last written, without reading their values.
+    // A subkey is written whenever its entry changes, so only the entries whose time changed need to be read again.
+    // Returns nothing if the location does not exist.
+    std::vector<ArpKeyStamp> GetArpKeyStamps(EntryLocation location);
+
+    // Reads the ARP entry from the subkey of the location.
+    // Returns an empty value if the subkey no longer exists, or is not shown in Add/Remove Programs,
+    // such as a system component or an update of another entry.
+    std::optional<InstalledEntry> ReadArpEntry(EntryLocation location, std::string_view key);
+
+    // Gets a value that changes whenever an MSIX package is registered or removed for the current user,
+    // so that the packages need only be enumerated again when it has changed.
+    int64_t GetMsixStamp();
+
+    // Reads the main MSIX packages registered for the current user; frameworks and resource packages are not included.
+    std::vector<InstalledEntry> ReadMsixEntries();
+}
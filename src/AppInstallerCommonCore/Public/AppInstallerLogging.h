@@ -10,16 +10,27 @@
 #include <string_view>
 #include <vector>
 
+// The lowest level of the logs that are compiled in; logs below it are removed at compile time, along with the
+// formatting of their messages. Define it as the name of a Level, such as Info, to remove the verbose logs from a build.
+#ifndef AICLI_LOG_MINIMUM_LEVEL
+#define AICLI_LOG_MINIMUM_LEVEL Verbose
+#endif
+
+// The message is only formatted when the channel and level are enabled, so the arguments cost nothing otherwise.
 #define AICLI_LOG(_channel_,_level_,_outstream_) \
     do { \
-        auto _aicli_log_channel = AppInstaller::Logging::Channel:: _channel_; \
-        auto _aicli_log_level = AppInstaller::Logging::Level:: _level_; \
-        auto& _aicli_log_log = AppInstaller::Logging::Log(); \
-        if (_aicli_log_log.IsEnabled(_aicli_log_channel, _aicli_log_level)) \
+        if constexpr (AppInstaller::Logging::IsLevelCompiled(AppInstaller::Logging::Level:: _level_)) \
         { \
-            std::stringstream _aicli_log_strstr; \
-            _aicli_log_strstr _outstream_; \
-            _aicli_log_log.Write(_aicli_log_channel, _aicli_log_level, _aicli_log_strstr.str()); \
+            auto _aicli_log_channel = AppInstaller::Logging::Channel:: _channel_; \
+            auto _aicli_log_level = AppInstaller::Logging::Level:: _level_; \
+            auto& _aicli_log_log = AppInstaller::Logging::Log(); \
+            if (_aicli_log_log.IsEnabled(_aicli_log_channel, _aicli_log_level)) \
+            { \
+                AppInstaller::Logging::MessageStream _aicli_log_message; \
+                std::ostringstream& _aicli_log_strstr = _aicli_log_message.Get(); \
+                _aicli_log_strstr _outstream_; \
+                _aicli_log_log.Write(_aicli_log_channel, _aicli_log_level, _aicli_log_strstr.str()); \
+            } \
         } \
     } while (0, 0)
 
@@ -54,6 +65,33 @@ namespace AppInstaller::Logging
         Crit,
     };
 
+    // Determines whether logs of the given level are compiled in.
+    constexpr bool IsLevelCompiled(Level level)
+    {
+        return static_cast<int>(level) >= static_cast<int>(Level:: AICLI_LOG_MINIMUM_LEVEL);
+    }
+
+    // Provides the stream that a log message is formatted in.
+    // Each thread reuses its streams rather than constructing one for every message; a message that is logged
+    // while another is being formatted gets a stream of its own.
+    struct MessageStream
+    {
+        MessageStream();
+
+        ~MessageStream();
+
+        MessageStream(const MessageStream&) = delete;
+        MessageStream& operator=(const MessageStream&) = delete;
+
+        MessageStream(MessageStream&&) = delete;
+        MessageStream& operator=(MessageStream&&) = delete;
+
+        std::ostringstream& Get() { return *m_stream; }
+
+    private:
+        std::ostringstream* m_stream;
+    };
+
     // The interface that a log target must implement.
     struct ILogger
     {
@@ -42,6 +42,11 @@ namespace AppInstaller::Msix
     // Gets the package location from the given full name.
     std::optional<std::filesystem::path> GetPackageLocationFromFullName(std::string_view fullName);
 
+    // Gets the full content of AppxSignature.p7x of the package or bundle at the given uri.
+    // Only the zip directory and the signature itself are read, rather than the manifest and block map that opening a
+    // package reads first, so that verifying a remote package transfers as little of it as possible.
+    std::vector<byte> GetPackageSignature(std::string_view uriStr);
+
     // MsixInfo class handles all appx/msix related query.
     struct MsixInfo
     {
@@ -69,6 +74,9 @@ namespace AppInstaller::Msix
 
         bool IsNewerThan(const winrt::Windows::ApplicationModel::PackageVersion& otherVersion);
 
+        // Determines whether the package contains the given file.
+        bool ContainsFile(std::string_view packageFile);
+
         // Writes the package file to the given path.
         void WriteToFile(std::string_view packageFile, const std::filesystem::path& target, IProgressCallback& progress);
 
@@ -1,13 +1,16 @@
 // Copyright (c) Microsoft Corporation.
 // Licensed under the MIT License.
 #pragma once
+#include <AppInstallerArchitecture.h>
 #include <AppInstallerVersions.h>
 #include <winget/LocIndependent.h>
 
+#include <array>
 #include <filesystem>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace AppInstaller::Runtime
 {
@@ -50,4 +53,35 @@ namespace AppInstaller::Runtime
 
     // Determines whether the process is running with administrator privileges.
     bool IsRunningAsAdmin();
+
+    // The capabilities of the system that installers are matched against.
+    // They are read from the system once, the first time they are needed, as they do not change while the process runs.
+    struct SystemCapabilities
+    {
+        static constexpr size_t ArchitectureCount = static_cast<size_t>(Utility::Architecture::Arm64) + 2;
+
+        // The architectures that are applicable to the system, from the most preferred to the least.
+        std::vector<Utility::Architecture> ApplicableArchitectures;
+
+        // The priority of each architecture in the applicable list, indexed by the architecture value plus one
+        // (to include Unknown); 0 has the lowest priority and -1 is not applicable.
+        std::array<int, ArchitectureCount> ArchitecturePriorities{};
+
+        // The major, minor and build numbers of the OS.
+        std::array<DWORD, 3> OSVersion{};
+
+        bool IsRunningAsAdmin = false;
+
+        // The name of the user preferred locale.
+        std::string Locale;
+
+        // Gets the priority of the architecture, as IsApplicableArchitecture does.
+        int GetArchitecturePriority(Utility::Architecture arch) const;
+
+        // Determines whether the OS version is >= the given one, treated as a standard 4 part Windows OS version.
+        bool IsOSVersionGreaterThanOrEqual(const Utility::Version& version) const;
+    };
+
+    // Gets the capabilities of the system.
+    const SystemCapabilities& GetSystemCapabilities();
 }
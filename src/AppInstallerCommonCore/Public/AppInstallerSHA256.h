@@ -2,10 +2,12 @@
 // Licensed under the MIT License.
 #pragma once
 
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <vector>
 #include <stdexcept>
+#include <cstdint>
 
 namespace AppInstaller::Utility {
 
@@ -20,7 +22,18 @@ namespace AppInstaller::Utility {
     public:
         using HashBuffer = std::vector<uint8_t>;
 
-        SHA256();
+        // The implementation used to compute the hash.
+        enum class Implementation
+        {
+            // The hardware implementation when the processor supports it, otherwise the platform one.
+            Default,
+            // The platform's cryptographic library (BCrypt).
+            Platform,
+            // The processor's SHA instructions (SHA-NI on x86/x64, the cryptographic extension on ARM64).
+            Hardware,
+        };
+
+        SHA256(Implementation implementation = Implementation::Default);
 
         // Adds the next chunk of data to the hash.
         void Add(const uint8_t* buffer, size_t cbBuffer);
@@ -47,10 +60,16 @@ namespace AppInstaller::Utility {
         // Computes the hash from a given stream.
         static std::vector<uint8_t> ComputeHash(std::istream& in);
 
+        // Computes the hash of a file, reading it through views of a file mapping.
+        static std::vector<uint8_t> ComputeHashFromFile(const std::filesystem::path& path);
+
         static std::string ConvertToString(const HashBuffer& hashBuffer);
 
         static HashBuffer ConvertToBytes(const std::string& hashStr);
 
+        // Determines whether the processor supports the hardware implementation.
+        static bool IsHardwareImplementationSupported();
+
     private:
         void EnsureNotFinished() const;
 
@@ -61,4 +80,40 @@ namespace AppInstaller::Utility {
 
         std::unique_ptr<SHA256Context, SHA256ContextDeleter> context;
     };
+
+    // Class used to compute the chunked hash of data: the SHA256 of the SHA256s of its chunks, in order.
+    // Every chunk but the last is the chunk size; data without any chunks has the hash of no data.
+    // The chunks are hashed independently, so they can be hashed at once on different threads, or as
+    // each range of a download arrives, and a chunk that was already hashed does not need to be hashed again.
+    class ChunkedSHA256
+    {
+    public:
+        using HashBuffer = SHA256::HashBuffer;
+
+        ChunkedSHA256(uint64_t chunkSize);
+
+        // Adds the next data to the hash; the chunks are formed from the data as it is added.
+        void Add(const uint8_t* buffer, size_t cbBuffer);
+
+        // Gets the hash of the data. This is a destructive action; the accumulated hash
+        // value will be returned and the object can no longer be used.
+        HashBuffer Get();
+
+        // Combines the hashes of the chunks, in order, into the chunked hash.
+        static HashBuffer CombineChunkHashes(const std::vector<HashBuffer>& chunkHashes);
+
+        // Computes the hash of each chunk of a file that is not already in the given hashes, on as many threads
+        // as there are processors. The hashes are resized to the number of chunks; an empty one is computed.
+        static void ComputeMissingChunkHashesFromFile(const std::filesystem::path& path, uint64_t chunkSize, std::vector<HashBuffer>& chunkHashes);
+
+        // Computes the chunked hash of a file, hashing its chunks concurrently.
+        static HashBuffer ComputeHashFromFile(const std::filesystem::path& path, uint64_t chunkSize);
+
+    private:
+        uint64_t m_chunkSize;
+        uint64_t m_chunkFilled = 0;
+        std::unique_ptr<SHA256> m_chunk;
+        std::vector<HashBuffer> m_chunkHashes;
+        bool m_finished = false;
+    };
 }
\ No newline at end of file
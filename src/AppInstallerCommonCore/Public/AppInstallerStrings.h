@@ -10,9 +10,10 @@
 namespace AppInstaller::Utility
 {
     // Compares the two UTF8 strings in a case insensitive manner.
+    // ASCII is compared in place; only the parts of the strings from the first character that is not ASCII are case folded.
     bool CaseInsensitiveEquals(std::string_view a, std::string_view b);
 
-    // Determins if string a starts with string b.
+    // Determins if string a starts with string b, in a case insensitive manner.
     bool CaseInsensitiveStartsWith(std::string_view a, std::string_view b);
 
     // Converts the given UTF16 string to UTF8
@@ -27,6 +28,9 @@ namespace AppInstaller::Utility
     // Returns a substring view in an UTF8-encoded string. Offset and count are measured in grapheme clusters (characters).
     std::string_view UTF8Substring(std::string_view input, size_t offset, size_t count);
 
+    // Determines whether the string only contains ASCII characters, which every normalization form leaves unchanged.
+    bool IsASCII(std::string_view input);
+
     // Normalizes a UTF8 string to the given form.
     std::string Normalize(std::string_view input, NORM_FORM form = NORM_FORM::NormalizationKC);
 
@@ -45,7 +49,7 @@ namespace AppInstaller::Utility
         NormalizedUTF8(std::string_view sv) : std::string(Normalize(sv, Form)) {}
 
         NormalizedUTF8(const std::string& s) : std::string(Normalize(s, Form)) {}
-        NormalizedUTF8(std::string&& s) : std::string(Normalize(s, Form)) {}
+        NormalizedUTF8(std::string&& s) : std::string(IsASCII(s) ? std::move(s) : Normalize(s, Form)) {}
 
         NormalizedUTF8(std::wstring_view sv) : std::string(ConvertToUTF8(Normalize(sv, Form))) {}
 
@@ -76,7 +80,7 @@ namespace AppInstaller::Utility
 
         NormalizedUTF8& operator=(std::string&& s)
         {
-            assign(Normalize(s, Form));
+            assign(IsASCII(s) ? std::move(s) : Normalize(s, Form));
             return *this;
         }
     };
@@ -89,6 +93,14 @@ namespace AppInstaller::Utility
     // Get the lower case version of the given std::wstring
     std::wstring ToLower(std::wstring_view in);
 
+    // Folds the case of each code point in the given UTF8 string, using the same simple case folding as the ICU LIKE operator.
+    // Two strings are equal in that comparison if and only if their folded forms are equal.
+    std::string FoldCase(std::string_view input);
+
+    // Gets the edit (Levenshtein) distance between the values, counted in UTF-16 code units.
+    // The values are compared as given; callers fold them first for a case insensitive distance.
+    size_t GetEditDistance(std::wstring_view a, std::wstring_view b);
+
     // Checks if the input string is empty or whitespace
     bool IsEmptyOrWhitespace(std::wstring_view str);
 
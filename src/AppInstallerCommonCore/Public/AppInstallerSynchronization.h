@@ -4,15 +4,32 @@
 #include <AppInstallerLanguageUtilities.h>
 #include <wil/resource.h>
 
+#include <chrono>
+#include <optional>
 #include <string_view>
 
 
 namespace AppInstaller::Synchronization
 {
+    namespace details
+    {
+        struct CrossProcessReaderWriteLockState;
+    }
+
     // A fairly simple cross process (same session) reader-writer lock.
     // The primary purpose is for sources to control access to their backing stores.
-    // Due to this design goal, these limitations exist:
-    // - Starves readers when a writer comes in.
+    // The state of the lock is kept in a section shared by the processes, so that a lock that is not contended is
+    // acquired and released with interlocked operations alone. Waiters poll the state with a growing delay.
+    //
+    // A writer first becomes pending, which makes new readers wait for it, but only for a short time; after that they
+    // are let in alongside the existing readers, reading the data as it was before the write. This lets a writer in
+    // ahead of a steady stream of readers, without a long reader making every new reader wait for it through the writer.
+    // Readers only ever wait on a writer that holds the lock, which it does for as short a time as it can.
+    //
+    // The process that holds a slot in the lock is recorded in it, so that the slots of processes that exit without
+    // releasing them are taken back by the waiters.
+    //
+    // These limitations exist:
     // - Readers are limited to an arbitrarily chosen limit.
     // - Not re-entrant (although repeated read locking will work, it will consume additional slots).
     // - No upgrade from reader to writer.
@@ -33,11 +50,16 @@ namespace AppInstaller::Synchronization
 
         static CrossProcessReaderWriteLock LockForWrite(std::string_view name);
 
+        // Attempts to acquire the lock, returning an empty optional if it could not be acquired within the timeout.
+        static std::optional<CrossProcessReaderWriteLock> TryLockForRead(std::string_view name, std::chrono::milliseconds timeout);
+
+        static std::optional<CrossProcessReaderWriteLock> TryLockForWrite(std::string_view name, std::chrono::milliseconds timeout);
+
     private:
-        CrossProcessReaderWriteLock(std::string_view name);
+        CrossProcessReaderWriteLock(details::CrossProcessReaderWriteLockState* state) : m_state(state) {}
 
-        wil::unique_mutex m_mutex;
-        wil::unique_semaphore m_semaphore;
-        ResetWhenMovedFrom<LONG> m_semaphoreReleases{ 0 };
+        ResetWhenMovedFrom<details::CrossProcessReaderWriteLockState*> m_state;
+        // The reader slot held in the state; null when the lock is held for write.
+        ResetWhenMovedFrom<volatile LONG*> m_readerSlot;
     };
 }
@@ -4,6 +4,9 @@
 #include <AppInstallerLanguageUtilities.h>
 #include <wil/result_macros.h>
 
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <string_view>
 #include <vector>
 
@@ -26,6 +29,9 @@ namespace AppInstaller::Logging
         // Gets the singleton instance of this type.
         static TelemetryTraceLogger& GetInstance();
 
+        // Determines whether telemetry events are being written; callers can skip building the values of an event when they are not.
+        bool IsEnabled() const noexcept;
+
         // Logs the failure info.
         void LogFailure(const wil::FailureInfo& failure) noexcept;
 
@@ -86,6 +92,9 @@ namespace AppInstaller::Logging
         // Logs a faild installation attempt.
         void LogInstallerFailure(std::string_view id, std::string_view version, std::string_view channel, std::string_view type, uint32_t errorCode);
 
+        // Logs the workflow task duration histogram and the performance counters for the invoked command.
+        void LogCommandPerformance(std::string_view commandName) noexcept;
+
     private:
         TelemetryTraceLogger();
     };
@@ -116,4 +125,101 @@ namespace AppInstaller::Logging
     private:
         DestructionToken m_token;
     };
+
+    // An RAII object that coalesces the per search events during its lifetime.
+    // Used by the modes that run many command lines in one process, so that the result count and match events of
+    // every search are written as a single SearchSummary event of their totals when the scope ends.
+    struct AggregateTelemetryScope
+    {
+        AggregateTelemetryScope();
+
+        AggregateTelemetryScope(const AggregateTelemetryScope&) = delete;
+        AggregateTelemetryScope& operator=(const AggregateTelemetryScope&) = delete;
+
+        AggregateTelemetryScope(AggregateTelemetryScope&&) = default;
+        AggregateTelemetryScope& operator=(AggregateTelemetryScope&&) = default;
+
+        ~AggregateTelemetryScope();
+
+    private:
+        DestructionToken m_token;
+    };
+
+    // The operations on the hot paths that are timed by ScopedPerformanceTimer.
+    enum class PerformanceOperation : size_t
+    {
+        SourceOpen,
+        IndexSearch,
+        ManifestFetch,
+        Download,
+        HashVerify,
+        InstallerExecution,
+        InventoryRefresh,
+        Max,
+    };
+
+    // Gets the name of the operation, as used in the events and the summary.
+    std::string_view ToString(PerformanceOperation operation);
+
+    // The totals for one operation over the lifetime of the process.
+    struct PerformanceCounter
+    {
+        uint64_t Count = 0;
+        std::chrono::microseconds Total{};
+        std::chrono::microseconds Longest{};
+    };
+
+    // Gets the totals for the operation; they are updated by every thread.
+    PerformanceCounter GetPerformanceCounter(PerformanceOperation operation);
+
+    // The number of workflow tasks that ran in each range of durations.
+    struct WorkflowTaskHistogram
+    {
+        // The exclusive upper bound of each bucket but the last, which holds every longer task.
+        static constexpr std::array<std::chrono::microseconds, 5> BucketBounds{
+            std::chrono::milliseconds{ 1 },
+            std::chrono::milliseconds{ 10 },
+            std::chrono::milliseconds{ 100 },
+            std::chrono::seconds{ 1 },
+            std::chrono::seconds{ 10 },
+        };
+
+        static constexpr size_t BucketCount = BucketBounds.size() + 1;
+
+        std::array<uint64_t, BucketCount> Counts{};
+        std::chrono::microseconds Total{};
+    };
+
+    // Adds the duration of a workflow task to the histogram.
+    // The duration should exclude the tasks that it ran itself, so that no time is counted twice.
+    void RecordWorkflowTaskDuration(std::chrono::microseconds duration) noexcept;
+
+    // Gets the histogram of the workflow tasks that ran in the process.
+    WorkflowTaskHistogram GetWorkflowTaskHistogram();
+
+    // Sets the totals for every operation and the workflow task histogram back to zero.
+    void ResetPerformanceCounters();
+
+    // An RAII object that times an operation for its lifetime.
+    // The time is added to the counter for the operation, and the operation is written as a start/stop
+    // activity pair to the trace logging provider, so that it can be seen in ETW traces of the process.
+    // These events are not telemetry; they are only written while a trace session listens to the provider.
+    struct ScopedPerformanceTimer
+    {
+        ScopedPerformanceTimer(PerformanceOperation operation);
+
+        ScopedPerformanceTimer(const ScopedPerformanceTimer&) = delete;
+        ScopedPerformanceTimer& operator=(const ScopedPerformanceTimer&) = delete;
+
+        ScopedPerformanceTimer(ScopedPerformanceTimer&&) = delete;
+        ScopedPerformanceTimer& operator=(ScopedPerformanceTimer&&) = delete;
+
+        ~ScopedPerformanceTimer();
+
+    private:
+        PerformanceOperation m_operation;
+        std::chrono::steady_clock::time_point m_start;
+        GUID m_activityId{};
+        bool m_traced = false;
+    };
 }
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation.
 // Licensed under the MIT License.
 #pragma once
+#include <winget/SmallVector.h>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -30,11 +31,28 @@ namespace AppInstaller::Utility
 
         Version(const std::string& version, std::string_view splitChars = DefaultSplitChars) :
             Version(std::string(version), splitChars) {}
+        Version(std::string_view version, std::string_view splitChars = DefaultSplitChars) :
+            Version(std::string(version), splitChars) {}
+        Version(const char* version, std::string_view splitChars = DefaultSplitChars) :
+            Version(std::string(version), splitChars) {}
         Version(std::string&& version, std::string_view splitChars = DefaultSplitChars);
 
         // Gets the full version string used to construct the Version.
         const std::string& ToString() const { return m_version; }
 
+        // Gets a binary encoding of the version whose byte order is the same as the Version order.
+        // Two keys can be compared with memcmp (or std::string comparison), with equal versions having equal keys.
+        // Each part is encoded as:
+        //  1 byte:     the count of significant bytes in Integer (bits 1-4) and whether Other is not empty (bit 0)
+        //  0-8 bytes:  the significant bytes of Integer, most significant first
+        //  if Other:   Other with 0x00 escaped as 0x00 0xFF, followed by 0x00 0x00
+        // A version with only numeric parts requires 2 bytes for each small part, and so typically fits without a heap allocation.
+        std::string GetSortKey() const;
+
+        // Creates a version from a key returned by GetSortKey.
+        // The version has the same parts as the original, but the string is rebuilt from them with '.' between parts.
+        static Version FromSortKey(std::string_view sortKey);
+
         bool operator<(const Version& other) const;
         bool operator>(const Version& other) const;
         bool operator<=(const Version& other) const;
@@ -45,7 +63,10 @@ namespace AppInstaller::Utility
         // An individual version part in between split characters.
         struct Part
         {
-            Part(const std::string& part);
+            // Parses the leading digits as Integer, with the remainder in Other.
+            // If the digits do not fit in Integer, the entire part is placed in Other.
+            Part(std::string_view part);
+            Part(uint64_t integer, std::string&& other) : Integer(integer), Other(std::move(other)) {}
 
             bool operator<(const Part& other) const;
             bool operator==(const Part& other) const;
@@ -55,12 +76,17 @@ namespace AppInstaller::Utility
             std::string Other;
         };
 
+        // Nearly all versions have this many parts or fewer, so they are stored without an allocation.
+        constexpr static size_t InlinePartCount = 4;
+
+        using Parts = SmallVector<Part, InlinePartCount>;
+
         // Gets the part breakdown for a given version; used for tests.
-        const std::vector<Part>& GetParts() const { return m_parts; }
+        const Parts& GetParts() const { return m_parts; }
 
     protected:
         std::string m_version;
-        std::vector<Part> m_parts;
+        Parts m_parts;
     };
 
     // A channel string; existing solely to give a type.
@@ -22,7 +22,18 @@ namespace AppInstaller::Settings
             ExperimentalCmd = 0x1,
             ExperimentalArg = 0x2,
             ExperimentalMSStore = 0x4,
-            Max = 0x8, // This MUST always be last
+            InMemorySearch = 0x8,
+            SearchResultCache = 0x10,
+            BackgroundSourceUpdate = 0x20,
+            PersistentRangeCache = 0x40,
+            InstallerCache = 0x80,
+            ManifestFetchCache = 0x100,
+            CompletionIndex = 0x200,
+            ServerMode = 0x400,
+            Batch = 0x800,
+            Upgrade = 0x1000,
+            HotIndex = 0x2000,
+            Max = 0x4000, // This MUST always be last
         };
 
         using Feature_t = std::underlying_type_t<ExperimentalFeature::Feature>;
@@ -7,6 +7,7 @@
 #include <winrt/Windows.ApplicationModel.AppExtensions.h>
 
 #include <filesystem>
+#include <string>
 #include <string_view>
 #include <optional>
 
@@ -22,12 +23,19 @@ namespace AppInstaller::Deployment
     {
         Extension(winrt::Windows::ApplicationModel::AppExtensions::AppExtension extension);
 
+        // Creates the extension from its cached details, without the catalog; the package is only looked up if it is needed.
+        Extension(std::string packageFullName, std::filesystem::path packagePath);
+
         // Gets the location of the package root.
         std::filesystem::path GetPackagePath() const;
 
         // Gets the location of the directory shared by the extension.
+        // Only available for an extension found in the catalog.
         std::filesystem::path GetPublicFolderPath() const;
 
+        // Gets the full name of the package.
+        std::string GetPackageFullName() const;
+
         // Get the version of the package.
         winrt::Windows::ApplicationModel::PackageVersion GetPackageVersion() const;
 
@@ -35,10 +43,17 @@ namespace AppInstaller::Deployment
         bool VerifyContentIntegrity(IProgressCallback& progress);
 
     private:
-        winrt::Windows::ApplicationModel::AppExtensions::AppExtension m_extension;
+        // Gets the package of the extension, looking it up by its full name if the extension was created from cached details.
+        winrt::Windows::ApplicationModel::Package GetPackage() const;
+
+        winrt::Windows::ApplicationModel::AppExtensions::AppExtension m_extension = nullptr;
+        std::string m_packageFullName;
+        std::filesystem::path m_packagePath;
     };
 
     // Wraps an AppExtensionCatalog.
+    // The extensions found are cached by package family, so that enumerating the catalog is only needed when the
+    // package has changed; a cached extension is used while the package has the same full name and install time.
     struct ExtensionCatalog
     {
         ExtensionCatalog(std::wstring_view extensionName);
@@ -47,6 +62,10 @@ namespace AppInstaller::Deployment
         std::optional<Extension> FindByPackageFamilyAndId(std::string_view packageFamilyName, std::wstring_view id) const;
 
     private:
-        winrt::Windows::ApplicationModel::AppExtensions::AppExtensionCatalog m_catalog = nullptr;
+        std::optional<Extension> FindInCatalog(std::string_view packageFamilyName, std::wstring_view id) const;
+
+        std::wstring m_extensionName;
+        // Opened on the first search of the catalog.
+        mutable winrt::Windows::ApplicationModel::AppExtensions::AppExtensionCatalog m_catalog = nullptr;
     };
 }
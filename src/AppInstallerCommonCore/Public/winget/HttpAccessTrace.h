@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace AppInstaller::Utility::HttpStream
+{
+    // A read of a range stream over HTTP, as it was served by the cache of the stream.
+    struct AccessTraceEntry
+    {
+        // The stream that read, numbered in the order that streams first read while tracing; each clone is its own stream.
+        uint32_t Stream = 0;
+        uint64_t Offset = 0;
+        uint32_t Size = 0;
+        // Whether the read was served without downloading any of it.
+        bool Hit = false;
+    };
+
+    // Records the reads of every range stream of the process while it exists, so that the policies of the cache
+    // can be measured against the way that real packages are read. Only one trace can be recorded at a time.
+    struct AccessTrace
+    {
+        AccessTrace();
+        ~AccessTrace();
+
+        AccessTrace(const AccessTrace&) = delete;
+        AccessTrace& operator=(const AccessTrace&) = delete;
+
+        AccessTrace(AccessTrace&&) = delete;
+        AccessTrace& operator=(AccessTrace&&) = delete;
+
+        // Gets the reads recorded so far, in the order that they completed.
+        std::vector<AccessTraceEntry> GetEntries() const;
+
+        // Records a read by the stream whose reads are identified by the given address, if a trace is being recorded.
+        static void Record(const void* stream, uint64_t offset, uint32_t size, bool hit);
+
+    private:
+        mutable std::mutex m_lock;
+        std::map<const void*, uint32_t> m_streams;
+        std::vector<AccessTraceEntry> m_entries;
+    };
+}
@@ -0,0 +1,22 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <Windows.h>
+#include <WinInet.h>
+#include <winrt/Windows.Web.Http.h>
+
+namespace AppInstaller::Utility
+{
+    // Gets the WinINet session shared by the whole process, so that requests to the same server reuse its
+    // kept-alive connections instead of each download doing its own TLS handshake. HTTP/2 is enabled on it
+    // when the OS supports it. The handle is thread-safe and must not be closed.
+    HINTERNET GetSharedInternetSession();
+
+    // Gets a second shared WinINet session that asks servers for gzip or deflate compressed content and decodes it as it
+    // is read. It must not be used for range requests, as their offsets would address the encoded content.
+    HINTERNET GetSharedDecodingInternetSession();
+
+    // Gets the HTTP client shared by the whole process, for the same reason; it always reads the most recent data
+    // from the server rather than from the local HTTP cache. The client is thread-safe.
+    winrt::Windows::Web::Http::HttpClient GetSharedHttpClient();
+}
@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace AppInstaller::Utility
+{
+    // A store of downloaded installers on disk that is shared by every process, where each installer is named
+    // by its SHA256 hash. An installer is only ever published under the hash of its content, so a manifest that
+    // names the same hash can use it without downloading it again.
+    struct InstallerCache
+    {
+        // Creates a cache in the given directory that holds at most maxSizeInBytes of installers, none of them
+        // unused for longer than maxAge.
+        InstallerCache(std::filesystem::path directory, uint64_t maxSizeInBytes, std::chrono::hours maxAge);
+
+        // Gets the cache configured by the user settings; returns an empty optional if the cache is not enabled.
+        static std::optional<InstallerCache> GetDefault();
+
+        // Places the installer with the given hash at the destination, if it is in the cache.
+        // The installer is verified against the hash after it is placed; returns false if it is missing or does not match.
+        bool TryGet(const std::vector<uint8_t>& sha256, const std::filesystem::path& destination) const;
+
+        // Publishes a copy of the given file, which the caller has verified to have the given hash, then prunes the cache.
+        // Publishing is atomic; if another process publishes the same installer first, its copy is kept.
+        void Add(const std::vector<uint8_t>& sha256, const std::filesystem::path& file) const;
+
+        // Removes the installers that are past the maximum age, then the least recently used ones until the cache fits in its maximum size.
+        // Installers that are in use by another process are skipped.
+        void Prune() const;
+
+        const std::filesystem::path& GetDirectory() const { return m_directory; }
+
+    private:
+        std::filesystem::path GetEntryPath(const std::vector<uint8_t>& sha256) const;
+
+        std::filesystem::path m_directory;
+        uint64_t m_maxSizeInBytes;
+        std::chrono::hours m_maxAge;
+    };
+}
@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace AppInstaller::Maintenance
+{
+    // The arguments that the scheduled task runs winget with.
+    constexpr std::wstring_view ScheduledSourceUpdateArguments = L"source update --scheduled";
+
+    // Gets the task scheduler definition of the task that updates the sources at the given interval.
+    // The task runs the executable with ScheduledSourceUpdateArguments, at the lowest priority, when the system is idle
+    // and on AC power with a network available; a run that was missed starts once it can.
+    std::wstring GetSourceUpdateTaskDefinition(const std::filesystem::path& executable, std::chrono::minutes interval);
+
+    // Registers the task of the current user that updates the sources at the given interval, replacing any earlier one.
+    void RegisterSourceUpdateTask(std::chrono::minutes interval);
+
+    // Removes the task of the current user that updates the sources. Returns false if it was not registered.
+    bool UnregisterSourceUpdateTask();
+
+    // Lowers the CPU, I/O and memory priority of the process for the rest of its life, for work that no one waits on.
+    void EnterBackgroundMode();
+
+    // Determines whether network use that can wait should be put off, because the internet connection is metered,
+    // roaming, or near its data limit, or because there is none.
+    bool ShouldDeferNetworkUse();
+}
@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <winget/ManifestValidation.h>
+#include <AppInstallerSHA256.h>
+#include <wil/resource.h>
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace AppInstaller::Manifest
+{
+    // The result of validating one of the manifests in a directory.
+    struct ManifestValidationResult
+    {
+        // The path of the manifest, relative to the directory.
+        std::filesystem::path RelativePath;
+
+        // S_OK if the manifest is valid, APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_WARNING if it only has warnings,
+        // and APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_FAILURE otherwise.
+        HRESULT Result = S_OK;
+
+        // The errors and warnings found; a manifest that could not be read at all only has a message.
+        std::vector<ValidationError> Errors;
+
+        // The errors as a message, in the same form as when a single manifest is validated.
+        std::string Message;
+    };
+
+    // A cache of validation results keyed by the SHA256 of the content of each manifest, so that a manifest that has not
+    // changed is not validated again. A cache written by a different version of the validator is not used, as its rules may differ.
+    // It may be used by several threads at once.
+    struct ManifestValidationCache
+    {
+        // Loads the cache from the file. A file that does not exist, cannot be read, or was written by another version
+        // of the validator gives an empty cache, which is written over when it is saved.
+        ManifestValidationCache(std::filesystem::path filePath);
+
+        ManifestValidationCache(const ManifestValidationCache&) = delete;
+        ManifestValidationCache& operator=(const ManifestValidationCache&) = delete;
+
+        ManifestValidationCache(ManifestValidationCache&&) = delete;
+        ManifestValidationCache& operator=(ManifestValidationCache&&) = delete;
+
+        // Gets the version of the validator that results are cached for.
+        static std::string GetValidatorVersion();
+
+        // Gets the cached result for the content with the hash; the relative path of the result is not set.
+        std::optional<ManifestValidationResult> Get(const Utility::SHA256::HashBuffer& contentHash) const;
+
+        // Sets the result for the content with the hash.
+        void Set(const Utility::SHA256::HashBuffer& contentHash, const ManifestValidationResult& result);
+
+        // Writes the cache to its file, if any result was set since it was loaded.
+        void Save();
+
+    private:
+        std::filesystem::path m_filePath;
+        mutable wil::srwlock m_lock;
+        std::map<std::string, ManifestValidationResult> m_results;
+        bool m_changed = false;
+    };
+
+    // Fully validates the manifest file, or gets its result from the cache if one is given and its content has not changed.
+    // Any failure to read or parse the manifest is returned as a failed result, rather than thrown.
+    ManifestValidationResult ValidateManifestFile(const std::filesystem::path& path, ManifestValidationCache* cache = nullptr);
+
+    // Fully validates every manifest (*.yaml) under the directory, on as many threads as there are processors.
+    // The results are ordered by path. The field tables of each manifest version are shared by all of the manifests.
+    // If a cache is given, the manifests whose content has not changed are not validated again.
+    std::vector<ManifestValidationResult> ValidateManifestsInDirectory(const std::filesystem::path& directory, ManifestValidationCache* cache = nullptr);
+
+    // Gets the combined result: the failure if any manifest failed, then the warning if any manifest has warnings, and S_OK otherwise.
+    HRESULT GetCombinedResult(const std::vector<ManifestValidationResult>& results);
+
+    // Converts the results to a JSON array with an object for each manifest:
+    //  { "Path": "...", "Result": "Valid" | "Warning" | "Error", "Message": "...",
+    //    "Errors": [ { "Level": "Warning" | "Error", "Message": "...", "Field": "...", "Value": "...", "Line": 1, "Column": 1 } ] }
+    std::string ConvertToJson(const std::vector<ManifestValidationResult>& results);
+}
@@ -50,6 +50,10 @@ namespace AppInstaller::Manifest
         // Required
         string_t Url;
 
+        // Optional. Other urls that serve the same installer. The download races them with Url, using the first to
+        // respond, and fails over to the others when it stops; the installer is still checked against the hash.
+        std::vector<string_t> MirrorUrls;
+
         // Required
         std::vector<BYTE> Sha256;
 
@@ -57,6 +61,12 @@ namespace AppInstaller::Manifest
         // validate appx/msix signature and perform streaming install.
         std::vector<BYTE> SignatureSha256;
 
+        // Optional. The chunked hash of the installer, with the size of its chunks in bytes; both are given or neither is.
+        // When provided, the chunks of the download are verified as they arrive, and a resumed download keeps those
+        // that were verified, rather than the whole installer being hashed once it is downloaded.
+        std::vector<BYTE> ChunkedSha256;
+        uint64_t ChunkSize = 0;
+
         // Empty means default
         string_t Language;
 
@@ -3,8 +3,23 @@
 #pragma once
 #include <AppInstallerStrings.h>
 
+#include <memory>
+
 namespace AppInstaller::Manifest
 {
+    class ManifestLocalization;
+
+    namespace details
+    {
+        // The fields of a localization that the parser left undecoded, until they are first needed.
+        struct DeferredLocalization
+        {
+            virtual ~DeferredLocalization() = default;
+
+            virtual void Decode(ManifestLocalization& localization) const = 0;
+        };
+    }
+
     class ManifestLocalization
     {
     public:
@@ -18,5 +33,25 @@ namespace AppInstaller::Manifest
         string_t Homepage;
 
         string_t LicenseUrl;
+
+        // Unless the manifest is parsed with full validation, only the language of each localization is decoded with it,
+        // as just one localization is ever shown; this decodes the other fields. Does nothing if they are already decoded.
+        void Decode()
+        {
+            if (m_deferred)
+            {
+                m_deferred->Decode(*this);
+                m_deferred.reset();
+            }
+        }
+
+        // Gets whether the fields other than the language are decoded.
+        bool IsDecoded() const { return !m_deferred; }
+
+        // Defers decoding the fields other than the language until Decode is called; only for the parser.
+        void SetDeferred(std::shared_ptr<const details::DeferredLocalization> deferred) { m_deferred = std::move(deferred); }
+
+    private:
+        std::shared_ptr<const details::DeferredLocalization> m_deferred;
     };
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 
 #include <functional>
 #include <string>
+#include <string_view>
 
 namespace YAML { class Node; }
 
@@ -152,4 +153,27 @@ namespace AppInstaller::Manifest
     };
 
     std::vector<ValidationError> ValidateManifest(const Manifest& manifest);
+
+    // Checks the values of the manifest fields that have a fixed format. These are hand written rather than regular expressions,
+    // so that full validation of many manifests does not compile and backtrack through a regex for every field.
+    namespace FieldValidators
+    {
+        // A version of three parts from 0 to 65535 without leading zeros, like the other versions in the manifest.
+        bool IsManifestVersion(std::string_view value);
+
+        // A version of one to four parts from 0 to 65535 without leading zeros.
+        bool IsMinOSVersion(std::string_view value);
+
+        // A value without whitespace that has a '.' between two non-empty parts, such as Publisher.Package.
+        bool IsPackageId(std::string_view value);
+
+        // A non-empty value without the characters that are not allowed in file names.
+        bool IsPackageVersion(std::string_view value);
+
+        // A SHA256 hash of 64 hexadecimal digits.
+        bool IsSha256(std::string_view value);
+
+        // A number of bytes without leading zeros that is a positive multiple of 64 KiB, and at most 4 GiB.
+        bool IsChunkSize(std::string_view value);
+    }
 }
\ No newline at end of file
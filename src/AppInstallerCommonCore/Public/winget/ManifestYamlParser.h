@@ -5,6 +5,9 @@
 #include <winget/Manifest.h>
 
 #include <filesystem>
+#include <memory>
+#include <string_view>
+#include <vector>
 
 namespace AppInstaller::Manifest
 {
@@ -31,20 +34,49 @@ namespace AppInstaller::Manifest
         std::map<ManifestInstaller::InstallerSwitchType, Utility::NormalizedString>* m_p_switches = nullptr;
         AppInstaller::Manifest::ManifestLocalization* m_p_localization = nullptr;
 
-        // This struct contains individual app manifest field info
+        // This struct contains individual app manifest field info.
+        // The processing function stores the value through the pointers of the parser that it is given.
         struct ManifestFieldInfo
         {
-            std::string Name;
+            std::string_view Name;
             ManifestVer VerIntroduced;
-            std::function<void(const YAML::Node&)> ProcessFunc;
+            void (*ProcessFunc)(YamlParser& parser, const YAML::Node& value);
             bool Required = false;
-            std::string RegEx = {};
+            // Checks the value of the field when full validation is requested; one of the FieldValidators.
+            bool (*ValidateValue)(std::string_view) = nullptr;
         };
 
-        std::vector<ManifestFieldInfo> RootFieldInfos;
-        std::vector<ManifestFieldInfo> InstallerFieldInfos;
-        std::vector<ManifestFieldInfo> SwitchesFieldInfos;
-        std::vector<ManifestFieldInfo> LocalizationFieldInfos;
+        // The fields of one kind of node that a manifest version supports, with their names ordered for case insensitive lookup.
+        struct ManifestFieldInfos
+        {
+            ManifestFieldInfos(const std::vector<ManifestFieldInfo>& fields, const ManifestVer& manifestVer);
+
+            // The fields in the order that they are declared in.
+            const std::vector<ManifestFieldInfo>& Fields() const { return m_fields; }
+
+            // Finds the field whose name matches the key case insensitively, without allocating; returns nullptr if there is none.
+            const ManifestFieldInfo* Find(std::string_view key) const;
+
+        private:
+            std::vector<ManifestFieldInfo> m_fields;
+            std::vector<size_t> m_byName;
+        };
+
+        // The fields of every kind of node for a manifest version. These are built once for a version and shared by its parses.
+        struct ManifestFieldInfoTables
+        {
+            ManifestFieldInfos Root;
+            ManifestFieldInfos Installer;
+            ManifestFieldInfos Switches;
+            ManifestFieldInfos Localization;
+            // The localization fields as they are checked when the fields other than the language are deferred.
+            ManifestFieldInfos LocalizationLanguage;
+        };
+
+        // Decodes the fields of a localization, other than the language, from its node.
+        struct DeferredLocalization;
+
+        std::shared_ptr<const ManifestFieldInfoTables> m_fieldInfos;
 
         std::vector<ValidationError> ParseManifest(const YAML::Node& rootNode, Manifest& manifest, bool fullValidation);
 
@@ -55,12 +87,13 @@ namespace AppInstaller::Manifest
         // Yaml-cpp does not support case insensitive search and it allows duplicate keys. If duplicate keys exist,
         // the value is undefined. So in this method, we will iterate through the node map and process each individual
         // pair ourselves. This also helps with generating aggregated error rather than throwing on first failure.
-        static std::vector<ValidationError> ValidateAndProcessFields(
+        std::vector<ValidationError> ValidateAndProcessFields(
             const YAML::Node& rootNode,
-            const std::vector<ManifestFieldInfo>& fieldInfos,
+            const ManifestFieldInfos& fieldInfos,
             bool fullValidation);
 
-        void PrepareManifestFieldInfos(const ManifestVer& manifestVer);
-        void FilterManifestFieldInfos(std::vector<ManifestFieldInfo>& source, const ManifestVer& manifestVer);
+        // Gets the shared field infos of the manifest version, creating them on its first parse.
+        static std::shared_ptr<const ManifestFieldInfoTables> GetManifestFieldInfos(const ManifestVer& manifestVer);
+        static ManifestFieldInfoTables CreateManifestFieldInfos(const ManifestVer& manifestVer);
     };
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <wil/resource.h>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace AppInstaller::Memory
+{
+    // The order in which the caches of a process are trimmed; those that are cheapest to fill again are trimmed first.
+    enum class TrimOrder
+    {
+        // Data that is still at hand elsewhere, such as the pages of a database file that is also mapped.
+        Early,
+        // Data that has to be read or downloaded again.
+        Normal,
+        // Data that is costly to build again, which is only trimmed once nothing else is left.
+        Late,
+    };
+
+    // The memory held by the caches of a process, which each register to report their usage and to be trimmed.
+    // A process that runs many commands, such as a server or a batch, keeps its caches between them; the budget keeps
+    // them from growing past a limit, and gives their memory back to the system when it is running low.
+    struct MemoryBudget
+    {
+        // Trims the cache, freeing at least the given number of bytes if it can.
+        // Called without any lock of the budget held, but never at the same time as the registration is removed.
+        using TrimFunction = std::function<void(size_t bytesToFree)>;
+
+        // Gets the usage of the cache, for a cache that does not report it as it changes.
+        using UsageFunction = std::function<size_t()>;
+
+        // The registration of a cache; the cache is no longer trimmed once this is destroyed or reset.
+        // A cache that holds this as a member must declare it after everything that its functions use.
+        struct Registration
+        {
+            Registration() = default;
+
+            Registration(const Registration&) = delete;
+            Registration& operator=(const Registration&) = delete;
+
+            Registration(Registration&&) = default;
+            Registration& operator=(Registration&& other);
+
+            ~Registration();
+
+            // Sets the number of bytes that the cache holds.
+            void SetUsage(size_t bytes);
+
+            // Removes the registration, waiting for a trim of the cache that is in progress.
+            void reset();
+
+        private:
+            friend MemoryBudget;
+
+            struct Entry;
+            Registration(MemoryBudget* budget, std::shared_ptr<Entry> entry);
+
+            MemoryBudget* m_budget = nullptr;
+            std::shared_ptr<Entry> m_entry;
+        };
+
+        // Creates a budget that trims its caches down to the given number of bytes; 0 does not limit them.
+        MemoryBudget(size_t limit);
+
+        MemoryBudget(const MemoryBudget&) = delete;
+        MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+        // Gets the budget of the process, with the limit of the user settings.
+        static MemoryBudget& Instance();
+
+        // Registers a cache that reports its usage with SetUsage on the registration.
+        Registration Register(std::string_view name, TrimOrder order, TrimFunction trim);
+
+        // Registers a cache whose usage is read when it is needed.
+        Registration Register(std::string_view name, TrimOrder order, UsageFunction usage, TrimFunction trim);
+
+        // Gets the number of bytes that the registered caches hold.
+        size_t GetUsage() const;
+
+        size_t GetLimit() const { return m_limit; }
+        void SetLimit(size_t limit) { m_limit = limit; }
+
+        // Trims the caches, in order, until they hold no more than the given number of bytes. Returns the bytes freed.
+        size_t Trim(size_t target);
+
+        // Trims the caches down to the limit, if they are over it.
+        void TrimIfOverBudget();
+
+    private:
+        void Unregister(const std::shared_ptr<Registration::Entry>& entry);
+
+        std::atomic<size_t> m_limit;
+        mutable std::mutex m_lock;
+        std::vector<std::shared_ptr<Registration::Entry>> m_entries;
+    };
+
+    // Trims all of the caches of the budget whenever the system signals that it is low on memory, while this exists.
+    struct LowMemoryMonitor
+    {
+        LowMemoryMonitor(MemoryBudget& budget = MemoryBudget::Instance());
+
+        LowMemoryMonitor(const LowMemoryMonitor&) = delete;
+        LowMemoryMonitor& operator=(const LowMemoryMonitor&) = delete;
+
+        ~LowMemoryMonitor();
+
+    private:
+        void Monitor();
+
+        MemoryBudget& m_budget;
+        wil::unique_handle m_notification;
+        wil::unique_event m_stop;
+        std::thread m_thread;
+    };
+}
@@ -3,6 +3,7 @@
 #pragma once
 #include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 
@@ -47,8 +48,14 @@ namespace AppInstaller::Settings
         constexpr static StreamDefinition PrimaryUserSettings{ Type::UserFile, "settings.json"sv };
         // The backup user settings file.
         constexpr static StreamDefinition BackupUserSettings{ Type::UserFile, "settings.json.backup"sv };
+        // The extensions found in the AppExtensionCatalog.
+        constexpr static StreamDefinition ExtensionCatalogCache{ Type::Standard, "extension_catalog_cache"sv };
     };
 
+    // Gets the named setting's value, if present.
+    // If the setting does not exist, returns an empty value.
+    std::optional<std::string> GetSetting(const StreamDefinition& def);
+
     // Gets a stream containing the named setting's value, if present.
     // If the setting does not exist, returns an empty value.
     std::unique_ptr<std::istream> GetSettingStream(const StreamDefinition& def);
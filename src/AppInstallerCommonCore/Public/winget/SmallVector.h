@@ -0,0 +1,189 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace AppInstaller
+{
+    // A vector that stores up to N elements inline, only allocating when more than that are added.
+    // Once allocated, the elements remain on the heap until the vector is cleared.
+    // Pointers to elements are invalidated by any operation that changes the size.
+    template <typename T, size_t N>
+    struct SmallVector
+    {
+        static_assert(N > 0, "Use std::vector when no elements are to be stored inline");
+
+        using value_type = T;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        SmallVector() = default;
+
+        SmallVector(const SmallVector& other)
+        {
+            CopyFrom(other);
+        }
+
+        SmallVector& operator=(const SmallVector& other)
+        {
+            if (this != &other)
+            {
+                clear();
+                CopyFrom(other);
+            }
+            return *this;
+        }
+
+        SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            MoveFrom(other);
+        }
+
+        SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            if (this != &other)
+            {
+                clear();
+                MoveFrom(other);
+            }
+            return *this;
+        }
+
+        ~SmallVector()
+        {
+            clear();
+        }
+
+        size_t size() const { return (m_onHeap ? m_heap.size() : m_inlineSize); }
+        bool empty() const { return size() == 0; }
+
+        // Determines whether the elements are stored inline; used for tests.
+        bool IsInline() const { return !m_onHeap; }
+
+        T* data() { return (m_onHeap ? m_heap.data() : InlineData()); }
+        const T* data() const { return (m_onHeap ? m_heap.data() : InlineData()); }
+
+        T& operator[](size_t i) { return data()[i]; }
+        const T& operator[](size_t i) const { return data()[i]; }
+
+        T& back() { return data()[size() - 1]; }
+        const T& back() const { return data()[size() - 1]; }
+
+        iterator begin() { return data(); }
+        iterator end() { return data() + size(); }
+        const_iterator begin() const { return data(); }
+        const_iterator end() const { return data() + size(); }
+
+        template <typename... Args>
+        T& emplace_back(Args&&... args)
+        {
+            if (!m_onHeap)
+            {
+                if (m_inlineSize < N)
+                {
+                    T* result = new (InlineData() + m_inlineSize) T(std::forward<Args>(args)...);
+                    ++m_inlineSize;
+                    return *result;
+                }
+
+                // Construct the value before moving the inline elements, as the arguments may refer to them.
+                T value(std::forward<Args>(args)...);
+                MoveInlineToHeap();
+                return m_heap.emplace_back(std::move(value));
+            }
+
+            return m_heap.emplace_back(std::forward<Args>(args)...);
+        }
+
+        void push_back(const T& value) { emplace_back(value); }
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        void pop_back()
+        {
+            if (m_onHeap)
+            {
+                m_heap.pop_back();
+            }
+            else
+            {
+                InlineData()[--m_inlineSize].~T();
+            }
+        }
+
+        void clear()
+        {
+            if (m_onHeap)
+            {
+                m_heap.clear();
+                m_onHeap = false;
+            }
+            else
+            {
+                while (m_inlineSize)
+                {
+                    pop_back();
+                }
+            }
+        }
+
+    private:
+        T* InlineData() { return std::launder(reinterpret_cast<T*>(m_inline)); }
+        const T* InlineData() const { return std::launder(reinterpret_cast<const T*>(m_inline)); }
+
+        void MoveInlineToHeap()
+        {
+            m_heap.reserve(N * 2);
+            for (size_t i = 0; i < m_inlineSize; ++i)
+            {
+                m_heap.emplace_back(std::move(InlineData()[i]));
+            }
+
+            clear();
+            m_onHeap = true;
+        }
+
+        // Both of these require that this object is empty and inline.
+        void CopyFrom(const SmallVector& other)
+        {
+            if (other.m_onHeap)
+            {
+                m_heap = other.m_heap;
+                m_onHeap = true;
+            }
+            else
+            {
+                for (const T& value : other)
+                {
+                    emplace_back(value);
+                }
+            }
+        }
+
+        void MoveFrom(SmallVector& other)
+        {
+            if (other.m_onHeap)
+            {
+                m_heap = std::move(other.m_heap);
+                m_onHeap = true;
+            }
+            else
+            {
+                for (T& value : other)
+                {
+                    emplace_back(std::move(value));
+                }
+            }
+
+            other.clear();
+        }
+
+        size_t m_inlineSize = 0;
+        bool m_onHeap = false;
+        alignas(T) unsigned char m_inline[sizeof(T) * N];
+        std::vector<T> m_heap;
+    };
+}
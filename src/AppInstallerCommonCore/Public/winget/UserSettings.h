@@ -3,6 +3,7 @@
 #pragma once
 #include "AppInstallerStrings.h"
 
+#include <array>
 #include <filesystem>
 #include <map>
 #include <optional>
@@ -35,6 +36,14 @@ namespace AppInstaller::Settings
         Rainbow,
     };
 
+    // The backend that downloads installers.
+    enum class InstallerDownloader
+    {
+        Default,
+        WinInet,
+        DeliveryOptimization,
+    };
+
     // Enum of settings.
     // Must start at 0 to enable direct access to variant in UserSettings.
     // Max must be last and unused.
@@ -46,9 +55,31 @@ namespace AppInstaller::Settings
     {
         ProgressBarVisualStyle,
         AutoUpdateTimeInMinutes,
+        SourceScheduledUpdate,
+        NetworkDownloadRateLimitInKBps,
+        NetworkBackgroundDownloadRateLimitInKBps,
+        InstallerCacheMaxSizeInMB,
+        InstallerCacheMaxAgeInDays,
+        MemoryBudgetInMB,
+        SearchSourceTimeoutInMilliseconds,
+        SearchHedgeRequests,
+        SearchMergeSources,
+        NetworkDownloader,
+        DiagnosticsRecordWorkload,
         EFExperimentalCmd,
         EFExperimentalArg,
         EFExperimentalMSStore,
+        EFInMemorySearch,
+        EFSearchResultCache,
+        EFBackgroundSourceUpdate,
+        EFPersistentRangeCache,
+        EFInstallerCache,
+        EFManifestFetchCache,
+        EFCompletionIndex,
+        EFServerMode,
+        EFBatch,
+        EFUpgrade,
+        EFHotIndex,
         Max
     };
 
@@ -78,9 +109,31 @@ namespace AppInstaller::Settings
 
         SETTINGMAPPING_SPECIALIZATION(Setting::ProgressBarVisualStyle, std::string, VisualStyle, VisualStyle::Accent, ".visual.progressBar"sv);
         SETTINGMAPPING_SPECIALIZATION(Setting::AutoUpdateTimeInMinutes, uint32_t, std::chrono::minutes, 5min, ".source.autoUpdateIntervalInMinutes"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::SourceScheduledUpdate, bool, bool, false, ".source.scheduledUpdate"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::NetworkDownloadRateLimitInKBps, uint32_t, uint32_t, 0, ".network.downloadRateLimitInKBps"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::NetworkBackgroundDownloadRateLimitInKBps, uint32_t, uint32_t, 64, ".network.backgroundDownloadRateLimitInKBps"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::InstallerCacheMaxSizeInMB, uint32_t, uint32_t, 2048, ".installerCache.maxSizeInMB"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::InstallerCacheMaxAgeInDays, uint32_t, std::chrono::hours, 720h, ".installerCache.maxAgeInDays"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::MemoryBudgetInMB, uint32_t, uint32_t, 128, ".memory.budgetInMB"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::SearchSourceTimeoutInMilliseconds, uint32_t, std::chrono::milliseconds, 0ms, ".search.sourceTimeoutInMilliseconds"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::SearchHedgeRequests, bool, bool, false, ".search.hedgeRequests"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::SearchMergeSources, bool, bool, true, ".search.mergeSources"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::NetworkDownloader, std::string, InstallerDownloader, InstallerDownloader::Default, ".network.downloader"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::DiagnosticsRecordWorkload, bool, bool, false, ".diagnostics.recordWorkload"sv);
         SETTINGMAPPING_SPECIALIZATION(Setting::EFExperimentalCmd, bool, bool, false, ".experimentalFeatures.experimentalCmd"sv);
         SETTINGMAPPING_SPECIALIZATION(Setting::EFExperimentalArg, bool, bool, false, ".experimentalFeatures.experimentalArg"sv);
         SETTINGMAPPING_SPECIALIZATION(Setting::EFExperimentalMSStore, bool, bool, false, ".experimentalFeatures.experimentalMSStore"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::EFInMemorySearch, bool, bool, false, ".experimentalFeatures.inMemorySearch"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::EFSearchResultCache, bool, bool, false, ".experimentalFeatures.searchResultCache"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::EFBackgroundSourceUpdate, bool, bool, false, ".experimentalFeatures.backgroundSourceUpdate"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::EFPersistentRangeCache, bool, bool, false, ".experimentalFeatures.persistentRangeCache"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::EFInstallerCache, bool, bool, false, ".experimentalFeatures.installerCache"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::EFManifestFetchCache, bool, bool, false, ".experimentalFeatures.manifestFetchCache"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::EFCompletionIndex, bool, bool, false, ".experimentalFeatures.completionIndex"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::EFServerMode, bool, bool, false, ".experimentalFeatures.serverMode"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::EFBatch, bool, bool, false, ".experimentalFeatures.batch"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::EFUpgrade, bool, bool, false, ".experimentalFeatures.upgrade"sv);
+        SETTINGMAPPING_SPECIALIZATION(Setting::EFHotIndex, bool, bool, false, ".experimentalFeatures.hotIndex"sv);
 
 
         // Used to deduce the SettingVariant type; making a variant that includes std::monostate and all SettingMapping types.
@@ -92,6 +145,9 @@ namespace AppInstaller::Settings
 
         // Gets the index into the variant for the given Setting.
         constexpr inline size_t SettingIndex(Setting s) { return static_cast<size_t>(s) + 1; }
+
+        // Holds the value of each Setting, indexed by the Setting; std::monostate when the setting is not set.
+        using SettingValues = std::array<SettingVariant, static_cast<size_t>(Setting::Max)>;
     }
 
 
@@ -117,23 +173,23 @@ namespace AppInstaller::Settings
 
         void PrepareToShellExecuteFile() const;
 
-        // Gets setting value, if its not in the map it returns the default value.
+        // Gets setting value, if it is not set it returns the default value.
         template <Setting S>
         typename details::SettingMapping<S>::value_t Get() const
         {
-            auto itr = m_settings.find(S);
-            if (itr == m_settings.end())
+            const auto* value = std::get_if<details::SettingIndex(S)>(&m_settings[static_cast<size_t>(S)]);
+            if (!value)
             {
                 return details::SettingMapping<S>::DefaultValue;
             }
 
-            return std::get<details::SettingIndex(S)>(itr->second);
+            return *value;
         }
 
     private:
         UserSettingsType m_type = UserSettingsType::Default;
         std::vector<std::string> m_warnings;
-        std::map<Setting, details::SettingVariant> m_settings;
+        details::SettingValues m_settings{};
 
     protected:
         UserSettings();
@@ -8,11 +8,20 @@
 #include <stack>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 
 namespace AppInstaller::YAML
 {
+    // Forward declaration to allow pImpl in this Emitter, and the loading of nodes.
+    namespace Wrapper
+    {
+        struct Document;
+        struct Emitter;
+        struct Parser;
+    }
+
     // A location within the stream.
     struct Mark
     {
@@ -58,6 +67,7 @@ namespace AppInstaller::YAML
     };
 
     // A YAML node.
+    // The children of a node are shared by its copies rather than copied with it, as a tree is not changed once it is loaded.
     struct Node
     {
         // The node's type.
@@ -70,13 +80,18 @@ namespace AppInstaller::YAML
             Mapping
         };
 
+        // The mapping of a node, in document order.
+        using mapping_t = std::vector<std::pair<Node, Node>>;
+
         Node() : m_type(Type::Invalid) {}
-        Node(Type type, std::string tag, const Mark& mark);
+
+        // The tag is only stored if it is not the default tag of the type.
+        Node(Type type, std::string_view tag, const Mark& mark);
 
         // Sets the scalar value of the node.
         void SetScalar(std::string value);
 
-        // Adds a child node to the sequence.
+        // Adds a child node to the sequence; only while the node is being loaded.
         template <typename... Args>
         Node& AddSequenceNode(Args&&... args)
         {
@@ -84,12 +99,12 @@ namespace AppInstaller::YAML
             return m_sequence->emplace_back(std::forward<Args>(args)...);
         }
 
-        // Adds a child node to the mapping.
+        // Adds a child node to the mapping; only while the node is being loaded, which indexes the mapping once it is complete.
         template <typename... Args>
         Node& AddMappingNode(Node&& key, Args&&... args)
         {
             Require(Type::Mapping);
-            return m_mapping->emplace(std::move(key), Node(std::forward<Args>(args)...))->second;
+            return m_mapping->pairs.emplace_back(std::move(key), Node(std::forward<Args>(args)...)).second;
         }
 
         bool IsDefined() const { return m_type != Type::Invalid; }
@@ -129,10 +144,16 @@ namespace AppInstaller::YAML
         const std::vector<Node>& Sequence() const;
 
         // Gets the nodes in the mapping.
-        const std::multimap<Node, Node>& Mapping() const;
+        const mapping_t& Mapping() const;
 
     private:
-        Node(std::string_view key) : m_type(Type::Scalar), m_scalar(key) {}
+        friend Wrapper::Parser;
+
+        // Indexes the keys of the mapping once all of its nodes are added.
+        void IndexMapping();
+
+        // Finds the value with the given key in the mapping; returns nullptr if there is none.
+        const Node* FindMappingValue(std::string_view key) const;
 
         // Require certain node types to; throwing if the requirement is not met.
         void Require(Type type) const;
@@ -146,8 +167,17 @@ namespace AppInstaller::YAML
         std::string m_tag;
         YAML::Mark m_mark;
         std::string m_scalar;
-        std::optional<std::vector<Node>> m_sequence;
-        std::optional<std::multimap<Node, Node>> m_mapping;
+        std::shared_ptr<std::vector<Node>> m_sequence;
+
+        // The children of a mapping node, with an index of their keys.
+        struct MappingData
+        {
+            mapping_t pairs;
+            // The hash of each key with its position in pairs, ordered by hash and then position.
+            std::vector<std::pair<size_t, size_t>> index;
+        };
+
+        std::shared_ptr<MappingData> m_mapping;
     };
 
     // Loads from the input; returns the root node of the first document.
@@ -167,13 +197,8 @@ namespace AppInstaller::YAML
         Value,
     };
 
-    // Forward declaration to allow pImpl in this Emitter.
-    namespace Wrapper
-    {
-        struct Document;
-    }
-
     // A YAML emitter.
+    // The events are streamed to libyaml as they are given, rather than building a document to dump.
     struct Emitter
     {
         Emitter();
@@ -192,23 +217,22 @@ namespace AppInstaller::YAML
         Emitter& operator<<(int64_t value);
         Emitter& operator<<(bool value);
 
-        // Gets the result of the emitter; can only be retrieved once.
+        // Gets the result of the emitter; can only be retrieved once, and only when no containers are left open.
         std::string str();
 
     private:
-        // Appends the given node to the current container if applicable.
-        void AppendNode(int id);
+        // Starts the document before its first container.
+        void StartDocumentIfNeeded();
 
-        std::unique_ptr<Wrapper::Document> m_document;
+        std::unique_ptr<Wrapper::Emitter> m_emitter;
 
-        // If set, stores the last Key that was set.
-        std::optional<int> m_keyId;
+        // Set once the document has been started, by the first container.
+        bool m_documentStarted = false;
 
         struct ContainerInfo
         {
-            ContainerInfo(int id, bool map) : Id(id), IsMapping(map) {}
+            ContainerInfo(bool map) : IsMapping(map) {}
 
-            int Id;
             bool IsMapping;
         };
 
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 #include "pch.h"
 #include <binver/version.h>
+#include "Public/AppInstallerLogging.h"
 #include "Public/AppInstallerRuntime.h"
 #include "Public/AppInstallerStrings.h"
 
@@ -79,6 +80,20 @@ namespace AppInstaller::Runtime
         static std::map<PathName, std::filesystem::path> s_Path_TestHook_Overrides;
 #endif
 
+        // The paths resolved by GetPathTo, which do not change for the lifetime of the process.
+        // Only successfully resolved (and created) paths are kept, so a failure is retried by the next call.
+        struct PathCache
+        {
+            std::mutex Lock;
+            std::map<PathName, std::filesystem::path> Paths;
+        };
+
+        PathCache& GetPathCache()
+        {
+            static PathCache s_cache;
+            return s_cache;
+        }
+
         std::filesystem::path GetKnownFolderPath(const KNOWNFOLDERID& id)
         {
             wil::unique_cotaskmem_string knownFolder = nullptr;
@@ -212,6 +227,18 @@ namespace AppInstaller::Runtime
 
     std::filesystem::path GetPathTo(PathName path)
     {
+        PathCache& cache = GetPathCache();
+
+        {
+            std::lock_guard<std::mutex> lock{ cache.Lock };
+            auto itr = cache.Paths.find(path);
+            if (itr != cache.Paths.end())
+            {
+                return itr->second;
+            }
+        }
+
+        // Resolve outside of the lock; the known folder and package APIs can be slow, and concurrent callers resolve the same value
         std::filesystem::path result;
         bool create = true;
 
@@ -311,57 +338,94 @@ namespace AppInstaller::Runtime
             }
         }
 
+        {
+            std::lock_guard<std::mutex> lock{ cache.Lock };
+            cache.Paths.emplace(path, result);
+        }
+
         return result;
     }
 
     bool IsCurrentOSVersionGreaterThanOrEqual(const Utility::Version& version)
     {
-        DWORD versionParts[3] = {};
+        return GetSystemCapabilities().IsOSVersionGreaterThanOrEqual(version);
+    }
+
+    bool IsRunningAsAdmin()
+    {
+        return GetSystemCapabilities().IsRunningAsAdmin;
+    }
 
-        for (size_t i = 0; i < ARRAYSIZE(versionParts) && i < version.GetParts().size(); ++i)
+    int SystemCapabilities::GetArchitecturePriority(Utility::Architecture arch) const
+    {
+        size_t index = static_cast<size_t>(static_cast<int>(arch) + 1);
+        return (index < ArchitecturePriorities.size() ? ArchitecturePriorities[index] : -1);
+    }
+
+    bool SystemCapabilities::IsOSVersionGreaterThanOrEqual(const Utility::Version& version) const
+    {
+        std::array<DWORD, 3> versionParts{};
+
+        for (size_t i = 0; i < versionParts.size() && i < version.GetParts().size(); ++i)
         {
             versionParts[i] = static_cast<DWORD>(std::min(static_cast<decltype(version.GetParts()[i].Integer)>(std::numeric_limits<DWORD>::max()), version.GetParts()[i].Integer));
         }
 
-        OSVERSIONINFOEXW osVersionInfo{};
-        osVersionInfo.dwOSVersionInfoSize = sizeof(osVersionInfo);
-        osVersionInfo.dwMajorVersion = versionParts[0];
-        osVersionInfo.dwMinorVersion = versionParts[1];
-        osVersionInfo.dwBuildNumber = versionParts[2];
-        osVersionInfo.wServicePackMajor = 0;
-        osVersionInfo.wServicePackMinor = 0;
-
-        DWORD mask = VER_MAJORVERSION | VER_MINORVERSION | VER_BUILDNUMBER | VER_SERVICEPACKMAJOR | VER_SERVICEPACKMINOR;
-
-        DWORDLONG conditions = 0;
-        VER_SET_CONDITION(conditions, VER_MAJORVERSION, VER_GREATER_EQUAL);
-        VER_SET_CONDITION(conditions, VER_MINORVERSION, VER_GREATER_EQUAL);
-        VER_SET_CONDITION(conditions, VER_BUILDNUMBER, VER_GREATER_EQUAL);
-        VER_SET_CONDITION(conditions, VER_SERVICEPACKMAJOR, VER_GREATER_EQUAL);
-        VER_SET_CONDITION(conditions, VER_SERVICEPACKMINOR, VER_GREATER_EQUAL);
-
-        BOOL result = VerifyVersionInfoW(&osVersionInfo, mask, conditions);
-        if (!result)
-        {
-            THROW_LAST_ERROR_IF(GetLastError() != ERROR_OLD_WIN_VERSION);
-        }
-        return !!result;
+        return OSVersion >= versionParts;
     }
 
-    bool IsRunningAsAdmin()
+    const SystemCapabilities& GetSystemCapabilities()
     {
-        return wil::test_token_membership(nullptr, SECURITY_NT_AUTHORITY, SECURITY_BUILTIN_DOMAIN_RID, DOMAIN_ALIAS_RID_ADMINS);
+        static const SystemCapabilities s_capabilities = []()
+        {
+            SystemCapabilities result;
+
+            result.ApplicableArchitectures = Utility::GetApplicableArchitectures();
+            result.ArchitecturePriorities.fill(-1);
+            for (size_t i = 0; i < result.ApplicableArchitectures.size(); ++i)
+            {
+                size_t index = static_cast<size_t>(static_cast<int>(result.ApplicableArchitectures[i]) + 1);
+                result.ArchitecturePriorities[index] = static_cast<int>(result.ApplicableArchitectures.size() - i);
+            }
+
+            // RtlGetVersion reports the actual version, where the version APIs report the one the process is manifested for
+            using RtlGetVersionFunction = LONG(WINAPI*)(PRTL_OSVERSIONINFOW);
+            auto rtlGetVersion = reinterpret_cast<RtlGetVersionFunction>(GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "RtlGetVersion"));
+            THROW_LAST_ERROR_IF_NULL(rtlGetVersion);
+
+            RTL_OSVERSIONINFOW osVersionInfo{};
+            osVersionInfo.dwOSVersionInfoSize = sizeof(osVersionInfo);
+            THROW_IF_NTSTATUS_FAILED(rtlGetVersion(&osVersionInfo));
+            result.OSVersion = { osVersionInfo.dwMajorVersion, osVersionInfo.dwMinorVersion, osVersionInfo.dwBuildNumber };
+
+            result.IsRunningAsAdmin = wil::test_token_membership(nullptr, SECURITY_NT_AUTHORITY, SECURITY_BUILTIN_DOMAIN_RID, DOMAIN_ALIAS_RID_ADMINS);
+
+            result.Locale = std::locale("").name();
+
+            AICLI_LOG(Core, Info, << "System capabilities: OS " << result.OSVersion[0] << '.' << result.OSVersion[1] << '.' << result.OSVersion[2] <<
+                ", admin " << result.IsRunningAsAdmin << ", locale " << result.Locale);
+
+            return result;
+        }();
+
+        return s_capabilities;
     }
 
 #ifndef AICLI_DISABLE_TEST_HOOKS
     void TestHook_SetPathOverride(PathName target, const std::filesystem::path& path)
     {
         s_Path_TestHook_Overrides[target] = path;
+
+        std::lock_guard<std::mutex> lock{ GetPathCache().Lock };
+        GetPathCache().Paths.clear();
     }
 
     void TestHook_ClearPathOverrides()
     {
         s_Path_TestHook_Overrides.clear();
+
+        std::lock_guard<std::mutex> lock{ GetPathCache().Lock };
+        GetPathCache().Paths.clear();
     }
 #endif
 }
@@ -6,20 +6,195 @@
 #include <bcrypt.h>
 #include "Public/AppInstallerSHA256.h"
 #include "Public/AppInstallerRuntime.h"
+#include "Public/AppInstallerTelemetry.h"
+#include <thread>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define AICLI_SHA256_HARDWARE_X86
+#elif defined(_M_ARM64)
+#include <arm64_neon.h>
+#define AICLI_SHA256_HARDWARE_ARM64
+#endif
 
 using namespace AppInstaller::Runtime;
 
 namespace AppInstaller::Utility {
 
+    namespace
+    {
+        constexpr size_t s_BlockSize = 64;
+        constexpr size_t s_HashSize = 32;
+
+        // The size of the file views mapped while hashing a file; a multiple of the allocation granularity.
+        constexpr uint64_t s_FileViewSize = 64 * 1024 * 1024;
+
+        constexpr std::array<uint32_t, 8> s_InitialState = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+        };
+
+        alignas(16) constexpr uint32_t s_RoundConstants[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+        };
+
+        bool DetectHardwareSupport()
+        {
+#if defined(AICLI_SHA256_HARDWARE_X86)
+            int registers[4]{};
+            __cpuid(registers, 0);
+            if (registers[0] < 7)
+            {
+                return false;
+            }
+
+            // SSSE3 and SSE4.1 are needed for the shuffles around the SHA instructions
+            __cpuid(registers, 1);
+            bool hasSSSE3 = (registers[2] & (1 << 9)) != 0;
+            bool hasSSE41 = (registers[2] & (1 << 19)) != 0;
+
+            __cpuidex(registers, 7, 0);
+            bool hasSHA = (registers[1] & (1 << 29)) != 0;
+
+            return hasSSSE3 && hasSSE41 && hasSHA;
+#elif defined(AICLI_SHA256_HARDWARE_ARM64)
+            return IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE) != FALSE;
+#else
+            return false;
+#endif
+        }
+
+        // Runs the compression function over whole blocks with the processor's SHA instructions.
+        // The message schedule is kept as four vectors of four words, indexed as a ring.
+        void ProcessBlocks(uint32_t* state, const uint8_t* data, size_t blockCount)
+        {
+#if defined(AICLI_SHA256_HARDWARE_X86)
+            const __m128i byteSwapMask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+            // The round instructions take the state as ABEF and CDGH
+            __m128i temp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+            __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+            temp = _mm_shuffle_epi32(temp, 0xB1);
+            state1 = _mm_shuffle_epi32(state1, 0x1B);
+            __m128i state0 = _mm_alignr_epi8(temp, state1, 8);
+            state1 = _mm_blend_epi16(state1, temp, 0xF0);
+
+            for (; blockCount > 0; --blockCount, data += s_BlockSize)
+            {
+                __m128i savedState0 = state0;
+                __m128i savedState1 = state1;
+                __m128i schedule[4];
+
+                for (size_t i = 0; i < 16; ++i)
+                {
+                    __m128i& words = schedule[i % 4];
+
+                    if (i < 4)
+                    {
+                        words = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)), byteSwapMask);
+                    }
+                    else
+                    {
+                        temp = _mm_add_epi32(_mm_sha256msg1_epu32(words, schedule[(i + 1) % 4]), _mm_alignr_epi8(schedule[(i + 3) % 4], schedule[(i + 2) % 4], 4));
+                        words = _mm_sha256msg2_epu32(temp, schedule[(i + 3) % 4]);
+                    }
+
+                    __m128i message = _mm_add_epi32(words, _mm_load_si128(reinterpret_cast<const __m128i*>(&s_RoundConstants[i * 4])));
+                    state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+                    state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0E));
+                }
+
+                state0 = _mm_add_epi32(state0, savedState0);
+                state1 = _mm_add_epi32(state1, savedState1);
+            }
+
+            temp = _mm_shuffle_epi32(state0, 0x1B);
+            state1 = _mm_shuffle_epi32(state1, 0xB1);
+            state0 = _mm_blend_epi16(temp, state1, 0xF0);
+            state1 = _mm_alignr_epi8(state1, temp, 8);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+#elif defined(AICLI_SHA256_HARDWARE_ARM64)
+            uint32x4_t state0 = vld1q_u32(&state[0]);
+            uint32x4_t state1 = vld1q_u32(&state[4]);
+
+            for (; blockCount > 0; --blockCount, data += s_BlockSize)
+            {
+                uint32x4_t savedState0 = state0;
+                uint32x4_t savedState1 = state1;
+                uint32x4_t schedule[4];
+
+                for (size_t i = 0; i < 16; ++i)
+                {
+                    uint32x4_t& words = schedule[i % 4];
+
+                    if (i < 4)
+                    {
+                        words = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + i * 16)));
+                    }
+                    else
+                    {
+                        words = vsha256su1q_u32(vsha256su0q_u32(words, schedule[(i + 1) % 4]), schedule[(i + 2) % 4], schedule[(i + 3) % 4]);
+                    }
+
+                    uint32x4_t message = vaddq_u32(words, vld1q_u32(&s_RoundConstants[i * 4]));
+                    uint32x4_t previousState0 = state0;
+                    state0 = vsha256hq_u32(state0, state1, message);
+                    state1 = vsha256h2q_u32(state1, previousState0, message);
+                }
+
+                state0 = vaddq_u32(state0, savedState0);
+                state1 = vaddq_u32(state1, savedState1);
+            }
+
+            vst1q_u32(&state[0], state0);
+            vst1q_u32(&state[4], state1);
+#else
+            UNREFERENCED_PARAMETER(state);
+            UNREFERENCED_PARAMETER(data);
+            UNREFERENCED_PARAMETER(blockCount);
+            THROW_HR(HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED));
+#endif
+        }
+    }
+
     struct SHA256Context
     {
+        // Used by the platform implementation.
         wil::unique_bcrypt_algorithm algHandle;
         wil::unique_bcrypt_hash hashHandle;
         DWORD hashLength = 0;
+
+        // Used by the hardware implementation; data is buffered until it fills a block.
+        bool useHardware = false;
+        std::array<uint32_t, 8> state{};
+        std::array<uint8_t, s_BlockSize> pending{};
+        size_t pendingSize = 0;
+        uint64_t totalSize = 0;
     };
 
-    SHA256::SHA256() : context(new SHA256Context{})
+    SHA256::SHA256(Implementation implementation) : context(new SHA256Context{})
     {
+        if (implementation == Implementation::Hardware && !IsHardwareImplementationSupported())
+        {
+            THROW_HR_MSG(HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED), "the processor does not support the SHA256 instructions");
+        }
+
+        if (implementation != Implementation::Platform && IsHardwareImplementationSupported())
+        {
+            context->useHardware = true;
+            context->hashLength = static_cast<DWORD>(s_HashSize);
+            context->state = s_InitialState;
+            return;
+        }
+
         BCRYPT_ALG_HANDLE algHandleT{};
         BCRYPT_HASH_HANDLE hashHandleT;
         DWORD resultLength = 0;
@@ -65,6 +240,45 @@ namespace AppInstaller::Utility {
     {
         EnsureNotFinished();
 
+        if (context->useHardware)
+        {
+            context->totalSize += cbBuffer;
+
+            // Complete the partial block from previous calls first
+            if (context->pendingSize > 0 && cbBuffer > 0)
+            {
+                size_t count = std::min(cbBuffer, s_BlockSize - context->pendingSize);
+                memcpy(context->pending.data() + context->pendingSize, buffer, count);
+                context->pendingSize += count;
+                buffer += count;
+                cbBuffer -= count;
+
+                if (context->pendingSize < s_BlockSize)
+                {
+                    return;
+                }
+
+                ProcessBlocks(context->state.data(), context->pending.data(), 1);
+                context->pendingSize = 0;
+            }
+
+            size_t blockCount = cbBuffer / s_BlockSize;
+            if (blockCount > 0)
+            {
+                ProcessBlocks(context->state.data(), buffer, blockCount);
+                buffer += blockCount * s_BlockSize;
+                cbBuffer -= blockCount * s_BlockSize;
+            }
+
+            if (cbBuffer > 0)
+            {
+                memcpy(context->pending.data(), buffer, cbBuffer);
+                context->pendingSize = cbBuffer;
+            }
+
+            return;
+        }
+
         // Add the data
         THROW_IF_NTSTATUS_FAILED_MSG(
             BCryptHashData(context->hashHandle.get(), const_cast<PUCHAR>(buffer), static_cast<ULONG>(cbBuffer), 0),
@@ -78,6 +292,41 @@ namespace AppInstaller::Utility {
         // Size the hash buffer appropriately
         hash.resize(context->hashLength);
 
+        if (context->useHardware)
+        {
+            // Pad with a single set bit, then zeros up to the big-endian bit length at the end of the last block
+            uint64_t bitLength = context->totalSize * 8;
+            auto& pending = context->pending;
+            size_t& pendingSize = context->pendingSize;
+
+            pending[pendingSize++] = 0x80;
+            if (pendingSize > s_BlockSize - sizeof(bitLength))
+            {
+                std::fill(pending.begin() + pendingSize, pending.end(), static_cast<uint8_t>(0));
+                ProcessBlocks(context->state.data(), pending.data(), 1);
+                pendingSize = 0;
+            }
+
+            std::fill(pending.begin() + pendingSize, pending.end() - sizeof(bitLength), static_cast<uint8_t>(0));
+            for (size_t i = 0; i < sizeof(bitLength); ++i)
+            {
+                pending[s_BlockSize - 1 - i] = static_cast<uint8_t>(bitLength >> (i * 8));
+            }
+            ProcessBlocks(context->state.data(), pending.data(), 1);
+
+            for (size_t i = 0; i < context->state.size(); ++i)
+            {
+                uint32_t word = context->state[i];
+                hash[i * 4] = static_cast<uint8_t>(word >> 24);
+                hash[i * 4 + 1] = static_cast<uint8_t>(word >> 16);
+                hash[i * 4 + 2] = static_cast<uint8_t>(word >> 8);
+                hash[i * 4 + 3] = static_cast<uint8_t>(word);
+            }
+
+            context.reset();
+            return;
+        }
+
         // Obtain the hash of the message(s) into the hash buffer
         THROW_IF_NTSTATUS_FAILED_MSG(BCryptFinishHash(
             context->hashHandle.get(),  // Handle to the hash or MAC object
@@ -158,6 +407,50 @@ namespace AppInstaller::Utility {
         return result;
     }
 
+    std::vector<uint8_t> SHA256::ComputeHashFromFile(const std::filesystem::path& path)
+    {
+        Logging::ScopedPerformanceTimer timer{ Logging::PerformanceOperation::HashVerify };
+
+        wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+        THROW_LAST_ERROR_IF_MSG(!file, "failed opening file to hash");
+
+        LARGE_INTEGER fileSize{};
+        THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &fileSize));
+
+        SHA256 hasher;
+
+        // A mapping cannot be created for an empty file
+        if (fileSize.QuadPart > 0)
+        {
+            wil::unique_handle mapping{ CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr) };
+            THROW_LAST_ERROR_IF_NULL_MSG(mapping, "failed creating file mapping to hash");
+
+            uint64_t size = static_cast<uint64_t>(fileSize.QuadPart);
+
+            for (uint64_t offset = 0; offset < size; offset += s_FileViewSize)
+            {
+                size_t viewSize = static_cast<size_t>(std::min(s_FileViewSize, size - offset));
+
+                wil::unique_mapview_ptr<uint8_t> view{ static_cast<uint8_t*>(MapViewOfFile(
+                    mapping.get(), FILE_MAP_READ, static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset), viewSize)) };
+                THROW_LAST_ERROR_IF_NULL_MSG(view, "failed mapping view of file to hash");
+
+                hasher.Add(view.get(), viewSize);
+            }
+        }
+
+        std::vector<uint8_t> result;
+        hasher.Get(result);
+
+        return result;
+    }
+
+    bool SHA256::IsHardwareImplementationSupported()
+    {
+        static const bool s_isSupported = DetectHardwareSupport();
+        return s_isSupported;
+    }
+
     void SHA256::SHA256ContextDeleter::operator()(SHA256Context* context)
     {
         delete context;
@@ -170,4 +463,175 @@ namespace AppInstaller::Utility {
             THROW_HR_MSG(E_UNEXPECTED, "The hash is already finished");
         }
     }
+
+    ChunkedSHA256::ChunkedSHA256(uint64_t chunkSize) : m_chunkSize(chunkSize)
+    {
+        THROW_HR_IF(E_INVALIDARG, chunkSize == 0);
+    }
+
+    void ChunkedSHA256::Add(const uint8_t* buffer, size_t cbBuffer)
+    {
+        THROW_HR_IF_MSG(E_UNEXPECTED, m_finished, "The hash is already finished");
+
+        while (cbBuffer > 0)
+        {
+            if (!m_chunk)
+            {
+                m_chunk = std::make_unique<SHA256>();
+                m_chunkFilled = 0;
+            }
+
+            size_t size = static_cast<size_t>(std::min<uint64_t>(cbBuffer, m_chunkSize - m_chunkFilled));
+            m_chunk->Add(buffer, size);
+            m_chunkFilled += size;
+            buffer += size;
+            cbBuffer -= size;
+
+            if (m_chunkFilled == m_chunkSize)
+            {
+                m_chunkHashes.emplace_back(m_chunk->Get());
+                m_chunk.reset();
+            }
+        }
+    }
+
+    ChunkedSHA256::HashBuffer ChunkedSHA256::Get()
+    {
+        THROW_HR_IF_MSG(E_UNEXPECTED, m_finished, "The hash is already finished");
+        m_finished = true;
+
+        // The last chunk is shorter than the others
+        if (m_chunk)
+        {
+            m_chunkHashes.emplace_back(m_chunk->Get());
+            m_chunk.reset();
+        }
+
+        return CombineChunkHashes(m_chunkHashes);
+    }
+
+    ChunkedSHA256::HashBuffer ChunkedSHA256::CombineChunkHashes(const std::vector<HashBuffer>& chunkHashes)
+    {
+        SHA256 hasher;
+
+        for (const auto& chunkHash : chunkHashes)
+        {
+            THROW_HR_IF(E_INVALIDARG, chunkHash.size() != s_HashSize);
+            hasher.Add(chunkHash);
+        }
+
+        return hasher.Get();
+    }
+
+    void ChunkedSHA256::ComputeMissingChunkHashesFromFile(const std::filesystem::path& path, uint64_t chunkSize, std::vector<HashBuffer>& chunkHashes)
+    {
+        THROW_HR_IF(E_INVALIDARG, chunkSize == 0);
+
+        Logging::ScopedPerformanceTimer timer{ Logging::PerformanceOperation::HashVerify };
+
+        wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        THROW_LAST_ERROR_IF_MSG(!file, "failed opening file to hash");
+
+        LARGE_INTEGER fileSize{};
+        THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &fileSize));
+
+        uint64_t size = static_cast<uint64_t>(fileSize.QuadPart);
+        chunkHashes.resize(static_cast<size_t>((size + chunkSize - 1) / chunkSize));
+
+        std::vector<size_t> missing;
+        for (size_t i = 0; i < chunkHashes.size(); ++i)
+        {
+            if (chunkHashes[i].empty())
+            {
+                missing.push_back(i);
+            }
+        }
+
+        if (missing.empty())
+        {
+            return;
+        }
+
+        size_t threadCount = std::min<size_t>(std::max<size_t>(std::thread::hardware_concurrency(), 1), missing.size());
+        std::atomic<size_t> nextChunk = 0;
+
+        // Each thread reads its chunks through the shared handle at their offsets, rather than mapping views,
+        // so that the chunk size need not be a multiple of the allocation granularity.
+        auto hashThread = [&]()
+        {
+            const DWORD bufferSize = 1024 * 1024; // 1MB
+            auto buffer = std::make_unique<uint8_t[]>(bufferSize);
+
+            for (size_t index = nextChunk++; index < missing.size(); index = nextChunk++)
+            {
+                size_t chunk = missing[index];
+                uint64_t offset = chunk * chunkSize;
+                uint64_t end = std::min(offset + chunkSize, size);
+
+                SHA256 hasher;
+
+                while (offset < end)
+                {
+                    OVERLAPPED overlapped{};
+                    overlapped.Offset = static_cast<DWORD>(offset);
+                    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+                    DWORD bytesRead = 0;
+                    THROW_LAST_ERROR_IF_MSG(!ReadFile(file.get(), buffer.get(), static_cast<DWORD>(std::min<uint64_t>(bufferSize, end - offset)), &bytesRead, &overlapped),
+                        "failed reading file to hash");
+                    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_HANDLE_EOF), bytesRead == 0);
+
+                    hasher.Add(buffer.get(), bytesRead);
+                    offset += bytesRead;
+                }
+
+                chunkHashes[chunk] = hasher.Get();
+            }
+        };
+
+        std::vector<std::future<void>> threads;
+        for (size_t i = 1; i < threadCount; ++i)
+        {
+            threads.emplace_back(std::async(std::launch::async, hashThread));
+        }
+
+        // This thread does its share of the work too; the others are waited for before surfacing a failure, as they use the handle
+        std::exception_ptr failure;
+        try
+        {
+            hashThread();
+        }
+        catch (...)
+        {
+            failure = std::current_exception();
+            nextChunk = missing.size();
+        }
+
+        for (auto& thread : threads)
+        {
+            try
+            {
+                thread.get();
+            }
+            catch (...)
+            {
+                if (!failure)
+                {
+                    failure = std::current_exception();
+                }
+            }
+        }
+
+        if (failure)
+        {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    ChunkedSHA256::HashBuffer ChunkedSHA256::ComputeHashFromFile(const std::filesystem::path& path, uint64_t chunkSize)
+    {
+        std::vector<HashBuffer> chunkHashes;
+        ComputeMissingChunkHashesFromFile(path, chunkSize, chunkHashes);
+        return CombineChunkHashes(chunkHashes);
+    }
 }
\ No newline at end of file
@@ -33,9 +33,9 @@ namespace AppInstaller::Settings
         {
             virtual ~ISettingsContainer() = default;
 
-            // Gets a stream containing the named setting's value, if present.
+            // Gets the named setting's value, if present.
             // If the setting does not exist, returns an empty value.
-            virtual std::unique_ptr<std::istream> Get(const std::filesystem::path& name) = 0;
+            virtual std::optional<std::string> Get(const std::filesystem::path& name) = 0;
 
             // Sets the named setting to the given value.
             virtual void Set(const std::filesystem::path& name, std::string_view value) = 0;
@@ -68,7 +68,7 @@ namespace AppInstaller::Settings
                 return result;
             }
 
-            std::unique_ptr<std::istream> Get(const std::filesystem::path& name) override
+            std::optional<std::string> Get(const std::filesystem::path& name) override
             {
                 Container parent = GetRelativeContainer(m_root, name.parent_path());
 
@@ -77,7 +77,7 @@ namespace AppInstaller::Settings
                 if (settingsValues.HasKey(filenameHstring))
                 {
                     auto value = winrt::unbox_value<winrt::hstring>(settingsValues.Lookup(filenameHstring));
-                    return std::make_unique<std::istringstream>(Utility::ConvertToUTF8(value.c_str()));
+                    return Utility::ConvertToUTF8(value.c_str());
                 }
                 else
                 {
@@ -112,20 +112,46 @@ namespace AppInstaller::Settings
         {
             FileSettingsContainer(std::filesystem::path root) : m_root(std::move(root)) {}
 
-            std::unique_ptr<std::istream> Get(const std::filesystem::path& name) override
+            std::optional<std::string> Get(const std::filesystem::path& name) override
             {
                 std::filesystem::path settingFileName = GetPath(name);
 
-                if (std::filesystem::exists(settingFileName))
+                wil::unique_hfile file{ CreateFileW(settingFileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+                if (!file)
                 {
-                    auto result = std::make_unique<std::ifstream>(settingFileName);
-                    THROW_LAST_ERROR_IF(result->fail());
-                    return result;
+                    DWORD error = GetLastError();
+                    if (error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND)
+                    {
+                        return {};
+                    }
+
+                    THROW_WIN32(error);
                 }
-                else
+
+                // Settings are small, so the whole file is read into the value with a single read in nearly every case
+                LARGE_INTEGER fileSize{};
+                THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &fileSize));
+                THROW_HR_IF(E_UNEXPECTED, static_cast<uint64_t>(fileSize.QuadPart) > std::numeric_limits<uint32_t>::max());
+
+                std::string result(static_cast<size_t>(fileSize.QuadPart), '\0');
+                size_t totalRead = 0;
+
+                while (totalRead < result.size())
                 {
-                    return {};
+                    DWORD bytesRead = 0;
+                    THROW_IF_WIN32_BOOL_FALSE(ReadFile(file.get(), &result[totalRead], static_cast<DWORD>(result.size() - totalRead), &bytesRead, nullptr));
+
+                    if (bytesRead == 0)
+                    {
+                        // The file was truncated after its size was read
+                        break;
+                    }
+
+                    totalRead += bytesRead;
                 }
+
+                result.resize(totalRead);
+                return result;
             }
 
             void Set(const std::filesystem::path& name, std::string_view value) override
@@ -187,14 +213,14 @@ namespace AppInstaller::Settings
 
             VerificationData GetVerificationData(const std::filesystem::path& name)
             {
-                std::unique_ptr<std::istream> stream = m_secure.Get(name);
+                std::optional<std::string> value = m_secure.Get(name);
 
-                if (!stream)
+                if (!value)
                 {
                     return {};
                 }
 
-                std::string streamContents = Utility::ReadEntireStream(*stream);
+                const std::string& streamContents = value.value();
 
                 YAML::Node document;
                 try
@@ -236,14 +262,14 @@ namespace AppInstaller::Settings
                 m_secure.Set(name, out.str());
             }
 
-            std::unique_ptr<std::istream> Get(const std::filesystem::path& name) override
+            std::optional<std::string> Get(const std::filesystem::path& name) override
             {
-                std::unique_ptr<std::istream> stream = m_container->Get(name);
+                std::optional<std::string> value = m_container->Get(name);
 
-                if (!stream)
+                if (!value)
                 {
-                    // If no stream exists, then no verification needs to be done.
-                    return stream;
+                    // If no value exists, then no verification needs to be done.
+                    return value;
                 }
 
                 VerificationData verData = GetVerificationData(name);
@@ -252,15 +278,14 @@ namespace AppInstaller::Settings
                 // Plus the text for this one is fairly on point for what has happened.
                 THROW_HR_IF(SPAPI_E_FILE_HASH_NOT_IN_CATALOG, !verData.Found);
 
-                std::string streamContents = Utility::ReadEntireStream(*stream);
-                THROW_HR_IF(E_UNEXPECTED, streamContents.size() > std::numeric_limits<uint32_t>::max());
+                THROW_HR_IF(E_UNEXPECTED, value->size() > std::numeric_limits<uint32_t>::max());
 
-                auto streamHash = SHA256::ComputeHash(reinterpret_cast<const uint8_t*>(streamContents.c_str()), static_cast<uint32_t>(streamContents.size()));
+                auto valueHash = SHA256::ComputeHash(reinterpret_cast<const uint8_t*>(value->c_str()), static_cast<uint32_t>(value->size()));
 
-                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_DATA_CHECKSUM_ERROR), !std::equal(streamHash.begin(), streamHash.end(), verData.Hash.begin()));
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_DATA_CHECKSUM_ERROR), !std::equal(valueHash.begin(), valueHash.end(), verData.Hash.begin()));
 
-                // Return a stream over the contents that we read in and verified, to prevent a race attack.
-                return std::make_unique<std::istringstream>(streamContents);
+                // Return the contents that we read in and verified, to prevent a race attack.
+                return value;
             }
 
             void Set(const std::filesystem::path& name, std::string_view value) override
@@ -344,13 +369,24 @@ namespace AppInstaller::Settings
         }
     }
 
-    std::unique_ptr<std::istream> GetSettingStream(const StreamDefinition& def)
+    std::optional<std::string> GetSetting(const StreamDefinition& def)
     {
         LogSettingAction("Get", def);
         ValidateSettingNamePath(def.Path);
         return GetSettingsContainer(def.Type)->Get(def.Path);
     }
 
+    std::unique_ptr<std::istream> GetSettingStream(const StreamDefinition& def)
+    {
+        std::optional<std::string> value = GetSetting(def);
+        if (!value)
+        {
+            return {};
+        }
+
+        return std::make_unique<std::istringstream>(std::move(value).value());
+    }
+
     void SetSetting(const StreamDefinition& def, std::string_view value)
     {
         LogSettingAction("Set", def);
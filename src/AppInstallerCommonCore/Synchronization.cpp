@@ -8,68 +8,342 @@
 
 namespace AppInstaller::Synchronization
 {
+    using namespace std::chrono_literals;
     using namespace std::string_view_literals;
 
-    constexpr std::wstring_view s_CrossProcessReaderWriteLock_MutexSuffix = L".mutex"sv;
-    constexpr std::wstring_view s_CrossProcessReaderWriteLock_SemaphoreSuffix = L".sem"sv;
+    constexpr std::wstring_view s_CrossProcessReaderWriteLock_StateSuffix = L".state"sv;
 
     // Arbitrary limit that should not ever cause a problem (theoretically 1 per process)
-    constexpr LONG s_CrossProcessReaderWriteLock_MaxReaders = 16;
+    constexpr size_t s_CrossProcessReaderWriteLock_MaxReaders = 64;
 
-    CrossProcessReaderWriteLock::~CrossProcessReaderWriteLock()
+    // How long new readers wait for a pending writer before they are let in alongside the existing readers.
+    constexpr std::chrono::milliseconds s_CrossProcessReaderWriteLock_ReaderYieldTime = 200ms;
+
+    // The bounds of the delay between checks of the state of a contended lock.
+    constexpr DWORD s_CrossProcessReaderWriteLock_MinPollDelay = 1;
+    constexpr DWORD s_CrossProcessReaderWriteLock_MaxPollDelay = 16;
+
+    namespace details
     {
-        for (LONG i = 0; i < m_semaphoreReleases; ++i)
+        // The state of a lock, in the section shared by the processes that use it.
+        // Each field is zero when it is not held, and otherwise the id of the process that holds it.
+        struct CrossProcessReaderWriteLockState
         {
-            m_semaphore.ReleaseSemaphore();
-        }
+            // The writer that is waiting for the lock or holding it; there is only ever one.
+            volatile LONG PendingWriter;
+            // The writer that holds the lock; only ever set by the pending writer.
+            volatile LONG Writer;
+            volatile LONG Readers[s_CrossProcessReaderWriteLock_MaxReaders];
+        };
     }
 
-    CrossProcessReaderWriteLock CrossProcessReaderWriteLock::LockForRead(std::string_view name)
+    namespace
     {
-        CrossProcessReaderWriteLock result(name);
+        using State = details::CrossProcessReaderWriteLockState;
+
+        LONG Load(volatile LONG& value)
+        {
+            return InterlockedCompareExchange(&value, 0, 0);
+        }
+
+        LONG GetCurrentProcessIdValue()
+        {
+            return static_cast<LONG>(GetCurrentProcessId());
+        }
+
+        // Determines whether the process that holds part of a lock still exists.
+        bool IsProcessRunning(LONG processId)
+        {
+            if (processId == GetCurrentProcessIdValue())
+            {
+                return true;
+            }
+
+            wil::unique_handle process{ OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(processId)) };
+            if (!process)
+            {
+                // A process that cannot be opened may still be running
+                return (GetLastError() == ERROR_ACCESS_DENIED);
+            }
+
+            return (WaitForSingleObject(process.get(), 0) == WAIT_TIMEOUT);
+        }
+
+        // Gets the state of the named lock. The state is kept mapped for the lifetime of the process, so that only the
+        // first use of a lock by a process needs to open it.
+        State* GetState(std::string_view name)
+        {
+            THROW_HR_IF(E_INVALIDARG, name.find('\\') != std::string::npos);
+
+            struct MappedState
+            {
+                wil::unique_handle Mapping;
+                wil::unique_mapview_ptr<State> View;
+            };
+
+            static wil::srwlock s_lock;
+            static std::map<std::string, MappedState, std::less<>> s_states;
+
+            {
+                auto lock = s_lock.lock_shared();
+                auto itr = s_states.find(name);
+                if (itr != s_states.end())
+                {
+                    return itr->second.View.get();
+                }
+            }
+
+            auto lock = s_lock.lock_exclusive();
+            auto itr = s_states.find(name);
+            if (itr != s_states.end())
+            {
+                return itr->second.View.get();
+            }
+
+            std::wstring mappingName = Utility::ConvertToUTF16(name);
+            mappingName += s_CrossProcessReaderWriteLock_StateSuffix;
+
+            // A new section is zeroed, which is the unheld state
+            MappedState mapped;
+            mapped.Mapping.reset(CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(State), mappingName.c_str()));
+            THROW_LAST_ERROR_IF_NULL_MSG(mapped.Mapping, "failed creating the state of lock: %hs", std::string{ name }.c_str());
+
+            mapped.View.reset(static_cast<State*>(MapViewOfFile(mapped.Mapping.get(), FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, sizeof(State))));
+            THROW_LAST_ERROR_IF_NULL(mapped.View);
+
+            State* result = mapped.View.get();
+            s_states.emplace(name, std::move(mapped));
+            return result;
+        }
+
+        bool HasReaders(State* state)
+        {
+            for (auto& reader : state->Readers)
+            {
+                if (Load(reader) != 0)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        volatile LONG* TryTakeReaderSlot(State* state)
+        {
+            LONG self = GetCurrentProcessIdValue();
+
+            for (auto& reader : state->Readers)
+            {
+                if (InterlockedCompareExchange(&reader, self, 0) == 0)
+                {
+                    return &reader;
+                }
+            }
+
+            return nullptr;
+        }
+
+        // Takes back the reader slots of processes that exited without releasing them.
+        void ReclaimReaderSlots(State* state)
+        {
+            for (auto& reader : state->Readers)
+            {
+                LONG processId = Load(reader);
+                if (processId != 0 && !IsProcessRunning(processId) && InterlockedCompareExchange(&reader, 0, processId) == processId)
+                {
+                    AICLI_LOG(Core, Warning, << "Reclaimed a lock reader slot from exited process " << processId);
+                }
+            }
+        }
 
-        DWORD status = 0;
-        auto lock = result.m_mutex.acquire(&status);
-        THROW_HR_IF(E_UNEXPECTED, status != WAIT_OBJECT_0);
+        // Takes back the lock from a writer process that exited without releasing it.
+        void ReclaimWriter(State* state, LONG processId)
+        {
+            if (!IsProcessRunning(processId))
+            {
+                // Clearing the pending writer last keeps any new writer out until the lock is fully released
+                InterlockedCompareExchange(&state->Writer, 0, processId);
+                if (InterlockedCompareExchange(&state->PendingWriter, 0, processId) == processId)
+                {
+                    AICLI_LOG(Core, Warning, << "Reclaimed a lock from exited writer process " << processId);
+                }
+            }
+        }
+
+        // Waits between checks of the state of a contended lock, with a delay that grows so that long waits do not spin.
+        struct Waiter
+        {
+            Waiter(std::chrono::milliseconds timeout) :
+                m_start(std::chrono::steady_clock::now()), m_infinite(timeout == std::chrono::milliseconds::max()), m_timeout(timeout) {}
+
+            // Waits before the state is checked again; returns false if the timeout has passed instead.
+            bool Wait()
+            {
+                DWORD delay = m_delay;
+
+                if (!m_infinite)
+                {
+                    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(m_timeout - Elapsed());
+                    if (remaining <= 0ms)
+                    {
+                        return false;
+                    }
+
+                    delay = std::min(delay, static_cast<DWORD>(remaining.count()));
+                }
+
+                Sleep(delay);
+                m_delay = std::min(m_delay * 2, s_CrossProcessReaderWriteLock_MaxPollDelay);
+                return true;
+            }
+
+            // Whether the wait has gone on long enough that the holders of the lock should be checked for having exited.
+            bool IsLongWait() const
+            {
+                return m_delay == s_CrossProcessReaderWriteLock_MaxPollDelay;
+            }
+
+            std::chrono::steady_clock::duration Elapsed() const
+            {
+                return std::chrono::steady_clock::now() - m_start;
+            }
 
-        // We are taking ownership of releasing this in the destructor
-        status = ::WaitForSingleObjectEx(result.m_semaphore.get(), INFINITE, FALSE);
-        THROW_HR_IF(E_UNEXPECTED, status != WAIT_OBJECT_0);
+        private:
+            std::chrono::steady_clock::time_point m_start;
+            bool m_infinite;
+            std::chrono::milliseconds m_timeout;
+            DWORD m_delay = s_CrossProcessReaderWriteLock_MinPollDelay;
+        };
+    }
+
+    CrossProcessReaderWriteLock::~CrossProcessReaderWriteLock()
+    {
+        details::CrossProcessReaderWriteLockState* state = m_state;
+        if (!state)
+        {
+            return;
+        }
 
-        result.m_semaphoreReleases = 1;
-        return result;
+        volatile LONG* readerSlot = m_readerSlot;
+        if (readerSlot)
+        {
+            InterlockedExchange(readerSlot, 0);
+        }
+        else
+        {
+            LONG self = GetCurrentProcessIdValue();
+            InterlockedCompareExchange(&state->Writer, 0, self);
+            InterlockedCompareExchange(&state->PendingWriter, 0, self);
+        }
+    }
+
+    CrossProcessReaderWriteLock CrossProcessReaderWriteLock::LockForRead(std::string_view name)
+    {
+        return TryLockForRead(name, std::chrono::milliseconds::max()).value();
     }
 
     CrossProcessReaderWriteLock CrossProcessReaderWriteLock::LockForWrite(std::string_view name)
     {
-        CrossProcessReaderWriteLock result(name);
+        return TryLockForWrite(name, std::chrono::milliseconds::max()).value();
+    }
 
-        DWORD status = 0;
-        auto lock = result.m_mutex.acquire(&status);
-        THROW_HR_IF(E_UNEXPECTED, status != WAIT_OBJECT_0);
+    std::optional<CrossProcessReaderWriteLock> CrossProcessReaderWriteLock::TryLockForRead(std::string_view name, std::chrono::milliseconds timeout)
+    {
+        State* state = GetState(name);
+        Waiter waiter{ timeout };
 
-        for (LONG i = 0; i < s_CrossProcessReaderWriteLock_MaxReaders; ++i)
+        for (;;)
         {
-            // We are taking ownership of releasing these in the destructor
-            status = ::WaitForSingleObjectEx(result.m_semaphore.get(), INFINITE, FALSE);
-            THROW_HR_IF(E_UNEXPECTED, status != WAIT_OBJECT_0);
-            result.m_semaphoreReleases = i + 1;
-        }
+            LONG writer = Load(state->Writer);
+
+            if (writer == 0)
+            {
+                if (Load(state->PendingWriter) == 0 || waiter.Elapsed() >= s_CrossProcessReaderWriteLock_ReaderYieldTime)
+                {
+                    volatile LONG* readerSlot = TryTakeReaderSlot(state);
+                    if (readerSlot)
+                    {
+                        // The writer takes the lock before it checks the readers, so one of the two always sees the other
+                        if (Load(state->Writer) == 0)
+                        {
+                            CrossProcessReaderWriteLock result{ state };
+                            result.m_readerSlot = readerSlot;
+                            return result;
+                        }
 
-        return result;
+                        InterlockedExchange(readerSlot, 0);
+                    }
+                    else if (waiter.IsLongWait())
+                    {
+                        ReclaimReaderSlots(state);
+                    }
+                }
+            }
+            else if (waiter.IsLongWait())
+            {
+                ReclaimWriter(state, writer);
+            }
+
+            if (!waiter.Wait())
+            {
+                return {};
+            }
+        }
     }
 
-    CrossProcessReaderWriteLock::CrossProcessReaderWriteLock(std::string_view name)
+    std::optional<CrossProcessReaderWriteLock> CrossProcessReaderWriteLock::TryLockForWrite(std::string_view name, std::chrono::milliseconds timeout)
     {
-        THROW_HR_IF(E_INVALIDARG, name.find('\\') != std::string::npos);
+        State* state = GetState(name);
+        Waiter waiter{ timeout };
+        LONG self = GetCurrentProcessIdValue();
 
-        std::wstring mutexName = Utility::ConvertToUTF16(name);
-        std::wstring semName = mutexName;
+        // Becoming the pending writer holds back new readers while the existing ones finish
+        for (;;)
+        {
+            LONG pendingWriter = InterlockedCompareExchange(&state->PendingWriter, self, 0);
+            if (pendingWriter == 0)
+            {
+                break;
+            }
+
+            if (waiter.IsLongWait())
+            {
+                ReclaimWriter(state, pendingWriter);
+            }
 
-        mutexName += s_CrossProcessReaderWriteLock_MutexSuffix;
-        semName += s_CrossProcessReaderWriteLock_SemaphoreSuffix;
+            if (!waiter.Wait())
+            {
+                return {};
+            }
+        }
 
-        m_mutex.create(mutexName.c_str(), 0, SYNCHRONIZE);
-        m_semaphore.create(s_CrossProcessReaderWriteLock_MaxReaders, s_CrossProcessReaderWriteLock_MaxReaders, semName.c_str(), SYNCHRONIZE | SEMAPHORE_MODIFY_STATE);
+        // From here, releasing the result releases the pending writer
+        CrossProcessReaderWriteLock result{ state };
+
+        for (;;)
+        {
+            if (!HasReaders(state))
+            {
+                InterlockedExchange(&state->Writer, self);
+
+                // A reader that took a slot before the lock was taken will see it and leave
+                if (!HasReaders(state))
+                {
+                    return result;
+                }
+
+                InterlockedExchange(&state->Writer, 0);
+            }
+            else if (waiter.IsLongWait())
+            {
+                ReclaimReaderSlots(state);
+            }
+
+            if (!waiter.Wait())
+            {
+                return {};
+            }
+        }
     }
 }
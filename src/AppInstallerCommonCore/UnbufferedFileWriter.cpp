@@ -0,0 +1,165 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "UnbufferedFileWriter.h"
+#include "Public/AppInstallerLogging.h"
+
+namespace AppInstaller::Utility
+{
+    namespace
+    {
+        // The size of each buffer; it is a whole number of sectors for any sector size that is used.
+        constexpr size_t s_UnbufferedFileWriter_BufferSize = 1024 * 1024;
+
+        // Used when the file system does not give its sector size, such as for some network shares.
+        constexpr size_t s_UnbufferedFileWriter_DefaultSectorSize = 4096;
+
+        size_t GetSectorSize(HANDLE file)
+        {
+            FILE_STORAGE_INFO storageInfo{};
+            if (GetFileInformationByHandleEx(file, FileStorageInfo, &storageInfo, sizeof(storageInfo)))
+            {
+                size_t result = storageInfo.PhysicalBytesPerSectorForPerformance;
+
+                // Only a power of two that divides the buffers can be used to align them
+                if (result != 0 && (result & (result - 1)) == 0 && result <= s_UnbufferedFileWriter_BufferSize)
+                {
+                    return result;
+                }
+            }
+
+            return s_UnbufferedFileWriter_DefaultSectorSize;
+        }
+    }
+
+    void UnbufferedFileWriter::VirtualFreeDeleter::operator()(void* p) const
+    {
+        VirtualFree(p, 0, MEM_RELEASE);
+    }
+
+    UnbufferedFileWriter::UnbufferedFileWriter(const std::filesystem::path& path)
+    {
+        m_file.reset(CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, TRUNCATE_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED, nullptr));
+
+        if (!m_file && GetLastError() == ERROR_INVALID_PARAMETER)
+        {
+            // Not every file system supports unbuffered I/O; the aligned writes work just as well through the cache
+            AICLI_LOG(Core, Info, << "Unbuffered I/O is not supported for the file, writing it through the cache: " << path);
+            m_file.reset(CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, TRUNCATE_EXISTING,
+                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, nullptr));
+        }
+
+        THROW_LAST_ERROR_IF(!m_file);
+
+        m_sectorSize = GetSectorSize(m_file.get());
+
+        // Allocated memory is page aligned, which is also aligned to any sector size that is used
+        for (auto& buffer : m_buffers)
+        {
+            buffer.reset(static_cast<uint8_t*>(VirtualAlloc(nullptr, s_UnbufferedFileWriter_BufferSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE)));
+            THROW_LAST_ERROR_IF_NULL(buffer);
+        }
+    }
+
+    UnbufferedFileWriter::~UnbufferedFileWriter()
+    {
+        // The buffer and the OVERLAPPED must outlive the write
+        try
+        {
+            WaitForPendingWrite();
+        }
+        CATCH_LOG();
+    }
+
+    void UnbufferedFileWriter::Preallocate(uint64_t size)
+    {
+        FILE_ALLOCATION_INFO allocationInfo{};
+        allocationInfo.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+
+        if (!SetFileInformationByHandle(m_file.get(), FileAllocationInfo, &allocationInfo, sizeof(allocationInfo)))
+        {
+            LOG_LAST_ERROR_MSG("Failed to preallocate %llu bytes for the file", size);
+        }
+    }
+
+    void UnbufferedFileWriter::Write(const void* data, size_t size)
+    {
+        THROW_HR_IF(E_ILLEGAL_METHOD_CALL, m_completed);
+
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        m_size += size;
+
+        while (size > 0)
+        {
+            size_t count = std::min(size, s_UnbufferedFileWriter_BufferSize - m_filled);
+            memcpy(m_buffers[m_current].get() + m_filled, bytes, count);
+
+            m_filled += count;
+            bytes += count;
+            size -= count;
+
+            if (m_filled == s_UnbufferedFileWriter_BufferSize)
+            {
+                StartWrite(s_UnbufferedFileWriter_BufferSize);
+            }
+        }
+    }
+
+    void UnbufferedFileWriter::Complete()
+    {
+        THROW_HR_IF(E_ILLEGAL_METHOD_CALL, m_completed);
+        m_completed = true;
+
+        // The last write is padded to a whole sector, and the padding is removed by setting the size of the file
+        if (m_filled > 0)
+        {
+            size_t alignedSize = (m_filled + m_sectorSize - 1) & ~(m_sectorSize - 1);
+            memset(m_buffers[m_current].get() + m_filled, 0, alignedSize - m_filled);
+            StartWrite(alignedSize);
+        }
+
+        WaitForPendingWrite();
+
+        FILE_END_OF_FILE_INFO endOfFileInfo{};
+        endOfFileInfo.EndOfFile.QuadPart = static_cast<LONGLONG>(m_size);
+        THROW_LAST_ERROR_IF(!SetFileInformationByHandle(m_file.get(), FileEndOfFileInfo, &endOfFileInfo, sizeof(endOfFileInfo)));
+    }
+
+    void UnbufferedFileWriter::StartWrite(size_t size)
+    {
+        // Only one write is in progress at a time, as it is the other buffer that is being written
+        WaitForPendingWrite();
+
+        m_overlapped = {};
+        m_overlapped.hEvent = m_event.get();
+        m_overlapped.Offset = static_cast<DWORD>(m_offset);
+        m_overlapped.OffsetHigh = static_cast<DWORD>(m_offset >> 32);
+
+        if (!WriteFile(m_file.get(), m_buffers[m_current].get(), static_cast<DWORD>(size), nullptr, &m_overlapped))
+        {
+            THROW_LAST_ERROR_IF(GetLastError() != ERROR_IO_PENDING);
+        }
+
+        m_pending = true;
+        m_pendingSize = size;
+        m_offset += size;
+
+        m_current = 1 - m_current;
+        m_filled = 0;
+    }
+
+    void UnbufferedFileWriter::WaitForPendingWrite()
+    {
+        if (!m_pending)
+        {
+            return;
+        }
+
+        m_pending = false;
+
+        DWORD bytesWritten = 0;
+        THROW_LAST_ERROR_IF(!GetOverlappedResult(m_file.get(), &m_overlapped, &bytesWritten, TRUE));
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_WRITE_FAULT), bytesWritten != m_pendingSize);
+    }
+}
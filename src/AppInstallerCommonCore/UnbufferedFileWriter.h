@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <wil/resource.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+namespace AppInstaller::Utility
+{
+    // Writes a file from start to end with unbuffered, overlapped I/O, so that a large download is not copied through
+    // the file cache on its way to the disk. The data is gathered in sector aligned buffers, and one is written while the
+    // next is filled.
+    struct UnbufferedFileWriter
+    {
+        // Opens the existing file and empties it. As the file is not created again, it keeps its alternate streams,
+        // such as the mark of the web.
+        UnbufferedFileWriter(const std::filesystem::path& path);
+
+        UnbufferedFileWriter(const UnbufferedFileWriter&) = delete;
+        UnbufferedFileWriter& operator=(const UnbufferedFileWriter&) = delete;
+
+        UnbufferedFileWriter(UnbufferedFileWriter&&) = delete;
+        UnbufferedFileWriter& operator=(UnbufferedFileWriter&&) = delete;
+
+        // Waits for any write that is still in progress.
+        ~UnbufferedFileWriter();
+
+        // Allocates space for a file of the given size up front, rather than growing the file with each write.
+        // A failure is only logged, as the file can still be written.
+        void Preallocate(uint64_t size);
+
+        // Appends the data to the file.
+        void Write(const void* data, size_t size);
+
+        // Writes the remaining data, and sets the size of the file to the number of bytes given to Write.
+        void Complete();
+
+        // Gets the number of bytes given to Write.
+        uint64_t GetSize() const { return m_size; }
+
+    private:
+        // Starts writing the current buffer, which must be a whole number of sectors, then switches to the other one.
+        void StartWrite(size_t size);
+
+        // Waits for the write in progress, if any, to finish.
+        void WaitForPendingWrite();
+
+        struct VirtualFreeDeleter
+        {
+            void operator()(void* p) const;
+        };
+
+        using AlignedBuffer = std::unique_ptr<uint8_t, VirtualFreeDeleter>;
+
+        wil::unique_hfile m_file;
+        size_t m_sectorSize = 0;
+        AlignedBuffer m_buffers[2];
+        size_t m_current = 0;
+        size_t m_filled = 0;
+
+        wil::unique_event m_event{ wil::EventOptions::ManualReset };
+        OVERLAPPED m_overlapped{};
+        bool m_pending = false;
+        size_t m_pendingSize = 0;
+
+        // The offset of the next write, which is always sector aligned.
+        uint64_t m_offset = 0;
+        uint64_t m_size = 0;
+        bool m_completed = false;
+    };
+}
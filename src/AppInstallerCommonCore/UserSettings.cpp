@@ -10,6 +10,7 @@
 
 namespace AppInstaller::Settings
 {
+    using namespace std::chrono_literals;
     using namespace std::string_view_literals;
     using namespace Runtime;
     using namespace Utility;
@@ -59,14 +60,14 @@ namespace AppInstaller::Settings
 
         std::optional<Json::Value> ParseFile(const StreamDefinition& setting, std::vector<std::string>& warnings)
         {
-            auto stream = GetSettingStream(setting);
-            if (stream)
+            std::optional<std::string> value = GetSetting(setting);
+            if (value)
             {
                 Json::Value root;
                 Json::CharReaderBuilder builder;
                 const std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
 
-                std::string settingsContentStr = Utility::ReadEntireStream(*stream);
+                const std::string& settingsContentStr = value.value();
                 std::string error;
 
                 if (reader->parse(settingsContentStr.c_str(), settingsContentStr.c_str() + settingsContentStr.size(), &root, &error))
@@ -85,7 +86,7 @@ namespace AppInstaller::Settings
         template <Setting S>
         void Validate(
             Json::Value& root,
-            std::map<Setting, details::SettingVariant>& settings,
+            details::SettingValues& settings,
             std::vector<std::string>& warnings)
         {
             // jsoncpp doesn't support std::string_view yet.
@@ -104,7 +105,7 @@ namespace AppInstaller::Settings
                     if (validatedValue.has_value())
                     {
                         // Finally add it to the map
-                        settings[S].emplace<details::SettingIndex(S)>(
+                        settings[static_cast<size_t>(S)].emplace<details::SettingIndex(S)>(
                             std::forward<typename details::SettingMapping<S>::value_t>(validatedValue.value()));
                         AICLI_LOG(Core, Info, << GetSettingsMessage(SettingsMessage::ValidMessage, path, jsonValue.value()));
                     }
@@ -131,7 +132,7 @@ namespace AppInstaller::Settings
         template <size_t... S>
         void ValidateAll(
             Json::Value& root,
-            std::map<Setting, details::SettingVariant>& settings,
+            details::SettingValues& settings,
             std::vector<std::string>& warnings,
             std::index_sequence<S...>)
         {
@@ -145,6 +146,326 @@ namespace AppInstaller::Settings
 #pragma clang diagnostic pop
 #endif
         }
+
+        // The snapshot holds the result of loading the settings files, so that while they are unchanged the settings
+        // are read from it without parsing and validating the files again. It starts with a key made of the size and
+        // last write time of the files, which must match those of the files for it to be used.
+        constexpr std::string_view s_UserSettingsSnapshot_FileName = "UserSettingsSnapshot.bin"sv;
+
+        // Any change to the format of the snapshot must increase this, so that existing snapshots are not used.
+        constexpr uint32_t s_UserSettingsSnapshot_Version = 1;
+
+        // Files written more recently than this are not snapshotted, as a change of the same size within the
+        // resolution of the last write time would not change the key.
+        constexpr std::filesystem::file_time_type::duration s_UserSettingsSnapshot_MinimumFileAge = 2s;
+
+        struct SnapshotFileKey
+        {
+            bool Exists = false;
+            uintmax_t Size = 0;
+            std::filesystem::file_time_type LastWriteTime;
+        };
+
+        SnapshotFileKey GetSnapshotFileKey(const StreamDefinition& setting)
+        {
+            SnapshotFileKey result;
+            std::filesystem::path path = GetPathTo(setting);
+
+            std::error_code error;
+            uintmax_t size = std::filesystem::file_size(path, error);
+            if (error)
+            {
+                return result;
+            }
+
+            std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(path, error);
+            if (error)
+            {
+                return result;
+            }
+
+            result.Exists = true;
+            result.Size = size;
+            result.LastWriteTime = lastWriteTime;
+            return result;
+        }
+
+        struct SnapshotWriter
+        {
+            template <typename T>
+            void Write(const T& value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                m_data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            void WriteString(std::string_view value)
+            {
+                Write(static_cast<uint32_t>(value.size()));
+                m_data.append(value);
+            }
+
+            template <typename T>
+            void WriteValue(const T& value)
+            {
+                if constexpr (std::is_same_v<T, std::string>)
+                {
+                    WriteString(value);
+                }
+                else if constexpr (std::is_enum_v<T> || std::is_arithmetic_v<T>)
+                {
+                    Write(static_cast<int64_t>(value));
+                }
+                else
+                {
+                    // Durations
+                    Write(static_cast<int64_t>(value.count()));
+                }
+            }
+
+            const std::string& Data() const { return m_data; }
+
+        private:
+            std::string m_data;
+        };
+
+        struct SnapshotReader
+        {
+            SnapshotReader(std::string_view data) : m_data(data) {}
+
+            template <typename T>
+            T Read()
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), m_data.size() < sizeof(T));
+
+                T result;
+                memcpy(&result, m_data.data(), sizeof(T));
+                m_data.remove_prefix(sizeof(T));
+                return result;
+            }
+
+            std::string ReadString()
+            {
+                uint32_t size = Read<uint32_t>();
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), m_data.size() < size);
+
+                std::string result{ m_data.substr(0, size) };
+                m_data.remove_prefix(size);
+                return result;
+            }
+
+            template <typename T>
+            T ReadValue()
+            {
+                if constexpr (std::is_same_v<T, std::string>)
+                {
+                    return ReadString();
+                }
+                else if constexpr (std::is_same_v<T, bool>)
+                {
+                    return Read<int64_t>() != 0;
+                }
+                else if constexpr (std::is_enum_v<T> || std::is_arithmetic_v<T>)
+                {
+                    return static_cast<T>(Read<int64_t>());
+                }
+                else
+                {
+                    // Durations
+                    return T{ static_cast<typename T::rep>(Read<int64_t>()) };
+                }
+            }
+
+            bool IsAtEnd() const { return m_data.empty(); }
+
+        private:
+            std::string_view m_data;
+        };
+
+        // Writes the key that the snapshot of the files must match; it also includes the version of the client, whose
+        // settings and validation may differ, and the number of settings.
+        void WriteSnapshotKey(SnapshotWriter& writer, const SnapshotFileKey& primary, const SnapshotFileKey& backup)
+        {
+            writer.Write(s_UserSettingsSnapshot_Version);
+            writer.WriteString(GetClientVersion().get());
+            writer.Write(static_cast<uint32_t>(Setting::Max));
+
+            for (const SnapshotFileKey* file : { &primary, &backup })
+            {
+                writer.Write(static_cast<uint8_t>(file->Exists));
+                writer.Write(static_cast<uint64_t>(file->Size));
+                writer.Write(static_cast<int64_t>(file->LastWriteTime.time_since_epoch().count()));
+            }
+        }
+
+        template <Setting S>
+        void WriteSnapshotSetting(SnapshotWriter& writer, const details::SettingValues& settings)
+        {
+            const auto* value = std::get_if<details::SettingIndex(S)>(&settings[static_cast<size_t>(S)]);
+            if (value)
+            {
+                writer.Write(static_cast<uint32_t>(S));
+                writer.WriteValue(*value);
+            }
+        }
+
+        template <size_t... S>
+        void WriteSnapshotSettings(SnapshotWriter& writer, const details::SettingValues& settings, std::index_sequence<S...>)
+        {
+#ifdef WINGET_DISABLE_FOR_FUZZING
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-value"
+#endif
+            (FoldHelper{}, ..., WriteSnapshotSetting<static_cast<Setting>(S)>(writer, settings));
+#ifdef WINGET_DISABLE_FOR_FUZZING
+#pragma clang diagnostic pop
+#endif
+        }
+
+        template <Setting S>
+        bool ReadSnapshotSetting(SnapshotReader& reader, uint32_t setting, details::SettingValues& settings)
+        {
+            if (setting != static_cast<uint32_t>(S))
+            {
+                return false;
+            }
+
+            settings[static_cast<size_t>(S)].emplace<details::SettingIndex(S)>(reader.ReadValue<typename details::SettingMapping<S>::value_t>());
+            return true;
+        }
+
+        template <size_t... S>
+        void ReadSnapshotSettings(SnapshotReader& reader, uint32_t setting, details::SettingValues& settings, std::index_sequence<S...>)
+        {
+            bool found = (ReadSnapshotSetting<static_cast<Setting>(S)>(reader, setting, settings) || ...);
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), !found);
+        }
+
+        std::filesystem::path GetSnapshotPath()
+        {
+            std::filesystem::path result = GetPathTo(PathName::LocalState);
+            result /= s_UserSettingsSnapshot_FileName;
+            return result;
+        }
+
+        // Loads the settings from the snapshot if its key matches the files; returns false if they must be loaded from the files.
+        bool TryLoadSnapshot(
+            const SnapshotFileKey& primary,
+            const SnapshotFileKey& backup,
+            UserSettingsType& type,
+            std::vector<std::string>& warnings,
+            details::SettingValues& settings)
+        {
+            if (!primary.Exists && !backup.Exists)
+            {
+                return false;
+            }
+
+            try
+            {
+                std::ifstream stream{ GetSnapshotPath(), std::ios::binary };
+                if (!stream)
+                {
+                    return false;
+                }
+
+                std::string data = Utility::ReadEntireStream(stream);
+
+                SnapshotWriter key;
+                WriteSnapshotKey(key, primary, backup);
+                if (data.compare(0, key.Data().size(), key.Data()) != 0)
+                {
+                    AICLI_LOG(Core, Verbose, << "Settings snapshot does not match the settings files");
+                    return false;
+                }
+
+                SnapshotReader reader{ std::string_view{ data }.substr(key.Data().size()) };
+
+                UserSettingsType snapshotType = static_cast<UserSettingsType>(reader.Read<uint8_t>());
+
+                std::vector<std::string> snapshotWarnings(reader.Read<uint32_t>());
+                for (auto& warning : snapshotWarnings)
+                {
+                    warning = reader.ReadString();
+                }
+
+                details::SettingValues snapshotSettings{};
+                for (uint32_t count = reader.Read<uint32_t>(); count > 0; --count)
+                {
+                    ReadSnapshotSettings(reader, reader.Read<uint32_t>(), snapshotSettings, std::make_index_sequence<static_cast<size_t>(Setting::Max)>());
+                }
+
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), !reader.IsAtEnd());
+
+                type = snapshotType;
+                warnings = std::move(snapshotWarnings);
+                settings = std::move(snapshotSettings);
+
+                AICLI_LOG(Core, Info, << "Settings loaded from snapshot");
+                return true;
+            }
+            CATCH_LOG();
+
+            return false;
+        }
+
+        // Saves the loaded settings to the snapshot, if the files are old enough for their key to identify them.
+        void TrySaveSnapshot(
+            const SnapshotFileKey& primary,
+            const SnapshotFileKey& backup,
+            UserSettingsType type,
+            const std::vector<std::string>& warnings,
+            const details::SettingValues& settings)
+        {
+            if (!primary.Exists && !backup.Exists)
+            {
+                return;
+            }
+
+            auto newest = std::filesystem::file_time_type::clock::now() - s_UserSettingsSnapshot_MinimumFileAge;
+            for (const SnapshotFileKey* file : { &primary, &backup })
+            {
+                if (file->Exists && file->LastWriteTime > newest)
+                {
+                    return;
+                }
+            }
+
+            try
+            {
+                SnapshotWriter writer;
+                WriteSnapshotKey(writer, primary, backup);
+
+                writer.Write(static_cast<uint8_t>(type));
+
+                writer.Write(static_cast<uint32_t>(warnings.size()));
+                for (const auto& warning : warnings)
+                {
+                    writer.WriteString(warning);
+                }
+
+                writer.Write(static_cast<uint32_t>(std::count_if(settings.begin(), settings.end(), [](const details::SettingVariant& value) { return value.index() != 0; })));
+                WriteSnapshotSettings(writer, settings, std::make_index_sequence<static_cast<size_t>(Setting::Max)>());
+
+                // Replace the snapshot as a whole, so that other processes never read a partial one
+                std::filesystem::path path = GetSnapshotPath();
+                std::filesystem::create_directories(path.parent_path());
+
+                std::filesystem::path tempPath = path;
+                tempPath += "." + std::to_string(GetCurrentProcessId()) + ".tmp";
+
+                {
+                    std::ofstream stream{ tempPath, std::ios::binary | std::ios::trunc };
+                    THROW_LAST_ERROR_IF(stream.fail());
+                    stream.write(writer.Data().data(), writer.Data().size());
+                    THROW_HR_IF(E_FAIL, stream.fail());
+                }
+
+                std::filesystem::rename(tempPath, path);
+            }
+            CATCH_LOG();
+        }
     }
 
     namespace details
@@ -155,6 +476,60 @@ namespace AppInstaller::Settings
             return std::chrono::minutes(value);
         }
 
+        std::optional<SettingMapping<Setting::SourceScheduledUpdate>::value_t>
+        SettingMapping<Setting::SourceScheduledUpdate>::Validate(const SettingMapping<Setting::SourceScheduledUpdate>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::NetworkDownloadRateLimitInKBps>::value_t>
+        SettingMapping<Setting::NetworkDownloadRateLimitInKBps>::Validate(const SettingMapping<Setting::NetworkDownloadRateLimitInKBps>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::NetworkBackgroundDownloadRateLimitInKBps>::value_t>
+        SettingMapping<Setting::NetworkBackgroundDownloadRateLimitInKBps>::Validate(const SettingMapping<Setting::NetworkBackgroundDownloadRateLimitInKBps>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::InstallerCacheMaxSizeInMB>::value_t>
+        SettingMapping<Setting::InstallerCacheMaxSizeInMB>::Validate(const SettingMapping<Setting::InstallerCacheMaxSizeInMB>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::InstallerCacheMaxAgeInDays>::value_t>
+        SettingMapping<Setting::InstallerCacheMaxAgeInDays>::Validate(const SettingMapping<Setting::InstallerCacheMaxAgeInDays>::json_t& value)
+        {
+            return std::chrono::hours(static_cast<std::chrono::hours::rep>(value) * 24);
+        }
+
+        std::optional<SettingMapping<Setting::MemoryBudgetInMB>::value_t>
+        SettingMapping<Setting::MemoryBudgetInMB>::Validate(const SettingMapping<Setting::MemoryBudgetInMB>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::SearchSourceTimeoutInMilliseconds>::value_t>
+        SettingMapping<Setting::SearchSourceTimeoutInMilliseconds>::Validate(const SettingMapping<Setting::SearchSourceTimeoutInMilliseconds>::json_t& value)
+        {
+            return std::chrono::milliseconds(value);
+        }
+
+        std::optional<SettingMapping<Setting::SearchHedgeRequests>::value_t>
+        SettingMapping<Setting::SearchHedgeRequests>::Validate(const SettingMapping<Setting::SearchHedgeRequests>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::SearchMergeSources>::value_t>
+        SettingMapping<Setting::SearchMergeSources>::Validate(const SettingMapping<Setting::SearchMergeSources>::json_t& value)
+        {
+            return value;
+        }
+
         std::optional<SettingMapping<Setting::ProgressBarVisualStyle>::value_t>
         SettingMapping<Setting::ProgressBarVisualStyle>::Validate(const SettingMapping<Setting::ProgressBarVisualStyle>::json_t& value)
         {
@@ -179,6 +554,36 @@ namespace AppInstaller::Settings
             return {};
         }
 
+        std::optional<SettingMapping<Setting::NetworkDownloader>::value_t>
+        SettingMapping<Setting::NetworkDownloader>::Validate(const SettingMapping<Setting::NetworkDownloader>::json_t& value)
+        {
+            // downloader property possible values
+            static constexpr std::string_view s_downloader_Default = "default";
+            static constexpr std::string_view s_downloader_WinInet = "wininet";
+            static constexpr std::string_view s_downloader_DO = "do";
+
+            if (Utility::CaseInsensitiveEquals(value, s_downloader_Default))
+            {
+                return InstallerDownloader::Default;
+            }
+            else if (Utility::CaseInsensitiveEquals(value, s_downloader_WinInet))
+            {
+                return InstallerDownloader::WinInet;
+            }
+            else if (Utility::CaseInsensitiveEquals(value, s_downloader_DO))
+            {
+                return InstallerDownloader::DeliveryOptimization;
+            }
+
+            return {};
+        }
+
+        std::optional<SettingMapping<Setting::DiagnosticsRecordWorkload>::value_t>
+        SettingMapping<Setting::DiagnosticsRecordWorkload>::Validate(const SettingMapping<Setting::DiagnosticsRecordWorkload>::json_t& value)
+        {
+            return value;
+        }
+
         std::optional<SettingMapping<Setting::EFExperimentalCmd>::value_t>
             SettingMapping<Setting::EFExperimentalCmd>::Validate(const SettingMapping<Setting::EFExperimentalCmd>::json_t& value)
         {
@@ -196,10 +601,84 @@ namespace AppInstaller::Settings
         {
             return value;
         }
+
+        std::optional<SettingMapping<Setting::EFInMemorySearch>::value_t>
+            SettingMapping<Setting::EFInMemorySearch>::Validate(const SettingMapping<Setting::EFInMemorySearch>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::EFSearchResultCache>::value_t>
+            SettingMapping<Setting::EFSearchResultCache>::Validate(const SettingMapping<Setting::EFSearchResultCache>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::EFBackgroundSourceUpdate>::value_t>
+            SettingMapping<Setting::EFBackgroundSourceUpdate>::Validate(const SettingMapping<Setting::EFBackgroundSourceUpdate>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::EFPersistentRangeCache>::value_t>
+            SettingMapping<Setting::EFPersistentRangeCache>::Validate(const SettingMapping<Setting::EFPersistentRangeCache>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::EFInstallerCache>::value_t>
+            SettingMapping<Setting::EFInstallerCache>::Validate(const SettingMapping<Setting::EFInstallerCache>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::EFManifestFetchCache>::value_t>
+            SettingMapping<Setting::EFManifestFetchCache>::Validate(const SettingMapping<Setting::EFManifestFetchCache>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::EFCompletionIndex>::value_t>
+            SettingMapping<Setting::EFCompletionIndex>::Validate(const SettingMapping<Setting::EFCompletionIndex>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::EFServerMode>::value_t>
+            SettingMapping<Setting::EFServerMode>::Validate(const SettingMapping<Setting::EFServerMode>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::EFBatch>::value_t>
+            SettingMapping<Setting::EFBatch>::Validate(const SettingMapping<Setting::EFBatch>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::EFUpgrade>::value_t>
+            SettingMapping<Setting::EFUpgrade>::Validate(const SettingMapping<Setting::EFUpgrade>::json_t& value)
+        {
+            return value;
+        }
+
+        std::optional<SettingMapping<Setting::EFHotIndex>::value_t>
+            SettingMapping<Setting::EFHotIndex>::Validate(const SettingMapping<Setting::EFHotIndex>::json_t& value)
+        {
+            return value;
+        }
     }
 
     UserSettings::UserSettings() : m_type(UserSettingsType::Default)
     {
+        SnapshotFileKey primaryKey = GetSnapshotFileKey(Streams::PrimaryUserSettings);
+        SnapshotFileKey backupKey = GetSnapshotFileKey(Streams::BackupUserSettings);
+
+        if (TryLoadSnapshot(primaryKey, backupKey, m_type, m_warnings, m_settings))
+        {
+            return;
+        }
+
         Json::Value settingsRoot = Json::Value::nullSingleton();
 
         // Settings can be loaded from settings.json or settings.json.backup files.
@@ -236,6 +715,8 @@ namespace AppInstaller::Settings
         {
             AICLI_LOG(Core, Info, << "Valid settings file not found. Using default values.");
         }
+
+        TrySaveSnapshot(primaryKey, backupKey, m_type, m_warnings, m_settings);
     }
 
     void UserSettings::PrepareToShellExecuteFile() const
@@ -15,7 +15,7 @@ namespace AppInstaller::Utility
             size_t newPos = m_version.find_first_of(splitChars, pos);
 
             size_t length = (newPos == std::string::npos ? m_version.length() : newPos) - pos;
-            m_parts.emplace_back(m_version.substr(pos, length));
+            m_parts.emplace_back(std::string_view{ m_version }.substr(pos, length));
 
             pos += length + 1;
         }
@@ -35,6 +35,120 @@ namespace AppInstaller::Utility
         }
     }
 
+    std::string Version::GetSortKey() const
+    {
+        size_t size = 0;
+        for (const Part& part : m_parts)
+        {
+            size += 1 + sizeof(uint64_t);
+            if (!part.Other.empty())
+            {
+                size += part.Other.length() + std::count(part.Other.begin(), part.Other.end(), '\0') + 2;
+            }
+        }
+
+        std::string result;
+        result.reserve(size);
+
+        for (const Part& part : m_parts)
+        {
+            uint8_t integerBytes = 0;
+            for (uint64_t remaining = part.Integer; remaining; remaining >>= 8)
+            {
+                ++integerBytes;
+            }
+
+            result.push_back(static_cast<char>((integerBytes << 1) | (part.Other.empty() ? 0 : 1)));
+
+            for (uint8_t i = integerBytes; i > 0; --i)
+            {
+                result.push_back(static_cast<char>((part.Integer >> ((i - 1) * 8)) & 0xFF));
+            }
+
+            if (!part.Other.empty())
+            {
+                for (char c : part.Other)
+                {
+                    result.push_back(c);
+                    if (c == '\0')
+                    {
+                        result.push_back(static_cast<char>(0xFF));
+                    }
+                }
+
+                result.push_back('\0');
+                result.push_back('\0');
+            }
+        }
+
+        return result;
+    }
+
+    Version Version::FromSortKey(std::string_view sortKey)
+    {
+        Version result;
+        size_t pos = 0;
+
+        while (pos < sortKey.length())
+        {
+            uint8_t header = static_cast<uint8_t>(sortKey[pos++]);
+            uint8_t integerBytes = header >> 1;
+            THROW_HR_IF(E_INVALIDARG, integerBytes > sizeof(uint64_t) || sortKey.length() - pos < integerBytes);
+
+            uint64_t integer = 0;
+            for (uint8_t i = 0; i < integerBytes; ++i)
+            {
+                integer = (integer << 8) | static_cast<uint8_t>(sortKey[pos++]);
+            }
+
+            std::string other;
+            if (header & 1)
+            {
+                for (;;)
+                {
+                    THROW_HR_IF(E_INVALIDARG, pos >= sortKey.length());
+                    char c = sortKey[pos++];
+                    if (c != '\0')
+                    {
+                        other.push_back(c);
+                        continue;
+                    }
+
+                    THROW_HR_IF(E_INVALIDARG, pos >= sortKey.length());
+                    char escape = sortKey[pos++];
+                    if (escape == '\0')
+                    {
+                        break;
+                    }
+
+                    THROW_HR_IF(E_INVALIDARG, escape != static_cast<char>(0xFF));
+                    other.push_back('\0');
+                }
+
+                THROW_HR_IF(E_INVALIDARG, other.empty());
+            }
+
+            if (!result.m_parts.empty())
+            {
+                result.m_version += '.';
+            }
+
+            // A part with no leading integer (or one too large to parse) holds all of its text in Other.
+            if (integer != 0 || other.empty())
+            {
+                result.m_version += std::to_string(integer);
+            }
+            result.m_version += other;
+
+            result.m_parts.emplace_back(integer, std::move(other));
+        }
+
+        // Keys from GetSortKey never end in an empty part, as those are removed when parsing.
+        THROW_HR_IF(E_INVALIDARG, !result.m_parts.empty() && result.m_parts.back().Integer == 0 && result.m_parts.back().Other.empty());
+
+        return result;
+    }
+
     bool Version::operator<(const Version& other) const
     {
         for (size_t i = 0; i < m_parts.size(); ++i)
@@ -101,21 +215,21 @@ namespace AppInstaller::Utility
         return !(*this == other);
     }
 
-    Version::Part::Part(const std::string& part)
+    Version::Part::Part(std::string_view part)
     {
-        const char* begin = part.c_str();
-        char* end = nullptr;
-        errno = 0;
-        Integer = strtoull(begin, &end, 10);
+        const char* begin = part.data();
+        const char* end = begin + part.length();
+        auto [next, error] = std::from_chars(begin, end, Integer);
 
-        if (errno == ERANGE)
+        if (error == std::errc::result_out_of_range)
         {
             Integer = 0;
             Other = part;
         }
-        else if (static_cast<size_t>(end - begin) != part.length())
+        else if (next != end)
         {
-            Other = end;
+            // Other is only assigned when not empty, so that purely numeric parts never allocate.
+            Other.assign(next, end);
         }
     }
 
@@ -17,6 +17,30 @@ namespace AppInstaller::YAML
     {
         Node s_globalInvalidNode;
 
+        // The initial capacity of the output of an emitter, which is enough for most settings and manifests to be written
+        // without the output needing to grow.
+        constexpr size_t s_EmitterOutputCapacity = 4096;
+
+        // The tags that nodes of each type have unless another is given; they are implied by the type rather than stored.
+        constexpr std::string_view s_DefaultScalarTag = "tag:yaml.org,2002:str"sv;
+        constexpr std::string_view s_DefaultSequenceTag = "tag:yaml.org,2002:seq"sv;
+        constexpr std::string_view s_DefaultMappingTag = "tag:yaml.org,2002:map"sv;
+
+        bool IsDefaultTag(Node::Type type, std::string_view tag)
+        {
+            switch (type)
+            {
+            case Node::Type::Scalar:
+                return tag == s_DefaultScalarTag;
+            case Node::Type::Sequence:
+                return tag == s_DefaultSequenceTag;
+            case Node::Type::Mapping:
+                return tag == s_DefaultMappingTag;
+            default:
+                return false;
+            }
+        }
+
         std::string_view GetExceptionTypeStringView(Exception::Type type)
         {
             switch (type)
@@ -128,16 +152,21 @@ namespace AppInstaller::YAML
         return m_what.c_str();
     }
 
-    Node::Node(Type type, std::string tag, const YAML::Mark& mark) :
-        m_type(type), m_tag(std::move(tag)), m_mark(mark)
+    Node::Node(Type type, std::string_view tag, const YAML::Mark& mark) :
+        m_type(type), m_mark(mark)
     {
+        if (!IsDefaultTag(type, tag))
+        {
+            m_tag = tag;
+        }
+
         if (m_type == Type::Sequence)
         {
-            m_sequence = decltype(m_sequence)::value_type{};
+            m_sequence = std::make_shared<std::vector<Node>>();
         }
         else if (m_type == Type::Mapping)
         {
-            m_mapping = decltype(m_mapping)::value_type{};
+            m_mapping = std::make_shared<MappingData>();
         }
     }
 
@@ -156,48 +185,26 @@ namespace AppInstaller::YAML
 
     Node& Node::operator[](std::string_view key)
     {
-        Require(Type::Mapping);
-        auto itrs = m_mapping->equal_range(key);
-
-        if (itrs.first == itrs.second)
-        {
-            return s_globalInvalidNode;
-        }
-
-        Node& result = itrs.first->second;
-
-        THROW_HR_IF(APPINSTALLER_CLI_ERROR_YAML_DUPLICATE_MAPPING_KEY, ++itrs.first != itrs.second);
-
-        return result;
+        const Node* result = FindMappingValue(key);
+        return result ? const_cast<Node&>(*result) : s_globalInvalidNode;
     }
 
     const Node& Node::operator[](std::string_view key) const
     {
-        Require(Type::Mapping);
-        auto itrs = m_mapping->equal_range(key);
-
-        if (itrs.first == itrs.second)
-        {
-            return s_globalInvalidNode;
-        }
-
-        const Node& result = itrs.first->second;
-
-        THROW_HR_IF(APPINSTALLER_CLI_ERROR_YAML_DUPLICATE_MAPPING_KEY, ++itrs.first != itrs.second);
-
-        return result;
+        const Node* result = FindMappingValue(key);
+        return result ? *result : s_globalInvalidNode;
     }
 
     Node& Node::operator[](size_t index)
     {
         Require(Type::Sequence);
-        return m_sequence.value()[index];
+        return (*m_sequence)[index];
     }
 
     const Node& Node::operator[](size_t index) const
     {
         Require(Type::Sequence);
-        return m_sequence.value()[index];
+        return (*m_sequence)[index];
     }
 
     size_t Node::size() const
@@ -211,7 +218,7 @@ namespace AppInstaller::YAML
         case Type::Sequence:
             return m_sequence->size();
         case Type::Mapping:
-            return m_mapping->size();
+            return m_mapping->pairs.size();
         }
 
         THROW_HR(E_UNEXPECTED);
@@ -220,13 +227,70 @@ namespace AppInstaller::YAML
     const std::vector<Node>& Node::Sequence() const
     {
         Require(Type::Sequence);
-        return m_sequence.value();
+        return *m_sequence;
     }
 
-    const std::multimap<Node, Node>& Node::Mapping() const
+    const Node::mapping_t& Node::Mapping() const
     {
         Require(Type::Mapping);
-        return m_mapping.value();
+        return m_mapping->pairs;
+    }
+
+    void Node::IndexMapping()
+    {
+        Require(Type::Mapping);
+
+        const mapping_t& pairs = m_mapping->pairs;
+        auto& index = m_mapping->index;
+
+        index.clear();
+        index.reserve(pairs.size());
+
+        // The keys are all scalars, as the loader requires
+        for (size_t i = 0; i < pairs.size(); ++i)
+        {
+            index.emplace_back(std::hash<std::string_view>{}(pairs[i].first.m_scalar), i);
+        }
+
+        std::sort(index.begin(), index.end());
+    }
+
+    const Node* Node::FindMappingValue(std::string_view key) const
+    {
+        Require(Type::Mapping);
+
+        const mapping_t& pairs = m_mapping->pairs;
+        const auto& index = m_mapping->index;
+        const Node* result = nullptr;
+
+        auto checkPair = [&](const std::pair<Node, Node>& pair)
+        {
+            if (pair.first.m_scalar == key)
+            {
+                THROW_HR_IF(APPINSTALLER_CLI_ERROR_YAML_DUPLICATE_MAPPING_KEY, result != nullptr);
+                result = &pair.second;
+            }
+        };
+
+        if (index.size() == pairs.size())
+        {
+            size_t hash = std::hash<std::string_view>{}(key);
+
+            for (auto itr = std::lower_bound(index.begin(), index.end(), std::make_pair(hash, size_t{ 0 })); itr != index.end() && itr->first == hash; ++itr)
+            {
+                checkPair(pairs[itr->second]);
+            }
+        }
+        else
+        {
+            // The mapping was not indexed by the loader
+            for (const auto& pair : pairs)
+            {
+                checkPair(pair);
+            }
+        }
+
+        return result;
     }
 
     void Node::Require(Type type) const
@@ -263,16 +327,7 @@ namespace AppInstaller::YAML
     Node Load(std::string_view input)
     {
         Wrapper::Parser parser(input);
-        Wrapper::Document document = parser.Load();
-
-        if (document.HasRoot())
-        {
-            return document.GetRoot();
-        }
-        else
-        {
-            return {};
-        }
+        return parser.Load();
     }
 
     Node Load(const std::string& input)
@@ -283,16 +338,7 @@ namespace AppInstaller::YAML
     Node Load(std::istream& input)
     {
         Wrapper::Parser parser(input);
-        Wrapper::Document document = parser.Load();
-
-        if (document.HasRoot())
-        {
-            return document.GetRoot();
-        }
-        else
-        {
-            return {};
-        }
+        return parser.Load();
     }
 
     Node Load(const std::filesystem::path& input)
@@ -303,8 +349,9 @@ namespace AppInstaller::YAML
     }
 
     Emitter::Emitter() :
-        m_document(std::make_unique<Wrapper::Document>(true))
+        m_emitter(std::make_unique<Wrapper::Emitter>(s_EmitterOutputCapacity))
     {
+        m_emitter->Emit(Wrapper::Event::StreamStart());
         SetAllowedInputs<InputType::BeginMap, InputType::BeginSeq>();
     }
 
@@ -318,30 +365,30 @@ namespace AppInstaller::YAML
         switch (event)
         {
         case AppInstaller::YAML::BeginSeq:
-        {
             CheckInput(InputType::BeginSeq);
-            int id = m_document->AddSequence();
-            AppendNode(id);
-            m_containers.emplace(id, false);
+            StartDocumentIfNeeded();
+            m_emitter->Emit(Wrapper::Event::SequenceStart());
+            m_containers.emplace(false);
+            m_scalarInfo = std::nullopt;
             SetAllowedInputsForContainer();
             break;
-        }
         case AppInstaller::YAML::EndSeq:
             CheckInput(InputType::EndSeq);
+            m_emitter->Emit(Wrapper::Event::SequenceEnd());
             m_containers.pop();
             SetAllowedInputsForContainer();
             break;
         case AppInstaller::YAML::BeginMap:
-        {
             CheckInput(InputType::BeginMap);
-            int id = m_document->AddMapping();
-            AppendNode(id);
-            m_containers.emplace(id, true);
+            StartDocumentIfNeeded();
+            m_emitter->Emit(Wrapper::Event::MappingStart());
+            m_containers.emplace(true);
+            m_scalarInfo = std::nullopt;
             SetAllowedInputsForContainer();
             break;
-        }
         case AppInstaller::YAML::EndMap:
             CheckInput(InputType::EndMap);
+            m_emitter->Emit(Wrapper::Event::MappingEnd());
             m_containers.pop();
             SetAllowedInputsForContainer();
             break;
@@ -366,24 +413,21 @@ namespace AppInstaller::YAML
     {
         CheckInput(InputType::Scalar);
 
-        int id = m_document->AddScalar(value);
+        m_emitter->Emit(Wrapper::Event::Scalar(value));
 
         if (!m_scalarInfo)
         {
             // Part of a sequence
-            AppendNode(id);
             // No change to allowed inputs
         }
         else if (m_scalarInfo.value() == InputType::Key)
         {
-            m_keyId = id;
             m_scalarInfo = std::nullopt;
             SetAllowedInputs<InputType::Value, InputType::BeginMap, InputType::BeginSeq>();
         }
         else if (m_scalarInfo.value() == InputType::Value)
         {
             // Mapping pair complete
-            AppendNode(id);
             m_scalarInfo = std::nullopt;
             SetAllowedInputsForContainer();
         }
@@ -397,9 +441,7 @@ namespace AppInstaller::YAML
 
     Emitter& Emitter::operator<<(int64_t value)
     {
-        std::ostringstream stream;
-        stream << value;
-        return operator<<(stream.str());
+        return operator<<(std::to_string(value));
     }
 
     Emitter& Emitter::operator<<(bool value)
@@ -409,31 +451,33 @@ namespace AppInstaller::YAML
 
     std::string Emitter::str()
     {
-        std::ostringstream stream;
-        Wrapper::Emitter emitter(stream);
+        THROW_HR_IF(APPINSTALLER_CLI_ERROR_YAML_INVALID_EMITTER_STATE, !m_emitter || !m_containers.empty());
+
+        // Ended in the same way as dumping a document, which does not end the stream unless the document is empty.
+        if (m_documentStarted)
+        {
+            m_emitter->Emit(Wrapper::Event::DocumentEnd());
+        }
+        else
+        {
+            m_emitter->Emit(Wrapper::Event::StreamEnd());
+        }
 
-        emitter.Dump(*m_document);
-        emitter.Flush();
+        m_emitter->Flush();
 
-        return stream.str();
+        std::string result = m_emitter->TakeOutput();
+        m_emitter.reset();
+        m_allowedInputs = 0;
+
+        return result;
     }
 
-    void Emitter::AppendNode(int id)
+    void Emitter::StartDocumentIfNeeded()
     {
-        if (!m_containers.empty())
+        if (!m_documentStarted)
         {
-            ContainerInfo& ci = m_containers.top();
-
-            if (ci.IsMapping)
-            {
-                THROW_HR_IF(APPINSTALLER_CLI_ERROR_YAML_INVALID_EMITTER_STATE, !m_keyId);
-                m_document->AppendMappingPair(ci.Id, m_keyId.value(), id);
-                m_keyId = std::nullopt;
-            }
-            else
-            {
-                m_document->AppendSequenceItem(ci.Id, id);
-            }
+            m_emitter->Emit(Wrapper::Event::DocumentStart());
+            m_documentStarted = true;
         }
     }
 
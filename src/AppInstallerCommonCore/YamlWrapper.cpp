@@ -7,28 +7,13 @@
 #include "AppInstallerLogging.h"
 #include "AppInstallerStrings.h"
 
+#include <map>
+
 
 namespace AppInstaller::YAML::Wrapper
 {
     namespace
     {
-        Node::Type ConvertNodeType(yaml_node_type_t type)
-        {
-            switch (type)
-            {
-            case YAML_NO_NODE:
-                return Node::Type::None;
-            case YAML_SCALAR_NODE:
-                return Node::Type::Scalar;
-            case YAML_SEQUENCE_NODE:
-                return Node::Type::Sequence;
-            case YAML_MAPPING_NODE:
-                return Node::Type::Mapping;
-            }
-
-            THROW_HR(E_UNEXPECTED);
-        }
-
         Exception::Type ConvertErrorType(yaml_error_type_t type)
         {
             switch (type)
@@ -66,9 +51,10 @@ namespace AppInstaller::YAML::Wrapper
             }
         }
 
-        std::string ConvertScalarToString(yaml_node_t* node)
+        // The tag is only copied if the node keeps it.
+        std::string_view ConvertTag(yaml_char_t* tag)
         {
-            return ConvertYamlString(node->data.scalar.value, node->data.scalar.length);
+            return tag ? std::string_view{ reinterpret_cast<char*>(tag) } : std::string_view{};
         }
 
         Mark ConvertMark(const yaml_mark_t& mark)
@@ -98,99 +84,6 @@ namespace AppInstaller::YAML::Wrapper
         }
     }
 
-    bool Document::HasRoot()
-    {
-        return yaml_document_get_root_node(&m_document) != nullptr;
-    }
-
-    Node Document::GetRoot()
-    {
-        yaml_node_t* root = yaml_document_get_root_node(&m_document);
-
-        if (!root)
-        {
-            return {};
-        }
-
-        Node result(ConvertNodeType(root->type), ConvertYamlString(root->tag), ConvertMark(root->start_mark));
-
-        struct StackItem
-        {
-            StackItem(yaml_node_t* yn, Node* n) :
-                yamlNode(yn), node(n) {}
-
-            yaml_node_t* yamlNode = nullptr;
-            Node* node = nullptr;
-            size_t childOffset = 0;
-        };
-
-        std::stack<StackItem> resultStack;
-        resultStack.emplace(root, &result);
-
-        while (!resultStack.empty())
-        {
-            StackItem& stackItem = resultStack.top();
-            bool pop = false;
-
-            switch (stackItem.yamlNode->type)
-            {
-            case YAML_NO_NODE:
-                pop = true;
-                break;
-            case YAML_SCALAR_NODE:
-                stackItem.node->SetScalar(ConvertScalarToString(stackItem.yamlNode));
-                pop = true;
-                break;
-            case YAML_SEQUENCE_NODE:
-            {
-                yaml_node_item_t* child = stackItem.yamlNode->data.sequence.items.start + stackItem.childOffset++;
-                if (child < stackItem.yamlNode->data.sequence.items.top)
-                {
-                    yaml_node_t* childYamlNode = GetNode(*child);
-                    Node& childNode = stackItem.node->AddSequenceNode(ConvertNodeType(childYamlNode->type), ConvertYamlString(childYamlNode->tag), ConvertMark(childYamlNode->start_mark));
-                    resultStack.emplace(childYamlNode, &childNode);
-                }
-                else
-                {
-                    // We've reached the end of the sequence
-                    pop = true;
-                }
-                break;
-            }
-            case YAML_MAPPING_NODE:
-            {
-                yaml_node_pair_t* child = stackItem.yamlNode->data.mapping.pairs.start + stackItem.childOffset++;
-                if (child < stackItem.yamlNode->data.mapping.pairs.top)
-                {
-                    yaml_node_t* keyYamlNode = GetNode(child->key);
-                    THROW_HR_IF(APPINSTALLER_CLI_ERROR_YAML_INVALID_MAPPING_KEY, keyYamlNode->type != YAML_SCALAR_NODE);
-
-                    Node keyNode(ConvertNodeType(keyYamlNode->type), ConvertYamlString(keyYamlNode->tag), ConvertMark(keyYamlNode->start_mark));
-                    keyNode.SetScalar(ConvertScalarToString(keyYamlNode));
-
-                    yaml_node_t* valueYamlNode = GetNode(child->value);
-
-                    Node& childNode = stackItem.node->AddMappingNode(std::move(keyNode), ConvertNodeType(valueYamlNode->type), ConvertYamlString(valueYamlNode->tag), ConvertMark(valueYamlNode->start_mark));
-                    resultStack.emplace(valueYamlNode, &childNode);
-                }
-                else
-                {
-                    // We've reached the end of the mapping
-                    pop = true;
-                }
-                break;
-            }
-            }
-
-            if (pop)
-            {
-                resultStack.pop();
-            }
-        }
-
-        return result;
-    }
-
     int Document::AddScalar(std::string_view value)
     {
         int result = yaml_document_add_scalar(&m_document, NULL, reinterpret_cast<const yaml_char_t*>(value.data()), static_cast<int>(value.size()), YAML_ANY_SCALAR_STYLE);
@@ -228,13 +121,6 @@ namespace AppInstaller::YAML::Wrapper
         }
     }
 
-    yaml_node_t* Document::GetNode(yaml_node_item_t index)
-    {
-        yaml_node_t* result = yaml_document_get_node(&m_document, index);
-        THROW_HR_IF(E_BOUNDS, !result);
-        return result;
-    }
-
     Parser::Parser(std::string_view input) : m_token(true), m_input(input)
     {
         THROW_HR_IF(APPINSTALLER_CLI_ERROR_YAML_INIT_FAILED, !yaml_parser_initialize(&m_parser));
@@ -261,32 +147,161 @@ namespace AppInstaller::YAML::Wrapper
         }
     }
 
-    Document Parser::Load()
+    Node Parser::Load()
     {
-        Document result;
+        struct StackItem
+        {
+            StackItem(Node* n, std::string a) :
+                node(n), anchor(std::move(a)) {}
+
+            Node* node = nullptr;
+            std::string anchor;
+            // The key of the pair being read, while the node is a mapping; invalid until the key is read.
+            Node key;
+        };
+
+        Node result;
+        std::vector<StackItem> resultStack;
+        std::map<std::string, Node> anchors;
 
-        if (!yaml_parser_load(&m_parser, &result))
+        // Places a node in the collection being read, or at the root if there is none.
+        auto addNode = [&](Node&& node) -> Node&
         {
-            Exception::Type type = ConvertErrorType(m_parser.error);
+            if (resultStack.empty())
+            {
+                result = std::move(node);
+                return result;
+            }
 
-            switch (type)
+            StackItem& parent = resultStack.back();
+
+            if (parent.node->IsSequence())
             {
-            case Exception::Type::Memory:
-                THROW_EXCEPTION(Exception(type));
-            case Exception::Type::Reader:
-                THROW_EXCEPTION(Exception(type, m_parser.problem, m_parser.problem_offset, m_parser.problem_value));
-            case Exception::Type::Scanner:
-            case Exception::Type::Parser:
-            case Exception::Type::Composer:
-                THROW_EXCEPTION(Exception(type, m_parser.problem, ConvertMark(m_parser.problem_mark), m_parser.context, ConvertMark(m_parser.context_mark)));
-            default:
-                THROW_EXCEPTION(Exception(type, "An unexpected error type occurred in Parser::Load"));
+                return parent.node->AddSequenceNode(std::move(node));
             }
+
+            if (!parent.key.IsDefined())
+            {
+                THROW_HR_IF(APPINSTALLER_CLI_ERROR_YAML_INVALID_MAPPING_KEY, !node.IsScalar());
+                parent.key = std::move(node);
+                return parent.key;
+            }
+
+            Node& value = parent.node->AddMappingNode(std::move(parent.key), std::move(node));
+            parent.key = Node{};
+            return value;
+        };
+
+        auto saveAnchor = [&](yaml_char_t* anchor, const Node& node)
+        {
+            if (anchor)
+            {
+                anchors[ConvertYamlString(anchor)] = node;
+            }
+        };
+
+        for (;;)
+        {
+            Event event = Parse();
+            yaml_event_t* yamlEvent = &event;
+
+            switch (yamlEvent->type)
+            {
+            case YAML_NO_EVENT:
+            case YAML_STREAM_START_EVENT:
+            case YAML_DOCUMENT_START_EVENT:
+                break;
+            case YAML_STREAM_END_EVENT:
+            case YAML_DOCUMENT_END_EVENT:
+                return result;
+            case YAML_ALIAS_EVENT:
+            {
+                // Copies of a node share its children, so an alias does not copy the anchored nodes
+                auto anchored = anchors.find(ConvertYamlString(yamlEvent->data.alias.anchor));
+                if (anchored == anchors.end())
+                {
+                    THROW_EXCEPTION(Exception(Exception::Type::Composer, "found undefined alias", ConvertMark(yamlEvent->start_mark)));
+                }
+
+                addNode(Node{ anchored->second });
+                break;
+            }
+            case YAML_SCALAR_EVENT:
+            {
+                Node node(Node::Type::Scalar, ConvertTag(yamlEvent->data.scalar.tag), ConvertMark(yamlEvent->start_mark));
+                node.SetScalar(ConvertYamlString(yamlEvent->data.scalar.value, yamlEvent->data.scalar.length));
+                saveAnchor(yamlEvent->data.scalar.anchor, addNode(std::move(node)));
+                break;
+            }
+            case YAML_SEQUENCE_START_EVENT:
+            {
+                Node& node = addNode(Node{ Node::Type::Sequence, ConvertTag(yamlEvent->data.sequence_start.tag), ConvertMark(yamlEvent->start_mark) });
+                yaml_char_t* anchor = yamlEvent->data.sequence_start.anchor;
+                resultStack.emplace_back(&node, anchor ? ConvertYamlString(anchor) : std::string{});
+                break;
+            }
+            case YAML_MAPPING_START_EVENT:
+            {
+                Node& node = addNode(Node{ Node::Type::Mapping, ConvertTag(yamlEvent->data.mapping_start.tag), ConvertMark(yamlEvent->start_mark) });
+                yaml_char_t* anchor = yamlEvent->data.mapping_start.anchor;
+                resultStack.emplace_back(&node, anchor ? ConvertYamlString(anchor) : std::string{});
+                break;
+            }
+            case YAML_SEQUENCE_END_EVENT:
+            case YAML_MAPPING_END_EVENT:
+            {
+                StackItem& stackItem = resultStack.back();
+
+                // The mapping is indexed once all of its nodes are read
+                if (stackItem.node->IsMap())
+                {
+                    stackItem.node->IndexMapping();
+                }
+
+                if (!stackItem.anchor.empty())
+                {
+                    anchors[std::move(stackItem.anchor)] = *stackItem.node;
+                }
+
+                resultStack.pop_back();
+                break;
+            }
+            }
+        }
+    }
+
+    Event Parser::Parse()
+    {
+        Event result;
+
+        if (!yaml_parser_parse(&m_parser, &result))
+        {
+            ThrowError();
         }
 
+        result.m_token = true;
         return result;
     }
 
+    void Parser::ThrowError()
+    {
+        Exception::Type type = ConvertErrorType(m_parser.error);
+
+        switch (type)
+        {
+        case Exception::Type::Memory:
+            THROW_EXCEPTION(Exception(type));
+        case Exception::Type::Reader:
+            THROW_EXCEPTION(Exception(type, m_parser.problem, m_parser.problem_offset, m_parser.problem_value));
+        case Exception::Type::Scanner:
+        case Exception::Type::Parser:
+        case Exception::Type::Composer:
+            THROW_EXCEPTION(Exception(type, m_parser.problem, ConvertMark(m_parser.problem_mark), m_parser.context, ConvertMark(m_parser.context_mark)));
+        default:
+            THROW_EXCEPTION(Exception(type, "An unexpected error type occurred in Parser"));
+        }
+    }
+
     void Parser::PrepareInput()
     {
         constexpr char c_utf16BOM[2] = { static_cast<char>(0xFF), static_cast<char>(0xFE) };
@@ -395,6 +410,15 @@ namespace AppInstaller::YAML::Wrapper
         return result;
     }
 
+    Event Event::Scalar(std::string_view value)
+    {
+        Event result;
+        // Implicit for both plain and quoted styles, as when dumping a scalar with the default tag.
+        THROW_HR_IF(APPINSTALLER_CLI_ERROR_YAML_INIT_FAILED, !yaml_scalar_event_initialize(&result, NULL, NULL,
+            reinterpret_cast<const yaml_char_t*>(value.data()), static_cast<int>(value.size()), 1, 1, YAML_ANY_SCALAR_STYLE));
+        return result;
+    }
+
     Event Event::SequenceEnd()
     {
         Event result;
@@ -424,6 +448,16 @@ namespace AppInstaller::YAML::Wrapper
         yaml_emitter_set_encoding(&m_emitter, YAML_UTF8_ENCODING);
     }
 
+    Emitter::Emitter(size_t outputCapacity) :
+        m_token(true)
+    {
+        m_output.reserve(outputCapacity);
+
+        THROW_HR_IF(APPINSTALLER_CLI_ERROR_YAML_INIT_FAILED, !yaml_emitter_initialize(&m_emitter));
+        yaml_emitter_set_output(&m_emitter, StreamWriteHandler, this);
+        yaml_emitter_set_encoding(&m_emitter, YAML_UTF8_ENCODING);
+    }
+
     Emitter::~Emitter()
     {
         if (m_token)
@@ -467,6 +501,11 @@ namespace AppInstaller::YAML::Wrapper
         }
     }
 
+    std::string Emitter::TakeOutput()
+    {
+        return std::move(m_output);
+    }
+
     int Emitter::StreamWriteHandler(
         void* data,
         unsigned char* buffer,
@@ -476,7 +515,14 @@ namespace AppInstaller::YAML::Wrapper
 
         try
         {
-            emitter.m_outputStream->write(reinterpret_cast<char*>(buffer), size);
+            if (emitter.m_outputStream)
+            {
+                emitter.m_outputStream->write(reinterpret_cast<char*>(buffer), size);
+            }
+            else
+            {
+                emitter.m_output.append(reinterpret_cast<char*>(buffer), size);
+            }
         }
         catch (...)
         {
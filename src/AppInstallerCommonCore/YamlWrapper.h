@@ -33,12 +33,6 @@ namespace AppInstaller::YAML::Wrapper
         // it has been handed off to the emitter.
         void Detach() { m_token = false; }
 
-        // Determines whether the document has a root node.
-        bool HasRoot();
-
-        // Gets the root node of the document, if it has one.
-        Node GetRoot();
-
         // Adds a scalar node to the document.
         int AddScalar(std::string_view value);
 
@@ -55,13 +49,12 @@ namespace AppInstaller::YAML::Wrapper
         void AppendMappingPair(int mapping, int key, int value);
 
     private:
-        // Gets the node referenced by the index.
-        yaml_node_t* GetNode(yaml_node_item_t index);
-
         DestructionToken m_token;
         yaml_document_t m_document;
     };
 
+    struct Event;
+
     // A libyaml yaml_parser_t.
     // The core parser construct for reading bytes directly.
     struct Parser
@@ -79,10 +72,16 @@ namespace AppInstaller::YAML::Wrapper
 
         yaml_parser_t* operator&() { return &m_parser; }
 
-        // Loads the next document from the input, if one exists.
-        Document Load();
+        // Loads the next document from the input; returns an invalid node if there are no more documents.
+        // The nodes are built directly from the parser events rather than from a libyaml document.
+        Node Load();
 
     private:
+        // Gets the next event from the input.
+        Event Parse();
+
+        [[noreturn]] void ThrowError();
+
         // Determines the type of encoding in use, transforming the input as necessary.
         void PrepareInput();
 
@@ -115,11 +114,15 @@ namespace AppInstaller::YAML::Wrapper
         static Event DocumentStart();
         static Event DocumentEnd();
         static Event SequenceStart();
+        // The value is copied into the event.
+        static Event Scalar(std::string_view value);
         static Event SequenceEnd();
         static Event MappingStart();
         static Event MappingEnd();
 
     private:
+        friend Parser;
+
         Event() = default;
 
         DestructionToken m_token;
@@ -132,6 +135,9 @@ namespace AppInstaller::YAML::Wrapper
     {
         Emitter(std::ostream& output);
 
+        // Writes to a buffer owned by the emitter, reserving the given capacity for the output up front.
+        Emitter(size_t outputCapacity);
+
         Emitter(const Emitter&) = delete;
         Emitter& operator=(const Emitter&) = delete;
 
@@ -152,6 +158,9 @@ namespace AppInstaller::YAML::Wrapper
         // Flushes the emitter.
         void Flush();
 
+        // Takes the output written to the buffer owned by the emitter.
+        std::string TakeOutput();
+
     private:
         static int StreamWriteHandler(
             void* data,
@@ -163,5 +172,6 @@ namespace AppInstaller::YAML::Wrapper
         DestructionToken m_token;
         yaml_emitter_t m_emitter;
         std::ostream* m_outputStream = nullptr;
+        std::string m_output;
     };
 }
@@ -16,7 +16,11 @@
 #include <yaml.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
 #include <chrono>
+#include <condition_variable>
 #include <cwctype>
 #include <filesystem>
 #include <fstream>
@@ -26,7 +30,10 @@
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <ostream>
+#include <queue>
 #include <regex>
 #include <set>
 #include <string>
@@ -2,13 +2,715 @@
 // Licensed under the MIT License.
 #include "pch.h"
 #include "AggregatedSource.h"
+#include "SourceLatencies.h"
+
+#include <condition_variable>
+#include <future>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 
 namespace AppInstaller::Repository
 {
+    // Holds the function that opens the source until it is used. A failure to open is not kept, so the next use tries again.
+    struct DeferredSource : public ISource
+    {
+        DeferredSource(const SourceDetails& details, std::function<std::shared_ptr<ISource>()> open) :
+            m_details(details), m_open(std::move(open)) {}
+
+        // The details that the source was configured with, which are known without opening it.
+        const SourceDetails& GetDetails() const override { return m_details; }
+
+        SearchResult Search(const SearchRequest& request) override { return Get()->Search(request); }
+
+        std::unique_ptr<ISearchCursor> OpenSearchCursor(const SearchRequest& request) override { return Get()->OpenSearchCursor(request); }
+
+        SearchResult SearchForIds(const std::vector<std::string>& ids) override { return Get()->SearchForIds(ids); }
+
+        bool MayContainId(std::string_view id) const override { return Get()->MayContainId(id); }
+
+        bool SupportsConcurrentSearches() const override { return Get()->SupportsConcurrentSearches(); }
+
+        // A source that was never opened did not find the package, so it is not opened to look for its installer.
+        bool TryGetInstaller(const std::vector<uint8_t>& sha256, const std::filesystem::path& destination) const override
+        {
+            std::shared_ptr<ISource> source;
+            {
+                std::lock_guard<std::mutex> lock{ m_lock };
+                source = m_source;
+            }
+
+            return source && source->TryGetInstaller(sha256, destination);
+        }
+
+        // Determines if the source has been opened.
+        bool IsOpen() const
+        {
+            std::lock_guard<std::mutex> lock{ m_lock };
+            return static_cast<bool>(m_source);
+        }
+
+        // Gets the source, opening it if it is not yet open.
+        std::shared_ptr<ISource> Get() const
+        {
+            std::lock_guard<std::mutex> lock{ m_lock };
+
+            if (!m_source)
+            {
+                AICLI_LOG(Repo, Info, << "Opening deferred source: " << m_details.Name);
+                m_source = m_open();
+                THROW_HR_IF(E_UNEXPECTED, !m_source);
+            }
+
+            return m_source;
+        }
+
+    private:
+        SourceDetails m_details;
+        std::function<std::shared_ptr<ISource>()> m_open;
+        mutable std::mutex m_lock;
+        mutable std::shared_ptr<ISource> m_source;
+    };
+
+    struct PendingSearches
+    {
+        PendingSearches() = default;
+
+        PendingSearches(const PendingSearches&) = delete;
+        PendingSearches& operator=(const PendingSearches&) = delete;
+
+        // The searches were cancelled when they were no longer waited for, so they should not take long to see it.
+        ~PendingSearches()
+        {
+            for (auto& thread : m_threads)
+            {
+                thread.join();
+            }
+        }
+
+        void Add(std::thread&& thread)
+        {
+            std::lock_guard<std::mutex> lock{ m_lock };
+            m_threads.emplace_back(std::move(thread));
+        }
+
+    private:
+        std::mutex m_lock;
+        std::vector<std::thread> m_threads;
+    };
+
+    namespace
+    {
+        // The number of results read from a source at a time while merging.
+        constexpr size_t s_MergeBatchSize = 64;
+
+        // A duplicate of a search is sent once it has taken longer than this fraction of the recent searches of its source.
+        constexpr double s_HedgeLatencyPercentile = 0.95;
+
+        // While waiting for a source, the progress of the search is checked this often for its cancellation.
+        constexpr std::chrono::milliseconds s_CancellationPollInterval{ 100 };
+
+#ifndef AICLI_DISABLE_TEST_HOOKS
+        // Lets tests set the search policy without changing the user settings.
+        static std::atomic_bool s_SearchPolicy_TestHook_IsOverridden = false;
+        static std::atomic<int64_t> s_SearchPolicy_TestHook_Timeout = 0;
+        static std::atomic_bool s_SearchPolicy_TestHook_Hedge = false;
+#endif
+
+        // How long each source is given to answer a search, and whether a slow search is duplicated, from the user settings.
+        struct SearchPolicy
+        {
+            SearchPolicy()
+            {
+#ifndef AICLI_DISABLE_TEST_HOOKS
+                if (s_SearchPolicy_TestHook_IsOverridden)
+                {
+                    Timeout = std::chrono::milliseconds{ s_SearchPolicy_TestHook_Timeout };
+                    Hedge = s_SearchPolicy_TestHook_Hedge;
+                    return;
+                }
+#endif
+                Timeout = Settings::User().Get<Settings::Setting::SearchSourceTimeoutInMilliseconds>();
+                Hedge = Settings::User().Get<Settings::Setting::SearchHedgeRequests>();
+            }
+
+            bool IsEnabled() const { return Timeout.count() > 0 || Hedge; }
+
+            std::chrono::milliseconds Timeout{};
+            bool Hedge = false;
+        };
+
+        // A search of one source that is given a limited time to open its cursor, and that sends a duplicate of itself
+        // if it is slower than the source usually is. The first attempt to open a cursor gives it, and the others are
+        // cancelled. An attempt that is no longer waited for runs on until it sees the cancellation, holding what it uses.
+        struct SourceSearch : public std::enable_shared_from_this<SourceSearch>
+        {
+            SourceSearch(std::shared_ptr<ISource> source, const SearchRequest& request) :
+                m_source(std::move(source)), m_request(request), m_name(m_source->GetDetails().Name), m_started(std::chrono::steady_clock::now())
+            {
+                // Each attempt is given its own progress, so that those that lose can be cancelled alone
+                m_request.Progress = nullptr;
+            }
+
+            // Starts another attempt at the search, on its own thread.
+            void Start(PendingSearches& pending)
+            {
+                ProgressCallback* progress = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock{ m_lock };
+                    progress = &m_progress.emplace_back();
+                    ++m_running;
+                }
+
+                try
+                {
+                    pending.Add(std::thread([self = shared_from_this(), progress]() { self->Run(*progress); }));
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock{ m_lock };
+                    --m_running;
+                    throw;
+                }
+            }
+
+            // Waits for an attempt to open the cursor, starting a duplicate once the search is slower than usual.
+            // Returns null if the timeout passes first. If every attempt fails, the first failure is rethrown.
+            std::unique_ptr<ISearchCursor> Wait(PendingSearches& pending, const SearchPolicy& policy, IProgressCallback* progress)
+            {
+                using clock = std::chrono::steady_clock;
+
+                std::optional<clock::time_point> deadline;
+                if (policy.Timeout.count() > 0)
+                {
+                    deadline = m_started + policy.Timeout;
+                }
+
+                // A duplicate of a search that can only be answered one at a time would only wait behind it
+                std::optional<clock::time_point> hedgeAt;
+                if (policy.Hedge && m_source->SupportsConcurrentSearches())
+                {
+                    auto usual = SourceLatencies::Instance().GetPercentile(m_name, s_HedgeLatencyPercentile);
+                    if (usual)
+                    {
+                        hedgeAt = m_started + usual.value();
+                    }
+                }
+
+                std::unique_lock<std::mutex> lock{ m_lock };
+
+                for (;;)
+                {
+                    if (m_cursor)
+                    {
+                        m_winner = m_cursorProgress;
+                        CancelAttempts();
+                        std::chrono::milliseconds latency = m_latency;
+                        std::unique_ptr<ISearchCursor> result = std::move(m_cursor);
+                        lock.unlock();
+
+                        SourceLatencies::Instance().Record(m_name, latency);
+                        return result;
+                    }
+
+                    if (m_running == 0)
+                    {
+                        CancelAttempts();
+                        THROW_HR_IF(E_UNEXPECTED, !m_failure);
+                        std::rethrow_exception(m_failure);
+                    }
+
+                    clock::time_point now = clock::now();
+
+                    if (deadline && now >= deadline.value())
+                    {
+                        AICLI_LOG(Repo, Warning, << "Source '" << m_name << "' did not respond to the search within " << policy.Timeout.count() << "ms; its results are left out");
+                        CancelAttempts();
+                        lock.unlock();
+
+                        // The search took at least this long, which is what the next one should expect
+                        SourceLatencies::Instance().Record(m_name, policy.Timeout);
+                        return {};
+                    }
+
+                    if (progress && progress->IsCancelled())
+                    {
+                        CancelAttempts();
+                        THROW_HR(E_ABORT);
+                    }
+
+                    if (hedgeAt && now >= hedgeAt.value())
+                    {
+                        AICLI_LOG(Repo, Info, << "Source '" << m_name << "' is slower to respond than usual, sending a duplicate of the search");
+                        hedgeAt.reset();
+                        lock.unlock();
+                        Start(pending);
+                        lock.lock();
+                        continue;
+                    }
+
+                    clock::time_point wake = clock::time_point::max();
+                    if (deadline)
+                    {
+                        wake = std::min(wake, deadline.value());
+                    }
+                    if (hedgeAt)
+                    {
+                        wake = std::min(wake, hedgeAt.value());
+                    }
+                    if (progress)
+                    {
+                        wake = std::min(wake, now + s_CancellationPollInterval);
+                    }
+
+                    if (wake == clock::time_point::max())
+                    {
+                        m_changed.wait(lock);
+                    }
+                    else
+                    {
+                        m_changed.wait_until(lock, wake);
+                    }
+                }
+            }
+
+            // Cancels every attempt of a search that is no longer waited for.
+            void Abandon()
+            {
+                std::lock_guard<std::mutex> lock{ m_lock };
+                CancelAttempts();
+            }
+
+        private:
+            void Run(ProgressCallback& progress)
+            {
+                SearchRequest request = m_request;
+                request.Progress = &progress;
+
+                auto start = std::chrono::steady_clock::now();
+                std::unique_ptr<ISearchCursor> cursor;
+                std::exception_ptr failure;
+
+                try
+                {
+                    cursor = m_source->OpenSearchCursor(request);
+                }
+                catch (...)
+                {
+                    failure = std::current_exception();
+                }
+
+                auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+                // A cursor that is not used is destroyed after the lock is released, as it was declared before it
+                std::lock_guard<std::mutex> lock{ m_lock };
+                --m_running;
+
+                if (cursor && !m_cursor && !m_finished)
+                {
+                    m_cursor = std::move(cursor);
+                    m_cursorProgress = &progress;
+                    m_latency = latency;
+                }
+                else if (failure && !m_failure)
+                {
+                    m_failure = failure;
+                }
+
+                m_changed.notify_all();
+            }
+
+            // *Must be called with the lock held*
+            // The attempt whose cursor was taken keeps its progress, as the cursor may still use it.
+            void CancelAttempts()
+            {
+                m_finished = true;
+                for (auto& progress : m_progress)
+                {
+                    if (&progress != m_winner)
+                    {
+                        progress.Cancel();
+                    }
+                }
+            }
+
+            std::shared_ptr<ISource> m_source;
+            SearchRequest m_request;
+            std::string m_name;
+            std::chrono::steady_clock::time_point m_started;
+
+            std::mutex m_lock;
+            std::condition_variable m_changed;
+            std::list<ProgressCallback> m_progress;
+            size_t m_running = 0;
+            bool m_finished = false;
+            std::unique_ptr<ISearchCursor> m_cursor;
+            ProgressCallback* m_cursorProgress = nullptr;
+            ProgressCallback* m_winner = nullptr;
+            std::chrono::milliseconds m_latency{};
+            std::exception_ptr m_failure;
+        };
+
+        // The copies of a package that several sources have, found by the same id.
+        // They are kept in the order of their sources, which is the order in which they are preferred.
+        struct PackageCopies
+        {
+            struct Copy
+            {
+                std::unique_ptr<IApplication> Application;
+                size_t SourceIndex = 0;
+            };
+
+            void Add(std::unique_ptr<IApplication> application, size_t sourceIndex)
+            {
+                auto position = std::upper_bound(Copies.begin(), Copies.end(), sourceIndex, [](size_t index, const Copy& copy) { return index < copy.SourceIndex; });
+                Copies.insert(position, Copy{ std::move(application), sourceIndex });
+                Versions.reset();
+            }
+
+            // Gets the versions of all of the copies, sorted as a single application gives them, with the position of the copy
+            // that each is taken from. A version that several copies have is taken from the first of them.
+            const std::vector<std::pair<Utility::VersionAndChannel, size_t>>& GetVersions()
+            {
+                if (!Versions)
+                {
+                    std::vector<std::pair<Utility::VersionAndChannel, size_t>> versions;
+                    for (size_t i = 0; i < Copies.size(); ++i)
+                    {
+                        for (auto& version : Copies[i].Application->GetVersions())
+                        {
+                            versions.emplace_back(std::move(version), i);
+                        }
+                    }
+
+                    // The stable sort keeps the copies of a version in the order of their sources
+                    std::stable_sort(versions.begin(), versions.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+                    versions.erase(std::unique(versions.begin(), versions.end(),
+                        [](const auto& a, const auto& b) { return !(a.first < b.first) && !(b.first < a.first); }), versions.end());
+
+                    Versions = std::move(versions);
+                }
+
+                return Versions.value();
+            }
+
+            std::vector<Copy> Copies;
+            std::optional<std::vector<std::pair<Utility::VersionAndChannel, size_t>>> Versions;
+        };
+
+        // The copies of a package as a single application, with the versions of all of them.
+        // The id and name are those of the most preferred copy; the cursor adds the copies that it finds later to the same application.
+        struct AggregatedApplication : public IApplication
+        {
+            AggregatedApplication(std::shared_ptr<PackageCopies> package) : m_package(std::move(package)) {}
+
+            Utility::LocIndString GetId() override
+            {
+                return m_package->Copies.front().Application->GetId();
+            }
+
+            Utility::LocIndString GetName() override
+            {
+                return m_package->Copies.front().Application->GetName();
+            }
+
+            std::optional<Manifest::Manifest> GetManifest(const Utility::NormalizedString& version, const Utility::NormalizedString& channel) override
+            {
+                if (m_package->Copies.size() == 1)
+                {
+                    return m_package->Copies.front().Application->GetManifest(version, channel);
+                }
+
+                if (version.empty())
+                {
+                    // The latest version in the channel of any of the copies
+                    Utility::Channel requested{ channel };
+                    for (const auto& [available, copy] : m_package->GetVersions())
+                    {
+                        if (!(available.GetChannel() < requested) && !(requested < available.GetChannel()))
+                        {
+                            return m_package->Copies[copy].Application->GetManifest(available.GetVersion().ToString(), channel);
+                        }
+                    }
+
+                    return {};
+                }
+
+                for (const auto& copy : m_package->Copies)
+                {
+                    std::optional<Manifest::Manifest> manifest = copy.Application->GetManifest(version, channel);
+                    if (manifest)
+                    {
+                        return manifest;
+                    }
+                }
+
+                return {};
+            }
+
+            std::vector<Utility::VersionAndChannel> GetVersions() override
+            {
+                if (m_package->Copies.size() == 1)
+                {
+                    return m_package->Copies.front().Application->GetVersions();
+                }
+
+                std::vector<Utility::VersionAndChannel> result;
+                for (const auto& version : m_package->GetVersions())
+                {
+                    result.emplace_back(version.first);
+                }
+
+                return result;
+            }
+
+            std::vector<Utility::VersionAndChannel> GetVersions(const VersionQuery& query) override
+            {
+                if (m_package->Copies.size() == 1)
+                {
+                    return m_package->Copies.front().Application->GetVersions(query);
+                }
+
+                return query.Apply(GetVersions());
+            }
+
+            // Each copy is asked for the versions that are taken from it, together, so that a source can still fetch them at once.
+            std::vector<std::optional<Manifest::Manifest>> GetManifests(const std::vector<Utility::VersionAndChannel>& versions) override
+            {
+                if (m_package->Copies.size() == 1)
+                {
+                    return m_package->Copies.front().Application->GetManifests(versions);
+                }
+
+                const auto& available = m_package->GetVersions();
+
+                std::vector<std::vector<size_t>> positionsByCopy(m_package->Copies.size());
+                for (size_t i = 0; i < versions.size(); ++i)
+                {
+                    auto itr = std::lower_bound(available.begin(), available.end(), versions[i], [](const auto& a, const Utility::VersionAndChannel& b) { return a.first < b; });
+                    if (itr != available.end() && !(versions[i] < itr->first))
+                    {
+                        positionsByCopy[itr->second].emplace_back(i);
+                    }
+                }
+
+                std::vector<std::optional<Manifest::Manifest>> result(versions.size());
+                for (size_t copy = 0; copy < positionsByCopy.size(); ++copy)
+                {
+                    if (positionsByCopy[copy].empty())
+                    {
+                        continue;
+                    }
+
+                    std::vector<Utility::VersionAndChannel> copyVersions;
+                    for (size_t position : positionsByCopy[copy])
+                    {
+                        copyVersions.emplace_back(versions[position]);
+                    }
+
+                    auto manifests = m_package->Copies[copy].Application->GetManifests(copyVersions);
+                    for (size_t i = 0; i < manifests.size() && i < positionsByCopy[copy].size(); ++i)
+                    {
+                        result[positionsByCopy[copy][i]] = std::move(manifests[i]);
+                    }
+                }
+
+                return result;
+            }
+
+        private:
+            std::shared_ptr<PackageCopies> m_package;
+        };
+
+        // Merges the results of the sources by their scores as they are read. Equal scores are taken from the earlier source
+        // first, giving the same order as a stable sort of all of the results in source order.
+        // A package with the same id in several sources is a single result, at the place of its best match; see AggregatedApplication.
+        struct AggregatedSearchCursor : public ISearchCursor
+        {
+            AggregatedSearchCursor(const std::vector<std::shared_ptr<ISource>>& sources, const SearchRequest& request, PendingSearches& pending) :
+                m_maximumResults(request.MaximumResults),
+                m_mergePackages(sources.size() > 1 && Settings::User().Get<Settings::Setting::SearchMergeSources>())
+            {
+                m_sources.resize(sources.size());
+
+                for (size_t i = 0; i < sources.size(); ++i)
+                {
+                    m_sources[i].Name = sources[i]->GetDetails().Name;
+                }
+
+                SearchPolicy policy;
+                if (policy.IsEnabled())
+                {
+                    // As below, all of the sources are searched at once; those that do not answer in time are left out.
+                    for (size_t i = 0; i < sources.size(); ++i)
+                    {
+                        m_sources[i].Search = std::make_shared<SourceSearch>(sources[i], request);
+                        m_sources[i].Search->Start(pending);
+                    }
+
+                    try
+                    {
+                        for (auto& source : m_sources)
+                        {
+                            source.Cursor = source.Search->Wait(pending, policy, request.Progress);
+                            if (!source.Cursor)
+                            {
+                                m_missingSources.emplace_back(source.Name);
+                            }
+                        }
+                    }
+                    catch (...)
+                    {
+                        for (auto& source : m_sources)
+                        {
+                            source.Search->Abandon();
+                        }
+                        throw;
+                    }
+                }
+                else if (sources.size() == 1)
+                {
+                    m_sources[0].Cursor = sources[0]->OpenSearchCursor(request);
+                }
+                else
+                {
+                    // Search all of the sources at once, so that the time taken is that of the slowest source rather than the sum of them.
+                    std::vector<std::future<std::unique_ptr<ISearchCursor>>> searches;
+                    searches.reserve(sources.size());
+
+                    for (const auto& source : sources)
+                    {
+                        searches.emplace_back(std::async(std::launch::async, [&source, &request]() { return source->OpenSearchCursor(request); }));
+                    }
+
+                    for (size_t i = 0; i < searches.size(); ++i)
+                    {
+                        m_sources[i].Cursor = searches[i].get();
+                    }
+                }
+            }
+
+            std::vector<ResultMatch> Next(size_t count) override
+            {
+                std::vector<ResultMatch> result;
+
+                while (result.size() < count)
+                {
+                    // There are only ever a few sources, so the next match is found by checking each of them.
+                    SourceResults* next = nullptr;
+
+                    for (auto& source : m_sources)
+                    {
+                        if (source.HasNext() && (!next || IsBetterMatch(source.Peek(), next->Peek())))
+                        {
+                            next = &source;
+                        }
+                    }
+
+                    if (!next)
+                    {
+                        break;
+                    }
+
+                    size_t sourceIndex = static_cast<size_t>(next - m_sources.data());
+                    std::string packageId;
+
+                    if (m_mergePackages && next->Peek().Application)
+                    {
+                        packageId = Utility::FoldCase(next->Peek().Application->GetId().get());
+
+                        // A package that an earlier result already has is added to it, rather than being a result of its own
+                        auto itr = m_packages.find(packageId);
+                        if (itr != m_packages.end())
+                        {
+                            itr->second->Add(next->Take().Application, sourceIndex);
+                            continue;
+                        }
+                    }
+
+                    if (m_maximumResults > 0 && m_resultCount >= m_maximumResults)
+                    {
+                        m_truncated = true;
+                        break;
+                    }
+
+                    ResultMatch match = next->Take();
+                    match.SourceName = next->Name;
+
+                    if (!packageId.empty())
+                    {
+                        auto package = std::make_shared<PackageCopies>();
+                        package->Add(std::move(match.Application), sourceIndex);
+                        m_packages.emplace(std::move(packageId), package);
+                        match.Application = std::make_unique<AggregatedApplication>(std::move(package));
+                    }
+
+                    result.emplace_back(std::move(match));
+                    ++m_resultCount;
+                }
+
+                return result;
+            }
+
+            bool IsTruncated() const override
+            {
+                // If a source did not return all of its matches, neither can the aggregate.
+                return m_truncated || std::any_of(m_sources.begin(), m_sources.end(), [](const SourceResults& source) { return source.Cursor && source.Cursor->IsTruncated(); });
+            }
+
+            std::vector<std::string> GetMissingSources() const override
+            {
+                return m_missingSources;
+            }
+
+        private:
+            // The results read from one source that are not yet merged.
+            struct SourceResults
+            {
+                // Holds the progress of the attempt that opened the cursor, which the cursor may use, so it is declared before it.
+                std::shared_ptr<SourceSearch> Search;
+                // Null if the source did not answer in time.
+                std::unique_ptr<ISearchCursor> Cursor;
+                std::string Name;
+                std::vector<ResultMatch> Buffer;
+                size_t Position = 0;
+                bool Exhausted = false;
+
+                bool HasNext()
+                {
+                    if (Position == Buffer.size() && !Exhausted && Cursor)
+                    {
+                        Buffer = Cursor->Next(s_MergeBatchSize);
+                        Position = 0;
+                        Exhausted = (Buffer.size() < s_MergeBatchSize);
+                    }
+
+                    return Position < Buffer.size();
+                }
+
+                const ResultMatch& Peek() const { return Buffer[Position]; }
+
+                ResultMatch Take() { return std::move(Buffer[Position++]); }
+            };
+
+            std::vector<SourceResults> m_sources;
+            size_t m_maximumResults;
+            size_t m_resultCount = 0;
+            bool m_truncated = false;
+            std::vector<std::string> m_missingSources;
+
+            // The packages of the results so far, by folded id.
+            bool m_mergePackages;
+            std::unordered_map<std::string, std::shared_ptr<PackageCopies>> m_packages;
+        };
+    }
+
     AggregatedSource::AggregatedSource()
     {
         m_details.Name = "AggregatedSource";
         m_details.IsAggregated = true;
+        m_pendingSearches = std::make_shared<PendingSearches>();
     }
 
     const SourceDetails& AppInstaller::Repository::AggregatedSource::GetDetails() const
@@ -21,56 +723,172 @@ namespace AppInstaller::Repository
         m_sources.emplace_back(std::move(source));
     }
 
-    SearchResult AggregatedSource::Search(const SearchRequest& request)
+    void AggregatedSource::AddSource(const SourceDetails& details, std::function<std::shared_ptr<ISource>()> open)
     {
-        SearchResult result;
+        auto source = std::make_shared<DeferredSource>(details, std::move(open));
+        m_deferredSources.emplace_back(source);
+        m_sources.emplace_back(std::move(source));
+    }
+
+    void AggregatedSource::OpenDeferredSources() const
+    {
+        std::vector<std::future<void>> opens;
 
-        for (auto& source : m_sources)
+        for (const auto& source : m_deferredSources)
         {
-            auto oneSourceResult = source->Search(request);
+            if (!source->IsOpen())
+            {
+                opens.emplace_back(std::async(std::launch::async, [&source]() { source->Get(); }));
+            }
+        }
 
-            for (auto& r : oneSourceResult.Matches)
+        // Wait for all of them before rethrowing the first failure, as the others still refer to the sources.
+        std::exception_ptr failure;
+        for (auto& open : opens)
+        {
+            try
+            {
+                open.get();
+            }
+            catch (...)
             {
-                r.SourceName = source->GetDetails().Name;
-                result.Matches.emplace_back(std::move(r));
+                if (!failure)
+                {
+                    failure = std::current_exception();
+                }
             }
         }
 
-        SortResultMatches(result.Matches);
+        if (failure)
+        {
+            std::rethrow_exception(failure);
+        }
+    }
 
-        if (request.MaximumResults > 0 && result.Matches.size() > request.MaximumResults)
+    std::vector<std::shared_ptr<ISource>> AggregatedSource::GetSourcesToSearch(const SearchRequest& request) const
+    {
+        // Every filter must match, so an exact id filter rules out any source that does not have the id.
+        std::vector<std::string_view> requiredIds;
+        for (const auto& filter : request.Filters)
         {
-            result.Truncated = true;
-            result.Matches.erase(result.Matches.begin() + request.MaximumResults, result.Matches.end());
+            if (filter.Field == ApplicationMatchField::Id && filter.Type == MatchType::Exact)
+            {
+                requiredIds.emplace_back(filter.Value);
+            }
+        }
+
+        // Every search opens the sources first, so that they open in parallel rather than one at a time as they are reached.
+        OpenDeferredSources();
+
+        if (requiredIds.empty())
+        {
+            return m_sources;
+        }
+
+        std::vector<std::shared_ptr<ISource>> result;
+        for (const auto& source : m_sources)
+        {
+            if (std::all_of(requiredIds.begin(), requiredIds.end(), [&](std::string_view id) { return source->MayContainId(id); }))
+            {
+                result.emplace_back(source);
+            }
+            else
+            {
+                AICLI_LOG(Repo, Verbose, << "Source '" << source->GetDetails().Name << "' does not have the requested id and is not searched");
+            }
         }
 
         return result;
     }
 
-    void AggregatedSource::SortResultMatches(std::vector<ResultMatch>& matches)
+    SearchResult AggregatedSource::Search(const SearchRequest& request)
     {
-        struct ResultMatchComparator
+        AggregatedSearchCursor cursor{ GetSourcesToSearch(request), request, *m_pendingSearches };
+
+        SearchResult result;
+        for (;;)
         {
-            // The comparator compares the ResultMatch by MatchType first, then Field in a predefined order.
-            bool operator() (
-                const ResultMatch& match1,
-                const ResultMatch& match2)
+            std::vector<ResultMatch> matches = cursor.Next(s_MergeBatchSize);
+            std::move(matches.begin(), matches.end(), std::back_inserter(result.Matches));
+
+            if (matches.size() < s_MergeBatchSize)
             {
-                if (match1.MatchCriteria.Type != match2.MatchCriteria.Type)
-                {
-                    return match2.MatchCriteria.Type > match1.MatchCriteria.Type;
-                }
+                break;
+            }
+        }
 
-                if (match1.MatchCriteria.Field != match2.MatchCriteria.Field)
-                {
-                    return match2.MatchCriteria.Field > match1.MatchCriteria.Field;
-                }
+        result.Truncated = cursor.IsTruncated();
+        result.MissingSources = cursor.GetMissingSources();
+        return result;
+    }
+
+    std::unique_ptr<ISearchCursor> AggregatedSource::OpenSearchCursor(const SearchRequest& request)
+    {
+        return std::make_unique<AggregatedSearchCursor>(GetSourcesToSearch(request), request, *m_pendingSearches);
+    }
+
+    SearchResult AggregatedSource::SearchForIds(const std::vector<std::string>& ids)
+    {
+        OpenDeferredSources();
+
+        // Search all of the sources at once, as the cursor does; a source that has none of the ids is not searched.
+        std::vector<std::future<SearchResult>> searches;
+        searches.reserve(m_sources.size());
+
+        for (const auto& source : m_sources)
+        {
+            if (std::any_of(ids.begin(), ids.end(), [&](const std::string& id) { return source->MayContainId(id); }))
+            {
+                searches.emplace_back(std::async(std::launch::async, [&source, &ids]() { return source->SearchForIds(ids); }));
+            }
+            else
+            {
+                searches.emplace_back();
+            }
+        }
 
-                return false;
+        SearchResult result;
+        for (size_t i = 0; i < searches.size(); ++i)
+        {
+            if (!searches[i].valid())
+            {
+                continue;
             }
-        };
 
-        std::stable_sort(matches.begin(), matches.end(), ResultMatchComparator());
+            SearchResult sourceResult = searches[i].get();
+
+            for (auto& match : sourceResult.Matches)
+            {
+                match.SourceName = m_sources[i]->GetDetails().Name;
+                result.Matches.emplace_back(std::move(match));
+            }
+        }
+
+        return result;
+    }
+
+    bool AggregatedSource::MayContainId(std::string_view id) const
+    {
+        OpenDeferredSources();
+        return std::any_of(m_sources.begin(), m_sources.end(), [&](const std::shared_ptr<ISource>& source) { return source->MayContainId(id); });
     }
-}
 
+    bool AggregatedSource::TryGetInstaller(const std::vector<uint8_t>& sha256, const std::filesystem::path& destination) const
+    {
+        return std::any_of(m_sources.begin(), m_sources.end(), [&](const std::shared_ptr<ISource>& source) { return source->TryGetInstaller(sha256, destination); });
+    }
+
+#ifndef AICLI_DISABLE_TEST_HOOKS
+    void TestHook_SetSearchPolicy(std::chrono::milliseconds sourceTimeout, bool hedgeRequests)
+    {
+        s_SearchPolicy_TestHook_Timeout = sourceTimeout.count();
+        s_SearchPolicy_TestHook_Hedge = hedgeRequests;
+        s_SearchPolicy_TestHook_IsOverridden = true;
+    }
+
+    void TestHook_ClearSearchPolicy()
+    {
+        s_SearchPolicy_TestHook_IsOverridden = false;
+    }
+#endif
+}
@@ -4,8 +4,18 @@
 #pragma once
 #include "AppInstallerRepositorySource.h"
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 namespace AppInstaller::Repository
 {
+    // A source that is opened when it is first used.
+    struct DeferredSource;
+
+    // The searches of sources that were no longer waited for, which are waited for when the aggregate is destroyed.
+    struct PendingSearches;
+
     struct AggregatedSource : public ISource
     {
         AggregatedSource();
@@ -24,13 +34,35 @@ namespace AppInstaller::Repository
         // Execute a search on the source.
         SearchResult Search(const SearchRequest & request) override;
 
+        // Opens a cursor that merges the results of the sources as they are read.
+        std::unique_ptr<ISearchCursor> OpenSearchCursor(const SearchRequest& request) override;
+
+        // Finds the ids in each of the sources, giving the matches of each source in turn.
+        SearchResult SearchForIds(const std::vector<std::string>& ids) override;
+
+        // Determines if any of the sources may have a package with the id.
+        bool MayContainId(std::string_view id) const override;
+
+        // Gets the installer from the first of the open sources that holds it.
+        bool TryGetInstaller(const std::vector<uint8_t>& sha256, const std::filesystem::path& destination) const override;
+
         void AddSource(std::shared_ptr<ISource> source);
 
+        // Adds a source that is opened by the function when it is first used, rather than now.
+        // The sources that are not yet open are opened in parallel by the first use that needs them.
+        void AddSource(const SourceDetails& details, std::function<std::shared_ptr<ISource>()> open);
+
     private:
+        // Opens all of the deferred sources that are not yet open, in parallel.
+        void OpenDeferredSources() const;
+
+        // Gets the sources that may have results for the request; those that definitely do not have the exact id it requires are left out.
+        std::vector<std::shared_ptr<ISource>> GetSourcesToSearch(const SearchRequest& request) const;
+
         std::vector<std::shared_ptr<ISource>> m_sources;
+        std::vector<std::shared_ptr<DeferredSource>> m_deferredSources;
+        std::shared_ptr<PendingSearches> m_pendingSearches;
         SourceDetails m_details;
-
-        void SortResultMatches(std::vector<ResultMatch>& matches);
     };
 }
 
@@ -0,0 +1,278 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "InventoryCache.h"
+
+#include <unordered_map>
+
+
+namespace AppInstaller::Repository
+{
+    using namespace std::string_literals;
+    using namespace std::string_view_literals;
+    using namespace Inventory;
+
+    namespace
+    {
+        static constexpr std::string_view s_InventoryCache_FileName = "InventoryCache.db"sv;
+
+        // The version of the tables below; recorded as the user_version of the database.
+        // Any change to the tables must increase this, causing existing caches to be recreated.
+        static constexpr int s_InventoryCache_SchemaVersion = 1;
+
+        // Waiting for another process to finish a refresh is preferable to reading the entries again.
+        static constexpr std::chrono::milliseconds s_InventoryCache_BusyTimeout = 5000ms;
+
+        static constexpr std::string_view s_InventoryCache_EntriesTable_Create = R"(
+CREATE TABLE [entries](
+    [location] INT NOT NULL,
+    [key] TEXT NOT NULL,
+    [stamp] INT64 NOT NULL,
+    [shown] INT NOT NULL,
+    [name] TEXT NOT NULL,
+    [version] TEXT NOT NULL,
+    [publisher] TEXT NOT NULL,
+    [family] TEXT NOT NULL,
+    PRIMARY KEY([location], [key]))
+)"sv;
+        static constexpr std::string_view s_InventoryCache_EntriesNameIndex_Create =
+            "CREATE INDEX [entries_name] ON [entries]([name] COLLATE NOCASE)"sv;
+
+        // The stamps of the locations that are refreshed as a whole, rather than by entry.
+        static constexpr std::string_view s_InventoryCache_LocationsTable_Create = R"(
+CREATE TABLE [locations](
+    [location] INT PRIMARY KEY NOT NULL,
+    [stamp] INT64 NOT NULL)
+)"sv;
+
+        // Statements
+        static constexpr std::string_view s_InventoryCacheStmt_DropEntries = "drop table if exists [entries]"sv;
+        static constexpr std::string_view s_InventoryCacheStmt_DropLocations = "drop table if exists [locations]"sv;
+        static constexpr std::string_view s_InventoryCacheStmt_GetSchemaVersion = "pragma user_version"sv;
+        static constexpr std::string_view s_InventoryCacheStmt_SetSchemaVersion = "pragma user_version = 1"sv;
+        static constexpr std::string_view s_InventoryCacheStmt_GetStamps = "select [key], [stamp] from [entries] where [location] = ?"sv;
+        static constexpr std::string_view s_InventoryCacheStmt_PutEntry =
+            "insert or replace into [entries] ([location], [key], [stamp], [shown], [name], [version], [publisher], [family]) values (?, ?, ?, ?, ?, ?, ?, ?)"sv;
+        static constexpr std::string_view s_InventoryCacheStmt_RemoveEntry = "delete from [entries] where [location] = ? and [key] = ?"sv;
+        static constexpr std::string_view s_InventoryCacheStmt_RemoveLocation = "delete from [entries] where [location] = ?"sv;
+        static constexpr std::string_view s_InventoryCacheStmt_GetLocationStamp = "select [stamp] from [locations] where [location] = ?"sv;
+        static constexpr std::string_view s_InventoryCacheStmt_SetLocationStamp = "insert or replace into [locations] ([location], [stamp]) values (?, ?)"sv;
+        static constexpr std::string_view s_InventoryCacheStmt_GetEntries =
+            "select [location], [key], [name], [version], [publisher], [family] from [entries] where [shown] = 1 order by [location], [key]"sv;
+        static constexpr std::string_view s_InventoryCacheStmt_FindByName =
+            "select [location], [key], [name], [version], [publisher], [family] from [entries] where [shown] = 1 and [name] = ? collate nocase order by [location], [key]"sv;
+
+        // Creates and executes a statement that has no parameters.
+        void Execute(SQLite::Connection& connection, std::string_view sql)
+        {
+            SQLite::Statement statement = SQLite::Statement::Create(connection, sql);
+            statement.Execute();
+        }
+
+        std::vector<InstalledEntry> ReadEntries(SQLite::Statement& statement)
+        {
+            std::vector<InstalledEntry> result;
+
+            while (statement.Step())
+            {
+                InstalledEntry entry;
+                std::tie(entry.Location, entry.Key, entry.Name, entry.Version, entry.Publisher, entry.FamilyName) =
+                    statement.GetRow<EntryLocation, std::string, std::string, std::string, std::string, std::string>();
+                result.emplace_back(std::move(entry));
+            }
+
+            return result;
+        }
+
+        struct SystemInventoryReader : public IInventoryReader
+        {
+            std::vector<EntryLocation> GetArpLocations() override { return Inventory::GetArpLocations(); }
+
+            std::vector<ArpKeyStamp> GetArpKeyStamps(EntryLocation location) override { return Inventory::GetArpKeyStamps(location); }
+
+            std::optional<InstalledEntry> ReadArpEntry(EntryLocation location, std::string_view key) override { return Inventory::ReadArpEntry(location, key); }
+
+            int64_t GetMsixStamp() override { return Inventory::GetMsixStamp(); }
+
+            std::vector<InstalledEntry> ReadMsixEntries() override { return Inventory::ReadMsixEntries(); }
+        };
+    }
+
+    std::unique_ptr<IInventoryReader> IInventoryReader::CreateDefault()
+    {
+        return std::make_unique<SystemInventoryReader>();
+    }
+
+    InventoryCache::InventoryCache(SQLite::Connection&& connection, std::unique_ptr<IInventoryReader> reader) :
+        m_connection(std::move(connection)), m_reader(std::move(reader))
+    {
+        THROW_HR_IF(E_INVALIDARG, !m_reader);
+    }
+
+    InventoryCache InventoryCache::Open(const std::filesystem::path& filePath, std::unique_ptr<IInventoryReader> reader)
+    {
+        if (filePath.has_parent_path())
+        {
+            std::filesystem::create_directories(filePath.parent_path());
+        }
+
+        InventoryCache result{ SQLite::Connection::Create(filePath.u8string(), SQLite::Connection::OpenDisposition::Create), std::move(reader) };
+        result.m_connection.SetBusyTimeout(s_InventoryCache_BusyTimeout);
+        result.InitializeSchema();
+        return result;
+    }
+
+    std::filesystem::path InventoryCache::GetDefaultPath()
+    {
+        std::filesystem::path result = Runtime::GetPathTo(Runtime::PathName::LocalState);
+        result /= s_InventoryCache_FileName;
+        return result;
+    }
+
+    void InventoryCache::InitializeSchema()
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_connection, "inventorycache_initialize");
+
+        SQLite::Statement getVersion = SQLite::Statement::Create(m_connection, s_InventoryCacheStmt_GetSchemaVersion);
+        THROW_HR_IF(E_UNEXPECTED, !getVersion.Step());
+        int version = getVersion.GetColumn<int>(0);
+
+        if (version == s_InventoryCache_SchemaVersion)
+        {
+            return;
+        }
+
+        AICLI_LOG(Repo, Info, << "Creating inventory cache tables, replacing version " << version);
+
+        Execute(m_connection, s_InventoryCacheStmt_DropEntries);
+        Execute(m_connection, s_InventoryCacheStmt_DropLocations);
+        Execute(m_connection, s_InventoryCache_EntriesTable_Create);
+        Execute(m_connection, s_InventoryCache_EntriesNameIndex_Create);
+        Execute(m_connection, s_InventoryCache_LocationsTable_Create);
+
+        static_assert(s_InventoryCache_SchemaVersion == 1, "Update the set statement with the version");
+        Execute(m_connection, s_InventoryCacheStmt_SetSchemaVersion);
+
+        savepoint.Commit();
+    }
+
+    InventoryCache::RefreshResult InventoryCache::Refresh()
+    {
+        RefreshResult result;
+
+        // The whole refresh is one transaction, so that other processes never see part of one
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_connection, "inventorycache_refresh");
+
+        for (EntryLocation location : m_reader->GetArpLocations())
+        {
+            RefreshArpLocation(location, result);
+        }
+
+        RefreshMsix(result);
+
+        savepoint.Commit();
+
+        AICLI_LOG(Repo, Info, << "Refreshed inventory cache; read " << result.Read << ", removed " << result.Removed);
+        return result;
+    }
+
+    void InventoryCache::RefreshArpLocation(EntryLocation location, RefreshResult& result)
+    {
+        std::unordered_map<std::string, int64_t> cachedStamps;
+        {
+            SQLite::Statement getStamps = SQLite::Statement::Create(m_connection, s_InventoryCacheStmt_GetStamps);
+            getStamps.Bind(1, location);
+            while (getStamps.Step())
+            {
+                auto [key, stamp] = getStamps.GetRow<std::string, int64_t>();
+                cachedStamps.emplace(std::move(key), stamp);
+            }
+        }
+
+        for (const ArpKeyStamp& keyStamp : m_reader->GetArpKeyStamps(location))
+        {
+            auto itr = cachedStamps.find(keyStamp.Key);
+            bool unchanged = (itr != cachedStamps.end() && itr->second == keyStamp.LastWriteTime);
+
+            if (itr != cachedStamps.end())
+            {
+                cachedStamps.erase(itr);
+            }
+
+            if (unchanged)
+            {
+                continue;
+            }
+
+            PutEntry(location, keyStamp.Key, keyStamp.LastWriteTime, m_reader->ReadArpEntry(location, keyStamp.Key));
+            ++result.Read;
+        }
+
+        // Those left were not found, so they were uninstalled
+        SQLite::Statement removeEntry = SQLite::Statement::Create(m_connection, s_InventoryCacheStmt_RemoveEntry);
+        for (const auto& cached : cachedStamps)
+        {
+            removeEntry.Reset();
+            removeEntry.Bind(1, location);
+            removeEntry.Bind(2, cached.first);
+            removeEntry.Execute();
+            ++result.Removed;
+        }
+    }
+
+    void InventoryCache::RefreshMsix(RefreshResult& result)
+    {
+        int64_t stamp = m_reader->GetMsixStamp();
+
+        SQLite::Statement getStamp = SQLite::Statement::Create(m_connection, s_InventoryCacheStmt_GetLocationStamp);
+        getStamp.Bind(1, EntryLocation::Msix);
+        if (getStamp.Step() && getStamp.GetColumn<int64_t>(0) == stamp)
+        {
+            return;
+        }
+
+        // The packages are only enumerated as a whole, so they are all replaced
+        SQLite::Statement removeLocation = SQLite::Statement::Create(m_connection, s_InventoryCacheStmt_RemoveLocation);
+        removeLocation.Bind(1, EntryLocation::Msix);
+        removeLocation.Execute();
+        result.Removed += static_cast<size_t>(m_connection.GetChanges());
+
+        for (const InstalledEntry& entry : m_reader->ReadMsixEntries())
+        {
+            PutEntry(EntryLocation::Msix, entry.Key, stamp, entry);
+            ++result.Read;
+        }
+
+        SQLite::Statement setStamp = SQLite::Statement::Create(m_connection, s_InventoryCacheStmt_SetLocationStamp);
+        setStamp.Bind(1, EntryLocation::Msix);
+        setStamp.Bind(2, stamp);
+        setStamp.Execute();
+    }
+
+    void InventoryCache::PutEntry(EntryLocation location, std::string_view key, int64_t stamp, const std::optional<InstalledEntry>& entry)
+    {
+        SQLite::Statement put = SQLite::Statement::Create(m_connection, s_InventoryCacheStmt_PutEntry);
+        put.Bind(1, location);
+        put.Bind(2, key);
+        put.Bind(3, stamp);
+        put.Bind(4, entry.has_value());
+        put.Bind(5, entry ? std::string_view{ entry->Name } : ""sv);
+        put.Bind(6, entry ? std::string_view{ entry->Version } : ""sv);
+        put.Bind(7, entry ? std::string_view{ entry->Publisher } : ""sv);
+        put.Bind(8, entry ? std::string_view{ entry->FamilyName } : ""sv);
+        put.Execute();
+    }
+
+    std::vector<InstalledEntry> InventoryCache::GetEntries()
+    {
+        SQLite::Statement getEntries = SQLite::Statement::Create(m_connection, s_InventoryCacheStmt_GetEntries);
+        return ReadEntries(getEntries);
+    }
+
+    std::vector<InstalledEntry> InventoryCache::FindByName(std::string_view name)
+    {
+        SQLite::Statement findByName = SQLite::Statement::Create(m_connection, s_InventoryCacheStmt_FindByName);
+        findByName.Bind(1, name);
+        return ReadEntries(findByName);
+    }
+}
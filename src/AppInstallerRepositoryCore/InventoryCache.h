@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+#include <AppInstallerInventory.h>
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace AppInstaller::Repository
+{
+    // Reads the installed entries from the system; tests replace it to control what is installed.
+    struct IInventoryReader
+    {
+        virtual ~IInventoryReader() = default;
+
+        virtual std::vector<Inventory::EntryLocation> GetArpLocations() = 0;
+        virtual std::vector<Inventory::ArpKeyStamp> GetArpKeyStamps(Inventory::EntryLocation location) = 0;
+        virtual std::optional<Inventory::InstalledEntry> ReadArpEntry(Inventory::EntryLocation location, std::string_view key) = 0;
+        virtual int64_t GetMsixStamp() = 0;
+        virtual std::vector<Inventory::InstalledEntry> ReadMsixEntries() = 0;
+
+        // Gets the reader of the system.
+        static std::unique_ptr<IInventoryReader> CreateDefault();
+    };
+
+    // A snapshot of the installed entries, stored in a database so that it is kept between runs and shared by every process.
+    // Each ARP entry is stored with the last write time of its subkey, and the MSIX packages with the stamp of the package
+    // repository, so that a refresh only reads the entries that changed since the snapshot was taken.
+    struct InventoryCache
+    {
+        // The counts of the entries that a refresh read and removed.
+        struct RefreshResult
+        {
+            size_t Read = 0;
+            size_t Removed = 0;
+        };
+
+        // Opens the cache at the given location, creating it if it does not exist.
+        static InventoryCache Open(const std::filesystem::path& filePath, std::unique_ptr<IInventoryReader> reader = IInventoryReader::CreateDefault());
+
+        // Gets the location of the cache of the user.
+        static std::filesystem::path GetDefaultPath();
+
+        InventoryCache(const InventoryCache&) = delete;
+        InventoryCache& operator=(const InventoryCache&) = delete;
+
+        InventoryCache(InventoryCache&&) = default;
+        InventoryCache& operator=(InventoryCache&&) = default;
+
+        // Brings the snapshot up to date with the system, reading only the entries that changed.
+        RefreshResult Refresh();
+
+        // Gets the entries of the snapshot that are shown in Add/Remove Programs, and the MSIX packages, ordered by location and key.
+        std::vector<Inventory::InstalledEntry> GetEntries();
+
+        // Gets the entries of the snapshot whose name is the given one, without regard to case.
+        std::vector<Inventory::InstalledEntry> FindByName(std::string_view name);
+
+    private:
+        InventoryCache(SQLite::Connection&& connection, std::unique_ptr<IInventoryReader> reader);
+
+        // Creates the tables, or recreates them if they are from a different version of the cache.
+        void InitializeSchema();
+
+        // Refreshes the entries of an ARP location, adding the counts to the result.
+        void RefreshArpLocation(Inventory::EntryLocation location, RefreshResult& result);
+
+        // Replaces the MSIX entries if the package repository has changed, adding the counts to the result.
+        void RefreshMsix(RefreshResult& result);
+
+        // Stores the entry for the key; an entry that is not shown is stored without its values, so that it is not read again.
+        void PutEntry(Inventory::EntryLocation location, std::string_view key, int64_t stamp, const std::optional<Inventory::InstalledEntry>& entry);
+
+        SQLite::Connection m_connection;
+        std::unique_ptr<IInventoryReader> m_reader;
+    };
+}
@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/BloomFilter.h"
+
+#include <algorithm>
+#include <charconv>
+
+using namespace std::string_view_literals;
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    namespace
+    {
+        // The serialized form is: <version>;<hash count>;<bits as hex>
+        constexpr std::string_view s_BloomFilter_Version = "1"sv;
+
+        // About ten bits and seven hashes for each value gives a false positive rate of about one percent.
+        constexpr size_t s_BloomFilter_BitsPerValue = 10;
+        constexpr uint32_t s_BloomFilter_HashCount = 7;
+
+        // FNV-1a, which is the same on every platform.
+        uint64_t GetHash(std::string_view value)
+        {
+            uint64_t result = 14695981039346656037ull;
+            for (char c : value)
+            {
+                result ^= static_cast<uint8_t>(c);
+                result *= 1099511628211ull;
+            }
+            return result;
+        }
+
+        // Calls the function with the position of each bit for the value, using two halves of one hash to derive the rest.
+        template <typename F>
+        void ForEachBit(std::string_view value, uint32_t hashCount, size_t bitCount, F&& f)
+        {
+            uint64_t hash = GetHash(value);
+            uint32_t first = static_cast<uint32_t>(hash);
+            uint32_t second = static_cast<uint32_t>(hash >> 32) | 1;
+
+            for (uint32_t i = 0; i < hashCount; ++i)
+            {
+                if (!f(static_cast<size_t>((static_cast<uint64_t>(first) + static_cast<uint64_t>(i) * second) % bitCount)))
+                {
+                    return;
+                }
+            }
+        }
+
+        uint8_t GetHexValue(char c)
+        {
+            if (c >= '0' && c <= '9')
+            {
+                return static_cast<uint8_t>(c - '0');
+            }
+            else if (c >= 'a' && c <= 'f')
+            {
+                return static_cast<uint8_t>(c - 'a' + 10);
+            }
+
+            THROW_HR(E_INVALIDARG);
+        }
+    }
+
+    BloomFilter::BloomFilter(size_t expectedCount) :
+        m_bits(std::max<size_t>(1, (expectedCount * s_BloomFilter_BitsPerValue + 7) / 8)), m_hashCount(s_BloomFilter_HashCount)
+    {
+    }
+
+    BloomFilter BloomFilter::Deserialize(std::string_view value)
+    {
+        size_t versionEnd = value.find(';');
+        THROW_HR_IF(E_INVALIDARG, versionEnd == std::string_view::npos || value.substr(0, versionEnd) != s_BloomFilter_Version);
+
+        size_t hashCountEnd = value.find(';', versionEnd + 1);
+        THROW_HR_IF(E_INVALIDARG, hashCountEnd == std::string_view::npos);
+
+        BloomFilter result;
+        auto parsed = std::from_chars(value.data() + versionEnd + 1, value.data() + hashCountEnd, result.m_hashCount);
+        THROW_HR_IF(E_INVALIDARG, parsed.ec != std::errc{} || parsed.ptr != value.data() + hashCountEnd || result.m_hashCount == 0);
+
+        std::string_view bits = value.substr(hashCountEnd + 1);
+        THROW_HR_IF(E_INVALIDARG, bits.empty() || bits.size() % 2 != 0);
+
+        result.m_bits.reserve(bits.size() / 2);
+        for (size_t i = 0; i < bits.size(); i += 2)
+        {
+            result.m_bits.push_back(static_cast<uint8_t>((GetHexValue(bits[i]) << 4) | GetHexValue(bits[i + 1])));
+        }
+
+        return result;
+    }
+
+    void BloomFilter::Add(std::string_view value)
+    {
+        ForEachBit(value, m_hashCount, m_bits.size() * 8, [&](size_t bit)
+            {
+                m_bits[bit / 8] |= static_cast<uint8_t>(1 << (bit % 8));
+                return true;
+            });
+    }
+
+    bool BloomFilter::MayContain(std::string_view value) const
+    {
+        bool result = true;
+        ForEachBit(value, m_hashCount, m_bits.size() * 8, [&](size_t bit)
+            {
+                result = (m_bits[bit / 8] & (1 << (bit % 8))) != 0;
+                return result;
+            });
+        return result;
+    }
+
+    std::string BloomFilter::Serialize() const
+    {
+        constexpr char s_hexDigits[] = "0123456789abcdef";
+
+        std::string result{ s_BloomFilter_Version };
+        result += ';';
+        result += std::to_string(m_hashCount);
+        result += ';';
+
+        result.reserve(result.size() + m_bits.size() * 2);
+        for (uint8_t byte : m_bits)
+        {
+            result += s_hexDigits[byte >> 4];
+            result += s_hexDigits[byte & 0xF];
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,38 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // A set of strings in a compact form that can be stored with an index. It can say that a value may be in the set
+    // when it is not, about one time in a hundred, but never that a value is not in the set when it is.
+    // The hashes are fixed rather than taken from std::hash, so that a filter written by one build is read the same by every other.
+    struct BloomFilter
+    {
+        // Creates an empty filter sized for the given number of values.
+        explicit BloomFilter(size_t expectedCount);
+
+        // Reads a filter from the string written by Serialize; throws if it is not a filter of a format that is understood.
+        static BloomFilter Deserialize(std::string_view value);
+
+        // Adds the value to the set.
+        void Add(std::string_view value);
+
+        // Determines if the value may be in the set; false only if it definitely is not.
+        bool MayContain(std::string_view value) const;
+
+        // Writes the filter as a string.
+        std::string Serialize() const;
+
+    private:
+        BloomFilter() = default;
+
+        std::vector<uint8_t> m_bits;
+        uint32_t m_hashCount = 0;
+    };
+}
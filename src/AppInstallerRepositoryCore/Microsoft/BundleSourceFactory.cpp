@@ -0,0 +1,146 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/BundleSourceFactory.h"
+#include "Microsoft/ManifestCache.h"
+#include "Microsoft/SourceBundle.h"
+#include "Microsoft/SQLiteIndex.h"
+#include "Microsoft/SQLiteIndexSource.h"
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+
+namespace AppInstaller::Repository::Microsoft
+{
+    namespace
+    {
+        static constexpr std::string_view s_BundleSourceFactory_IndexFileName = "index.db"sv;
+        static constexpr std::string_view s_BundleSourceFactory_StagingIndexFileName = "index.db.staging"sv;
+
+        // Gets the identifier of the local state from the details.
+        std::string GetStateIdentifierFromDetails(const SourceDetails& details)
+        {
+            THROW_HR_IF(E_UNEXPECTED, details.Data.empty());
+            return details.Data;
+        }
+
+        // Creates a name for the cross process reader-writer lock given the details.
+        std::string CreateNameForCPRWL(const SourceDetails& details)
+        {
+            return "BundleSourceCPRWL_"s + GetStateIdentifierFromDetails(details);
+        }
+
+        // Constructs the location that the index is extracted to.
+        std::filesystem::path GetStatePathFromDetails(const SourceDetails& details)
+        {
+            std::filesystem::path result = Runtime::GetPathTo(Runtime::PathName::LocalState);
+            result /= BundleSourceFactory::Type();
+            result /= GetStateIdentifierFromDetails(details);
+            return result;
+        }
+
+        std::string CreateStateIdentifier()
+        {
+            GUID stateId;
+            THROW_IF_FAILED(CoCreateGuid(&stateId));
+
+            wchar_t guidAsString[MAX_PATH];
+            THROW_HR_IF(E_UNEXPECTED, StringFromGUID2(stateId, guidAsString, MAX_PATH) == 0);
+
+            // Drop the braces from around the GUID
+            std::string result = Utility::ConvertToUTF8(guidAsString);
+            return result.substr(1, result.size() - 2);
+        }
+
+        struct BundleSourceFactoryImpl : public ISourceFactory
+        {
+            std::shared_ptr<ISource> Create(const SourceDetails& details, IProgressCallback&) override
+            {
+                THROW_HR_IF(E_INVALIDARG, details.Type != BundleSourceFactory::Type());
+
+                // The index is replaced by an update, so the lock is held for the lifetime of the source
+                auto lock = Synchronization::CrossProcessReaderWriteLock::LockForRead(CreateNameForCPRWL(details));
+
+                std::filesystem::path indexPath = GetStatePathFromDetails(details) / s_BundleSourceFactory_IndexFileName;
+                if (!std::filesystem::exists(indexPath))
+                {
+                    AICLI_LOG(Repo, Info, << "Data not found at " << indexPath);
+                    THROW_HR(APPINSTALLER_CLI_ERROR_SOURCE_DATA_MISSING);
+                }
+
+                std::filesystem::path bundlePath = std::filesystem::u8path(details.Arg);
+                SourceBundle bundle = SourceBundle::Open(bundlePath);
+
+                SQLiteIndex index = SQLiteIndex::Open(indexPath.u8string(), SQLiteIndex::OpenDisposition::Read);
+                auto result = std::make_shared<SQLiteIndexSource>(details, std::move(index), std::move(lock));
+
+                // The manifests are read in place from the bundle; without them, the source has nowhere to read them from
+                auto manifestCache = bundle.GetEntry(SourceBundle::ManifestCacheEntryName);
+                THROW_HR_IF_MSG(APPINSTALLER_CLI_ERROR_SOURCE_DATA_MISSING, !manifestCache, "Source bundle has no manifest cache");
+                result->SetManifestCache(ManifestCache::Open(bundlePath, manifestCache->Offset, manifestCache->Size));
+
+                result->SetSourceBundle(std::move(bundle));
+                return result;
+            }
+
+            void Add(SourceDetails& details, IProgressCallback& progress) override
+            {
+                THROW_HR_IF(E_INVALIDARG, details.Type != BundleSourceFactory::Type());
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND), !std::filesystem::is_regular_file(std::filesystem::u8path(details.Arg)));
+
+                details.Data = CreateStateIdentifier();
+                AICLI_LOG(Repo, Info, << "Extracting bundle source to " << GetStatePathFromDetails(details));
+
+                ExtractIndex(details, progress);
+            }
+
+            void Update(SourceDetails& details, IProgressCallback& progress) override
+            {
+                THROW_HR_IF(E_INVALIDARG, details.Type != BundleSourceFactory::Type());
+                ExtractIndex(details, progress);
+            }
+
+            void Remove(const SourceDetails& details, IProgressCallback&) override
+            {
+                THROW_HR_IF(E_INVALIDARG, details.Type != BundleSourceFactory::Type());
+
+                auto lock = Synchronization::CrossProcessReaderWriteLock::LockForWrite(CreateNameForCPRWL(details));
+                std::filesystem::remove_all(GetStatePathFromDetails(details));
+            }
+
+        private:
+            // Extracts the index from the bundle, replacing the one extracted before if there is one.
+            void ExtractIndex(const SourceDetails& details, IProgressCallback& progress)
+            {
+                SourceBundle bundle = SourceBundle::Open(std::filesystem::u8path(details.Arg));
+
+                std::filesystem::path statePath = GetStatePathFromDetails(details);
+                std::filesystem::create_directories(statePath);
+
+                auto lock = Synchronization::CrossProcessReaderWriteLock::LockForWrite(CreateNameForCPRWL(details));
+
+                // The index is extracted beside the current one, so that a failure part way leaves the current one as it was
+                std::filesystem::path stagingPath = statePath / s_BundleSourceFactory_StagingIndexFileName;
+                bundle.ExtractEntry(SourceBundle::IndexEntryName, stagingPath);
+
+                if (progress.IsCancelled())
+                {
+                    std::filesystem::remove(stagingPath);
+                    return;
+                }
+
+                // Check that the index can be opened before replacing the current one with it
+                (void)SQLiteIndex::Open(stagingPath.u8string(), SQLiteIndex::OpenDisposition::Read);
+
+                std::filesystem::rename(stagingPath, statePath / s_BundleSourceFactory_IndexFileName);
+
+                AICLI_LOG(Repo, Info, << "Bundle source [" << details.Name << "] is up to date with " << bundle.GetCount() << " entries");
+            }
+        };
+    }
+
+    std::unique_ptr<ISourceFactory> BundleSourceFactory::Create()
+    {
+        return std::make_unique<BundleSourceFactoryImpl>();
+    }
+}
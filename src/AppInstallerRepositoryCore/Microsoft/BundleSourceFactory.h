@@ -0,0 +1,28 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Public/AppInstallerRepositorySource.h"
+#include "SourceFactory.h"
+
+#include <string_view>
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // A source for a single bundle file holding an index, its manifests and their installers, for machines without a network.
+    // The index is extracted when the source is added or updated, as it must be a file of its own to be opened; manifests
+    // and installers are read from a mapped view of the bundle as they are needed, so that nothing else is copied.
+    // Arg  ::  Expected to be a fully qualified path to the bundle file, such as D:\offline\packages.wgbundle
+    // Data ::  The identifier of the local state, created when the source is added.
+    struct BundleSourceFactory
+    {
+        // Get the type string for this source.
+        static constexpr std::string_view Type()
+        {
+            using namespace std::string_view_literals;
+            return "Microsoft.Bundle"sv;
+        }
+
+        // Creates a source factory for this type.
+        static std::unique_ptr<ISourceFactory> Create();
+    };
+}
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/CompactSearchResult.h"
+
+#include <limits>
+#include <numeric>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    namespace
+    {
+        struct CriteriaKey
+        {
+            ApplicationMatchField Field;
+            MatchType Type;
+            std::string_view Value;
+
+            bool operator==(const CriteriaKey& other) const
+            {
+                return Field == other.Field && Type == other.Type && Value == other.Value;
+            }
+        };
+
+        struct CriteriaKeyHash
+        {
+            size_t operator()(const CriteriaKey& key) const
+            {
+                size_t result = std::hash<std::string_view>{}(key.Value);
+                result ^= (static_cast<size_t>(key.Field) << 8) | static_cast<size_t>(key.Type);
+                return result;
+            }
+        };
+    }
+
+    CompactSearchResult::CompactSearchResult(std::vector<std::pair<SQLite::rowid_t, ApplicationMatchFilter>>&& matches, bool truncated) :
+        m_truncated(truncated)
+    {
+        m_ids.reserve(matches.size());
+        m_criteriaIndices.reserve(matches.size());
+
+        // The keys view the values of the interned criteria, which do not move as more are added.
+        std::unordered_map<CriteriaKey, uint32_t, CriteriaKeyHash> criteriaIndices;
+
+        for (auto& match : matches)
+        {
+            m_ids.push_back(match.first);
+
+            auto itr = criteriaIndices.find(CriteriaKey{ match.second.Field, match.second.Type, match.second.Value });
+            if (itr == criteriaIndices.end())
+            {
+                THROW_HR_IF(E_UNEXPECTED, m_criteria.size() >= std::numeric_limits<uint32_t>::max());
+
+                uint32_t index = static_cast<uint32_t>(m_criteria.size());
+                const ApplicationMatchFilter& interned = m_criteria.emplace_back(std::move(match.second));
+                itr = criteriaIndices.emplace(CriteriaKey{ interned.Field, interned.Type, interned.Value }, index).first;
+            }
+
+            m_criteriaIndices.push_back(itr->second);
+        }
+    }
+
+    void CompactSearchResult::ScoreAndSort(const SearchRequest& request)
+    {
+        m_scores.clear();
+        m_scores.reserve(m_criteria.size());
+        for (const auto& criteria : m_criteria)
+        {
+            m_scores.push_back(GetMatchScore(criteria, request));
+        }
+
+        auto isBetter = [&](uint32_t first, uint32_t second) { return m_scores[first] > m_scores[second]; };
+
+        if (std::is_sorted(m_criteriaIndices.begin(), m_criteriaIndices.end(), isBetter))
+        {
+            return;
+        }
+
+        std::vector<size_t> order(m_ids.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t first, size_t second) { return isBetter(m_criteriaIndices[first], m_criteriaIndices[second]); });
+
+        std::vector<SQLite::rowid_t> sortedIds;
+        std::vector<uint32_t> sortedCriteriaIndices;
+        sortedIds.reserve(order.size());
+        sortedCriteriaIndices.reserve(order.size());
+        for (size_t i : order)
+        {
+            sortedIds.push_back(m_ids[i]);
+            sortedCriteriaIndices.push_back(m_criteriaIndices[i]);
+        }
+
+        m_ids = std::move(sortedIds);
+        m_criteriaIndices = std::move(sortedCriteriaIndices);
+    }
+}
@@ -0,0 +1,60 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Microsoft/Schema/ISQLiteIndex.h"
+#include <AppInstallerRepositorySearch.h>
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // The matches of an index search, stored by column rather than as a vector of matches.
+    // A search matches many ids on few distinct { field, match type, value } criteria, so the criteria are interned
+    // and each match only holds the rowid of its id and the position of its criteria; scoring is done once per criteria.
+    struct CompactSearchResult
+    {
+        CompactSearchResult() = default;
+
+        // Takes the matches of an index search, in the order given.
+        CompactSearchResult(std::vector<std::pair<SQLite::rowid_t, ApplicationMatchFilter>>&& matches, bool truncated);
+
+        CompactSearchResult(const CompactSearchResult&) = delete;
+        CompactSearchResult& operator=(const CompactSearchResult&) = delete;
+
+        CompactSearchResult(CompactSearchResult&&) = default;
+        CompactSearchResult& operator=(CompactSearchResult&&) = default;
+
+        // Gets the number of matches.
+        size_t Size() const { return m_ids.size(); }
+
+        // Gets the number of distinct criteria among the matches.
+        size_t GetCriteriaCount() const { return m_criteria.size(); }
+
+        // If true, the results were truncated by the maximum results of the request.
+        bool IsTruncated() const { return m_truncated; }
+
+        // Gets the rowid of the id of every match, in order.
+        const std::vector<SQLite::rowid_t>& GetIds() const { return m_ids; }
+
+        SQLite::rowid_t GetId(size_t match) const { return m_ids[match]; }
+
+        const ApplicationMatchFilter& GetCriteria(size_t match) const { return m_criteria[m_criteriaIndices[match]]; }
+
+        // Gets the score of the match; only valid once the matches have been scored.
+        MatchScore GetScore(size_t match) const { return m_scores[m_criteriaIndices[match]]; }
+
+        // Scores the matches against the request, and orders them best score first, keeping the order of equal scores.
+        void ScoreAndSort(const SearchRequest& request);
+
+    private:
+        std::vector<SQLite::rowid_t> m_ids;
+        std::vector<uint32_t> m_criteriaIndices;
+        std::deque<ApplicationMatchFilter> m_criteria;
+        // The score of each criteria.
+        std::vector<MatchScore> m_scores;
+        bool m_truncated = false;
+    };
+}
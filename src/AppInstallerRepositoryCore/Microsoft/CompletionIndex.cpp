@@ -0,0 +1,212 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/CompletionIndex.h"
+#include "Microsoft/SearchResultCache.h"
+
+#include <set>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    namespace
+    {
+        constexpr std::wstring_view s_CompletionIndexDirectoryName = L"CompletionIndex";
+
+        constexpr char s_CompletionIndexMagic[4] = { 'W', 'G', 'C', 'I' };
+
+        // Must be changed whenever the values that are written change.
+        constexpr uint32_t s_CompletionIndexVersion = 1;
+
+        // Data in the completion index is not valid.
+        constexpr HRESULT s_CorruptIndexError = HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT);
+
+        struct FileHeader
+        {
+            char Magic[4];
+            uint32_t Version;
+            uint32_t Count;
+            uint32_t Reserved;
+        };
+        static_assert(sizeof(FileHeader) == 16);
+
+        struct FileEntry
+        {
+            uint32_t Field;
+            uint32_t KeySize;
+            uint32_t ValueSize;
+            uint32_t Reserved;
+            uint64_t KeyOffset;
+            uint64_t ValueOffset;
+        };
+        static_assert(sizeof(FileEntry) == 32);
+
+        // A value to write, as { field, key, value }; ordering them orders the entries as the file requires.
+        using CompletionValue = std::tuple<uint32_t, std::string, std::string>;
+
+        void AddValue(std::set<CompletionValue>& values, ApplicationMatchField field, std::string_view value)
+        {
+            if (!value.empty())
+            {
+                values.emplace(static_cast<uint32_t>(field), Utility::FoldCase(value), std::string{ value });
+            }
+        }
+
+        void WriteIndex(const std::filesystem::path& filePath, const std::set<CompletionValue>& values)
+        {
+            FileHeader header{};
+            std::memcpy(header.Magic, s_CompletionIndexMagic, sizeof(header.Magic));
+            header.Version = s_CompletionIndexVersion;
+            header.Count = wil::safe_cast<uint32_t>(values.size());
+
+            std::vector<FileEntry> entries;
+            entries.reserve(values.size());
+
+            uint64_t offset = sizeof(FileHeader) + sizeof(FileEntry) * values.size();
+            for (const auto& [field, key, value] : values)
+            {
+                FileEntry entry{};
+                entry.Field = field;
+
+                entry.KeyOffset = offset;
+                entry.KeySize = wil::safe_cast<uint32_t>(key.size());
+                offset += entry.KeySize;
+
+                entry.ValueOffset = offset;
+                entry.ValueSize = wil::safe_cast<uint32_t>(value.size());
+                offset += entry.ValueSize;
+
+                entries.emplace_back(entry);
+            }
+
+            std::ofstream stream{ filePath, std::ios::binary | std::ios::trunc };
+            THROW_LAST_ERROR_IF(stream.fail());
+
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            stream.write(reinterpret_cast<const char*>(entries.data()), sizeof(FileEntry) * entries.size());
+            for (const auto& [field, key, value] : values)
+            {
+                stream.write(key.data(), key.size());
+                stream.write(value.data(), value.size());
+            }
+
+            stream.flush();
+            THROW_HR_IF(E_FAIL, stream.fail());
+        }
+    }
+
+    void CompletionIndex::Create(const std::filesystem::path& filePath, SQLiteIndex& index)
+    {
+        std::set<CompletionValue> values;
+
+        for (const auto& manifest : index.GetAllManifests())
+        {
+            AddValue(values, ApplicationMatchField::Id, manifest.first.Id);
+            AddValue(values, ApplicationMatchField::Name, manifest.first.Name);
+            AddValue(values, ApplicationMatchField::Moniker, manifest.first.AppMoniker);
+
+            for (const auto& tag : manifest.first.Tags)
+            {
+                AddValue(values, ApplicationMatchField::Tag, tag);
+            }
+
+            for (const auto& command : manifest.first.Commands)
+            {
+                AddValue(values, ApplicationMatchField::Command, command);
+            }
+        }
+
+        AICLI_LOG(Repo, Info, << "Creating completion index with " << values.size() << " values at [" << filePath << "]");
+
+        if (filePath.has_parent_path())
+        {
+            std::filesystem::create_directories(filePath.parent_path());
+        }
+
+        // Other processes may be creating the same index; each writes its own file and the last rename wins
+        std::filesystem::path tempPath = filePath;
+        tempPath += L"." + std::to_wstring(GetCurrentProcessId()) + L".tmp";
+        auto removeTemp = wil::scope_exit([&]()
+            {
+                std::error_code error;
+                std::filesystem::remove(tempPath, error);
+            });
+
+        WriteIndex(tempPath, values);
+        THROW_IF_WIN32_BOOL_FALSE(MoveFileExW(tempPath.c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH));
+        removeTemp.release();
+    }
+
+    CompletionIndex CompletionIndex::Open(const std::filesystem::path& filePath)
+    {
+        CompletionIndex result;
+
+        result.m_file.reset(CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr));
+        THROW_LAST_ERROR_IF_MSG(!result.m_file, "failed opening completion index");
+
+        LARGE_INTEGER fileSize{};
+        THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(result.m_file.get(), &fileSize));
+        result.m_size = static_cast<uint64_t>(fileSize.QuadPart);
+
+        // An empty file cannot be mapped, and is not a completion index either
+        THROW_HR_IF(s_CorruptIndexError, result.m_size < sizeof(FileHeader));
+
+        result.m_mapping.reset(CreateFileMappingW(result.m_file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+        THROW_LAST_ERROR_IF_NULL_MSG(result.m_mapping, "failed creating file mapping of completion index");
+
+        result.m_view.reset(static_cast<uint8_t*>(MapViewOfFile(result.m_mapping.get(), FILE_MAP_READ, 0, 0, 0)));
+        THROW_LAST_ERROR_IF_NULL_MSG(result.m_view, "failed mapping view of completion index");
+
+        const FileHeader* header = reinterpret_cast<const FileHeader*>(result.m_view.get());
+        THROW_HR_IF(s_CorruptIndexError, std::memcmp(header->Magic, s_CompletionIndexMagic, sizeof(header->Magic)) != 0);
+        THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_UNSUPPORTED_TYPE), header->Version != s_CompletionIndexVersion, "Completion index version %u is not supported", header->Version);
+
+        result.m_count = header->Count;
+        (void)result.GetBytes(sizeof(FileHeader), sizeof(FileEntry) * static_cast<uint64_t>(result.m_count));
+
+        return result;
+    }
+
+    std::filesystem::path CompletionIndex::GetDefaultPath(const SourceDetails& details)
+    {
+        std::filesystem::path result = Runtime::GetPathTo(Runtime::PathName::LocalState);
+        result /= s_CompletionIndexDirectoryName;
+        result /= std::filesystem::u8path(SearchResultCache::GetSourceIdentifier(details) + ".bin");
+        return result;
+    }
+
+    std::vector<std::string> CompletionIndex::GetCompletions(ApplicationMatchField field, std::string_view prefix) const
+    {
+        const FileEntry* begin = reinterpret_cast<const FileEntry*>(m_view.get() + sizeof(FileHeader));
+        const FileEntry* end = begin + m_count;
+
+        uint32_t fieldValue = static_cast<uint32_t>(field);
+        std::string foldedPrefix = Utility::FoldCase(prefix);
+
+        auto keyOf = [this](const FileEntry& entry) { return GetBytes(entry.KeyOffset, entry.KeySize); };
+        const FileEntry* entry = std::lower_bound(begin, end, foldedPrefix, [&](const FileEntry& a, std::string_view b)
+            {
+                return a.Field < fieldValue || (a.Field == fieldValue && keyOf(a) < b);
+            });
+
+        std::vector<std::string> result;
+
+        for (; entry != end && entry->Field == fieldValue; ++entry)
+        {
+            if (keyOf(*entry).substr(0, foldedPrefix.size()) != foldedPrefix)
+            {
+                break;
+            }
+
+            result.emplace_back(GetBytes(entry->ValueOffset, entry->ValueSize));
+        }
+
+        return result;
+    }
+
+    std::string_view CompletionIndex::GetBytes(uint64_t offset, uint64_t size) const
+    {
+        THROW_HR_IF(s_CorruptIndexError, offset > m_size || size > m_size - offset);
+        return { reinterpret_cast<const char*>(m_view.get() + offset), static_cast<size_t>(size) };
+    }
+}
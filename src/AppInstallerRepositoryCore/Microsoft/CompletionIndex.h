@@ -0,0 +1,62 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Microsoft/SQLiteIndex.h"
+#include "Public/AppInstallerRepositorySearch.h"
+#include "Public/AppInstallerRepositorySource.h"
+#include <wil/resource.h>
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // A file of the values that can complete each searchable field of a source, so that shell completion can find the
+    // values that start with a prefix without opening the index. It is built from the index when the source is opened,
+    // and removed whenever the index is replaced.
+    //
+    // The file is read through a mapped view, and the matching values are found with a binary search:
+    //  Header      { char magic[4]; uint32 version; uint32 count; uint32 reserved; }
+    //  Entries     { uint32 field; uint32 keySize; uint32 valueSize; uint32 reserved; uint64 keyOffset; uint64 valueOffset; }[count],
+    //              ordered by field then key, where the key is the case folded value
+    //  Data        The keys and values
+    struct CompletionIndex
+    {
+        // Writes a completion index of the values in the given index.
+        // The file is written next to its final location and then renamed, so that a partial file is never read.
+        static void Create(const std::filesystem::path& filePath, SQLiteIndex& index);
+
+        // Opens an existing completion index; throws if the file is not a completion index of a format that is understood.
+        static CompletionIndex Open(const std::filesystem::path& filePath);
+
+        // Gets the location of the completion index for the source.
+        static std::filesystem::path GetDefaultPath(const SourceDetails& details);
+
+        CompletionIndex(const CompletionIndex&) = delete;
+        CompletionIndex& operator=(const CompletionIndex&) = delete;
+
+        CompletionIndex(CompletionIndex&&) = default;
+        CompletionIndex& operator=(CompletionIndex&&) = default;
+
+        // Gets the number of values in the completion index.
+        size_t GetCount() const { return m_count; }
+
+        // Gets the values of the field that start with the prefix, ignoring case, in order.
+        std::vector<std::string> GetCompletions(ApplicationMatchField field, std::string_view prefix) const;
+
+    private:
+        CompletionIndex() = default;
+
+        // Gets bytes from the file, throwing if they are not all within it.
+        std::string_view GetBytes(uint64_t offset, uint64_t size) const;
+
+        wil::unique_hfile m_file;
+        wil::unique_handle m_mapping;
+        wil::unique_mapview_ptr<uint8_t> m_view;
+        uint64_t m_size = 0;
+        uint32_t m_count = 0;
+    };
+}
@@ -0,0 +1,399 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/DirectoryIndexer.h"
+#include "Microsoft/ParallelManifestParser.h"
+
+#include <unordered_map>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    using namespace std::string_literals;
+    using namespace std::string_view_literals;
+
+    namespace
+    {
+        // The version of the table below; recorded as the user_version of the database.
+        // Any change to the table must increase this, causing existing state to be recreated.
+        static constexpr int s_DirectoryIndexer_SchemaVersion = 1;
+
+        // The number of new manifests added to the index in a single transaction.
+        static constexpr size_t s_DirectoryIndexer_AddBatchSize = 1000;
+
+        static constexpr std::string_view s_DirectoryIndexer_FilesTable_Create = R"(
+CREATE TABLE [files](
+    [path] TEXT PRIMARY KEY NOT NULL,
+    [size] INT64 NOT NULL,
+    [write_time] INT64 NOT NULL,
+    [id] TEXT NOT NULL,
+    [version] TEXT NOT NULL,
+    [channel] TEXT NOT NULL)
+)"sv;
+
+        // Statements
+        static constexpr std::string_view s_DirectoryIndexerStmt_DropFiles = "drop table if exists [files]"sv;
+        static constexpr std::string_view s_DirectoryIndexerStmt_GetSchemaVersion = "pragma user_version"sv;
+        static constexpr std::string_view s_DirectoryIndexerStmt_SetSchemaVersion = "pragma user_version = 1"sv;
+        static constexpr std::string_view s_DirectoryIndexerStmt_GetAll = "select [path], [size], [write_time], [id], [version], [channel] from [files]"sv;
+        static constexpr std::string_view s_DirectoryIndexerStmt_Put =
+            "insert or replace into [files] ([path], [size], [write_time], [id], [version], [channel]) values (?, ?, ?, ?, ?, ?)"sv;
+        static constexpr std::string_view s_DirectoryIndexerStmt_Remove = "delete from [files] where [path] = ?"sv;
+
+        // Creates and executes a statement that has no parameters.
+        void Execute(SQLite::Connection& connection, std::string_view sql)
+        {
+            SQLite::Statement statement = SQLite::Statement::Create(connection, sql);
+            statement.Execute();
+        }
+
+        // What identifies the contents of a file without reading it.
+        struct FileStamp
+        {
+            int64_t Size = 0;
+            int64_t WriteTime = 0;
+
+            bool operator==(const FileStamp& other) const { return Size == other.Size && WriteTime == other.WriteTime; }
+        };
+
+        // A file as it was last indexed.
+        struct FileState
+        {
+            FileStamp Stamp;
+            std::string Id;
+            std::string Version;
+            std::string Channel;
+
+            bool IsSameManifest(const Manifest::Manifest& manifest) const
+            {
+                return Id == manifest.Id && Version == manifest.Version && Channel == manifest.Channel;
+            }
+
+            // Creates a manifest with only the values that identify it in the index, which is all that removing it needs.
+            Manifest::Manifest CreateIdentity() const
+            {
+                Manifest::Manifest result;
+                result.Id = Id;
+                result.Version = Version;
+                result.Channel = Channel;
+                return result;
+            }
+        };
+
+        // A file that is new or has changed since it was last indexed.
+        struct ChangedFile
+        {
+            std::filesystem::path RelativePath;
+            FileStamp Stamp;
+            std::optional<FileState> Previous;
+        };
+
+        // Records the files as indexed, and removes those that no longer are, using the same statements for all of them.
+        struct StateWriter
+        {
+            StateWriter(SQLite::Connection& connection) :
+                m_put(SQLite::Statement::Create(connection, s_DirectoryIndexerStmt_Put)),
+                m_remove(SQLite::Statement::Create(connection, s_DirectoryIndexerStmt_Remove)) {}
+
+            void Put(const std::filesystem::path& relativePath, const FileStamp& stamp, const Manifest::Manifest& manifest)
+            {
+                m_put.Reset();
+                m_put.Bind(1, relativePath.u8string());
+                m_put.Bind(2, stamp.Size);
+                m_put.Bind(3, stamp.WriteTime);
+                m_put.Bind(4, manifest.Id);
+                m_put.Bind(5, manifest.Version);
+                m_put.Bind(6, manifest.Channel);
+                m_put.Execute();
+            }
+
+            void Remove(const std::string& relativePath)
+            {
+                m_remove.Reset();
+                m_remove.Bind(1, relativePath);
+                m_remove.Execute();
+            }
+
+        private:
+            SQLite::Statement m_put;
+            SQLite::Statement m_remove;
+        };
+
+        // Removes the manifest that the file was indexed as; returns false if it could not be.
+        bool RemoveFromIndex(SQLiteIndex& index, const std::string& relativePath, const FileState& state)
+        {
+            try
+            {
+                index.RemoveManifest(state.CreateIdentity(), std::filesystem::u8path(relativePath));
+                return true;
+            }
+            catch (...)
+            {
+                LOG_CAUGHT_EXCEPTION_MSG("Failed removing the manifest of: %hs", relativePath.c_str());
+                return false;
+            }
+        }
+    }
+
+    DirectoryIndexer::DirectoryIndexer(SQLite::Connection&& connection) :
+        m_connection(std::move(connection))
+    {
+    }
+
+    DirectoryIndexer DirectoryIndexer::Open(const std::filesystem::path& statePath)
+    {
+        if (statePath.has_parent_path())
+        {
+            std::filesystem::create_directories(statePath.parent_path());
+        }
+
+        DirectoryIndexer result{ SQLite::Connection::Create(statePath.u8string(), SQLite::Connection::OpenDisposition::Create) };
+        result.InitializeSchema();
+        return result;
+    }
+
+    void DirectoryIndexer::InitializeSchema()
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_connection, "directoryindexer_initialize");
+
+        SQLite::Statement getVersion = SQLite::Statement::Create(m_connection, s_DirectoryIndexerStmt_GetSchemaVersion);
+        THROW_HR_IF(E_UNEXPECTED, !getVersion.Step());
+        int version = getVersion.GetColumn<int>(0);
+
+        if (version == s_DirectoryIndexer_SchemaVersion)
+        {
+            return;
+        }
+
+        AICLI_LOG(Repo, Info, << "Creating directory indexer table, replacing version " << version);
+
+        Execute(m_connection, s_DirectoryIndexerStmt_DropFiles);
+        Execute(m_connection, s_DirectoryIndexer_FilesTable_Create);
+
+        static_assert(s_DirectoryIndexer_SchemaVersion == 1, "Update the set statement with the version");
+        Execute(m_connection, s_DirectoryIndexerStmt_SetSchemaVersion);
+
+        savepoint.Commit();
+    }
+
+    DirectoryIndexer::Result DirectoryIndexer::Synchronize(SQLiteIndex& index, const std::filesystem::path& rootDirectory, IProgressCallback& progress)
+    {
+        AICLI_LOG(Repo, Info, << "Synchronizing index with directory [" << rootDirectory << "]");
+
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_PATH_NOT_FOUND), !std::filesystem::is_directory(rootDirectory));
+
+        std::unordered_map<std::string, FileState> previousFiles;
+        {
+            SQLite::Statement getAll = SQLite::Statement::Create(m_connection, s_DirectoryIndexerStmt_GetAll);
+            while (getAll.Step())
+            {
+                auto [path, size, writeTime, id, version, channel] = getAll.GetRow<std::string, int64_t, int64_t, std::string, std::string, std::string>();
+                previousFiles.emplace(std::move(path), FileState{ { size, writeTime }, std::move(id), std::move(version), std::move(channel) });
+            }
+        }
+
+        // Only the directory entries are read here; the files that have the same stamp as when they were indexed are not opened
+        std::vector<ChangedFile> changedFiles;
+        size_t unchangedFiles = 0;
+
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(rootDirectory))
+        {
+            if (!entry.is_regular_file() || !Utility::CaseInsensitiveEquals(entry.path().extension().u8string(), ".yaml"))
+            {
+                continue;
+            }
+
+            ChangedFile file;
+            file.RelativePath = entry.path().lexically_relative(rootDirectory);
+            file.Stamp.Size = static_cast<int64_t>(entry.file_size());
+            file.Stamp.WriteTime = static_cast<int64_t>(entry.last_write_time().time_since_epoch().count());
+
+            auto previous = previousFiles.find(file.RelativePath.u8string());
+            if (previous != previousFiles.end())
+            {
+                if (previous->second.Stamp == file.Stamp)
+                {
+                    previousFiles.erase(previous);
+                    ++unchangedFiles;
+                    continue;
+                }
+
+                file.Previous = std::move(previous->second);
+                previousFiles.erase(previous);
+            }
+
+            changedFiles.emplace_back(std::move(file));
+        }
+
+        AICLI_LOG(Repo, Info, << "Found " << changedFiles.size() << " new or changed files, " << previousFiles.size() << " removed files and " << unchangedFiles << " unchanged files");
+
+        Result result;
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_connection, "directoryindexer_synchronize");
+        StateWriter state{ m_connection };
+
+        // A scan can update and remove many manifests, so the values they leave are removed once at the end
+        index.SetDeferUnusedValueRemoval(true);
+        auto restoreRemoval = wil::scope_exit([&]() { index.SetDeferUnusedValueRemoval(false); });
+
+        // The files that are left were not found in the directory
+        for (const auto& [relativePath, previous] : previousFiles)
+        {
+            if (RemoveFromIndex(index, relativePath, previous))
+            {
+                ++result.Removed;
+            }
+            else
+            {
+                ++result.Failed;
+            }
+
+            state.Remove(relativePath);
+        }
+
+        std::vector<std::pair<std::filesystem::path, std::filesystem::path>> manifestPaths;
+        manifestPaths.reserve(changedFiles.size());
+        for (const auto& file : changedFiles)
+        {
+            manifestPaths.emplace_back(rootDirectory / file.RelativePath, file.RelativePath);
+        }
+
+        // New manifests are added in batches, each in a single transaction
+        std::vector<std::pair<Manifest::Manifest, std::filesystem::path>> pendingAdds;
+        std::vector<const ChangedFile*> pendingAddFiles;
+
+        auto addPending = [&]()
+        {
+            if (pendingAdds.empty())
+            {
+                return;
+            }
+
+            try
+            {
+                index.AddManifests(pendingAdds);
+                for (size_t i = 0; i < pendingAdds.size(); ++i)
+                {
+                    state.Put(pendingAddFiles[i]->RelativePath, pendingAddFiles[i]->Stamp, pendingAdds[i].first);
+                }
+                result.Added += pendingAdds.size();
+            }
+            catch (...)
+            {
+                LOG_CAUGHT_EXCEPTION_MSG("Failed adding a batch of manifests; adding them one at a time");
+
+                // One bad manifest fails the whole batch, so find out which it was. A manifest may already be in the
+                // index when its file was indexed but the state was not written, in which case it is updated instead.
+                for (size_t i = 0; i < pendingAdds.size(); ++i)
+                {
+                    const auto& [manifest, relativePath] = pendingAdds[i];
+                    try
+                    {
+                        try
+                        {
+                            index.AddManifest(manifest, relativePath);
+                        }
+                        catch (const wil::ResultException& re)
+                        {
+                            if (re.GetErrorCode() != HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS))
+                            {
+                                throw;
+                            }
+
+                            index.UpdateManifest(manifest, relativePath);
+                        }
+
+                        state.Put(relativePath, pendingAddFiles[i]->Stamp, manifest);
+                        ++result.Added;
+                    }
+                    catch (...)
+                    {
+                        LOG_CAUGHT_EXCEPTION_MSG("Failed adding the manifest: %hs", relativePath.u8string().c_str());
+                        ++result.Failed;
+                    }
+                }
+            }
+
+            pendingAdds.clear();
+            pendingAddFiles.clear();
+        };
+
+        ParallelManifestParser parser{ std::move(manifestPaths) };
+        size_t processed = 0;
+
+        while (auto parsed = parser.NextResult())
+        {
+            if (progress.IsCancelled())
+            {
+                // The files that were indexed are recorded, so the next scan continues from here
+                AICLI_LOG(Repo, Info, << "Cancelling the directory scan upon request");
+                break;
+            }
+
+            const ChangedFile& file = changedFiles[parsed->Index];
+            std::string relativePath = file.RelativePath.u8string();
+            progress.OnProgress(++processed, changedFiles.size(), ProgressType::Percent);
+
+            // A file that now holds a different manifest, or that can no longer be parsed, no longer holds the one it was indexed as
+            if (file.Previous && (!parsed->Parsed || !file.Previous->IsSameManifest(parsed->Parsed.value())))
+            {
+                if (RemoveFromIndex(index, relativePath, file.Previous.value()))
+                {
+                    ++result.Removed;
+                }
+
+                state.Remove(relativePath);
+            }
+
+            if (!parsed->Parsed)
+            {
+                try
+                {
+                    std::rethrow_exception(parsed->Error);
+                }
+                catch (...)
+                {
+                    LOG_CAUGHT_EXCEPTION_MSG("Failed parsing the manifest: %hs", relativePath.c_str());
+                }
+
+                ++result.Failed;
+                continue;
+            }
+
+            if (file.Previous && file.Previous->IsSameManifest(parsed->Parsed.value()))
+            {
+                try
+                {
+                    index.UpdateManifest(parsed->Parsed.value(), file.RelativePath);
+                    state.Put(file.RelativePath, file.Stamp, parsed->Parsed.value());
+                    ++result.Updated;
+                }
+                catch (...)
+                {
+                    LOG_CAUGHT_EXCEPTION_MSG("Failed updating the manifest: %hs", relativePath.c_str());
+                    ++result.Failed;
+                }
+
+                continue;
+            }
+
+            pendingAdds.emplace_back(std::move(parsed->Parsed).value(), file.RelativePath);
+            pendingAddFiles.emplace_back(&file);
+
+            if (pendingAdds.size() == s_DirectoryIndexer_AddBatchSize)
+            {
+                addPending();
+            }
+        }
+
+        addPending();
+
+        index.RemoveUnusedValues();
+
+        savepoint.Commit();
+
+        AICLI_LOG(Repo, Info, << "Directory scan added " << result.Added << ", updated " << result.Updated << " and removed " << result.Removed <<
+            " manifests; " << result.Failed << " files failed");
+
+        return result;
+    }
+}
@@ -0,0 +1,53 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Microsoft/SQLiteIndex.h"
+#include "SQLiteWrapper.h"
+#include <AppInstallerProgress.h>
+
+#include <filesystem>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // Keeps an index in sync with a directory of manifest files (*.yaml), without parsing the files that have not changed.
+    // The size and last write time of each indexed file are recorded in a database of their own, along with the
+    // { Id, Version, Channel } that the file was indexed as, so that a scan only parses the files that are new or
+    // have changed, and removes the manifests of the files that are gone without reading them again.
+    struct DirectoryIndexer
+    {
+        // The changes that a scan made to the index.
+        struct Result
+        {
+            size_t Added = 0;
+            size_t Updated = 0;
+            size_t Removed = 0;
+            // The files that could not be parsed or indexed; they are scanned again the next time.
+            size_t Failed = 0;
+
+            bool IndexModified() const { return (Added + Updated + Removed) != 0; }
+        };
+
+        // Opens the state at the given location, creating it if it does not exist.
+        static DirectoryIndexer Open(const std::filesystem::path& statePath);
+
+        DirectoryIndexer(const DirectoryIndexer&) = delete;
+        DirectoryIndexer& operator=(const DirectoryIndexer&) = delete;
+
+        DirectoryIndexer(DirectoryIndexer&&) = default;
+        DirectoryIndexer& operator=(DirectoryIndexer&&) = default;
+
+        // Scans the directory and applies the changes since the last scan to the index.
+        // The state must only ever be used with the same index, which must have been empty at the first scan.
+        // The changed files are parsed in parallel; a file that cannot be indexed does not stop the others.
+        Result Synchronize(SQLiteIndex& index, const std::filesystem::path& rootDirectory, IProgressCallback& progress);
+
+    private:
+        DirectoryIndexer(SQLite::Connection&& connection);
+
+        // Creates the table, or recreates it if it is from a different version of the state.
+        void InitializeSchema();
+
+        SQLite::Connection m_connection;
+    };
+}
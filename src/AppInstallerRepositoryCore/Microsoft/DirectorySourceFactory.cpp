@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/DirectorySourceFactory.h"
+#include "Microsoft/DirectoryIndexer.h"
+#include "Microsoft/SQLiteIndex.h"
+#include "Microsoft/SQLiteIndexSource.h"
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+
+namespace AppInstaller::Repository::Microsoft
+{
+    namespace
+    {
+        static constexpr std::string_view s_DirectorySourceFactory_IndexFileName = "index.db"sv;
+        static constexpr std::string_view s_DirectorySourceFactory_StateFileName = "files.db"sv;
+
+        // Gets the identifier of the local index from the details.
+        std::string GetIndexIdentifierFromDetails(const SourceDetails& details)
+        {
+            THROW_HR_IF(E_UNEXPECTED, details.Data.empty());
+            return details.Data;
+        }
+
+        // Creates a name for the cross process reader-writer lock given the details.
+        std::string CreateNameForCPRWL(const SourceDetails& details)
+        {
+            return "DirectorySourceCPRWL_"s + GetIndexIdentifierFromDetails(details);
+        }
+
+        // Constructs the location that the index and its state are written to.
+        std::filesystem::path GetStatePathFromDetails(const SourceDetails& details)
+        {
+            std::filesystem::path result = Runtime::GetPathTo(Runtime::PathName::LocalState);
+            result /= DirectorySourceFactory::Type();
+            result /= GetIndexIdentifierFromDetails(details);
+            return result;
+        }
+
+        std::string CreateIndexIdentifier()
+        {
+            GUID indexId;
+            THROW_IF_FAILED(CoCreateGuid(&indexId));
+
+            wchar_t guidAsString[MAX_PATH];
+            THROW_HR_IF(E_UNEXPECTED, StringFromGUID2(indexId, guidAsString, MAX_PATH) == 0);
+
+            // Drop the braces from around the GUID
+            std::string result = Utility::ConvertToUTF8(guidAsString);
+            return result.substr(1, result.size() - 2);
+        }
+
+        struct DirectorySourceFactoryImpl : public ISourceFactory
+        {
+            std::shared_ptr<ISource> Create(const SourceDetails& details, IProgressCallback&) override
+            {
+                THROW_HR_IF(E_INVALIDARG, details.Type != DirectorySourceFactory::Type());
+
+                // The index is modified in place by an update, so the lock is held for the lifetime of the source
+                auto lock = Synchronization::CrossProcessReaderWriteLock::LockForRead(CreateNameForCPRWL(details));
+
+                std::filesystem::path indexPath = GetStatePathFromDetails(details) / s_DirectorySourceFactory_IndexFileName;
+                if (!std::filesystem::exists(indexPath))
+                {
+                    AICLI_LOG(Repo, Info, << "Data not found at " << indexPath);
+                    THROW_HR(APPINSTALLER_CLI_ERROR_SOURCE_DATA_MISSING);
+                }
+
+                SQLiteIndex index = SQLiteIndex::Open(indexPath.u8string(), SQLiteIndex::OpenDisposition::Read);
+                return std::make_shared<SQLiteIndexSource>(details, std::move(index), std::move(lock));
+            }
+
+            void Add(SourceDetails& details, IProgressCallback& progress) override
+            {
+                THROW_HR_IF(E_INVALIDARG, details.Type != DirectorySourceFactory::Type());
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_PATH_NOT_FOUND), !std::filesystem::is_directory(std::filesystem::u8path(details.Arg)));
+
+                details.Data = CreateIndexIdentifier();
+                AICLI_LOG(Repo, Info, << "Indexing directory source at " << GetStatePathFromDetails(details));
+
+                Synchronize(details, progress);
+            }
+
+            void Update(SourceDetails& details, IProgressCallback& progress) override
+            {
+                THROW_HR_IF(E_INVALIDARG, details.Type != DirectorySourceFactory::Type());
+                Synchronize(details, progress);
+            }
+
+            void Remove(const SourceDetails& details, IProgressCallback&) override
+            {
+                THROW_HR_IF(E_INVALIDARG, details.Type != DirectorySourceFactory::Type());
+
+                auto lock = Synchronization::CrossProcessReaderWriteLock::LockForWrite(CreateNameForCPRWL(details));
+                std::filesystem::remove_all(GetStatePathFromDetails(details));
+            }
+
+        private:
+            // Brings the local index up to date with the directory, creating it if it does not exist.
+            void Synchronize(const SourceDetails& details, IProgressCallback& progress)
+            {
+                auto lock = Synchronization::CrossProcessReaderWriteLock::LockForWrite(CreateNameForCPRWL(details));
+
+                std::filesystem::path statePath = GetStatePathFromDetails(details);
+                std::filesystem::create_directories(statePath);
+
+                std::filesystem::path indexPath = statePath / s_DirectorySourceFactory_IndexFileName;
+                std::filesystem::path filesPath = statePath / s_DirectorySourceFactory_StateFileName;
+
+                // The index is rewritten in batches while scanning, so it keeps a log to sync less often
+                std::optional<SQLiteIndex> index;
+                if (std::filesystem::exists(indexPath))
+                {
+                    index = SQLiteIndex::Open(indexPath.u8string(), SQLiteIndex::OpenDisposition::ReadWriteWithLog);
+                }
+                else
+                {
+                    // The state describes the index that was lost, so the scan starts over
+                    std::filesystem::remove(filesPath);
+                    index = SQLiteIndex::CreateNew(indexPath.u8string(), Schema::Version::Latest(), SQLiteIndex::OpenDisposition::ReadWriteWithLog);
+                }
+
+                DirectoryIndexer::Result result = DirectoryIndexer::Open(filesPath).Synchronize(index.value(), std::filesystem::u8path(details.Arg), progress);
+
+                AICLI_LOG(Repo, Info, << "Directory source [" << details.Name << "] is up to date; added " << result.Added << ", updated " << result.Updated <<
+                    ", removed " << result.Removed << ", failed " << result.Failed);
+            }
+        };
+    }
+
+    std::unique_ptr<ISourceFactory> DirectorySourceFactory::Create()
+    {
+        return std::make_unique<DirectorySourceFactoryImpl>();
+    }
+}
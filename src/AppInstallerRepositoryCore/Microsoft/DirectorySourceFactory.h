@@ -0,0 +1,29 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Public/AppInstallerRepositorySource.h"
+#include "SourceFactory.h"
+
+#include <string_view>
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // A source for a directory of manifest files, such as a file share, that is indexed locally.
+    // Adding and updating the source scan the directory, indexing only the files that have changed since the last scan;
+    // searches are served from the local index without reading the directory.
+    // Arg  ::  Expected to be a fully qualified path to the directory, such as \\somewhere\manifests
+    //          Every manifest (*.yaml) under it is indexed, with its path relative to it.
+    // Data ::  The identifier of the local index, created when the source is added.
+    struct DirectorySourceFactory
+    {
+        // Get the type string for this source.
+        static constexpr std::string_view Type()
+        {
+            using namespace std::string_view_literals;
+            return "Microsoft.Directory"sv;
+        }
+
+        // Creates a source factory for this type.
+        static std::unique_ptr<ISourceFactory> Create();
+    };
+}
@@ -0,0 +1,150 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/HotColdSource.h"
+
+#include <set>
+
+using namespace std::chrono_literals;
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    HotColdSource::HotColdSource(std::shared_ptr<ISource> hot, std::optional<BloomFilter> coldIdFilter, std::shared_future<std::shared_ptr<ISource>> cold) :
+        m_hot(std::move(hot)), m_coldIdFilter(std::move(coldIdFilter)), m_cold(std::move(cold))
+    {
+        THROW_HR_IF(E_INVALIDARG, !m_hot || !m_cold.valid());
+    }
+
+    const SourceDetails& HotColdSource::GetDetails() const
+    {
+        return m_hot->GetDetails();
+    }
+
+    SearchResult HotColdSource::Search(const SearchRequest& request)
+    {
+        if (auto cold = GetCold(false))
+        {
+            return cold->Search(request);
+        }
+
+        // Every filter must match, so an exact id filter rules out the cold index if it does not have the id
+        std::vector<std::string_view> requiredIds;
+        for (const auto& filter : request.Filters)
+        {
+            if (filter.Field == ApplicationMatchField::Id && filter.Type == MatchType::Exact)
+            {
+                requiredIds.emplace_back(filter.Value);
+            }
+        }
+
+        SearchResult result = m_hot->Search(request);
+
+        if (!result.Matches.empty())
+        {
+            // The hot index has every version of the packages that it holds, so the results for an exact id are complete;
+            // any other search may have more results in the cold index.
+            if (requiredIds.empty())
+            {
+                result.Truncated = true;
+            }
+
+            return result;
+        }
+
+        if (!std::all_of(requiredIds.begin(), requiredIds.end(), [this](std::string_view id) { return ColdMayContainId(id); }))
+        {
+            return result;
+        }
+
+        AICLI_LOG(Repo, Info, << "Hot index has no results, waiting for the full index of source: " << GetDetails().Name);
+
+        if (auto cold = GetCold(true))
+        {
+            return cold->Search(request);
+        }
+
+        return result;
+    }
+
+    SearchResult HotColdSource::SearchForIds(const std::vector<std::string>& ids)
+    {
+        if (auto cold = GetCold(false))
+        {
+            return cold->SearchForIds(ids);
+        }
+
+        SearchResult result = m_hot->SearchForIds(ids);
+
+        std::set<std::string> found;
+        for (const auto& match : result.Matches)
+        {
+            if (match.Application)
+            {
+                found.emplace(Utility::FoldCase(match.Application->GetId().get()));
+            }
+        }
+
+        bool coldNeeded = std::any_of(ids.begin(), ids.end(), [&](const std::string& id)
+            {
+                return found.count(Utility::FoldCase(id)) == 0 && ColdMayContainId(id);
+            });
+
+        if (coldNeeded)
+        {
+            AICLI_LOG(Repo, Info, << "Hot index does not have all of the ids, waiting for the full index of source: " << GetDetails().Name);
+
+            if (auto cold = GetCold(true))
+            {
+                return cold->SearchForIds(ids);
+            }
+        }
+
+        return result;
+    }
+
+    bool HotColdSource::MayContainId(std::string_view id) const
+    {
+        if (auto cold = GetCold(false))
+        {
+            return cold->MayContainId(id);
+        }
+
+        return m_hot->MayContainId(id) || ColdMayContainId(id);
+    }
+
+    bool HotColdSource::IsColdAvailable() const
+    {
+        return static_cast<bool>(GetCold(false));
+    }
+
+    std::shared_ptr<ISource> HotColdSource::GetCold(bool wait) const
+    {
+        // The future is only safe to use from several threads through a copy of it on each
+        std::shared_future<std::shared_ptr<ISource>> cold = m_cold;
+
+        if (!wait && cold.wait_for(0s) != std::future_status::ready)
+        {
+            return {};
+        }
+
+        try
+        {
+            return cold.get();
+        }
+        catch (...)
+        {
+            // The failure is kept by the future, so it is not tried again; it is only logged the first time it is seen
+            if (!m_coldFailed.exchange(true))
+            {
+                LOG_CAUGHT_EXCEPTION_MSG("Full index is not available, using the hot index");
+            }
+            return {};
+        }
+    }
+
+    bool HotColdSource::ColdMayContainId(std::string_view id) const
+    {
+        return !m_coldIdFilter || m_coldIdFilter->MayContain(Utility::FoldCase(id));
+    }
+}
@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Microsoft/BloomFilter.h"
+#include "Public/AppInstallerRepositorySource.h"
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // A source that searches a small hot index of the most used packages while the full (cold) index is acquired.
+    // Once the cold source is available every search uses it; until then a search that the hot index cannot answer,
+    // because it has no results that the cold index may have, waits for the cold source rather than finding nothing.
+    // If the cold source fails to open, the hot index continues to be used for everything.
+    // Destroying the source waits for the cold source, so that acquiring the full index is not abandoned part of the way through.
+    struct HotColdSource : public ISource
+    {
+        // The filter holds the case folded ids of the cold index; without one, the cold index may have any id.
+        HotColdSource(std::shared_ptr<ISource> hot, std::optional<BloomFilter> coldIdFilter, std::shared_future<std::shared_ptr<ISource>> cold);
+
+        HotColdSource(const HotColdSource&) = delete;
+        HotColdSource& operator=(const HotColdSource&) = delete;
+
+        // Get the source's details.
+        const SourceDetails& GetDetails() const override;
+
+        // Searches the cold source if it is available; otherwise searches the hot index, falling through to the cold source
+        // if that has no results. Results from the hot index alone are truncated unless they are for an exact id.
+        SearchResult Search(const SearchRequest& request) override;
+
+        // Finds the ids in the hot index, using the cold source instead if it may have any of the ids that were not found.
+        SearchResult SearchForIds(const std::vector<std::string>& ids) override;
+
+        // Checks the hot index, and then the filter of the cold index.
+        bool MayContainId(std::string_view id) const override;
+
+        // Determines if the cold source has been opened, without waiting for it.
+        bool IsColdAvailable() const;
+
+    private:
+        // Gets the cold source if it has been opened, waiting for it if requested; empty if it is not available.
+        std::shared_ptr<ISource> GetCold(bool wait) const;
+
+        // Determines if the cold index may have the id, by its filter.
+        bool ColdMayContainId(std::string_view id) const;
+
+        std::shared_ptr<ISource> m_hot;
+        std::optional<BloomFilter> m_coldIdFilter;
+        std::shared_future<std::shared_ptr<ISource>> m_cold;
+        mutable std::atomic<bool> m_coldFailed = false;
+    };
+}
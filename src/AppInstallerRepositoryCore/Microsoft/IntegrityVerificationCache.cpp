@@ -0,0 +1,186 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/IntegrityVerificationCache.h"
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    using namespace std::string_literals;
+    using namespace std::string_view_literals;
+
+    namespace
+    {
+        static constexpr std::string_view s_IntegrityVerificationCache_FileName = "IntegrityVerificationCache.db"sv;
+
+        // The version of the table below; recorded as the user_version of the database.
+        // Any change to the table must increase this, causing existing caches to be recreated.
+        static constexpr int s_IntegrityVerificationCache_SchemaVersion = 1;
+
+        static constexpr std::chrono::milliseconds s_IntegrityVerificationCache_BusyTimeout = 2000ms;
+
+        static constexpr std::string_view s_IntegrityVerificationCache_VerificationsTable_Create = R"(
+CREATE TABLE [verifications](
+    [family] TEXT PRIMARY KEY NOT NULL,
+    [full_name] TEXT NOT NULL,
+    [volume_serial] INT64 NOT NULL,
+    [file_id] TEXT NOT NULL,
+    [write_time] INT64 NOT NULL,
+    [verified_time] INT64 NOT NULL)
+)"sv;
+
+        // Statements
+        static constexpr std::string_view s_IntegrityVerificationCacheStmt_DropVerifications = "drop table if exists [verifications]"sv;
+        static constexpr std::string_view s_IntegrityVerificationCacheStmt_GetSchemaVersion = "pragma user_version"sv;
+        static constexpr std::string_view s_IntegrityVerificationCacheStmt_SetSchemaVersion = "pragma user_version = 1"sv;
+        static constexpr std::string_view s_IntegrityVerificationCacheStmt_Get =
+            "select [verified_time] from [verifications] where [family] = ? and [full_name] = ? and [volume_serial] = ? and [file_id] = ? and [write_time] = ?"sv;
+        static constexpr std::string_view s_IntegrityVerificationCacheStmt_Put =
+            "insert or replace into [verifications] ([family], [full_name], [volume_serial], [file_id], [write_time], [verified_time]) values (?, ?, ?, ?, ?, ?)"sv;
+        static constexpr std::string_view s_IntegrityVerificationCacheStmt_Remove = "delete from [verifications] where [family] = ?"sv;
+
+        // Creates and executes a statement that has no parameters.
+        void Execute(SQLite::Connection& connection, std::string_view sql)
+        {
+            SQLite::Statement statement = SQLite::Statement::Create(connection, sql);
+            statement.Execute();
+        }
+
+        std::string ConvertToHex(const unsigned char* bytes, size_t count)
+        {
+            static constexpr char s_digits[] = "0123456789abcdef";
+
+            std::string result;
+            result.reserve(count * 2);
+            for (size_t i = 0; i < count; ++i)
+            {
+                result += s_digits[bytes[i] >> 4];
+                result += s_digits[bytes[i] & 0xF];
+            }
+            return result;
+        }
+
+        int64_t GetCurrentUnixTime()
+        {
+            return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    bool IntegrityVerificationCache::FileIdentity::operator==(const FileIdentity& other) const
+    {
+        return VolumeSerialNumber == other.VolumeSerialNumber && FileId == other.FileId && LastWriteTime == other.LastWriteTime;
+    }
+
+    IntegrityVerificationCache::FileIdentity IntegrityVerificationCache::GetFileIdentity(const std::filesystem::path& filePath)
+    {
+        wil::unique_hfile file{ CreateFileW(filePath.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        THROW_LAST_ERROR_IF(!file);
+
+        FILE_ID_INFO idInfo{};
+        THROW_IF_WIN32_BOOL_FALSE(GetFileInformationByHandleEx(file.get(), FileIdInfo, &idInfo, sizeof(idInfo)));
+
+        FILE_BASIC_INFO basicInfo{};
+        THROW_IF_WIN32_BOOL_FALSE(GetFileInformationByHandleEx(file.get(), FileBasicInfo, &basicInfo, sizeof(basicInfo)));
+
+        FileIdentity result;
+        result.VolumeSerialNumber = idInfo.VolumeSerialNumber;
+        result.FileId = ConvertToHex(idInfo.FileId.Identifier, sizeof(idInfo.FileId.Identifier));
+        result.LastWriteTime = basicInfo.LastWriteTime.QuadPart;
+        return result;
+    }
+
+    IntegrityVerificationCache::IntegrityVerificationCache(SQLite::Connection&& connection) :
+        m_connection(std::move(connection))
+    {
+    }
+
+    IntegrityVerificationCache IntegrityVerificationCache::Open(const std::filesystem::path& filePath)
+    {
+        if (filePath.has_parent_path())
+        {
+            std::filesystem::create_directories(filePath.parent_path());
+        }
+
+        IntegrityVerificationCache result{ SQLite::Connection::Create(filePath.u8string(), SQLite::Connection::OpenDisposition::Create) };
+        result.m_connection.SetBusyTimeout(s_IntegrityVerificationCache_BusyTimeout);
+        result.InitializeSchema();
+        return result;
+    }
+
+    std::filesystem::path IntegrityVerificationCache::GetDefaultPath()
+    {
+        std::filesystem::path result = Runtime::GetPathTo(Runtime::PathName::LocalState);
+        result /= s_IntegrityVerificationCache_FileName;
+        return result;
+    }
+
+    void IntegrityVerificationCache::InitializeSchema()
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_connection, "integrityverificationcache_initialize");
+
+        SQLite::Statement getVersion = SQLite::Statement::Create(m_connection, s_IntegrityVerificationCacheStmt_GetSchemaVersion);
+        THROW_HR_IF(E_UNEXPECTED, !getVersion.Step());
+        int version = getVersion.GetColumn<int>(0);
+
+        if (version == s_IntegrityVerificationCache_SchemaVersion)
+        {
+            return;
+        }
+
+        AICLI_LOG(Repo, Info, << "Creating integrity verification cache table, replacing version " << version);
+
+        Execute(m_connection, s_IntegrityVerificationCacheStmt_DropVerifications);
+        Execute(m_connection, s_IntegrityVerificationCache_VerificationsTable_Create);
+
+        static_assert(s_IntegrityVerificationCache_SchemaVersion == 1, "Update the set statement with the version");
+        Execute(m_connection, s_IntegrityVerificationCacheStmt_SetSchemaVersion);
+
+        savepoint.Commit();
+    }
+
+    bool IntegrityVerificationCache::IsVerified(std::string_view packageFamilyName, std::string_view packageFullName, const FileIdentity& identity, std::chrono::seconds maximumAge)
+    {
+        SQLite::Statement get = SQLite::Statement::Create(m_connection, s_IntegrityVerificationCacheStmt_Get);
+        get.Bind(1, packageFamilyName);
+        get.Bind(2, packageFullName);
+        get.Bind(3, static_cast<int64_t>(identity.VolumeSerialNumber));
+        get.Bind(4, identity.FileId);
+        get.Bind(5, identity.LastWriteTime);
+
+        if (!get.Step())
+        {
+            return false;
+        }
+
+        int64_t verifiedTime = get.GetColumn<int64_t>(0);
+        int64_t currentTime = GetCurrentUnixTime();
+
+        // A verification from the future means the clock was moved back, so its age is unknown
+        if (verifiedTime > currentTime || (currentTime - verifiedTime) >= maximumAge.count())
+        {
+            AICLI_LOG(Repo, Info, << "Integrity verification of " << packageFullName << " has expired");
+            return false;
+        }
+
+        return true;
+    }
+
+    void IntegrityVerificationCache::SetVerified(std::string_view packageFamilyName, std::string_view packageFullName, const FileIdentity& identity)
+    {
+        SQLite::Statement put = SQLite::Statement::Create(m_connection, s_IntegrityVerificationCacheStmt_Put);
+        put.Bind(1, packageFamilyName);
+        put.Bind(2, packageFullName);
+        put.Bind(3, static_cast<int64_t>(identity.VolumeSerialNumber));
+        put.Bind(4, identity.FileId);
+        put.Bind(5, identity.LastWriteTime);
+        put.Bind(6, GetCurrentUnixTime());
+        put.Execute();
+    }
+
+    void IntegrityVerificationCache::Remove(std::string_view packageFamilyName)
+    {
+        SQLite::Statement remove = SQLite::Statement::Create(m_connection, s_IntegrityVerificationCacheStmt_Remove);
+        remove.Bind(1, packageFamilyName);
+        remove.Execute();
+    }
+}
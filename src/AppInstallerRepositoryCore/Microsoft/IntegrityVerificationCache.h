@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // A cache of the packages whose content integrity has been verified, so that a source package is not hashed again
+    // every time it is opened. Entries are keyed on the package family, and hold the full name of the package that was
+    // verified along with the identity of a file in it; a changed package or file, or an entry older than the maximum
+    // age, must be verified again.
+    // The cache is kept in the local state of the user, which only they can write, like the rest of their source state.
+    struct IntegrityVerificationCache
+    {
+        // The default time after which a package is verified again even though it has not changed.
+        static constexpr std::chrono::hours DefaultMaximumAge = std::chrono::hours{ 24 * 7 };
+
+        // Identifies a file independently of its path; any replacement or modification of the file changes it.
+        struct FileIdentity
+        {
+            uint64_t VolumeSerialNumber = 0;
+            // The 128 bit file id, as hex.
+            std::string FileId;
+            int64_t LastWriteTime = 0;
+
+            bool operator==(const FileIdentity& other) const;
+            bool operator!=(const FileIdentity& other) const { return !(*this == other); }
+        };
+
+        // Gets the identity of the file at the given path.
+        static FileIdentity GetFileIdentity(const std::filesystem::path& filePath);
+
+        // Opens the cache at the given location, creating it if it does not exist.
+        static IntegrityVerificationCache Open(const std::filesystem::path& filePath);
+
+        // Gets the location of the cache shared by the sources.
+        static std::filesystem::path GetDefaultPath();
+
+        IntegrityVerificationCache(const IntegrityVerificationCache&) = delete;
+        IntegrityVerificationCache& operator=(const IntegrityVerificationCache&) = delete;
+
+        IntegrityVerificationCache(IntegrityVerificationCache&&) = default;
+        IntegrityVerificationCache& operator=(IntegrityVerificationCache&&) = default;
+
+        // Determines whether the package was verified within the maximum age, with the file as it is now.
+        bool IsVerified(std::string_view packageFamilyName, std::string_view packageFullName, const FileIdentity& identity, std::chrono::seconds maximumAge = DefaultMaximumAge);
+
+        // Records that the package has been verified, replacing the entry for any other version of it.
+        void SetVerified(std::string_view packageFamilyName, std::string_view packageFullName, const FileIdentity& identity);
+
+        // Removes the entry for the package family.
+        void Remove(std::string_view packageFamilyName);
+
+    private:
+        IntegrityVerificationCache(SQLite::Connection&& connection);
+
+        // Creates the table, or recreates it if it is from a different version of the cache.
+        void InitializeSchema();
+
+        SQLite::Connection m_connection;
+    };
+}
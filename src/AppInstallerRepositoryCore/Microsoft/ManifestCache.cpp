@@ -0,0 +1,491 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/ManifestCache.h"
+#include "Microsoft/ParallelManifestParser.h"
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    using namespace Manifest;
+
+    namespace
+    {
+        constexpr char s_ManifestCacheMagic[4] = { 'W', 'G', 'M', 'C' };
+
+        // Must be changed whenever the manifest that is written changes.
+        constexpr uint32_t s_ManifestCacheVersion = 3;
+
+        // Data in the cache is not valid.
+        constexpr HRESULT s_CorruptCacheError = HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT);
+
+        struct FileHeader
+        {
+            char Magic[4];
+            uint32_t Version;
+            uint32_t Count;
+            uint32_t Reserved;
+        };
+        static_assert(sizeof(FileHeader) == 16);
+
+        struct FileEntry
+        {
+            uint64_t KeyOffset;
+            uint64_t ManifestOffset;
+            uint32_t KeySize;
+            uint32_t ManifestSize;
+        };
+        static_assert(sizeof(FileEntry) == 24);
+
+        // Writes the values of a manifest, each string and array prefixed by its size.
+        struct ManifestWriter
+        {
+            void WriteUInt32(uint32_t value)
+            {
+                m_data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+            }
+
+            void WriteUInt64(uint64_t value)
+            {
+                m_data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+            }
+
+            void WriteSize(size_t size)
+            {
+                WriteUInt32(wil::safe_cast<uint32_t>(size));
+            }
+
+            void WriteString(std::string_view value)
+            {
+                WriteSize(value.size());
+                m_data.append(value);
+            }
+
+            void WriteBytes(const std::vector<BYTE>& value)
+            {
+                WriteSize(value.size());
+                m_data.append(reinterpret_cast<const char*>(value.data()), value.size());
+            }
+
+            void WriteStrings(const std::vector<Utility::NormalizedString>& values)
+            {
+                WriteSize(values.size());
+                for (const auto& value : values)
+                {
+                    WriteString(value);
+                }
+            }
+
+            void WriteSwitches(const std::map<ManifestInstaller::InstallerSwitchType, Utility::NormalizedString>& switches)
+            {
+                WriteSize(switches.size());
+                for (const auto& entry : switches)
+                {
+                    WriteUInt32(static_cast<uint32_t>(entry.first));
+                    WriteString(entry.second);
+                }
+            }
+
+            void WriteInstaller(const ManifestInstaller& installer)
+            {
+                WriteUInt32(static_cast<uint32_t>(installer.Arch));
+                WriteString(installer.Url);
+                WriteStrings(installer.MirrorUrls);
+                WriteBytes(installer.Sha256);
+                WriteBytes(installer.SignatureSha256);
+                WriteBytes(installer.ChunkedSha256);
+                WriteUInt64(installer.ChunkSize);
+                WriteString(installer.Language);
+                WriteString(installer.Scope);
+                WriteString(installer.ProductId);
+                WriteUInt32(static_cast<uint32_t>(installer.InstallerType));
+                WriteSwitches(installer.Switches);
+            }
+
+            void WriteLocalization(const ManifestLocalization& localization)
+            {
+                WriteString(localization.Language);
+                WriteString(localization.Description);
+                WriteString(localization.Homepage);
+                WriteString(localization.LicenseUrl);
+            }
+
+            void WriteManifest(const Manifest::Manifest& manifest)
+            {
+                WriteString(manifest.Id);
+                WriteString(manifest.Name);
+                WriteString(manifest.Version);
+                WriteString(manifest.Publisher);
+                WriteString(manifest.AppMoniker);
+                WriteString(manifest.Channel);
+                WriteString(manifest.Author);
+                WriteString(manifest.License);
+                WriteString(manifest.MinOSVersion);
+                WriteStrings(manifest.Tags);
+                WriteStrings(manifest.Commands);
+                WriteStrings(manifest.Protocols);
+                WriteStrings(manifest.FileExtensions);
+                WriteUInt32(static_cast<uint32_t>(manifest.InstallerType));
+                WriteString(manifest.Description);
+                WriteString(manifest.Homepage);
+                WriteString(manifest.LicenseUrl);
+                WriteString(manifest.ManifestVersion.ToString());
+                WriteSwitches(manifest.Switches);
+
+                WriteSize(manifest.Installers.size());
+                for (const auto& installer : manifest.Installers)
+                {
+                    WriteInstaller(installer);
+                }
+
+                WriteSize(manifest.Localization.size());
+                for (const auto& localization : manifest.Localization)
+                {
+                    // The cache holds every field, so a localization that is not yet decoded is decoded as it is written
+                    ManifestLocalization decoded = localization;
+                    decoded.Decode();
+                    WriteLocalization(decoded);
+                }
+            }
+
+            std::string m_data;
+        };
+
+        // Reads the values of a manifest written by ManifestWriter, throwing if they go past the end of the data.
+        struct ManifestReader
+        {
+            ManifestReader(std::string_view data) : m_data(data) {}
+
+            uint32_t ReadUInt32()
+            {
+                uint32_t value = 0;
+                std::string_view bytes = ReadRaw(sizeof(value));
+                std::memcpy(&value, bytes.data(), sizeof(value));
+                return value;
+            }
+
+            uint64_t ReadUInt64()
+            {
+                uint64_t value = 0;
+                std::string_view bytes = ReadRaw(sizeof(value));
+                std::memcpy(&value, bytes.data(), sizeof(value));
+                return value;
+            }
+
+            std::string_view ReadString()
+            {
+                return ReadRaw(ReadUInt32());
+            }
+
+            // The strings were normalized when the cache was written, so they are not normalized again.
+            void ReadNormalized(Utility::NormalizedString& value)
+            {
+                static_cast<std::string&>(value).assign(ReadString());
+            }
+
+            void ReadBytes(std::vector<BYTE>& value)
+            {
+                std::string_view bytes = ReadString();
+                value.assign(bytes.begin(), bytes.end());
+            }
+
+            void ReadStrings(std::vector<Utility::NormalizedString>& values)
+            {
+                values.resize(ReadCount());
+                for (auto& value : values)
+                {
+                    ReadNormalized(value);
+                }
+            }
+
+            void ReadSwitches(std::map<ManifestInstaller::InstallerSwitchType, Utility::NormalizedString>& switches)
+            {
+                for (uint32_t count = ReadCount(); count > 0; --count)
+                {
+                    auto type = static_cast<ManifestInstaller::InstallerSwitchType>(ReadUInt32());
+                    ReadNormalized(switches[type]);
+                }
+            }
+
+            void ReadInstaller(ManifestInstaller& installer)
+            {
+                installer.Arch = static_cast<Utility::Architecture>(static_cast<int32_t>(ReadUInt32()));
+                ReadNormalized(installer.Url);
+                ReadStrings(installer.MirrorUrls);
+                ReadBytes(installer.Sha256);
+                ReadBytes(installer.SignatureSha256);
+                ReadBytes(installer.ChunkedSha256);
+                installer.ChunkSize = ReadUInt64();
+                ReadNormalized(installer.Language);
+                ReadNormalized(installer.Scope);
+                ReadNormalized(installer.ProductId);
+                installer.InstallerType = static_cast<ManifestInstaller::InstallerTypeEnum>(ReadUInt32());
+                ReadSwitches(installer.Switches);
+            }
+
+            void ReadLocalization(ManifestLocalization& localization)
+            {
+                ReadNormalized(localization.Language);
+                ReadNormalized(localization.Description);
+                ReadNormalized(localization.Homepage);
+                ReadNormalized(localization.LicenseUrl);
+            }
+
+            void ReadManifest(Manifest::Manifest& manifest)
+            {
+                ReadNormalized(manifest.Id);
+                ReadNormalized(manifest.Name);
+                ReadNormalized(manifest.Version);
+                ReadNormalized(manifest.Publisher);
+                ReadNormalized(manifest.AppMoniker);
+                ReadNormalized(manifest.Channel);
+                ReadNormalized(manifest.Author);
+                ReadNormalized(manifest.License);
+                ReadNormalized(manifest.MinOSVersion);
+                ReadStrings(manifest.Tags);
+                ReadStrings(manifest.Commands);
+                ReadStrings(manifest.Protocols);
+                ReadStrings(manifest.FileExtensions);
+                manifest.InstallerType = static_cast<ManifestInstaller::InstallerTypeEnum>(ReadUInt32());
+                ReadNormalized(manifest.Description);
+                ReadNormalized(manifest.Homepage);
+                ReadNormalized(manifest.LicenseUrl);
+
+                std::string_view manifestVersion = ReadString();
+                if (!manifestVersion.empty())
+                {
+                    manifest.ManifestVersion = ManifestVer{ std::string{ manifestVersion }, false };
+                }
+
+                ReadSwitches(manifest.Switches);
+
+                manifest.Installers.resize(ReadCount());
+                for (auto& installer : manifest.Installers)
+                {
+                    ReadInstaller(installer);
+                }
+
+                manifest.Localization.resize(ReadCount());
+                for (auto& localization : manifest.Localization)
+                {
+                    ReadLocalization(localization);
+                }
+
+                THROW_HR_IF(s_CorruptCacheError, !m_data.empty());
+            }
+
+        private:
+            std::string_view ReadRaw(size_t size)
+            {
+                THROW_HR_IF(s_CorruptCacheError, size > m_data.size());
+                std::string_view result = m_data.substr(0, size);
+                m_data.remove_prefix(size);
+                return result;
+            }
+
+            // Every item of an array takes at least one byte, so a count larger than the remaining data is not valid.
+            uint32_t ReadCount()
+            {
+                uint32_t count = ReadUInt32();
+                THROW_HR_IF(s_CorruptCacheError, count > m_data.size());
+                return count;
+            }
+
+            std::string_view m_data;
+        };
+
+        // Writes the serialized manifests, each paired with its key.
+        void WriteCache(const std::filesystem::path& filePath, std::vector<std::pair<std::string, std::string>>& manifests)
+        {
+            std::sort(manifests.begin(), manifests.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+            auto duplicate = std::adjacent_find(manifests.begin(), manifests.end(), [](const auto& a, const auto& b) { return a.first == b.first; });
+            THROW_HR_IF_MSG(E_INVALIDARG, duplicate != manifests.end(), "Duplicate manifest path in cache: %hs", duplicate->first.c_str());
+
+            FileHeader header{};
+            std::memcpy(header.Magic, s_ManifestCacheMagic, sizeof(header.Magic));
+            header.Version = s_ManifestCacheVersion;
+            header.Count = wil::safe_cast<uint32_t>(manifests.size());
+
+            std::vector<FileEntry> entries;
+            entries.reserve(manifests.size());
+
+            uint64_t offset = sizeof(FileHeader) + sizeof(FileEntry) * manifests.size();
+            for (const auto& manifest : manifests)
+            {
+                FileEntry entry{};
+                entry.KeyOffset = offset;
+                entry.KeySize = wil::safe_cast<uint32_t>(manifest.first.size());
+                offset += entry.KeySize;
+
+                entry.ManifestOffset = offset;
+                entry.ManifestSize = wil::safe_cast<uint32_t>(manifest.second.size());
+                offset += entry.ManifestSize;
+
+                entries.emplace_back(entry);
+            }
+
+            std::ofstream stream{ filePath, std::ios::binary | std::ios::trunc };
+            THROW_LAST_ERROR_IF(stream.fail());
+
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            stream.write(reinterpret_cast<const char*>(entries.data()), sizeof(FileEntry) * entries.size());
+            for (const auto& manifest : manifests)
+            {
+                stream.write(manifest.first.data(), manifest.first.size());
+                stream.write(manifest.second.data(), manifest.second.size());
+            }
+
+            stream.flush();
+            THROW_HR_IF(E_FAIL, stream.fail());
+        }
+
+        std::string SerializeManifest(const Manifest::Manifest& manifest)
+        {
+            ManifestWriter writer;
+            writer.WriteManifest(manifest);
+            return std::move(writer.m_data);
+        }
+    }
+
+    void ManifestCache::Create(const std::filesystem::path& filePath, const std::vector<std::pair<Manifest::Manifest, std::filesystem::path>>& manifests)
+    {
+        AICLI_LOG(Repo, Info, << "Creating manifest cache with " << manifests.size() << " manifests at [" << filePath << "]");
+
+        std::vector<std::pair<std::string, std::string>> serialized;
+        serialized.reserve(manifests.size());
+
+        for (const auto& manifest : manifests)
+        {
+            serialized.emplace_back(GetKey(manifest.second), SerializeManifest(manifest.first));
+        }
+
+        WriteCache(filePath, serialized);
+    }
+
+    void ManifestCache::CreateFromDirectory(const std::filesystem::path& filePath, const std::filesystem::path& rootDirectory)
+    {
+        AICLI_LOG(Repo, Info, << "Creating manifest cache at [" << filePath << "] from directory [" << rootDirectory << "]");
+
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_PATH_NOT_FOUND), !std::filesystem::is_directory(rootDirectory));
+
+        std::vector<std::pair<std::filesystem::path, std::filesystem::path>> manifestPaths;
+
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(rootDirectory))
+        {
+            if (entry.is_regular_file() && Utility::CaseInsensitiveEquals(entry.path().extension().u8string(), ".yaml"))
+            {
+                manifestPaths.emplace_back(entry.path(), entry.path().lexically_relative(rootDirectory));
+            }
+        }
+
+        std::vector<std::pair<std::string, std::string>> serialized;
+        serialized.reserve(manifestPaths.size());
+
+        // Each manifest is serialized as it is parsed, so that only a few are held at once
+        ParallelManifestParser parser{ std::move(manifestPaths) };
+        while (auto manifest = parser.Next())
+        {
+            serialized.emplace_back(GetKey(manifest->second), SerializeManifest(manifest->first));
+        }
+
+        WriteCache(filePath, serialized);
+    }
+
+    ManifestCache ManifestCache::Open(const std::filesystem::path& filePath)
+    {
+        return OpenRange(filePath, 0, std::nullopt);
+    }
+
+    ManifestCache ManifestCache::Open(const std::filesystem::path& filePath, uint64_t offset, uint64_t size)
+    {
+        return OpenRange(filePath, offset, size);
+    }
+
+    ManifestCache ManifestCache::OpenRange(const std::filesystem::path& filePath, uint64_t offset, std::optional<uint64_t> size)
+    {
+        ManifestCache result;
+
+        result.m_file.reset(CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr));
+        THROW_LAST_ERROR_IF_MSG(!result.m_file, "failed opening manifest cache");
+
+        LARGE_INTEGER fileSize{};
+        THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(result.m_file.get(), &fileSize));
+        uint64_t fileSizeValue = static_cast<uint64_t>(fileSize.QuadPart);
+
+        THROW_HR_IF(s_CorruptCacheError, offset > fileSizeValue || (size && size.value() > fileSizeValue - offset));
+        result.m_size = size.value_or(fileSizeValue - offset);
+
+        // An empty file cannot be mapped, and is not a cache either
+        THROW_HR_IF(s_CorruptCacheError, result.m_size < sizeof(FileHeader));
+
+        result.m_mapping.reset(CreateFileMappingW(result.m_file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+        THROW_LAST_ERROR_IF_NULL_MSG(result.m_mapping, "failed creating file mapping of manifest cache");
+
+        // Only the range is mapped, from the allocation boundary before it, so that the rest of a larger file is not
+        SYSTEM_INFO systemInfo{};
+        GetSystemInfo(&systemInfo);
+        uint64_t viewOffset = offset - (offset % systemInfo.dwAllocationGranularity);
+        ULARGE_INTEGER viewOffsetParts{};
+        viewOffsetParts.QuadPart = viewOffset;
+
+        result.m_view.reset(static_cast<uint8_t*>(MapViewOfFile(result.m_mapping.get(), FILE_MAP_READ, viewOffsetParts.HighPart, viewOffsetParts.LowPart,
+            wil::safe_cast<SIZE_T>(offset - viewOffset + result.m_size))));
+        THROW_LAST_ERROR_IF_NULL_MSG(result.m_view, "failed mapping view of manifest cache");
+
+        result.m_base = result.m_view.get() + (offset - viewOffset);
+
+        const FileHeader* header = reinterpret_cast<const FileHeader*>(result.m_base);
+        THROW_HR_IF(s_CorruptCacheError, std::memcmp(header->Magic, s_ManifestCacheMagic, sizeof(header->Magic)) != 0);
+        THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_UNSUPPORTED_TYPE), header->Version != s_ManifestCacheVersion, "Manifest cache version %u is not supported", header->Version);
+
+        result.m_count = header->Count;
+        (void)result.GetBytes(sizeof(FileHeader), sizeof(FileEntry) * static_cast<uint64_t>(result.m_count));
+
+        AICLI_LOG(Repo, Info, << "Opened manifest cache with " << result.m_count << " manifests at [" << filePath << "]");
+
+        return result;
+    }
+
+    std::optional<Manifest::Manifest> ManifestCache::GetManifest(std::string_view relativePath) const
+    {
+        const FileEntry* begin = reinterpret_cast<const FileEntry*>(m_base + sizeof(FileHeader));
+        const FileEntry* end = begin + m_count;
+
+        auto keyOf = [this](const FileEntry& entry) { return GetBytes(entry.KeyOffset, entry.KeySize); };
+        const FileEntry* entry = std::lower_bound(begin, end, relativePath, [&](const FileEntry& a, std::string_view b) { return keyOf(a) < b; });
+
+        if (entry == end || keyOf(*entry) != relativePath)
+        {
+            return {};
+        }
+
+        Manifest::Manifest result;
+        ManifestReader reader{ GetBytes(entry->ManifestOffset, entry->ManifestSize) };
+        reader.ReadManifest(result);
+        return result;
+    }
+
+    std::string ManifestCache::GetKey(const std::filesystem::path& relativePath)
+    {
+        std::string result;
+
+        for (const auto& part : relativePath)
+        {
+            if (!result.empty())
+            {
+                result += '/';
+            }
+
+            result += part.u8string();
+        }
+
+        return result;
+    }
+
+    std::string_view ManifestCache::GetBytes(uint64_t offset, uint64_t size) const
+    {
+        THROW_HR_IF(s_CorruptCacheError, offset > m_size || size > m_size - offset);
+        return { reinterpret_cast<const char*>(m_base + offset), static_cast<size_t>(size) };
+    }
+}
@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <winget/Manifest.h>
+#include <wil/resource.h>
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // A file of manifests in a compact binary form, published alongside the index so that a manifest can be read
+    // without downloading and parsing its YAML. Each manifest is keyed by its relative path, as the index stores it.
+    //
+    // The file is read through a mapped view, and only the manifests that are requested are read:
+    //  Header      { char magic[4]; uint32 version; uint32 count; uint32 reserved; }
+    //  Entries     { uint64 keyOffset; uint64 manifestOffset; uint32 keySize; uint32 manifestSize; }[count], ordered by key
+    //  Data        The keys, and the manifests with each string and array prefixed by its size
+    struct ManifestCache
+    {
+        // Writes a cache of the given manifests, each paired with its repository relative path.
+        static void Create(const std::filesystem::path& filePath, const std::vector<std::pair<Manifest::Manifest, std::filesystem::path>>& manifests);
+
+        // Writes a cache of every manifest (*.yaml) under the directory, with its path relative to the directory.
+        // The manifests are parsed in parallel; if any fails to parse, the cache is not written.
+        static void CreateFromDirectory(const std::filesystem::path& filePath, const std::filesystem::path& rootDirectory);
+
+        // Opens an existing cache; throws if the file is not a cache of a format that is understood.
+        static ManifestCache Open(const std::filesystem::path& filePath);
+
+        // Opens an existing cache that is held at the range of a larger file, such as a source bundle.
+        static ManifestCache Open(const std::filesystem::path& filePath, uint64_t offset, uint64_t size);
+
+        ManifestCache(const ManifestCache&) = delete;
+        ManifestCache& operator=(const ManifestCache&) = delete;
+
+        ManifestCache(ManifestCache&&) = default;
+        ManifestCache& operator=(ManifestCache&&) = default;
+
+        // Gets the number of manifests in the cache.
+        size_t GetCount() const { return m_count; }
+
+        // Gets the manifest at the repository relative path, if it is in the cache.
+        std::optional<Manifest::Manifest> GetManifest(std::string_view relativePath) const;
+
+        // Gets the key for a repository relative path, which is its parts joined by '/' as the index stores it.
+        static std::string GetKey(const std::filesystem::path& relativePath);
+
+    private:
+        ManifestCache() = default;
+
+        // Opens the cache at the range of the file; the range is the rest of the file if there is no size.
+        static ManifestCache OpenRange(const std::filesystem::path& filePath, uint64_t offset, std::optional<uint64_t> size);
+
+        // Gets bytes from the file, throwing if they are not all within it.
+        std::string_view GetBytes(uint64_t offset, uint64_t size) const;
+
+        wil::unique_hfile m_file;
+        wil::unique_handle m_mapping;
+        wil::unique_mapview_ptr<uint8_t> m_view;
+        // The start of the cache within the view.
+        const uint8_t* m_base = nullptr;
+        uint64_t m_size = 0;
+        uint32_t m_count = 0;
+    };
+}
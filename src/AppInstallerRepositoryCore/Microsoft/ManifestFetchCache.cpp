@@ -0,0 +1,176 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/ManifestFetchCache.h"
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    using namespace std::string_literals;
+    using namespace std::string_view_literals;
+
+    namespace
+    {
+        static constexpr std::string_view s_ManifestFetchCache_FileName = "ManifestFetchCache.db"sv;
+
+        // The version of the table below; recorded as the user_version of the database.
+        // Any change to the table must increase this, causing existing caches to be recreated.
+        static constexpr int s_ManifestFetchCache_SchemaVersion = 1;
+
+        // Waiting for another process to finish writing is preferable to downloading the manifest again.
+        static constexpr std::chrono::milliseconds s_ManifestFetchCache_BusyTimeout = 2000ms;
+
+        static constexpr std::string_view s_ManifestFetchCache_ManifestsTable_Create = R"(
+CREATE TABLE [manifests](
+    [source] TEXT NOT NULL,
+    [path] TEXT NOT NULL,
+    [index_identity] TEXT NOT NULL,
+    [contents] TEXT NOT NULL,
+    [last_used] INT64 NOT NULL,
+    PRIMARY KEY([source], [path]))
+)"sv;
+
+        // Statements
+        static constexpr std::string_view s_ManifestFetchCacheStmt_DropManifests = "drop table if exists [manifests]"sv;
+        static constexpr std::string_view s_ManifestFetchCacheStmt_GetSchemaVersion = "pragma user_version"sv;
+        static constexpr std::string_view s_ManifestFetchCacheStmt_SetSchemaVersion = "pragma user_version = 1"sv;
+        static constexpr std::string_view s_ManifestFetchCacheStmt_Get =
+            "select [contents] from [manifests] where [source] = ? and [path] = ? and [index_identity] = ?"sv;
+        static constexpr std::string_view s_ManifestFetchCacheStmt_Touch =
+            "update [manifests] set [last_used] = (select ifnull(max([last_used]), 0) + 1 from [manifests]) where [source] = ? and [path] = ?"sv;
+        static constexpr std::string_view s_ManifestFetchCacheStmt_Put =
+            "insert or replace into [manifests] ([source], [path], [index_identity], [contents], [last_used]) values (?, ?, ?, ?, (select ifnull(max([last_used]), 0) + 1 from [manifests]))"sv;
+        static constexpr std::string_view s_ManifestFetchCacheStmt_Trim =
+            "delete from [manifests] where [rowid] in (select [rowid] from [manifests] order by [last_used] desc limit -1 offset ?)"sv;
+        static constexpr std::string_view s_ManifestFetchCacheStmt_RemoveSource = "delete from [manifests] where [source] = ?"sv;
+        static constexpr std::string_view s_ManifestFetchCacheStmt_GetEntryCount = "select count(*) from [manifests]"sv;
+
+        // Creates and executes a statement that has no parameters.
+        void Execute(SQLite::Connection& connection, std::string_view sql)
+        {
+            SQLite::Statement statement = SQLite::Statement::Create(connection, sql);
+            statement.Execute();
+        }
+    }
+
+    ManifestFetchCache::ManifestFetchCache(SQLite::Connection&& connection, size_t maximumEntries) :
+        m_connection(std::move(connection)), m_maximumEntries(maximumEntries)
+    {
+        THROW_HR_IF(E_INVALIDARG, m_maximumEntries == 0);
+    }
+
+    ManifestFetchCache ManifestFetchCache::Open(const std::filesystem::path& filePath, size_t maximumEntries)
+    {
+        if (filePath.has_parent_path())
+        {
+            std::filesystem::create_directories(filePath.parent_path());
+        }
+
+        ManifestFetchCache result{ SQLite::Connection::Create(filePath.u8string(), SQLite::Connection::OpenDisposition::Create), maximumEntries };
+        result.m_connection.SetBusyTimeout(s_ManifestFetchCache_BusyTimeout);
+        result.InitializeSchema();
+        return result;
+    }
+
+    std::filesystem::path ManifestFetchCache::GetDefaultPath()
+    {
+        std::filesystem::path result = Runtime::GetPathTo(Runtime::PathName::LocalState);
+        result /= s_ManifestFetchCache_FileName;
+        return result;
+    }
+
+    void ManifestFetchCache::RemoveSource(const std::filesystem::path& filePath, std::string_view sourceIdentifier)
+    {
+        if (!std::filesystem::exists(filePath))
+        {
+            return;
+        }
+
+        ManifestFetchCache cache = Open(filePath);
+        cache.Remove(sourceIdentifier);
+    }
+
+    void ManifestFetchCache::InitializeSchema()
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_connection, "manifestfetchcache_initialize");
+
+        SQLite::Statement getVersion = SQLite::Statement::Create(m_connection, s_ManifestFetchCacheStmt_GetSchemaVersion);
+        THROW_HR_IF(E_UNEXPECTED, !getVersion.Step());
+        int version = getVersion.GetColumn<int>(0);
+
+        if (version == s_ManifestFetchCache_SchemaVersion)
+        {
+            return;
+        }
+
+        AICLI_LOG(Repo, Info, << "Creating manifest fetch cache table, replacing version " << version);
+
+        Execute(m_connection, s_ManifestFetchCacheStmt_DropManifests);
+        Execute(m_connection, s_ManifestFetchCache_ManifestsTable_Create);
+
+        static_assert(s_ManifestFetchCache_SchemaVersion == 1, "Update the set statement with the version");
+        Execute(m_connection, s_ManifestFetchCacheStmt_SetSchemaVersion);
+
+        savepoint.Commit();
+    }
+
+    std::optional<std::string> ManifestFetchCache::Get(std::string_view sourceIdentifier, std::string_view indexIdentity, std::string_view relativePath)
+    {
+        SQLite::Statement get = SQLite::Statement::Create(m_connection, s_ManifestFetchCacheStmt_Get);
+        get.Bind(1, sourceIdentifier);
+        get.Bind(2, relativePath);
+        get.Bind(3, indexIdentity);
+
+        if (!get.Step())
+        {
+            return {};
+        }
+
+        std::string result = get.GetColumn<std::string>(0);
+
+        // Only a hit writes to the cache, so that a miss does not wait on other processes.
+        SQLite::Statement touch = SQLite::Statement::Create(m_connection, s_ManifestFetchCacheStmt_Touch);
+        touch.Bind(1, sourceIdentifier);
+        touch.Bind(2, relativePath);
+        touch.Execute();
+
+        AICLI_LOG(Repo, Verbose, << "Manifest fetch cache hit for: " << relativePath);
+
+        return result;
+    }
+
+    void ManifestFetchCache::Put(std::string_view sourceIdentifier, std::string_view indexIdentity, std::string_view relativePath, std::string_view contents)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_connection, "manifestfetchcache_put");
+
+        // An entry from another index is replaced, as the path may name different contents in this one.
+        SQLite::Statement put = SQLite::Statement::Create(m_connection, s_ManifestFetchCacheStmt_Put);
+        put.Bind(1, sourceIdentifier);
+        put.Bind(2, relativePath);
+        put.Bind(3, indexIdentity);
+        put.Bind(4, contents);
+        put.Execute();
+
+        SQLite::Statement trim = SQLite::Statement::Create(m_connection, s_ManifestFetchCacheStmt_Trim);
+        trim.Bind(1, static_cast<int64_t>(m_maximumEntries));
+        trim.Execute();
+
+        savepoint.Commit();
+    }
+
+    void ManifestFetchCache::Remove(std::string_view sourceIdentifier)
+    {
+        SQLite::Statement remove = SQLite::Statement::Create(m_connection, s_ManifestFetchCacheStmt_RemoveSource);
+        remove.Bind(1, sourceIdentifier);
+        remove.Execute();
+
+        AICLI_LOG(Repo, Info, << "Removed " << m_connection.GetChanges() << " manifest fetch cache entries for source: " << sourceIdentifier);
+    }
+
+    size_t ManifestFetchCache::GetEntryCount()
+    {
+        SQLite::Statement getCount = SQLite::Statement::Create(m_connection, s_ManifestFetchCacheStmt_GetEntryCount);
+        THROW_HR_IF(E_UNEXPECTED, !getCount.Step());
+        return static_cast<size_t>(getCount.GetColumn<int64_t>(0));
+    }
+}
@@ -0,0 +1,60 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // A cache of the manifests downloaded from sources, stored in a database so that it is shared by every process.
+    // Entries are keyed on the source and the relative path of the manifest, and hold its contents along with the
+    // identity of the index that named the path; the least recently used entries are removed beyond a maximum count.
+    struct ManifestFetchCache
+    {
+        // The default maximum number of entries in the cache.
+        static constexpr size_t DefaultMaximumEntries = 1024;
+
+        // Opens the cache at the given location, creating it if it does not exist.
+        static ManifestFetchCache Open(const std::filesystem::path& filePath, size_t maximumEntries = DefaultMaximumEntries);
+
+        // Gets the location of the cache shared by the sources.
+        static std::filesystem::path GetDefaultPath();
+
+        // Removes the entries for the source from the cache at the given location, if the cache exists.
+        // This should be called while holding the write lock of the source, after its index has been replaced.
+        static void RemoveSource(const std::filesystem::path& filePath, std::string_view sourceIdentifier);
+
+        ManifestFetchCache(const ManifestFetchCache&) = delete;
+        ManifestFetchCache& operator=(const ManifestFetchCache&) = delete;
+
+        ManifestFetchCache(ManifestFetchCache&&) = default;
+        ManifestFetchCache& operator=(ManifestFetchCache&&) = default;
+
+        // Gets the cached contents of the manifest, marking it as the most recently used.
+        // Returns an empty value if there is no entry for the manifest from the given index.
+        std::optional<std::string> Get(std::string_view sourceIdentifier, std::string_view indexIdentity, std::string_view relativePath);
+
+        // Stores the contents of the manifest, replacing any existing entry for its path.
+        void Put(std::string_view sourceIdentifier, std::string_view indexIdentity, std::string_view relativePath, std::string_view contents);
+
+        // Removes all of the entries for the source.
+        void Remove(std::string_view sourceIdentifier);
+
+        // Gets the number of entries in the cache.
+        size_t GetEntryCount();
+
+    private:
+        ManifestFetchCache(SQLite::Connection&& connection, size_t maximumEntries);
+
+        // Creates the table, or recreates it if it is from a different version of the cache.
+        void InitializeSchema();
+
+        SQLite::Connection m_connection;
+        size_t m_maximumEntries;
+    };
+}
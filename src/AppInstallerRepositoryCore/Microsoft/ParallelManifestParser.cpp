@@ -0,0 +1,189 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "ParallelManifestParser.h"
+#include <winget/ManifestYamlParser.h>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    namespace
+    {
+        // The number of parsed manifests held for each thread.
+        constexpr size_t s_ParallelManifestParser_SlotsPerThread = 8;
+
+        std::vector<ParallelManifestParser::Input> GetInputs(std::vector<std::pair<std::filesystem::path, std::filesystem::path>> manifestPaths)
+        {
+            std::vector<ParallelManifestParser::Input> result;
+            result.reserve(manifestPaths.size());
+
+            for (auto& paths : manifestPaths)
+            {
+                result.emplace_back(std::move(paths.first), std::nullopt, std::move(paths.second));
+            }
+
+            return result;
+        }
+    }
+
+    ParallelManifestParser::ParallelManifestParser(std::vector<std::pair<std::filesystem::path, std::filesystem::path>> manifestPaths, size_t threadCount, size_t capacity) :
+        ParallelManifestParser(GetInputs(std::move(manifestPaths)), threadCount, capacity) {}
+
+    ParallelManifestParser::ParallelManifestParser(std::vector<Input> inputs, size_t threadCount, size_t capacity) :
+        m_inputs(std::move(inputs))
+    {
+        if (!threadCount)
+        {
+            threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+        // More threads than manifests would never have anything to do.
+        threadCount = std::min(threadCount, m_inputs.size());
+
+        if (!capacity)
+        {
+            capacity = std::max<size_t>(threadCount, 1) * s_ParallelManifestParser_SlotsPerThread;
+        }
+
+        m_slots.resize(capacity);
+
+        AICLI_LOG(Repo, Info, << "Parsing " << m_inputs.size() << " manifests on " << threadCount << " threads");
+
+        try
+        {
+            for (size_t i = 0; i < threadCount; ++i)
+            {
+                m_threads.emplace_back(&ParallelManifestParser::ParseThread, this);
+            }
+        }
+        catch (...)
+        {
+            // The destructor will not run, so the threads that did start must be stopped here.
+            {
+                std::lock_guard<std::mutex> lock{ m_lock };
+                m_stopping = true;
+            }
+            m_slotAvailable.notify_all();
+
+            for (std::thread& thread : m_threads)
+            {
+                thread.join();
+            }
+
+            throw;
+        }
+    }
+
+    ParallelManifestParser::~ParallelManifestParser()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_lock };
+            m_stopping = true;
+        }
+        m_slotAvailable.notify_all();
+
+        for (std::thread& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    std::optional<std::pair<Manifest::Manifest, std::filesystem::path>> ParallelManifestParser::Next()
+    {
+        std::optional<Result> result = NextResult();
+
+        if (!result)
+        {
+            return {};
+        }
+
+        if (result->Error)
+        {
+            std::rethrow_exception(result->Error);
+        }
+
+        return std::make_pair(std::move(result->Parsed).value(), m_inputs[result->Index].RelativePath);
+    }
+
+    std::optional<ParallelManifestParser::Result> ParallelManifestParser::NextResult()
+    {
+        Slot slotResult;
+        Result result;
+
+        {
+            std::unique_lock<std::mutex> lock{ m_lock };
+
+            if (m_nextToReturn >= m_inputs.size())
+            {
+                return {};
+            }
+
+            result.Index = m_nextToReturn;
+            Slot& slot = m_slots[result.Index % m_slots.size()];
+            m_slotReady.wait(lock, [&]() { return slot.Ready; });
+
+            slotResult = std::move(slot);
+            slot = {};
+            ++m_nextToReturn;
+        }
+
+        m_slotAvailable.notify_all();
+
+        if (slotResult.Error)
+        {
+            const Input& input = m_inputs[result.Index];
+            AICLI_LOG(Repo, Error, << "Failed to parse manifest [" << (input.ManifestContent ? input.RelativePath : input.ManifestPath) << "]");
+        }
+
+        result.Parsed = std::move(slotResult.Parsed);
+        result.Error = std::move(slotResult.Error);
+        return result;
+    }
+
+    void ParallelManifestParser::ParseThread()
+    {
+        for (;;)
+        {
+            size_t index = 0;
+
+            {
+                std::unique_lock<std::mutex> lock{ m_lock };
+
+                m_slotAvailable.wait(lock, [&]()
+                    {
+                        return m_stopping || m_nextToParse >= m_inputs.size() || m_nextToParse < m_nextToReturn + m_slots.size();
+                    });
+
+                if (m_stopping || m_nextToParse >= m_inputs.size())
+                {
+                    return;
+                }
+
+                index = m_nextToParse++;
+            }
+
+            Slot result;
+
+            try
+            {
+                const Input& input = m_inputs[index];
+                result.Parsed = (input.ManifestContent ?
+                    Manifest::YamlParser::Create(input.ManifestContent.value()) :
+                    Manifest::YamlParser::CreateFromPath(input.ManifestPath));
+            }
+            catch (...)
+            {
+                result.Error = std::current_exception();
+            }
+
+            result.Ready = true;
+
+            {
+                std::lock_guard<std::mutex> lock{ m_lock };
+                m_slots[index % m_slots.size()] = std::move(result);
+            }
+
+            m_slotReady.notify_all();
+        }
+    }
+}
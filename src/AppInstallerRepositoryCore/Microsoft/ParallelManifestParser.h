@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <winget/Manifest.h>
+
+#include <condition_variable>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // Parses manifest files on a pool of threads, returning them in the order that they were given.
+    // Only a bounded number of parsed manifests are held at once, so the consumer can apply them as they arrive.
+    struct ParallelManifestParser
+    {
+        // A manifest to parse; the YAML content if it is given, and otherwise the file at the path.
+        struct Input
+        {
+            Input(std::filesystem::path manifestPath, std::optional<std::string> manifestContent, std::filesystem::path relativePath) :
+                ManifestPath(std::move(manifestPath)), ManifestContent(std::move(manifestContent)), RelativePath(std::move(relativePath)) {}
+
+            std::filesystem::path ManifestPath;
+            std::optional<std::string> ManifestContent;
+            std::filesystem::path RelativePath;
+        };
+
+        // The result of parsing the manifest at Index in the inputs; either the manifest or the error.
+        struct Result
+        {
+            size_t Index = 0;
+            std::optional<Manifest::Manifest> Parsed;
+            std::exception_ptr Error;
+        };
+
+        // Begins parsing the manifests at the given paths, each paired with its repository relative path.
+        // A thread count of zero uses one thread per processor; a capacity of zero uses a multiple of the thread count.
+        ParallelManifestParser(std::vector<std::pair<std::filesystem::path, std::filesystem::path>> manifestPaths, size_t threadCount = 0, size_t capacity = 0);
+
+        // Begins parsing the given manifests.
+        ParallelManifestParser(std::vector<Input> inputs, size_t threadCount = 0, size_t capacity = 0);
+
+        ParallelManifestParser(const ParallelManifestParser&) = delete;
+        ParallelManifestParser& operator=(const ParallelManifestParser&) = delete;
+
+        ParallelManifestParser(ParallelManifestParser&&) = delete;
+        ParallelManifestParser& operator=(ParallelManifestParser&&) = delete;
+
+        // Stops any parsing still in progress.
+        ~ParallelManifestParser();
+
+        // Gets the next manifest and its relative path, waiting for it to be parsed if necessary.
+        // Returns an empty value once all of the manifests have been returned.
+        // If the manifest failed to parse, the error is rethrown.
+        std::optional<std::pair<Manifest::Manifest, std::filesystem::path>> Next();
+
+        // Gets the result for the next manifest, waiting for it to be parsed if necessary.
+        // Returns an empty value once all of the manifests have been returned.
+        // Unlike Next, a manifest that failed to parse is returned with its error.
+        std::optional<Result> NextResult();
+
+    private:
+        // The result of parsing a single manifest.
+        struct Slot
+        {
+            bool Ready = false;
+            std::optional<Manifest::Manifest> Parsed;
+            std::exception_ptr Error;
+        };
+
+        void ParseThread();
+
+        std::vector<Input> m_inputs;
+
+        std::mutex m_lock;
+        std::condition_variable m_slotReady;
+        std::condition_variable m_slotAvailable;
+
+        // Holds manifest i at i % size; a manifest is only parsed once the one [size] before it has been returned.
+        std::vector<Slot> m_slots;
+        size_t m_nextToParse = 0;
+        size_t m_nextToReturn = 0;
+        bool m_stopping = false;
+
+        std::vector<std::thread> m_threads;
+    };
+}
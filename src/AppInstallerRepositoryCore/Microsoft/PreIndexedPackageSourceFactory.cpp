@@ -3,11 +3,18 @@
 #pragma once
 #include "pch.h"
 #include "Microsoft/PreIndexedPackageSourceFactory.h"
+#include "Microsoft/CompletionIndex.h"
+#include "Microsoft/HotColdSource.h"
+#include "Microsoft/IntegrityVerificationCache.h"
+#include "Microsoft/ManifestCache.h"
+#include "Microsoft/ManifestFetchCache.h"
 #include "Microsoft/SQLiteIndex.h"
 #include "Microsoft/SQLiteIndexSource.h"
+#include "Microsoft/SearchResultCache.h"
 
 using namespace std::string_literals;
 using namespace std::string_view_literals;
+using namespace std::chrono_literals;
 
 namespace AppInstaller::Repository::Microsoft
 {
@@ -18,18 +25,46 @@ namespace AppInstaller::Repository::Microsoft
         static constexpr std::string_view s_PreIndexedPackageSourceFactory_IndexFileName = "index.db"sv;
         // TODO: This being hard coded to force using the Public directory name is not ideal.
         static constexpr std::string_view s_PreIndexedPackageSourceFactory_IndexFilePath = "Public\\index.db"sv;
+        // The manifest cache is optional; a package that does not have one has its manifests downloaded.
+        static constexpr std::string_view s_PreIndexedPackageSourceFactory_ManifestCacheFileName = "manifestcache.bin"sv;
+        static constexpr std::string_view s_PreIndexedPackageSourceFactory_ManifestCacheFilePath = "Public\\manifestcache.bin"sv;
+        // Outside of a package, each version of the data is extracted to its own directory, and this file names the current one.
+        static constexpr std::string_view s_PreIndexedPackageSourceFactory_CurrentVersionFileName = "current"sv;
+        static constexpr std::string_view s_PreIndexedPackageSourceFactory_StagingExtension = ".staging"sv;
+        // A staging directory older than this was left by an update that did not finish.
+        static constexpr auto s_PreIndexedPackageSourceFactory_StagingExpiration = 24h;
+        // A source may also publish a package holding a hot index of its most used packages, whose index is extracted
+        // under its own name so that it is never mistaken for the full index.
+        static constexpr std::string_view s_PreIndexedPackageSourceFactory_HotPackageFileName = "hot.msix"sv;
+        static constexpr std::string_view s_PreIndexedPackageSourceFactory_HotIndexFileName = "hot.db"sv;
 
         // Construct the package location from the given details.
         // Currently expects that the arg is an https uri pointing to the root of the data.
-        std::string GetPackageLocation(const SourceDetails& details)
+        std::string GetPackageLocation(std::string_view arg, std::string_view packageFileName)
         {
-            THROW_HR_IF(E_INVALIDARG, details.Arg.empty());
-            std::string result = details.Arg;
+            THROW_HR_IF(E_INVALIDARG, arg.empty());
+            std::string result{ arg };
             if (result.back() != '/')
             {
                 result += '/';
             }
-            result += s_PreIndexedPackageSourceFactory_PackageFileName;
+            result += packageFileName;
+            return result;
+        }
+
+        std::string GetPackageLocation(const SourceDetails& details, std::string_view packageFileName = s_PreIndexedPackageSourceFactory_PackageFileName)
+        {
+            return GetPackageLocation(details.Arg, packageFileName);
+        }
+
+        // Gets the locations of the package, the given one first and then those of the mirrors of the source.
+        std::vector<std::string> GetPackageLocations(const std::string& packageLocation, const SourceDetails& details)
+        {
+            std::vector<std::string> result{ packageLocation };
+            for (const auto& mirror : details.Mirrors)
+            {
+                result.emplace_back(GetPackageLocation(mirror, s_PreIndexedPackageSourceFactory_PackageFileName));
+            }
             return result;
         }
 
@@ -47,6 +82,103 @@ namespace AppInstaller::Repository::Microsoft
             return "PreIndexedSourceCPRWL_"s + GetPackageFamilyNameFromDetails(details);
         }
 
+        // Names the search snapshot shared by every process that opens the index in the given version of the package.
+        // The source lock is already held for read while the snapshot is loaded, so this must not be the same name.
+        std::string CreateNameForSearchSnapshot(const SourceDetails& details, const winrt::Windows::ApplicationModel::PackageVersion& version)
+        {
+            std::ostringstream stream;
+            stream << CreateNameForCPRWL(details) << "_SearchSnapshot_" << version.Major << '.' << version.Minor << '.' << version.Build << '.' << version.Revision;
+            return stream.str();
+        }
+
+        // Reads the pages of a newly deployed index that searches use into the file cache, so that the first search after
+        // an update does not wait on a read for each of them. The update has succeeded by now, so a failure is only logged.
+        void PrewarmIndex(const std::filesystem::path& indexPath)
+        {
+            try
+            {
+                SQLiteIndex::Prewarm(indexPath);
+            }
+            CATCH_LOG();
+        }
+
+        // Creates the source for the index, using the search result and manifest fetch caches if they are enabled and the manifest cache if the package has one.
+        // The completion index is created here if it is enabled and missing, as this is the first use of the index since it was replaced.
+        // *Should only be called when under the read CrossProcessReaderWriteLock*
+        std::shared_ptr<ISource> CreateSourceFromIndex(
+            const SourceDetails& details,
+            SQLiteIndex&& index,
+            Synchronization::CrossProcessReaderWriteLock&& lock,
+            const std::filesystem::path& manifestCachePath)
+        {
+            if (Settings::ExperimentalFeature::IsEnabled(Settings::ExperimentalFeature::Feature::CompletionIndex))
+            {
+                std::filesystem::path completionIndexPath = CompletionIndex::GetDefaultPath(details);
+
+                std::error_code error;
+                if (!std::filesystem::exists(completionIndexPath, error))
+                {
+                    try
+                    {
+                        CompletionIndex::Create(completionIndexPath, index);
+                    }
+                    CATCH_LOG();
+                }
+            }
+
+            auto result = std::make_shared<SQLiteIndexSource>(details, std::move(index), std::move(lock));
+
+            std::error_code error;
+            if (std::filesystem::exists(manifestCachePath, error))
+            {
+                try
+                {
+                    result->SetManifestCache(ManifestCache::Open(manifestCachePath));
+                }
+                CATCH_LOG();
+            }
+
+            if (Settings::ExperimentalFeature::IsEnabled(Settings::ExperimentalFeature::Feature::SearchResultCache))
+            {
+                try
+                {
+                    result->SetSearchResultCache(SearchResultCache::Open(SearchResultCache::GetDefaultPath()));
+                }
+                CATCH_LOG();
+            }
+
+            if (Settings::ExperimentalFeature::IsEnabled(Settings::ExperimentalFeature::Feature::ManifestFetchCache))
+            {
+                try
+                {
+                    result->SetManifestFetchCache(ManifestFetchCache::Open(ManifestFetchCache::GetDefaultPath()));
+                }
+                CATCH_LOG();
+            }
+
+            return result;
+        }
+
+        // Removes the cached search results, manifests and completion index for the source, as its index has been replaced or removed.
+        // *Should only be called when under the write CrossProcessReaderWriteLock*
+        void RemoveCachedSourceData(const SourceDetails& details)
+        {
+            try
+            {
+                SearchResultCache::RemoveSource(SearchResultCache::GetDefaultPath(), SearchResultCache::GetSourceIdentifier(details));
+            }
+            CATCH_LOG();
+
+            try
+            {
+                ManifestFetchCache::RemoveSource(ManifestFetchCache::GetDefaultPath(), SearchResultCache::GetSourceIdentifier(details));
+            }
+            CATCH_LOG();
+
+            std::error_code error;
+            std::filesystem::remove(CompletionIndex::GetDefaultPath(details), error);
+        }
+
         // The base class for a package that comes from a preindexed packaged source.
         struct PreIndexedFactoryBase : public ISourceFactory
         {
@@ -87,30 +219,92 @@ namespace AppInstaller::Repository::Microsoft
 
                 details.Data = Msix::GetPackageFamilyNameFromFullName(fullName);
 
-                auto lock = Synchronization::CrossProcessReaderWriteLock::LockForWrite(CreateNameForCPRWL(details));
-
-                UpdateInternal(packageLocation, details, progress);
+                UpdateIfModified(packageLocation, details, progress, false);
             }
 
-            void Update(const SourceDetails& details, IProgressCallback& progress) override final
+            void Update(SourceDetails& details, IProgressCallback& progress) override final
             {
                 THROW_HR_IF(E_INVALIDARG, details.Type != PreIndexedPackageSourceFactory::Type());
 
                 std::string packageLocation = GetPackageLocation(details);
 
-                auto lock = Synchronization::CrossProcessReaderWriteLock::LockForWrite(CreateNameForCPRWL(details));
+                UpdateIfModified(packageLocation, details, progress, HasExistingData(details));
+            }
+
+            // Updates the source data, first checking with a conditional request whether the remote package has changed
+            // since it was last fetched; this avoids reading the package at all when it has not.
+            // The validators of the package are recorded in the details for the next update.
+            void UpdateIfModified(const std::string& packageLocation, SourceDetails& details, IProgressCallback& progress, bool allowNotModified)
+            {
+                std::optional<Utility::ResourceValidators> validators;
+
+                if (Utility::IsUrlRemote(packageLocation))
+                {
+                    Utility::ResourceValidators previous;
+                    if (allowNotModified)
+                    {
+                        previous.ETag = details.DataETag;
+                        previous.LastModified = details.DataLastModified;
+                    }
+
+                    bool checked = false;
+                    try
+                    {
+                        validators = Utility::GetResourceValidatorsIfModified(packageLocation, previous);
+                        checked = true;
+                    }
+                    catch (...)
+                    {
+                        // Without the argument, the update can still come from a mirror; it is then not known whether
+                        // the data changed, so it is acquired and no validators are recorded.
+                        if (details.Mirrors.empty())
+                        {
+                            throw;
+                        }
+
+                        AICLI_LOG(Repo, Info, << "Unable to check whether the source data was modified, updating from the mirrors of the source");
+                    }
+
+                    if (checked && !validators)
+                    {
+                        AICLI_LOG(Repo, Info, << "Remote source data was not modified, no update needed");
+                        return;
+                    }
+                }
 
                 UpdateInternal(packageLocation, details, progress);
+
+                // A cancelled update may not have replaced the data, so it must not be recorded as current.
+                if (validators && !progress.IsCancelled())
+                {
+                    details.DataETag = std::move(validators->ETag);
+                    details.DataLastModified = std::move(validators->LastModified);
+                }
             }
 
+            // Determines whether the source data is present locally; without it, an update must not be skipped.
+            virtual bool HasExistingData(const SourceDetails& details) = 0;
+
+            // Acquires the new source data from the package location, then replaces the existing data with it through SwapUnderLock.
             virtual void UpdateInternal(std::string packageLocation, const SourceDetails& details, IProgressCallback& progress) = 0;
 
+            // Replaces the source data under the write lock, so that readers are only blocked by the swap itself rather
+            // than by the download that precedes it. Cached search results and manifests are removed while the lock is still held.
+            void SwapUnderLock(const SourceDetails& details, const std::function<void()>& swap)
+            {
+                auto lock = Synchronization::CrossProcessReaderWriteLock::LockForWrite(CreateNameForCPRWL(details));
+
+                swap();
+                RemoveCachedSourceData(details);
+            }
+
             void Remove(const SourceDetails& details, IProgressCallback& progress) override final
             {
                 THROW_HR_IF(E_INVALIDARG, details.Type != PreIndexedPackageSourceFactory::Type());
                 auto lock = Synchronization::CrossProcessReaderWriteLock::LockForWrite(CreateNameForCPRWL(details));
 
                 RemoveInternal(details, progress);
+                RemoveCachedSourceData(details);
             }
 
             virtual void RemoveInternal(const SourceDetails& details, IProgressCallback&) = 0;
@@ -126,6 +320,51 @@ namespace AppInstaller::Repository::Microsoft
                 return catalog.FindByPackageFamilyAndId(GetPackageFamilyNameFromDetails(details), Deployment::IndexDBId);
             }
 
+            // Verifies the integrity of the package content, unless the same package was verified recently and its index
+            // is the same file as it was then. Hashing the content of a large index is most of the cost of opening it.
+            // *Should only be called when under a CrossProcessReaderWriteLock*
+            void VerifyContentIntegrity(const SourceDetails& details, Deployment::Extension& extension, const std::filesystem::path& indexLocation, IProgressCallback& progress)
+            {
+                std::string packageFamilyName = GetPackageFamilyNameFromDetails(details);
+                std::string packageFullName = extension.GetPackageFullName();
+
+                std::optional<IntegrityVerificationCache> cache;
+                std::optional<IntegrityVerificationCache::FileIdentity> identity;
+
+                try
+                {
+                    identity = IntegrityVerificationCache::GetFileIdentity(indexLocation);
+                    cache = IntegrityVerificationCache::Open(IntegrityVerificationCache::GetDefaultPath());
+
+                    if (cache->IsVerified(packageFamilyName, packageFullName, identity.value()))
+                    {
+                        AICLI_LOG(Repo, Verbose, << "Using the cached integrity verification of " << packageFullName);
+                        return;
+                    }
+                }
+                CATCH_LOG();
+
+                bool verified = extension.VerifyContentIntegrity(progress);
+
+                if (cache && identity)
+                {
+                    try
+                    {
+                        if (verified)
+                        {
+                            cache->SetVerified(packageFamilyName, packageFullName, identity.value());
+                        }
+                        else
+                        {
+                            cache->Remove(packageFamilyName);
+                        }
+                    }
+                    CATCH_LOG();
+                }
+
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_NEEDS_REMEDIATION), !verified);
+            }
+
             std::shared_ptr<ISource> CreateInternal(const SourceDetails& details, Synchronization::CrossProcessReaderWriteLock&& lock, IProgressCallback& progress) override
             {
                 auto extension = GetExtensionFromDetails(details);
@@ -135,8 +374,6 @@ namespace AppInstaller::Repository::Microsoft
                     THROW_HR(APPINSTALLER_CLI_ERROR_SOURCE_DATA_MISSING);
                 }
 
-                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_NEEDS_REMEDIATION), !extension->VerifyContentIntegrity(progress));
-
                 // To work around an issue with accessing the public folder, we are temporarily
                 // constructing the location ourself.  This was already the case for the non-packaged
                 // runtime, and we can fix both in the future.  The only problem with this is that
@@ -144,20 +381,47 @@ namespace AppInstaller::Repository::Microsoft
                 std::filesystem::path indexLocation = extension->GetPackagePath();
                 indexLocation /= s_PreIndexedPackageSourceFactory_IndexFilePath;
 
+                VerifyContentIntegrity(details, extension.value(), indexLocation, progress);
+
+                std::filesystem::path manifestCacheLocation = extension->GetPackagePath();
+                manifestCacheLocation /= s_PreIndexedPackageSourceFactory_ManifestCacheFilePath;
+
                 SQLiteIndex index = SQLiteIndex::Open(indexLocation.u8string(), SQLiteIndex::OpenDisposition::Immutable);
 
-                return std::make_shared<SQLiteIndexSource>(details, std::move(index), std::move(lock));
+                if (Settings::ExperimentalFeature::IsEnabled(Settings::ExperimentalFeature::Feature::InMemorySearch))
+                {
+                    index.LoadSearchSnapshot(CreateNameForSearchSnapshot(details, extension->GetPackageVersion()));
+                }
+
+                return CreateSourceFromIndex(details, std::move(index), std::move(lock), manifestCacheLocation);
+            }
+
+            bool HasExistingData(const SourceDetails& details) override
+            {
+                return GetExtensionFromDetails(details).has_value();
             }
 
             void UpdateInternal(std::string packageLocation, const SourceDetails& details, IProgressCallback& progress) override
             {
-                // Check if the package is newer before calling into deployment.
-                // This can save us a lot of time over letting deployment detect same version.
-                auto extension = GetExtensionFromDetails(details);
-                if (extension)
+                // A remote package is downloaded once, with the segmented download that resumes after a dropped connection,
+                // and everything after reads the local file; deployment is given that file rather than downloading it again.
+                // The download is not under the write lock, so the file name must not collide with other processes.
+                std::filesystem::path tempFile;
+                auto removeTempFile = wil::scope_exit([&]()
+                    {
+                        if (!tempFile.empty())
+                        {
+                            std::error_code error;
+                            std::filesystem::remove(tempFile, error);
+                        }
+                    });
+
+                if (Utility::IsUrlRemote(packageLocation))
                 {
-                    Msix::MsixInfo packageInfo(packageLocation);
-                    THROW_HR_IF(APPINSTALLER_CLI_ERROR_PACKAGE_IS_BUNDLE, packageInfo.GetIsBundle());
+                    tempFile = Runtime::GetPathTo(Runtime::PathName::Temp);
+                    tempFile /= GetPackageFamilyNameFromDetails(details) + "_" + std::to_string(GetCurrentProcessId()) + ".msix";
+
+                    Utility::Download(GetPackageLocations(packageLocation, details), tempFile, Utility::DownloadType::Index, progress);
 
                     if (progress.IsCancelled())
                     {
@@ -165,48 +429,47 @@ namespace AppInstaller::Repository::Microsoft
                         return;
                     }
 
-                    if (!packageInfo.IsNewerThan(extension->GetPackageVersion()))
-                    {
-                        AICLI_LOG(Repo, Info, << "Remote source data was not newer than existing, no update needed");
-                        return;
-                    }
+                    packageLocation = tempFile.u8string();
                 }
 
-                if (progress.IsCancelled())
-                {
-                    AICLI_LOG(Repo, Info, << "Cancelling update upon request");
-                    return;
-                }
+                Msix::MsixInfo packageInfo(packageLocation);
+                THROW_HR_IF(APPINSTALLER_CLI_ERROR_PACKAGE_IS_BUNDLE, packageInfo.GetIsBundle());
 
-                // Due to complications with deployment, download the file and deploy from
-                // a local source while we investigate further.
-                bool download = Utility::IsUrlRemote(packageLocation);
-                std::filesystem::path tempFile;
-                winrt::Windows::Foundation::Uri uri = nullptr;
+                // The server could give any package at the url, and deploying one of another family would leave the source without its data
+                std::string packageFamilyName = Msix::GetPackageFamilyNameFromFullName(packageInfo.GetPackageFullName());
+                THROW_HR_IF_MSG(APPINSTALLER_CLI_ERROR_INDEX_INTEGRITY_COMPROMISED, !Utility::CaseInsensitiveEquals(packageFamilyName, GetPackageFamilyNameFromDetails(details)),
+                    "Source package family %hs does not match %hs", packageFamilyName.c_str(), GetPackageFamilyNameFromDetails(details).c_str());
 
-                if (download)
+                // Check if the package is newer before calling into deployment.
+                // This can save us a lot of time over letting deployment detect same version.
+                // Only the version of the extension is used here, so the lock is not needed; a concurrent swap
+                // can at worst cause a redundant deployment.
+                auto extension = GetExtensionFromDetails(details);
+                if (extension && !packageInfo.IsNewerThan(extension->GetPackageVersion()))
                 {
-                    tempFile = Runtime::GetPathTo(Runtime::PathName::Temp);
-                    tempFile /= GetPackageFamilyNameFromDetails(details) + ".msix";
-
-                    Utility::Download(packageLocation, tempFile, progress);
-
-                    uri = winrt::Windows::Foundation::Uri(tempFile.c_str());
+                    AICLI_LOG(Repo, Info, << "Remote source data was not newer than existing, no update needed");
+                    return;
                 }
-                else
+
+                if (progress.IsCancelled())
                 {
-                    uri = winrt::Windows::Foundation::Uri(Utility::ConvertToUTF16(packageLocation));
+                    AICLI_LOG(Repo, Info, << "Cancelling update upon request");
+                    return;
                 }
 
-                Deployment::RequestAddPackage(
-                    uri,
-                    winrt::Windows::Management::Deployment::DeploymentOptions::None,
-                    progress);
+                winrt::Windows::Foundation::Uri uri{ Utility::ConvertToUTF16(packageLocation) };
 
-                if (download)
+                SwapUnderLock(details, [&]()
+                    {
+                        Deployment::RequestAddPackage(
+                            uri,
+                            winrt::Windows::Management::Deployment::DeploymentOptions::None,
+                            progress);
+                    });
+
+                if (auto deployed = GetExtensionFromDetails(details))
                 {
-                    // If successful, delete the file
-                    std::filesystem::remove(tempFile);
+                    PrewarmIndex(deployed->GetPackagePath() / s_PreIndexedPackageSourceFactory_IndexFilePath);
                 }
             }
 
@@ -227,6 +490,9 @@ namespace AppInstaller::Repository::Microsoft
         };
 
         // Source factory for running outside of a package.
+        // Each version of the data is extracted to its own directory, and the current one is named by a file that an update
+        // replaces to swap in the new version. A source keeps the version that it opened, so that an update never waits for
+        // the open sources to be closed; an old version is removed by the first update after its last reader is closed.
         struct DesktopContextFactory : public PreIndexedFactoryBase
         {
             // Constructs the location that we will write files to.
@@ -238,28 +504,202 @@ namespace AppInstaller::Repository::Microsoft
                 return result;
             }
 
-            std::shared_ptr<ISource> CreateInternal(const SourceDetails& details, Synchronization::CrossProcessReaderWriteLock&& lock, IProgressCallback&) override
+            // Gets the directory of the current version of the data. Data written before versions were used is directly
+            // in the state directory, which is the current version until the next update.
+            // *Should only be called when under a CrossProcessReaderWriteLock*
+            std::filesystem::path GetCurrentVersionPath(const std::filesystem::path& statePath)
+            {
+                std::filesystem::path result = statePath;
+
+                std::ifstream stream{ statePath / s_PreIndexedPackageSourceFactory_CurrentVersionFileName };
+                std::string version;
+                if (stream && std::getline(stream, version))
+                {
+                    Utility::Trim(version);
+                    if (!version.empty())
+                    {
+                        result /= std::filesystem::u8path(version);
+                    }
+                }
+
+                return result;
+            }
+
+            std::string CreateVersionName()
+            {
+                GUID versionId;
+                THROW_IF_FAILED(CoCreateGuid(&versionId));
+
+                wchar_t guidAsString[MAX_PATH];
+                THROW_HR_IF(E_UNEXPECTED, StringFromGUID2(versionId, guidAsString, MAX_PATH) == 0);
+
+                // Drop the braces from around the GUID
+                std::string result = Utility::ConvertToUTF8(guidAsString);
+                return result.substr(1, result.size() - 2);
+            }
+
+            // Removes the versions of the data other than the current one that are no longer open, and the staging
+            // directories left by updates that did not finish.
+            // *Should only be called when under the write CrossProcessReaderWriteLock*
+            void RemoveUnusedVersions(const std::filesystem::path& statePath, const std::filesystem::path& currentVersionPath)
             {
-                std::filesystem::path packageLocation = GetStatePathFromDetails(details);
-                packageLocation /= s_PreIndexedPackageSourceFactory_IndexFileName;
+                std::error_code error;
 
-                if (!std::filesystem::exists(packageLocation))
+                // An open index cannot be removed, so removing it first determines whether the version is still in use
+                auto removeIfUnused = [&](const std::filesystem::path& versionPath)
                 {
-                    AICLI_LOG(Repo, Info, << "Data not found at " << packageLocation);
+                    bool hotIndexUnused = std::filesystem::remove(versionPath / s_PreIndexedPackageSourceFactory_HotIndexFileName, error) || !error;
+
+                    if (hotIndexUnused && (std::filesystem::remove(versionPath / s_PreIndexedPackageSourceFactory_IndexFileName, error) || !error))
+                    {
+                        std::filesystem::remove(versionPath / s_PreIndexedPackageSourceFactory_AppxManifestFileName, error);
+                        std::filesystem::remove(versionPath / s_PreIndexedPackageSourceFactory_ManifestCacheFileName, error);
+                        return true;
+                    }
+
+                    AICLI_LOG(Repo, Verbose, << "Source data version is still in use: " << versionPath.u8string());
+                    return false;
+                };
+
+                if (statePath != currentVersionPath)
+                {
+                    removeIfUnused(statePath);
+                }
+
+                auto expiration = std::filesystem::file_time_type::clock::now() - s_PreIndexedPackageSourceFactory_StagingExpiration;
+
+                for (const auto& entry : std::filesystem::directory_iterator{ statePath, error })
+                {
+                    if (!entry.is_directory(error) || entry.path() == currentVersionPath)
+                    {
+                        continue;
+                    }
+
+                    // Another update may still be writing to a staging directory
+                    if (entry.path().extension().u8string() == s_PreIndexedPackageSourceFactory_StagingExtension)
+                    {
+                        if (entry.last_write_time(error) > expiration || error)
+                        {
+                            continue;
+                        }
+                    }
+                    else if (!removeIfUnused(entry.path()))
+                    {
+                        continue;
+                    }
+
+                    AICLI_LOG(Repo, Info, << "Removing unused source data version: " << entry.path().u8string());
+                    std::filesystem::remove_all(entry.path(), error);
+                }
+            }
+
+            std::shared_ptr<ISource> CreateInternal(const SourceDetails& details, Synchronization::CrossProcessReaderWriteLock&&, IProgressCallback&) override
+            {
+                std::filesystem::path versionPath = GetCurrentVersionPath(GetStatePathFromDetails(details));
+
+                if (Settings::ExperimentalFeature::IsEnabled(Settings::ExperimentalFeature::Feature::HotIndex) &&
+                    !std::filesystem::exists(versionPath / s_PreIndexedPackageSourceFactory_IndexFileName) &&
+                    std::filesystem::exists(versionPath / s_PreIndexedPackageSourceFactory_HotIndexFileName))
+                {
+                    return CreateHotColdSource(details, versionPath);
+                }
+
+                return CreateFullSource(details, versionPath);
+            }
+
+            // Opens the full index of the version of the data.
+            // *Should only be called when under a CrossProcessReaderWriteLock*
+            std::shared_ptr<ISource> CreateFullSource(const SourceDetails& details, const std::filesystem::path& versionPath)
+            {
+                std::filesystem::path indexPath = versionPath / s_PreIndexedPackageSourceFactory_IndexFileName;
+
+                if (!std::filesystem::exists(indexPath))
+                {
+                    AICLI_LOG(Repo, Info, << "Data not found at " << indexPath);
                     THROW_HR(APPINSTALLER_CLI_ERROR_SOURCE_DATA_MISSING);
                 }
 
-                SQLiteIndex index = SQLiteIndex::Open(packageLocation.u8string(), SQLiteIndex::OpenDisposition::Read);
+                SQLiteIndex index = SQLiteIndex::Open(indexPath.u8string(), SQLiteIndex::OpenDisposition::Read);
 
-                return std::make_shared<SQLiteIndexSource>(details, std::move(index), std::move(lock));
+                // The open index keeps its version from being removed, so the lock is only held while the source is created
+                // rather than for its lifetime.
+                return CreateSourceFromIndex(details, std::move(index), {}, versionPath / s_PreIndexedPackageSourceFactory_ManifestCacheFileName);
+            }
+
+            // Opens the hot index of the version of the data, and acquires the full index on another thread for the source
+            // to use once it is available. The hot index has no manifest cache, so its manifests are downloaded.
+            // *Should only be called when under a CrossProcessReaderWriteLock*
+            std::shared_ptr<ISource> CreateHotColdSource(const SourceDetails& details, const std::filesystem::path& versionPath)
+            {
+                AICLI_LOG(Repo, Info, << "Using the hot index until the full index is available for source: " << details.Name);
+
+                SQLiteIndex index = SQLiteIndex::Open((versionPath / s_PreIndexedPackageSourceFactory_HotIndexFileName).u8string(), SQLiteIndex::OpenDisposition::Read);
+                std::optional<BloomFilter> coldIdFilter = index.GetColdIdFilter();
+
+                auto hot = CreateSourceFromIndex(details, std::move(index), {}, versionPath / s_PreIndexedPackageSourceFactory_ManifestCacheFileName);
+
+                // The update takes the locks that it needs, so it only swaps in the full index once this source has been created
+                std::shared_future<std::shared_ptr<ISource>> cold = std::async(std::launch::async, [details]()
+                    {
+                        DesktopContextFactory factory;
+                        ProgressCallback progress;
+                        factory.UpdateInternal(GetPackageLocation(details), details, progress);
+
+                        auto lock = Synchronization::CrossProcessReaderWriteLock::LockForRead(CreateNameForCPRWL(details));
+                        return factory.CreateFullSource(details, factory.GetCurrentVersionPath(factory.GetStatePathFromDetails(details)));
+                    }).share();
+
+                return std::make_shared<HotColdSource>(std::move(hot), std::move(coldIdFilter), std::move(cold));
+            }
+
+            bool HasExistingData(const SourceDetails& details) override
+            {
+                auto lock = Synchronization::CrossProcessReaderWriteLock::LockForRead(CreateNameForCPRWL(details));
+
+                std::filesystem::path versionPath = GetCurrentVersionPath(GetStatePathFromDetails(details));
+                return std::filesystem::exists(versionPath / s_PreIndexedPackageSourceFactory_AppxManifestFileName) &&
+                    std::filesystem::exists(versionPath / s_PreIndexedPackageSourceFactory_IndexFileName);
             }
 
             void UpdateInternal(std::string packageLocation, const SourceDetails& details, IProgressCallback& progress) override
             {
-                // We will extract the manifest and index files directly to this location
                 std::filesystem::path packageState = GetStatePathFromDetails(details);
                 std::filesystem::create_directories(packageState);
 
+                if (Settings::ExperimentalFeature::IsEnabled(Settings::ExperimentalFeature::Feature::HotIndex) &&
+                    TryUpdateHotIndex(details, packageState, progress))
+                {
+                    return;
+                }
+
+                // The package is otherwise read from its location as it is needed, but with mirrors it is downloaded once
+                // from whichever of them serves it, so that the source can still be updated when the argument cannot.
+                std::filesystem::path tempFile;
+                auto removeTempFile = wil::scope_exit([&]()
+                    {
+                        if (!tempFile.empty())
+                        {
+                            std::error_code error;
+                            std::filesystem::remove(tempFile, error);
+                        }
+                    });
+
+                if (!details.Mirrors.empty() && Utility::IsUrlRemote(packageLocation))
+                {
+                    tempFile = Runtime::GetPathTo(Runtime::PathName::Temp);
+                    tempFile /= GetPackageFamilyNameFromDetails(details) + "_" + std::to_string(GetCurrentProcessId()) + ".msix";
+
+                    Utility::Download(GetPackageLocations(packageLocation, details), tempFile, Utility::DownloadType::Index, progress);
+
+                    if (progress.IsCancelled())
+                    {
+                        AICLI_LOG(Repo, Info, << "Cancelling update upon request");
+                        return;
+                    }
+
+                    packageLocation = tempFile.u8string();
+                }
+
                 Msix::MsixInfo packageInfo(packageLocation);
                 THROW_HR_IF(APPINSTALLER_CLI_ERROR_PACKAGE_IS_BUNDLE, packageInfo.GetIsBundle());
 
@@ -269,10 +709,16 @@ namespace AppInstaller::Repository::Microsoft
                     return;
                 }
 
-                std::filesystem::path manifestPath = packageState / s_PreIndexedPackageSourceFactory_AppxManifestFileName;
-                std::filesystem::path indexPath = packageState / s_PreIndexedPackageSourceFactory_IndexFileName;
+                // A concurrent swap can at worst cause a redundant update, so the lock is only needed to find the current version
+                std::filesystem::path currentVersionPath;
+                {
+                    auto lock = Synchronization::CrossProcessReaderWriteLock::LockForRead(CreateNameForCPRWL(details));
+                    currentVersionPath = GetCurrentVersionPath(packageState);
+                }
 
-                if (std::filesystem::exists(manifestPath) && std::filesystem::exists(indexPath))
+                std::filesystem::path manifestPath = currentVersionPath / s_PreIndexedPackageSourceFactory_AppxManifestFileName;
+
+                if (std::filesystem::exists(manifestPath) && std::filesystem::exists(currentVersionPath / s_PreIndexedPackageSourceFactory_IndexFileName))
                 {
                     // If we already have a manifest, use it to determine if we need to update or not.
                     if (!packageInfo.IsNewerThan(manifestPath))
@@ -288,8 +734,110 @@ namespace AppInstaller::Repository::Microsoft
                     return;
                 }
 
-                packageInfo.WriteToFile(s_PreIndexedPackageSourceFactory_IndexFilePath, indexPath, progress);
-                packageInfo.WriteManifestToFile(manifestPath, progress);
+                ExtractVersion(details, packageState, progress, [&](const std::filesystem::path& stagingPath)
+                    {
+                        packageInfo.WriteToFile(s_PreIndexedPackageSourceFactory_IndexFilePath, stagingPath / s_PreIndexedPackageSourceFactory_IndexFileName, progress);
+                        packageInfo.WriteManifestToFile(stagingPath / s_PreIndexedPackageSourceFactory_AppxManifestFileName, progress);
+
+                        if (packageInfo.ContainsFile(s_PreIndexedPackageSourceFactory_ManifestCacheFilePath))
+                        {
+                            packageInfo.WriteToFile(s_PreIndexedPackageSourceFactory_ManifestCacheFilePath, stagingPath / s_PreIndexedPackageSourceFactory_ManifestCacheFileName, progress);
+                        }
+                    });
+            }
+
+            // Extracts only the hot index when the source has no data yet, so that it can be searched without waiting for the
+            // full index, which the first source to be opened then acquires. A version with only the hot index is not existing
+            // data, so an update before then acquires the full index as well. Returns false if the source already has data,
+            // or does not publish a hot index.
+            bool TryUpdateHotIndex(const SourceDetails& details, const std::filesystem::path& packageState, IProgressCallback& progress)
+            {
+                {
+                    auto lock = Synchronization::CrossProcessReaderWriteLock::LockForRead(CreateNameForCPRWL(details));
+                    std::filesystem::path currentVersionPath = GetCurrentVersionPath(packageState);
+
+                    if (std::filesystem::exists(currentVersionPath / s_PreIndexedPackageSourceFactory_IndexFileName) ||
+                        std::filesystem::exists(currentVersionPath / s_PreIndexedPackageSourceFactory_HotIndexFileName))
+                    {
+                        return false;
+                    }
+                }
+
+                std::optional<Msix::MsixInfo> hotInfo;
+                try
+                {
+                    hotInfo.emplace(GetPackageLocation(details, s_PreIndexedPackageSourceFactory_HotPackageFileName));
+                }
+                catch (...)
+                {
+                    AICLI_LOG(Repo, Info, << "Source does not publish a hot index, acquiring the full index");
+                    return false;
+                }
+
+                THROW_HR_IF(APPINSTALLER_CLI_ERROR_PACKAGE_IS_BUNDLE, hotInfo->GetIsBundle());
+
+                AICLI_LOG(Repo, Info, << "Acquiring the hot index of source: " << details.Name);
+
+                ExtractVersion(details, packageState, progress, [&](const std::filesystem::path& stagingPath)
+                    {
+                        hotInfo->WriteToFile(s_PreIndexedPackageSourceFactory_IndexFilePath, stagingPath / s_PreIndexedPackageSourceFactory_HotIndexFileName, progress);
+                    });
+
+                return true;
+            }
+
+            // Extracts data to a new version directory, so that the swap only replaces the file naming the current version.
+            // The extraction is not under the write lock, so it is staged under a name that the swap gives up.
+            void ExtractVersion(const SourceDetails& details, const std::filesystem::path& packageState, IProgressCallback& progress, const std::function<void(const std::filesystem::path&)>& extract)
+            {
+                std::string versionName = CreateVersionName();
+                std::filesystem::path versionPath = packageState / std::filesystem::u8path(versionName);
+                std::filesystem::path stagingPath = versionPath;
+                stagingPath += s_PreIndexedPackageSourceFactory_StagingExtension;
+                std::filesystem::create_directories(stagingPath);
+
+                std::filesystem::path currentVersionFile = packageState / s_PreIndexedPackageSourceFactory_CurrentVersionFileName;
+                std::filesystem::path downloadCurrentVersionFile = currentVersionFile;
+                downloadCurrentVersionFile += "." + versionName + ".download";
+
+                auto removeStaging = wil::scope_exit([&]()
+                    {
+                        std::error_code error;
+                        std::filesystem::remove_all(stagingPath, error);
+                        std::filesystem::remove(downloadCurrentVersionFile, error);
+                    });
+
+                extract(stagingPath);
+
+                if (progress.IsCancelled())
+                {
+                    AICLI_LOG(Repo, Info, << "Cancelling update upon request");
+                    return;
+                }
+
+                {
+                    std::ofstream stream{ downloadCurrentVersionFile, std::ios::out | std::ios::trunc };
+                    stream << versionName << std::endl;
+                    THROW_HR_IF(E_FAIL, stream.fail());
+                }
+
+                SwapUnderLock(details, [&]()
+                    {
+                        std::filesystem::rename(stagingPath, versionPath);
+                        std::filesystem::rename(downloadCurrentVersionFile, currentVersionFile);
+
+                        RemoveUnusedVersions(packageState, versionPath);
+                    });
+
+                // A version holds the full index, or only the hot index until the full index is acquired
+                for (std::string_view indexFileName : { s_PreIndexedPackageSourceFactory_IndexFileName, s_PreIndexedPackageSourceFactory_HotIndexFileName })
+                {
+                    std::filesystem::path indexPath = versionPath / indexFileName;
+                    if (std::filesystem::exists(indexPath))
+                    {
+                        PrewarmIndex(indexPath);
+                    }
+                }
             }
 
             void RemoveInternal(const SourceDetails& details, IProgressCallback&) override
@@ -303,7 +851,17 @@ namespace AppInstaller::Repository::Microsoft
                 else
                 {
                     AICLI_LOG(Repo, Info, << "Removing state found for source: " << packageState.u8string());
-                    std::filesystem::remove_all(packageState);
+
+                    // Once the current version is no longer named, the data is missing even if an open version is left
+                    std::filesystem::remove(packageState / s_PreIndexedPackageSourceFactory_CurrentVersionFileName);
+                    RemoveUnusedVersions(packageState, {});
+
+                    std::error_code error;
+                    std::filesystem::remove_all(packageState, error);
+                    if (error)
+                    {
+                        AICLI_LOG(Repo, Warning, << "Source data still in use was not removed: " << error.message());
+                    }
                 }
             }
         };
@@ -320,4 +878,23 @@ namespace AppInstaller::Repository::Microsoft
             return std::make_unique<DesktopContextFactory>();
         }
     }
+
+    std::optional<std::vector<std::string>> PreIndexedPackageSourceFactory::GetCompletions(const SourceDetails& details, ApplicationMatchField field, std::string_view prefix)
+    {
+        THROW_HR_IF(E_INVALIDARG, details.Type != PreIndexedPackageSourceFactory::Type());
+
+        // The lock keeps the completion index from being removed for a new index while it is opened
+        auto lock = Synchronization::CrossProcessReaderWriteLock::LockForRead(CreateNameForCPRWL(details));
+
+        std::filesystem::path completionIndexPath = CompletionIndex::GetDefaultPath(details);
+
+        std::error_code error;
+        if (!std::filesystem::exists(completionIndexPath, error))
+        {
+            AICLI_LOG(Repo, Verbose, << "No completion index for source: " << details.Name);
+            return {};
+        }
+
+        return CompletionIndex::Open(completionIndexPath).GetCompletions(field, prefix);
+    }
 }
@@ -4,7 +4,10 @@
 #include "Public/AppInstallerRepositorySource.h"
 #include "SourceFactory.h"
 
+#include <optional>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace AppInstaller::Repository::Microsoft
 {
@@ -27,5 +30,9 @@ namespace AppInstaller::Repository::Microsoft
 
         // Creates a source factory for this type.
         static std::unique_ptr<ISourceFactory> Create();
+
+        // Gets the values of the field that start with the prefix from the completion index of the source, without opening its index.
+        // Returns an empty optional if the source has no completion index.
+        static std::optional<std::vector<std::string>> GetCompletions(const SourceDetails& details, ApplicationMatchField field, std::string_view prefix);
     };
 }
@@ -0,0 +1,175 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/RestResponseCache.h"
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    using namespace std::string_literals;
+    using namespace std::string_view_literals;
+
+    namespace
+    {
+        static constexpr std::string_view s_RestResponseCache_FileName = "RestResponseCache.db"sv;
+
+        // The version of the table below; recorded as the user_version of the database.
+        // Any change to the table must increase this, causing existing caches to be recreated.
+        static constexpr int s_RestResponseCache_SchemaVersion = 1;
+
+        // Waiting for another process to finish writing is preferable to requesting the whole response again.
+        static constexpr std::chrono::milliseconds s_RestResponseCache_BusyTimeout = 2000ms;
+
+        static constexpr std::string_view s_RestResponseCache_ResponsesTable_Create = R"(
+CREATE TABLE [responses](
+    [source] TEXT NOT NULL,
+    [request] TEXT NOT NULL,
+    [etag] TEXT NOT NULL,
+    [contents] TEXT NOT NULL,
+    [last_used] INT64 NOT NULL,
+    PRIMARY KEY([source], [request]))
+)"sv;
+
+        // Statements
+        static constexpr std::string_view s_RestResponseCacheStmt_DropResponses = "drop table if exists [responses]"sv;
+        static constexpr std::string_view s_RestResponseCacheStmt_GetSchemaVersion = "pragma user_version"sv;
+        static constexpr std::string_view s_RestResponseCacheStmt_SetSchemaVersion = "pragma user_version = 1"sv;
+        static constexpr std::string_view s_RestResponseCacheStmt_Get =
+            "select [etag], [contents] from [responses] where [source] = ? and [request] = ?"sv;
+        static constexpr std::string_view s_RestResponseCacheStmt_Touch =
+            "update [responses] set [last_used] = (select ifnull(max([last_used]), 0) + 1 from [responses]) where [source] = ? and [request] = ?"sv;
+        static constexpr std::string_view s_RestResponseCacheStmt_Put =
+            "insert or replace into [responses] ([source], [request], [etag], [contents], [last_used]) values (?, ?, ?, ?, (select ifnull(max([last_used]), 0) + 1 from [responses]))"sv;
+        static constexpr std::string_view s_RestResponseCacheStmt_Trim =
+            "delete from [responses] where [rowid] in (select [rowid] from [responses] order by [last_used] desc limit -1 offset ?)"sv;
+        static constexpr std::string_view s_RestResponseCacheStmt_RemoveSource = "delete from [responses] where [source] = ?"sv;
+        static constexpr std::string_view s_RestResponseCacheStmt_GetEntryCount = "select count(*) from [responses]"sv;
+
+        // Creates and executes a statement that has no parameters.
+        void Execute(SQLite::Connection& connection, std::string_view sql)
+        {
+            SQLite::Statement statement = SQLite::Statement::Create(connection, sql);
+            statement.Execute();
+        }
+    }
+
+    RestResponseCache::RestResponseCache(SQLite::Connection&& connection, size_t maximumEntries) :
+        m_connection(std::move(connection)), m_maximumEntries(maximumEntries)
+    {
+        THROW_HR_IF(E_INVALIDARG, m_maximumEntries == 0);
+    }
+
+    RestResponseCache RestResponseCache::Open(const std::filesystem::path& filePath, size_t maximumEntries)
+    {
+        if (filePath.has_parent_path())
+        {
+            std::filesystem::create_directories(filePath.parent_path());
+        }
+
+        RestResponseCache result{ SQLite::Connection::Create(filePath.u8string(), SQLite::Connection::OpenDisposition::Create), maximumEntries };
+        result.m_connection.SetBusyTimeout(s_RestResponseCache_BusyTimeout);
+        result.InitializeSchema();
+        return result;
+    }
+
+    std::filesystem::path RestResponseCache::GetDefaultPath()
+    {
+        std::filesystem::path result = Runtime::GetPathTo(Runtime::PathName::LocalState);
+        result /= s_RestResponseCache_FileName;
+        return result;
+    }
+
+    void RestResponseCache::RemoveSource(const std::filesystem::path& filePath, std::string_view sourceIdentifier)
+    {
+        if (!std::filesystem::exists(filePath))
+        {
+            return;
+        }
+
+        RestResponseCache cache = Open(filePath);
+        cache.Remove(sourceIdentifier);
+    }
+
+    void RestResponseCache::InitializeSchema()
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_connection, "restresponsecache_initialize");
+
+        SQLite::Statement getVersion = SQLite::Statement::Create(m_connection, s_RestResponseCacheStmt_GetSchemaVersion);
+        THROW_HR_IF(E_UNEXPECTED, !getVersion.Step());
+        int version = getVersion.GetColumn<int>(0);
+
+        if (version == s_RestResponseCache_SchemaVersion)
+        {
+            return;
+        }
+
+        AICLI_LOG(Repo, Info, << "Creating REST response cache table, replacing version " << version);
+
+        Execute(m_connection, s_RestResponseCacheStmt_DropResponses);
+        Execute(m_connection, s_RestResponseCache_ResponsesTable_Create);
+
+        static_assert(s_RestResponseCache_SchemaVersion == 1, "Update the set statement with the version");
+        Execute(m_connection, s_RestResponseCacheStmt_SetSchemaVersion);
+
+        savepoint.Commit();
+    }
+
+    std::optional<RestResponseCache::Entry> RestResponseCache::Get(std::string_view sourceIdentifier, std::string_view request)
+    {
+        SQLite::Statement get = SQLite::Statement::Create(m_connection, s_RestResponseCacheStmt_Get);
+        get.Bind(1, sourceIdentifier);
+        get.Bind(2, request);
+
+        if (!get.Step())
+        {
+            return {};
+        }
+
+        Entry result;
+        result.ETag = get.GetColumn<std::string>(0);
+        result.Contents = get.GetColumn<std::string>(1);
+        return result;
+    }
+
+    void RestResponseCache::Touch(std::string_view sourceIdentifier, std::string_view request)
+    {
+        SQLite::Statement touch = SQLite::Statement::Create(m_connection, s_RestResponseCacheStmt_Touch);
+        touch.Bind(1, sourceIdentifier);
+        touch.Bind(2, request);
+        touch.Execute();
+    }
+
+    void RestResponseCache::Put(std::string_view sourceIdentifier, std::string_view request, std::string_view etag, std::string_view contents)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_connection, "restresponsecache_put");
+
+        SQLite::Statement put = SQLite::Statement::Create(m_connection, s_RestResponseCacheStmt_Put);
+        put.Bind(1, sourceIdentifier);
+        put.Bind(2, request);
+        put.Bind(3, etag);
+        put.Bind(4, contents);
+        put.Execute();
+
+        SQLite::Statement trim = SQLite::Statement::Create(m_connection, s_RestResponseCacheStmt_Trim);
+        trim.Bind(1, static_cast<int64_t>(m_maximumEntries));
+        trim.Execute();
+
+        savepoint.Commit();
+    }
+
+    void RestResponseCache::Remove(std::string_view sourceIdentifier)
+    {
+        SQLite::Statement remove = SQLite::Statement::Create(m_connection, s_RestResponseCacheStmt_RemoveSource);
+        remove.Bind(1, sourceIdentifier);
+        remove.Execute();
+
+        AICLI_LOG(Repo, Info, << "Removed " << m_connection.GetChanges() << " REST response cache entries for source: " << sourceIdentifier);
+    }
+
+    size_t RestResponseCache::GetEntryCount()
+    {
+        SQLite::Statement getCount = SQLite::Statement::Create(m_connection, s_RestResponseCacheStmt_GetEntryCount);
+        THROW_HR_IF(E_UNEXPECTED, !getCount.Step());
+        return static_cast<size_t>(getCount.GetColumn<int64_t>(0));
+    }
+}
@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // A cache of the responses from the servers of REST sources, stored in a database so that it is shared by every process.
+    // Entries are keyed on the source and the request, and hold the body of the response along with its ETag, so that
+    // the server only needs to confirm that the response has not changed; the least recently used entries are removed
+    // beyond a maximum count.
+    struct RestResponseCache
+    {
+        // The default maximum number of entries in the cache.
+        static constexpr size_t DefaultMaximumEntries = 1024;
+
+        // A cached response.
+        struct Entry
+        {
+            std::string ETag;
+            std::string Contents;
+        };
+
+        // Opens the cache at the given location, creating it if it does not exist.
+        static RestResponseCache Open(const std::filesystem::path& filePath, size_t maximumEntries = DefaultMaximumEntries);
+
+        // Gets the location of the cache shared by the sources.
+        static std::filesystem::path GetDefaultPath();
+
+        // Removes the entries for the source from the cache at the given location, if the cache exists.
+        static void RemoveSource(const std::filesystem::path& filePath, std::string_view sourceIdentifier);
+
+        RestResponseCache(const RestResponseCache&) = delete;
+        RestResponseCache& operator=(const RestResponseCache&) = delete;
+
+        RestResponseCache(RestResponseCache&&) = default;
+        RestResponseCache& operator=(RestResponseCache&&) = default;
+
+        // Gets the cached response to the request; returns an empty value if there is none.
+        // The entry is only marked as used once the server confirms that it is current, with Touch.
+        std::optional<Entry> Get(std::string_view sourceIdentifier, std::string_view request);
+
+        // Marks the entry for the request as the most recently used.
+        void Touch(std::string_view sourceIdentifier, std::string_view request);
+
+        // Stores the response, replacing any existing entry for the request.
+        void Put(std::string_view sourceIdentifier, std::string_view request, std::string_view etag, std::string_view contents);
+
+        // Removes all of the entries for the source.
+        void Remove(std::string_view sourceIdentifier);
+
+        // Gets the number of entries in the cache.
+        size_t GetEntryCount();
+
+    private:
+        RestResponseCache(SQLite::Connection&& connection, size_t maximumEntries);
+
+        // Creates the table, or recreates it if it is from a different version of the cache.
+        void InitializeSchema();
+
+        SQLite::Connection m_connection;
+        size_t m_maximumEntries;
+    };
+}
@@ -0,0 +1,657 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/RestSource.h"
+#include "Microsoft/SearchResultCache.h"
+#include "SearchCursor.h"
+#include <winget/HttpSession.h>
+#include <winget/ManifestYamlParser.h>
+
+#include <json.h>
+#include <winrt/Windows.Storage.Streams.h>
+#include <winrt/Windows.Web.Http.Headers.h>
+
+#include <limits>
+#include <unordered_map>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    using namespace std::string_literals;
+    using namespace std::string_view_literals;
+    using namespace Utility;
+    using namespace winrt::Windows::Foundation;
+    using namespace winrt::Windows::Web::Http;
+
+    namespace
+    {
+        // The paths of the requests, relative to the root of the API.
+        static constexpr std::string_view s_RestSource_SearchPath = "manifestSearch"sv;
+        static constexpr std::string_view s_RestSource_ManifestPath = "packageManifests/"sv;
+        static constexpr std::string_view s_RestSource_InformationPath = "information"sv;
+
+        static constexpr std::wstring_view s_RestSource_JsonContentType = L"application/json"sv;
+        static constexpr std::wstring_view s_RestSource_YamlContentType = L"application/x-yaml"sv;
+        static constexpr std::wstring_view s_RestSource_ContinuationTokenHeader = L"ContinuationToken"sv;
+
+        // The number of ids found by a single search request.
+        static constexpr size_t s_RestSource_MaximumIdsPerRequest = 50;
+
+        std::string_view MatchFieldToRestName(ApplicationMatchField field)
+        {
+            switch (field)
+            {
+            case ApplicationMatchField::Id:
+                return "PackageIdentifier"sv;
+            case ApplicationMatchField::Name:
+                return "PackageName"sv;
+            case ApplicationMatchField::Moniker:
+                return "Moniker"sv;
+            case ApplicationMatchField::Command:
+                return "Command"sv;
+            case ApplicationMatchField::Tag:
+                return "Tag"sv;
+            }
+
+            THROW_HR(E_UNEXPECTED);
+        }
+
+        std::optional<ApplicationMatchField> RestNameToMatchField(std::string_view name)
+        {
+            for (auto field : { ApplicationMatchField::Id, ApplicationMatchField::Name, ApplicationMatchField::Moniker, ApplicationMatchField::Command, ApplicationMatchField::Tag })
+            {
+                if (MatchFieldToRestName(field) == name)
+                {
+                    return field;
+                }
+            }
+
+            return {};
+        }
+
+        std::optional<MatchType> RestNameToMatchType(std::string_view name)
+        {
+            for (auto type = MatchType::Exact; type <= MatchType::Wildcard; type = static_cast<MatchType>(static_cast<int>(type) + 1))
+            {
+                if (MatchTypeToString(type) == name)
+                {
+                    return type;
+                }
+            }
+
+            return {};
+        }
+
+        Json::Value CreateRequestMatch(const RequestMatch& match)
+        {
+            Json::Value result{ Json::objectValue };
+            result["KeyWord"] = match.Value;
+            result["MatchType"] = std::string{ MatchTypeToString(match.Type) };
+            return result;
+        }
+
+        Json::Value CreateMatchFilter(const ApplicationMatchFilter& filter)
+        {
+            Json::Value result{ Json::objectValue };
+            result["PackageMatchField"] = std::string{ MatchFieldToRestName(filter.Field) };
+            result["RequestMatch"] = CreateRequestMatch(filter);
+            return result;
+        }
+
+        // Gets the member of the node; a node that is not an object has no members.
+        const Json::Value& GetMember(const Json::Value& node, const char* member)
+        {
+            return (node.isObject() ? node[member] : Json::Value::nullSingleton());
+        }
+
+        // Gets the string member of the node; returns an empty value if it is missing or not a string.
+        std::optional<std::string> GetString(const Json::Value& node, const char* member)
+        {
+            const Json::Value& value = GetMember(node, member);
+            if (!value.isString())
+            {
+                return {};
+            }
+
+            return value.asString();
+        }
+
+        std::optional<ApplicationMatchFilter> ParseMatchFilter(const Json::Value& node)
+        {
+            if (!node.isObject())
+            {
+                return {};
+            }
+
+            auto field = RestNameToMatchField(GetString(node, "PackageMatchField").value_or(""s));
+            const Json::Value& requestMatch = GetMember(node, "RequestMatch");
+            if (!field || !requestMatch.isObject())
+            {
+                return {};
+            }
+
+            auto type = RestNameToMatchType(GetString(requestMatch, "MatchType").value_or(""s));
+            auto keyWord = GetString(requestMatch, "KeyWord");
+            if (!type || !keyWord)
+            {
+                return {};
+            }
+
+            return ApplicationMatchFilter{ field.value(), type.value(), keyWord.value() };
+        }
+
+        Json::Value ParseJson(std::string_view body)
+        {
+            Json::Value root;
+            Json::CharReaderBuilder builder;
+            const std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+            std::string error;
+
+            THROW_HR_IF_MSG(APPINSTALLER_CLI_ERROR_RESTSOURCE_INVALID_RESPONSE,
+                !reader->parse(body.data(), body.data() + body.size(), &root, &error),
+                "Failed parsing the response: %hs", error.c_str());
+
+            return root;
+        }
+
+        // Gets the root of the API of the source, ending with a separator so that request paths can be appended.
+        std::string GetApiRoot(const SourceDetails& details)
+        {
+            THROW_HR_IF(E_INVALIDARG, details.Arg.empty());
+            std::string result = details.Arg;
+            if (result.back() != '/')
+            {
+                result += '/';
+            }
+            return result;
+        }
+
+        std::string EscapeComponent(std::string_view value)
+        {
+            return ConvertToUTF8(Uri::EscapeComponent(ConvertToUTF16(value)));
+        }
+
+        // Gets the criteria that a package matched on when the server does not report them: those of the first part
+        // of the request, with the value of the package in that field where it is known.
+        ApplicationMatchFilter GetDefaultMatch(const SearchRequest& request, const RestProtocol::Package& package)
+        {
+            std::optional<ApplicationMatchFilter> criteria;
+
+            if (request.Query)
+            {
+                criteria.emplace(ApplicationMatchField::Id, request.Query->Type, request.Query->Value);
+            }
+            else if (!request.Inclusions.empty())
+            {
+                criteria.emplace(request.Inclusions[0]);
+            }
+            else if (!request.Filters.empty())
+            {
+                criteria.emplace(request.Filters[0]);
+            }
+            else
+            {
+                return { ApplicationMatchField::Id, MatchType::Exact, package.Id };
+            }
+
+            switch (criteria->Field)
+            {
+            case ApplicationMatchField::Id:
+                criteria->Value = package.Id;
+                break;
+            case ApplicationMatchField::Name:
+                criteria->Value = package.Name;
+                break;
+            default:
+                break;
+            }
+
+            return criteria.value();
+        }
+
+        // The IApplication impl for RestSource.
+        struct Application : public IApplication
+        {
+            Application(const std::shared_ptr<RestSource>& source, RestProtocol::Package&& package) :
+                m_source(source), m_package(std::move(package)) {}
+
+            // Inherited via IApplication
+            LocIndString GetId() override
+            {
+                return LocIndString{ m_package.Id };
+            }
+
+            LocIndString GetName() override
+            {
+                return LocIndString{ m_package.Name };
+            }
+
+            std::optional<Manifest::Manifest> GetManifest(const Utility::NormalizedString& version, const Utility::NormalizedString& channel) override
+            {
+                // The versions are sorted by channel and then latest first, so the latest is the first on the channel
+                for (const auto& versionAndChannel : m_package.Versions)
+                {
+                    if (CaseInsensitiveEquals(versionAndChannel.GetChannel().ToString(), channel) &&
+                        (version.empty() || versionAndChannel.GetVersion().ToString() == version))
+                    {
+                        return GetSource()->GetManifest(m_package.Id, versionAndChannel.GetVersion().ToString(), versionAndChannel.GetChannel().ToString());
+                    }
+                }
+
+                return {};
+            }
+
+            std::vector<Utility::VersionAndChannel> GetVersions() override
+            {
+                return m_package.Versions;
+            }
+
+        private:
+            std::shared_ptr<RestSource> GetSource()
+            {
+                std::shared_ptr<RestSource> source = m_source.lock();
+                THROW_HR_IF(E_NOT_VALID_STATE, !source);
+                return source;
+            }
+
+            std::weak_ptr<RestSource> m_source;
+            RestProtocol::Package m_package;
+        };
+
+        // A cursor over the results of a search, which requests each page from the server when the one before it has been read.
+        // The server gives the results best match first; each page is sorted by score in case the server does not score them the same way.
+        struct SearchCursor : public ISearchCursor
+        {
+            SearchCursor(std::shared_ptr<RestSource> source, const SearchRequest& request) :
+                m_source(std::move(source)), m_request(request) {}
+
+            std::vector<ResultMatch> Next(size_t count) override
+            {
+                std::vector<ResultMatch> result;
+
+                while (result.size() < count)
+                {
+                    if (m_position == m_page.size() && !FetchPage())
+                    {
+                        break;
+                    }
+
+                    result.emplace_back(std::move(m_page[m_position++]));
+                }
+
+                return result;
+            }
+
+            bool IsTruncated() const override { return m_truncated; }
+
+        private:
+            // Reads the next page that has results into m_page; returns false if there are no more.
+            bool FetchPage()
+            {
+                m_page.clear();
+                m_position = 0;
+
+                while (m_page.empty() && !m_finished)
+                {
+                    size_t pageSize = RestProtocol::MaximumPageSize;
+                    if (m_request.MaximumResults)
+                    {
+                        pageSize = std::min(pageSize, m_request.MaximumResults - m_resultCount);
+                    }
+
+                    RestProtocol::SearchPage page = m_source->GetSearchPage(m_request, pageSize, m_continuationToken);
+
+                    for (auto& package : page.Packages)
+                    {
+                        if (m_request.MaximumResults && m_resultCount == m_request.MaximumResults)
+                        {
+                            m_truncated = true;
+                            break;
+                        }
+
+                        ApplicationMatchFilter match = package.Match ? std::move(package.Match).value() : GetDefaultMatch(m_request, package);
+                        MatchScore score = GetMatchScore(match, m_request);
+                        m_page.emplace_back(std::make_unique<Application>(m_source, std::move(package)), std::move(match), score);
+                        ++m_resultCount;
+                    }
+
+                    m_continuationToken = std::move(page.ContinuationToken);
+
+                    if (m_continuationToken.empty())
+                    {
+                        m_finished = true;
+                    }
+                    else if (m_request.MaximumResults && m_resultCount == m_request.MaximumResults)
+                    {
+                        // The server has more results than were asked for
+                        m_truncated = true;
+                        m_finished = true;
+                    }
+                }
+
+                SortResultMatches(m_page);
+                return !m_page.empty();
+            }
+
+            std::shared_ptr<RestSource> m_source;
+            SearchRequest m_request;
+            std::string m_continuationToken;
+            std::vector<ResultMatch> m_page;
+            size_t m_position = 0;
+            size_t m_resultCount = 0;
+            bool m_finished = false;
+            bool m_truncated = false;
+        };
+    }
+
+    namespace RestProtocol
+    {
+        std::string CreateSearchRequestBody(const SearchRequest& request, size_t pageSize)
+        {
+            Json::Value root{ Json::objectValue };
+            root["MaximumResults"] = static_cast<Json::UInt64>(pageSize);
+
+            if (request.Query)
+            {
+                root["Query"] = CreateRequestMatch(request.Query.value());
+            }
+
+            if (!request.Inclusions.empty())
+            {
+                Json::Value& inclusions = root["Inclusions"] = Json::Value{ Json::arrayValue };
+                for (const auto& inclusion : request.Inclusions)
+                {
+                    inclusions.append(CreateMatchFilter(inclusion));
+                }
+            }
+
+            if (!request.Filters.empty())
+            {
+                Json::Value& filters = root["Filters"] = Json::Value{ Json::arrayValue };
+                for (const auto& filter : request.Filters)
+                {
+                    filters.append(CreateMatchFilter(filter));
+                }
+            }
+
+            Json::StreamWriterBuilder builder;
+            builder["indentation"] = "";
+            return Json::writeString(builder, root);
+        }
+
+        SearchPage ParseSearchResponse(std::string_view body)
+        {
+            SearchPage result;
+
+            // A server may answer a search that found nothing with no content
+            if (body.empty())
+            {
+                return result;
+            }
+
+            Json::Value root = ParseJson(body);
+            const Json::Value& data = GetMember(root, "Data");
+            THROW_HR_IF_MSG(APPINSTALLER_CLI_ERROR_RESTSOURCE_INVALID_RESPONSE, !data.isNull() && !data.isArray(), "The search response data is not an array");
+
+            for (const Json::Value& packageNode : data)
+            {
+                Package package;
+
+                auto id = GetString(packageNode, "PackageIdentifier");
+                THROW_HR_IF_MSG(APPINSTALLER_CLI_ERROR_RESTSOURCE_INVALID_RESPONSE, !id || id->empty(), "A search result has no package identifier");
+                package.Id = std::move(id).value();
+                package.Name = GetString(packageNode, "PackageName").value_or(package.Id);
+
+                for (const Json::Value& versionNode : GetMember(packageNode, "Versions"))
+                {
+                    auto version = GetString(versionNode, "PackageVersion");
+                    THROW_HR_IF_MSG(APPINSTALLER_CLI_ERROR_RESTSOURCE_INVALID_RESPONSE, !version, "A version of %hs has no package version", package.Id.c_str());
+                    package.Versions.emplace_back(Version{ std::move(version).value() }, Channel{ GetString(versionNode, "Channel").value_or(""s) });
+                }
+
+                THROW_HR_IF_MSG(APPINSTALLER_CLI_ERROR_RESTSOURCE_INVALID_RESPONSE, package.Versions.empty(), "The search result %hs has no versions", package.Id.c_str());
+                std::sort(package.Versions.begin(), package.Versions.end());
+
+                package.Match = ParseMatchFilter(GetMember(packageNode, "Match"));
+
+                result.Packages.emplace_back(std::move(package));
+            }
+
+            result.ContinuationToken = GetString(root, "ContinuationToken").value_or(""s);
+
+            return result;
+        }
+
+        std::string ParseInformationResponse(std::string_view body)
+        {
+            Json::Value root = ParseJson(body);
+
+            auto identifier = GetString(GetMember(root, "Data"), "SourceIdentifier");
+            THROW_HR_IF_MSG(APPINSTALLER_CLI_ERROR_RESTSOURCE_INVALID_RESPONSE, !identifier || identifier->empty(), "The information response has no source identifier");
+
+            return std::move(identifier).value();
+        }
+    }
+
+    RestSource::RestSource(const SourceDetails& details) :
+        m_details(details), m_cacheSourceIdentifier(SearchResultCache::GetSourceIdentifier(details))
+    {
+    }
+
+    const SourceDetails& RestSource::GetDetails() const
+    {
+        return m_details;
+    }
+
+    SearchResult RestSource::Search(const SearchRequest& request)
+    {
+        SearchCursor cursor{ shared_from_this(), request };
+
+        SearchResult result;
+        result.Matches = cursor.Next(request.MaximumResults ? request.MaximumResults : std::numeric_limits<size_t>::max());
+        result.Truncated = cursor.IsTruncated();
+
+        // Each page is in order, but the results of one page may score better than those of the page before it
+        SortResultMatches(result.Matches);
+        return result;
+    }
+
+    std::unique_ptr<ISearchCursor> RestSource::OpenSearchCursor(const SearchRequest& request)
+    {
+        return std::make_unique<SearchCursor>(shared_from_this(), request);
+    }
+
+    SearchResult RestSource::SearchForIds(const std::vector<std::string>& ids)
+    {
+        // The positions are keyed on the folded id, as the server may not match ids with the same case
+        std::unordered_map<std::string, size_t> positions;
+        std::vector<std::string> uniqueIds;
+        for (const std::string& id : ids)
+        {
+            if (positions.emplace(FoldCase(id), uniqueIds.size()).second)
+            {
+                uniqueIds.push_back(id);
+            }
+        }
+
+        std::vector<std::unique_ptr<IApplication>> applications(uniqueIds.size());
+
+        for (size_t begin = 0; begin < uniqueIds.size(); begin += s_RestSource_MaximumIdsPerRequest)
+        {
+            size_t end = std::min(begin + s_RestSource_MaximumIdsPerRequest, uniqueIds.size());
+
+            SearchRequest request;
+            for (size_t i = begin; i < end; ++i)
+            {
+                request.Inclusions.emplace_back(ApplicationMatchField::Id, MatchType::Exact, uniqueIds[i]);
+            }
+
+            SearchCursor cursor{ shared_from_this(), request };
+            for (auto& match : cursor.Next(std::numeric_limits<size_t>::max()))
+            {
+                auto position = positions.find(FoldCase(match.Application->GetId().get()));
+                if (position != positions.end() && !applications[position->second])
+                {
+                    applications[position->second] = std::move(match.Application);
+                }
+            }
+        }
+
+        SearchResult result;
+        for (size_t i = 0; i < uniqueIds.size(); ++i)
+        {
+            if (applications[i])
+            {
+                result.Matches.emplace_back(std::move(applications[i]), ApplicationMatchFilter(ApplicationMatchField::Id, MatchType::Exact, uniqueIds[i]));
+            }
+        }
+
+        AICLI_LOG(Repo, Verbose, << "Found " << result.Matches.size() << " of " << uniqueIds.size() << " ids");
+        return result;
+    }
+
+    void RestSource::SetResponseCache(RestResponseCache&& cache)
+    {
+        std::lock_guard<std::mutex> lock{ m_cacheLock };
+        m_responseCache.emplace(std::move(cache));
+    }
+
+    RestProtocol::SearchPage RestSource::GetSearchPage(const SearchRequest& request, size_t pageSize, std::string_view continuationToken)
+    {
+        AICLI_LOG(Repo, Verbose, << "Requesting a page of " << pageSize << " results from REST source " << m_details.Name << ": " << request.ToString());
+
+        std::string body = RestProtocol::CreateSearchRequestBody(request, pageSize);
+        std::optional<std::string> response = SendRequest(std::string{ s_RestSource_SearchPath }, body, continuationToken, s_RestSource_JsonContentType);
+
+        // A server that found nothing may report that there is no result
+        return RestProtocol::ParseSearchResponse(response.value_or(""s));
+    }
+
+    std::optional<Manifest::Manifest> RestSource::GetManifest(std::string_view id, std::string_view version, std::string_view channel)
+    {
+        std::string path{ s_RestSource_ManifestPath };
+        path += EscapeComponent(id);
+        path += "?Version=";
+        path += EscapeComponent(version);
+        if (!channel.empty())
+        {
+            path += "&Channel=";
+            path += EscapeComponent(channel);
+        }
+
+        std::optional<std::string> response = SendRequest(path, {}, {}, s_RestSource_YamlContentType);
+        if (!response)
+        {
+            return {};
+        }
+
+        return Manifest::YamlParser::Create(response.value());
+    }
+
+    std::string RestSource::GetSourceIdentifierFromServer()
+    {
+        std::optional<std::string> response = SendRequest(std::string{ s_RestSource_InformationPath }, {}, {}, s_RestSource_JsonContentType);
+        THROW_HR_IF_MSG(APPINSTALLER_CLI_ERROR_RESTSOURCE_INVALID_RESPONSE, !response, "The server has no information");
+
+        return RestProtocol::ParseInformationResponse(response.value());
+    }
+
+    std::optional<std::string> RestSource::SendRequest(
+        const std::string& relativePath,
+        std::string_view body,
+        std::string_view continuationToken,
+        std::wstring_view contentType)
+    {
+        std::string url = GetApiRoot(m_details) + relativePath;
+
+        // The body and token are part of the key, as searches are all sent to the same url
+        std::string cacheKey = url;
+        if (!body.empty() || !continuationToken.empty())
+        {
+            cacheKey += '\n';
+            cacheKey += body;
+            cacheKey += '\n';
+            cacheKey += continuationToken;
+        }
+
+        std::optional<RestResponseCache::Entry> cached;
+        {
+            std::lock_guard<std::mutex> lock{ m_cacheLock };
+            if (m_responseCache)
+            {
+                try
+                {
+                    cached = m_responseCache->Get(m_cacheSourceIdentifier, cacheKey);
+                }
+                CATCH_LOG();
+            }
+        }
+
+        HttpRequestMessage request{ body.empty() ? HttpMethod::Get() : HttpMethod::Post(), Uri{ ConvertToUTF16(url) } };
+        request.Headers().Accept().TryParseAdd(contentType);
+
+        if (!body.empty())
+        {
+            request.Content(HttpStringContent{ ConvertToUTF16(body), winrt::Windows::Storage::Streams::UnicodeEncoding::Utf8, s_RestSource_JsonContentType });
+        }
+
+        if (!continuationToken.empty())
+        {
+            request.Headers().Append(s_RestSource_ContinuationTokenHeader, ConvertToUTF16(continuationToken));
+        }
+
+        if (cached)
+        {
+            request.Headers().Append(L"If-None-Match", ConvertToUTF16(cached->ETag));
+        }
+
+        // The shared client keeps the connection to the server alive between requests, and decompresses the
+        // responses, which it asks the server to compress.
+        HttpResponseMessage response = GetSharedHttpClient().SendRequestAsync(request).get();
+        HttpStatusCode status = response.StatusCode();
+
+        if (status == HttpStatusCode::NotModified && cached)
+        {
+            AICLI_LOG(Repo, Verbose, << "REST response cache hit for: " << url);
+
+            std::lock_guard<std::mutex> lock{ m_cacheLock };
+            try
+            {
+                m_responseCache->Touch(m_cacheSourceIdentifier, cacheKey);
+            }
+            CATCH_LOG();
+
+            return std::move(cached->Contents);
+        }
+
+        if (status == HttpStatusCode::NotFound || status == HttpStatusCode::NoContent)
+        {
+            return {};
+        }
+
+        if (!response.IsSuccessStatusCode())
+        {
+            AICLI_LOG(Repo, Error, << "REST request failed. Returned status: " << static_cast<int>(status));
+            THROW_HR_MSG(MAKE_HRESULT(SEVERITY_ERROR, FACILITY_HTTP, static_cast<int>(status)), "REST request status is not success.");
+        }
+
+        std::string contents = ConvertToUTF8(response.Content().ReadAsStringAsync().get());
+
+        if (response.Headers().HasKey(L"ETag"))
+        {
+            std::string etag = ConvertToUTF8(response.Headers().Lookup(L"ETag"));
+
+            std::lock_guard<std::mutex> lock{ m_cacheLock };
+            if (m_responseCache && !etag.empty())
+            {
+                try
+                {
+                    m_responseCache->Put(m_cacheSourceIdentifier, cacheKey, etag, contents);
+                }
+                CATCH_LOG();
+            }
+        }
+
+        return contents;
+    }
+}
@@ -0,0 +1,102 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Microsoft/RestResponseCache.h"
+#include "Public/AppInstallerRepositorySource.h"
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // The messages exchanged with the server of a REST source.
+    namespace RestProtocol
+    {
+        // The largest number of results requested in a single page.
+        static constexpr size_t MaximumPageSize = 100;
+
+        // A single package in a page of search results.
+        struct Package
+        {
+            std::string Id;
+            std::string Name;
+            // The versions of the package, in sorted, descending order.
+            std::vector<Utility::VersionAndChannel> Versions;
+            // The criteria that the package matched on, if the server reported it.
+            std::optional<ApplicationMatchFilter> Match;
+        };
+
+        // A page of search results.
+        struct SearchPage
+        {
+            std::vector<Package> Packages;
+            // The token that requests the next page; empty on the last page.
+            std::string ContinuationToken;
+        };
+
+        // Creates the JSON body of a search request for a page of at most pageSize results.
+        std::string CreateSearchRequestBody(const SearchRequest& request, size_t pageSize);
+
+        // Parses the JSON body of the response to a search request.
+        SearchPage ParseSearchResponse(std::string_view body);
+
+        // Parses the JSON body of the response to an information request, returning the source identifier.
+        std::string ParseInformationResponse(std::string_view body);
+    }
+
+    // A source that sends its searches to a server.
+    struct RestSource : public std::enable_shared_from_this<RestSource>, public ISource
+    {
+        RestSource(const SourceDetails& details);
+
+        RestSource(const RestSource&) = delete;
+        RestSource& operator=(const RestSource&) = delete;
+
+        // Get the source's details.
+        const SourceDetails& GetDetails() const override;
+
+        // Execute a search on the source, reading pages from the server until the request is satisfied.
+        SearchResult Search(const SearchRequest& request) override;
+
+        // Opens a cursor that requests each page of results from the server only when it is read.
+        std::unique_ptr<ISearchCursor> OpenSearchCursor(const SearchRequest& request) override;
+
+        // Finds the ids with a search for each batch of them, rather than a request for each one.
+        SearchResult SearchForIds(const std::vector<std::string>& ids) override;
+
+        // Each search is its own requests to the server.
+        bool SupportsConcurrentSearches() const override { return true; }
+
+        // Uses the cache of responses, so that the server only needs to confirm that an earlier response is current.
+        void SetResponseCache(RestResponseCache&& cache);
+
+        // Sends the search request for a page of results, continuing from the token given by the previous page.
+        RestProtocol::SearchPage GetSearchPage(const SearchRequest& request, size_t pageSize, std::string_view continuationToken);
+
+        // Gets the manifest of the package version from the server; returns an empty value if there is none.
+        std::optional<Manifest::Manifest> GetManifest(std::string_view id, std::string_view version, std::string_view channel);
+
+        // Gets the source identifier from the information the server gives about itself.
+        std::string GetSourceIdentifierFromServer();
+
+    private:
+        // Sends a request to the server at the path relative to the root of its API, returning the response body.
+        // A GET is sent when the body is empty, otherwise a POST of the JSON body. Returns an empty value if the
+        // server reports that there is no such resource.
+        std::optional<std::string> SendRequest(
+            const std::string& relativePath,
+            std::string_view body,
+            std::string_view continuationToken,
+            std::wstring_view contentType);
+
+        SourceDetails m_details;
+        std::string m_cacheSourceIdentifier;
+        std::mutex m_cacheLock;
+        std::optional<RestResponseCache> m_responseCache;
+    };
+}
@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/RestSourceFactory.h"
+#include "Microsoft/RestResponseCache.h"
+#include "Microsoft/RestSource.h"
+#include "Microsoft/SearchResultCache.h"
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    namespace
+    {
+        // Removes the cached responses of the source, as the server no longer answers for it.
+        void RemoveCachedResponses(const SourceDetails& details)
+        {
+            try
+            {
+                RestResponseCache::RemoveSource(RestResponseCache::GetDefaultPath(), SearchResultCache::GetSourceIdentifier(details));
+            }
+            CATCH_LOG();
+        }
+
+        // There is no local copy of the data to keep, so adding and updating only ask the server to identify itself.
+        struct RestSourceFactoryImpl : public ISourceFactory
+        {
+            std::shared_ptr<ISource> Create(const SourceDetails& details, IProgressCallback&) override
+            {
+                THROW_HR_IF(E_INVALIDARG, details.Type != RestSourceFactory::Type());
+                THROW_HR_IF(E_UNEXPECTED, details.Data.empty());
+
+                auto result = std::make_shared<RestSource>(details);
+
+                try
+                {
+                    result->SetResponseCache(RestResponseCache::Open(RestResponseCache::GetDefaultPath()));
+                }
+                CATCH_LOG();
+
+                return result;
+            }
+
+            void Add(SourceDetails& details, IProgressCallback&) override
+            {
+                THROW_HR_IF(E_INVALIDARG, details.Type != RestSourceFactory::Type());
+                THROW_HR_IF(APPINSTALLER_CLI_ERROR_SOURCE_NOT_SECURE, !Utility::IsUrlSecure(details.Arg));
+
+                details.Data = RestSource{ details }.GetSourceIdentifierFromServer();
+                AICLI_LOG(Repo, Info, << "Found REST source identifier: " << details.Data);
+            }
+
+            void Update(SourceDetails& details, IProgressCallback&) override
+            {
+                THROW_HR_IF(E_INVALIDARG, details.Type != RestSourceFactory::Type());
+
+                std::string identifier = RestSource{ details }.GetSourceIdentifierFromServer();
+                if (identifier != details.Data)
+                {
+                    AICLI_LOG(Repo, Info, << "REST source identifier changed from " << details.Data << " to " << identifier);
+                    RemoveCachedResponses(details);
+                    details.Data = std::move(identifier);
+                }
+            }
+
+            void Remove(const SourceDetails& details, IProgressCallback&) override
+            {
+                THROW_HR_IF(E_INVALIDARG, details.Type != RestSourceFactory::Type());
+                RemoveCachedResponses(details);
+            }
+        };
+    }
+
+    std::unique_ptr<ISourceFactory> RestSourceFactory::Create()
+    {
+        return std::make_unique<RestSourceFactoryImpl>();
+    }
+}
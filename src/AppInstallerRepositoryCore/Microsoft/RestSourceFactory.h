@@ -0,0 +1,28 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Public/AppInstallerRepositorySource.h"
+#include "SourceFactory.h"
+
+#include <string_view>
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // A source that sends each search to a server, rather than searching a local copy of an index.
+    // Arg  ::  Expected to be the https uri of the root of the REST API, such as https://somewhere/api/
+    //          The server answers searches at manifestSearch, manifests at packageManifests/<id> and
+    //          describes itself at information.
+    // Data ::  The source identifier that the server gives in its information.
+    struct RestSourceFactory
+    {
+        // Get the type string for this source.
+        static constexpr std::string_view Type()
+        {
+            using namespace std::string_view_literals;
+            return "Microsoft.Rest"sv;
+        }
+
+        // Creates a source factory for this type.
+        static std::unique_ptr<ISourceFactory> Create();
+    };
+}
@@ -3,12 +3,22 @@
 #include "pch.h"
 #include "SQLiteIndex.h"
 #include "Schema/MetadataTable.h"
+#include "Schema/DeltaTable.h"
+#include "Schema/1_2/Interface.h"
+#include "Schema/1_0/ManifestTable.h"
+#include "ParallelManifestParser.h"
 #include <winget/ManifestYamlParser.h>
 
+#include <map>
+#include <set>
+
 namespace AppInstaller::Repository::Microsoft
 {
     namespace
     {
+        // The number of parsed manifests written to the index at a time when adding from files.
+        constexpr size_t s_SQLiteIndex_AddManifestsBatchSize = 1000;
+
         char const* const GetOpenDispositionString(SQLiteIndex::OpenDisposition disposition)
         {
             switch (disposition)
@@ -17,18 +27,116 @@ namespace AppInstaller::Repository::Microsoft
                 return "Read";
             case AppInstaller::Repository::Microsoft::SQLiteIndex::OpenDisposition::ReadWrite:
                 return "ReadWrite";
+            case AppInstaller::Repository::Microsoft::SQLiteIndex::OpenDisposition::ReadWriteWithLog:
+                return "ReadWriteWithLog";
             case AppInstaller::Repository::Microsoft::SQLiteIndex::OpenDisposition::Immutable:
                 return "ImmutableRead";
             default:
                 return "Unknown";
             }
         }
+
+        // The values that identify a manifest in the index, which are matched without regard to case.
+        using ManifestKey = std::tuple<std::string, std::string, std::string>;
+
+        ManifestKey GetManifestKey(const Manifest::Manifest& manifest)
+        {
+            return { Utility::FoldCase(manifest.Id), Utility::FoldCase(manifest.Version), Utility::FoldCase(manifest.Channel) };
+        }
+
+        // Determines if all of the values that the index stores for the manifests are the same.
+        bool AreIndexValuesEqual(const std::pair<Manifest::Manifest, std::filesystem::path>& a, const std::pair<Manifest::Manifest, std::filesystem::path>& b)
+        {
+            return
+                a.first.Id == b.first.Id &&
+                a.first.Name == b.first.Name &&
+                a.first.AppMoniker == b.first.AppMoniker &&
+                a.first.Version == b.first.Version &&
+                a.first.Channel == b.first.Channel &&
+                a.first.Tags == b.first.Tags &&
+                a.first.Commands == b.first.Commands &&
+                a.second == b.second;
+        }
+
+        // Copies the id filter values, if there are any. The filter is only used by an index with the write time it was made for.
+        void CopyIdFilter(SQLite::Connection& source, SQLite::Connection& target)
+        {
+            auto filter = Schema::MetadataTable::TryGetNamedValue<std::string>(source, Schema::s_MetadataValueName_IdFilter);
+            auto writeTime = Schema::MetadataTable::TryGetNamedValue<int64_t>(source, Schema::s_MetadataValueName_IdFilterWriteTime);
+
+            if (filter && writeTime)
+            {
+                Schema::MetadataTable::SetNamedValue(target, Schema::s_MetadataValueName_IdFilter, filter.value());
+                Schema::MetadataTable::SetNamedValue(target, Schema::s_MetadataValueName_IdFilterWriteTime, writeTime.value());
+            }
+        }
+
+        BloomFilter CreateIdFilter(const std::set<std::string>& foldedIds)
+        {
+            BloomFilter result{ foldedIds.size() };
+            for (const auto& id : foldedIds)
+            {
+                result.Add(id);
+            }
+            return result;
+        }
+
+        std::optional<BloomFilter> DeserializeIdFilter(const std::string& value)
+        {
+            try
+            {
+                return BloomFilter::Deserialize(value);
+            }
+            catch (...)
+            {
+                AICLI_LOG(Repo, Warning, << "Id filter could not be read and will not be used");
+                return std::nullopt;
+            }
+        }
+
+        // Page ranges are stored as "first:count" pairs separated by commas.
+        std::string SerializePageRanges(const std::vector<SQLiteIndex::PageRange>& ranges)
+        {
+            std::ostringstream stream;
+            for (size_t i = 0; i < ranges.size(); ++i)
+            {
+                stream << (i == 0 ? "" : ",") << ranges[i].First << ':' << ranges[i].Count;
+            }
+            return stream.str();
+        }
+
+        std::optional<std::vector<SQLiteIndex::PageRange>> DeserializePageRanges(const std::string& value)
+        {
+            std::vector<SQLiteIndex::PageRange> result;
+            std::istringstream stream{ value };
+            std::string range;
+
+            while (std::getline(stream, range, ','))
+            {
+                size_t separator = range.find(':');
+                if (separator == std::string::npos)
+                {
+                    AICLI_LOG(Repo, Warning, << "Prewarm pages could not be read and will not be used");
+                    return std::nullopt;
+                }
+
+                SQLiteIndex::PageRange pageRange;
+                pageRange.First = std::stoll(range.substr(0, separator));
+                pageRange.Count = std::stoll(range.substr(separator + 1));
+                result.emplace_back(pageRange);
+            }
+
+            return result;
+        }
     }
 
-    SQLiteIndex SQLiteIndex::CreateNew(const std::string& filePath, Schema::Version version)
+    SQLiteIndex SQLiteIndex::CreateNew(const std::string& filePath, Schema::Version version, OpenDisposition disposition)
     {
-        AICLI_LOG(Repo, Info, << "Creating new SQLite Index [" << version << "] at '" << filePath << "'");
-        SQLiteIndex result{ filePath, version };
+        THROW_HR_IF(E_INVALIDARG, disposition != OpenDisposition::ReadWrite && disposition != OpenDisposition::ReadWriteWithLog);
+
+        AICLI_LOG(Repo, Info, << "Creating new SQLite Index [" << version << "] for " << GetOpenDispositionString(disposition) << " at '" << filePath << "'");
+        SQLiteIndex result{ filePath, version,
+            disposition == OpenDisposition::ReadWriteWithLog ? SQLite::Connection::OpenFlags::WriteAheadLog : SQLite::Connection::OpenFlags::None };
 
         SQLite::Savepoint savepoint = SQLite::Savepoint::Create(result.m_dbconn, "sqliteindex_createnew");
 
@@ -54,6 +162,8 @@ namespace AppInstaller::Repository::Microsoft
             return { filePath, SQLite::Connection::OpenDisposition::ReadOnly, SQLite::Connection::OpenFlags::None };
         case AppInstaller::Repository::Microsoft::SQLiteIndex::OpenDisposition::ReadWrite:
             return { filePath, SQLite::Connection::OpenDisposition::ReadWrite, SQLite::Connection::OpenFlags::None };
+        case AppInstaller::Repository::Microsoft::SQLiteIndex::OpenDisposition::ReadWriteWithLog:
+            return { filePath, SQLite::Connection::OpenDisposition::ReadWrite, SQLite::Connection::OpenFlags::WriteAheadLog };
         case AppInstaller::Repository::Microsoft::SQLiteIndex::OpenDisposition::Immutable:
         {
             // Following the algorithm set forth at https://sqlite.org/uri.html [3.1] to convert to a URI path
@@ -99,7 +209,12 @@ namespace AppInstaller::Repository::Microsoft
 
             target += "?immutable=1";
 
-            return { target, SQLite::Connection::OpenDisposition::ReadOnly, SQLite::Connection::OpenFlags::Uri };
+            SQLiteIndex result{ target, SQLite::Connection::OpenDisposition::ReadOnly, SQLite::Connection::OpenFlags::Uri | SQLite::Connection::OpenFlags::OptimizeForRead };
+            result.m_isImmutable = true;
+
+            // Nothing else can change the index, so the searches of a request can run as separate statements, accumulating the results in memory.
+            result.m_interface->SetSearchResultsInMemory(true);
+            return result;
         }
         default:
             THROW_HR(E_UNEXPECTED);
@@ -107,23 +222,71 @@ namespace AppInstaller::Repository::Microsoft
     }
 
     SQLiteIndex::SQLiteIndex(const std::string& target, SQLite::Connection::OpenDisposition disposition, SQLite::Connection::OpenFlags flags) :
-        m_dbconn(SQLite::Connection::Create(target, disposition, flags))
+        m_target(target), m_flags(flags), m_dbconn(SQLite::Connection::Create(target, disposition, flags))
     {
-        m_dbconn.EnableICU();
+        // A reader mostly looks up exact values, so ICU is only registered once a statement compares with it
+        if (disposition == SQLite::Connection::OpenDisposition::ReadOnly)
+        {
+            m_dbconn.EnableICUOnFirstUse();
+        }
+        else
+        {
+            m_dbconn.EnableICU();
+        }
+
         m_version = Schema::Version::GetSchemaVersion(m_dbconn);
         AICLI_LOG(Repo, Info, << "Opened SQLite Index with version [" << m_version << "], last write [" << GetLastWriteTime() << "]");
-        m_interface = m_version.CreateISQLiteIndex();
+        SetInterface(m_version.CreateISQLiteIndex());
         THROW_HR_IF(APPINSTALLER_CLI_ERROR_CANNOT_WRITE_TO_UPLEVEL_INDEX, disposition == SQLite::Connection::OpenDisposition::ReadWrite && m_version != m_interface->GetVersion());
     }
 
-    SQLiteIndex::SQLiteIndex(const std::string& target, Schema::Version version) :
-        m_dbconn(SQLite::Connection::Create(target, SQLite::Connection::OpenDisposition::Create))
+    SQLiteIndex::SQLiteIndex(const std::string& target, Schema::Version version, SQLite::Connection::OpenFlags flags) :
+        m_target(target), m_flags(flags), m_dbconn(SQLite::Connection::Create(target, SQLite::Connection::OpenDisposition::Create, flags))
     {
         m_dbconn.EnableICU();
-        m_interface = version.CreateISQLiteIndex();
+        SetInterface(version.CreateISQLiteIndex());
         m_version = m_interface->GetVersion();
     }
 
+    void SQLiteIndex::SetInterface(std::unique_ptr<Schema::ISQLiteIndex>&& value)
+    {
+        m_interface = std::move(value);
+        m_latestInterface = dynamic_cast<Schema::V1_2::Interface*>(m_interface.get());
+    }
+
+    template <typename Operation>
+    decltype(auto) SQLiteIndex::WithInterface(Operation&& operation)
+    {
+        if (m_latestInterface)
+        {
+            return operation(*m_latestInterface);
+        }
+
+        return operation(*m_interface);
+    }
+
+    bool SQLiteIndex::CanOpenReader() const
+    {
+        // An empty target is a temporary database, which is private to its connection like one in memory.
+        return !m_target.empty() && m_target != ":memory:";
+    }
+
+    SQLiteIndex SQLiteIndex::OpenReader() const
+    {
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), !CanOpenReader());
+
+        AICLI_LOG(Repo, Verbose, << "Opening another SQLite Index reader for '" << m_target << "'");
+        SQLiteIndex result{ m_target, SQLite::Connection::OpenDisposition::ReadOnly, m_flags };
+
+        if (m_isImmutable)
+        {
+            result.m_isImmutable = true;
+            result.m_interface->SetSearchResultsInMemory(true);
+        }
+
+        return result;
+    }
+
     void SQLiteIndex::AddManifest(const std::filesystem::path& manifestPath, const std::filesystem::path& relativePath)
     {
         AICLI_LOG(Repo, Info, << "Adding manifest from file [" << manifestPath << "]");
@@ -145,6 +308,89 @@ namespace AppInstaller::Repository::Microsoft
         savepoint.Commit();
     }
 
+    void SQLiteIndex::AddManifests(const std::vector<std::pair<std::filesystem::path, std::filesystem::path>>& manifestPaths)
+    {
+        AICLI_LOG(Repo, Info, << "Adding " << manifestPaths.size() << " manifests from files");
+
+        // The files are parsed on other threads while this one writes the manifests to the index in batches.
+        ParallelManifestParser parser{ manifestPaths };
+
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_dbconn, "sqliteindex_addmanifests");
+
+        // An empty index is built from all of the manifests at once, so that every table can be written in the order of its key.
+        // This holds every parsed manifest in memory, but only for building a new index, which is done by the packaging tools.
+        size_t batchSize = s_SQLiteIndex_AddManifestsBatchSize;
+        if (Schema::V1_0::ManifestTable::IsEmpty(m_dbconn))
+        {
+            batchSize = std::numeric_limits<size_t>::max();
+        }
+
+        std::vector<std::pair<Manifest::Manifest, std::filesystem::path>> batch;
+        batch.reserve(std::min(batchSize, manifestPaths.size()));
+
+        size_t addedCount = 0;
+
+        for (auto manifest = parser.Next(); manifest; manifest = parser.Next())
+        {
+            batch.emplace_back(std::move(manifest).value());
+
+            if (batch.size() >= batchSize)
+            {
+                m_interface->AddManifests(m_dbconn, batch);
+                addedCount += batch.size();
+                batch.clear();
+
+                AICLI_LOG(Repo, Verbose, << "Added " << addedCount << " of " << manifestPaths.size() << " manifests");
+            }
+        }
+
+        if (!batch.empty())
+        {
+            m_interface->AddManifests(m_dbconn, batch);
+        }
+
+        SetLastWriteTime();
+
+        savepoint.Commit();
+        m_dbconn.Checkpoint();
+    }
+
+    void SQLiteIndex::AddManifestsFromDirectory(const std::filesystem::path& rootDirectory)
+    {
+        AICLI_LOG(Repo, Info, << "Adding manifests from directory [" << rootDirectory << "]");
+
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_PATH_NOT_FOUND), !std::filesystem::is_directory(rootDirectory));
+
+        std::vector<std::pair<std::filesystem::path, std::filesystem::path>> manifestPaths;
+
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(rootDirectory))
+        {
+            if (entry.is_regular_file() && Utility::CaseInsensitiveEquals(entry.path().extension().u8string(), ".yaml"))
+            {
+                manifestPaths.emplace_back(entry.path(), entry.path().lexically_relative(rootDirectory));
+            }
+        }
+
+        // Enumeration order is not defined; sorting makes the resulting index the same every time.
+        std::sort(manifestPaths.begin(), manifestPaths.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+
+        AddManifests(manifestPaths);
+    }
+
+    void SQLiteIndex::AddManifests(const std::vector<std::pair<Manifest::Manifest, std::filesystem::path>>& manifests)
+    {
+        AICLI_LOG(Repo, Info, << "Adding " << manifests.size() << " manifests");
+
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_dbconn, "sqliteindex_addmanifests");
+
+        m_interface->AddManifests(m_dbconn, manifests);
+
+        SetLastWriteTime();
+
+        savepoint.Commit();
+        m_dbconn.Checkpoint();
+    }
+
     bool SQLiteIndex::UpdateManifest(const std::filesystem::path& manifestPath, const std::filesystem::path& relativePath)
     {
         AICLI_LOG(Repo, Info, << "Updating manifest from file [" << manifestPath << "]");
@@ -163,6 +409,7 @@ namespace AppInstaller::Repository::Microsoft
 
         if (result)
         {
+            m_unusedValuesPending = m_unusedValuesPending || m_deferUnusedValueRemoval;
             SetLastWriteTime();
 
             savepoint.Commit();
@@ -186,44 +433,670 @@ namespace AppInstaller::Repository::Microsoft
         SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_dbconn, "sqliteindex_removemanifest");
 
         m_interface->RemoveManifest(m_dbconn, manifest, relativePath);
+        m_unusedValuesPending = m_unusedValuesPending || m_deferUnusedValueRemoval;
 
         SetLastWriteTime();
 
         savepoint.Commit();
     }
 
+    bool SQLiteIndex::ApplyManifestChanges(const std::vector<ManifestChange>& changes, const ManifestChangeCallback& callback)
+    {
+        AICLI_LOG(Repo, Info, << "Applying " << changes.size() << " manifest changes");
+
+        std::vector<ParallelManifestParser::Input> inputs;
+        inputs.reserve(changes.size());
+
+        for (const auto& change : changes)
+        {
+            inputs.emplace_back(change.ManifestPath, change.ManifestContent, change.RelativePath);
+        }
+
+        ParallelManifestParser parser{ std::move(inputs) };
+
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_dbconn, "sqliteindex_applymanifestchanges");
+
+        bool anyModified = false;
+
+        for (auto result = parser.NextResult(); result; result = parser.NextResult())
+        {
+            const ManifestChange& change = changes[result->Index];
+            HRESULT hr = S_OK;
+            bool modified = false;
+
+            try
+            {
+                if (result->Error)
+                {
+                    std::rethrow_exception(result->Error);
+                }
+
+                const Manifest::Manifest& manifest = result->Parsed.value();
+
+                // Each change has its own savepoint, so that one that fails part way leaves nothing behind
+                SQLite::Savepoint changeSavepoint = SQLite::Savepoint::Create(m_dbconn, "sqliteindex_applymanifestchange");
+
+                switch (change.ChangeOperation)
+                {
+                case ManifestChange::Operation::Add:
+                    m_interface->AddManifest(m_dbconn, manifest, change.RelativePath);
+                    modified = true;
+                    break;
+                case ManifestChange::Operation::Update:
+                    modified = m_interface->UpdateManifest(m_dbconn, manifest, change.RelativePath);
+                    m_unusedValuesPending = m_unusedValuesPending || (modified && m_deferUnusedValueRemoval);
+                    break;
+                case ManifestChange::Operation::Remove:
+                    m_interface->RemoveManifest(m_dbconn, manifest, change.RelativePath);
+                    m_unusedValuesPending = m_unusedValuesPending || m_deferUnusedValueRemoval;
+                    modified = true;
+                    break;
+                default:
+                    THROW_HR(E_INVALIDARG);
+                }
+
+                changeSavepoint.Commit();
+            }
+            catch (...)
+            {
+                hr = LOG_CAUGHT_EXCEPTION_MSG("Failed to apply manifest change %zu", result->Index);
+                modified = false;
+            }
+
+            anyModified = anyModified || modified;
+
+            if (callback)
+            {
+                callback(result->Index, hr, modified);
+            }
+        }
+
+        if (anyModified)
+        {
+            SetLastWriteTime();
+        }
+
+        // The values left by all of the changes are removed together, as part of the same transaction.
+        if (m_unusedValuesPending)
+        {
+            RemoveUnusedValues();
+        }
+
+        savepoint.Commit();
+        m_dbconn.Checkpoint();
+
+        return anyModified;
+    }
+
+    void SQLiteIndex::SetDeferUnusedValueRemoval(bool value)
+    {
+        m_deferUnusedValueRemoval = value;
+        m_interface->SetDeferUnusedValueRemoval(value);
+    }
+
+    void SQLiteIndex::RemoveUnusedValues()
+    {
+        AICLI_LOG(Repo, Info, << "Removing unused values");
+
+        m_interface->RemoveUnusedValues(m_dbconn);
+        m_unusedValuesPending = false;
+    }
+
+    void SQLiteIndex::MigrateTo(Schema::Version version)
+    {
+        std::unique_ptr<Schema::ISQLiteIndex> target = version.CreateISQLiteIndex();
+        Schema::Version targetVersion = target->GetVersion();
+
+        AICLI_LOG(Repo, Info, << "Migrating index from [" << m_version << "] to [" << targetVersion << "]");
+
+        if (targetVersion == m_version)
+        {
+            return;
+        }
+
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED), targetVersion.MajorVersion != m_version.MajorVersion || targetVersion.MinorVersion < m_version.MinorVersion);
+
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_dbconn, "sqliteindex_migrateto");
+
+        target->MigrateFrom(m_dbconn, m_version);
+        targetVersion.SetSchemaVersion(m_dbconn);
+
+        savepoint.Commit();
+
+        // The manifests are unchanged, so the last write time is kept; a filter of the ids also remains valid.
+        target->SetDeferUnusedValueRemoval(m_deferUnusedValueRemoval);
+        SetInterface(std::move(target));
+        m_version = targetVersion;
+    }
+
     void SQLiteIndex::PrepareForPackaging()
     {
         AICLI_LOG(Repo, Info, << "Preparing index for packaging");
 
+        // Done regardless of whether any removal was deferred by this object, as it may have been by an earlier one;
+        // the tables that are built for packaging must not have values without manifests.
+        RemoveUnusedValues();
+
+        // The published index is read from within its package, where a write-ahead log cannot be created,
+        // so it always goes back to a rollback journal; this is done first so that the compaction is not logged.
+        m_dbconn.SetWriteAheadLog(false);
+
+        // Written first so that it is compacted with everything else.
+        std::set<std::string> ids;
+        for (const auto& manifest : m_interface->GetAllManifests(m_dbconn))
+        {
+            ids.emplace(Utility::FoldCase(manifest.first.Id));
+        }
+
+        Schema::MetadataTable::SetNamedValue(m_dbconn, Schema::s_MetadataValueName_IdFilter, CreateIdFilter(ids).Serialize());
+        Schema::MetadataTable::SetNamedValue(m_dbconn, Schema::s_MetadataValueName_IdFilterWriteTime,
+            Schema::MetadataTable::GetNamedValue<int64_t>(m_dbconn, Schema::s_MetadataValueName_LastWriteTime));
+
         m_interface->PrepareForPackaging(m_dbconn);
+
+        // Only once the file is compacted, as the compaction moves the pages
+        SetPrewarmPageRanges();
+    }
+
+    SQLiteIndex SQLiteIndex::CreateDelta(const std::string& filePath, SQLiteIndex& baseIndex, SQLiteIndex& targetIndex)
+    {
+        AICLI_LOG(Repo, Info, << "Creating index delta at '" << filePath << "'");
+
+        THROW_HR_IF(E_INVALIDARG, baseIndex.m_version != targetIndex.m_version);
+        THROW_HR_IF(E_INVALIDARG, baseIndex.IsDelta() || targetIndex.IsDelta());
+
+        auto baseManifests = baseIndex.m_interface->GetAllManifests(baseIndex.m_dbconn);
+        auto targetManifests = targetIndex.m_interface->GetAllManifests(targetIndex.m_dbconn);
+
+        std::map<ManifestKey, size_t> basePositions;
+        for (size_t i = 0; i < baseManifests.size(); ++i)
+        {
+            basePositions.emplace(GetManifestKey(baseManifests[i].first), i);
+        }
+
+        // Manifests that are new or changed in the target go into the delta; the changed ones are also recorded as updates.
+        std::vector<std::pair<Manifest::Manifest, std::filesystem::path>> deltaManifests;
+        std::vector<bool> baseInTarget(baseManifests.size());
+        std::vector<size_t> updatePositions;
+
+        for (auto& targetManifest : targetManifests)
+        {
+            auto itr = basePositions.find(GetManifestKey(targetManifest.first));
+
+            if (itr == basePositions.end())
+            {
+                deltaManifests.emplace_back(std::move(targetManifest));
+                continue;
+            }
+
+            baseInTarget[itr->second] = true;
+
+            if (!AreIndexValuesEqual(baseManifests[itr->second], targetManifest))
+            {
+                updatePositions.push_back(deltaManifests.size());
+                deltaManifests.emplace_back(std::move(targetManifest));
+            }
+        }
+
+        SQLiteIndex result = CreateNew(filePath, targetIndex.m_version);
+
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(result.m_dbconn, "sqliteindex_createdelta");
+
+        Schema::DeltaTable::Create(result.m_dbconn);
+
+        size_t removedCount = 0;
+        for (size_t i = 0; i < baseManifests.size(); ++i)
+        {
+            if (!baseInTarget[i])
+            {
+                const Manifest::Manifest& manifest = baseManifests[i].first;
+                Schema::DeltaTable::AddChange(result.m_dbconn, manifest.Id, manifest.Version, manifest.Channel, Schema::DeltaOperation::Remove);
+                ++removedCount;
+            }
+        }
+
+        for (size_t position : updatePositions)
+        {
+            const Manifest::Manifest& manifest = deltaManifests[position].first;
+            Schema::DeltaTable::AddChange(result.m_dbconn, manifest.Id, manifest.Version, manifest.Channel, Schema::DeltaOperation::Update);
+        }
+
+        if (!deltaManifests.empty())
+        {
+            result.m_interface->AddManifests(result.m_dbconn, deltaManifests);
+        }
+
+        Schema::MetadataTable::SetNamedValue(result.m_dbconn, Schema::s_MetadataValueName_DeltaBaseWriteTime,
+            Schema::MetadataTable::GetNamedValue<int64_t>(baseIndex.m_dbconn, Schema::s_MetadataValueName_LastWriteTime));
+        Schema::MetadataTable::SetNamedValue(result.m_dbconn, Schema::s_MetadataValueName_DeltaTargetWriteTime,
+            Schema::MetadataTable::GetNamedValue<int64_t>(targetIndex.m_dbconn, Schema::s_MetadataValueName_LastWriteTime));
+        CopyIdFilter(targetIndex.m_dbconn, result.m_dbconn);
+
+        savepoint.Commit();
+
+        AICLI_LOG(Repo, Info, << "Index delta has " << (deltaManifests.size() - updatePositions.size()) << " added, " << updatePositions.size() <<
+            " updated, and " << removedCount << " removed manifests");
+
+        return result;
+    }
+
+    SQLiteIndex SQLiteIndex::CreateHot(const std::string& filePath, SQLiteIndex& fullIndex, const std::vector<std::string>& ids)
+    {
+        AICLI_LOG(Repo, Info, << "Creating hot index of " << ids.size() << " ids at '" << filePath << "'");
+
+        THROW_HR_IF(E_INVALIDARG, fullIndex.IsDelta());
+
+        std::set<std::string> hotIds;
+        for (const auto& id : ids)
+        {
+            hotIds.emplace(Utility::FoldCase(id));
+        }
+
+        std::set<std::string> allIds;
+        std::vector<std::pair<Manifest::Manifest, std::filesystem::path>> hotManifests;
+
+        for (auto& manifest : fullIndex.m_interface->GetAllManifests(fullIndex.m_dbconn))
+        {
+            std::string id = Utility::FoldCase(manifest.first.Id);
+            if (hotIds.count(id) != 0)
+            {
+                hotManifests.emplace_back(std::move(manifest));
+            }
+            allIds.emplace(std::move(id));
+        }
+
+        SQLiteIndex result = CreateNew(filePath, fullIndex.m_version);
+
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(result.m_dbconn, "sqliteindex_createhot");
+
+        if (!hotManifests.empty())
+        {
+            result.m_interface->AddManifests(result.m_dbconn, hotManifests);
+        }
+
+        Schema::MetadataTable::SetNamedValue(result.m_dbconn, Schema::s_MetadataValueName_ColdIdFilter, CreateIdFilter(allIds).Serialize());
+        result.SetLastWriteTime();
+
+        savepoint.Commit();
+
+        AICLI_LOG(Repo, Info, << "Hot index has " << hotManifests.size() << " of the manifests of " << allIds.size() << " ids");
+
+        return result;
+    }
+
+    bool SQLiteIndex::IsDelta()
+    {
+        return Schema::DeltaTable::Exists(m_dbconn);
+    }
+
+    void SQLiteIndex::ApplyDelta(SQLiteIndex& delta)
+    {
+        AICLI_LOG(Repo, Info, << "Applying index delta");
+
+        THROW_HR_IF(E_INVALIDARG, !delta.IsDelta());
+        THROW_HR_IF(E_INVALIDARG, IsDelta());
+
+        int64_t baseWriteTime = Schema::MetadataTable::GetNamedValue<int64_t>(delta.m_dbconn, Schema::s_MetadataValueName_DeltaBaseWriteTime);
+        int64_t lastWriteTime = Schema::MetadataTable::GetNamedValue<int64_t>(m_dbconn, Schema::s_MetadataValueName_LastWriteTime);
+
+        if (delta.m_version != m_version || baseWriteTime != lastWriteTime)
+        {
+            AICLI_LOG(Repo, Error, << "Index delta is for version [" << delta.m_version << "], last write [" << Utility::ConvertUnixEpochToSystemClock(baseWriteTime) <<
+                "]; but index is version [" << m_version << "], last write [" << Utility::ConvertUnixEpochToSystemClock(lastWriteTime) << "]");
+            THROW_HR(APPINSTALLER_CLI_ERROR_INDEX_DELTA_MISMATCH);
+        }
+
+        std::vector<Schema::DeltaChange> changes = Schema::DeltaTable::GetChanges(delta.m_dbconn);
+        auto deltaManifests = delta.m_interface->GetAllManifests(delta.m_dbconn);
+
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_dbconn, "sqliteindex_applydelta");
+
+        // Removals go first, so that their paths are available to the manifests that replace them.
+        std::set<ManifestKey> updates;
+
+        for (const Schema::DeltaChange& change : changes)
+        {
+            Manifest::Manifest manifest;
+            manifest.Id = change.Id;
+            manifest.Version = change.Version;
+            manifest.Channel = change.Channel;
+
+            if (change.Operation == Schema::DeltaOperation::Remove)
+            {
+                m_interface->RemoveManifest(m_dbconn, manifest, {});
+            }
+            else
+            {
+                updates.emplace(GetManifestKey(manifest));
+            }
+        }
+
+        std::vector<std::pair<Manifest::Manifest, std::filesystem::path>> additions;
+
+        for (auto& deltaManifest : deltaManifests)
+        {
+            if (updates.count(GetManifestKey(deltaManifest.first)))
+            {
+                m_interface->UpdateManifest(m_dbconn, deltaManifest.first, deltaManifest.second);
+            }
+            else
+            {
+                additions.emplace_back(std::move(deltaManifest));
+            }
+        }
+
+        if (!additions.empty())
+        {
+            m_interface->AddManifests(m_dbconn, additions);
+        }
+
+        Schema::MetadataTable::SetNamedValue(m_dbconn, Schema::s_MetadataValueName_LastWriteTime,
+            Schema::MetadataTable::GetNamedValue<int64_t>(delta.m_dbconn, Schema::s_MetadataValueName_DeltaTargetWriteTime));
+        CopyIdFilter(delta.m_dbconn, m_dbconn);
+
+        savepoint.Commit();
+        m_dbconn.Checkpoint();
     }
 
     Schema::ISQLiteIndex::SearchResult SQLiteIndex::Search(const SearchRequest& request)
     {
         AICLI_LOG(Repo, Info, << "Performing search: " << request.ToString());
 
-        return m_interface->Search(m_dbconn, request);
+        Logging::ScopedPerformanceTimer timer{ Logging::PerformanceOperation::IndexSearch };
+
+        std::optional<SQLite::CancellationScope> cancellation;
+        if (request.Progress)
+        {
+            cancellation.emplace(m_dbconn, *request.Progress);
+        }
+
+        Schema::ISQLiteIndex::SearchResult result;
+        try
+        {
+            result = WithInterface([&](auto& index) { return index.Search(m_dbconn, request); });
+        }
+        catch (const SQLite::SQLiteException&)
+        {
+            // Report an interrupted search as cancelled rather than as a database error.
+            THROW_HR_IF(E_ABORT, request.Progress && request.Progress->IsCancelled());
+            throw;
+        }
+
+        const SQLite::StatementCache& statementCache = m_dbconn.GetStatementCache();
+        AICLI_LOG(Repo, Verbose, << "Statement cache totals after search: " << statementCache.GetHitCount() << " hits, " << statementCache.GetMissCount() << " misses");
+
+        return result;
+    }
+
+    Schema::ISQLiteIndex::SearchResult SQLiteIndex::SearchForIds(const std::vector<std::string>& ids)
+    {
+        AICLI_LOG(Repo, Info, << "Performing search for " << ids.size() << " ids");
+
+        Logging::ScopedPerformanceTimer timer{ Logging::PerformanceOperation::IndexSearch };
+        return WithInterface([&](auto& index) { return index.SearchForIds(m_dbconn, ids); });
+    }
+
+    void SQLiteIndex::LoadSearchSnapshot(std::string_view sharedName)
+    {
+        // The snapshot is never updated, so it is only valid when the index cannot change.
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), !m_isImmutable);
+
+        AICLI_LOG(Repo, Info, << "Loading search snapshot");
+        m_interface->LoadSearchSnapshot(m_dbconn, sharedName);
+    }
+
+    std::optional<BloomFilter> SQLiteIndex::GetIdFilter()
+    {
+        auto filter = Schema::MetadataTable::TryGetNamedValue<std::string>(m_dbconn, Schema::s_MetadataValueName_IdFilter);
+        auto writeTime = Schema::MetadataTable::TryGetNamedValue<int64_t>(m_dbconn, Schema::s_MetadataValueName_IdFilterWriteTime);
+
+        if (!filter || !writeTime)
+        {
+            return std::nullopt;
+        }
+
+        // A filter from before the last change to the index may be missing ids that are now in it.
+        if (writeTime.value() != Schema::MetadataTable::GetNamedValue<int64_t>(m_dbconn, Schema::s_MetadataValueName_LastWriteTime))
+        {
+            AICLI_LOG(Repo, Info, << "Id filter is out of date and will not be used");
+            return std::nullopt;
+        }
+
+        return DeserializeIdFilter(filter.value());
+    }
+
+    std::optional<BloomFilter> SQLiteIndex::GetColdIdFilter()
+    {
+        auto filter = Schema::MetadataTable::TryGetNamedValue<std::string>(m_dbconn, Schema::s_MetadataValueName_ColdIdFilter);
+        if (!filter)
+        {
+            return std::nullopt;
+        }
+
+        return DeserializeIdFilter(filter.value());
     }
 
     std::optional<std::string> SQLiteIndex::GetIdStringById(IdType id)
     {
-        return m_interface->GetIdStringById(m_dbconn, id);
+        return WithInterface([&](auto& index) { return index.GetIdStringById(m_dbconn, id); });
     }
 
     std::optional<std::string> SQLiteIndex::GetNameStringById(IdType id)
     {
-        return m_interface->GetNameStringById(m_dbconn, id);
+        return WithInterface([&](auto& index) { return index.GetNameStringById(m_dbconn, id); });
     }
 
     std::optional<std::string> SQLiteIndex::GetPathStringByKey(IdType id, std::string_view version, std::string_view channel)
     {
-        return m_interface->GetPathStringByKey(m_dbconn, id, version, channel);
+        return WithInterface([&](auto& index) { return index.GetPathStringByKey(m_dbconn, id, version, channel); });
+    }
+
+    std::vector<std::optional<std::string>> SQLiteIndex::GetPathStringsByKeys(IdType id, const std::vector<Utility::VersionAndChannel>& versions)
+    {
+        return WithInterface([&](auto& index) { return index.GetPathStringsByKeys(m_dbconn, id, versions); });
     }
 
     std::vector<Utility::VersionAndChannel> SQLiteIndex::GetVersionsById(IdType id)
     {
-        return m_interface->GetVersionsById(m_dbconn, id);
+        return WithInterface([&](auto& index) { return index.GetVersionsById(m_dbconn, id); });
+    }
+
+    std::vector<std::vector<Utility::VersionAndChannel>> SQLiteIndex::GetVersionsByIds(const std::vector<IdType>& ids, const VersionQuery& query)
+    {
+        return WithInterface([&](auto& index) { return index.GetVersionsByIds(m_dbconn, ids, query); });
+    }
+
+    std::vector<Schema::ISQLiteIndex::ApplicationSummary> SQLiteIndex::GetApplicationSummaries(const std::vector<IdType>& ids)
+    {
+        return WithInterface([&](auto& index) { return index.GetApplicationSummaries(m_dbconn, ids); });
+    }
+
+    std::vector<std::pair<Manifest::Manifest, std::filesystem::path>> SQLiteIndex::GetAllManifests()
+    {
+        return m_interface->GetAllManifests(m_dbconn);
+    }
+
+    std::vector<std::pair<std::string, size_t>> SQLiteIndex::GetFacetCounts(Schema::Facet facet)
+    {
+        return m_interface->GetFacetCounts(m_dbconn, facet);
+    }
+
+    std::vector<SQLiteIndex::IdType> SQLiteIndex::GetIdsByFacet(Schema::Facet facet, std::string_view value)
+    {
+        return m_interface->GetIdsByFacet(m_dbconn, facet, value);
+    }
+
+    SQLiteIndex::StorageStatistics SQLiteIndex::GetStorageStatistics()
+    {
+        StorageStatistics result;
+
+        auto getPragmaValue = [&](std::string_view pragma)
+        {
+            SQLite::Statement statement = SQLite::Statement::Create(m_dbconn, pragma);
+            THROW_HR_IF(E_UNEXPECTED, !statement.Step());
+            return statement.GetColumn<int64_t>(0);
+        };
+
+        result.PageSize = getPragmaValue("PRAGMA page_size");
+        result.PageCount = getPragmaValue("PRAGMA page_count");
+        result.FreePageCount = getPragmaValue("PRAGMA freelist_count");
+
+        std::optional<SQLite::Statement> select;
+
+        try
+        {
+            // The schema table itself has no row in sqlite_master, so it is joined to nothing and named as itself.
+            select = SQLite::Statement::Create(m_dbconn,
+                "SELECT s.name, coalesce(m.tbl_name, s.name), m.type, COUNT(*), SUM(s.pgsize) FROM dbstat AS s "
+                "LEFT OUTER JOIN sqlite_master AS m ON s.name = m.name GROUP BY s.name ORDER BY SUM(s.pgsize) DESC, s.name");
+            result.HasObjectPages = true;
+        }
+        catch (const wil::ResultException&)
+        {
+            AICLI_LOG(Repo, Info, << "The dbstat virtual table is not available; storage statistics will not include page counts for each object");
+            select = SQLite::Statement::Create(m_dbconn,
+                "SELECT name, tbl_name, type, 0, 0 FROM sqlite_master WHERE rootpage != 0 ORDER BY name");
+        }
+
+        while (select->Step())
+        {
+            StorageObject object;
+            object.Name = select->GetColumn<std::string>(0);
+            object.TableName = select->GetColumn<std::string>(1);
+            object.IsIndex = !select->GetColumnIsNull(2) && select->GetColumn<std::string>(2) == "index";
+            object.PageCount = select->GetColumn<int64_t>(3);
+            object.ByteCount = select->GetColumn<int64_t>(4);
+            result.Objects.emplace_back(std::move(object));
+        }
+
+        return result;
+    }
+
+    std::optional<std::vector<SQLiteIndex::PageRange>> SQLiteIndex::GetPrewarmPageRanges()
+    {
+        auto ranges = Schema::MetadataTable::TryGetNamedValue<std::string>(m_dbconn, Schema::s_MetadataValueName_PrewarmPages);
+        auto writeTime = Schema::MetadataTable::TryGetNamedValue<int64_t>(m_dbconn, Schema::s_MetadataValueName_PrewarmPagesWriteTime);
+
+        if (!ranges || !writeTime)
+        {
+            return std::nullopt;
+        }
+
+        // Any change to the index since may have moved the pages
+        if (writeTime.value() != Schema::MetadataTable::GetNamedValue<int64_t>(m_dbconn, Schema::s_MetadataValueName_LastWriteTime))
+        {
+            AICLI_LOG(Repo, Info, << "Prewarm pages are out of date and will not be used");
+            return std::nullopt;
+        }
+
+        try
+        {
+            return DeserializePageRanges(ranges.value());
+        }
+        catch (...)
+        {
+            AICLI_LOG(Repo, Warning, << "Prewarm pages could not be read and will not be used");
+            return std::nullopt;
+        }
+    }
+
+    void SQLiteIndex::Prewarm(const std::filesystem::path& filePath)
+    {
+        std::vector<PageRange> ranges;
+        int64_t pageSize = 0;
+        {
+            SQLiteIndex index = Open(filePath.u8string(), OpenDisposition::Immutable);
+            ranges = index.GetPrewarmPageRanges().value_or(std::vector<PageRange>{});
+
+            SQLite::Statement statement = SQLite::Statement::Create(index.m_dbconn, "PRAGMA page_size");
+            THROW_HR_IF(E_UNEXPECTED, !statement.Step());
+            pageSize = statement.GetColumn<int64_t>(0);
+        }
+
+        wil::unique_hfile file{ CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        THROW_LAST_ERROR_IF_MSG(!file, "failed opening index to prewarm");
+
+        LARGE_INTEGER fileSize{};
+        THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &fileSize));
+        uint64_t size = static_cast<uint64_t>(fileSize.QuadPart);
+
+        // An empty file cannot be mapped, and has nothing to read either
+        if (size == 0)
+        {
+            return;
+        }
+
+        wil::unique_handle mapping{ CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr) };
+        THROW_LAST_ERROR_IF_NULL_MSG(mapping, "failed creating file mapping of index to prewarm");
+
+        wil::unique_mapview_ptr<uint8_t> view{ static_cast<uint8_t*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0)) };
+        THROW_LAST_ERROR_IF_NULL_MSG(view, "failed mapping view of index to prewarm");
+
+        std::vector<WIN32_MEMORY_RANGE_ENTRY> entries;
+        uint64_t prefetchSize = 0;
+
+        if (ranges.empty())
+        {
+            entries.push_back({ view.get(), static_cast<SIZE_T>(size) });
+            prefetchSize = size;
+        }
+        else
+        {
+            for (const auto& range : ranges)
+            {
+                // The pages are a hint, so any that are not in the file are left out rather than failing
+                uint64_t offset = static_cast<uint64_t>(range.First - 1) * static_cast<uint64_t>(pageSize);
+                if (range.First < 1 || range.Count < 1 || offset >= size)
+                {
+                    continue;
+                }
+
+                uint64_t length = std::min(static_cast<uint64_t>(range.Count) * static_cast<uint64_t>(pageSize), size - offset);
+                entries.push_back({ view.get() + offset, static_cast<SIZE_T>(length) });
+                prefetchSize += length;
+            }
+        }
+
+        // The prefetched pages stay in the file cache once the view is unmapped, for the connections that read the index next
+        THROW_IF_WIN32_BOOL_FALSE(PrefetchVirtualMemory(GetCurrentProcess(), entries.size(), entries.data(), 0));
+
+        AICLI_LOG(Repo, Info, << "Prewarmed " << prefetchSize << " of " << size << " bytes in " << entries.size() << " ranges of index at '" << filePath.u8string() << "'");
+    }
+
+    void SQLiteIndex::SetPrewarmPageRanges()
+    {
+        // The paths of manifests are only read once a manifest is fetched, so they are left out.
+        // The schema table has no row in sqlite_master, so it is joined to nothing and kept by its own name.
+        std::optional<SQLite::Statement> select;
+        try
+        {
+            select = SQLite::Statement::Create(m_dbconn,
+                "SELECT s.pageno FROM dbstat AS s LEFT OUTER JOIN sqlite_master AS m ON s.name = m.name "
+                "WHERE coalesce(m.tbl_name, s.name) NOT IN ('pathparts', 'manifest_paths') ORDER BY s.pageno");
+        }
+        catch (const wil::ResultException&)
+        {
+            AICLI_LOG(Repo, Info, << "The dbstat virtual table is not available; prewarming will read the whole index");
+            return;
+        }
+
+        std::vector<PageRange> ranges;
+        while (select->Step())
+        {
+            int64_t page = select->GetColumn<int64_t>(0);
+            if (!ranges.empty() && ranges.back().First + ranges.back().Count == page)
+            {
+                ++ranges.back().Count;
+            }
+            else
+            {
+                ranges.push_back({ page, 1 });
+            }
+        }
+
+        Schema::MetadataTable::SetNamedValue(m_dbconn, Schema::s_MetadataValueName_PrewarmPages, SerializePageRanges(ranges));
+        Schema::MetadataTable::SetNamedValue(m_dbconn, Schema::s_MetadataValueName_PrewarmPagesWriteTime,
+            Schema::MetadataTable::GetNamedValue<int64_t>(m_dbconn, Schema::s_MetadataValueName_LastWriteTime));
     }
 
     // Recording last write time based on MSDN documentation stating that time returns a POSIX epoch time and thus
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 #pragma once
 #include "SQLiteWrapper.h"
+#include "Microsoft/BloomFilter.h"
 #include "Microsoft/Schema/ISQLiteIndex.h"
 #include "Microsoft/Schema/Version.h"
 #include "Public/AppInstallerRepositorySearch.h"
@@ -11,12 +12,19 @@
 
 #include <chrono>
 #include <filesystem>
+#include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    struct Interface;
+}
+
 namespace AppInstaller::Repository::Microsoft
 {
     // Holds the connection to the database, as well as the appropriate functionality to interface with it.
@@ -31,9 +39,6 @@ namespace AppInstaller::Repository::Microsoft
         SQLiteIndex(SQLiteIndex&&) = default;
         SQLiteIndex& operator=(SQLiteIndex&&) = default;
 
-        // Creates a new index database of the given version.
-        static SQLiteIndex CreateNew(const std::string& filePath, Schema::Version version);
-
         // The disposition for opening the index.
         enum class OpenDisposition
         {
@@ -41,13 +46,27 @@ namespace AppInstaller::Repository::Microsoft
             Read,
             // Open for read and write.
             ReadWrite,
-            // The database will not change while in use; open for immutable read.
+            // Open for read and write with a write-ahead log, so that indexes opened for Read keep searching a consistent
+            // snapshot while changes are written, rather than waiting for each batch of them to commit. The index keeps
+            // the log until it is prepared for packaging, so it must be in a location where readers can write the log.
+            ReadWriteWithLog,
+            // The database will not change while in use; open for immutable read with the file memory mapped.
             Immutable,
         };
 
+        // Creates a new index database of the given version, open for ReadWrite unless ReadWriteWithLog is given.
+        static SQLiteIndex CreateNew(const std::string& filePath, Schema::Version version, OpenDisposition disposition = OpenDisposition::ReadWrite);
+
         // Opens an existing index database.
         static SQLiteIndex Open(const std::string& filePath, OpenDisposition disposition);
 
+        // Determines if OpenReader can be used; it cannot for an index that is only in memory.
+        bool CanOpenReader() const;
+
+        // Opens another connection to the same index for reading only, so that it can be read on another thread at the same time.
+        // An index opened with OpenDisposition::Immutable gives a reader that is also immutable; the search snapshot is not shared.
+        SQLiteIndex OpenReader() const;
+
         // Gets the schema version of the index.
         Schema::Version GetVersion() const { return m_version; }
 
@@ -62,6 +81,19 @@ namespace AppInstaller::Repository::Microsoft
         // If the function succeeds, the manifest has been added.
         void AddManifest(const Manifest::Manifest& manifest, const std::filesystem::path& relativePath);
 
+        // Adds the manifests at the paths, each paired with its repository relative path, to the index.
+        // All of the manifests are added in a single transaction; if the function fails, none have been added.
+        // The files are parsed in parallel, and written to the index in batches as they are parsed.
+        void AddManifests(const std::vector<std::pair<std::filesystem::path, std::filesystem::path>>& manifestPaths);
+
+        // Adds every manifest (*.yaml) under the root directory to the index, with its path relative to the root.
+        // All of the manifests are added in a single transaction; if the function fails, none have been added.
+        void AddManifestsFromDirectory(const std::filesystem::path& rootDirectory);
+
+        // Adds the manifests, each paired with its repository relative path, to the index.
+        // All of the manifests are added in a single transaction; if the function fails, none have been added.
+        void AddManifests(const std::vector<std::pair<Manifest::Manifest, std::filesystem::path>>& manifests);
+
         // Updates the manifest with matching { Id, Version, Channel } in the index.
         // The return value indicates whether the index was modified by the function.
         bool UpdateManifest(const std::filesystem::path& manifestPath, const std::filesystem::path& relativePath);
@@ -78,12 +110,85 @@ namespace AppInstaller::Repository::Microsoft
         // Path is currently ignored.
         void RemoveManifest(const Manifest::Manifest& manifest, const std::filesystem::path& relativePath);
 
+        // A change to make to the index for a single manifest.
+        struct ManifestChange
+        {
+            enum class Operation
+            {
+                Add,
+                Update,
+                Remove,
+            };
+
+            Operation ChangeOperation = Operation::Add;
+            // The manifest file; ignored when the content is given.
+            std::filesystem::path ManifestPath;
+            // The YAML content of the manifest.
+            std::optional<std::string> ManifestContent;
+            std::filesystem::path RelativePath;
+        };
+
+        // Called with the result of each change, in the order of the changes, and whether it modified the index.
+        using ManifestChangeCallback = std::function<void(size_t index, HRESULT result, bool indexModified)>;
+
+        // Applies the changes to the index in a single transaction, while the manifests are parsed in parallel.
+        // A change that fails does not stop the others; its error is given to the callback and it has no effect.
+        // Returns whether the index was modified by any of the changes.
+        bool ApplyManifestChanges(const std::vector<ManifestChange>& changes, const ManifestChangeCallback& callback);
+
+        // Sets whether updating and removing manifests leaves the values that they no longer reference in the index,
+        // rather than checking each value for other references as it is unreferenced. The values are then removed all at once
+        // by RemoveUnusedValues, at the end of ApplyManifestChanges, or by PrepareForPackaging.
+        void SetDeferUnusedValueRemoval(bool value);
+
+        // Removes every value that is not referenced by a manifest, with a single statement per table.
+        void RemoveUnusedValues();
+
         // Removes data that is no longer needed for an index that is to be published.
+        // Also writes a filter of the ids in the index, which GetIdFilter reads, and the pages that searches read,
+        // which GetPrewarmPageRanges reads.
         void PrepareForPackaging();
 
+        // Upgrades the index, in place and in a single transaction, to the given later schema version of the same major version.
+        // The existing values are transformed with set based statements rather than by reading the manifests again;
+        // the tables that are built for packaging are left empty, to be built by PrepareForPackaging.
+        void MigrateTo(Schema::Version version);
+
+        // Creates a new delta at the given path, holding the changes that turn the base index into the target index.
+        // The indexes must be of the same schema version, and neither can be a delta.
+        static SQLiteIndex CreateDelta(const std::string& filePath, SQLiteIndex& baseIndex, SQLiteIndex& targetIndex);
+
+        // Determines if the index is a delta created by CreateDelta.
+        bool IsDelta();
+
+        // Applies the changes in the delta to this index, which must be the base index that the delta was created from.
+        // All of the changes are applied in a single transaction; afterward, the last write time is that of the target index.
+        void ApplyDelta(SQLiteIndex& delta);
+
+        // Creates a new hot index at the given path, holding every version of the given ids from the full index, so that
+        // a source can search its most used packages before the full index is downloaded. The hot index also holds a filter
+        // of all of the ids in the full index, which GetColdIdFilter reads. It is prepared for packaging like any other index.
+        static SQLiteIndex CreateHot(const std::string& filePath, SQLiteIndex& fullIndex, const std::vector<std::string>& ids);
+
+        // Gets the filter of the case folded ids in the full index that this hot index was created from; empty if it is not a hot index.
+        std::optional<BloomFilter> GetColdIdFilter();
+
         // Performs a search based on the given criteria.
         Schema::ISQLiteIndex::SearchResult Search(const SearchRequest& request);
 
+        // Finds the given ids exactly, in one pass over the index rather than a search for each.
+        Schema::ISQLiteIndex::SearchResult SearchForIds(const std::vector<std::string>& ids);
+
+        // Loads the searchable values into memory, so that all future searches are performed without the database.
+        // Only valid when the index was opened with OpenDisposition::Immutable.
+        // If the shared name is not empty, the memory is shared with every process that loads the same index under that name,
+        // so it must change whenever the contents of the index do.
+        void LoadSearchSnapshot(std::string_view sharedName = {});
+
+        // Gets the filter of the case folded ids in the index, if it has one that is up to date.
+        // It is written when the index is prepared for packaging, and carried by a delta to the index that it is applied to.
+        std::optional<BloomFilter> GetIdFilter();
+
         // Gets the Id string for the given id, if present.
         std::optional<std::string> GetIdStringById(IdType id);
 
@@ -94,21 +199,105 @@ namespace AppInstaller::Repository::Microsoft
         // If version is empty, gets the value for the 'latest' version.
         std::optional<std::string> GetPathStringByKey(IdType id, std::string_view version, std::string_view channel);
 
+        // Gets the relative path string for each of the given { version, channel } of the id, in the same order.
+        // Each is found as GetPathStringByKey would find it, and is empty if not present.
+        std::vector<std::optional<std::string>> GetPathStringsByKeys(IdType id, const std::vector<Utility::VersionAndChannel>& versions);
+
         // Gets all versions and channels for the given id.
         std::vector<Utility::VersionAndChannel> GetVersionsById(IdType id);
 
+        // Gets the versions and channels of each of the given ids that the query includes, in the same order as the ids.
+        std::vector<std::vector<Utility::VersionAndChannel>> GetVersionsByIds(const std::vector<IdType>& ids, const VersionQuery& query);
+
+        // Gets the id, name, and versions for each of the given ids, using a single query for all of them.
+        std::vector<Schema::ISQLiteIndex::ApplicationSummary> GetApplicationSummaries(const std::vector<IdType>& ids);
+
+        // Gets the searchable values of every manifest in the index, each paired with its relative path.
+        std::vector<std::pair<Manifest::Manifest, std::filesystem::path>> GetAllManifests();
+
+        // Gets every value of the facet, in sorted order, along with the number of ids that have it.
+        std::vector<std::pair<std::string, size_t>> GetFacetCounts(Schema::Facet facet);
+
+        // Gets the ids that have the given value of the facet.
+        std::vector<IdType> GetIdsByFacet(Schema::Facet facet, std::string_view value);
+
+        // The storage used by a single table or index.
+        struct StorageObject
+        {
+            std::string Name;
+            // The table of an index, or the name of a table.
+            std::string TableName;
+            bool IsIndex = false;
+            // Only set when the SQLite build has the dbstat virtual table.
+            int64_t PageCount = 0;
+            int64_t ByteCount = 0;
+        };
+
+        // The storage used by the index file, and by each of its tables and indexes.
+        struct StorageStatistics
+        {
+            int64_t PageSize = 0;
+            int64_t PageCount = 0;
+            int64_t FreePageCount = 0;
+            // False if the SQLite build does not have the dbstat virtual table; the objects then have no page counts.
+            bool HasObjectPages = false;
+            // The objects using the most bytes come first.
+            std::vector<StorageObject> Objects;
+        };
+
+        // Gets the storage used by the index, to find which tables and indexes dominate its size.
+        StorageStatistics GetStorageStatistics();
+
+        // A run of pages of the index file; the first page of the file is page 1.
+        struct PageRange
+        {
+            int64_t First = 0;
+            int64_t Count = 0;
+        };
+
+        // Gets the pages of the tables and indexes that searches read, as recorded when the index was prepared for packaging.
+        // Returns an empty value if they were not recorded, which needs a SQLite build with the dbstat virtual table,
+        // or if the index has changed since.
+        std::optional<std::vector<PageRange>> GetPrewarmPageRanges();
+
+        // Reads the pages that searches use of the index at the path into the file cache of the system, so that the first
+        // search of a newly deployed index does not wait on a read for each page that it touches. The file is mapped and
+        // the pages are prefetched in large reads; the whole file is prefetched if the index has no recorded pages.
+        static void Prewarm(const std::filesystem::path& filePath);
+
     private:
         // Constructor used to open an existing index.
         SQLiteIndex(const std::string& target, SQLite::Connection::OpenDisposition disposition, SQLite::Connection::OpenFlags flags);
 
         // Constructor used to create a new index.
-        SQLiteIndex(const std::string& target, Schema::Version version);
+        SQLiteIndex(const std::string& target, Schema::Version version, SQLite::Connection::OpenFlags flags);
 
         // Sets the last write time metadata value in the index.
         void SetLastWriteTime();
 
+        // Records the pages of the tables and indexes that searches read, for GetPrewarmPageRanges.
+        void SetPrewarmPageRanges();
+
+        // Sets the interface to the schema version of the index.
+        void SetInterface(std::unique_ptr<Schema::ISQLiteIndex>&& value);
+
+        // Calls the operation with the interface to the schema version of the index. The operation is instantiated for
+        // the latest version, which is called directly, and for the interface, which is called through virtual dispatch
+        // for the earlier versions; the one to call is chosen when the index is opened.
+        template <typename Operation>
+        decltype(auto) WithInterface(Operation&& operation);
+
+        // The target and flags that the connection was opened with, to open readers with.
+        std::string m_target;
+        SQLite::Connection::OpenFlags m_flags = SQLite::Connection::OpenFlags::None;
         SQLite::Connection m_dbconn;
         Schema::Version m_version;
         std::unique_ptr<Schema::ISQLiteIndex> m_interface;
+        // Set to m_interface when it is the latest version.
+        Schema::V1_2::Interface* m_latestInterface = nullptr;
+        bool m_isImmutable = false;
+        // Set when a manifest has been updated or removed while the removal of unused values is deferred.
+        bool m_unusedValuesPending = false;
+        bool m_deferUnusedValueRemoval = false;
     };
 }
@@ -0,0 +1,175 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/SQLiteIndexProfile.h"
+
+#include <json.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Gets the nearest rank percentile of the sorted latencies.
+        std::chrono::microseconds GetPercentile(const std::vector<std::chrono::microseconds>& sorted, size_t percentile)
+        {
+            if (sorted.empty())
+            {
+                return {};
+            }
+
+            size_t rank = (sorted.size() * percentile + 99) / 100;
+            return sorted[std::max<size_t>(rank, 1) - 1];
+        }
+
+        Json::Value::Int64 ToJson(std::chrono::microseconds value)
+        {
+            return static_cast<Json::Value::Int64>(value.count());
+        }
+    }
+
+    const std::vector<MatchType>& GetProfiledMatchTypes()
+    {
+        // Wildcard is left out, as the queries of a corpus are not patterns.
+        static const std::vector<MatchType> s_matchTypes
+        {
+            MatchType::Exact,
+            MatchType::CaseInsensitive,
+            MatchType::StartsWith,
+            MatchType::Substring,
+            MatchType::Fuzzy,
+            MatchType::FuzzySubstring,
+        };
+
+        return s_matchTypes;
+    }
+
+    std::vector<std::string> ReadSearchCorpus(const std::filesystem::path& path)
+    {
+        std::ifstream stream{ path };
+        THROW_LAST_ERROR_IF(!stream);
+
+        std::vector<std::string> result;
+        std::string line;
+
+        while (std::getline(stream, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+
+            if (!line.empty())
+            {
+                result.emplace_back(std::move(line));
+            }
+        }
+
+        return result;
+    }
+
+    IndexProfile ProfileIndex(SQLiteIndex& index, const std::vector<std::string>& searchCorpus, size_t iterations)
+    {
+        IndexProfile result;
+        result.Version = index.GetVersion();
+        result.Storage = index.GetStorageStatistics();
+
+        if (searchCorpus.empty() || iterations == 0)
+        {
+            return result;
+        }
+
+        std::vector<std::chrono::microseconds> latencies;
+        latencies.reserve(searchCorpus.size() * iterations);
+
+        for (MatchType matchType : GetProfiledMatchTypes())
+        {
+            SearchLatencyProfile profile;
+            profile.Type = matchType;
+            latencies.clear();
+
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                for (const auto& query : searchCorpus)
+                {
+                    SearchRequest request;
+                    request.Query = RequestMatch{ matchType, query };
+
+                    auto start = Clock::now();
+                    auto searchResult = index.Search(request);
+                    latencies.emplace_back(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start));
+
+                    profile.MatchCount += searchResult.Matches.size();
+                }
+            }
+
+            std::sort(latencies.begin(), latencies.end());
+            profile.SearchCount = latencies.size();
+            profile.P50 = GetPercentile(latencies, 50);
+            profile.P90 = GetPercentile(latencies, 90);
+            profile.P99 = GetPercentile(latencies, 99);
+            profile.Max = latencies.back();
+
+            AICLI_LOG(Repo, Info, << "Profiled " << profile.SearchCount << " searches of type " << MatchTypeToString(matchType) <<
+                ": P50 " << profile.P50.count() << "us, P90 " << profile.P90.count() << "us, P99 " << profile.P99.count() << "us");
+
+            result.Searches.emplace_back(std::move(profile));
+        }
+
+        return result;
+    }
+
+    std::string ConvertToJson(const IndexProfile& profile)
+    {
+        Json::Value root{ Json::objectValue };
+
+        std::ostringstream version;
+        version << profile.Version;
+        root["Version"] = version.str();
+
+        Json::Value storage{ Json::objectValue };
+        storage["PageSize"] = static_cast<Json::Value::Int64>(profile.Storage.PageSize);
+        storage["PageCount"] = static_cast<Json::Value::Int64>(profile.Storage.PageCount);
+        storage["FreePageCount"] = static_cast<Json::Value::Int64>(profile.Storage.FreePageCount);
+        storage["HasObjectPages"] = profile.Storage.HasObjectPages;
+
+        Json::Value objects{ Json::arrayValue };
+        for (const auto& object : profile.Storage.Objects)
+        {
+            Json::Value objectValue{ Json::objectValue };
+            objectValue["Name"] = object.Name;
+            objectValue["Table"] = object.TableName;
+            objectValue["Type"] = (object.IsIndex ? "Index" : "Table");
+            objectValue["PageCount"] = static_cast<Json::Value::Int64>(object.PageCount);
+            objectValue["ByteCount"] = static_cast<Json::Value::Int64>(object.ByteCount);
+            objects.append(std::move(objectValue));
+        }
+        storage["Objects"] = std::move(objects);
+        root["Storage"] = std::move(storage);
+
+        Json::Value searches{ Json::arrayValue };
+        for (const auto& search : profile.Searches)
+        {
+            Json::Value searchValue{ Json::objectValue };
+            searchValue["MatchType"] = std::string{ MatchTypeToString(search.Type) };
+            searchValue["SearchCount"] = static_cast<Json::UInt64>(search.SearchCount);
+            searchValue["MatchCount"] = static_cast<Json::UInt64>(search.MatchCount);
+            searchValue["P50"] = ToJson(search.P50);
+            searchValue["P90"] = ToJson(search.P90);
+            searchValue["P99"] = ToJson(search.P99);
+            searchValue["Max"] = ToJson(search.Max);
+            searches.append(std::move(searchValue));
+        }
+        root["Searches"] = std::move(searches);
+
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "  ";
+        return Json::writeString(builder, root);
+    }
+}
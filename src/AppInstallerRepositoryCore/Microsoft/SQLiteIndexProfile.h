@@ -0,0 +1,49 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Microsoft/SQLiteIndex.h"
+#include <AppInstallerRepositorySearch.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // The latencies of the searches replayed for a single match type.
+    struct SearchLatencyProfile
+    {
+        MatchType Type = MatchType::Exact;
+        size_t SearchCount = 0;
+        // The total number of matches found by the searches.
+        size_t MatchCount = 0;
+        std::chrono::microseconds P50{};
+        std::chrono::microseconds P90{};
+        std::chrono::microseconds P99{};
+        std::chrono::microseconds Max{};
+    };
+
+    // The size of an index and the latencies of searches against it, to measure the effect of schema and packaging changes.
+    struct IndexProfile
+    {
+        Schema::Version Version;
+        SQLiteIndex::StorageStatistics Storage;
+        // In the order of the match types replayed; empty if no searches were replayed.
+        std::vector<SearchLatencyProfile> Searches;
+    };
+
+    // The match types that each query of a search corpus is replayed with.
+    const std::vector<MatchType>& GetProfiledMatchTypes();
+
+    // Reads a search corpus from the file, one query per line; empty lines are skipped.
+    std::vector<std::string> ReadSearchCorpus(const std::filesystem::path& path);
+
+    // Gets the storage statistics of the index, and replays each query of the corpus as the query of a search request
+    // with each of the profiled match types, the given number of times.
+    IndexProfile ProfileIndex(SQLiteIndex& index, const std::vector<std::string>& searchCorpus, size_t iterations = 1);
+
+    // Converts the profile to a JSON object, with latencies in microseconds.
+    std::string ConvertToJson(const IndexProfile& profile);
+}
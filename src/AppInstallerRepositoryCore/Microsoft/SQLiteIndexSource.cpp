@@ -2,9 +2,13 @@
 // Licensed under the MIT License.
 #include "pch.h"
 #include "Microsoft/SQLiteIndexSource.h"
+#include "Microsoft/CompactSearchResult.h"
 #include "Microsoft/PreIndexedPackageSourceFactory.h"
 #include <winget/ManifestYamlParser.h>
 
+#include <atomic>
+#include <limits>
+
 
 namespace AppInstaller::Repository::Microsoft
 {
@@ -12,23 +16,104 @@ namespace AppInstaller::Repository::Microsoft
 
     namespace
     {
+        // The most manifests that are fetched at once; they are small, so each fetch is mostly spent waiting on its download.
+        constexpr size_t s_ManifestFetchThreadCount = 8;
+
+        // The summaries for all of the applications from a single search.
+        // They are retrieved in batches of consecutive results, rather than with separate queries for each application.
+        // Results are usually read in order, so the first ones can be output without waiting for the summaries of all of them.
+        struct SearchResultSummaries
+        {
+            // The number of summaries retrieved by a query; more than a table reads before it starts to output lines.
+            static constexpr size_t BatchSize = 64;
+
+            // Summaries that the search already produced are used as they are.
+            SearchResultSummaries(std::vector<SQLiteIndex::IdType>&& ids, std::vector<Schema::ISQLiteIndex::ApplicationSummary>&& summaries) :
+                m_ids(std::move(ids)), m_batchLoaded((m_ids.size() + BatchSize - 1) / BatchSize)
+            {
+                for (size_t i = 0; i < m_ids.size(); ++i)
+                {
+                    m_positions.emplace(m_ids[i], i);
+                }
+
+                for (auto& summary : summaries)
+                {
+                    SQLiteIndex::IdType summaryId = summary.Id;
+                    m_summaries.emplace(summaryId, std::move(summary));
+                }
+            }
+
+            // Gets the summary for the id; returns null if it was not found.
+            const Schema::ISQLiteIndex::ApplicationSummary* Get(SQLiteIndex& index, SQLiteIndex::IdType id)
+            {
+                auto itr = m_summaries.find(id);
+                if (itr == m_summaries.end())
+                {
+                    auto position = m_positions.find(id);
+                    if (position == m_positions.end())
+                    {
+                        return nullptr;
+                    }
+
+                    size_t batch = position->second / BatchSize;
+                    if (m_batchLoaded[batch])
+                    {
+                        return nullptr;
+                    }
+
+                    LoadBatch(index, batch);
+                    itr = m_summaries.find(id);
+                }
+
+                return (itr == m_summaries.end() ? nullptr : &itr->second);
+            }
+
+            // Gets the summary for the id if it is already loaded, without loading its batch.
+            const Schema::ISQLiteIndex::ApplicationSummary* Peek(SQLiteIndex::IdType id) const
+            {
+                auto itr = m_summaries.find(id);
+                return (itr == m_summaries.end() ? nullptr : &itr->second);
+            }
+
+        private:
+            void LoadBatch(SQLiteIndex& index, size_t batch)
+            {
+                std::vector<SQLiteIndex::IdType> batchIds{
+                    m_ids.begin() + batch * BatchSize,
+                    m_ids.begin() + std::min((batch + 1) * BatchSize, m_ids.size()) };
+
+                for (auto& summary : index.GetApplicationSummaries(batchIds))
+                {
+                    SQLiteIndex::IdType summaryId = summary.Id;
+                    m_summaries.emplace(summaryId, std::move(summary));
+                }
+
+                m_batchLoaded[batch] = true;
+            }
+
+            std::vector<SQLiteIndex::IdType> m_ids;
+            std::unordered_map<SQLiteIndex::IdType, size_t> m_positions;
+            std::vector<bool> m_batchLoaded;
+            std::unordered_map<SQLiteIndex::IdType, Schema::ISQLiteIndex::ApplicationSummary> m_summaries;
+        };
+
         // The IApplication impl for SQLiteIndexSource.
         struct Application : public IApplication
         {
-            Application(std::shared_ptr<SQLiteIndexSource>& source, SQLiteIndex::IdType id) :
-                m_id(id), m_source(source) {}
+            Application(std::shared_ptr<SQLiteIndexSource>& source, SQLiteIndex::IdType id, std::shared_ptr<SearchResultSummaries> summaries) :
+                m_id(id), m_source(source), m_summaries(std::move(summaries)) {}
 
             // Inherited via IApplication
             LocIndString GetId() override
             {
                 // Values coming from the index will always be localized/independent.
-                return LocIndString{ GetSource()->GetIndex().GetIdStringById(m_id).value() };
+                return LocIndString{ GetSummary().IdString };
             }
 
             LocIndString GetName() override
             {
                 // Values coming from the index will always be localized/independent.
-                return LocIndString{ GetSource()->GetIndex().GetNameStringById(m_id).value() };
+                return LocIndString{ GetSummary().Name };
             }
 
             std::optional<Manifest::Manifest> GetManifest(const Utility::NormalizedString& version, const Utility::NormalizedString& channel) override
@@ -39,38 +124,59 @@ namespace AppInstaller::Repository::Microsoft
                 {
                     return {};
                 }
-                std::string relativePath = relativePathOpt.value();
+                return source->GetManifestByRelativePath(relativePathOpt.value());
+            }
+
+            std::vector<Utility::VersionAndChannel> GetVersions() override
+            {
+                return GetSummary().Versions;
+            }
 
-                std::string fullPath = source->GetDetails().Arg;
-                if (fullPath.back() != '/')
+            std::vector<Utility::VersionAndChannel> GetVersions(const VersionQuery& query) override
+            {
+                // A summary that is loaded already has every version; otherwise only those in the query are read
+                const Schema::ISQLiteIndex::ApplicationSummary* summary = m_summaries->Peek(m_id);
+                if (summary)
                 {
-                    fullPath += '/';
+                    return query.Apply(summary->Versions);
                 }
-                fullPath += relativePath;
 
-                if (Utility::IsUrlRemote(fullPath))
+                return std::move(GetSource()->GetIndex().GetVersionsByIds({ m_id }, query).at(0));
+            }
+
+            std::vector<std::optional<Manifest::Manifest>> GetManifests(const std::vector<Utility::VersionAndChannel>& versions) override
+            {
+                std::shared_ptr<SQLiteIndexSource> source = GetSource();
+                std::vector<std::optional<std::string>> relativePaths = source->GetIndex().GetPathStringsByKeys(m_id, versions);
+
+                std::vector<std::string> foundPaths;
+                for (const auto& relativePath : relativePaths)
                 {
-                    std::ostringstream manifestStream;
+                    if (relativePath)
+                    {
+                        foundPaths.emplace_back(relativePath.value());
+                    }
+                }
 
-                    AICLI_LOG(Repo, Info, << "Downloading manifest");
-                    ProgressCallback emptyCallback;
-                    (void)Utility::DownloadToStream(fullPath, manifestStream, emptyCallback);
+                std::vector<Manifest::Manifest> manifests = source->GetManifestsByRelativePaths(foundPaths);
 
-                    std::string manifestContents = manifestStream.str();
-                    AICLI_LOG(Repo, Verbose, << "Manifest contents: " << manifestContents);
+                std::vector<std::optional<Manifest::Manifest>> result;
+                result.reserve(relativePaths.size());
 
-                    return Manifest::YamlParser::Create(manifestContents);
-                }
-                else
+                size_t nextManifest = 0;
+                for (const auto& relativePath : relativePaths)
                 {
-                    AICLI_LOG(Repo, Info, << "Opening manifest from local file: " << fullPath);
-                    return Manifest::YamlParser::CreateFromPath(fullPath);
+                    if (relativePath)
+                    {
+                        result.emplace_back(std::move(manifests[nextManifest++]));
+                    }
+                    else
+                    {
+                        result.emplace_back();
+                    }
                 }
-            }
 
-            std::vector<Utility::VersionAndChannel> GetVersions() override
-            {
-                return GetSource()->GetIndex().GetVersionsById(m_id);
+                return result;
             }
 
         private:
@@ -81,14 +187,58 @@ namespace AppInstaller::Repository::Microsoft
                 return source;
             }
 
+            const Schema::ISQLiteIndex::ApplicationSummary& GetSummary()
+            {
+                const Schema::ISQLiteIndex::ApplicationSummary* summary = m_summaries->Get(GetSource()->GetIndex(), m_id);
+                THROW_HR_IF(E_NOT_SET, !summary);
+                return *summary;
+            }
+
             std::weak_ptr<SQLiteIndexSource> m_source;
             SQLiteIndex::IdType m_id;
+            std::shared_ptr<SearchResultSummaries> m_summaries;
+        };
+
+        // A cursor over the results of an index search, which creates the applications as they are read.
+        // The results are held by column until they are read; the index gives them best match first, so the scores
+        // are only checked for being in order.
+        struct SearchCursor : public ISearchCursor
+        {
+            SearchCursor(std::shared_ptr<SQLiteIndexSource> source, const SearchRequest& request, Schema::ISQLiteIndex::SearchResult&& indexResults) :
+                m_source(std::move(source)), m_results(std::move(indexResults.Matches), indexResults.Truncated)
+            {
+                m_results.ScoreAndSort(request);
+                m_summaries = std::make_shared<SearchResultSummaries>(std::vector<SQLiteIndex::IdType>{ m_results.GetIds() }, std::move(indexResults.Summaries));
+            }
+
+            std::vector<ResultMatch> Next(size_t count) override
+            {
+                size_t end = m_position + std::min(count, m_results.Size() - m_position);
+
+                std::vector<ResultMatch> result;
+                result.reserve(end - m_position);
+                for (; m_position < end; ++m_position)
+                {
+                    result.emplace_back(std::make_unique<Application>(m_source, m_results.GetId(m_position), m_summaries), m_results.GetCriteria(m_position), m_results.GetScore(m_position));
+                }
+
+                return result;
+            }
+
+            bool IsTruncated() const override { return m_results.IsTruncated(); }
+
+        private:
+            std::shared_ptr<SQLiteIndexSource> m_source;
+            CompactSearchResult m_results;
+            std::shared_ptr<SearchResultSummaries> m_summaries;
+            size_t m_position = 0;
         };
     }
 
     SQLiteIndexSource::SQLiteIndexSource(const SourceDetails& details, SQLiteIndex&& index, Synchronization::CrossProcessReaderWriteLock&& lock) :
-        m_details(details), m_lock(std::move(lock)), m_index(std::move(index))
+        m_details(details), m_lock(std::move(lock)), m_index(std::move(index)), m_indexThread(std::this_thread::get_id())
     {
+        m_idFilter = m_index.GetIdFilter();
     }
 
     const SourceDetails& SQLiteIndexSource::GetDetails() const
@@ -96,17 +246,262 @@ namespace AppInstaller::Repository::Microsoft
         return m_details;
     }
 
-    SearchResult SQLiteIndexSource::Search(const SearchRequest& request)
+    SQLiteIndex& SQLiteIndexSource::GetIndex()
     {
-        auto indexResults = m_index.Search(request);
+        std::thread::id thisThread = std::this_thread::get_id();
+        if (thisThread == m_indexThread || !m_index.CanOpenReader())
+        {
+            return m_index;
+        }
 
-        SearchResult result;
-        std::shared_ptr<SQLiteIndexSource> sharedThis = shared_from_this();
-        for (auto& indexResult : indexResults.Matches)
+        std::lock_guard<std::mutex> lock{ m_readersLock };
+
+        // The readers are kept for the lifetime of the source, as the threads that search it are usually a fixed pool.
+        auto& reader = m_readers[thisThread];
+        if (!reader)
+        {
+            reader = std::make_unique<SQLiteIndex>(m_index.OpenReader());
+        }
+
+        return *reader;
+    }
+
+    void SQLiteIndexSource::SetSearchResultCache(SearchResultCache&& cache)
+    {
+        GetIndexIdentity();
+        m_searchResultCache.emplace(std::move(cache));
+    }
+
+    void SQLiteIndexSource::SetManifestCache(ManifestCache&& cache)
+    {
+        m_manifestCache.emplace(std::move(cache));
+    }
+
+    void SQLiteIndexSource::SetSourceBundle(SourceBundle&& bundle)
+    {
+        m_sourceBundle.emplace(std::move(bundle));
+    }
+
+    void SQLiteIndexSource::SetManifestFetchCache(ManifestFetchCache&& cache)
+    {
+        GetIndexIdentity();
+        m_manifestFetchCache.emplace(std::move(cache));
+    }
+
+    Manifest::Manifest SQLiteIndexSource::GetManifestByRelativePath(const std::string& relativePath)
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_manifestsLock };
+            auto itr = m_manifests.find(relativePath);
+            if (itr != m_manifests.end())
+            {
+                return itr->second;
+            }
+        }
+
+        // The lock is not held while fetching; a manifest fetched by two threads at once is the same either way.
+        Manifest::Manifest result = FetchManifest(relativePath);
+
+        std::lock_guard<std::mutex> lock{ m_manifestsLock };
+        m_manifests.emplace(relativePath, result);
+        return result;
+    }
+
+    std::vector<Manifest::Manifest> SQLiteIndexSource::GetManifestsByRelativePaths(const std::vector<std::string>& relativePaths)
+    {
+        std::vector<Manifest::Manifest> result(relativePaths.size());
+        size_t threadCount = std::min(s_ManifestFetchThreadCount, relativePaths.size());
+
+        // Each manifest is written by the thread that fetched it, so no lock is needed
+        std::atomic<size_t> nextManifest = 0;
+
+        auto fetchManifests = [&]()
+        {
+            for (size_t index = nextManifest++; index < relativePaths.size(); index = nextManifest++)
+            {
+                result[index] = GetManifestByRelativePath(relativePaths[index]);
+            }
+        };
+
+        std::vector<std::future<void>> fetches;
+        for (size_t i = 1; i < threadCount; ++i)
+        {
+            fetches.emplace_back(std::async(std::launch::async, fetchManifests));
+        }
+
+        // This thread does its share of the work too
+        fetchManifests();
+
+        for (auto& fetch : fetches)
+        {
+            fetch.get();
+        }
+
+        return result;
+    }
+
+    const std::string& SQLiteIndexSource::GetIndexIdentity()
+    {
+        if (m_indexIdentity.empty())
+        {
+            // Matches the identity used for the state and lock of the source; the name is only a user facing alias.
+            m_cacheSourceIdentifier = SearchResultCache::GetSourceIdentifier(m_details);
+
+            // The schema version and last write time identify the contents of a published index.
+            std::ostringstream indexIdentity;
+            indexIdentity << GetIndex().GetVersion() << '/' << Utility::ConvertSystemClockToUnixEpoch(GetIndex().GetLastWriteTime());
+            m_indexIdentity = indexIdentity.str();
+        }
+
+        return m_indexIdentity;
+    }
+
+    Manifest::Manifest SQLiteIndexSource::FetchManifest(const std::string& relativePath)
+    {
+        Logging::ScopedPerformanceTimer timer{ Logging::PerformanceOperation::ManifestFetch };
+
+        // The manifest caches only ever save time, so any failure to use them falls back to the manifest file.
+        if (m_manifestCache)
+        {
+            try
+            {
+                auto cachedManifest = m_manifestCache->GetManifest(relativePath);
+                if (cachedManifest)
+                {
+                    AICLI_LOG(Repo, Info, << "Found manifest in the manifest cache: " << relativePath);
+                    return std::move(cachedManifest).value();
+                }
+            }
+            CATCH_LOG();
+        }
+
+        auto getFullPath = [&](std::string base)
+        {
+            if (base.empty() || base.back() != '/')
+            {
+                base += '/';
+            }
+            base += relativePath;
+            return base;
+        };
+
+        std::string fullPath = getFullPath(m_details.Arg);
+
+        if (!Utility::IsUrlRemote(fullPath))
+        {
+            AICLI_LOG(Repo, Info, << "Opening manifest from local file: " << fullPath);
+            return Manifest::YamlParser::CreateFromPath(fullPath);
+        }
+
+        if (m_manifestFetchCache)
+        {
+            try
+            {
+                std::lock_guard<std::mutex> lock{ m_cachesLock };
+                auto cachedContents = m_manifestFetchCache->Get(m_cacheSourceIdentifier, m_indexIdentity, relativePath);
+                if (cachedContents)
+                {
+                    AICLI_LOG(Repo, Info, << "Found manifest in the manifest fetch cache: " << relativePath);
+                    return Manifest::YamlParser::Create(cachedContents.value());
+                }
+            }
+            CATCH_LOG();
+        }
+
+        std::ostringstream manifestStream;
+
+        AICLI_LOG(Repo, Info, << "Downloading manifest");
+        ProgressCallback emptyCallback;
+        std::vector<std::string> urls{ fullPath };
+        for (const auto& mirror : m_details.Mirrors)
         {
-            result.Matches.emplace_back(std::make_unique<Application>(sharedThis, indexResult.first), std::move(indexResult.second));
+            urls.emplace_back(getFullPath(mirror));
         }
-        result.Truncated = indexResults.Truncated;
+        (void)Utility::DownloadToStream(urls, manifestStream, Utility::DownloadType::Manifest, emptyCallback);
+
+        std::string manifestContents = manifestStream.str();
+        AICLI_LOG(Repo, Verbose, << "Manifest contents: " << manifestContents);
+
+        Manifest::Manifest result = Manifest::YamlParser::Create(manifestContents);
+
+        // Only manifests that parse are cached, so that a bad download is not kept.
+        if (m_manifestFetchCache)
+        {
+            try
+            {
+                std::lock_guard<std::mutex> lock{ m_cachesLock };
+                m_manifestFetchCache->Put(m_cacheSourceIdentifier, m_indexIdentity, relativePath, manifestContents);
+            }
+            CATCH_LOG();
+        }
+
         return result;
     }
+
+    Schema::ISQLiteIndex::SearchResult SQLiteIndexSource::SearchIndex(const SearchRequest& request)
+    {
+        // The cache only ever saves time, so any failure to use it falls back to searching the index.
+        if (m_searchResultCache)
+        {
+            try
+            {
+                std::lock_guard<std::mutex> lock{ m_cachesLock };
+                auto cachedResults = m_searchResultCache->Get(m_cacheSourceIdentifier, m_indexIdentity, request);
+                if (cachedResults)
+                {
+                    return std::move(cachedResults).value();
+                }
+            }
+            CATCH_LOG();
+        }
+
+        auto indexResults = GetIndex().Search(request);
+
+        if (m_searchResultCache)
+        {
+            try
+            {
+                std::lock_guard<std::mutex> lock{ m_cachesLock };
+                m_searchResultCache->Put(m_cacheSourceIdentifier, m_indexIdentity, request, indexResults);
+            }
+            CATCH_LOG();
+        }
+
+        return indexResults;
+    }
+
+    SearchResult SQLiteIndexSource::Search(const SearchRequest& request)
+    {
+        SearchCursor cursor{ shared_from_this(), request, SearchIndex(request) };
+
+        SearchResult result;
+        result.Matches = cursor.Next(std::numeric_limits<size_t>::max());
+        result.Truncated = cursor.IsTruncated();
+        return result;
+    }
+
+    std::unique_ptr<ISearchCursor> SQLiteIndexSource::OpenSearchCursor(const SearchRequest& request)
+    {
+        return std::make_unique<SearchCursor>(shared_from_this(), request, SearchIndex(request));
+    }
+
+    SearchResult SQLiteIndexSource::SearchForIds(const std::vector<std::string>& ids)
+    {
+        // The matches are all exact id matches, so they all score the same and keep the order of the ids
+        SearchCursor cursor{ shared_from_this(), SearchRequest{}, GetIndex().SearchForIds(ids) };
+
+        SearchResult result;
+        result.Matches = cursor.Next(std::numeric_limits<size_t>::max());
+        return result;
+    }
+
+    bool SQLiteIndexSource::MayContainId(std::string_view id) const
+    {
+        return !m_idFilter || m_idFilter->MayContain(Utility::FoldCase(id));
+    }
+
+    bool SQLiteIndexSource::TryGetInstaller(const std::vector<uint8_t>& sha256, const std::filesystem::path& destination) const
+    {
+        return m_sourceBundle && m_sourceBundle->TryExtractInstaller(sha256, destination);
+    }
 }
@@ -1,16 +1,27 @@
 // Copyright (c) Microsoft Corporation.
 // Licensed under the MIT License.
 #pragma once
+#include "Microsoft/ManifestCache.h"
+#include "Microsoft/ManifestFetchCache.h"
 #include "Microsoft/SQLiteIndex.h"
+#include "Microsoft/SearchResultCache.h"
+#include "Microsoft/SourceBundle.h"
 #include "Public/AppInstallerRepositorySource.h"
 #include <AppInstallerSynchronization.h>
 
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
 
 
 namespace AppInstaller::Repository::Microsoft
 {
     // A source that holds a SQLiteIndex and lock.
+    // It can be searched from many threads at once; the thread that creates it uses the index it is given, and every other
+    // thread reads the index through a connection of its own, so that the searches do not wait on each other.
     struct SQLiteIndexSource : public std::enable_shared_from_this<SQLiteIndexSource>, public ISource
     {
         SQLiteIndexSource(const SourceDetails& details, SQLiteIndex&& index, Synchronization::CrossProcessReaderWriteLock&& lock = {});
@@ -29,12 +40,73 @@ namespace AppInstaller::Repository::Microsoft
         // Execute a search on the source.
         SearchResult Search(const SearchRequest& request) override;
 
-        // Gets the index.
-        SQLiteIndex& GetIndex() { return m_index; }
+        // Opens a cursor that creates the applications found by the index search as they are read.
+        std::unique_ptr<ISearchCursor> OpenSearchCursor(const SearchRequest& request) override;
+
+        // Finds all of the ids with a single index search.
+        SearchResult SearchForIds(const std::vector<std::string>& ids) override;
+
+        // Checks the filter of ids published with the index, if it has one.
+        bool MayContainId(std::string_view id) const override;
+
+        // Extracts the installer from the source bundle, if one is set and holds it.
+        bool TryGetInstaller(const std::vector<uint8_t>& sha256, const std::filesystem::path& destination) const override;
+
+        // Gets the index for use on the calling thread.
+        // An index that can not be opened again, as it is only in memory, is the same for every thread and must only be used by one at a time.
+        SQLiteIndex& GetIndex();
+
+        // Uses the cache for the results of index searches.
+        // The index must not change while the source is open, as cached results are keyed on its contents when this is called.
+        void SetSearchResultCache(SearchResultCache&& cache);
+
+        // Uses the cache of manifests published with the index, rather than downloading and parsing them.
+        void SetManifestCache(ManifestCache&& cache);
+
+        // Gets the cache of manifests published with the index; returns null if there is none.
+        const ManifestCache* GetManifestCache() const { return m_manifestCache ? &m_manifestCache.value() : nullptr; }
+
+        // Uses the cache of downloaded manifests, rather than downloading them again.
+        // The index must not change while the source is open, as cached manifests are keyed on its contents when this is called.
+        void SetManifestFetchCache(ManifestFetchCache&& cache);
+
+        // Uses the bundle that the index came from for the installers that it holds, rather than downloading them.
+        void SetSourceBundle(SourceBundle&& bundle);
+
+        // Gets the manifest at the path relative to the source location.
+        // Manifests are kept for the lifetime of the source, as the index that names them does not change while it is open.
+        Manifest::Manifest GetManifestByRelativePath(const std::string& relativePath);
+
+        // Gets the manifests at the paths relative to the source location, in the same order.
+        // Those not already kept are fetched concurrently, as most of the time is spent waiting on their downloads.
+        std::vector<Manifest::Manifest> GetManifestsByRelativePaths(const std::vector<std::string>& relativePaths);
 
     private:
+        // Gets the identity of the index contents that cached data is keyed on.
+        const std::string& GetIndexIdentity();
+
+        // Gets the manifest from the caches or the source location.
+        Manifest::Manifest FetchManifest(const std::string& relativePath);
+
+        // Searches the index, using the cache if one is set.
+        Schema::ISQLiteIndex::SearchResult SearchIndex(const SearchRequest& request);
+
         SourceDetails m_details;
         Synchronization::CrossProcessReaderWriteLock m_lock;
         SQLiteIndex m_index;
+        std::thread::id m_indexThread;
+        std::mutex m_readersLock;
+        std::unordered_map<std::thread::id, std::unique_ptr<SQLiteIndex>> m_readers;
+        // Held while using the search result and manifest fetch caches, which each have a single connection.
+        std::mutex m_cachesLock;
+        std::string m_cacheSourceIdentifier;
+        std::string m_indexIdentity;
+        std::optional<SearchResultCache> m_searchResultCache;
+        std::optional<ManifestCache> m_manifestCache;
+        std::optional<ManifestFetchCache> m_manifestFetchCache;
+        std::optional<SourceBundle> m_sourceBundle;
+        std::optional<BloomFilter> m_idFilter;
+        std::mutex m_manifestsLock;
+        std::unordered_map<std::string, Manifest::Manifest> m_manifests;
     };
 }
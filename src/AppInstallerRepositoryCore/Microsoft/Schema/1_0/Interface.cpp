@@ -21,8 +21,21 @@
 
 namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 {
+    using namespace std::string_view_literals;
+
     namespace
     {
+        // The page size of a packaged index; it only takes effect when the database is vacuumed.
+        // The index is compressed into the source package, and smaller pages leave less unused space in each page
+        // for the compression to spend bits on. Measured against the default of 4096, 2048 makes the compressed
+        // index about 5% smaller without a measurable cost to searches; 1024 shrinks it further but slows scans.
+        constexpr std::string_view s_PragmaPackagedPageSize = "PRAGMA page_size = 2048"sv;
+
+        // The values of each facet, along with the id that has them.
+        constexpr std::string_view s_InterfaceStmt_GetTagFacetValues =
+            "select [tags].[tag], [manifest].[id] from [tags_map] join [tags] on [tags_map].[tag] = [tags].[rowid] join [manifest] on [tags_map].[manifest] = [manifest].[rowid]"sv;
+        constexpr std::string_view s_InterfaceStmt_GetIdValues = "select [rowid], [id] from [ids]"sv;
+
         // Gets an existing manifest by its rowid., if it exists.
         std::optional<SQLite::rowid_t> GetExistingManifestId(SQLite::Connection& connection, const Manifest::Manifest& manifest)
         {
@@ -124,8 +137,9 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         }
 
         // Updates the manifest column and related table based on the given value.
+        // The old value is only removed if removeUnusedValue is true and it is no longer referenced.
         template <typename Table>
-        void UpdateManifestValueById(SQLite::Connection& connection, const typename Table::value_t& value, SQLite::rowid_t manifestId, bool overwriteLikeMatch = false)
+        void UpdateManifestValueById(SQLite::Connection& connection, const typename Table::value_t& value, SQLite::rowid_t manifestId, bool removeUnusedValue, bool overwriteLikeMatch = false)
         {
             auto [oldValueId] = ManifestTable::GetIdsById<Table>(connection, manifestId);
 
@@ -133,7 +147,55 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 
             ManifestTable::UpdateValueIdById<Table>(connection, manifestId, newValueId);
 
-            Table::DeleteIfNotNeededById(connection, oldValueId);
+            if (removeUnusedValue)
+            {
+                Table::DeleteIfNotNeededById(connection, oldValueId);
+            }
+        }
+
+        // Drops the indices that are not needed when adding manifests.
+        void DropSecondaryIndices(SQLite::Connection& connection)
+        {
+            ManifestTable::DropIndices(connection, {
+                IdTable::ValueName(),
+                NameTable::ValueName(),
+                MonikerTable::ValueName(),
+                VersionTable::ValueName(),
+                ChannelTable::ValueName(),
+                PathPartTable::ValueName()
+                });
+
+            TagsTable::DropIndices(connection);
+            CommandsTable::DropIndices(connection);
+        }
+
+        // Creates the indices dropped by DropSecondaryIndices.
+        void CreateSecondaryIndices(SQLite::Connection& connection)
+        {
+            ManifestTable::CreateIndices(connection, {
+                IdTable::ValueName(),
+                NameTable::ValueName(),
+                MonikerTable::ValueName(),
+                VersionTable::ValueName(),
+                ChannelTable::ValueName(),
+                PathPartTable::ValueName()
+                });
+
+            TagsTable::CreateIndices(connection);
+            CommandsTable::CreateIndices(connection);
+        }
+
+        // Adds the distinct values to the data table in sorted order, so that their rowids follow the order of the values.
+        template <typename Table>
+        void AddSortedValues(SQLite::Connection& connection, std::vector<std::string_view>& values, ValueIdCache& cache)
+        {
+            std::sort(values.begin(), values.end());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+
+            for (std::string_view value : values)
+            {
+                Table::EnsureExists(connection, value, cache);
+            }
         }
 
         // Gets the ordering of matches to execute, with more specific matches coming first.
@@ -159,6 +221,202 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
                 THROW_HR(E_UNEXPECTED);
             }
         }
+
+        // Sorts the values into the order of the VersionAndChannel retrieved from each by the projection.
+        // The version sort keys are created once up front, so that the sort itself only compares bytes.
+        template <typename T, typename Projection>
+        void SortByVersionAndChannel(std::vector<T>& values, Projection projection)
+        {
+            struct SortEntry
+            {
+                const std::string* Channel;
+                std::string VersionKey;
+                size_t Index;
+            };
+
+            std::vector<SortEntry> entries;
+            entries.reserve(values.size());
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                const Utility::VersionAndChannel& vac = projection(values[i]);
+                entries.push_back({ &vac.GetChannel().ToString(), vac.GetVersion().GetSortKey(), i });
+            }
+
+            // Channel ascending, then version descending; the same as VersionAndChannel::operator<.
+            std::sort(entries.begin(), entries.end(), [](const SortEntry& a, const SortEntry& b)
+                {
+                    int channelCompare = a.Channel->compare(*b.Channel);
+                    if (channelCompare != 0)
+                    {
+                        return channelCompare < 0;
+                    }
+
+                    return b.VersionKey < a.VersionKey;
+                });
+
+            std::vector<T> sorted;
+            sorted.reserve(values.size());
+            for (const SortEntry& entry : entries)
+            {
+                sorted.emplace_back(std::move(values[entry.Index]));
+            }
+
+            values = std::move(sorted);
+        }
+
+        // Orders the matches by their scores for the request, keeping only the best up to the maximum results.
+        // The matches are scored in one pass that keeps a heap of the best so far, with the worst of them on top,
+        // so that only the matches that are kept are ever sorted.  Equal scores keep the order of the search.
+        void KeepBestMatches(ISQLiteIndex::SearchResult& result, const SearchRequest& request)
+        {
+            auto& matches = result.Matches;
+            size_t limit = (request.MaximumResults > 0 ? std::min(request.MaximumResults, matches.size()) : matches.size());
+
+            using ScoredMatch = std::pair<MatchScore, size_t>;
+            auto isBetter = [](const ScoredMatch& first, const ScoredMatch& second)
+            {
+                return (first.first != second.first ? first.first > second.first : first.second < second.second);
+            };
+
+            std::vector<ScoredMatch> best;
+            best.reserve(limit);
+
+            for (size_t i = 0; i < matches.size(); ++i)
+            {
+                ScoredMatch scored{ GetMatchScore(matches[i].second, request), i };
+
+                if (best.size() < limit)
+                {
+                    best.push_back(scored);
+                    std::push_heap(best.begin(), best.end(), isBetter);
+                }
+                else if (isBetter(scored, best.front()))
+                {
+                    std::pop_heap(best.begin(), best.end(), isBetter);
+                    best.back() = scored;
+                    std::push_heap(best.begin(), best.end(), isBetter);
+                }
+            }
+
+            if (best.size() < matches.size())
+            {
+                result.Truncated = true;
+            }
+
+            std::sort_heap(best.begin(), best.end(), isBetter);
+
+            std::remove_reference_t<decltype(matches)> kept;
+            kept.reserve(best.size());
+            for (const auto& scored : best)
+            {
+                kept.emplace_back(std::move(matches[scored.second]));
+            }
+
+            matches = std::move(kept);
+        }
+
+        // Performs the search phases against the given results, which can be either the database or the snapshot.
+        template <typename ResultsT>
+        ISQLiteIndex::SearchResult SearchWithResults(ResultsT& resultsTable, const SearchRequest& request)
+        {
+            // First phase, populate the search results with the initial matches.
+            // If the Query is provided, we search across many fields and put results in together.
+            // If Inclusions has fields, we add these to the data.
+            // If neither is defined, we take the first filter and use it as the initial results search.
+            bool inclusionsAttempted = false;
+
+            // Every search sorts after the ones before it, so once there are more ids than the maximum, the remaining
+            // searches cannot change the results.  This only holds if no filters are applied to the initial results.
+            bool canStopEarly = (request.MaximumResults > 0 &&
+                (request.Filters.empty() || (!request.Query && request.Inclusions.empty() && request.Filters.size() == 1)));
+            bool hasEnoughResults = false;
+
+            auto searchOnField = [&](ApplicationMatchField field, MatchType match, std::string_view value)
+            {
+                if (hasEnoughResults)
+                {
+                    return;
+                }
+
+                resultsTable.SearchOnField(field, match, value);
+
+                if (canStopEarly && resultsTable.HasMoreIdsThan(request.MaximumResults))
+                {
+                    AICLI_LOG(Repo, Verbose, << "Found more than " << request.MaximumResults << " results, skipping the remaining searches");
+                    hasEnoughResults = true;
+                }
+            };
+
+            if (request.Query)
+            {
+                // Perform searches across multiple tables to populate the initial results.
+                const RequestMatch& query = request.Query.value();
+
+                for (MatchType match : GetMatchTypeOrder(query.Type))
+                {
+                    searchOnField(ApplicationMatchField::Id, match, query.Value);
+                    searchOnField(ApplicationMatchField::Name, match, query.Value);
+                    searchOnField(ApplicationMatchField::Moniker, match, query.Value);
+                    searchOnField(ApplicationMatchField::Command, match, query.Value);
+                    searchOnField(ApplicationMatchField::Tag, match, query.Value);
+                }
+
+                inclusionsAttempted = true;
+            }
+
+            if (!request.Inclusions.empty())
+            {
+                for (const auto& include : request.Inclusions)
+                {
+                    for (MatchType match : GetMatchTypeOrder(include.Type))
+                    {
+                        searchOnField(include.Field, match, include.Value);
+                    }
+                }
+
+                inclusionsAttempted = true;
+            }
+
+            size_t filterIndex = 0;
+            if (!inclusionsAttempted)
+            {
+                THROW_HR_IF(E_UNEXPECTED, request.Filters.empty());
+
+                // Perform search for just the field matching the first filter
+                const ApplicationMatchFilter& filter = request.Filters[0];
+
+                for (MatchType match : GetMatchTypeOrder(filter.Type))
+                {
+                    searchOnField(filter.Field, match, filter.Value);
+                }
+
+                // Skip the filter as we already know everything matches
+                filterIndex = 1;
+            }
+
+            // Remove any duplicate manifest entries
+            resultsTable.RemoveDuplicateManifestRows();
+
+            // Second phase, for remaining filters, flag matching search results, then remove unflagged values.
+            for (size_t i = filterIndex; i < request.Filters.size(); ++i)
+            {
+                const ApplicationMatchFilter& filter = request.Filters[i];
+
+                resultsTable.PrepareToFilter();
+
+                for (MatchType match : GetMatchTypeOrder(filter.Type))
+                {
+                    resultsTable.FilterOnField(filter.Field, match, filter.Value);
+                }
+
+                resultsTable.CompleteFilter();
+            }
+
+            // All of the results are scored, as the best of them need not be the first in search order
+            ISQLiteIndex::SearchResult result = resultsTable.GetSearchResults();
+            KeepBestMatches(result, request);
+            return result;
+        }
     }
 
     Schema::Version Interface::GetVersion() const
@@ -187,13 +445,108 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             { PathPartTable::ValueName(), false, true }
             });
 
-        TagsTable::Create(connection);
-        CommandsTable::Create(connection);
+        CreateOneToManyTables(connection);
 
         savepoint.Commit();
     }
 
     void Interface::AddManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath)
+    {
+        m_valueIdCache.Validate(connection);
+        AddManifestWithCache(connection, manifest, relativePath, m_valueIdCache);
+    }
+
+    void Interface::AddManifests(SQLite::Connection& connection, const std::vector<std::pair<Manifest::Manifest, std::filesystem::path>>& manifests)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "addmanifests_v1_0");
+
+        // When populating an empty index, it is much faster to create the secondary indices once at the end
+        // than to maintain them for every insert.  They are not used when adding manifests.
+        bool deferIndices = (manifests.size() > 1 && ManifestTable::IsEmpty(connection));
+
+        if (deferIndices)
+        {
+            AICLI_LOG(Repo, Verbose, << "Deferring index creation until all manifests are added");
+            DropSecondaryIndices(connection);
+        }
+
+        m_valueIdCache.Validate(connection);
+
+        if (deferIndices)
+        {
+            AddManifestsInKeyOrder(connection, manifests);
+            CreateSecondaryIndices(connection);
+        }
+        else
+        {
+            for (const auto& manifest : manifests)
+            {
+                AddManifestWithCache(connection, manifest.first, manifest.second, m_valueIdCache);
+            }
+        }
+
+        savepoint.Commit();
+    }
+
+    void Interface::AddManifestsInKeyOrder(SQLite::Connection& connection, const std::vector<std::pair<Manifest::Manifest, std::filesystem::path>>& manifests)
+    {
+        // The manifests are added in the order of { folded id, version, channel }, the order in which they are looked up.
+        // As a new id is then always after every id before it, the ids also get their rowids in order.
+        std::vector<std::tuple<std::string, std::string_view, std::string_view, size_t>> keys;
+        keys.reserve(manifests.size());
+
+        std::vector<std::string_view> names;
+        std::vector<std::string_view> monikers;
+        std::vector<std::string_view> versions;
+        std::vector<std::string_view> channels;
+        std::vector<std::string_view> tags;
+        std::vector<std::string_view> commands;
+
+        for (size_t i = 0; i < manifests.size(); ++i)
+        {
+            const Manifest::Manifest& manifest = manifests[i].first;
+            keys.emplace_back(Utility::FoldCase(manifest.Id), manifest.Version, manifest.Channel, i);
+
+            names.emplace_back(manifest.Name);
+            monikers.emplace_back(manifest.AppMoniker);
+            versions.emplace_back(manifest.Version);
+            channels.emplace_back(manifest.Channel);
+            tags.insert(tags.end(), manifest.Tags.begin(), manifest.Tags.end());
+            commands.insert(commands.end(), manifest.Commands.begin(), manifest.Commands.end());
+        }
+
+        std::sort(keys.begin(), keys.end());
+
+        // The other values are shared in no particular order, so they are all added up front.
+        // Each insert then appends to the table and to the index on its value, rather than splitting pages all over them.
+        AddSortedValues<NameTable>(connection, names, m_valueIdCache);
+        AddSortedValues<MonikerTable>(connection, monikers, m_valueIdCache);
+        AddSortedValues<VersionTable>(connection, versions, m_valueIdCache);
+        AddSortedValues<ChannelTable>(connection, channels, m_valueIdCache);
+        AddSortedValues<TagsTable>(connection, tags, m_valueIdCache);
+        AddSortedValues<CommandsTable>(connection, commands, m_valueIdCache);
+
+        // The path parts are keyed on their parent, and so are left in the order of the manifests.
+        DeferredMappings mappings;
+
+        for (const auto& key : keys)
+        {
+            const auto& manifest = manifests[std::get<3>(key)];
+            AddManifestWithCache(connection, manifest.first, manifest.second, m_valueIdCache, &mappings);
+        }
+
+        // The mapping tables are keyed on { value, manifest }
+        std::sort(mappings.Tags.begin(), mappings.Tags.end());
+        std::sort(mappings.Commands.begin(), mappings.Commands.end());
+
+        TagsTable::InsertMappings(connection, mappings.Tags);
+        CommandsTable::InsertMappings(connection, mappings.Commands);
+
+        AICLI_LOG(Repo, Verbose, << "Added " << manifests.size() << " manifests in key order");
+    }
+
+    void Interface::AddManifestWithCache(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath, ValueIdCache& cache,
+        DeferredMappings* deferredMappings)
     {
         auto manifestResult = GetExistingManifestId(connection, manifest);
 
@@ -202,17 +555,17 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 
         SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "addmanifest_v1_0");
 
-        auto [pathAdded, pathLeafId] = PathPartTable::EnsurePathExists(connection, relativePath, true);
+        auto [pathAdded, pathLeafId] = PathPartTable::EnsurePathExists(connection, relativePath, true, &cache);
 
         // If we get false from the function, this manifest path already exists in the index.
         THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS), !pathAdded);
 
         // Ensure that all of the 1:1 data exists.
         SQLite::rowid_t idId = IdTable::EnsureExists(connection, manifest.Id, true);
-        SQLite::rowid_t nameId = NameTable::EnsureExists(connection, manifest.Name);
-        SQLite::rowid_t monikerId = MonikerTable::EnsureExists(connection, manifest.AppMoniker);
-        SQLite::rowid_t versionId = VersionTable::EnsureExists(connection, manifest.Version);
-        SQLite::rowid_t channelId = ChannelTable::EnsureExists(connection, manifest.Channel);
+        SQLite::rowid_t nameId = NameTable::EnsureExists(connection, manifest.Name, cache);
+        SQLite::rowid_t monikerId = MonikerTable::EnsureExists(connection, manifest.AppMoniker, cache);
+        SQLite::rowid_t versionId = VersionTable::EnsureExists(connection, manifest.Version, cache);
+        SQLite::rowid_t channelId = ChannelTable::EnsureExists(connection, manifest.Channel, cache);
 
         // Insert the manifest entry.
         SQLite::rowid_t manifestId = ManifestTable::Insert(connection, {
@@ -224,9 +577,26 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             { PathPartTable::ValueName(), pathLeafId }
             });
 
+        OnManifestInserted(connection, manifest, manifestId);
+
         // Add all of the 1:N data.
-        TagsTable::EnsureExistsAndInsert(connection, manifest.Tags, manifestId);
-        CommandsTable::EnsureExistsAndInsert(connection, manifest.Commands, manifestId);
+        if (deferredMappings)
+        {
+            for (const auto& tag : manifest.Tags)
+            {
+                deferredMappings->Tags.emplace_back(TagsTable::EnsureExists(connection, tag, cache), manifestId);
+            }
+
+            for (const auto& command : manifest.Commands)
+            {
+                deferredMappings->Commands.emplace_back(CommandsTable::EnsureExists(connection, command, cache), manifestId);
+            }
+        }
+        else
+        {
+            TagsTable::EnsureExistsAndInsert(connection, manifest.Tags, manifestId, cache);
+            CommandsTable::EnsureExistsAndInsert(connection, manifest.Commands, manifestId, cache);
+        }
 
         savepoint.Commit();
     }
@@ -240,40 +610,44 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 
         SQLite::rowid_t manifestId = manifestResult.value();
 
+        // Values that are no longer referenced are removed, and their rowids may be reused.
+        m_valueIdCache.Clear();
+
         auto [idInIndex, nameInIndex, monikerInIndex, versionInIndex, channelInIndex] =
             ManifestTable::GetValuesById<IdTable, NameTable, MonikerTable, VersionTable, ChannelTable>(connection, manifestId);
 
         SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "updatemanifest_v1_0");
         bool indexModified = false;
+        bool removeUnusedValues = !m_deferUnusedValueRemoval;
 
         // Id, Version, and Channel may have changed casing. If so, they too need to be updated.
         if (idInIndex != manifest.Id)
         {
-            UpdateManifestValueById<IdTable>(connection, manifest.Id, manifestId, true);
+            UpdateManifestValueById<IdTable>(connection, manifest.Id, manifestId, removeUnusedValues, true);
             indexModified = true;
         }
 
         if (versionInIndex != manifest.Version)
         {
-            UpdateManifestValueById<VersionTable>(connection, manifest.Version, manifestId);
+            UpdateManifestValueById<VersionTable>(connection, manifest.Version, manifestId, removeUnusedValues);
             indexModified = true;
         }
 
         if (channelInIndex != manifest.Channel)
         {
-            UpdateManifestValueById<ChannelTable>(connection, manifest.Channel, manifestId);
+            UpdateManifestValueById<ChannelTable>(connection, manifest.Channel, manifestId, removeUnusedValues);
             indexModified = true;
         }
 
         if (nameInIndex != manifest.Name)
         {
-            UpdateManifestValueById<NameTable>(connection, manifest.Name, manifestId);
+            UpdateManifestValueById<NameTable>(connection, manifest.Name, manifestId, removeUnusedValues);
             indexModified = true;
         }
 
         if (monikerInIndex != manifest.AppMoniker)
         {
-            UpdateManifestValueById<MonikerTable>(connection, manifest.AppMoniker, manifestId);
+            UpdateManifestValueById<MonikerTable>(connection, manifest.AppMoniker, manifestId, removeUnusedValues);
             indexModified = true;
         }
 
@@ -285,7 +659,10 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         {
             // Path was added, so we need to update the manifest table and delete the old path
             ManifestTable::UpdateValueIdById<PathPartTable>(connection, manifestId, newPathLeafId);
-            PathPartTable::RemovePathById(connection, existingPathLeafId);
+            if (removeUnusedValues)
+            {
+                PathPartTable::RemovePathById(connection, existingPathLeafId);
+            }
             indexModified = true;
         }
         else
@@ -295,8 +672,8 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         }
 
         // Update all 1:N tables as necessary
-        indexModified = TagsTable::UpdateIfNeededByManifestId(connection, manifest.Tags, manifestId) || indexModified;
-        indexModified = CommandsTable::UpdateIfNeededByManifestId(connection, manifest.Commands, manifestId) || indexModified;
+        indexModified = TagsTable::UpdateIfNeededByManifestId(connection, manifest.Tags, manifestId, removeUnusedValues) || indexModified;
+        indexModified = CommandsTable::UpdateIfNeededByManifestId(connection, manifest.Commands, manifestId, removeUnusedValues) || indexModified;
 
         savepoint.Commit();
 
@@ -312,6 +689,9 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 
         SQLite::rowid_t manifestId = manifestResult.value();
 
+        // Values that are no longer referenced are removed, and their rowids may be reused.
+        m_valueIdCache.Clear();
+
         // Get the ids of the values from the manifest table
         auto [idId, nameId, monikerId, versionId, channelId, pathLeafId] = 
             ManifestTable::GetIdsById<IdTable, NameTable, MonikerTable, VersionTable, ChannelTable, PathPartTable>(connection, manifestId);
@@ -320,26 +700,39 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 
         // Remove the manifest row
         ManifestTable::DeleteById(connection, manifestId);
+        OnManifestDeleted(connection, manifest, manifestId);
 
-        // Remove all of the 1:1 data that is no longer referenced.
-        IdTable::DeleteIfNotNeededById(connection, idId);
-        NameTable::DeleteIfNotNeededById(connection, nameId);
-        MonikerTable::DeleteIfNotNeededById(connection, monikerId);
-        VersionTable::DeleteIfNotNeededById(connection, versionId);
-        ChannelTable::DeleteIfNotNeededById(connection, channelId);
-
-        // Remove the path
-        PathPartTable::RemovePathById(connection, pathLeafId);
-
-        // Remove all of the 1:N data that is no longer referenced.
-        TagsTable::DeleteIfNotNeededByManifestId(connection, manifestId);
-        CommandsTable::DeleteIfNotNeededByManifestId(connection, manifestId);
+        if (m_deferUnusedValueRemoval)
+        {
+            // The values are left for RemoveUnusedValues, but the mappings belong to the manifest.
+            TagsTable::DeleteMappingsByManifestId(connection, manifestId);
+            CommandsTable::DeleteMappingsByManifestId(connection, manifestId);
+        }
+        else
+        {
+            // Remove all of the 1:1 data that is no longer referenced.
+            IdTable::DeleteIfNotNeededById(connection, idId);
+            NameTable::DeleteIfNotNeededById(connection, nameId);
+            MonikerTable::DeleteIfNotNeededById(connection, monikerId);
+            VersionTable::DeleteIfNotNeededById(connection, versionId);
+            ChannelTable::DeleteIfNotNeededById(connection, channelId);
+
+            // Remove the path
+            PathPartTable::RemovePathById(connection, pathLeafId);
+
+            // Remove all of the 1:N data that is no longer referenced.
+            TagsTable::DeleteIfNotNeededByManifestId(connection, manifestId);
+            CommandsTable::DeleteIfNotNeededByManifestId(connection, manifestId);
+        }
 
         savepoint.Commit();
     }
 
     void Interface::PrepareForPackaging(SQLite::Connection& connection)
     {
+        // Vacuuming may change the rowids of the values.
+        m_valueIdCache.Clear();
+
         SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "prepareforpackaging_v1_0");
 
         IdTable::PrepareForPackaging(connection);
@@ -359,8 +752,20 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         TagsTable::PrepareForPackaging(connection);
         CommandsTable::PrepareForPackaging(connection);
 
+        // Without statistics, the planner drives searches from the manifest table, evaluating the (ICU) LIKE on
+        // the value of every manifest rather than once per distinct value. The existing indices already cover
+        // every search subselect; it is only the join order that needs the statistics.
+        SQLite::Builder::StatementBuilder analyzeBuilder;
+        analyzeBuilder.Analyze();
+        analyzeBuilder.Execute(connection);
+
         savepoint.Commit();
 
+        // The rows are already stored in rowid order, which is the order in which the searches read them,
+        // so rebuilding the file with the packaged page size is enough for locality.
+        SQLite::Statement pageSize = SQLite::Statement::Create(connection, s_PragmaPackagedPageSize);
+        pageSize.Execute();
+
         // Force the database to actually shrink the file size.
         // This *must* be done outside of an active transaction.
         SQLite::Builder::StatementBuilder builder;
@@ -386,79 +791,66 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             return result;
         }
 
-        // First phase, create the search results table and populate it with the initial results.
-        // If the Query is provided, we search across many fields and put results in together.
-        // If Inclusions has fields, we add these to the data.
-        // If neither is defined, we take the first filter and use it as the initial results search.
-        SearchResultsTable resultsTable(connection);
-        bool inclusionsAttempted = false;
-
-        if (request.Query)
+        if (m_searchSnapshot)
         {
-            // Perform searches across multiple tables to populate the initial results.
-            const RequestMatch& query = request.Query.value();
+            SearchSnapshot::Results results(*m_searchSnapshot);
+            return SearchWithResults(results, request);
+        }
 
-            for (MatchType match : GetMatchTypeOrder(query.Type))
-            {
-                resultsTable.SearchOnField(ApplicationMatchField::Id, match, query.Value);
-                resultsTable.SearchOnField(ApplicationMatchField::Name, match, query.Value);
-                resultsTable.SearchOnField(ApplicationMatchField::Moniker, match, query.Value);
-                resultsTable.SearchOnField(ApplicationMatchField::Command, match, query.Value);
-                resultsTable.SearchOnField(ApplicationMatchField::Tag, match, query.Value);
-            }
+        std::unique_ptr<SearchResultsTable> resultsTable = CreateSearchResultsTable(connection, m_searchResultsInMemory);
+        return SearchWithResults(*resultsTable, request);
+    }
 
-            inclusionsAttempted = true;
-        }
+    ISQLiteIndex::SearchResult Interface::SearchForIds(SQLite::Connection& connection, const std::vector<std::string>& ids)
+    {
+        // Stay well under the limit on the number of parameters in a single statement.
+        constexpr size_t maximumIdsPerStatement = 500;
 
-        if (!request.Inclusions.empty())
+        std::unordered_map<std::string_view, size_t> positions;
+        std::vector<std::string> uniqueIds;
+        for (const std::string& id : ids)
         {
-            for (const auto& include : request.Inclusions)
+            if (positions.emplace(id, uniqueIds.size()).second)
             {
-                for (MatchType match : GetMatchTypeOrder(include.Type))
-                {
-                    resultsTable.SearchOnField(include.Field, match, include.Value);
-                }
+                uniqueIds.push_back(id);
             }
-
-            inclusionsAttempted = true;
         }
 
-        size_t filterIndex = 0;
-        if (!inclusionsAttempted)
+        std::vector<std::optional<SQLite::rowid_t>> rowIds(uniqueIds.size());
+
+        for (size_t begin = 0; begin < uniqueIds.size(); begin += maximumIdsPerStatement)
         {
-            THROW_HR_IF(E_UNEXPECTED, request.Filters.empty());
+            size_t end = std::min(begin + maximumIdsPerStatement, uniqueIds.size());
+            std::vector<std::string> batch(uniqueIds.begin() + begin, uniqueIds.begin() + end);
 
-            // Perform search for just the field matching the first filter
-            const ApplicationMatchFilter& filter = request.Filters[0];
+            // The goal is a statement like this:
+            //  SELECT rowid, id from ids where id in (<ids>)
+            // The number of ids varies, so this is not worth caching.
+            SQLite::Builder::StatementBuilder builder;
+            builder.Select({ SQLite::RowIDName, IdTable::ValueName() }).From(IdTable::TableName()).Where(IdTable::ValueName()).In(batch);
 
-            for (MatchType match : GetMatchTypeOrder(filter.Type))
+            SQLite::Statement select = builder.Prepare(connection);
+            while (select.Step())
             {
-                resultsTable.SearchOnField(filter.Field, match, filter.Value);
+                auto position = positions.find(select.GetColumn<std::string>(1));
+                if (position != positions.end())
+                {
+                    rowIds[position->second] = select.GetColumn<SQLite::rowid_t>(0);
+                }
             }
-
-            // Skip the filter as we already know everything matches
-            filterIndex = 1;
         }
 
-        // Remove any duplicate manifest entries
-        resultsTable.RemoveDuplicateManifestRows();
-
-        // Second phase, for remaining filters, flag matching search results, then remove unflagged values.
-        for (size_t i = filterIndex; i < request.Filters.size(); ++i)
+        SearchResult result;
+        for (size_t i = 0; i < uniqueIds.size(); ++i)
         {
-            const ApplicationMatchFilter& filter = request.Filters[i];
-
-            resultsTable.PrepareToFilter();
-
-            for (MatchType match : GetMatchTypeOrder(filter.Type))
+            if (rowIds[i])
             {
-                resultsTable.FilterOnField(filter.Field, match, filter.Value);
+                result.Matches.emplace_back(rowIds[i].value(), ApplicationMatchFilter(ApplicationMatchField::Id, MatchType::Exact, uniqueIds[i]));
             }
-
-            resultsTable.CompleteFilter();
         }
 
-        return resultsTable.GetSearchResults(request.MaximumResults);
+        AICLI_LOG(Repo, Verbose, << "Found " << result.Matches.size() << " of " << uniqueIds.size() << " ids");
+        return result;
     }
 
     std::optional<std::string> Interface::GetIdStringById(SQLite::Connection& connection, SQLite::rowid_t id)
@@ -468,7 +860,7 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 
     std::optional<std::string> Interface::GetNameStringById(SQLite::Connection& connection, SQLite::rowid_t id)
     {
-        std::optional<SQLite::rowid_t> manifestIdOpt = GetManifestIdByKey(connection, id);
+        std::optional<SQLite::rowid_t> manifestIdOpt = GetManifestIdByKey(connection, id, {}, {});
 
         if (!manifestIdOpt)
         {
@@ -495,6 +887,19 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         return PathPartTable::GetPathById(connection, pathPartId);
     }
 
+    std::vector<std::optional<std::string>> Interface::GetPathStringsByKeys(SQLite::Connection& connection, SQLite::rowid_t id, const std::vector<Utility::VersionAndChannel>& versions)
+    {
+        std::vector<std::optional<std::string>> result;
+        result.reserve(versions.size());
+
+        for (const auto& version : versions)
+        {
+            result.emplace_back(GetPathStringByKey(connection, id, version.GetVersion().ToString(), version.GetChannel().ToString()));
+        }
+
+        return result;
+    }
+
     std::vector<Utility::VersionAndChannel> Interface::GetVersionsById(SQLite::Connection& connection, SQLite::rowid_t id)
     {
         auto versionsAndChannels = ManifestTable::GetAllValuesById<IdTable, VersionTable, ChannelTable>(connection, id);
@@ -506,8 +911,254 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             result.emplace_back(Utility::Version{ std::move(std::get<0>(vac)) }, Utility::Channel{ std::move(std::get<1>(vac)) });
         }
 
-        std::sort(result.begin(), result.end());
+        SortByVersionAndChannel(result, [](const Utility::VersionAndChannel& vac) -> const Utility::VersionAndChannel& { return vac; });
+
+        return result;
+    }
+
+    std::vector<std::vector<Utility::VersionAndChannel>> Interface::GetVersionsByIds(SQLite::Connection& connection, const std::vector<SQLite::rowid_t>& ids, const VersionQuery& query)
+    {
+        // Without the sort keys of a later schema, every version has to be read and sorted to know which the query includes.
+        std::vector<std::vector<Utility::VersionAndChannel>> result;
+        result.reserve(ids.size());
+
+        for (SQLite::rowid_t id : ids)
+        {
+            result.emplace_back(query.Apply(GetVersionsById(connection, id)));
+        }
+
+        return result;
+    }
+
+    void Interface::LoadSearchSnapshot(SQLite::Connection& connection, std::string_view sharedName)
+    {
+        m_searchSnapshot = std::make_unique<SearchSnapshot>(connection, sharedName);
+    }
+
+    void Interface::SetSearchResultsInMemory(bool value)
+    {
+        m_searchResultsInMemory = value;
+    }
+
+    void Interface::SetDeferUnusedValueRemoval(bool value)
+    {
+        m_deferUnusedValueRemoval = value;
+    }
+
+    void Interface::RemoveUnusedValues(SQLite::Connection& connection)
+    {
+        // Values that are no longer referenced are removed, and their rowids may be reused.
+        m_valueIdCache.Clear();
+
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "removeunusedvalues_v1_0");
+
+        IdTable::RemoveUnused(connection);
+        NameTable::RemoveUnused(connection);
+        MonikerTable::RemoveUnused(connection);
+        VersionTable::RemoveUnused(connection);
+        ChannelTable::RemoveUnused(connection);
+
+        PathPartTable::RemoveUnused(connection);
+
+        TagsTable::RemoveUnused(connection);
+        CommandsTable::RemoveUnused(connection);
+
+        savepoint.Commit();
+    }
+
+    void Interface::MigrateFrom(SQLite::Connection&, const Schema::Version& version)
+    {
+        // There is no earlier schema to upgrade from; each later version migrates its own tables
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED), version != Schema::Version{ 1, 0 });
+    }
+
+    std::vector<std::pair<Manifest::Manifest, std::filesystem::path>> Interface::GetAllManifests(SQLite::Connection& connection)
+    {
+        std::vector<std::pair<Manifest::Manifest, std::filesystem::path>> result;
+
+        for (SQLite::rowid_t manifestId : ManifestTable::GetAllRowIds(connection))
+        {
+            Manifest::Manifest manifest;
+
+            auto [id, name, moniker, version, channel] =
+                ManifestTable::GetValuesById<IdTable, NameTable, MonikerTable, VersionTable, ChannelTable>(connection, manifestId);
+
+            manifest.Id = std::move(id);
+            manifest.Name = std::move(name);
+            manifest.AppMoniker = std::move(moniker);
+            manifest.Version = std::move(version);
+            manifest.Channel = std::move(channel);
+
+            for (std::string& tag : TagsTable::GetValuesByManifestId(connection, manifestId))
+            {
+                manifest.Tags.emplace_back(std::move(tag));
+            }
+
+            for (std::string& command : CommandsTable::GetValuesByManifestId(connection, manifestId))
+            {
+                manifest.Commands.emplace_back(std::move(command));
+            }
+
+            auto [pathLeafId] = ManifestTable::GetIdsById<PathPartTable>(connection, manifestId);
+            std::optional<std::string> path = PathPartTable::GetPathById(connection, pathLeafId);
+            THROW_HR_IF(E_UNEXPECTED, !path);
+
+            result.emplace_back(std::move(manifest), std::filesystem::u8path(path.value()));
+        }
+
+        return result;
+    }
+
+    std::vector<ISQLiteIndex::ApplicationSummary> Interface::GetApplicationSummaries(SQLite::Connection& connection, const std::vector<SQLite::rowid_t>& ids)
+    {
+        // Stay well under the limit on the number of parameters in a single statement.
+        constexpr size_t maximumIdsPerStatement = 500;
+
+        std::unordered_map<SQLite::rowid_t, size_t> positions;
+        std::vector<SQLite::rowid_t> uniqueIds;
+        for (SQLite::rowid_t id : ids)
+        {
+            if (positions.emplace(id, uniqueIds.size()).second)
+            {
+                uniqueIds.push_back(id);
+            }
+        }
+
+        std::vector<std::string> idStrings(uniqueIds.size());
+        std::vector<std::vector<std::pair<Utility::VersionAndChannel, std::string>>> versionsAndNames(uniqueIds.size());
+
+        for (size_t begin = 0; begin < uniqueIds.size(); begin += maximumIdsPerStatement)
+        {
+            size_t end = std::min(begin + maximumIdsPerStatement, uniqueIds.size());
+            std::vector<SQLite::rowid_t> batch(uniqueIds.begin() + begin, uniqueIds.begin() + end);
+
+            for (auto&& row : ManifestTable::GetAllValuesByIdIn<IdTable, IdTable, NameTable, VersionTable, ChannelTable>(connection, batch))
+            {
+                size_t position = positions[std::get<0>(row)];
+                idStrings[position] = std::move(std::get<1>(row));
+                versionsAndNames[position].emplace_back(
+                    Utility::VersionAndChannel{ Utility::Version{ std::move(std::get<3>(row)) }, Utility::Channel{ std::move(std::get<4>(row)) } },
+                    std::move(std::get<2>(row)));
+            }
+        }
+
+        std::vector<ApplicationSummary> result;
+        result.reserve(uniqueIds.size());
+
+        for (size_t i = 0; i < uniqueIds.size(); ++i)
+        {
+            auto& versions = versionsAndNames[i];
+            if (versions.empty())
+            {
+                AICLI_LOG(Repo, Info, << "Did not find manifest by Id id: " << uniqueIds[i]);
+                continue;
+            }
+
+            // Sorted the same as GetVersionsById, so that the name comes from the version shown first.
+            SortByVersionAndChannel(versions, [](const auto& version) -> const Utility::VersionAndChannel& { return version.first; });
+
+            ApplicationSummary& summary = result.emplace_back();
+            summary.Id = uniqueIds[i];
+            summary.IdString = std::move(idStrings[i]);
+            summary.Name = std::move(versions.front().second);
+
+            summary.Versions.reserve(versions.size());
+            for (auto& version : versions)
+            {
+                summary.Versions.emplace_back(std::move(version.first));
+            }
+        }
 
         return result;
     }
+
+    std::vector<std::pair<std::string, size_t>> Interface::GetFacetCounts(SQLite::Connection& connection, Facet facet)
+    {
+        std::vector<std::pair<std::string, size_t>> result;
+        for (auto& entry : GetAllFacetIds(connection, facet))
+        {
+            result.emplace_back(entry.first, entry.second.size());
+        }
+        return result;
+    }
+
+    std::vector<SQLite::rowid_t> Interface::GetIdsByFacet(SQLite::Connection& connection, Facet facet, std::string_view value)
+    {
+        auto facetIds = GetAllFacetIds(connection, facet);
+        auto itr = facetIds.find(std::string{ value });
+        return (itr == facetIds.end() ? std::vector<SQLite::rowid_t>{} : std::move(itr->second));
+    }
+
+    std::string Interface::GetFacetValueFromId(Facet facet, std::string_view id)
+    {
+        THROW_HR_IF(E_INVALIDARG, facet != Facet::Publisher);
+        return Utility::FoldCase(id.substr(0, id.find('.')));
+    }
+
+    std::map<std::string, std::vector<SQLite::rowid_t>> Interface::GetAllFacetIds(SQLite::Connection& connection, Facet facet)
+    {
+        std::map<std::string, std::vector<SQLite::rowid_t>> result;
+
+        switch (facet)
+        {
+        case Facet::Tag:
+        {
+            SQLite::Statement select = SQLite::Statement::Create(connection, s_InterfaceStmt_GetTagFacetValues);
+            while (select.Step())
+            {
+                result[select.GetColumn<std::string>(0)].push_back(select.GetColumn<SQLite::rowid_t>(1));
+            }
+        }
+        break;
+        case Facet::Publisher:
+        {
+            SQLite::Statement select = SQLite::Statement::Create(connection, s_InterfaceStmt_GetIdValues);
+            while (select.Step())
+            {
+                result[GetFacetValueFromId(facet, select.GetColumn<std::string>(1))].push_back(select.GetColumn<SQLite::rowid_t>(0));
+            }
+        }
+        break;
+        default:
+            THROW_HR(E_INVALIDARG);
+        }
+
+        // An id has a tag when any of its manifests do, so the same id can be found more than once.
+        for (auto& entry : result)
+        {
+            std::sort(entry.second.begin(), entry.second.end());
+            entry.second.erase(std::unique(entry.second.begin(), entry.second.end()), entry.second.end());
+        }
+
+        return result;
+    }
+
+    void Interface::CreateOneToManyTables(SQLite::Connection& connection)
+    {
+        TagsTable::Create(connection);
+        CommandsTable::Create(connection);
+    }
+
+    std::optional<SQLite::rowid_t> Interface::GetExistingManifestId(SQLite::Connection& connection, const Manifest::Manifest& manifest)
+    {
+        return V1_0::GetExistingManifestId(connection, manifest);
+    }
+
+    void Interface::OnManifestInserted(SQLite::Connection&, const Manifest::Manifest&, SQLite::rowid_t)
+    {
+    }
+
+    void Interface::OnManifestDeleted(SQLite::Connection&, const Manifest::Manifest&, SQLite::rowid_t)
+    {
+    }
+
+    std::unique_ptr<SearchResultsTable> Interface::CreateSearchResultsTable(SQLite::Connection& connection, bool inMemory) const
+    {
+        return std::make_unique<SearchResultsTable>(connection, inMemory);
+    }
+
+    std::optional<SQLite::rowid_t> Interface::GetManifestIdByKey(SQLite::Connection& connection, SQLite::rowid_t id, std::string_view version, std::string_view channel)
+    {
+        return V1_0::GetManifestIdByKey(connection, id, version, channel);
+    }
 }
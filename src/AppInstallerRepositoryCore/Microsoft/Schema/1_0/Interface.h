@@ -2,6 +2,12 @@
 // Licensed under the MIT License.
 #pragma once
 #include "Microsoft/Schema/ISQLiteIndex.h"
+#include "Microsoft/Schema/1_0/SearchResultsTable.h"
+#include "Microsoft/Schema/1_0/SearchSnapshot.h"
+#include "Microsoft/Schema/1_0/OneToOneTable.h"
+
+#include <map>
+#include <memory>
 
 
 namespace AppInstaller::Repository::Microsoft::Schema::V1_0
@@ -13,13 +19,76 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         Schema::Version GetVersion() const override;
         void CreateTables(SQLite::Connection& connection) override;
         void AddManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath) override;
+        void AddManifests(SQLite::Connection& connection, const std::vector<std::pair<Manifest::Manifest, std::filesystem::path>>& manifests) override;
         bool UpdateManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath) override;
         void RemoveManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath) override;
         void PrepareForPackaging(SQLite::Connection& connection) override;
         SearchResult Search(SQLite::Connection& connection, const SearchRequest& request) override;
+        SearchResult SearchForIds(SQLite::Connection& connection, const std::vector<std::string>& ids) override;
         std::optional<std::string> GetIdStringById(SQLite::Connection& connection, SQLite::rowid_t id) override;
         std::optional<std::string> GetNameStringById(SQLite::Connection& connection, SQLite::rowid_t id) override;
         std::optional<std::string> GetPathStringByKey(SQLite::Connection& connection, SQLite::rowid_t id, std::string_view version, std::string_view channel) override;
+        std::vector<std::optional<std::string>> GetPathStringsByKeys(SQLite::Connection& connection, SQLite::rowid_t id, const std::vector<Utility::VersionAndChannel>& versions) override;
         std::vector<Utility::VersionAndChannel> GetVersionsById(SQLite::Connection& connection, SQLite::rowid_t id) override;
+        std::vector<std::vector<Utility::VersionAndChannel>> GetVersionsByIds(SQLite::Connection& connection, const std::vector<SQLite::rowid_t>& ids, const VersionQuery& query) override;
+        void LoadSearchSnapshot(SQLite::Connection& connection, std::string_view sharedName) override;
+        void SetSearchResultsInMemory(bool value) override;
+        std::vector<std::pair<Manifest::Manifest, std::filesystem::path>> GetAllManifests(SQLite::Connection& connection) override;
+        std::vector<ApplicationSummary> GetApplicationSummaries(SQLite::Connection& connection, const std::vector<SQLite::rowid_t>& ids) override;
+        std::vector<std::pair<std::string, size_t>> GetFacetCounts(SQLite::Connection& connection, Facet facet) override;
+        std::vector<SQLite::rowid_t> GetIdsByFacet(SQLite::Connection& connection, Facet facet, std::string_view value) override;
+        void SetDeferUnusedValueRemoval(bool value) override;
+        void RemoveUnusedValues(SQLite::Connection& connection) override;
+        void MigrateFrom(SQLite::Connection& connection, const Schema::Version& version) override;
+
+    protected:
+        // Gets the value of the facet for the given id string; only valid for facets that come from the id.
+        static std::string GetFacetValueFromId(Facet facet, std::string_view id);
+
+        // Gathers every value of the facet from the manifests, each with its sorted, unique ids.
+        static std::map<std::string, std::vector<SQLite::rowid_t>> GetAllFacetIds(SQLite::Connection& connection, Facet facet);
+
+        // Creates the tables of the values that are 1:N with a manifest.
+        virtual void CreateOneToManyTables(SQLite::Connection& connection);
+
+        // Gets the manifest with the same { Id, Version, Channel } as the given manifest, ignoring case, if it exists.
+        virtual std::optional<SQLite::rowid_t> GetExistingManifestId(SQLite::Connection& connection, const Manifest::Manifest& manifest);
+
+        // Called within the savepoint of adding a manifest, once its row has been inserted.
+        virtual void OnManifestInserted(SQLite::Connection& connection, const Manifest::Manifest& manifest, SQLite::rowid_t manifestId);
+
+        // Called within the savepoint of removing a manifest, once its row has been deleted.
+        virtual void OnManifestDeleted(SQLite::Connection& connection, const Manifest::Manifest& manifest, SQLite::rowid_t manifestId);
+
+        // Creates the search results table used by this version.
+        virtual std::unique_ptr<SearchResultsTable> CreateSearchResultsTable(SQLite::Connection& connection, bool inMemory) const;
+
+        // Gets the manifest for the given key; an empty version is the latest version in the channel.
+        virtual std::optional<SQLite::rowid_t> GetManifestIdByKey(SQLite::Connection& connection, SQLite::rowid_t id, std::string_view version, std::string_view channel);
+
+    private:
+        // The rows of the mapping tables, held back while adding manifests in bulk so that they can be inserted in key order.
+        // Each is a pair of { value rowid, manifest rowid }.
+        struct DeferredMappings
+        {
+            std::vector<std::pair<SQLite::rowid_t, SQLite::rowid_t>> Tags;
+            std::vector<std::pair<SQLite::rowid_t, SQLite::rowid_t>> Commands;
+        };
+
+        // Adds the manifest, using the cache for the values shared with other manifests.
+        // If deferredMappings is given, the rows of the mapping tables are added to it rather than inserted.
+        void AddManifestWithCache(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath, ValueIdCache& cache,
+            DeferredMappings* deferredMappings = nullptr);
+
+        // Adds the manifests to an empty index, inserting the rows of every table in the order of its key.
+        void AddManifestsInKeyOrder(SQLite::Connection& connection, const std::vector<std::pair<Manifest::Manifest, std::filesystem::path>>& manifests);
+
+        std::unique_ptr<SearchSnapshot> m_searchSnapshot;
+        bool m_searchResultsInMemory = false;
+        bool m_deferUnusedValueRemoval = false;
+
+        // The rowids of values added through this interface, so that values repeated across manifests are only looked up once.
+        // Cleared whenever values may be removed from the index.
+        ValueIdCache m_valueIdCache;
     };
 }
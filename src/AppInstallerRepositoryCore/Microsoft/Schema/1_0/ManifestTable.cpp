@@ -42,17 +42,17 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 
             builder.Limit(1);
 
-            SQLite::Statement select = builder.Prepare(connection);
+            SQLite::CachedStatement select = builder.PrepareCached(connection);
 
             int bindIndex = 0;
             for (const auto& id : ids)
             {
-                select.Bind(++bindIndex, id);
+                select->Bind(++bindIndex, id);
             }
 
-            if (select.Step())
+            if (select->Step())
             {
-                return select.GetColumn<SQLite::rowid_t>(0);
+                return select->GetColumn<SQLite::rowid_t>(0);
             }
             else
             {
@@ -60,7 +60,7 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             }
         }
 
-        SQLite::Statement ManifestTableGetIdsById_Statement(
+        SQLite::CachedStatement ManifestTableGetIdsById_Statement(
             SQLite::Connection& connection,
             SQLite::rowid_t id,
             std::initializer_list<std::string_view> values)
@@ -68,9 +68,9 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             SQLite::Builder::StatementBuilder builder;
             builder.Select(values).From(s_ManifestTable_Table_Name).Where(SQLite::RowIDName).Equals(id);
 
-            SQLite::Statement result = builder.Prepare(connection);
+            SQLite::CachedStatement result = builder.PrepareCached(connection);
 
-            THROW_HR_IF(E_NOT_SET, !result.Step());
+            THROW_HR_IF(E_NOT_SET, !result->Step());
 
             return result;
         }
@@ -80,7 +80,7 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         // SELECT [ids].[id] FROM [manifest]
         // JOIN [ids] ON [manifest].[id] = [ids].[rowid]
         // WHERE [manifest].[rowid] = 1
-        SQLite::Statement ManifestTableGetValuesById_Statement(
+        SQLite::CachedStatement ManifestTableGetValuesById_Statement(
             SQLite::Connection& connection,
             SQLite::rowid_t id,
             std::initializer_list<SQLite::Builder::QualifiedColumn> columns)
@@ -98,14 +98,14 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 
             builder.Where(QCol{ s_ManifestTable_Table_Name, SQLite::RowIDName }).Equals(id);
 
-            SQLite::Statement result = builder.Prepare(connection);
+            SQLite::CachedStatement result = builder.PrepareCached(connection);
 
-            THROW_HR_IF(E_NOT_SET, !result.Step());
+            THROW_HR_IF(E_NOT_SET, !result->Step());
 
             return result;
         }
 
-        SQLite::Statement ManifestTableGetAllValuesByIds_Statement(
+        SQLite::CachedStatement ManifestTableGetAllValuesByIds_Statement(
             SQLite::Connection& connection,
             std::initializer_list<SQLite::Builder::QualifiedColumn> valueColumns,
             std::initializer_list<std::string_view> idColumns,
@@ -138,12 +138,12 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
                 }
             }
 
-            SQLite::Statement select = builder.Prepare(connection);
+            SQLite::CachedStatement select = builder.PrepareCached(connection);
 
             int bindIndex = 0;
             for (const auto& id : ids)
             {
-                select.Bind(++bindIndex, id);
+                select->Bind(++bindIndex, id);
             }
 
             return select;
@@ -158,28 +158,56 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             auto select = ManifestTableGetAllValuesByIds_Statement(connection, valueColumns, idColumns, ids);
 
             std::vector<std::string> result;
-            while (select.Step())
+            while (select->Step())
             {
-                result.emplace_back(select.GetColumn<std::string>(0));
+                result.emplace_back(select->GetColumn<std::string>(0));
             }
             return result;
         }
 
-        int ManifestTableBuildSearchStatement(
+        SQLite::Statement ManifestTableGetAllValuesByIdIn_Statement(
+            SQLite::Connection& connection,
+            std::initializer_list<SQLite::Builder::QualifiedColumn> valueColumns,
+            std::string_view idColumn,
+            const std::vector<SQLite::rowid_t>& ids)
+        {
+            using QCol = SQLite::Builder::QualifiedColumn;
+
+            SQLite::Builder::StatementBuilder builder;
+            builder.Select().Column(QCol{ s_ManifestTable_Table_Name, idColumn });
+
+            for (const auto& valueColumn : valueColumns)
+            {
+                builder.Column(valueColumn);
+            }
+
+            builder.From(s_ManifestTable_Table_Name);
+
+            for (const auto& valueColumn : valueColumns)
+            {
+                builder.Join(valueColumn.Table).On(QCol{ s_ManifestTable_Table_Name, valueColumn.Column }, QCol{ valueColumn.Table, SQLite::RowIDName });
+            }
+
+            // The number of ids varies, so this is not worth caching.
+            builder.Where(QCol{ s_ManifestTable_Table_Name, idColumn }).In(ids);
+
+            return builder.Prepare(connection);
+        }
+
+        void ManifestTableBuildSearchSelect(
             SQLite::Builder::StatementBuilder& builder,
             const SQLite::Builder::QualifiedColumn& column,
             bool isOneToOne,
             std::string_view manifestAlias,
-            std::string_view valueAlias,
-            bool useLike)
+            std::string_view valueAlias)
         {
             using QCol = SQLite::Builder::QualifiedColumn;
 
             // Build a statement like:
-            //      SELECT manifest.rowid as m, ids.id as v from manifest join ids on manifest.id = ids.rowid where ids.id = <value>
+            //      SELECT manifest.rowid as m, ids.id as v from manifest join ids on manifest.id = ids.rowid
             // OR
             //      SELECT manifest.rowid as m, tags.tag as v from manifest join tags_map on manifest.rowid = tags_map.manifest
-            //      join tags on tags_map.tag = tags.rowid where tags.tag = <value>
+            //      join tags on tags_map.tag = tags.rowid
             builder.Select().
                 Column(QCol(s_ManifestTable_Table_Name, SQLite::RowIDName)).As(manifestAlias).
                 Column(column).As(valueAlias);
@@ -187,17 +215,29 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             if (isOneToOne)
             {
                 builder.From(s_ManifestTable_Table_Name).
-                    Join(column.Table).On(QCol(s_ManifestTable_Table_Name, column.Column), QCol(column.Table, SQLite::RowIDName)).
-                    Where(column);
+                    Join(column.Table).On(QCol(s_ManifestTable_Table_Name, column.Column), QCol(column.Table, SQLite::RowIDName));
             }
             else
             {
                 std::string mapTableName = details::OneToManyTableGetMapTableName(column.Table);
                 builder.From(s_ManifestTable_Table_Name).
                     Join(mapTableName).On(QCol(s_ManifestTable_Table_Name, SQLite::RowIDName), QCol(mapTableName, details::OneToManyTableGetManifestColumnName())).
-                    Join(column.Table).On(QCol(mapTableName, column.Column), QCol(column.Table, SQLite::RowIDName)).
-                    Where(column);
+                    Join(column.Table).On(QCol(mapTableName, column.Column), QCol(column.Table, SQLite::RowIDName));
             }
+        }
+
+        int ManifestTableBuildSearchStatement(
+            SQLite::Builder::StatementBuilder& builder,
+            const SQLite::Builder::QualifiedColumn& column,
+            bool isOneToOne,
+            std::string_view manifestAlias,
+            std::string_view valueAlias,
+            bool useLike)
+        {
+            // Build a statement like:
+            //      SELECT manifest.rowid as m, ids.id as v from manifest join ids on manifest.id = ids.rowid where ids.id = <value>
+            ManifestTableBuildSearchSelect(builder, column, isOneToOne, manifestAlias, valueAlias);
+            builder.Where(column);
 
             int result = 0;
             if (useLike)
@@ -259,14 +299,33 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         // Create an index on every value to improve performance
         for (const ManifestColumnInfo& value : values)
         {
-            StatementBuilder createIndexBuilder;
-            createIndexBuilder.CreateIndex({ s_ManifestTable_Table_Name, s_ManifestTable_Index_Separator, value.Name, s_ManifestTable_Index_Suffix }).
-                On(s_ManifestTable_Table_Name).Columns(value.Name);
+            CreateIndices(connection, { value.Name });
+        }
+
+        savepoint.Commit();
+    }
+
+    void ManifestTable::CreateIndices(SQLite::Connection& connection, std::initializer_list<std::string_view> values)
+    {
+        for (std::string_view value : values)
+        {
+            SQLite::Builder::StatementBuilder createIndexBuilder;
+            createIndexBuilder.CreateIndex({ s_ManifestTable_Table_Name, s_ManifestTable_Index_Separator, value, s_ManifestTable_Index_Suffix }).
+                On(s_ManifestTable_Table_Name).Columns(value);
 
             createIndexBuilder.Execute(connection);
         }
+    }
 
-        savepoint.Commit();
+    void ManifestTable::DropIndices(SQLite::Connection& connection, std::initializer_list<std::string_view> values)
+    {
+        for (std::string_view value : values)
+        {
+            SQLite::Builder::StatementBuilder dropIndexBuilder;
+            dropIndexBuilder.DropIndex({ s_ManifestTable_Table_Name, s_ManifestTable_Index_Separator, value, s_ManifestTable_Index_Suffix });
+
+            dropIndexBuilder.Execute(connection);
+        }
     }
 
     SQLite::rowid_t ManifestTable::Insert(SQLite::Connection& connection, std::initializer_list<ManifestOneToOneValue> values)
@@ -328,4 +387,20 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 
         return (countStatement.GetColumn<int>(0) == 0);
     }
+
+    std::vector<SQLite::rowid_t> ManifestTable::GetAllRowIds(SQLite::Connection& connection)
+    {
+        SQLite::Builder::StatementBuilder builder;
+        builder.Select(SQLite::RowIDName).From(s_ManifestTable_Table_Name).OrderBy(SQLite::RowIDName);
+
+        SQLite::Statement select = builder.Prepare(connection);
+
+        std::vector<SQLite::rowid_t> result;
+        while (select.Step())
+        {
+            result.push_back(select.GetColumn<SQLite::rowid_t>(0));
+        }
+
+        return result;
+    }
 }
@@ -20,19 +20,19 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             std::initializer_list<SQLite::rowid_t> ids);
 
         // Gets the requested ids for the manifest with the given rowid.
-        SQLite::Statement ManifestTableGetIdsById_Statement(
+        SQLite::CachedStatement ManifestTableGetIdsById_Statement(
             SQLite::Connection& connection,
             SQLite::rowid_t id,
             std::initializer_list<std::string_view> values);
 
         // Gets the requested values for the manifest with the given rowid.
-        SQLite::Statement ManifestTableGetValuesById_Statement(
+        SQLite::CachedStatement ManifestTableGetValuesById_Statement(
             SQLite::Connection& connection,
             SQLite::rowid_t id,
             std::initializer_list<SQLite::Builder::QualifiedColumn> columns);
 
         // Gets all values for rows that match the given ids.
-        SQLite::Statement ManifestTableGetAllValuesByIds_Statement(
+        SQLite::CachedStatement ManifestTableGetAllValuesByIds_Statement(
             SQLite::Connection& connection,
             std::initializer_list<SQLite::Builder::QualifiedColumn> valueColumns,
             std::initializer_list<std::string_view> idColumns,
@@ -45,6 +45,13 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             std::initializer_list<std::string_view> idColumns,
             std::initializer_list<SQLite::rowid_t> ids);
 
+        // Gets the id column, and all values, for rows whose id column is any of the given ids.
+        SQLite::Statement ManifestTableGetAllValuesByIdIn_Statement(
+            SQLite::Connection& connection,
+            std::initializer_list<SQLite::Builder::QualifiedColumn> valueColumns,
+            std::string_view idColumn,
+            const std::vector<SQLite::rowid_t>& ids);
+
         // Builds the search select statement base on the given values.
         int ManifestTableBuildSearchStatement(
             SQLite::Builder::StatementBuilder& builder,
@@ -54,6 +61,14 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             std::string_view valueAlias,
             bool useLike);
 
+        // Builds the select and joins of a search statement, leaving the caller to add the constraint.
+        void ManifestTableBuildSearchSelect(
+            SQLite::Builder::StatementBuilder& builder,
+            const SQLite::Builder::QualifiedColumn& column,
+            bool isOneToOne,
+            std::string_view manifestAlias,
+            std::string_view valueAlias);
+
         // Update the value of a single column for the manifest with the given rowid.
         void ManifestTableUpdateValueIdById(SQLite::Connection& connection, std::string_view valueName, SQLite::rowid_t value, SQLite::rowid_t id);
     }
@@ -82,6 +97,12 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         // Creates the table.
         static void Create(SQLite::Connection& connection, std::initializer_list<ManifestColumnInfo> values);
 
+        // Creates an index on each of the given columns.
+        static void CreateIndices(SQLite::Connection& connection, std::initializer_list<std::string_view> values);
+
+        // Drops the index on each of the given columns.
+        static void DropIndices(SQLite::Connection& connection, std::initializer_list<std::string_view> values);
+
         // Insert the given values into the table.
         static SQLite::rowid_t Insert(SQLite::Connection& connection, std::initializer_list<ManifestOneToOneValue> values);
 
@@ -97,14 +118,14 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         template <typename... Tables>
         static auto GetIdsById(SQLite::Connection& connection, SQLite::rowid_t id)
         {
-            return details::ManifestTableGetIdsById_Statement(connection, id, { Tables::ValueName()... }).GetRow<Tables::id_t...>();
+            return details::ManifestTableGetIdsById_Statement(connection, id, { Tables::ValueName()... })->GetRow<Tables::id_t...>();
         }
 
         // Gets the values requested for the manifest with the given rowid.
         template <typename... Tables>
         static auto GetValuesById(SQLite::Connection& connection, SQLite::rowid_t id)
         {
-            return details::ManifestTableGetValuesById_Statement(connection, id, { SQLite::Builder::QualifiedColumn{ Tables::TableName(), Tables::ValueName() }... }).GetRow<Tables::value_t...>();
+            return details::ManifestTableGetValuesById_Statement(connection, id, { SQLite::Builder::QualifiedColumn{ Tables::TableName(), Tables::ValueName() }... })->GetRow<Tables::value_t...>();
         }
 
         // Gets the values for rows that match the given ids.
@@ -120,9 +141,22 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         {
             auto stmt = details::ManifestTableGetAllValuesByIds_Statement(connection, { SQLite::Builder::QualifiedColumn{ ValueTables::TableName(), ValueTables::ValueName() }... }, { IdTable::ValueName() }, { id });
             std::vector<std::tuple<typename ValueTables::value_t...>> result;
+            while (stmt->Step())
+            {
+                result.emplace_back(stmt->GetRow<ValueTables::value_t...>());
+            }
+            return result;
+        }
+
+        // Gets all values for rows whose id is any of the given ids, each preceded by the id of the row.
+        template <typename IdTable, typename... ValueTables>
+        static std::vector<std::tuple<SQLite::rowid_t, typename ValueTables::value_t...>> GetAllValuesByIdIn(SQLite::Connection& connection, const std::vector<SQLite::rowid_t>& ids)
+        {
+            auto stmt = details::ManifestTableGetAllValuesByIdIn_Statement(connection, { SQLite::Builder::QualifiedColumn{ ValueTables::TableName(), ValueTables::ValueName() }... }, IdTable::ValueName(), ids);
+            std::vector<std::tuple<SQLite::rowid_t, typename ValueTables::value_t...>> result;
             while (stmt.Step())
             {
-                result.emplace_back(stmt.GetRow<ValueTables::value_t...>());
+                result.emplace_back(stmt.GetRow<SQLite::rowid_t, ValueTables::value_t...>());
             }
             return result;
         }
@@ -134,6 +168,14 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             return details::ManifestTableBuildSearchStatement(builder, SQLite::Builder::QualifiedColumn{ Table::TableName(), Table::ValueName() }, Table::IsOneToOne(), manifestAlias, valueAlias, useLike);
         }
 
+        // Builds the select and joins of a search statement for the value table, without any constraint on the values.
+        // The caller must add one, starting with a where clause.
+        template <typename Table>
+        static void BuildSearchSelect(SQLite::Builder::StatementBuilder& builder, std::string_view manifestAlias, std::string_view valueAlias)
+        {
+            details::ManifestTableBuildSearchSelect(builder, SQLite::Builder::QualifiedColumn{ Table::TableName(), Table::ValueName() }, Table::IsOneToOne(), manifestAlias, valueAlias);
+        }
+
         // Update the value of a single column for the manifest with the given rowid.
         template <typename Table>
         static void UpdateValueIdById(SQLite::Connection& connection, SQLite::rowid_t id, SQLite::rowid_t value)
@@ -149,5 +191,8 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 
         // Determines if the table is empty.
         static bool IsEmpty(SQLite::Connection& connection);
+
+        // Gets the rowids of all manifests, in rowid order.
+        static std::vector<SQLite::rowid_t> GetAllRowIds(SQLite::Connection& connection);
     };
 }
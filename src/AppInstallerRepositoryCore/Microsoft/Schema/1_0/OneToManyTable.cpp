@@ -10,11 +10,6 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 {
     namespace details
     {
-        using namespace std::string_view_literals;
-        static constexpr std::string_view s_OneToManyTable_MapTable_ManifestName = "manifest"sv;
-        static constexpr std::string_view s_OneToManyTable_MapTable_Suffix = "_map"sv;
-        static constexpr std::string_view s_OneToManyTable_MapTable_IndexSuffix = "_index"sv;
-
         namespace
         {
             // Create the mapping table insert statement for multiple use.
@@ -28,6 +23,26 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
                 return insertMappingBuilder.Prepare(connection);
             }
 
+            // Creates a mapping table with the given name.
+            void CreateMapTable(SQLite::Connection& connection, std::initializer_list<std::string_view> mapTableName, std::string_view valueName, bool mapTableWithoutRowID)
+            {
+                using namespace SQLite::Builder;
+
+                StatementBuilder createMapTableBuilder;
+                createMapTableBuilder.CreateTable(mapTableName).Columns({
+                    ColumnBuilder(s_OneToManyTable_MapTable_ManifestName, Type::Int64).NotNull(),
+                    ColumnBuilder(valueName, Type::Int64).NotNull(),
+                    PrimaryKeyBuilder({ valueName, s_OneToManyTable_MapTable_ManifestName })
+                    });
+
+                if (mapTableWithoutRowID)
+                {
+                    createMapTableBuilder.WithoutRowID();
+                }
+
+                createMapTableBuilder.Execute(connection);
+            }
+
             // Get a collection of the value ids associated with the given manifest id.
             std::vector<SQLite::rowid_t> GetValueIdsByManifestId(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, SQLite::rowid_t manifestId)
             {
@@ -96,61 +111,120 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             return s_OneToManyTable_MapTable_ManifestName;
         }
 
-        void CreateOneToManyTable(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName)
+        void CreateOneToManyTable(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, bool mapTableWithoutRowID)
         {
-            using namespace SQLite::Builder;
-
             SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, std::string{ tableName } + "_create_v1_0");
 
             // Create the data table as a 1:1
             CreateOneToOneTable(connection, tableName, valueName);
 
             // Create the mapping table
-            StatementBuilder createMapTableBuilder;
-            createMapTableBuilder.CreateTable({ tableName, s_OneToManyTable_MapTable_Suffix }).Columns({
-                ColumnBuilder(s_OneToManyTable_MapTable_ManifestName, Type::Int64).NotNull(),
-                ColumnBuilder(valueName, Type::Int64).NotNull(),
-                PrimaryKeyBuilder({ valueName, s_OneToManyTable_MapTable_ManifestName })
-                });
+            CreateMapTable(connection, { tableName, s_OneToManyTable_MapTable_Suffix }, valueName, mapTableWithoutRowID);
 
-            createMapTableBuilder.Execute(connection);
+            OneToManyTableCreateMapIndex(connection, tableName);
+
+            savepoint.Commit();
+        }
 
-            StatementBuilder createMapTableIndexBuilder;
+        void OneToManyTableCreateMapIndex(SQLite::Connection& connection, std::string_view tableName)
+        {
+            SQLite::Builder::StatementBuilder createMapTableIndexBuilder;
             createMapTableIndexBuilder.CreateIndex({ tableName, s_OneToManyTable_MapTable_Suffix, s_OneToManyTable_MapTable_IndexSuffix }).
                 On({ tableName, s_OneToManyTable_MapTable_Suffix }).Columns(s_OneToManyTable_MapTable_ManifestName);
 
             createMapTableIndexBuilder.Execute(connection);
+        }
+
+        void OneToManyTableDropMapIndex(SQLite::Connection& connection, std::string_view tableName)
+        {
+            SQLite::Builder::StatementBuilder dropMapTableIndexBuilder;
+            dropMapTableIndexBuilder.DropIndex({ tableName, s_OneToManyTable_MapTable_Suffix, s_OneToManyTable_MapTable_IndexSuffix });
+
+            dropMapTableIndexBuilder.Execute(connection);
+        }
+
+        void OneToManyTableRebuildMapTable(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, bool mapTableWithoutRowID)
+        {
+            SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, std::string{ tableName } + "_rebuildmap_v1_0");
+
+            std::string mapTableName = OneToManyTableGetMapTableName(tableName);
+            std::string rebuildTableName = mapTableName;
+            rebuildTableName += s_OneToManyTable_MapTable_RebuildSuffix;
+
+            CreateMapTable(connection, { mapTableName, s_OneToManyTable_MapTable_RebuildSuffix }, valueName, mapTableWithoutRowID);
+
+            std::ostringstream copyRows;
+            copyRows << "INSERT INTO [" << rebuildTableName << "] ([" << s_OneToManyTable_MapTable_ManifestName << "], [" << valueName << "]) SELECT [" <<
+                s_OneToManyTable_MapTable_ManifestName << "], [" << valueName << "] FROM [" << mapTableName << ']';
+            SQLite::Statement copyRowsStatement = SQLite::Statement::Create(connection, copyRows.str());
+            copyRowsStatement.Execute();
+
+            // Dropping the table also drops its index, which is created again on the rebuilt table
+            SQLite::Builder::StatementBuilder dropMapTableBuilder;
+            dropMapTableBuilder.DropTable(mapTableName);
+            dropMapTableBuilder.Execute(connection);
+
+            std::ostringstream renameTable;
+            renameTable << "ALTER TABLE [" << rebuildTableName << "] RENAME TO [" << mapTableName << ']';
+            SQLite::Statement renameTableStatement = SQLite::Statement::Create(connection, renameTable.str());
+            renameTableStatement.Execute();
+
+            OneToManyTableCreateMapIndex(connection, tableName);
 
             savepoint.Commit();
         }
 
         void OneToManyTableEnsureExistsAndInsert(SQLite::Connection& connection,
-            std::string_view tableName, std::string_view valueName,
-            const std::vector<Utility::NormalizedString>& values, SQLite::rowid_t manifestId)
+            const OneToOneTableStatements& table,
+            const std::vector<Utility::NormalizedString>& values, SQLite::rowid_t manifestId, ValueIdCache* cache)
         {
+            std::string_view tableName = table.TableName;
+            std::string_view valueName = table.ValueName;
+
             SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, std::string{ tableName } + "_ensureandinsert_v1_0");
 
-            SQLite::Statement insertMapping = CreateMappingInsertStatementForManifestId(connection, tableName, valueName, manifestId);
+            // The whole list of values is mapped with as few statements as possible
+            SQLite::Builder::BulkInsert<SQLite::rowid_t, SQLite::rowid_t> insertMapping{ connection,
+                { tableName, s_OneToManyTable_MapTable_Suffix }, { s_OneToManyTable_MapTable_ManifestName, valueName }, values.size() };
 
             for (const std::string& value : values)
             {
                 // First, ensure that the data exists
-                SQLite::rowid_t dataId = OneToOneTableEnsureExists(connection, tableName, valueName, value);
+                SQLite::rowid_t dataId = (cache ?
+                    OneToOneTableEnsureExists(connection, table, value, *cache) :
+                    OneToOneTableEnsureExists(connection, table, value));
 
-                // Second, insert into the mapping table
-                insertMapping.Reset();
-                insertMapping.Bind(2, dataId);
-
-                insertMapping.Execute();
+                // Second, add it to the rows for the mapping table
+                insertMapping.AddRow(manifestId, dataId);
             }
 
+            insertMapping.Execute();
+
             savepoint.Commit();
         }
 
+        void OneToManyTableInsertMappings(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName,
+            const std::vector<std::pair<SQLite::rowid_t, SQLite::rowid_t>>& valueAndManifestIds)
+        {
+            SQLite::Builder::BulkInsert<SQLite::rowid_t, SQLite::rowid_t> insertMapping{ connection,
+                { tableName, s_OneToManyTable_MapTable_Suffix }, { valueName, s_OneToManyTable_MapTable_ManifestName },
+                SQLite::Builder::BulkInsert<SQLite::rowid_t, SQLite::rowid_t>::MaximumValuesPerStatement };
+
+            for (const auto& [valueId, manifestId] : valueAndManifestIds)
+            {
+                insertMapping.AddRow(valueId, manifestId);
+            }
+
+            insertMapping.Execute();
+        }
+
         bool OneToManyTableUpdateIfNeededByManifestId(SQLite::Connection& connection,
-            std::string_view tableName, std::string_view valueName,
-            const std::vector<Utility::NormalizedString>& values, SQLite::rowid_t manifestId)
+            const OneToOneTableStatements& table,
+            const std::vector<Utility::NormalizedString>& values, SQLite::rowid_t manifestId, bool removeUnusedValues)
         {
+            std::string_view tableName = table.TableName;
+            std::string_view valueName = table.ValueName;
+
             std::vector<SQLite::rowid_t> oldValueIds = GetValueIdsByManifestId(connection, tableName, valueName, manifestId);
             bool modificationNeeded = false;
 
@@ -158,7 +232,7 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 
             for (const std::string& value : values)
             {
-                SQLite::rowid_t valueId = OneToOneTableEnsureExists(connection, tableName, valueName, value);
+                SQLite::rowid_t valueId = OneToOneTableEnsureExists(connection, table, value);
 
                 auto itr = std::find(oldValueIds.begin(), oldValueIds.end(), valueId);
                 if (itr != oldValueIds.end())
@@ -196,12 +270,31 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
                 deleteStatement.Execute();
 
                 // Second, delete the value itself if not needed
-                dvinns.Execute(valueId);
+                if (removeUnusedValues)
+                {
+                    dvinns.Execute(valueId);
+                }
             }
 
             return modificationNeeded;
         }
 
+        std::vector<std::string> OneToManyTableGetValuesByManifestId(SQLite::Connection& connection, std::string_view selectValuesByManifestId, SQLite::rowid_t manifestId)
+        {
+            SQLite::CachedStatement select = connection.GetStatementCache().Get(connection, selectValuesByManifestId);
+            select->Bind(1, manifestId);
+
+            std::vector<std::string> result;
+            while (select->Step())
+            {
+                result.emplace_back(select->GetColumn<std::string>(0));
+            }
+
+            std::sort(result.begin(), result.end());
+
+            return result;
+        }
+
         void OneToManyTableDeleteIfNotNeededByManifestId(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, SQLite::rowid_t manifestId)
         {
             SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, std::string{ tableName } + "_deleteifnotneeded_v1_0");
@@ -226,6 +319,22 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             savepoint.Commit();
         }
 
+        void OneToManyTableDeleteMappingsByManifestId(SQLite::Connection& connection, std::string_view tableName, SQLite::rowid_t manifestId)
+        {
+            SQLite::Builder::StatementBuilder deleteBuilder;
+            deleteBuilder.DeleteFrom({ tableName, s_OneToManyTable_MapTable_Suffix }).Where(s_OneToManyTable_MapTable_ManifestName).Equals(manifestId);
+
+            deleteBuilder.Execute(connection);
+        }
+
+        void OneToManyTableRemoveUnused(SQLite::Connection& connection, std::string_view tableName, std::string_view deleteUnused)
+        {
+            SQLite::Statement deleteStatement = SQLite::Statement::Create(connection, deleteUnused);
+            deleteStatement.Execute();
+
+            AICLI_LOG(Repo, Verbose, << "Removed " << connection.GetChanges() << " unused values from " << tableName);
+        }
+
         void OneToManyTablePrepareForPackaging(SQLite::Connection& connection, std::string_view tableName)
         {
             SQLite::Builder::StatementBuilder dropMapTableIndexBuilder;
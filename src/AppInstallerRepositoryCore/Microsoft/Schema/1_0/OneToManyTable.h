@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 #pragma once
 #include "SQLiteWrapper.h"
+#include "Microsoft/Schema/1_0/OneToOneTable.h"
 #include <string>
 #include <string_view>
 #include <vector>
@@ -11,6 +12,27 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 {
     namespace details
     {
+        using namespace std::string_view_literals;
+        static constexpr std::string_view s_OneToManyTable_MapTable_ManifestName = "manifest"sv;
+        static constexpr std::string_view s_OneToManyTable_MapTable_Suffix = "_map"sv;
+        static constexpr std::string_view s_OneToManyTable_MapTable_IndexSuffix = "_index"sv;
+        static constexpr std::string_view s_OneToManyTable_MapTable_RebuildSuffix = "_rebuild"sv;
+
+        // The statements of the mapping table of the table described by the TableInfo, with their text joined at compile time.
+        template <typename TableInfo>
+        struct OneToManyTableStatementsFor
+        {
+            // Bind the manifest rowid to 1.
+            static constexpr auto SelectValuesByManifestId = AICLI_SQLITE_STATIC_SQL(
+                "SELECT [", TableInfo::TableName(), "].[", TableInfo::ValueName(), "] FROM [", TableInfo::TableName(), s_OneToManyTable_MapTable_Suffix,
+                "] JOIN [", TableInfo::TableName(), "] ON [", TableInfo::TableName(), s_OneToManyTable_MapTable_Suffix, "].[", TableInfo::ValueName(),
+                "] = [", TableInfo::TableName(), "].[rowid] WHERE [", TableInfo::TableName(), s_OneToManyTable_MapTable_Suffix, "].[",
+                s_OneToManyTable_MapTable_ManifestName, "] = ?");
+            static constexpr auto DeleteUnused = AICLI_SQLITE_STATIC_SQL(
+                "DELETE FROM [", TableInfo::TableName(), "] WHERE [rowid] NOT IN (SELECT [", TableInfo::ValueName(), "] FROM [",
+                TableInfo::TableName(), s_OneToManyTable_MapTable_Suffix, "])");
+        };
+
         // Returns the map table name for a given table.
         std::string OneToManyTableGetMapTableName(std::string_view tableName);
 
@@ -18,21 +40,46 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         std::string_view OneToManyTableGetManifestColumnName();
 
         // Create the tables.
-        void CreateOneToManyTable(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName);
+        // A mapping table without a rowid stores its rows only in its { value, manifest } primary key.
+        void CreateOneToManyTable(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, bool mapTableWithoutRowID = false);
 
         // Ensures that the value exists and inserts mapping entries.
         void OneToManyTableEnsureExistsAndInsert(SQLite::Connection& connection,
-            std::string_view tableName, std::string_view valueName, 
-            const std::vector<Utility::NormalizedString>& values, SQLite::rowid_t manifestId);
+            const OneToOneTableStatements& table,
+            const std::vector<Utility::NormalizedString>& values, SQLite::rowid_t manifestId, ValueIdCache* cache = nullptr);
+
+        // Inserts the mapping entries, given as pairs of { value rowid, manifest rowid }, with as few statements as possible.
+        void OneToManyTableInsertMappings(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName,
+            const std::vector<std::pair<SQLite::rowid_t, SQLite::rowid_t>>& valueAndManifestIds);
+
+        // Creates the index on the manifest column of the mapping table.
+        void OneToManyTableCreateMapIndex(SQLite::Connection& connection, std::string_view tableName);
+
+        // Drops the index on the manifest column of the mapping table.
+        void OneToManyTableDropMapIndex(SQLite::Connection& connection, std::string_view tableName);
+
+        // Recreates the mapping table with the given layout, copying its rows with a single statement.
+        void OneToManyTableRebuildMapTable(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, bool mapTableWithoutRowID);
 
         // Updates the mapping table to represent the given values for the manifest.
+        // Values that are no longer mapped are only removed if removeUnusedValues is true.
         bool OneToManyTableUpdateIfNeededByManifestId(SQLite::Connection& connection,
-            std::string_view tableName, std::string_view valueName,
-            const std::vector<Utility::NormalizedString>& values, SQLite::rowid_t manifestId);
+            const OneToOneTableStatements& table,
+            const std::vector<Utility::NormalizedString>& values, SQLite::rowid_t manifestId, bool removeUnusedValues = true);
+
+        // Gets the values mapped to the given manifest, sorted.
+        // The select statement must be OneToManyTableStatementsFor::SelectValuesByManifestId for the table.
+        std::vector<std::string> OneToManyTableGetValuesByManifestId(SQLite::Connection& connection, std::string_view selectValuesByManifestId, SQLite::rowid_t manifestId);
 
         // Deletes the mapping rows for the given manifest, then removes any unused data rows.
         void OneToManyTableDeleteIfNotNeededByManifestId(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, SQLite::rowid_t manifestId);
 
+        // Deletes the mapping rows for the given manifest, leaving the data rows.
+        void OneToManyTableDeleteMappingsByManifestId(SQLite::Connection& connection, std::string_view tableName, SQLite::rowid_t manifestId);
+
+        // Removes every data row that is not mapped to a manifest, using the DeleteUnused statement of the table.
+        void OneToManyTableRemoveUnused(SQLite::Connection& connection, std::string_view tableName, std::string_view deleteUnused);
+
         // Removes data that is no longer needed for an index that is to be published.
         void OneToManyTablePrepareForPackaging(SQLite::Connection& connection, std::string_view tableName);
 
@@ -63,21 +110,60 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         }
 
         // Creates the table.
-        static void Create(SQLite::Connection& connection)
+        static void Create(SQLite::Connection& connection, bool mapTableWithoutRowID = false)
         {
-            details::CreateOneToManyTable(connection, TableInfo::TableName(), TableInfo::ValueName());
+            details::CreateOneToManyTable(connection, TableInfo::TableName(), TableInfo::ValueName(), mapTableWithoutRowID);
         }
 
         // Ensures that all values exist in the data table, and inserts into the mapping table for the given manifest id.
         static void EnsureExistsAndInsert(SQLite::Connection& connection, const std::vector<Utility::NormalizedString>& values, SQLite::rowid_t manifestId)
         {
-            details::OneToManyTableEnsureExistsAndInsert(connection, TableInfo::TableName(), TableInfo::ValueName(), values, manifestId);
+            details::OneToManyTableEnsureExistsAndInsert(connection, details::OneToOneTableStatementsFor<TableInfo>::Value, values, manifestId);
+        }
+
+        // Ensures that all values exist in the data table, and inserts into the mapping table for the given manifest id.
+        // The cache is consulted first for the data values, and updated with the results.
+        static void EnsureExistsAndInsert(SQLite::Connection& connection, const std::vector<Utility::NormalizedString>& values, SQLite::rowid_t manifestId, ValueIdCache& cache)
+        {
+            details::OneToManyTableEnsureExistsAndInsert(connection, details::OneToOneTableStatementsFor<TableInfo>::Value, values, manifestId, &cache);
+        }
+
+        // Ensures that the value exists in the data table, without mapping it to a manifest.
+        static SQLite::rowid_t EnsureExists(SQLite::Connection& connection, std::string_view value, ValueIdCache& cache)
+        {
+            return details::OneToOneTableEnsureExists(connection, details::OneToOneTableStatementsFor<TableInfo>::Value, value, cache);
+        }
+
+        // Inserts into the mapping table, given pairs of { value rowid, manifest rowid }.
+        // When the table is keyed on its values, sorting the pairs first lets each row be appended to it.
+        static void InsertMappings(SQLite::Connection& connection, const std::vector<std::pair<SQLite::rowid_t, SQLite::rowid_t>>& valueAndManifestIds)
+        {
+            details::OneToManyTableInsertMappings(connection, TableInfo::TableName(), TableInfo::ValueName(), valueAndManifestIds);
+        }
+
+        // Creates the secondary indices of the table; these are not needed to add values.
+        static void CreateIndices(SQLite::Connection& connection)
+        {
+            details::OneToManyTableCreateMapIndex(connection, TableInfo::TableName());
+        }
+
+        // Drops the secondary indices of the table; these are not needed to add values.
+        static void DropIndices(SQLite::Connection& connection)
+        {
+            details::OneToManyTableDropMapIndex(connection, TableInfo::TableName());
         }
 
         // Updates the mapping table to represent the given values for the manifest.
-        static bool UpdateIfNeededByManifestId(SQLite::Connection& connection, const std::vector<Utility::NormalizedString>& values, SQLite::rowid_t manifestId)
+        // Values that are no longer mapped are only removed if removeUnusedValues is true; otherwise RemoveUnused must be called later.
+        static bool UpdateIfNeededByManifestId(SQLite::Connection& connection, const std::vector<Utility::NormalizedString>& values, SQLite::rowid_t manifestId, bool removeUnusedValues = true)
+        {
+            return details::OneToManyTableUpdateIfNeededByManifestId(connection, details::OneToOneTableStatementsFor<TableInfo>::Value, values, manifestId, removeUnusedValues);
+        }
+
+        // Gets the values mapped to the given manifest, sorted.
+        static std::vector<std::string> GetValuesByManifestId(SQLite::Connection& connection, SQLite::rowid_t manifestId)
         {
-            return details::OneToManyTableUpdateIfNeededByManifestId(connection, TableInfo::TableName(), TableInfo::ValueName(), values, manifestId);
+            return details::OneToManyTableGetValuesByManifestId(connection, details::OneToManyTableStatementsFor<TableInfo>::SelectValuesByManifestId.View(), manifestId);
         }
 
         // Deletes the mapping rows for the given manifest, then removes any unused data rows.
@@ -86,6 +172,24 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             details::OneToManyTableDeleteIfNotNeededByManifestId(connection, TableInfo::TableName(), TableInfo::ValueName(), manifestId);
         }
 
+        // Deletes the mapping rows for the given manifest, leaving the data rows for RemoveUnused.
+        static void DeleteMappingsByManifestId(SQLite::Connection& connection, SQLite::rowid_t manifestId)
+        {
+            details::OneToManyTableDeleteMappingsByManifestId(connection, TableInfo::TableName(), manifestId);
+        }
+
+        // Removes every data row that is no longer mapped, in a single statement.
+        static void RemoveUnused(SQLite::Connection& connection)
+        {
+            details::OneToManyTableRemoveUnused(connection, TableInfo::TableName(), details::OneToManyTableStatementsFor<TableInfo>::DeleteUnused.View());
+        }
+
+        // Recreates the mapping table with the given layout, as Create would have made it, keeping all of its rows.
+        static void RebuildMapTable(SQLite::Connection& connection, bool mapTableWithoutRowID)
+        {
+            details::OneToManyTableRebuildMapTable(connection, TableInfo::TableName(), TableInfo::ValueName(), mapTableWithoutRowID);
+        }
+
         // Removes data that is no longer needed for an index that is to be published.
         static void PrepareForPackaging(SQLite::Connection& connection)
         {
@@ -8,6 +8,60 @@
 
 namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 {
+    std::optional<SQLite::rowid_t> ValueIdCache::Find(std::string_view tableName, std::string_view value) const
+    {
+        auto tableItr = m_tables.find(tableName);
+        if (tableItr == m_tables.end())
+        {
+            return {};
+        }
+
+        auto valueItr = tableItr->second.find(std::string{ value });
+        if (valueItr == tableItr->second.end())
+        {
+            return {};
+        }
+
+        return valueItr->second;
+    }
+
+    void ValueIdCache::Add(std::string_view tableName, std::string_view value, SQLite::rowid_t id)
+    {
+        m_tables[tableName][std::string{ value }] = id;
+    }
+
+    std::optional<SQLite::rowid_t> ValueIdCache::FindPathPart(std::optional<SQLite::rowid_t> parent, std::string_view part) const
+    {
+        auto itr = m_pathParts.find(std::make_pair(parent.value_or(0), std::string{ part }));
+        if (itr == m_pathParts.end())
+        {
+            return {};
+        }
+
+        return itr->second;
+    }
+
+    void ValueIdCache::AddPathPart(std::optional<SQLite::rowid_t> parent, std::string_view part, SQLite::rowid_t id)
+    {
+        m_pathParts[std::make_pair(parent.value_or(0), std::string{ part })] = id;
+    }
+
+    void ValueIdCache::Clear()
+    {
+        m_tables.clear();
+        m_pathParts.clear();
+    }
+
+    void ValueIdCache::Validate(const SQLite::Connection& connection)
+    {
+        if (m_rollbackCount != connection.GetRollbackCount())
+        {
+            AICLI_LOG(Repo, Verbose, << "Clearing value id cache after changes were rolled back");
+            Clear();
+            m_rollbackCount = connection.GetRollbackCount();
+        }
+    }
+
     namespace details
     {
         void CreateOneToOneTable(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName)
@@ -22,25 +76,23 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             createTableBuilder.Execute(connection);
         }
 
-        std::optional<SQLite::rowid_t> OneToOneTableSelectIdByValue(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, std::string_view value, bool useLike)
+        std::optional<SQLite::rowid_t> OneToOneTableSelectIdByValue(SQLite::Connection& connection, const OneToOneTableStatements& table, std::string_view value, bool useLike)
         {
-            SQLite::Builder::StatementBuilder selectBuilder;
-            selectBuilder.Select(SQLite::RowIDName).From(tableName).Where(valueName);
+            SQLite::CachedStatement select = connection.GetStatementCache().Get(connection, (useLike ? table.SelectIdByValueLike : table.SelectIdByValue));
 
             if (useLike)
             {
-                selectBuilder.LikeWithEscape(value);
+                select->Bind(1, SQLite::EscapeStringForLike(value));
+                select->Bind(2, SQLite::EscapeCharForLike);
             }
             else
             {
-                selectBuilder.Equals(value);
+                select->Bind(1, value);
             }
 
-            SQLite::Statement select = selectBuilder.Prepare(connection);
-
-            if (select.Step())
+            if (select->Step())
             {
-                return select.GetColumn<SQLite::rowid_t>(0);
+                return select->GetColumn<SQLite::rowid_t>(0);
             }
             else
             {
@@ -48,16 +100,14 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             }
         }
 
-        std::optional<std::string> OneToOneTableSelectValueById(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, SQLite::rowid_t id)
+        std::optional<std::string> OneToOneTableSelectValueById(SQLite::Connection& connection, const OneToOneTableStatements& table, SQLite::rowid_t id)
         {
-            SQLite::Builder::StatementBuilder selectBuilder;
-            selectBuilder.Select(valueName).From(tableName).Where(SQLite::RowIDName).Equals(id);
-
-            SQLite::Statement select = selectBuilder.Prepare(connection);
+            SQLite::CachedStatement select = connection.GetStatementCache().Get(connection, table.SelectValueById);
+            select->Bind(1, id);
 
-            if (select.Step())
+            if (select->Step())
             {
-                return select.GetColumn<std::string>(0);
+                return select->GetColumn<std::string>(0);
             }
             else
             {
@@ -85,64 +135,122 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             return result;
         }
 
-        SQLite::rowid_t OneToOneTableEnsureExists(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, std::string_view value, bool overwriteLikeMatch)
+        SQLite::rowid_t OneToOneTableEnsureExists(SQLite::Connection& connection, const OneToOneTableStatements& table, std::string_view value, bool overwriteLikeMatch)
         {
-            auto selectResult = OneToOneTableSelectIdByValue(connection, tableName, valueName, value, overwriteLikeMatch);
+            auto selectResult = OneToOneTableSelectIdByValue(connection, table, value, overwriteLikeMatch);
             if (selectResult)
             {
                 if (overwriteLikeMatch)
                 {
                     // If the value in the table is not an exact match, overwrite it with the incoming value
-                    auto tableValue = OneToOneTableSelectValueById(connection, tableName, valueName, selectResult.value());
+                    auto tableValue = OneToOneTableSelectValueById(connection, table, selectResult.value());
                     if (tableValue.value() != value)
                     {
-                        SQLite::Builder::StatementBuilder updateBuilder;
-                        updateBuilder.Update(tableName).Set().Column(valueName).Equals(value).Where(SQLite::RowIDName).Equals(selectResult);
+                        SQLite::CachedStatement update = connection.GetStatementCache().Get(connection, table.UpdateValueById);
+                        update->Bind(1, value);
+                        update->Bind(2, selectResult.value());
 
-                        updateBuilder.Execute(connection);
+                        update->Execute();
                     }
                 }
 
                 return selectResult.value();
             }
 
-            SQLite::Builder::StatementBuilder insertBuilder;
-            insertBuilder.InsertInto(tableName).Columns(valueName).Values(value);
+            SQLite::CachedStatement insert = connection.GetStatementCache().Get(connection, table.Insert);
+            insert->Bind(1, value);
 
-            insertBuilder.Execute(connection);
+            insert->Execute();
 
             return connection.GetLastInsertRowID();
         }
 
-        void OneToOneTableDeleteIfNotNeededById(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, SQLite::rowid_t id)
+        SQLite::rowid_t OneToOneTableEnsureExists(SQLite::Connection& connection, const OneToOneTableStatements& table, std::string_view value, ValueIdCache& cache)
+        {
+            std::optional<SQLite::rowid_t> cachedId = cache.Find(table.TableName, value);
+            if (cachedId)
+            {
+                return cachedId.value();
+            }
+
+            std::optional<SQLite::rowid_t> result;
+
+            if (SQLite::IsReturningSupported())
+            {
+                SQLite::CachedStatement insert = connection.GetStatementCache().Get(connection, table.InsertIfMissing);
+                insert->Bind(1, value);
+
+                int stepResult = insert->TryStep();
+                if (stepResult == SQLITE_ROW)
+                {
+                    result = insert->GetColumn<SQLite::rowid_t>(0);
+                }
+                else if (stepResult != SQLITE_DONE)
+                {
+                    THROW_SQLITE(stepResult);
+                }
+            }
+            else
+            {
+                SQLite::CachedStatement insert = connection.GetStatementCache().Get(connection, table.Insert);
+                insert->Bind(1, value);
+
+                int stepResult = insert->TryExecute();
+                if (stepResult == SQLITE_DONE)
+                {
+                    result = connection.GetLastInsertRowID();
+                }
+                else if (stepResult != SQLITE_CONSTRAINT_PRIMARYKEY && stepResult != SQLITE_CONSTRAINT_UNIQUE)
+                {
+                    THROW_SQLITE(stepResult);
+                }
+            }
+
+            if (!result)
+            {
+                // The value was already in the table
+                result = OneToOneTableSelectIdByValue(connection, table, value);
+                THROW_HR_IF(E_UNEXPECTED, !result);
+            }
+
+            cache.Add(table.TableName, value, result.value());
+            return result.value();
+        }
+
+        void OneToOneTableDeleteIfNotNeededById(SQLite::Connection& connection, const OneToOneTableStatements& table, SQLite::rowid_t id)
         {
             // If a manifest is found that references this id, then we are done.
-            if (ManifestTableSelectByValueIds(connection, { valueName }, { id }))
+            if (ManifestTableSelectByValueIds(connection, { table.ValueName }, { id }))
             {
                 return;
             }
 
-            SQLite::Builder::StatementBuilder builder;
-            builder.DeleteFrom(tableName).Where(SQLite::RowIDName).Equals(id);
+            SQLite::CachedStatement deleteStatement = connection.GetStatementCache().Get(connection, table.DeleteById);
+            deleteStatement->Bind(1, id);
 
-            builder.Execute(connection);
+            deleteStatement->Execute();
         }
 
-        uint64_t OneToOneTableGetCount(SQLite::Connection& connection, std::string_view tableName)
+        void OneToOneTableRemoveUnused(SQLite::Connection& connection, std::string_view tableName, std::string_view deleteUnused)
         {
-            SQLite::Builder::StatementBuilder builder;
-            builder.Select(SQLite::Builder::RowCount).From(tableName);
+            SQLite::Statement deleteStatement = SQLite::Statement::Create(connection, deleteUnused);
+            deleteStatement.Execute();
+
+            AICLI_LOG(Repo, Verbose, << "Removed " << connection.GetChanges() << " unused values from " << tableName);
+        }
 
-            SQLite::Statement countStatement = builder.Prepare(connection);
+        uint64_t OneToOneTableGetCount(SQLite::Connection& connection, const OneToOneTableStatements& table)
+        {
+            SQLite::CachedStatement countStatement = connection.GetStatementCache().Get(connection, table.Count);
 
-            THROW_HR_IF(E_UNEXPECTED, !countStatement.Step());
+            THROW_HR_IF(E_UNEXPECTED, !countStatement->Step());
 
-            return static_cast<uint64_t>(countStatement.GetColumn<SQLite::rowid_t>(0));
+            return static_cast<uint64_t>(countStatement->GetColumn<SQLite::rowid_t>(0));
         }
 
-        bool OneToOneTableIsEmpty(SQLite::Connection& connection, std::string_view tableName)
+        bool OneToOneTableIsEmpty(SQLite::Connection& connection, const OneToOneTableStatements& table)
         {
-            return (OneToOneTableGetCount(connection, tableName) == 0);
+            return (OneToOneTableGetCount(connection, table) == 0);
         }
     }
 }
@@ -2,39 +2,148 @@
 // Licensed under the MIT License.
 #pragma once
 #include "SQLiteWrapper.h"
+#include "SQLiteStatementBuilder.h"
+#include <map>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 
 namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 {
+    // A cache of the rowids of values in the data tables, for use while adding to the index.
+    // A cached rowid remains valid until a value is removed from the index or changes are rolled back;
+    // the owner must clear the cache when removing values, and validate it against the connection before use.
+    struct ValueIdCache
+    {
+        // Gets the rowid of the value in the table, if it has been cached.
+        std::optional<SQLite::rowid_t> Find(std::string_view tableName, std::string_view value) const;
+
+        // Caches the rowid of the value in the table.
+        void Add(std::string_view tableName, std::string_view value, SQLite::rowid_t id);
+
+        // Gets the rowid of the path part with the given parent, if it has been cached.
+        std::optional<SQLite::rowid_t> FindPathPart(std::optional<SQLite::rowid_t> parent, std::string_view part) const;
+
+        // Caches the rowid of the path part with the given parent.
+        void AddPathPart(std::optional<SQLite::rowid_t> parent, std::string_view part, SQLite::rowid_t id);
+
+        // Removes all cached values.
+        void Clear();
+
+        // Clears the cache if any changes have been rolled back on the connection since the last time it was validated.
+        void Validate(const SQLite::Connection& connection);
+
+    private:
+        // Table names are always the constants from the table info types, so a view is sufficient.
+        std::map<std::string_view, std::unordered_map<std::string, SQLite::rowid_t>> m_tables;
+        // Keyed on { parent, part }, where the parent of a root part is 0 as SQLite never assigns it as a rowid.
+        std::map<std::pair<SQLite::rowid_t, std::string>, SQLite::rowid_t> m_pathParts;
+        uint64_t m_rollbackCount = 0;
+    };
+
     namespace details
     {
+        using namespace std::string_view_literals;
+
+        // The name of the manifest table, whose columns hold the rowids of the values.
+        static constexpr std::string_view s_OneToOneTable_ManifestTable_Name = "manifest"sv;
+
+        // The names of a table with a single value and the text of its statements, which only depend on the names.
+        struct OneToOneTableStatements
+        {
+            std::string_view TableName;
+            std::string_view ValueName;
+            // Bind the value to 1.
+            std::string_view SelectIdByValue;
+            // Bind the escaped value to 1 and the escape character to 2.
+            std::string_view SelectIdByValueLike;
+            // Bind the rowid to 1.
+            std::string_view SelectValueById;
+            // Bind the value to 1.
+            std::string_view Insert;
+            // Bind the value to 1; returns the rowid if the value was inserted, and no row if it was already present.
+            // Requires support for RETURNING, see SQLite::IsReturningSupported.
+            std::string_view InsertIfMissing;
+            // Bind the value to 1 and the rowid to 2.
+            std::string_view UpdateValueById;
+            // Bind the rowid to 1.
+            std::string_view DeleteById;
+            std::string_view Count;
+        };
+
+        // The statements of the table described by the TableInfo, with their text joined at compile time.
+        template <typename TableInfo>
+        struct OneToOneTableStatementsFor
+        {
+            static constexpr auto SelectIdByValue = AICLI_SQLITE_STATIC_SQL(
+                "SELECT [rowid] FROM [", TableInfo::TableName(), "] WHERE [", TableInfo::ValueName(), "] = ?");
+            static constexpr auto SelectIdByValueLike = AICLI_SQLITE_STATIC_SQL(
+                "SELECT [rowid] FROM [", TableInfo::TableName(), "] WHERE [", TableInfo::ValueName(), "] LIKE ? ESCAPE ?");
+            static constexpr auto SelectValueById = AICLI_SQLITE_STATIC_SQL(
+                "SELECT [", TableInfo::ValueName(), "] FROM [", TableInfo::TableName(), "] WHERE [rowid] = ?");
+            static constexpr auto Insert = AICLI_SQLITE_STATIC_SQL(
+                "INSERT INTO [", TableInfo::TableName(), "] ([", TableInfo::ValueName(), "]) VALUES (?)");
+            static constexpr auto InsertIfMissing = AICLI_SQLITE_STATIC_SQL(
+                "INSERT INTO [", TableInfo::TableName(), "] ([", TableInfo::ValueName(), "]) VALUES (?) ON CONFLICT DO NOTHING RETURNING [rowid]");
+            static constexpr auto UpdateValueById = AICLI_SQLITE_STATIC_SQL(
+                "UPDATE [", TableInfo::TableName(), "] SET [", TableInfo::ValueName(), "] = ? WHERE [rowid] = ?");
+            static constexpr auto DeleteById = AICLI_SQLITE_STATIC_SQL(
+                "DELETE FROM [", TableInfo::TableName(), "] WHERE [rowid] = ?");
+            static constexpr auto Count = AICLI_SQLITE_STATIC_SQL(
+                "SELECT COUNT(*) FROM [", TableInfo::TableName(), "]");
+            // Only valid for a table that has a column in the manifest table.
+            static constexpr auto DeleteUnused = AICLI_SQLITE_STATIC_SQL(
+                "DELETE FROM [", TableInfo::TableName(), "] WHERE [rowid] NOT IN (SELECT [", TableInfo::ValueName(), "] FROM [", s_OneToOneTable_ManifestTable_Name, "])");
+
+            static constexpr OneToOneTableStatements Value{
+                TableInfo::TableName(),
+                TableInfo::ValueName(),
+                SelectIdByValue.View(),
+                SelectIdByValueLike.View(),
+                SelectValueById.View(),
+                Insert.View(),
+                InsertIfMissing.View(),
+                UpdateValueById.View(),
+                DeleteById.View(),
+                Count.View(),
+            };
+        };
+
         // Creates the table.
         void CreateOneToOneTable(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName);
 
         // Selects the value from the table, returning the rowid if it exists.
-        std::optional<SQLite::rowid_t> OneToOneTableSelectIdByValue(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, std::string_view value, bool useLike = false);
+        std::optional<SQLite::rowid_t> OneToOneTableSelectIdByValue(SQLite::Connection& connection, const OneToOneTableStatements& table, std::string_view value, bool useLike = false);
 
         // Selects the value from the table, returning the rowid if it exists.
-        std::optional<std::string> OneToOneTableSelectValueById(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, SQLite::rowid_t id);
+        std::optional<std::string> OneToOneTableSelectValueById(SQLite::Connection& connection, const OneToOneTableStatements& table, SQLite::rowid_t id);
 
         // Gets all row ids from the table.
         std::vector<SQLite::rowid_t> OneToOneTableGetAllRowIds(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, size_t limit);
 
         // Ensures that the values exists in the table.
-        SQLite::rowid_t OneToOneTableEnsureExists(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, std::string_view value, bool overwriteLikeMatch = false);
+        SQLite::rowid_t OneToOneTableEnsureExists(SQLite::Connection& connection, const OneToOneTableStatements& table, std::string_view value, bool overwriteLikeMatch = false);
+
+        // Ensures that the values exists in the table, using the cache to avoid looking up values that have already been seen.
+        // As the cache holds the values seen before, one that is not in it is inserted without looking it up first; a value
+        // already in the table is then found from the conflict, which is reported by status rather than by an exception.
+        SQLite::rowid_t OneToOneTableEnsureExists(SQLite::Connection& connection, const OneToOneTableStatements& table, std::string_view value, ValueIdCache& cache);
 
         // Removes the given row by its rowid if it is no longer referenced.
-        void OneToOneTableDeleteIfNotNeededById(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, SQLite::rowid_t id);
+        void OneToOneTableDeleteIfNotNeededById(SQLite::Connection& connection, const OneToOneTableStatements& table, SQLite::rowid_t id);
+
+        // Removes every row that is not referenced by a manifest, using the DeleteUnused statement of the table.
+        void OneToOneTableRemoveUnused(SQLite::Connection& connection, std::string_view tableName, std::string_view deleteUnused);
 
         // Gets the total number of rows in the table.
-        uint64_t OneToOneTableGetCount(SQLite::Connection& connection, std::string_view tableName);
+        uint64_t OneToOneTableGetCount(SQLite::Connection& connection, const OneToOneTableStatements& table);
 
         // Determines if the table is empty.
-        bool OneToOneTableIsEmpty(SQLite::Connection& connection, std::string_view tableName);
+        bool OneToOneTableIsEmpty(SQLite::Connection& connection, const OneToOneTableStatements& table);
     }
 
     // A table that represents a value that is 1:1 with a primary entry.
@@ -71,16 +180,22 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             return true;
         }
 
+        // The statements of the table.
+        static constexpr const details::OneToOneTableStatements& Statements()
+        {
+            return details::OneToOneTableStatementsFor<TableInfo>::Value;
+        }
+
         // Selects the value from the table, returning the rowid if it exists.
         static std::optional<SQLite::rowid_t> SelectIdByValue(SQLite::Connection& connection, std::string_view value, bool useLike = false)
         {
-            return details::OneToOneTableSelectIdByValue(connection, TableInfo::TableName(), TableInfo::ValueName(), value, useLike);
+            return details::OneToOneTableSelectIdByValue(connection, Statements(), value, useLike);
         }
 
         // Selects the value from the table, returning it if it exists.
         static std::optional<value_t> SelectValueById(SQLite::Connection& connection, id_t id)
         {
-            return details::OneToOneTableSelectValueById(connection, TableInfo::TableName(), TableInfo::ValueName(), id);
+            return details::OneToOneTableSelectValueById(connection, Statements(), id);
         }
 
         // Gets all row ids from the table.
@@ -92,13 +207,26 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         // Ensures that the given value exists in the table, returning the rowid.
         static SQLite::rowid_t EnsureExists(SQLite::Connection& connection, std::string_view value, bool overwriteLikeMatch = false)
         {
-            return details::OneToOneTableEnsureExists(connection, TableInfo::TableName(), TableInfo::ValueName(), value, overwriteLikeMatch);
+            return details::OneToOneTableEnsureExists(connection, Statements(), value, overwriteLikeMatch);
+        }
+
+        // Ensures that the given value exists in the table, returning the rowid.
+        // The cache is consulted first, and updated with the result.
+        static SQLite::rowid_t EnsureExists(SQLite::Connection& connection, std::string_view value, ValueIdCache& cache)
+        {
+            return details::OneToOneTableEnsureExists(connection, Statements(), value, cache);
         }
 
         // Removes the given row by its rowid if it is no longer referenced.
         static void DeleteIfNotNeededById(SQLite::Connection& connection, SQLite::rowid_t id)
         {
-            return details::OneToOneTableDeleteIfNotNeededById(connection, TableInfo::TableName(), TableInfo::ValueName(), id);
+            return details::OneToOneTableDeleteIfNotNeededById(connection, Statements(), id);
+        }
+
+        // Removes every row that is no longer referenced, in a single statement.
+        static void RemoveUnused(SQLite::Connection& connection)
+        {
+            details::OneToOneTableRemoveUnused(connection, TableInfo::TableName(), details::OneToOneTableStatementsFor<TableInfo>::DeleteUnused.View());
         }
 
         // Removes data that is no longer needed for an index that is to be published.
@@ -110,13 +238,13 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         // Gets the total number of rows in the table.
         static uint64_t GetCount(SQLite::Connection& connection)
         {
-            return details::OneToOneTableGetCount(connection, TableInfo::TableName());
+            return details::OneToOneTableGetCount(connection, Statements());
         }
 
         // Determines if the table is empty.
         static bool IsEmpty(SQLite::Connection& connection)
         {
-            return details::OneToOneTableIsEmpty(connection, TableInfo::TableName());
+            return details::OneToOneTableIsEmpty(connection, Statements());
         }
     };
 }
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 #include "pch.h"
 #include "PathPartTable.h"
+#include "OneToOneTable.h"
 #include "SQLiteStatementBuilder.h"
 
 
@@ -13,6 +14,10 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
     static constexpr std::string_view s_PathPartTable_ParentValue_Name = "parent"sv;
     static constexpr std::string_view s_PathPartTable_PartValue_Name = "pathpart"sv;
 
+    // Deletes the parts that are neither the path of a manifest nor the parent of another part, which removes one level of unused parts.
+    static constexpr std::string_view s_PathPartTableStmt_DeleteUnused =
+        "DELETE FROM [pathparts] WHERE [rowid] NOT IN (SELECT [pathpart] FROM [manifest]) AND [rowid] NOT IN (SELECT [parent] FROM [pathparts] WHERE [parent] IS NOT NULL)"sv;
+
     namespace
     {
         // Attempts to select a path part given the input.
@@ -121,7 +126,7 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         return s_PathPartTable_PartValue_Name;
     }
 
-    std::tuple<bool, SQLite::rowid_t> PathPartTable::EnsurePathExists(SQLite::Connection& connection, const std::filesystem::path& relativePath, bool createIfNotFound)
+    std::tuple<bool, SQLite::rowid_t> PathPartTable::EnsurePathExists(SQLite::Connection& connection, const std::filesystem::path& relativePath, bool createIfNotFound, ValueIdCache* cache)
     {
         THROW_HR_IF(E_INVALIDARG, !relativePath.has_relative_path());
         THROW_HR_IF(E_INVALIDARG, relativePath.has_root_path());
@@ -139,20 +144,30 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         for (const auto& part : relativePath)
         {
             std::string utf8part = part.u8string();
-            std::optional<SQLite::rowid_t> current = SelectPathPart(connection, parent, utf8part);
+            std::optional<SQLite::rowid_t> current = (cache ? cache->FindPathPart(parent, utf8part) : std::nullopt);
 
             if (!current)
             {
-                if (createIfNotFound)
+                current = SelectPathPart(connection, parent, utf8part);
+
+                if (!current)
                 {
-                    partsAdded = true;
-                    current = InsertPathPart(connection, parent, utf8part);
+                    if (createIfNotFound)
+                    {
+                        partsAdded = true;
+                        current = InsertPathPart(connection, parent, utf8part);
+                    }
+                    else
+                    {
+                        // Current part was not found, and we were told not to create.
+                        // Return false to indicate that the path does not exist.
+                        return {};
+                    }
                 }
-                else
+
+                if (cache)
                 {
-                    // Current part was not found, and we were told not to create.
-                    // Return false to indicate that the path does not exist.
-                    return {};
+                    cache->AddPathPart(parent, utf8part, current.value());
                 }
             }
 
@@ -247,6 +262,30 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         }
     }
 
+    void PathPartTable::RemoveUnused(SQLite::Connection& connection)
+    {
+        SQLite::Statement deleteStatement = SQLite::Statement::Create(connection, s_PathPartTableStmt_DeleteUnused);
+
+        // Removing the unused leaves can leave their parents unused, so repeat until nothing is removed.
+        // This takes one statement per level of the deepest unused path, rather than one per part.
+        int removed = 0;
+        for (;;)
+        {
+            deleteStatement.Reset();
+            deleteStatement.Execute();
+
+            int changes = connection.GetChanges();
+            if (changes == 0)
+            {
+                break;
+            }
+
+            removed += changes;
+        }
+
+        AICLI_LOG(Repo, Verbose, << "Removed " << removed << " unused path parts");
+    }
+
     void PathPartTable::PrepareForPackaging(SQLite::Connection& connection)
     {
         SQLite::Builder::StatementBuilder dropIndexBuilder;
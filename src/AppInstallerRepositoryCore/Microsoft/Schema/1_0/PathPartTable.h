@@ -11,6 +11,9 @@
 
 namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 {
+    // Forward declarations
+    struct ValueIdCache;
+
     // A table that represents a single manifest
     struct PathPartTable
     {
@@ -31,7 +34,8 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         //      The result bool will indicate whether the path was found (true), or not (false).
         // In all cases except createIfNotFound == false and result bool == false, the int64_t value
         // will be valid and the rowid of the final path part in the path.
-        static std::tuple<bool, SQLite::rowid_t> EnsurePathExists(SQLite::Connection& connection, const std::filesystem::path& relativePath, bool createIfNotFound);
+        // If a cache is given, it is consulted for each part first, and updated with the result.
+        static std::tuple<bool, SQLite::rowid_t> EnsurePathExists(SQLite::Connection& connection, const std::filesystem::path& relativePath, bool createIfNotFound, ValueIdCache* cache = nullptr);
 
         // Gets the path string using the given id as the leaf.
         static std::optional<std::string> GetPathById(SQLite::Connection& connection, SQLite::rowid_t id);
@@ -40,6 +44,9 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         // Will not remove a path part if it is referenced.
         static void RemovePathById(SQLite::Connection& connection, SQLite::rowid_t id);
 
+        // Removes every part that is not in the path of a manifest.
+        static void RemoveUnused(SQLite::Connection& connection);
+
         // Removes data that is no longer needed for an index that is to be published.
         static void PrepareForPackaging(SQLite::Connection& connection);
 
@@ -11,6 +11,9 @@
 #include "Microsoft/Schema/1_0/ManifestTable.h"
 #include "Microsoft/Schema/1_0/TagsTable.h"
 #include "Microsoft/Schema/1_0/CommandsTable.h"
+#include "Microsoft/Schema/WildcardPattern.h"
+
+#include <unordered_set>
 
 
 namespace AppInstaller::Repository::Microsoft::Schema::V1_0
@@ -25,9 +28,8 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         constexpr std::string_view s_SearchResultsTable_MatchType = "match"sv;
         constexpr std::string_view s_SearchResultsTable_MatchValue = "value"sv;
         constexpr std::string_view s_SearchResultsTable_SortValue = "sort"sv;
-        constexpr std::string_view s_SearchResultsTable_Filter = "filter"sv;
 
-        constexpr std::string_view s_SearchResultsTable_Index_Suffix = "_i_m"sv;
+        constexpr std::string_view s_SearchResultsTable_Results = "results"sv;
 
         constexpr std::string_view s_SearchResultsTable_SubSelect_TableAlias = "valueTable"sv;
         constexpr std::string_view s_SearchResultsTable_SubSelect_ManifestAlias = "m"sv;
@@ -59,18 +61,22 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             }
         }
 
-        void ExecuteStatementForMatchType(SQLite::Statement& statement, MatchType match, int bindIndex, bool escapeValueForLike, std::string_view value)
+        // TODO: Implement these more complex match types
+        bool MatchTypeIsImplemented(MatchType match)
         {
-            // TODO: Implement these more complex match types
-            if (match == MatchType::Wildcard || match == MatchType::Fuzzy || match == MatchType::FuzzySubstring)
-            {
-                AICLI_LOG(Repo, Verbose, << "Specific match type not implemented, skipping: " << MatchTypeToString(match));
-                return;
-            }
+            return (match != MatchType::Fuzzy && match != MatchType::FuzzySubstring);
+        }
 
+        void BindStatementForMatchType(SQLite::Statement& statement, MatchType match, int bindIndex, bool escapeValueForLike, std::string_view value)
+        {
             std::string valueToUse;
 
-            if (escapeValueForLike)
+            if (match == MatchType::Wildcard)
+            {
+                // The wildcards become those of LIKE, which matches without regard to case the same way
+                valueToUse = WildcardPattern{ value }.ToLike();
+            }
+            else if (escapeValueForLike)
             {
                 valueToUse = SQLite::EscapeStringForLike(value);
             }
@@ -93,186 +99,497 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
             }
 
             statement.Bind(bindIndex, valueToUse);
-
-            statement.Execute();
         }
     }
 
-    SearchResultsTable::SearchResultsTable(SQLite::Connection& connection) :
-        m_connection(connection)
+    SearchResultsTable::SearchResultsTable(SQLite::Connection& connection, bool inMemory) :
+        m_connection(connection), m_inMemory(inMemory)
+    {
+    }
+
+    void SearchResultsTable::SearchOnField(ApplicationMatchField field, MatchType match, std::string_view value)
     {
         using namespace SQLite::Builder;
+        using QCol = QualifiedColumn;
 
+        if (m_inMemory)
         {
-            StatementBuilder builder;
-            builder.CreateTable(GetQualifiedName()).BeginColumns();
+            SearchOnFieldInMemory(field, match, value);
+            return;
+        }
 
-            builder.Column(ColumnBuilder(s_SearchResultsTable_Manifest, Type::RowId).NotNull());
-            builder.Column(ColumnBuilder(s_SearchResultsTable_MatchField, Type::Int).NotNull());
-            builder.Column(ColumnBuilder(s_SearchResultsTable_MatchType, Type::Int).NotNull());
-            builder.Column(ColumnBuilder(s_SearchResultsTable_MatchValue, Type::Text).NotNull());
-            builder.Column(ColumnBuilder(s_SearchResultsTable_SortValue, Type::Int).NotNull());
-            builder.Column(ColumnBuilder(s_SearchResultsTable_Filter, Type::Bool).NotNull());
+        THROW_HR_IF(E_UNEXPECTED, m_searchesComplete);
 
-            builder.EndColumns();
+        int sortOrdinal = m_sortOrdinalValue++;
 
-            builder.Execute(m_connection);
+        // Add a select of the rows that the search finds to the results of the statement.
+        // The goal is a statement like this:
+        //      WITH results(manifest, field, match, value, sort) AS (
+        //          SELECT valueTable.m, <field>, <match>, valueTable.v, <sort> FROM
+        //          (SELECT manifest.rowid as m, manifest.id as v from manifest join ids on manifest.id = ids.rowid where ids.id = <value>) AS valueTable
+        //          UNION ALL <the next search>
+        //      )
+        // Where the subselect is built by the owning table.
+        StatementBuilder part = m_statement.BeginPart();
+
+        if (m_searchCount == 0)
+        {
+            part.With(s_SearchResultsTable_Results, { s_SearchResultsTable_Manifest, s_SearchResultsTable_MatchField, s_SearchResultsTable_MatchType,
+                s_SearchResultsTable_MatchValue, s_SearchResultsTable_SortValue }).BeginParenthetical();
+        }
+        else
+        {
+            part.UnionAll();
         }
 
-        InitDropStatement(m_connection);
+        part.Select().
+            Column(QCol(s_SearchResultsTable_SubSelect_TableAlias, s_SearchResultsTable_SubSelect_ManifestAlias)).
+            Value(field).
+            Value(match).
+            Column(QCol(s_SearchResultsTable_SubSelect_TableAlias, s_SearchResultsTable_SubSelect_ValueAlias)).
+            Value(sortOrdinal).
+        From().BeginParenthetical();
 
+        if (!BuildFieldStatement(part, field, match, value))
         {
-            SQLite::Builder::QualifiedTable index = GetQualifiedName();
-            std::string indexName(index.Table);
-            indexName += s_SearchResultsTable_Index_Suffix;
-            index.Table = indexName;
+            AICLI_LOG(Repo, Verbose, << "Specific match type not implemented, skipping: " << MatchTypeToString(match));
+            return;
+        }
+
+        part.EndParenthetical().As(s_SearchResultsTable_SubSelect_TableAlias);
 
-            StatementBuilder builder;
-            builder.CreateIndex(indexName).On(GetQualifiedName().Table).Columns(s_SearchResultsTable_Manifest);
+        m_statement.Append(std::move(part));
+        ++m_searchCount;
+    }
 
-            builder.Execute(m_connection);
+    void SearchResultsTable::RemoveDuplicateManifestRows()
+    {
+        if (m_inMemory)
+        {
+            // Rows are always in sort order, so the first row for a manifest is one with the lowest sort order.
+            std::unordered_set<SQLite::rowid_t> manifestSeen;
+            size_t previousCount = m_rows.size();
+
+            m_rows.erase(std::remove_if(m_rows.begin(), m_rows.end(), [&](const Row& row) { return !manifestSeen.insert(row.Manifest).second; }), m_rows.end());
+
+            AICLI_LOG(Repo, Verbose, << "Removed " << (previousCount - m_rows.size()) << " duplicate rows");
+            return;
         }
+
+        // Nothing to do for the statement; filters remove every row of a manifest, and the rows are grouped by id
+        // when read, which keeps the row with the lowest sort order just as removing the duplicates first would.
     }
 
-    void SearchResultsTable::SearchOnField(ApplicationMatchField field, MatchType match, std::string_view value)
+    void SearchResultsTable::PrepareToFilter()
     {
         using namespace SQLite::Builder;
+        using QCol = QualifiedColumn;
 
-        int sortOrdinal = m_sortOrdinalValue++;
+        if (m_inMemory)
+        {
+            m_filterManifests.clear();
+            return;
+        }
 
-        // Create an insert statement to select values into the table as requested.
-        // The goal is a statement like this:
-        //      INSERT INTO <tempTable>
-        //      SELECT valueTable.m, <field>, <match>, valueTable.v, <sort>, <filter> FROM
-        //      (SELECT manifest.rowid as m, manifest.id as v from manifest join ids on manifest.id = ids.rowid where ids.id = <value>) AS valueTable
-        // Where the subselect is built by the owning table.
-        StatementBuilder builder;
-        builder.InsertInto(GetQualifiedName()).Select().
-            Column(QualifiedColumn(s_SearchResultsTable_SubSelect_TableAlias, s_SearchResultsTable_SubSelect_ManifestAlias)).
-            Value(field).
-            Value(match).
-            Column(QualifiedColumn(s_SearchResultsTable_SubSelect_TableAlias, s_SearchResultsTable_SubSelect_ValueAlias)).
-            Value(sortOrdinal).
-            Value(false).
-        From().BeginParenthetical();
+        CompleteSearches();
 
-        // Add the field specific portion
-        int bindIndex = BuildSearchStatement(builder, field, match);
+        if (m_searchCount == 0)
+        {
+            return;
+        }
 
-        builder.EndParenthetical().As(s_SearchResultsTable_SubSelect_TableAlias);
+        // Each filter keeps only the rows of the manifests that any of its searches find.
+        // The goal is a statement like this:
+        //      ... WHERE results.manifest IN (SELECT m FROM (<search>) UNION ALL SELECT m FROM (<search>)) AND results.manifest IN (<next filter>)
+        if (m_filterCount == 0)
+        {
+            m_statement.Where(QCol(s_SearchResultsTable_Results, s_SearchResultsTable_Manifest));
+        }
+        else
+        {
+            m_statement.And(QCol(s_SearchResultsTable_Results, s_SearchResultsTable_Manifest));
+        }
 
-        SQLite::Statement statement = builder.Prepare(m_connection);
-        ExecuteStatementForMatchType(statement, match, bindIndex, MatchUsesLike(match), value);
-        AICLI_LOG(Repo, Verbose, << "Search found " << m_connection.GetChanges() << " rows");
+        m_statement.In().BeginParenthetical();
+
+        ++m_filterCount;
+        m_filterSearchCount = 0;
     }
 
-    void SearchResultsTable::RemoveDuplicateManifestRows()
+    void SearchResultsTable::FilterOnField(ApplicationMatchField field, MatchType match, std::string_view value)
     {
         using namespace SQLite::Builder;
 
-        // Create a delete statement to leave only one row with a given manifest.
-        // This will arbitrarily choose one of the rows if multiple have the same lowest sort order.
-        // The goal is a statement like this:
-        //      DELETE from <temp> where rowid not in (
-        //          SELECT rowid from (
-        //              SELECT rowid, min(sort) from <temp> group by manifest
-        //          )
-        //      )
-        StatementBuilder builder;
-        builder.DeleteFrom(GetQualifiedName()).Where(SQLite::RowIDName).Not().In().BeginParenthetical().
-            Select(SQLite::RowIDName).From().BeginParenthetical().
-                Select().Column(SQLite::RowIDName).Column(Aggregate::Min, s_SearchResultsTable_SortValue).From(GetQualifiedName()).GroupBy(s_SearchResultsTable_Manifest).
-            EndParenthetical().
-        EndParenthetical();
-
-        builder.Execute(m_connection);
-        AICLI_LOG(Repo, Verbose, << "Removed " << m_connection.GetChanges() << " duplicate rows");
+        if (m_inMemory)
+        {
+            FilterOnFieldInMemory(field, match, value);
+            return;
+        }
+
+        if (m_searchCount == 0)
+        {
+            return;
+        }
+
+        // Add a select of the manifests that the search finds to those kept by the filter.
+        StatementBuilder part = m_statement.BeginPart();
+
+        if (m_filterSearchCount != 0)
+        {
+            part.UnionAll();
+        }
+
+        part.Select(s_SearchResultsTable_SubSelect_ManifestAlias).From().BeginParenthetical();
+
+        if (!BuildFieldStatement(part, field, match, value))
+        {
+            AICLI_LOG(Repo, Verbose, << "Specific match type not implemented, skipping: " << MatchTypeToString(match));
+            return;
+        }
+
+        part.EndParenthetical();
+
+        m_statement.Append(std::move(part));
+        ++m_filterSearchCount;
     }
 
-    void SearchResultsTable::PrepareToFilter()
+    void SearchResultsTable::CompleteFilter()
+    {
+        if (m_inMemory)
+        {
+            std::sort(m_filterManifests.begin(), m_filterManifests.end());
+            m_filterManifests.erase(std::unique(m_filterManifests.begin(), m_filterManifests.end()), m_filterManifests.end());
+
+            size_t previousCount = m_rows.size();
+
+            m_rows.erase(std::remove_if(m_rows.begin(), m_rows.end(), [&](const Row& row)
+                {
+                    return !std::binary_search(m_filterManifests.begin(), m_filterManifests.end(), row.Manifest);
+                }), m_rows.end());
+
+            AICLI_LOG(Repo, Verbose, << "Filter deleted " << (previousCount - m_rows.size()) << " rows");
+            return;
+        }
+
+        if (m_searchCount == 0)
+        {
+            return;
+        }
+
+        // A filter without any searches is an empty list, which keeps nothing, the same as a filter whose searches find nothing.
+        m_statement.EndParenthetical();
+    }
+
+    void SearchResultsTable::AddFieldConstraints(SQLite::Builder::StatementBuilder&, ApplicationMatchField, MatchType, std::string_view)
     {
-        // Reset all filter values to unselected
-        SQLite::Builder::StatementBuilder builder;
-        builder.Update(GetQualifiedName()).Set().Column(s_SearchResultsTable_Filter).Equals(false);
+        // No additional constraints in this version.
+    }
 
-        builder.Execute(m_connection);
+    bool SearchResultsTable::BuildExtendedSearchStatement(SQLite::Builder::StatementBuilder&, ApplicationMatchField, MatchType, std::string_view, std::string_view, std::string_view)
+    {
+        // No additional match types in this version.
+        return false;
     }
 
-    void SearchResultsTable::FilterOnField(ApplicationMatchField field, MatchType match, std::string_view value)
+    std::optional<std::vector<SQLite::rowid_t>> SearchResultsTable::FilterManifests(ApplicationMatchField, MatchType, std::string_view)
     {
-        using namespace SQLite::Builder;
+        // No filters are evaluated in memory in this version.
+        return {};
+    }
 
-        // Create an update statement to mark rows that are found by the search.
-        // This will arbitrarily choose one of the rows if multiple have the same lowest sort order.
-        // The goal is a statement like this:
-        //      UPDATE <temp> set filter = 1 where manifest in (
-        //          SELECT m from (
-        //              SELECT manifest.rowid as m, manifest.id as v from manifest join ids on manifest.id = ids.rowid where ids.id = <value>
-        //          )
-        //      )
-        StatementBuilder builder;
-        builder.Update(GetQualifiedName()).Set().Column(s_SearchResultsTable_Filter).Equals(true).Where(s_SearchResultsTable_Manifest).In().BeginParenthetical().
-            Select(s_SearchResultsTable_SubSelect_ManifestAlias).From().BeginParenthetical();
+    std::vector<SQLite::rowid_t> SearchResultsTable::GetManifests()
+    {
+        THROW_HR_IF(E_UNEXPECTED, !m_inMemory);
 
-        // Add the field specific portion
-        int bindIndex = BuildSearchStatement(builder, field, match);
+        std::vector<SQLite::rowid_t> result;
+        result.reserve(m_rows.size());
 
-        builder.EndParenthetical().EndParenthetical();
+        for (const Row& row : m_rows)
+        {
+            result.push_back(row.Manifest);
+        }
 
-        SQLite::Statement statement = builder.Prepare(m_connection);
-        ExecuteStatementForMatchType(statement, match, bindIndex, MatchUsesLike(match), value);
-        AICLI_LOG(Repo, Verbose, << "Filter kept " << m_connection.GetChanges() << " rows");
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
     }
 
-    void SearchResultsTable::CompleteFilter()
+    bool SearchResultsTable::HasMoreIdsThan(size_t count)
     {
-        // Delete all unselected values
-        SQLite::Builder::StatementBuilder builder;
-        builder.DeleteFrom(GetQualifiedName()).Where(s_SearchResultsTable_Filter).Equals(false);
+        if (m_inMemory)
+        {
+            std::unordered_set<SQLite::rowid_t> idSeen;
+
+            for (const Row& row : m_rows)
+            {
+                if (idSeen.insert(row.Id).second && idSeen.size() > count)
+                {
+                    return true;
+                }
+            }
 
-        builder.Execute(m_connection);
-        AICLI_LOG(Repo, Verbose, << "Filter deleted " << m_connection.GetChanges() << " rows");
+            return false;
+        }
+
+        // The searches only run when the results are read, so the check is made then instead.  The results are read in sort order,
+        // so stopping once more than the count of ids have been read, and every other row of the search that found the last of them,
+        // gives the same results as stopping the searches.
+        m_stopAfterIdCount = count;
+        return false;
     }
 
     ISQLiteIndex::SearchResult SearchResultsTable::GetSearchResults(size_t limit)
     {
-        constexpr std::string_view tempTableAlias = "t"sv;
+        if (m_inMemory)
+        {
+            // Only the first row for each id is returned; as the rows are in sort order,
+            // this is one of the rows that matched through the earliest search.
+            std::unordered_set<SQLite::rowid_t> idSeen;
+
+            ISQLiteIndex::SearchResult result;
+            for (const Row& row : m_rows)
+            {
+                if (idSeen.count(row.Id))
+                {
+                    continue;
+                }
+
+                if (limit && result.Matches.size() >= limit)
+                {
+                    result.Truncated = true;
+                    break;
+                }
+
+                idSeen.insert(row.Id);
+                result.Matches.emplace_back(row.Id, ApplicationMatchFilter(row.Field, row.Match, row.Value));
+            }
+
+            return result;
+        }
 
         using namespace SQLite::Builder;
         using QCol = QualifiedColumn;
 
-        // Select all unique ids from the results table, and their highest ordered match.
-        // The goal is a statement like this:
-        //  SELECT m.id, field, match, value, min(sort) from <temp> join manifest on rowid = manifest group by m.id order by t.sort
+        CompleteSearches();
+
+        ISQLiteIndex::SearchResult result;
+
+        if (m_searchCount == 0)
+        {
+            return result;
+        }
+
+        // Group the rows by id, keeping their highest ordered match.
+        // The goal is the end of a statement like this:
+        //  ... GROUP BY manifest.id ORDER BY results.sort
         // Through the "group by m.id", we will only ever have one row per id, and the "min(sort)" returns us one of the rows that matched
         // through the earliest search.  We also order by the sort value to have the earliest search matches first in the list
-        StatementBuilder builder;
-        builder.Select().
-            Column(QCol(ManifestTable::TableName(), IdTable::ValueName())).
-            Column(QCol(tempTableAlias, s_SearchResultsTable_MatchField)).
-            Column(QCol(tempTableAlias, s_SearchResultsTable_MatchType)).
-            Column(QCol(tempTableAlias, s_SearchResultsTable_MatchValue)).
-            Column(Aggregate::Min, QCol(tempTableAlias, s_SearchResultsTable_SortValue)).
-        From(GetQualifiedName()).As(tempTableAlias).
-            Join(ManifestTable::TableName()).On(QCol(tempTableAlias, s_SearchResultsTable_Manifest), QCol(ManifestTable::TableName(), SQLite::RowIDName)).
-            GroupBy(QCol(ManifestTable::TableName(), IdTable::ValueName())).OrderBy(QCol(tempTableAlias, s_SearchResultsTable_SortValue));
+        m_statement.GroupBy(QCol(ManifestTable::TableName(), IdTable::ValueName())).OrderBy(QCol(s_SearchResultsTable_Results, s_SearchResultsTable_SortValue));
 
-        SQLite::Statement select = builder.Prepare(m_connection);
+        SQLite::Statement select = m_statement.Prepare(m_connection);
+
+        for (const Binding& binding : m_bindings)
+        {
+            BindStatementForMatchType(select, binding.Match, binding.Index, MatchUsesLike(binding.Match), binding.Value);
+        }
+
+        std::optional<int> stopAfterSort;
+        bool stoppedEarly = false;
 
-        ISQLiteIndex::SearchResult result;
         while (select.Step())
         {
+            int sort = select.GetColumn<int>(4);
+
+            if (stopAfterSort && sort > stopAfterSort.value())
+            {
+                stoppedEarly = true;
+                break;
+            }
+
             if (limit && result.Matches.size() >= limit)
             {
                 break;
             }
 
-            result.Matches.emplace_back(select.GetColumn<SQLite::rowid_t>(0), 
+            result.Matches.emplace_back(select.GetColumn<SQLite::rowid_t>(0),
                 ApplicationMatchFilter(select.GetColumn<ApplicationMatchField>(1), select.GetColumn<MatchType>(2), select.GetColumn<std::string>(3)));
+
+            if (m_stopAfterIdCount && !stopAfterSort && result.Matches.size() > m_stopAfterIdCount)
+            {
+                AICLI_LOG(Repo, Verbose, << "Found more than " << m_stopAfterIdCount << " results, skipping the results of the remaining searches");
+                stopAfterSort = sort;
+            }
         }
 
-        result.Truncated = (select.GetState() != SQLite::Statement::State::Completed);
+        result.Truncated = (!stoppedEarly && select.GetState() != SQLite::Statement::State::Completed);
 
         return result;
     }
+
+    bool SearchResultsTable::BuildFieldStatement(SQLite::Builder::StatementBuilder& builder, ApplicationMatchField field, MatchType match, std::string_view value)
+    {
+        if (BuildExtendedSearchStatement(builder, field, match, value, s_SearchResultsTable_SubSelect_ManifestAlias, s_SearchResultsTable_SubSelect_ValueAlias))
+        {
+            return true;
+        }
+        else if (MatchTypeIsImplemented(match))
+        {
+            int bindIndex = BuildSearchStatement(builder, field, match);
+            AddFieldConstraints(builder, field, match, value);
+
+            m_bindings.push_back({ bindIndex, match, std::string{ value } });
+            return true;
+        }
+
+        return false;
+    }
+
+    void SearchResultsTable::CompleteSearches()
+    {
+        using namespace SQLite::Builder;
+        using QCol = QualifiedColumn;
+
+        if (m_searchesComplete)
+        {
+            return;
+        }
+
+        m_searchesComplete = true;
+
+        if (m_searchCount == 0)
+        {
+            return;
+        }
+
+        // End the results and select them, along with the id of each manifest for grouping the results.
+        // The goal is a statement like this:
+        //      WITH results(...) AS (<searches>)
+        //      SELECT manifest.id, results.field, results.match, results.value, min(results.sort) FROM results JOIN manifest ON results.manifest = manifest.rowid
+        m_statement.EndParenthetical().Select().
+            Column(QCol(ManifestTable::TableName(), IdTable::ValueName())).
+            Column(QCol(s_SearchResultsTable_Results, s_SearchResultsTable_MatchField)).
+            Column(QCol(s_SearchResultsTable_Results, s_SearchResultsTable_MatchType)).
+            Column(QCol(s_SearchResultsTable_Results, s_SearchResultsTable_MatchValue)).
+            Column(Aggregate::Min, QCol(s_SearchResultsTable_Results, s_SearchResultsTable_SortValue)).
+        From(s_SearchResultsTable_Results).
+            Join(ManifestTable::TableName()).On(QCol(s_SearchResultsTable_Results, s_SearchResultsTable_Manifest), QCol(ManifestTable::TableName(), SQLite::RowIDName));
+    }
+
+    void SearchResultsTable::SearchOnFieldInMemory(ApplicationMatchField field, MatchType match, std::string_view value)
+    {
+        using namespace SQLite::Builder;
+        using QCol = QualifiedColumn;
+
+        int sortOrdinal = m_sortOrdinalValue++;
+
+        // Create a select statement that returns the values that would have been inserted into the temp table,
+        // along with the id of each manifest for grouping the results.
+        // The goal is a statement like this:
+        //      SELECT valueTable.m, manifest.id, valueTable.v FROM
+        //      (SELECT manifest.rowid as m, manifest.id as v from manifest join ids on manifest.id = ids.rowid where ids.id = <value>) AS valueTable
+        //      JOIN manifest ON valueTable.m = manifest.rowid
+        StatementBuilder builder;
+        builder.Select().
+            Column(QCol(s_SearchResultsTable_SubSelect_TableAlias, s_SearchResultsTable_SubSelect_ManifestAlias)).
+            Column(QCol(ManifestTable::TableName(), IdTable::ValueName())).
+            Column(QCol(s_SearchResultsTable_SubSelect_TableAlias, s_SearchResultsTable_SubSelect_ValueAlias)).
+        From().BeginParenthetical();
+
+        auto addRows = [&](SQLite::Statement& statement)
+        {
+            size_t previousCount = m_rows.size();
+
+            while (statement.Step())
+            {
+                m_rows.push_back({ statement.GetColumn<SQLite::rowid_t>(0), statement.GetColumn<SQLite::rowid_t>(1), field, match, statement.GetColumn<std::string>(2), sortOrdinal });
+            }
+
+            AICLI_LOG(Repo, Verbose, << "Search found " << (m_rows.size() - previousCount) << " rows");
+        };
+
+        auto endStatement = [&]()
+        {
+            builder.EndParenthetical().As(s_SearchResultsTable_SubSelect_TableAlias).
+                Join(ManifestTable::TableName()).On(QCol(s_SearchResultsTable_SubSelect_TableAlias, s_SearchResultsTable_SubSelect_ManifestAlias), QCol(ManifestTable::TableName(), SQLite::RowIDName));
+        };
+
+        // Add the field specific portion
+        if (BuildExtendedSearchStatement(builder, field, match, value, s_SearchResultsTable_SubSelect_ManifestAlias, s_SearchResultsTable_SubSelect_ValueAlias))
+        {
+            endStatement();
+
+            SQLite::Statement statement = builder.Prepare(m_connection);
+            addRows(statement);
+        }
+        else if (MatchTypeIsImplemented(match))
+        {
+            int bindIndex = BuildSearchStatement(builder, field, match);
+            AddFieldConstraints(builder, field, match, value);
+            endStatement();
+
+            SQLite::CachedStatement statement = builder.PrepareCached(m_connection);
+            BindStatementForMatchType(statement, match, bindIndex, MatchUsesLike(match), value);
+            addRows(statement);
+        }
+        else
+        {
+            AICLI_LOG(Repo, Verbose, << "Specific match type not implemented, skipping: " << MatchTypeToString(match));
+        }
+    }
+
+    void SearchResultsTable::FilterOnFieldInMemory(ApplicationMatchField field, MatchType match, std::string_view value)
+    {
+        using namespace SQLite::Builder;
+
+        if (std::optional<std::vector<SQLite::rowid_t>> manifests = FilterManifests(field, match, value))
+        {
+            m_filterManifests.insert(m_filterManifests.end(), manifests->begin(), manifests->end());
+            AICLI_LOG(Repo, Verbose, << "Filter found " << manifests->size() << " manifests");
+            return;
+        }
+
+        // Create a select statement that returns the manifests that the filter keeps.
+        // The goal is a statement like this:
+        //      SELECT m from (
+        //          SELECT manifest.rowid as m, manifest.id as v from manifest join ids on manifest.id = ids.rowid where ids.id = <value>
+        //      )
+        StatementBuilder builder;
+        builder.Select(s_SearchResultsTable_SubSelect_ManifestAlias).From().BeginParenthetical();
+
+        auto addManifests = [&](SQLite::Statement& statement)
+        {
+            size_t previousCount = m_filterManifests.size();
+
+            while (statement.Step())
+            {
+                m_filterManifests.push_back(statement.GetColumn<SQLite::rowid_t>(0));
+            }
+
+            AICLI_LOG(Repo, Verbose, << "Filter found " << (m_filterManifests.size() - previousCount) << " manifests");
+        };
+
+        // Add the field specific portion
+        if (BuildExtendedSearchStatement(builder, field, match, value, s_SearchResultsTable_SubSelect_ManifestAlias, s_SearchResultsTable_SubSelect_ValueAlias))
+        {
+            builder.EndParenthetical();
+
+            SQLite::Statement statement = builder.Prepare(m_connection);
+            addManifests(statement);
+        }
+        else if (MatchTypeIsImplemented(match))
+        {
+            int bindIndex = BuildSearchStatement(builder, field, match);
+            AddFieldConstraints(builder, field, match, value);
+
+            builder.EndParenthetical();
+
+            SQLite::CachedStatement statement = builder.PrepareCached(m_connection);
+            BindStatementForMatchType(statement, match, bindIndex, MatchUsesLike(match), value);
+            addManifests(statement);
+        }
+        else
+        {
+            AICLI_LOG(Repo, Verbose, << "Specific match type not implemented, skipping: " << MatchTypeToString(match));
+        }
+    }
 }
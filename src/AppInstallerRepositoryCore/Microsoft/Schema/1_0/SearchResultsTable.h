@@ -2,20 +2,28 @@
 // Licensed under the MIT License.
 #pragma once
 #include "SQLiteWrapper.h"
-#include "SQLiteTempTable.h"
+#include "SQLiteStatementBuilder.h"
 #include "Microsoft/Schema/ISQLiteIndex.h"
 #include "AppInstallerRepositorySearch.h"
 
+#include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
 
 namespace AppInstaller::Repository::Microsoft::Schema::V1_0
 {
-    // Table for holding temporary search results.
-    struct SearchResultsTable : public SQLite::TempTable
+    // Holds the results of a search request.
+    // When in memory, the rows are held in this object; the searches and filters run against the database one at a time,
+    // but the results are accumulated without writing to temp storage.
+    // Otherwise, the searches and filters are compiled into a single statement, which is only run when the results are read,
+    // so that the database plans the request as a whole and nothing is written to temp storage.
+    struct SearchResultsTable
     {
-        SearchResultsTable(SQLite::Connection& connection);
+        SearchResultsTable(SQLite::Connection& connection, bool inMemory = false);
+
+        virtual ~SearchResultsTable() = default;
 
         SearchResultsTable(const SearchResultsTable&) = delete;
         SearchResultsTable& operator=(const SearchResultsTable&) = delete;
@@ -38,11 +46,81 @@ namespace AppInstaller::Repository::Microsoft::Schema::V1_0
         // Completes a filtering pass, removing filtered rows.
         void CompleteFilter();
 
+        // Determines if the table holds rows for more than the given number of distinct ids.
+        bool HasMoreIdsThan(size_t count);
+
         // Gets the results from the table.
         ISQLiteIndex::SearchResult GetSearchResults(size_t limit = 0);
 
-    private:
+    protected:
+        // Allows later schema versions to add constraints to the field specific portion of a search or filter statement.
+        // Any constraints added must not exclude rows that the match itself would have included.
+        virtual void AddFieldConstraints(SQLite::Builder::StatementBuilder& builder, ApplicationMatchField field, MatchType match, std::string_view value);
+
+        // Allows later schema versions to provide the field specific portion of a search or filter statement, either for match types
+        // that this version does not implement or in place of the one this version would build.  The statement must select the
+        // manifest rowid and the matched value, using the given aliases, and bind all of its own values.  Returns false to leave
+        // the search to this version (which skips the match types it does not implement), in which case nothing may be added.
+        virtual bool BuildExtendedSearchStatement(SQLite::Builder::StatementBuilder& builder, ApplicationMatchField field, MatchType match, std::string_view value,
+            std::string_view manifestAlias, std::string_view valueAlias);
+
+        // Allows later schema versions to evaluate a filter against the manifests already in the results, rather than through a statement.
+        // Returns the manifests that the filter keeps, or an empty value to leave the filter to the statement.
+        // Only used when in memory, as a compiled statement has no results until it is run.
+        virtual std::optional<std::vector<SQLite::rowid_t>> FilterManifests(ApplicationMatchField field, MatchType match, std::string_view value);
+
+        // Gets the distinct manifests in the results, in rowid order; only valid when in memory.
+        std::vector<SQLite::rowid_t> GetManifests();
+
         SQLite::Connection& m_connection;
+
+    private:
+        // A row of the results when they are held in memory.
+        struct Row
+        {
+            SQLite::rowid_t Manifest;
+            SQLite::rowid_t Id;
+            ApplicationMatchField Field;
+            MatchType Match;
+            std::string Value;
+            int Sort;
+        };
+
+        // A value of the compiled statement that is bound once it is prepared, for a search built by this version.
+        struct Binding
+        {
+            int Index;
+            MatchType Match;
+            std::string Value;
+        };
+
+        // The in memory implementations of SearchOnField and FilterOnField.
+        void SearchOnFieldInMemory(ApplicationMatchField field, MatchType match, std::string_view value);
+        void FilterOnFieldInMemory(ApplicationMatchField field, MatchType match, std::string_view value);
+
+        // Adds the field specific portion of a search or filter to a part of the compiled statement.
+        // Returns false, having added nothing, if the match type is not implemented.
+        bool BuildFieldStatement(SQLite::Builder::StatementBuilder& builder, ApplicationMatchField field, MatchType match, std::string_view value);
+
+        // Ends the searches of the compiled statement and begins its selection of their results, if not already done.
+        void CompleteSearches();
+
         int m_sortOrdinalValue = 0;
+        bool m_inMemory = false;
+
+        // The compiled statement; the searches are the rows of a common table expression, and the filters constrain its manifests.
+        SQLite::Builder::StatementBuilder m_statement;
+        std::vector<Binding> m_bindings;
+        size_t m_searchCount = 0;
+        bool m_searchesComplete = false;
+        size_t m_filterCount = 0;
+        size_t m_filterSearchCount = 0;
+        // When not zero, the results are read only until they hold more than this many ids.
+        size_t m_stopAfterIdCount = 0;
+
+        // The rows are always in sort order, as each search is appended with a higher sort value.
+        std::vector<Row> m_rows;
+        // The manifests found by the current filtering pass; sorted and made unique when the pass completes.
+        std::vector<SQLite::rowid_t> m_filterManifests;
     };
 }
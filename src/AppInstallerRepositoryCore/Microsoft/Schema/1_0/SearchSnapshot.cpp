@@ -0,0 +1,616 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "SearchSnapshot.h"
+#include "SQLiteStatementBuilder.h"
+
+#include "Microsoft/Schema/1_0/IdTable.h"
+#include "Microsoft/Schema/1_0/NameTable.h"
+#include "Microsoft/Schema/1_0/MonikerTable.h"
+#include "Microsoft/Schema/1_0/ManifestTable.h"
+#include "Microsoft/Schema/1_0/TagsTable.h"
+#include "Microsoft/Schema/1_0/CommandsTable.h"
+#include "Microsoft/Schema/WildcardPattern.h"
+
+#include <unordered_map>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_0
+{
+    namespace
+    {
+        using namespace std::string_view_literals;
+
+        // "WGSS", and the version of the serialized form; a section of another version is not used.
+        constexpr uint32_t s_SearchSnapshot_Magic = 0x53534757;
+        constexpr uint32_t s_SearchSnapshot_Version = 1;
+
+        // Appended to the shared name to name the section.
+        constexpr std::wstring_view s_SearchSnapshot_SectionSuffix = L".searchsnapshot"sv;
+
+        // Data in the snapshot is not valid.
+        constexpr HRESULT s_CorruptSnapshotError = HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT);
+
+        // The location of the arrays of a field in the serialized snapshot; offsets are from the start of it.
+        struct SerializedField
+        {
+            uint32_t ValueCount;
+            uint32_t AssociationCount;
+            uint64_t RowIds;
+            uint64_t ValueOffsets;
+            uint64_t FoldedValueOffsets;
+            uint64_t Strings;
+            uint64_t StringsSize;
+            uint64_t Manifests;
+            uint64_t ValueIndices;
+        };
+
+        // The start of the serialized snapshot.
+        struct SerializedHeader
+        {
+            uint32_t Magic;
+            uint32_t Version;
+            uint64_t Size;
+            uint32_t ManifestCount;
+            uint32_t Reserved;
+            uint64_t ManifestRowIds;
+            uint64_t ManifestIdPositions;
+            SerializedField Fields[5];
+        };
+
+        // Every array starts on this alignment, which is enough for any of them.
+        constexpr size_t s_SerializedAlignment = 8;
+
+        // Builds the serialized snapshot, appending its arrays after the header.
+        struct SnapshotWriter
+        {
+            SnapshotWriter() : Data(sizeof(SerializedHeader)) {}
+
+            template <typename T>
+            uint64_t Append(const std::vector<T>& values)
+            {
+                return Append(values.data(), values.size() * sizeof(T));
+            }
+
+            uint64_t Append(const void* data, size_t size)
+            {
+                Data.resize((Data.size() + s_SerializedAlignment - 1) / s_SerializedAlignment * s_SerializedAlignment);
+
+                uint64_t offset = Data.size();
+                const uint8_t* bytes = static_cast<const uint8_t*>(data);
+                Data.insert(Data.end(), bytes, bytes + size);
+                return offset;
+            }
+
+            std::vector<uint8_t> Data;
+        };
+
+        size_t GetFieldIndex(ApplicationMatchField field)
+        {
+            switch (field)
+            {
+            case ApplicationMatchField::Id:
+            case ApplicationMatchField::Name:
+            case ApplicationMatchField::Moniker:
+            case ApplicationMatchField::Command:
+            case ApplicationMatchField::Tag:
+                return static_cast<size_t>(field);
+            default:
+                THROW_HR(E_UNEXPECTED);
+            }
+        }
+
+        // Loads the values and manifest associations of the table, and appends them to the snapshot.
+        // Returns the position of the value of each association, in the order of the manifest positions.
+        template <typename Table>
+        std::vector<uint32_t> SerializeField(SQLite::Connection& connection, const std::unordered_map<SQLite::rowid_t, uint32_t>& manifestPositions,
+            SnapshotWriter& writer, SerializedField& serialized)
+        {
+            std::unordered_map<SQLite::rowid_t, uint32_t> valuePositions;
+            std::vector<int64_t> rowIds;
+            std::vector<std::string> values;
+
+            {
+                SQLite::Builder::StatementBuilder builder;
+                builder.Select({ SQLite::RowIDName, Table::ValueName() }).From(Table::TableName());
+
+                SQLite::Statement select = builder.Prepare(connection);
+
+                while (select.Step())
+                {
+                    SQLite::rowid_t valueId = select.GetColumn<SQLite::rowid_t>(0);
+                    valuePositions[valueId] = static_cast<uint32_t>(values.size());
+
+                    rowIds.push_back(valueId);
+                    values.emplace_back(select.GetColumn<std::string>(1));
+                }
+            }
+
+            std::vector<std::pair<uint32_t, uint32_t>> associations;
+
+            {
+                // Either the value column of the manifest table, or the mapping table for 1:N data.
+                SQLite::Builder::StatementBuilder builder;
+                if constexpr (Table::IsOneToOne())
+                {
+                    builder.Select({ SQLite::RowIDName, Table::ValueName() }).From(ManifestTable::TableName());
+                }
+                else
+                {
+                    std::string mapTableName = details::OneToManyTableGetMapTableName(Table::TableName());
+                    builder.Select({ details::OneToManyTableGetManifestColumnName(), Table::ValueName() }).From(mapTableName);
+                }
+
+                SQLite::Statement select = builder.Prepare(connection);
+
+                while (select.Step())
+                {
+                    auto manifestItr = manifestPositions.find(select.GetColumn<SQLite::rowid_t>(0));
+                    auto valueItr = valuePositions.find(select.GetColumn<SQLite::rowid_t>(1));
+                    THROW_HR_IF(E_UNEXPECTED, manifestItr == manifestPositions.end() || valueItr == valuePositions.end());
+
+                    associations.emplace_back(manifestItr->second, valueItr->second);
+                }
+            }
+
+            std::sort(associations.begin(), associations.end());
+
+            std::vector<uint32_t> manifests;
+            std::vector<uint32_t> valueIndices;
+            manifests.reserve(associations.size());
+            valueIndices.reserve(associations.size());
+            for (const auto& association : associations)
+            {
+                manifests.push_back(association.first);
+                valueIndices.push_back(association.second);
+            }
+
+            // The values and then their case folded forms, each delimited by consecutive offsets
+            std::string strings;
+            std::vector<uint32_t> valueOffsets;
+            std::vector<uint32_t> foldedValueOffsets;
+
+            for (const auto& value : values)
+            {
+                valueOffsets.push_back(wil::safe_cast<uint32_t>(strings.size()));
+                strings += value;
+            }
+            valueOffsets.push_back(wil::safe_cast<uint32_t>(strings.size()));
+
+            for (const auto& value : values)
+            {
+                foldedValueOffsets.push_back(wil::safe_cast<uint32_t>(strings.size()));
+                strings += Utility::FoldCase(value);
+            }
+            foldedValueOffsets.push_back(wil::safe_cast<uint32_t>(strings.size()));
+
+            serialized.ValueCount = static_cast<uint32_t>(values.size());
+            serialized.AssociationCount = static_cast<uint32_t>(associations.size());
+            serialized.RowIds = writer.Append(rowIds);
+            serialized.ValueOffsets = writer.Append(valueOffsets);
+            serialized.FoldedValueOffsets = writer.Append(foldedValueOffsets);
+            serialized.Strings = writer.Append(strings.data(), strings.size());
+            serialized.StringsSize = strings.size();
+            serialized.Manifests = writer.Append(manifests);
+            serialized.ValueIndices = writer.Append(valueIndices);
+
+            return valueIndices;
+        }
+    }
+
+    SearchSnapshot::SearchSnapshot(SQLite::Connection& connection, std::string_view sharedName) :
+        m_memoryRegistration(Memory::MemoryBudget::Instance().Register("Search snapshot", Memory::TrimOrder::Late, {}))
+    {
+        if (sharedName.empty())
+        {
+            m_data = Serialize(connection);
+            Attach(m_data.data(), m_data.size());
+            AICLI_LOG(Repo, Info, << "Loaded search snapshot of " << m_data.size() << " bytes with " << m_manifestCount << " manifests");
+            return;
+        }
+
+        std::wstring sectionName = Utility::ConvertToUTF16(sharedName);
+        sectionName += s_SearchSnapshot_SectionSuffix;
+
+        // The section is only written under the write lock, so a reader that finds it sees all of it
+        {
+            auto lock = Synchronization::CrossProcessReaderWriteLock::LockForRead(sharedName);
+            if (TryMapShared(sectionName))
+            {
+                AICLI_LOG(Repo, Info, << "Mapped shared search snapshot with " << m_manifestCount << " manifests: " << sharedName);
+                return;
+            }
+        }
+
+        auto lock = Synchronization::CrossProcessReaderWriteLock::LockForWrite(sharedName);
+
+        // Another process may have shared it while this one waited for the lock
+        if (TryMapShared(sectionName))
+        {
+            AICLI_LOG(Repo, Info, << "Mapped shared search snapshot with " << m_manifestCount << " manifests: " << sharedName);
+            return;
+        }
+
+        std::vector<uint8_t> data = Serialize(connection);
+        uint64_t size = data.size();
+
+        wil::unique_handle mapping{ CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), sectionName.c_str()) };
+        if (!mapping || GetLastError() == ERROR_ALREADY_EXISTS)
+        {
+            // A section with the name that does not hold a valid snapshot cannot be replaced, so this one is not shared
+            AICLI_LOG(Repo, Warning, << "Search snapshot could not be shared, keeping it to this process: " << sharedName);
+            m_data = std::move(data);
+            Attach(m_data.data(), m_data.size());
+            return;
+        }
+
+        {
+            wil::unique_mapview_ptr<uint8_t> writeView{ static_cast<uint8_t*>(MapViewOfFile(mapping.get(), FILE_MAP_WRITE, 0, 0, data.size())) };
+            THROW_LAST_ERROR_IF_NULL_MSG(writeView, "failed mapping search snapshot to write");
+            std::memcpy(writeView.get(), data.data(), data.size());
+        }
+
+        m_view.reset(static_cast<uint8_t*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, data.size())));
+        THROW_LAST_ERROR_IF_NULL_MSG(m_view, "failed mapping search snapshot");
+        m_mapping = std::move(mapping);
+
+        Attach(m_view.get(), data.size());
+        AICLI_LOG(Repo, Info, << "Loaded and shared search snapshot of " << data.size() << " bytes with " << m_manifestCount << " manifests: " << sharedName);
+    }
+
+    std::vector<uint8_t> SearchSnapshot::Serialize(SQLite::Connection& connection)
+    {
+        SnapshotWriter writer;
+        SerializedHeader header{};
+        header.Magic = s_SearchSnapshot_Magic;
+        header.Version = s_SearchSnapshot_Version;
+
+        std::unordered_map<SQLite::rowid_t, uint32_t> manifestPositions;
+        std::vector<int64_t> manifestRowIds;
+
+        {
+            SQLite::Builder::StatementBuilder builder;
+            builder.Select(SQLite::RowIDName).From(ManifestTable::TableName()).OrderBy(SQLite::RowIDName);
+
+            SQLite::Statement select = builder.Prepare(connection);
+
+            while (select.Step())
+            {
+                SQLite::rowid_t manifestId = select.GetColumn<SQLite::rowid_t>(0);
+                manifestPositions[manifestId] = static_cast<uint32_t>(manifestRowIds.size());
+                manifestRowIds.push_back(manifestId);
+            }
+        }
+
+        std::vector<uint32_t> idPositions = SerializeField<IdTable>(connection, manifestPositions, writer, header.Fields[GetFieldIndex(ApplicationMatchField::Id)]);
+        SerializeField<NameTable>(connection, manifestPositions, writer, header.Fields[GetFieldIndex(ApplicationMatchField::Name)]);
+        SerializeField<MonikerTable>(connection, manifestPositions, writer, header.Fields[GetFieldIndex(ApplicationMatchField::Moniker)]);
+        SerializeField<CommandsTable>(connection, manifestPositions, writer, header.Fields[GetFieldIndex(ApplicationMatchField::Command)]);
+        SerializeField<TagsTable>(connection, manifestPositions, writer, header.Fields[GetFieldIndex(ApplicationMatchField::Tag)]);
+
+        // Every manifest has exactly one Id; record it directly for grouping the results.
+        THROW_HR_IF(E_UNEXPECTED, idPositions.size() != manifestRowIds.size());
+
+        header.ManifestCount = static_cast<uint32_t>(manifestRowIds.size());
+        header.ManifestRowIds = writer.Append(manifestRowIds);
+        header.ManifestIdPositions = writer.Append(idPositions);
+        header.Size = writer.Data.size();
+
+        std::memcpy(writer.Data.data(), &header, sizeof(header));
+
+        return std::move(writer.Data);
+    }
+
+    bool SearchSnapshot::TryMapShared(const std::wstring& sectionName)
+    {
+        wil::unique_handle mapping{ OpenFileMappingW(FILE_MAP_READ, FALSE, sectionName.c_str()) };
+        if (!mapping)
+        {
+            return false;
+        }
+
+        wil::unique_mapview_ptr<uint8_t> view{ static_cast<uint8_t*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0)) };
+        if (!view)
+        {
+            LOG_LAST_ERROR_MSG("failed mapping shared search snapshot");
+            return false;
+        }
+
+        // The view covers the whole section, rounded up to a page
+        MEMORY_BASIC_INFORMATION info{};
+        if (!VirtualQuery(view.get(), &info, sizeof(info)))
+        {
+            LOG_LAST_ERROR_MSG("failed querying shared search snapshot");
+            return false;
+        }
+
+        try
+        {
+            Attach(view.get(), info.RegionSize);
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION_MSG("Shared search snapshot is not valid");
+            return false;
+        }
+
+        m_mapping = std::move(mapping);
+        m_view = std::move(view);
+        return true;
+    }
+
+    void SearchSnapshot::Attach(const uint8_t* data, size_t size)
+    {
+        SerializedHeader header{};
+        THROW_HR_IF(s_CorruptSnapshotError, size < sizeof(header));
+        std::memcpy(&header, data, sizeof(header));
+
+        THROW_HR_IF(s_CorruptSnapshotError, header.Magic != s_SearchSnapshot_Magic);
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_UNSUPPORTED_TYPE), header.Version != s_SearchSnapshot_Version);
+        THROW_HR_IF(s_CorruptSnapshotError, header.Size < sizeof(header) || header.Size > size);
+
+        // Gets an array of the snapshot, checking that it is within it and aligned for its type
+        auto getArray = [&](uint64_t offset, uint64_t count, size_t elementSize) -> const uint8_t*
+        {
+            THROW_HR_IF(s_CorruptSnapshotError, offset % s_SerializedAlignment != 0 || offset > header.Size || count > (header.Size - offset) / elementSize);
+            return data + offset;
+        };
+
+        // Also checks that every entry is below the limit
+        auto getPositions = [&](uint64_t offset, uint64_t count, uint32_t limit) -> const uint32_t*
+        {
+            const uint32_t* result = reinterpret_cast<const uint32_t*>(getArray(offset, count, sizeof(uint32_t)));
+            THROW_HR_IF(s_CorruptSnapshotError, std::any_of(result, result + count, [&](uint32_t position) { return position >= limit; }));
+            return result;
+        };
+
+        // Offsets delimit the strings, so they must not decrease or go past the end of them
+        auto getStringOffsets = [&](uint64_t offset, uint64_t count, uint64_t stringsSize) -> const uint32_t*
+        {
+            const uint32_t* result = reinterpret_cast<const uint32_t*>(getArray(offset, count, sizeof(uint32_t)));
+            THROW_HR_IF(s_CorruptSnapshotError, count == 0 || result[count - 1] > stringsSize || !std::is_sorted(result, result + count));
+            return result;
+        };
+
+        for (size_t i = 0; i < m_fields.size(); ++i)
+        {
+            const SerializedField& serialized = header.Fields[i];
+            FieldColumn& column = m_fields[i];
+
+            column.ValueCount = serialized.ValueCount;
+            column.AssociationCount = serialized.AssociationCount;
+            column.RowIds = reinterpret_cast<const int64_t*>(getArray(serialized.RowIds, serialized.ValueCount, sizeof(int64_t)));
+            column.ValueOffsets = getStringOffsets(serialized.ValueOffsets, static_cast<uint64_t>(serialized.ValueCount) + 1, serialized.StringsSize);
+            column.FoldedValueOffsets = getStringOffsets(serialized.FoldedValueOffsets, static_cast<uint64_t>(serialized.ValueCount) + 1, serialized.StringsSize);
+            column.Strings = reinterpret_cast<const char*>(getArray(serialized.Strings, serialized.StringsSize, 1));
+            column.Manifests = getPositions(serialized.Manifests, serialized.AssociationCount, header.ManifestCount);
+            column.ValueIndices = getPositions(serialized.ValueIndices, serialized.AssociationCount, serialized.ValueCount);
+        }
+
+        const FieldColumn& idColumn = GetField(ApplicationMatchField::Id);
+        THROW_HR_IF(s_CorruptSnapshotError, idColumn.AssociationCount != header.ManifestCount);
+
+        m_manifestCount = header.ManifestCount;
+        m_manifestRowIds = reinterpret_cast<const int64_t*>(getArray(header.ManifestRowIds, header.ManifestCount, sizeof(int64_t)));
+        m_manifestIdPositions = getPositions(header.ManifestIdPositions, header.ManifestCount, idColumn.ValueCount);
+
+        m_memoryRegistration.SetUsage(size);
+    }
+
+    const SearchSnapshot::FieldColumn& SearchSnapshot::GetField(ApplicationMatchField field) const
+    {
+        return m_fields[GetFieldIndex(field)];
+    }
+
+    std::vector<bool> SearchSnapshot::MatchValues(const FieldColumn& column, MatchType match, std::string_view value) const
+    {
+        // TODO: Implement these more complex match types
+        if (match == MatchType::Fuzzy || match == MatchType::FuzzySubstring)
+        {
+            AICLI_LOG(Repo, Verbose, << "Specific match type not implemented, skipping: " << MatchTypeToString(match));
+            return {};
+        }
+
+        std::vector<bool> result(column.ValueCount);
+
+        if (match == MatchType::Exact)
+        {
+            for (size_t i = 0; i < column.ValueCount; ++i)
+            {
+                result[i] = (column.GetValue(i) == value);
+            }
+
+            return result;
+        }
+
+        if (match == MatchType::Wildcard)
+        {
+            WildcardPattern pattern{ value };
+            const std::string& prefix = pattern.GetLiteralPrefix();
+
+            for (size_t i = 0; i < column.ValueCount; ++i)
+            {
+                std::string_view folded = column.GetFoldedValue(i);
+                result[i] = (folded.compare(0, prefix.length(), prefix) == 0 && pattern.Matches(folded));
+            }
+
+            return result;
+        }
+
+        std::string foldedValue = Utility::FoldCase(value);
+
+        for (size_t i = 0; i < column.ValueCount; ++i)
+        {
+            std::string_view folded = column.GetFoldedValue(i);
+
+            switch (match)
+            {
+            case MatchType::CaseInsensitive:
+                result[i] = (folded == foldedValue);
+                break;
+            case MatchType::StartsWith:
+                result[i] = (folded.compare(0, foldedValue.length(), foldedValue) == 0);
+                break;
+            case MatchType::Substring:
+                result[i] = (folded.find(foldedValue) != std::string::npos);
+                break;
+            default:
+                THROW_HR(E_UNEXPECTED);
+            }
+        }
+
+        return result;
+    }
+
+    SearchSnapshot::Results::Results(const SearchSnapshot& snapshot) :
+        m_snapshot(snapshot)
+    {
+    }
+
+    void SearchSnapshot::Results::SearchOnField(ApplicationMatchField field, MatchType match, std::string_view value)
+    {
+        int sortOrdinal = m_sortOrdinalValue++;
+
+        const FieldColumn& column = m_snapshot.GetField(field);
+        std::vector<bool> matches = m_snapshot.MatchValues(column, match, value);
+
+        if (matches.empty())
+        {
+            return;
+        }
+
+        size_t previousCount = m_rows.size();
+
+        for (size_t i = 0; i < column.AssociationCount; ++i)
+        {
+            uint32_t valueIndex = column.ValueIndices[i];
+            if (matches[valueIndex])
+            {
+                m_rows.push_back({ column.Manifests[i], field, match, valueIndex, sortOrdinal, false });
+            }
+        }
+
+        AICLI_LOG(Repo, Verbose, << "Search found " << (m_rows.size() - previousCount) << " rows");
+    }
+
+    void SearchSnapshot::Results::RemoveDuplicateManifestRows()
+    {
+        // Rows are always in sort order, so the first row for a manifest is the one to keep.
+        std::vector<bool> manifestSeen(m_snapshot.GetManifestCount());
+        size_t previousCount = m_rows.size();
+
+        m_rows.erase(std::remove_if(m_rows.begin(), m_rows.end(), [&](const Row& row)
+            {
+                if (manifestSeen[row.Manifest])
+                {
+                    return true;
+                }
+
+                manifestSeen[row.Manifest] = true;
+                return false;
+            }), m_rows.end());
+
+        AICLI_LOG(Repo, Verbose, << "Removed " << (previousCount - m_rows.size()) << " duplicate rows");
+    }
+
+    void SearchSnapshot::Results::PrepareToFilter()
+    {
+        for (Row& row : m_rows)
+        {
+            row.Filter = false;
+        }
+    }
+
+    void SearchSnapshot::Results::FilterOnField(ApplicationMatchField field, MatchType match, std::string_view value)
+    {
+        const FieldColumn& column = m_snapshot.GetField(field);
+        std::vector<bool> matches = m_snapshot.MatchValues(column, match, value);
+
+        if (matches.empty())
+        {
+            return;
+        }
+
+        std::vector<bool> manifestMatches(m_snapshot.GetManifestCount());
+        for (size_t i = 0; i < column.AssociationCount; ++i)
+        {
+            if (matches[column.ValueIndices[i]])
+            {
+                manifestMatches[column.Manifests[i]] = true;
+            }
+        }
+
+        size_t keptCount = 0;
+        for (Row& row : m_rows)
+        {
+            if (manifestMatches[row.Manifest])
+            {
+                row.Filter = true;
+                ++keptCount;
+            }
+        }
+
+        AICLI_LOG(Repo, Verbose, << "Filter kept " << keptCount << " rows");
+    }
+
+    void SearchSnapshot::Results::CompleteFilter()
+    {
+        size_t previousCount = m_rows.size();
+
+        m_rows.erase(std::remove_if(m_rows.begin(), m_rows.end(), [](const Row& row) { return !row.Filter; }), m_rows.end());
+
+        AICLI_LOG(Repo, Verbose, << "Filter deleted " << (previousCount - m_rows.size()) << " rows");
+    }
+
+    bool SearchSnapshot::Results::HasMoreIdsThan(size_t count) const
+    {
+        std::vector<bool> idSeen(m_snapshot.GetField(ApplicationMatchField::Id).ValueCount);
+        size_t idCount = 0;
+
+        for (const Row& row : m_rows)
+        {
+            uint32_t idPosition = m_snapshot.m_manifestIdPositions[row.Manifest];
+            if (!idSeen[idPosition])
+            {
+                idSeen[idPosition] = true;
+                if (++idCount > count)
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    ISQLiteIndex::SearchResult SearchSnapshot::Results::GetSearchResults(size_t limit)
+    {
+        const FieldColumn& idColumn = m_snapshot.GetField(ApplicationMatchField::Id);
+
+        // Only the first row for each id is returned; as the rows are in sort order,
+        // this is one of the rows that matched through the earliest search.
+        std::vector<bool> idSeen(idColumn.ValueCount);
+
+        ISQLiteIndex::SearchResult result;
+        for (const Row& row : m_rows)
+        {
+            uint32_t idPosition = m_snapshot.m_manifestIdPositions[row.Manifest];
+            if (idSeen[idPosition])
+            {
+                continue;
+            }
+
+            if (limit && result.Matches.size() >= limit)
+            {
+                result.Truncated = true;
+                break;
+            }
+
+            idSeen[idPosition] = true;
+            result.Matches.emplace_back(idColumn.RowIds[idPosition],
+                ApplicationMatchFilter(row.Field, row.Match, std::string{ m_snapshot.GetField(row.Field).GetValue(row.Value) }));
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,153 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+#include "Microsoft/Schema/ISQLiteIndex.h"
+#include "AppInstallerRepositorySearch.h"
+
+#include <wil/resource.h>
+#include <winget/MemoryBudget.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_0
+{
+    // An in memory copy of the searchable values in an index, stored by column.
+    // This must only be used with an index that will not change while it is open, as changes are not reflected.
+    //
+    // The values are serialized into a single read only buffer that refers to its parts by offset, so that the same bytes
+    // can be used at any address. A snapshot given a shared name is kept in a named section: the first process builds it,
+    // and every other process that opens the same index maps it rather than loading it again, sharing the memory.
+    struct SearchSnapshot
+    {
+        // Loads the searchable values from the index.
+        // If the shared name is not empty, the snapshot of another process with the same name is used if there is one,
+        // and otherwise the one loaded is shared under it. The name must identify the contents of the index, such as by
+        // the version of the package that holds it, and follows the naming of a CrossProcessReaderWriteLock.
+        SearchSnapshot(SQLite::Connection& connection, std::string_view sharedName = {});
+
+        SearchSnapshot(const SearchSnapshot&) = delete;
+        SearchSnapshot& operator=(const SearchSnapshot&) = delete;
+
+        SearchSnapshot(SearchSnapshot&&) = default;
+        SearchSnapshot& operator=(SearchSnapshot&&) = default;
+
+        // Gets the number of manifests in the snapshot.
+        size_t GetManifestCount() const { return m_manifestCount; }
+
+        // Determines whether the snapshot is mapped from a section shared with other processes.
+        bool IsShared() const { return static_cast<bool>(m_view); }
+
+        // Holds search results against the snapshot.
+        // Mirrors the operations and semantics of the SearchResultsTable, without using the database.
+        struct Results
+        {
+            Results(const SearchSnapshot& snapshot);
+
+            // Performs the requested search type on the requested field.
+            void SearchOnField(ApplicationMatchField field, MatchType match, std::string_view value);
+
+            // Removes rows with manifest ids whose sort order is below the highest one.
+            void RemoveDuplicateManifestRows();
+
+            // Prepares the results for a filtering pass.
+            void PrepareToFilter();
+
+            // Performs the requested filter type on the requested field.
+            void FilterOnField(ApplicationMatchField field, MatchType match, std::string_view value);
+
+            // Completes a filtering pass, removing filtered rows.
+            void CompleteFilter();
+
+            // Determines if the results hold rows for more than the given number of distinct ids.
+            bool HasMoreIdsThan(size_t count) const;
+
+            // Gets the results.
+            ISQLiteIndex::SearchResult GetSearchResults(size_t limit = 0);
+
+        private:
+            struct Row
+            {
+                uint32_t Manifest;
+                ApplicationMatchField Field;
+                MatchType Match;
+                uint32_t Value;
+                int Sort;
+                bool Filter;
+            };
+
+            const SearchSnapshot& m_snapshot;
+            std::vector<Row> m_rows;
+            int m_sortOrdinalValue = 0;
+        };
+
+    private:
+        // The values of a single field, as a view of the arrays in the serialized snapshot.
+        struct FieldColumn
+        {
+            // The number of distinct values, and of pairs of { manifest position, value position }.
+            uint32_t ValueCount = 0;
+            uint32_t AssociationCount = 0;
+
+            // The rowid of each value.
+            const int64_t* RowIds = nullptr;
+
+            // The value and its case folded form are the bytes between consecutive offsets into the strings.
+            const uint32_t* ValueOffsets = nullptr;
+            const uint32_t* FoldedValueOffsets = nullptr;
+            const char* Strings = nullptr;
+
+            // The pairs, stored as parallel arrays ordered by manifest position.
+            const uint32_t* Manifests = nullptr;
+            const uint32_t* ValueIndices = nullptr;
+
+            std::string_view GetValue(size_t index) const
+            {
+                return { Strings + ValueOffsets[index], ValueOffsets[index + 1] - ValueOffsets[index] };
+            }
+
+            std::string_view GetFoldedValue(size_t index) const
+            {
+                return { Strings + FoldedValueOffsets[index], FoldedValueOffsets[index + 1] - FoldedValueOffsets[index] };
+            }
+        };
+
+        // Reads the searchable values from the index into the serialized form.
+        static std::vector<uint8_t> Serialize(SQLite::Connection& connection);
+
+        // Maps the section with the given name, if it exists and holds a valid snapshot.
+        bool TryMapShared(const std::wstring& mappingName);
+
+        // Sets the columns to view the serialized snapshot, throwing if it is not well formed.
+        // The bytes may come from another process, so every offset and position in them is checked.
+        void Attach(const uint8_t* data, size_t size);
+
+        // Gets the column for the given field.
+        const FieldColumn& GetField(ApplicationMatchField field) const;
+
+        // Determines which of the values in the field match the given value.
+        // Returns an empty vector if the match type is not supported.
+        std::vector<bool> MatchValues(const FieldColumn& column, MatchType match, std::string_view value) const;
+
+        // The serialized snapshot, either owned by this object or mapped from a shared section.
+        std::vector<uint8_t> m_data;
+        wil::unique_handle m_mapping;
+        wil::unique_mapview_ptr<uint8_t> m_view;
+
+        // The rowid of each manifest, and the position of its Id value, at the same position.
+        uint32_t m_manifestCount = 0;
+        const int64_t* m_manifestRowIds = nullptr;
+        const uint32_t* m_manifestIdPositions = nullptr;
+
+        // Columns for Id, Name, Moniker, Command, and Tag; ordered as ApplicationMatchField.
+        std::array<FieldColumn, 5> m_fields;
+
+        // Reports the size of the snapshot to the memory budget; searches rely on it, so it is never trimmed.
+        Memory::MemoryBudget::Registration m_memoryRegistration;
+    };
+}
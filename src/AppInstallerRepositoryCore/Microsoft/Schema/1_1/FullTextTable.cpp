@@ -0,0 +1,261 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/1_1/FullTextTable.h"
+
+#include "Microsoft/Schema/1_0/IdTable.h"
+#include "Microsoft/Schema/1_0/NameTable.h"
+#include "Microsoft/Schema/1_0/MonikerTable.h"
+#include "Microsoft/Schema/1_0/ManifestTable.h"
+#include "Microsoft/Schema/1_0/TagsTable.h"
+#include "Microsoft/Schema/1_0/CommandsTable.h"
+
+#include <array>
+#include <map>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_1
+{
+    namespace
+    {
+        using namespace std::string_view_literals;
+        static constexpr std::string_view s_FullTextTable_Table_Name = "manifest_fts"sv;
+
+        // The diacritics are kept so that the matching agrees with the case folding done for the other match types.
+        static constexpr std::string_view s_FullTextTable_Table_Create = R"(
+CREATE VIRTUAL TABLE [manifest_fts] USING fts5(
+    [id], [name], [moniker], [command], [tag],
+    content = '', tokenize = 'unicode61 remove_diacritics 0'))"sv;
+
+        static constexpr std::string_view s_FullTextTable_Rank = "rank"sv;
+
+        std::string_view GetColumnName(ApplicationMatchField field)
+        {
+            switch (field)
+            {
+            case ApplicationMatchField::Id:
+                return V1_0::IdTable::ValueName();
+            case ApplicationMatchField::Name:
+                return V1_0::NameTable::ValueName();
+            case ApplicationMatchField::Moniker:
+                return V1_0::MonikerTable::ValueName();
+            case ApplicationMatchField::Command:
+                return V1_0::CommandsTable::ValueName();
+            case ApplicationMatchField::Tag:
+                return V1_0::TagsTable::ValueName();
+            default:
+                THROW_HR(E_UNEXPECTED);
+            }
+        }
+
+        using ManifestValues = std::map<SQLite::rowid_t, std::array<std::string, 5>>;
+
+        // Appends the values of the table to those of each manifest, space separated for 1:N values.
+        template <typename Table>
+        void LoadValues(SQLite::Connection& connection, ApplicationMatchField field, ManifestValues& values)
+        {
+            using QCol = SQLite::Builder::QualifiedColumn;
+
+            SQLite::Builder::StatementBuilder builder;
+            if constexpr (Table::IsOneToOne())
+            {
+                builder.Select({ QCol(V1_0::ManifestTable::TableName(), SQLite::RowIDName), QCol(Table::TableName(), Table::ValueName()) }).
+                    From(V1_0::ManifestTable::TableName()).Join(Table::TableName()).
+                    On(QCol(V1_0::ManifestTable::TableName(), Table::ValueName()), QCol(Table::TableName(), SQLite::RowIDName));
+
+                SQLite::Statement select = builder.Prepare(connection);
+                while (select.Step())
+                {
+                    values[select.GetColumn<SQLite::rowid_t>(0)][static_cast<size_t>(field)] = select.GetColumn<std::string>(1);
+                }
+            }
+            else
+            {
+                std::string mapTableName = V1_0::details::OneToManyTableGetMapTableName(Table::TableName());
+                builder.Select({ QCol(mapTableName, V1_0::details::OneToManyTableGetManifestColumnName()), QCol(Table::TableName(), Table::ValueName()) }).
+                    From(mapTableName).Join(Table::TableName()).
+                    On(QCol(mapTableName, Table::ValueName()), QCol(Table::TableName(), SQLite::RowIDName));
+
+                SQLite::Statement select = builder.Prepare(connection);
+                while (select.Step())
+                {
+                    std::string& current = values[select.GetColumn<SQLite::rowid_t>(0)][static_cast<size_t>(field)];
+                    if (!current.empty())
+                    {
+                        current += ' ';
+                    }
+                    current += select.GetColumn<std::string>(1);
+                }
+            }
+        }
+
+        bool TableExists(SQLite::Connection& connection)
+        {
+            SQLite::Builder::StatementBuilder builder;
+            builder.Select(SQLite::Builder::RowCount).From("sqlite_master"sv).Where("type"sv).Equals("table"sv).And("name"sv).Equals(s_FullTextTable_Table_Name);
+
+            SQLite::Statement select = builder.Prepare(connection);
+            THROW_HR_IF(E_UNEXPECTED, !select.Step());
+            return select.GetColumn<int>(0) != 0;
+        }
+    }
+
+    std::string BuildFullTextQuery(ApplicationMatchField field, std::string_view value)
+    {
+        std::string_view column = GetColumnName(field);
+        std::string result;
+
+        // Build a query like:
+        //      name : "windows"* AND name : "term"*
+        // Each token is quoted so that it is never interpreted as query syntax; the tokenizer
+        // will still split it further on punctuation, making that portion a phrase.
+        size_t pos = 0;
+        while (pos < value.length())
+        {
+            size_t start = value.find_first_not_of(" \t\r\n"sv, pos);
+            if (start == std::string_view::npos)
+            {
+                break;
+            }
+
+            size_t end = value.find_first_of(" \t\r\n"sv, start);
+            if (end == std::string_view::npos)
+            {
+                end = value.length();
+            }
+
+            if (!result.empty())
+            {
+                result += " AND ";
+            }
+
+            result += column;
+            result += " : \"";
+            for (char c : value.substr(start, end - start))
+            {
+                if (c == '"')
+                {
+                    result += '"';
+                }
+                result += c;
+            }
+            result += "\"*";
+
+            pos = end;
+        }
+
+        return result;
+    }
+
+    std::string_view FullTextTable::TableName()
+    {
+        return s_FullTextTable_Table_Name;
+    }
+
+    bool FullTextTable::CreateAndPopulate(SQLite::Connection& connection)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "createfulltext_v1_1");
+
+        Drop(connection);
+
+        try
+        {
+            SQLite::Statement create = SQLite::Statement::Create(connection, s_FullTextTable_Table_Create);
+            create.Execute();
+        }
+        catch (const SQLite::SQLiteException&)
+        {
+            AICLI_LOG(Repo, Info, << "FTS5 is not available, the full text table will not be created");
+            return false;
+        }
+
+        ManifestValues values;
+        LoadValues<V1_0::IdTable>(connection, ApplicationMatchField::Id, values);
+        LoadValues<V1_0::NameTable>(connection, ApplicationMatchField::Name, values);
+        LoadValues<V1_0::MonikerTable>(connection, ApplicationMatchField::Moniker, values);
+        LoadValues<V1_0::CommandsTable>(connection, ApplicationMatchField::Command, values);
+        LoadValues<V1_0::TagsTable>(connection, ApplicationMatchField::Tag, values);
+
+        SQLite::Builder::StatementBuilder insertBuilder;
+        insertBuilder.InsertInto(s_FullTextTable_Table_Name).Columns({
+            SQLite::RowIDName,
+            GetColumnName(ApplicationMatchField::Id),
+            GetColumnName(ApplicationMatchField::Name),
+            GetColumnName(ApplicationMatchField::Moniker),
+            GetColumnName(ApplicationMatchField::Command),
+            GetColumnName(ApplicationMatchField::Tag) }).
+            Values(SQLite::Builder::Unbound, SQLite::Builder::Unbound, SQLite::Builder::Unbound, SQLite::Builder::Unbound, SQLite::Builder::Unbound, SQLite::Builder::Unbound);
+
+        SQLite::Statement insert = insertBuilder.Prepare(connection);
+
+        for (const auto& manifest : values)
+        {
+            insert.Reset();
+            insert.Bind(1, manifest.first);
+            for (size_t i = 0; i < manifest.second.size(); ++i)
+            {
+                insert.Bind(static_cast<int>(i + 2), manifest.second[i]);
+            }
+            insert.Execute();
+        }
+
+        AICLI_LOG(Repo, Verbose, << "Added " << values.size() << " manifests to " << s_FullTextTable_Table_Name);
+
+        savepoint.Commit();
+        return true;
+    }
+
+    void FullTextTable::Drop(SQLite::Connection& connection)
+    {
+        // Checking first allows modification of an index without the table, even if FTS5 is not available.
+        if (TableExists(connection))
+        {
+            SQLite::Builder::StatementBuilder builder;
+            builder.DropTable(s_FullTextTable_Table_Name);
+
+            builder.Execute(connection);
+        }
+    }
+
+    bool FullTextTable::IsAvailable(SQLite::Connection& connection)
+    {
+        if (!TableExists(connection))
+        {
+            return false;
+        }
+
+        try
+        {
+            // Only look for the first row; this fails if the table was created by a SQLite that supports FTS5 but this one does not.
+            SQLite::Builder::StatementBuilder builder;
+            builder.Select(SQLite::RowIDName).From(s_FullTextTable_Table_Name).Limit(1);
+
+            SQLite::Statement select = builder.Prepare(connection);
+            return select.Step();
+        }
+        catch (const SQLite::SQLiteException&)
+        {
+            AICLI_LOG(Repo, Info, << "The full text table exists but FTS5 is not available");
+            return false;
+        }
+    }
+
+    bool FullTextTable::BuildSearchStatement(SQLite::Builder::StatementBuilder& builder, ApplicationMatchField field, std::string_view value,
+        std::string_view manifestAlias, std::string_view valueAlias)
+    {
+        std::string query = BuildFullTextQuery(field, value);
+        if (query.empty())
+        {
+            return false;
+        }
+
+        // The table does not store the values, so the value that matched is reported as the search value.
+        // The goal is a statement like this:
+        //      SELECT rowid AS m, <value> AS v FROM manifest_fts WHERE manifest_fts MATCH <query> ORDER BY rank
+        builder.Select().Column(SQLite::Builder::QualifiedColumn(s_FullTextTable_Table_Name, SQLite::RowIDName)).As(manifestAlias).
+            Value(std::string{ value }).As(valueAlias).
+            From(s_FullTextTable_Table_Name).Where(s_FullTextTable_Table_Name).Match(query).OrderBy(s_FullTextTable_Rank);
+
+        return true;
+    }
+}
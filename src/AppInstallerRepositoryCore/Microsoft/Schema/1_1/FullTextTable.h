@@ -0,0 +1,41 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+#include "SQLiteStatementBuilder.h"
+#include "AppInstallerRepositorySearch.h"
+#include <string>
+#include <string_view>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_1
+{
+    // Builds the full text query that matches every whitespace separated token of the value,
+    // as a prefix of a token in the column for the given field.
+    // Returns an empty string if the value contains no tokens.
+    std::string BuildFullTextQuery(ApplicationMatchField field, std::string_view value);
+
+    // A full text (FTS5) table holding the searchable values of every manifest, with a column for each field.
+    // The table is contentless; it can only be used to find the manifests that match, not to retrieve the values.
+    // It is only created when packaging, and only if the SQLite in use supports FTS5.
+    struct FullTextTable
+    {
+        // The name of the table.
+        static std::string_view TableName();
+
+        // Creates and populates the table, replacing any existing one.
+        // Returns false if FTS5 is not available, leaving the index without the table.
+        static bool CreateAndPopulate(SQLite::Connection& connection);
+
+        // Drops the table if it exists, as it no longer reflects the values.
+        static void Drop(SQLite::Connection& connection);
+
+        // Determines if the table exists, is usable by this SQLite, and contains values.
+        static bool IsAvailable(SQLite::Connection& connection);
+
+        // Builds a statement that selects the rowid of the manifests matching the value in the given field,
+        // along with the value itself, as the given aliases.  Returns false if the value contains no tokens.
+        static bool BuildSearchStatement(SQLite::Builder::StatementBuilder& builder, ApplicationMatchField field, std::string_view value,
+            std::string_view manifestAlias, std::string_view valueAlias);
+    };
+}
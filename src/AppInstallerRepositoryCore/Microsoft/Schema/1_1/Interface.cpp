@@ -0,0 +1,148 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/1_1/Interface.h"
+
+#include "Microsoft/Schema/1_0/IdTable.h"
+#include "Microsoft/Schema/1_0/NameTable.h"
+#include "Microsoft/Schema/1_0/MonikerTable.h"
+#include "Microsoft/Schema/1_0/TagsTable.h"
+#include "Microsoft/Schema/1_0/CommandsTable.h"
+
+#include "Microsoft/Schema/1_1/TrigramTable.h"
+#include "Microsoft/Schema/1_1/FullTextTable.h"
+#include "Microsoft/Schema/1_1/SearchResultsTable.h"
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_1
+{
+    namespace
+    {
+        // Removes all trigrams and the full text table, as any change to the index can invalidate them.
+        // They are only recreated by PrepareForPackaging.
+        void ClearSearchTables(SQLite::Connection& connection)
+        {
+            TrigramTable<V1_0::IdTable>::Clear(connection);
+            TrigramTable<V1_0::NameTable>::Clear(connection);
+            TrigramTable<V1_0::MonikerTable>::Clear(connection);
+            TrigramTable<V1_0::TagsTable>::Clear(connection);
+            TrigramTable<V1_0::CommandsTable>::Clear(connection);
+            FullTextTable::Drop(connection);
+        }
+
+        // Creates the tables that were added by this version.
+        void CreateVersionTables(SQLite::Connection& connection)
+        {
+            TrigramTable<V1_0::IdTable>::Create(connection);
+            TrigramTable<V1_0::NameTable>::Create(connection);
+            TrigramTable<V1_0::MonikerTable>::Create(connection);
+            TrigramTable<V1_0::TagsTable>::Create(connection);
+            TrigramTable<V1_0::CommandsTable>::Create(connection);
+        }
+    }
+
+    Schema::Version Interface::GetVersion() const
+    {
+        return { 1, 1 };
+    }
+
+    void Interface::CreateTables(SQLite::Connection& connection)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "createtables_v1_1");
+
+        V1_0::Interface::CreateTables(connection);
+        CreateVersionTables(connection);
+
+        savepoint.Commit();
+    }
+
+    void Interface::AddManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "addmanifest_v1_1");
+
+        V1_0::Interface::AddManifest(connection, manifest, relativePath);
+        ClearSearchTables(connection);
+
+        savepoint.Commit();
+    }
+
+    void Interface::AddManifests(SQLite::Connection& connection, const std::vector<std::pair<Manifest::Manifest, std::filesystem::path>>& manifests)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "addmanifests_v1_1");
+
+        V1_0::Interface::AddManifests(connection, manifests);
+        ClearSearchTables(connection);
+
+        savepoint.Commit();
+    }
+
+    bool Interface::UpdateManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "updatemanifest_v1_1");
+
+        bool result = V1_0::Interface::UpdateManifest(connection, manifest, relativePath);
+
+        if (result)
+        {
+            ClearSearchTables(connection);
+        }
+
+        savepoint.Commit();
+
+        return result;
+    }
+
+    void Interface::RemoveManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "removemanifest_v1_1");
+
+        V1_0::Interface::RemoveManifest(connection, manifest, relativePath);
+        ClearSearchTables(connection);
+
+        savepoint.Commit();
+    }
+
+    void Interface::PrepareForPackaging(SQLite::Connection& connection)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "prepareforpackaging_v1_1");
+
+        TrigramTable<V1_0::IdTable>::Populate(connection);
+        TrigramTable<V1_0::NameTable>::Populate(connection);
+        TrigramTable<V1_0::MonikerTable>::Populate(connection);
+        TrigramTable<V1_0::TagsTable>::Populate(connection);
+        TrigramTable<V1_0::CommandsTable>::Populate(connection);
+
+        if (!FullTextTable::CreateAndPopulate(connection))
+        {
+            AICLI_LOG(Repo, Warning, << "Packaging without the full text table; fuzzy substring searches will not be possible");
+        }
+
+        savepoint.Commit();
+
+        // The base implementation vacuums, which must be done outside of an active transaction.
+        V1_0::Interface::PrepareForPackaging(connection);
+    }
+
+    void Interface::MigrateFrom(SQLite::Connection& connection, const Schema::Version& version)
+    {
+        // Not GetVersion, which a later version overrides when it migrates through this one
+        if (version == Schema::Version{ 1, 1 })
+        {
+            return;
+        }
+
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "migratefrom_v1_1");
+
+        V1_0::Interface::MigrateFrom(connection, version);
+
+        // The trigrams and full text table are only built for packaging, so they start out empty
+        CreateVersionTables(connection);
+
+        savepoint.Commit();
+    }
+
+    std::unique_ptr<V1_0::SearchResultsTable> Interface::CreateSearchResultsTable(SQLite::Connection& connection, bool inMemory) const
+    {
+        return std::make_unique<SearchResultsTable>(connection, inMemory);
+    }
+}
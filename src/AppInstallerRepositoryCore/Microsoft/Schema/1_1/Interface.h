@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Microsoft/Schema/1_0/Interface.h"
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_1
+{
+    // Interface to this schema version exposed through ISQLiteIndex.
+    struct Interface : public V1_0::Interface
+    {
+        // Version 1.0
+        Schema::Version GetVersion() const override;
+        void CreateTables(SQLite::Connection& connection) override;
+        void AddManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath) override;
+        void AddManifests(SQLite::Connection& connection, const std::vector<std::pair<Manifest::Manifest, std::filesystem::path>>& manifests) override;
+        bool UpdateManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath) override;
+        void RemoveManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath) override;
+        void PrepareForPackaging(SQLite::Connection& connection) override;
+        void MigrateFrom(SQLite::Connection& connection, const Schema::Version& version) override;
+
+    protected:
+        std::unique_ptr<V1_0::SearchResultsTable> CreateSearchResultsTable(SQLite::Connection& connection, bool inMemory) const override;
+    };
+}
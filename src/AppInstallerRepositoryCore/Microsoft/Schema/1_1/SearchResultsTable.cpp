@@ -0,0 +1,112 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/1_1/SearchResultsTable.h"
+#include "Microsoft/Schema/1_1/TrigramTable.h"
+#include "Microsoft/Schema/1_1/FullTextTable.h"
+
+#include "Microsoft/Schema/1_0/IdTable.h"
+#include "Microsoft/Schema/1_0/NameTable.h"
+#include "Microsoft/Schema/1_0/MonikerTable.h"
+#include "Microsoft/Schema/1_0/TagsTable.h"
+#include "Microsoft/Schema/1_0/CommandsTable.h"
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_1
+{
+    SearchResultsTable::SearchResultsTable(SQLite::Connection& connection, bool inMemory) :
+        V1_0::SearchResultsTable(connection, inMemory)
+    {
+    }
+
+    void SearchResultsTable::AddFieldConstraints(SQLite::Builder::StatementBuilder& builder, ApplicationMatchField field, MatchType match, std::string_view value)
+    {
+        if (match != MatchType::Substring)
+        {
+            return;
+        }
+
+        std::vector<int64_t> trigrams = GetTrigrams(value);
+        if (trigrams.empty() || !AreTrigramsAvailable(field))
+        {
+            return;
+        }
+
+        switch (field)
+        {
+        case ApplicationMatchField::Id:
+            TrigramTable<V1_0::IdTable>::AddCandidateConstraint(builder, trigrams);
+            break;
+        case ApplicationMatchField::Name:
+            TrigramTable<V1_0::NameTable>::AddCandidateConstraint(builder, trigrams);
+            break;
+        case ApplicationMatchField::Moniker:
+            TrigramTable<V1_0::MonikerTable>::AddCandidateConstraint(builder, trigrams);
+            break;
+        case ApplicationMatchField::Command:
+            TrigramTable<V1_0::CommandsTable>::AddCandidateConstraint(builder, trigrams);
+            break;
+        case ApplicationMatchField::Tag:
+            TrigramTable<V1_0::TagsTable>::AddCandidateConstraint(builder, trigrams);
+            break;
+        default:
+            THROW_HR(E_UNEXPECTED);
+        }
+    }
+
+    bool SearchResultsTable::BuildExtendedSearchStatement(SQLite::Builder::StatementBuilder& builder, ApplicationMatchField field, MatchType match, std::string_view value,
+        std::string_view manifestAlias, std::string_view valueAlias)
+    {
+        if (match != MatchType::FuzzySubstring)
+        {
+            return false;
+        }
+
+        // Like the trigram tables, the full text table is only present after packaging and is dropped by any later modification.
+        if (!m_fullTextAvailable)
+        {
+            m_fullTextAvailable = FullTextTable::IsAvailable(m_connection);
+        }
+
+        if (!m_fullTextAvailable.value())
+        {
+            return false;
+        }
+
+        return FullTextTable::BuildSearchStatement(builder, field, value, manifestAlias, valueAlias);
+    }
+
+    bool SearchResultsTable::AreTrigramsAvailable(ApplicationMatchField field)
+    {
+        std::optional<bool>& available = m_trigramsAvailable.at(static_cast<size_t>(field));
+
+        if (!available)
+        {
+            // The trigram tables are only populated when packaging and are cleared by any later modification,
+            // so a populated table always matches the values.  An empty one may simply mean no value is long enough,
+            // in which case scanning is still correct.
+            switch (field)
+            {
+            case ApplicationMatchField::Id:
+                available = !TrigramTable<V1_0::IdTable>::IsEmpty(m_connection);
+                break;
+            case ApplicationMatchField::Name:
+                available = !TrigramTable<V1_0::NameTable>::IsEmpty(m_connection);
+                break;
+            case ApplicationMatchField::Moniker:
+                available = !TrigramTable<V1_0::MonikerTable>::IsEmpty(m_connection);
+                break;
+            case ApplicationMatchField::Command:
+                available = !TrigramTable<V1_0::CommandsTable>::IsEmpty(m_connection);
+                break;
+            case ApplicationMatchField::Tag:
+                available = !TrigramTable<V1_0::TagsTable>::IsEmpty(m_connection);
+                break;
+            default:
+                THROW_HR(E_UNEXPECTED);
+            }
+        }
+
+        return available.value();
+    }
+}
@@ -0,0 +1,38 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Microsoft/Schema/1_0/SearchResultsTable.h"
+
+#include <array>
+#include <optional>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_1
+{
+    // Holds the results of a search request.
+    // Uses the trigram tables, when they are populated, to limit the values that substring matches must scan.
+    // Uses the full text table, when it is available, to implement fuzzy substring matches as token prefix matches.
+    struct SearchResultsTable : public V1_0::SearchResultsTable
+    {
+        SearchResultsTable(SQLite::Connection& connection, bool inMemory = false);
+
+        SearchResultsTable(const SearchResultsTable&) = delete;
+        SearchResultsTable& operator=(const SearchResultsTable&) = delete;
+
+        SearchResultsTable(SearchResultsTable&&) = default;
+        SearchResultsTable& operator=(SearchResultsTable&&) = default;
+
+    protected:
+        void AddFieldConstraints(SQLite::Builder::StatementBuilder& builder, ApplicationMatchField field, MatchType match, std::string_view value) override;
+
+        bool BuildExtendedSearchStatement(SQLite::Builder::StatementBuilder& builder, ApplicationMatchField field, MatchType match, std::string_view value,
+            std::string_view manifestAlias, std::string_view valueAlias) override;
+
+    private:
+        // Determines whether the trigram table for the field is populated, caching the result for the life of this object.
+        bool AreTrigramsAvailable(ApplicationMatchField field);
+
+        std::array<std::optional<bool>, 5> m_trigramsAvailable;
+        std::optional<bool> m_fullTextAvailable;
+    };
+}
@@ -0,0 +1,142 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/1_1/TrigramTable.h"
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_1
+{
+    namespace details
+    {
+        using namespace std::string_view_literals;
+        static constexpr std::string_view s_TrigramTable_Suffix = "_trigrams"sv;
+        static constexpr std::string_view s_TrigramTable_TrigramName = "trigram"sv;
+        static constexpr std::string_view s_TrigramTable_ValueName = "value"sv;
+
+        std::string TrigramTableGetTableName(std::string_view tableName)
+        {
+            std::string result(tableName);
+            result += s_TrigramTable_Suffix;
+            return result;
+        }
+
+        void CreateTrigramTable(SQLite::Connection& connection, std::string_view tableName)
+        {
+            using namespace SQLite::Builder;
+
+            // The primary key allows both the lookup of a trigram, and the retrieval of all values containing it, from the index alone.
+            StatementBuilder createTableBuilder;
+            createTableBuilder.CreateTable({ tableName, s_TrigramTable_Suffix }).Columns({
+                ColumnBuilder(s_TrigramTable_TrigramName, Type::Int64).NotNull(),
+                ColumnBuilder(s_TrigramTable_ValueName, Type::Int64).NotNull(),
+                PrimaryKeyBuilder({ s_TrigramTable_TrigramName, s_TrigramTable_ValueName })
+                });
+
+            createTableBuilder.Execute(connection);
+        }
+
+        void TrigramTablePopulate(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName)
+        {
+            SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, std::string{ tableName } + "_populatetrigrams_v1_1");
+
+            TrigramTableClear(connection, tableName);
+
+            SQLite::Builder::StatementBuilder selectBuilder;
+            selectBuilder.Select({ SQLite::RowIDName, valueName }).From(tableName);
+
+            SQLite::Statement select = selectBuilder.Prepare(connection);
+
+            SQLite::Builder::StatementBuilder insertBuilder;
+            insertBuilder.InsertInto({ tableName, s_TrigramTable_Suffix }).
+                Columns({ s_TrigramTable_TrigramName, s_TrigramTable_ValueName }).Values(SQLite::Builder::Unbound, SQLite::Builder::Unbound);
+
+            SQLite::Statement insert = insertBuilder.Prepare(connection);
+
+            size_t valueCount = 0;
+            size_t trigramCount = 0;
+
+            while (select.Step())
+            {
+                SQLite::rowid_t valueId = select.GetColumn<SQLite::rowid_t>(0);
+                ++valueCount;
+
+                for (int64_t trigram : GetTrigrams(select.GetColumn<std::string>(1)))
+                {
+                    insert.Reset();
+                    insert.Bind(1, trigram);
+                    insert.Bind(2, valueId);
+                    insert.Execute();
+                    ++trigramCount;
+                }
+            }
+
+            AICLI_LOG(Repo, Verbose, << "Added " << trigramCount << " trigrams for " << valueCount << " values to " << tableName << s_TrigramTable_Suffix);
+
+            savepoint.Commit();
+        }
+
+        void TrigramTableClear(SQLite::Connection& connection, std::string_view tableName)
+        {
+            SQLite::Builder::StatementBuilder builder;
+            builder.DeleteFrom({ tableName, s_TrigramTable_Suffix });
+
+            builder.Execute(connection);
+        }
+
+        bool TrigramTableIsEmpty(SQLite::Connection& connection, std::string_view tableName)
+        {
+            // Only look for the first row, as the table is potentially very large.
+            SQLite::Builder::StatementBuilder builder;
+            builder.Select(s_TrigramTable_TrigramName).From({ tableName, s_TrigramTable_Suffix }).Limit(1);
+
+            SQLite::Statement select = builder.Prepare(connection);
+
+            return !select.Step();
+        }
+
+        void TrigramTableAddCandidateConstraint(SQLite::Builder::StatementBuilder& builder, std::string_view tableName, const std::vector<int64_t>& trigrams)
+        {
+            using QCol = SQLite::Builder::QualifiedColumn;
+
+            std::string trigramTableName = TrigramTableGetTableName(tableName);
+
+            // Build a constraint like:
+            //      AND names.rowid IN (SELECT value FROM names_trigrams WHERE trigram = <t1>)
+            //      AND names.rowid IN (SELECT value FROM names_trigrams WHERE trigram = <t2>) ...
+            for (int64_t trigram : trigrams)
+            {
+                builder.And(QCol(tableName, SQLite::RowIDName)).In().BeginParenthetical().
+                    Select(s_TrigramTable_ValueName).From(trigramTableName).Where(s_TrigramTable_TrigramName).Equals(trigram).
+                    EndParenthetical();
+            }
+        }
+    }
+
+    std::vector<int64_t> GetTrigrams(std::string_view value)
+    {
+        std::vector<int64_t> result;
+
+        std::string folded = Utility::FoldCase(value);
+        if (folded.length() < 3)
+        {
+            return result;
+        }
+
+        // The trigrams are formed from bytes rather than code points; as UTF-8 is self synchronizing,
+        // a folded value contains the folded search value exactly when it contains it as a byte sequence.
+        for (size_t i = 0; i + 3 <= folded.length(); ++i)
+        {
+            int64_t trigram =
+                (static_cast<int64_t>(static_cast<uint8_t>(folded[i])) << 16) |
+                (static_cast<int64_t>(static_cast<uint8_t>(folded[i + 1])) << 8) |
+                static_cast<int64_t>(static_cast<uint8_t>(folded[i + 2]));
+
+            if (std::find(result.begin(), result.end(), trigram) == result.end())
+            {
+                result.push_back(trigram);
+            }
+        }
+
+        return result;
+    }
+}
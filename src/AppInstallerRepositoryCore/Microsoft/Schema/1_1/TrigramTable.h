@@ -0,0 +1,79 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+#include "SQLiteStatementBuilder.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_1
+{
+    namespace details
+    {
+        // Returns the trigram table name for a given value table.
+        std::string TrigramTableGetTableName(std::string_view tableName);
+
+        // Create the table.
+        void CreateTrigramTable(SQLite::Connection& connection, std::string_view tableName);
+
+        // Replaces the contents of the trigram table with the trigrams of every value in the value table.
+        void TrigramTablePopulate(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName);
+
+        // Removes all trigrams, as they no longer reflect the values.
+        void TrigramTableClear(SQLite::Connection& connection, std::string_view tableName);
+
+        // Determines if the table is empty.
+        bool TrigramTableIsEmpty(SQLite::Connection& connection, std::string_view tableName);
+
+        // Adds a constraint to the builder limiting the value table rowid to those containing all of the trigrams.
+        void TrigramTableAddCandidateConstraint(SQLite::Builder::StatementBuilder& builder, std::string_view tableName, const std::vector<int64_t>& trigrams);
+    }
+
+    // Gets the distinct trigrams of the case folded form of the value, in the order they first appear.
+    // Values too short to contain a trigram return an empty vector.
+    std::vector<int64_t> GetTrigrams(std::string_view value);
+
+    // A table that holds the trigrams of every value in a value table, allowing substring searches
+    // to look up a small set of candidate values rather than scanning the entire value table.
+    template <typename ValueTable>
+    struct TrigramTable
+    {
+        // The name of the table.
+        static std::string TableName()
+        {
+            return details::TrigramTableGetTableName(ValueTable::TableName());
+        }
+
+        // Creates the table.
+        static void Create(SQLite::Connection& connection)
+        {
+            details::CreateTrigramTable(connection, ValueTable::TableName());
+        }
+
+        // Replaces the contents of the table with the trigrams of every value in the value table.
+        static void Populate(SQLite::Connection& connection)
+        {
+            details::TrigramTablePopulate(connection, ValueTable::TableName(), ValueTable::ValueName());
+        }
+
+        // Removes all trigrams, as they no longer reflect the values.
+        static void Clear(SQLite::Connection& connection)
+        {
+            details::TrigramTableClear(connection, ValueTable::TableName());
+        }
+
+        // Determines if the table is empty.
+        static bool IsEmpty(SQLite::Connection& connection)
+        {
+            return details::TrigramTableIsEmpty(connection, ValueTable::TableName());
+        }
+
+        // Adds a constraint to the builder limiting the value table rowid to those containing all of the trigrams.
+        static void AddCandidateConstraint(SQLite::Builder::StatementBuilder& builder, const std::vector<int64_t>& trigrams)
+        {
+            details::TrigramTableAddCandidateConstraint(builder, ValueTable::TableName(), trigrams);
+        }
+    };
+}
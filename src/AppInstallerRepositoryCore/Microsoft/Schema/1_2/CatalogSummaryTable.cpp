@@ -0,0 +1,157 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/1_2/CatalogSummaryTable.h"
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    using namespace std::string_view_literals;
+
+    // The rowid is the position of the id in the catalog, so that a scan in rowid order reads the catalog in order.
+    static constexpr std::string_view s_CatalogSummaryTable_Table_Create = R"(
+CREATE TABLE [catalog_summary](
+    [position] INTEGER PRIMARY KEY NOT NULL,
+    [id] INT64 NOT NULL,
+    [id_value] TEXT NOT NULL,
+    [name] TEXT NOT NULL,
+    [versions] TEXT NOT NULL)
+)"sv;
+
+    // Statements
+    static constexpr std::string_view s_CatalogSummaryTableStmt_Insert =
+        "insert into [catalog_summary] ([position], [id], [id_value], [name], [versions]) values (?, ?, ?, ?, ?)"sv;
+    static constexpr std::string_view s_CatalogSummaryTableStmt_Clear = "delete from [catalog_summary]"sv;
+    static constexpr std::string_view s_CatalogSummaryTableStmt_IsEmpty = "select [position] from [catalog_summary] limit 1"sv;
+    static constexpr std::string_view s_CatalogSummaryTableStmt_GetSummaries =
+        "select [id], [id_value], [name], [versions] from [catalog_summary] order by [position] limit ?"sv;
+
+    namespace
+    {
+        // The versions are stored as a single value, each version and channel preceded by its length,
+        // so that any character can be in them.
+        void AppendEncoded(std::string& encoded, std::string_view value)
+        {
+            encoded += std::to_string(value.length());
+            encoded += ':';
+            encoded += value;
+        }
+
+        std::string EncodeVersions(const std::vector<Utility::VersionAndChannel>& versions)
+        {
+            std::string result;
+            for (const auto& version : versions)
+            {
+                AppendEncoded(result, version.GetVersion().ToString());
+                AppendEncoded(result, version.GetChannel().ToString());
+            }
+            return result;
+        }
+
+        std::string_view ReadEncoded(std::string_view& encoded)
+        {
+            size_t separator = encoded.find(':');
+            THROW_HR_IF(E_UNEXPECTED, separator == std::string_view::npos);
+
+            size_t length = std::stoull(std::string{ encoded.substr(0, separator) });
+            THROW_HR_IF(E_UNEXPECTED, length > encoded.length() - separator - 1);
+
+            std::string_view result = encoded.substr(separator + 1, length);
+            encoded.remove_prefix(separator + 1 + length);
+            return result;
+        }
+
+        std::vector<Utility::VersionAndChannel> DecodeVersions(std::string_view encoded)
+        {
+            std::vector<Utility::VersionAndChannel> result;
+            while (!encoded.empty())
+            {
+                std::string version{ ReadEncoded(encoded) };
+                std::string channel{ ReadEncoded(encoded) };
+                result.emplace_back(Utility::Version{ std::move(version) }, Utility::Channel{ std::move(channel) });
+            }
+            return result;
+        }
+    }
+
+    void CatalogSummaryTable::Create(SQLite::Connection& connection)
+    {
+        SQLite::Statement create = SQLite::Statement::Create(connection, s_CatalogSummaryTable_Table_Create);
+        create.Execute();
+    }
+
+    void CatalogSummaryTable::Populate(SQLite::Connection& connection, std::vector<ISQLiteIndex::ApplicationSummary>&& summaries)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "populatecatalogsummary_v1_2");
+
+        Clear(connection);
+
+        // Ordered the same regardless of case, with the ids that differ only in case in a fixed order.
+        std::vector<std::pair<std::string, size_t>> order;
+        order.reserve(summaries.size());
+        for (size_t i = 0; i < summaries.size(); ++i)
+        {
+            order.emplace_back(Utility::FoldCase(std::string_view{ summaries[i].IdString }), i);
+        }
+
+        std::sort(order.begin(), order.end(), [&](const auto& first, const auto& second)
+            {
+                if (first.first != second.first)
+                {
+                    return first.first < second.first;
+                }
+                return summaries[first.second].IdString < summaries[second.second].IdString;
+            });
+
+        SQLite::Statement insert = SQLite::Statement::Create(connection, s_CatalogSummaryTableStmt_Insert);
+
+        int64_t position = 0;
+        for (const auto& entry : order)
+        {
+            const auto& summary = summaries[entry.second];
+
+            insert.Reset();
+            insert.Bind(1, ++position);
+            insert.Bind(2, summary.Id);
+            insert.Bind(3, summary.IdString);
+            insert.Bind(4, summary.Name);
+            insert.Bind(5, EncodeVersions(summary.Versions));
+            insert.Execute();
+        }
+
+        AICLI_LOG(Repo, Verbose, << "Added " << position << " catalog summaries");
+
+        savepoint.Commit();
+    }
+
+    void CatalogSummaryTable::Clear(SQLite::Connection& connection)
+    {
+        SQLite::Statement clear = SQLite::Statement::Create(connection, s_CatalogSummaryTableStmt_Clear);
+        clear.Execute();
+    }
+
+    bool CatalogSummaryTable::IsEmpty(SQLite::Connection& connection)
+    {
+        SQLite::Statement isEmpty = SQLite::Statement::Create(connection, s_CatalogSummaryTableStmt_IsEmpty);
+        return !isEmpty.Step();
+    }
+
+    std::vector<ISQLiteIndex::ApplicationSummary> CatalogSummaryTable::GetSummaries(SQLite::Connection& connection, size_t limit)
+    {
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_CatalogSummaryTableStmt_GetSummaries);
+        // A negative limit has no upper bound.
+        select.Bind(1, (limit ? static_cast<int64_t>(limit) : -1));
+
+        std::vector<ISQLiteIndex::ApplicationSummary> result;
+        while (select.Step())
+        {
+            ISQLiteIndex::ApplicationSummary& summary = result.emplace_back();
+            summary.Id = select.GetColumn<SQLite::rowid_t>(0);
+            summary.IdString = select.GetColumn<std::string>(1);
+            summary.Name = select.GetColumn<std::string>(2);
+            summary.Versions = DecodeVersions(select.GetColumn<std::string>(3));
+        }
+
+        return result;
+    }
+}
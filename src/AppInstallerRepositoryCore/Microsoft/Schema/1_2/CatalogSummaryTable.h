@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+#include "Microsoft/Schema/ISQLiteIndex.h"
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    // A table that holds the summary of every id, as shown in search results, in the order of the ids.
+    // Listing the whole catalog reads it in a single sequential scan, rather than gathering the name and versions
+    // of each id from the manifests.
+    struct CatalogSummaryTable
+    {
+        // Creates the table.
+        static void Create(SQLite::Connection& connection);
+
+        // Replaces the contents of the table with the given summaries, which must be for every id in the index.
+        static void Populate(SQLite::Connection& connection, std::vector<ISQLiteIndex::ApplicationSummary>&& summaries);
+
+        // Removes all rows, as they no longer reflect the manifests.
+        static void Clear(SQLite::Connection& connection);
+
+        // Determines if the table is empty.
+        static bool IsEmpty(SQLite::Connection& connection);
+
+        // Gets the summaries in order, up to the given count; zero gets all of them.
+        static std::vector<ISQLiteIndex::ApplicationSummary> GetSummaries(SQLite::Connection& connection, size_t limit = 0);
+    };
+}
@@ -0,0 +1,157 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/1_2/FacetTable.h"
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    using namespace std::string_view_literals;
+
+    // Without a rowid, the rows are stored in primary key order, which is the order in which they are read.
+    static constexpr std::string_view s_FacetTable_Table_Create = R"(
+CREATE TABLE [facets](
+    [facet] INT NOT NULL,
+    [value] TEXT NOT NULL,
+    [count] INT64 NOT NULL,
+    [ids] BLOB NOT NULL,
+    PRIMARY KEY([facet], [value])) WITHOUT ROWID
+)"sv;
+
+    // Statements
+    static constexpr std::string_view s_FacetTableStmt_Insert = "insert into [facets] ([facet], [value], [count], [ids]) values (?, ?, ?, ?)"sv;
+    static constexpr std::string_view s_FacetTableStmt_ClearFacet = "delete from [facets] where [facet] = ?"sv;
+    static constexpr std::string_view s_FacetTableStmt_Clear = "delete from [facets]"sv;
+    static constexpr std::string_view s_FacetTableStmt_IsEmpty = "select [facet] from [facets] limit 1"sv;
+    static constexpr std::string_view s_FacetTableStmt_GetCounts = "select [value], [count] from [facets] where [facet] = ? order by [value]"sv;
+    static constexpr std::string_view s_FacetTableStmt_GetIds = "select [ids] from [facets] where [facet] = ? and [value] = ?"sv;
+
+    namespace
+    {
+        // The ids are stored as the difference from the previous id, each as a little endian base 128 varint,
+        // as sorted ids are close together and most differences fit in a single byte.
+        std::vector<uint8_t> EncodeIds(const std::vector<SQLite::rowid_t>& ids)
+        {
+            std::vector<uint8_t> result;
+            result.reserve(ids.size());
+
+            SQLite::rowid_t previous = 0;
+            for (SQLite::rowid_t id : ids)
+            {
+                THROW_HR_IF(E_INVALIDARG, id < previous);
+
+                uint64_t delta = static_cast<uint64_t>(id - previous);
+                previous = id;
+
+                while (delta >= 0x80)
+                {
+                    result.push_back(static_cast<uint8_t>(delta | 0x80));
+                    delta >>= 7;
+                }
+                result.push_back(static_cast<uint8_t>(delta));
+            }
+
+            return result;
+        }
+
+        std::vector<SQLite::rowid_t> DecodeIds(const std::vector<uint8_t>& encoded)
+        {
+            std::vector<SQLite::rowid_t> result;
+
+            SQLite::rowid_t previous = 0;
+            uint64_t delta = 0;
+            int shift = 0;
+            for (uint8_t byte : encoded)
+            {
+                THROW_HR_IF(E_UNEXPECTED, shift > 63);
+
+                delta |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (byte & 0x80)
+                {
+                    shift += 7;
+                    continue;
+                }
+
+                previous += static_cast<SQLite::rowid_t>(delta);
+                result.push_back(previous);
+                delta = 0;
+                shift = 0;
+            }
+
+            THROW_HR_IF(E_UNEXPECTED, shift != 0);
+
+            return result;
+        }
+    }
+
+    void FacetTable::Create(SQLite::Connection& connection)
+    {
+        SQLite::Statement create = SQLite::Statement::Create(connection, s_FacetTable_Table_Create);
+        create.Execute();
+    }
+
+    void FacetTable::Populate(SQLite::Connection& connection, Facet facet, const std::map<std::string, std::vector<SQLite::rowid_t>>& values)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "populatefacets_v1_2");
+
+        SQLite::Statement clear = SQLite::Statement::Create(connection, s_FacetTableStmt_ClearFacet);
+        clear.Bind(1, facet);
+        clear.Execute();
+
+        SQLite::Statement insert = SQLite::Statement::Create(connection, s_FacetTableStmt_Insert);
+
+        for (const auto& entry : values)
+        {
+            insert.Reset();
+            insert.Bind(1, facet);
+            insert.Bind(2, entry.first);
+            insert.Bind(3, static_cast<int64_t>(entry.second.size()));
+            insert.Bind(4, EncodeIds(entry.second));
+            insert.Execute();
+        }
+
+        AICLI_LOG(Repo, Verbose, << "Added " << values.size() << " values of facet " << ToIntegral(facet));
+
+        savepoint.Commit();
+    }
+
+    void FacetTable::Clear(SQLite::Connection& connection)
+    {
+        SQLite::Statement clear = SQLite::Statement::Create(connection, s_FacetTableStmt_Clear);
+        clear.Execute();
+    }
+
+    bool FacetTable::IsEmpty(SQLite::Connection& connection)
+    {
+        SQLite::Statement isEmpty = SQLite::Statement::Create(connection, s_FacetTableStmt_IsEmpty);
+        return !isEmpty.Step();
+    }
+
+    std::vector<std::pair<std::string, size_t>> FacetTable::GetCounts(SQLite::Connection& connection, Facet facet)
+    {
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_FacetTableStmt_GetCounts);
+        select.Bind(1, facet);
+
+        std::vector<std::pair<std::string, size_t>> result;
+        while (select.Step())
+        {
+            result.emplace_back(select.GetColumn<std::string>(0), static_cast<size_t>(select.GetColumn<int64_t>(1)));
+        }
+
+        return result;
+    }
+
+    std::vector<SQLite::rowid_t> FacetTable::GetIds(SQLite::Connection& connection, Facet facet, std::string_view value)
+    {
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_FacetTableStmt_GetIds);
+        select.Bind(1, facet);
+        select.Bind(2, value);
+
+        if (!select.Step())
+        {
+            return {};
+        }
+
+        return DecodeIds(select.GetColumn<std::vector<uint8_t>>(0));
+    }
+}
@@ -0,0 +1,38 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+#include "Microsoft/Schema/ISQLiteIndex.h"
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    // A table that holds, for every value of each facet, the number of ids with that value and the sorted ids themselves.
+    // The rows are stored in the order of their facet and value, so browsing a facet is a single range read, and listing
+    // the ids with a value is a single row, rather than joining the value and mapping tables to the manifests.
+    struct FacetTable
+    {
+        // Creates the table.
+        static void Create(SQLite::Connection& connection);
+
+        // Replaces the rows of the facet with the given values, each with its sorted, unique ids.
+        static void Populate(SQLite::Connection& connection, Facet facet, const std::map<std::string, std::vector<SQLite::rowid_t>>& values);
+
+        // Removes all rows, as they no longer reflect the manifests.
+        static void Clear(SQLite::Connection& connection);
+
+        // Determines if the table is empty.
+        static bool IsEmpty(SQLite::Connection& connection);
+
+        // Gets every value of the facet, in sorted order, along with the number of ids that have it.
+        static std::vector<std::pair<std::string, size_t>> GetCounts(SQLite::Connection& connection, Facet facet);
+
+        // Gets the ids that have the given value of the facet, in rowid order.
+        static std::vector<SQLite::rowid_t> GetIds(SQLite::Connection& connection, Facet facet, std::string_view value);
+    };
+}
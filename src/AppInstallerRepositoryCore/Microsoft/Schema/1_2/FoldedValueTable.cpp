@@ -0,0 +1,149 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/1_2/FoldedValueTable.h"
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    namespace details
+    {
+        using namespace std::string_view_literals;
+        static constexpr std::string_view s_FoldedValueTable_Suffix = "_folded"sv;
+        static constexpr std::string_view s_FoldedValueTable_FoldedName = "folded"sv;
+        static constexpr std::string_view s_FoldedValueTable_ValueName = "value"sv;
+
+        std::string FoldedValueTableGetTableName(std::string_view tableName)
+        {
+            std::string result(tableName);
+            result += s_FoldedValueTable_Suffix;
+            return result;
+        }
+
+        void CreateFoldedValueTable(SQLite::Connection& connection, std::string_view tableName)
+        {
+            using namespace SQLite::Builder;
+
+            // The primary key allows both the lookup of a folded value (or range of them), and the retrieval of the values, from the index alone.
+            // Nothing refers to the rows by rowid, so the rows are stored in the primary key rather than in a table and an index of it.
+            StatementBuilder createTableBuilder;
+            createTableBuilder.CreateTable({ tableName, s_FoldedValueTable_Suffix }).Columns({
+                ColumnBuilder(s_FoldedValueTable_FoldedName, Type::Text).NotNull(),
+                ColumnBuilder(s_FoldedValueTable_ValueName, Type::Int64).NotNull(),
+                PrimaryKeyBuilder({ s_FoldedValueTable_FoldedName, s_FoldedValueTable_ValueName })
+                }).WithoutRowID();
+
+            createTableBuilder.Execute(connection);
+        }
+
+        void FoldedValueTablePopulate(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName)
+        {
+            SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, std::string{ tableName } + "_populatefolded_v1_2");
+
+            FoldedValueTableClear(connection, tableName);
+
+            SQLite::Builder::StatementBuilder selectBuilder;
+            selectBuilder.Select({ SQLite::RowIDName, valueName }).From(tableName);
+
+            SQLite::Statement select = selectBuilder.Prepare(connection);
+
+            SQLite::Builder::StatementBuilder insertBuilder;
+            insertBuilder.InsertInto({ tableName, s_FoldedValueTable_Suffix }).
+                Columns({ s_FoldedValueTable_FoldedName, s_FoldedValueTable_ValueName }).Values(SQLite::Builder::Unbound, SQLite::Builder::Unbound);
+
+            SQLite::Statement insert = insertBuilder.Prepare(connection);
+
+            size_t valueCount = 0;
+
+            while (select.Step())
+            {
+                insert.Reset();
+                insert.Bind(1, Utility::FoldCase(select.GetColumn<std::string>(1)));
+                insert.Bind(2, select.GetColumn<SQLite::rowid_t>(0));
+                insert.Execute();
+                ++valueCount;
+            }
+
+            AICLI_LOG(Repo, Verbose, << "Added " << valueCount << " folded values to " << tableName << s_FoldedValueTable_Suffix);
+
+            savepoint.Commit();
+        }
+
+        void FoldedValueTableClear(SQLite::Connection& connection, std::string_view tableName)
+        {
+            SQLite::Builder::StatementBuilder builder;
+            builder.DeleteFrom({ tableName, s_FoldedValueTable_Suffix });
+
+            builder.Execute(connection);
+        }
+
+        bool FoldedValueTableIsEmpty(SQLite::Connection& connection, std::string_view tableName)
+        {
+            // Only look for the first row, as the table is potentially large.
+            SQLite::Builder::StatementBuilder builder;
+            builder.Select(s_FoldedValueTable_FoldedName).From({ tableName, s_FoldedValueTable_Suffix }).Limit(1);
+
+            SQLite::Statement select = builder.Prepare(connection);
+
+            return !select.Step();
+        }
+
+        void FoldedValueTableAddConstraint(SQLite::Builder::StatementBuilder& builder, std::string_view tableName, const std::string& folded, bool isPrefix)
+        {
+            using QCol = SQLite::Builder::QualifiedColumn;
+
+            std::string foldedTableName = FoldedValueTableGetTableName(tableName);
+
+            // Build a constraint like:
+            //      WHERE names.rowid IN (SELECT value FROM names_folded WHERE folded = <folded>)
+            // OR, for a prefix:
+            //      WHERE names.rowid IN (SELECT value FROM names_folded WHERE folded >= <folded> AND folded < <folded with last byte incremented>)
+            builder.Where(QCol(tableName, SQLite::RowIDName)).In().BeginParenthetical().
+                Select(s_FoldedValueTable_ValueName).From(foldedTableName).Where(s_FoldedValueTable_FoldedName);
+
+            if (isPrefix)
+            {
+                // Folded values are UTF-8, which never contains the byte 0xFF, so the last byte can always be incremented.
+                // Every value that starts with the prefix then sorts between the two, and every other value outside of them.
+                THROW_HR_IF(E_INVALIDARG, folded.empty());
+                std::string upperBound = folded;
+                upperBound.back() = static_cast<char>(static_cast<uint8_t>(upperBound.back()) + 1);
+
+                builder.GreaterThanOrEqual(folded).And(s_FoldedValueTable_FoldedName).LessThan(upperBound);
+            }
+            else
+            {
+                builder.Equals(folded);
+            }
+
+            builder.EndParenthetical();
+        }
+
+        void FoldedValueTableAddWildcardConstraint(SQLite::Builder::StatementBuilder& builder, std::string_view tableName, const WildcardPattern& pattern)
+        {
+            using QCol = SQLite::Builder::QualifiedColumn;
+
+            std::string foldedTableName = FoldedValueTableGetTableName(tableName);
+
+            // Build a constraint like:
+            //      WHERE names.rowid IN (SELECT value FROM names_folded WHERE folded >= <prefix> AND folded < <prefix with last byte incremented> AND folded GLOB <pattern>)
+            // The range over the literal prefix is a seek on the primary key, leaving GLOB to check only the values in it;
+            // GLOB is case sensitive, which is the same as matching without regard to case as both sides are folded.
+            builder.Where(QCol(tableName, SQLite::RowIDName)).In().BeginParenthetical().
+                Select(s_FoldedValueTable_ValueName).From(foldedTableName).Where(s_FoldedValueTable_FoldedName);
+
+            const std::string& prefix = pattern.GetLiteralPrefix();
+            if (!prefix.empty())
+            {
+                std::string upperBound = prefix;
+                upperBound.back() = static_cast<char>(static_cast<uint8_t>(upperBound.back()) + 1);
+
+                builder.GreaterThanOrEqual(prefix).And(s_FoldedValueTable_FoldedName).LessThan(upperBound).And(s_FoldedValueTable_FoldedName);
+            }
+
+            builder.Glob(pattern.ToGlob());
+
+            builder.EndParenthetical();
+        }
+    }
+}
@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+#include "SQLiteStatementBuilder.h"
+#include "Microsoft/Schema/WildcardPattern.h"
+#include <string>
+#include <string_view>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    namespace details
+    {
+        // Returns the folded value table name for a given value table.
+        std::string FoldedValueTableGetTableName(std::string_view tableName);
+
+        // Create the table.
+        void CreateFoldedValueTable(SQLite::Connection& connection, std::string_view tableName);
+
+        // Replaces the contents of the folded value table with the folded form of every value in the value table.
+        void FoldedValueTablePopulate(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName);
+
+        // Removes all folded values, as they no longer reflect the values.
+        void FoldedValueTableClear(SQLite::Connection& connection, std::string_view tableName);
+
+        // Determines if the table is empty.
+        bool FoldedValueTableIsEmpty(SQLite::Connection& connection, std::string_view tableName);
+
+        // Adds a where clause to the builder limiting the value table rowid to those whose folded form equals,
+        // or starts with, the given folded value.
+        void FoldedValueTableAddConstraint(SQLite::Builder::StatementBuilder& builder, std::string_view tableName, const std::string& folded, bool isPrefix);
+
+        // Adds a where clause to the builder limiting the value table rowid to those whose folded form matches the pattern.
+        void FoldedValueTableAddWildcardConstraint(SQLite::Builder::StatementBuilder& builder, std::string_view tableName, const WildcardPattern& pattern);
+    }
+
+    // A table that holds the case folded form of every value in a value table, indexed, so that case insensitive
+    // and starts with searches are index lookups rather than a case folding comparison of every value.
+    template <typename ValueTable>
+    struct FoldedValueTable
+    {
+        // The name of the table.
+        static std::string TableName()
+        {
+            return details::FoldedValueTableGetTableName(ValueTable::TableName());
+        }
+
+        // Creates the table.
+        static void Create(SQLite::Connection& connection)
+        {
+            details::CreateFoldedValueTable(connection, ValueTable::TableName());
+        }
+
+        // Replaces the contents of the table with the folded form of every value in the value table.
+        static void Populate(SQLite::Connection& connection)
+        {
+            details::FoldedValueTablePopulate(connection, ValueTable::TableName(), ValueTable::ValueName());
+        }
+
+        // Removes all folded values, as they no longer reflect the values.
+        static void Clear(SQLite::Connection& connection)
+        {
+            details::FoldedValueTableClear(connection, ValueTable::TableName());
+        }
+
+        // Determines if the table is empty.
+        static bool IsEmpty(SQLite::Connection& connection)
+        {
+            return details::FoldedValueTableIsEmpty(connection, ValueTable::TableName());
+        }
+
+        // Adds a where clause to the builder limiting the value table rowid to those whose folded form equals,
+        // or starts with, the given folded value.
+        static void AddConstraint(SQLite::Builder::StatementBuilder& builder, const std::string& folded, bool isPrefix)
+        {
+            details::FoldedValueTableAddConstraint(builder, ValueTable::TableName(), folded, isPrefix);
+        }
+
+        // Adds a where clause to the builder limiting the value table rowid to those whose folded form matches the pattern.
+        static void AddWildcardConstraint(SQLite::Builder::StatementBuilder& builder, const WildcardPattern& pattern)
+        {
+            details::FoldedValueTableAddWildcardConstraint(builder, ValueTable::TableName(), pattern);
+        }
+    };
+}
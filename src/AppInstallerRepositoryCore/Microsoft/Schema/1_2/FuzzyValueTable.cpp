@@ -0,0 +1,243 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/1_2/FuzzyValueTable.h"
+
+#include <array>
+#include <unordered_set>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    namespace
+    {
+        // The number of code units at the start of a value that deletions are taken from; deletions of
+        // the whole value would grow with the length of the value, where these are at most 1 + 7 + 21.
+        constexpr size_t s_FuzzyValueTable_PrefixLength = 7;
+
+        // The most deletions made from a value, which is the largest edit distance that is fuzzy matched.
+        constexpr size_t s_FuzzyValueTable_MaxDeletions = 2;
+
+        // The most matches returned; they are bound into the search statement.
+        constexpr size_t s_FuzzyValueTable_MaxMatches = 500;
+
+        // FNV-1a; a collision only adds a candidate, which the edit distance then rejects.
+        int64_t HashDeletion(std::wstring_view value)
+        {
+            uint64_t result = 14695981039346656037ull;
+
+            for (wchar_t c : value)
+            {
+                result ^= static_cast<uint64_t>(c);
+                result *= 1099511628211ull;
+            }
+
+            return static_cast<int64_t>(result);
+        }
+
+        // Gets the sorted, distinct hashes of the strings left by deleting up to the given number of code units from the prefix of the folded value.
+        std::vector<int64_t> GetDeletionHashes(std::wstring_view folded, size_t deletions)
+        {
+            std::unordered_set<std::wstring> seen;
+            std::vector<std::wstring> current{ std::wstring{ folded.substr(0, s_FuzzyValueTable_PrefixLength) } };
+            seen.emplace(current.front());
+
+            // Breadth first, so that each string is expanded once, from the fewest deletions that reach it
+            for (size_t level = 0; level < deletions; ++level)
+            {
+                std::vector<std::wstring> next;
+
+                for (const auto& value : current)
+                {
+                    for (size_t i = 0; i < value.length(); ++i)
+                    {
+                        std::wstring deleted = value;
+                        deleted.erase(i, 1);
+
+                        if (seen.emplace(deleted).second)
+                        {
+                            next.emplace_back(std::move(deleted));
+                        }
+                    }
+                }
+
+                current = std::move(next);
+            }
+
+            std::vector<int64_t> result;
+            result.reserve(seen.size());
+
+            for (const auto& value : seen)
+            {
+                result.push_back(HashDeletion(value));
+            }
+
+            std::sort(result.begin(), result.end());
+            result.erase(std::unique(result.begin(), result.end()), result.end());
+
+            return result;
+        }
+
+        std::wstring FoldToUTF16(std::string_view value)
+        {
+            return Utility::ConvertToUTF16(Utility::FoldCase(value));
+        }
+    }
+
+    namespace details
+    {
+        using namespace std::string_view_literals;
+        static constexpr std::string_view s_FuzzyValueTable_Suffix = "_deletes"sv;
+        static constexpr std::string_view s_FuzzyValueTable_HashName = "hash"sv;
+        static constexpr std::string_view s_FuzzyValueTable_ValueName = "value"sv;
+
+        std::string FuzzyValueTableGetTableName(std::string_view tableName)
+        {
+            std::string result(tableName);
+            result += s_FuzzyValueTable_Suffix;
+            return result;
+        }
+
+        void CreateFuzzyValueTable(SQLite::Connection& connection, std::string_view tableName)
+        {
+            using namespace SQLite::Builder;
+
+            // The primary key allows both the lookup of a deletion, and the retrieval of all values that have it, from the index alone.
+            // Nothing refers to the rows by rowid, so the rows are stored in the primary key rather than in a table and an index of it.
+            StatementBuilder createTableBuilder;
+            createTableBuilder.CreateTable({ tableName, s_FuzzyValueTable_Suffix }).Columns({
+                ColumnBuilder(s_FuzzyValueTable_HashName, Type::Int64).NotNull(),
+                ColumnBuilder(s_FuzzyValueTable_ValueName, Type::Int64).NotNull(),
+                PrimaryKeyBuilder({ s_FuzzyValueTable_HashName, s_FuzzyValueTable_ValueName })
+                }).WithoutRowID();
+
+            createTableBuilder.Execute(connection);
+        }
+
+        void FuzzyValueTablePopulate(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName)
+        {
+            SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, std::string{ tableName } + "_populatedeletes_v1_2");
+
+            FuzzyValueTableClear(connection, tableName);
+
+            SQLite::Builder::StatementBuilder selectBuilder;
+            selectBuilder.Select({ SQLite::RowIDName, valueName }).From(tableName);
+
+            SQLite::Statement select = selectBuilder.Prepare(connection);
+
+            SQLite::Builder::StatementBuilder insertBuilder;
+            insertBuilder.InsertInto({ tableName, s_FuzzyValueTable_Suffix }).
+                Columns({ s_FuzzyValueTable_HashName, s_FuzzyValueTable_ValueName }).Values(SQLite::Builder::Unbound, SQLite::Builder::Unbound);
+
+            SQLite::Statement insert = insertBuilder.Prepare(connection);
+
+            size_t valueCount = 0;
+            size_t deletionCount = 0;
+
+            while (select.Step())
+            {
+                SQLite::rowid_t valueId = select.GetColumn<SQLite::rowid_t>(0);
+                ++valueCount;
+
+                for (int64_t hash : GetDeletionHashes(FoldToUTF16(select.GetColumn<std::string>(1)), s_FuzzyValueTable_MaxDeletions))
+                {
+                    insert.Reset();
+                    insert.Bind(1, hash);
+                    insert.Bind(2, valueId);
+                    insert.Execute();
+                    ++deletionCount;
+                }
+            }
+
+            AICLI_LOG(Repo, Verbose, << "Added " << deletionCount << " deletions for " << valueCount << " values to " << tableName << s_FuzzyValueTable_Suffix);
+
+            savepoint.Commit();
+        }
+
+        void FuzzyValueTableClear(SQLite::Connection& connection, std::string_view tableName)
+        {
+            SQLite::Builder::StatementBuilder builder;
+            builder.DeleteFrom({ tableName, s_FuzzyValueTable_Suffix });
+
+            builder.Execute(connection);
+        }
+
+        bool FuzzyValueTableIsEmpty(SQLite::Connection& connection, std::string_view tableName)
+        {
+            // Only look for the first row, as the table is potentially very large.
+            SQLite::Builder::StatementBuilder builder;
+            builder.Select(s_FuzzyValueTable_HashName).From({ tableName, s_FuzzyValueTable_Suffix }).Limit(1);
+
+            SQLite::Statement select = builder.Prepare(connection);
+
+            return !select.Step();
+        }
+
+        std::vector<SQLite::rowid_t> FuzzyValueTableGetMatches(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, std::string_view value)
+        {
+            std::vector<SQLite::rowid_t> result;
+
+            std::wstring folded = FoldToUTF16(value);
+            size_t maxDistance = std::min(GetMaxFuzzyEditDistance(folded.length()), s_FuzzyValueTable_MaxDeletions);
+            if (maxDistance == 0)
+            {
+                return result;
+            }
+
+            // Build a statement like:
+            //      SELECT rowid, name FROM names WHERE rowid IN (SELECT value FROM names_deletes WHERE hash IN (<h1>, <h2>, ...))
+            SQLite::Builder::StatementBuilder builder;
+            builder.Select({ SQLite::RowIDName, valueName }).From(tableName).Where(SQLite::RowIDName).In().BeginParenthetical().
+                Select(s_FuzzyValueTable_ValueName).From({ tableName, s_FuzzyValueTable_Suffix }).Where(s_FuzzyValueTable_HashName).In(GetDeletionHashes(folded, maxDistance)).
+                EndParenthetical();
+
+            SQLite::Statement select = builder.Prepare(connection);
+
+            std::vector<std::pair<size_t, SQLite::rowid_t>> matches;
+            size_t candidateCount = 0;
+
+            while (select.Step())
+            {
+                ++candidateCount;
+
+                size_t distance = Utility::GetEditDistance(folded, FoldToUTF16(select.GetColumn<std::string>(1)));
+                if (distance <= maxDistance)
+                {
+                    matches.emplace_back(distance, select.GetColumn<SQLite::rowid_t>(0));
+                }
+            }
+
+            std::sort(matches.begin(), matches.end());
+            if (matches.size() > s_FuzzyValueTable_MaxMatches)
+            {
+                matches.resize(s_FuzzyValueTable_MaxMatches);
+            }
+
+            AICLI_LOG(Repo, Verbose, << "Fuzzy match kept " << matches.size() << " of " << candidateCount << " candidates from " << tableName << s_FuzzyValueTable_Suffix);
+
+            result.reserve(matches.size());
+            for (const auto& match : matches)
+            {
+                result.push_back(match.second);
+            }
+
+            return result;
+        }
+    }
+
+    size_t GetMaxFuzzyEditDistance(size_t length)
+    {
+        if (length < 3)
+        {
+            return 0;
+        }
+        else if (length < 6)
+        {
+            return 1;
+        }
+        else
+        {
+            return 2;
+        }
+    }
+}
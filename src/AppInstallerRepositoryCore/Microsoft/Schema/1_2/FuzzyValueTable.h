@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+#include "SQLiteStatementBuilder.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    namespace details
+    {
+        // Returns the fuzzy value table name for a given value table.
+        std::string FuzzyValueTableGetTableName(std::string_view tableName);
+
+        // Create the table.
+        void CreateFuzzyValueTable(SQLite::Connection& connection, std::string_view tableName);
+
+        // Replaces the contents of the fuzzy value table with the deletions of every value in the value table.
+        void FuzzyValueTablePopulate(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName);
+
+        // Removes all deletions, as they no longer reflect the values.
+        void FuzzyValueTableClear(SQLite::Connection& connection, std::string_view tableName);
+
+        // Determines if the table is empty.
+        bool FuzzyValueTableIsEmpty(SQLite::Connection& connection, std::string_view tableName);
+
+        // Gets the rowids of the values in the value table that are within the fuzzy edit distance of the value, closest first.
+        std::vector<SQLite::rowid_t> FuzzyValueTableGetMatches(SQLite::Connection& connection, std::string_view tableName, std::string_view valueName, std::string_view value);
+    }
+
+    // Gets the largest edit distance at which a value of the given length still fuzzy matches.
+    // Values too short to be told apart from others with a single edit return zero, and are not fuzzy matched.
+    size_t GetMaxFuzzyEditDistance(size_t length);
+
+    // A table that holds, for every value in a value table, the hashes of the strings left by deleting up to two characters
+    // from the start of its case folded form (a symmetric deletion index). Two values within a small edit distance of each
+    // other share one of these, so a fuzzy search looks up the deletions of the search value to find a small set of candidates,
+    // and only computes the edit distance for those rather than for every value.
+    template <typename ValueTable>
+    struct FuzzyValueTable
+    {
+        // The name of the table.
+        static std::string TableName()
+        {
+            return details::FuzzyValueTableGetTableName(ValueTable::TableName());
+        }
+
+        // Creates the table.
+        static void Create(SQLite::Connection& connection)
+        {
+            details::CreateFuzzyValueTable(connection, ValueTable::TableName());
+        }
+
+        // Replaces the contents of the table with the deletions of every value in the value table.
+        static void Populate(SQLite::Connection& connection)
+        {
+            details::FuzzyValueTablePopulate(connection, ValueTable::TableName(), ValueTable::ValueName());
+        }
+
+        // Removes all deletions, as they no longer reflect the values.
+        static void Clear(SQLite::Connection& connection)
+        {
+            details::FuzzyValueTableClear(connection, ValueTable::TableName());
+        }
+
+        // Determines if the table is empty.
+        static bool IsEmpty(SQLite::Connection& connection)
+        {
+            return details::FuzzyValueTableIsEmpty(connection, ValueTable::TableName());
+        }
+
+        // Gets the rowids of the values in the value table that are within the fuzzy edit distance of the value, closest first.
+        static std::vector<SQLite::rowid_t> GetMatches(SQLite::Connection& connection, std::string_view value)
+        {
+            return details::FuzzyValueTableGetMatches(connection, ValueTable::TableName(), ValueTable::ValueName(), value);
+        }
+    };
+}
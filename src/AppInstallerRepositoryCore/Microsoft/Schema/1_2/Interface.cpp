@@ -0,0 +1,391 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/1_2/Interface.h"
+
+#include "Microsoft/Schema/1_0/ChannelTable.h"
+#include "Microsoft/Schema/1_0/IdTable.h"
+#include "Microsoft/Schema/1_0/ManifestTable.h"
+#include "Microsoft/Schema/1_0/NameTable.h"
+#include "Microsoft/Schema/1_0/MonikerTable.h"
+#include "Microsoft/Schema/1_0/TagsTable.h"
+#include "Microsoft/Schema/1_0/CommandsTable.h"
+#include "Microsoft/Schema/1_0/VersionTable.h"
+
+#include "Microsoft/Schema/1_2/CatalogSummaryTable.h"
+#include "Microsoft/Schema/1_2/FacetTable.h"
+#include "Microsoft/Schema/1_2/FoldedValueTable.h"
+#include "Microsoft/Schema/1_2/FuzzyValueTable.h"
+#include "Microsoft/Schema/1_2/LatestManifestTable.h"
+#include "Microsoft/Schema/1_2/ManifestKeyTable.h"
+#include "Microsoft/Schema/1_2/ManifestPathTable.h"
+#include "Microsoft/Schema/1_2/ManifestValueSetTable.h"
+#include "Microsoft/Schema/1_2/SearchResultsTable.h"
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    namespace
+    {
+        // Removes the version sort keys, latest manifests, manifest paths, catalog summaries, facets, manifest value sets, folded values, and deletions, as any change to the index can invalidate them.
+        // They are only recreated by PrepareForPackaging.
+        void ClearPackagingTables(SQLite::Connection& connection)
+        {
+            VersionSortKeyTable::Clear(connection);
+            LatestManifestTable::Clear(connection);
+            ManifestPathTable::Clear(connection);
+            CatalogSummaryTable::Clear(connection);
+            FacetTable::Clear(connection);
+            ManifestValueSetTable::Clear(connection);
+            FoldedValueTable<V1_0::IdTable>::Clear(connection);
+            FoldedValueTable<V1_0::NameTable>::Clear(connection);
+            FoldedValueTable<V1_0::MonikerTable>::Clear(connection);
+            FoldedValueTable<V1_0::TagsTable>::Clear(connection);
+            FoldedValueTable<V1_0::CommandsTable>::Clear(connection);
+            FuzzyValueTable<V1_0::IdTable>::Clear(connection);
+            FuzzyValueTable<V1_0::NameTable>::Clear(connection);
+            FuzzyValueTable<V1_0::MonikerTable>::Clear(connection);
+            FuzzyValueTable<V1_0::TagsTable>::Clear(connection);
+            FuzzyValueTable<V1_0::CommandsTable>::Clear(connection);
+        }
+
+        // Creates the tables that were added by this version.
+        void CreateVersionTables(SQLite::Connection& connection)
+        {
+            VersionSortKeyTable::Create(connection);
+            LatestManifestTable::Create(connection);
+            ManifestPathTable::Create(connection);
+            CatalogSummaryTable::Create(connection);
+            FacetTable::Create(connection);
+            ManifestValueSetTable::Create(connection);
+            ManifestKeyTable::Create(connection);
+            FoldedValueTable<V1_0::IdTable>::Create(connection);
+            FoldedValueTable<V1_0::NameTable>::Create(connection);
+            FoldedValueTable<V1_0::MonikerTable>::Create(connection);
+            FoldedValueTable<V1_0::TagsTable>::Create(connection);
+            FoldedValueTable<V1_0::CommandsTable>::Create(connection);
+            FuzzyValueTable<V1_0::IdTable>::Create(connection);
+            FuzzyValueTable<V1_0::NameTable>::Create(connection);
+            FuzzyValueTable<V1_0::MonikerTable>::Create(connection);
+            FuzzyValueTable<V1_0::TagsTable>::Create(connection);
+            FuzzyValueTable<V1_0::CommandsTable>::Create(connection);
+        }
+    }
+
+    Schema::Version Interface::GetVersion() const
+    {
+        return { 1, 2 };
+    }
+
+    void Interface::CreateTables(SQLite::Connection& connection)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "createtables_v1_2");
+
+        V1_1::Interface::CreateTables(connection);
+        CreateVersionTables(connection);
+
+        savepoint.Commit();
+    }
+
+    void Interface::AddManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "addmanifest_v1_2");
+
+        V1_1::Interface::AddManifest(connection, manifest, relativePath);
+        ClearPackagingTables(connection);
+
+        savepoint.Commit();
+    }
+
+    void Interface::AddManifests(SQLite::Connection& connection, const std::vector<std::pair<Manifest::Manifest, std::filesystem::path>>& manifests)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "addmanifests_v1_2");
+
+        V1_1::Interface::AddManifests(connection, manifests);
+        ClearPackagingTables(connection);
+
+        savepoint.Commit();
+    }
+
+    bool Interface::UpdateManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "updatemanifest_v1_2");
+
+        bool result = V1_1::Interface::UpdateManifest(connection, manifest, relativePath);
+
+        if (result)
+        {
+            ClearPackagingTables(connection);
+        }
+
+        savepoint.Commit();
+
+        return result;
+    }
+
+    void Interface::RemoveManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "removemanifest_v1_2");
+
+        V1_1::Interface::RemoveManifest(connection, manifest, relativePath);
+        ClearPackagingTables(connection);
+
+        savepoint.Commit();
+    }
+
+    void Interface::PrepareForPackaging(SQLite::Connection& connection)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "prepareforpackaging_v1_2");
+
+        VersionSortKeyTable::Populate(connection);
+        LatestManifestTable::Populate(connection);
+        ManifestPathTable::Populate(connection);
+        CatalogSummaryTable::Populate(connection, GetApplicationSummaries(connection, V1_0::IdTable::GetAllRowIds(connection)));
+        FacetTable::Populate(connection, Facet::Tag, GetAllFacetIds(connection, Facet::Tag));
+        FacetTable::Populate(connection, Facet::Publisher, GetAllFacetIds(connection, Facet::Publisher));
+        ManifestValueSetTable::Populate(connection);
+        FoldedValueTable<V1_0::IdTable>::Populate(connection);
+        FoldedValueTable<V1_0::NameTable>::Populate(connection);
+        FoldedValueTable<V1_0::MonikerTable>::Populate(connection);
+        FoldedValueTable<V1_0::TagsTable>::Populate(connection);
+        FoldedValueTable<V1_0::CommandsTable>::Populate(connection);
+        FuzzyValueTable<V1_0::IdTable>::Populate(connection);
+        FuzzyValueTable<V1_0::NameTable>::Populate(connection);
+        FuzzyValueTable<V1_0::MonikerTable>::Populate(connection);
+        FuzzyValueTable<V1_0::TagsTable>::Populate(connection);
+        FuzzyValueTable<V1_0::CommandsTable>::Populate(connection);
+
+        savepoint.Commit();
+
+        // The base implementation vacuums, which must be done outside of an active transaction.
+        V1_1::Interface::PrepareForPackaging(connection);
+    }
+
+    ISQLiteIndex::SearchResult Interface::Search(SQLite::Connection& connection, const SearchRequest& request)
+    {
+        // If an empty request, get everything from the catalog summaries, along with the summaries themselves
+        if (request.Query || !request.Inclusions.empty() || !request.Filters.empty() || CatalogSummaryTable::IsEmpty(connection))
+        {
+            return V1_1::Interface::Search(connection, request);
+        }
+
+        SearchResult result;
+
+        // Reading one more than the maximum determines whether the results are truncated
+        result.Summaries = CatalogSummaryTable::GetSummaries(connection, (request.MaximumResults ? request.MaximumResults + 1 : 0));
+        if (request.MaximumResults && result.Summaries.size() > request.MaximumResults)
+        {
+            result.Summaries.resize(request.MaximumResults);
+            result.Truncated = true;
+        }
+
+        result.Matches.reserve(result.Summaries.size());
+        for (const auto& summary : result.Summaries)
+        {
+            result.Matches.emplace_back(summary.Id, ApplicationMatchFilter(ApplicationMatchField::Id, MatchType::Wildcard, {}));
+        }
+
+        return result;
+    }
+
+    std::vector<std::pair<std::string, size_t>> Interface::GetFacetCounts(SQLite::Connection& connection, Facet facet)
+    {
+        if (FacetTable::IsEmpty(connection))
+        {
+            return V1_1::Interface::GetFacetCounts(connection, facet);
+        }
+
+        return FacetTable::GetCounts(connection, facet);
+    }
+
+    std::vector<SQLite::rowid_t> Interface::GetIdsByFacet(SQLite::Connection& connection, Facet facet, std::string_view value)
+    {
+        if (FacetTable::IsEmpty(connection))
+        {
+            return V1_1::Interface::GetIdsByFacet(connection, facet, value);
+        }
+
+        return FacetTable::GetIds(connection, facet, value);
+    }
+
+    std::vector<Utility::VersionAndChannel> Interface::GetVersionsById(SQLite::Connection& connection, SQLite::rowid_t id)
+    {
+        if (VersionSortKeyTable::IsEmpty(connection))
+        {
+            return V1_1::Interface::GetVersionsById(connection, id);
+        }
+
+        auto versionsAndChannels = VersionSortKeyTable::GetSortedVersionsAndChannelsById(connection, id);
+
+        std::vector<Utility::VersionAndChannel> result;
+        result.reserve(versionsAndChannels.size());
+        for (auto&& vac : versionsAndChannels)
+        {
+            result.emplace_back(Utility::Version{ std::move(vac.first) }, Utility::Channel{ std::move(vac.second) });
+        }
+
+        return result;
+    }
+
+    std::vector<std::vector<Utility::VersionAndChannel>> Interface::GetVersionsByIds(SQLite::Connection& connection, const std::vector<SQLite::rowid_t>& ids, const VersionQuery& query)
+    {
+        // The database only ignores the case of ASCII letters when it matches a prefix
+        if (VersionSortKeyTable::IsEmpty(connection) || !Utility::IsASCII(query.Prefix))
+        {
+            return V1_1::Interface::GetVersionsByIds(connection, ids, query);
+        }
+
+        std::vector<std::vector<Utility::VersionAndChannel>> result;
+        result.reserve(ids.size());
+
+        for (auto& versionsAndChannels : VersionSortKeyTable::GetSortedVersionsAndChannelsByIds(connection, ids, query.Prefix, query.Offset, query.Limit))
+        {
+            std::vector<Utility::VersionAndChannel>& versions = result.emplace_back();
+            versions.reserve(versionsAndChannels.size());
+            for (auto&& vac : versionsAndChannels)
+            {
+                versions.emplace_back(Utility::Version{ std::move(vac.first) }, Utility::Channel{ std::move(vac.second) });
+            }
+        }
+
+        return result;
+    }
+
+    std::optional<std::string> Interface::GetPathStringByKey(SQLite::Connection& connection, SQLite::rowid_t id, std::string_view version, std::string_view channel)
+    {
+        if (ManifestPathTable::IsEmpty(connection))
+        {
+            return V1_1::Interface::GetPathStringByKey(connection, id, version, channel);
+        }
+
+        std::optional<SQLite::rowid_t> manifestIdOpt = GetManifestIdByKey(connection, id, version, channel);
+
+        if (!manifestIdOpt)
+        {
+            AICLI_LOG(Repo, Info, << "Did not find manifest for: " << id << ", " << version << ", " << channel);
+            return {};
+        }
+
+        return ManifestPathTable::GetPathByManifestId(connection, manifestIdOpt.value());
+    }
+
+    std::vector<std::optional<std::string>> Interface::GetPathStringsByKeys(SQLite::Connection& connection, SQLite::rowid_t id, const std::vector<Utility::VersionAndChannel>& versions)
+    {
+        if (ManifestPathTable::IsEmpty(connection))
+        {
+            return V1_1::Interface::GetPathStringsByKeys(connection, id, versions);
+        }
+
+        // One query reads the path of every version of the id; the keys are usually those of its versions exactly.
+        std::map<std::pair<std::string, std::string>, std::string> paths;
+        for (auto& [version, channel, path] : ManifestPathTable::GetVersionsAndPathsById(connection, id))
+        {
+            paths.emplace(std::make_pair(std::move(version), std::move(channel)), std::move(path));
+        }
+
+        std::vector<std::optional<std::string>> result;
+        result.reserve(versions.size());
+
+        for (const auto& version : versions)
+        {
+            auto itr = paths.find(std::make_pair(version.GetVersion().ToString(), version.GetChannel().ToString()));
+            if (itr != paths.end())
+            {
+                result.emplace_back(itr->second);
+            }
+            else
+            {
+                // Finds the latest version, or matches the values as the single lookup does
+                result.emplace_back(GetPathStringByKey(connection, id, version.GetVersion().ToString(), version.GetChannel().ToString()));
+            }
+        }
+
+        return result;
+    }
+
+    void Interface::MigrateFrom(SQLite::Connection& connection, const Schema::Version& version)
+    {
+        // Not GetVersion, which a later version overrides when it migrates through this one
+        if (version == Schema::Version{ 1, 2 })
+        {
+            return;
+        }
+
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "migratefrom_v1_2");
+
+        V1_1::Interface::MigrateFrom(connection, version);
+
+        CreateVersionTables(connection);
+
+        // The key of every existing manifest is needed to find it when it is updated or removed
+        ManifestKeyTable::Populate(connection);
+
+        // The mapping rows move to the layout that CreateOneToManyTables uses, copied table to table
+        V1_0::TagsTable::RebuildMapTable(connection, true);
+        V1_0::CommandsTable::RebuildMapTable(connection, true);
+
+        savepoint.Commit();
+    }
+
+    void Interface::CreateOneToManyTables(SQLite::Connection& connection)
+    {
+        // The mapping rows are only ever found by their value or manifest, so they are stored in their primary key alone;
+        // once the manifest index is dropped for packaging, each row is stored once rather than in both a table and an index.
+        V1_0::TagsTable::Create(connection, true);
+        V1_0::CommandsTable::Create(connection, true);
+    }
+
+    std::optional<SQLite::rowid_t> Interface::GetExistingManifestId(SQLite::Connection& connection, const Manifest::Manifest& manifest)
+    {
+        std::string id = Utility::FoldCase(manifest.Id);
+        std::string version = Utility::FoldCase(manifest.Version);
+        std::string channel = Utility::FoldCase(manifest.Channel);
+
+        for (SQLite::rowid_t manifestId : ManifestKeyTable::GetManifestIdsByKey(connection, manifest))
+        {
+            auto [idInIndex, versionInIndex, channelInIndex] =
+                V1_0::ManifestTable::GetValuesById<V1_0::IdTable, V1_0::VersionTable, V1_0::ChannelTable>(connection, manifestId);
+
+            if (Utility::FoldCase(idInIndex) == id && Utility::FoldCase(versionInIndex) == version && Utility::FoldCase(channelInIndex) == channel)
+            {
+                return manifestId;
+            }
+        }
+
+        AICLI_LOG(Repo, Info, << "Did not find a manifest row for { " << manifest.Id << ", " << manifest.Version << ", " << manifest.Channel << " }");
+        return {};
+    }
+
+    void Interface::OnManifestInserted(SQLite::Connection& connection, const Manifest::Manifest& manifest, SQLite::rowid_t manifestId)
+    {
+        ManifestKeyTable::Add(connection, manifest, manifestId);
+    }
+
+    void Interface::OnManifestDeleted(SQLite::Connection& connection, const Manifest::Manifest& manifest, SQLite::rowid_t manifestId)
+    {
+        ManifestKeyTable::Remove(connection, manifest, manifestId);
+    }
+
+    std::unique_ptr<V1_0::SearchResultsTable> Interface::CreateSearchResultsTable(SQLite::Connection& connection, bool inMemory) const
+    {
+        return std::make_unique<SearchResultsTable>(connection, inMemory);
+    }
+
+    std::optional<SQLite::rowid_t> Interface::GetManifestIdByKey(SQLite::Connection& connection, SQLite::rowid_t id, std::string_view version, std::string_view channel)
+    {
+        if (!version.empty() || LatestManifestTable::IsEmpty(connection))
+        {
+            return V1_1::Interface::GetManifestIdByKey(connection, id, version, channel);
+        }
+
+        // Use the same channel semantics as the base implementation; an empty channel that is not found does not filter.
+        std::optional<SQLite::rowid_t> channelIdOpt = V1_0::ChannelTable::SelectIdByValue(connection, channel, true);
+        if (!channelIdOpt && !channel.empty())
+        {
+            AICLI_LOG(Repo, Info, << "Did not find a Channel { " << channel << " }");
+            return {};
+        }
+
+        return LatestManifestTable::GetLatestManifestId(connection, id, channelIdOpt);
+    }
+}
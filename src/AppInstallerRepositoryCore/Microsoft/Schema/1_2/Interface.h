@@ -0,0 +1,38 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Microsoft/Schema/1_1/Interface.h"
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    // Interface to this schema version exposed through ISQLiteIndex.
+    // It is the latest version, so nothing derives from it, and its calls to its own members need no virtual dispatch.
+    struct Interface final : public V1_1::Interface
+    {
+        // Version 1.0
+        Schema::Version GetVersion() const override;
+        void CreateTables(SQLite::Connection& connection) override;
+        void AddManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath) override;
+        void AddManifests(SQLite::Connection& connection, const std::vector<std::pair<Manifest::Manifest, std::filesystem::path>>& manifests) override;
+        bool UpdateManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath) override;
+        void RemoveManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath) override;
+        void PrepareForPackaging(SQLite::Connection& connection) override;
+        SearchResult Search(SQLite::Connection& connection, const SearchRequest& request) override;
+        std::optional<std::string> GetPathStringByKey(SQLite::Connection& connection, SQLite::rowid_t id, std::string_view version, std::string_view channel) override;
+        std::vector<std::optional<std::string>> GetPathStringsByKeys(SQLite::Connection& connection, SQLite::rowid_t id, const std::vector<Utility::VersionAndChannel>& versions) override;
+        std::vector<Utility::VersionAndChannel> GetVersionsById(SQLite::Connection& connection, SQLite::rowid_t id) override;
+        std::vector<std::vector<Utility::VersionAndChannel>> GetVersionsByIds(SQLite::Connection& connection, const std::vector<SQLite::rowid_t>& ids, const VersionQuery& query) override;
+        std::vector<std::pair<std::string, size_t>> GetFacetCounts(SQLite::Connection& connection, Facet facet) override;
+        std::vector<SQLite::rowid_t> GetIdsByFacet(SQLite::Connection& connection, Facet facet, std::string_view value) override;
+        void MigrateFrom(SQLite::Connection& connection, const Schema::Version& version) override;
+
+    protected:
+        void CreateOneToManyTables(SQLite::Connection& connection) override;
+        std::optional<SQLite::rowid_t> GetExistingManifestId(SQLite::Connection& connection, const Manifest::Manifest& manifest) override;
+        void OnManifestInserted(SQLite::Connection& connection, const Manifest::Manifest& manifest, SQLite::rowid_t manifestId) override;
+        void OnManifestDeleted(SQLite::Connection& connection, const Manifest::Manifest& manifest, SQLite::rowid_t manifestId) override;
+        std::unique_ptr<V1_0::SearchResultsTable> CreateSearchResultsTable(SQLite::Connection& connection, bool inMemory) const override;
+        std::optional<SQLite::rowid_t> GetManifestIdByKey(SQLite::Connection& connection, SQLite::rowid_t id, std::string_view version, std::string_view channel) override;
+    };
+}
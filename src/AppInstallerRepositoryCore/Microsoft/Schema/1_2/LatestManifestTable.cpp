@@ -0,0 +1,229 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/1_2/LatestManifestTable.h"
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    using namespace std::string_view_literals;
+
+    static constexpr std::string_view s_VersionSortKeyTable_Table_Create = R"(
+CREATE TABLE [versions_sortkeys](
+    [version] INT64 PRIMARY KEY NOT NULL,
+    [sortkey] INT64 NOT NULL)
+)"sv;
+
+    static constexpr std::string_view s_LatestManifestTable_Table_Create = R"(
+CREATE TABLE [manifest_latest](
+    [id] INT64 NOT NULL,
+    [channel] INT64 NOT NULL,
+    [manifest] INT64 NOT NULL,
+    [sortkey] INT64 NOT NULL,
+    PRIMARY KEY([id], [channel]))
+)"sv;
+
+    // Statements
+    static constexpr std::string_view s_VersionSortKeyTableStmt_GetVersions = "select [rowid], [version] from [versions]"sv;
+    static constexpr std::string_view s_VersionSortKeyTableStmt_Insert = "insert into [versions_sortkeys] ([version], [sortkey]) values (?, ?)"sv;
+    static constexpr std::string_view s_VersionSortKeyTableStmt_Clear = "delete from [versions_sortkeys]"sv;
+    static constexpr std::string_view s_VersionSortKeyTableStmt_IsEmpty = "select [version] from [versions_sortkeys] limit 1"sv;
+    static constexpr std::string_view s_VersionSortKeyTableStmt_GetSortedVersionsAndChannelsById = R"(
+select [versions].[version], [channels].[channel] from [manifest]
+    join [versions] on [manifest].[version] = [versions].[rowid]
+    join [channels] on [manifest].[channel] = [channels].[rowid]
+    join [versions_sortkeys] on [manifest].[version] = [versions_sortkeys].[version]
+    where [manifest].[id] = ?
+    order by [channels].[channel], [versions_sortkeys].[sortkey] desc
+)"sv;
+    static constexpr std::string_view s_VersionSortKeyTableStmt_GetSortedVersionsAndChannelsByIdLimited = R"(
+select [versions].[version], [channels].[channel] from [manifest]
+    join [versions] on [manifest].[version] = [versions].[rowid]
+    join [channels] on [manifest].[channel] = [channels].[rowid]
+    join [versions_sortkeys] on [manifest].[version] = [versions_sortkeys].[version]
+    where [manifest].[id] = ? and [versions].[version] like ? escape ''
+    order by [channels].[channel], [versions_sortkeys].[sortkey] desc
+    limit ? offset ?
+)"sv;
+
+    // SQLite takes the bare columns of an aggregate query using max from the row holding the maximum value.
+    static constexpr std::string_view s_LatestManifestTableStmt_Populate = R"(
+insert into [manifest_latest] ([id], [channel], [manifest], [sortkey])
+    select [manifest].[id], [manifest].[channel], [manifest].[rowid], max([versions_sortkeys].[sortkey]) from [manifest]
+    join [versions_sortkeys] on [manifest].[version] = [versions_sortkeys].[version]
+    group by [manifest].[id], [manifest].[channel]
+)"sv;
+    static constexpr std::string_view s_LatestManifestTableStmt_Clear = "delete from [manifest_latest]"sv;
+    static constexpr std::string_view s_LatestManifestTableStmt_IsEmpty = "select [id] from [manifest_latest] limit 1"sv;
+    static constexpr std::string_view s_LatestManifestTableStmt_GetByIdAndChannel = "select [manifest] from [manifest_latest] where [id] = ? and [channel] = ?"sv;
+    static constexpr std::string_view s_LatestManifestTableStmt_GetById = "select [manifest] from [manifest_latest] where [id] = ? order by [sortkey] desc limit 1"sv;
+
+    void VersionSortKeyTable::Create(SQLite::Connection& connection)
+    {
+        SQLite::Statement create = SQLite::Statement::Create(connection, s_VersionSortKeyTable_Table_Create);
+        create.Execute();
+    }
+
+    void VersionSortKeyTable::Populate(SQLite::Connection& connection)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "populateversionsortkeys_v1_2");
+
+        Clear(connection);
+
+        // Pairs of { version sort key, version rowid }; the binary keys sort the same as the versions.
+        std::vector<std::pair<std::string, SQLite::rowid_t>> versions;
+
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_VersionSortKeyTableStmt_GetVersions);
+        while (select.Step())
+        {
+            SQLite::rowid_t versionId = select.GetColumn<SQLite::rowid_t>(0);
+            versions.emplace_back(Utility::Version{ select.GetColumn<std::string>(1) }.GetSortKey(), versionId);
+        }
+
+        std::sort(versions.begin(), versions.end());
+
+        SQLite::Statement insert = SQLite::Statement::Create(connection, s_VersionSortKeyTableStmt_Insert);
+
+        // Versions that compare as equal share a key, so that neither is considered later than the other.
+        int64_t sortKey = 0;
+        for (size_t i = 0; i < versions.size(); ++i)
+        {
+            if (i > 0 && versions[i - 1].first < versions[i].first)
+            {
+                ++sortKey;
+            }
+
+            insert.Reset();
+            insert.Bind(1, versions[i].second);
+            insert.Bind(2, sortKey);
+            insert.Execute();
+        }
+
+        AICLI_LOG(Repo, Verbose, << "Added sort keys for " << versions.size() << " versions");
+
+        savepoint.Commit();
+    }
+
+    void VersionSortKeyTable::Clear(SQLite::Connection& connection)
+    {
+        SQLite::Statement clear = SQLite::Statement::Create(connection, s_VersionSortKeyTableStmt_Clear);
+        clear.Execute();
+    }
+
+    bool VersionSortKeyTable::IsEmpty(SQLite::Connection& connection)
+    {
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_VersionSortKeyTableStmt_IsEmpty);
+        return !select.Step();
+    }
+
+    std::vector<std::pair<std::string, std::string>> VersionSortKeyTable::GetSortedVersionsAndChannelsById(SQLite::Connection& connection, SQLite::rowid_t id)
+    {
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_VersionSortKeyTableStmt_GetSortedVersionsAndChannelsById);
+        select.Bind(1, id);
+
+        std::vector<std::pair<std::string, std::string>> result;
+        while (select.Step())
+        {
+            auto [version, channel] = select.GetRow<std::string, std::string>();
+            result.emplace_back(std::move(version), std::move(channel));
+        }
+
+        return result;
+    }
+
+    std::vector<std::vector<std::pair<std::string, std::string>>> VersionSortKeyTable::GetSortedVersionsAndChannelsByIds(
+        SQLite::Connection& connection, const std::vector<SQLite::rowid_t>& ids, std::string_view prefix, size_t offset, size_t limit)
+    {
+        // The wildcards of the pattern are escaped, so that only the end of it matches anything
+        std::string pattern;
+        for (char c : prefix)
+        {
+            if (c == '%' || c == '_' || c == '\\')
+            {
+                pattern += '\\';
+            }
+            pattern += c;
+        }
+        pattern += '%';
+
+        // The statement is prepared once, and the limit applies to the rows of each id on its own
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_VersionSortKeyTableStmt_GetSortedVersionsAndChannelsByIdLimited);
+
+        std::vector<std::vector<std::pair<std::string, std::string>>> result;
+        result.reserve(ids.size());
+
+        for (SQLite::rowid_t id : ids)
+        {
+            select.Reset();
+            select.Bind(1, id);
+            select.Bind(2, pattern);
+            select.Bind(3, limit == 0 ? int64_t{ -1 } : static_cast<int64_t>(limit));
+            select.Bind(4, static_cast<int64_t>(offset));
+
+            auto& versions = result.emplace_back();
+            while (select.Step())
+            {
+                auto [version, channel] = select.GetRow<std::string, std::string>();
+                versions.emplace_back(std::move(version), std::move(channel));
+            }
+        }
+
+        return result;
+    }
+
+    void LatestManifestTable::Create(SQLite::Connection& connection)
+    {
+        SQLite::Statement create = SQLite::Statement::Create(connection, s_LatestManifestTable_Table_Create);
+        create.Execute();
+    }
+
+    void LatestManifestTable::Populate(SQLite::Connection& connection)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "populatelatestmanifests_v1_2");
+
+        Clear(connection);
+
+        SQLite::Statement populate = SQLite::Statement::Create(connection, s_LatestManifestTableStmt_Populate);
+        populate.Execute();
+
+        AICLI_LOG(Repo, Verbose, << "Added " << connection.GetChanges() << " latest manifests");
+
+        savepoint.Commit();
+    }
+
+    void LatestManifestTable::Clear(SQLite::Connection& connection)
+    {
+        SQLite::Statement clear = SQLite::Statement::Create(connection, s_LatestManifestTableStmt_Clear);
+        clear.Execute();
+    }
+
+    bool LatestManifestTable::IsEmpty(SQLite::Connection& connection)
+    {
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_LatestManifestTableStmt_IsEmpty);
+        return !select.Step();
+    }
+
+    std::optional<SQLite::rowid_t> LatestManifestTable::GetLatestManifestId(SQLite::Connection& connection, SQLite::rowid_t id, std::optional<SQLite::rowid_t> channel)
+    {
+        SQLite::Statement select;
+
+        if (channel)
+        {
+            select = SQLite::Statement::Create(connection, s_LatestManifestTableStmt_GetByIdAndChannel);
+            select.Bind(1, id);
+            select.Bind(2, channel.value());
+        }
+        else
+        {
+            select = SQLite::Statement::Create(connection, s_LatestManifestTableStmt_GetById);
+            select.Bind(1, id);
+        }
+
+        if (select.Step())
+        {
+            return select.GetColumn<SQLite::rowid_t>(0);
+        }
+
+        return {};
+    }
+}
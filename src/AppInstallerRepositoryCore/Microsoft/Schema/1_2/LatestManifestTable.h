@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    // A table that holds a key for every version string, such that ordering by the key orders the versions
+    // the same as Utility::Version; allowing versions to be sorted by the database.
+    struct VersionSortKeyTable
+    {
+        // Creates the table.
+        static void Create(SQLite::Connection& connection);
+
+        // Replaces the contents of the table with a key for every value in the version table.
+        static void Populate(SQLite::Connection& connection);
+
+        // Removes all keys, as they no longer reflect the versions.
+        static void Clear(SQLite::Connection& connection);
+
+        // Determines if the table is empty.
+        static bool IsEmpty(SQLite::Connection& connection);
+
+        // Gets the versions and channels of all manifests with the given id, in the same order as Utility::VersionAndChannel.
+        static std::vector<std::pair<std::string, std::string>> GetSortedVersionsAndChannelsById(SQLite::Connection& connection, SQLite::rowid_t id);
+
+        // Gets the versions and channels of each of the given ids, in the same order as GetSortedVersionsAndChannelsById.
+        // Only the versions that begin with the prefix, ignoring the case of ASCII letters, are included; of those, the given
+        // number are skipped and at most the limit are returned, with a limit of 0 returning all of the rest.
+        static std::vector<std::vector<std::pair<std::string, std::string>>> GetSortedVersionsAndChannelsByIds(
+            SQLite::Connection& connection, const std::vector<SQLite::rowid_t>& ids, std::string_view prefix, size_t offset, size_t limit);
+    };
+
+    // A table that holds the latest manifest of each id and channel pair.
+    // This requires the VersionSortKeyTable to be populated first.
+    struct LatestManifestTable
+    {
+        // Creates the table.
+        static void Create(SQLite::Connection& connection);
+
+        // Replaces the contents of the table with the latest manifest for every id and channel in the manifest table.
+        static void Populate(SQLite::Connection& connection);
+
+        // Removes all rows, as they no longer reflect the manifests.
+        static void Clear(SQLite::Connection& connection);
+
+        // Determines if the table is empty.
+        static bool IsEmpty(SQLite::Connection& connection);
+
+        // Gets the latest manifest for the id in the given channel, or the latest in any channel if none is given.
+        static std::optional<SQLite::rowid_t> GetLatestManifestId(SQLite::Connection& connection, SQLite::rowid_t id, std::optional<SQLite::rowid_t> channel);
+    };
+}
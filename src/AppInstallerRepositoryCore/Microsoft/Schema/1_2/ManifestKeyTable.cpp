@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/1_2/ManifestKeyTable.h"
+#include <AppInstallerStrings.h>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    using namespace std::string_view_literals;
+
+    // The rows are stored in their primary key alone, which is also the only way that they are found.
+    static constexpr std::string_view s_ManifestKeyTable_Table_Create = R"(
+CREATE TABLE [manifest_keys](
+    [key] INT64 NOT NULL,
+    [manifest] INT64 NOT NULL,
+    PRIMARY KEY([key], [manifest])) WITHOUT ROWID
+)"sv;
+
+    // Statements
+    static constexpr std::string_view s_ManifestKeyTableStmt_Insert = "insert into [manifest_keys] ([key], [manifest]) values (?, ?)"sv;
+    static constexpr std::string_view s_ManifestKeyTableStmt_Delete = "delete from [manifest_keys] where [key] = ? and [manifest] = ?"sv;
+    static constexpr std::string_view s_ManifestKeyTableStmt_GetManifestIdsByKey = "select [manifest] from [manifest_keys] where [key] = ?"sv;
+    static constexpr std::string_view s_ManifestKeyTableStmt_GetAllManifestValues = R"(
+select [manifest].[rowid], [ids].[id], [versions].[version], [channels].[channel] from [manifest]
+    join [ids] on [manifest].[id] = [ids].[rowid]
+    join [versions] on [manifest].[version] = [versions].[rowid]
+    join [channels] on [manifest].[channel] = [channels].[rowid]
+)"sv;
+
+    namespace
+    {
+        // FNV-1a; a collision only adds a candidate, which the caller then rejects.
+        void HashValue(uint64_t& hash, std::string_view value)
+        {
+            std::string folded = Utility::FoldCase(value);
+
+            for (char c : folded)
+            {
+                hash ^= static_cast<uint64_t>(static_cast<unsigned char>(c));
+                hash *= 1099511628211ull;
+            }
+
+            // Hash a zero byte after each value, so that moving characters between the values changes the key.
+            hash *= 1099511628211ull;
+        }
+
+        int64_t GetManifestKey(const Manifest::Manifest& manifest)
+        {
+            return ManifestKeyTable::GetKey(manifest.Id, manifest.Version, manifest.Channel);
+        }
+    }
+
+    void ManifestKeyTable::Create(SQLite::Connection& connection)
+    {
+        SQLite::Statement create = SQLite::Statement::Create(connection, s_ManifestKeyTable_Table_Create);
+        create.Execute();
+    }
+
+    void ManifestKeyTable::Populate(SQLite::Connection& connection)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "populatemanifestkeys_v1_2");
+
+        // The key is a hash of the case folded values, which SQL cannot compute, so it is inserted for each manifest
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_ManifestKeyTableStmt_GetAllManifestValues);
+        SQLite::Statement insert = SQLite::Statement::Create(connection, s_ManifestKeyTableStmt_Insert);
+
+        size_t count = 0;
+        while (select.Step())
+        {
+            auto [manifestId, id, version, channel] = select.GetRow<SQLite::rowid_t, std::string, std::string, std::string>();
+
+            insert.Reset();
+            insert.Bind(1, GetKey(id, version, channel));
+            insert.Bind(2, manifestId);
+            insert.Execute();
+
+            ++count;
+        }
+
+        AICLI_LOG(Repo, Verbose, << "Added " << count << " manifest keys");
+
+        savepoint.Commit();
+    }
+
+    int64_t ManifestKeyTable::GetKey(std::string_view id, std::string_view version, std::string_view channel)
+    {
+        uint64_t result = 14695981039346656037ull;
+
+        HashValue(result, id);
+        HashValue(result, version);
+        HashValue(result, channel);
+
+        return static_cast<int64_t>(result);
+    }
+
+    void ManifestKeyTable::Add(SQLite::Connection& connection, const Manifest::Manifest& manifest, SQLite::rowid_t manifestId)
+    {
+        SQLite::CachedStatement insert = connection.GetStatementCache().Get(connection, s_ManifestKeyTableStmt_Insert);
+        insert->Bind(1, GetManifestKey(manifest));
+        insert->Bind(2, manifestId);
+        insert->Execute();
+    }
+
+    void ManifestKeyTable::Remove(SQLite::Connection& connection, const Manifest::Manifest& manifest, SQLite::rowid_t manifestId)
+    {
+        SQLite::CachedStatement remove = connection.GetStatementCache().Get(connection, s_ManifestKeyTableStmt_Delete);
+        remove->Bind(1, GetManifestKey(manifest));
+        remove->Bind(2, manifestId);
+        remove->Execute();
+    }
+
+    std::vector<SQLite::rowid_t> ManifestKeyTable::GetManifestIdsByKey(SQLite::Connection& connection, const Manifest::Manifest& manifest)
+    {
+        SQLite::CachedStatement select = connection.GetStatementCache().Get(connection, s_ManifestKeyTableStmt_GetManifestIdsByKey);
+        select->Bind(1, GetManifestKey(manifest));
+
+        std::vector<SQLite::rowid_t> result;
+        while (select->Step())
+        {
+            result.push_back(select->GetColumn<SQLite::rowid_t>(0));
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+#include <winget/Manifest.h>
+#include <string_view>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    // A table that holds a hash of the case folded { Id, Version, Channel } of every manifest, so that finding the
+    // existing manifest when one is added, updated or removed is a single point lookup, rather than a case insensitive
+    // lookup of each value followed by one of the manifest.
+    struct ManifestKeyTable
+    {
+        // Creates the table.
+        static void Create(SQLite::Connection& connection);
+
+        // Adds the key of every manifest in the index; used when upgrading an index of an earlier schema, which has no keys.
+        static void Populate(SQLite::Connection& connection);
+
+        // Gets the key of the given values; values that differ only by case have the same key.
+        static int64_t GetKey(std::string_view id, std::string_view version, std::string_view channel);
+
+        // Adds the key of the manifest with the given rowid.
+        static void Add(SQLite::Connection& connection, const Manifest::Manifest& manifest, SQLite::rowid_t manifestId);
+
+        // Removes the key of the manifest with the given rowid.
+        static void Remove(SQLite::Connection& connection, const Manifest::Manifest& manifest, SQLite::rowid_t manifestId);
+
+        // Gets the rowids of the manifests with the same key as the given manifest; these must still be compared with it,
+        // as different values can have the same key.
+        static std::vector<SQLite::rowid_t> GetManifestIdsByKey(SQLite::Connection& connection, const Manifest::Manifest& manifest);
+    };
+}
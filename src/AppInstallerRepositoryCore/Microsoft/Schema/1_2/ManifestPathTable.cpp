@@ -0,0 +1,100 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/1_2/ManifestPathTable.h"
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    using namespace std::string_view_literals;
+
+    static constexpr std::string_view s_ManifestPathTable_Table_Create = R"(
+CREATE TABLE [manifest_paths](
+    [manifest] INT64 PRIMARY KEY NOT NULL,
+    [path] TEXT NOT NULL)
+)"sv;
+
+    // Statements
+    // Walks up from the leaf part of every manifest, prepending each parent, until reaching the root part.
+    static constexpr std::string_view s_ManifestPathTableStmt_Populate = R"(
+with recursive [paths]([leaf], [parent], [path]) as (
+    select [rowid], [parent], [pathpart] from [pathparts] where [rowid] in (select [pathpart] from [manifest])
+    union all
+    select [paths].[leaf], [pathparts].[parent], [pathparts].[pathpart] || '/' || [paths].[path] from [paths]
+        join [pathparts] on [paths].[parent] = [pathparts].[rowid]
+)
+insert into [manifest_paths] ([manifest], [path])
+    select [manifest].[rowid], [paths].[path] from [manifest]
+    join [paths] on [manifest].[pathpart] = [paths].[leaf]
+    where [paths].[parent] is null
+)"sv;
+    static constexpr std::string_view s_ManifestPathTableStmt_Clear = "delete from [manifest_paths]"sv;
+    static constexpr std::string_view s_ManifestPathTableStmt_IsEmpty = "select [manifest] from [manifest_paths] limit 1"sv;
+    static constexpr std::string_view s_ManifestPathTableStmt_GetPathByManifestId = "select [path] from [manifest_paths] where [manifest] = ?"sv;
+    static constexpr std::string_view s_ManifestPathTableStmt_GetVersionsAndPathsById = R"(
+select [versions].[version], [channels].[channel], [manifest_paths].[path] from [manifest]
+    join [versions] on [manifest].[version] = [versions].[rowid]
+    join [channels] on [manifest].[channel] = [channels].[rowid]
+    join [manifest_paths] on [manifest].[rowid] = [manifest_paths].[manifest]
+    where [manifest].[id] = ?
+)"sv;
+
+    void ManifestPathTable::Create(SQLite::Connection& connection)
+    {
+        SQLite::Statement create = SQLite::Statement::Create(connection, s_ManifestPathTable_Table_Create);
+        create.Execute();
+    }
+
+    void ManifestPathTable::Populate(SQLite::Connection& connection)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "populatemanifestpaths_v1_2");
+
+        Clear(connection);
+
+        SQLite::Statement populate = SQLite::Statement::Create(connection, s_ManifestPathTableStmt_Populate);
+        populate.Execute();
+
+        AICLI_LOG(Repo, Verbose, << "Added " << connection.GetChanges() << " manifest paths");
+
+        savepoint.Commit();
+    }
+
+    void ManifestPathTable::Clear(SQLite::Connection& connection)
+    {
+        SQLite::Statement clear = SQLite::Statement::Create(connection, s_ManifestPathTableStmt_Clear);
+        clear.Execute();
+    }
+
+    bool ManifestPathTable::IsEmpty(SQLite::Connection& connection)
+    {
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_ManifestPathTableStmt_IsEmpty);
+        return !select.Step();
+    }
+
+    std::optional<std::string> ManifestPathTable::GetPathByManifestId(SQLite::Connection& connection, SQLite::rowid_t manifestId)
+    {
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_ManifestPathTableStmt_GetPathByManifestId);
+        select.Bind(1, manifestId);
+
+        if (select.Step())
+        {
+            return select.GetColumn<std::string>(0);
+        }
+
+        return {};
+    }
+
+    std::vector<std::tuple<std::string, std::string, std::string>> ManifestPathTable::GetVersionsAndPathsById(SQLite::Connection& connection, SQLite::rowid_t id)
+    {
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_ManifestPathTableStmt_GetVersionsAndPathsById);
+        select.Bind(1, id);
+
+        std::vector<std::tuple<std::string, std::string, std::string>> result;
+        while (select.Step())
+        {
+            result.emplace_back(select.GetRow<std::string, std::string, std::string>());
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,35 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    // A table that holds the full relative path of every manifest, so that a path can be read without
+    // walking the path parts one at a time.
+    struct ManifestPathTable
+    {
+        // Creates the table.
+        static void Create(SQLite::Connection& connection);
+
+        // Replaces the contents of the table with the path of every manifest in the manifest table.
+        static void Populate(SQLite::Connection& connection);
+
+        // Removes all rows, as they no longer reflect the manifests.
+        static void Clear(SQLite::Connection& connection);
+
+        // Determines if the table is empty.
+        static bool IsEmpty(SQLite::Connection& connection);
+
+        // Gets the relative path of the manifest with the given rowid.
+        static std::optional<std::string> GetPathByManifestId(SQLite::Connection& connection, SQLite::rowid_t manifestId);
+
+        // Gets the { version, channel, relative path } of every manifest of the id.
+        static std::vector<std::tuple<std::string, std::string, std::string>> GetVersionsAndPathsById(SQLite::Connection& connection, SQLite::rowid_t id);
+    };
+}
@@ -0,0 +1,215 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/1_2/ManifestValueSetTable.h"
+#include "Microsoft/Schema/1_0/ManifestTable.h"
+#include "Microsoft/Schema/1_0/TagsTable.h"
+#include "Microsoft/Schema/1_0/CommandsTable.h"
+#include <map>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    using namespace std::string_view_literals;
+
+    static constexpr std::string_view s_ManifestValueSetTable_Table_Create = R"(
+CREATE TABLE [manifest_valuesets](
+    [manifest] INT64 PRIMARY KEY NOT NULL,
+    [tags] BLOB NOT NULL,
+    [commands] BLOB NOT NULL)
+)"sv;
+
+    // Statements
+    static constexpr std::string_view s_ManifestValueSetTableStmt_Insert = "insert into [manifest_valuesets] ([manifest], [tags], [commands]) values (?, ?, ?)"sv;
+    static constexpr std::string_view s_ManifestValueSetTableStmt_Clear = "delete from [manifest_valuesets]"sv;
+    static constexpr std::string_view s_ManifestValueSetTableStmt_IsEmpty = "select [manifest] from [manifest_valuesets] limit 1"sv;
+    static constexpr std::string_view s_ManifestValueSetTableStmt_GetTags = "select [tags] from [manifest_valuesets] where [manifest] = ?"sv;
+    static constexpr std::string_view s_ManifestValueSetTableStmt_GetCommands = "select [commands] from [manifest_valuesets] where [manifest] = ?"sv;
+
+    namespace
+    {
+        // The rowids are stored as an array of little endian 64-bit values, rather than the varint deltas of the facet table,
+        // so that they can be searched without decoding every value before the one being looked for.
+        std::vector<uint8_t> PackIds(const std::vector<SQLite::rowid_t>& ids)
+        {
+            std::vector<uint8_t> result(ids.size() * sizeof(int64_t));
+
+            for (size_t i = 0; i < ids.size(); ++i)
+            {
+                uint64_t value = static_cast<uint64_t>(ids[i]);
+                for (size_t j = 0; j < sizeof(int64_t); ++j)
+                {
+                    result[i * sizeof(int64_t) + j] = static_cast<uint8_t>(value >> (8 * j));
+                }
+            }
+
+            return result;
+        }
+
+        SQLite::rowid_t GetPackedId(const std::vector<uint8_t>& packed, size_t index)
+        {
+            uint64_t value = 0;
+            for (size_t j = 0; j < sizeof(int64_t); ++j)
+            {
+                value |= static_cast<uint64_t>(packed[index * sizeof(int64_t) + j]) << (8 * j);
+            }
+
+            return static_cast<SQLite::rowid_t>(value);
+        }
+
+        // Determines whether any of the sorted values are in the packed, sorted rowids.
+        // The values of a filter are few, so each is a binary search of the packed rowids.
+        bool ContainsAny(const std::vector<uint8_t>& packed, const std::vector<SQLite::rowid_t>& values)
+        {
+            THROW_HR_IF(E_UNEXPECTED, packed.size() % sizeof(int64_t) != 0);
+
+            size_t low = 0;
+            size_t high = packed.size() / sizeof(int64_t);
+
+            for (SQLite::rowid_t value : values)
+            {
+                // As the values are sorted, each search starts from where the previous one ended
+                size_t end = high;
+                while (low < end)
+                {
+                    size_t middle = low + (end - low) / 2;
+                    SQLite::rowid_t id = GetPackedId(packed, middle);
+
+                    if (id == value)
+                    {
+                        return true;
+                    }
+                    else if (id < value)
+                    {
+                        low = middle + 1;
+                    }
+                    else
+                    {
+                        end = middle;
+                    }
+                }
+
+                if (low == high)
+                {
+                    break;
+                }
+            }
+
+            return false;
+        }
+
+        template <typename ValueTable>
+        void AddMappedValues(SQLite::Connection& connection, std::map<SQLite::rowid_t, std::vector<SQLite::rowid_t>>& values)
+        {
+            SQLite::Builder::StatementBuilder builder;
+            builder.Select({ V1_0::details::OneToManyTableGetManifestColumnName(), ValueTable::ValueName() }).
+                From(V1_0::details::OneToManyTableGetMapTableName(ValueTable::TableName()));
+
+            SQLite::Statement select = builder.Prepare(connection);
+
+            while (select.Step())
+            {
+                auto itr = values.find(select.GetColumn<SQLite::rowid_t>(0));
+                if (itr != values.end())
+                {
+                    itr->second.push_back(select.GetColumn<SQLite::rowid_t>(1));
+                }
+            }
+
+            for (auto& entry : values)
+            {
+                std::sort(entry.second.begin(), entry.second.end());
+                entry.second.erase(std::unique(entry.second.begin(), entry.second.end()), entry.second.end());
+            }
+        }
+    }
+
+    void ManifestValueSetTable::Create(SQLite::Connection& connection)
+    {
+        SQLite::Statement create = SQLite::Statement::Create(connection, s_ManifestValueSetTable_Table_Create);
+        create.Execute();
+    }
+
+    void ManifestValueSetTable::Populate(SQLite::Connection& connection)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(connection, "populatemanifestvaluesets_v1_2");
+
+        Clear(connection);
+
+        // Every manifest gets a row, even one without any tags or commands
+        std::map<SQLite::rowid_t, std::vector<SQLite::rowid_t>> tags;
+        std::map<SQLite::rowid_t, std::vector<SQLite::rowid_t>> commands;
+
+        for (SQLite::rowid_t manifestId : V1_0::ManifestTable::GetAllRowIds(connection))
+        {
+            tags.emplace(manifestId, std::vector<SQLite::rowid_t>{});
+            commands.emplace(manifestId, std::vector<SQLite::rowid_t>{});
+        }
+
+        AddMappedValues<V1_0::TagsTable>(connection, tags);
+        AddMappedValues<V1_0::CommandsTable>(connection, commands);
+
+        SQLite::Statement insert = SQLite::Statement::Create(connection, s_ManifestValueSetTableStmt_Insert);
+
+        for (const auto& entry : tags)
+        {
+            insert.Reset();
+            insert.Bind(1, entry.first);
+            insert.Bind(2, PackIds(entry.second));
+            insert.Bind(3, PackIds(commands[entry.first]));
+            insert.Execute();
+        }
+
+        AICLI_LOG(Repo, Verbose, << "Added " << tags.size() << " manifest value sets");
+
+        savepoint.Commit();
+    }
+
+    void ManifestValueSetTable::Clear(SQLite::Connection& connection)
+    {
+        SQLite::Statement clear = SQLite::Statement::Create(connection, s_ManifestValueSetTableStmt_Clear);
+        clear.Execute();
+    }
+
+    bool ManifestValueSetTable::IsEmpty(SQLite::Connection& connection)
+    {
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_ManifestValueSetTableStmt_IsEmpty);
+        return !select.Step();
+    }
+
+    bool ManifestValueSetTable::HoldsField(ApplicationMatchField field)
+    {
+        return (field == ApplicationMatchField::Tag || field == ApplicationMatchField::Command);
+    }
+
+    std::vector<SQLite::rowid_t> ManifestValueSetTable::FilterManifests(SQLite::Connection& connection, ApplicationMatchField field,
+        const std::vector<SQLite::rowid_t>& valueIds, const std::vector<SQLite::rowid_t>& manifestIds)
+    {
+        THROW_HR_IF(E_INVALIDARG, !HoldsField(field));
+
+        std::vector<SQLite::rowid_t> result;
+
+        if (valueIds.empty())
+        {
+            return result;
+        }
+
+        SQLite::CachedStatement select = connection.GetStatementCache().Get(connection,
+            (field == ApplicationMatchField::Tag ? s_ManifestValueSetTableStmt_GetTags : s_ManifestValueSetTableStmt_GetCommands));
+
+        for (SQLite::rowid_t manifestId : manifestIds)
+        {
+            select->Reset();
+            select->Bind(1, manifestId);
+
+            if (select->Step() && ContainsAny(select->GetColumn<std::vector<uint8_t>>(0), valueIds))
+            {
+                result.push_back(manifestId);
+            }
+        }
+
+        select->Reset();
+
+        return result;
+    }
+}
@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+#include "Microsoft/Schema/ISQLiteIndex.h"
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    // A table that holds, for every manifest, the sorted rowids of its tags and of its commands, each packed into a blob.
+    // A tag or command filter is then checked against the manifests already in the results by reading a single row for each
+    // and searching the packed values in memory, rather than joining the mapping tables for every candidate.
+    struct ManifestValueSetTable
+    {
+        // Creates the table.
+        static void Create(SQLite::Connection& connection);
+
+        // Replaces the contents of the table with the tags and commands of every manifest in the manifest table.
+        static void Populate(SQLite::Connection& connection);
+
+        // Removes all rows, as they no longer reflect the manifests.
+        static void Clear(SQLite::Connection& connection);
+
+        // Determines if the table is empty.
+        static bool IsEmpty(SQLite::Connection& connection);
+
+        // Determines whether the table holds the values of the field; only tags and commands are held.
+        static bool HoldsField(ApplicationMatchField field);
+
+        // Gets those of the given manifests that have any of the given values of the field, in the order given.
+        // The values must be sorted rowids of the value table of the field.
+        static std::vector<SQLite::rowid_t> FilterManifests(SQLite::Connection& connection, ApplicationMatchField field,
+            const std::vector<SQLite::rowid_t>& valueIds, const std::vector<SQLite::rowid_t>& manifestIds);
+    };
+}
@@ -0,0 +1,293 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/1_2/SearchResultsTable.h"
+#include "Microsoft/Schema/1_2/FoldedValueTable.h"
+#include "Microsoft/Schema/1_2/FuzzyValueTable.h"
+#include "Microsoft/Schema/1_2/ManifestValueSetTable.h"
+
+#include "Microsoft/Schema/1_0/IdTable.h"
+#include "Microsoft/Schema/1_0/NameTable.h"
+#include "Microsoft/Schema/1_0/MonikerTable.h"
+#include "Microsoft/Schema/1_0/ManifestTable.h"
+#include "Microsoft/Schema/1_0/TagsTable.h"
+#include "Microsoft/Schema/1_0/CommandsTable.h"
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    namespace
+    {
+        template <typename ValueTable>
+        void BuildFoldedSearchStatement(SQLite::Builder::StatementBuilder& builder, const std::string& folded, bool isPrefix,
+            std::string_view manifestAlias, std::string_view valueAlias)
+        {
+            V1_0::ManifestTable::BuildSearchSelect<ValueTable>(builder, manifestAlias, valueAlias);
+            FoldedValueTable<ValueTable>::AddConstraint(builder, folded, isPrefix);
+        }
+
+        template <typename ValueTable>
+        void BuildWildcardSearchStatement(SQLite::Builder::StatementBuilder& builder, const WildcardPattern& pattern,
+            std::string_view manifestAlias, std::string_view valueAlias)
+        {
+            V1_0::ManifestTable::BuildSearchSelect<ValueTable>(builder, manifestAlias, valueAlias);
+            FoldedValueTable<ValueTable>::AddWildcardConstraint(builder, pattern);
+        }
+
+        // The matches are found from the fuzzy value table and verified before the statement is built, so the statement only
+        // selects the matching values by rowid.
+        template <typename ValueTable>
+        void BuildFuzzySearchStatement(SQLite::Builder::StatementBuilder& builder, SQLite::Connection& connection, std::string_view value,
+            std::string_view manifestAlias, std::string_view valueAlias)
+        {
+            std::vector<SQLite::rowid_t> matches = FuzzyValueTable<ValueTable>::GetMatches(connection, value);
+
+            V1_0::ManifestTable::BuildSearchSelect<ValueTable>(builder, manifestAlias, valueAlias);
+            builder.Where(SQLite::Builder::QualifiedColumn(ValueTable::TableName(), SQLite::RowIDName)).In(matches);
+        }
+
+        // Gets the sorted rowids of the values that match exactly, or whose folded form equals or starts with the folded value.
+        template <typename ValueTable>
+        std::vector<SQLite::rowid_t> GetMatchingValueIds(SQLite::Connection& connection, MatchType match, std::string_view value, const std::string& folded)
+        {
+            SQLite::Builder::StatementBuilder builder;
+            builder.Select(SQLite::Builder::QualifiedColumn(ValueTable::TableName(), SQLite::RowIDName)).From(ValueTable::TableName());
+
+            if (match == MatchType::Exact)
+            {
+                builder.Where(ValueTable::ValueName()).Equals(value);
+            }
+            else
+            {
+                FoldedValueTable<ValueTable>::AddConstraint(builder, folded, (match == MatchType::StartsWith));
+            }
+
+            SQLite::Statement select = builder.Prepare(connection);
+
+            std::vector<SQLite::rowid_t> result;
+            while (select.Step())
+            {
+                result.push_back(select.GetColumn<SQLite::rowid_t>(0));
+            }
+
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+    }
+
+    SearchResultsTable::SearchResultsTable(SQLite::Connection& connection, bool inMemory) :
+        V1_1::SearchResultsTable(connection, inMemory)
+    {
+    }
+
+    bool SearchResultsTable::BuildExtendedSearchStatement(SQLite::Builder::StatementBuilder& builder, ApplicationMatchField field, MatchType match, std::string_view value,
+        std::string_view manifestAlias, std::string_view valueAlias)
+    {
+        if (match == MatchType::CaseInsensitive || match == MatchType::StartsWith)
+        {
+            // The folding is the same as the ICU like that the base implementation uses, so the matches are the same;
+            // an empty value matches everything as a prefix, which the base implementation handles as well as an index would.
+            std::string folded = Utility::FoldCase(value);
+            bool isPrefix = (match == MatchType::StartsWith);
+
+            if (!folded.empty() && AreFoldedValuesAvailable(field))
+            {
+                switch (field)
+                {
+                case ApplicationMatchField::Id:
+                    BuildFoldedSearchStatement<V1_0::IdTable>(builder, folded, isPrefix, manifestAlias, valueAlias);
+                    break;
+                case ApplicationMatchField::Name:
+                    BuildFoldedSearchStatement<V1_0::NameTable>(builder, folded, isPrefix, manifestAlias, valueAlias);
+                    break;
+                case ApplicationMatchField::Moniker:
+                    BuildFoldedSearchStatement<V1_0::MonikerTable>(builder, folded, isPrefix, manifestAlias, valueAlias);
+                    break;
+                case ApplicationMatchField::Command:
+                    BuildFoldedSearchStatement<V1_0::CommandsTable>(builder, folded, isPrefix, manifestAlias, valueAlias);
+                    break;
+                case ApplicationMatchField::Tag:
+                    BuildFoldedSearchStatement<V1_0::TagsTable>(builder, folded, isPrefix, manifestAlias, valueAlias);
+                    break;
+                default:
+                    THROW_HR(E_UNEXPECTED);
+                }
+
+                return true;
+            }
+        }
+        else if (match == MatchType::Wildcard)
+        {
+            if (AreFoldedValuesAvailable(field))
+            {
+                WildcardPattern pattern{ value };
+
+                switch (field)
+                {
+                case ApplicationMatchField::Id:
+                    BuildWildcardSearchStatement<V1_0::IdTable>(builder, pattern, manifestAlias, valueAlias);
+                    break;
+                case ApplicationMatchField::Name:
+                    BuildWildcardSearchStatement<V1_0::NameTable>(builder, pattern, manifestAlias, valueAlias);
+                    break;
+                case ApplicationMatchField::Moniker:
+                    BuildWildcardSearchStatement<V1_0::MonikerTable>(builder, pattern, manifestAlias, valueAlias);
+                    break;
+                case ApplicationMatchField::Command:
+                    BuildWildcardSearchStatement<V1_0::CommandsTable>(builder, pattern, manifestAlias, valueAlias);
+                    break;
+                case ApplicationMatchField::Tag:
+                    BuildWildcardSearchStatement<V1_0::TagsTable>(builder, pattern, manifestAlias, valueAlias);
+                    break;
+                default:
+                    THROW_HR(E_UNEXPECTED);
+                }
+
+                return true;
+            }
+        }
+        else if (match == MatchType::Fuzzy)
+        {
+            // Values too short for a fuzzy match are left to the base implementation, which skips them.
+            if (GetMaxFuzzyEditDistance(Utility::ConvertToUTF16(Utility::FoldCase(value)).length()) != 0 && AreFuzzyValuesAvailable(field))
+            {
+                switch (field)
+                {
+                case ApplicationMatchField::Id:
+                    BuildFuzzySearchStatement<V1_0::IdTable>(builder, m_connection, value, manifestAlias, valueAlias);
+                    break;
+                case ApplicationMatchField::Name:
+                    BuildFuzzySearchStatement<V1_0::NameTable>(builder, m_connection, value, manifestAlias, valueAlias);
+                    break;
+                case ApplicationMatchField::Moniker:
+                    BuildFuzzySearchStatement<V1_0::MonikerTable>(builder, m_connection, value, manifestAlias, valueAlias);
+                    break;
+                case ApplicationMatchField::Command:
+                    BuildFuzzySearchStatement<V1_0::CommandsTable>(builder, m_connection, value, manifestAlias, valueAlias);
+                    break;
+                case ApplicationMatchField::Tag:
+                    BuildFuzzySearchStatement<V1_0::TagsTable>(builder, m_connection, value, manifestAlias, valueAlias);
+                    break;
+                default:
+                    THROW_HR(E_UNEXPECTED);
+                }
+
+                return true;
+            }
+        }
+
+        return V1_1::SearchResultsTable::BuildExtendedSearchStatement(builder, field, match, value, manifestAlias, valueAlias);
+    }
+
+    std::optional<std::vector<SQLite::rowid_t>> SearchResultsTable::FilterManifests(ApplicationMatchField field, MatchType match, std::string_view value)
+    {
+        if (!ManifestValueSetTable::HoldsField(field) || !AreValueSetsAvailable())
+        {
+            return {};
+        }
+
+        // Only the match types whose values can be found without comparing every value are evaluated here; as with searches,
+        // an empty folded value is left to the base implementation.
+        std::string folded;
+        if (match == MatchType::CaseInsensitive || match == MatchType::StartsWith)
+        {
+            folded = Utility::FoldCase(value);
+            if (folded.empty() || !AreFoldedValuesAvailable(field))
+            {
+                return {};
+            }
+        }
+        else if (match != MatchType::Exact)
+        {
+            return {};
+        }
+
+        std::vector<SQLite::rowid_t> valueIds = (field == ApplicationMatchField::Tag ?
+            GetMatchingValueIds<V1_0::TagsTable>(m_connection, match, value, folded) :
+            GetMatchingValueIds<V1_0::CommandsTable>(m_connection, match, value, folded));
+
+        if (valueIds.empty())
+        {
+            return std::vector<SQLite::rowid_t>{};
+        }
+
+        return ManifestValueSetTable::FilterManifests(m_connection, field, valueIds, GetManifests());
+    }
+
+    bool SearchResultsTable::AreValueSetsAvailable()
+    {
+        if (!m_valueSetsAvailable)
+        {
+            // Like the folded value tables, the value sets are only populated when packaging and are cleared by any later modification.
+            m_valueSetsAvailable = !ManifestValueSetTable::IsEmpty(m_connection);
+        }
+
+        return m_valueSetsAvailable.value();
+    }
+
+    bool SearchResultsTable::AreFoldedValuesAvailable(ApplicationMatchField field)
+    {
+        std::optional<bool>& available = m_foldedValuesAvailable.at(static_cast<size_t>(field));
+
+        if (!available)
+        {
+            // Like the trigram tables, the folded value tables are only populated when packaging and are cleared by any
+            // later modification, so a populated table always matches the values.
+            switch (field)
+            {
+            case ApplicationMatchField::Id:
+                available = !FoldedValueTable<V1_0::IdTable>::IsEmpty(m_connection);
+                break;
+            case ApplicationMatchField::Name:
+                available = !FoldedValueTable<V1_0::NameTable>::IsEmpty(m_connection);
+                break;
+            case ApplicationMatchField::Moniker:
+                available = !FoldedValueTable<V1_0::MonikerTable>::IsEmpty(m_connection);
+                break;
+            case ApplicationMatchField::Command:
+                available = !FoldedValueTable<V1_0::CommandsTable>::IsEmpty(m_connection);
+                break;
+            case ApplicationMatchField::Tag:
+                available = !FoldedValueTable<V1_0::TagsTable>::IsEmpty(m_connection);
+                break;
+            default:
+                THROW_HR(E_UNEXPECTED);
+            }
+        }
+
+        return available.value();
+    }
+
+    bool SearchResultsTable::AreFuzzyValuesAvailable(ApplicationMatchField field)
+    {
+        std::optional<bool>& available = m_fuzzyValuesAvailable.at(static_cast<size_t>(field));
+
+        if (!available)
+        {
+            // Like the trigram tables, the fuzzy value tables are only populated when packaging and are cleared by any
+            // later modification.
+            switch (field)
+            {
+            case ApplicationMatchField::Id:
+                available = !FuzzyValueTable<V1_0::IdTable>::IsEmpty(m_connection);
+                break;
+            case ApplicationMatchField::Name:
+                available = !FuzzyValueTable<V1_0::NameTable>::IsEmpty(m_connection);
+                break;
+            case ApplicationMatchField::Moniker:
+                available = !FuzzyValueTable<V1_0::MonikerTable>::IsEmpty(m_connection);
+                break;
+            case ApplicationMatchField::Command:
+                available = !FuzzyValueTable<V1_0::CommandsTable>::IsEmpty(m_connection);
+                break;
+            case ApplicationMatchField::Tag:
+                available = !FuzzyValueTable<V1_0::TagsTable>::IsEmpty(m_connection);
+                break;
+            default:
+                THROW_HR(E_UNEXPECTED);
+            }
+        }
+
+        return available.value();
+    }
+}
@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Microsoft/Schema/1_1/SearchResultsTable.h"
+
+#include <array>
+#include <optional>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema::V1_2
+{
+    // Holds the results of a search request.
+    // Uses the folded value tables, when they are populated, to implement case insensitive and starts with matches as index lookups,
+    // and wildcard matches as a range over their literal prefix.
+    // Uses the fuzzy value tables, when they are populated, to implement fuzzy matches.
+    // Uses the manifest value sets, when they are populated, to filter on tags and commands without joining the mapping tables.
+    struct SearchResultsTable : public V1_1::SearchResultsTable
+    {
+        SearchResultsTable(SQLite::Connection& connection, bool inMemory = false);
+
+        SearchResultsTable(const SearchResultsTable&) = delete;
+        SearchResultsTable& operator=(const SearchResultsTable&) = delete;
+
+        SearchResultsTable(SearchResultsTable&&) = default;
+        SearchResultsTable& operator=(SearchResultsTable&&) = default;
+
+    protected:
+        bool BuildExtendedSearchStatement(SQLite::Builder::StatementBuilder& builder, ApplicationMatchField field, MatchType match, std::string_view value,
+            std::string_view manifestAlias, std::string_view valueAlias) override;
+
+        std::optional<std::vector<SQLite::rowid_t>> FilterManifests(ApplicationMatchField field, MatchType match, std::string_view value) override;
+
+    private:
+        // Determines whether the folded value table for the field is populated, caching the result for the life of this object.
+        bool AreFoldedValuesAvailable(ApplicationMatchField field);
+
+        // Determines whether the fuzzy value table for the field is populated, caching the result for the life of this object.
+        bool AreFuzzyValuesAvailable(ApplicationMatchField field);
+
+        // Determines whether the manifest value sets are populated, caching the result for the life of this object.
+        bool AreValueSetsAvailable();
+
+        std::array<std::optional<bool>, 5> m_foldedValuesAvailable;
+        std::array<std::optional<bool>, 5> m_fuzzyValuesAvailable;
+        std::optional<bool> m_valueSetsAvailable;
+    };
+}
@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "DeltaTable.h"
+
+
+namespace AppInstaller::Repository::Microsoft::Schema
+{
+    using namespace std::string_view_literals;
+
+    // Table data [note that this table is not versioned, and thus *cannot change*]
+    static constexpr std::string_view s_DeltaTable_Table_Create = R"(
+CREATE TABLE [delta](
+    [id] TEXT NOT NULL,
+    [version] TEXT NOT NULL,
+    [channel] TEXT NOT NULL,
+    [operation] INT NOT NULL)
+)"sv;
+
+    // Statements
+    static constexpr std::string_view s_DeltaTableStmt_Exists = "select count(*) from [sqlite_master] where [type] = 'table' and [name] = 'delta'"sv;
+    static constexpr std::string_view s_DeltaTableStmt_AddChange = "insert into [delta] ([id], [version], [channel], [operation]) values (?, ?, ?, ?)"sv;
+    static constexpr std::string_view s_DeltaTableStmt_GetChanges = "select [id], [version], [channel], [operation] from [delta] order by [rowid]"sv;
+
+    void DeltaTable::Create(SQLite::Connection& connection)
+    {
+        SQLite::Statement create = SQLite::Statement::Create(connection, s_DeltaTable_Table_Create);
+        create.Execute();
+    }
+
+    bool DeltaTable::Exists(SQLite::Connection& connection)
+    {
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_DeltaTableStmt_Exists);
+        THROW_HR_IF(E_UNEXPECTED, !select.Step());
+        return select.GetColumn<int>(0) != 0;
+    }
+
+    void DeltaTable::AddChange(SQLite::Connection& connection, std::string_view id, std::string_view version, std::string_view channel, DeltaOperation operation)
+    {
+        SQLite::Statement insert = SQLite::Statement::Create(connection, s_DeltaTableStmt_AddChange);
+        insert.Bind(1, id);
+        insert.Bind(2, version);
+        insert.Bind(3, channel);
+        insert.Bind(4, static_cast<int>(operation));
+        insert.Execute();
+    }
+
+    std::vector<DeltaChange> DeltaTable::GetChanges(SQLite::Connection& connection)
+    {
+        SQLite::Statement select = SQLite::Statement::Create(connection, s_DeltaTableStmt_GetChanges);
+
+        std::vector<DeltaChange> result;
+        while (select.Step())
+        {
+            auto [id, version, channel, operation] = select.GetRow<std::string, std::string, std::string, int>();
+            result.push_back({ std::move(id), std::move(version), std::move(channel), static_cast<DeltaOperation>(operation) });
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AppInstaller::Repository::Microsoft::Schema
+{
+    // The operation that a delta records for a manifest.
+    enum class DeltaOperation : int
+    {
+        // The manifest in the delta replaces the existing one.
+        Update = 1,
+        // The existing manifest is removed.
+        Remove = 2,
+    };
+
+    // A manifest key and the operation to perform on it.
+    struct DeltaChange
+    {
+        std::string Id;
+        std::string Version;
+        std::string Channel;
+        DeltaOperation Operation;
+    };
+
+    // The table of changes in an index delta; manifests present in the delta without a change are added.
+    // Only present in an index created as a delta, where it marks the index as such.
+    struct DeltaTable
+    {
+        static void Create(SQLite::Connection& connection);
+
+        // Determines if the table exists in the index.
+        static bool Exists(SQLite::Connection& connection);
+
+        // Records the operation for the manifest with the given key.
+        static void AddChange(SQLite::Connection& connection, std::string_view id, std::string_view version, std::string_view channel, DeltaOperation operation);
+
+        // Gets all of the changes, in the order they were added.
+        static std::vector<DeltaChange> GetChanges(SQLite::Connection& connection);
+    };
+}
@@ -8,6 +8,8 @@
 #include <winget/Manifest.h>
 
 #include <filesystem>
+#include <utility>
+#include <vector>
 
 
 namespace AppInstaller::Repository::Microsoft::Schema
@@ -15,17 +17,44 @@ namespace AppInstaller::Repository::Microsoft::Schema
     // Forward declarations
     struct Version;
 
+    // A value by which the ids in the index can be browsed and counted.
+    enum class Facet
+    {
+        // The tags of any manifest of the id, as they are in the manifest.
+        Tag = 1,
+        // The publisher part of the id, which is the folded case of the id up to its first '.'.
+        Publisher = 2,
+    };
+
     // The common interface used to interact with all schema versions of the index.
     struct ISQLiteIndex
     {
         virtual ~ISQLiteIndex() = default;
 
+        // The non-version specific return value of Search.
+        // New fields must have initializers to their down-schema defaults.
+        // The data shown for an id in search results.
+        struct ApplicationSummary
+        {
+            SQLite::rowid_t Id = 0;
+            std::string IdString;
+
+            // The name from the manifest of the first version.
+            std::string Name;
+
+            // All versions and channels, in sorted order.
+            std::vector<Utility::VersionAndChannel> Versions;
+        };
+
         // The non-version specific return value of Search.
         // New fields must have initializers to their down-schema defaults.
         struct SearchResult
         {
             std::vector<std::pair<SQLite::rowid_t, ApplicationMatchFilter>> Matches;
             bool Truncated = false;
+
+            // The summaries of the matches, when the search produced them along with the matches; otherwise empty.
+            std::vector<ApplicationSummary> Summaries;
         };
 
         // Version 1.0
@@ -39,6 +68,9 @@ namespace AppInstaller::Repository::Microsoft::Schema
         // Adds the manifest at the repository relative path to the index.
         virtual void AddManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath) = 0;
 
+        // Adds all of the manifests, each at its repository relative path, to the index.
+        virtual void AddManifests(SQLite::Connection& connection, const std::vector<std::pair<Manifest::Manifest, std::filesystem::path>>& manifests) = 0;
+
         // Updates the manifest with matching { Id, Version, Channel } in the index.
         // The return value indicates whether the index was modified by the function.
         virtual bool UpdateManifest(SQLite::Connection& connection, const Manifest::Manifest& manifest, const std::filesystem::path& relativePath) = 0;
@@ -53,6 +85,9 @@ namespace AppInstaller::Repository::Microsoft::Schema
         // Performs a search based on the given criteria.
         virtual SearchResult Search(SQLite::Connection& connection, const SearchRequest& request) = 0;
 
+        // Finds the given ids exactly, giving a match for each one that is found, in the order given.
+        virtual SearchResult SearchForIds(SQLite::Connection& connection, const std::vector<std::string>& ids) = 0;
+
         // Gets the Id string for the given id, if present.
         virtual std::optional<std::string> GetIdStringById(SQLite::Connection& connection, SQLite::rowid_t id) = 0;
 
@@ -63,8 +98,51 @@ namespace AppInstaller::Repository::Microsoft::Schema
         // If version is empty, gets the value for the 'latest' version.
         virtual std::optional<std::string> GetPathStringByKey(SQLite::Connection& connection, SQLite::rowid_t id, std::string_view version, std::string_view channel) = 0;
 
+        // Gets the relative path string for each of the given { version, channel } of the id, in the same order.
+        // Each is found as GetPathStringByKey would find it, and is empty if not present.
+        virtual std::vector<std::optional<std::string>> GetPathStringsByKeys(SQLite::Connection& connection, SQLite::rowid_t id, const std::vector<Utility::VersionAndChannel>& versions) = 0;
+
         // Gets all versions and channels for the given id.
         virtual std::vector<Utility::VersionAndChannel> GetVersionsById(SQLite::Connection& connection, SQLite::rowid_t id) = 0;
+
+        // Gets the versions and channels of each of the given ids that the query includes, in the same order as the ids.
+        // The versions of each id are sorted as GetVersionsById sorts them, and the query applies to each id separately.
+        virtual std::vector<std::vector<Utility::VersionAndChannel>> GetVersionsByIds(SQLite::Connection& connection, const std::vector<SQLite::rowid_t>& ids, const VersionQuery& query) = 0;
+
+        // Loads the searchable values into memory, where all future searches are performed.
+        // Must only be used when the index will not change while it is open.
+        // If the shared name is not empty, the values are shared with other processes that load them with the same name.
+        virtual void LoadSearchSnapshot(SQLite::Connection& connection, std::string_view sharedName) = 0;
+
+        // Sets whether searches accumulate their results in memory, running each search as a separate statement,
+        // rather than compiling the whole request into a single statement.
+        // Must only be enabled when the index will not change while it is open.
+        virtual void SetSearchResultsInMemory(bool value) = 0;
+
+        // Gets every manifest in the index, each paired with its repository relative path.
+        // The manifests only contain the values that are stored in the index.
+        virtual std::vector<std::pair<Manifest::Manifest, std::filesystem::path>> GetAllManifests(SQLite::Connection& connection) = 0;
+
+        // Gets the summaries for the given ids, retrieving the data for all of them together.
+        // The summaries are in the order of the ids; ids that are not found are not included.
+        virtual std::vector<ApplicationSummary> GetApplicationSummaries(SQLite::Connection& connection, const std::vector<SQLite::rowid_t>& ids) = 0;
+
+        // Gets every value of the facet, in sorted order, along with the number of ids that have it.
+        virtual std::vector<std::pair<std::string, size_t>> GetFacetCounts(SQLite::Connection& connection, Facet facet) = 0;
+
+        // Gets the ids that have the given value of the facet, in rowid order.
+        virtual std::vector<SQLite::rowid_t> GetIdsByFacet(SQLite::Connection& connection, Facet facet, std::string_view value) = 0;
+
+        // Sets whether updating and removing manifests leaves the values that they no longer reference in the index,
+        // rather than checking each of them for other references; RemoveUnusedValues must then be called to remove them.
+        virtual void SetDeferUnusedValueRemoval(bool value) = 0;
+
+        // Removes every value that is not referenced by a manifest, with a single statement per table.
+        virtual void RemoveUnusedValues(SQLite::Connection& connection) = 0;
+
+        // Upgrades the tables of an index of the given earlier schema version, in place, to those of this version.
+        // Every manifest and value is kept; the tables that are only built by PrepareForPackaging are left empty.
+        virtual void MigrateFrom(SQLite::Connection& connection, const Schema::Version& version) = 0;
     };
 
 
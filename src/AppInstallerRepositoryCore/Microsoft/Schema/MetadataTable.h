@@ -4,6 +4,7 @@
 #include "SQLiteWrapper.h"
 
 #include <wil/result_macros.h>
+#include <optional>
 #include <string_view>
 
 namespace AppInstaller::Repository::Microsoft::Schema
@@ -16,6 +17,21 @@ namespace AppInstaller::Repository::Microsoft::Schema
     static constexpr std::string_view s_MetadataValueName_MinorVersion = "minorVersion"sv;
     static constexpr std::string_view s_MetadataValueName_LastWriteTime = "lastwritetime"sv;
 
+    // Delta
+    static constexpr std::string_view s_MetadataValueName_DeltaBaseWriteTime = "deltaBaseWriteTime"sv;
+    static constexpr std::string_view s_MetadataValueName_DeltaTargetWriteTime = "deltaTargetWriteTime"sv;
+
+    // Id filter
+    static constexpr std::string_view s_MetadataValueName_IdFilter = "idFilter"sv;
+    static constexpr std::string_view s_MetadataValueName_IdFilterWriteTime = "idFilterWriteTime"sv;
+
+    // Hot index
+    static constexpr std::string_view s_MetadataValueName_ColdIdFilter = "coldIdFilter"sv;
+
+    // Prewarming
+    static constexpr std::string_view s_MetadataValueName_PrewarmPages = "prewarmPages"sv;
+    static constexpr std::string_view s_MetadataValueName_PrewarmPagesWriteTime = "prewarmPagesWriteTime"sv;
+
     // The metadata table for the index.
     // Contains a fixed-schema set of named values that can be used to determine how to read the rest of the index.
     struct MetadataTable
@@ -30,6 +46,18 @@ namespace AppInstaller::Repository::Microsoft::Schema
             return statement.GetColumn<Value>(0);
         }
 
+        // Gets the named value from the metadata table, interpreting it as the given type; empty if there is no such value.
+        template <typename Value>
+        static std::optional<Value> TryGetNamedValue(SQLite::Connection& connection, std::string_view name)
+        {
+            std::optional<SQLite::Statement> statement = TryGetNamedValueStatement(connection, name);
+            if (!statement)
+            {
+                return std::nullopt;
+            }
+            return statement->GetColumn<Value>(0);
+        }
+
         // Sets the named value into the metadata table.
         template <typename Value>
         static void SetNamedValue(SQLite::Connection& connection, std::string_view name, Value&& v)
@@ -43,6 +71,9 @@ namespace AppInstaller::Repository::Microsoft::Schema
         // Internal function that gets the named value.
         static SQLite::Statement GetNamedValueStatement(SQLite::Connection& connection, std::string_view name);
 
+        // Internal function that gets the named value, if it exists.
+        static std::optional<SQLite::Statement> TryGetNamedValueStatement(SQLite::Connection& connection, std::string_view name);
+
         // Internal function that sets the named value.
         static SQLite::Statement SetNamedValueStatement(SQLite::Connection& connection, std::string_view name);
     };
@@ -5,6 +5,8 @@
 #include "MetadataTable.h"
 
 #include "1_0/Interface.h"
+#include "1_1/Interface.h"
+#include "1_2/Interface.h"
 
 namespace AppInstaller::Repository::Microsoft::Schema
 {
@@ -29,11 +31,19 @@ namespace AppInstaller::Repository::Microsoft::Schema
     // Creates the interface object for this version.
     std::unique_ptr<ISQLiteIndex> Version::CreateISQLiteIndex()
     {
-        if (*this == Version{ 1, 0 } ||
+        if (*this == Version{ 1, 0 })
+        {
+            return std::make_unique<V1_0::Interface>();
+        }
+        else if (*this == Version{ 1, 1 })
+        {
+            return std::make_unique<V1_1::Interface>();
+        }
+        else if (*this == Version{ 1, 2 } ||
             this->MajorVersion == 1 ||
             this->IsLatest())
         {
-            return std::make_unique<V1_0::Interface>();
+            return std::make_unique<V1_2::Interface>();
         }
 
         // We do not have the capacity to operate on this schema version
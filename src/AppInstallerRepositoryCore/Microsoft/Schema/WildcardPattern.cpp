@@ -0,0 +1,169 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/Schema/WildcardPattern.h"
+#include "SQLiteWrapper.h"
+
+
+namespace AppInstaller::Repository::Microsoft::Schema
+{
+    namespace
+    {
+        constexpr char s_WildcardPattern_Any = '*';
+        constexpr char s_WildcardPattern_Single = '?';
+
+        bool IsContinuationByte(char c)
+        {
+            return (static_cast<uint8_t>(c) & 0xC0) == 0x80;
+        }
+
+        // Gets the position after the UTF-8 character at the position.
+        size_t NextCharacter(std::string_view value, size_t position)
+        {
+            ++position;
+            while (position < value.length() && IsContinuationByte(value[position]))
+            {
+                ++position;
+            }
+            return position;
+        }
+    }
+
+    WildcardPattern::WildcardPattern(std::string_view pattern) :
+        m_folded(Utility::FoldCase(pattern))
+    {
+        m_literalPrefix = m_folded.substr(0, m_folded.find_first_of("*?"));
+
+        size_t start = 0;
+        for (;;)
+        {
+            size_t end = m_folded.find(s_WildcardPattern_Any, start);
+            if (end == std::string::npos)
+            {
+                m_segments.emplace_back(m_folded.substr(start));
+                break;
+            }
+
+            m_segments.emplace_back(m_folded.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+
+    std::optional<size_t> WildcardPattern::MatchSegmentAt(std::string_view value, size_t position, std::string_view segment)
+    {
+        for (char c : segment)
+        {
+            if (position >= value.length())
+            {
+                return {};
+            }
+
+            if (c == s_WildcardPattern_Single)
+            {
+                position = NextCharacter(value, position);
+            }
+            else if (value[position] == c)
+            {
+                ++position;
+            }
+            else
+            {
+                return {};
+            }
+        }
+
+        // A literal that ends part way through a character of the value has not matched it
+        if (position < value.length() && IsContinuationByte(value[position]))
+        {
+            return {};
+        }
+
+        return position;
+    }
+
+    bool WildcardPattern::Matches(std::string_view folded) const
+    {
+        // The first segment is anchored to the start of the value
+        std::optional<size_t> position = MatchSegmentAt(folded, 0, m_segments.front());
+        if (!position)
+        {
+            return false;
+        }
+
+        if (m_segments.size() == 1)
+        {
+            return position.value() == folded.length();
+        }
+
+        // Each middle segment takes its earliest match, which leaves the most of the value for those after it
+        size_t current = position.value();
+        for (size_t i = 1; i + 1 < m_segments.size(); ++i)
+        {
+            std::optional<size_t> end;
+            for (size_t start = current; start <= folded.length() && !end; start = (start < folded.length() ? NextCharacter(folded, start) : start + 1))
+            {
+                end = MatchSegmentAt(folded, start, m_segments[i]);
+            }
+
+            if (!end)
+            {
+                return false;
+            }
+
+            current = end.value();
+        }
+
+        // The last segment is anchored to the end of the value
+        const std::string& last = m_segments.back();
+        for (size_t start = current; start <= folded.length(); start = (start < folded.length() ? NextCharacter(folded, start) : start + 1))
+        {
+            std::optional<size_t> end = MatchSegmentAt(folded, start, last);
+            if (end && end.value() == folded.length())
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::string WildcardPattern::ToGlob() const
+    {
+        // The wildcards are the same; only the start of a character class needs to be escaped, as a class of itself.
+        std::string result;
+        result.reserve(m_folded.length());
+
+        for (char c : m_folded)
+        {
+            if (c == '[')
+            {
+                result += "[[]";
+            }
+            else
+            {
+                result += c;
+            }
+        }
+
+        return result;
+    }
+
+    std::string WildcardPattern::ToLike() const
+    {
+        std::string result = SQLite::EscapeStringForLike(m_folded);
+
+        for (char& c : result)
+        {
+            if (c == s_WildcardPattern_Any)
+            {
+                c = '%';
+            }
+            else if (c == s_WildcardPattern_Single)
+            {
+                c = '_';
+            }
+        }
+
+        return result;
+    }
+}
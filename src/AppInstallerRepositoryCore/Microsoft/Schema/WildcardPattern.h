@@ -0,0 +1,41 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft::Schema
+{
+    // A wildcard pattern, compiled once for matching against many values.
+    // '*' matches any number of characters and '?' matches exactly one; every other character matches itself,
+    // without regard to case. The values that the pattern is matched against must already be case folded.
+    struct WildcardPattern
+    {
+        WildcardPattern(std::string_view pattern);
+
+        // Gets the case folded characters that every matching value starts with; empty if the pattern starts with a wildcard.
+        const std::string& GetLiteralPrefix() const { return m_literalPrefix; }
+
+        // Determines whether the case folded value matches the pattern.
+        bool Matches(std::string_view folded) const;
+
+        // Gets the pattern as a SQLite GLOB pattern, for matching against case folded values.
+        std::string ToGlob() const;
+
+        // Gets the pattern as a LIKE pattern, escaped with SQLite::EscapeCharForLike.
+        std::string ToLike() const;
+
+    private:
+        // Matches the segment at the start of the value, returning the position after the match.
+        static std::optional<size_t> MatchSegmentAt(std::string_view value, size_t position, std::string_view segment);
+
+        std::string m_folded;
+        std::string m_literalPrefix;
+        // The parts of the folded pattern between the '*' characters; the first and last are empty when
+        // the pattern starts or ends with one.
+        std::vector<std::string> m_segments;
+    };
+}
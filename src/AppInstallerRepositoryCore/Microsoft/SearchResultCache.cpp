@@ -0,0 +1,269 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/SearchResultCache.h"
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    using namespace std::string_literals;
+    using namespace std::string_view_literals;
+
+    namespace
+    {
+        static constexpr std::string_view s_SearchResultCache_FileName = "SearchResultCache.db"sv;
+
+        // The version of the tables below; recorded as the user_version of the database.
+        // Any change to the tables must increase this, causing existing caches to be recreated.
+        static constexpr int s_SearchResultCache_SchemaVersion = 1;
+
+        // Waiting for another process to finish writing is preferable to missing the cache.
+        static constexpr std::chrono::milliseconds s_SearchResultCache_BusyTimeout = 2000ms;
+
+        static constexpr std::string_view s_SearchResultCache_EntriesTable_Create = R"(
+CREATE TABLE [entries](
+    [source] TEXT NOT NULL,
+    [index_identity] TEXT NOT NULL,
+    [request] TEXT NOT NULL,
+    [truncated] INT NOT NULL,
+    [last_used] INT64 NOT NULL,
+    PRIMARY KEY([source], [index_identity], [request]))
+)"sv;
+
+        static constexpr std::string_view s_SearchResultCache_ResultsTable_Create = R"(
+CREATE TABLE [results](
+    [entry] INT64 NOT NULL,
+    [ordinal] INT NOT NULL,
+    [id] INT64 NOT NULL,
+    [field] INT NOT NULL,
+    [match] INT NOT NULL,
+    [value] TEXT NOT NULL,
+    PRIMARY KEY([entry], [ordinal]))
+)"sv;
+
+        // Statements
+        static constexpr std::string_view s_SearchResultCacheStmt_DropEntries = "drop table if exists [entries]"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_DropResults = "drop table if exists [results]"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_GetSchemaVersion = "pragma user_version"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_SetSchemaVersion = "pragma user_version = 1"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_Touch =
+            "update [entries] set [last_used] = (select ifnull(max([last_used]), 0) + 1 from [entries]) where [source] = ? and [index_identity] = ? and [request] = ?"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_GetEntry =
+            "select [rowid], [truncated] from [entries] where [source] = ? and [index_identity] = ? and [request] = ?"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_GetResults =
+            "select [id], [field], [match], [value] from [results] where [entry] = ? order by [ordinal]"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_RemoveEntryResults =
+            "delete from [results] where [entry] in (select [rowid] from [entries] where [source] = ? and [index_identity] = ? and [request] = ?)"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_RemoveEntry =
+            "delete from [entries] where [source] = ? and [index_identity] = ? and [request] = ?"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_AddEntry =
+            "insert into [entries] ([source], [index_identity], [request], [truncated], [last_used]) values (?, ?, ?, ?, (select ifnull(max([last_used]), 0) + 1 from [entries]))"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_AddResult =
+            "insert into [results] ([entry], [ordinal], [id], [field], [match], [value]) values (?, ?, ?, ?, ?, ?)"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_TrimResults =
+            "delete from [results] where [entry] in (select [rowid] from [entries] order by [last_used] desc limit -1 offset ?)"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_TrimEntries =
+            "delete from [entries] where [rowid] in (select [rowid] from [entries] order by [last_used] desc limit -1 offset ?)"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_RemoveSourceResults =
+            "delete from [results] where [entry] in (select [rowid] from [entries] where [source] = ?)"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_RemoveSourceEntries =
+            "delete from [entries] where [source] = ?"sv;
+        static constexpr std::string_view s_SearchResultCacheStmt_GetEntryCount = "select count(*) from [entries]"sv;
+
+        // Binds the key of an entry to the first three parameters of the statement.
+        void BindEntryKey(SQLite::Statement& statement, std::string_view sourceIdentifier, std::string_view indexIdentity, const std::string& request)
+        {
+            statement.Bind(1, sourceIdentifier);
+            statement.Bind(2, indexIdentity);
+            statement.Bind(3, request);
+        }
+
+        // Creates and executes a statement that has no parameters.
+        void Execute(SQLite::Connection& connection, std::string_view sql)
+        {
+            SQLite::Statement statement = SQLite::Statement::Create(connection, sql);
+            statement.Execute();
+        }
+    }
+
+    SearchResultCache::SearchResultCache(SQLite::Connection&& connection, size_t maximumEntries) :
+        m_connection(std::move(connection)), m_maximumEntries(maximumEntries)
+    {
+        THROW_HR_IF(E_INVALIDARG, m_maximumEntries == 0);
+    }
+
+    SearchResultCache SearchResultCache::Open(const std::filesystem::path& filePath, size_t maximumEntries)
+    {
+        if (filePath.has_parent_path())
+        {
+            std::filesystem::create_directories(filePath.parent_path());
+        }
+
+        SearchResultCache result{ SQLite::Connection::Create(filePath.u8string(), SQLite::Connection::OpenDisposition::Create), maximumEntries };
+        result.m_connection.SetBusyTimeout(s_SearchResultCache_BusyTimeout);
+        result.InitializeSchema();
+        return result;
+    }
+
+    std::filesystem::path SearchResultCache::GetDefaultPath()
+    {
+        std::filesystem::path result = Runtime::GetPathTo(Runtime::PathName::LocalState);
+        result /= s_SearchResultCache_FileName;
+        return result;
+    }
+
+    std::string SearchResultCache::GetSourceIdentifier(const SourceDetails& details)
+    {
+        // Matches the identity used for the state and lock of the source; the name is only a user facing alias.
+        return details.Type + '/' + details.Data;
+    }
+
+    void SearchResultCache::RemoveSource(const std::filesystem::path& filePath, std::string_view sourceIdentifier)
+    {
+        if (!std::filesystem::exists(filePath))
+        {
+            return;
+        }
+
+        SearchResultCache cache = Open(filePath);
+        cache.Remove(sourceIdentifier);
+    }
+
+    void SearchResultCache::InitializeSchema()
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_connection, "searchresultcache_initialize");
+
+        SQLite::Statement getVersion = SQLite::Statement::Create(m_connection, s_SearchResultCacheStmt_GetSchemaVersion);
+        THROW_HR_IF(E_UNEXPECTED, !getVersion.Step());
+        int version = getVersion.GetColumn<int>(0);
+
+        if (version == s_SearchResultCache_SchemaVersion)
+        {
+            return;
+        }
+
+        AICLI_LOG(Repo, Info, << "Creating search result cache tables, replacing version " << version);
+
+        Execute(m_connection, s_SearchResultCacheStmt_DropEntries);
+        Execute(m_connection, s_SearchResultCacheStmt_DropResults);
+        Execute(m_connection, s_SearchResultCache_EntriesTable_Create);
+        Execute(m_connection, s_SearchResultCache_ResultsTable_Create);
+
+        static_assert(s_SearchResultCache_SchemaVersion == 1, "Update the set statement with the version");
+        Execute(m_connection, s_SearchResultCacheStmt_SetSchemaVersion);
+
+        savepoint.Commit();
+    }
+
+    std::optional<Schema::ISQLiteIndex::SearchResult> SearchResultCache::Get(std::string_view sourceIdentifier, std::string_view indexIdentity, const SearchRequest& request)
+    {
+        std::string requestString = request.ToString();
+
+        // Read the entry and its results together, as another process may replace it in between.
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_connection, "searchresultcache_get");
+
+        SQLite::Statement getEntry = SQLite::Statement::Create(m_connection, s_SearchResultCacheStmt_GetEntry);
+        BindEntryKey(getEntry, sourceIdentifier, indexIdentity, requestString);
+
+        if (!getEntry.Step())
+        {
+            return {};
+        }
+
+        Schema::ISQLiteIndex::SearchResult result;
+        SQLite::rowid_t entryId = getEntry.GetColumn<SQLite::rowid_t>(0);
+        result.Truncated = getEntry.GetColumn<bool>(1);
+
+        SQLite::Statement getResults = SQLite::Statement::Create(m_connection, s_SearchResultCacheStmt_GetResults);
+        getResults.Bind(1, entryId);
+
+        while (getResults.Step())
+        {
+            auto [id, field, match, value] = getResults.GetRow<SQLite::rowid_t, ApplicationMatchField, MatchType, std::string>();
+            result.Matches.emplace_back(id, ApplicationMatchFilter(field, match, value));
+        }
+
+        savepoint.Commit();
+
+        // Only a hit writes to the cache, so that a miss does not wait on other processes.
+        SQLite::Statement touch = SQLite::Statement::Create(m_connection, s_SearchResultCacheStmt_Touch);
+        BindEntryKey(touch, sourceIdentifier, indexIdentity, requestString);
+        touch.Execute();
+
+        AICLI_LOG(Repo, Verbose, << "Search result cache hit with " << result.Matches.size() << " results for: " << requestString);
+
+        return result;
+    }
+
+    void SearchResultCache::Put(std::string_view sourceIdentifier, std::string_view indexIdentity, const SearchRequest& request, const Schema::ISQLiteIndex::SearchResult& result)
+    {
+        std::string requestString = request.ToString();
+
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_connection, "searchresultcache_put");
+
+        SQLite::Statement removeResults = SQLite::Statement::Create(m_connection, s_SearchResultCacheStmt_RemoveEntryResults);
+        BindEntryKey(removeResults, sourceIdentifier, indexIdentity, requestString);
+        removeResults.Execute();
+
+        SQLite::Statement removeEntry = SQLite::Statement::Create(m_connection, s_SearchResultCacheStmt_RemoveEntry);
+        BindEntryKey(removeEntry, sourceIdentifier, indexIdentity, requestString);
+        removeEntry.Execute();
+
+        SQLite::Statement addEntry = SQLite::Statement::Create(m_connection, s_SearchResultCacheStmt_AddEntry);
+        BindEntryKey(addEntry, sourceIdentifier, indexIdentity, requestString);
+        addEntry.Bind(4, result.Truncated);
+        addEntry.Execute();
+
+        SQLite::rowid_t entryId = m_connection.GetLastInsertRowID();
+
+        SQLite::Statement addResult = SQLite::Statement::Create(m_connection, s_SearchResultCacheStmt_AddResult);
+        int ordinal = 0;
+
+        for (const auto& match : result.Matches)
+        {
+            addResult.Reset();
+            addResult.Bind(1, entryId);
+            addResult.Bind(2, ordinal++);
+            addResult.Bind(3, match.first);
+            addResult.Bind(4, match.second.Field);
+            addResult.Bind(5, match.second.Type);
+            addResult.Bind(6, static_cast<const std::string&>(match.second.Value));
+            addResult.Execute();
+        }
+
+        // Remove the least recently used entries beyond the maximum; results first, as they are found through the entries.
+        SQLite::Statement trimResults = SQLite::Statement::Create(m_connection, s_SearchResultCacheStmt_TrimResults);
+        trimResults.Bind(1, static_cast<int64_t>(m_maximumEntries));
+        trimResults.Execute();
+
+        SQLite::Statement trimEntries = SQLite::Statement::Create(m_connection, s_SearchResultCacheStmt_TrimEntries);
+        trimEntries.Bind(1, static_cast<int64_t>(m_maximumEntries));
+        trimEntries.Execute();
+
+        savepoint.Commit();
+    }
+
+    void SearchResultCache::Remove(std::string_view sourceIdentifier)
+    {
+        SQLite::Savepoint savepoint = SQLite::Savepoint::Create(m_connection, "searchresultcache_remove");
+
+        SQLite::Statement removeResults = SQLite::Statement::Create(m_connection, s_SearchResultCacheStmt_RemoveSourceResults);
+        removeResults.Bind(1, sourceIdentifier);
+        removeResults.Execute();
+
+        SQLite::Statement removeEntries = SQLite::Statement::Create(m_connection, s_SearchResultCacheStmt_RemoveSourceEntries);
+        removeEntries.Bind(1, sourceIdentifier);
+        removeEntries.Execute();
+
+        AICLI_LOG(Repo, Info, << "Removed " << m_connection.GetChanges() << " search result cache entries for source: " << sourceIdentifier);
+
+        savepoint.Commit();
+    }
+
+    size_t SearchResultCache::GetEntryCount()
+    {
+        SQLite::Statement getCount = SQLite::Statement::Create(m_connection, s_SearchResultCacheStmt_GetEntryCount);
+        THROW_HR_IF(E_UNEXPECTED, !getCount.Step());
+        return static_cast<size_t>(getCount.GetColumn<int64_t>(0));
+    }
+}
@@ -0,0 +1,66 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "SQLiteWrapper.h"
+#include "Microsoft/Schema/ISQLiteIndex.h"
+#include "Public/AppInstallerRepositorySearch.h"
+#include "Public/AppInstallerRepositorySource.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // A cache of index search results, stored in a database so that it is shared by every process.
+    // Entries are keyed on the source, the identity of the index contents, and the search request,
+    // and hold the matched ids; the least recently used entries are removed beyond a maximum count.
+    struct SearchResultCache
+    {
+        // The default maximum number of entries in the cache.
+        static constexpr size_t DefaultMaximumEntries = 256;
+
+        // Opens the cache at the given location, creating it if it does not exist.
+        static SearchResultCache Open(const std::filesystem::path& filePath, size_t maximumEntries = DefaultMaximumEntries);
+
+        // Gets the location of the cache shared by the sources.
+        static std::filesystem::path GetDefaultPath();
+
+        // Gets the identifier for a source in the cache.
+        static std::string GetSourceIdentifier(const SourceDetails& details);
+
+        // Removes the entries for the source from the cache at the given location, if the cache exists.
+        // This should be called while holding the write lock of the source, after its index has been replaced.
+        static void RemoveSource(const std::filesystem::path& filePath, std::string_view sourceIdentifier);
+
+        SearchResultCache(const SearchResultCache&) = delete;
+        SearchResultCache& operator=(const SearchResultCache&) = delete;
+
+        SearchResultCache(SearchResultCache&&) = default;
+        SearchResultCache& operator=(SearchResultCache&&) = default;
+
+        // Gets the cached result of the request, marking it as the most recently used.
+        // Returns an empty value if there is no entry for the request.
+        std::optional<Schema::ISQLiteIndex::SearchResult> Get(std::string_view sourceIdentifier, std::string_view indexIdentity, const SearchRequest& request);
+
+        // Stores the result of the request, replacing any existing entry.
+        void Put(std::string_view sourceIdentifier, std::string_view indexIdentity, const SearchRequest& request, const Schema::ISQLiteIndex::SearchResult& result);
+
+        // Removes all of the entries for the source.
+        void Remove(std::string_view sourceIdentifier);
+
+        // Gets the number of entries in the cache.
+        size_t GetEntryCount();
+
+    private:
+        SearchResultCache(SQLite::Connection&& connection, size_t maximumEntries);
+
+        // Creates the tables, or recreates them if they are from a different version of the cache.
+        void InitializeSchema();
+
+        SQLite::Connection m_connection;
+        size_t m_maximumEntries;
+    };
+}
@@ -0,0 +1,280 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Microsoft/SourceBundle.h"
+
+using namespace std::string_literals;
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    namespace
+    {
+        constexpr char s_SourceBundleMagic[4] = { 'W', 'G', 'S', 'B' };
+
+        // Must be changed whenever the layout of the file changes.
+        constexpr uint32_t s_SourceBundleVersion = 1;
+
+        // Data in the bundle is not valid.
+        constexpr HRESULT s_CorruptBundleError = HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT);
+
+        // The data of each entry starts on this boundary.
+        constexpr uint64_t s_DataAlignment = 8;
+
+        // Entries are written out in pieces of this size, so that a large installer is not all paged in at once.
+        constexpr size_t s_ExtractChunkSize = 1024 * 1024;
+
+        struct FileHeader
+        {
+            char Magic[4];
+            uint32_t Version;
+            uint32_t Count;
+            uint32_t Reserved;
+        };
+        static_assert(sizeof(FileHeader) == 16);
+
+        struct FileEntry
+        {
+            uint64_t NameOffset;
+            uint64_t DataOffset;
+            uint64_t DataSize;
+            uint32_t NameSize;
+            uint32_t Reserved;
+        };
+        static_assert(sizeof(FileEntry) == 32);
+
+        // An entry to be written, whose data is the content of a file.
+        struct PendingEntry
+        {
+            std::string Name;
+            std::filesystem::path Source;
+            uint64_t Size;
+        };
+
+        uint64_t Align(uint64_t offset)
+        {
+            return (offset + s_DataAlignment - 1) / s_DataAlignment * s_DataAlignment;
+        }
+
+        void WritePadding(std::ostream& stream, uint64_t from, uint64_t to)
+        {
+            static constexpr char s_Zeros[s_DataAlignment] = {};
+            stream.write(s_Zeros, static_cast<std::streamsize>(to - from));
+        }
+
+        // Writes the data to the file in chunks, adding each to the hash if one is given.
+        void WriteData(std::string_view data, const std::filesystem::path& destination, Utility::SHA256* hash)
+        {
+            std::ofstream stream{ destination, std::ios::binary | std::ios::trunc };
+            THROW_LAST_ERROR_IF(stream.fail());
+
+            for (size_t offset = 0; offset < data.size(); offset += s_ExtractChunkSize)
+            {
+                std::string_view chunk = data.substr(offset, s_ExtractChunkSize);
+                if (hash)
+                {
+                    hash->Add(reinterpret_cast<const uint8_t*>(chunk.data()), chunk.size());
+                }
+                stream.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            }
+
+            stream.flush();
+            THROW_HR_IF(E_FAIL, stream.fail());
+        }
+    }
+
+    void SourceBundle::Create(
+        const std::filesystem::path& filePath,
+        const std::filesystem::path& indexPath,
+        const std::optional<std::filesystem::path>& manifestCachePath,
+        const std::vector<std::filesystem::path>& installerPaths)
+    {
+        AICLI_LOG(Repo, Info, << "Creating source bundle with " << installerPaths.size() << " installers at [" << filePath << "]");
+
+        std::vector<PendingEntry> pending;
+        pending.push_back({ std::string{ IndexEntryName }, indexPath, std::filesystem::file_size(indexPath) });
+
+        if (manifestCachePath)
+        {
+            pending.push_back({ std::string{ ManifestCacheEntryName }, manifestCachePath.value(), std::filesystem::file_size(manifestCachePath.value()) });
+        }
+
+        for (const auto& installerPath : installerPaths)
+        {
+            std::string name = GetInstallerEntryName(Utility::SHA256::ComputeHashFromFile(installerPath));
+
+            // The same installer is only held once, however many manifests name it
+            if (std::none_of(pending.begin(), pending.end(), [&](const PendingEntry& entry) { return entry.Name == name; }))
+            {
+                pending.push_back({ std::move(name), installerPath, std::filesystem::file_size(installerPath) });
+            }
+        }
+
+        std::sort(pending.begin(), pending.end(), [](const PendingEntry& a, const PendingEntry& b) { return a.Name < b.Name; });
+
+        FileHeader header{};
+        std::memcpy(header.Magic, s_SourceBundleMagic, sizeof(header.Magic));
+        header.Version = s_SourceBundleVersion;
+        header.Count = wil::safe_cast<uint32_t>(pending.size());
+
+        std::vector<FileEntry> entries;
+        entries.reserve(pending.size());
+
+        // The names come first, so that looking up an entry only reads the start of the file
+        uint64_t offset = sizeof(FileHeader) + sizeof(FileEntry) * pending.size();
+        for (const auto& entry : pending)
+        {
+            FileEntry fileEntry{};
+            fileEntry.NameOffset = offset;
+            fileEntry.NameSize = wil::safe_cast<uint32_t>(entry.Name.size());
+            offset += fileEntry.NameSize;
+            entries.emplace_back(fileEntry);
+        }
+
+        uint64_t namesEnd = offset;
+
+        for (size_t i = 0; i < pending.size(); ++i)
+        {
+            offset = Align(offset);
+            entries[i].DataOffset = offset;
+            entries[i].DataSize = pending[i].Size;
+            offset += entries[i].DataSize;
+        }
+
+        std::ofstream stream{ filePath, std::ios::binary | std::ios::trunc };
+        THROW_LAST_ERROR_IF(stream.fail());
+
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(entries.data()), sizeof(FileEntry) * entries.size());
+        for (const auto& entry : pending)
+        {
+            stream.write(entry.Name.data(), entry.Name.size());
+        }
+
+        WritePadding(stream, namesEnd, entries.front().DataOffset);
+
+        for (size_t i = 0; i < pending.size(); ++i)
+        {
+            // Inserting an empty stream would fail the output
+            if (pending[i].Size > 0)
+            {
+                std::ifstream source{ pending[i].Source, std::ios::binary };
+                THROW_LAST_ERROR_IF(source.fail());
+                stream << source.rdbuf();
+            }
+
+            // The file must not have changed since its size was read, or the offsets that were written are wrong
+            uint64_t end = entries[i].DataOffset + entries[i].DataSize;
+            THROW_HR_IF(E_UNEXPECTED, static_cast<uint64_t>(stream.tellp()) != end);
+
+            if (i + 1 < pending.size())
+            {
+                WritePadding(stream, end, entries[i + 1].DataOffset);
+            }
+        }
+
+        stream.flush();
+        THROW_HR_IF(E_FAIL, stream.fail());
+    }
+
+    SourceBundle SourceBundle::Open(const std::filesystem::path& filePath)
+    {
+        SourceBundle result;
+        result.m_filePath = filePath;
+
+        result.m_file.reset(CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr));
+        THROW_LAST_ERROR_IF_MSG(!result.m_file, "failed opening source bundle");
+
+        LARGE_INTEGER fileSize{};
+        THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(result.m_file.get(), &fileSize));
+        result.m_size = static_cast<uint64_t>(fileSize.QuadPart);
+
+        // An empty file cannot be mapped, and is not a bundle either
+        THROW_HR_IF(s_CorruptBundleError, result.m_size < sizeof(FileHeader));
+
+        result.m_mapping.reset(CreateFileMappingW(result.m_file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+        THROW_LAST_ERROR_IF_NULL_MSG(result.m_mapping, "failed creating file mapping of source bundle");
+
+        result.m_view.reset(static_cast<uint8_t*>(MapViewOfFile(result.m_mapping.get(), FILE_MAP_READ, 0, 0, 0)));
+        THROW_LAST_ERROR_IF_NULL_MSG(result.m_view, "failed mapping view of source bundle");
+
+        const FileHeader* header = reinterpret_cast<const FileHeader*>(result.m_view.get());
+        THROW_HR_IF(s_CorruptBundleError, std::memcmp(header->Magic, s_SourceBundleMagic, sizeof(header->Magic)) != 0);
+        THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_UNSUPPORTED_TYPE), header->Version != s_SourceBundleVersion, "Source bundle version %u is not supported", header->Version);
+
+        result.m_count = header->Count;
+        (void)result.GetBytes(sizeof(FileHeader), sizeof(FileEntry) * static_cast<uint64_t>(result.m_count));
+
+        AICLI_LOG(Repo, Info, << "Opened source bundle with " << result.m_count << " entries at [" << filePath << "]");
+
+        return result;
+    }
+
+    std::optional<SourceBundle::Entry> SourceBundle::GetEntry(std::string_view name) const
+    {
+        const FileEntry* begin = reinterpret_cast<const FileEntry*>(m_view.get() + sizeof(FileHeader));
+        const FileEntry* end = begin + m_count;
+
+        auto nameOf = [this](const FileEntry& entry) { return GetBytes(entry.NameOffset, entry.NameSize); };
+        const FileEntry* entry = std::lower_bound(begin, end, name, [&](const FileEntry& a, std::string_view b) { return nameOf(a) < b; });
+
+        if (entry == end || nameOf(*entry) != name)
+        {
+            return {};
+        }
+
+        // The data is checked here, so that it can be used without checking it again
+        (void)GetBytes(entry->DataOffset, entry->DataSize);
+        return Entry{ entry->DataOffset, entry->DataSize };
+    }
+
+    std::string_view SourceBundle::GetData(const Entry& entry) const
+    {
+        return GetBytes(entry.Offset, entry.Size);
+    }
+
+    void SourceBundle::ExtractEntry(std::string_view name, const std::filesystem::path& destination) const
+    {
+        auto entry = GetEntry(name);
+        THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_NOT_FOUND), !entry, "Source bundle has no entry %hs", std::string{ name }.c_str());
+
+        WriteData(GetData(entry.value()), destination, nullptr);
+    }
+
+    bool SourceBundle::TryExtractInstaller(const Utility::SHA256::HashBuffer& sha256, const std::filesystem::path& destination) const
+    {
+        std::string name = GetInstallerEntryName(sha256);
+        auto entry = GetEntry(name);
+        if (!entry)
+        {
+            return false;
+        }
+
+        Utility::SHA256 hash;
+        WriteData(GetData(entry.value()), destination, &hash);
+
+        // The bundle may have been altered since it was created, so the data is only used if it is still the installer
+        if (hash.Get() != sha256)
+        {
+            AICLI_LOG(Repo, Error, << "Installer in source bundle does not match its hash: " << name);
+
+            std::error_code error;
+            std::filesystem::remove(destination, error);
+            return false;
+        }
+
+        AICLI_LOG(Repo, Info, << "Extracted installer from source bundle: " << name);
+        return true;
+    }
+
+    std::string SourceBundle::GetInstallerEntryName(const Utility::SHA256::HashBuffer& sha256)
+    {
+        return "installers/"s + Utility::SHA256::ConvertToString(sha256);
+    }
+
+    std::string_view SourceBundle::GetBytes(uint64_t offset, uint64_t size) const
+    {
+        THROW_HR_IF(s_CorruptBundleError, offset > m_size || size > m_size - offset);
+        return { reinterpret_cast<const char*>(m_view.get() + offset), static_cast<size_t>(size) };
+    }
+}
@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <AppInstallerSHA256.h>
+#include <wil/resource.h>
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Microsoft
+{
+    // A single file holding an index, the cache of its manifests and the installers that they name, so that a source can be
+    // carried to a machine without a network and installed from entirely. Installers are keyed by their SHA256, as the
+    // manifests name them, so that an installer shared by several manifests is only held once.
+    //
+    // The file is read through a mapped view, and only the entries that are used are read:
+    //  Header      { char magic[4]; uint32 version; uint32 count; uint32 reserved; }
+    //  Entries     { uint64 nameOffset; uint64 dataOffset; uint64 dataSize; uint32 nameSize; uint32 reserved; }[count], ordered by name
+    //  Data        The names, and the data of each entry aligned to 8 bytes
+    struct SourceBundle
+    {
+        // The name of the entry holding the index.
+        static constexpr std::string_view IndexEntryName = "index.db";
+
+        // The name of the entry holding the manifest cache, if the bundle has one.
+        static constexpr std::string_view ManifestCacheEntryName = "manifestcache.bin";
+
+        // The location of an entry in the file.
+        struct Entry
+        {
+            uint64_t Offset = 0;
+            uint64_t Size = 0;
+        };
+
+        // Writes a bundle of the index, the manifest cache if there is one, and the installers, each keyed by its hash.
+        static void Create(
+            const std::filesystem::path& filePath,
+            const std::filesystem::path& indexPath,
+            const std::optional<std::filesystem::path>& manifestCachePath,
+            const std::vector<std::filesystem::path>& installerPaths);
+
+        // Opens an existing bundle; throws if the file is not a bundle of a format that is understood.
+        static SourceBundle Open(const std::filesystem::path& filePath);
+
+        SourceBundle(const SourceBundle&) = delete;
+        SourceBundle& operator=(const SourceBundle&) = delete;
+
+        SourceBundle(SourceBundle&&) = default;
+        SourceBundle& operator=(SourceBundle&&) = default;
+
+        // Gets the path of the file that the bundle was opened from.
+        const std::filesystem::path& GetFilePath() const { return m_filePath; }
+
+        // Gets the number of entries in the bundle.
+        size_t GetCount() const { return m_count; }
+
+        // Gets the location of the named entry, if it is in the bundle.
+        std::optional<Entry> GetEntry(std::string_view name) const;
+
+        // Gets the data of an entry from the mapped view; it is valid for the lifetime of the bundle.
+        std::string_view GetData(const Entry& entry) const;
+
+        // Writes the data of the named entry to the file; throws if it is not in the bundle.
+        void ExtractEntry(std::string_view name, const std::filesystem::path& destination) const;
+
+        // Writes the installer with the hash to the file, if it is in the bundle.
+        // Returns false if it is not, or if its data does not match the hash, in which case nothing is left at the destination.
+        bool TryExtractInstaller(const Utility::SHA256::HashBuffer& sha256, const std::filesystem::path& destination) const;
+
+        // Gets the name of the entry for the installer with the hash.
+        static std::string GetInstallerEntryName(const Utility::SHA256::HashBuffer& sha256);
+
+    private:
+        SourceBundle() = default;
+
+        // Gets bytes from the file, throwing if they are not all within it.
+        std::string_view GetBytes(uint64_t offset, uint64_t size) const;
+
+        std::filesystem::path m_filePath;
+        wil::unique_hfile m_file;
+        wil::unique_handle m_mapping;
+        wil::unique_mapview_ptr<uint8_t> m_view;
+        uint64_t m_size = 0;
+        uint32_t m_count = 0;
+    };
+}
@@ -0,0 +1,50 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <AppInstallerInventory.h>
+#include <AppInstallerRepositorySource.h>
+#include <AppInstallerVersions.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace AppInstaller::Repository
+{
+    // Gets what is installed on the machine, from a snapshot kept in local state that is brought up to date first;
+    // only the entries that changed since the last snapshot are read from the system.
+    std::vector<Inventory::InstalledEntry> GetInstalledInventory();
+
+    // Gets the ids that an installed entry may have in a source, most likely first.
+    std::vector<std::string> GetCandidateIds(const Inventory::InstalledEntry& entry);
+
+    // An installed entry, and the package in a source that it was found to be.
+    struct CorrelatedEntry
+    {
+        Inventory::InstalledEntry Installed;
+
+        // Shared by the entries found to be the same package, such as the 32 and 64-bit entries of it.
+        std::shared_ptr<IApplication> Application;
+
+        // The name of the source that the package is from.
+        std::string SourceName;
+    };
+
+    // Finds the packages in the source that the installed entries are, looking up the candidate ids of all of them at once.
+    // Entries that are not found are left out; the rest keep their order.
+    std::vector<CorrelatedEntry> CorrelateInventory(ISource& source, const std::vector<Inventory::InstalledEntry>& entries);
+
+    // An installed package that the source has a later version of.
+    struct AvailableUpgrade
+    {
+        CorrelatedEntry Entry;
+
+        // The latest version of the package in the general audience channel.
+        Utility::VersionAndChannel Latest;
+    };
+
+    // Finds the installed entries that the source has a later version of, with the same single lookup as CorrelateInventory.
+    // A package that has several installed entries is given once, for the first of them; entries without a version are left out.
+    std::vector<AvailableUpgrade> EvaluateUpgrades(ISource& source, const std::vector<Inventory::InstalledEntry>& entries);
+}
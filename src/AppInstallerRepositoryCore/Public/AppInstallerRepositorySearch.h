@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation.
 // Licensed under the MIT License.
 #pragma once
+#include <AppInstallerProgress.h>
 #include <AppInstallerStrings.h>
 #include <AppInstallerVersions.h>
 #include <winget/LocIndependent.h>
@@ -78,10 +79,31 @@ namespace AppInstaller::Repository
         // The default of 0 will place no limit.
         size_t MaximumResults{};
 
+        // If set, the search stops as soon as possible when the progress is cancelled.
+        // The callback must outlive the search; it is not part of the criteria of the request.
+        IProgressCallback* Progress = nullptr;
+
         // Returns a string summarizing the search request.
         std::string ToString() const;
     };
 
+    // Limits the versions of an application that are returned, keeping their order.
+    struct VersionQuery
+    {
+        // Only versions whose string begins with this, ignoring case, are included; an empty prefix includes every version.
+        std::string Prefix;
+
+        // The number of included versions to skip, and the most to return after them; a limit of 0 returns all of the rest.
+        size_t Offset = 0;
+        size_t Limit = 0;
+
+        // Gets a query for only the first version.
+        static VersionQuery First();
+
+        // Applies the query to versions that are already sorted.
+        std::vector<Utility::VersionAndChannel> Apply(std::vector<Utility::VersionAndChannel> versions) const;
+    };
+
     // A single application result from a search.
     struct IApplication
     {
@@ -102,8 +124,42 @@ namespace AppInstaller::Repository
         // The versions will be returned in sorted, descending order.
         //  Ex. { 4, 3, 2, 1 }
         virtual std::vector<Utility::VersionAndChannel> GetVersions() = 0;
+
+        // Gets the versions of this application that the query includes, in the same order as GetVersions.
+        // Sources that can find only those versions override this.
+        virtual std::vector<Utility::VersionAndChannel> GetVersions(const VersionQuery& query)
+        {
+            return query.Apply(GetVersions());
+        }
+
+        // Gets the manifests for several versions of this application, in the same order.
+        // Each is empty if the version is not found. Sources that can find and fetch them together override this.
+        virtual std::vector<std::optional<Manifest::Manifest>> GetManifests(const std::vector<Utility::VersionAndChannel>& versions)
+        {
+            std::vector<std::optional<Manifest::Manifest>> result;
+            result.reserve(versions.size());
+
+            for (const auto& version : versions)
+            {
+                result.emplace_back(GetManifest(version.GetVersion().ToString(), version.GetChannel().ToString()));
+            }
+
+            return result;
+        }
     };
 
+    // The relevance of a match to a search; a higher score is a better match.
+    // The match type and then the field are the most significant parts, so that scores keep the order of IsBetterMatch
+    // for the match criteria. Matches that are equal in those are then ordered by how early in the matched value the
+    // request value is found, and then by the edit distance between the two values.
+    using MatchScore = uint32_t;
+
+    // Gets the score of a match for the given request value; an empty request value scores only the match type and field.
+    MatchScore GetMatchScore(const ApplicationMatchFilter& match, std::string_view requestValue = {});
+
+    // Gets the score of a match found by the search request, for the best of the request values that search on the field of the match.
+    MatchScore GetMatchScore(const ApplicationMatchFilter& match, const SearchRequest& request);
+
     // A single result from the search.
     struct ResultMatch
     {
@@ -116,7 +172,12 @@ namespace AppInstaller::Repository
         // The name of the source where the result is from. Used in aggregated source scenario.
         std::string SourceName = {};
 
-        ResultMatch(std::unique_ptr<IApplication>&& a, ApplicationMatchFilter f) : Application(std::move(a)), MatchCriteria(std::move(f)) {}
+        // The relevance of the match to the search, which orders the results.
+        MatchScore Score;
+
+        ResultMatch(std::unique_ptr<IApplication>&& a, ApplicationMatchFilter f) : Application(std::move(a)), MatchCriteria(std::move(f)), Score(GetMatchScore(MatchCriteria)) {}
+
+        ResultMatch(std::unique_ptr<IApplication>&& a, ApplicationMatchFilter f, MatchScore s) : Application(std::move(a)), MatchCriteria(std::move(f)), Score(s) {}
     };
 
     // Search result data.
@@ -127,6 +188,44 @@ namespace AppInstaller::Repository
 
         // If true, the results were truncated by the given SearchRequest::MaximumResults.
         bool Truncated = false;
+
+        // The names of the sources that did not respond in time, whose matches are not included.
+        std::vector<std::string> MissingSources;
+    };
+
+    // Returns true if the first criteria is a better match than the second: by MatchType first, then by ApplicationMatchField.
+    // Search results are given best match first; equally good matches keep the order of the source.
+    inline bool IsBetterMatch(const ApplicationMatchFilter& first, const ApplicationMatchFilter& second)
+    {
+        if (first.Type != second.Type)
+        {
+            return first.Type < second.Type;
+        }
+
+        return first.Field < second.Field;
+    }
+
+    // Returns true if the first result is a better match than the second, by the score of each.
+    inline bool IsBetterMatch(const ResultMatch& first, const ResultMatch& second)
+    {
+        return first.Score > second.Score;
+    }
+
+    // A cursor over the results of a search, which creates each result when it is read.
+    // Results are given best match first, as ordered by IsBetterMatch of the results.
+    struct ISearchCursor
+    {
+        virtual ~ISearchCursor() = default;
+
+        // Gets at most count of the next results; fewer are returned only when there are no more.
+        virtual std::vector<ResultMatch> Next(size_t count) = 0;
+
+        // Returns true if the results were truncated by the given SearchRequest::MaximumResults.
+        // This is only final once the cursor has run out of results.
+        virtual bool IsTruncated() const = 0;
+
+        // Gets the names of the sources that did not respond in time, whose matches are not included.
+        virtual std::vector<std::string> GetMissingSources() const { return {}; }
     };
 
     inline std::string_view MatchTypeToString(MatchType type)
@@ -5,6 +5,7 @@
 #include <AppInstallerProgress.h>
 
 #include <chrono>
+#include <filesystem>
 #include <memory>
 #include <optional>
 #include <string>
@@ -35,12 +36,21 @@ namespace AppInstaller::Repository
         // The argument used when adding the source.
         std::string Arg;
 
+        // Other locations that serve the same data as the argument; downloads race the argument against them and
+        // fail over between them.
+        std::vector<std::string> Mirrors;
+
         // The sources extra data string.
         std::string Data;
 
         // The last time that this source was updated.
         std::chrono::system_clock::time_point LastUpdateTime = {};
 
+        // The ETag and Last-Modified headers of the source data that was last fetched, if the source has them.
+        // These allow the next update to only check whether the data has changed.
+        std::string DataETag;
+        std::string DataLastModified;
+
         // The origin of the source.
         SourceOrigin Origin = SourceOrigin::Default;
 
@@ -49,6 +59,8 @@ namespace AppInstaller::Repository
     };
 
     // Interface for interacting with a source from outside of the repository lib.
+    // A source can be searched from several threads at once; the results, cursors and applications that it returns
+    // are each only used by one thread at a time.
     struct ISource
     {
         virtual ~ISource() = default;
@@ -58,6 +70,26 @@ namespace AppInstaller::Repository
 
         // Execute a search on the source.
         virtual SearchResult Search(const SearchRequest& request) = 0;
+
+        // Opens a cursor over the results of a search on the source, so that only the results that are read are created.
+        // The default implementation takes the results from Search.
+        virtual std::unique_ptr<ISearchCursor> OpenSearchCursor(const SearchRequest& request);
+
+        // Finds each of the given ids exactly, giving the matches in the order of the ids; ids that are not found have no match.
+        // The default implementation performs an exact id search for each one.
+        virtual SearchResult SearchForIds(const std::vector<std::string>& ids);
+
+        // Determines if the source may have a package with the id; false only if it definitely does not.
+        // The default implementation always returns true.
+        virtual bool MayContainId(std::string_view id) const;
+
+        // Writes the installer with the hash to the file if the source holds it, so that it need not be downloaded.
+        // Returns true only if what was written matches the hash. The default implementation holds no installers.
+        virtual bool TryGetInstaller(const std::vector<uint8_t>& sha256, const std::filesystem::path& destination) const;
+
+        // Determines if more than one search of the source can be made at once, such that a duplicate of a slow search
+        // may be answered sooner. The default implementation returns false.
+        virtual bool SupportsConcurrentSearches() const;
     };
 
     // Gets the details for all sources.
@@ -67,16 +99,32 @@ namespace AppInstaller::Repository
     std::optional<SourceDetails> GetSource(std::string_view name);
 
     // Adds a new source for the user.
-    void AddSource(std::string_view name, std::string_view type, std::string_view arg, IProgressCallback& progress);
+    // The mirrors are other locations serving the same data as the argument.
+    void AddSource(std::string_view name, std::string_view type, std::string_view arg, IProgressCallback& progress, const std::vector<std::string>& mirrors = {});
 
     // Opens an existing source.
     // Passing an empty string as the name of the source will return a source that aggregates all others.
     std::shared_ptr<ISource> OpenSource(std::string_view name, IProgressCallback& progress);
 
+    // Gets the values of the field that start with the prefix from the completion indexes of the sources, without opening them.
+    // Passing an empty string as the name of the source gets the values from all sources.
+    // Returns an empty optional if the completion index feature is disabled, or if any of the sources has no completion index or
+    // is due to be updated; the sources must then be opened and searched instead.
+    std::optional<std::vector<std::string>> GetCompletionsFromIndexes(std::string_view name, ApplicationMatchField field, std::string_view prefix);
+
+    // Waits for the source updates that OpenSource started in the background to complete.
+    // The updates need the write lock of their source to finish, so this must only be called once the opened sources are released.
+    void CompleteBackgroundSourceUpdates();
+
     // Updates an existing source.
     // Return value indicates whether the named source was found.
     bool UpdateSource(std::string_view name, IProgressCallback& progress);
 
+    // Updates several existing sources concurrently, recording their update times once all have finished.
+    // Return value indicates, for each name, whether the named source was found.
+    // If any update fails, the first failure is rethrown after the others have finished.
+    std::vector<bool> UpdateSources(const std::vector<std::string>& names, IProgressCallback& progress);
+
     // Removes an existing source.
     // Return value indicates whether the named source was found.
     bool RemoveSource(std::string_view name, IProgressCallback& progress);
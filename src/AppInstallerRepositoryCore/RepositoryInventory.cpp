@@ -0,0 +1,233 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "Public/AppInstallerRepositoryInventory.h"
+#include "InventoryCache.h"
+
+#include <cctype>
+#include <unordered_map>
+#include <unordered_set>
+
+
+namespace AppInstaller::Repository
+{
+    using namespace std::string_view_literals;
+    using namespace Inventory;
+
+    namespace
+    {
+        // Inno Setup names its ARP key after the application id with this suffix.
+        constexpr std::string_view s_InnoKeySuffix = "_is1"sv;
+
+        // An MSI names its ARP key with its product code.
+        bool IsProductCode(std::string_view key)
+        {
+            return key.size() == 38 && key.front() == '{' && key.back() == '}';
+        }
+
+        bool IsIdCharacter(char c)
+        {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '+';
+        }
+
+        // Splits the value at spaces, leaving out empty parts.
+        std::vector<std::string_view> SplitWords(std::string_view value)
+        {
+            std::vector<std::string_view> result;
+
+            size_t start = 0;
+            while (start < value.size())
+            {
+                size_t end = value.find(' ', start);
+                if (end == std::string_view::npos)
+                {
+                    end = value.size();
+                }
+
+                if (end > start)
+                {
+                    result.emplace_back(value.substr(start, end - start));
+                }
+
+                start = end + 1;
+            }
+
+            return result;
+        }
+
+        // Gets the characters of the word that can be part of an id.
+        std::string ToIdPart(std::string_view word)
+        {
+            std::string result;
+            std::copy_if(word.begin(), word.end(), std::back_inserter(result), IsIdCharacter);
+            return result;
+        }
+    }
+
+    std::vector<InstalledEntry> GetInstalledInventory()
+    {
+        Logging::ScopedPerformanceTimer timer{ Logging::PerformanceOperation::InventoryRefresh };
+
+        InventoryCache cache = InventoryCache::Open(InventoryCache::GetDefaultPath());
+        cache.Refresh();
+        return cache.GetEntries();
+    }
+
+    std::vector<std::string> GetCandidateIds(const InstalledEntry& entry)
+    {
+        std::vector<std::string> result;
+
+        auto add = [&](std::string id)
+        {
+            if (!id.empty() && std::find(result.begin(), result.end(), id) == result.end())
+            {
+                result.emplace_back(std::move(id));
+            }
+        };
+
+        // The name of a package identity is usually its id as well
+        if (entry.Location == EntryLocation::Msix)
+        {
+            add(entry.Name);
+            return result;
+        }
+
+        // A key that is not a product code is usually named after the application by its installer
+        if (!IsProductCode(entry.Key))
+        {
+            std::string_view key = entry.Key;
+            if (key.size() > s_InnoKeySuffix.size() && Utility::CaseInsensitiveEquals(key.substr(key.size() - s_InnoKeySuffix.size()), s_InnoKeySuffix))
+            {
+                key.remove_suffix(s_InnoKeySuffix.size());
+            }
+
+            if (std::all_of(key.begin(), key.end(), [](char c) { return IsIdCharacter(c) || c == '.'; }))
+            {
+                add(std::string{ key });
+            }
+        }
+
+        // Ids are usually formed as Publisher.Name, from the first word of the publisher and the name without spaces,
+        // leaving out the publisher at the start of the name and the version and architecture that often follow it.
+        std::vector<std::string_view> publisherWords = SplitWords(entry.Publisher);
+        std::vector<std::string_view> nameWords = SplitWords(entry.Name);
+        if (publisherWords.empty() || nameWords.empty())
+        {
+            return result;
+        }
+
+        std::string publisher = ToIdPart(publisherWords.front());
+
+        std::string name;
+        for (size_t i = 0; i < nameWords.size(); ++i)
+        {
+            std::string_view word = nameWords[i];
+            if (i == 0 && nameWords.size() > 1 && Utility::CaseInsensitiveEquals(ToIdPart(word), publisher))
+            {
+                continue;
+            }
+
+            if (i > 0 && (std::isdigit(static_cast<unsigned char>(word.front())) || word.front() == '(' || word.front() == '-'))
+            {
+                break;
+            }
+
+            name += ToIdPart(word);
+        }
+
+        if (!publisher.empty() && !name.empty())
+        {
+            add(publisher + '.' + name);
+        }
+
+        return result;
+    }
+
+    std::vector<CorrelatedEntry> CorrelateInventory(ISource& source, const std::vector<InstalledEntry>& entries)
+    {
+        std::vector<std::vector<std::string>> candidates;
+        candidates.reserve(entries.size());
+
+        std::vector<std::string> ids;
+        for (const auto& entry : entries)
+        {
+            candidates.emplace_back(GetCandidateIds(entry));
+            ids.insert(ids.end(), candidates.back().begin(), candidates.back().end());
+        }
+
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+        AICLI_LOG(Repo, Info, << "Correlating " << entries.size() << " installed entries using " << ids.size() << " candidate ids");
+
+        // A single lookup of every candidate, rather than a search for each entry
+        SearchResult searchResult = source.SearchForIds(ids);
+
+        // Entries of the same package share it, so the first match for each id is kept
+        std::unordered_map<std::string, std::pair<std::shared_ptr<IApplication>, std::string>> found;
+        for (auto& match : searchResult.Matches)
+        {
+            found.emplace(match.MatchCriteria.Value, std::make_pair(std::shared_ptr<IApplication>{ std::move(match.Application) }, match.SourceName));
+        }
+
+        std::vector<CorrelatedEntry> result;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            for (const auto& candidate : candidates[i])
+            {
+                auto itr = found.find(candidate);
+                if (itr != found.end())
+                {
+                    result.push_back({ entries[i], itr->second.first, itr->second.second.empty() ? source.GetDetails().Name : itr->second.second });
+                    break;
+                }
+            }
+        }
+
+        AICLI_LOG(Repo, Info, << "Correlated " << result.size() << " of " << entries.size() << " installed entries");
+        return result;
+    }
+
+    std::vector<AvailableUpgrade> EvaluateUpgrades(ISource& source, const std::vector<InstalledEntry>& entries)
+    {
+        std::vector<CorrelatedEntry> correlated = CorrelateInventory(source, entries);
+
+        std::vector<AvailableUpgrade> candidates;
+        std::vector<std::string> installedKeys;
+        std::vector<std::string> latestKeys;
+        std::unordered_set<IApplication*> seen;
+
+        for (auto& entry : correlated)
+        {
+            if (entry.Installed.Version.empty() || !seen.insert(entry.Application.get()).second)
+            {
+                continue;
+            }
+
+            // The versions of an indexed package are read with its summary, in batches, rather than by a query for each
+            auto versions = entry.Application->GetVersions();
+            auto latest = std::find_if(versions.begin(), versions.end(), [](const Utility::VersionAndChannel& version) { return version.GetChannel().ToString().empty(); });
+            if (latest == versions.end())
+            {
+                continue;
+            }
+
+            installedKeys.emplace_back(Utility::Version{ entry.Installed.Version }.GetSortKey());
+            latestKeys.emplace_back(latest->GetVersion().GetSortKey());
+            candidates.push_back({ std::move(entry), *latest });
+        }
+
+        // The keys are encoded once, and then compared as bytes without parsing either version again
+        std::vector<AvailableUpgrade> result;
+        for (size_t i = 0; i < candidates.size(); ++i)
+        {
+            if (latestKeys[i] > installedKeys[i])
+            {
+                result.emplace_back(std::move(candidates[i]));
+            }
+        }
+
+        AICLI_LOG(Repo, Info, << "Found " << result.size() << " upgrades for " << candidates.size() << " installed packages");
+        return result;
+    }
+}
@@ -5,7 +5,10 @@
 
 #include "AggregatedSource.h"
 #include "SourceFactory.h"
+#include "Microsoft/BundleSourceFactory.h"
+#include "Microsoft/DirectorySourceFactory.h"
 #include "Microsoft/PreIndexedPackageSourceFactory.h"
+#include "Microsoft/RestSourceFactory.h"
 
 namespace AppInstaller::Repository
 {
@@ -20,10 +23,16 @@ namespace AppInstaller::Repository
     constexpr std::string_view s_SourcesYaml_Source_Arg = "Arg"sv;
     constexpr std::string_view s_SourcesYaml_Source_Data = "Data"sv;
     constexpr std::string_view s_SourcesYaml_Source_IsTombstone = "IsTombstone"sv;
+    constexpr std::string_view s_SourcesYaml_Source_Mirrors = "Mirrors"sv;
 
     constexpr std::string_view s_MetadataYaml_Sources = "Sources"sv;
     constexpr std::string_view s_MetadataYaml_Source_Name = "Name"sv;
     constexpr std::string_view s_MetadataYaml_Source_LastUpdate = "LastUpdate"sv;
+    constexpr std::string_view s_MetadataYaml_Source_DataETag = "DataETag"sv;
+    constexpr std::string_view s_MetadataYaml_Source_DataLastModified = "DataLastModified"sv;
+
+    // Guards the metadata setting, so that the processes changing the metadata of different sources keep each other's changes.
+    constexpr std::string_view s_MetadataLockName = "WinGetSourcesMetadataCPRWL"sv;
 
     constexpr std::string_view s_Source_WingetCommunityDefault_Name = "winget"sv;
     constexpr std::string_view s_Source_WingetCommunityDefault_Arg = "https://winget.azureedge.net/cache"sv;
@@ -67,17 +76,46 @@ namespace AppInstaller::Repository
             return true;
         }
 
-        // Attempts to read the source details from the given stream.
+        // Reads an optional sequence of scalars; a value that is present but not a sequence of scalars is invalid.
+        bool TryReadOptionalSequence(std::string_view settingName, const std::string& settingValue, const YAML::Node& sourceNode, std::string_view name, std::vector<std::string>& values)
+        {
+            YAML::Node valueNode = sourceNode[std::string{ name }];
+
+            if (!valueNode || valueNode.IsNull())
+            {
+                return true;
+            }
+
+            if (!valueNode.IsSequence())
+            {
+                AICLI_LOG(Repo, Error, << "Setting '" << settingName << "' did not contain the expected format (" << name << " is not a sequence within a source):\n" << settingValue);
+                return false;
+            }
+
+            for (const auto& item : valueNode.Sequence())
+            {
+                if (!item.IsScalar())
+                {
+                    AICLI_LOG(Repo, Error, << "Setting '" << settingName << "' did not contain the expected format (" << name << " is invalid within a source):\n" << settingValue);
+                    return false;
+                }
+
+                values.emplace_back(item.as<std::string>());
+            }
+
+            return true;
+        }
+
+        // Attempts to read the source details from the given setting value.
         // Results are all or nothing; if any failures occur, no details are returned.
         bool TryReadSourceDetails(
             std::string_view settingName,
-            std::istream& stream,
+            const std::string& settingValue,
             std::string_view rootName,
             std::function<bool(SourceDetailsInternal&, const std::string&, const YAML::Node&)> parse,
             std::vector<SourceDetailsInternal>& sourceDetails)
         {
             std::vector<SourceDetailsInternal> result;
-            std::string settingValue = Utility::ReadEntireStream(stream);
 
             YAML::Node document;
             try
@@ -132,40 +170,34 @@ namespace AppInstaller::Repository
             return true;
         }
 
-        // Gets the source details from a particular setting, or an empty optional if no setting exists.
-        std::optional<std::vector<SourceDetailsInternal>> TryGetSourcesFromSetting(
-            const Settings::StreamDefinition& setting,
-            std::string_view rootName,
-            std::function<bool(SourceDetailsInternal&, const std::string&, const YAML::Node&)> parse)
+        // Reads the value of a setting, or an empty optional if no setting exists.
+        // Note that this case is different than the one in which all sources have been removed.
+        std::optional<std::string> ReadSetting(const Settings::StreamDefinition& setting)
         {
-            auto sourcesStream = Settings::GetSettingStream(setting);
-            if (!sourcesStream)
-            {
-                // Note that this case is different than the one in which all sources have been removed.
-                return {};
-            }
-            else
-            {
-                std::vector<SourceDetailsInternal> result;
-                THROW_HR_IF(APPINSTALLER_CLI_ERROR_SOURCES_INVALID, !TryReadSourceDetails(setting.Path, *sourcesStream, rootName, parse, result));
-                return result;
-            }
+            return Settings::GetSetting(setting);
         }
 
-        // Gets the source details from a particular setting.
+        // Gets the source details from the value of a particular setting.
         std::vector<SourceDetailsInternal> GetSourcesFromSetting(
             const Settings::StreamDefinition& setting,
+            const std::optional<std::string>& settingValue,
             std::string_view rootName,
             std::function<bool(SourceDetailsInternal&, const std::string&, const YAML::Node&)> parse)
         {
-            return TryGetSourcesFromSetting(setting, rootName, parse).value_or(std::vector<SourceDetailsInternal>{});
+            std::vector<SourceDetailsInternal> result;
+            if (settingValue)
+            {
+                THROW_HR_IF(APPINSTALLER_CLI_ERROR_SOURCES_INVALID, !TryReadSourceDetails(setting.Path, *settingValue, rootName, parse, result));
+            }
+            return result;
         }
 
-        // Gets the metadata.
-        std::vector<SourceDetailsInternal> GetMetadata()
+        // Gets the metadata from the value of its setting.
+        std::vector<SourceDetailsInternal> GetMetadata(const std::optional<std::string>& settingValue)
         {
             return GetSourcesFromSetting(
                 Settings::Streams::SourcesMetadata,
+                settingValue,
                 s_MetadataYaml_Sources,
                 [&](SourceDetailsInternal& details, const std::string& settingValue, const YAML::Node& source)
                 {
@@ -174,12 +206,15 @@ namespace AppInstaller::Repository
                     int64_t lastUpdateInEpoch{};
                     if (!TryReadScalar(name, settingValue, source, s_MetadataYaml_Source_LastUpdate, lastUpdateInEpoch)) { return false; }
                     details.LastUpdateTime = Utility::ConvertUnixEpochToSystemClock(lastUpdateInEpoch);
+                    // Optional; only present for sources whose data has these headers.
+                    TryReadScalar(name, settingValue, source, s_MetadataYaml_Source_DataETag, details.DataETag, false);
+                    TryReadScalar(name, settingValue, source, s_MetadataYaml_Source_DataLastModified, details.DataLastModified, false);
                     return true;
                 });
         }
 
-        // Gets the sources from a particular origin.
-        std::vector<SourceDetailsInternal> GetSourcesByOrigin(SourceOrigin origin)
+        // Gets the sources from a particular origin, with the value of the user sources setting.
+        std::vector<SourceDetailsInternal> GetSourcesByOrigin(SourceOrigin origin, const std::optional<std::string>& userSourcesValue)
         {
             std::vector<SourceDetailsInternal> result;
 
@@ -208,6 +243,7 @@ namespace AppInstaller::Repository
             case SourceOrigin::User:
                 result = GetSourcesFromSetting(
                     Settings::Streams::UserSources,
+                    userSourcesValue,
                     s_SourcesYaml_Sources,
                     [&](SourceDetailsInternal& details, const std::string& settingValue, const YAML::Node& source)
                     {
@@ -217,6 +253,7 @@ namespace AppInstaller::Repository
                         if (!TryReadScalar(name, settingValue, source, s_SourcesYaml_Source_Arg, details.Arg)) { return false; }
                         if (!TryReadScalar(name, settingValue, source, s_SourcesYaml_Source_Data, details.Data)) { return false; }
                         if (!TryReadScalar(name, settingValue, source, s_SourcesYaml_Source_IsTombstone, details.IsTombstone)) { return false; }
+                        if (!TryReadOptionalSequence(name, settingValue, source, s_SourcesYaml_Source_Mirrors, details.Mirrors)) { return false; }
                         return true;
                     });
                 break;
@@ -232,14 +269,29 @@ namespace AppInstaller::Repository
             return result;
         }
 
-        // Gets the internal view of the sources.
-        std::vector<SourceDetailsInternal> GetSourcesInternal()
+        // Gets the sources from a particular origin.
+        std::vector<SourceDetailsInternal> GetSourcesByOrigin(SourceOrigin origin)
+        {
+            return GetSourcesByOrigin(origin, (origin == SourceOrigin::User ? ReadSetting(Settings::Streams::UserSources) : std::nullopt));
+        }
+
+        // The sources as they were last created from the settings, so that the settings are only parsed again once they change.
+        struct SourcesSnapshot
+        {
+            std::optional<std::string> UserSourcesValue;
+            std::optional<std::string> MetadataValue;
+            bool MSStoreEnabled = false;
+            std::vector<SourceDetailsInternal> Sources;
+        };
+
+        // Creates the internal view of the sources from the values of the settings.
+        std::vector<SourceDetailsInternal> CreateSourcesInternal(const std::optional<std::string>& userSourcesValue, const std::optional<std::string>& metadataValue)
         {
             std::vector<SourceDetailsInternal> result;
 
             for (SourceOrigin origin : { SourceOrigin::User, SourceOrigin::Default })
             {
-                auto forOrigin = GetSourcesByOrigin(origin);
+                auto forOrigin = GetSourcesByOrigin(origin, userSourcesValue);
 
                 for (auto&& source : forOrigin)
                 {
@@ -269,19 +321,59 @@ namespace AppInstaller::Repository
                 }
             }
 
-            auto metadata = GetMetadata();
+            auto metadata = GetMetadata(metadataValue);
             for (const auto& metaSource : metadata)
             {
                 auto itr = FindSourceByName(result, metaSource.Name);
                 if (itr != result.end())
                 {
                     itr->LastUpdateTime = metaSource.LastUpdateTime;
+                    itr->DataETag = metaSource.DataETag;
+                    itr->DataLastModified = metaSource.DataLastModified;
                 }
             }
 
             return result;
         }
 
+        // Gets the internal view of the sources.
+        // The settings are read on every call, as any process may change them, but they are only parsed when their values
+        // differ from the ones the last view was created from.
+        std::vector<SourceDetailsInternal> GetSourcesInternal()
+        {
+            static wil::srwlock s_snapshotLock;
+            static std::optional<SourcesSnapshot> s_snapshot;
+
+            std::optional<std::string> userSourcesValue = ReadSetting(Settings::Streams::UserSources);
+            std::optional<std::string> metadataValue;
+            {
+                auto metadataLock = Synchronization::CrossProcessReaderWriteLock::LockForRead(s_MetadataLockName);
+                metadataValue = ReadSetting(Settings::Streams::SourcesMetadata);
+            }
+            bool msStoreEnabled = Settings::ExperimentalFeature::IsEnabled(Settings::ExperimentalFeature::Feature::ExperimentalMSStore);
+
+            {
+                auto lock = s_snapshotLock.lock_shared();
+                if (s_snapshot &&
+                    s_snapshot->MSStoreEnabled == msStoreEnabled &&
+                    s_snapshot->UserSourcesValue == userSourcesValue &&
+                    s_snapshot->MetadataValue == metadataValue)
+                {
+                    return s_snapshot->Sources;
+                }
+            }
+
+            SourcesSnapshot snapshot;
+            snapshot.Sources = CreateSourcesInternal(userSourcesValue, metadataValue);
+            snapshot.UserSourcesValue = std::move(userSourcesValue);
+            snapshot.MetadataValue = std::move(metadataValue);
+            snapshot.MSStoreEnabled = msStoreEnabled;
+
+            auto lock = s_snapshotLock.lock_exclusive();
+            s_snapshot = std::move(snapshot);
+            return s_snapshot->Sources;
+        }
+
         // Sets the sources for a particular setting, from a particular origin.
         void SetSourcesToSettingWithFilter(const Settings::StreamDefinition& setting, SourceOrigin origin, const std::vector<SourceDetailsInternal>& sources)
         {
@@ -300,6 +392,15 @@ namespace AppInstaller::Repository
                     out << YAML::Key << s_SourcesYaml_Source_Arg << YAML::Value << details.Arg;
                     out << YAML::Key << s_SourcesYaml_Source_Data << YAML::Value << details.Data;
                     out << YAML::Key << s_SourcesYaml_Source_IsTombstone << YAML::Value << details.IsTombstone;
+                    if (!details.Mirrors.empty())
+                    {
+                        out << YAML::Key << s_SourcesYaml_Source_Mirrors << YAML::Value << YAML::BeginSeq;
+                        for (const auto& mirror : details.Mirrors)
+                        {
+                            out << mirror;
+                        }
+                        out << YAML::EndSeq;
+                    }
                     out << YAML::EndMap;
                 }
             }
@@ -311,6 +412,7 @@ namespace AppInstaller::Repository
         }
 
         // Sets the metadata only (which is not a secure setting and can be set unprivileged)
+        // *Should only be called when under the write CrossProcessReaderWriteLock of the metadata*
         void SetMetadata(const std::vector<SourceDetailsInternal>& sources)
         {
             YAML::Emitter out;
@@ -323,6 +425,14 @@ namespace AppInstaller::Repository
                 out << YAML::BeginMap;
                 out << YAML::Key << s_MetadataYaml_Source_Name << YAML::Value << details.Name;
                 out << YAML::Key << s_MetadataYaml_Source_LastUpdate << YAML::Value << Utility::ConvertSystemClockToUnixEpoch(details.LastUpdateTime);
+                if (!details.DataETag.empty())
+                {
+                    out << YAML::Key << s_MetadataYaml_Source_DataETag << YAML::Value << details.DataETag;
+                }
+                if (!details.DataLastModified.empty())
+                {
+                    out << YAML::Key << s_MetadataYaml_Source_DataLastModified << YAML::Value << details.DataLastModified;
+                }
                 out << YAML::EndMap;
             }
 
@@ -332,6 +442,56 @@ namespace AppInstaller::Repository
             Settings::SetSetting(Settings::Streams::SourcesMetadata, out.str());
         }
 
+        // Changes the metadata as it is now, rather than as it was when the sources were read, so that only the records
+        // of the sources that are changed are written; concurrent changes to the records of other sources are kept.
+        void UpdateMetadata(const std::function<void(std::vector<SourceDetailsInternal>&)>& change)
+        {
+            auto lock = Synchronization::CrossProcessReaderWriteLock::LockForWrite(s_MetadataLockName);
+
+            std::vector<SourceDetailsInternal> metadata = GetMetadata(ReadSetting(Settings::Streams::SourcesMetadata));
+            change(metadata);
+            SetMetadata(metadata);
+        }
+
+        // Records the update times and data validators of the sources in the metadata.
+        void RecordSourceUpdates(const std::vector<const SourceDetails*>& sources)
+        {
+            UpdateMetadata([&](std::vector<SourceDetailsInternal>& metadata)
+                {
+                    for (const SourceDetails* source : sources)
+                    {
+                        auto itr = FindSourceByName(metadata, source->Name);
+                        if (itr == metadata.end())
+                        {
+                            itr = metadata.emplace(metadata.end());
+                            itr->Name = source->Name;
+                        }
+
+                        itr->LastUpdateTime = source->LastUpdateTime;
+                        itr->DataETag = source->DataETag;
+                        itr->DataLastModified = source->DataLastModified;
+                    }
+                });
+        }
+
+        void RecordSourceUpdate(const SourceDetails& source)
+        {
+            RecordSourceUpdates({ &source });
+        }
+
+        // Removes the record of the source from the metadata.
+        void RemoveSourceMetadata(std::string_view name)
+        {
+            UpdateMetadata([&](std::vector<SourceDetailsInternal>& metadata)
+                {
+                    auto itr = FindSourceByName(metadata, name);
+                    if (itr != metadata.end())
+                    {
+                        metadata.erase(itr);
+                    }
+                });
+        }
+
         // Sets the sources for a given origin.
         void SetSourcesByOrigin(SourceOrigin origin, const std::vector<SourceDetailsInternal>& sources)
         {
@@ -343,8 +503,6 @@ namespace AppInstaller::Repository
             default:
                 THROW_HR(E_UNEXPECTED);
             }
-
-            SetMetadata(sources);
         }
 
 #ifndef AICLI_DISABLE_TEST_HOOKS
@@ -369,6 +527,21 @@ namespace AppInstaller::Repository
                 return Microsoft::PreIndexedPackageSourceFactory::Create();
             }
 
+            if (Utility::CaseInsensitiveEquals(Microsoft::RestSourceFactory::Type(), type))
+            {
+                return Microsoft::RestSourceFactory::Create();
+            }
+
+            if (Utility::CaseInsensitiveEquals(Microsoft::DirectorySourceFactory::Type(), type))
+            {
+                return Microsoft::DirectorySourceFactory::Create();
+            }
+
+            if (Utility::CaseInsensitiveEquals(Microsoft::BundleSourceFactory::Type(), type))
+            {
+                return Microsoft::BundleSourceFactory::Create();
+            }
+
             THROW_HR(APPINSTALLER_CLI_ERROR_INVALID_SOURCE_TYPE);
         }
 
@@ -409,6 +582,129 @@ namespace AppInstaller::Repository
             AddOrUpdateFromDetails(details, &ISourceFactory::Update, progress);
         }
 
+        // Updates that OpenSource started in the background, by source name.
+        std::mutex s_BackgroundUpdatesLock;
+        std::vector<std::pair<std::string, std::future<void>>> s_BackgroundUpdates;
+
+        // Updates the source on a background thread, so that it can be opened with its existing data right away.
+        // The updated data is used the next time that the source is opened.
+        void UpdateSourceInBackground(const SourceDetails& details)
+        {
+            std::lock_guard<std::mutex> lock{ s_BackgroundUpdatesLock };
+
+            for (const auto& update : s_BackgroundUpdates)
+            {
+                if (Utility::CaseInsensitiveEquals(update.first, details.Name))
+                {
+                    return;
+                }
+            }
+
+            AICLI_LOG(Repo, Info, << "Updating source in the background: " << details.Name);
+
+            s_BackgroundUpdates.emplace_back(details.Name, std::async(std::launch::async, [details]() mutable
+                {
+                    try
+                    {
+                        ProgressCallback progress;
+                        UpdateSourceFromDetails(details, progress);
+
+                        // The source may have been removed while updating
+                        auto currentSources = GetSourcesInternal();
+                        if (FindSourceByName(currentSources, details.Name) != currentSources.end())
+                        {
+                            RecordSourceUpdate(details);
+                        }
+
+                        AICLI_LOG(Repo, Info, << "Background update of source completed: " << details.Name);
+                    }
+                    CATCH_LOG();
+                }));
+        }
+
+        // Combines the progress of several concurrent operations into a single percentage on the given callback,
+        // and forwards cancellation from it to each of the operations.
+        struct AggregateProgress
+        {
+            AggregateProgress(IProgressCallback& progress, size_t count) : m_progress(progress), m_fractions(count)
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    m_parts.emplace_back(std::make_unique<Part>(*this, i));
+                }
+
+                m_cancellation = m_progress.SetCancellationFunction([this]() { CancelAll(); });
+
+                if (m_progress.IsCancelled())
+                {
+                    CancelAll();
+                }
+            }
+
+            AggregateProgress(const AggregateProgress&) = delete;
+            AggregateProgress& operator=(const AggregateProgress&) = delete;
+
+            // Gets the callback for a single operation.
+            IProgressCallback& GetCallback(size_t index)
+            {
+                return m_parts[index]->Callback;
+            }
+
+            // Marks a single operation as fully progressed.
+            void Complete(size_t index)
+            {
+                Report(index, 1.0);
+            }
+
+        private:
+            struct Part : public IProgressSink
+            {
+                Part(AggregateProgress& parent, size_t index) : Parent(parent), Index(index) {}
+
+                void OnProgress(uint64_t current, uint64_t maximum, ProgressType) override
+                {
+                    // Without a maximum, there is nothing to contribute to the percentage.
+                    if (maximum != 0)
+                    {
+                        Parent.Report(Index, static_cast<double>(current) / maximum);
+                    }
+                }
+
+                AggregateProgress& Parent;
+                size_t Index;
+                ProgressCallback Callback{ this };
+            };
+
+            void Report(size_t index, double fraction)
+            {
+                std::lock_guard<std::mutex> lock{ m_lock };
+
+                m_fractions[index] = std::min(fraction, 1.0);
+
+                double total = 0;
+                for (double value : m_fractions)
+                {
+                    total += value;
+                }
+
+                m_progress.OnProgress(static_cast<uint64_t>(total * 100 / m_fractions.size()), 100, ProgressType::Percent);
+            }
+
+            void CancelAll()
+            {
+                for (const auto& part : m_parts)
+                {
+                    part->Callback.Cancel();
+                }
+            }
+
+            IProgressCallback& m_progress;
+            std::vector<std::unique_ptr<Part>> m_parts;
+            std::mutex m_lock;
+            std::vector<double> m_fractions;
+            IProgressCallback::CancelFunctionRemoval m_cancellation;
+        };
+
         void RemoveSourceFromDetails(const SourceDetails& details, IProgressCallback& progress)
         {
             auto factory = GetFactoryForType(details.Type);
@@ -482,10 +778,17 @@ namespace AppInstaller::Repository
         }
     }
 
-    void AddSource(std::string_view name, std::string_view type, std::string_view arg, IProgressCallback& progress)
+    void AddSource(std::string_view name, std::string_view type, std::string_view arg, IProgressCallback& progress, const std::vector<std::string>& mirrors)
     {
         THROW_HR_IF(E_INVALIDARG, name.empty());
 
+        // A mirror must serve the same data over a connection as safe as the one to the argument
+        for (const auto& mirror : mirrors)
+        {
+            THROW_HR_IF(E_INVALIDARG, mirror.empty());
+            THROW_HR_IF(APPINSTALLER_CLI_ERROR_SOURCE_NOT_SECURE, Utility::IsUrlRemote(mirror) && !Utility::IsUrlSecure(mirror));
+        }
+
         AICLI_LOG(Repo, Info, << "Adding source: Name[" << name << "], Type[" << type << "], Arg[" << arg << "]");
 
         // Check all sources for the given name.
@@ -498,6 +801,7 @@ namespace AppInstaller::Repository
         details.Name = name;
         details.Type = type;
         details.Arg = arg;
+        details.Mirrors = mirrors;
         details.LastUpdateTime = Utility::ConvertUnixEpochToSystemClock(0);
         details.Origin = SourceOrigin::User;
 
@@ -507,6 +811,7 @@ namespace AppInstaller::Repository
         currentSources.emplace_back(details);
 
         SetSourcesByOrigin(SourceOrigin::User, currentSources);
+        RecordSourceUpdate(details);
     }
 
     std::shared_ptr<ISource> OpenSource(std::string_view name, IProgressCallback& progress)
@@ -530,24 +835,36 @@ namespace AppInstaller::Repository
                 AICLI_LOG(Repo, Info, << "Default source requested, multiple sources available, creating aggregated source.");
                 auto aggregatedSource = std::make_shared<AggregatedSource>();
 
-                bool sourceUpdated = false;
                 for (auto& source : currentSources)
                 {
                     AICLI_LOG(Repo, Info, << "Adding to aggregated source: " << source.Name);
 
                     if (ShouldUpdateBeforeOpen(source))
                     {
-                        // TODO: Consider adding a context callback to indicate we are doing the same action
-                        // to avoid the progress bar fill up multiple times.
-                        UpdateSourceFromDetails(source, progress);
-                        sourceUpdated = true;
+                        if (ExperimentalFeature::IsEnabled(ExperimentalFeature::Feature::BackgroundSourceUpdate))
+                        {
+                            UpdateSourceInBackground(source);
+                        }
+                        else
+                        {
+                            // TODO: Consider adding a context callback to indicate we are doing the same action
+                            // to avoid the progress bar fill up multiple times.
+                            UpdateSourceFromDetails(source, progress);
+                            RecordSourceUpdate(source);
+
+                            // The source was just updated with the progress shown, so it is opened with it as well.
+                            aggregatedSource->AddSource(CreateSourceFromDetails(source, progress));
+                            continue;
+                        }
                     }
-                    aggregatedSource->AddSource(CreateSourceFromDetails(source, progress));
-                }
 
-                if (sourceUpdated)
-                {
-                    SetMetadata(currentSources);
+                    // Opening is left until a search needs the source, when all of them are opened in parallel.
+                    // The progress is only valid for this call, so opening later reports to no one.
+                    aggregatedSource->AddSource(source, [details = static_cast<SourceDetails>(source)]()
+                        {
+                            ProgressCallback openProgress;
+                            return CreateSourceFromDetails(details, openProgress);
+                        });
                 }
 
                 return aggregatedSource;
@@ -567,14 +884,87 @@ namespace AppInstaller::Repository
                 AICLI_LOG(Repo, Info, << "Named source requested, found: " << itr->Name);
                 if (ShouldUpdateBeforeOpen(*itr))
                 {
-                    UpdateSourceFromDetails(*itr, progress);
-                    SetMetadata(currentSources);
+                    if (ExperimentalFeature::IsEnabled(ExperimentalFeature::Feature::BackgroundSourceUpdate))
+                    {
+                        UpdateSourceInBackground(*itr);
+                    }
+                    else
+                    {
+                        UpdateSourceFromDetails(*itr, progress);
+                        RecordSourceUpdate(*itr);
+                    }
                 }
                 return CreateSourceFromDetails(*itr, progress);
             }
         }
     }
 
+    std::optional<std::vector<std::string>> GetCompletionsFromIndexes(std::string_view name, ApplicationMatchField field, std::string_view prefix)
+    {
+        if (!ExperimentalFeature::IsEnabled(ExperimentalFeature::Feature::CompletionIndex))
+        {
+            return {};
+        }
+
+        auto currentSources = GetSourcesInternal();
+
+        if (!name.empty())
+        {
+            auto itr = FindSourceByName(currentSources, name);
+            if (itr == currentSources.end())
+            {
+                return {};
+            }
+
+            std::vector<SourceDetailsInternal> namedSource{ *itr };
+            currentSources = std::move(namedSource);
+        }
+
+        std::vector<std::string> result;
+
+        for (const auto& source : currentSources)
+        {
+            // A source that is due to be updated is opened, so that the update is not skipped by completion
+            if (!Utility::CaseInsensitiveEquals(source.Type, Microsoft::PreIndexedPackageSourceFactory::Type()) || ShouldUpdateBeforeOpen(source))
+            {
+                return {};
+            }
+
+            auto completions = Microsoft::PreIndexedPackageSourceFactory::GetCompletions(source, field, prefix);
+            if (!completions)
+            {
+                return {};
+            }
+
+            std::move(completions->begin(), completions->end(), std::back_inserter(result));
+        }
+
+        if (currentSources.size() > 1)
+        {
+            std::sort(result.begin(), result.end());
+            result.erase(std::unique(result.begin(), result.end()), result.end());
+        }
+
+        return result;
+    }
+
+    void CompleteBackgroundSourceUpdates()
+    {
+        std::vector<std::pair<std::string, std::future<void>>> updates;
+
+        {
+            std::lock_guard<std::mutex> lock{ s_BackgroundUpdatesLock };
+            updates = std::move(s_BackgroundUpdates);
+            s_BackgroundUpdates.clear();
+        }
+
+        for (auto& update : updates)
+        {
+            AICLI_LOG(Repo, Info, << "Waiting for background update of source: " << update.first);
+            update.second.get();
+        }
+    }
+
     bool UpdateSource(std::string_view name, IProgressCallback& progress)
     {
         THROW_HR_IF(E_INVALIDARG, name.empty());
@@ -592,11 +982,87 @@ namespace AppInstaller::Repository
             AICLI_LOG(Repo, Info, << "Named source to be updated, found: " << itr->Name);
             UpdateSourceFromDetails(*itr, progress);
 
-            SetMetadata(currentSources);
+            RecordSourceUpdate(*itr);
             return true;
         }
     }
 
+    std::vector<bool> UpdateSources(const std::vector<std::string>& names, IProgressCallback& progress)
+    {
+        auto currentSources = GetSourcesInternal();
+
+        std::vector<bool> result;
+        std::vector<SourceDetailsInternal*> sourcesToUpdate;
+
+        for (const auto& name : names)
+        {
+            THROW_HR_IF(E_INVALIDARG, name.empty());
+
+            auto itr = FindSourceByName(currentSources, name);
+
+            if (itr == currentSources.end())
+            {
+                AICLI_LOG(Repo, Info, << "Named source to be updated, but not found: " << name);
+                result.push_back(false);
+            }
+            else
+            {
+                AICLI_LOG(Repo, Info, << "Named source to be updated, found: " << itr->Name);
+                result.push_back(true);
+
+                if (std::find(sourcesToUpdate.begin(), sourcesToUpdate.end(), &*itr) == sourcesToUpdate.end())
+                {
+                    sourcesToUpdate.push_back(&*itr);
+                }
+            }
+        }
+
+        // Each update takes the write lock for its own source only, so they do not contend with each other.
+        AggregateProgress aggregateProgress(progress, sourcesToUpdate.size());
+        std::vector<std::future<void>> updates;
+
+        for (size_t i = 0; i < sourcesToUpdate.size(); ++i)
+        {
+            updates.emplace_back(std::async(std::launch::async, [&, i]()
+                {
+                    UpdateSourceFromDetails(*sourcesToUpdate[i], aggregateProgress.GetCallback(i));
+                    aggregateProgress.Complete(i);
+                }));
+        }
+
+        // Wait for every update before surfacing a failure, so that the ones that succeeded are still recorded.
+        std::exception_ptr failure;
+        std::vector<const SourceDetails*> updatedSources;
+        for (size_t i = 0; i < updates.size(); ++i)
+        {
+            try
+            {
+                updates[i].get();
+                updatedSources.push_back(sourcesToUpdate[i]);
+            }
+            catch (...)
+            {
+                LOG_CAUGHT_EXCEPTION();
+                if (!failure)
+                {
+                    failure = std::current_exception();
+                }
+            }
+        }
+
+        if (!updatedSources.empty())
+        {
+            RecordSourceUpdates(updatedSources);
+        }
+
+        if (failure)
+        {
+            std::rethrow_exception(failure);
+        }
+
+        return result;
+    }
+
     bool RemoveSource(std::string_view name, IProgressCallback& progress)
     {
         THROW_HR_IF(E_INVALIDARG, name.empty());
@@ -647,6 +1113,7 @@ namespace AppInstaller::Repository
             }
 
             SetSourcesByOrigin(SourceOrigin::User, currentSources);
+            RemoveSourceMetadata(name);
 
             return true;
         }
@@ -657,6 +1124,8 @@ namespace AppInstaller::Repository
         if (name.empty())
         {
             Settings::RemoveSetting(Settings::Streams::UserSources);
+
+            auto lock = Synchronization::CrossProcessReaderWriteLock::LockForWrite(s_MetadataLockName);
             Settings::RemoveSetting(Settings::Streams::SourcesMetadata);
             return true;
         }
@@ -677,9 +1146,9 @@ namespace AppInstaller::Repository
                 currentSources.erase(itr);
 
                 // Since this only writes the user setting, it can't actually drop non-user sources.
-                // But since it also implicitly sets all metadata, it will drop the metadata and allow
-                // somewhat of a clean slate.
+                // But since it also drops the metadata, it allows somewhat of a clean slate.
                 SetSourcesByOrigin(SourceOrigin::User, currentSources);
+                RemoveSourceMetadata(name);
 
                 return true;
             }
@@ -718,6 +1187,32 @@ namespace AppInstaller::Repository
         return result.str();
     }
 
+    VersionQuery VersionQuery::First()
+    {
+        VersionQuery result;
+        result.Limit = 1;
+        return result;
+    }
+
+    std::vector<Utility::VersionAndChannel> VersionQuery::Apply(std::vector<Utility::VersionAndChannel> versions) const
+    {
+        if (!Prefix.empty())
+        {
+            versions.erase(std::remove_if(versions.begin(), versions.end(),
+                [&](const Utility::VersionAndChannel& version) { return !Utility::CaseInsensitiveStartsWith(version.GetVersion().ToString(), Prefix); }),
+                versions.end());
+        }
+
+        versions.erase(versions.begin(), versions.begin() + std::min(Offset, versions.size()));
+
+        if (Limit != 0 && versions.size() > Limit)
+        {
+            versions.erase(versions.begin() + Limit, versions.end());
+        }
+
+        return versions;
+    }
+
 #ifndef AICLI_DISABLE_TEST_HOOKS
     void TestHook_SetSourceFactoryOverride(const std::string& type, std::function<std::unique_ptr<ISourceFactory>()>&& factory)
     {
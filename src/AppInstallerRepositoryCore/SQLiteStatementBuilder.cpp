@@ -316,6 +316,18 @@ namespace AppInstaller::Repository::SQLite::Builder
         return *this;
     }
 
+    StatementBuilder& StatementBuilder::Match(std::string_view value)
+    {
+        AddBindFunctor(AppendOpAndBinder(Op::Match), std::string{ value });
+        return *this;
+    }
+
+    StatementBuilder& StatementBuilder::Glob(std::string_view value)
+    {
+        AddBindFunctor(AppendOpAndBinder(Op::Glob), std::string{ value });
+        return *this;
+    }
+
     StatementBuilder& StatementBuilder::Equals(std::nullptr_t)
     {
         // This is almost certainly not what you want.
@@ -562,6 +574,12 @@ namespace AppInstaller::Repository::SQLite::Builder
         return *this;
     }
 
+    StatementBuilder& StatementBuilder::WithoutRowID()
+    {
+        m_stream << " WITHOUT ROWID";
+        return *this;
+    }
+
     StatementBuilder& StatementBuilder::DropTable(std::string_view table)
     {
         OutputOperationAndTable(m_stream, "DROP TABLE", table);
@@ -677,6 +695,26 @@ namespace AppInstaller::Repository::SQLite::Builder
         return *this;
     }
 
+    StatementBuilder& StatementBuilder::Analyze()
+    {
+        m_stream << "ANALYZE";
+        return *this;
+    }
+
+    StatementBuilder& StatementBuilder::With(std::string_view table, std::initializer_list<std::string_view> columns)
+    {
+        OutputOperationAndTable(m_stream, "WITH", table);
+        OutputColumns(m_stream, "(", columns);
+        m_stream << ") AS ";
+        return *this;
+    }
+
+    StatementBuilder& StatementBuilder::UnionAll()
+    {
+        m_stream << " UNION ALL ";
+        return *this;
+    }
+
     StatementBuilder& StatementBuilder::BeginParenthetical()
     {
         m_stream << '(';
@@ -695,6 +733,30 @@ namespace AppInstaller::Repository::SQLite::Builder
         return *this;
     }
 
+    StatementBuilder StatementBuilder::BeginPart() const
+    {
+        StatementBuilder result;
+        result.m_bindIndex = m_bindIndex;
+        result.m_firstBindIndex = m_bindIndex;
+        return result;
+    }
+
+    StatementBuilder& StatementBuilder::Append(StatementBuilder&& part)
+    {
+        // The bind indices of the part are only correct if it begins where this statement ends
+        THROW_HR_IF(E_INVALIDARG, part.m_firstBindIndex != m_bindIndex);
+
+        m_stream << part.m_stream.str();
+        m_binders.insert(m_binders.end(), std::make_move_iterator(part.m_binders.begin()), std::make_move_iterator(part.m_binders.end()));
+        m_bindIndex = part.m_bindIndex;
+        m_needsComma = part.m_needsComma;
+
+        part.m_binders.clear();
+        part.m_firstBindIndex = part.m_bindIndex;
+
+        return *this;
+    }
+
     Statement StatementBuilder::Prepare(Connection& connection)
     {
         Statement result = Statement::Create(connection, m_stream.str());
@@ -705,6 +767,16 @@ namespace AppInstaller::Repository::SQLite::Builder
         return result;
     }
 
+    CachedStatement StatementBuilder::PrepareCached(Connection& connection)
+    {
+        CachedStatement result = connection.GetStatementCache().Get(connection, m_stream.str());
+        for (const auto& f : m_binders)
+        {
+            f(result);
+        }
+        return result;
+    }
+
     void StatementBuilder::Execute(Connection& connection)
     {
         Prepare(connection).Execute();
@@ -723,6 +795,18 @@ namespace AppInstaller::Repository::SQLite::Builder
         case Op::Escape:
             m_stream << " ESCAPE ?";
             break;
+        case Op::Match:
+            m_stream << " MATCH ?";
+            break;
+        case Op::Glob:
+            m_stream << " GLOB ?";
+            break;
+        case Op::GreaterThanOrEqual:
+            m_stream << " >= ?";
+            break;
+        case Op::LessThan:
+            m_stream << " < ?";
+            break;
         default:
             THROW_HR(E_UNEXPECTED);
         }
@@ -744,6 +828,20 @@ namespace AppInstaller::Repository::SQLite::Builder
         return result;
     }
 
+    int StatementBuilder::AppendInAndBinders(size_t count)
+    {
+        m_stream << " IN (";
+        for (size_t i = 0; i < count; ++i)
+        {
+            m_stream << (i == 0 ? "?" : ", ?");
+        }
+        m_stream << ')';
+
+        int result = m_bindIndex;
+        m_bindIndex += static_cast<int>(count);
+        return result;
+    }
+
     int StatementBuilder::AppendValueAndBinder()
     {
         if (m_needsComma)
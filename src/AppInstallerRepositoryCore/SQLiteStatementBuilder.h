@@ -10,6 +10,7 @@
 #include <optional>
 #include <sstream>
 #include <string_view>
+#include <tuple>
 #include <vector>
 
 namespace AppInstaller::Repository::SQLite::Builder
@@ -202,14 +203,46 @@ namespace AppInstaller::Repository::SQLite::Builder
         StatementBuilder& Equals(details::unbound_t);
         StatementBuilder& Equals(std::nullptr_t);
 
+        // Compares the previous item against the given value, in the collation order of the column.
+        template <typename ValueType>
+        StatementBuilder& GreaterThanOrEqual(const ValueType& value)
+        {
+            AddBindFunctor(AppendOpAndBinder(Op::GreaterThanOrEqual), value);
+            return *this;
+        }
+        template <typename ValueType>
+        StatementBuilder& LessThan(const ValueType& value)
+        {
+            AddBindFunctor(AppendOpAndBinder(Op::LessThan), value);
+            return *this;
+        }
+
         StatementBuilder& LikeWithEscape(std::string_view value);
         StatementBuilder& Like(details::unbound_t);
 
         StatementBuilder& Escape(std::string_view escapeChar);
 
+        // Matches the previous item, a full text table, against the given full text query.
+        StatementBuilder& Match(std::string_view value);
+
+        // Matches the previous item against the given GLOB pattern, which is case sensitive.
+        StatementBuilder& Glob(std::string_view value);
+
         StatementBuilder& Not();
         StatementBuilder& In();
 
+        // Matches the previous item against the set of given values.
+        template <typename ValueType>
+        StatementBuilder& In(const std::vector<ValueType>& values)
+        {
+            int bindIndex = AppendInAndBinders(values.size());
+            for (const auto& value : values)
+            {
+                AddBindFunctor(bindIndex++, value);
+            }
+            return *this;
+        }
+
         StatementBuilder& IsNull();
 
         // Operators for combining filter clauses.
@@ -284,6 +317,10 @@ namespace AppInstaller::Repository::SQLite::Builder
         StatementBuilder& CreateTable(QualifiedTable table);
         StatementBuilder& CreateTable(std::initializer_list<std::string_view> table);
 
+        // Makes the table being created store its rows in the order of its primary key, without a rowid.
+        // Only valid after the columns of a table that has a primary key and whose rowid is not used.
+        StatementBuilder& WithoutRowID();
+
         // Begin an table deletion statement.
         // The initializer_list form enables the table name to be constructed from multiple parts.
         StatementBuilder& DropTable(std::string_view table);
@@ -324,6 +361,15 @@ namespace AppInstaller::Repository::SQLite::Builder
         // Output the set portion of an update statement.
         StatementBuilder& Vacuum();
 
+        // Gathers statistics about tables and indices for use by the query planner.
+        StatementBuilder& Analyze();
+
+        // Begin a common table expression with the given name and columns; its select follows in a parenthetical.
+        StatementBuilder& With(std::string_view table, std::initializer_list<std::string_view> columns);
+
+        // Combines the rows of the previous select with those of the one that follows.
+        StatementBuilder& UnionAll();
+
         // General purpose functions to begin and end a parenthetical expression.
         StatementBuilder& BeginParenthetical();
         StatementBuilder& EndParenthetical();
@@ -335,9 +381,20 @@ namespace AppInstaller::Repository::SQLite::Builder
         // A value of zero indicates that nothing has been bound.
         int GetLastBindIndex() const { return m_bindIndex - 1; }
 
+        // Begins a separate builder for a part of this statement, whose bind indices continue from those of this one.
+        // The part is then either added to the end of this statement with Append, or discarded without changing it.
+        StatementBuilder BeginPart() const;
+
+        // Adds a part that was begun from this statement to its end; nothing else may have been added to this statement since.
+        StatementBuilder& Append(StatementBuilder&& part);
+
         // Prepares and returns the statement, applying any bindings that were requested.
         Statement Prepare(Connection& connection);
 
+        // Gets the statement from the connection's statement cache, preparing it only if it is not already present,
+        // then applies any bindings that were requested.  Use this for statements that are executed repeatedly.
+        CachedStatement PrepareCached(Connection& connection);
+
         // A convenience function that prepares, binds, and then executes a statement that does not return rows.
         void Execute(Connection& connection);
 
@@ -346,7 +403,11 @@ namespace AppInstaller::Repository::SQLite::Builder
         {
             Equals,
             Like,
-            Escape
+            Escape,
+            Match,
+            Glob,
+            GreaterThanOrEqual,
+            LessThan,
         };
 
         // Appends given the operation.
@@ -358,6 +419,9 @@ namespace AppInstaller::Repository::SQLite::Builder
         // Appends a binder for the values clause of an insert.
         int AppendValueAndBinder();
 
+        // Appends a set of binders for an IN clause.
+        int AppendInAndBinders(size_t count);
+
         // Adds a functor to our list that will bind the given value.
         template <typename ValueType>
         void AddBindFunctor(int binderIndex, const ValueType& value)
@@ -398,7 +462,167 @@ namespace AppInstaller::Repository::SQLite::Builder
         std::ostringstream m_stream;
         // Because binding values starts at 1
         int m_bindIndex = 1;
+        // The bind index at which a part begun from another statement started.
+        int m_firstBindIndex = 1;
         std::vector<std::function<void(Statement&)>> m_binders;
         bool m_needsComma = false;
     };
+
+    namespace details
+    {
+        constexpr size_t GetStaticSqlLength(std::initializer_list<std::string_view> parts)
+        {
+            size_t result = 0;
+            for (std::string_view part : parts)
+            {
+                result += part.length();
+            }
+            return result;
+        }
+    }
+
+    // The text of a statement joined from its parts at compile time, for a statement whose shape depends only on
+    // constant values such as the names of a table and its columns; create one with AICLI_SQLITE_STATIC_SQL.
+    // Its text is the same each time, so it is prepared once by the statement cache of the connection.
+    template <size_t Length>
+    struct StaticSql
+    {
+        constexpr StaticSql(std::initializer_list<std::string_view> parts) : m_text{}
+        {
+            size_t position = 0;
+            for (std::string_view part : parts)
+            {
+                for (char c : part)
+                {
+                    m_text[position++] = c;
+                }
+            }
+        }
+
+        constexpr std::string_view View() const { return { m_text, Length }; }
+
+        // Gets a leased statement for the text from the statement cache of the connection.
+        CachedStatement PrepareCached(Connection& connection) const { return connection.GetStatementCache().Get(connection, View()); }
+
+    private:
+        // Null terminated.
+        char m_text[Length + 1];
+    };
+
+    // Inserts rows into a table with statements that each hold the values of many rows, rather than a statement for every row.
+    // The rows are held until there are enough of them to fill a statement; Execute inserts the rest of them.
+    // Rows that have not been inserted when this is destroyed are discarded.
+    template <typename... ValueTypes>
+    struct BulkInsert
+    {
+        static_assert(sizeof...(ValueTypes) > 0, "A row must have at least one value");
+
+        // The most values bound to one statement; the smallest limit on parameters of any SQLite build.
+        static constexpr size_t MaximumValuesPerStatement = 999;
+
+        // The table is given in parts, as with StatementBuilder::InsertInto, and there must be a column for each value of a row.
+        BulkInsert(Connection& connection, std::initializer_list<std::string_view> table, std::initializer_list<std::string_view> columns, size_t rowsPerStatement = 100) :
+            m_connection(connection), m_rowsPerStatement(std::clamp<size_t>(rowsPerStatement, 1, MaximumValuesPerStatement / sizeof...(ValueTypes)))
+        {
+            THROW_HR_IF(E_INVALIDARG, columns.size() != sizeof...(ValueTypes));
+
+            m_prefix = "INSERT INTO [";
+            for (std::string_view part : table)
+            {
+                m_prefix += part;
+            }
+            m_prefix += "] (";
+
+            bool first = true;
+            for (std::string_view column : columns)
+            {
+                m_prefix += (first ? "[" : ", [");
+                m_prefix += column;
+                m_prefix += ']';
+                first = false;
+            }
+            m_prefix += ") VALUES ";
+
+            m_rows.reserve(m_rowsPerStatement);
+        }
+
+        BulkInsert(const BulkInsert&) = delete;
+        BulkInsert& operator=(const BulkInsert&) = delete;
+
+        // Gets the number of rows inserted by each full statement.
+        size_t GetRowsPerStatement() const { return m_rowsPerStatement; }
+
+        // Adds a row, inserting the rows held if the statement is then full.
+        void AddRow(ValueTypes... values)
+        {
+            m_rows.emplace_back(std::move(values)...);
+
+            if (m_rows.size() >= m_rowsPerStatement)
+            {
+                Execute();
+            }
+        }
+
+        // Inserts the rows that are held.
+        void Execute()
+        {
+            if (m_rows.empty())
+            {
+                return;
+            }
+
+            // The text of a full statement is the same every time, so it is only built once
+            if (m_rows.size() == m_rowsPerStatement && m_fullStatement.empty())
+            {
+                m_fullStatement = GetStatementText(m_rowsPerStatement);
+            }
+
+            CachedStatement statement = m_connection.GetStatementCache().Get(m_connection,
+                (m_rows.size() == m_rowsPerStatement ? m_fullStatement : GetStatementText(m_rows.size())));
+
+            int bindIndex = 1;
+            for (const auto& row : m_rows)
+            {
+                // Folding over the comma operator binds the values in the order of the columns.
+                std::apply([&](const auto&... values) { (statement->Bind(bindIndex++, values), ...); }, row);
+            }
+
+            statement->Execute();
+            m_rows.clear();
+        }
+
+    private:
+        std::string GetStatementText(size_t rowCount) const
+        {
+            std::string row = "(?";
+            for (size_t i = 1; i < sizeof...(ValueTypes); ++i)
+            {
+                row += ", ?";
+            }
+            row += ')';
+
+            std::string result = m_prefix;
+            result.reserve(m_prefix.size() + rowCount * (row.size() + 2));
+            for (size_t i = 0; i < rowCount; ++i)
+            {
+                if (i)
+                {
+                    result += ", ";
+                }
+                result += row;
+            }
+
+            return result;
+        }
+
+        Connection& m_connection;
+        size_t m_rowsPerStatement;
+        std::string m_prefix;
+        std::string m_fullStatement;
+        std::vector<std::tuple<ValueTypes...>> m_rows;
+    };
 }
+
+// Creates a StaticSql from the parts, which must all be constant expressions convertible to std::string_view.
+#define AICLI_SQLITE_STATIC_SQL(...) \
+    ::AppInstaller::Repository::SQLite::Builder::StaticSql<::AppInstaller::Repository::SQLite::Builder::details::GetStaticSqlLength({ __VA_ARGS__ })>{ { __VA_ARGS__ } }
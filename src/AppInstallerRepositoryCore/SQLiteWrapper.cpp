@@ -6,23 +6,10 @@
 
 #include <wil/result_macros.h>
 
-using namespace std::string_view_literals;
+#include <mutex>
 
-// TODO: Invoke the wil error handling callback to log the error
-#define THROW_SQLITE(_error_) \
-    do { \
-        int _ts_sqliteReturnValue = _error_; \
-        THROW_EXCEPTION_MSG(SQLiteException(_ts_sqliteReturnValue), sqlite3_errstr(_ts_sqliteReturnValue)); \
-    } while (0,0)
-
-#define THROW_IF_SQLITE_FAILED(_statement_) \
-    do { \
-        int _tisf_sqliteReturnValue = _statement_; \
-        if (_tisf_sqliteReturnValue != SQLITE_OK) \
-        { \
-            THROW_SQLITE(_tisf_sqliteReturnValue); \
-        } \
-    } while (0,0)
+using namespace std::string_literals;
+using namespace std::string_view_literals;
 
 namespace AppInstaller::Repository::SQLite
 {
@@ -35,6 +22,132 @@ namespace AppInstaller::Repository::SQLite
             static std::atomic_size_t statementId(0);
             return ++statementId;
         }
+
+        // Determines whether the statement may call any of the functions that the ICU integrations replace or add.
+        // This only looks for their names, so it can be wrong only by registering them when they are not used.
+        bool UsesICUFunctions(std::string_view sql)
+        {
+            std::string lowered = Utility::ToLower(sql);
+            for (std::string_view name : { "like"sv, "regexp"sv, "lower"sv, "upper"sv, "icu_load_collation"sv })
+            {
+                if (lowered.find(name) != std::string::npos)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        // Determines whether any statement of the connection has been stepped and not yet completed or reset.
+        bool HasRunningStatement(sqlite3* connection)
+        {
+            for (sqlite3_stmt* statement = sqlite3_next_stmt(connection, nullptr); statement; statement = sqlite3_next_stmt(connection, statement))
+            {
+                if (sqlite3_stmt_busy(statement))
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        // The statistics for all statements, keyed by SQL text.
+        struct StatementStatisticsRegistry
+        {
+            std::atomic_bool Enabled{ false };
+            std::mutex Lock;
+            std::unordered_map<std::string, std::shared_ptr<details::StatementStatisticsEntry>> Entries;
+        };
+
+        StatementStatisticsRegistry& GetStatementStatisticsRegistry()
+        {
+            static StatementStatisticsRegistry registry;
+            return registry;
+        }
+
+        uint64_t GetMicrosecondsSince(std::chrono::steady_clock::time_point start)
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        // Gets the query plan for the statement, indenting each step under its parent.
+        // Failure to get the plan is not an error, as it is only diagnostic information.
+        std::string GetQueryPlan(sqlite3* connection, std::string_view sql)
+        {
+            std::string explainSql = "EXPLAIN QUERY PLAN ";
+            explainSql += sql;
+
+            wil::unique_any<sqlite3_stmt*, decltype(sqlite3_finalize), sqlite3_finalize> explain;
+            if (sqlite3_prepare_v2(connection, explainSql.c_str(), static_cast<int>(explainSql.size() + 1), &explain, nullptr) != SQLITE_OK)
+            {
+                return {};
+            }
+
+            // Columns are: id, parent, notused, detail
+            std::unordered_map<int, size_t> depths;
+            std::string result;
+            while (sqlite3_step(explain.get()) == SQLITE_ROW)
+            {
+                int id = sqlite3_column_int(explain.get(), 0);
+                int parent = sqlite3_column_int(explain.get(), 1);
+                const char* detail = reinterpret_cast<const char*>(sqlite3_column_text(explain.get(), 3));
+
+                auto parentItr = depths.find(parent);
+                size_t depth = (parentItr == depths.end() ? 0 : parentItr->second + 1);
+                depths[id] = depth;
+
+                result.append(depth * 2, ' ');
+                result += (detail ? detail : "");
+                result += '\n';
+            }
+
+            return result;
+        }
+
+        size_t GetConnectionCacheMemoryUsed(sqlite3* connection)
+        {
+            int current = 0;
+            int highwater = 0;
+            if (sqlite3_db_status(connection, SQLITE_DBSTATUS_CACHE_USED, &current, &highwater, 0) != SQLITE_OK)
+            {
+                return 0;
+            }
+
+            return static_cast<size_t>(current);
+        }
+    }
+
+    namespace details
+    {
+        struct StatementStatisticsEntry
+        {
+            StatementStatisticsEntry(std::string queryPlan) : QueryPlan(std::move(queryPlan)) {}
+
+            const std::string QueryPlan;
+            std::atomic<uint64_t> PrepareCount{ 0 };
+            std::atomic<uint64_t> StepCount{ 0 };
+            std::atomic<uint64_t> RowCount{ 0 };
+            std::atomic<uint64_t> PrepareMicroseconds{ 0 };
+            std::atomic<uint64_t> StepMicroseconds{ 0 };
+        };
+
+        // Larger than any current index, so that the entire file is mapped; the mapping only covers the actual file size.
+        // A negative cache size is in KiB rather than pages.
+        constexpr std::string_view s_OptimizeForReadPragmas = R"(
+pragma mmap_size = 268435456;
+pragma cache_size = -16384;
+pragma temp_store = MEMORY;
+)"sv;
+
+        // The number of pages that the write-ahead log grows to before a commit checkpoints it; the default is 1000.
+        // A batch of changes that is committed at once is then usually copied into the database once, after it is done.
+        constexpr int s_WriteAheadLogCheckpointPages = 16384;
+
+        // The number of virtual machine instructions between checks for cancellation of a statement.
+        // This is a few milliseconds of work, so that a scan of a large table stops soon after the request.
+        constexpr int s_CancellationCheckInstructions = 10000;
     }
 
     namespace details
@@ -59,6 +172,19 @@ namespace AppInstaller::Repository::SQLite
             THROW_IF_SQLITE_FAILED(sqlite3_bind_text64(stmt, index, v.data(), v.size(), SQLITE_TRANSIENT, SQLITE_UTF8));
         }
 
+        void ParameterSpecificsImpl<std::vector<uint8_t>>::Bind(sqlite3_stmt* stmt, int index, const std::vector<uint8_t>& v)
+        {
+            THROW_IF_SQLITE_FAILED(sqlite3_bind_blob64(stmt, index, v.data(), v.size(), SQLITE_TRANSIENT));
+        }
+
+        std::vector<uint8_t> ParameterSpecificsImpl<std::vector<uint8_t>>::GetColumn(sqlite3_stmt* stmt, int column)
+        {
+            // The pointer must be retrieved before the size, and is null for an empty value.
+            const uint8_t* blob = reinterpret_cast<const uint8_t*>(sqlite3_column_blob(stmt, column));
+            int size = sqlite3_column_bytes(stmt, column);
+            return (blob ? std::vector<uint8_t>(blob, blob + size) : std::vector<uint8_t>{});
+        }
+
         void ParameterSpecificsImpl<int>::Bind(sqlite3_stmt* stmt, int index, int v)
         {
             THROW_IF_SQLITE_FAILED(sqlite3_bind_int(stmt, index, v));
@@ -93,23 +219,103 @@ namespace AppInstaller::Repository::SQLite
     Connection::Connection(const std::string& target, OpenDisposition disposition, OpenFlags flags)
     {
         AICLI_LOG(SQL, Info, << "Opening SQLite connection: '" << target << "' [" << std::hex << static_cast<int>(disposition) << ", " << std::hex << static_cast<int>(flags) << "]");
-        int resultingFlags = static_cast<int>(disposition) | static_cast<int>(flags);
+        int resultingFlags = static_cast<int>(disposition) | static_cast<int>(flags & ~OpenFlags::OptimizeForRead);
         THROW_IF_SQLITE_FAILED(sqlite3_open_v2(target.c_str(), &m_dbconn, resultingFlags, nullptr));
     }
 
+    Connection::Connection(Connection&& other) = default;
+
+    Connection& Connection::operator=(Connection&& other)
+    {
+        // The registration refers to the handle, so the one of this connection is removed before its handle is closed
+        m_memoryRegistration = std::move(other.m_memoryRegistration);
+        m_dbconn = std::move(other.m_dbconn);
+        m_statementCache = std::move(other.m_statementCache);
+        m_rollbackCount = other.m_rollbackCount;
+        m_icuEnabled = other.m_icuEnabled;
+        m_icuRegistered = other.m_icuRegistered;
+        return *this;
+    }
+
+    Connection::~Connection() = default;
+
     Connection Connection::Create(const std::string& target, OpenDisposition disposition, OpenFlags flags)
     {
-        Connection result{ target, disposition, flags };
+        Connection result{ target, disposition, flags & ~OpenFlags::WriteAheadLog };
         
         THROW_IF_SQLITE_FAILED(sqlite3_extended_result_codes(result.m_dbconn.get(), 1));
 
+        if (WI_IsFlagSet(flags, OpenFlags::WriteAheadLog) && disposition != OpenDisposition::ReadOnly && result.SetWriteAheadLog(true))
+        {
+            // The log is synced at checkpoints rather than at each commit, which is as durable as the rollback journal
+            // against a failure of the process, and loses at most the last commits on a failure of the system.
+            THROW_IF_SQLITE_FAILED(sqlite3_exec(result.m_dbconn.get(), "pragma synchronous = NORMAL", nullptr, nullptr, nullptr));
+            THROW_IF_SQLITE_FAILED(sqlite3_wal_autocheckpoint(result.m_dbconn.get(), s_WriteAheadLogCheckpointPages));
+        }
+
+        if (WI_IsFlagSet(flags, OpenFlags::OptimizeForRead))
+        {
+            AICLI_LOG(SQL, Verbose, << "Applying read optimizations to connection");
+            THROW_IF_SQLITE_FAILED(sqlite3_exec(result.m_dbconn.get(), s_OptimizeForReadPragmas.data(), nullptr, nullptr, nullptr));
+        }
+
+        // The connection is serialized, so its memory can be released from the thread that trims while another uses it
+        sqlite3* handle = result.m_dbconn.get();
+        result.m_memoryRegistration = Memory::MemoryBudget::Instance().Register("SQLite connection " + target, Memory::TrimOrder::Early,
+            [handle]() { return GetConnectionCacheMemoryUsed(handle); },
+            [handle](size_t) { sqlite3_db_release_memory(handle); });
+
         return result;
     }
 
+    size_t Connection::GetCacheMemoryUsed() const
+    {
+        return GetConnectionCacheMemoryUsed(m_dbconn.get());
+    }
+
+    void Connection::ReleaseMemory()
+    {
+        THROW_IF_SQLITE_FAILED(sqlite3_db_release_memory(m_dbconn.get()));
+    }
+
     void Connection::EnableICU()
+    {
+        m_icuEnabled = true;
+        RegisterICU();
+    }
+
+    void Connection::EnableICUOnFirstUse()
+    {
+        m_icuEnabled = true;
+    }
+
+    void Connection::RegisterICU()
     {
         AICLI_LOG(SQL, Verbose, << "Enabling ICU");
         THROW_IF_SQLITE_FAILED(sqlite3IcuInit(m_dbconn.get()));
+        m_icuRegistered = true;
+    }
+
+    void Connection::RegisterICUIfUsed(std::string_view sql)
+    {
+        if (!m_icuEnabled || m_icuRegistered || !UsesICUFunctions(sql))
+        {
+            return;
+        }
+
+        // SQLite does not replace a built in function while any statement is running, as that statement may be calling it
+        THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), HasRunningStatement(m_dbconn.get()), "ICU first needed while a statement is running");
+        RegisterICU();
+    }
+
+    StatementCache& Connection::GetStatementCache()
+    {
+        if (!m_statementCache)
+        {
+            m_statementCache = std::make_unique<StatementCache>();
+        }
+
+        return *m_statementCache;
     }
 
     rowid_t Connection::GetLastInsertRowID()
@@ -122,13 +328,81 @@ namespace AppInstaller::Repository::SQLite
         return sqlite3_changes(m_dbconn.get());
     }
 
+    void Connection::SetBusyTimeout(std::chrono::milliseconds timeout)
+    {
+        THROW_IF_SQLITE_FAILED(sqlite3_busy_timeout(m_dbconn.get(), static_cast<int>(timeout.count())));
+    }
+
+    bool Connection::SetWriteAheadLog(bool enabled)
+    {
+        std::string_view mode = (enabled ? "wal"sv : "delete"sv);
+
+        Statement statement = Statement::Create(*this, "pragma journal_mode = "s + std::string{ mode });
+        THROW_HR_IF(E_UNEXPECTED, !statement.Step());
+
+        // The mode that the database is in is returned, which is unchanged if the requested one cannot be used
+        std::string result = statement.GetColumn<std::string>(0);
+        AICLI_LOG(SQL, Verbose, << "Journal mode is " << result);
+        return Utility::CaseInsensitiveEquals(result, mode);
+    }
+
+    void Connection::Checkpoint()
+    {
+        // A database without a write-ahead log has nothing to checkpoint, which is not an error;
+        // nor is another connection checkpointing it at the same time, as that one copies the same changes.
+        int logFrames = 0;
+        int checkpointedFrames = 0;
+        int result = sqlite3_wal_checkpoint_v2(m_dbconn.get(), nullptr, SQLITE_CHECKPOINT_PASSIVE, &logFrames, &checkpointedFrames);
+        if (result == SQLITE_BUSY)
+        {
+            AICLI_LOG(SQL, Verbose, << "Write-ahead log is being checkpointed by another connection");
+            return;
+        }
+
+        THROW_IF_SQLITE_FAILED(result);
+
+        if (logFrames > 0)
+        {
+            AICLI_LOG(SQL, Verbose, << "Checkpointed " << checkpointedFrames << " of " << logFrames << " frames of the write-ahead log");
+        }
+    }
+
     Statement::Statement(Connection& connection, std::string_view sql)
     {
         m_id = GetNextStatementId();
         AICLI_LOG(SQL, Verbose, << "Preparing statement #" << m_id << ": " << sql);
+
+        StatementStatisticsRegistry& statistics = GetStatementStatisticsRegistry();
+        bool collectStatistics = statistics.Enabled;
+        std::chrono::steady_clock::time_point prepareStart;
+        if (collectStatistics)
+        {
+            prepareStart = std::chrono::steady_clock::now();
+        }
+
+        connection.RegisterICUIfUsed(sql);
+
         // SQL string size should include the null terminator (https://www.sqlite.org/c3ref/prepare.html)
         assert(sql.data()[sql.size()] == '\0');
         THROW_IF_SQLITE_FAILED(sqlite3_prepare_v2(connection, sql.data(), static_cast<int>(sql.size() + 1), &m_stmt, nullptr));
+
+        if (collectStatistics)
+        {
+            uint64_t prepareTime = GetMicrosecondsSince(prepareStart);
+
+            {
+                std::lock_guard<std::mutex> lock{ statistics.Lock };
+                auto& entry = statistics.Entries[std::string{ sql }];
+                if (!entry)
+                {
+                    entry = std::make_shared<details::StatementStatisticsEntry>(GetQueryPlan(connection, sql));
+                }
+                m_statistics = entry;
+            }
+
+            ++m_statistics->PrepareCount;
+            m_statistics->PrepareMicroseconds += prepareTime;
+        }
     }
 
     Statement Statement::Create(Connection& connection, const std::string& sql)
@@ -150,23 +424,21 @@ namespace AppInstaller::Repository::SQLite
     bool Statement::Step(bool failFastOnError)
     {
         AICLI_LOG(SQL, Verbose, << "Stepping statement #" << m_id);
-        int result = sqlite3_step(m_stmt.get());
+
+        int result = TryStep();
 
         if (result == SQLITE_ROW)
         {
             AICLI_LOG(SQL, Verbose, << "Statement #" << m_id << " has data");
-            m_state = State::HasRow;
             return true;
         }
         else if (result == SQLITE_DONE)
         {
             AICLI_LOG(SQL, Verbose, << "Statement #" << m_id << " has completed");
-            m_state = State::Completed;
             return false;
         }
         else
         {
-            m_state = State::Error;
             if (failFastOnError)
             {
                 FAIL_FAST_MSG("Critical SQL statement failed");
@@ -183,6 +455,47 @@ namespace AppInstaller::Repository::SQLite
         THROW_HR_IF(E_UNEXPECTED, Step(failFastOnError));
     }
 
+    int Statement::TryStep() noexcept
+    {
+        std::chrono::steady_clock::time_point stepStart;
+        if (m_statistics)
+        {
+            stepStart = std::chrono::steady_clock::now();
+        }
+
+        int result = sqlite3_step(m_stmt.get());
+
+        if (m_statistics)
+        {
+            ++m_statistics->StepCount;
+            m_statistics->StepMicroseconds += GetMicrosecondsSince(stepStart);
+            if (result == SQLITE_ROW)
+            {
+                ++m_statistics->RowCount;
+            }
+        }
+
+        if (result == SQLITE_ROW)
+        {
+            m_state = State::HasRow;
+        }
+        else if (result == SQLITE_DONE)
+        {
+            m_state = State::Completed;
+        }
+        else
+        {
+            m_state = State::Error;
+        }
+
+        return result;
+    }
+
+    int Statement::TryExecute() noexcept
+    {
+        return TryStep();
+    }
+
     bool Statement::GetColumnIsNull(int column)
     {
         int type = sqlite3_column_type(m_stmt.get(), column);
@@ -197,8 +510,82 @@ namespace AppInstaller::Repository::SQLite
         m_state = State::Prepared;
     }
 
+    CachedStatement::CachedStatement(Statement& cached, bool& leased) :
+        m_cached(&cached), m_leased(&leased)
+    {
+        *m_leased = true;
+    }
+
+    CachedStatement::CachedStatement(Statement&& uncached) :
+        m_uncached(std::move(uncached))
+    {
+    }
+
+    CachedStatement::CachedStatement(CachedStatement&& other) noexcept :
+        m_cached(other.m_cached), m_leased(other.m_leased), m_uncached(std::move(other.m_uncached))
+    {
+        other.m_cached = nullptr;
+        other.m_leased = nullptr;
+    }
+
+    CachedStatement::~CachedStatement()
+    {
+        if (m_leased)
+        {
+            // Reset so that the statement does not hold the database busy while it sits in the cache.
+            m_cached->Reset();
+            *m_leased = false;
+        }
+    }
+
+    CachedStatement StatementCache::Get(Connection& connection, std::string_view sql)
+    {
+        m_lookupKey.assign(sql);
+        auto itr = m_statements.find(m_lookupKey);
+
+        if (itr != m_statements.end())
+        {
+            if (itr->second.Leased)
+            {
+                // The same statement is already in use further up the stack; it cannot be shared.
+                ++m_misses;
+                return { Statement::Create(connection, m_lookupKey) };
+            }
+
+            ++m_hits;
+            itr->second.Value.Reset();
+            return { itr->second.Value, itr->second.Leased };
+        }
+
+        ++m_misses;
+
+        if (m_statements.size() >= MaximumSize)
+        {
+            AICLI_LOG(SQL, Verbose, << "Statement cache is full, clearing it");
+            Clear();
+        }
+
+        auto [newItr, inserted] = m_statements.emplace(m_lookupKey, Entry{ Statement::Create(connection, m_lookupKey) });
+        return { newItr->second.Value, newItr->second.Leased };
+    }
+
+    void StatementCache::Clear()
+    {
+        for (auto itr = m_statements.begin(); itr != m_statements.end();)
+        {
+            if (itr->second.Leased)
+            {
+                ++itr;
+            }
+            else
+            {
+                itr = m_statements.erase(itr);
+            }
+        }
+    }
+
     Savepoint::Savepoint(Connection& connection, std::string&& name) :
-        m_name(std::move(name))
+        m_connection(&connection), m_name(std::move(name))
     {
         using namespace std::string_literals;
 
@@ -225,6 +612,7 @@ namespace AppInstaller::Repository::SQLite
         if (m_inProgress)
         {
             AICLI_LOG(SQL, Info, << "Roll back savepoint: " << m_name);
+            ++m_connection->m_rollbackCount;
             m_rollbackTo.Step(true);
             // 'ROLLBACK TO' *DOES NOT* remove the savepoint from the transaction stack.
             // In order to remove it, we must RELEASE. Since we just invoked a ROLLBACK TO
@@ -234,6 +622,28 @@ namespace AppInstaller::Repository::SQLite
         }
     }
 
+    CancellationScope::CancellationScope(Connection& connection, IProgressCallback& progress) :
+        m_connection(connection), m_progress(progress)
+    {
+        // The handler catches a cancellation that happened before the function was set.
+        sqlite3_progress_handler(m_connection, details::s_CancellationCheckInstructions, ProgressHandler, this);
+
+        // sqlite3_interrupt is safe to call from other threads, and stops the statement without waiting for the next check.
+        m_removeCancel = progress.SetCancellationFunction([connection = m_connection]() { sqlite3_interrupt(connection); });
+    }
+
+    CancellationScope::~CancellationScope()
+    {
+        m_removeCancel.reset();
+        sqlite3_progress_handler(m_connection, 0, nullptr, nullptr);
+    }
+
+    int CancellationScope::ProgressHandler(void* context)
+    {
+        // A non-zero return interrupts the statement.
+        return (reinterpret_cast<CancellationScope*>(context)->m_progress.IsCancelled() ? 1 : 0);
+    }
+
     void Savepoint::Commit()
     {
         if (m_inProgress)
@@ -244,6 +654,67 @@ namespace AppInstaller::Repository::SQLite
         }
     }
 
+    void EnableStatementStatistics(bool enabled)
+    {
+        AICLI_LOG(SQL, Info, << (enabled ? "Enabling" : "Disabling") << " statement statistics");
+        GetStatementStatisticsRegistry().Enabled = enabled;
+    }
+
+    std::vector<StatementStatistics> GetStatementStatistics()
+    {
+        StatementStatisticsRegistry& statistics = GetStatementStatisticsRegistry();
+        std::vector<StatementStatistics> result;
+
+        {
+            std::lock_guard<std::mutex> lock{ statistics.Lock };
+            result.reserve(statistics.Entries.size());
+
+            for (const auto& entry : statistics.Entries)
+            {
+                StatementStatistics& current = result.emplace_back();
+                current.SQL = entry.first;
+                current.QueryPlan = entry.second->QueryPlan;
+                current.PrepareCount = static_cast<size_t>(entry.second->PrepareCount.load());
+                current.StepCount = static_cast<size_t>(entry.second->StepCount.load());
+                current.RowCount = static_cast<size_t>(entry.second->RowCount.load());
+                current.PrepareTime = std::chrono::microseconds{ entry.second->PrepareMicroseconds.load() };
+                current.StepTime = std::chrono::microseconds{ entry.second->StepMicroseconds.load() };
+            }
+        }
+
+        std::sort(result.begin(), result.end(), [](const StatementStatistics& a, const StatementStatistics& b)
+            {
+                return (a.PrepareTime + a.StepTime) > (b.PrepareTime + b.StepTime);
+            });
+
+        return result;
+    }
+
+    void LogStatementStatistics()
+    {
+        std::vector<StatementStatistics> statistics = GetStatementStatistics();
+
+        {
+            StatementStatisticsRegistry& registry = GetStatementStatisticsRegistry();
+            std::lock_guard<std::mutex> lock{ registry.Lock };
+            registry.Entries.clear();
+        }
+
+        if (statistics.empty())
+        {
+            return;
+        }
+
+        AICLI_LOG(Repo, Info, << "Statistics for " << statistics.size() << " distinct SQL statements, most expensive first:");
+
+        for (const auto& current : statistics)
+        {
+            AICLI_LOG(Repo, Info, << "Total " << (current.PrepareTime + current.StepTime).count() << "us; prepared " << current.PrepareCount <<
+                " times in " << current.PrepareTime.count() << "us; stepped " << current.StepCount << " times in " << current.StepTime.count() <<
+                "us; returned " << current.RowCount << " rows\n" << current.SQL << "\nQuery plan:\n" << current.QueryPlan);
+        }
+    }
+
     std::string_view EscapeCharForLike = "'"sv;
 
     std::string EscapeStringForLike(std::string_view value)
@@ -266,4 +737,10 @@ namespace AppInstaller::Repository::SQLite
 
         return result;
     }
+
+    bool IsReturningSupported()
+    {
+        static const bool s_supported = (sqlite3_libversion_number() >= 3035000);
+        return s_supported;
+    }
 }
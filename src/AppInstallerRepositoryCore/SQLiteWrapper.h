@@ -7,12 +7,34 @@
 
 #include <AppInstallerLogging.h>
 #include <AppInstallerLanguageUtilities.h>
+#include <AppInstallerProgress.h>
+#include <winget/MemoryBudget.h>
 
+#include <chrono>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
+
+// TODO: Invoke the wil error handling callback to log the error
+#define THROW_SQLITE(_error_) \
+    do { \
+        int _ts_sqliteReturnValue = _error_; \
+        THROW_EXCEPTION_MSG(::AppInstaller::Repository::SQLite::SQLiteException(_ts_sqliteReturnValue), sqlite3_errstr(_ts_sqliteReturnValue)); \
+    } while (0,0)
+
+#define THROW_IF_SQLITE_FAILED(_statement_) \
+    do { \
+        int _tisf_sqliteReturnValue = _statement_; \
+        if (_tisf_sqliteReturnValue != SQLITE_OK) \
+        { \
+            THROW_SQLITE(_tisf_sqliteReturnValue); \
+        } \
+    } while (0,0)
 
 namespace AppInstaller::Repository::SQLite
 {
@@ -24,6 +46,9 @@ namespace AppInstaller::Repository::SQLite
 
     namespace details
     {
+        // The shared statistics for all statements with the same SQL text.
+        struct StatementStatisticsEntry;
+
         template <typename T, typename = void>
         struct ParameterSpecificsImpl
         {
@@ -56,6 +81,14 @@ namespace AppInstaller::Repository::SQLite
             static void Bind(sqlite3_stmt* stmt, int index, std::string_view v);
         };
 
+        // Binds and reads a BLOB column.
+        template <>
+        struct ParameterSpecificsImpl<std::vector<uint8_t>>
+        {
+            static void Bind(sqlite3_stmt* stmt, int index, const std::vector<uint8_t>& v);
+            static std::vector<uint8_t> GetColumn(sqlite3_stmt* stmt, int column);
+        };
+
         template <>
         struct ParameterSpecificsImpl<int>
         {
@@ -100,6 +133,10 @@ namespace AppInstaller::Repository::SQLite
         SQLiteException(int error) : wil::ResultException(MAKE_HRESULT(SEVERITY_ERROR, FACILITY_SQLITE, error)) {}
     };
 
+    // Forward declarations
+    struct StatementCache;
+    struct CachedStatement;
+
     // The connection to a database.
     struct Connection
     {
@@ -121,6 +158,15 @@ namespace AppInstaller::Repository::SQLite
             None = 0,
             // Indicate that the target can be a URI.
             Uri = SQLITE_OPEN_URI,
+            // Tune the connection for many reads from a database that is not written to, by memory mapping
+            // the file, using a larger page cache, and keeping temporary tables in memory.
+            // This flag is handled by Create and not passed to SQLite.
+            OptimizeForRead = 0x40000000,
+            // Use a write-ahead log, so that other connections keep reading a consistent snapshot of the database while
+            // it is written rather than waiting for each write to commit. The log is checkpointed less often than by default,
+            // as the database is expected to be written in large batches. Ignored for a read only connection, which uses
+            // the log of the database if it has one. This flag is handled by Create and not passed to SQLite.
+            WriteAheadLog = 0x20000000,
         };
 
         static Connection Create(const std::string& target, OpenDisposition disposition, OpenFlags flags = OpenFlags::None);
@@ -130,28 +176,80 @@ namespace AppInstaller::Repository::SQLite
         Connection(const Connection&) = delete;
         Connection& operator=(const Connection&) = delete;
 
-        Connection(Connection&& other) = default;
-        Connection& operator=(Connection&& other) = default;
+        Connection(Connection&& other);
+        Connection& operator=(Connection&& other);
 
-        ~Connection() = default;
+        ~Connection();
 
         // Enables the ICU integrations on this connection.
         void EnableICU();
 
+        // Enables the ICU integrations on this connection, registering them only when the first statement that uses them
+        // is prepared. That must not be while another statement of the connection is running, so this is meant for
+        // connections that only read, where most statements look up values exactly and never use them.
+        void EnableICUOnFirstUse();
+
+        // Determines whether the ICU integrations have been registered on this connection.
+        bool IsICURegistered() const { return m_icuRegistered; }
+
+        // Gets the cache of prepared statements for this connection.
+        StatementCache& GetStatementCache();
+
         // Gets the last inserted rowid to the database.
         rowid_t GetLastInsertRowID();
 
         // Gets the count of changed rows for the last executed statement.
         int GetChanges();
 
+        // Sets the time to wait for a lock held by another connection before failing with SQLITE_BUSY.
+        void SetBusyTimeout(std::chrono::milliseconds timeout);
+
+        // Sets whether the database uses a write-ahead log or a rollback journal. The mode is kept by the database file,
+        // so later connections use it as well. Leaving write-ahead logging copies the log into the database, which requires
+        // that no other connection has it open. Returns false if the mode cannot be used, as for a database in memory.
+        bool SetWriteAheadLog(bool enabled);
+
+        // Copies the changes committed to the write-ahead log into the database, as far as it can without waiting for readers,
+        // so that the log does not keep growing while they read. Does nothing if the database does not use a write-ahead log.
+        void Checkpoint();
+
+        // Gets the number of savepoints that have been rolled back on this connection.
+        // Caches of values read from the database can use this to detect that they may no longer be valid.
+        uint64_t GetRollbackCount() const { return m_rollbackCount; }
+
+        // Gets the bytes held by the page cache of this connection.
+        size_t GetCacheMemoryUsed() const;
+
+        // Frees as much of the memory of this connection as it can, such as the pages of its cache that are not in use.
+        // The connection is registered with the memory budget of the process, which calls this when it trims its caches.
+        void ReleaseMemory();
+
         operator sqlite3* () const { return m_dbconn.get(); }
 
     private:
+        friend struct Savepoint;
+        friend struct Statement;
+
         Connection(const std::string& target, OpenDisposition disposition, OpenFlags flags);
 
+        // Registers the ICU integrations.
+        void RegisterICU();
+
+        // Registers the ICU integrations if they are enabled but not yet registered, and the statement uses them.
+        void RegisterICUIfUsed(std::string_view sql);
+
         wil::unique_any<sqlite3*, decltype(sqlite3_close_v2), sqlite3_close_v2> m_dbconn;
+        // Declared after the connection so that the cached statements are finalized first.
+        std::unique_ptr<StatementCache> m_statementCache;
+        uint64_t m_rollbackCount = 0;
+        bool m_icuEnabled = false;
+        bool m_icuRegistered = false;
+        // Declared last so that it is removed before the connection is closed.
+        Memory::MemoryBudget::Registration m_memoryRegistration;
     };
 
+    DEFINE_ENUM_FLAG_OPERATORS(Connection::OpenFlags);
+
     // A SQL statement.
     struct Statement
     {
@@ -202,6 +300,14 @@ namespace AppInstaller::Repository::SQLite
         // Equivalent to Step, but does not ever expect a result, throwing if one is retrieved.
         void Execute(bool failFastOnError = false);
 
+        // Equivalent to Step, but returns the SQLite result rather than throwing for an error: SQLITE_ROW if there is a row
+        // of data, SQLITE_DONE if there is none, and the error otherwise. For statements where a failure, such as a constraint
+        // conflict, is expected and handled by the caller, so that it does not pay for an exception.
+        int TryStep() noexcept;
+
+        // Equivalent to TryStep, for a statement that does not ever expect a result; returns SQLITE_DONE when it succeeds.
+        int TryExecute() noexcept;
+
         // Gets a boolean value that indicates whether the specified column value is null in the current row.
         // The index is 0 based.
         bool GetColumnIsNull(int column);
@@ -248,6 +354,108 @@ namespace AppInstaller::Repository::SQLite
         size_t m_id = 0;
         wil::unique_any<sqlite3_stmt*, decltype(sqlite3_finalize), sqlite3_finalize> m_stmt;
         State m_state = State::Prepared;
+        // Only set when statement statistics were enabled as the statement was prepared.
+        std::shared_ptr<details::StatementStatisticsEntry> m_statistics;
+    };
+
+    // The statistics collected for all statements with the same SQL text.
+    struct StatementStatistics
+    {
+        std::string SQL;
+
+        // The output of EXPLAIN QUERY PLAN for the statement, one step per line.
+        std::string QueryPlan;
+
+        size_t PrepareCount = 0;
+        size_t StepCount = 0;
+        size_t RowCount = 0;
+        std::chrono::microseconds PrepareTime{};
+        std::chrono::microseconds StepTime{};
+    };
+
+    // Enables or disables the collection of statistics for statements prepared from now on, aggregated by SQL text.
+    // Collection is off by default, as it adds timing and a query plan lookup to statements.
+    void EnableStatementStatistics(bool enabled);
+
+    // Gets the statistics collected so far, in descending order of total time.
+    std::vector<StatementStatistics> GetStatementStatistics();
+
+    // Writes the statistics collected so far to the log, then discards them.
+    void LogStatementStatistics();
+
+    // A statement leased from a StatementCache.
+    // The statement is reset when the lease ends, so that it does not keep the database busy.
+    struct CachedStatement
+    {
+        CachedStatement(const CachedStatement&) = delete;
+        CachedStatement& operator=(const CachedStatement&) = delete;
+
+        CachedStatement(CachedStatement&& other) noexcept;
+        CachedStatement& operator=(CachedStatement&&) = delete;
+
+        ~CachedStatement();
+
+        // Gets the underlying statement.
+        Statement& Get() { return (m_leased ? *m_cached : m_uncached); }
+
+        Statement* operator->() { return &Get(); }
+        operator Statement& () { return Get(); }
+
+    private:
+        friend StatementCache;
+
+        CachedStatement(Statement& cached, bool& leased);
+        CachedStatement(Statement&& uncached);
+
+        Statement* m_cached = nullptr;
+        bool* m_leased = nullptr;
+        Statement m_uncached;
+    };
+
+    // A cache of prepared statements for a single connection, keyed by the SQL text of the statement.
+    // A cached statement is only leased to one caller at a time; requesting a statement that is
+    // currently leased results in a new, uncached statement.
+    struct StatementCache
+    {
+        // The maximum number of statements that will be held by the cache.
+        static constexpr size_t MaximumSize = 64;
+
+        StatementCache() = default;
+
+        StatementCache(const StatementCache&) = delete;
+        StatementCache& operator=(const StatementCache&) = delete;
+
+        StatementCache(StatementCache&&) = delete;
+        StatementCache& operator=(StatementCache&&) = delete;
+
+        // Gets a prepared statement for the given SQL, preparing it only if not already cached.
+        // The statement is in the Prepared state, but may still hold bindings from a previous lease.
+        CachedStatement Get(Connection& connection, std::string_view sql);
+
+        // Gets the number of requests that were satisfied from the cache.
+        size_t GetHitCount() const { return m_hits; }
+
+        // Gets the number of requests that required a statement to be prepared.
+        size_t GetMissCount() const { return m_misses; }
+
+        // Gets the number of statements currently held by the cache.
+        size_t GetSize() const { return m_statements.size(); }
+
+        // Removes all statements that are not currently leased.
+        void Clear();
+
+    private:
+        struct Entry
+        {
+            Statement Value;
+            bool Leased = false;
+        };
+
+        std::unordered_map<std::string, Entry> m_statements;
+        // Holds the text of the statement while it is looked up, so that a lookup does not allocate once it has grown.
+        std::string m_lookupKey;
+        size_t m_hits = 0;
+        size_t m_misses = 0;
     };
 
     // A SQLite savepoint.
@@ -273,15 +481,41 @@ namespace AppInstaller::Repository::SQLite
     private:
         Savepoint(Connection& connection, std::string&& name);
 
+        Connection* m_connection;
         std::string m_name;
         DestructionToken m_inProgress = true;
         Statement m_rollbackTo;
         Statement m_release;
     };
 
+    // Interrupts the statements executing on the connection when the progress is cancelled, for the lifetime of the object.
+    // An interrupted statement fails with SQLITE_INTERRUPT. Only one may exist for a connection at a time.
+    struct CancellationScope
+    {
+        CancellationScope(Connection& connection, IProgressCallback& progress);
+
+        CancellationScope(const CancellationScope&) = delete;
+        CancellationScope& operator=(const CancellationScope&) = delete;
+
+        CancellationScope(CancellationScope&&) = delete;
+        CancellationScope& operator=(CancellationScope&&) = delete;
+
+        ~CancellationScope();
+
+    private:
+        static int ProgressHandler(void* context);
+
+        sqlite3* m_connection;
+        IProgressCallback& m_progress;
+        IProgressCallback::CancelFunctionRemoval m_removeCancel;
+    };
+
     // The escape character used in the EscapeStringForLike function.
     extern std::string_view EscapeCharForLike;
 
     // Escapes the given input string for passing to a like operation.
     std::string EscapeStringForLike(std::string_view value);
+
+    // Determines whether the SQLite in use supports the RETURNING clause, which was added in 3.35.
+    bool IsReturningSupported();
 }
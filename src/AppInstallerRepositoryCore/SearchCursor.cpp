@@ -0,0 +1,161 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "SearchCursor.h"
+
+namespace AppInstaller::Repository
+{
+    namespace
+    {
+        // The number of bits of each part of a score, from the least significant; better parts have higher values.
+        constexpr MatchScore s_MatchScore_DistanceBits = 16;
+        constexpr MatchScore s_MatchScore_PositionBits = 10;
+        constexpr MatchScore s_MatchScore_FieldBits = 3;
+
+        constexpr MatchScore s_MatchScore_PositionShift = s_MatchScore_DistanceBits;
+        constexpr MatchScore s_MatchScore_FieldShift = s_MatchScore_PositionShift + s_MatchScore_PositionBits;
+        constexpr MatchScore s_MatchScore_TypeShift = s_MatchScore_FieldShift + s_MatchScore_FieldBits;
+
+        // Gets the part of a score for a value where lower is better, so that large values all score the same lowest part.
+        MatchScore GetInvertedScorePart(size_t value, MatchScore bits)
+        {
+            MatchScore maximum = (1u << bits) - 1;
+            return maximum - static_cast<MatchScore>(std::min<size_t>(value, maximum));
+        }
+    }
+
+    MatchScore GetMatchScore(const ApplicationMatchFilter& match, std::string_view requestValue)
+    {
+        size_t position = 0;
+        size_t distance = 0;
+
+        if (!requestValue.empty())
+        {
+            std::wstring matched = Utility::ConvertToUTF16(Utility::FoldCase(match.Value));
+            std::wstring request = Utility::ConvertToUTF16(Utility::FoldCase(requestValue));
+
+            size_t found = matched.find(request);
+            if (found != std::wstring::npos)
+            {
+                // The edit distance to a value that contains the request value is the characters around it
+                position = found;
+                distance = matched.length() - request.length();
+            }
+            else
+            {
+                // Fuzzy and wildcard matches need not contain the request value; they are placed after those that do
+                position = std::numeric_limits<size_t>::max();
+                distance = Utility::GetEditDistance(matched, request);
+            }
+        }
+
+        MatchScore type = static_cast<MatchScore>(MatchType::Wildcard) - static_cast<MatchScore>(match.Type);
+        MatchScore field = static_cast<MatchScore>(ApplicationMatchField::Tag) - static_cast<MatchScore>(match.Field);
+
+        return (type << s_MatchScore_TypeShift) |
+            (field << s_MatchScore_FieldShift) |
+            (GetInvertedScorePart(position, s_MatchScore_PositionBits) << s_MatchScore_PositionShift) |
+            GetInvertedScorePart(distance, s_MatchScore_DistanceBits);
+    }
+
+    MatchScore GetMatchScore(const ApplicationMatchFilter& match, const SearchRequest& request)
+    {
+        std::optional<MatchScore> result;
+
+        auto scoreRequestValue = [&](std::string_view value)
+        {
+            MatchScore score = GetMatchScore(match, value);
+            if (!result || score > result.value())
+            {
+                result = score;
+            }
+        };
+
+        // The query searches on all of the fields
+        if (request.Query)
+        {
+            scoreRequestValue(request.Query->Value);
+        }
+
+        for (const auto& include : request.Inclusions)
+        {
+            if (include.Field == match.Field)
+            {
+                scoreRequestValue(include.Value);
+            }
+        }
+
+        // Without a query or inclusions, the first filter is the search
+        if (!request.Query && request.Inclusions.empty() && !request.Filters.empty() && request.Filters[0].Field == match.Field)
+        {
+            scoreRequestValue(request.Filters[0].Value);
+        }
+
+        return result ? result.value() : GetMatchScore(match);
+    }
+
+    void SortResultMatches(std::vector<ResultMatch>& matches)
+    {
+        auto comparator = [](const ResultMatch& first, const ResultMatch& second) { return IsBetterMatch(first, second); };
+
+        if (!std::is_sorted(matches.begin(), matches.end(), comparator))
+        {
+            std::stable_sort(matches.begin(), matches.end(), comparator);
+        }
+    }
+
+    SearchResultCursor::SearchResultCursor(SearchResult&& result) : m_result(std::move(result))
+    {
+        SortResultMatches(m_result.Matches);
+    }
+
+    std::vector<ResultMatch> SearchResultCursor::Next(size_t count)
+    {
+        size_t end = m_position + std::min(count, m_result.Matches.size() - m_position);
+
+        std::vector<ResultMatch> result;
+        result.reserve(end - m_position);
+        for (; m_position < end; ++m_position)
+        {
+            result.emplace_back(std::move(m_result.Matches[m_position]));
+        }
+
+        return result;
+    }
+
+    std::unique_ptr<ISearchCursor> ISource::OpenSearchCursor(const SearchRequest& request)
+    {
+        return std::make_unique<SearchResultCursor>(Search(request));
+    }
+
+    SearchResult ISource::SearchForIds(const std::vector<std::string>& ids)
+    {
+        SearchResult result;
+
+        for (const std::string& id : ids)
+        {
+            SearchRequest request;
+            request.Filters.emplace_back(ApplicationMatchField::Id, MatchType::Exact, id);
+
+            SearchResult idResult = Search(request);
+            std::move(idResult.Matches.begin(), idResult.Matches.end(), std::back_inserter(result.Matches));
+        }
+
+        return result;
+    }
+
+    bool ISource::MayContainId(std::string_view) const
+    {
+        return true;
+    }
+
+    bool ISource::TryGetInstaller(const std::vector<uint8_t>&, const std::filesystem::path&) const
+    {
+        return false;
+    }
+
+    bool ISource::SupportsConcurrentSearches() const
+    {
+        return false;
+    }
+}
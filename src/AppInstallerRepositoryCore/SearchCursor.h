@@ -0,0 +1,26 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Public/AppInstallerRepositorySource.h"
+
+#include <vector>
+
+namespace AppInstaller::Repository
+{
+    // Sorts the results from a single source best match first by their scores; these are usually already in order.
+    void SortResultMatches(std::vector<ResultMatch>& matches);
+
+    // A cursor over results that were all created by the search.
+    struct SearchResultCursor : public ISearchCursor
+    {
+        SearchResultCursor(SearchResult&& result);
+
+        std::vector<ResultMatch> Next(size_t count) override;
+
+        bool IsTruncated() const override { return m_result.Truncated; }
+
+    private:
+        SearchResult m_result;
+        size_t m_position = 0;
+    };
+}
@@ -20,8 +20,8 @@ namespace AppInstaller::Repository
         // Adds the source from the given details, writing back to the details any changes.
         virtual void Add(SourceDetails& details, IProgressCallback& progress) = 0;
 
-        // Updates the source from the given details (may not change the details).
-        virtual void Update(const SourceDetails& details, IProgressCallback& progress) = 0;
+        // Updates the source from the given details, writing back to the details any changes to its metadata.
+        virtual void Update(SourceDetails& details, IProgressCallback& progress) = 0;
 
         // Removes the source from the given details.
         virtual void Remove(const SourceDetails& details, IProgressCallback& progress) = 0;
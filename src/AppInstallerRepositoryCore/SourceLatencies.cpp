@@ -0,0 +1,150 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "SourceLatencies.h"
+
+#include <cmath>
+
+namespace AppInstaller::Repository
+{
+    namespace
+    {
+        using namespace std::string_view_literals;
+
+        constexpr std::string_view s_SourceLatencies_FileName = "SourceLatencies.yaml"sv;
+        constexpr std::string_view s_SourceLatencies_Sources = "Sources"sv;
+        constexpr std::string_view s_SourceLatencies_Name = "Name"sv;
+        constexpr std::string_view s_SourceLatencies_Milliseconds = "Milliseconds"sv;
+        constexpr std::string_view s_SourceLatencies_LastRecorded = "LastRecorded"sv;
+
+        // The number of searches kept for each source; the oldest is removed to make room for another.
+        constexpr size_t s_SourceLatencies_MaximumSamples = 20;
+
+        // A percentile of fewer searches than this says little about the source, so none is given.
+        constexpr size_t s_SourceLatencies_MinimumSamples = 5;
+
+        // The number of sources kept; the one recorded least recently is removed to make room for another.
+        constexpr size_t s_SourceLatencies_MaximumSources = 64;
+    }
+
+    SourceLatencies::SourceLatencies(std::filesystem::path path) : m_path(std::move(path))
+    {
+        Load();
+    }
+
+    SourceLatencies& SourceLatencies::Instance()
+    {
+        static SourceLatencies s_instance{ Runtime::GetPathTo(Runtime::PathName::LocalState) / s_SourceLatencies_FileName };
+        return s_instance;
+    }
+
+    std::optional<std::chrono::milliseconds> SourceLatencies::GetPercentile(std::string_view source, double fraction) const
+    {
+        std::vector<int64_t> samples;
+        {
+            std::lock_guard<std::mutex> lock{ m_lock };
+            auto itr = m_sources.find(std::string{ source });
+            if (itr == m_sources.end())
+            {
+                return {};
+            }
+
+            samples = itr->second.Milliseconds;
+        }
+
+        if (samples.size() < s_SourceLatencies_MinimumSamples)
+        {
+            return {};
+        }
+
+        // The nearest rank, so that the result is always one of the latencies seen
+        std::sort(samples.begin(), samples.end());
+        size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(samples.size())));
+        return std::chrono::milliseconds{ samples[std::clamp<size_t>(rank, 1, samples.size()) - 1] };
+    }
+
+    void SourceLatencies::Record(std::string_view source, std::chrono::milliseconds latency)
+    {
+        std::lock_guard<std::mutex> lock{ m_lock };
+
+        Latencies& latencies = m_sources[std::string{ source }];
+        latencies.Milliseconds.emplace_back(latency.count());
+        if (latencies.Milliseconds.size() > s_SourceLatencies_MaximumSamples)
+        {
+            latencies.Milliseconds.erase(latencies.Milliseconds.begin());
+        }
+        latencies.LastRecorded = Utility::GetCurrentUnixEpoch();
+
+        while (m_sources.size() > s_SourceLatencies_MaximumSources)
+        {
+            auto oldest = std::min_element(m_sources.begin(), m_sources.end(), [](const auto& a, const auto& b)
+                {
+                    return a.second.LastRecorded < b.second.LastRecorded;
+                });
+            m_sources.erase(oldest);
+        }
+
+        // The latencies only decide when a search is duplicated, so failing to keep them does not fail the search
+        try
+        {
+            Save();
+        }
+        CATCH_LOG();
+    }
+
+    void SourceLatencies::Load()
+    {
+        if (!std::filesystem::exists(m_path))
+        {
+            return;
+        }
+
+        try
+        {
+            YAML::Node document = YAML::Load(m_path);
+
+            for (const auto& entry : document[s_SourceLatencies_Sources].Sequence())
+            {
+                Latencies& latencies = m_sources[entry[s_SourceLatencies_Name].as<std::string>()];
+                for (const auto& sample : entry[s_SourceLatencies_Milliseconds].Sequence())
+                {
+                    latencies.Milliseconds.emplace_back(sample.as<int64_t>());
+                }
+                latencies.LastRecorded = entry[s_SourceLatencies_LastRecorded].as<int64_t>();
+            }
+        }
+        catch (...)
+        {
+            AICLI_LOG(Repo, Info, << "Source latencies could not be read, they will be ignored: " << m_path);
+            m_sources.clear();
+        }
+    }
+
+    void SourceLatencies::Save() const
+    {
+        YAML::Emitter out;
+        out << YAML::BeginMap;
+        out << YAML::Key << s_SourceLatencies_Sources;
+        out << YAML::BeginSeq;
+        for (const auto& source : m_sources)
+        {
+            out << YAML::BeginMap;
+            out << YAML::Key << s_SourceLatencies_Name << YAML::Value << source.first;
+            out << YAML::Key << s_SourceLatencies_Milliseconds;
+            out << YAML::BeginSeq;
+            for (int64_t sample : source.second.Milliseconds)
+            {
+                out << sample;
+            }
+            out << YAML::EndSeq;
+            out << YAML::Key << s_SourceLatencies_LastRecorded << YAML::Value << source.second.LastRecorded;
+            out << YAML::EndMap;
+        }
+        out << YAML::EndSeq;
+        out << YAML::EndMap;
+
+        std::filesystem::create_directories(m_path.parent_path());
+        std::ofstream stream(m_path, std::ofstream::binary | std::ofstream::trunc);
+        stream << out.str();
+    }
+}
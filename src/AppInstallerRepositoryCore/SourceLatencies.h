@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AppInstaller::Repository
+{
+    // The time that recent searches of each source took, kept between runs so that a search of a source that is slower
+    // than usual can be recognized, and a duplicate of it sent, without waiting for the first search of the run.
+    // Only the latest searches of the sources searched most recently are kept, so that the file does not grow without bound.
+    struct SourceLatencies
+    {
+        // The latencies are read from, and written to, the given file.
+        SourceLatencies(std::filesystem::path path);
+
+        // Gets the latencies of the process, which are kept in the local state.
+        static SourceLatencies& Instance();
+
+        // Gets the latency that the given fraction of the recent searches of the source completed within.
+        // Returns an empty value if the source has not been searched often enough for it to mean anything.
+        std::optional<std::chrono::milliseconds> GetPercentile(std::string_view source, double fraction) const;
+
+        // Records a search of the source, and saves the latencies.
+        void Record(std::string_view source, std::chrono::milliseconds latency);
+
+    private:
+        struct Latencies
+        {
+            // The oldest search is first.
+            std::vector<int64_t> Milliseconds;
+            int64_t LastRecorded = 0;
+        };
+
+        void Load();
+        void Save() const;
+
+        std::filesystem::path m_path;
+        mutable std::mutex m_lock;
+        std::map<std::string, Latencies> m_sources;
+    };
+}
@@ -0,0 +1,512 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#include "pch.h"
+#include "WorkloadTrace.h"
+
+#include <AppInstallerLanguageUtilities.h>
+#include <json.h>
+
+#include <atomic>
+#include <map>
+
+
+namespace AppInstaller::Repository::Workload
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        constexpr std::string_view s_TraceFileName = "WorkloadTrace.jsonl";
+
+        // The trace that this process appends to, if recording is enabled.
+        struct TraceFile
+        {
+            std::mutex Lock;
+            wil::unique_hfile File;
+            std::atomic<bool> Enabled = false;
+        };
+
+        TraceFile& GetTraceFile()
+        {
+            static TraceFile s_traceFile;
+            return s_traceFile;
+        }
+
+        // The commands of the process are numbered from one; zero is no command.
+        std::atomic<uint64_t> s_lastCommand = 0;
+        thread_local uint64_t s_currentCommand = 0;
+
+        std::chrono::microseconds ToMicroseconds(Clock::duration duration)
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(duration);
+        }
+
+        Json::Value::Int64 ToJson(std::chrono::microseconds value)
+        {
+            return static_cast<Json::Value::Int64>(value.count());
+        }
+
+        Json::Value CreateRecord(std::string_view type, uint64_t command)
+        {
+            Json::Value record{ Json::objectValue };
+            record["Type"] = std::string{ type };
+            record["Process"] = static_cast<Json::UInt>(GetCurrentProcessId());
+            record["Command"] = static_cast<Json::UInt64>(command);
+            return record;
+        }
+
+        // Appends the record to the trace as a single line, in a single write, so that the lines of
+        // the processes appending to the trace at once are not interleaved.
+        void WriteRecord(const Json::Value& record)
+        {
+            Json::StreamWriterBuilder builder;
+            builder["indentation"] = "";
+            std::string line = Json::writeString(builder, record);
+            line += '\n';
+
+            TraceFile& traceFile = GetTraceFile();
+            std::lock_guard<std::mutex> lock{ traceFile.Lock };
+            if (!traceFile.File)
+            {
+                return;
+            }
+
+            DWORD written = 0;
+            if (!WriteFile(traceFile.File.get(), line.data(), static_cast<DWORD>(line.size()), &written, nullptr))
+            {
+                // Recording must never fail the command, so the trace is given up on instead
+                AICLI_LOG(Repo, Warning, << "Failed writing the workload trace, so recording is stopped: " << GetLastError());
+                traceFile.File.reset();
+                traceFile.Enabled = false;
+            }
+        }
+
+        Json::Value ToJson(const RequestMatch& match)
+        {
+            Json::Value result{ Json::objectValue };
+            result["Type"] = std::string{ MatchTypeToString(match.Type) };
+            result["Value"] = match.Value;
+            return result;
+        }
+
+        Json::Value ToJson(const std::vector<ApplicationMatchFilter>& filters)
+        {
+            Json::Value result{ Json::arrayValue };
+            for (const auto& filter : filters)
+            {
+                Json::Value filterValue = ToJson(static_cast<const RequestMatch&>(filter));
+                filterValue["Field"] = std::string{ ApplicationMatchFieldToString(filter.Field) };
+                result.append(std::move(filterValue));
+            }
+            return result;
+        }
+
+        Json::Value ToJson(const SearchRequest& request)
+        {
+            Json::Value result{ Json::objectValue };
+            if (request.Query)
+            {
+                result["Query"] = ToJson(request.Query.value());
+            }
+            result["Inclusions"] = ToJson(request.Inclusions);
+            result["Filters"] = ToJson(request.Filters);
+            result["MaximumResults"] = static_cast<Json::UInt64>(request.MaximumResults);
+            return result;
+        }
+
+        std::vector<std::string> ReadStrings(const Json::Value& value)
+        {
+            std::vector<std::string> result;
+            if (value.isArray())
+            {
+                for (const auto& item : value)
+                {
+                    result.emplace_back(item.asString());
+                }
+            }
+            return result;
+        }
+
+        // The names are read back by comparing them with the name of each value, so that they only need to be written in one place.
+        MatchType ReadMatchType(const Json::Value& value)
+        {
+            std::string name = value.asString();
+            for (auto type = ToIntegral(MatchType::Exact); type <= ToIntegral(MatchType::Wildcard); ++type)
+            {
+                if (MatchTypeToString(static_cast<MatchType>(type)) == name)
+                {
+                    return static_cast<MatchType>(type);
+                }
+            }
+
+            THROW_HR_MSG(E_INVALIDARG, "Unknown match type in workload trace: %hs", name.c_str());
+        }
+
+        ApplicationMatchField ReadMatchField(const Json::Value& value)
+        {
+            std::string name = value.asString();
+            for (auto field = ToIntegral(ApplicationMatchField::Id); field <= ToIntegral(ApplicationMatchField::Tag); ++field)
+            {
+                if (ApplicationMatchFieldToString(static_cast<ApplicationMatchField>(field)) == name)
+                {
+                    return static_cast<ApplicationMatchField>(field);
+                }
+            }
+
+            THROW_HR_MSG(E_INVALIDARG, "Unknown match field in workload trace: %hs", name.c_str());
+        }
+
+        std::vector<ApplicationMatchFilter> ReadFilters(const Json::Value& value)
+        {
+            std::vector<ApplicationMatchFilter> result;
+            if (value.isArray())
+            {
+                for (const auto& item : value)
+                {
+                    result.emplace_back(ReadMatchField(item["Field"]), ReadMatchType(item["Type"]), item["Value"].asString());
+                }
+            }
+            return result;
+        }
+
+        SearchRequest ReadRequest(const Json::Value& value)
+        {
+            SearchRequest result;
+            if (value.isMember("Query"))
+            {
+                const Json::Value& query = value["Query"];
+                result.Query = RequestMatch{ ReadMatchType(query["Type"]), query["Value"].asString() };
+            }
+            result.Inclusions = ReadFilters(value["Inclusions"]);
+            result.Filters = ReadFilters(value["Filters"]);
+            result.MaximumResults = static_cast<size_t>(value["MaximumResults"].asUInt64());
+            return result;
+        }
+
+        void ReadRecord(const Json::Value& record, RecordedCommand& command)
+        {
+            std::string type = record["Type"].asString();
+
+            if (type == "Source")
+            {
+                SourceDetails details;
+                details.Name = record["Name"].asString();
+                details.Type = record["SourceType"].asString();
+                details.Arg = record["Arg"].asString();
+                details.LastUpdateTime = Utility::ConvertUnixEpochToSystemClock(record["LastUpdateTime"].asInt64());
+                details.DataETag = record["ETag"].asString();
+                details.DataLastModified = record["LastModified"].asString();
+                command.Sources.emplace_back(std::move(details));
+            }
+            else if (type == "Search" || type == "SearchForIds")
+            {
+                RecordedSearch search;
+                if (type == "Search")
+                {
+                    search.Request = ReadRequest(record["Request"]);
+                    search.Summary = record["Summary"].asString();
+                }
+                else
+                {
+                    search.IsForIds = true;
+                    search.Ids = ReadStrings(record["Ids"]);
+                }
+                search.ResultCount = static_cast<size_t>(record["Results"].asUInt64());
+                search.Duration = std::chrono::microseconds{ record["Microseconds"].asInt64() };
+                command.Searches.emplace_back(std::move(search));
+            }
+            else if (type == "End")
+            {
+                command.Result = static_cast<HRESULT>(record["Result"].asInt());
+                command.Duration = std::chrono::microseconds{ record["Microseconds"].asInt64() };
+
+                const Json::Value& operations = record["Operations"];
+                if (operations.isObject())
+                {
+                    for (const auto& name : operations.getMemberNames())
+                    {
+                        const Json::Value& operation = operations[name];
+                        command.Operations.push_back({ name, operation["Count"].asUInt64(), std::chrono::microseconds{ operation["Microseconds"].asInt64() } });
+                    }
+                }
+            }
+        }
+    }
+
+    void EnableRecording(const std::filesystem::path& filePath)
+    {
+        // Appending only, so that every write goes to the end of the file whichever process makes it
+        wil::unique_hfile file{ CreateFileW(filePath.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        THROW_LAST_ERROR_IF_MSG(!file, "failed opening workload trace");
+
+        TraceFile& traceFile = GetTraceFile();
+        std::lock_guard<std::mutex> lock{ traceFile.Lock };
+        traceFile.File = std::move(file);
+        traceFile.Enabled = true;
+
+        AICLI_LOG(Repo, Info, << "Recording workload to [" << filePath << "]");
+    }
+
+    void DisableRecording()
+    {
+        TraceFile& traceFile = GetTraceFile();
+        std::lock_guard<std::mutex> lock{ traceFile.Lock };
+        traceFile.File.reset();
+        traceFile.Enabled = false;
+    }
+
+    bool IsRecording()
+    {
+        return GetTraceFile().Enabled;
+    }
+
+    std::filesystem::path GetDefaultTracePath()
+    {
+        return Runtime::GetPathTo(Runtime::PathName::DefaultLogLocation) / s_TraceFileName;
+    }
+
+    CommandRecorder::CommandRecorder(const std::vector<std::string>& args)
+    {
+        if (!IsRecording())
+        {
+            return;
+        }
+
+        m_command = ++s_lastCommand;
+        m_previousCommand = std::exchange(s_currentCommand, m_command);
+        m_start = Clock::now();
+
+        for (size_t i = 0; i < ToIntegral(Logging::PerformanceOperation::Max); ++i)
+        {
+            m_startCounters.emplace_back(Logging::GetPerformanceCounter(static_cast<Logging::PerformanceOperation>(i)));
+        }
+
+        Json::Value record = CreateRecord("Command", m_command);
+        Json::Value argsValue{ Json::arrayValue };
+        for (const auto& arg : args)
+        {
+            argsValue.append(arg);
+        }
+        record["Args"] = std::move(argsValue);
+        WriteRecord(record);
+    }
+
+    CommandRecorder::~CommandRecorder()
+    {
+        if (m_command != 0)
+        {
+            s_currentCommand = m_previousCommand;
+        }
+    }
+
+    void CommandRecorder::End(HRESULT result)
+    {
+        if (m_command == 0 || m_ended)
+        {
+            return;
+        }
+
+        m_ended = true;
+
+        Json::Value record = CreateRecord("End", m_command);
+        record["Result"] = static_cast<Json::Int>(result);
+        record["Microseconds"] = ToJson(ToMicroseconds(Clock::now() - m_start));
+
+        Json::Value operations{ Json::objectValue };
+        for (size_t i = 0; i < m_startCounters.size(); ++i)
+        {
+            Logging::PerformanceOperation operation = static_cast<Logging::PerformanceOperation>(i);
+            Logging::PerformanceCounter counter = Logging::GetPerformanceCounter(operation);
+
+            // The counters are for the process, so the command is given what was added to them while it ran
+            uint64_t count = counter.Count - m_startCounters[i].Count;
+            if (count == 0)
+            {
+                continue;
+            }
+
+            Json::Value operationValue{ Json::objectValue };
+            operationValue["Count"] = static_cast<Json::UInt64>(count);
+            operationValue["Microseconds"] = ToJson(counter.Total - m_startCounters[i].Total);
+            operations[std::string{ Logging::ToString(operation) }] = std::move(operationValue);
+        }
+        record["Operations"] = std::move(operations);
+
+        WriteRecord(record);
+    }
+
+    void RecordSource(const SourceDetails& details)
+    {
+        if (s_currentCommand == 0 || !IsRecording())
+        {
+            return;
+        }
+
+        Json::Value record = CreateRecord("Source", s_currentCommand);
+        record["Name"] = details.Name;
+        record["SourceType"] = details.Type;
+        record["Arg"] = details.Arg;
+        record["LastUpdateTime"] = static_cast<Json::Value::Int64>(Utility::ConvertSystemClockToUnixEpoch(details.LastUpdateTime));
+        record["ETag"] = details.DataETag;
+        record["LastModified"] = details.DataLastModified;
+        WriteRecord(record);
+    }
+
+    void RecordSearch(const SearchRequest& request, size_t resultCount, std::chrono::microseconds duration)
+    {
+        if (s_currentCommand == 0 || !IsRecording())
+        {
+            return;
+        }
+
+        Json::Value record = CreateRecord("Search", s_currentCommand);
+        record["Summary"] = request.ToString();
+        record["Request"] = ToJson(request);
+        record["Results"] = static_cast<Json::UInt64>(resultCount);
+        record["Microseconds"] = ToJson(duration);
+        WriteRecord(record);
+    }
+
+    void RecordSearchForIds(const std::vector<std::string>& ids, size_t resultCount, std::chrono::microseconds duration)
+    {
+        if (s_currentCommand == 0 || !IsRecording())
+        {
+            return;
+        }
+
+        Json::Value record = CreateRecord("SearchForIds", s_currentCommand);
+        Json::Value idsValue{ Json::arrayValue };
+        for (const auto& id : ids)
+        {
+            idsValue.append(id);
+        }
+        record["Ids"] = std::move(idsValue);
+        record["Results"] = static_cast<Json::UInt64>(resultCount);
+        record["Microseconds"] = ToJson(duration);
+        WriteRecord(record);
+    }
+
+    std::vector<RecordedCommand> ReadTrace(const std::filesystem::path& filePath)
+    {
+        std::ifstream stream{ filePath, std::ios::binary };
+        THROW_LAST_ERROR_IF(!stream);
+
+        std::vector<RecordedCommand> result;
+
+        // The command that each process and command number refers to; a process id can be used again by a later process,
+        // whose first command then takes over the key.
+        std::map<std::pair<uint32_t, uint64_t>, size_t> commands;
+
+        Json::CharReaderBuilder builder;
+        std::unique_ptr<Json::CharReader> reader{ builder.newCharReader() };
+
+        std::string line;
+        size_t skipped = 0;
+        while (std::getline(stream, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+
+            if (line.empty())
+            {
+                continue;
+            }
+
+            // A line can be cut short if its process ended while writing it
+            try
+            {
+                Json::Value record;
+                std::string error;
+                if (!reader->parse(line.data(), line.data() + line.size(), &record, &error) || !record.isObject())
+                {
+                    ++skipped;
+                    continue;
+                }
+
+                std::pair<uint32_t, uint64_t> key{ record["Process"].asUInt(), record["Command"].asUInt64() };
+
+                if (record["Type"].asString() == "Command")
+                {
+                    RecordedCommand command;
+                    command.Process = key.first;
+                    command.Command = key.second;
+                    command.Args = ReadStrings(record["Args"]);
+                    commands[key] = result.size();
+                    result.emplace_back(std::move(command));
+                    continue;
+                }
+
+                auto itr = commands.find(key);
+                if (itr == commands.end())
+                {
+                    ++skipped;
+                    continue;
+                }
+
+                ReadRecord(record, result[itr->second]);
+            }
+            catch (...)
+            {
+                ++skipped;
+            }
+        }
+
+        AICLI_LOG(Repo, Info, << "Read " << result.size() << " commands from workload trace [" << filePath << "], skipping " << skipped << " lines");
+
+        return result;
+    }
+
+    std::vector<ReplayedSearch> Replay(const std::vector<RecordedCommand>& commands, ISource& source)
+    {
+        std::vector<ReplayedSearch> result;
+
+        for (const auto& command : commands)
+        {
+            for (const auto& search : command.Searches)
+            {
+                ReplayedSearch replayed;
+                replayed.Command = &command;
+                replayed.Search = &search;
+
+                auto start = Clock::now();
+                SearchResult searchResult = search.IsForIds ? source.SearchForIds(search.Ids) : source.Search(search.Request);
+                replayed.Duration = ToMicroseconds(Clock::now() - start);
+                replayed.ResultCount = searchResult.Matches.size();
+
+                result.emplace_back(std::move(replayed));
+            }
+        }
+
+        AICLI_LOG(Repo, Info, << "Replayed " << result.size() << " searches of " << commands.size() << " commands");
+
+        return result;
+    }
+
+    std::string ConvertToJson(const std::vector<ReplayedSearch>& searches)
+    {
+        Json::Value root{ Json::arrayValue };
+
+        for (const auto& search : searches)
+        {
+            Json::Value searchValue{ Json::objectValue };
+            searchValue["Process"] = static_cast<Json::UInt>(search.Command->Process);
+            searchValue["Command"] = static_cast<Json::UInt64>(search.Command->Command);
+            searchValue["Type"] = search.Search->IsForIds ? "SearchForIds" : "Search";
+            if (!search.Search->IsForIds)
+            {
+                searchValue["Summary"] = search.Search->Summary;
+            }
+            searchValue["RecordedResults"] = static_cast<Json::UInt64>(search.Search->ResultCount);
+            searchValue["RecordedMicroseconds"] = ToJson(search.Search->Duration);
+            searchValue["Results"] = static_cast<Json::UInt64>(search.ResultCount);
+            searchValue["Microseconds"] = ToJson(search.Duration);
+            root.append(std::move(searchValue));
+        }
+
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "  ";
+        return Json::writeString(builder, root);
+    }
+}
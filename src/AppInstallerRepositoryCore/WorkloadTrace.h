@@ -0,0 +1,128 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+#include "Public/AppInstallerRepositorySearch.h"
+#include "Public/AppInstallerRepositorySource.h"
+#include <AppInstallerTelemetry.h>
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace AppInstaller::Repository::Workload
+{
+    // A workload trace records what each command did, so that real workloads can be replayed later to compare
+    // index schemas, cache settings and builds on equal terms. It is a file of JSON lines, which every recording
+    // process appends to; each record is written as it is made, so a command that never ends is still in the trace:
+    //  { "Type": "Command", "Process": 1, "Command": 1, "Args": [ "..." ] }
+    //  { "Type": "Source", "Process": 1, "Command": 1, "Name": "...", "SourceType": "...", "Arg": "...", "LastUpdateTime": 0, "ETag": "...", "LastModified": "..." }
+    //  { "Type": "Search", "Process": 1, "Command": 1, "Summary": "...", "Request": { "Query": { "Type": "...", "Value": "..." },
+    //      "Inclusions": [ { "Field": "...", "Type": "...", "Value": "..." } ], "Filters": [ ... ], "MaximumResults": 0 }, "Results": 0, "Microseconds": 0 }
+    //  { "Type": "SearchForIds", "Process": 1, "Command": 1, "Ids": [ "..." ], "Results": 0, "Microseconds": 0 }
+    //  { "Type": "End", "Process": 1, "Command": 1, "Result": 0, "Microseconds": 0, "Operations": { "<operation>": { "Count": 0, "Microseconds": 0 } } }
+    // Commands are numbered within their process, and the records of a command are those made on its thread.
+
+    // Starts recording the commands of this process, appending them to the trace file.
+    void EnableRecording(const std::filesystem::path& filePath);
+
+    // Stops recording, closing the trace file.
+    void DisableRecording();
+
+    // Determines whether the commands of this process are being recorded.
+    bool IsRecording();
+
+    // Gets the location of the trace that is recorded when the setting is enabled, beside the log files.
+    std::filesystem::path GetDefaultTracePath();
+
+    // Records a command for its lifetime, on the thread that runs it; nothing is recorded if recording is not enabled.
+    // The operation times of the command are those added to the performance counters while it ran.
+    struct CommandRecorder
+    {
+        CommandRecorder(const std::vector<std::string>& args);
+
+        CommandRecorder(const CommandRecorder&) = delete;
+        CommandRecorder& operator=(const CommandRecorder&) = delete;
+
+        CommandRecorder(CommandRecorder&&) = delete;
+        CommandRecorder& operator=(CommandRecorder&&) = delete;
+
+        ~CommandRecorder();
+
+        // Records the end of the command with its result.
+        void End(HRESULT result);
+
+    private:
+        uint64_t m_command = 0;
+        uint64_t m_previousCommand = 0;
+        bool m_ended = false;
+        std::chrono::steady_clock::time_point m_start;
+        std::vector<Logging::PerformanceCounter> m_startCounters;
+    };
+
+    // Records a source that the current command opened.
+    void RecordSource(const SourceDetails& details);
+
+    // Records a search of the current command.
+    void RecordSearch(const SearchRequest& request, size_t resultCount, std::chrono::microseconds duration);
+
+    // Records a search for ids of the current command.
+    void RecordSearchForIds(const std::vector<std::string>& ids, size_t resultCount, std::chrono::microseconds duration);
+
+    // A search read from a trace.
+    struct RecordedSearch
+    {
+        // Set for a search for ids, which has no request.
+        bool IsForIds = false;
+        SearchRequest Request;
+        std::vector<std::string> Ids;
+
+        std::string Summary;
+        size_t ResultCount = 0;
+        std::chrono::microseconds Duration{};
+    };
+
+    // The time that a command spent in one of the performance operations.
+    struct RecordedOperation
+    {
+        std::string Name;
+        uint64_t Count = 0;
+        std::chrono::microseconds Total{};
+    };
+
+    // A command read from a trace.
+    struct RecordedCommand
+    {
+        uint32_t Process = 0;
+        uint64_t Command = 0;
+        std::vector<std::string> Args;
+        std::vector<SourceDetails> Sources;
+        std::vector<RecordedSearch> Searches;
+
+        // Not set if the command did not end in the trace.
+        std::optional<HRESULT> Result;
+        std::chrono::microseconds Duration{};
+        std::vector<RecordedOperation> Operations;
+    };
+
+    // Reads the commands from the trace, in the order that they started; lines that cannot be read are skipped.
+    std::vector<RecordedCommand> ReadTrace(const std::filesystem::path& filePath);
+
+    // The result of replaying a search.
+    struct ReplayedSearch
+    {
+        const RecordedCommand* Command = nullptr;
+        const RecordedSearch* Search = nullptr;
+        size_t ResultCount = 0;
+        std::chrono::microseconds Duration{};
+    };
+
+    // Runs every search of the commands against the source, in the order that they were recorded, timing each.
+    std::vector<ReplayedSearch> Replay(const std::vector<RecordedCommand>& commands, ISource& source);
+
+    // Converts the replayed searches to a JSON array, with the recorded and replayed durations of each in microseconds.
+    std::string ConvertToJson(const std::vector<ReplayedSearch>& searches);
+}
@@ -16,6 +16,7 @@
 #include <AppInstallerSHA256.h>
 #include <AppInstallerStrings.h>
 #include <AppInstallerSynchronization.h>
+#include <AppInstallerTelemetry.h>
 #include <AppInstallerVersions.h>
 #include <winget/ExtensionCatalog.h>
 #include <winget/ExperimentalFeature.h>
@@ -36,9 +37,11 @@
 #include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <functional>
 #include <initializer_list>
 #include <iomanip>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -4,6 +4,7 @@
 namespace IndexCreationTool
 {
     using System;
+    using System.Collections.Generic;
     using System.Diagnostics;
     using System.IO;
 
@@ -12,12 +13,20 @@ namespace IndexCreationTool
         public const string IndexName = @"index.db";
         public const string IndexPathInPackage = @"Public\index.db";
         public const string IndexPackageName = @"source.msix";
+        public const string ManifestCacheName = @"manifestcache.bin";
+        public const string ManifestCachePathInPackage = @"Public\manifestcache.bin";
+        public const string ProfileName = @"IndexProfile.json";
 
         static void Main(string[] args)
         {
             string rootDir = string.Empty;
             string appxManifestPath = string.Empty;
             string certPath = string.Empty;
+            bool directoryIngest = false;
+            bool manifestCache = false;
+            bool profile = false;
+            string searchCorpusPath = null;
+            uint profileIterations = 1;
 
             for (int i = 0; i < args.Length; i++)
             {
@@ -33,11 +42,32 @@ namespace IndexCreationTool
                 {
                     certPath = args[i];
                 }
+                else if (args[i] == "-i")
+                {
+                    directoryIngest = true;
+                }
+                else if (args[i] == "-b")
+                {
+                    manifestCache = true;
+                }
+                else if (args[i] == "-p")
+                {
+                    profile = true;
+                }
+                else if (args[i] == "-s" && ++i < args.Length)
+                {
+                    profile = true;
+                    searchCorpusPath = args[i];
+                }
+                else if (args[i] == "-n" && ++i < args.Length)
+                {
+                    profileIterations = uint.Parse(args[i]);
+                }
             }
 
             if (string.IsNullOrEmpty(rootDir))
             {
-                Console.WriteLine("Usage: IndexCreationTool.exe -d <Path to search for yaml> [-m <appxmanifest for index package> [-c <cert for signing index package>]]");
+                Console.WriteLine("Usage: IndexCreationTool.exe -d <Path to search for yaml> [-i] [-b] [-p [-s <search corpus file> [-n <iterations>]]] [-m <appxmanifest for index package> [-c <cert for signing index package>]]");
                 return;
             }
 
@@ -50,11 +80,37 @@ namespace IndexCreationTool
 
                 using (var indexHelper = WinGetUtilWrapper.Create(IndexName))
                 {
-                    foreach (string file in Directory.EnumerateFiles(rootDir, "*.yaml", SearchOption.AllDirectories))
+                    if (directoryIngest)
                     {
-                        indexHelper.AddManifest(file, Path.GetRelativePath(rootDir, file));
+                        // Let WinGetUtil enumerate the directory itself.
+                        indexHelper.AddManifestsFromDirectory(rootDir);
                     }
+                    else
+                    {
+                        List<string> manifestPaths = new List<string>();
+                        List<string> relativePaths = new List<string>();
+                        foreach (string file in Directory.EnumerateFiles(rootDir, "*.yaml", SearchOption.AllDirectories))
+                        {
+                            manifestPaths.Add(file);
+                            relativePaths.Add(Path.GetRelativePath(rootDir, file));
+                        }
+                        indexHelper.AddManifests(manifestPaths, relativePaths);
+                    }
+
                     indexHelper.PrepareForPackaging();
+
+                    if (profile)
+                    {
+                        // Measured on the packaged index, as it is what clients search.
+                        File.WriteAllText(ProfileName, indexHelper.Profile(searchCorpusPath, profileIterations));
+                        Console.WriteLine($"Wrote index profile to {ProfileName}.");
+                    }
+                }
+
+                if (manifestCache)
+                {
+                    // Clients read manifests from the cache rather than downloading them.
+                    WinGetUtilWrapper.CreateManifestCache(rootDir, ManifestCacheName);
                 }
 
                 if (!string.IsNullOrEmpty(appxManifestPath))
@@ -64,6 +120,11 @@ namespace IndexCreationTool
                         outputFile.WriteLine("[Files]");
                         outputFile.WriteLine($"\"{IndexName}\" \"{IndexPathInPackage}\"");
                         outputFile.WriteLine($"\"{appxManifestPath}\" \"AppxManifest.xml\"");
+
+                        if (manifestCache)
+                        {
+                            outputFile.WriteLine($"\"{ManifestCacheName}\" \"{ManifestCachePathInPackage}\"");
+                        }
                     }
 
                     RunCommand("makeappx.exe", $"pack /f MappingFile.txt /o /nv /p {IndexPackageName}");
@@ -4,6 +4,8 @@
 namespace IndexCreationTool
 {
     using System;
+    using System.Collections.Generic;
+    using System.Linq;
     using System.Runtime.InteropServices;
 
     /// <summary>
@@ -91,6 +93,45 @@ namespace IndexCreationTool
             }
         }
 
+        /// <summary>
+        /// Adds manifests to index in a single transaction.
+        /// </summary>
+        /// <param name="manifestPaths">Manifests to add.</param>
+        /// <param name="relativePaths">Paths of the manifests in the repository, in the same order.</param>
+        public void AddManifests(IList<string> manifestPaths, IList<string> relativePaths)
+        {
+            try
+            {
+                Console.WriteLine($"Adding {manifestPaths.Count} manifests on index file.");
+                WinGetSQLiteIndexAddManifests(this.indexHandle, (uint)manifestPaths.Count, manifestPaths.ToArray(), relativePaths.ToArray());
+                return;
+            }
+            catch (Exception e)
+            {
+                Console.WriteLine($"Error to add {manifestPaths.Count} manifests. {Environment.NewLine}{e.ToString()}");
+                throw;
+            }
+        }
+
+        /// <summary>
+        /// Adds all manifests under a directory to index in a single transaction, parsing them in parallel.
+        /// </summary>
+        /// <param name="rootDirectory">Directory to search for manifests; relative paths are from this directory.</param>
+        public void AddManifestsFromDirectory(string rootDirectory)
+        {
+            try
+            {
+                Console.WriteLine($"Adding manifests from {rootDirectory} on index file.");
+                WinGetSQLiteIndexAddManifestsFromDirectory(this.indexHandle, rootDirectory);
+                return;
+            }
+            catch (Exception e)
+            {
+                Console.WriteLine($"Error to add manifests from {rootDirectory}. {Environment.NewLine}{e.ToString()}");
+                throw;
+            }
+        }
+
         /// <summary>
         /// Updates manifest in the index.
         /// </summary>
@@ -147,6 +188,26 @@ namespace IndexCreationTool
             }
         }
 
+        /// <summary>
+        /// Writes a cache of all manifests under a directory, to be published alongside the index.
+        /// </summary>
+        /// <param name="rootDirectory">Directory to search for manifests; relative paths are from this directory.</param>
+        /// <param name="cacheFile">Manifest cache file to create.</param>
+        public static void CreateManifestCache(string rootDirectory, string cacheFile)
+        {
+            try
+            {
+                Console.WriteLine($"Creating manifest cache {cacheFile} from {rootDirectory}.");
+                WinGetManifestCacheCreateFromDirectory(rootDirectory, cacheFile);
+                return;
+            }
+            catch (Exception e)
+            {
+                Console.WriteLine($"Error to create manifest cache from {rootDirectory}. {Environment.NewLine}{e.ToString()}");
+                throw;
+            }
+        }
+
         /// <summary>
         /// Wrapper for WinGetSQLiteIndexPrepareForPackaging.
         /// </summary>
@@ -164,6 +225,43 @@ namespace IndexCreationTool
             }
         }
 
+        /// <summary>
+        /// Wrapper for WinGetSQLiteIndexMigrate; upgrades the index to the latest schema without reading the manifests again.
+        /// </summary>
+        public void MigrateToLatest()
+        {
+            try
+            {
+                WinGetSQLiteIndexMigrate(this.indexHandle, WinGetUtilWrapper.LatestVersion, WinGetUtilWrapper.LatestVersion);
+                return;
+            }
+            catch (Exception e)
+            {
+                Console.WriteLine($"Error to migrate the index. {Environment.NewLine}{e.ToString()}");
+                throw;
+            }
+        }
+
+        /// <summary>
+        /// Reports the size of each table and index of the index, and the search latencies of each match type.
+        /// </summary>
+        /// <param name="searchCorpusFile">File with one search query per line; null to only report sizes.</param>
+        /// <param name="iterations">Number of times to search for each query with each match type.</param>
+        /// <returns>The profile as JSON.</returns>
+        public string Profile(string searchCorpusFile, uint iterations)
+        {
+            try
+            {
+                WinGetSQLiteIndexProfile(this.indexHandle, searchCorpusFile, iterations, out string profile);
+                return profile;
+            }
+            catch (Exception e)
+            {
+                Console.WriteLine($"Error to profile index. {Environment.NewLine}{e.ToString()}");
+                throw;
+            }
+        }
+
         /// <summary>
         /// Dispose method.
         /// </summary>
@@ -227,6 +325,41 @@ namespace IndexCreationTool
         [DllImport(DllName, CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Unicode, PreserveSig = false)]
         private static extern IntPtr WinGetSQLiteIndexAddManifest(IntPtr index, string manifestPath, string relativePath);
 
+        /// <summary>
+        /// Adds the manifests at the repository relative paths to the index.
+        /// If the function succeeds, all of the manifests have been added; otherwise none have.
+        /// </summary>
+        /// <param name="index">Handle of the index.</param>
+        /// <param name="count">Number of manifests to add.</param>
+        /// <param name="manifestPaths">Manifests to add.</param>
+        /// <param name="relativePaths">Paths of the manifests in the container.</param>
+        /// <returns>HRESULT.</returns>
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Unicode, PreserveSig = false)]
+        private static extern IntPtr WinGetSQLiteIndexAddManifests(
+            IntPtr index,
+            uint count,
+            [MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.LPWStr)] string[] manifestPaths,
+            [MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.LPWStr)] string[] relativePaths);
+
+        /// <summary>
+        /// Adds every manifest under the directory to the index, with its path relative to the directory.
+        /// If the function succeeds, all of the manifests have been added; otherwise none have.
+        /// </summary>
+        /// <param name="index">Handle of the index.</param>
+        /// <param name="rootDirectory">Directory to search for manifests.</param>
+        /// <returns>HRESULT.</returns>
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Unicode, PreserveSig = false)]
+        private static extern IntPtr WinGetSQLiteIndexAddManifestsFromDirectory(IntPtr index, string rootDirectory);
+
+        /// <summary>
+        /// Writes a cache of every manifest under the directory, keyed by its path relative to the directory.
+        /// </summary>
+        /// <param name="rootDirectory">Directory to search for manifests.</param>
+        /// <param name="cacheFilePath">Manifest cache file to create.</param>
+        /// <returns>HRESULT.</returns>
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Unicode, PreserveSig = false)]
+        private static extern IntPtr WinGetManifestCacheCreateFromDirectory(string rootDirectory, string cacheFilePath);
+
         /// <summary>
         /// Updates the manifest at the repository relative path in the index.
         /// The out value indicates whether the index was modified by the function.
@@ -260,5 +393,30 @@ namespace IndexCreationTool
         /// <returns>HRESULT.</returns>
         [DllImport(DllName, CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Unicode, PreserveSig = false)]
         private static extern IntPtr WinGetSQLiteIndexPrepareForPackaging(IntPtr index);
+
+        /// <summary>
+        /// Upgrades the index, in place, to the given later schema version.
+        /// </summary>
+        /// <param name="index">Index handle.</param>
+        /// <param name="majorVersion">Major version of the schema.</param>
+        /// <param name="minorVersion">Minor version of the schema.</param>
+        /// <returns>HRESULT.</returns>
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Unicode, PreserveSig = false)]
+        private static extern IntPtr WinGetSQLiteIndexMigrate(IntPtr index, uint majorVersion, uint minorVersion);
+
+        /// <summary>
+        /// Reports the size of each table and index of the index, and the search latencies of each match type.
+        /// </summary>
+        /// <param name="index">Handle of the index.</param>
+        /// <param name="searchCorpusPath">File with one search query per line; null to only report sizes.</param>
+        /// <param name="iterations">Number of times to search for each query with each match type.</param>
+        /// <param name="profile">The profile as JSON.</param>
+        /// <returns>HRESULT.</returns>
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Unicode, PreserveSig = false)]
+        private static extern IntPtr WinGetSQLiteIndexProfile(
+            IntPtr index,
+            string searchCorpusPath,
+            uint iterations,
+            [MarshalAs(UnmanagedType.BStr)] out string profile);
     }
 }
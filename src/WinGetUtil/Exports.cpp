@@ -8,7 +8,12 @@
 #include <AppInstallerLogging.h>
 #include <AppInstallerStrings.h>
 #include <AppInstallerTelemetry.h>
+#include <Microsoft/ManifestCache.h>
 #include <Microsoft/SQLiteIndex.h>
+#include <Microsoft/SQLiteIndexProfile.h>
+#include <Microsoft/SQLiteIndexSource.h>
+#include <WorkloadTrace.h>
+#include <winget/ManifestDirectoryValidation.h>
 #include <winget/ManifestYamlParser.h>
 
 using namespace AppInstaller::Utility;
@@ -90,6 +95,22 @@ extern "C"
     }
     CATCH_RETURN()
 
+    WINGET_UTIL_API WinGetSQLiteIndexOpenWithLog(WINGET_STRING filePath, WINGET_SQLITE_INDEX_HANDLE* index) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !filePath);
+        THROW_HR_IF(E_INVALIDARG, !index);
+        THROW_HR_IF(E_INVALIDARG, !!*index);
+
+        std::string filePathUtf8 = ConvertToUTF8(filePath);
+
+        std::unique_ptr<SQLiteIndex> result = std::make_unique<SQLiteIndex>(SQLiteIndex::Open(filePathUtf8, SQLiteIndex::OpenDisposition::ReadWriteWithLog));
+
+        *index = static_cast<WINGET_SQLITE_INDEX_HANDLE>(result.release());
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
     WINGET_UTIL_API WinGetSQLiteIndexClose(WINGET_SQLITE_INDEX_HANDLE index) try
     {
         std::unique_ptr<SQLiteIndex> toClose(reinterpret_cast<SQLiteIndex*>(index));
@@ -112,6 +133,107 @@ extern "C"
     }
     CATCH_RETURN()
 
+    WINGET_UTIL_API WinGetSQLiteIndexAddManifests(
+        WINGET_SQLITE_INDEX_HANDLE index,
+        UINT32 count,
+        WINGET_STRING* manifestPaths,
+        WINGET_STRING* relativePaths) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !index);
+        THROW_HR_IF(E_INVALIDARG, count && !manifestPaths);
+        THROW_HR_IF(E_INVALIDARG, count && !relativePaths);
+
+        std::vector<std::pair<std::filesystem::path, std::filesystem::path>> paths;
+        paths.reserve(count);
+
+        for (UINT32 i = 0; i < count; ++i)
+        {
+            THROW_HR_IF(E_INVALIDARG, !manifestPaths[i]);
+            THROW_HR_IF(E_INVALIDARG, !relativePaths[i]);
+
+            paths.emplace_back(manifestPaths[i], relativePaths[i]);
+        }
+
+        reinterpret_cast<SQLiteIndex*>(index)->AddManifests(paths);
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
+    WINGET_UTIL_API WinGetSQLiteIndexAddManifestsFromDirectory(
+        WINGET_SQLITE_INDEX_HANDLE index,
+        WINGET_STRING rootDirectory) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !index);
+        THROW_HR_IF(E_INVALIDARG, !rootDirectory);
+
+        reinterpret_cast<SQLiteIndex*>(index)->AddManifestsFromDirectory(rootDirectory);
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
+    WINGET_UTIL_API WinGetSQLiteIndexApplyManifestChanges(
+        WINGET_SQLITE_INDEX_HANDLE index,
+        UINT32 count,
+        const WINGET_MANIFEST_CHANGE* changes,
+        WINGET_MANIFEST_CHANGE_CALLBACK callback,
+        void* context) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !index);
+        THROW_HR_IF(E_INVALIDARG, count != 0 && !changes);
+
+        std::vector<SQLiteIndex::ManifestChange> manifestChanges;
+        manifestChanges.reserve(count);
+
+        for (UINT32 i = 0; i < count; ++i)
+        {
+            const WINGET_MANIFEST_CHANGE& change = changes[i];
+            THROW_HR_IF(E_INVALIDARG, !change.RelativePath);
+            THROW_HR_IF(E_INVALIDARG, !change.ManifestContent && !change.ManifestPath);
+
+            SQLiteIndex::ManifestChange manifestChange;
+            switch (change.ChangeType)
+            {
+            case WinGetManifestChangeAdd:
+                manifestChange.ChangeOperation = SQLiteIndex::ManifestChange::Operation::Add;
+                break;
+            case WinGetManifestChangeUpdate:
+                manifestChange.ChangeOperation = SQLiteIndex::ManifestChange::Operation::Update;
+                break;
+            case WinGetManifestChangeRemove:
+                manifestChange.ChangeOperation = SQLiteIndex::ManifestChange::Operation::Remove;
+                break;
+            default:
+                THROW_HR(E_INVALIDARG);
+            }
+
+            if (change.ManifestContent)
+            {
+                manifestChange.ManifestContent.emplace(change.ManifestContent, change.ManifestContentSize);
+            }
+            else
+            {
+                manifestChange.ManifestPath = change.ManifestPath;
+            }
+            manifestChange.RelativePath = change.RelativePath;
+
+            manifestChanges.emplace_back(std::move(manifestChange));
+        }
+
+        reinterpret_cast<SQLiteIndex*>(index)->ApplyManifestChanges(manifestChanges,
+            [&](size_t changeIndex, HRESULT result, bool indexModified)
+            {
+                if (callback)
+                {
+                    callback(static_cast<UINT32>(changeIndex), result, (indexModified ? TRUE : FALSE), context);
+                }
+            });
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
     WINGET_UTIL_API WinGetSQLiteIndexUpdateManifest(
         WINGET_SQLITE_INDEX_HANDLE index,
         WINGET_STRING manifestPath,
@@ -157,6 +279,130 @@ extern "C"
     }
     CATCH_RETURN()
 
+    WINGET_UTIL_API WinGetSQLiteIndexMigrate(
+        WINGET_SQLITE_INDEX_HANDLE index,
+        UINT32 majorVersion,
+        UINT32 minorVersion) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !index);
+
+        reinterpret_cast<SQLiteIndex*>(index)->MigrateTo(Schema::Version{ majorVersion, minorVersion });
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
+    WINGET_UTIL_API WinGetSQLiteIndexCreateDelta(
+        WINGET_STRING deltaPath,
+        WINGET_SQLITE_INDEX_HANDLE baseIndex,
+        WINGET_SQLITE_INDEX_HANDLE targetIndex) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !deltaPath);
+        THROW_HR_IF(E_INVALIDARG, !baseIndex);
+        THROW_HR_IF(E_INVALIDARG, !targetIndex);
+
+        std::string deltaPathUtf8 = ConvertToUTF8(deltaPath);
+
+        (void)SQLiteIndex::CreateDelta(deltaPathUtf8, *reinterpret_cast<SQLiteIndex*>(baseIndex), *reinterpret_cast<SQLiteIndex*>(targetIndex));
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
+    WINGET_UTIL_API WinGetSQLiteIndexCreateHot(
+        WINGET_STRING hotPath,
+        WINGET_SQLITE_INDEX_HANDLE index,
+        WINGET_STRING idListPath) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !hotPath);
+        THROW_HR_IF(E_INVALIDARG, !index);
+        THROW_HR_IF(E_INVALIDARG, !idListPath);
+
+        std::string hotPathUtf8 = ConvertToUTF8(hotPath);
+
+        (void)SQLiteIndex::CreateHot(hotPathUtf8, *reinterpret_cast<SQLiteIndex*>(index), ReadSearchCorpus(idListPath));
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
+    WINGET_UTIL_API WinGetSQLiteIndexApplyDelta(
+        WINGET_SQLITE_INDEX_HANDLE index,
+        WINGET_STRING deltaPath) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !index);
+        THROW_HR_IF(E_INVALIDARG, !deltaPath);
+
+        std::string deltaPathUtf8 = ConvertToUTF8(deltaPath);
+
+        SQLiteIndex delta = SQLiteIndex::Open(deltaPathUtf8, SQLiteIndex::OpenDisposition::Read);
+        reinterpret_cast<SQLiteIndex*>(index)->ApplyDelta(delta);
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
+    WINGET_UTIL_API WinGetSQLiteIndexProfile(
+        WINGET_SQLITE_INDEX_HANDLE index,
+        WINGET_STRING searchCorpusPath,
+        UINT32 iterations,
+        WINGET_STRING_OUT* profile) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !index);
+        THROW_HR_IF(E_INVALIDARG, !profile);
+
+        std::vector<std::string> searchCorpus;
+        if (searchCorpusPath)
+        {
+            searchCorpus = ReadSearchCorpus(searchCorpusPath);
+        }
+
+        IndexProfile result = ProfileIndex(*reinterpret_cast<SQLiteIndex*>(index), searchCorpus, iterations);
+        *profile = ::SysAllocString(ConvertToUTF16(ConvertToJson(result)).c_str());
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
+    WINGET_UTIL_API WinGetWorkloadReplay(
+        WINGET_STRING indexPath,
+        WINGET_STRING tracePath,
+        WINGET_STRING_OUT* results) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !indexPath);
+        THROW_HR_IF(E_INVALIDARG, !tracePath);
+        THROW_HR_IF(E_INVALIDARG, !results);
+
+        std::vector<AppInstaller::Repository::Workload::RecordedCommand> commands = AppInstaller::Repository::Workload::ReadTrace(tracePath);
+
+        // The index is searched through a source, as the client searches it, so that the replay includes creating the results
+        AppInstaller::Repository::SourceDetails details;
+        details.Name = "Replay";
+        details.Arg = ConvertToUTF8(indexPath);
+
+        SQLiteIndex index = SQLiteIndex::Open(details.Arg, SQLiteIndex::OpenDisposition::Read);
+        auto source = std::make_shared<SQLiteIndexSource>(details, std::move(index));
+
+        auto replayed = AppInstaller::Repository::Workload::Replay(commands, *source);
+        *results = ::SysAllocString(ConvertToUTF16(AppInstaller::Repository::Workload::ConvertToJson(replayed)).c_str());
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
+    WINGET_UTIL_API WinGetManifestCacheCreateFromDirectory(
+        WINGET_STRING rootDirectory,
+        WINGET_STRING cacheFilePath) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !rootDirectory);
+        THROW_HR_IF(E_INVALIDARG, !cacheFilePath);
+
+        ManifestCache::CreateFromDirectory(cacheFilePath, rootDirectory);
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
     WINGET_UTIL_API WinGetValidateManifest(
         WINGET_STRING manifestPath,
         BOOL* succeeded,
@@ -183,6 +429,100 @@ extern "C"
     }
     CATCH_RETURN()
 
+    WINGET_UTIL_API WinGetValidateManifestDirectory(
+        WINGET_STRING directoryPath,
+        BOOL* succeeded,
+        WINGET_STRING_OUT* results) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !directoryPath);
+        THROW_HR_IF(E_INVALIDARG, !succeeded);
+
+        auto validationResults = ValidateManifestsInDirectory(directoryPath);
+        *succeeded = GetCombinedResult(validationResults) == APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_FAILURE ? FALSE : TRUE;
+
+        if (results)
+        {
+            *results = ::SysAllocString(ConvertToUTF16(ConvertToJson(validationResults)).c_str());
+        }
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
+    WINGET_UTIL_API WinGetValidationCacheOpen(
+        WINGET_STRING cacheFilePath,
+        WINGET_VALIDATION_CACHE_HANDLE* cache) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !cacheFilePath);
+        THROW_HR_IF(E_INVALIDARG, !cache);
+        THROW_HR_IF(E_INVALIDARG, !!*cache);
+
+        auto result = std::make_unique<ManifestValidationCache>(cacheFilePath);
+
+        *cache = static_cast<WINGET_VALIDATION_CACHE_HANDLE>(result.release());
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
+    WINGET_UTIL_API WinGetValidationCacheClose(
+        WINGET_VALIDATION_CACHE_HANDLE cache) try
+    {
+        std::unique_ptr<ManifestValidationCache> toClose(reinterpret_cast<ManifestValidationCache*>(cache));
+
+        if (toClose)
+        {
+            toClose->Save();
+        }
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
+    WINGET_UTIL_API WinGetValidateManifestWithCache(
+        WINGET_VALIDATION_CACHE_HANDLE cache,
+        WINGET_STRING manifestPath,
+        BOOL* succeeded,
+        WINGET_STRING_OUT* message) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !cache);
+        THROW_HR_IF(E_INVALIDARG, !manifestPath);
+        THROW_HR_IF(E_INVALIDARG, !succeeded);
+
+        auto result = ValidateManifestFile(manifestPath, reinterpret_cast<ManifestValidationCache*>(cache));
+        *succeeded = result.Result == APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_FAILURE ? FALSE : TRUE;
+
+        if (message && result.Result != S_OK)
+        {
+            *message = ::SysAllocString(ConvertToUTF16(result.Message).c_str());
+        }
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
+    WINGET_UTIL_API WinGetValidateManifestDirectoryWithCache(
+        WINGET_VALIDATION_CACHE_HANDLE cache,
+        WINGET_STRING directoryPath,
+        BOOL* succeeded,
+        WINGET_STRING_OUT* results) try
+    {
+        THROW_HR_IF(E_INVALIDARG, !cache);
+        THROW_HR_IF(E_INVALIDARG, !directoryPath);
+        THROW_HR_IF(E_INVALIDARG, !succeeded);
+
+        auto validationResults = ValidateManifestsInDirectory(directoryPath, reinterpret_cast<ManifestValidationCache*>(cache));
+        *succeeded = GetCombinedResult(validationResults) == APPINSTALLER_CLI_ERROR_MANIFEST_VALIDATION_FAILURE ? FALSE : TRUE;
+
+        if (results)
+        {
+            *results = ::SysAllocString(ConvertToUTF16(ConvertToJson(validationResults)).c_str());
+        }
+
+        return S_OK;
+    }
+    CATCH_RETURN()
+
     WINGET_UTIL_API WinGetDownload(
         WINGET_STRING url,
         WINGET_STRING filePath,
@@ -197,7 +537,7 @@ extern "C"
         THROW_HR_IF(E_INVALIDARG, computeHash && sha256HashLength != 32);
 
         AppInstaller::ProgressCallback callback;
-        auto hashValue = Download(ConvertToUTF8(url), filePath, callback, computeHash);
+        auto hashValue = Download(ConvertToUTF8(url), filePath, DownloadType::WinGetUtil, callback, computeHash);
 
         // At this point, if computeHash is set we have verified that the buffer is valid and 32 bytes.
         if (computeHash)
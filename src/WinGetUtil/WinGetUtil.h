@@ -7,12 +7,37 @@ extern "C"
     // A handle to the index.
     typedef void* WINGET_SQLITE_INDEX_HANDLE;
 
+    // A handle to a cache of manifest validation results.
+    typedef void* WINGET_VALIDATION_CACHE_HANDLE;
+
     // A string taken in by the utility; in UTF16.
     typedef wchar_t const* const WINGET_STRING;
 
     // A string returned by the utility; in UTF16.
     typedef BSTR WINGET_STRING_OUT;
 
+    // The change to make to the index for a manifest.
+    typedef enum _WINGET_MANIFEST_CHANGE_TYPE
+    {
+        WinGetManifestChangeAdd = 0,
+        WinGetManifestChangeUpdate = 1,
+        WinGetManifestChangeRemove = 2,
+    } WINGET_MANIFEST_CHANGE_TYPE;
+
+    // A change to make to the index for a manifest at the repository relative path.
+    // The manifest is read from ManifestPath, unless ManifestContent holds its YAML content (in UTF8).
+    typedef struct _WINGET_MANIFEST_CHANGE
+    {
+        UINT32 ChangeType;
+        wchar_t const* ManifestPath;
+        char const* ManifestContent;
+        UINT32 ManifestContentSize;
+        wchar_t const* RelativePath;
+    } WINGET_MANIFEST_CHANGE;
+
+    // Called with the result of each change, in the order of the changes, and whether it modified the index.
+    typedef void (__stdcall *WINGET_MANIFEST_CHANGE_CALLBACK)(UINT32 index, HRESULT result, BOOL indexModified, void* context);
+
 #define WINGET_UTIL_API HRESULT __stdcall
 
 #define WINGET_SQLITE_INDEX_VERSION_LATEST ((UINT32)-1)
@@ -38,6 +63,12 @@ extern "C"
         WINGET_STRING filePath, 
         WINGET_SQLITE_INDEX_HANDLE* index);
 
+    // Opens an existing index at filePath with a write-ahead log, so that readers of the index are not blocked
+    // while manifests are added to it. The log is removed when the index is prepared for packaging.
+    WINGET_UTIL_API WinGetSQLiteIndexOpenWithLog(
+        WINGET_STRING filePath,
+        WINGET_SQLITE_INDEX_HANDLE* index);
+
     // Closes the index.
     WINGET_UTIL_API WinGetSQLiteIndexClose(
         WINGET_SQLITE_INDEX_HANDLE index);
@@ -49,6 +80,32 @@ extern "C"
         WINGET_STRING manifestPath, 
         WINGET_STRING relativePath);
 
+    // Adds the manifests at the repository relative paths to the index.
+    // The arrays must each contain count strings, paired by their position.
+    // If the function succeeds, all of the manifests have been added; otherwise none have.
+    WINGET_UTIL_API WinGetSQLiteIndexAddManifests(
+        WINGET_SQLITE_INDEX_HANDLE index,
+        UINT32 count,
+        WINGET_STRING* manifestPaths,
+        WINGET_STRING* relativePaths);
+
+    // Adds every manifest (*.yaml) under the directory to the index, with its path relative to the directory.
+    // The manifests are parsed in parallel and added in a single transaction.
+    // If the function succeeds, all of the manifests have been added; otherwise none have.
+    WINGET_UTIL_API WinGetSQLiteIndexAddManifestsFromDirectory(
+        WINGET_SQLITE_INDEX_HANDLE index,
+        WINGET_STRING rootDirectory);
+
+    // Applies the changes to the index in a single transaction, parsing the manifests in parallel.
+    // A change that fails does not stop the others; its error is given to the callback and it has no effect.
+    // The callback is optional. The function fails only if the changes could not be applied at all.
+    WINGET_UTIL_API WinGetSQLiteIndexApplyManifestChanges(
+        WINGET_SQLITE_INDEX_HANDLE index,
+        UINT32 count,
+        const WINGET_MANIFEST_CHANGE* changes,
+        WINGET_MANIFEST_CHANGE_CALLBACK callback,
+        void* context);
+
     // Updates the manifest with matching { Id, Version, Channel } in the index.
     // The return value indicates whether the index was modified by the function.
     WINGET_UTIL_API WinGetSQLiteIndexUpdateManifest(
@@ -68,6 +125,57 @@ extern "C"
     WINGET_UTIL_API WinGetSQLiteIndexPrepareForPackaging(
         WINGET_SQLITE_INDEX_HANDLE index);
 
+    // Upgrades the index, in place, to the given later schema version, without reading the manifests again.
+    // If the function succeeds, the index is of the new version; otherwise it is unchanged.
+    WINGET_UTIL_API WinGetSQLiteIndexMigrate(
+        WINGET_SQLITE_INDEX_HANDLE index,
+        UINT32 majorVersion,
+        UINT32 minorVersion);
+
+    // Creates a new delta file at deltaPath that holds the changes turning the base index into the target index.
+    // Applying the delta to a copy of the base index results in the same manifests as the target index.
+    WINGET_UTIL_API WinGetSQLiteIndexCreateDelta(
+        WINGET_STRING deltaPath,
+        WINGET_SQLITE_INDEX_HANDLE baseIndex,
+        WINGET_SQLITE_INDEX_HANDLE targetIndex);
+
+    // Creates a new hot index file at hotPath holding every version of the ids listed in the file at idListPath,
+    // one per line, from the index. It also holds a filter of every id in the index, for clients to know which ids
+    // can only be found once they have the full index. The hot index is then prepared for packaging like any other.
+    WINGET_UTIL_API WinGetSQLiteIndexCreateHot(
+        WINGET_STRING hotPath,
+        WINGET_SQLITE_INDEX_HANDLE index,
+        WINGET_STRING idListPath);
+
+    // Applies the delta file at deltaPath to the index, which must be the base index of the delta.
+    // If the function succeeds, all of the changes have been applied; otherwise none have.
+    WINGET_UTIL_API WinGetSQLiteIndexApplyDelta(
+        WINGET_SQLITE_INDEX_HANDLE index,
+        WINGET_STRING deltaPath);
+
+    // Reports the size of each table and index of the index as JSON. If a search corpus file is given, with one query
+    // per line, each query is also searched for with each match type the given number of times, and the latency
+    // percentiles of each match type are reported.
+    WINGET_UTIL_API WinGetSQLiteIndexProfile(
+        WINGET_SQLITE_INDEX_HANDLE index,
+        WINGET_STRING searchCorpusPath,
+        UINT32 iterations,
+        WINGET_STRING_OUT* profile);
+
+    // Runs the searches of a workload trace, as recorded by the diagnostics.recordWorkload setting, against the index,
+    // in the order that they were recorded. Reports each search as JSON, with the duration and result count that were
+    // recorded beside those of the replay. The index is only read, so the replay needs no network.
+    WINGET_UTIL_API WinGetWorkloadReplay(
+        WINGET_STRING indexPath,
+        WINGET_STRING tracePath,
+        WINGET_STRING_OUT* results);
+
+    // Writes a cache of every manifest under the directory, keyed by its path relative to the directory, for publishing
+    // alongside the index as Public\manifestcache.bin. Clients then read manifests from it rather than downloading them.
+    WINGET_UTIL_API WinGetManifestCacheCreateFromDirectory(
+        WINGET_STRING rootDirectory,
+        WINGET_STRING cacheFilePath);
+
     // Validates a given manifest. Returns a bool for validation result and
     // a string representing validation errors if validation failed.
     WINGET_UTIL_API WinGetValidateManifest(
@@ -75,6 +183,37 @@ extern "C"
         BOOL* succeeded,
         WINGET_STRING_OUT* message);
 
+    // Validates every manifest under the given directory concurrently. Returns a bool that is false if any manifest
+    // failed validation (warnings do not fail it), and a JSON array with the result and errors of each manifest.
+    WINGET_UTIL_API WinGetValidateManifestDirectory(
+        WINGET_STRING directoryPath,
+        BOOL* succeeded,
+        WINGET_STRING_OUT* results);
+
+    // Opens the cache of validation results at cacheFilePath, keyed by the SHA256 of manifest content and the version of
+    // the validator. The file is created when the cache is closed if it does not exist, and a file from another version is replaced.
+    WINGET_UTIL_API WinGetValidationCacheOpen(
+        WINGET_STRING cacheFilePath,
+        WINGET_VALIDATION_CACHE_HANDLE* cache);
+
+    // Writes the results added to the cache back to its file, and closes it.
+    WINGET_UTIL_API WinGetValidationCacheClose(
+        WINGET_VALIDATION_CACHE_HANDLE cache);
+
+    // As WinGetValidateManifest, but a manifest whose content has a result in the cache is not validated again.
+    WINGET_UTIL_API WinGetValidateManifestWithCache(
+        WINGET_VALIDATION_CACHE_HANDLE cache,
+        WINGET_STRING manifestPath,
+        BOOL* succeeded,
+        WINGET_STRING_OUT* message);
+
+    // As WinGetValidateManifestDirectory, but the manifests whose content has a result in the cache are not validated again.
+    WINGET_UTIL_API WinGetValidateManifestDirectoryWithCache(
+        WINGET_VALIDATION_CACHE_HANDLE cache,
+        WINGET_STRING directoryPath,
+        BOOL* succeeded,
+        WINGET_STRING_OUT* results);
+
     // Downloads a file to the given path, returning the SHA 256 hash of the file.
     WINGET_UTIL_API WinGetDownload(
         WINGET_STRING url,